@@ -226,14 +226,18 @@ def xls_ir_verilog_impl(ctx, src):
         "module_name",
         "assert_format",
         "clock_margin_percent",
+        "clock_period_search_threads",
         "gate_format",
         "period_relaxation_percent",
         "reset",
+        "resource_sharing_constraints",
+        "schedule_cache_dir",
         "reset_active_low",
         "reset_asynchronous",
         "reset_data_path",
         "use_system_verilog",
         "separate_lines",
+        "sparse_timing_constraints",
         "streaming_channel_data_suffix",
         "streaming_channel_ready_suffix",
         "streaming_channel_valid_suffix",
@@ -244,7 +248,10 @@ def xls_ir_verilog_impl(ctx, src):
         "ram_configurations",
         "gate_recvs",
         "array_index_bounds_checking",
+        "bdd_io_analysis_node_limit",
+        "merge_registers",
         "mutual_exclusion_z3_rlimit",
+        "mutual_exclusion_time_budget_ms",
     )
 
     is_args_valid(codegen_args, CODEGEN_FLAGS)
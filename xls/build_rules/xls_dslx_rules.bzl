@@ -105,6 +105,10 @@ def _get_dslx_test_cmdline(ctx, src, append_cmd_line_args = True):
         "dslx_path",
         "warnings_as_errors",
         "max_ticks",
+        "test_parallelism",
+        "quickcheck_parallelism",
+        "jit_object_cache_dir",
+        "jit_object_cache_max_bytes",
     )
 
     dslx_test_args = dict(_dslx_test_args)
@@ -224,10 +224,20 @@ def xls_ir_cc_library_macro(
     This will produce a cc_library that will execute the fn `bar` from the
     `foo` IR file. The call itself will be inside the namespace `a::b::c`.
 
+    `top` may be a comma-separated list of functions, in which case all of them
+    are compiled into a single object file and the generated header declares a
+    wrapper for each. Functions called by more than one of them are compiled
+    once.
+
+    Besides the xls::Value-based wrappers, the header declares allocation-free
+    entry points with C linkage for each function, which take their arguments
+    and result in the packed layout; see xls/jit/aot_c_api.h.
+
     Args:
       name: The name of the resulting library.
       src: The path to the IR file to compile.
-      top: The entry point in the IR file of interest.
+      top: The entry point(s) in the IR file of interest. If unspecified, the
+           package top is used.
       namespaces: A comma-separated list of namespaces into which the
                   generated code should go.
     """
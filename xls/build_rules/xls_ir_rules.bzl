@@ -203,6 +203,16 @@ def _optimize_ir(ctx, src):
         "opt_level",
         "convert_array_index_to_select",
         "inline_procs",
+        "incremental_topo_sort",
+        "incremental_verification",
+        "incremental_fixed_point",
+        "function_base_pass_threads",
+        "structural_hashing",
+        "pass_metrics_path",
+        "cache_dir",
+        "opt_time_budget",
+        "proof_threads",
+        "proof_timeout",
     )
 
     is_args_valid(opt_ir_args, IR_OPT_FLAGS)
@@ -337,6 +347,9 @@ def get_eval_ir_test_cmd(ctx, src, append_cmd_line_args = True):
         "use_llvm_jit",
         "test_llvm_jit",
         "llvm_opt_level",
+        "jit_object_cache_dir",
+        "jit_object_cache_max_bytes",
+        "threads",
         "test_only_inject_jit_result",
     )
 
@@ -411,6 +424,7 @@ def get_benchmark_ir_cmd(ctx, src, append_cmd_line_args = True):
         "pipeline_stages",
         "clock_margin_percent",
         "show_known_bits",
+        "critical_path_count",
         "delay_model",
         "convert_array_index_to_select",
     )
@@ -1074,6 +1088,8 @@ def _xls_ir_cc_library_impl(ctx):
     aot_compiler_args.add("-output_object", object_file.path)
     aot_compiler_args.add("-output_source", unformatted_source_file.path)
     aot_compiler_args.add("-header_include_path", header_file.short_path)
+    if ctx.attr.top:
+        aot_compiler_args.add("-top", ctx.attr.top)
     if ctx.attr.namespaces:
         aot_compiler_args.add("-namespaces", ctx.attr.namespaces)
 
@@ -359,7 +359,8 @@ def xls_dslx_opt_ir_macro(
 
 def xls_dslx_cpp_type_library(
         name,
-        src):
+        src,
+        native_layout = False):
     """Creates a cc_library target for transpiled DSLX types.
 
     This macros invokes the DSLX-to-C++ transpiler and compiles the result as
@@ -368,6 +369,8 @@ def xls_dslx_cpp_type_library(
     Args:
       name: The name of the eventual cc_library.
       src: The DSLX file whose types to compile as C++.
+      native_layout: Whether to also generate methods converting structs
+        directly to and from the native data layout used by the JIT.
     """
     native.genrule(
         name = name + "_generate_sources",
@@ -382,6 +385,7 @@ def xls_dslx_cpp_type_library(
         cmd = "$(location //xls/dslx:cpp_transpiler_main) " +
               "--output_header_path=$(@D)/{}.h ".format(name) +
               "--output_source_path=$(@D)/{}.cc ".format(name) +
+              ("--native_layout " if native_layout else "") +
               "$(location {})".format(src),
     )
 
@@ -15,15 +15,21 @@
 #include "xls/codegen/bdd_io_analysis.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
+#include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/passes/bdd_query_engine.h"
@@ -49,9 +55,65 @@ bool UseNodeInBddEngine(const Node* node) {
          node->Is<CompareOp>();
 }
 
+// Returns a function containing the cones of logic computing `predicates` in
+// `f`, with the nodes which are not evaluated using BDDs replaced by
+// parameters, together with the nodes of the function corresponding to
+// `predicates`. Building the BDD over this function rather than over `f`
+// avoids allocating BDD variables for the (possibly many) nodes which cannot
+// affect the predicates.
+absl::StatusOr<std::pair<std::unique_ptr<Function>, std::vector<Node*>>>
+ExtractPredicateCones(FunctionBase* f, absl::Span<Node* const> predicates) {
+  // A node is a leaf of the cone if its value is modeled as BDD variables
+  // anyway.
+  auto is_leaf = [](Node* node) {
+    return !UseNodeInBddEngine(node) ||
+           !std::all_of(node->operands().begin(), node->operands().end(),
+                        [](Node* o) { return o->GetType()->IsBits(); });
+  };
+  absl::flat_hash_set<Node*> cone;
+  std::vector<Node*> worklist(predicates.begin(), predicates.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (!cone.insert(node).second || is_leaf(node)) {
+      continue;
+    }
+    worklist.insert(worklist.end(), node->operands().begin(),
+                    node->operands().end());
+  }
+
+  auto cone_function = std::make_unique<Function>(
+      absl::StrCat(f->name(), "__predicate_cones"), f->package());
+  absl::flat_hash_map<Node*, Node*> node_map;
+  for (Node* node : TopoSort(f)) {
+    if (!cone.contains(node)) {
+      continue;
+    }
+    if (is_leaf(node)) {
+      node_map[node] = cone_function->AddNode(std::make_unique<Param>(
+          node->loc(), node->GetName(), node->GetType(), cone_function.get()));
+      continue;
+    }
+    std::vector<Node*> new_operands;
+    for (Node* operand : node->operands()) {
+      new_operands.push_back(node_map.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        node_map[node],
+        node->CloneInNewFunction(new_operands, cone_function.get()));
+  }
+
+  std::vector<Node*> cone_predicates;
+  for (Node* predicate : predicates) {
+    cone_predicates.push_back(node_map.at(predicate));
+  }
+  return std::make_pair(std::move(cone_function), std::move(cone_predicates));
+}
+
 }  // namespace
 
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(FunctionBase* f) {
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    FunctionBase* f, int64_t node_limit, int64_t path_limit) {
   // Find all send nodes associated with streaming channels.
   int64_t streaming_send_count = 0;
   std::vector<Node*> send_predicates;
@@ -89,12 +151,14 @@ absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(FunctionBase* f) {
   }
 
   // Use BDD query engine to determine predicates are such that
-  // if one is true, the rest are false.
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit,
-                              UseNodeInBddEngine);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
-
-  return query_engine.AtMostOneNodeTrue(send_predicates);
+  // if one is true, the rest are false. Expressions which exceed the node or
+  // path limits are replaced by new variables so the answer is conservative.
+  XLS_ASSIGN_OR_RETURN(auto cones, ExtractPredicateCones(f, send_predicates));
+  auto& [cone_function, cone_predicates] = cones;
+  BddQueryEngine query_engine(path_limit, UseNodeInBddEngine, node_limit);
+  XLS_RETURN_IF_ERROR(query_engine.Populate(cone_function.get()).status());
+
+  return query_engine.AtMostOneNodeTrue(cone_predicates);
 }
 
 }  // namespace xls
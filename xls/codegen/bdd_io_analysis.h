@@ -15,18 +15,34 @@
 #ifndef XLS_CODEGEN_BDD_IO_ANALYSIS_H_
 #define XLS_CODEGEN_BDD_IO_ANALYSIS_H_
 
+#include <cstdint>
+
 #include "absl/status/statusor.h"
 #include "xls/common/casts.h"
 #include "xls/ir/function.h"
+#include "xls/passes/bdd_function.h"
 #include "xls/passes/passes.h"
 
 namespace xls {
 
-// Determines if streaming outputs are mutually exclusive.
+// The default limits on the BDD used by AreStreamingOutputsMutuallyExclusive.
+// These are lower than the defaults of the optimizer's BDD query engine as
+// codegen only needs the BDD to answer a single query.
+inline constexpr int64_t kDefaultBddIoAnalysisNodeLimit = 1 << 16;
+inline constexpr int64_t kDefaultBddIoAnalysisPathLimit =
+    BddFunction::kDefaultPathLimit;
+
+// Determines if streaming outputs are mutually exclusive. Only the cones of
+// logic computing the send predicates are analyzed. `node_limit` and
+// `path_limit` bound the size of the BDD (zero means no limit); if they are
+// exceeded the analysis conservatively returns false rather than growing the
+// BDD further.
 //
 // TODO(tedhong): 2022-02-09 Add analysis of I/O dependencies
 // TODO(tedhong): 2022-02-09 Add additional exclusivity analysis
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(FunctionBase* f);
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    FunctionBase* f, int64_t node_limit = kDefaultBddIoAnalysisNodeLimit,
+    int64_t path_limit = kDefaultBddIoAnalysisPathLimit);
 
 }  // namespace xls
 
@@ -228,5 +228,45 @@ TEST_F(BddIOAnalysisPassTest, NonMutuallyExclusiveSendIf) {
   EXPECT_EQ(mutually_exclusive, false);
 }
 
+TEST_F(BddIOAnalysisPassTest, MutuallyExclusiveSendIfExceedingNodeLimit) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * sel,
+      package.CreateStreamingChannel("sel", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in_val = pb.Receive(in);
+  BValue sel_val = pb.Receive(sel);
+
+  pb.SendIf(out0, pb.Eq(sel_val, pb.Literal(UBits(0, 32))), in_val);
+  pb.SendIf(out1, pb.Eq(sel_val, pb.Literal(UBits(1, 32))), in_val);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(bool mutually_exclusive,
+                           AreStreamingOutputsMutuallyExclusive(proc));
+  EXPECT_EQ(mutually_exclusive, true);
+
+  // With a tiny BDD the predicates cannot be analyzed so the answer is
+  // conservative.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      mutually_exclusive,
+      AreStreamingOutputsMutuallyExclusive(proc, /*node_limit=*/4));
+  EXPECT_EQ(mutually_exclusive, false);
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,6 +14,8 @@
 
 #include "xls/codegen/block_conversion.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -1940,42 +1942,45 @@ class CloneNodesIntoBlockHandler {
     return absl::OkStatus();
   }
 
-  // Add pipeline registers. A register is needed for each node which is
-  // scheduled at or before this cycle and has a use after this cycle.
-  absl::Status AddNextPipelineStage(const PipelineSchedule& schedule,
-                                    int64_t stage) {
+  // Determines which nodes need a pipeline register after each stage: those
+  // scheduled at or before the stage with a use after it. Each node's live
+  // range (from its own cycle to its last use) is computed once, so this is
+  // linear in the number of nodes and registers rather than rescanning every
+  // node and its users for every stage. Must be called before
+  // AddNextPipelineStage().
+  void ComputeLiveRanges(const PipelineSchedule& schedule) {
     Function* as_func = dynamic_cast<Function*>(function_base_);
-
-    for (Node* function_base_node : function_base_->nodes()) {
-      if (schedule.cycle(function_base_node) > stage) {
-        continue;
+    int64_t last_stage = schedule.length() - 1;
+    live_out_of_stage_.assign(schedule.length(), {});
+    for (Node* node : function_base_->nodes()) {
+      int64_t last_use = schedule.cycle(node);
+      if (as_func != nullptr && node == as_func->return_value()) {
+        last_use = last_stage;
       }
-      auto is_live_out_of_stage = [&](Node* n) {
-        if (stage == schedule.length() - 1) {
-          return false;
-        }
-        if ((as_func != nullptr) && (n == as_func->return_value())) {
-          return true;
-        }
-        for (Node* user : n->users()) {
-          if (schedule.cycle(user) > stage) {
-            return true;
-          }
-        }
-        return false;
-      };
+      for (Node* user : node->users()) {
+        last_use = std::max(last_use, schedule.cycle(user));
+      }
+      for (int64_t stage = schedule.cycle(node);
+           stage < std::min(last_use, last_stage); ++stage) {
+        live_out_of_stage_[stage].push_back(node);
+      }
+    }
+  }
 
-      if (is_live_out_of_stage(function_base_node)) {
-        Node* node = node_map_.at(function_base_node);
+  // Add pipeline registers. A register is needed for each node which is
+  // scheduled at or before this cycle and has a use after this cycle.
+  absl::Status AddNextPipelineStage(int64_t stage) {
+    XLS_RET_CHECK_LT(stage, live_out_of_stage_.size());
+    for (Node* function_base_node : live_out_of_stage_[stage]) {
+      Node* node = node_map_.at(function_base_node);
 
-        XLS_ASSIGN_OR_RETURN(
-            Node * node_after_stage,
-            CreatePipelineRegistersForNode(
-                PipelineSignalName(node->GetName(), stage), node,
-                result_.pipeline_registers.at(stage), block_));
+      XLS_ASSIGN_OR_RETURN(
+          Node * node_after_stage,
+          CreatePipelineRegistersForNode(
+              PipelineSignalName(node->GetName(), stage), node,
+              result_.pipeline_registers.at(stage), block_));
 
-        node_map_[function_base_node] = node_after_stage;
-      }
+      node_map_[function_base_node] = node_after_stage;
     }
 
     return absl::OkStatus();
@@ -2390,6 +2395,9 @@ class CloneNodesIntoBlockHandler {
   Block* block_;
   StreamingIOPipeline result_;
   absl::flat_hash_map<Node*, Node*> node_map_;
+
+  // The nodes to register after each stage, see ComputeLiveRanges().
+  std::vector<std::vector<Node*>> live_out_of_stage_;
 };
 
 // Adds the nodes in the given schedule to the block. Pipeline registers are
@@ -2403,9 +2411,10 @@ static absl::StatusOr<StreamingIOPipeline> CloneNodesIntoPipelinedBlock(
 
   CloneNodesIntoBlockHandler cloner(function_base, schedule.length(), options,
                                     block);
+  cloner.ComputeLiveRanges(schedule);
   for (int64_t stage = 0; stage < schedule.length(); ++stage) {
     XLS_RET_CHECK_OK(cloner.CloneNodes(schedule.nodes_in_cycle(stage), stage));
-    XLS_RET_CHECK_OK(cloner.AddNextPipelineStage(schedule, stage));
+    XLS_RET_CHECK_OK(cloner.AddNextPipelineStage(stage));
   }
 
   XLS_RET_CHECK_OK(cloner.AddOutputPortsIfFunction());
@@ -2716,8 +2725,11 @@ absl::StatusOr<Block*> ProcToPipelinedBlock(const PipelineSchedule& schedule,
   bool streaming_outputs_mutually_exclusive = true;
   if (number_of_outputs > 1) {
     // TODO: do this analysis on a per-stage basis
-    XLS_ASSIGN_OR_RETURN(streaming_outputs_mutually_exclusive,
-                         AreStreamingOutputsMutuallyExclusive(proc));
+    XLS_ASSIGN_OR_RETURN(
+        streaming_outputs_mutually_exclusive,
+        AreStreamingOutputsMutuallyExclusive(
+            proc, options.bdd_io_analysis_node_limit().value_or(
+                      kDefaultBddIoAnalysisNodeLimit)));
 
     if (streaming_outputs_mutually_exclusive) {
       XLS_VLOG(3) << absl::StrFormat(
@@ -2871,8 +2883,11 @@ absl::StatusOr<Block*> ProcToCombinationalBlock(Proc* proc,
 
   if (number_of_outputs > 1) {
     // TODO: do this analysis on a per-stage basis
-    XLS_ASSIGN_OR_RETURN(bool streaming_outputs_mutually_exclusive,
-                         AreStreamingOutputsMutuallyExclusive(proc));
+    XLS_ASSIGN_OR_RETURN(
+        bool streaming_outputs_mutually_exclusive,
+        AreStreamingOutputsMutuallyExclusive(
+            proc, options.bdd_io_analysis_node_limit().value_or(
+                      kDefaultBddIoAnalysisNodeLimit)));
 
     if (streaming_outputs_mutually_exclusive) {
       XLS_VLOG(3) << absl::StrFormat(
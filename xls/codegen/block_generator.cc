@@ -14,9 +14,16 @@
 
 #include "xls/codegen/block_generator.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <deque>
+#include <memory>
+#include <string>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/flattening.h"
@@ -28,9 +35,11 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/block.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 namespace verilog {
@@ -770,11 +779,53 @@ absl::StatusOr<std::vector<Block*>> GatherInstantiatedBlocks(Block* top) {
   return blocks;
 }
 
+// The Verilog generated for a single block, see GenerateVerilog().
+struct GeneratedBlock {
+  absl::Status status;
+  std::unique_ptr<VerilogFile> file;
+  LineInfo line_info;
+  std::string text;
+  absl::Duration construction_duration;
+  absl::Duration emission_duration;
+};
+
+// Adds the source-to-Verilog line mappings recorded in `line_info` to
+// `verilog_line_map`, with Verilog lines shifted down by `line_offset`.
+absl::Status AddLineMappings(const LineInfo& line_info, int64_t line_offset,
+                             Package* package,
+                             VerilogLineMap* verilog_line_map) {
+  for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
+    std::optional<std::vector<LineSpan>> spans =
+        line_info.LookupNode(vast_node);
+    if (!spans.has_value()) {
+      return absl::InternalError("Unbalanced calls to LineInfo::{Start, End}");
+    }
+    for (const LineSpan& span : spans.value()) {
+      SourceInfo info = vast_node->loc();
+      for (const SourceLocation& loc : info.locations) {
+        int64_t line = static_cast<int32_t>(loc.lineno());
+        VerilogLineMapping* mapping = verilog_line_map->add_mapping();
+        mapping->set_source_file(
+            package->GetFilename(loc.fileno()).value_or(""));
+        mapping->mutable_source_span()->set_line_start(line);
+        mapping->mutable_source_span()->set_line_end(line);
+        mapping->set_verilog_file("");  // to be updated later on
+        mapping->mutable_verilog_span()->set_line_start(span.StartLine() +
+                                                        line_offset);
+        mapping->mutable_verilog_span()->set_line_end(span.EndLine() +
+                                                      line_offset);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::StatusOr<std::string> GenerateVerilog(Block* top,
                                             const CodegenOptions& options,
-                                            VerilogLineMap* verilog_line_map) {
+                                            VerilogLineMap* verilog_line_map,
+                                            PassResults* pass_results) {
   XLS_VLOG(2) << absl::StreamFormat(
       "Generating Verilog for packge with with top level block `%s`:",
       top->name());
@@ -782,40 +833,50 @@ absl::StatusOr<std::string> GenerateVerilog(Block* top,
 
   XLS_ASSIGN_OR_RETURN(std::vector<Block*> blocks,
                        GatherInstantiatedBlocks(top));
-  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
-                                                : FileType::kVerilog);
-  for (Block* block : blocks) {
-    XLS_RETURN_IF_ERROR(BlockGenerator::Generate(block, &file, options));
-    if (block != blocks.back()) {
-      file.Add(file.Make<BlankLine>(SourceInfo()));
-      file.Add(file.Make<BlankLine>(SourceInfo()));
+
+  // Each block becomes a self-contained module which refers to the modules of
+  // the blocks it instantiates only by name, so the blocks are generated and
+  // emitted concurrently into separate files. The resulting text is spliced
+  // together in order below, separated by two blank lines.
+  std::vector<GeneratedBlock> generated(blocks.size());
+  auto generate = [&](int64_t i) {
+    GeneratedBlock& out = generated[i];
+    out.file = std::make_unique<VerilogFile>(options.use_system_verilog()
+                                                 ? FileType::kSystemVerilog
+                                                 : FileType::kVerilog);
+    absl::Time start = absl::Now();
+    out.status = BlockGenerator::Generate(blocks[i], out.file.get(), options);
+    out.construction_duration = absl::Now() - start;
+    if (out.status.ok()) {
+      start = absl::Now();
+      out.text = out.file->Emit(&out.line_info);
+      out.emission_duration = absl::Now() - start;
     }
+  };
+  ParallelFor(0, blocks.size(), generate);
+
+  if (pass_results != nullptr) {
+    PhaseTiming construction{.name = "vast_construction"};
+    PhaseTiming emission{.name = "verilog_emission"};
+    for (const GeneratedBlock& block : generated) {
+      construction.duration += block.construction_duration;
+      emission.duration += block.emission_duration;
+    }
+    pass_results->phases.push_back(std::move(construction));
+    pass_results->phases.push_back(std::move(emission));
   }
 
-  LineInfo line_info;
-  std::string text = file.Emit(&line_info);
-  if (verilog_line_map != nullptr) {
-    for (const auto& [vast_node, partial_spans] : line_info.Spans()) {
-      std::optional<std::vector<LineSpan>> spans =
-          line_info.LookupNode(vast_node);
-      if (!spans.has_value()) {
-        return absl::InternalError(
-            "Unbalanced calls to LineInfo::{Start, End}");
-      }
-      for (const LineSpan& span : spans.value()) {
-        SourceInfo info = vast_node->loc();
-        for (const SourceLocation& loc : info.locations) {
-          int64_t line = static_cast<int32_t>(loc.lineno());
-          VerilogLineMapping* mapping = verilog_line_map->add_mapping();
-          mapping->set_source_file(
-              top->package()->GetFilename(loc.fileno()).value_or(""));
-          mapping->mutable_source_span()->set_line_start(line);
-          mapping->mutable_source_span()->set_line_end(line);
-          mapping->set_verilog_file("");  // to be updated later on
-          mapping->mutable_verilog_span()->set_line_start(span.StartLine());
-          mapping->mutable_verilog_span()->set_line_end(span.EndLine());
-        }
-      }
+  std::string text;
+  for (const GeneratedBlock& block : generated) {
+    XLS_RETURN_IF_ERROR(block.status);
+    if (&block != &generated.front()) {
+      absl::StrAppend(&text, "\n\n");
+    }
+    int64_t line_offset = absl::c_count(text, '\n');
+    absl::StrAppend(&text, block.text);
+    if (verilog_line_map != nullptr) {
+      XLS_RETURN_IF_ERROR(AddLineMappings(block.line_info, line_offset,
+                                          top->package(), verilog_line_map));
     }
   }
 
@@ -19,6 +19,7 @@
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/ir/block.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 namespace verilog {
@@ -26,9 +27,14 @@ namespace verilog {
 // Generates and returns (System)Verilog text implementing the given top-level
 // block. The text will include a Verilog module corresponding to the given
 // block as well as module definitions for any instantiated blocks.
+//
+// If `pass_results` is non-null, the time spent building the VAST of the
+// modules and emitting it as text is recorded in it as the phases
+// "vast_construction" and "verilog_emission" (each summed over all blocks).
 absl::StatusOr<std::string> GenerateVerilog(
     Block* top, const CodegenOptions& options,
-    VerilogLineMap* verilog_line_map = nullptr);
+    VerilogLineMap* verilog_line_map = nullptr,
+    PassResults* pass_results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
@@ -0,0 +1,305 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the phases of codegen over synthetic pipelines of
+// parameterized size: the number of nodes of each pipeline, the number of
+// stages, the bit width of the values and the number of pipelines (each a
+// separate block instantiated by a top-level block). The conversion of the
+// scheduled functions to blocks, the codegen pass pipeline and Verilog
+// generation are timed separately; the latter also reports the time spent
+// building the VAST and emitting it as text.
+//
+// Besides the time, each benchmark reports the size parameters and the peak
+// resident set size of the process so far (run a single benchmark with
+// --benchmark_filter for a per-size figure). To track regressions save the
+// results with --benchmark_out=<file> --benchmark_out_format=json and compare
+// runs with Google Benchmark's tools/compare.py.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "absl/time/time.h"
+#include "xls/codegen/block_conversion.h"
+#include "xls/codegen/block_generator.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/codegen/codegen_pass_pipeline.h"
+#include "xls/codegen/pipeline_generator.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/instantiation.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+namespace xls::verilog {
+namespace {
+
+// The number of parameters of each synthetic pipeline.
+constexpr int64_t kParamCount = 8;
+
+// The size parameters of a synthetic design, in the order of the benchmark
+// arguments.
+struct DesignSize {
+  int64_t node_count;
+  int64_t stage_count;
+  int64_t bit_width;
+  int64_t pipeline_count;
+};
+
+DesignSize GetDesignSize(const benchmark::State& state) {
+  return DesignSize{.node_count = state.range(0),
+                    .stage_count = state.range(1),
+                    .bit_width = state.range(2),
+                    .pipeline_count = state.range(3)};
+}
+
+struct Design {
+  std::unique_ptr<Package> package;
+  std::vector<Function*> functions;
+  std::vector<PipelineSchedule> schedules;
+};
+
+// Returns a function of `size.node_count` operations on `size.bit_width`-bit
+// values. Each operation combines the previous one with an earlier value so
+// the function is one long dependency chain (all of it live) with fan-out
+// throughout.
+Function* BuildSyntheticFunction(std::string_view name, const DesignSize& size,
+                                 Package* package) {
+  FunctionBuilder fb(name, package);
+  Type* type = package->GetBitsType(size.bit_width);
+  std::vector<BValue> values;
+  for (int64_t i = 0; i < kParamCount; ++i) {
+    values.push_back(fb.Param(absl::StrCat("x", i), type));
+  }
+  for (int64_t i = 0; i < size.node_count; ++i) {
+    BValue lhs = values.back();
+    BValue rhs = values[(i * 7919) % values.size()];
+    switch (i % 4) {
+      case 0:
+        values.push_back(fb.Add(lhs, rhs));
+        break;
+      case 1:
+        values.push_back(fb.Xor(lhs, rhs));
+        break;
+      case 2:
+        values.push_back(fb.Subtract(lhs, rhs));
+        break;
+      default:
+        values.push_back(fb.Or(lhs, fb.Not(rhs)));
+        break;
+    }
+  }
+  return fb.BuildWithReturnValue(values.back()).value();
+}
+
+// Returns a schedule of `f` dividing its nodes evenly between the stages in
+// topological order.
+PipelineSchedule ScheduleEvenly(Function* f, int64_t stage_count) {
+  ScheduleCycleMap cycle_map;
+  int64_t index = 0;
+  for (Node* node : TopoSort(f)) {
+    cycle_map[node] = node->Is<Param>()
+                          ? 0
+                          : index * stage_count / f->node_count();
+    ++index;
+  }
+  return PipelineSchedule(f, cycle_map, stage_count);
+}
+
+Design BuildDesign(const DesignSize& size) {
+  Design design;
+  design.package = std::make_unique<Package>("synthetic");
+  for (int64_t i = 0; i < size.pipeline_count; ++i) {
+    Function* f = BuildSyntheticFunction(absl::StrCat("pipeline", i), size,
+                                         design.package.get());
+    design.functions.push_back(f);
+    design.schedules.push_back(ScheduleEvenly(f, size.stage_count));
+  }
+  return design;
+}
+
+std::vector<Block*> ConvertToBlocks(const Design& design,
+                                    const CodegenOptions& options) {
+  std::vector<Block*> blocks;
+  for (int64_t i = 0; i < design.functions.size(); ++i) {
+    blocks.push_back(FunctionToPipelinedBlock(design.schedules[i], options,
+                                              design.functions[i])
+                         .value());
+  }
+  return blocks;
+}
+
+void RunCodegenPasses(const Design& design, const CodegenOptions& options,
+                      absl::Span<Block* const> blocks) {
+  for (int64_t i = 0; i < blocks.size(); ++i) {
+    CodegenPassOptions pass_options;
+    pass_options.codegen_options = options;
+    pass_options.schedule = design.schedules[i];
+    CodegenPassUnit unit(design.package.get(), blocks[i]);
+    PassResults results;
+    XLS_CHECK_OK(
+        CreateCodegenPassPipeline()->Run(&unit, pass_options, &results)
+            .status());
+  }
+}
+
+void RemoveBlocks(Package* package) {
+  std::vector<Block*> blocks(package->blocks().size());
+  for (int64_t i = 0; i < blocks.size(); ++i) {
+    blocks[i] = package->blocks()[i].get();
+  }
+  for (Block* block : blocks) {
+    XLS_CHECK_OK(package->RemoveBlock(block));
+  }
+}
+
+// Returns a block instantiating each of `blocks` with its inputs and outputs
+// connected to ports of the block.
+Block* BuildTopBlock(absl::Span<Block* const> blocks, Package* package) {
+  BlockBuilder bb("top", package);
+  XLS_CHECK_OK(bb.block()->AddClockPort("clk"));
+  for (Block* block : blocks) {
+    Instantiation* instantiation =
+        bb.block()
+            ->AddBlockInstantiation(absl::StrCat(block->name(), "_inst"),
+                                    block)
+            .value();
+    for (InputPort* port : block->GetInputPorts()) {
+      bb.InstantiationInput(
+          instantiation, port->GetName(),
+          bb.InputPort(absl::StrCat(block->name(), "_", port->GetName()),
+                       port->GetType()));
+    }
+    for (OutputPort* port : block->GetOutputPorts()) {
+      bb.OutputPort(absl::StrCat(block->name(), "_", port->GetName()),
+                    bb.InstantiationOutput(instantiation, port->GetName()));
+    }
+  }
+  return bb.Build().value();
+}
+
+void SetCounters(benchmark::State& state, const DesignSize& size) {
+  state.counters["nodes"] = size.node_count;
+  state.counters["stages"] = size.stage_count;
+  state.counters["bit_width"] = size.bit_width;
+  state.counters["pipelines"] = size.pipeline_count;
+  state.counters["peak_rss_mb"] =
+      static_cast<double>(GetPeakRssBytes()) / (1024 * 1024);
+}
+
+void BM_BlockConversion(benchmark::State& state) {
+  DesignSize size = GetDesignSize(state);
+  Design design = BuildDesign(size);
+  CodegenOptions options = BuildPipelineOptions();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ConvertToBlocks(design, options));
+    state.PauseTiming();
+    RemoveBlocks(design.package.get());
+    state.ResumeTiming();
+  }
+  SetCounters(state, size);
+}
+
+void BM_CodegenPasses(benchmark::State& state) {
+  DesignSize size = GetDesignSize(state);
+  Design design = BuildDesign(size);
+  CodegenOptions options = BuildPipelineOptions();
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<Block*> blocks = ConvertToBlocks(design, options);
+    state.ResumeTiming();
+    RunCodegenPasses(design, options, blocks);
+    state.PauseTiming();
+    RemoveBlocks(design.package.get());
+    state.ResumeTiming();
+  }
+  SetCounters(state, size);
+}
+
+void BM_GenerateVerilog(benchmark::State& state) {
+  DesignSize size = GetDesignSize(state);
+  Design design = BuildDesign(size);
+  CodegenOptions options = BuildPipelineOptions();
+  std::vector<Block*> blocks = ConvertToBlocks(design, options);
+  RunCodegenPasses(design, options, blocks);
+  Block* top = BuildTopBlock(blocks, design.package.get());
+
+  PassResults results;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        GenerateVerilog(top, options, /*verilog_line_map=*/nullptr, &results)
+            .value());
+  }
+  // Report the average time per iteration of the phases of Verilog
+  // generation.
+  absl::Duration vast_construction;
+  absl::Duration verilog_emission;
+  for (const PhaseTiming& phase : results.phases) {
+    if (phase.name == "vast_construction") {
+      vast_construction += phase.duration;
+    } else if (phase.name == "verilog_emission") {
+      verilog_emission += phase.duration;
+    }
+  }
+  state.counters["vast_construction_ms"] =
+      absl::ToDoubleMilliseconds(vast_construction) / state.iterations();
+  state.counters["verilog_emission_ms"] =
+      absl::ToDoubleMilliseconds(verilog_emission) / state.iterations();
+  SetCounters(state, size);
+}
+
+// Registers the design sizes: {nodes, stages, bit width, pipelines}.
+void DesignSizes(benchmark::internal::Benchmark* b) {
+  for (int64_t node_count : {1000, 10000, 100000}) {
+    for (int64_t stage_count : {4, 32}) {
+      b->Args({node_count, stage_count, /*bit_width=*/32,
+               /*pipeline_count=*/1});
+    }
+  }
+  // Wide values.
+  b->Args({10000, 4, /*bit_width=*/512, /*pipeline_count=*/1});
+  // Many pipelines.
+  b->Args({10000, 4, /*bit_width=*/32, /*pipeline_count=*/8});
+}
+
+BENCHMARK(BM_BlockConversion)
+    ->Apply(DesignSizes)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CodegenPasses)
+    ->Apply(DesignSizes)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GenerateVerilog)
+    ->Apply(DesignSizes)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace xls::verilog
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  xls::InitXls(argv[0], argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
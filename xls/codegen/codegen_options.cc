@@ -50,7 +50,9 @@ CodegenOptions::CodegenOptions(const CodegenOptions& options)
       streaming_channel_ready_suffix_(options.streaming_channel_ready_suffix_),
       streaming_channel_valid_suffix_(options.streaming_channel_valid_suffix_),
       array_index_bounds_checking_(options.array_index_bounds_checking_),
-      gate_recvs_(options.gate_recvs_) {
+      gate_recvs_(options.gate_recvs_),
+      bdd_io_analysis_node_limit_(options.bdd_io_analysis_node_limit_),
+      merge_registers_(options.merge_registers_) {
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -81,6 +83,8 @@ CodegenOptions& CodegenOptions::operator=(const CodegenOptions& options) {
   streaming_channel_valid_suffix_ = options.streaming_channel_valid_suffix_;
   array_index_bounds_checking_ = options.array_index_bounds_checking_;
   gate_recvs_ = options.gate_recvs_;
+  bdd_io_analysis_node_limit_ = options.bdd_io_analysis_node_limit_;
+  merge_registers_ = options.merge_registers_;
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -247,6 +251,16 @@ CodegenOptions& CodegenOptions::gate_recvs(bool value) {
   return *this;
 }
 
+CodegenOptions& CodegenOptions::bdd_io_analysis_node_limit(int64_t value) {
+  bdd_io_analysis_node_limit_ = value;
+  return *this;
+}
+
+CodegenOptions& CodegenOptions::merge_registers(bool value) {
+  merge_registers_ = value;
+  return *this;
+}
+
 CodegenOptions& CodegenOptions::ram_configurations(
     absl::Span<const std::unique_ptr<RamConfiguration>> ram_configurations) {
   ram_configurations_.clear();
@@ -220,6 +220,21 @@ class CodegenOptions {
   CodegenOptions& gate_recvs(bool value);
   bool gate_recvs() const { return gate_recvs_; }
 
+  // The maximum number of nodes in the BDD used to determine whether the
+  // streaming outputs of a proc are mutually exclusive. If the limit is
+  // exceeded the outputs are conservatively assumed not to be mutually
+  // exclusive. If not set, a default limit is used.
+  CodegenOptions& bdd_io_analysis_node_limit(int64_t value);
+  std::optional<int64_t> bdd_io_analysis_node_limit() const {
+    return bdd_io_analysis_node_limit_;
+  }
+
+  // Merge registers which are written with identical inputs and remove
+  // registers which always hold the same constant value. This reduces area and
+  // the size of the emitted Verilog.
+  CodegenOptions& merge_registers(bool value);
+  bool merge_registers() const { return merge_registers_; }
+
   // List of channels to rewrite for RAMs.
   CodegenOptions& ram_configurations(
       absl::Span<const std::unique_ptr<RamConfiguration>> ram_configurations);
@@ -250,6 +265,8 @@ class CodegenOptions {
   std::string streaming_channel_valid_suffix_ = "_vld";
   bool array_index_bounds_checking_ = true;
   bool gate_recvs_ = true;
+  std::optional<int64_t> bdd_io_analysis_node_limit_;
+  bool merge_registers_ = false;
   std::vector<std::unique_ptr<RamConfiguration>> ram_configurations_;
 };
 
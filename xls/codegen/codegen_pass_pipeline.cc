@@ -24,6 +24,7 @@
 #include "xls/codegen/port_legalization_pass.h"
 #include "xls/codegen/ram_rewrite_pass.h"
 #include "xls/codegen/register_legalization_pass.h"
+#include "xls/codegen/register_merging_pass.h"
 #include "xls/codegen/signature_generation_pass.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/identity_removal_pass.h"
@@ -58,6 +59,9 @@ std::unique_ptr<CodegenCompoundPass> CreateCodegenPassPipeline() {
   // Remove zero-width registers.
   top->Add<RegisterLegalizationPass>();
 
+  // Merge duplicate registers and remove registers carrying constants.
+  top->Add<RegisterMergingPass>();
+
   // Eliminate no-longer-needed partial product operations by turning them into
   // normal multiplies.
   top->Add<MulpCombiningPass>();
@@ -48,16 +48,21 @@ namespace xls {
 namespace verilog {
 
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
-    FunctionBase* module, const CodegenOptions& options) {
+    FunctionBase* module, const CodegenOptions& options,
+    PassResults* pass_results) {
   Block* block = nullptr;
 
   XLS_RET_CHECK(module->IsProc() || module->IsFunction());
-  if (module->IsFunction()) {
-    XLS_ASSIGN_OR_RETURN(block, FunctionToCombinationalBlock(
-                                    dynamic_cast<Function*>(module), options));
-  } else {
-    XLS_ASSIGN_OR_RETURN(
-        block, ProcToCombinationalBlock(dynamic_cast<Proc*>(module), options));
+  {
+    ScopedPhaseTimer timer(pass_results, "block_conversion");
+    if (module->IsFunction()) {
+      XLS_ASSIGN_OR_RETURN(block,
+                           FunctionToCombinationalBlock(
+                               dynamic_cast<Function*>(module), options));
+    } else {
+      XLS_ASSIGN_OR_RETURN(block, ProcToCombinationalBlock(
+                                      dynamic_cast<Proc*>(module), options));
+    }
   }
 
   CodegenPassUnit unit(module->package(), block);
@@ -67,12 +72,15 @@ absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
 
   PassResults results;
   XLS_RETURN_IF_ERROR(CreateCodegenPassPipeline()
-                          ->Run(&unit, codegen_pass_options, &results)
+                          ->Run(&unit, codegen_pass_options,
+                                pass_results == nullptr ? &results
+                                                        : pass_results)
                           .status());
   XLS_RET_CHECK(unit.signature.has_value());
   VerilogLineMap verilog_line_map;
-  XLS_ASSIGN_OR_RETURN(std::string verilog,
-                       GenerateVerilog(block, options, &verilog_line_map));
+  XLS_ASSIGN_OR_RETURN(
+      std::string verilog,
+      GenerateVerilog(block, options, &verilog_line_map, pass_results));
 
   return ModuleGeneratorResult{verilog, verilog_line_map,
                                unit.signature.value()};
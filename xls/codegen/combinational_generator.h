@@ -25,6 +25,7 @@
 #include "xls/codegen/vast.h"
 #include "xls/ir/function.h"
 #include "xls/ir/proc.h"
+#include "xls/passes/pass_base.h"
 
 namespace xls {
 namespace verilog {
@@ -33,8 +34,11 @@ namespace verilog {
 // use_system_verilog is true the generated module will be SystemVerilog
 // otherwise it will be Verilog. This adds a proc to the package which
 // represents the combinational module. This proc is used for code generation.
+// If `pass_results` is non-null the invocations of the codegen passes are
+// recorded in it.
 absl::StatusOr<ModuleGeneratorResult> GenerateCombinationalModule(
-    FunctionBase* func, const CodegenOptions& options);
+    FunctionBase* func, const CodegenOptions& options,
+    PassResults* pass_results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
@@ -14,30 +14,38 @@
 
 #include "xls/codegen/flattening.h"
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
-#include "xls/ir/bits_ops.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/package.h"
 
 namespace xls {
 
-// Gathers the Bits objects at the leaves of the Value.
-static void GatherValueLeaves(const Value& value, std::vector<Bits>* leaves) {
+// Pushes the leaves of `value` into `rope` from the least significant leaf in
+// the flattened representation to the most significant. Leaves are copied a
+// word at a time.
+static void PushValueLeaves(const Value& value, BitsRope* rope) {
   switch (value.kind()) {
     case ValueKind::kBits:
-      leaves->push_back(value.bits());
+      rope->push_back(value.bits());
       break;
     case ValueKind::kTuple:
-      for (const Value& e : value.elements()) {
-        GatherValueLeaves(e, leaves);
+      // The zero-th tuple element ends up in the most significant bits.
+      for (int64_t i = value.size() - 1; i >= 0; --i) {
+        PushValueLeaves(value.element(i), rope);
       }
       break;
     case ValueKind::kArray:
-      for (int64_t i = value.size() - 1; i >= 0; --i) {
-        GatherValueLeaves(value.element(i), leaves);
+      // The last array element ends up in the most significant bits.
+      for (const Value& e : value.elements()) {
+        PushValueLeaves(e, rope);
       }
       break;
     default:
@@ -46,45 +54,45 @@ static void GatherValueLeaves(const Value& value, std::vector<Bits>* leaves) {
 }
 
 Bits FlattenValueToBits(const Value& value) {
-  std::vector<Bits> leaves;
-  GatherValueLeaves(value, &leaves);
-  return bits_ops::Concat(leaves);
+  BitsRope rope(value.GetFlatBitCount());
+  PushValueLeaves(value, &rope);
+  return rope.Build();
 }
 
-absl::StatusOr<Value> UnflattenBitsToValue(const Bits& bits, const Type* type) {
-  if (bits.bit_count() != type->GetFlatBitCount()) {
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Cannot unflatten input. Has %d bits, expected %d bits",
-                        bits.bit_count(), type->GetFlatBitCount()));
-  }
+// Returns the value of type `type` whose flattened representation is the
+// bits of `bits` starting at `offset`. Element offsets are computed in a
+// single pass over each aggregate and leaves are sliced a word at a time.
+static absl::StatusOr<Value> UnflattenBitsToValueAt(const Bits& bits,
+                                                    int64_t offset,
+                                                    const Type* type) {
   if (type->IsBits()) {
-    return Value(bits);
+    return Value(bits.Slice(offset, type->GetFlatBitCount()));
   }
   if (type->IsTuple()) {
-    std::vector<Value> elements;
     const TupleType* tuple_type = type->AsTupleOrDie();
-    for (int64_t i = 0; i < tuple_type->size(); ++i) {
+    std::vector<Value> elements(tuple_type->size());
+    int64_t element_offset = offset;
+    for (int64_t i = tuple_type->size() - 1; i >= 0; --i) {
       Type* element_type = tuple_type->element_type(i);
       XLS_ASSIGN_OR_RETURN(
-          Value element, UnflattenBitsToValue(
-                             bits.Slice(GetFlatBitIndexOfElement(tuple_type, i),
-                                        element_type->GetFlatBitCount()),
-                             element_type));
-      elements.push_back(element);
+          elements[i],
+          UnflattenBitsToValueAt(bits, element_offset, element_type));
+      element_offset += element_type->GetFlatBitCount();
     }
     return Value::Tuple(elements);
   }
   if (type->IsArray()) {
-    std::vector<Value> elements;
     const ArrayType* array_type = type->AsArrayOrDie();
+    const int64_t element_width =
+        array_type->element_type()->GetFlatBitCount();
+    std::vector<Value> elements;
+    elements.reserve(array_type->size());
     for (int64_t i = 0; i < array_type->size(); ++i) {
       XLS_ASSIGN_OR_RETURN(
           Value element,
-          UnflattenBitsToValue(
-              bits.Slice(GetFlatBitIndexOfElement(array_type, i),
-                         array_type->element_type()->GetFlatBitCount()),
-              array_type->element_type()));
-      elements.push_back(element);
+          UnflattenBitsToValueAt(bits, offset + i * element_width,
+                                 array_type->element_type()));
+      elements.push_back(std::move(element));
     }
     return Value::Array(elements);
   }
@@ -92,6 +100,18 @@ absl::StatusOr<Value> UnflattenBitsToValue(const Bits& bits, const Type* type) {
       absl::StrFormat("Invalid type: %s", type->ToString()));
 }
 
+absl::StatusOr<Value> UnflattenBitsToValue(const Bits& bits, const Type* type) {
+  if (bits.bit_count() != type->GetFlatBitCount()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Cannot unflatten input. Has %d bits, expected %d bits",
+                        bits.bit_count(), type->GetFlatBitCount()));
+  }
+  if (type->IsBits()) {
+    return Value(bits);
+  }
+  return UnflattenBitsToValueAt(bits, /*offset=*/0, type);
+}
+
 absl::StatusOr<Value> UnflattenBitsToValue(const Bits& bits,
                                            const TypeProto& type_proto) {
   // Create a dummy package for converting  a TypeProto into a Type*.
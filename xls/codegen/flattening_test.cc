@@ -14,6 +14,9 @@
 
 #include "xls/codegen/flattening.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
@@ -109,6 +112,25 @@ TEST_F(FlatteningTest, FlattenValues) {
               IsOkAndHolds(abc_array));
 }
 
+TEST_F(FlatteningTest, FlattenWideValues) {
+  Package p(TestName());
+
+  // Leaves which straddle 64-bit word boundaries of the flattened value.
+  std::vector<Value> elements;
+  for (int64_t i = 0; i < 5; ++i) {
+    elements.push_back(Value(UBits(0x1234567890ULL * (i + 1), 37)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value array, Value::Array(elements));
+  Value tuple = Value::Tuple({Value(UBits(1, 3)), array, Value(UBits(5, 70))});
+
+  Bits flattened = FlattenValueToBits(tuple);
+  ASSERT_EQ(flattened.bit_count(), 3 + 5 * 37 + 70);
+  EXPECT_EQ(flattened.Slice(70 + 2 * 37, 37), elements[2].bits());
+  EXPECT_EQ(flattened.Slice(70 + 5 * 37, 3), UBits(1, 3));
+  EXPECT_THAT(UnflattenBitsToValue(flattened, p.GetTypeForValue(tuple)),
+              IsOkAndHolds(tuple));
+}
+
 TEST_F(FlatteningTest, ExpressionFlattening) {
   Package p(TestName());
   Type* b5 = p.GetBitsType(5);
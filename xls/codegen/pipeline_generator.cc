@@ -33,14 +33,14 @@ namespace verilog {
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, Function* func,
-    const CodegenOptions& options) {
+    const CodegenOptions& options, PassResults* pass_results) {
   return ToPipelineModuleText(schedule, static_cast<FunctionBase*>(func),
-                              options);
+                              options, pass_results);
 }
 
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
-    const CodegenOptions& options) {
+    const CodegenOptions& options, PassResults* pass_results) {
   XLS_VLOG(2) << "Generating pipelined module for module:";
   XLS_VLOG_LINES(2, module->DumpIr());
   XLS_VLOG_LINES(2, schedule.ToString());
@@ -53,29 +53,37 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
 
   XLS_RET_CHECK(module->IsProc() || module->IsFunction());
   // Convert to block and add in pipe stages according to schedule.
-  if (module->IsFunction()) {
-    Function* func = module->AsFunctionOrDie();
-    XLS_ASSIGN_OR_RETURN(block,
-                         FunctionToPipelinedBlock(schedule, options, func));
-  } else {
-    Proc* proc = module->AsProcOrDie();
-    XLS_ASSIGN_OR_RETURN(block, ProcToPipelinedBlock(schedule, options, proc));
+  {
+    ScopedPhaseTimer timer(pass_results, "block_conversion");
+    if (module->IsFunction()) {
+      Function* func = module->AsFunctionOrDie();
+      XLS_ASSIGN_OR_RETURN(block,
+                           FunctionToPipelinedBlock(schedule, options, func));
+    } else {
+      Proc* proc = module->AsProcOrDie();
+      XLS_ASSIGN_OR_RETURN(block,
+                           ProcToPipelinedBlock(schedule, options, proc));
 
-    // Force using non-pretty printed codegen when generating procs.
-    // TODO(tedhong): 2021-09-25 - Update pretty-printer to support
-    //  blocks with flow control.
-    pass_options.codegen_options.emit_as_pipeline(false);
+      // Force using non-pretty printed codegen when generating procs.
+      // TODO(tedhong): 2021-09-25 - Update pretty-printer to support
+      //  blocks with flow control.
+      pass_options.codegen_options.emit_as_pipeline(false);
+    }
   }
 
   CodegenPassUnit unit(module->package(), block);
   PassResults results;
-  XLS_RETURN_IF_ERROR(
-      CreateCodegenPassPipeline()->Run(&unit, pass_options, &results).status());
+  XLS_RETURN_IF_ERROR(CreateCodegenPassPipeline()
+                          ->Run(&unit, pass_options,
+                                pass_results == nullptr ? &results
+                                                        : pass_results)
+                          .status());
   XLS_RET_CHECK(unit.signature.has_value());
   VerilogLineMap verilog_line_map;
   XLS_ASSIGN_OR_RETURN(
       std::string verilog,
-      GenerateVerilog(block, pass_options.codegen_options, &verilog_line_map));
+      GenerateVerilog(block, pass_options.codegen_options, &verilog_line_map,
+                      pass_results));
 
   return ModuleGeneratorResult{verilog, verilog_line_map,
                                unit.signature.value()};
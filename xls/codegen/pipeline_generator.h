@@ -25,6 +25,7 @@
 #include "xls/codegen/name_to_bit_count.h"
 #include "xls/codegen/vast.h"
 #include "xls/ir/function.h"
+#include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
 namespace xls {
@@ -41,17 +42,21 @@ inline CodegenOptions BuildPipelineOptions() {
 
 // Emits the given function as a verilog module which follows the given
 // schedule. The module is pipelined with a latency and initiation interval
-// given in the signature.
+// given in the signature. If `pass_results` is non-null the invocations of the
+// codegen passes are recorded in it.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, Function* func,
-    const CodegenOptions& options = BuildPipelineOptions());
+    const CodegenOptions& options = BuildPipelineOptions(),
+    PassResults* pass_results = nullptr);
 
 // Emits the given function or proc as a verilog module which follows the given
 // schedule. The module is pipelined with a latency and initiation interval
-// given in the signature.
+// given in the signature. If `pass_results` is non-null the invocations of the
+// codegen passes are recorded in it.
 absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const PipelineSchedule& schedule, FunctionBase* module,
-    const CodegenOptions& options = BuildPipelineOptions());
+    const CodegenOptions& options = BuildPipelineOptions(),
+    PassResults* pass_results = nullptr);
 
 }  // namespace verilog
 }  // namespace xls
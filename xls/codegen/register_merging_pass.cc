@@ -0,0 +1,151 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/register_merging_pass.h"
+
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/block.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls::verilog {
+namespace {
+
+bool SameReset(const std::optional<Reset>& a, const std::optional<Reset>& b) {
+  if (!a.has_value() || !b.has_value()) {
+    return a.has_value() == b.has_value();
+  }
+  return a->reset_value == b->reset_value &&
+         a->asynchronous == b->asynchronous && a->active_low == b->active_low;
+}
+
+// Replaces the uses of the value of register `reg` with `replacement` and
+// removes the register along with its read and write.
+absl::Status ReplaceRegister(Block* block, Register* reg, Node* replacement) {
+  XLS_ASSIGN_OR_RETURN(RegisterRead * reg_read, block->GetRegisterRead(reg));
+  XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                       block->GetRegisterWrite(reg));
+  XLS_RETURN_IF_ERROR(reg_read->ReplaceUsesWith(replacement));
+  XLS_RETURN_IF_ERROR(block->RemoveNode(reg_read));
+  XLS_RETURN_IF_ERROR(block->RemoveNode(reg_write));
+  return block->RemoveRegister(reg);
+}
+
+// Merges registers which are written with the same data, load enable and
+// reset signals and have the same reset behavior. Such registers always hold
+// the same value. The earliest such register is kept.
+absl::StatusOr<bool> MergeDuplicateRegisters(Block* block) {
+  using WriteKey =
+      std::tuple<Node*, std::optional<Node*>, std::optional<Node*>>;
+  absl::flat_hash_map<WriteKey, std::vector<Register*>> candidates;
+  std::vector<std::pair<Register*, Register*>> merges;
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    std::vector<Register*>& same_inputs = candidates[WriteKey(
+        reg_write->data(), reg_write->load_enable(), reg_write->reset())];
+    bool merged = false;
+    for (Register* kept : same_inputs) {
+      if (SameReset(kept->reset(), reg->reset())) {
+        merges.push_back({reg, kept});
+        merged = true;
+        break;
+      }
+    }
+    if (!merged) {
+      same_inputs.push_back(reg);
+    }
+  }
+  for (auto [reg, kept] : merges) {
+    XLS_VLOG(3) << "Merging register " << reg->name() << " into "
+                << kept->name();
+    XLS_ASSIGN_OR_RETURN(RegisterRead * kept_read,
+                         block->GetRegisterRead(kept));
+    XLS_RETURN_IF_ERROR(ReplaceRegister(block, reg, kept_read));
+  }
+  return !merges.empty();
+}
+
+// Replaces registers which always hold the same value with that value. This
+// is the case if the data written to the register is known to be a constant
+// and the register has no reset or resets to the same constant. A register
+// without a reset holds an arbitrary value before it is first written which
+// the constant refines.
+absl::StatusOr<bool> RemoveConstantRegisters(Block* block) {
+  TernaryQueryEngine query_engine;
+  XLS_RETURN_IF_ERROR(query_engine.Populate(block).status());
+  std::vector<std::pair<Register*, Value>> constants;
+  for (Register* reg : block->GetRegisters()) {
+    if (!reg->type()->IsBits()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    if (!query_engine.AllBitsKnown(reg_write->data())) {
+      continue;
+    }
+    Value value(query_engine.MaxUnsignedValue(reg_write->data()));
+    if (reg->reset().has_value() && reg->reset()->reset_value != value) {
+      continue;
+    }
+    constants.push_back({reg, value});
+  }
+  for (const auto& [reg, value] : constants) {
+    XLS_VLOG(3) << "Replacing register " << reg->name() << " with constant "
+                << value;
+    XLS_ASSIGN_OR_RETURN(RegisterRead * reg_read, block->GetRegisterRead(reg));
+    XLS_ASSIGN_OR_RETURN(
+        Node * literal,
+        block->MakeNode<xls::Literal>(reg_read->loc(), value));
+    XLS_RETURN_IF_ERROR(ReplaceRegister(block, reg, literal));
+  }
+  return !constants.empty();
+}
+
+}  // namespace
+
+absl::StatusOr<bool> RegisterMergingPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    PassResults* results) const {
+  if (!options.codegen_options.merge_registers()) {
+    return false;
+  }
+  Block* block = unit->block;
+  bool changed = false;
+  // Removing a register may make the registers downstream of it duplicates or
+  // constants, so iterate to a fixed point.
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(bool merged, MergeDuplicateRegisters(block));
+    XLS_ASSIGN_OR_RETURN(bool removed, RemoveConstantRegisters(block));
+    if (!merged && !removed) {
+      break;
+    }
+    changed = true;
+  }
+  return changed;
+}
+
+}  // namespace xls::verilog
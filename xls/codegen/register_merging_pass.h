@@ -0,0 +1,42 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CODEGEN_REGISTER_MERGING_PASS_H_
+#define XLS_CODEGEN_REGISTER_MERGING_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Removes redundant registers from the block. Registers which are written with
+// the same data, load enable and reset signals and have the same reset value
+// are merged into a single register. Registers whose data input is known to be
+// a constant (and whose reset value, if any, is the same constant) are
+// replaced by the constant. Only runs if the codegen option merge_registers is
+// set.
+class RegisterMergingPass : public CodegenPass {
+ public:
+  RegisterMergingPass()
+      : CodegenPass("register_merging", "Merge redundant registers") {}
+  ~RegisterMergingPass() override = default;
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   PassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_REGISTER_MERGING_PASS_H_
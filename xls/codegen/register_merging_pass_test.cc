@@ -0,0 +1,128 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/codegen/register_merging_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls::verilog {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::UnorderedElementsAre;
+
+class RegisterMergingPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Block* block) {
+    PassResults results;
+    CodegenPassUnit unit(block->package(), block);
+    CodegenPassOptions options;
+    options.codegen_options.merge_registers(true);
+    return RegisterMergingPass().Run(&unit, options, &results);
+  }
+};
+
+TEST_F(RegisterMergingPassTest, MergesDuplicateRegisters) {
+  auto p = CreatePackage();
+
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue b = bb.InputPort("b", p->GetBitsType(32));
+  BValue en = bb.InputPort("en", p->GetBitsType(1));
+  BValue a_reg0 = bb.InsertRegister("a_reg0", a);
+  BValue a_reg1 = bb.InsertRegister("a_reg1", a);
+  // Differs from a_reg0 in its load enable.
+  BValue a_reg2 = bb.InsertRegister("a_reg2", a, en);
+  BValue b_reg = bb.InsertRegister("b_reg", b);
+  bb.OutputPort("out0", bb.Add(a_reg0, b_reg));
+  bb.OutputPort("out1", bb.Add(a_reg1, a_reg2));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_THAT(block->GetRegisters(),
+              UnorderedElementsAre(block->GetRegister("a_reg0").value(),
+                                   block->GetRegister("a_reg2").value(),
+                                   block->GetRegister("b_reg").value()));
+  EXPECT_THAT(block->GetOutputPort("out1").value()->operand(0),
+              m::Add(m::RegisterRead("a_reg0"), m::RegisterRead("a_reg2")));
+
+  // Pass should be idempotent.
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+}
+
+TEST_F(RegisterMergingPassTest, DoesNotMergeRegistersWithDifferentResets) {
+  auto p = CreatePackage();
+
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue rst = bb.InputPort("rst", p->GetBitsType(1));
+  BValue a_reg0 = bb.InsertRegister(
+      "a_reg0", a, rst,
+      Reset{.reset_value = Value(UBits(0, 32)),
+            .asynchronous = false,
+            .active_low = false});
+  BValue a_reg1 = bb.InsertRegister(
+      "a_reg1", a, rst,
+      Reset{.reset_value = Value(UBits(1, 32)),
+            .asynchronous = false,
+            .active_low = false});
+  bb.OutputPort("out", bb.Add(a_reg0, a_reg1));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+  EXPECT_EQ(block->GetRegisters().size(), 2);
+}
+
+TEST_F(RegisterMergingPassTest, RemovesConstantRegisters) {
+  auto p = CreatePackage();
+
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(32));
+  BValue rst = bb.InputPort("rst", p->GetBitsType(1));
+  BValue c = bb.Literal(UBits(42, 32));
+  BValue c_reg = bb.InsertRegister("c_reg", c);
+  // The register downstream becomes constant once c_reg is removed.
+  BValue c_reg2 = bb.InsertRegister("c_reg2", bb.Not(c_reg));
+  // Resets to a different value so may not be removed.
+  BValue c_reg3 = bb.InsertRegister(
+      "c_reg3", c, rst,
+      Reset{.reset_value = Value(UBits(0, 32)),
+            .asynchronous = false,
+            .active_low = false});
+  BValue a_reg = bb.InsertRegister("a_reg", a);
+  bb.OutputPort("out0", bb.Add(a_reg, c_reg2));
+  bb.OutputPort("out1", c_reg3);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_THAT(block->GetRegisters(),
+              UnorderedElementsAre(block->GetRegister("a_reg").value(),
+                                   block->GetRegister("c_reg3").value()));
+  EXPECT_THAT(block->GetOutputPort("out0").value()->operand(0),
+              m::Add(m::RegisterRead("a_reg"), m::Literal(~uint32_t{42})));
+}
+
+}  // namespace
+}  // namespace xls::verilog
@@ -14,6 +14,11 @@
 
 #include "xls/codegen/vast.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
@@ -60,6 +65,26 @@ void LineInfoIncrease(LineInfo* line_info, int64_t delta) {
 
 }  // namespace
 
+void VastWriter::Write(std::string_view text) {
+  while (!text.empty()) {
+    size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    if (!line.empty()) {
+      if (at_line_start_) {
+        out_->append(indent_, ' ');
+      }
+      absl::StrAppend(out_, line);
+      at_line_start_ = false;
+    }
+    if (newline == std::string_view::npos) {
+      return;
+    }
+    out_->push_back('\n');
+    at_line_start_ = true;
+    text.remove_prefix(newline + 1);
+  }
+}
+
 std::string PartialLineSpans::ToString() const {
   return absl::StrCat(
       "[",
@@ -205,18 +230,12 @@ DataType* VerilogFile::UnpackedArrayType(int64_t element_bit_count,
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit(
-        Visitor{[=](Include* m) -> std::string { return m->Emit(line_info); },
-                [=](Module* m) -> std::string { return m->Emit(line_info); },
-                [=](BlankLine* m) -> std::string { return m->Emit(line_info); },
-                [=](Comment* m) -> std::string { return m->Emit(line_info); }},
-        member);
-  };
-
   std::string out;
+  VastWriter writer(&out);
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    absl::visit([&](VastNode* node) { node->EmitTo(line_info, &writer); },
+                member);
+    writer.Write("\n");
     LineInfoIncrease(line_info, 1);
   }
   return out;
@@ -539,48 +558,31 @@ std::string RegDef::Emit(LineInfo* line_info) const {
   return result;
 }
 
-namespace {
-
-// "Match" statement for emitting a ModuleMember.
-std::string EmitModuleMember(LineInfo* line_info, const ModuleMember& member) {
-  return absl::visit(
-      Visitor{[=](Def* d) { return d->Emit(line_info); },
-              [=](LocalParam* p) { return p->Emit(line_info); },
-              [=](Parameter* p) { return p->Emit(line_info); },
-              [=](Instantiation* i) { return i->Emit(line_info); },
-              [=](ContinuousAssignment* c) { return c->Emit(line_info); },
-              [=](Comment* c) { return c->Emit(line_info); },
-              [=](BlankLine* b) { return b->Emit(line_info); },
-              [=](InlineVerilogStatement* s) { return s->Emit(line_info); },
-              [=](StructuredProcedure* sp) { return sp->Emit(line_info); },
-              [=](AlwaysComb* ac) { return ac->Emit(line_info); },
-              [=](AlwaysFf* af) { return af->Emit(line_info); },
-              [=](AlwaysFlop* af) { return af->Emit(line_info); },
-              [=](VerilogFunction* f) { return f->Emit(line_info); },
-              [=](Cover* c) { return c->Emit(line_info); },
-              [=](ModuleSection* s) { return s->Emit(line_info); }},
-      member);
+std::string ModuleSection::Emit(LineInfo* line_info) const {
+  std::string result;
+  VastWriter writer(&result);
+  EmitTo(line_info, &writer);
+  return result;
 }
 
-}  // namespace
-
-std::string ModuleSection::Emit(LineInfo* line_info) const {
+void ModuleSection::EmitTo(LineInfo* line_info, VastWriter* writer) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  bool first = true;
   for (const ModuleMember& member : members_) {
     if (std::holds_alternative<ModuleSection*>(member)) {
       if (std::get<ModuleSection*>(member)->members_.empty()) {
         continue;
       }
     }
-    elements.push_back(EmitModuleMember(line_info, member));
-    LineInfoIncrease(line_info, 1);
-  }
-  if (!elements.empty()) {
-    LineInfoIncrease(line_info, -1);
+    if (!first) {
+      writer->Write("\n");
+      LineInfoIncrease(line_info, 1);
+    }
+    first = false;
+    absl::visit([&](VastNode* node) { node->EmitTo(line_info, writer); },
+                member);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string ContinuousAssignment::Emit(LineInfo* line_info) const {
@@ -675,6 +677,13 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  std::string result;
+  VastWriter writer(&result);
+  EmitTo(line_info, &writer);
+  return result;
+}
+
+void Module::EmitTo(LineInfo* line_info, VastWriter* writer) const {
   LineInfoStart(line_info, this);
   std::string result = absl::StrCat("module ", name_);
   if (ports_.empty()) {
@@ -693,11 +702,13 @@ std::string Module::Emit(LineInfo* line_info) const {
     absl::StrAppend(&result, "\n);\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  writer->Write(result);
+  writer->Indent();
+  top_.EmitTo(line_info, writer);
+  writer->Dedent();
+  writer->Write("\nendmodule");
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Literal::Emit(LineInfo* line_info) const {
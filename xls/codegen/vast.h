@@ -21,6 +21,7 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -30,6 +31,7 @@
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
 #include "xls/codegen/module_signature.pb.h"
+#include "xls/common/arena.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/source_location.h"
@@ -144,6 +146,31 @@ class LineInfo {
 // characters are replaced with '_'.
 std::string SanitizeIdentifier(std::string_view name);
 
+// Accumulates emitted text into a single output string, indenting lines as
+// they are written. Large constructs (files, modules, module sections) stream
+// their children through a writer rather than concatenating and re-indenting
+// intermediate strings at every level of nesting.
+class VastWriter {
+ public:
+  explicit VastWriter(std::string* out) : out_(out) {}
+
+  // Appends `text`. Every non-empty line begun by `text` is prefixed with the
+  // current indentation; empty lines are not indented (no trailing spaces).
+  void Write(std::string_view text);
+
+  // Increases/decreases the indentation applied to subsequently begun lines.
+  void Indent(int64_t spaces = 2) { indent_ += spaces; }
+  void Dedent(int64_t spaces = 2) {
+    XLS_CHECK_GE(indent_, spaces);
+    indent_ -= spaces;
+  }
+
+ private:
+  std::string* out_;
+  int64_t indent_ = 0;
+  bool at_line_start_ = true;
+};
+
 // Base type for a VAST node. All nodes are owned by a VerilogFile.
 class VastNode {
  public:
@@ -158,6 +185,12 @@ class VastNode {
 
   virtual std::string Emit(LineInfo* line_info) const = 0;
 
+  // Writes the same text as Emit() into `writer`. Nodes with many children
+  // override this to stream them instead of building the text up front.
+  virtual void EmitTo(LineInfo* line_info, VastWriter* writer) const {
+    writer->Write(Emit(line_info));
+  }
+
  private:
   VerilogFile* file_;
   SourceInfo loc_;
@@ -1466,6 +1499,7 @@ class ModuleSection : public VastNode {
   std::vector<ModuleMember> GatherMembers() const;
 
   std::string Emit(LineInfo* line_info) const override;
+  void EmitTo(LineInfo* line_info, VastWriter* writer) const override;
 
  private:
   std::vector<ModuleMember> members_;
@@ -1529,6 +1563,7 @@ class Module : public VastNode {
   const std::string& name() const { return name_; }
 
   std::string Emit(LineInfo* line_info) const override;
+  void EmitTo(LineInfo* line_info, VastWriter* writer) const override;
 
  private:
   // Add the given Def as a port on the module.
@@ -1561,6 +1596,10 @@ class VerilogFile {
  public:
   explicit VerilogFile(FileType file_type) : file_type_(file_type) {}
 
+  // Nodes refer back to their file, so it can be neither copied nor moved.
+  VerilogFile(const VerilogFile&) = delete;
+  VerilogFile& operator=(const VerilogFile&) = delete;
+
   Module* AddModule(std::string_view name, const SourceInfo& loc) {
     return Add(Make<Module>(loc, name));
   }
@@ -1576,11 +1615,7 @@ class VerilogFile {
 
   template <typename T, typename... Args>
   T* Make(const SourceInfo& loc, Args&&... args) {
-    std::unique_ptr<T> value =
-        std::make_unique<T>(std::forward<Args>(args)..., this, loc);
-    T* ptr = value.get();
-    nodes_.push_back(std::move(value));
-    return ptr;
+    return node_arena_.New<T>(std::forward<Args>(args)..., this, loc);
   }
 
   std::string Emit(LineInfo* line_info = nullptr) const;
@@ -1828,7 +1863,11 @@ class VerilogFile {
 
   FileType file_type_;
   std::vector<FileMember> members_;
-  std::vector<std::unique_ptr<VastNode>> nodes_;
+
+  // Owns the nodes. Codegen makes a very large number of small nodes, hence
+  // the large blocks. Declared last so the nodes are destroyed before the
+  // other members.
+  Arena node_arena_{/*block_size=*/64 * 1024};
 };
 
 template <typename T, typename... Args>
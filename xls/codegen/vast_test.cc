@@ -1207,6 +1207,20 @@ endmodule)");
             std::vector<LineSpan>{LineSpan(7, 7)});
 }
 
+TEST_P(VastTest, WriterIndentsBegunLines) {
+  std::string out;
+  VastWriter writer(&out);
+  writer.Write("a\n");
+  writer.Indent();
+  writer.Write("b\n\nc");
+  writer.Write(" continued\n");
+  writer.Indent();
+  writer.Write("d");
+  writer.Dedent(4);
+  writer.Write("\ne");
+  EXPECT_EQ(out, "a\n  b\n\n  c continued\n    d\ne");
+}
+
 TEST_P(VastTest, VerilogFunction) {
   VerilogFile f(GetFileType());
   Module* m = f.AddModule("top", SourceInfo());
@@ -0,0 +1,58 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/arena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace xls {
+namespace {
+
+char* AlignUp(char* p, size_t alignment) {
+  uintptr_t value = reinterpret_cast<uintptr_t>(p);
+  return reinterpret_cast<char*>((value + alignment - 1) & ~(alignment - 1));
+}
+
+}  // namespace
+
+Arena::~Arena() {
+  for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+    it->destroy(it->object);
+  }
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  if (cursor_ != nullptr) {
+    char* start = AlignUp(cursor_, alignment);
+    if (start + size <= end_) {
+      cursor_ = start + size;
+      return start;
+    }
+  }
+  size_t block_size = size + alignment;
+  if (block_size > block_size_) {
+    // Give the allocation a block of its own and keep filling the current one.
+    blocks_.push_back(std::unique_ptr<char[]>(new char[block_size]));
+    return AlignUp(blocks_.back().get(), alignment);
+  }
+  blocks_.push_back(std::unique_ptr<char[]>(new char[block_size_]));
+  char* start = AlignUp(blocks_.back().get(), alignment);
+  cursor_ = start + size;
+  end_ = blocks_.back().get() + block_size_;
+  return start;
+}
+
+}  // namespace xls
@@ -0,0 +1,82 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_ARENA_H_
+#define XLS_COMMON_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xls {
+
+// Owns objects constructed in place in large blocks of memory rather than
+// allocated one by one, so building and tearing down a graph of many small
+// objects (e.g., the nodes of a syntax tree) touches the allocator once per
+// block. Objects live until the arena is destroyed, which destroys them in the
+// reverse order of their creation. Not thread-safe.
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 32 * 1024;
+
+  // Allocations which do not fit in `block_size` bytes get a block of their
+  // own.
+  explicit Arena(size_t block_size = kDefaultBlockSize)
+      : block_size_(block_size) {}
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Constructs a T from `args` in the arena.
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    void* storage = Allocate(sizeof(T), alignof(T));
+    T* object = new (storage) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors_.push_back(
+          {object, [](void* p) { static_cast<T*>(p)->~T(); }});
+    }
+    return object;
+  }
+
+  // Returns uninitialized storage of `size` bytes aligned to `alignment`, which
+  // must be a power of two. The storage lives as long as the arena.
+  void* Allocate(size_t size, size_t alignment);
+
+  // Returns the number of blocks allocated so far.
+  int64_t block_count() const { return blocks_.size(); }
+
+ private:
+  struct Destructor {
+    void* object;
+    void (*destroy)(void*);
+  };
+
+  size_t block_size_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  // The free space of the current block.
+  char* cursor_ = nullptr;
+  char* end_ = nullptr;
+  // The objects created by New which need destroying, in creation order.
+  std::vector<Destructor> destructors_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_ARENA_H_
@@ -0,0 +1,112 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/arena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+bool IsAligned(const void* p, size_t alignment) {
+  return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+TEST(ArenaTest, Alignment) {
+  Arena arena(/*block_size=*/256);
+  for (size_t alignment : {1, 2, 4, 8, 16, 32, 64, 128}) {
+    // Misalign the cursor first.
+    arena.Allocate(1, 1);
+    void* p = arena.Allocate(24, alignment);
+    EXPECT_TRUE(IsAligned(p, alignment)) << alignment;
+  }
+
+  struct alignas(64) OverAligned {
+    char data[64];
+  };
+  arena.Allocate(1, 1);
+  EXPECT_TRUE(IsAligned(arena.New<OverAligned>(), 64));
+}
+
+TEST(ArenaTest, SmallAllocationsShareBlocks) {
+  Arena arena(/*block_size=*/1024);
+  std::vector<int64_t*> values;
+  for (int64_t i = 0; i < 64; ++i) {
+    values.push_back(arena.New<int64_t>(i));
+  }
+  EXPECT_EQ(arena.block_count(), 1);
+  for (int64_t i = 0; i < 64; ++i) {
+    EXPECT_EQ(*values[i], i);
+  }
+
+  // Allocations which do not fit in the current block start a new one.
+  arena.Allocate(1000, 8);
+  EXPECT_EQ(arena.block_count(), 2);
+}
+
+TEST(ArenaTest, OversizedAllocations) {
+  Arena arena(/*block_size=*/256);
+  char* small = static_cast<char*>(arena.Allocate(16, 8));
+  EXPECT_EQ(arena.block_count(), 1);
+
+  char* large = static_cast<char*>(arena.Allocate(1000, 16));
+  EXPECT_TRUE(IsAligned(large, 16));
+  EXPECT_EQ(arena.block_count(), 2);
+  std::fill(large, large + 1000, 'x');
+
+  // The oversized allocation has a block of its own, so later small ones
+  // still fill the first block.
+  char* next = static_cast<char*>(arena.Allocate(16, 8));
+  EXPECT_EQ(next, small + 16);
+  EXPECT_EQ(arena.block_count(), 2);
+}
+
+TEST(ArenaTest, DestroysObjectsInReverseOrder) {
+  class Recorder {
+   public:
+    Recorder(std::string name, std::vector<std::string>* destroyed)
+        : name_(std::move(name)), destroyed_(destroyed) {}
+    ~Recorder() { destroyed_->push_back(name_); }
+
+   private:
+    std::string name_;
+    std::vector<std::string>* destroyed_;
+  };
+
+  std::vector<std::string> destroyed;
+  {
+    Arena arena(/*block_size=*/64);
+    arena.New<Recorder>("a", &destroyed);
+    arena.New<int64_t>(42);
+    arena.New<Recorder>("b", &destroyed);
+    // Spills into further blocks.
+    arena.New<Recorder>("c", &destroyed);
+    arena.New<Recorder>("d", &destroyed);
+    EXPECT_TRUE(destroyed.empty());
+  }
+  EXPECT_THAT(destroyed, ElementsAre("d", "c", "b", "a"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,149 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/content_addressed_cache.h"
+
+#include <openssl/sha.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+std::string ContentDigest(absl::Span<const std::string_view> pieces) {
+  SHA256_CTX context;
+  SHA256_Init(&context);
+  for (std::string_view piece : pieces) {
+    const uint64_t size = piece.size();
+    SHA256_Update(&context, &size, sizeof(size));
+    SHA256_Update(&context, piece.data(), piece.size());
+  }
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256_Final(digest, &context);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+absl::StatusOr<std::string> ComputeFileBuildId(
+    const std::filesystem::path& path) {
+  std::error_code ec;
+  std::filesystem::path canonical = std::filesystem::canonical(path, ec);
+  uintmax_t size = ec ? 0 : std::filesystem::file_size(canonical, ec);
+  std::filesystem::file_time_type mtime =
+      ec ? std::filesystem::file_time_type()
+         : std::filesystem::last_write_time(canonical, ec);
+  if (ec) {
+    return absl::NotFoundError(absl::StrCat(
+        "Unable to identify the build of ", path.string(), ": ", ec.message()));
+  }
+  std::string canonical_path = canonical.string();
+  std::string size_text = absl::StrCat(size);
+  std::string mtime_text = absl::StrCat(mtime.time_since_epoch().count());
+  return ContentDigest({canonical_path, size_text, mtime_text}).substr(0, 16);
+}
+
+absl::Status AtomicallySetFileContents(const std::filesystem::path& path,
+                                       std::string_view contents) {
+  // The process id and a random number make the name unique among threads and
+  // processes, possibly on other hosts sharing the directory.
+  absl::BitGen bitgen;
+  std::filesystem::path temp_path =
+      absl::StrFormat("%s.tmp.%d.%016x", path.string(), getpid(),
+                      absl::Uniform<uint64_t>(bitgen));
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, contents));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    std::error_code remove_ec;
+    std::filesystem::remove(temp_path, remove_ec);
+    return absl::InternalError(absl::StrFormat(
+        "Failed to rename %s to %s: %s", temp_path.string(), path.string(),
+        ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+ContentAddressedCache::ContentAddressedCache(std::filesystem::path directory,
+                                             std::string_view suffix,
+                                             int64_t shard_prefix_length)
+    : directory_(std::move(directory)),
+      suffix_(suffix),
+      shard_prefix_length_(shard_prefix_length) {}
+
+std::filesystem::path ContentAddressedCache::EntryPath(
+    std::string_view key) const {
+  std::string name = absl::StrCat(key, suffix_);
+  if (shard_prefix_length_ > 0) {
+    return directory_ / key.substr(0, shard_prefix_length_) / name;
+  }
+  return directory_ / name;
+}
+
+absl::StatusOr<std::optional<std::string>> ContentAddressedCache::Read(
+    std::string_view key) const {
+  absl::StatusOr<std::string> contents = GetFileContents(EntryPath(key));
+  if (absl::IsNotFound(contents.status())) {
+    return std::nullopt;
+  }
+  XLS_RETURN_IF_ERROR(contents.status());
+  return *std::move(contents);
+}
+
+absl::Status ContentAddressedCache::Write(std::string_view key,
+                                          std::string_view contents) const {
+  std::filesystem::path path = EntryPath(key);
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+  return AtomicallySetFileContents(path, contents);
+}
+
+absl::StatusOr<TempDirectory> ContentAddressedCache::CreateStagingDirectory()
+    const {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory_));
+  return TempDirectory::CreateIn(directory_);
+}
+
+absl::StatusOr<bool> ContentAddressedCache::PublishDirectory(
+    TempDirectory staging, std::string_view key) const {
+  std::filesystem::path path = EntryPath(key);
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+  std::error_code ec;
+  std::filesystem::rename(staging.path(), path, ec);
+  if (ec == std::errc::directory_not_empty || ec == std::errc::file_exists) {
+    return false;
+  }
+  if (ec) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to rename %s to %s: %s", staging.path().string(),
+        path.string(), ec.message()));
+  }
+  std::move(staging).Release();
+  return true;
+}
+
+}  // namespace xls
@@ -0,0 +1,95 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
+#define XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/file/temp_directory.h"
+
+namespace xls {
+
+// Returns the (lowercase hex) SHA-256 digest of `pieces`. Each piece is
+// prefixed with its length so that different splits of the same bytes differ.
+std::string ContentDigest(absl::Span<const std::string_view> pieces);
+
+// Returns an ID of the build of the executable at `path`, e.g.
+// "/proc/self/exe", for keys of entries produced by that build. It is derived
+// from the path, size and modification time of the file rather than its
+// contents so that it is cheap to compute for large binaries.
+absl::StatusOr<std::string> ComputeFileBuildId(
+    const std::filesystem::path& path);
+
+// Replaces the contents of the file at `path` such that readers, possibly in
+// other processes, see either the previous file or the complete new one: the
+// contents are written to a uniquely named file next to `path` which is then
+// renamed over it.
+absl::Status AtomicallySetFileContents(const std::filesystem::path& path,
+                                       std::string_view contents);
+
+// A directory of entries named by keys, typically digests of everything which
+// determines the entry (see ContentDigest), shared by threads and processes.
+// Entries are published atomically so readers never see partial entries, and
+// concurrent writers of the same key are harmless as their entries are equal.
+// Entries may be files or, for outputs of tools which produce many files,
+// directories.
+class ContentAddressedCache {
+ public:
+  // Entries are named by their key followed by `suffix`. If
+  // `shard_prefix_length` is positive, they are placed in subdirectories named
+  // by that many leading characters of the key to keep directories small. The
+  // directory is created when the first entry is written.
+  explicit ContentAddressedCache(std::filesystem::path directory,
+                                 std::string_view suffix = "",
+                                 int64_t shard_prefix_length = 0);
+
+  const std::filesystem::path& directory() const { return directory_; }
+
+  std::filesystem::path EntryPath(std::string_view key) const;
+
+  // Returns the contents of the file entry of `key`, or std::nullopt if there
+  // is none.
+  absl::StatusOr<std::optional<std::string>> Read(std::string_view key) const;
+
+  // Writes the file entry of `key`, replacing any existing entry.
+  absl::Status Write(std::string_view key, std::string_view contents) const;
+
+  // Returns a new empty directory in the cache directory in which a directory
+  // entry can be built and then published by PublishDirectory. The directory
+  // is removed when the returned object is destroyed unless it was published.
+  absl::StatusOr<TempDirectory> CreateStagingDirectory() const;
+
+  // Renames `staging` to the directory entry of `key`. Returns true if it
+  // became the entry and false if there was already an entry, e.g., published
+  // by a concurrent writer, in which case `staging` is removed.
+  absl::StatusOr<bool> PublishDirectory(TempDirectory staging,
+                                        std::string_view key) const;
+
+ private:
+  std::filesystem::path directory_;
+  std::string suffix_;
+  int64_t shard_prefix_length_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_CONTENT_ADDRESSED_CACHE_H_
@@ -0,0 +1,121 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/content_addressed_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+using ::testing::Not;
+using ::testing::Optional;
+
+TEST(ContentAddressedCacheTest, DigestDependsOnSplit) {
+  std::string digest = ContentDigest({"ab", "c"});
+  EXPECT_EQ(digest.size(), 64);
+  EXPECT_EQ(ContentDigest({"ab", "c"}), digest);
+  EXPECT_NE(ContentDigest({"a", "bc"}), digest);
+  EXPECT_NE(ContentDigest({"abc"}), digest);
+}
+
+TEST(ContentAddressedCacheTest, FileBuildId) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path binary = temp_dir.path() / "binary";
+  XLS_ASSERT_OK(SetFileContents(binary, "build 1"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string id, ComputeFileBuildId(binary));
+  EXPECT_EQ(id.size(), 16);
+  EXPECT_THAT(ComputeFileBuildId(binary), IsOkAndHolds(id));
+
+  XLS_ASSERT_OK(SetFileContents(binary, "build 22"));
+  EXPECT_THAT(ComputeFileBuildId(binary), IsOkAndHolds(Not(id)));
+  EXPECT_FALSE(ComputeFileBuildId(temp_dir.path() / "missing").ok());
+}
+
+TEST(ContentAddressedCacheTest, WriteAndRead) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ContentAddressedCache cache(temp_dir.path() / "cache", ".entry");
+  std::string key = ContentDigest({"input"});
+  EXPECT_THAT(cache.Read(key), IsOkAndHolds(std::nullopt));
+
+  XLS_ASSERT_OK(cache.Write(key, "output"));
+  EXPECT_EQ(cache.EntryPath(key),
+            temp_dir.path() / "cache" / absl::StrCat(key, ".entry"));
+  EXPECT_THAT(cache.Read(key), IsOkAndHolds(Optional(std::string("output"))));
+
+  XLS_ASSERT_OK(cache.Write(key, "replaced"));
+  EXPECT_THAT(cache.Read(key),
+              IsOkAndHolds(Optional(std::string("replaced"))));
+  // No temporary files are left behind.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> entries,
+                           GetDirectoryEntries(temp_dir.path() / "cache"));
+  EXPECT_THAT(entries, ElementsAre(cache.EntryPath(key)));
+}
+
+TEST(ContentAddressedCacheTest, ShardedEntries) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ContentAddressedCache cache(temp_dir.path(), /*suffix=*/"",
+                              /*shard_prefix_length=*/2);
+  XLS_ASSERT_OK(cache.Write("abcdef", "output"));
+  EXPECT_EQ(cache.EntryPath("abcdef"), temp_dir.path() / "ab" / "abcdef");
+  EXPECT_THAT(cache.Read("abcdef"),
+              IsOkAndHolds(Optional(std::string("output"))));
+}
+
+TEST(ContentAddressedCacheTest, PublishDirectory) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ContentAddressedCache cache(temp_dir.path() / "cache");
+  auto stage = [&](std::string_view contents) -> TempDirectory {
+    absl::StatusOr<TempDirectory> staging = cache.CreateStagingDirectory();
+    XLS_CHECK_OK(staging.status());
+    XLS_CHECK_OK(SetFileContents(staging->path() / "file", contents));
+    return *std::move(staging);
+  };
+
+  TempDirectory first = stage("first");
+  std::filesystem::path first_path = first.path();
+  EXPECT_EQ(first_path.parent_path(), temp_dir.path() / "cache");
+  EXPECT_THAT(cache.PublishDirectory(std::move(first), "key"),
+              IsOkAndHolds(true));
+  EXPECT_FALSE(FileExists(first_path).ok());
+
+  // A later writer of the same key leaves the published entry alone and its
+  // staging directory is removed.
+  TempDirectory second = stage("second");
+  std::filesystem::path second_path = second.path();
+  EXPECT_THAT(cache.PublishDirectory(std::move(second), "key"),
+              IsOkAndHolds(false));
+  EXPECT_FALSE(FileExists(second_path).ok());
+  EXPECT_THAT(GetFileContents(cache.EntryPath("key") / "file"),
+              IsOkAndHolds("first"));
+}
+
+}  // namespace
+}  // namespace xls
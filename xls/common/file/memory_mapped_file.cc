@@ -0,0 +1,64 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/memory_mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/status/error_code_to_status.h"
+
+namespace xls {
+
+absl::StatusOr<std::unique_ptr<MemoryMappedFile>> MemoryMappedFile::Open(
+    const std::filesystem::path& path) {
+  FileDescriptor fd(open(path.c_str(), O_RDONLY));
+  if (fd.get() == -1) {
+    return ErrnoToStatus(errno) << "Failed to open file: " << path;
+  }
+  struct stat status;
+  if (fstat(fd.get(), &status) != 0) {
+    return ErrnoToStatus(errno) << "Failed to stat file: " << path;
+  }
+  if (!S_ISREG(status.st_mode)) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Cannot memory map file which is not a regular file: ",
+                     path.string()));
+  }
+  if (status.st_size == 0) {
+    return absl::WrapUnique(new MemoryMappedFile(nullptr, 0));
+  }
+  void* address =
+      mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (address == MAP_FAILED) {
+    return ErrnoToStatus(errno) << "Failed to memory map file: " << path;
+  }
+  // The mapping remains valid after the file descriptor is closed.
+  return absl::WrapUnique(new MemoryMappedFile(address, status.st_size));
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+  if (address_ != nullptr) {
+    munmap(address_, size_);
+  }
+}
+
+}  // namespace xls
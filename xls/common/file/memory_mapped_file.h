@@ -0,0 +1,60 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_MEMORY_MAPPED_FILE_H_
+#define XLS_COMMON_FILE_MEMORY_MAPPED_FILE_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+// A read-only memory mapping of the contents of a file. The mapping is removed
+// when the object is destroyed.
+class MemoryMappedFile {
+ public:
+  // Maps the file at `path`. Returns an error if the file cannot be opened or
+  // is not a regular file (e.g., a pipe such as /dev/stdin).
+  static absl::StatusOr<std::unique_ptr<MemoryMappedFile>> Open(
+      const std::filesystem::path& path);
+
+  ~MemoryMappedFile();
+
+  MemoryMappedFile(const MemoryMappedFile&) = delete;
+  MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+  absl::Span<const uint8_t> data() const {
+    return absl::MakeConstSpan(static_cast<const uint8_t*>(address_), size_);
+  }
+  std::string_view contents() const {
+    return std::string_view(static_cast<const char*>(address_), size_);
+  }
+
+ private:
+  MemoryMappedFile(void* address, int64_t size)
+      : address_(address), size_(size) {}
+
+  // Null if the file is empty as empty mappings are not allowed.
+  void* address_;
+  int64_t size_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_MEMORY_MAPPED_FILE_H_
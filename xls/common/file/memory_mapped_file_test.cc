@@ -0,0 +1,58 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/memory_mapped_file.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+
+TEST(MemoryMappedFileTest, MapsContents) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file,
+                           TempFile::CreateWithContent("hello world"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MemoryMappedFile> mapped,
+                           MemoryMappedFile::Open(file.path()));
+  EXPECT_EQ(mapped->contents(), "hello world");
+  EXPECT_EQ(mapped->data().size(), 11);
+  EXPECT_EQ(mapped->data()[0], 'h');
+}
+
+TEST(MemoryMappedFileTest, EmptyFile) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<MemoryMappedFile> mapped,
+                           MemoryMappedFile::Open(file.path()));
+  EXPECT_TRUE(mapped->contents().empty());
+  EXPECT_TRUE(mapped->data().empty());
+}
+
+TEST(MemoryMappedFileTest, NonexistentFile) {
+  EXPECT_THAT(MemoryMappedFile::Open("/nonexistent_path_name___/foo"),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST(MemoryMappedFileTest, NotARegularFile) {
+  EXPECT_THAT(MemoryMappedFile::Open("/dev/null"),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+}  // namespace
+}  // namespace xls
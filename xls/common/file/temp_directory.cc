@@ -54,8 +54,12 @@ absl::StatusOr<TempDirectory> TempDirectory::Create() {
   if (ec) {
     return absl::InternalError("Failed to get temporary directory path.");
   }
+  return CreateIn(global_temp_dir);
+}
 
-  std::string temp_dir = (global_temp_dir / "temp_directory_XXXXXX").string();
+absl::StatusOr<TempDirectory> TempDirectory::CreateIn(
+    const std::filesystem::path& parent) {
+  std::string temp_dir = (parent / "temp_directory_XXXXXX").string();
   if (mkdtemp(temp_dir.data()) == nullptr) {
     return absl::UnavailableError(
         absl::StrCat("Failed to create temporary directory ", temp_dir));
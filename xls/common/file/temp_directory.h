@@ -31,6 +31,12 @@ class TempDirectory {
 
   static absl::StatusOr<TempDirectory> Create();
 
+  // As above, but creates the directory in `parent` rather than in the system
+  // temporary directory, e.g., so it can be renamed to a path in the same file
+  // system once populated.
+  static absl::StatusOr<TempDirectory> CreateIn(
+      const std::filesystem::path& parent);
+
   const std::filesystem::path& path() const;
 
   // Leave the directory on the file system as is. This causes TempDirectory to
@@ -34,6 +34,18 @@ TEST(TempDirectory, CreateCreatesATemporaryDirectory) {
   EXPECT_TRUE(std::filesystem::is_directory(temp_dir->path(), ec));
 }
 
+TEST(TempDirectory, CreateInCreatesADirectoryInTheParent) {
+  std::error_code ec;
+
+  auto parent = TempDirectory::Create();
+  XLS_ASSERT_OK(parent);
+  auto temp_dir = TempDirectory::CreateIn(parent->path());
+  XLS_ASSERT_OK(temp_dir);
+
+  EXPECT_EQ(temp_dir->path().parent_path(), parent->path());
+  EXPECT_TRUE(std::filesystem::is_directory(temp_dir->path(), ec));
+}
+
 TEST(TempDirectory, DestructorDeletesTheTemporaryDirectory) {
   std::error_code ec;
 
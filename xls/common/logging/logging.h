@@ -187,11 +187,13 @@
   default:                                    \
     XLS_LOGGING_INTERNAL_CONDITION(condition) \
   XLS_LOGGING_INTERNAL_LOG_##severity.stream()
-#define XLS_VLOG_IF(verbose_level, condition)                     \
-  switch (0)                                                      \
-  default:                                                        \
-    XLS_LOGGING_INTERNAL_CONDITION((condition) &&                 \
-                                   XLS_VLOG_IS_ON(verbose_level)) \
+// The verbosity is checked first so `condition` is only evaluated if the
+// level is enabled.
+#define XLS_VLOG_IF(verbose_level, condition)                       \
+  switch (0)                                                        \
+  default:                                                          \
+    XLS_LOGGING_INTERNAL_CONDITION(XLS_VLOG_IS_ON(verbose_level) && \
+                                   (condition))                     \
   XLS_LOGGING_INTERNAL_LOG_INFO.WithVerbosity(verbose_level).stream()
 
 // -----------------------------------------------------------------------------
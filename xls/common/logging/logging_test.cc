@@ -119,6 +119,22 @@ TEST_F(LoggingTest, VlogIfLogsNothingWhenConditionDoesNotHold) {
   EXPECT_EQ(entries_.size(), 0);
 }
 
+TEST_F(LoggingTest, VlogIfDoesNotEvaluateConditionWhenLevelDisabled) {
+  absl::SetFlag(&FLAGS_v, 1);
+  int evaluations = 0;
+  auto condition = [&] {
+    ++evaluations;
+    return true;
+  };
+  XLS_VLOG_IF(5, condition()) << "logged_message";
+  EXPECT_EQ(evaluations, 0);
+  EXPECT_EQ(entries_.size(), 0);
+
+  XLS_VLOG_IF(1, condition()) << "logged_message";
+  EXPECT_EQ(evaluations, 1);
+  EXPECT_EQ(entries_.size(), 1);
+}
+
 TEST_F(LoggingTest, CheckDoesNothingWhenConditionHolds) {
   XLS_CHECK(true);
 
@@ -14,6 +14,10 @@
 
 #include "xls/common/logging/vlog_is_on.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
 #include "absl/base/internal/spinlock.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/strip.h"
@@ -203,6 +207,16 @@ int InitVLOG(std::atomic<int32_t>* site, std::string_view full_path) {
     info = info->next;
   }
 
+  // Sites without a module-specific level cache the value of FLAGS_v. It is
+  // read after the global epoch, and updates of the flag advance the epoch,
+  // so the cached value is never newer than the epoch stored with it.
+  if (SiteLevel(new_site) == kUseFlag) {
+    const int32_t flag_level =
+        std::clamp<int32_t>(absl::GetFlag(FLAGS_v), kUseFlag + 1,
+                            std::numeric_limits<int16_t>::max());
+    new_site = Site(flag_level, global_epoch);
+  }
+
   // Attempt to store the new log site.  This can race with other
   // threads.  If we lose the race, don't bother retrying.  Our epoch
   // will remain stale, so we will try again on the next iteration.
@@ -55,24 +55,34 @@ ABSL_DECLARE_FLAG(int32_t, v);
 // xls::SetVLOGLevel.
 ABSL_DECLARE_FLAG(std::string, vmodule);
 
+// Verbose logging above this level is compiled out: XLS_VLOG_IS_ON is a
+// constant false for such levels, so the XLS_VLOG statements and their
+// arguments are dead code. There is no limit by default; builds where the
+// cost of disabled logging matters can define it, e.g.
+// --copt=-DXLS_MAX_VLOG_LEVEL=1.
+#ifndef XLS_MAX_VLOG_LEVEL
+#define XLS_MAX_VLOG_LEVEL 0x7FFF
+#endif
+
 // We pack an int16_t verbosity level and an int16_t epoch into an
 // int32_t at every XLS_VLOG_IS_ON() call site.  The level determines
 // whether the site should log, and the epoch determines whether the
-// site is stale and should be reinitialized.  A verbosity level of
-// kUseFlag (kint16min) indicates that the value of FLAGS_v should be used as
-// the verbosity level.  When the site is (re)initialized, a verbosity
-// level for the current source file is retrieved from an internal
-// list.  This list is mutated through calls to SetVLOGLevel() and
-// mutations to the --vmodule flag.  New log sites are initialized
-// with a stale epoch and a verbosity level of kUseFlag.
-#define XLS_VLOG_IS_ON(verbose_level)               \
-  (::xls::logging_internal::VLogEnabled(            \
-      []() -> std::atomic<int32_t>* {               \
-        static std::atomic<int32_t> site__(         \
-            ::xls::logging_internal::kDefaultSite); \
-        return &site__;                             \
-      }(),                                          \
-      (verbose_level), __FILE__))
+// site is stale and should be reinitialized.  When the site is
+// (re)initialized, a verbosity level for the current source file is
+// retrieved from an internal list, or from FLAGS_v if no entry of the
+// list applies.  The list is mutated through calls to SetVLOGLevel() and
+// mutations to the --vmodule flag; these and mutations of --v advance
+// the global epoch.  New log sites are initialized with a stale epoch, so
+// a check of an up-to-date site is a single comparison.
+#define XLS_VLOG_IS_ON(verbose_level)                 \
+  ((verbose_level) <= XLS_MAX_VLOG_LEVEL &&           \
+   ::xls::logging_internal::VLogEnabled(              \
+       []() -> std::atomic<int32_t>* {                \
+         static std::atomic<int32_t> site__(          \
+             ::xls::logging_internal::kDefaultSite);  \
+         return &site__;                              \
+       }(),                                           \
+       (verbose_level), __FILE__))
 
 namespace xls {
 
@@ -95,7 +105,8 @@ namespace logging_internal {
 // global epoch is advanced, invalidating all site epochs.
 extern std::atomic<int32_t> vlog_epoch;
 
-// A log level of kUseFlag means "read the logging level from FLAGS_v."
+// A log level of kUseFlag means "read the logging level from FLAGS_v." Sites
+// only hold it before they are first initialized.
 const int kUseFlag = (int16_t)~0x7FFF;
 
 // Log sites use FLAGS_v by default, and have an initial epoch of 0.
@@ -137,13 +148,10 @@ inline bool VLogEnabled(std::atomic<int32_t>* site, int32_t level,
                         std::string_view file) {
   const int32_t site_copy = site->load(std::memory_order_acquire);
   if (ABSL_PREDICT_TRUE(SiteEpoch(site_copy) == GlobalEpoch())) {
-    int32_t site_level = SiteLevel(site_copy);
-    if (site_level == kUseFlag) {
-      // Use global setting instead of per-site setting.
-      site_level = absl::GetFlag(FLAGS_v);
-    }
-    if (ABSL_PREDICT_TRUE(level > site_level)) {
-      return false;
+    const int32_t site_level = SiteLevel(site_copy);
+    // A never-initialized site matches the epoch only if the epoch wrapped.
+    if (ABSL_PREDICT_TRUE(site_level != kUseFlag)) {
+      return ABSL_PREDICT_FALSE(level <= site_level);
     }
   }
   return VLogEnabledSlow(site, level, file);
@@ -33,6 +33,14 @@ TEST_F(VlogIsOnTest, GlobalFlagIsUsedByDefault) {
   ExpectVlogLevel(4);
 }
 
+TEST_F(VlogIsOnTest, CachedSiteFollowsFlagChanges) {
+  // The same call site is checked under each setting of the flag.
+  for (int level : {2, 7, 0, 3}) {
+    absl::SetFlag(&FLAGS_v, level);
+    ExpectVlogLevel(level);
+  }
+}
+
 TEST_F(VlogIsOnTest, MismatchingModuleNamePatternDoesNotApply) {
   absl::SetFlag(&FLAGS_v, 5);
   SetVLOGLevel("something_else", 10);
@@ -16,6 +16,7 @@
 
 #include <fcntl.h>
 #include <poll.h>
+#include <sys/socket.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
@@ -25,6 +26,8 @@
 #include <cstring>
 #include <ctime>
 #include <filesystem>  // NOLINT
+#include <functional>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -32,6 +35,7 @@
 #include <vector>
 
 #include "absl/container/fixed_array.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -70,10 +74,25 @@ struct Pipe {
   FileDescriptor entrance;
 };
 
+// Opens a connected pair of sockets to carry the stdin of a subprocess. This
+// is used rather than a pipe so that writes can be made with MSG_NOSIGNAL: a
+// subprocess exiting without reading its input then results in an EPIPE error
+// rather than a SIGPIPE which kills this process.
+absl::StatusOr<std::pair<FileDescriptor, FileDescriptor>> OpenStdinSockets() {
+  int descriptors[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, descriptors) != 0) {
+    return absl::InternalError(
+        absl::StrCat("Failed to initialize stdin socket:", Strerror(errno)));
+  }
+  return std::make_pair(FileDescriptor(descriptors[0]),
+                        FileDescriptor(descriptors[1]));
+}
+
 void PrepareAndExecInChildProcess(const std::vector<const char*>& argv_pointers,
                                   std::optional<std::filesystem::path> cwd,
                                   const Pipe& stdout_pipe,
-                                  const Pipe& stderr_pipe) {
+                                  const Pipe& stderr_pipe,
+                                  const FileDescriptor& stdin_exit) {
   if (cwd.has_value()) {
     if (chdir(cwd->c_str()) != 0) {
       XLS_LOG(ERROR) << "chdir failed: " << Strerror(errno);
@@ -87,22 +106,26 @@ void PrepareAndExecInChildProcess(const std::vector<const char*>& argv_pointers,
   while ((dup2(stderr_pipe.entrance.get(), STDERR_FILENO) == -1) &&
          (errno == EINTR)) {
   }
+  if (stdin_exit.get() != -1) {
+    while ((dup2(stdin_exit.get(), STDIN_FILENO) == -1) && (errno == EINTR)) {
+    }
+  }
 
   execv(argv_pointers[0], const_cast<char* const*>(argv_pointers.data()));
   XLS_LOG(ERROR) << "Execv syscall failed: " << Strerror(errno);
   _exit(127);
 }
 
-// Takes a list of file descriptor data streams and reads them into a list of
-// strings, one for each provided file descriptor.
+// Takes a list of file descriptor data streams and passes the data read from
+// each to the corresponding callback as it arrives, until all the streams are
+// closed.
 //
-// The 'result' vector is populated with all the data that was read in from the
-// fd's regardless to the status that is returned. Non-OK status will still
-// populate what it can into 'result'.
-absl::Status ReadFileDescriptors(absl::Span<FileDescriptor*> fds,
-                                 std::vector<std::string>& result) {
+// All the data that was read in from the fd's is passed on regardless of the
+// status that is returned.
+absl::Status ReadFileDescriptors(
+    absl::Span<FileDescriptor* const> fds,
+    absl::Span<const std::function<void(std::string_view)>> callbacks) {
   absl::FixedArray<char> buffer(4096);
-  result.resize(fds.size());
   std::vector<pollfd> poll_list;
   poll_list.resize(fds.size());
   for (int i = 0; i < fds.size(); i++) {
@@ -139,12 +162,12 @@ absl::Status ReadFileDescriptors(absl::Span<FileDescriptor*> fds,
       // connection, but there may be data waiting to be read. read() will
       // return 0 bytes when we consume all the data, so just ignore that error.
       if ((poll_list[i].revents & (POLLHUP | POLLIN)) != 0) {
-        size_t bytes = read(poll_list[i].fd, buffer.data(), buffer.size());
+        ssize_t bytes = read(poll_list[i].fd, buffer.data(), buffer.size());
         if (bytes == 0) {
           // All data is read.
           close_fd_by_index(i);
         } else if (bytes > 0) {
-          result[i].append(buffer.data(), bytes);
+          callbacks[i](std::string_view(buffer.data(), bytes));
         } else if (errno != EINTR) {
           close_fd_by_index(i);
         }
@@ -168,12 +191,24 @@ absl::StatusOr<int> WaitForPid(pid_t pid) {
   return wait_status;
 }
 
+// Waits for a process to exit without reaping it, so that its pid is not
+// reused until WaitForPid is called.
+absl::Status WaitForExit(pid_t pid) {
+  siginfo_t info;
+  while (waitid(P_PID, pid, &info, WEXITED | WNOWAIT) == -1) {
+    if (errno == EINTR) {
+      continue;
+    }
+    return absl::InternalError(
+        absl::StrCat("waitid failed: ", Strerror(errno)));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
-absl::StatusOr<SubprocessResult> InvokeSubprocess(
-    absl::Span<const std::string> argv,
-    std::optional<std::filesystem::path> cwd,
-    std::optional<absl::Duration> optional_timeout) {
+absl::StatusOr<std::unique_ptr<Subprocess>> Subprocess::Start(
+    absl::Span<const std::string> argv, SubprocessOptions options) {
   if (argv.empty()) {
     return absl::InvalidArgumentError("Cannot invoke empty argv list.");
   }
@@ -181,8 +216,8 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
 
   XLS_VLOG(1) << absl::StreamFormat(
       "Running %s; argv: [ %s ], cwd: %s", bin_name, absl::StrJoin(argv, " "),
-      cwd.has_value() ? cwd->string()
-                      : std::filesystem::current_path().string());
+      options.cwd.has_value() ? options.cwd->string()
+                              : std::filesystem::current_path().string());
 
   std::vector<const char*> argv_pointers;
   argv_pointers.reserve(argv.size() + 1);
@@ -193,6 +228,12 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
 
   XLS_ASSIGN_OR_RETURN(auto stdout_pipe, Pipe::Open());
   XLS_ASSIGN_OR_RETURN(auto stderr_pipe, Pipe::Open());
+  FileDescriptor stdin_entrance;
+  FileDescriptor stdin_exit;
+  if (options.pipe_stdin) {
+    XLS_ASSIGN_OR_RETURN(std::tie(stdin_entrance, stdin_exit),
+                         OpenStdinSockets());
+  }
 
   pid_t pid = fork();
   if (pid == -1) {
@@ -200,12 +241,83 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
         absl::StrCat("Failed to fork: ", Strerror(errno)));
   }
   if (pid == 0) {
-    PrepareAndExecInChildProcess(argv_pointers, cwd, stdout_pipe, stderr_pipe);
+    PrepareAndExecInChildProcess(argv_pointers, options.cwd, stdout_pipe,
+                                 stderr_pipe, stdin_exit);
   }
   // This is the parent process.
   stdout_pipe.entrance.Close();
   stderr_pipe.entrance.Close();
+  stdin_exit.Close();
+
+  auto subprocess = absl::WrapUnique(new Subprocess(
+      pid, std::move(bin_name), std::move(options),
+      std::move(stdout_pipe.exit), std::move(stderr_pipe.exit),
+      std::move(stdin_entrance)));
+  subprocess->io_thread_.emplace([p = subprocess.get()]() { p->Run(); });
+  return subprocess;
+}
+
+Subprocess::Subprocess(pid_t pid, std::string bin_name,
+                       SubprocessOptions options, FileDescriptor stdout_exit,
+                       FileDescriptor stderr_exit,
+                       FileDescriptor stdin_entrance)
+    : pid_(pid),
+      bin_name_(std::move(bin_name)),
+      options_(std::move(options)),
+      stdout_exit_(std::move(stdout_exit)),
+      stderr_exit_(std::move(stderr_exit)),
+      stdin_entrance_(std::move(stdin_entrance)) {}
+
+Subprocess::~Subprocess() {
+  Kill();
+  CloseStdin();
+  // io_thread_ is joined as the first member destroyed.
+}
+
+absl::Status Subprocess::WriteStdin(std::string_view data) {
+  if (stdin_entrance_.get() == -1) {
+    return absl::FailedPreconditionError(
+        "The stdin of the subprocess is not piped or has been closed.");
+  }
+  while (!data.empty()) {
+    ssize_t bytes =
+        send(stdin_entrance_.get(), data.data(), data.size(), MSG_NOSIGNAL);
+    if (bytes < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return absl::InternalError(absl::StrCat(
+          "Failed to write to stdin of subprocess: ", Strerror(errno)));
+    }
+    data.remove_prefix(bytes);
+  }
+  return absl::OkStatus();
+}
+
+void Subprocess::CloseStdin() { stdin_entrance_.Close(); }
 
+bool Subprocess::IsDone() const {
+  absl::MutexLock lock(&mutex_);
+  return result_.has_value();
+}
+
+absl::StatusOr<SubprocessResult> Subprocess::Wait() {
+  absl::MutexLock lock(&mutex_);
+  auto done = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return result_.has_value();
+  };
+  mutex_.Await(absl::Condition(&done));
+  return *result_;
+}
+
+void Subprocess::Kill() {
+  absl::MutexLock lock(&mutex_);
+  if (!exited_ && kill(pid_, SIGKILL) == 0) {
+    XLS_VLOG(1) << "Killed " << pid_;
+  }
+}
+
+void Subprocess::Run() {
   // Order is important here. The optional<Thread> must appear after the mutex
   // because the thread's destructor calls Join() and because the thread has
   // references to the mutex. We are depending on destructor invocation being
@@ -213,13 +325,14 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
   //
   // Note that release_watchdog is the Condition trigger protected by the mutex
   // and signaling that the process has finished and the watchdog should exit.
+  // The watchdog sleeps on the condition rather than polling the process.
   std::atomic<bool> timeout_expired = false;
   bool release_watchdog = false;
   absl::Mutex watchdog_mutex;
   std::optional<xls::Thread> watchdog_thread;
-  if (optional_timeout.has_value() &&
-      *optional_timeout > absl::ZeroDuration()) {
-    auto watchdog = [pid, timeout = optional_timeout.value(), &watchdog_mutex,
+  if (options_.timeout.has_value() &&
+      *options_.timeout > absl::ZeroDuration()) {
+    auto watchdog = [this, timeout = options_.timeout.value(), &watchdog_mutex,
                      &release_watchdog, &timeout_expired]() {
       absl::MutexLock lock(&watchdog_mutex);
       auto condition_lambda = [](void* release_val) {
@@ -230,39 +343,106 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
               timeout)) {
         // Timeout has lapsed, try to kill the subprocess.
         timeout_expired.store(true);
-        if (kill(pid, SIGKILL) == 0) {
-          XLS_VLOG(1) << "Watchdog killed " << pid;
-        }
+        Kill();
       }
     };
     watchdog_thread.emplace(watchdog);
   }
 
-  // Read from the output streams of the subprocess.
-  FileDescriptor* fds[] = {&stdout_pipe.exit, &stderr_pipe.exit};
-  std::vector<std::string> output_strings;
-  absl::Status read_status = ReadFileDescriptors(fds, output_strings);
+  // Read from the output streams of the subprocess, accumulating the streams
+  // which are not passed to callbacks.
+  std::string stdout_output;
+  std::string stderr_output;
+  auto output_callback = [](const std::function<void(std::string_view)>& f,
+                            std::string* output) {
+    return f ? f : [output](std::string_view data) { output->append(data); };
+  };
+  FileDescriptor* fds[] = {&stdout_exit_, &stderr_exit_};
+  std::function<void(std::string_view)> callbacks[] = {
+      output_callback(options_.stdout_callback, &stdout_output),
+      output_callback(options_.stderr_callback, &stderr_output)};
+  absl::Status read_status = ReadFileDescriptors(fds, callbacks);
   if (!read_status.ok()) {
     XLS_VLOG(1) << "ReadFileDescriptors non-ok status: " << read_status;
   }
-  const auto& stdout_output = output_strings[0];
-  const auto& stderr_output = output_strings[1];
 
-  XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stdout:\n ", stdout_output));
-  XLS_VLOG_LINES(2, absl::StrCat(bin_name, " stderr:\n ", stderr_output));
+  XLS_VLOG_LINES(2, absl::StrCat(bin_name_, " stdout:\n ", stdout_output));
+  XLS_VLOG_LINES(2, absl::StrCat(bin_name_, " stderr:\n ", stderr_output));
 
-  XLS_ASSIGN_OR_RETURN(int wait_status, WaitForPid(pid));
+  auto wait = [&]() -> absl::StatusOr<SubprocessResult> {
+    XLS_RETURN_IF_ERROR(WaitForExit(pid_));
+    {
+      absl::MutexLock lock(&mutex_);
+      exited_ = true;
+    }
+    XLS_ASSIGN_OR_RETURN(int wait_status, WaitForPid(pid_));
+    return SubprocessResult{.stdout = std::move(stdout_output),
+                            .stderr = std::move(stderr_output),
+                            .exit_status = WEXITSTATUS(wait_status),
+                            .normal_termination = WIFEXITED(wait_status),
+                            .timeout_expired = timeout_expired.load()};
+  };
+  absl::StatusOr<SubprocessResult> result = wait();
 
   if (watchdog_thread != std::nullopt) {
-    absl::MutexLock lock(&watchdog_mutex);
-    release_watchdog = true;
+    {
+      absl::MutexLock lock(&watchdog_mutex);
+      release_watchdog = true;
+    }
+    watchdog_thread->Join();
+  }
+  if (options_.on_exit) {
+    options_.on_exit(result);
   }
 
-  return SubprocessResult{.stdout = stdout_output,
-                          .stderr = stderr_output,
-                          .exit_status = WEXITSTATUS(wait_status),
-                          .normal_termination = WIFEXITED(wait_status),
-                          .timeout_expired = timeout_expired.load()};
+  absl::MutexLock lock(&mutex_);
+  result_ = std::move(result);
+}
+
+SubprocessLauncher::SubprocessLauncher(int64_t max_running)
+    : max_running_(max_running) {
+  XLS_CHECK_GE(max_running, 1);
+}
+
+absl::StatusOr<std::unique_ptr<Subprocess>> SubprocessLauncher::Start(
+    absl::Span<const std::string> argv, SubprocessOptions options) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto has_free_slot = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return running_ < max_running_;
+    };
+    mutex_.Await(absl::Condition(&has_free_slot));
+    ++running_;
+  }
+  auto release_slot = [this]() {
+    absl::MutexLock lock(&mutex_);
+    --running_;
+  };
+  options.on_exit =
+      [release_slot, on_exit = std::move(options.on_exit)](
+          const absl::StatusOr<SubprocessResult>& result) {
+        if (on_exit) {
+          on_exit(result);
+        }
+        release_slot();
+      };
+  absl::StatusOr<std::unique_ptr<Subprocess>> subprocess =
+      Subprocess::Start(argv, std::move(options));
+  if (!subprocess.ok()) {
+    release_slot();
+  }
+  return subprocess;
+}
+
+absl::StatusOr<SubprocessResult> InvokeSubprocess(
+    absl::Span<const std::string> argv,
+    std::optional<std::filesystem::path> cwd,
+    std::optional<absl::Duration> optional_timeout) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Subprocess> subprocess,
+      Subprocess::Start(argv, SubprocessOptions{.cwd = std::move(cwd),
+                                                .timeout = optional_timeout}));
+  return subprocess->Wait();
 }
 
 absl::StatusOr<std::pair<std::string, std::string>> SubprocessResultToStrings(
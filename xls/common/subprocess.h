@@ -15,13 +15,26 @@
 #ifndef XLS_COMMON_SUBPROCESS_H_
 #define XLS_COMMON_SUBPROCESS_H_
 
+#include <sys/types.h>
+
+#include <cstdint>
 #include <filesystem>  // NOLINT
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/thread.h"
 
 namespace xls {
 
@@ -86,5 +99,123 @@ absl::StatusOr<SubprocessResult> InvokeSubprocess(
     std::optional<std::filesystem::path> cwd = std::nullopt,
     std::optional<absl::Duration> optional_timeout = std::nullopt);
 
+// Options of a subprocess started with Subprocess::Start.
+struct SubprocessOptions {
+  // If supplied, the subprocess is invoked in this directory.
+  std::optional<std::filesystem::path> cwd;
+
+  // Subprocesses that run beyond this are killed. Nullopt is equivalent to
+  // absl::ZeroDuration and means "wait forever".
+  std::optional<absl::Duration> timeout;
+
+  // If set, called with each chunk of output of the subprocess on the
+  // corresponding stream as it arrives, and the output is not accumulated in
+  // the SubprocessResult. Called from the thread of the subprocess (see
+  // Subprocess).
+  std::function<void(std::string_view)> stdout_callback;
+  std::function<void(std::string_view)> stderr_callback;
+
+  // Whether input is written to the subprocess with Subprocess::WriteStdin.
+  // Otherwise the subprocess inherits the stdin of this process.
+  bool pipe_stdin = false;
+
+  // If set, called from the thread of the subprocess once it has exited and
+  // all of its output has been read.
+  std::function<void(const absl::StatusOr<SubprocessResult>&)> on_exit;
+};
+
+// A running subprocess. Its output is read, and its timeout enforced, by a
+// thread of its own which blocks on the output and on the deadline, so the
+// caller is free to do other work, or to start other subprocesses, until it
+// calls Wait.
+//
+// Ex:
+//   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Subprocess> simulator,
+//                        Subprocess::Start(argv, {.pipe_stdin = true}));
+//   XLS_RETURN_IF_ERROR(simulator->WriteStdin(stimulus));
+//   simulator->CloseStdin();
+//   ... do other work ...
+//   XLS_ASSIGN_OR_RETURN(SubprocessResult result, simulator->Wait());
+class Subprocess {
+ public:
+  // Starts a subprocess with the given argv. Problems in invocation result in
+  // a non-OK status.
+  static absl::StatusOr<std::unique_ptr<Subprocess>> Start(
+      absl::Span<const std::string> argv, SubprocessOptions options = {});
+
+  // Kills the subprocess if it is still running, and waits for it to exit.
+  ~Subprocess();
+
+  Subprocess(const Subprocess&) = delete;
+  Subprocess& operator=(const Subprocess&) = delete;
+
+  // Writes `data` to the stdin of the subprocess, blocking until the
+  // subprocess has accepted it all. Requires options.pipe_stdin.
+  absl::Status WriteStdin(std::string_view data);
+
+  // Closes the stdin of the subprocess, signaling the end of its input.
+  void CloseStdin();
+
+  // Returns whether the subprocess has exited and all its output been read.
+  bool IsDone() const;
+
+  // Waits until the subprocess has exited and all its output been read, and
+  // returns its result. The stdout and stderr of the result are empty if they
+  // were passed to callbacks instead. Unexpected termination of the subprocess
+  // (currently) results in a non-OK status.
+  absl::StatusOr<SubprocessResult> Wait();
+
+  // Kills the subprocess if it is still running.
+  void Kill();
+
+  pid_t pid() const { return pid_; }
+
+ private:
+  Subprocess(pid_t pid, std::string bin_name, SubprocessOptions options,
+             FileDescriptor stdout_exit, FileDescriptor stderr_exit,
+             FileDescriptor stdin_entrance);
+
+  // Reads the output of the subprocess until it exits, then reaps it. Runs
+  // on io_thread_.
+  void Run();
+
+  const pid_t pid_;
+  const std::string bin_name_;
+  const SubprocessOptions options_;
+  FileDescriptor stdout_exit_;
+  FileDescriptor stderr_exit_;
+  FileDescriptor stdin_entrance_;
+
+  mutable absl::Mutex mutex_;
+  // Whether the subprocess has exited, after which its pid may be reused and
+  // must not be signaled anymore.
+  bool exited_ ABSL_GUARDED_BY(mutex_) = false;
+  std::optional<absl::StatusOr<SubprocessResult>> result_
+      ABSL_GUARDED_BY(mutex_);
+
+  // Declared last so that the thread is joined before the members it uses
+  // are destroyed.
+  std::optional<Thread> io_thread_;
+};
+
+// Starts subprocesses such that at most a given number of them run at once,
+// e.g. to overlap simulator runs with each other and with compute without
+// oversubscribing the machine. The launcher must outlive the subprocesses it
+// starts.
+class SubprocessLauncher {
+ public:
+  explicit SubprocessLauncher(int64_t max_running);
+
+  // Blocks until fewer than max_running subprocesses started by this launcher
+  // are running, then starts one. See Subprocess::Start.
+  absl::StatusOr<std::unique_ptr<Subprocess>> Start(
+      absl::Span<const std::string> argv, SubprocessOptions options = {});
+
+ private:
+  const int64_t max_running_;
+  absl::Mutex mutex_;
+  int64_t running_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 }  // namespace xls
 #endif  // XLS_COMMON_SUBPROCESS_H_
@@ -14,9 +14,14 @@
 
 #include "xls/common/subprocess.h"
 
+#include <memory>
+#include <string>
+#include <string_view>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 
@@ -174,5 +179,78 @@ TEST(SubprocessTest, ResultsUnpackToStringPair) {
               StatusIs(absl::StatusCode::kInternal, HasSubstr("bad arg")));
 }
 
+TEST(SubprocessTest, AsyncOutputCallbacks) {
+  std::string streamed_stdout;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Subprocess> subprocess,
+      Subprocess::Start(
+          {"/bin/sh", "-c", "/usr/bin/env seq 3 && echo hello >&2"},
+          SubprocessOptions{.stdout_callback = [&](std::string_view data) {
+            streamed_stdout.append(data);
+          }}));
+
+  EXPECT_THAT(subprocess->Wait(), IsOkAndHolds(FieldsAre(
+                                      /*stdout=*/"",
+                                      /*stderr=*/"hello\n",
+                                      /*exit_status=*/0,
+                                      /*normal_termination=*/true,
+                                      /*timeout_expired=*/false)));
+  EXPECT_TRUE(subprocess->IsDone());
+  EXPECT_EQ(streamed_stdout, "1\n2\n3\n");
+}
+
+TEST(SubprocessTest, AsyncStdinWorks) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Subprocess> subprocess,
+      Subprocess::Start({"/bin/cat"}, SubprocessOptions{.pipe_stdin = true}));
+  XLS_ASSERT_OK(subprocess->WriteStdin("hello "));
+  XLS_ASSERT_OK(subprocess->WriteStdin(std::string(100000, 'x')));
+  subprocess->CloseStdin();
+
+  XLS_ASSERT_OK_AND_ASSIGN(SubprocessResult result, subprocess->Wait());
+  EXPECT_EQ(result.stdout, absl::StrCat("hello ", std::string(100000, 'x')));
+  EXPECT_EQ(result.exit_status, 0);
+}
+
+TEST(SubprocessTest, AsyncStdinAfterExitFails) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Subprocess> subprocess,
+      Subprocess::Start({"/bin/sh", "-c", "exit 0"},
+                        SubprocessOptions{.pipe_stdin = true}));
+  XLS_ASSERT_OK(subprocess->Wait().status());
+
+  EXPECT_THAT(subprocess->WriteStdin(std::string(100000, 'x')),
+              StatusIs(absl::StatusCode::kInternal));
+  subprocess->CloseStdin();
+  EXPECT_THAT(subprocess->WriteStdin("x"),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST(SubprocessTest, AsyncKillWorks) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Subprocess> subprocess,
+                           Subprocess::Start({"/bin/sh", "-c", "sleep 10s"}));
+  subprocess->Kill();
+
+  EXPECT_THAT(subprocess->Wait(), IsOkAndHolds(FieldsAre(
+                                      /*stdout=*/"",
+                                      /*stderr=*/"",
+                                      /*exit_status=*/_,
+                                      /*normal_termination=*/false,
+                                      /*timeout_expired=*/false)));
+}
+
+TEST(SubprocessTest, LauncherBoundsRunningSubprocesses) {
+  SubprocessLauncher launcher(/*max_running=*/1);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Subprocess> first,
+                           launcher.Start({"/bin/sh", "-c", "sleep 0.2"}));
+  // Starting a second subprocess waits for the first to exit.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Subprocess> second,
+                           launcher.Start({"/bin/sh", "-c", "exit 3"}));
+  EXPECT_TRUE(first->IsDone());
+
+  XLS_ASSERT_OK_AND_ASSIGN(SubprocessResult result, second->Wait());
+  EXPECT_EQ(result.exit_status, 3);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,236 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+
+ABSL_FLAG(int64_t, xls_threads, 0,
+          "Number of worker threads in the process-wide thread pool. Zero "
+          "means one per hardware thread.");
+
+namespace xls {
+namespace {
+
+// The pool and index of the worker running on this thread, if any.
+thread_local ThreadPool* current_pool = nullptr;
+thread_local int64_t current_worker = -1;
+
+}  // namespace
+
+ThreadPool::ThreadPool(int64_t thread_count) {
+  XLS_CHECK_GT(thread_count, 0);
+  for (int64_t i = 0; i < thread_count; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (int64_t i = 0; i < thread_count; ++i) {
+    workers_.push_back(std::make_unique<Thread>([this, i]() {
+      current_pool = this;
+      current_worker = i;
+      WorkerLoop(i);
+    }));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutting_down_ = true;
+    work_available_.SignalAll();
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+ThreadPool* ThreadPool::Default() {
+  static ThreadPool* pool = [] {
+    int64_t thread_count = absl::GetFlag(FLAGS_xls_threads);
+    if (thread_count <= 0) {
+      thread_count = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+    }
+    return new ThreadPool(thread_count);
+  }();
+  return pool;
+}
+
+void ThreadPool::Schedule(std::function<void()> task) {
+  int64_t index = current_pool == this
+                      ? current_worker
+                      : next_queue_.fetch_add(1) % queues_.size();
+  {
+    Queue& queue = *queues_[index];
+    absl::MutexLock lock(&queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  absl::MutexLock lock(&mutex_);
+  ++queued_;
+  work_available_.Signal();
+}
+
+std::optional<std::function<void()>> ThreadPool::TakeTask(int64_t index) {
+  std::optional<std::function<void()>> task;
+  if (index >= 0) {
+    Queue& own = *queues_[index];
+    absl::MutexLock lock(&own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+  for (int64_t i = 1; !task.has_value() && i <= queues_.size(); ++i) {
+    Queue& victim = *queues_[(std::max<int64_t>(index, 0) + i) %
+                             queues_.size()];
+    absl::MutexLock lock(&victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+  if (task.has_value()) {
+    absl::MutexLock lock(&mutex_);
+    --queued_;
+  }
+  return task;
+}
+
+void ThreadPool::WorkerLoop(int64_t index) {
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      while (queued_ == 0 && !shutting_down_) {
+        work_available_.Wait(&mutex_);
+      }
+      if (queued_ == 0) {
+        return;
+      }
+    }
+    // Another thread may take the task first, in which case this simply
+    // waits again.
+    if (std::optional<std::function<void()>> task = TakeTask(index)) {
+      (*task)();
+    }
+  }
+}
+
+TaskGroup::TaskGroup(ThreadPool* pool)
+    : pool_(pool), state_(std::make_shared<State>()) {}
+
+TaskGroup::~TaskGroup() { Wait(); }
+
+void TaskGroup::Schedule(std::function<void()> task) {
+  {
+    absl::MutexLock lock(&state_->mutex);
+    state_->pending.push_back(std::move(task));
+    ++state_->outstanding;
+  }
+  pool_->Schedule([state = state_]() { RunPendingTask(state.get()); });
+}
+
+bool TaskGroup::RunPendingTask(State* state) {
+  std::function<void()> task;
+  {
+    absl::MutexLock lock(&state->mutex);
+    if (state->pending.empty()) {
+      return false;
+    }
+    task = std::move(state->pending.front());
+    state->pending.pop_front();
+  }
+  if (!state->cancelled.load()) {
+    task();
+  }
+  absl::MutexLock lock(&state->mutex);
+  --state->outstanding;
+  return true;
+}
+
+void TaskGroup::Cancel() { state_->cancelled.store(true); }
+
+bool TaskGroup::cancelled() const { return state_->cancelled.load(); }
+
+void TaskGroup::Wait() {
+  while (RunPendingTask(state_.get())) {
+  }
+  // The remaining tasks are running on other threads.
+  auto done = [](State* state) ABSL_EXCLUSIVE_LOCKS_REQUIRED(state->mutex) {
+    return state->outstanding == 0;
+  };
+  absl::MutexLock lock(&state_->mutex);
+  state_->mutex.Await(absl::Condition(+done, state_.get()));
+}
+
+namespace {
+
+// Runs chunks of `grain` indices on the calling thread and at most
+// `max_concurrency` - 1 tasks of `pool`.
+void RunChunksInParallel(int64_t begin, int64_t end,
+                         const std::function<void(int64_t)>& fn,
+                         ThreadPool* pool, int64_t grain,
+                         int64_t max_concurrency) {
+  XLS_CHECK_GT(grain, 0);
+  XLS_CHECK_GT(max_concurrency, 0);
+  if (begin >= end) {
+    return;
+  }
+  const int64_t chunk_count = CeilOfRatio(end - begin, grain);
+  std::atomic<int64_t> next_chunk = 0;
+  auto run_chunks = [&]() {
+    for (int64_t chunk = next_chunk.fetch_add(1); chunk < chunk_count;
+         chunk = next_chunk.fetch_add(1)) {
+      int64_t chunk_end = std::min(end, begin + (chunk + 1) * grain);
+      for (int64_t i = begin + chunk * grain; i < chunk_end; ++i) {
+        fn(i);
+      }
+    }
+  };
+  TaskGroup group(pool);
+  int64_t helper_count = std::min({pool->thread_count(), chunk_count - 1,
+                                   max_concurrency - 1});
+  for (int64_t i = 0; i < helper_count; ++i) {
+    group.Schedule(run_chunks);
+  }
+  run_chunks();
+  group.Wait();
+}
+
+}  // namespace
+
+void ParallelFor(int64_t begin, int64_t end,
+                 const std::function<void(int64_t)>& fn, ThreadPool* pool,
+                 int64_t grain) {
+  RunChunksInParallel(begin, end, fn, pool, grain,
+                      std::numeric_limits<int64_t>::max());
+}
+
+void BoundedParallelFor(int64_t begin, int64_t end, int64_t max_concurrency,
+                        const std::function<void(int64_t)>& fn,
+                        ThreadPool* pool) {
+  RunChunksInParallel(begin, end, fn, pool, /*grain=*/1, max_concurrency);
+}
+
+}  // namespace xls
@@ -0,0 +1,172 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_THREAD_POOL_H_
+#define XLS_COMMON_THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/flags/declare.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+
+ABSL_DECLARE_FLAG(int64_t, xls_threads);
+
+namespace xls {
+
+// A pool of worker threads running tasks with work stealing: each worker has
+// its own queue, which tasks scheduled from that worker go to and which it
+// drains newest first, and idle workers steal the oldest tasks from the
+// queues of others.
+//
+// Tools should normally use the process-wide pool returned by `Default()` so
+// that several tools running in one process share the cores rather than each
+// starting its own threads.
+class ThreadPool {
+ public:
+  // Creates a pool with the given number of worker threads, which must be
+  // positive.
+  explicit ThreadPool(int64_t thread_count);
+
+  // Runs all scheduled tasks and joins the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Returns the process-wide pool, created on first use with --xls_threads
+  // workers (or one per hardware thread if the flag is zero).
+  static ThreadPool* Default();
+
+  int64_t thread_count() const { return workers_.size(); }
+
+  // Schedules `task` to run on a worker.
+  void Schedule(std::function<void()> task);
+
+ private:
+  struct Queue {
+    absl::Mutex mutex;
+    std::deque<std::function<void()>> tasks ABSL_GUARDED_BY(mutex);
+  };
+
+  // Takes a task from the queue of worker `index`, or steals one from another
+  // worker. `index` may be -1 for threads outside the pool.
+  std::optional<std::function<void()>> TakeTask(int64_t index);
+
+  void WorkerLoop(int64_t index);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::atomic<uint64_t> next_queue_ = 0;
+
+  absl::Mutex mutex_;
+  absl::CondVar work_available_;
+  // The number of tasks in the queues.
+  int64_t queued_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutting_down_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::vector<std::unique_ptr<Thread>> workers_;
+};
+
+// A set of tasks on a thread pool which can be waited on and cancelled
+// together. Tasks of a group may schedule further tasks in the same group.
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool* pool = ThreadPool::Default());
+
+  // Waits for all tasks of the group.
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // Schedules `task` as part of the group. The task is skipped if the group
+  // is cancelled before it starts.
+  void Schedule(std::function<void()> task);
+
+  // Cancels the tasks of the group which have not started yet. Running tasks
+  // may poll `cancelled()` to stop early.
+  void Cancel();
+  bool cancelled() const;
+
+  // Blocks until every task of the group has finished or been skipped. The
+  // calling thread runs the group's own tasks which have not started yet, so
+  // this may be called from within a task of the same pool. It never runs
+  // tasks of other groups, which may be long-running.
+  void Wait();
+
+ private:
+  // Shared with the scheduled tasks, which may finish after `Wait` returns
+  // in the group's thread.
+  struct State {
+    std::atomic<bool> cancelled = false;
+    absl::Mutex mutex;
+    // Tasks not yet started. Each has a pool task which runs it unless the
+    // waiting thread takes it first.
+    std::deque<std::function<void()>> pending ABSL_GUARDED_BY(mutex);
+    int64_t outstanding ABSL_GUARDED_BY(mutex) = 0;
+  };
+
+  // Runs the oldest pending task of `state`, if any. Returns whether a task
+  // was run.
+  static bool RunPendingTask(State* state);
+
+  ThreadPool* pool_;
+  std::shared_ptr<State> state_;
+};
+
+// Calls `fn(i)` for every `i` in `[begin, end)` on the pool and returns once
+// all calls have returned. Consecutive indices are handed out in chunks of
+// `grain`. The calling thread takes part, so this may be nested.
+void ParallelFor(int64_t begin, int64_t end,
+                 const std::function<void(int64_t)>& fn,
+                 ThreadPool* pool = ThreadPool::Default(), int64_t grain = 1);
+
+// Like ParallelFor, but `fn` runs on at most `max_concurrency` threads at once,
+// including the calling thread. For callers with a user-facing thread count
+// option: the work still shares the pool with the rest of the process rather
+// than starting threads of its own.
+void BoundedParallelFor(int64_t begin, int64_t end, int64_t max_concurrency,
+                        const std::function<void(int64_t)>& fn,
+                        ThreadPool* pool = ThreadPool::Default());
+
+// Computes `map(i)` for every `i` in `[begin, end)` in parallel and folds the
+// results into `init` with `reduce` in increasing order of `i`, so the result
+// does not depend on how the work was scheduled.
+template <typename T, typename MapFn, typename ReduceFn>
+T ParallelMapReduce(int64_t begin, int64_t end, T init, MapFn map,
+                    ReduceFn reduce,
+                    ThreadPool* pool = ThreadPool::Default()) {
+  using Mapped = std::invoke_result_t<MapFn&, int64_t>;
+  std::vector<std::optional<Mapped>> mapped(std::max<int64_t>(end - begin, 0));
+  ParallelFor(
+      begin, end, [&](int64_t i) { mapped[i - begin].emplace(map(i)); }, pool);
+  for (std::optional<Mapped>& value : mapped) {
+    init = reduce(std::move(init), std::move(*value));
+  }
+  return init;
+}
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_THREAD_POOL_H_
@@ -0,0 +1,165 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+
+namespace xls {
+namespace {
+
+TEST(ThreadPoolTest, ScheduledTasksRunBeforeDestruction) {
+  std::atomic<int64_t> count = 0;
+  {
+    ThreadPool pool(/*thread_count=*/3);
+    for (int64_t i = 0; i < 1000; ++i) {
+      pool.Schedule([&]() { count.fetch_add(1); });
+    }
+  }
+  EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEachIndexOnce) {
+  ThreadPool pool(/*thread_count=*/4);
+  for (int64_t grain : {1, 7, 1000}) {
+    std::vector<std::atomic<int>> visits(2000);
+    ParallelFor(
+        100, 2000, [&](int64_t i) { visits[i].fetch_add(1); }, &pool, grain);
+    for (int64_t i = 0; i < visits.size(); ++i) {
+      ASSERT_EQ(visits[i].load(), i < 100 ? 0 : 1) << i;
+    }
+  }
+}
+
+TEST(ThreadPoolTest, BoundedParallelForLimitsConcurrency) {
+  ThreadPool pool(/*thread_count=*/8);
+  for (int64_t max_concurrency : {1, 3}) {
+    std::vector<std::atomic<int>> visits(500);
+    std::atomic<int64_t> running = 0;
+    std::atomic<int64_t> max_running = 0;
+    BoundedParallelFor(
+        0, 500, max_concurrency,
+        [&](int64_t i) {
+          int64_t now = running.fetch_add(1) + 1;
+          int64_t seen = max_running.load();
+          while (now > seen && !max_running.compare_exchange_weak(seen, now)) {
+          }
+          visits[i].fetch_add(1);
+          running.fetch_sub(1);
+        },
+        &pool);
+    for (int64_t i = 0; i < visits.size(); ++i) {
+      ASSERT_EQ(visits[i].load(), 1) << i;
+    }
+    EXPECT_LE(max_running.load(), max_concurrency);
+  }
+}
+
+TEST(ThreadPoolTest, ParallelMapReduceIsOrdered) {
+  ThreadPool pool(/*thread_count=*/4);
+  std::string expected;
+  for (int64_t i = 0; i < 500; ++i) {
+    absl::StrAppend(&expected, i, ",");
+  }
+  std::string result = ParallelMapReduce(
+      0, 500, std::string(),
+      [](int64_t i) { return absl::StrCat(i, ","); },
+      [](std::string acc, const std::string& s) { return acc + s; }, &pool);
+  EXPECT_EQ(result, expected);
+}
+
+TEST(ThreadPoolTest, NestedParallelForOnSingleThread) {
+  // Waiting threads run their group's tasks, so nesting cannot deadlock even when
+  // the only worker is busy with the outer loop.
+  ThreadPool pool(/*thread_count=*/1);
+  std::atomic<int64_t> count = 0;
+  ParallelFor(
+      0, 8,
+      [&](int64_t) {
+        ParallelFor(
+            0, 8, [&](int64_t) { count.fetch_add(1); }, &pool);
+      },
+      &pool);
+  EXPECT_EQ(count.load(), 64);
+}
+
+TEST(ThreadPoolTest, WaitRunsOnlyTasksOfItsGroup) {
+  // Other tasks may be long-running workers, which must not end up on the
+  // stack of a waiting thread.
+  ThreadPool pool(/*thread_count=*/1);
+  absl::Notification worker_busy;
+  absl::Notification release_worker;
+  pool.Schedule([&]() {
+    worker_busy.Notify();
+    release_worker.WaitForNotification();
+  });
+  worker_busy.WaitForNotification();
+  std::atomic<bool> other_ran = false;
+  pool.Schedule([&]() { other_ran.store(true); });
+  std::atomic<int64_t> count = 0;
+  TaskGroup group(&pool);
+  for (int64_t i = 0; i < 4; ++i) {
+    group.Schedule([&]() { count.fetch_add(1); });
+  }
+  group.Wait();
+  EXPECT_EQ(count.load(), 4);
+  EXPECT_FALSE(other_ran.load());
+  release_worker.Notify();
+}
+
+TEST(ThreadPoolTest, CancelledTasksAreSkipped) {
+  ThreadPool pool(/*thread_count=*/1);
+  std::atomic<int64_t> count = 0;
+  absl::Mutex mutex;
+  bool release = false;
+  TaskGroup group(&pool);
+  // Occupy the only worker so the following tasks cannot start before the
+  // group is cancelled.
+  group.Schedule([&]() {
+    absl::MutexLock lock(&mutex);
+    mutex.Await(absl::Condition(&release));
+  });
+  TaskGroup cancelled_group(&pool);
+  for (int64_t i = 0; i < 10; ++i) {
+    cancelled_group.Schedule([&]() { count.fetch_add(1); });
+  }
+  cancelled_group.Cancel();
+  EXPECT_TRUE(cancelled_group.cancelled());
+  {
+    absl::MutexLock lock(&mutex);
+    release = true;
+  }
+  cancelled_group.Wait();
+  group.Wait();
+  EXPECT_EQ(count.load(), 0);
+}
+
+TEST(ThreadPoolTest, DefaultPoolHasThreads) {
+  EXPECT_GE(ThreadPool::Default()->thread_count(), 1);
+  std::atomic<int64_t> count = 0;
+  ParallelFor(0, 100, [&](int64_t) { count.fetch_add(1); });
+  EXPECT_EQ(count.load(), 100);
+}
+
+}  // namespace
+}  // namespace xls
@@ -41,6 +41,18 @@ absl::Status BasicIntegrationAlgorithm::Initialize() {
   return absl::OkStatus();
 }
 
+absl::StatusOr<int64_t> BasicIntegrationAlgorithm::GetInsertNodeCost(
+    const Node* node) {
+  auto cost_itr = insert_costs_.find(node);
+  if (cost_itr != insert_costs_.end()) {
+    return cost_itr->second;
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t cost,
+                       integration_function_->GetInsertNodeCost(node));
+  insert_costs_[node] = cost;
+  return cost;
+}
+
 absl::StatusOr<std::unique_ptr<IntegrationFunction>>
 BasicIntegrationAlgorithm::Run() {
   while (!ready_nodes_.empty()) {
@@ -48,8 +60,7 @@ BasicIntegrationAlgorithm::Run() {
     for (auto node_itr = ready_nodes_.begin(); node_itr != ready_nodes_.end();
          ++node_itr) {
       // Check insertion cost.
-      XLS_ASSIGN_OR_RETURN(int64_t insert_cost,
-                           integration_function_->GetInsertNodeCost(*node_itr));
+      XLS_ASSIGN_OR_RETURN(int64_t insert_cost, GetInsertNodeCost(*node_itr));
       if (!move.has_value() || insert_cost < move.value().cost) {
         move = MakeInsertMove(node_itr, insert_cost);
       }
@@ -63,10 +74,16 @@ BasicIntegrationAlgorithm::Run() {
         }
 
         // Check if mergeable
+        std::pair<const Node*, int64_t> pair_key = {*node_itr,
+                                                     internal_node->id()};
+        if (unmergeable_pairs_.contains(pair_key)) {
+          continue;
+        }
         XLS_ASSIGN_OR_RETURN(
             std::optional<int64_t> merge_cost,
             integration_function_->GetMergeNodesCost(*node_itr, internal_node));
         if (!merge_cost.has_value()) {
+          unmergeable_pairs_.insert(pair_key);
           continue;
         }
 
@@ -84,6 +101,7 @@ BasicIntegrationAlgorithm::Run() {
         ExecuteMove(integration_function_.get(), move.value()).status());
 
     // Update ready_nodes_.
+    insert_costs_.erase(move.value().node);
     ready_nodes_.erase(move.value().node_itr);
     for (Node* user : move.value().node->users()) {
       EnqueueNodeIfReady(user);
@@ -16,6 +16,13 @@
 #ifndef XLS_INTEGRATOR_BASIC_INTEGRATION_ALGORITHM_
 #define XLS_INTEGRATOR_BASIC_INTEGRATION_ALGORITHM_
 
+#include <cstdint>
+#include <list>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
 #include "xls/contrib/integrator/integration_algorithms/integration_algorithm.h"
 
 namespace xls {
@@ -89,6 +96,23 @@ class BasicIntegrationAlgorithm
   // Track all nodes that have ever been inserted into 'ready_nodes_'.
   absl::flat_hash_set<Node*> queued_nodes_;
 
+  // Returns the cost of inserting 'node', a node of 'ready_nodes_', into the
+  // integration function. Inserting a node unifies each operand with itself,
+  // which never adds a mux, so the cost only depends on the node and is
+  // computed once rather than on every step.
+  absl::StatusOr<int64_t> GetInsertNodeCost(const Node* node);
+
+  // Insertion costs of the nodes of 'ready_nodes_', by node.
+  absl::flat_hash_map<const Node*, int64_t> insert_costs_;
+
+  // Pairs of a source function node and the id of an integration function
+  // node that cannot be merged. Whether two nodes can be merged only depends
+  // on their ops, attributes and source functions, none of which change over
+  // the lifetime of an integration function node (a merge replaces the
+  // node with a new one), so these pairs are not probed again. Ids are used
+  // because the address of a removed node may be reused.
+  absl::flat_hash_set<std::pair<const Node*, int64_t>> unmergeable_pairs_;
+
   // Function combining the source functions.
   std::unique_ptr<IntegrationFunction> integration_function_;
 };
@@ -23,6 +23,7 @@
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/AST/RecursiveASTVisitor.h"
 #include "clang/include/clang/Frontend/CompilerInstance.h"
+#include "clang/include/clang/Frontend/FrontendActions.h"
 #include "clang/include/clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/include/clang/Tooling/Tooling.h"
 #include "xls/common/logging/logging.h"
@@ -130,6 +131,8 @@ absl::Status CCParser::ScanFile(
   XLS_CHECK_EQ(libtool_thread_.get(), nullptr);
   XLS_CHECK_EQ(libtool_wait_for_destruct_.get(), nullptr);
 
+  PhaseTimer::ScopedPhase timed_phase(phase_timer_, kClangParsePhase);
+
   // The AST is destroyed after ToolInvocation::run() returns
   //
   // However, we want to preserve it to access it across multiple passes and
@@ -246,6 +249,8 @@ static size_t match_pragma(std::string_view pragma_string,
 }
 
 absl::Status CCParser::ScanFileForPragmas(std::string_view filename) {
+  PhaseTimer::ScopedPhase timed_phase(phase_timer_, kPragmaScanPhase);
+
   std::ifstream fin(std::string(filename).c_str());
   if (!fin.good()) {
     if (!(filename.empty() || filename[0] == '/')) {
@@ -410,33 +415,23 @@ void LibToolThread::Start() {
 
 void LibToolThread::Join() { thread_->Join(); }
 
-void LibToolThread::Run() {
-  std::vector<std::string> argv;
-  argv.emplace_back("binary");
-  argv.emplace_back("/xls_top.cc");
-  for (const auto& view : command_line_args_) {
-    argv.emplace_back(view);
-  }
+// Appends the arguments with which Clang is run on every translation unit.
+static void AddCommonClangArgs(std::vector<std::string>& argv) {
   // For xls_top.cc to include the source file
   argv.emplace_back("-I.");
-  argv.emplace_back("-fsyntax-only");
   argv.emplace_back("-std=c++17");
   argv.emplace_back("-nostdinc");
   argv.emplace_back("-Wno-unused-label");
   argv.emplace_back("-Wno-constant-logical-operand");
   argv.emplace_back("-Wno-unused-but-set-variable");
   argv.emplace_back("-Wno-c++11-narrowing");
+}
 
-  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
-
-  std::unique_ptr<LibToolFrontendAction> libtool_action(
-      new LibToolFrontendAction(parser_));
-
-  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
-      new llvm::vfs::InMemoryFileSystem);
-  mem_fs->addFile("/xls_builtin.h", 0,
-                  llvm::MemoryBuffer::getMemBuffer(
-                      R"(
+// Adds the declarations of the xlscc builtins as /xls_builtin.h.
+static void AddXlsBuiltinHeader(llvm::vfs::InMemoryFileSystem& mem_fs) {
+  mem_fs.addFile("/xls_builtin.h", 0,
+                 llvm::MemoryBuffer::getMemBuffer(
+                     R"(
 #ifndef __XLS_BUILTIN_H
 #define __XLS_BUILTIN_H
 template<int N>
@@ -493,6 +488,69 @@ bool __xlscc_on_reset = false;
 
 #endif//__XLS_BUILTIN_H
           )"));
+}
+
+// Returns a file manager for the real file system overlaid with mem_fs.
+static llvm::IntrusiveRefCntPtr<clang::FileManager> CreateFileManager(
+    llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs) {
+  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
+      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
+
+  overlay_fs->pushOverlay(mem_fs);
+
+  return new clang::FileManager(clang::FileSystemOptions(), overlay_fs);
+}
+
+absl::Status CCParser::GeneratePrecompiledHeader(
+    std::string_view header_filename, std::string_view pch_filename,
+    absl::Span<std::string_view> command_line_args) {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back("-xc++-header");
+  argv.emplace_back(header_filename);
+  for (const auto& view : command_line_args) {
+    argv.emplace_back(view);
+  }
+  // Headers may use the builtins, which xls_top.cc includes first
+  argv.emplace_back("-include");
+  argv.emplace_back("/xls_builtin.h");
+  AddCommonClangArgs(argv);
+  argv.emplace_back("-o");
+  argv.emplace_back(pch_filename);
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  AddXlsBuiltinHeader(*mem_fs);
+  llvm::IntrusiveRefCntPtr<clang::FileManager> files =
+      CreateFileManager(mem_fs);
+
+  clang::tooling::ToolInvocation invocation(
+      argv, std::make_unique<clang::GeneratePCHAction>(), files.get());
+  if (!invocation.run()) {
+    return absl::FailedPreconditionError(
+        absl::StrFormat("Unable to precompile header %s with clang "
+                        "(libtooling)",
+                        header_filename));
+  }
+  return absl::OkStatus();
+}
+
+void LibToolThread::Run() {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back("/xls_top.cc");
+  for (const auto& view : command_line_args_) {
+    argv.emplace_back(view);
+  }
+  argv.emplace_back("-fsyntax-only");
+  AddCommonClangArgs(argv);
+
+  std::unique_ptr<LibToolFrontendAction> libtool_action(
+      new LibToolFrontendAction(parser_));
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  AddXlsBuiltinHeader(*mem_fs);
 
   // Inject an instantiation to make Clang parse the constructor bodies
   std::string top_class_inst_injection = top_class_name_.empty()
@@ -524,13 +582,8 @@ void __xlscc_top_class_instance_ref2() {
   mem_fs->addFile("/xls_top.cc", 0,
                   llvm::MemoryBuffer::getMemBuffer(top_src.c_str()));
 
-  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
-      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
-
-  overlay_fs->pushOverlay(mem_fs);
-
-  libtool_files =
-      new clang::FileManager(clang::FileSystemOptions(), overlay_fs);
+  llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files =
+      CreateFileManager(mem_fs);
 
   std::unique_ptr<clang::tooling::ToolInvocation> libtool_inv(
       new clang::tooling::ToolInvocation(argv, std::move(libtool_action),
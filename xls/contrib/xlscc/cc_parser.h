@@ -23,6 +23,7 @@
 #include "clang/include/clang/AST/Decl.h"
 #include "xls/common/thread.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/contrib/xlscc/phase_timer.h"
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 
@@ -110,13 +111,31 @@ class CCParser {
   // source_filename must be .cc
   // Retains references to the TU until ~Translator()
   // This function may only be called once in the lifetime of a CCParser.
+  //
+  // Passing "-include-pch <file>" in command_line_args loads a header
+  //  precompiled by GeneratePrecompiledHeader() instead of parsing it.
   absl::Status ScanFile(std::string_view source_filename,
                         absl::Span<std::string_view> command_line_args);
 
+  // Uses Clang to precompile header_filename, and the headers it includes,
+  //  into pch_filename, so that they are not parsed again by each ScanFile()
+  //  of a source including them.
+  //
+  // command_line_args should match those passed to ScanFile, as Clang
+  //  rejects precompiled headers built with different defines or include
+  //  paths, or whose headers have changed since.
+  static absl::Status GeneratePrecompiledHeader(
+      std::string_view header_filename, std::string_view pch_filename,
+      absl::Span<std::string_view> command_line_args);
+
   // Call after ScanFile, as the top function may be specified by #pragma
   // If none was found, an error is returned
   absl::StatusOr<std::string> GetEntryFunctionName() const;
 
+  // Accumulates the time spent parsing and scanning for pragmas into timer,
+  //  which must outlive the parser. Not timed if nullptr (the default).
+  void SetPhaseTimer(PhaseTimer* timer) { phase_timer_ = timer; }
+
   // Returns a pointer into the AST for the top, or entry, function
   // Returns nullptr if no top function has been found
   absl::StatusOr<const clang::FunctionDecl*> GetTopFunction() const;
@@ -166,6 +185,8 @@ class CCParser {
   // For source location
   absl::flat_hash_map<std::string, int> file_numbers_;
   int next_file_number_ = 1;
+
+  PhaseTimer* phase_timer_ = nullptr;
 };
 
 }  // namespace xlscc
@@ -16,6 +16,8 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
 #include "xls/contrib/xlscc/unit_test.h"
@@ -437,4 +439,41 @@ TEST_F(CCParserTest, TopClass) {
   EXPECT_NE(top_ptr, nullptr);
 }
 
+TEST_F(CCParserTest, PrecompiledHeader) {
+  const std::string header_src = R"(
+    #ifndef STABLE_HEADER_H
+    #define STABLE_HEADER_H
+    template <int N>
+    struct Wrapped {
+      __xls_bits<N> bits;
+    };
+    inline int add(int a, int b) { return a + b; }
+    #endif
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempFile header,
+                           xls::TempFile::CreateWithContent(header_src, ".h"));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::TempFile pch, xls::TempFile::Create(".pch"));
+  const std::string header_path = header.path();
+  const std::string pch_path = pch.path();
+  XLS_ASSERT_OK(xlscc::CCParser::GeneratePrecompiledHeader(
+      header_path, pch_path, absl::Span<std::string_view>()));
+
+  xlscc::CCParser parser;
+  const std::string cpp_src = absl::StrFormat(R"(
+    #include "%s"
+    #pragma hls_top
+    int foo(int a, int b) {
+      Wrapped<3> w;
+      (void)w;
+      return add(a, b);
+    }
+  )",
+                                              header_path);
+
+  XLS_ASSERT_OK(
+      ScanTempFileWithContent(cpp_src, {"-include-pch", pch_path}, &parser));
+  XLS_ASSERT_OK_AND_ASSIGN(const auto* top_ptr, parser.GetTopFunction());
+  EXPECT_NE(top_ptr, nullptr);
+}
+
 }  // namespace
@@ -16,22 +16,36 @@
 // front-end. It accepts as input a C/C++ file and produces as textual output
 // the equivalent XLS intermediate representation (IR).
 
+#include <cstdint>
 #include <cstdlib>
 #include <fstream>
+#include <memory>
+#include <optional>
 #include <streambuf>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "google/protobuf/text_format.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/log_flags.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/contrib/xlscc/cc_parser.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/contrib/xlscc/phase_timer.h"
 #include "xls/contrib/xlscc/translator.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 
 const char kUsage[] = R"(
 Generates XLS IR from a given C++ file, or generates Verilog in the special
@@ -40,9 +54,22 @@ case of a combinational module.
 Emit XLS IR:
 xlscc foo.cc
 
+Emit IR for several top functions, translated concurrently:
+xlscc foo.cc --tops f,g
+
 Emit combinational Verilog module:
 xlscc foo.cc --block_pb block_info.pb
 
+Report the time spent in each phase of translation:
+xlscc foo.cc --timing_out timings.textproto
+
+Emit IR with constant folding, CSE and dead code elimination applied:
+xlscc foo.cc --simplify_ir
+
+Precompile stable headers, then use them:
+xlscc headers.h --pch_out headers.pch
+xlscc foo.cc --pch headers.pch
+
 )";
 
 ABSL_FLAG(std::string, out, "",
@@ -61,6 +88,16 @@ ABSL_FLAG(std::string, top, "", "Top function name");
 
 ABSL_FLAG(std::string, package, "", "Package name to generate");
 
+ABSL_FLAG(std::vector<std::string>, tops, std::vector<std::string>(),
+          "Comma separated list of top functions to translate concurrently, "
+          "each by its own translator, into one package. Helpers shared by "
+          "several tops appear once. The first is the package top. Cannot "
+          "be combined with --top or a block");
+
+ABSL_FLAG(int, tops_max_concurrency, 0,
+          "Maximum number of --tops translated at once, each holding its own "
+          "Clang AST. 0 means as many as the shared thread pool has threads");
+
 ABSL_FLAG(std::string, clang_args_file, "",
           "File containing on each line one command line argument for clang");
 
@@ -70,17 +107,30 @@ ABSL_FLAG(std::vector<std::string>, defines, std::vector<std::string>(),
 ABSL_FLAG(std::vector<std::string>, include_dirs, std::vector<std::string>(),
           "Comma separated list of include directories to pass to clang");
 
+ABSL_FLAG(std::string, pch, "",
+          "Clang precompiled header, generated with --pch_out and the same "
+          "clang arguments, to load instead of parsing the headers in it");
+
+ABSL_FLAG(std::string, pch_out, "",
+          "If specified, precompile the given header file, and the headers it "
+          "includes, into this path instead of generating IR");
+
 ABSL_FLAG(std::string, meta_out, "",
           "Path at which to output metadata protobuf");
 
 ABSL_FLAG(bool, meta_out_text, false, "Output metadata as textproto?");
 
+ABSL_FLAG(std::string, timing_out, "",
+          "Path at which to output, as a TranslationTimings textproto, the "
+          "time spent in each phase of translation and in each function. "
+          "With --tops, the times of the concurrent translations are summed");
+
 ABSL_FLAG(std::string, verilog_line_map_out, "",
           "Path at which to output Verilog line map protobuf");
 
 ABSL_FLAG(bool, error_on_init_interval, false,
-          "Generate an error when an initiation interval is requested greater "
-          "than supported");
+          "Generate an error when an initiation interval less than 1 is "
+          "requested, instead of defaulting to 1");
 
 ABSL_FLAG(int, top_level_init_interval, 1,
           "Initiation interval of block top level (Run/main function)");
@@ -94,12 +144,227 @@ ABSL_FLAG(int, warn_unroll_iters, 100,
 ABSL_FLAG(int, z3_rlimit, -1,
           "rlimit to set for z3 solver (eg for loop unrolling)");
 
+ABSL_FLAG(bool, simplify_ir, false,
+          "Apply constant folding, CSE, select simplification and dead code "
+          "elimination to the IR before writing it");
+
 namespace xlscc {
 
+// Returns the arguments to pass to clang from the command line flags.
+absl::StatusOr<std::vector<std::string>> GetClangArgs() {
+  std::vector<std::string> clang_argvs;
+
+  const std::string clang_args_file = absl::GetFlag(FLAGS_clang_args_file);
+
+  if (!clang_args_file.empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string clang_args_content,
+                         xls::GetFileContents(clang_args_file));
+    for (auto arg :
+         absl::StrSplit(clang_args_content, '\n', absl::SkipWhitespace())) {
+      clang_argvs.push_back(std::string(absl::StripAsciiWhitespace(arg)));
+    }
+  }
+
+  for (std::string& def : absl::GetFlag(FLAGS_defines)) {
+    clang_argvs.push_back(absl::StrCat("-D", def));
+  }
+
+  for (std::string& dir : absl::GetFlag(FLAGS_include_dirs)) {
+    clang_argvs.push_back(absl::StrCat("-I", dir));
+  }
+
+  return clang_argvs;
+}
+
+// Returns the arguments to pass to clang when translating, which also load
+// the precompiled header given by --pch.
+absl::StatusOr<std::vector<std::string>> GetTranslationClangArgs() {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> clang_argvs, GetClangArgs());
+
+  const std::string pch_path = absl::GetFlag(FLAGS_pch);
+  if (!pch_path.empty()) {
+    clang_argvs.push_back("-include-pch");
+    clang_argvs.push_back(pch_path);
+  }
+
+  return clang_argvs;
+}
+
+absl::Status GeneratePrecompiledHeader(std::string_view header_path,
+                                       std::string_view pch_path) {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> clang_argvs, GetClangArgs());
+
+  std::vector<std::string_view> clang_argv(clang_argvs.begin(),
+                                           clang_argvs.end());
+
+  std::cerr << "Precompiling header '" << header_path << "' with clang..."
+            << std::endl;
+  return CCParser::GeneratePrecompiledHeader(header_path, pch_path,
+                                             absl::MakeSpan(clang_argv));
+}
+
+// Writes the times accumulated by timer to the path given by --timing_out,
+// if any.
+absl::Status WriteTimings(const PhaseTimer& timer) {
+  const std::string timing_out_path = absl::GetFlag(FLAGS_timing_out);
+  if (timing_out_path.empty()) {
+    return absl::OkStatus();
+  }
+  return xls::SetTextProtoFile(timing_out_path, timer.ToProto());
+}
+
+// Translates the function top_name of cpp_path into package, with a
+// translator of its own whose times are added to timer.
+absl::Status TranslateTopFunction(std::string_view cpp_path,
+                                  std::string_view top_name,
+                                  absl::Span<std::string_view> clang_argv,
+                                  xls::Package* package, PhaseTimer* timer) {
+  xlscc::Translator translator(absl::GetFlag(FLAGS_error_on_init_interval),
+                               absl::GetFlag(FLAGS_max_unroll_iters),
+                               absl::GetFlag(FLAGS_warn_unroll_iters),
+                               absl::GetFlag(FLAGS_z3_rlimit));
+  XLS_RETURN_IF_ERROR(translator.SelectTop(top_name));
+  XLS_RETURN_IF_ERROR(translator.ScanFile(cpp_path, clang_argv));
+  XLS_RETURN_IF_ERROR(translator.GenerateIR_Top_Function(package).status());
+  translator.AddSourceInfoToPackage(*package);
+  timer->Merge(translator.phase_timer());
+  return absl::OkStatus();
+}
+
+// Renumbers the source locations of package after the file numbers of
+// target, to which it is about to be added.
+void RemapFilenos(xls::Package& package, xls::Package& target) {
+  for (std::unique_ptr<xls::Function>& function : package.functions()) {
+    for (xls::Node* node : function->nodes()) {
+      xls::SourceInfo loc = node->loc();
+      for (xls::SourceLocation& location : loc.locations) {
+        std::optional<std::string> filename =
+            package.GetFilename(location.fileno());
+        if (filename.has_value()) {
+          location = xls::SourceLocation(target.GetOrCreateFileno(*filename),
+                                         location.lineno(), location.colno());
+        }
+      }
+      node->SetLoc(loc);
+    }
+  }
+}
+
+// Adds the functions of top_package to package, callees first. A function
+// package already has by name is a helper also translated for an earlier top:
+// it is not added again, and calls to it are redirected to the existing one.
+absl::Status MergeTopPackage(xls::Package& top_package,
+                             xls::Package& package) {
+  absl::flat_hash_map<const xls::Function*, xls::Function*> call_remapping;
+  for (xls::FunctionBase* function_base :
+       xls::FunctionsInPostOrder(&top_package)) {
+    XLS_RET_CHECK(function_base->IsFunction()) << function_base->name();
+    xls::Function* function = function_base->AsFunctionOrDie();
+    absl::StatusOr<xls::Function*> existing =
+        package.GetFunction(function->name());
+    if (existing.ok()) {
+      call_remapping[function] = *existing;
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        call_remapping[function],
+        function->Clone(function->name(), &package, call_remapping));
+  }
+  return absl::OkStatus();
+}
+
+// Translates the functions given by --tops concurrently on the shared thread
+// pool into separate packages, then merges them in order into a single
+// package so the output does not depend on scheduling. Each translation
+// parses the file with Clang itself: translators keep per-top state in the
+// AST walk, so they cannot share one parse.
+absl::Status RunTops(std::string_view cpp_path) {
+  const std::vector<std::string> tops = absl::GetFlag(FLAGS_tops);
+  if (!absl::GetFlag(FLAGS_top).empty() ||
+      !absl::GetFlag(FLAGS_block_pb).empty() ||
+      !absl::GetFlag(FLAGS_block_from_class).empty()) {
+    return absl::InvalidArgumentError(
+        "--tops cannot be combined with --top, --block_pb or "
+        "--block_from_class");
+  }
+  int64_t max_concurrency = absl::GetFlag(FLAGS_tops_max_concurrency);
+  if (max_concurrency < 0) {
+    return absl::InvalidArgumentError(
+        "--tops_max_concurrency must not be negative");
+  }
+  if (max_concurrency == 0) {
+    max_concurrency = xls::ThreadPool::Default()->thread_count();
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> clang_argvs,
+                       GetTranslationClangArgs());
+  std::vector<std::string_view> clang_argv(clang_argvs.begin(),
+                                           clang_argvs.end());
+
+  std::string package_name = absl::GetFlag(FLAGS_package);
+  if (package_name.empty()) {
+    package_name = "my_package";
+  }
+
+  std::cerr << "Translating " << tops.size() << " top functions in '"
+            << cpp_path << "' concurrently..." << std::endl;
+  std::vector<std::unique_ptr<xls::Package>> top_packages;
+  for (int64_t i = 0; i < tops.size(); ++i) {
+    top_packages.push_back(std::make_unique<xls::Package>(package_name));
+  }
+  std::vector<PhaseTimer> timers(tops.size());
+  std::vector<absl::Status> statuses(tops.size());
+  xls::BoundedParallelFor(0, tops.size(), max_concurrency, [&](int64_t i) {
+    statuses[i] =
+        TranslateTopFunction(cpp_path, tops[i], absl::MakeSpan(clang_argv),
+                             top_packages[i].get(), &timers[i]);
+  });
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  PhaseTimer timer;
+  for (const PhaseTimer& top_timer : timers) {
+    timer.Merge(top_timer);
+  }
+
+  xls::Package package(package_name);
+  for (std::unique_ptr<xls::Package>& top_package : top_packages) {
+    RemapFilenos(*top_package, package);
+    XLS_RETURN_IF_ERROR(MergeTopPackage(*top_package, package));
+  }
+  XLS_RETURN_IF_ERROR(package.SetTopByName(tops.front()));
+
+  if (absl::GetFlag(FLAGS_simplify_ir)) {
+    PhaseTimer::ScopedPhase timed_phase(&timer, kIrSimplificationPhase);
+    XLS_RETURN_IF_ERROR(Translator::SimplifyIR(&package));
+  }
+
+  {
+    PhaseTimer::ScopedPhase timed_phase(&timer, kIrOutputPhase);
+    const std::string ir = absl::StrCat(package.DumpIr(), "\n");
+    const std::string output_file = absl::GetFlag(FLAGS_out);
+    if (output_file.empty()) {
+      std::cout << ir;
+    } else {
+      XLS_RETURN_IF_ERROR(xls::SetFileContents(output_file, ir));
+    }
+  }
+  return WriteTimings(timer);
+}
+
 absl::Status Run(std::string_view cpp_path) {
   // Warnings should print by default
   absl::SetFlag(&FLAGS_logtostderr, true);
 
+  const std::string pch_out_path = absl::GetFlag(FLAGS_pch_out);
+  if (!pch_out_path.empty()) {
+    return GeneratePrecompiledHeader(cpp_path, pch_out_path);
+  }
+
+  if (!absl::GetFlag(FLAGS_tops).empty()) {
+    return RunTops(cpp_path);
+  }
+
   xlscc::Translator translator(absl::GetFlag(FLAGS_error_on_init_interval),
                                absl::GetFlag(FLAGS_max_unroll_iters),
                                absl::GetFlag(FLAGS_warn_unroll_iters),
@@ -132,26 +397,8 @@ absl::Status Run(std::string_view cpp_path) {
         translator.SelectTop(top_function_name, block_from_class_name));
   }
 
-  std::vector<std::string> clang_argvs;
-
-  const std::string clang_args_file = absl::GetFlag(FLAGS_clang_args_file);
-
-  if (!clang_args_file.empty()) {
-    XLS_ASSIGN_OR_RETURN(std::string clang_args_content,
-                         xls::GetFileContents(clang_args_file));
-    for (auto arg :
-         absl::StrSplit(clang_args_content, '\n', absl::SkipWhitespace())) {
-      clang_argvs.push_back(std::string(absl::StripAsciiWhitespace(arg)));
-    }
-  }
-
-  for (std::string& def : absl::GetFlag(FLAGS_defines)) {
-    clang_argvs.push_back(absl::StrCat("-D", def));
-  }
-
-  for (std::string& dir : absl::GetFlag(FLAGS_include_dirs)) {
-    clang_argvs.push_back(absl::StrCat("-I", dir));
-  }
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> clang_argvs,
+                       GetTranslationClangArgs());
 
   std::vector<std::string_view> clang_argv;
   for (const auto& i : clang_argvs) {
@@ -180,7 +427,15 @@ absl::Status Run(std::string_view cpp_path) {
     output_absolute = cwd / output_file;
   }
 
-  auto write_to_output = [&](std::string_view output) -> absl::Status {
+  auto write_to_output = [&](xls::Package& package) -> absl::Status {
+    if (absl::GetFlag(FLAGS_simplify_ir)) {
+      PhaseTimer::ScopedPhase timed_phase(&translator.phase_timer(),
+                                          kIrSimplificationPhase);
+      XLS_RETURN_IF_ERROR(Translator::SimplifyIR(&package));
+    }
+    PhaseTimer::ScopedPhase timed_phase(&translator.phase_timer(),
+                                        kIrOutputPhase);
+    const std::string output = absl::StrCat(package.DumpIr(), "\n");
     if (output_file.empty()) {
       std::cout << output;
     } else {
@@ -193,10 +448,9 @@ absl::Status Run(std::string_view cpp_path) {
   xls::Package package(package_name);
   if (block_pb_name.empty()) {
     XLS_RETURN_IF_ERROR(translator.GenerateIR_Top_Function(&package).status());
-    // TODO(seanhaskell): Simplify IR
     XLS_RETURN_IF_ERROR(package.SetTopByName(top_name));
     translator.AddSourceInfoToPackage(package);
-    XLS_RETURN_IF_ERROR(write_to_output(absl::StrCat(package.DumpIr(), "\n")));
+    XLS_RETURN_IF_ERROR(write_to_output(package));
   } else {
     xls::Proc* proc = nullptr;
 
@@ -219,29 +473,38 @@ absl::Status Run(std::string_view cpp_path) {
     XLS_RETURN_IF_ERROR(package.SetTop(proc));
     std::cerr << "Saving Package IR..." << std::endl;
     translator.AddSourceInfoToPackage(package);
-    XLS_RETURN_IF_ERROR(write_to_output(absl::StrCat(package.DumpIr(), "\n")));
+    XLS_RETURN_IF_ERROR(write_to_output(package));
   }
 
   const std::string metadata_out_path = absl::GetFlag(FLAGS_meta_out);
   if (!metadata_out_path.empty()) {
-    XLS_ASSIGN_OR_RETURN(xlscc_metadata::MetadataOutput meta,
-                         translator.GenerateMetadata());
-
-    if (absl::GetFlag(FLAGS_meta_out_text)) {
-      XLS_RETURN_IF_ERROR(xls::SetTextProtoFile(metadata_out_path, meta));
-    } else {
-      std::ofstream ostr(metadata_out_path);
-      if (!ostr.good()) {
-        return absl::NotFoundError(absl::StrFormat(
-            "Couldn't open metadata output path: %s", metadata_out_path));
-      }
-      if (!meta.SerializeToOstream(&ostr)) {
-        return absl::UnknownError("Error writing metadata proto");
-      }
+    std::ofstream ostr(metadata_out_path);
+    if (!ostr.good()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Couldn't open metadata output path: %s", metadata_out_path));
+    }
+    const bool meta_out_text = absl::GetFlag(FLAGS_meta_out_text);
+
+    // Written a piece at a time, see Translator::GenerateMetadata()
+    XLS_RETURN_IF_ERROR(translator.GenerateMetadata(
+        [&](const xlscc_metadata::MetadataOutput& piece) -> absl::Status {
+          if (meta_out_text) {
+            std::string text;
+            if (!google::protobuf::TextFormat::PrintToString(piece, &text)) {
+              return absl::UnknownError("Error printing metadata proto");
+            }
+            ostr << text;
+          } else if (!piece.SerializeToOstream(&ostr)) {
+            return absl::UnknownError("Error writing metadata proto");
+          }
+          return absl::OkStatus();
+        }));
+    if (!ostr.good()) {
+      return absl::UnknownError("Error writing metadata proto");
     }
   }
 
-  return absl::OkStatus();
+  return WriteTimings(translator.phase_timer());
 }
 
 }  // namespace xlscc
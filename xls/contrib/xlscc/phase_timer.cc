@@ -0,0 +1,103 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/contrib/xlscc/phase_timer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "xls/common/logging/logging.h"
+
+namespace xlscc {
+
+PhaseTimer::ScopedPhase::ScopedPhase(PhaseTimer* timer,
+                                     std::string_view phase)
+    : timer_(timer), phase_(phase), start_(absl::Now()) {
+  if (timer_ != nullptr) {
+    Phase& accumulated = timer_->phases_[phase_];
+    ++accumulated.call_count;
+    ++accumulated.depth;
+  }
+}
+
+PhaseTimer::ScopedPhase::~ScopedPhase() {
+  if (timer_ == nullptr) {
+    return;
+  }
+  Phase& accumulated = timer_->phases_[phase_];
+  if (--accumulated.depth == 0) {
+    accumulated.total += absl::Now() - start_;
+  }
+}
+
+PhaseTimer::ScopedFunction::ScopedFunction(PhaseTimer* timer,
+                                           std::string_view xls_name)
+    : timer_(timer) {
+  if (timer_ != nullptr) {
+    timer_->function_stack_.push_back(RunningFunction{
+        .xls_name = std::string(xls_name), .start = absl::Now()});
+  }
+}
+
+PhaseTimer::ScopedFunction::~ScopedFunction() {
+  if (timer_ == nullptr) {
+    return;
+  }
+  XLS_CHECK(!timer_->function_stack_.empty());
+  RunningFunction function = std::move(timer_->function_stack_.back());
+  timer_->function_stack_.pop_back();
+
+  const absl::Duration elapsed = absl::Now() - function.start;
+  timer_->function_self_times_[function.xls_name] +=
+      elapsed - function.callee_time;
+  if (!timer_->function_stack_.empty()) {
+    timer_->function_stack_.back().callee_time += elapsed;
+  }
+}
+
+void PhaseTimer::Merge(const PhaseTimer& other) {
+  for (const auto& [name, phase] : other.phases_) {
+    Phase& accumulated = phases_[name];
+    accumulated.total += phase.total;
+    accumulated.call_count += phase.call_count;
+  }
+  for (const auto& [name, self_time] : other.function_self_times_) {
+    function_self_times_[name] += self_time;
+  }
+}
+
+xlscc_metadata::TranslationTimings PhaseTimer::ToProto() const {
+  xlscc_metadata::TranslationTimings timings;
+  for (const auto& [name, phase] : phases_) {
+    xlscc_metadata::PhaseTiming* phase_proto = timings.add_phases();
+    phase_proto->set_phase(name);
+    phase_proto->set_total_us(absl::ToInt64Microseconds(phase.total));
+    phase_proto->set_call_count(phase.call_count);
+  }
+
+  std::vector<std::pair<std::string, absl::Duration>> functions(
+      function_self_times_.begin(), function_self_times_.end());
+  std::stable_sort(functions.begin(), functions.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.second > b.second;
+                   });
+  for (const auto& [name, self_time] : functions) {
+    xlscc_metadata::FunctionTiming* function_proto = timings.add_functions();
+    function_proto->set_xls_name(name);
+    function_proto->set_self_us(absl::ToInt64Microseconds(self_time));
+  }
+  return timings;
+}
+
+}  // namespace xlscc
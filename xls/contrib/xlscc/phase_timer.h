@@ -0,0 +1,101 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_CONTRIB_XLSCC_PHASE_TIMER_H_
+#define XLS_CONTRIB_XLSCC_PHASE_TIMER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/time/time.h"
+#include "xls/contrib/xlscc/metadata_output.pb.h"
+
+namespace xlscc {
+
+// Phase names used by the parser and translator
+inline constexpr std::string_view kClangParsePhase = "clang_parse";
+inline constexpr std::string_view kPragmaScanPhase = "pragma_scan";
+inline constexpr std::string_view kTranslationPhase = "translation";
+inline constexpr std::string_view kLoopUnrollingPhase = "loop_unrolling";
+inline constexpr std::string_view kZ3Phase = "z3";
+inline constexpr std::string_view kIrSimplificationPhase = "ir_simplification";
+inline constexpr std::string_view kIrOutputPhase = "ir_output";
+
+// Accumulates the wall time spent in each phase of translation, and in the
+//  translation of each function.
+//
+// Not thread safe: each translator has its own.
+class PhaseTimer {
+ public:
+  // Adds the time from construction to destruction to a phase.
+  // A phase entered again while it is running, such as the unrolling of
+  //  nested loops, is only counted once.
+  // Does nothing if timer is nullptr.
+  class ScopedPhase {
+   public:
+    ScopedPhase(PhaseTimer* timer, std::string_view phase);
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+   private:
+    PhaseTimer* timer_;
+    std::string phase_;
+    absl::Time start_;
+  };
+
+  // Adds the time from construction to destruction to the translation of a
+  //  function, minus the time of the functions translated meanwhile.
+  // Does nothing if timer is nullptr.
+  class ScopedFunction {
+   public:
+    ScopedFunction(PhaseTimer* timer, std::string_view xls_name);
+    ~ScopedFunction();
+
+    ScopedFunction(const ScopedFunction&) = delete;
+    ScopedFunction& operator=(const ScopedFunction&) = delete;
+
+   private:
+    PhaseTimer* timer_;
+  };
+
+  // Adds the times of other, for example of another translator, to these.
+  void Merge(const PhaseTimer& other);
+
+  xlscc_metadata::TranslationTimings ToProto() const;
+
+ private:
+  struct Phase {
+    absl::Duration total;
+    int64_t call_count = 0;
+    int64_t depth = 0;
+  };
+  struct RunningFunction {
+    std::string xls_name;
+    absl::Time start;
+    absl::Duration callee_time;
+  };
+
+  absl::btree_map<std::string, Phase> phases_;
+  absl::btree_map<std::string, absl::Duration> function_self_times_;
+  std::vector<RunningFunction> function_stack_;
+};
+
+}  // namespace xlscc
+
+#endif  // XLS_CONTRIB_XLSCC_PHASE_TIMER_H_
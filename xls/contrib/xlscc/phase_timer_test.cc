@@ -0,0 +1,81 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/contrib/xlscc/phase_timer.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "xls/contrib/xlscc/metadata_output.pb.h"
+
+namespace xlscc {
+namespace {
+
+TEST(PhaseTimerTest, NestedPhaseCountedOnce) {
+  PhaseTimer timer;
+  {
+    PhaseTimer::ScopedPhase outer(&timer, kLoopUnrollingPhase);
+    PhaseTimer::ScopedPhase inner(&timer, kLoopUnrollingPhase);
+    absl::SleepFor(absl::Milliseconds(50));
+  }
+  xlscc_metadata::TranslationTimings timings = timer.ToProto();
+  ASSERT_EQ(timings.phases_size(), 1);
+  EXPECT_EQ(timings.phases(0).phase(), kLoopUnrollingPhase);
+  EXPECT_EQ(timings.phases(0).call_count(), 2);
+  EXPECT_GE(timings.phases(0).total_us(), 50000);
+  // Counted twice, it would be at least twice the time slept.
+  EXPECT_LT(timings.phases(0).total_us(), 2 * 50000);
+}
+
+TEST(PhaseTimerTest, FunctionTimeExcludesCallees) {
+  PhaseTimer timer;
+  {
+    PhaseTimer::ScopedFunction caller(&timer, "caller");
+    absl::SleepFor(absl::Milliseconds(5));
+    {
+      PhaseTimer::ScopedFunction callee(&timer, "callee");
+      absl::SleepFor(absl::Milliseconds(50));
+    }
+  }
+  xlscc_metadata::TranslationTimings timings = timer.ToProto();
+  ASSERT_EQ(timings.functions_size(), 2);
+  // Sorted by decreasing time.
+  EXPECT_EQ(timings.functions(0).xls_name(), "callee");
+  EXPECT_EQ(timings.functions(1).xls_name(), "caller");
+  EXPECT_GE(timings.functions(1).self_us(), 5000);
+  EXPECT_LT(timings.functions(1).self_us(), 50000);
+}
+
+TEST(PhaseTimerTest, NullTimerIgnored) {
+  PhaseTimer::ScopedPhase phase(nullptr, kZ3Phase);
+  PhaseTimer::ScopedFunction function(nullptr, "f");
+}
+
+TEST(PhaseTimerTest, Merge) {
+  PhaseTimer a;
+  PhaseTimer b;
+  { PhaseTimer::ScopedPhase phase(&a, kZ3Phase); }
+  { PhaseTimer::ScopedPhase phase(&b, kZ3Phase); }
+  { PhaseTimer::ScopedPhase phase(&b, kClangParsePhase); }
+  a.Merge(b);
+  xlscc_metadata::TranslationTimings timings = a.ToProto();
+  ASSERT_EQ(timings.phases_size(), 2);
+  EXPECT_EQ(timings.phases(0).phase(), kClangParsePhase);
+  EXPECT_EQ(timings.phases(0).call_count(), 1);
+  EXPECT_EQ(timings.phases(1).phase(), kZ3Phase);
+  EXPECT_EQ(timings.phases(1).call_count(), 2);
+}
+
+}  // namespace
+}  // namespace xlscc
@@ -120,6 +120,8 @@ absl::Status Translator::GenerateExternalChannels(
 
 absl::StatusOr<xls::Proc*> Translator::GenerateIR_Block(
     xls::Package* package, const HLSBlock& block, int top_level_init_interval) {
+  PhaseTimer::ScopedPhase timed_phase(&phase_timer_, kTranslationPhase);
+
   package_ = package;
 
   absl::flat_hash_map<std::string, HLSChannel> channels_by_name;
@@ -283,12 +285,22 @@ absl::StatusOr<xls::Proc*> Translator::GenerateIR_Block(
   XLS_CHECK_EQ(static_next_values.size(), prepared.state_init_count);
   // const xls::BValue next_state = pb.Tuple(static_next_values);
 
-  return pb.Build(prepared.token, static_next_values);
+  XLS_ASSIGN_OR_RETURN(xls::Proc * proc,
+                       pb.Build(prepared.token, static_next_values));
+
+  // The scheduler pipelines the proc at the requested interval
+  if (top_level_init_interval > 1) {
+    proc->SetInitiationInterval(top_level_init_interval);
+  }
+
+  return proc;
 }
 
 absl::StatusOr<xls::Proc*> Translator::GenerateIR_BlockFromClass(
     xls::Package* package, HLSBlock* block_spec_out,
     int top_level_init_interval) {
+  PhaseTimer::ScopedPhase timed_phase(&phase_timer_, kTranslationPhase);
+
   package_ = package;
   block_spec_out->Clear();
 
@@ -81,6 +81,8 @@ absl::Status Translator::GenerateIR_UnrolledLoop(bool always_first_iter,
                                                  const clang::Stmt* body,
                                                  clang::ASTContext& ctx,
                                                  const xls::SourceInfo& loc) {
+  PhaseTimer::ScopedPhase timed_phase(&phase_timer_, kLoopUnrollingPhase);
+
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<xls::solvers::z3::IrTranslator> z3_translator_parent,
       xls::solvers::z3::IrTranslator::CreateAndTranslate(
@@ -705,7 +707,13 @@ absl::Status Translator::GenerateIR_PipelinedLoopBody(
   }
 
   //  xls::BValue next_state = pb.Tuple(next_state_values);
-  XLS_RETURN_IF_ERROR(pb.Build(token, next_state_values).status());
+  XLS_ASSIGN_OR_RETURN(xls::Proc * body_proc,
+                       pb.Build(token, next_state_values));
+
+  // The scheduler pipelines the body proc at the requested interval
+  if (init_interval > 1) {
+    body_proc->SetInitiationInterval(init_interval);
+  }
 
   return absl::OkStatus();
 }
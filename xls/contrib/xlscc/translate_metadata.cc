@@ -171,19 +171,34 @@ absl::Status Translator::GenerateFunctionMetadata(
 }
 
 absl::StatusOr<xlscc_metadata::MetadataOutput> Translator::GenerateMetadata() {
+  xlscc_metadata::MetadataOutput ret;
+  XLS_RETURN_IF_ERROR(GenerateMetadata(
+      [&ret](const xlscc_metadata::MetadataOutput& piece) -> absl::Status {
+        ret.MergeFrom(piece);
+        return absl::OkStatus();
+      }));
+  return ret;
+}
+
+absl::Status Translator::GenerateMetadata(const MetadataWriter& write_piece) {
   XLS_CHECK_NE(parser_.get(), nullptr);
   XLS_ASSIGN_OR_RETURN(const clang::FunctionDecl* top_function,
                        parser_->GetTopFunction());
 
-  xlscc_metadata::MetadataOutput ret;
+  // Each piece holds one entry, and is released once written.
+  xlscc_metadata::MetadataOutput piece;
 
-  parser_->AddSourceInfoToMetadata(ret);
+  parser_->AddSourceInfoToMetadata(piece);
+  XLS_RETURN_IF_ERROR(write_piece(piece));
+  piece.Clear();
 
   absl::flat_hash_set<const clang::NamedDecl*> aliases_used_unordered;
 
   // Top function proto
   XLS_RETURN_IF_ERROR(GenerateFunctionMetadata(
-      top_function, ret.mutable_top_func_proto(), aliases_used_unordered));
+      top_function, piece.mutable_top_func_proto(), aliases_used_unordered));
+  XLS_RETURN_IF_ERROR(write_piece(piece));
+  piece.Clear();
 
   for (auto const& [decl, xls_name] : xls_names_for_functions_generated_) {
     if (auto method_decl = clang::dyn_cast<clang::CXXMethodDecl>(decl);
@@ -202,7 +217,9 @@ absl::StatusOr<xlscc_metadata::MetadataOutput> Translator::GenerateMetadata() {
       }
     }
     XLS_RETURN_IF_ERROR(GenerateFunctionMetadata(
-        decl, ret.add_all_func_protos(), aliases_used_unordered));
+        decl, piece.add_all_func_protos(), aliases_used_unordered));
+    XLS_RETURN_IF_ERROR(write_piece(piece));
+    piece.Clear();
   }
 
   std::list<const clang::NamedDecl*> aliases_used(
@@ -228,15 +245,17 @@ absl::StatusOr<xlscc_metadata::MetadataOutput> Translator::GenerateMetadata() {
       if (ctype_as_struct == nullptr) {
         continue;
       }
-      xlscc_metadata::Type* struct_out = ret.add_structs();
+      xlscc_metadata::Type* struct_out = piece.add_structs();
       XLS_RETURN_IF_ERROR(temp_alias->GetMetadata(
           *this, struct_out->mutable_as_struct()->mutable_name(),
           aliases_dummy));
       XLS_RETURN_IF_ERROR(
           ctype_as_struct->GetMetadata(*this, struct_out, aliases_dummy));
+      XLS_RETURN_IF_ERROR(write_piece(piece));
+      piece.Clear();
     }
   }
-  return ret;
+  return absl::OkStatus();
 }
 
 void Translator::FillLocationProto(
@@ -69,7 +69,14 @@
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/passes/constant_folding_pass.h"
+#include "xls/passes/cse_pass.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/identity_removal_pass.h"
+#include "xls/passes/passes.h"
+#include "xls/passes/select_simplification_pass.h"
 #include "xls/passes/standard_pipeline.h"
+#include "xls/passes/tuple_simplification_pass.h"
 #include "re2/re2.h"
 
 using std::list;
@@ -93,6 +100,7 @@ Translator::Translator(bool error_on_init_interval, int64_t max_unroll_iters,
   } else {
     parser_ = std::make_unique<CCParser>();
   }
+  parser_->SetPhaseTimer(&phase_timer_);
 }
 
 Translator::~Translator() = default;
@@ -594,6 +602,8 @@ absl::StatusOr<GeneratedFunction*> Translator::GenerateIR_Function(
 
   xls_names_for_functions_generated_[funcdecl] = xls_name;
 
+  PhaseTimer::ScopedFunction timed_function(&phase_timer_, xls_name);
+
   xls::FunctionBuilder builder(xls_name, package_);
 
   PushContextGuard context_guard(*this, GetLoc(*funcdecl));
@@ -847,9 +857,74 @@ absl::StatusOr<GeneratedFunction*> Translator::GenerateIR_Function(
   XLS_ASSIGN_OR_RETURN(sf.xls_func,
                        builder.BuildWithReturnValue(context().return_val));
 
+  XLS_RETURN_IF_ERROR(ReleaseTranslationState(sf));
+
+  // Share the XLS function with an identical one already generated.
+  // IO ops refer to nodes in this function, and the top function keeps its
+  //  own name, so these are never shared.
+  if (name_override.empty() && sf.io_ops.empty() &&
+      sf.side_effecting_parameters.empty() && sf.static_values.empty()) {
+    xls::Function* shared = FindOrAddPureFunction(sf.xls_func);
+    if (shared != sf.xls_func) {
+      XLS_RETURN_IF_ERROR(package_->RemoveFunction(sf.xls_func));
+      sf.xls_func = shared;
+      xls_names_for_functions_generated_[funcdecl] = shared->name();
+    }
+  }
+
   return &sf;
 }
 
+static bool LValueHasSelect(const std::shared_ptr<LValue>& lvalue) {
+  if (lvalue == nullptr) {
+    return false;
+  }
+  if (lvalue->is_select()) {
+    return true;
+  }
+  for (const auto& [_, compound_lvalue] : lvalue->get_compounds()) {
+    if (LValueHasSelect(compound_lvalue)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+absl::Status Translator::ReleaseTranslationState(GeneratedFunction& sf) {
+  // Global values are only looked up while translating the body, and refer
+  //  to nodes of its FunctionBuilder, which is gone.
+  sf.global_values.clear();
+
+  // IO ops and lvalue selects refer to nodes of the function which may be
+  //  dead, so these are left for the optimizer.
+  if (!sf.io_ops.empty() || LValueHasSelect(sf.return_lvalue) ||
+      LValueHasSelect(sf.this_lvalue)) {
+    return absl::OkStatus();
+  }
+
+  // Translation leaves behind many unused nodes, for example conditions which
+  //  were folded or loop iterations which were never taken. Removing them now,
+  //  rather than after translating the whole package, bounds the number of
+  //  dead nodes alive at once by the size of one function.
+  xls::PassResults results;
+  return xls::DeadCodeEliminationPass()
+      .RunOnFunctionBase(sf.xls_func, xls::PassOptions(), &results)
+      .status();
+}
+
+xls::Function* Translator::FindOrAddPureFunction(xls::Function* func) {
+  std::vector<xls::Function*>& candidates =
+      pure_functions_by_shape_[std::make_pair(func->GetType()->ToString(),
+                                              func->node_count())];
+  for (xls::Function* candidate : candidates) {
+    if (candidate->IsDefinitelyEqualTo(func)) {
+      return candidate;
+    }
+  }
+  candidates.push_back(func);
+  return func;
+}
+
 absl::StatusOr<std::shared_ptr<CType>> Translator::InterceptBuiltInStruct(
     const clang::RecordDecl* sd) {
   // "__xls_bits" is a special built-in type: CBitsType
@@ -3881,24 +3956,45 @@ absl::StatusOr<xls::Value> Translator::EvaluateNode(xls::Node* node,
 
 absl::Status Translator::ShortCircuitBVal(xls::BValue& bval,
                                           const xls::SourceInfo& loc) {
-  absl::flat_hash_set<xls::Node*> visited;
-  return ShortCircuitNode(bval.node(), bval, nullptr, visited, loc);
+  absl::flat_hash_map<xls::Node*, xls::Node*> replacements;
+  return ShortCircuitNode(bval.node(), bval, nullptr, replacements, loc);
+}
+
+absl::Status Translator::ReplaceShortCircuitedNode(
+    xls::Node* node, xls::Node* replacement, xls::BValue& top_bval,
+    xls::Node* parent, const xls::SourceInfo& loc) {
+  if (parent != nullptr) {
+    XLSCC_CHECK(parent->ReplaceOperand(node, replacement), loc);
+  } else {
+    top_bval = xls::BValue(replacement, context().fb);
+  }
+  return absl::OkStatus();
 }
 
 absl::Status Translator::ShortCircuitNode(
     xls::Node* node, xls::BValue& top_bval, xls::Node* parent,
-    absl::flat_hash_set<xls::Node*>& visited, const xls::SourceInfo& loc) {
-  if (visited.contains(node)) {
-    return absl::OkStatus();
+    absl::flat_hash_map<xls::Node*, xls::Node*>& replacements,
+    const xls::SourceInfo& loc) {
+  // Nodes with several users are replaced in each of them
+  if (auto found = replacements.find(node); found != replacements.end()) {
+    if (found->second == node) {
+      return absl::OkStatus();
+    }
+    return ReplaceShortCircuitedNode(node, found->second, top_bval, parent,
+                                     loc);
   }
 
-  visited.insert(node);
+  replacements[node] = node;
 
   // Depth-first to allow multi-step short circuits
   // Index based to avoid modify while iterating
+  bool operands_literal = true;
   for (int oi = 0; oi < node->operand_count(); ++oi) {
     xls::Node* op = node->operand(oi);
-    XLS_RETURN_IF_ERROR(ShortCircuitNode(op, top_bval, node, visited, loc));
+    XLS_RETURN_IF_ERROR(ShortCircuitNode(op, top_bval, node, replacements,
+                                         loc));
+    operands_literal =
+        operands_literal && node->operand(oi)->Is<xls::Literal>();
   }
 
   // Don't duplicate literals
@@ -3906,20 +4002,20 @@ absl::Status Translator::ShortCircuitNode(
     return absl::OkStatus();
   }
 
-  absl::StatusOr<xls::Value> const_result =
-      EvaluateNode(node, loc, /*do_check=*/false);
-
-  // Try to replace the node with a literal
-  if (const_result.ok()) {
-    xls::BValue literal_bval =
-        context().fb->Literal(const_result.value(), node->loc());
+  // Only nodes whose operands all turned into literals can be constant,
+  // so the IR interpreter is not run again over non-constant operands.
+  if (operands_literal) {
+    absl::StatusOr<xls::Value> const_result =
+        EvaluateNode(node, loc, /*do_check=*/false);
 
-    if (parent != nullptr) {
-      XLSCC_CHECK(parent->ReplaceOperand(node, literal_bval.node()), loc);
-    } else {
-      top_bval = literal_bval;
+    // Try to replace the node with a literal
+    if (const_result.ok()) {
+      xls::BValue literal_bval =
+          context().fb->Literal(const_result.value(), node->loc());
+      replacements[node] = literal_bval.node();
+      return ReplaceShortCircuitedNode(node, literal_bval.node(), top_bval,
+                                       parent, loc);
     }
-    return absl::OkStatus();
   }
 
   if (!((node->op() == xls::Op::kAnd) || (node->op() == xls::Op::kOr))) {
@@ -3944,13 +4040,8 @@ absl::Status Translator::ShortCircuitNode(
     }
 
     // Replace the node with its literal operand
-    if (parent != nullptr) {
-      XLSCC_CHECK(parent->ReplaceOperand(node, op), loc);
-    } else {
-      top_bval = xls::BValue(op, context().fb);
-    }
-
-    return absl::OkStatus();
+    replacements[node] = op;
+    return ReplaceShortCircuitedNode(node, op, top_bval, parent, loc);
   }
 
   return absl::OkStatus();
@@ -4478,6 +4569,15 @@ absl::StatusOr<bool> Translator::BitMustBe(bool assert_value, xls::BValue& bval,
 
   XLS_RETURN_IF_ERROR(ShortCircuitBVal(bval, loc));
 
+  // Conditions which fold to a constant, such as those of loops with
+  // constant bounds, don't need the solver.
+  if (bval.node()->Is<xls::Literal>()) {
+    const xls::Value& const_value = bval.node()->As<xls::Literal>()->value();
+    return assert_value ? const_value.IsAllOnes() : const_value.IsAllZeros();
+  }
+
+  PhaseTimer::ScopedPhase timed_phase(&phase_timer_, kZ3Phase);
+
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<xls::solvers::z3::IrTranslator> z3_translator,
       xls::solvers::z3::IrTranslator::CreateAndTranslate(
@@ -4526,10 +4626,10 @@ GeneratedFunction::GetDeterministicallyOrderedStaticValues() const {
 
 absl::Status Translator::CheckInitIntervalValidity(int initiation_interval_arg,
                                                    const xls::SourceInfo& loc) {
-  if (initiation_interval_arg != 1) {
+  if (initiation_interval_arg < 1) {
     std::string message = ErrorMessage(
         loc,
-        "Only initiation interval 1 supported, %i requested, defaulting to 1",
+        "Initiation interval must be at least 1, %i requested, defaulting to 1",
         initiation_interval_arg);
     if (error_on_init_interval_) {
       return absl::UnimplementedError(message);
@@ -4925,6 +5025,8 @@ absl::Status Translator::SelectTop(std::string_view top_function_name,
 absl::StatusOr<GeneratedFunction*> Translator::GenerateIR_Top_Function(
     xls::Package* package, bool force_static,
     bool member_references_become_channels, int default_init_interval) {
+  PhaseTimer::ScopedPhase timed_phase(&phase_timer_, kTranslationPhase);
+
   const clang::FunctionDecl* top_function = nullptr;
 
   XLS_CHECK_NE(parser_.get(), nullptr);
@@ -4974,6 +5076,21 @@ absl::Status Translator::InlineAllInvokes(xls::Package* package) {
   return absl::OkStatus();
 }
 
+/* static */ absl::Status Translator::SimplifyIR(xls::Package* package) {
+  xls::FixedPointCompoundPass pipeline("xlscc_simp", "XLS[cc] simplification");
+  pipeline.Add<xls::IdentityRemovalPass>();
+  pipeline.Add<xls::ConstantFoldingPass>();
+  pipeline.Add<xls::DeadCodeEliminationPass>();
+  pipeline.Add<xls::CsePass>();
+  pipeline.Add<xls::SelectSimplificationPass>();
+  pipeline.Add<xls::DeadCodeEliminationPass>();
+  pipeline.Add<xls::TupleSimplificationPass>();
+  pipeline.Add<xls::DeadCodeEliminationPass>();
+
+  xls::PassResults results;
+  return pipeline.Run(package, xls::PassOptions(), &results).status();
+}
+
 absl::StatusOr<xls::BValue> Translator::GenTypeConvert(
     CValue const& in, std::shared_ptr<CType> out_type,
     const xls::SourceInfo& loc) {
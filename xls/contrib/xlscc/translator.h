@@ -16,10 +16,12 @@
 #define XLS_CONTRIB_XLSCC_TRANSLATOR_H_
 
 #include <cstdint>
+#include <functional>
 #include <list>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/container/btree_map.h"
@@ -41,6 +43,7 @@
 #include "xls/contrib/xlscc/cc_parser.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/contrib/xlscc/phase_timer.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/caret.h"
 #include "xls/ir/channel.h"
@@ -969,15 +972,35 @@ class Translator {
   //  codegen is done by XLS[cc] for combinational blocks.
   absl::Status InlineAllInvokes(xls::Package* package);
 
+  // Applies cheap local simplifications to generated IR: identity removal,
+  //  constant folding, common subexpression elimination, select and tuple
+  //  simplification, and dead code elimination. These remove most of the
+  //  redundancy translation leaves behind, such as conditions repeated in
+  //  each unrolled iteration, for a fraction of the cost of opt_main.
+  static absl::Status SimplifyIR(xls::Package* package);
+
   // Generate some useful metadata after either GenerateIR_Top_Function() or
   //  GenerateIR_Block() has run.
   absl::StatusOr<xlscc_metadata::MetadataOutput> GenerateMetadata();
+
+  // Generates the same metadata, passing it to write_piece one entry at a
+  //  time as each is generated, so that the whole is never held in memory.
+  // Each piece is a MetadataOutput with a single field set. As protobuf
+  //  parsers merge repeated messages, the pieces concatenated in order, in
+  //  either the binary or the text format, parse as the whole MetadataOutput.
+  using MetadataWriter =
+      std::function<absl::Status(const xlscc_metadata::MetadataOutput&)>;
+  absl::Status GenerateMetadata(const MetadataWriter& write_piece);
   absl::Status GenerateFunctionMetadata(
       const clang::FunctionDecl* func,
       xlscc_metadata::FunctionPrototype* output,
       absl::flat_hash_set<const clang::NamedDecl*>& aliases_used);
   void AddSourceInfoToPackage(xls::Package& package);
 
+  // Time spent so far in each phase of parsing and translation, and in the
+  //  translation of each function.
+  PhaseTimer& phase_timer() { return phase_timer_; }
+
   inline void SetIOTestMode() { io_test_mode_ = true; }
 
  private:
@@ -1226,6 +1249,14 @@ class Translator {
   absl::flat_hash_map<const clang::FunctionDecl*, std::string>
       xls_names_for_functions_generated_;
 
+  // Functions without side effects generated so far, keyed by their type
+  //  and node count, so that identical helpers, such as template
+  //  instantiations whose arguments do not affect the body, share one XLS
+  //  function.
+  absl::flat_hash_map<std::pair<std::string, int64_t>,
+                      std::vector<xls::Function*>>
+      pure_functions_by_shape_;
+
   int next_asm_number_ = 1;
   int next_for_number_ = 1;
 
@@ -1591,6 +1622,12 @@ class Translator {
       const clang::FunctionDecl* funcdecl, std::string_view name_override = "",
       bool force_static = false,
       bool member_references_become_channels = false);
+  // Returns a previously generated pure function definitely equal to func,
+  // or func itself after recording it for later lookups.
+  xls::Function* FindOrAddPureFunction(xls::Function* func);
+  // Called once sf.xls_func is built to free what only its translation
+  //  needed, including its dead nodes where nothing else refers to them.
+  absl::Status ReleaseTranslationState(GeneratedFunction& sf);
 
   absl::Status GenerateThisLValues(const clang::RecordDecl* this_struct_decl,
                                    const std::shared_ptr<CType> thisctype,
@@ -1633,10 +1670,18 @@ class Translator {
                                           const xls::SourceInfo& loc,
                                           bool do_check = true);
 
-  absl::Status ShortCircuitNode(xls::Node* node, xls::BValue& top_bval,
-                                xls::Node* parent,
-                                absl::flat_hash_set<xls::Node*>& visited,
-                                const xls::SourceInfo& loc);
+  // Replaces constant nodes in the cone of node by literals, and and/or
+  //  nodes with a controlling literal operand by that operand. Replacements
+  //  of the nodes visited, or the nodes themselves, are kept in replacements.
+  absl::Status ShortCircuitNode(
+      xls::Node* node, xls::BValue& top_bval, xls::Node* parent,
+      absl::flat_hash_map<xls::Node*, xls::Node*>& replacements,
+      const xls::SourceInfo& loc);
+  absl::Status ReplaceShortCircuitedNode(xls::Node* node,
+                                         xls::Node* replacement,
+                                         xls::BValue& top_bval,
+                                         xls::Node* parent,
+                                         const xls::SourceInfo& loc);
   absl::Status ShortCircuitBVal(xls::BValue& bval, const xls::SourceInfo& loc);
   absl::StatusOr<xls::Value> EvaluateBVal(xls::BValue bval,
                                           const xls::SourceInfo& loc,
@@ -1764,6 +1809,7 @@ class Translator {
   void FillLocationRangeProto(const clang::SourceRange& range,
                               xlscc_metadata::SourceLocationRange* range_out);
 
+  PhaseTimer phase_timer_;
   std::unique_ptr<CCParser> parser_;
 
   // Convenience calls to CCParser
@@ -0,0 +1,202 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/contrib/xlscc/hls_block.pb.h"
+#include "xls/contrib/xlscc/metadata_output.pb.h"
+#include "xls/contrib/xlscc/phase_timer.h"
+#include "xls/contrib/xlscc/translator.h"
+#include "xls/ir/package.h"
+
+// Benchmarks of XLS[cc] translation, from parsing to IR, over the examples and
+// over synthetic sources stressing loop unrolling, Z3 queries and calls.
+//
+// Besides the time per translation, each benchmark reports the average time
+// per translation of each phase timed by PhaseTimer, in microseconds.
+
+namespace xlscc {
+namespace {
+
+// Returns the clang arguments to find xls_int.h and the ac_types headers.
+absl::StatusOr<std::vector<std::string>> GetClangArgs() {
+  XLS_ASSIGN_OR_RETURN(
+      std::filesystem::path ac_int_path,
+      xls::GetXlsRunfilePath(
+          "external/com_github_hlslibs_ac_types/include/ac_int.h"));
+  XLS_ASSIGN_OR_RETURN(
+      std::filesystem::path xls_int_path,
+      xls::GetXlsRunfilePath("xls/contrib/xlscc/synth_only/xls_int.h"));
+  return std::vector<std::string>{
+      absl::StrCat("-I", xls_int_path.parent_path().string()),
+      absl::StrCat("-I", ac_int_path.parent_path().parent_path().string()),
+      "-D__SYNTHESIS__"};
+}
+
+// Translates cpp_path, as a block if block is not null, and adds the time
+// spent in each phase to timer.
+absl::Status Translate(const std::filesystem::path& cpp_path,
+                       const HLSBlock* block, PhaseTimer& timer) {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> clang_args, GetClangArgs());
+  std::vector<std::string_view> clang_argv(clang_args.begin(),
+                                           clang_args.end());
+
+  Translator translator(/*error_on_init_interval=*/false,
+                        /*max_unroll_iters=*/100000);
+  XLS_RETURN_IF_ERROR(
+      translator.ScanFile(cpp_path.string(), absl::MakeSpan(clang_argv)));
+  xls::Package package("my_package");
+  if (block == nullptr) {
+    XLS_RETURN_IF_ERROR(translator.GenerateIR_Top_Function(&package).status());
+  } else {
+    XLS_RETURN_IF_ERROR(translator.GenerateIR_Block(&package, *block).status());
+  }
+  timer.Merge(translator.phase_timer());
+  return absl::OkStatus();
+}
+
+void SetPhaseCounters(benchmark::State& state, const PhaseTimer& timer) {
+  for (const xlscc_metadata::PhaseTiming& phase : timer.ToProto().phases()) {
+    state.counters[absl::StrCat(phase.phase(), "_us")] =
+        benchmark::Counter(static_cast<double>(phase.total_us()),
+                           benchmark::Counter::kAvgIterations);
+  }
+}
+
+void TranslateInLoop(benchmark::State& state,
+                     const std::filesystem::path& cpp_path,
+                     const HLSBlock* block) {
+  PhaseTimer timer;
+  for (auto _ : state) {
+    XLS_CHECK_OK(Translate(cpp_path, block, timer));
+  }
+  SetPhaseCounters(state, timer);
+}
+
+void BM_TranslateExample(benchmark::State& state, std::string_view name) {
+  const std::string example_dir = "xls/contrib/xlscc/examples/";
+  std::filesystem::path cpp_path =
+      xls::GetXlsRunfilePath(absl::StrCat(example_dir, name, ".cc")).value();
+  HLSBlock block;
+  XLS_CHECK_OK(xls::ParseTextProtoFile(
+      xls::GetXlsRunfilePath(absl::StrCat(example_dir, name, ".textproto"))
+          .value(),
+      &block));
+  TranslateInLoop(state, cpp_path, &block);
+}
+
+BENCHMARK_CAPTURE(BM_TranslateExample, mux3, "mux3");
+BENCHMARK_CAPTURE(BM_TranslateExample, mux1to2, "mux1to2");
+BENCHMARK_CAPTURE(BM_TranslateExample, switch, "switch");
+BENCHMARK_CAPTURE(BM_TranslateExample, delay, "delay");
+
+void TranslateSource(benchmark::State& state, std::string_view source) {
+  xls::TempFile temp = xls::TempFile::CreateWithContent(source, ".cc").value();
+  TranslateInLoop(state, temp.path(), /*block=*/nullptr);
+}
+
+// Argument: iteration count of a loop with constant bounds.
+void BM_UnrollConstantLoop(benchmark::State& state) {
+  TranslateSource(state, absl::StrFormat(R"(
+    #pragma hls_top
+    int my_package(int a) {
+      int r = 0;
+      #pragma hls_unroll yes
+      for (int i = 0; i < %d; ++i) {
+        r += a * i;
+      }
+      return r;
+    })",
+                                         state.range(0)));
+}
+
+// Argument: iteration count of each of two nested loops.
+void BM_UnrollNestedLoops(benchmark::State& state) {
+  TranslateSource(state, absl::StrFormat(R"(
+    #pragma hls_top
+    int my_package(int a) {
+      int r = 0;
+      #pragma hls_unroll yes
+      for (int i = 0; i < %1$d; ++i) {
+        #pragma hls_unroll yes
+        for (int j = 0; j < %1$d; ++j) {
+          r ^= (a + i) * j;
+        }
+      }
+      return r;
+    })",
+                                         state.range(0)));
+}
+
+// Argument: iteration count bound of a loop whose exit depends on the input,
+// so that every iteration asks Z3 whether the loop may continue.
+void BM_UnrollDataDependentLoop(benchmark::State& state) {
+  TranslateSource(state, absl::StrFormat(R"(
+    #pragma hls_top
+    int my_package(unsigned int a) {
+      int r = 0;
+      #pragma hls_unroll yes
+      for (unsigned int i = 0; i < %d; ++i) {
+        if (i >= (a & 0xff)) {
+          break;
+        }
+        r += i;
+      }
+      return r;
+    })",
+                                         state.range(0)));
+}
+
+// Argument: length of a chain of functions, each calling the next.
+void BM_TranslateCallChain(benchmark::State& state) {
+  std::string source = "int f0(int a) { return a + 1; }\n";
+  for (int64_t i = 1; i < state.range(0); ++i) {
+    absl::StrAppendFormat(&source, "int f%d(int a) { return f%d(a) * 3; }\n",
+                          i, i - 1);
+  }
+  absl::StrAppendFormat(
+      &source, "#pragma hls_top\nint my_package(int a) { return f%d(a); }\n",
+      state.range(0) - 1);
+  TranslateSource(state, source);
+}
+
+BENCHMARK(BM_UnrollConstantLoop)->Arg(10)->Arg(100)->Arg(1000);
+BENCHMARK(BM_UnrollNestedLoops)->Arg(4)->Arg(16)->Arg(32);
+BENCHMARK(BM_UnrollDataDependentLoop)->Arg(16)->Arg(64)->Arg(256);
+BENCHMARK(BM_TranslateCallChain)->Arg(10)->Arg(100)->Arg(500);
+
+}  // namespace
+}  // namespace xlscc
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  xls::InitXls(argv[0], argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
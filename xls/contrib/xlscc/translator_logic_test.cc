@@ -2037,6 +2037,24 @@ TEST_F(TranslatorLogicTest, MaxUnrollItersEquals) {
       /*max_unroll_iters=*/5);
 }
 
+TEST_F(TranslatorLogicTest, UnrollLongConstantBoundLoop) {
+  const std::string content = R"(
+    #pragma hls_top
+    int foo(int b) {
+      int ret = 0;
+
+      #pragma hls_unroll yes
+      for(int i=3;i<3000;i+=3) {
+        ret += b;
+      }
+      return ret;
+    })";
+  Run({{"b", 2}}, 1998, content,
+      /*loc=*/xabsl::SourceLocation::current(),
+      /*clang_argv=*/{},
+      /*max_unroll_iters=*/1000);
+}
+
 TEST_F(TranslatorLogicTest, ReturnFromForStopsUnrolling) {
   const std::string content = R"(
     #pragma hls_top
@@ -3187,6 +3205,71 @@ TEST_F(TranslatorLogicTest, TemplateFunctionBool) {
   Run({{"a", 3}}, 15, absl::StrFormat(content, "false"));
 }
 
+TEST_F(TranslatorLogicTest, TemplateFunctionIdenticalInstancesShared) {
+  const std::string content = R"(
+      template<typename T>
+      int twice(int a) {
+        return a+a;
+      }
+      int my_package(int a) {
+        return twice<char>(a) + twice<long>(a);
+      })";
+  Run({{"a", 3}}, 12, content);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string source, SourceToIr(content));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::Package> package,
+                           ParsePackage(source));
+  EXPECT_EQ(package->functions().size(), 2);
+}
+
+TEST_F(TranslatorLogicTest, DeadNodesRemovedFromFunctions) {
+  const std::string content = R"(
+      int plus_one(int a) {
+        int unused = a * 5;
+        return a + 1;
+      }
+      int my_package(int a) {
+        int unused = a * 7;
+        return plus_one(a);
+      })";
+  Run({{"a", 3}}, 4, content);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string source, SourceToIr(content));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::Package> package,
+                           ParsePackage(source));
+  for (const std::unique_ptr<xls::Function>& function : package->functions()) {
+    for (const xls::Node* node : function->nodes()) {
+      EXPECT_FALSE(node->op() == xls::Op::kSMul || node->op() == xls::Op::kUMul)
+          << node->ToString();
+    }
+  }
+}
+
+TEST_F(TranslatorLogicTest, SimplifyIR) {
+  const std::string content = R"(
+      #pragma hls_top
+      int my_package(int a) {
+        int r = 0;
+        #pragma hls_unroll yes
+        for (int i = 0; i < 8; ++i) {
+          r += (a + 1) * 2;
+        }
+        return r;
+      })";
+  XLS_ASSERT_OK_AND_ASSIGN(std::string source, SourceToIr(content));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<xls::Package> package,
+                           ParsePackage(source));
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * entry, package->GetTopAsFunction());
+  const int64_t node_count_before = entry->node_count();
+
+  XLS_ASSERT_OK(Translator::SimplifyIR(package.get()));
+  EXPECT_LT(entry->node_count(), node_count_before);
+
+  auto x = DropInterpreterEvents(xls::InterpretFunctionKwargs(
+      entry, {{"a", xls::Value(xls::SBits(3, 32))}}));
+  ASSERT_THAT(x, IsOkAndHolds(xls::Value(xls::SBits(64, 32))));
+}
+
 TEST_F(TranslatorLogicTest, FunctionDeclOrder) {
   const std::string content = R"(
       int do_something(int a);
@@ -1543,6 +1543,61 @@ TEST_F(TranslatorMetadataTest, EnumMember) {
   ASSERT_TRUE(differencer.Compare(meta, ref_meta)) << diff;
 }
 
+TEST_F(TranslatorMetadataTest, WrittenInPieces) {
+  const std::string content = R"(
+    namespace foo {
+      struct Blah {
+        int aa;
+        struct Something {
+          int bb;
+        }s;
+      };
+      int get(Blah a) {
+        return a.aa + a.s.bb;
+      }
+      #pragma hls_top
+      short i_am_top(Blah a, Blah c) {
+        return get(a) + get(c);
+      }
+    })";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, SourceToIr(content, nullptr));
+
+  XLS_ASSERT_OK_AND_ASSIGN(xlscc_metadata::MetadataOutput meta,
+                           translator_->GenerateMetadata());
+
+  int64_t piece_count = 0;
+  std::string binary;
+  std::string text;
+  XLS_ASSERT_OK(translator_->GenerateMetadata(
+      [&](const xlscc_metadata::MetadataOutput& piece) -> absl::Status {
+        ++piece_count;
+        binary += piece.SerializeAsString();
+        std::string piece_text;
+        if (!google::protobuf::TextFormat::PrintToString(piece, &piece_text)) {
+          return absl::UnknownError("Error printing metadata proto");
+        }
+        text += piece_text;
+        return absl::OkStatus();
+      }));
+
+  // Sources, top, 2 functions, 2 structs
+  EXPECT_EQ(piece_count, 6);
+  EXPECT_EQ(meta.all_func_protos_size(), 2);
+  EXPECT_EQ(meta.structs_size(), 2);
+
+  xlscc_metadata::MetadataOutput from_binary;
+  ASSERT_TRUE(from_binary.ParseFromString(binary));
+  xlscc_metadata::MetadataOutput from_text;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(text, &from_text));
+
+  std::string diff;
+  google::protobuf::util::MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&diff);
+  EXPECT_TRUE(differencer.Compare(meta, from_binary)) << diff;
+  EXPECT_TRUE(differencer.Compare(meta, from_text)) << diff;
+}
+
 }  // namespace
 
 }  // namespace xlscc
@@ -776,9 +776,17 @@ TEST_F(TranslatorProcTest, ForPipelinedII2) {
   XLS_ASSERT_OK_AND_ASSIGN(uint64_t top_proc_state_bits,
                            GetStateBitsForProcNameContains("foo"));
   EXPECT_EQ(top_proc_state_bits, 0);
+
+  for (std::unique_ptr<xls::Proc>& proc : package_->procs()) {
+    if (absl::StrContains(proc->name(), "for")) {
+      EXPECT_EQ(proc->GetInitiationInterval(), 2);
+    } else {
+      EXPECT_FALSE(proc->GetInitiationInterval().has_value());
+    }
+  }
 }
 
-TEST_F(TranslatorProcTest, ForPipelinedII2Error) {
+TEST_F(TranslatorProcTest, ForPipelinedII2ErrorOnInitInterval) {
   const std::string content = R"(
     #include "/xls_builtin.h"
 
@@ -814,11 +822,14 @@ TEST_F(TranslatorProcTest, ForPipelinedII2Error) {
                          /*io_test_mode=*/false,
                          /*error_on_init_interval=*/true));
   package_.reset(new xls::Package("my_package"));
-  ASSERT_THAT(
-      translator_->GenerateIR_Block(package_.get(), block_spec).status(),
-      xls::status_testing::StatusIs(
-          absl::StatusCode::kUnimplemented,
-          testing::HasSubstr("nly initiation interval 1")));
+  XLS_ASSERT_OK(
+      translator_->GenerateIR_Block(package_.get(), block_spec).status());
+
+  for (std::unique_ptr<xls::Proc>& proc : package_->procs()) {
+    if (absl::StrContains(proc->name(), "for")) {
+      EXPECT_EQ(proc->GetInitiationInterval(), 2);
+    }
+  }
 }
 
 TEST_F(TranslatorProcTest, WhilePipelined) {
@@ -320,8 +320,9 @@ absl::Status CInstantiableTypeAlias::GetMetadata(
     return absl::OkStatus();
   }
 
-  // Recurse for aliases used in referenced struct
-  {
+  // Recurse for aliases used in referenced struct, unless a previous
+  //  reference already did
+  if (!aliases_used.contains(base_)) {
     XLS_ASSIGN_OR_RETURN(auto resolved,
                          translator.ResolveTypeInstance(temp_alias));
     xlscc_metadata::Type dummy_type;
@@ -61,6 +61,20 @@ void my_function(int& dir,
 }
 """
 
+TOPS_CPP_SRC = """
+int helper(int a) {
+  return a * 3;
+}
+
+int top_f(int a) {
+  return helper(a) + 1;
+}
+
+int top_g(int a, int b) {
+  return helper(a) - helper(b);
+}
+"""
+
 
 class XlsccMainTest(absltest.TestCase):
 
@@ -114,6 +128,25 @@ class XlsccMainTest(absltest.TestCase):
         block_pb_file.full_path
     ])
 
+  def test_gen_ir_tops_is_deterministic(self):
+    cpp_file = self.create_tempfile(file_path="src.cc", content=TOPS_CPP_SRC)
+
+    outputs = []
+    for max_concurrency in ["1", "2", "0", "0"]:
+      outputs.append(
+          subprocess.check_output([
+              XLSCC_MAIN_PATH, cpp_file.full_path, "--tops", "top_f,top_g",
+              "--tops_max_concurrency", max_concurrency
+          ]).decode("utf-8"))
+    for output in outputs[1:]:
+      self.assertEqual(output, outputs[0])
+
+    fn_lines = [
+        line for line in outputs[0].splitlines() if line.startswith("fn ")
+    ]
+    self.assertLen([line for line in fn_lines if "helper" in line], 1)
+    self.assertIn("top fn top_f(", outputs[0])
+
 
 if __name__ == "__main__":
   absltest.main()
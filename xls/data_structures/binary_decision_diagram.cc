@@ -14,60 +14,91 @@
 
 #include "xls/data_structures/binary_decision_diagram.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 
 namespace xls {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
-  // Leaf node 0.
-  nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
-                           /*p=*/1));
-  // Leaf node 1.
+BinaryDecisionDiagram::BinaryDecisionDiagram(int64_t ite_cache_size)
+    : ite_cache_size_(ite_cache_size) {
+  XLS_CHECK_GT(ite_cache_size, 0);
+  XLS_CHECK_EQ(ite_cache_size & (ite_cache_size - 1), 0)
+      << "ITE cache size must be a power of two: " << ite_cache_size;
+  // The terminal node. The uncomplemented edge to it is zero and the
+  // complemented edge is one.
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
 }
 
 BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
                                                     BddNodeIndex high,
-                                                    BddNodeIndex low) {
+                                                    BddNodeIndex low,
+                                                    bool ignore_node_limit) {
+  if (low == high) {
+    return low;
+  }
+  // Keep the low edge uncomplemented by complementing the node instead:
+  //   (var ? high : low) == !(var ? !high : !low)
+  bool complement = IsComplemented(low);
+  if (complement) {
+    high = Not(high);
+    low = Not(low);
+  }
   NodeKey key = std::make_tuple(var, high, low);
   auto it = node_map_.find(key);
   if (it != node_map_.end()) {
-    return it->second;
+    return complement ? Not(it->second) : it->second;
   }
-  if (low == high) {
-    return low;
+  if (!ignore_node_limit && node_limit_ > 0 && size() >= node_limit_) {
+    node_limit_exceeded_ = true;
+    return zero();
   }
   // Compute the number of paths that the new node will have to the terminal
   // nodes 0 and 1. Use int64s to avoid overflowing and saturate at INT32_MAX.
   int32_t paths = std::min(
       static_cast<int64_t>(GetNode(low).path_count) + GetNode(high).path_count,
       static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
-  nodes_.emplace_back(var, high, low, paths);
-  BddNodeIndex node_index = BddNodeIndex(nodes_.size() - 1);
+  int32_t slot;
+  if (free_slots_.empty()) {
+    slot = nodes_.size();
+    nodes_.emplace_back(var, high, low, paths);
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    nodes_[slot] = BddNode(var, high, low, paths);
+  }
+  BddNodeIndex node_index = BddNodeIndex(slot << 1);
   node_map_[key] = node_index;
-  return node_index;
+  return complement ? Not(node_index) : node_index;
 }
 
 BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
                                              bool value) {
-  if (expr == zero() || expr == one()) {
+  if (IsTerminal(expr)) {
     return expr;
   }
 
   const BddNode& node = GetNode(expr);
   XLS_CHECK_LE(var, node.variable);
   if (node.variable == var) {
-    return value ? node.high : node.low;
+    BddNodeIndex child = value ? node.high : node.low;
+    return IsComplemented(expr) ? Not(child) : child;
   }
   return expr;
 }
@@ -75,36 +106,71 @@ BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
 BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                                BddNodeIndex if_true,
                                                BddNodeIndex if_false) {
+  if (node_limit_exceeded_) {
+    return zero();
+  }
   if (cond == one()) {
     return if_true;
   }
   if (cond == zero()) {
     return if_false;
   }
-  if (if_true == one() && if_false == zero()) {
-    return cond;
+  // Replace references to the condition in the branches with constants.
+  if (if_true == cond) {
+    if_true = one();
+  } else if (if_true == Not(cond)) {
+    if_true = zero();
+  }
+  if (if_false == cond) {
+    if_false = zero();
+  } else if (if_false == Not(cond)) {
+    if_false = one();
   }
   if (if_true == if_false) {
     return if_true;
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+  if (if_true == one() && if_false == zero()) {
+    return cond;
+  }
+  if (if_true == zero() && if_false == one()) {
+    return Not(cond);
   }
 
-  // The expression is non-trivial and has not been computed before. Recursively
-  // decompose the expression by peeling away the first variable and performing
-  // a Shannon decomposition.
+  // Normalize the expression so equivalent expressions share a cache entry:
+  // the condition is uncomplemented and so is the if-true branch (by
+  // complementing the result).
+  if (IsComplemented(cond)) {
+    cond = Not(cond);
+    std::swap(if_true, if_false);
+  }
+  bool complement_result = IsComplemented(if_true);
+  if (complement_result) {
+    if_true = Not(if_true);
+    if_false = Not(if_false);
+  }
+
+  if (ite_cache_.empty()) {
+    ite_cache_.resize(ite_cache_size_);
+  }
+  IteCacheEntry& entry =
+      ite_cache_[absl::HashOf(cond, if_true, if_false) & (ite_cache_size_ - 1)];
+  if (entry.cond == cond && entry.if_true == if_true &&
+      entry.if_false == if_false) {
+    return complement_result ? Not(entry.result) : entry.result;
+  }
+
+  // The expression is non-trivial and has not been computed recently.
+  // Recursively decompose the expression by peeling away the first variable
+  // and performing a Shannon decomposition.
 
   // First, find the lowest-index variable amongst all expressions. In all paths
   // through the BDD the variable indices are strictly increasing.
   BddVariable min_var = GetNode(cond).variable;
   // Only non-leaf nodes (not zero or one) have associated variables.
-  if (if_true != zero() && if_true != one()) {
+  if (!IsTerminal(if_true)) {
     min_var = std::min(min_var, GetNode(if_true).variable);
   }
-  if (if_false != zero() && if_false != one()) {
+  if (!IsTerminal(if_false)) {
     min_var = std::min(min_var, GetNode(if_false).variable);
   }
 
@@ -119,32 +185,85 @@ BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
   BddNodeIndex false_cofactor = IfThenElse(Restrict(cond, min_var, false),
                                            Restrict(if_true, min_var, false),
                                            Restrict(if_false, min_var, false));
+  BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
+  if (node_limit_exceeded_) {
+    return zero();
+  }
+  // The recursive calls may have overwritten the entry; that is fine.
+  IteCacheEntry& new_entry =
+      ite_cache_[absl::HashOf(cond, if_true, if_false) & (ite_cache_size_ - 1)];
+  new_entry = IteCacheEntry{.cond = cond,
+                            .if_true = if_true,
+                            .if_false = if_false,
+                            .result = expr};
+  return complement_result ? Not(expr) : expr;
+}
 
-  if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
-    return true_cofactor;
+BddNodeIndex BinaryDecisionDiagram::IfThenElseOrNewVariable(
+    BddNodeIndex cond, BddNodeIndex if_true, BddNodeIndex if_false) {
+  bool previously_exceeded = node_limit_exceeded_;
+  node_limit_exceeded_ = false;
+  BddNodeIndex result = IfThenElse(cond, if_true, if_false);
+  if (node_limit_exceeded_) {
+    return NewVariable();
   }
-  BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
-  return expr;
+  node_limit_exceeded_ = previously_exceeded;
+  return result;
 }
 
 BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   BddVariable var = next_var_;
   ++next_var_;
-  return GetOrCreateNode(var, one(), zero());
-}
-
-BddNodeIndex BinaryDecisionDiagram::Not(BddNodeIndex expr) {
-  return IfThenElse(expr, zero(), one());
+  return GetOrCreateNode(var, one(), zero(), /*ignore_node_limit=*/true);
 }
 
 BddNodeIndex BinaryDecisionDiagram::Or(BddNodeIndex a, BddNodeIndex b) {
-  return IfThenElse(a, one(), b);
+  return IfThenElseOrNewVariable(a, one(), b);
 }
 
 BddNodeIndex BinaryDecisionDiagram::And(BddNodeIndex a, BddNodeIndex b) {
-  return IfThenElse(a, b, zero());
+  return IfThenElseOrNewVariable(a, b, zero());
+}
+
+void BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  // Mark the nodes reachable from the roots and the variable base nodes.
+  std::vector<bool> live(nodes_.size(), false);
+  live[0] = true;
+  std::vector<int32_t> worklist;
+  auto mark = [&](BddNodeIndex expr) {
+    int32_t slot = expr.value() >> 1;
+    if (!live[slot]) {
+      live[slot] = true;
+      worklist.push_back(slot);
+    }
+  };
+  for (BddNodeIndex root : roots) {
+    mark(root);
+  }
+  for (BddVariable var(0); var < next_var_; ++var) {
+    mark(GetVariableBaseNode(var));
+  }
+  while (!worklist.empty()) {
+    const BddNode& node = nodes_[worklist.back()];
+    worklist.pop_back();
+    mark(node.high);
+    mark(node.low);
+  }
+
+  // Sweep the unmarked nodes. Slots already free are unmarked as well so
+  // rebuild the free list from scratch.
+  absl::erase_if(node_map_, [&](const auto& entry) {
+    return !live[entry.second.value() >> 1];
+  });
+  free_slots_.clear();
+  for (int32_t slot = nodes_.size() - 1; slot > 0; --slot) {
+    if (!live[slot]) {
+      nodes_[slot] = BddNode();
+      free_slots_.push_back(slot);
+    }
+  }
+  ite_cache_.clear();
 }
 
 absl::StatusOr<bool> BinaryDecisionDiagram::Evaluate(
@@ -165,15 +284,16 @@ absl::StatusOr<bool> BinaryDecisionDiagram::Evaluate(
                   << variable_values.at(node);
     }
   }
-  while (result != zero() && result != one()) {
+  while (!IsTerminal(result)) {
     BddNodeIndex var_node = GetVariableBaseNode(GetNode(result).variable);
     if (!variable_values.contains(var_node)) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Missing value for BDD variable %d (node index %d)",
                           GetNode(result).variable.value(), var_node.value()));
     }
-    result = variable_values.at(var_node) ? GetNode(result).high
-                                          : GetNode(result).low;
+    BddNodeIndex child = variable_values.at(var_node) ? GetNode(result).high
+                                                      : GetNode(result).low;
+    result = IsComplemented(result) ? Not(child) : child;
   }
   XLS_VLOG(2) << "  result = " << (result == one() ? true : false);
   return result == one();
@@ -204,11 +324,14 @@ void BinaryDecisionDiagram::ToStringDnfHelper(BddNodeIndex expr,
     return;
   }
 
+  // The complement of the edge applies to both children.
   const BddNode& node = GetNode(expr);
+  BddNodeIndex high = IsComplemented(expr) ? Not(node.high) : node.high;
+  BddNodeIndex low = IsComplemented(expr) ? Not(node.low) : node.low;
   terms->push_back(absl::StrCat("x", node.variable.value()));
-  ToStringDnfHelper(node.high, minterms_to_emit, terms, str);
+  ToStringDnfHelper(high, minterms_to_emit, terms, str);
   terms->back() = absl::StrCat("!x", node.variable.value());
-  ToStringDnfHelper(node.low, minterms_to_emit, terms, str);
+  ToStringDnfHelper(low, minterms_to_emit, terms, str);
   terms->pop_back();
 }
 
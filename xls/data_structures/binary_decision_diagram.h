@@ -16,9 +16,13 @@
 #define XLS_DATA_STRUCTURES_BINARY_DECISION_DIAGRAM_H_
 
 #include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -31,15 +35,24 @@ namespace xls {
 //   K.S. Brace, R.L. Rudell, and R.E. Bryant,
 //   "Efficient Implementation of a BDD package"
 //   https://ieeexplore.ieee.org/document/114826
+//
+// As described there, the BDD uses complement edges (so negation is free and
+// an expression and its inverse share all nodes) and a fixed-size lossy cache
+// of the results of if-then-else operations. Nodes which are no longer needed
+// may be freed with GarbageCollect and the number of nodes may be bounded with
+// set_node_limit.
 
 // For efficiency variables and nodes are referred to by indices into vector
-// data members in the BDD.
+// data members in the BDD. A BddNodeIndex refers to an *edge* to a node: the
+// index of the node in the upper bits and in the lowest bit whether the edge
+// is complemented (i.e., refers to the inverse of the node's expression).
 DEFINE_STRONG_INT_TYPE(BddVariable, int32_t);
 DEFINE_STRONG_INT_TYPE(BddNodeIndex, int32_t);
 
 // A node in the BDD. The node is associated with a single variable and has
 // children corresponding to when the variable is true (high) and when it is
-// false (low).
+// false (low). The children are edges relative to the uncomplemented node. The
+// low edge is never complemented which makes the representation canonical.
 struct BddNode {
   BddNode() : variable(0), high(0), low(0), path_count(0) {}
   BddNode(BddVariable v, BddNodeIndex h, BddNodeIndex l, int32_t p)
@@ -57,22 +70,31 @@ struct BddNode {
 
 class BinaryDecisionDiagram {
  public:
-  // Creates an empty BDD. Initialize the BDD contains only the nodes
-  // corresponding to zero and one.
-  BinaryDecisionDiagram();
+  // The default number of entries in the cache of if-then-else results.
+  static constexpr int64_t kDefaultIteCacheSize = int64_t{1} << 16;
+
+  // Creates an empty BDD. Initially the BDD contains only the terminal node
+  // (zero and one are edges to it). `ite_cache_size` is the number of entries
+  // of the cache of if-then-else results and must be a power of two.
+  explicit BinaryDecisionDiagram(int64_t ite_cache_size = kDefaultIteCacheSize);
 
   // Adds a new variable to the BDD and returns the node corresponding the
-  // variable's value.
+  // variable's value. Variables are created regardless of the node limit.
   BddNodeIndex NewVariable();
 
-  // Returns the inverse of the given expression.
-  BddNodeIndex Not(BddNodeIndex expr);
+  // Returns the inverse of the given expression. Never creates nodes.
+  BddNodeIndex Not(BddNodeIndex expr) const {
+    return BddNodeIndex(expr.value() ^ 1);
+  }
 
-  // Returns the OR/AND of the given expressions.
+  // Returns the OR/AND of the given expressions. If the node limit is reached
+  // while constructing the result, returns a new variable instead (i.e., an
+  // expression about which nothing is known) and sets node_limit_exceeded.
   BddNodeIndex And(BddNodeIndex a, BddNodeIndex b);
   BddNodeIndex Or(BddNodeIndex a, BddNodeIndex b);
 
-  // Returns the leaf node corresponding to zero or one.
+  // Returns the leaf node corresponding to zero or one. Both are edges to the
+  // single terminal node.
   BddNodeIndex zero() const { return BddNodeIndex(0); }
   BddNodeIndex one() const { return BddNodeIndex(1); }
 
@@ -84,13 +106,13 @@ class BinaryDecisionDiagram {
       BddNodeIndex expr,
       const absl::flat_hash_map<BddNodeIndex, bool>& variable_values) const;
 
-  // Returns the BDD node with the given index.
+  // Returns the BDD node the given edge refers to, ignoring complementation.
   const BddNode& GetNode(BddNodeIndex node_index) const {
-    return nodes_.at(node_index.value());
+    return nodes_.at(node_index.value() >> 1);
   }
 
-  // Returns the number of nodes in the graph.
-  int64_t size() const { return nodes_.size(); }
+  // Returns the number of live nodes in the graph.
+  int64_t size() const { return nodes_.size() - free_slots_.size(); }
 
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return next_var_.value(); }
@@ -109,28 +131,60 @@ class BinaryDecisionDiagram {
   // variable. The expression of a base node is exactly equal to the value of
   // the variable.
   bool IsVariableBaseNode(BddNodeIndex expr) const {
-    return GetNode(expr).high == one() && GetNode(expr).low == zero();
+    return !IsComplemented(expr) && !IsTerminal(expr) &&
+           GetNode(expr).high == one() && GetNode(expr).low == zero();
   }
 
+  // Limits the number of live nodes (see size()) to `limit`. Zero means no
+  // limit. Operations which would exceed the limit return new variables as
+  // described at And/Or.
+  void set_node_limit(int64_t limit) { node_limit_ = limit; }
+  int64_t node_limit() const { return node_limit_; }
+
+  // Returns whether an operation hit the node limit since the flag was last
+  // cleared.
+  bool node_limit_exceeded() const { return node_limit_exceeded_; }
+  void ClearNodeLimitExceeded() { node_limit_exceeded_ = false; }
+
+  // Frees the nodes which are not reachable from any of `roots` (or from the
+  // base nodes of the variables) and makes their slots available for reuse.
+  // Edges to the remaining nodes are unaffected. Any other edge becomes
+  // invalid. Clears the cache of if-then-else results.
+  void GarbageCollect(absl::Span<const BddNodeIndex> roots);
+
  private:
+  static bool IsComplemented(BddNodeIndex expr) {
+    return (expr.value() & 1) != 0;
+  }
+  static bool IsTerminal(BddNodeIndex expr) { return (expr.value() >> 1) == 0; }
+
   // Helper for constructing a DNF string respresentation.
   void ToStringDnfHelper(BddNodeIndex expr, int64_t* minterms_to_emit,
                          std::vector<std::string>* terms,
                          std::string* str) const;
 
   // Get the node corresponding to the given variable with the given low/high
-  // children. Creates it if it does not exist.
+  // children. Creates it if it does not exist. If creation would exceed the
+  // node limit (and `ignore_node_limit` is false) sets node_limit_exceeded_
+  // and returns an arbitrary edge.
   BddNodeIndex GetOrCreateNode(BddVariable var, BddNodeIndex high,
-                               BddNodeIndex low);
+                               BddNodeIndex low,
+                               bool ignore_node_limit = false);
 
   // Returns the node equal to given expression with the given variable
   // set to the given value.
   BddNodeIndex Restrict(BddNodeIndex expr, BddVariable var, bool value);
 
-  // Returns the node corresponding to the given if-then-else expression.
+  // Returns the node corresponding to the given if-then-else expression. The
+  // result is meaningless if node_limit_exceeded_ is set on return.
   BddNodeIndex IfThenElse(BddNodeIndex cond, BddNodeIndex if_true,
                           BddNodeIndex if_false);
 
+  // Returns IfThenElse of the given operands, or a new variable if the node
+  // limit is exceeded while computing it.
+  BddNodeIndex IfThenElseOrNewVariable(BddNodeIndex cond, BddNodeIndex if_true,
+                                       BddNodeIndex if_false);
+
   // Returns the node corresponding to the value of the given variable.
   BddNodeIndex GetVariableBaseNode(BddVariable variable) const {
     return node_map_.at({variable, one(), zero()});
@@ -140,20 +194,32 @@ class BinaryDecisionDiagram {
   // call to NewVariable which
   BddVariable next_var_ = BddVariable(0);
 
-  // The vector of all the nodes in the BDD.
+  // The vector of all the nodes in the BDD. Slot zero holds the terminal node.
   std::vector<BddNode> nodes_;
 
+  // The slots of nodes_ freed by garbage collection.
+  std::vector<int32_t> free_slots_;
+
   // A map from BDD node content (variable id, high child, low child) to the
-  // index of the respective node. This map is used to ensure that no duplicate
-  // nodes are created.
+  // (uncomplemented) edge of the respective node. This map is used to ensure
+  // that no duplicate nodes are created.
   using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
   absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
 
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  // A direct-mapped cache from normalized if-then-else expression (condition,
+  // if-true, if-false) to the resulting edge. Colliding entries overwrite each
+  // other so the memory used is bounded. Allocated on first use.
+  struct IteCacheEntry {
+    BddNodeIndex cond = BddNodeIndex(-1);
+    BddNodeIndex if_true;
+    BddNodeIndex if_false;
+    BddNodeIndex result;
+  };
+  int64_t ite_cache_size_;
+  std::vector<IteCacheEntry> ite_cache_;
+
+  int64_t node_limit_ = 0;
+  bool node_limit_exceeded_ = false;
 };
 
 }  // namespace xls
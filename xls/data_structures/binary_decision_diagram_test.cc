@@ -14,6 +14,9 @@
 
 #include "xls/data_structures/binary_decision_diagram.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/inlined_vector.h"
@@ -251,6 +254,88 @@ TEST(BinaryDecisionDiagramTest, Parity) {
               IsOkAndHolds(false));
 }
 
+TEST(BinaryDecisionDiagramTest, ComplementEdges) {
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex x0 = bdd.NewVariable();
+  BddNodeIndex x1 = bdd.NewVariable();
+  BddNodeIndex x0_and_x1 = bdd.And(x0, x1);
+
+  // Negation never creates nodes and is an involution.
+  int64_t before_size = bdd.size();
+  EXPECT_EQ(bdd.Not(bdd.Not(x0_and_x1)), x0_and_x1);
+  EXPECT_EQ(bdd.Not(bdd.zero()), bdd.one());
+  EXPECT_EQ(bdd.size(), before_size);
+
+  // An expression and its inverse share nodes: by De Morgan's law the NAND
+  // is the OR of the negated variables.
+  EXPECT_EQ(bdd.Or(bdd.Not(x0), bdd.Not(x1)), bdd.Not(x0_and_x1));
+  EXPECT_EQ(bdd.size(), before_size);
+  EXPECT_FALSE(bdd.IsVariableBaseNode(bdd.Not(x0)));
+  EXPECT_TRUE(bdd.IsVariableBaseNode(x0));
+  EXPECT_EQ(bdd.ToStringDnf(bdd.Not(x0_and_x1)), "x0.!x1 + !x0");
+}
+
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> variables;
+  for (int64_t i = 0; i < 8; ++i) {
+    variables.push_back(bdd.NewVariable());
+  }
+  BddNodeIndex x0_and_x1 = bdd.And(variables[0], variables[1]);
+  int64_t live_size = bdd.size();
+  BddNodeIndex parity = bdd.zero();
+  for (BddNodeIndex variable : variables) {
+    parity = bdd.Or(bdd.And(parity, bdd.Not(variable)),
+                    bdd.And(bdd.Not(parity), variable));
+  }
+  EXPECT_GT(bdd.size(), live_size);
+
+  // Only the nodes of the roots and the variables survive and the roots still
+  // evaluate correctly.
+  bdd.GarbageCollect({x0_and_x1});
+  EXPECT_EQ(bdd.size(), live_size);
+  absl::flat_hash_map<BddNodeIndex, bool> values;
+  for (BddNodeIndex variable : variables) {
+    values[variable] = true;
+  }
+  EXPECT_THAT(bdd.Evaluate(x0_and_x1, values), IsOkAndHolds(true));
+  values[variables[1]] = false;
+  EXPECT_THAT(bdd.Evaluate(bdd.Not(x0_and_x1), values), IsOkAndHolds(true));
+
+  // Freed slots are reused and hash-consing still finds the live nodes.
+  EXPECT_EQ(bdd.And(variables[1], variables[0]), x0_and_x1);
+  BddNodeIndex x2_or_x3 = bdd.Or(variables[2], variables[3]);
+  EXPECT_EQ(bdd.size(), live_size + 1);
+  values[variables[2]] = false;
+  values[variables[3]] = false;
+  EXPECT_THAT(bdd.Evaluate(x2_or_x3, values), IsOkAndHolds(false));
+}
+
+TEST(BinaryDecisionDiagramTest, NodeLimit) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> variables;
+  for (int64_t i = 0; i < 8; ++i) {
+    variables.push_back(bdd.NewVariable());
+  }
+  bdd.set_node_limit(bdd.size() + 3);
+  BddNodeIndex x0_and_x1 = bdd.And(variables[0], variables[1]);
+  BddNodeIndex x2_and_x3 = bdd.And(variables[2], variables[3]);
+  EXPECT_FALSE(bdd.node_limit_exceeded());
+
+  // The result of an operation exceeding the limit is a new variable.
+  BddNodeIndex result = bdd.Or(x0_and_x1, x2_and_x3);
+  EXPECT_TRUE(bdd.node_limit_exceeded());
+  EXPECT_TRUE(bdd.IsVariableBaseNode(result));
+  EXPECT_EQ(bdd.variable_count(), 9);
+
+  // Garbage collection makes room for new nodes.
+  bdd.ClearNodeLimitExceeded();
+  bdd.GarbageCollect({x2_and_x3});
+  BddNodeIndex x1_and_x2_and_x3 = bdd.And(variables[1], x2_and_x3);
+  EXPECT_FALSE(bdd.node_limit_exceeded());
+  EXPECT_FALSE(bdd.IsVariableBaseNode(x1_and_x2_and_x3));
+}
+
 TEST(BinaryDecisionDiagramTest, ThreeVariableExhaustive) {
   // Generate all three-variable boolean functions and test each with all
   // possible inputs.
@@ -14,10 +14,17 @@
 
 #include "xls/data_structures/binary_search.h"
 
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 
 namespace xls {
 
@@ -103,4 +110,77 @@ absl::StatusOr<int64_t> BinarySearchMinTrueWithStatus(
   return lowest_true;
 }
 
+namespace {
+
+// Evaluates `f` at each of `values` concurrently on the shared thread pool,
+// passing worker index i with the i-th value.
+// Returns the results in the order of `values`, or the first error in that
+// order.
+absl::StatusOr<std::vector<bool>> ProbeConcurrently(
+    absl::Span<const int64_t> values,
+    absl::FunctionRef<absl::StatusOr<bool>(int64_t i, int64_t worker)> f) {
+  std::vector<std::optional<absl::StatusOr<bool>>> results(values.size());
+  ParallelFor(0, values.size(), [&](int64_t worker) {
+    results[worker] = f(values[worker], worker);
+  });
+  std::vector<bool> probes;
+  for (std::optional<absl::StatusOr<bool>>& result : results) {
+    XLS_ASSIGN_OR_RETURN(bool probe, *std::move(result));
+    probes.push_back(probe);
+  }
+  return probes;
+}
+
+}  // namespace
+
+absl::StatusOr<int64_t> KarySearchMinTrueWithStatus(
+    int64_t start, int64_t end, int64_t parallelism,
+    absl::FunctionRef<absl::StatusOr<bool>(int64_t i, int64_t worker)> f) {
+  XLS_RET_CHECK_LE(start, end);
+  XLS_RET_CHECK_GE(parallelism, 1);
+  std::vector<int64_t> bounds = {end};
+  if (start != end && parallelism > 1) {
+    bounds.push_back(start);
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<bool> f_bounds,
+                       ProbeConcurrently(bounds, f));
+  if (!f_bounds[0]) {
+    return absl::InvalidArgumentError(
+        "Highest value in range fails condition of binary search.");
+  }
+  if (bounds.size() == 1) {
+    XLS_ASSIGN_OR_RETURN(bool f_start, f(start, 0));
+    f_bounds.push_back(f_start);
+  }
+  if (f_bounds[1]) {
+    return start;
+  }
+  int64_t highest_false = start;
+  int64_t lowest_true = end;
+  while (highest_false < lowest_true - 1) {
+    // Split the interval (highest_false, lowest_true) into k + 1 parts of
+    // nearly equal size.
+    int64_t gap = lowest_true - highest_false;
+    int64_t k = std::min(parallelism, gap - 1);
+    std::vector<int64_t> values;
+    for (int64_t i = 1; i <= k; ++i) {
+      int64_t value = highest_false + (gap * i) / (k + 1);
+      if (value > highest_false && value < lowest_true &&
+          (values.empty() || value > values.back())) {
+        values.push_back(value);
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<bool> probes,
+                         ProbeConcurrently(values, f));
+    for (int64_t i = 0; i < values.size(); ++i) {
+      if (probes[i]) {
+        lowest_true = values[i];
+        break;
+      }
+      highest_false = values[i];
+    }
+  }
+  return lowest_true;
+}
+
 }  // namespace xls
@@ -44,6 +44,18 @@ absl::StatusOr<int64_t> BinarySearchMinTrueWithStatus(
     int64_t start, int64_t end,
     absl::FunctionRef<absl::StatusOr<bool>(int64_t i)> f);
 
+// Variant of BinarySearchMinTrueWithStatus which evaluates up to
+// `parallelism` values concurrently on the shared thread pool. Each round
+// probes evenly spaced values strictly inside the interval of uncertainty,
+// narrowing it by a factor of (number of probes + 1). `f` is called with the
+// value to probe and the index of the worker, in [0, parallelism), probing it;
+// calls made concurrently always have distinct worker indices so `f` may keep
+// per-worker state without synchronization. If any probe of a round returns an
+// error the error of the smallest probed value is returned.
+absl::StatusOr<int64_t> KarySearchMinTrueWithStatus(
+    int64_t start, int64_t end, int64_t parallelism,
+    absl::FunctionRef<absl::StatusOr<bool>(int64_t i, int64_t worker)> f);
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_BINARY_SEARCH_H_
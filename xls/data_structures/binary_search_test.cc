@@ -14,6 +14,9 @@
 
 #include "xls/data_structures/binary_search.h"
 
+#include <atomic>
+#include <cstdint>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
@@ -80,6 +83,47 @@ TEST(BinarySearchTest, MinTrueWithStatus) {
   }
 }
 
+TEST(BinarySearchTest, KaryMinTrueWithStatus) {
+  const int64_t kMaxSize = 10;
+  for (int64_t parallelism = 1; parallelism <= 4; ++parallelism) {
+    for (int start = 0; start < kMaxSize; ++start) {
+      for (int end = start; end < kMaxSize; ++end) {
+        for (int target = start; target <= end; ++target) {
+          auto got = KarySearchMinTrueWithStatus(
+              start, end, parallelism,
+              [&](int64_t i, int64_t worker) -> absl::StatusOr<bool> {
+                EXPECT_GE(worker, 0);
+                EXPECT_LT(worker, parallelism);
+                return i >= target;
+              });
+          EXPECT_THAT(got, IsOkAndHolds(target));
+        }
+      }
+    }
+  }
+}
+
+TEST(BinarySearchTest, KaryNumRounds) {
+  // Each round of probes narrows the interval by a factor of five.
+  std::atomic<int64_t> f_called = 0;
+  auto f = [&](int64_t i, int64_t worker) -> absl::StatusOr<bool> {
+    f_called++;
+    return i >= 123456;
+  };
+  EXPECT_THAT(KarySearchMinTrueWithStatus(0, 1024 * 1024, 4, f),
+              IsOkAndHolds(123456));
+  EXPECT_LT(f_called, 2 + 4 * 10);
+
+  auto g = [&](int64_t i, int64_t worker) -> absl::StatusOr<bool> {
+    if (i > 0 && i < 100) {
+      return absl::UnimplementedError("qux");
+    }
+    return i >= 100;
+  };
+  EXPECT_THAT(KarySearchMinTrueWithStatus(0, 200, 4, g),
+              StatusIs(absl::StatusCode::kUnimplemented, HasSubstr("qux")));
+}
+
 TEST(BinarySearchTest, NumTimesFunctionCalled) {
   int64_t f_called = 0;
   // Note: some compilers dislike the lambda living inside the macro, so we
@@ -0,0 +1,140 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/graph_coloring.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+// Returns the number of bits set in both `a` and `b`.
+int64_t CountIntersection(const InlineBitmap& a, const InlineBitmap& b) {
+  int64_t count = 0;
+  for (int64_t wordno = 0; wordno < a.word_count(); ++wordno) {
+    count += absl::popcount(a.GetWord(wordno) & b.GetWord(wordno));
+  }
+  return count;
+}
+
+// Calls `f` with the index of each bit set in `a` but not in `b`, in ascending
+// order.
+template <typename F>
+void ForEachInDifference(const InlineBitmap& a, const InlineBitmap& b, F f) {
+  for (int64_t wordno = 0; wordno < a.word_count(); ++wordno) {
+    uint64_t word = a.GetWord(wordno) & ~b.GetWord(wordno);
+    while (word != 0) {
+      f(wordno * 64 + absl::countr_zero(word));
+      word &= word - 1;
+    }
+  }
+}
+
+// Finds a maximal independent set of the subgraph induced by `uncolored`. This
+// mirrors FindMaximalIndependentSet, including its tie-breaking.
+std::vector<int64_t> FindMaximalIndependentSet(
+    absl::Span<const InlineBitmap> adjacency, const InlineBitmap& uncolored) {
+  const int64_t n = adjacency.size();
+  const InlineBitmap empty(n);
+  std::vector<int64_t> result;         // named S in the book
+  InlineBitmap available = uncolored;  // named X
+  InlineBitmap neighboring_result(n);  // named Y
+
+  auto add_to_result = [&](int64_t vertex) {
+    result.push_back(vertex);
+    for (int64_t wordno = 0; wordno < neighboring_result.word_count();
+         ++wordno) {
+      neighboring_result.SetWord(
+          wordno, neighboring_result.GetWord(wordno) |
+                      (adjacency[vertex].GetWord(wordno) &
+                       uncolored.GetWord(wordno)));
+    }
+    available.Set(vertex, false);
+  };
+
+  // Initialize result to contain only the vertex with highest degree.
+  {
+    int64_t largest_neighborhood = 0;
+    int64_t vertex_with_most_neighbors = -1;
+    ForEachInDifference(available, empty, [&](int64_t vertex) {
+      int64_t neighborhood_size =
+          CountIntersection(adjacency[vertex], uncolored);
+      if (neighborhood_size >= largest_neighborhood) {
+        largest_neighborhood = neighborhood_size;
+        vertex_with_most_neighbors = vertex;
+      }
+    });
+    add_to_result(vertex_with_most_neighbors);
+  }
+
+  while (true) {
+    // Choose the vertex maximizing (neighbors in Y, -neighbors in X), ordered
+    // lexicographically; see FindMaximalIndependentSet.
+    std::pair<int64_t, int64_t> measure = {-1, -1};
+    int64_t best = -1;
+    ForEachInDifference(available, neighboring_result, [&](int64_t vertex) {
+      std::pair<int64_t, int64_t> vertex_measure{
+          CountIntersection(adjacency[vertex], neighboring_result),
+          -CountIntersection(adjacency[vertex], available)};
+      if (vertex_measure > measure) {
+        best = vertex;
+        measure = vertex_measure;
+      }
+    });
+    if (best == -1) {
+      break;
+    }
+    add_to_result(best);
+  }
+
+  return result;
+}
+
+}  // namespace
+
+std::vector<std::vector<int64_t>> RecursiveLargestFirstColoring(
+    absl::Span<const InlineBitmap> adjacency, absl::Duration time_limit) {
+  const absl::Time deadline = absl::Now() + time_limit;
+  const int64_t n = adjacency.size();
+  const InlineBitmap empty(n);
+  std::vector<std::vector<int64_t>> result;
+  InlineBitmap uncolored(n, /*fill=*/true);
+  while (!uncolored.IsAllZeroes()) {
+    if (absl::Now() > deadline) {
+      ForEachInDifference(uncolored, empty, [&](int64_t vertex) {
+        result.push_back({vertex});
+      });
+      break;
+    }
+    std::vector<int64_t> chosen =
+        FindMaximalIndependentSet(adjacency, uncolored);
+    for (int64_t vertex : chosen) {
+      uncolored.Set(vertex, false);
+    }
+    std::sort(chosen.begin(), chosen.end());
+    result.push_back(std::move(chosen));
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -15,14 +15,19 @@
 #ifndef XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
 #define XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
 
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "../z3/src/api/c++/z3++.h"
 
 namespace xls {
@@ -150,6 +155,21 @@ std::vector<absl::flat_hash_set<V>> RecursiveLargestFirstColoring(
   return result;
 }
 
+// Color the graph with vertices [0, adjacency.size()) using the Recursive
+// Largest First algorithm, as above. Bit j of `adjacency[i]` is set iff i and j
+// are neighbors; the relation must be symmetric. Candidate sets are kept as
+// bitmaps so each step of the algorithm is a handful of word-wide operations,
+// which makes this suitable for graphs with thousands of vertices. Produces the
+// same coloring as the generic version given the same graph.
+//
+// If `time_limit` expires before the coloring is complete, each remaining
+// vertex is given a color of its own, so the result is always a valid coloring.
+//
+// Returns the color classes, each sorted in ascending order.
+std::vector<std::vector<int64_t>> RecursiveLargestFirstColoring(
+    absl::Span<const InlineBitmap> adjacency,
+    absl::Duration time_limit = absl::InfiniteDuration());
+
 inline std::optional<int64_t> LookupIntegerInZ3Model(z3::model model,
                                                      std::string_view name) {
   for (int32_t i = 0; i < model.size(); i++) {
@@ -14,14 +14,25 @@
 
 #include "xls/data_structures/graph_coloring.h"
 
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAreArray;
+
 using V = std::string;
 
 std::vector<absl::flat_hash_set<V>> RLFFromMap(
@@ -141,5 +152,60 @@ TEST(GraphColoringTest, Wheel) {
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
 }
 
+// Returns a random graph on `n` vertices as adjacency bitmaps, along with the
+// same graph as neighbor sets.
+std::pair<std::vector<InlineBitmap>,
+          absl::flat_hash_map<int64_t, absl::flat_hash_set<int64_t>>>
+RandomGraph(int64_t n, double edge_probability) {
+  std::mt19937_64 gen;
+  std::bernoulli_distribution coin(edge_probability);
+  std::vector<InlineBitmap> adjacency(n, InlineBitmap(n));
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<int64_t>> neighborhood;
+  for (int64_t i = 0; i < n; ++i) {
+    neighborhood[i];
+    for (int64_t j = 0; j < i; ++j) {
+      if (coin(gen)) {
+        adjacency[i].Set(j);
+        adjacency[j].Set(i);
+        neighborhood[i].insert(j);
+        neighborhood[j].insert(i);
+      }
+    }
+  }
+  return {std::move(adjacency), std::move(neighborhood)};
+}
+
+TEST(GraphColoringTest, BitmapMatchesGeneric) {
+  constexpr int64_t kSize = 150;
+  auto [adjacency, neighborhood] = RandomGraph(kSize, 0.3);
+  absl::flat_hash_set<int64_t> vertices;
+  for (int64_t i = 0; i < kSize; ++i) {
+    vertices.insert(i);
+  }
+  std::vector<absl::flat_hash_set<int64_t>> expected =
+      RecursiveLargestFirstColoring<int64_t>(
+          vertices, [&](const int64_t& v) -> absl::flat_hash_set<int64_t> {
+            return neighborhood.at(v);
+          });
+  std::vector<std::vector<int64_t>> coloring =
+      RecursiveLargestFirstColoring(adjacency);
+  ASSERT_EQ(coloring.size(), expected.size());
+  for (int64_t i = 0; i < coloring.size(); ++i) {
+    EXPECT_THAT(coloring[i], UnorderedElementsAreArray(expected[i]));
+  }
+}
+
+TEST(GraphColoringTest, BitmapTimeLimit) {
+  constexpr int64_t kSize = 100;
+  auto [adjacency, neighborhood] = RandomGraph(kSize, 0.5);
+  std::vector<std::vector<int64_t>> coloring =
+      RecursiveLargestFirstColoring(adjacency, absl::ZeroDuration());
+  // Out of time before the first color class, so every vertex gets its own.
+  ASSERT_EQ(coloring.size(), kSize);
+  for (int64_t i = 0; i < kSize; ++i) {
+    EXPECT_THAT(coloring[i], ElementsAre(i));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -157,6 +157,16 @@ class InlineBitmap {
     return data_[wordno];
   }
 
+  // Sets the 64-bit word that backs a group of 64 bits. Bits of `value` beyond
+  // bit_count() are ignored.
+  void SetWord(int64_t wordno, uint64_t value) {
+    XLS_DCHECK_LT(wordno, word_count());
+    data_[wordno] = value & MaskForWord(wordno);
+  }
+
+  // Returns the number of 64-bit words backing the bitmap.
+  int64_t word_count() const { return data_.size(); }
+
   // Sets a byte in the data underlying the bitmap.
   //
   // Setting byte i as {b_7, b_6, b_5, ..., b_0} sets the bit at i*8 to b_0, the
@@ -246,6 +256,21 @@ class InlineBitmap {
     }
   }
 
+  // Overwrites the `count` bits of this bitmap starting at `dst_offset` with
+  // the bits of `src` starting at `src_offset`. Bits are copied a word at a
+  // time.
+  void Overwrite(const InlineBitmap& src, int64_t count, int64_t dst_offset,
+                 int64_t src_offset) {
+    XLS_DCHECK_GE(count, 0);
+    XLS_DCHECK_LE(dst_offset + count, bit_count());
+    XLS_DCHECK_LE(src_offset + count, src.bit_count());
+    for (int64_t copied = 0; copied < count; copied += kWordBits) {
+      int64_t width = std::min(kWordBits, count - copied);
+      WriteBits(dst_offset + copied, width,
+                src.ReadBits(src_offset + copied, width));
+    }
+  }
+
   int64_t byte_count() const { return CeilOfRatio(bit_count_, int64_t{8}); }
 
   template <typename H>
@@ -258,7 +283,6 @@ class InlineBitmap {
 
   static constexpr int64_t kWordBits = 64;
   static constexpr int64_t kWordBytes = 8;
-  int64_t word_count() const { return data_.size(); }
 
   void MaskLastWord() {
     if (word_count() == 0) {
@@ -269,6 +293,32 @@ class InlineBitmap {
     data_[last_wordno] &= mask;
   }
 
+  // Returns the `width` (at most kWordBits) bits starting at `offset`.
+  uint64_t ReadBits(int64_t offset, int64_t width) const {
+    int64_t wordno = offset / kWordBits;
+    int64_t bitno = offset % kWordBits;
+    uint64_t value = data_[wordno] >> bitno;
+    if (bitno + width > kWordBits) {
+      value |= data_[wordno + 1] << (kWordBits - bitno);
+    }
+    return value & Mask(width);
+  }
+
+  // Sets the `width` (at most kWordBits) bits starting at `offset` to the low
+  // bits of `value`.
+  void WriteBits(int64_t offset, int64_t width, uint64_t value) {
+    int64_t wordno = offset / kWordBits;
+    int64_t bitno = offset % kWordBits;
+    uint64_t mask = Mask(width);
+    value &= mask;
+    data_[wordno] = (data_[wordno] & ~(mask << bitno)) | (value << bitno);
+    if (bitno + width > kWordBits) {
+      int64_t low_width = kWordBits - bitno;
+      data_[wordno + 1] =
+          (data_[wordno + 1] & ~(mask >> low_width)) | (value >> low_width);
+    }
+  }
+
   // Creates a mask for the valid bits in word "wordno".
   uint64_t MaskForWord(int64_t wordno) const {
     int64_t remainder = bit_count_ % kWordBits;
@@ -249,6 +249,18 @@ TEST(InlineBitmapTest, GetSetBytesAndWords) {
     EXPECT_EQ(b.GetWord(0), 0xff00000000000000) << std::hex << b.GetWord(0);
     EXPECT_EQ(b.GetWord(1), 0x1) << std::hex << b.GetWord(1);
   }
+
+  {
+    InlineBitmap b(/*bit_count=*/100);
+    EXPECT_EQ(b.word_count(), 2);
+    b.SetWord(0, 0x123456789abcdef0);
+    // Only the low 36 bits of the last word are in range.
+    b.SetWord(1, 0xffffffffffffffff);
+    EXPECT_EQ(b.GetWord(0), 0x123456789abcdef0) << std::hex << b.GetWord(0);
+    EXPECT_EQ(b.GetWord(1), 0xfffffffff) << std::hex << b.GetWord(1);
+    EXPECT_EQ(b.GetByte(0), 0xf0);
+    EXPECT_TRUE(b.Get(99));
+  }
 }
 
 TEST(InlineBitmapTest, FromToBytes) {
@@ -413,6 +425,31 @@ TEST(InlineBitmapTest, Union) {
   }
 }
 
+TEST(InlineBitmapTest, Overwrite) {
+  // Compare against a bit-at-a-time copy for a variety of alignments and
+  // widths crossing word boundaries.
+  InlineBitmap src(200);
+  for (int64_t i = 0; i < src.bit_count(); ++i) {
+    src.Set(i, (i * 7) % 3 == 0);
+  }
+  for (int64_t count : {0, 1, 5, 63, 64, 65, 130}) {
+    for (int64_t src_offset : {0, 1, 31, 64, 69}) {
+      for (int64_t dst_offset : {0, 3, 60, 64}) {
+        InlineBitmap dst(200, /*fill=*/true);
+        dst.Overwrite(src, count, dst_offset, src_offset);
+        for (int64_t i = 0; i < dst.bit_count(); ++i) {
+          bool expected = (i >= dst_offset && i < dst_offset + count)
+                              ? src.Get(src_offset + i - dst_offset)
+                              : true;
+          EXPECT_EQ(dst.Get(i), expected)
+              << "count=" << count << " src_offset=" << src_offset
+              << " dst_offset=" << dst_offset << " i=" << i;
+        }
+      }
+    }
+  }
+}
+
 }  // namespace
 
 // Note: tests below this point are friended, so cannot live in the anonymous
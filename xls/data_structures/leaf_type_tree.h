@@ -15,6 +15,8 @@
 #ifndef XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
 #define XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
 
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
@@ -27,10 +29,89 @@
 
 namespace xls {
 
+namespace leaf_type_tree_internal {
+
+inline bool IsLeafType(Type* t) { return t->IsBits() || t->IsToken(); }
+
+// Returns a pair containing the Type and element offset for the given type
+// index.
+inline std::pair<Type*, int64_t> GetSubtypeAndOffset(
+    Type* t, absl::Span<int64_t const> index, int64_t offset = 0) {
+  if (index.empty()) {
+    return {t, offset};
+  }
+  if (t->IsArray()) {
+    XLS_CHECK_LT(index[0], t->AsArrayOrDie()->size());
+    Type* element_type = t->AsArrayOrDie()->element_type();
+    return GetSubtypeAndOffset(element_type, index.subspan(1),
+                               offset + index[0] * element_type->leaf_count());
+  }
+  XLS_CHECK(t->IsTuple());
+  TupleType* tuple_type = t->AsTupleOrDie();
+  XLS_CHECK_LT(index[0], tuple_type->size());
+  return GetSubtypeAndOffset(
+      tuple_type->element_type(index[0]), index.subspan(1),
+      offset + tuple_type->element_leaf_offset(index[0]));
+}
+
+}  // namespace leaf_type_tree_internal
+
+// A non-owning view of the values of a LeafTypeTree, or of a subtree of one.
+// Views are cheap to create and copy, so subtrees can be inspected (e.g., for
+// tuple-index or array-index operations) without copying their values. A view
+// must not outlive the tree it refers to, and is invalidated by any change to
+// the tree other than assignment to its values.
+template <typename T>
+class LeafTypeTreeView {
+ public:
+  LeafTypeTreeView(Type* type, absl::Span<const T> elements,
+                   absl::Span<Type* const> leaf_types)
+      : type_(type), elements_(elements), leaf_types_(leaf_types) {
+    XLS_CHECK_EQ(elements_.size(), leaf_types_.size());
+  }
+
+  Type* type() const { return type_; }
+
+  // Returns the number of values in the view (equivalently number of leaves of
+  // the type).
+  int64_t size() const { return elements_.size(); }
+
+  // Returns the element at the given Type index, which must correspond to a
+  // leaf Bits-type element in the view's XLS type.
+  const T& Get(absl::Span<int64_t const> index) const {
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
+    XLS_CHECK(leaf_type_tree_internal::IsLeafType(type_offset.first));
+    return elements_[type_offset.second];
+  }
+
+  // Returns the values in the view.
+  absl::Span<T const> elements() const { return elements_; }
+
+  // Returns the types of each leaf in the XLS type of the view.
+  absl::Span<Type* const> leaf_types() const { return leaf_types_; }
+
+  // Returns a view of the subtree rooted at the given type index.
+  LeafTypeTreeView<T> AsView(absl::Span<const int64_t> index) const {
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
+    const int64_t leaf_count = type_offset.first->leaf_count();
+    return LeafTypeTreeView<T>(
+        type_offset.first, elements_.subspan(type_offset.second, leaf_count),
+        leaf_types_.subspan(type_offset.second, leaf_count));
+  }
+
+ private:
+  Type* type_;
+  absl::Span<const T> elements_;
+  absl::Span<Type* const> leaf_types_;
+};
+
 // A container which stores values of an arbitrary type T, one value for each
 // leaf element (Bits value) of a potentially-recursive XLS type. Values are
-// stored in a flat vector which provides fast iteration, but indexing through
-// tuple types is O(#elements in tuple).
+// stored in a flat vector which provides fast iteration; indexing is
+// O(depth of the index). Subtrees can be accessed without copying through
+// LeafTypeTreeView.
 //
 // Example usage where T is an int64_t:
 //
@@ -114,6 +195,12 @@ class LeafTypeTree {
     }
   }
 
+  // Constructor which copies the values of the given view.
+  explicit LeafTypeTree(const LeafTypeTreeView<T>& view)
+      : type_(view.type()),
+        elements_(view.elements().begin(), view.elements().end()),
+        leaf_types_(view.leaf_types().begin(), view.leaf_types().end()) {}
+
   Type* type() const { return type_; }
 
   // Returns the number of values in the container (equivalently number of
@@ -124,9 +211,10 @@ class LeafTypeTree {
   // recursive traversal through the object's XLS type. The Type index must
   // correspond to a leaf Bits-type element in the object's XLS type.
   T& Get(absl::Span<int64_t const> index) {
-    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
     // The index must refer to a leaf node (bits or token type).
-    XLS_CHECK(IsLeafType(type_offset.first));
+    XLS_CHECK(leaf_type_tree_internal::IsLeafType(type_offset.first));
     return elements_[type_offset.second];
   }
   const T& Get(absl::Span<int64_t const> index) const {
@@ -135,9 +223,10 @@ class LeafTypeTree {
 
   // Sets the element at the given Type index to the given value.
   void Set(absl::Span<int64_t const> index, const T& value) {
-    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
     // The index must refer to a leaf node (bits or token type).
-    XLS_CHECK(IsLeafType(type_offset.first));
+    XLS_CHECK(leaf_type_tree_internal::IsLeafType(type_offset.first));
     elements_[type_offset.second] = value;
   }
 
@@ -149,14 +238,16 @@ class LeafTypeTree {
 
   // Returns the values corresponding to the subtree rooted at the given index.
   absl::Span<T> GetSubelements(absl::Span<const int64_t> index) {
-    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
     return type_offset.first->leaf_count() == 0
                ? absl::Span<T>()
                : absl::Span<T>(&elements_[type_offset.second],
                                type_offset.first->leaf_count());
   }
   absl::Span<T const> GetSubelements(absl::Span<const int64_t> index) const {
-    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
+    std::pair<Type*, int64_t> type_offset =
+        leaf_type_tree_internal::GetSubtypeAndOffset(type_, index);
     return type_offset.first->leaf_count() == 0
                ? absl::Span<const T>()
                : absl::Span<const T>(&elements_[type_offset.second],
@@ -167,18 +258,16 @@ class LeafTypeTree {
   // these types corresponds to the order of elements().
   absl::Span<Type* const> leaf_types() const { return leaf_types_; }
 
+  // Returns a view of the subtree rooted at the given type index. By default,
+  // the view covers the whole tree.
+  LeafTypeTreeView<T> AsView(absl::Span<const int64_t> index = {}) const {
+    return LeafTypeTreeView<T>(type_, elements_, leaf_types_).AsView(index);
+  }
+
   // Copies and returns the subtree rooted at the given type index as a
   // LeafTypeTree.
   LeafTypeTree<T> CopySubtree(absl::Span<const int64_t> index) const {
-    std::pair<Type*, int64_t> type_offset = GetSubtypeAndOffset(type_, index);
-    // To avoid indexing into an empty vector, handle the empty elements()
-    // case specially.
-    return LeafTypeTree<T>(
-        type_offset.first,
-        type_offset.first->leaf_count() == 0
-            ? absl::Span<const T>()
-            : absl::Span<const T>(&elements_[type_offset.second],
-                                  type_offset.first->leaf_count()));
+    return LeafTypeTree<T>(AsView(index));
   }
 
   // Produce a new `LeafTypeTree` from this one `LeafTypeTree` with a different
@@ -288,8 +377,6 @@ class LeafTypeTree {
   }
 
  private:
-  static bool IsLeafType(Type* t) { return t->IsBits() || t->IsToken(); }
-
   std::string ToStringHelper(const std::function<std::string(const T&)>& f,
                              Type* subtype, bool multiline, int64_t indent,
                              int64_t& linear_index) const {
@@ -335,7 +422,7 @@ class LeafTypeTree {
 
   // Creates the vector of leaf types.
   void MakeLeafTypes(Type* t) {
-    if (IsLeafType(t)) {
+    if (leaf_type_tree_internal::IsLeafType(t)) {
       leaf_types_.push_back(t);
       return;
     }
@@ -351,33 +438,6 @@ class LeafTypeTree {
     }
   }
 
-  // Returns a pair containing the Type and element offset for the given type
-  // index.
-  std::pair<Type*, int64_t> GetSubtypeAndOffset(Type* t,
-                                                absl::Span<int64_t const> index,
-                                                int64_t offset = 0) const {
-    if (index.empty()) {
-      return {t, offset};
-    }
-    if (t->IsArray()) {
-      XLS_CHECK(!index.empty());
-      XLS_CHECK_LT(index[0], t->AsArrayOrDie()->size());
-      Type* element_type = t->AsArrayOrDie()->element_type();
-      return GetSubtypeAndOffset(
-          element_type, index.subspan(1),
-          offset + index[0] * element_type->leaf_count());
-    }
-    XLS_CHECK(t->IsTuple());
-    TupleType* tuple_type = t->AsTupleOrDie();
-    XLS_CHECK_LT(index[0], tuple_type->size());
-    int64_t element_offset = 0;
-    for (int64_t i = 0; i < index[0]; ++i) {
-      element_offset += tuple_type->element_type(i)->leaf_count();
-    }
-    return GetSubtypeAndOffset(tuple_type->element_type(index[0]),
-                               index.subspan(1), offset + element_offset);
-  }
-
   absl::Status ForEachHelper(
       Type* subtype,
       const std::function<absl::Status(Type*, T&, absl::Span<const int64_t>)>&
@@ -323,6 +323,42 @@ TEST_F(LeafTypeTreeTest, ForEachTest) {
   }
 }
 
+TEST_F(LeafTypeTreeTest, Views) {
+  LeafTypeTree<int64_t> tree(
+      AsType("(bits[37][3], (bits[22], (bits[1], bits[1][2]), bits[42]))"));
+  tree.Set({0, 2}, 3);
+  tree.Set({1, 1, 0}, 42);
+  tree.Set({1, 2}, 77);
+
+  LeafTypeTreeView<int64_t> view = tree.AsView();
+  EXPECT_EQ(view.type(), tree.type());
+  EXPECT_EQ(view.size(), 8);
+  EXPECT_THAT(view.elements(), ElementsAre(0, 0, 3, 0, 42, 0, 0, 77));
+
+  LeafTypeTreeView<int64_t> subview = tree.AsView({1});
+  EXPECT_EQ(subview.type()->ToString(),
+            "(bits[22], (bits[1], bits[1][2]), bits[42])");
+  EXPECT_THAT(subview.elements(), ElementsAre(0, 42, 0, 0, 77));
+  EXPECT_THAT(AsStrings(subview.leaf_types()),
+              ElementsAre("bits[22]", "bits[1]", "bits[1]", "bits[1]",
+                          "bits[42]"));
+  EXPECT_EQ(subview.Get({1, 0}), 42);
+  EXPECT_EQ(subview.Get({2}), 77);
+  // The view refers to the values of the tree rather than copying them.
+  EXPECT_EQ(&subview.Get({2}), &tree.Get({1, 2}));
+
+  LeafTypeTreeView<int64_t> subsubview = subview.AsView({1});
+  EXPECT_EQ(subsubview.type()->ToString(), "(bits[1], bits[1][2])");
+  EXPECT_THAT(subsubview.elements(), ElementsAre(42, 0, 0));
+
+  LeafTypeTree<int64_t> copy(subsubview);
+  EXPECT_EQ(copy, tree.CopySubtree({1, 1}));
+  EXPECT_EQ(copy.ToString(), "(42, [0, 0])");
+
+  EXPECT_EQ(tree.AsView({1, 1, 1}).size(), 2);
+  EXPECT_EQ(LeafTypeTree<int64_t>(AsType("()")).AsView().size(), 0);
+}
+
 TEST_F(LeafTypeTreeTest, ArrayOfEmptyTuples) {
   LeafTypeTree<int64_t> tree(AsType("()[5]"));
   EXPECT_EQ(tree.ToString(), "[(), (), (), (), ()]");
@@ -0,0 +1,150 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/maximum_clique.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace {
+
+// Returns the index of the lowest bit set in `bitmap`, or -1 if there is none.
+int64_t FirstSetBit(const InlineBitmap& bitmap) {
+  for (int64_t wordno = 0; wordno < bitmap.word_count(); ++wordno) {
+    uint64_t word = bitmap.GetWord(wordno);
+    if (word != 0) {
+      return wordno * 64 + absl::countr_zero(word);
+    }
+  }
+  return -1;
+}
+
+// Sets `bitmap` to the intersection of `bitmap` and `other`, or of `bitmap`
+// and the complement of `other` if `complement` is true.
+void Intersect(InlineBitmap* bitmap, const InlineBitmap& other,
+               bool complement = false) {
+  for (int64_t wordno = 0; wordno < bitmap->word_count(); ++wordno) {
+    uint64_t other_word = other.GetWord(wordno);
+    bitmap->SetWord(wordno, bitmap->GetWord(wordno) &
+                                (complement ? ~other_word : other_word));
+  }
+}
+
+// Branch-and-bound search for a maximum clique. Each branch extends the current
+// clique by a vertex from a candidate set; the candidates are greedily colored
+// and, since a clique contains at most one vertex of each color, the number of
+// colors bounds how much the branch can still grow.
+class CliqueSearch {
+ public:
+  CliqueSearch(absl::Span<const InlineBitmap> adjacency, absl::Time deadline)
+      : adjacency_(adjacency.begin(), adjacency.end()), deadline_(deadline) {
+    for (int64_t vertex = 0; vertex < adjacency_.size(); ++vertex) {
+      adjacency_[vertex].Set(vertex, false);
+    }
+  }
+
+  std::vector<int64_t> Run() {
+    const int64_t n = adjacency_.size();
+    if (n == 0) {
+      return {};
+    }
+    best_ = {0};
+    Expand(InlineBitmap(n, /*fill=*/true));
+    std::sort(best_.begin(), best_.end());
+    return best_;
+  }
+
+ private:
+  // Checking the clock is relatively expensive, so it is only done once per
+  // this many expansions.
+  static constexpr int64_t kDeadlineCheckInterval = 256;
+
+  // Greedily colors `candidates`, returning the vertices ordered by color and
+  // the number of colors used up to and including each vertex.
+  std::pair<std::vector<int64_t>, std::vector<int64_t>> ColorSort(
+      const InlineBitmap& candidates) const {
+    std::vector<int64_t> order;
+    std::vector<int64_t> bounds;
+    InlineBitmap uncolored = candidates;
+    int64_t color = 0;
+    while (!uncolored.IsAllZeroes()) {
+      ++color;
+      // Vertices which can still receive the current color.
+      InlineBitmap colorable = uncolored;
+      for (int64_t vertex = FirstSetBit(colorable); vertex != -1;
+           vertex = FirstSetBit(colorable)) {
+        uncolored.Set(vertex, false);
+        colorable.Set(vertex, false);
+        Intersect(&colorable, adjacency_[vertex], /*complement=*/true);
+        order.push_back(vertex);
+        bounds.push_back(color);
+      }
+    }
+    return {std::move(order), std::move(bounds)};
+  }
+
+  void Expand(InlineBitmap candidates) {
+    if (++expansions_ % kDeadlineCheckInterval == 0 &&
+        absl::Now() > deadline_) {
+      timed_out_ = true;
+    }
+    if (timed_out_) {
+      return;
+    }
+    auto [order, bounds] = ColorSort(candidates);
+    for (int64_t i = order.size() - 1; i >= 0; --i) {
+      if (timed_out_ || current_.size() + bounds[i] <= best_.size()) {
+        return;
+      }
+      const int64_t vertex = order[i];
+      current_.push_back(vertex);
+      InlineBitmap next = candidates;
+      Intersect(&next, adjacency_[vertex]);
+      if (next.IsAllZeroes()) {
+        if (current_.size() > best_.size()) {
+          best_ = current_;
+        }
+      } else {
+        Expand(std::move(next));
+      }
+      current_.pop_back();
+      candidates.Set(vertex, false);
+    }
+  }
+
+  std::vector<InlineBitmap> adjacency_;
+  absl::Time deadline_;
+  std::vector<int64_t> current_;
+  std::vector<int64_t> best_;
+  int64_t expansions_ = 0;
+  bool timed_out_ = false;
+};
+
+}  // namespace
+
+std::vector<int64_t> MaximumClique(absl::Span<const InlineBitmap> adjacency,
+                                   absl::Duration time_limit) {
+  return CliqueSearch(adjacency, absl::Now() + time_limit).Run();
+}
+
+}  // namespace xls
@@ -15,21 +15,25 @@
 #ifndef XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 #define XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
 
+#include <cstdint>
 #include <optional>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "ortools/linear_solver/linear_solver.h"
 
 namespace xls {
 
 // Compute the maximum clique in the given graph. This supports graphs of up to
-// around 100 nodes. More cleverness will be needed if we want to support bigger
-// graphs than that.
+// around 100 nodes; use the bitmap-based overload below for bigger graphs.
 template <typename V, typename Compare = std::less<V>>
 absl::StatusOr<absl::btree_set<V, Compare>> MaximumClique(
     const absl::btree_set<V, Compare>& vertices,
@@ -93,6 +97,21 @@ absl::StatusOr<absl::btree_set<V, Compare>> MaximumClique(
   return result;
 }
 
+// Compute a maximum clique in the graph with vertices [0, adjacency.size()),
+// where bit j of `adjacency[i]` is set iff i and j are neighbors. The relation
+// must be symmetric; self-loops are ignored. This is a branch-and-bound search
+// in the style of Tomita's MCQ/MCS algorithms, bounding each branch with a
+// greedy coloring computed on bitmaps, and handles graphs with thousands of
+// vertices.
+//
+// If `time_limit` expires before the search completes, the largest clique found
+// so far is returned, which may not be maximum.
+//
+// Returns the vertices of the clique in ascending order.
+std::vector<int64_t> MaximumClique(
+    absl::Span<const InlineBitmap> adjacency,
+    absl::Duration time_limit = absl::InfiniteDuration());
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_MAXIMUM_CLIQUE_H_
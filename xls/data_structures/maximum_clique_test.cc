@@ -14,16 +14,25 @@
 
 #include "xls/data_structures/maximum_clique.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <random>
+#include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+
 using V = std::string;
 
 using Graph = absl::btree_map<V, absl::btree_set<V>>;
@@ -153,5 +162,81 @@ TEST(MaximumCliqueTest, Big) {
   EXPECT_TRUE(IsValidClique(graph, clique));
 }
 
+bool IsValidClique(absl::Span<const InlineBitmap> adjacency,
+                   absl::Span<const int64_t> clique) {
+  for (int64_t x : clique) {
+    for (int64_t y : clique) {
+      if ((x != y) && !adjacency[x].Get(y)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::vector<InlineBitmap> RandomGraph(int64_t n, double edge_probability) {
+  std::mt19937_64 gen;
+  std::bernoulli_distribution coin(edge_probability);
+  std::vector<InlineBitmap> adjacency(n, InlineBitmap(n));
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = 0; j < i; ++j) {
+      if (coin(gen)) {
+        adjacency[i].Set(j);
+        adjacency[j].Set(i);
+      }
+    }
+  }
+  return adjacency;
+}
+
+TEST(MaximumCliqueTest, BitmapConnectedUnionOfCG4AndCG3) {
+  // 0-3 form a complete graph, as do 4-6, with edges 0-4, 1-5 and 2-6.
+  std::vector<InlineBitmap> adjacency(7, InlineBitmap(7));
+  auto add_edge = [&](int64_t x, int64_t y) {
+    adjacency[x].Set(y);
+    adjacency[y].Set(x);
+  };
+  for (int64_t x = 0; x < 4; ++x) {
+    for (int64_t y = x + 1; y < 4; ++y) {
+      add_edge(x, y);
+    }
+  }
+  add_edge(4, 5);
+  add_edge(4, 6);
+  add_edge(5, 6);
+  add_edge(0, 4);
+  add_edge(1, 5);
+  add_edge(2, 6);
+  EXPECT_THAT(MaximumClique(adjacency), ElementsAre(0, 1, 2, 3));
+}
+
+TEST(MaximumCliqueTest, BitmapMatchesBruteForce) {
+  constexpr int64_t kSize = 16;
+  std::vector<InlineBitmap> adjacency = RandomGraph(kSize, 0.6);
+  int64_t expected_size = 0;
+  for (int64_t subset = 0; subset < (int64_t{1} << kSize); ++subset) {
+    std::vector<int64_t> vertices;
+    for (int64_t i = 0; i < kSize; ++i) {
+      if ((subset >> i) & 1) {
+        vertices.push_back(i);
+      }
+    }
+    if (IsValidClique(adjacency, vertices)) {
+      expected_size = std::max<int64_t>(expected_size, vertices.size());
+    }
+  }
+  std::vector<int64_t> clique = MaximumClique(adjacency);
+  EXPECT_EQ(clique.size(), expected_size);
+  EXPECT_TRUE(IsValidClique(adjacency, clique));
+}
+
+TEST(MaximumCliqueTest, BitmapBig) {
+  std::vector<InlineBitmap> adjacency = RandomGraph(2000, 0.5);
+  std::vector<int64_t> clique =
+      MaximumClique(adjacency, /*time_limit=*/absl::Seconds(1));
+  EXPECT_GE(clique.size(), 2);
+  EXPECT_TRUE(IsValidClique(adjacency, clique));
+}
+
 }  // namespace
 }  // namespace xls
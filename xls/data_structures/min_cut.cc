@@ -14,8 +14,12 @@
 
 #include "xls/data_structures/min_cut.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <deque>
-#include <set>
+#include <limits>
+#include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
@@ -107,7 +111,9 @@ struct ResidualEdge {
 // flow along the edge.
 class ResidualGraph {
  public:
-  explicit ResidualGraph(const Graph& graph) {
+  // Edge weights are clamped to `capacity_limit` so the excess flow
+  // accumulated at a node cannot overflow.
+  ResidualGraph(const Graph& graph, int64_t capacity_limit) {
     // There are exactly twice as many edges in the residual graph because each
     // edge in the original graph maps to a forward and backward edge in the
     // residual graph. The forward edge in the original graph has the same
@@ -122,7 +128,8 @@ class ResidualGraph {
       // Add the forward edge to the residual graph. It has an inital capacity
       // equal to the weight of the edge in the original graph.
       edges_[int64_t{edge_id}] =
-          ResidualEdge{edge.from, edge.to, edge.weight, backward_edge_id};
+          ResidualEdge{edge.from, edge.to,
+                       std::min(edge.weight, capacity_limit), backward_edge_id};
       successors_[int64_t{edge.from}].push_back(edge_id);
 
       // Add the backward edge to the residual graph. It has an inital capacity
@@ -167,117 +174,146 @@ std::string GraphWithFlowToString(const Graph& graph,
         &out, "  %s : %s\n", graph.name(n),
         absl::StrJoin(
             graph.successors(n), ", ", [&](std::string* out, EdgeId e_id) {
+              // The flow along an edge is the capacity of its dual.
               const Edge& e = graph.edge(e_id);
-              absl::StrAppendFormat(
-                  out, "%s[%d/%d]", graph.name(e.to),
-                  e.weight - residual_graph.edge(e_id).capacity, e.weight);
+              const ResidualEdge& dual =
+                  residual_graph.edge(residual_graph.edge(e_id).dual_edge);
+              absl::StrAppendFormat(out, "%s[%d/%d]", graph.name(e.to),
+                                    dual.capacity, e.weight);
             }));
   }
   return out;
 }
 
-// Finds an augmenting path from source to sink in the graph (path of edges with
-// non-zero residual capacity) and increases the flow along each edge in the
-// path. The amount of flow increase is equal to the minimum residual capacity
-// of any edge in the path. The augmenting path is found via Dinic's algorithm
-// which finds a shortest augmenting path via BFS search. Returns the amount of
-// augmented flow. If no augmenting path is found then zero is returned.
-int64_t AugmentFlow(const Graph& graph, NodeId source, NodeId sink,
-                    ResidualGraph* residual_graph) {
-  XLS_VLOG_LINES(4, GraphWithFlowToString(graph, *residual_graph));
+// Returns the weight above which edges are treated as having infinite
+// capacity: one more than the total weight of the other edges, so no minimum
+// cut which could be finite includes such an edge. The limit is capped such
+// that the sum of the capacities of all edges cannot overflow.
+int64_t CapacityLimit(const Graph& graph) {
+  const int64_t kMaxLimit =
+      std::numeric_limits<int64_t>::max() / (2 * graph.edge_count() + 1);
+  int64_t total = 0;
+  for (EdgeId edge_id = EdgeId{0}; edge_id <= graph.max_edge_id();
+       edge_id += EdgeId{1}) {
+    total += std::min(graph.edge(edge_id).weight, kMaxLimit);
+    if (total >= kMaxLimit) {
+      return kMaxLimit;
+    }
+  }
+  return total + 1;
+}
 
-  // Perform a BFS search from flow to find the shortest augmenting path (by
-  // edge count) from source to sink. For each edge traversed in the BFS search,
-  // 'path_back' holds the previous edge in the path from the source along with
-  // the residual capacity of that path..
-  absl::flat_hash_map<NodeId, std::pair<ResidualEdge*, int64_t>> path_back;
-  std::vector<NodeId> frontier = {source};
-  while (!frontier.empty()) {
-    std::vector<NodeId> next_frontier;
-    // Try to add extend the BFS-constructed paths from the source with the
-    // given edge.
-    auto maybe_extend_frontier = [&](ResidualEdge* e) {
-      if (path_back.contains(e->to)) {
-        return;
+// Computes a maximum flow from source to sink in the residual graph with the
+// push-relabel method. Active nodes (those with excess flow) are discharged in
+// FIFO order, which bounds the run time by O(V^3). Nodes start with their
+// exact distance to the sink as their label, and the gap heuristic lifts nodes
+// which can no longer reach the sink directly above the source so that their
+// excess is promptly returned to it. Upon return the residual graph holds a
+// maximum flow in which only the source and sink have non-zero excess.
+void PushRelabelMaxFlow(const Graph& graph, NodeId source, NodeId sink,
+                        ResidualGraph* residual_graph) {
+  const int64_t node_count = graph.node_count();
+  std::vector<int64_t> label(node_count, node_count);
+  std::vector<int64_t> excess(node_count, 0);
+  // The index of the next successor edge of each node to try pushing along.
+  std::vector<int64_t> current_edge(node_count, 0);
+  // The number of nodes with each label. Labels are less than 2 * V.
+  std::vector<int64_t> label_count(2 * node_count, 0);
+
+  // Label each node with its distance to the sink in the residual graph.
+  // Nodes which cannot reach the sink are labeled V like the source.
+  label[int64_t{sink}] = 0;
+  std::deque<NodeId> bfs_frontier = {sink};
+  while (!bfs_frontier.empty()) {
+    NodeId node = bfs_frontier.front();
+    bfs_frontier.pop_front();
+    for (EdgeId edge_id : residual_graph->successors(node)) {
+      // The dual of an edge out of `node` extends into `node`.
+      const ResidualEdge& edge = residual_graph->edge(edge_id);
+      const ResidualEdge& dual = residual_graph->edge(edge.dual_edge);
+      int64_t from = int64_t{dual.from};
+      if (dual.capacity > 0 && label[from] == node_count &&
+          dual.from != source && dual.from != sink) {
+        label[from] = label[int64_t{node}] + 1;
+        bfs_frontier.push_back(dual.from);
       }
-      int64_t path_capacity = path_back.contains(e->from)
-                                  ? path_back.at(e->from).second
-                                  : std::numeric_limits<int64_t>::max();
-      // The residual capacity of a path is the minimum residual capacity of any
-      // edge in the path.
-      path_capacity = std::min(path_capacity, e->capacity);
-      path_back[e->to] = {e, path_capacity};
-      next_frontier.push_back(e->to);
-      XLS_VLOG(5) << "  Added " << graph.name(e->to) << " to the frontier";
-    };
-
-    for (NodeId node : frontier) {
-      XLS_VLOG(5) << "Visiting " << graph.name(node);
-      for (EdgeId edge_id : residual_graph->successors(node)) {
-        ResidualEdge& edge = residual_graph->edge(edge_id);
-        XLS_VLOG(5) << absl::StreamFormat(
-            "  Traversing %s->%s", graph.name(edge.from), graph.name(edge.to));
-        XLS_CHECK_GE(edge.capacity, 0);
-        if (edge.capacity > 0) {
-          maybe_extend_frontier(&edge);
-          if (edge.to == sink) {
-            // Found augmenting path. As this is the first path we've found in a
-            // BFS search it is necessarily a shortest path. Walk back along
-            // path and augment the flow.
-            int64_t augmented_flow_amount = path_back.at(sink).second;
-            XLS_CHECK_GT(augmented_flow_amount, 0);
-            NodeId n = sink;
-            while (n != source) {
-              ResidualEdge* e = path_back.at(n).first;
-              residual_graph->PushFlow(augmented_flow_amount, e);
-              XLS_CHECK_GE(e->capacity, 0);
-              n = e->from;
-            }
-            if (XLS_VLOG_IS_ON(4)) {
-              XLS_VLOG(4) << "Augmented flow: " << augmented_flow_amount;
-              std::vector<const ResidualEdge*> augmented_path;
-              NodeId n = sink;
-              while (n != source) {
-                const ResidualEdge* e = path_back.at(n).first;
-                augmented_path.push_back(e);
-                n = e->from;
-              }
-              std::reverse(augmented_path.begin(), augmented_path.end());
-              XLS_VLOG(4) << "Augmented path: "
-                          << absl::StrJoin(
-                                 augmented_path, ", ",
-                                 [&](std::string* out, const ResidualEdge* e) {
-                                   absl::StrAppendFormat(
-                                       out, "%s->%s [new capacity %d]",
-                                       graph.name(e->from), graph.name(e->to),
-                                       e->capacity);
-                                 });
+    }
+  }
+  label[int64_t{source}] = node_count;
+  for (int64_t l : label) {
+    ++label_count[l];
+  }
+
+  std::deque<NodeId> active;
+  auto push = [&](ResidualEdge* edge, int64_t amount) {
+    residual_graph->PushFlow(amount, edge);
+    excess[int64_t{edge->from}] -= amount;
+    if (excess[int64_t{edge->to}] == 0 && edge->to != source &&
+        edge->to != sink) {
+      active.push_back(edge->to);
+    }
+    excess[int64_t{edge->to}] += amount;
+  };
+
+  for (EdgeId edge_id : residual_graph->successors(source)) {
+    ResidualEdge& edge = residual_graph->edge(edge_id);
+    if (edge.capacity > 0) {
+      push(&edge, edge.capacity);
+    }
+  }
+
+  while (!active.empty()) {
+    NodeId node = active.front();
+    active.pop_front();
+    int64_t n = int64_t{node};
+    absl::Span<const EdgeId> successors = residual_graph->successors(node);
+    // Discharge the node: push its excess to neighbors one label closer to the
+    // sink, relabeling whenever no such neighbor remains.
+    while (excess[n] > 0) {
+      if (current_edge[n] == successors.size()) {
+        int64_t old_label = label[n];
+        int64_t new_label = 2 * node_count - 1;
+        for (EdgeId edge_id : successors) {
+          const ResidualEdge& edge = residual_graph->edge(edge_id);
+          if (edge.capacity > 0) {
+            new_label = std::min(new_label, label[int64_t{edge.to}] + 1);
+          }
+        }
+        --label_count[old_label];
+        label[n] = new_label;
+        ++label_count[new_label];
+        current_edge[n] = 0;
+        if (label_count[old_label] == 0 && old_label < node_count) {
+          // No node has label `old_label` so no node labeled above it can reach
+          // the sink.
+          for (int64_t other = 0; other < node_count; ++other) {
+            if (label[other] > old_label && label[other] < node_count) {
+              --label_count[label[other]];
+              label[other] = node_count + 1;
+              ++label_count[label[other]];
+              current_edge[other] = 0;
             }
-            return augmented_flow_amount;
           }
         }
+        continue;
+      }
+      ResidualEdge& edge = residual_graph->edge(successors[current_edge[n]]);
+      if (edge.capacity > 0 && label[n] == label[int64_t{edge.to}] + 1) {
+        push(&edge, std::min(excess[n], edge.capacity));
+      } else {
+        ++current_edge[n];
       }
     }
-
-    frontier = std::move(next_frontier);
-    next_frontier.clear();
   }
-
-  XLS_VLOG(4) << "No augmenting path found";
-  return 0;
+  XLS_VLOG(4) << "Maximum flow: " << excess[int64_t{sink}];
+  XLS_VLOG_LINES(4, GraphWithFlowToString(graph, *residual_graph));
 }
 
 }  // namespace
 
 GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink) {
-  // This loop is the core of the Ford-Fulkerson method. Starting with zero flow
-  // on all edges, flow is increased along a path from source to sink with
-  // residual capacity (called an augmenting path). When no further augmenting
-  // paths exist, flow has been maximized. 'flow' is the flow of each edge in
-  // the graph indexed by EdgeId.
-  ResidualGraph residual_graph(graph);
-  while (AugmentFlow(graph, source, sink, &residual_graph) > 0) {
-  }
+  ResidualGraph residual_graph(graph, CapacityLimit(graph));
+  PushRelabelMaxFlow(graph, source, sink, &residual_graph);
 
   // Once a maximum flow is found, walk the residual graph from the source. All
   // reachable nodes form one partition.
@@ -96,9 +96,12 @@ struct GraphCut {
 
 // Computes a minimum cut of the given graph where source and sink are in
 // different partitions. The cut is returned as a partitioning of the nodes of
-// the graph into two sets of nodes on either side of the cut. The min cut is
-// found via the Ford-Fulkerson method using Dinic's algorithm. This results in
-// a worst case run time of O(V^2 * E).
+// the graph into two sets of nodes on either side of the cut. The source
+// partition is the smallest possible: the nodes reachable from the source in
+// the residual graph of a maximum flow. The maximum flow is found with the FIFO
+// push-relabel method using the gap heuristic, which results in a worst case
+// run time of O(V^3). Edge weights too large to be part of any finite cut (such
+// as std::numeric_limits<int64_t>::max()) are treated as infinite.
 GraphCut MinCutBetweenNodes(const Graph& graph, NodeId source, NodeId sink);
 
 }  // namespace min_cut
@@ -355,6 +355,63 @@ TEST(MinCutTest, ResidualGraphTraversalTest) {
   EXPECT_EQ(min_cut.weight, 2);
 }
 
+TEST(MinCutTest, MatchesExhaustiveSearch) {
+  // Compare against all partitions of small random graphs which, like those
+  // built by the scheduler, include maximum weight edges. The partition
+  // returned is the minimum cut with the smallest source partition, which is
+  // contained in the source partition of every other minimum cut.
+  const int64_t kNodeCount = 9;
+  const int64_t kMaxWeight = std::numeric_limits<int64_t>::max();
+  std::mt19937_64 gen;
+  std::uniform_int_distribution<int64_t> node_dis(0, kNodeCount - 1);
+  std::uniform_int_distribution<int64_t> weight_dis(0, 12);
+  for (int64_t trial = 0; trial < 100; ++trial) {
+    Graph graph;
+    for (int64_t i = 0; i < kNodeCount; ++i) {
+      graph.AddNode();
+    }
+    NodeId source(0);
+    NodeId sink(1);
+    for (int64_t i = 0; i < 3 * kNodeCount; ++i) {
+      int64_t weight = weight_dis(gen);
+      graph.AddEdge(NodeId(node_dis(gen)), NodeId(node_dis(gen)),
+                    weight > 10 ? kMaxWeight : weight);
+    }
+    GraphCut min_cut = MinCutBetweenNodes(graph, source, sink);
+
+    int64_t min_cost = kMaxWeight;
+    std::vector<absl::flat_hash_set<NodeId>> min_cost_source_sets;
+    for (int64_t mask = 0; mask < (1 << (kNodeCount - 2)); ++mask) {
+      absl::flat_hash_set<NodeId> source_set = {source};
+      absl::flat_hash_set<NodeId> sink_set = {sink};
+      for (int64_t i = 2; i < kNodeCount; ++i) {
+        if ((mask >> (i - 2)) & 1) {
+          source_set.insert(NodeId(i));
+        } else {
+          sink_set.insert(NodeId(i));
+        }
+      }
+      int64_t cost = CutCost(graph, source_set, sink_set);
+      if (cost < min_cost) {
+        min_cost = cost;
+        min_cost_source_sets.clear();
+      }
+      if (cost == min_cost) {
+        min_cost_source_sets.push_back(source_set);
+      }
+    }
+    if (min_cost == kMaxWeight) {
+      continue;
+    }
+    EXPECT_EQ(min_cut.weight, min_cost) << graph.ToString();
+    for (const absl::flat_hash_set<NodeId>& source_set : min_cost_source_sets) {
+      for (NodeId node : min_cut.source_partition) {
+        EXPECT_TRUE(source_set.contains(node)) << graph.ToString();
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace min_cut
 }  // namespace xls
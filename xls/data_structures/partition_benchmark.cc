@@ -0,0 +1,140 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the partitioning algorithms used by the scheduler: optimal
+// path cuts, minimum cuts and approximate submodular minimization. The range
+// argument is the problem size.
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/container/btree_set.h"
+#include "xls/data_structures/min_cut.h"
+#include "xls/data_structures/path_cut.h"
+#include "xls/data_structures/submodular.h"
+
+namespace xls {
+namespace {
+
+template <typename T>
+PartialDifferenceMonoid<T> AddSubPDM() {
+  return {[]() { return 0; },
+          [](T x, T y) -> std::optional<T> { return x + y; },
+          [](T x, T y) -> std::optional<T> { return x - y; }};
+}
+
+template <typename T>
+TotalOrder<T> LessThanTotalOrder() {
+  return {[](T x, T y) { return x == y; }, [](T x, T y) { return x < y; }};
+}
+
+// Cuts a path with random weights into pieces of about eight nodes.
+void BM_PathCut(benchmark::State& state) {
+  std::mt19937_64 engine(0);
+  std::uniform_int_distribution<int32_t> weight(1, 100);
+  std::vector<int32_t> node_weights(state.range(0));
+  std::vector<int32_t> edge_weights(state.range(0) - 1);
+  for (int32_t& w : node_weights) {
+    w = weight(engine);
+  }
+  for (int32_t& w : edge_weights) {
+    w = weight(engine);
+  }
+  PathGraph<int32_t, int32_t> path =
+      *PathGraph<int32_t, int32_t>::Create(
+          node_weights, edge_weights, AddSubPDM<int32_t>(),
+          AddSubPDM<int32_t>(), LessThanTotalOrder<int32_t>(),
+          LessThanTotalOrder<int32_t>());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(path.ComputePathCut(/*maximum_weight=*/400));
+  }
+}
+
+// Cuts a random layered graph, shaped like the graphs built for partitioning
+// functions, between a source feeding the first layer and a sink fed by the
+// last.
+void BM_MinCut(benchmark::State& state) {
+  constexpr int64_t kWidth = 16;
+  std::mt19937_64 engine(0);
+  std::uniform_int_distribution<int64_t> weight(1, 64);
+  std::uniform_int_distribution<int64_t> column(0, kWidth - 1);
+  min_cut::Graph graph;
+  min_cut::NodeId source = graph.AddNode();
+  min_cut::NodeId sink = graph.AddNode();
+  std::vector<min_cut::NodeId> previous;
+  for (int64_t i = 0; i < state.range(0); i += kWidth) {
+    std::vector<min_cut::NodeId> layer;
+    for (int64_t j = 0; j < kWidth; ++j) {
+      layer.push_back(graph.AddNode());
+      if (previous.empty()) {
+        graph.AddEdge(source, layer.back(),
+                      std::numeric_limits<int64_t>::max());
+      } else {
+        for (int64_t k = 0; k < 2; ++k) {
+          graph.AddEdge(previous[column(engine)], layer.back(),
+                        weight(engine));
+        }
+      }
+    }
+    previous = std::move(layer);
+  }
+  for (min_cut::NodeId node : previous) {
+    graph.AddEdge(node, sink, std::numeric_limits<int64_t>::max());
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(min_cut::MinCutBetweenNodes(graph, source, sink));
+  }
+}
+
+// Minimizes a cut function of a cycle plus a modular term over 64 elements.
+// The range argument is the number of threads.
+void BM_SubmodularMinimize(benchmark::State& state) {
+  constexpr int32_t kSize = 64;
+  absl::btree_set<int32_t> universe;
+  for (int32_t i = 0; i < kSize; ++i) {
+    universe.insert(i);
+  }
+  SubmodularFunction<int32_t> f(
+      universe, [](const absl::btree_set<int32_t>& subset) -> double {
+        double result = 0.0;
+        for (int32_t i = 0; i < kSize; ++i) {
+          if (subset.contains(i) != subset.contains((i + 1) % kSize)) {
+            result += 1.0;
+          }
+          if (subset.contains(i)) {
+            result += (i % 7) - 3;
+          }
+        }
+        return result;
+      });
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(f.ApproxMinimize(
+        {MinimizeMode::Alternating, /*seed=*/0, /*rounds=*/32,
+         /*num_threads=*/state.range(0)}));
+  }
+}
+
+BENCHMARK(BM_PathCut)->Arg(64)->Arg(512)->Arg(4096);
+BENCHMARK(BM_MinCut)->Arg(256)->Arg(4096)->Arg(65536);
+BENCHMARK(BM_SubmodularMinimize)->Arg(1)->Arg(4);
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
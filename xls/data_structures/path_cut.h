@@ -15,13 +15,15 @@
 #ifndef XLS_DATA_STRUCTURES_PATH_CUT_H_
 #define XLS_DATA_STRUCTURES_PATH_CUT_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <sstream>
 #include <string>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
@@ -183,7 +185,7 @@ class PathGraph {
   // The algorithm is based on https://cs.stackexchange.com/a/138417
   std::optional<PathCut> ComputePathCut(NW maximum_weight) {
     // Set up a cache for prefix sums of the node weight list.
-    absl::flat_hash_map<PathNodeId, NW> prefix_sums = ComputePrefixSums();
+    std::vector<NW> prefix_sums = ComputePrefixSums();
 
     // Elements of this cache represent the optimal solution to the problem,
     // assuming that the solution contains a cut edge immediately after a
@@ -215,10 +217,13 @@ class PathGraph {
     // Note that when k = n, there is no "cut edge"; this is by design, so that
     // we don't need to duplicate the inner loop logic to find the optimal
     // "leftover" non-prefix piece at the end.
-    absl::flat_hash_map<CacheKey, CacheItem> cache;
-
-    // Initialize the base case of the recurrence.
-    cache[std::nullopt] = {edge_weight_pdm_.zero(), {}};
+    //
+    // The cache is indexed by node id. Rather than the cut edges themselves,
+    // each entry records the previously cut node `t` it was derived from, so
+    // the optimal cut is recovered by walking these links back from the end.
+    std::vector<CacheItem> cache;
+    cache.reserve(NumNodes());
+    const CacheItem base_case{edge_weight_pdm_.zero(), std::nullopt};
 
     for (PathNodeId k(0); static_cast<int32_t>(k) < NumNodes(); k++) {
       std::optional<CacheItem> best;
@@ -227,18 +232,22 @@ class PathGraph {
         // The body of the dynamic programming inner loop; corresponds to the
         // min{A[t] | …} in the recurrence above.
         auto loop_body = [&](CacheKey t) {
+          const NW& prefix_sum = prefix_sums[static_cast<int32_t>(k)];
           std::optional<NW> prefix_sum_diff_maybe =
               t.has_value()
-                  ? node_weight_pdm_.difference(prefix_sums[k], prefix_sums[*t])
-                  : prefix_sums[k];
+                  ? node_weight_pdm_.difference(
+                        prefix_sum, prefix_sums[static_cast<int32_t>(*t)])
+                  : prefix_sum;
           XLS_CHECK(prefix_sum_diff_maybe.has_value())
               << "The given PartialDifferenceMonoid for node weights failed";
-          NW prefix_sum_diff = *prefix_sum_diff_maybe;
-          if (node_weight_total_order_.less_than_or_eq(prefix_sum_diff,
+          const CacheItem& candidate =
+              t.has_value() ? cache[static_cast<int32_t>(*t)] : base_case;
+          if (node_weight_total_order_.less_than_or_eq(*prefix_sum_diff_maybe,
                                                        maximum_weight) &&
               (!best.has_value() ||
-               edge_weight_total_order_.less_than(cache[t].cost, best->cost))) {
-            best = cache[t];
+               edge_weight_total_order_.less_than(candidate.cost,
+                                                  best->cost))) {
+            best = CacheItem{candidate.cost, t};
           }
         };
 
@@ -258,18 +267,23 @@ class PathGraph {
       // Corresponds to the … + wₑ(k, k + 1) part of the recurrence.
       if (std::optional<PathEdgeId> e = NodeSuccessorEdge(k)) {
         best->cost += WeightOfEdge(*e);
-        best->cut_edges.push_back(*e);
       }
 
-      cache[k] = *best;
+      cache.push_back(*best);
     }
 
     XLS_VLOG(3) << "cache = " << CacheToString(cache) << "\n";
 
-    CacheItem optimal = cache[PathNodeId(NumNodes() - 1)];
-    std::sort(optimal.cut_edges.begin(), optimal.cut_edges.end());
+    // Every link points at a node with a cut edge after it, i.e.: the edge
+    // with the same id.
+    std::vector<PathEdgeId> cut_edges;
+    for (CacheKey t = cache.back().previous_cut; t.has_value();
+         t = cache[static_cast<int32_t>(*t)].previous_cut) {
+      cut_edges.push_back(*NodeSuccessorEdge(*t));
+    }
+    std::reverse(cut_edges.begin(), cut_edges.end());
 
-    return CutEdgesToPathCut(optimal.cut_edges);
+    return CutEdgesToPathCut(cut_edges);
   }
 
   // Convert a list of "cut edges" into a `PathCut`, i.e.: if the given `Path`
@@ -306,38 +320,37 @@ class PathGraph {
 
   struct CacheItem {
     EW cost;
-    std::vector<PathEdgeId> cut_edges;
+    // The node after which the previous cut edge lies, if any.
+    CacheKey previous_cut;
   };
 
   // Display the value of the dynamic programming cache as a string.
-  std::string CacheToString(
-      absl::flat_hash_map<CacheKey, CacheItem>& cache) const {
+  std::string CacheToString(absl::Span<const CacheItem> cache) const {
     std::vector<std::string> items;
-    for (PathNodeId n(0); static_cast<int32_t>(n) < NumNodes(); n++) {
+    for (const CacheItem& item : cache) {
       std::stringstream ss;
-      ss << cache[n].cost;
-      items.push_back(
-          absl::StrFormat("(%s, [%s])", ss.str(),
-                          absl::StrJoin(cache[n].cut_edges, ", ",
-                                        [](std::string* out, PathEdgeId edge) {
-                                          absl::StrAppend(out, edge.value());
-                                        })));
+      ss << item.cost;
+      items.push_back(absl::StrFormat(
+          "(%s, %s)", ss.str(),
+          item.previous_cut.has_value()
+              ? absl::StrCat(item.previous_cut->value())
+              : "ø"));
     }
     return absl::StrJoin(items, ", ");
   }
 
-  absl::flat_hash_map<PathNodeId, NW> ComputePrefixSums() {
-    absl::flat_hash_map<PathNodeId, NW> result;
-
-    result[PathNodeId(0)] = WeightOfNode(PathNodeId(0));
+  // Returns the sums of the node weights of each prefix of the path, indexed
+  // by the id of the last node of the prefix.
+  std::vector<NW> ComputePrefixSums() const {
+    std::vector<NW> result;
+    result.reserve(NumNodes());
+    result.push_back(WeightOfNode(PathNodeId(0)));
     for (PathNodeId n(1); static_cast<int32_t>(n) < NumNodes(); n++) {
-      auto sum_maybe =
-          node_weight_pdm_.sum(result[n - PathNodeId(1)], WeightOfNode(n));
+      auto sum_maybe = node_weight_pdm_.sum(result.back(), WeightOfNode(n));
       XLS_CHECK(sum_maybe)
           << "The given PartialDifferenceMonoid for node weights failed";
-      result[n] = *sum_maybe;
+      result.push_back(*sum_maybe);
     }
-
     return result;
   }
 };
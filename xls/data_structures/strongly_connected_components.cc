@@ -0,0 +1,91 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/strongly_connected_components.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace xls {
+
+// A description of the Tarjan SCC algorithm exists on Wikipedia:
+// https://w.wiki/5h9U
+// This implementation follows that pseudocode, with the recursion of
+// strongconnect replaced by an explicit stack of (vertex, next edge) frames.
+DenseComponents StronglyConnectedComponents(const CsrGraph& graph) {
+  const int64_t n = graph.vertex_count();
+  constexpr int64_t kUnvisited = -1;
+  std::vector<int64_t> indexes(n, kUnvisited);
+  std::vector<int64_t> low_links(n);
+  std::vector<uint8_t> on_stack(n, 0);
+  std::vector<int64_t> stack;
+  int64_t index = 0;
+
+  struct Frame {
+    int64_t vertex;
+    int64_t next_edge;
+  };
+  std::vector<Frame> frames;
+
+  DenseComponents result;
+  auto visit = [&](int64_t vertex) {
+    indexes[vertex] = index;
+    low_links[vertex] = index;
+    ++index;
+    stack.push_back(vertex);
+    on_stack[vertex] = 1;
+    frames.push_back(Frame{vertex, graph.offsets[vertex]});
+  };
+
+  for (int64_t root = 0; root < n; ++root) {
+    if (indexes[root] != kUnvisited) {
+      continue;
+    }
+    visit(root);
+    while (!frames.empty()) {
+      const int64_t vertex = frames.back().vertex;
+      if (frames.back().next_edge < graph.offsets[vertex + 1]) {
+        const int64_t neighbor = graph.targets[frames.back().next_edge++];
+        if (indexes[neighbor] == kUnvisited) {
+          visit(neighbor);
+        } else if (on_stack[neighbor]) {
+          low_links[vertex] = std::min(low_links[vertex], indexes[neighbor]);
+        }
+        continue;
+      }
+
+      // All edges of `vertex` have been explored.
+      if (low_links[vertex] == indexes[vertex]) {
+        int64_t v;
+        do {
+          v = stack.back();
+          stack.pop_back();
+          on_stack[v] = 0;
+          result.vertices.push_back(v);
+        } while (v != vertex);
+        result.offsets.push_back(result.vertices.size());
+      }
+      frames.pop_back();
+      if (!frames.empty()) {
+        const int64_t parent = frames.back().vertex;
+        low_links[parent] = std::min(low_links[parent], low_links[vertex]);
+      }
+    }
+  }
+
+  return result;
+}
+
+}  // namespace xls
@@ -15,82 +15,100 @@
 #ifndef XLS_DATA_STRUCTURES_STRONGLY_CONNECTED_COMPONENTS_H_
 #define XLS_DATA_STRUCTURES_STRONGLY_CONNECTED_COMPONENTS_H_
 
-#include <stack>
+#include <cstdint>
 #include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
-// Computes the strongly connected components of a graph using Tarjan's strongly
-// connected components algorithm.
+// A directed graph on the vertices [0, vertex_count()) in compressed sparse row
+// form: the out-neighbors of vertex v are targets[offsets[v]] through
+// targets[offsets[v + 1] - 1], so `offsets` has vertex_count() + 1 entries.
+struct CsrGraph {
+  std::vector<int64_t> offsets = {0};
+  std::vector<int64_t> targets;
+
+  int64_t vertex_count() const { return offsets.size() - 1; }
+  absl::Span<const int64_t> neighbors(int64_t vertex) const {
+    return absl::MakeConstSpan(targets).subspan(
+        offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+  }
+};
+
+// The strongly connected components of a CsrGraph, stored contiguously:
+// component i consists of vertices[offsets[i]] through
+// vertices[offsets[i + 1] - 1].
+struct DenseComponents {
+  std::vector<int64_t> offsets = {0};
+  std::vector<int64_t> vertices;
+
+  int64_t component_count() const { return offsets.size() - 1; }
+  absl::Span<const int64_t> component(int64_t i) const {
+    return absl::MakeConstSpan(vertices).subspan(
+        offsets[i], offsets[i + 1] - offsets[i]);
+  }
+};
+
+// Computes the strongly connected components of a graph on dense vertex ids
+// using Tarjan's strongly connected components algorithm. Self-edges are
+// permitted.
+//
+// The depth-first search is iterative, so this is safe on arbitrarily deep
+// graphs, and the bookkeeping uses flat arrays indexed by vertex. Components
+// are returned in the order Tarjan's algorithm completes them, which is a
+// reverse topological order of the condensed graph.
+DenseComponents StronglyConnectedComponents(const CsrGraph& graph);
+
+// Computes the strongly connected components of a graph.
 //
 // The parameter `graph` is an arbitrary adjacency matrix represented as a
 // map from nodes to the set of out-neighbors of that node. Self-edges are
-// permitted.
+// permitted. Only nodes with an in- or out-edge are considered vertices.
 //
-// A description of the Tarjan SCC algorithm exists on Wikipedia:
-// https://w.wiki/5h9U
-// This implementation is directly based off of that pseudocode, so please read
-// that to make sense of this code.
+// This maps the vertices to dense ids in sorted order and calls the CsrGraph
+// overload above, so components are returned in the same order as a recursive
+// implementation of Tarjan's algorithm visiting vertices in sorted order.
 template <typename V>
 std::vector<absl::btree_set<V>> StronglyConnectedComponents(
     const absl::btree_map<V, absl::btree_set<V>>& graph) {
-  absl::btree_set<V> vertices;
+  absl::btree_map<V, int64_t> ids;
   for (const auto& [source, targets] : graph) {
     for (const V& target : targets) {
-      vertices.insert(source);
-      vertices.insert(target);
+      ids.insert({source, 0});
+      ids.insert({target, 0});
     }
   }
+  std::vector<const V*> vertices;
+  vertices.reserve(ids.size());
+  for (auto& [vertex, id] : ids) {
+    id = vertices.size();
+    vertices.push_back(&vertex);
+  }
 
-  int64_t index = 0;
-  std::stack<V, std::vector<V>> stack;
-  std::vector<absl::btree_set<V>> result;
-  absl::btree_map<V, int64_t> indexes;
-  absl::btree_map<V, int64_t> low_links;
-  absl::btree_set<V> on_stack;
-
-  std::function<void(const V&)> strong_connect = [&](const V& vertex) {
-    indexes[vertex] = index;
-    low_links[vertex] = index;
-    ++index;
-    stack.push(vertex);
-    on_stack.insert(vertex);
-
-    if (graph.contains(vertex)) {
-      for (const V& neighbor : graph.at(vertex)) {
-        if (!indexes.contains(neighbor)) {
-          strong_connect(neighbor);
-          low_links.at(vertex) =
-              std::min(low_links.at(vertex), low_links.at(neighbor));
-        } else if (on_stack.contains(neighbor)) {
-          low_links.at(vertex) =
-              std::min(low_links.at(vertex), indexes.at(neighbor));
-        }
+  CsrGraph csr;
+  csr.offsets.reserve(vertices.size() + 1);
+  for (const V* vertex : vertices) {
+    auto it = graph.find(*vertex);
+    if (it != graph.end()) {
+      for (const V& target : it->second) {
+        csr.targets.push_back(ids.at(target));
       }
     }
+    csr.offsets.push_back(csr.targets.size());
+  }
 
-    if (low_links.at(vertex) == indexes.at(vertex)) {
-      absl::btree_set<V> scc;
-      V v;
-      do {
-        v = stack.top();
-        stack.pop();
-        on_stack.erase(v);
-        scc.insert(v);
-      } while (v != vertex);
-      result.push_back(scc);
-    }
-  };
-
-  for (const V& vertex : vertices) {
-    if (!indexes.contains(vertex)) {
-      strong_connect(vertex);
+  DenseComponents components = StronglyConnectedComponents(csr);
+  std::vector<absl::btree_set<V>> result;
+  result.reserve(components.component_count());
+  for (int64_t i = 0; i < components.component_count(); ++i) {
+    absl::btree_set<V>& scc = result.emplace_back();
+    for (int64_t id : components.component(i)) {
+      scc.insert(*vertices[id]);
     }
   }
-
   return result;
 }
 
@@ -14,12 +14,21 @@
 
 #include "xls/data_structures/strongly_connected_components.h"
 
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/types/span.h"
 
 namespace xls {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
 using V = std::string;
 
 absl::btree_set<V> FlattenSCCs(const std::vector<absl::btree_set<V>>& sccs) {
@@ -140,5 +149,58 @@ TEST(StronglyConnectedComponentsTest, Tree) {
   EXPECT_EQ(FlattenSCCs(sccs).size(), GraphSize(graph));
 }
 
+// Builds a CsrGraph from a list of edges on `n` vertices.
+CsrGraph MakeCsrGraph(int64_t n,
+                      absl::Span<const std::pair<int64_t, int64_t>> edges) {
+  std::vector<std::vector<int64_t>> adjacency(n);
+  for (const auto& [source, target] : edges) {
+    adjacency[source].push_back(target);
+  }
+  CsrGraph graph;
+  for (const std::vector<int64_t>& targets : adjacency) {
+    graph.targets.insert(graph.targets.end(), targets.begin(), targets.end());
+    graph.offsets.push_back(graph.targets.size());
+  }
+  return graph;
+}
+
+TEST(StronglyConnectedComponentsTest, DenseBarBellWithSelfEdge) {
+  // 0 -> 1 -> 2 -> 0, 2 -> 3, 3 -> 4 -> 3, and 5 -> 5.
+  CsrGraph graph = MakeCsrGraph(
+      6, {{0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 4}, {4, 3}, {5, 5}});
+  DenseComponents sccs = StronglyConnectedComponents(graph);
+  ASSERT_EQ(sccs.component_count(), 3);
+  // Components are completed in reverse topological order.
+  EXPECT_THAT(sccs.component(0), UnorderedElementsAre(3, 4));
+  EXPECT_THAT(sccs.component(1), UnorderedElementsAre(0, 1, 2));
+  EXPECT_THAT(sccs.component(2), ElementsAre(5));
+}
+
+TEST(StronglyConnectedComponentsTest, DenseEmpty) {
+  DenseComponents sccs = StronglyConnectedComponents(CsrGraph());
+  EXPECT_EQ(sccs.component_count(), 0);
+}
+
+TEST(StronglyConnectedComponentsTest, DenseDeepChain) {
+  // A path deep enough to overflow the stack of a recursive implementation.
+  constexpr int64_t kSize = 1000000;
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t i = 0; i + 1 < kSize; ++i) {
+    edges.push_back({i, i + 1});
+  }
+  CsrGraph chain = MakeCsrGraph(kSize, edges);
+  DenseComponents sccs = StronglyConnectedComponents(chain);
+  ASSERT_EQ(sccs.component_count(), kSize);
+  EXPECT_THAT(sccs.component(0), ElementsAre(kSize - 1));
+  EXPECT_THAT(sccs.component(kSize - 1), ElementsAre(0));
+
+  // Closing the path makes it a single component.
+  edges.push_back({kSize - 1, 0});
+  CsrGraph cycle = MakeCsrGraph(kSize, edges);
+  sccs = StronglyConnectedComponents(cycle);
+  ASSERT_EQ(sccs.component_count(), 1);
+  EXPECT_EQ(sccs.component(0).size(), kSize);
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,11 +15,16 @@
 #ifndef XLS_DATA_STRUCTURES_SUBMODULAR_H_
 #define XLS_DATA_STRUCTURES_SUBMODULAR_H_
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <random>
+#include <utility>
+#include <vector>
 
 #include "absl/container/btree_set.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/thread_pool.h"
 
 namespace xls {
 
@@ -33,6 +38,11 @@ struct MinimizeOptions {
   MinimizeMode mode;
   std::optional<int64_t> seed;
   int64_t rounds;
+
+  // The number of rounds run at once on the shared thread pool. The result
+  // does not depend on this, but above one the function must be safe to call
+  // concurrently.
+  int64_t num_threads = 1;
 };
 
 // A submodular function is a function from a set to the reals that has
@@ -92,8 +102,7 @@ class SubmodularFunction {
   // Approximate minimization of a submodular function.
   absl::btree_set<T, C> ApproxMinimize(const MinimizeOptions& options) {
     XLS_CHECK_GT(options.rounds, 0);
-    double best_cost = std::numeric_limits<double>::max();
-    absl::btree_set<T, C> best;
+    XLS_CHECK_GT(options.num_threads, 0);
 
     int64_t seed;
 
@@ -107,42 +116,49 @@ class SubmodularFunction {
     std::mt19937_64 engine(seed);
     std::bernoulli_distribution coin(0.5);
 
-    for (int64_t i = 0; i < options.rounds + 2; ++i) {
-      absl::btree_set<T, C> random;
-
+    // The starting points are drawn up front so the rounds are independent
+    // and the result is the same however they are spread over threads.
+    std::vector<absl::btree_set<T, C>> initial(options.rounds + 2);
+    for (int64_t i = 0; i < initial.size(); ++i) {
       if (i == 0) {
         // Keep random empty
       } else if (i == 1) {
-        random = universe_;
+        initial[i] = universe_;
       } else {
         for (const T& element : universe_) {
           if (coin(engine)) {
-            random.insert(element);
+            initial[i].insert(element);
           }
         }
       }
+    }
 
-      absl::btree_set<T, C> newest;
-
+    std::vector<absl::btree_set<T, C>> results(initial.size());
+    std::vector<double> costs(initial.size());
+    auto run_round = [&](int64_t i) {
       switch (options.mode) {
         case MinimizeMode::MMinI:
-          newest = MMinI(random);
+          results[i] = MMinI(initial[i]);
           break;
         case MinimizeMode::MMinII:
-          newest = MMinII(random);
+          results[i] = MMinII(initial[i]);
           break;
         case MinimizeMode::Alternating:
-          newest = AlternatingMin(random);
+          results[i] = AlternatingMin(initial[i]);
           break;
       }
-
-      double newest_cost = function_(newest);
-      if (newest_cost < best_cost) {
-        best = newest;
-        best_cost = newest_cost;
+      costs[i] = function_(results[i]);
+    };
+    BoundedParallelFor(0, initial.size(), options.num_threads, run_round);
+
+    // Ties go to the earliest round.
+    int64_t best = 0;
+    for (int64_t i = 1; i < costs.size(); ++i) {
+      if (costs[i] < costs[best]) {
+        best = i;
       }
     }
-    return best;
+    return std::move(results[best]);
   }
 
   // Uses the alternating algorithm for submodular minimization.
@@ -166,11 +182,20 @@ class SubmodularFunction {
       x_old = x;
       // By Lemma 5.4, the body of the loop is equivalent to
       // `X_{t + 1} = X_t ∪ {j | f(j | X_t) < 0}`
+      // Elements already in `X_t` have an incremental value of zero, and
+      // `f(X_t)` is shared by every incremental value.
       absl::btree_set<T, C> x_new = x;
+      const double cost = function_(x);
+      absl::btree_set<T, C> incremented = x;
       for (const T& j : universe_) {
-        if (IncrementalValue(x, j) < 0) {
+        if (x.contains(j)) {
+          continue;
+        }
+        auto [it, inserted] = incremented.insert(j);
+        if (function_(incremented) - cost < 0) {
           x_new.insert(j);
         }
+        incremented.erase(it);
       }
       x = x_new;
     } while (x_old.value() != x);
@@ -185,11 +210,17 @@ class SubmodularFunction {
       x_old = x;
       // By Lemma 5.4, the body of the loop is equivalent to
       // `X_{t + 1} = X_t \ {j | f(j | X_t \ {j}) > 0}`
+      // Elements not in `X_t` have a decremental value of zero, and `f(X_t)`
+      // is shared by every decremental value.
       absl::btree_set<T, C> x_new = x;
-      for (const T& j : universe_) {
-        if (DecrementalValue(x, j) > 0) {
+      const double cost = function_(x);
+      absl::btree_set<T, C> decremented = x;
+      for (const T& j : x) {
+        decremented.erase(j);
+        if (cost - function_(decremented) > 0) {
           x_new.erase(j);
         }
+        decremented.insert(j);
       }
       x = x_new;
     } while (x_old.value() != x);
@@ -67,5 +67,33 @@ TEST(SubmodularTest, Iwata) {
   EXPECT_EQ(f.Call(result), -166167);
 }
 
+TEST(SubmodularTest, ThreadsDoNotChangeResult) {
+  absl::btree_set<int32_t> universe;
+  for (int32_t i = 0; i < 40; ++i) {
+    universe.insert(i);
+  }
+  // A cut function of a cycle plus a modular term, which is submodular.
+  SubmodularFunction<int32_t> f(
+      universe, [](const absl::btree_set<int32_t>& subset) -> double {
+        double result = 0.0;
+        for (int32_t i = 0; i < 40; ++i) {
+          if (subset.contains(i) != subset.contains((i + 1) % 40)) {
+            result += 1.0;
+          }
+          if (subset.contains(i)) {
+            result += (i % 7) - 3;
+          }
+        }
+        return result;
+      });
+  for (MinimizeMode mode : {MinimizeMode::MMinI, MinimizeMode::MMinII,
+                            MinimizeMode::Alternating}) {
+    absl::btree_set<int32_t> sequential =
+        f.ApproxMinimize({mode, 42, 20, /*num_threads=*/1});
+    EXPECT_EQ(f.ApproxMinimize({mode, 42, 20, /*num_threads=*/4}),
+              sequential);
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,17 +15,42 @@
 #ifndef XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 #define XLS_DATA_STRUCTURES_TRANSITIVE_CLOSURE_H_
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/log_message.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 
 template <typename V>
 using HashRelation = absl::flat_hash_map<V, absl::flat_hash_set<V>>;
 
+// Compute the transitive closure of a relation over the dense indices
+// [0, relation.size()), where bit j of `relation[i]` is set iff i is related to
+// j. Every bitmap must have relation.size() bits.
+inline std::vector<InlineBitmap> TransitiveClosure(
+    std::vector<InlineBitmap> relation) {
+  // Warshall's algorithm; https://cs.winona.edu/lin/cs440/ch08-2.pdf
+  //
+  // Row i gains every index reachable from k once i reaches k, so each step of
+  // the inner loop is a single OR of bitmaps rather than n bit operations.
+  const int64_t n = relation.size();
+  for (int64_t k = 0; k < n; ++k) {
+    for (int64_t i = 0; i < n; ++i) {
+      if (i != k && relation[i].Get(k)) {
+        relation[i].Union(relation[k]);
+      }
+    }
+  }
+  return relation;
+}
+
 // Compute the transitive closure of a relation.
 template <typename V>
 HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
@@ -35,60 +60,42 @@ HashRelation<V> TransitiveClosure(const HashRelation<V>& relation) {
     return Rel();
   }
 
-  absl::flat_hash_set<V> unordered_nodes;
+  std::vector<V> ordered_nodes;
+  absl::flat_hash_map<V, int64_t> node_to_index;
+  auto index_of = [&](const V& node) -> int64_t {
+    auto [it, inserted] = node_to_index.try_emplace(node, ordered_nodes.size());
+    if (inserted) {
+      ordered_nodes.push_back(node);
+    }
+    return it->second;
+  };
   for (const auto& [node, children] : relation) {
-    unordered_nodes.insert(node);
+    index_of(node);
     for (const auto& child : children) {
-      unordered_nodes.insert(child);
+      index_of(child);
     }
   }
 
-  std::vector<V> ordered_nodes(unordered_nodes.begin(), unordered_nodes.end());
-  std::sort(ordered_nodes.begin(), ordered_nodes.end());
-
   const int64_t n = ordered_nodes.size();
-
-  absl::flat_hash_map<V, int64_t> node_to_index;
-  for (int64_t i = 0; i < n; ++i) {
-    node_to_index[ordered_nodes[i]] = i;
-  }
-
-  // Warshall's algorithm; https://cs.winona.edu/lin/cs440/ch08-2.pdf
-
-  auto get = [&](const HashRelation<int64_t>& rel, int64_t i,
-                 int64_t j) -> bool {
-    return rel.contains(i) && rel.at(i).contains(j);
-  };
-
-  auto set = [&](HashRelation<int64_t>* rel, int64_t i, int64_t j, bool value) {
-    if (value) {
-      (*rel)[i].insert(j);
-    } else {
-      (*rel)[i].erase(j);
-    }
-  };
-
-  HashRelation<int64_t> lag;
+  std::vector<InlineBitmap> dense(n, InlineBitmap(n));
   for (const auto& [node, children] : relation) {
+    InlineBitmap& row = dense[node_to_index.at(node)];
     for (const auto& child : children) {
-      set(&lag, node_to_index.at(node), node_to_index.at(child), true);
+      row.Set(node_to_index.at(child));
     }
   }
-  HashRelation<int64_t> closure = lag;
-  for (int64_t k = 0; k < n; ++k) {
-    for (int64_t i = 0; i < n; ++i) {
-      for (int64_t j = 0; j < n; ++j) {
-        set(&closure, i, j,
-            get(lag, i, j) || (get(lag, i, k) && get(lag, k, j)));
-      }
-    }
-    lag = closure;
-  }
+  std::vector<InlineBitmap> closure = TransitiveClosure(std::move(dense));
 
   Rel result;
-  for (const auto& [node_index, children_indices] : closure) {
-    for (const auto& child_index : children_indices) {
-      result[ordered_nodes[node_index]].insert(ordered_nodes[child_index]);
+  for (int64_t i = 0; i < n; ++i) {
+    if (closure[i].IsAllZeroes()) {
+      continue;
+    }
+    absl::flat_hash_set<V>& children = result[ordered_nodes[i]];
+    for (int64_t j = 0; j < n; ++j) {
+      if (closure[i].Get(j)) {
+        children.insert(ordered_nodes[j]);
+      }
     }
   }
 
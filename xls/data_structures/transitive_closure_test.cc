@@ -14,10 +14,15 @@
 
 #include "xls/data_structures/transitive_closure.h"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
 namespace {
@@ -41,5 +46,32 @@ TEST(TransitiveClosureTest, Simple) {
   EXPECT_FALSE(tc.contains("qux"));
 }
 
+TEST(TransitiveClosureTest, Cycle) {
+  HashRelation<V> rel;
+  rel["a"].insert("b");
+  rel["b"].insert("c");
+  rel["c"].insert("a");
+  HashRelation<V> tc = TransitiveClosure<V>(rel);
+  EXPECT_THAT(tc.at("a"), UnorderedElementsAre("a", "b", "c"));
+  EXPECT_THAT(tc.at("b"), UnorderedElementsAre("a", "b", "c"));
+  EXPECT_THAT(tc.at("c"), UnorderedElementsAre("a", "b", "c"));
+}
+
+TEST(TransitiveClosureTest, DenseChain) {
+  // A chain 0 -> 1 -> ... -> n-1 spanning several words per row.
+  constexpr int64_t kSize = 200;
+  std::vector<InlineBitmap> rel(kSize, InlineBitmap(kSize));
+  for (int64_t i = 0; i + 1 < kSize; ++i) {
+    rel[i].Set(i + 1);
+  }
+  std::vector<InlineBitmap> tc = TransitiveClosure(std::move(rel));
+  ASSERT_EQ(tc.size(), kSize);
+  for (int64_t i = 0; i < kSize; ++i) {
+    for (int64_t j = 0; j < kSize; ++j) {
+      EXPECT_EQ(tc[i].Get(j), j > i) << i << " -> " << j;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -73,6 +73,63 @@ class UnionFind {
   UnionFindMap<T, absl::monostate> union_find_map_;
 };
 
+// A union-find over the dense integer ids [0, size). Unlike UnionFind, which
+// hashes its elements, this stores a parent and a rank per id in flat arrays
+// and uses union by rank and path halving, so it scales to many millions of
+// elements.
+class DenseUnionFind {
+ public:
+  // Creates a union-find of `size` elements, each in its own equivalence
+  // class.
+  explicit DenseUnionFind(int64_t size)
+      : parent_(size), rank_(size, 0), set_count_(size) {
+    for (int64_t i = 0; i < size; ++i) {
+      parent_[i] = i;
+    }
+  }
+
+  // Union together the equivalence classes of two elements. Returns whether
+  // they were in different classes.
+  bool Union(int64_t x, int64_t y) {
+    x = Find(x);
+    y = Find(y);
+    if (x == y) {
+      return false;
+    }
+    if (rank_[x] < rank_[y]) {
+      std::swap(x, y);
+    }
+    parent_[y] = x;
+    if (rank_[x] == rank_[y]) {
+      ++rank_[x];
+    }
+    --set_count_;
+    return true;
+  }
+
+  // Returns the representative element in the given element's equivalence
+  // class.
+  int64_t Find(int64_t element) {
+    XLS_DCHECK(element >= 0 && element < size());
+    while (parent_[element] != element) {
+      parent_[element] = parent_[parent_[element]];
+      element = parent_[element];
+    }
+    return element;
+  }
+
+  // Returns the number of elements in the data structure.
+  int64_t size() const { return parent_.size(); }
+
+  // Returns the number of equivalence classes.
+  int64_t set_count() const { return set_count_; }
+
+ private:
+  std::vector<int64_t> parent_;
+  std::vector<uint8_t> rank_;
+  int64_t set_count_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_UNION_FIND_H_
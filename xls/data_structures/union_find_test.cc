@@ -67,5 +67,35 @@ TEST(UnionFindTest, UnionFind) {
   EXPECT_THAT(uf.Find('a'), AnyOf('a', 'b', 'c', 'd'));
 }
 
+TEST(UnionFindTest, DenseUnionFind) {
+  DenseUnionFind uf(5);
+  EXPECT_EQ(uf.size(), 5);
+  EXPECT_EQ(uf.set_count(), 5);
+  for (int64_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(uf.Find(i), i);
+  }
+
+  // Unioning an element with itself should have no effect.
+  EXPECT_FALSE(uf.Union(2, 2));
+  EXPECT_EQ(uf.set_count(), 5);
+
+  EXPECT_TRUE(uf.Union(0, 1));
+  EXPECT_TRUE(uf.Union(3, 4));
+  EXPECT_EQ(uf.set_count(), 3);
+  EXPECT_EQ(uf.Find(0), uf.Find(1));
+  EXPECT_EQ(uf.Find(3), uf.Find(4));
+  EXPECT_NE(uf.Find(0), uf.Find(3));
+  EXPECT_EQ(uf.Find(2), 2);
+
+  EXPECT_TRUE(uf.Union(1, 4));
+  EXPECT_FALSE(uf.Union(0, 3));
+  EXPECT_EQ(uf.set_count(), 2);
+  EXPECT_THAT(uf.Find(3), AnyOf(0, 1, 3, 4));
+  for (int64_t i : {1, 3, 4}) {
+    EXPECT_EQ(uf.Find(i), uf.Find(0));
+  }
+  EXPECT_EQ(uf.Find(2), 2);
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,11 +14,14 @@
 
 #include "xls/delay_model/delay_estimator.h"
 
+#include <memory>
+
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/status/status_builder.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/nodes.h"
 #include "xls/netlist/logical_effort.h"
 
@@ -75,7 +78,8 @@ absl::Status DelayEstimatorManager::RegisterDelayEstimator(
     return absl::InternalError(
         absl::StrFormat("Delay estimator named %s already exists", name));
   }
-  estimators_[name] = {precedence, std::move(delay_estimator)};
+  estimators_[name] = {precedence, std::make_unique<CachingDelayEstimator>(
+                                       std::move(delay_estimator))};
   estimator_names_.push_back(name);
   std::sort(estimator_names_.begin(), estimator_names_.end());
 
@@ -169,6 +173,75 @@ absl::StatusOr<int64_t> DecoratingDelayEstimator::GetOperationDelayInPs(
   return modifier_(node, original);
 }
 
+CachingDelayEstimator::CachingDelayEstimator(std::string_view name,
+                                             const DelayEstimator& decorated)
+    : DelayEstimator(name), decorated_(decorated) {}
+
+CachingDelayEstimator::CachingDelayEstimator(
+    std::unique_ptr<DelayEstimator> decorated)
+    : DelayEstimator(decorated->name()),
+      owned_(std::move(decorated)),
+      decorated_(*owned_) {}
+
+CachingDelayEstimator::FunctionDelays& CachingDelayEstimator::GetFunctionDelays(
+    FunctionBase* f) const {
+  auto it = cache_.find(f->uid());
+  if (it == cache_.end()) {
+    if (cache_.size() >= kMaxCachedFunctionBases) {
+      cache_.clear();
+    }
+    it = cache_.insert({f->uid(), FunctionDelays{f->change_count(), {}}}).first;
+  } else if (it->second.change_count != f->change_count()) {
+    it->second.change_count = f->change_count();
+    it->second.delays.clear();
+  }
+  return it->second;
+}
+
+absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
+    Node* node) const {
+  FunctionBase* f = node->function_base();
+  {
+    absl::MutexLock lock(&mutex_);
+    FunctionDelays& function_delays = GetFunctionDelays(f);
+    auto it = function_delays.delays.find(node);
+    if (it != function_delays.delays.end()) {
+      ++hit_count_;
+      return it->second;
+    }
+    ++miss_count_;
+  }
+  // Evaluate the delay model without holding the lock so concurrent lookups
+  // are not serialized.
+  XLS_ASSIGN_OR_RETURN(int64_t delay, decorated_.GetOperationDelayInPs(node));
+  absl::MutexLock lock(&mutex_);
+  GetFunctionDelays(f).delays[node] = delay;
+  return delay;
+}
+
+void CachingDelayEstimator::PrecomputeDelays(FunctionBase* f) const {
+  absl::flat_hash_map<Node*, int64_t> delays;
+  delays.reserve(f->node_count());
+  for (Node* node : f->nodes()) {
+    absl::StatusOr<int64_t> delay = decorated_.GetOperationDelayInPs(node);
+    if (delay.ok()) {
+      delays[node] = delay.value();
+    }
+  }
+  absl::MutexLock lock(&mutex_);
+  GetFunctionDelays(f).delays = std::move(delays);
+}
+
+int64_t CachingDelayEstimator::hit_count() const {
+  absl::MutexLock lock(&mutex_);
+  return hit_count_;
+}
+
+int64_t CachingDelayEstimator::miss_count() const {
+  absl::MutexLock lock(&mutex_);
+  return miss_count_;
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
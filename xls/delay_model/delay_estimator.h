@@ -16,9 +16,12 @@
 #define XLS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 
 #include <cstdint>
+#include <memory>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node.h"
@@ -62,6 +65,61 @@ class DecoratingDelayEstimator : public DelayEstimator {
   std::function<int64_t(Node*, int64_t)> modifier_;
 };
 
+// Decorates an underlying delay estimator with a cache of the delays of nodes.
+// The delays of the nodes of a function base are valid for the version of the
+// function base (FunctionBase::change_count) they were computed for, so any
+// mutation of a function base drops its cached delays. Errors are not cached.
+// The methods are thread-safe.
+class CachingDelayEstimator : public DelayEstimator {
+ public:
+  // Caches the delays of `decorated`, which must outlive this object.
+  CachingDelayEstimator(std::string_view name, const DelayEstimator& decorated);
+
+  // Caches the delays of `decorated`, which is owned by this object, under the
+  // name of `decorated`.
+  explicit CachingDelayEstimator(std::unique_ptr<DelayEstimator> decorated);
+
+  ~CachingDelayEstimator() override = default;
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
+
+  // Computes the delays of all of the nodes of `f` at once so later lookups
+  // are answered from the table of delays of `f`. Nodes whose delay cannot be
+  // estimated are skipped; the error is returned by the lookup of the node.
+  void PrecomputeDelays(FunctionBase* f) const;
+
+  // Returns the number of lookups answered from and missing the cache.
+  int64_t hit_count() const;
+  int64_t miss_count() const;
+
+ private:
+  // The cached delays of the nodes of a version of a function base.
+  struct FunctionDelays {
+    int64_t change_count;
+    absl::flat_hash_map<Node*, int64_t> delays;
+  };
+
+  // The maximum number of function bases with cached delays. The cache is
+  // cleared when it would be exceeded so delays of function bases which are
+  // no longer used are not held forever.
+  static constexpr int64_t kMaxCachedFunctionBases = 16;
+
+  // Returns the cached delays of the current version of `f`, creating an
+  // empty entry if there is none.
+  FunctionDelays& GetFunctionDelays(FunctionBase* f) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  std::unique_ptr<DelayEstimator> owned_;
+  const DelayEstimator& decorated_;
+
+  mutable absl::Mutex mutex_;
+  // The cached delays indexed by FunctionBase::uid.
+  mutable absl::flat_hash_map<int64_t, FunctionDelays> cache_
+      ABSL_GUARDED_BY(mutex_);
+  mutable int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  mutable int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 enum class DelayEstimatorPrecedence {
   kLow = 1,
   kMedium = 2,
@@ -79,6 +137,9 @@ class DelayEstimatorManager {
   absl::StatusOr<DelayEstimator*> GetDefaultDelayEstimator() const;
 
   // Adds a DelayEstimator to the manager and associates it with the given name.
+  // The manager returns the estimator decorated with a CachingDelayEstimator so
+  // repeated lookups of the delay of a node (e.g., during scheduling) skip the
+  // evaluation of the delay model.
   absl::Status RegisterDelayEstimator(
       std::unique_ptr<DelayEstimator> delay_estimator,
       DelayEstimatorPrecedence precedence);
@@ -126,5 +126,87 @@ TEST_F(DelayEstimatorTest, DecoratingDelayEstimator) {
               IsOkAndHolds(42));
 }
 
+// A test delay estimator which returns the bit count of the node and counts
+// the number of estimates made.
+class CountingDelayEstimator : public DelayEstimator {
+ public:
+  CountingDelayEstimator() : DelayEstimator("counting") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    ++estimate_count_;
+    if (node->Is<Literal>()) {
+      return absl::UnimplementedError("No delay for literals");
+    }
+    return node->GetType()->GetFlatBitCount();
+  }
+
+  int64_t estimate_count() const { return estimate_count_; }
+
+ private:
+  mutable int64_t estimate_count_ = 0;
+};
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Concat({sum, x})));
+
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
+  EXPECT_THAT(caching.GetOperationDelayInPs(sum.node()), IsOkAndHolds(8));
+  EXPECT_THAT(caching.GetOperationDelayInPs(sum.node()), IsOkAndHolds(8));
+  EXPECT_THAT(caching.GetOperationDelayInPs(f->return_value()),
+              IsOkAndHolds(16));
+  EXPECT_EQ(counting.estimate_count(), 2);
+  EXPECT_EQ(caching.hit_count(), 1);
+  EXPECT_EQ(caching.miss_count(), 2);
+
+  // Mutating the function drops its cached delays.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * literal, f->MakeNode<Literal>(SourceInfo(), Value(UBits(0, 8))));
+  EXPECT_THAT(caching.GetOperationDelayInPs(sum.node()), IsOkAndHolds(8));
+  EXPECT_EQ(counting.estimate_count(), 3);
+
+  // Precomputing estimates every node once. Errors are not cached.
+  caching.PrecomputeDelays(f);
+  EXPECT_EQ(counting.estimate_count(), 8);
+  for (Node* node : f->nodes()) {
+    if (node != literal) {
+      XLS_EXPECT_OK(caching.GetOperationDelayInPs(node).status());
+    }
+  }
+  EXPECT_EQ(counting.estimate_count(), 8);
+  EXPECT_THAT(caching.GetOperationDelayInPs(literal),
+              StatusIs(absl::StatusCode::kUnimplemented));
+  EXPECT_THAT(caching.GetOperationDelayInPs(literal),
+              StatusIs(absl::StatusCode::kUnimplemented));
+  EXPECT_EQ(counting.estimate_count(), 10);
+}
+
+TEST_F(DelayEstimatorTest, ManagerCachesDelays) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(fb.Not(x)));
+
+  DelayEstimatorManager manager;
+  auto counting = std::make_unique<CountingDelayEstimator>();
+  CountingDelayEstimator* counting_ptr = counting.get();
+  XLS_ASSERT_OK(manager.RegisterDelayEstimator(
+      std::move(counting), DelayEstimatorPrecedence::kLow));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * estimator,
+                           manager.GetDelayEstimator("counting"));
+  EXPECT_EQ(estimator->name(), "counting");
+  EXPECT_THAT(estimator->GetOperationDelayInPs(f->return_value()),
+              IsOkAndHolds(8));
+  EXPECT_THAT(estimator->GetOperationDelayInPs(f->return_value()),
+              IsOkAndHolds(8));
+  EXPECT_EQ(counting_ptr->estimate_count(), 1);
+}
+
 }  // namespace
 }  // namespace xls
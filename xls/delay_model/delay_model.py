@@ -21,9 +21,10 @@ well as provide delay estimates in Python.
 """
 
 import abc
+import math
 import random
 
-from typing import Sequence, Text, Tuple, Callable
+from typing import Callable, Optional, Sequence, Text, Tuple
 import warnings
 
 import numpy as np
@@ -31,6 +32,10 @@ from scipy import optimize as opt
 
 from xls.delay_model import delay_model_pb2
 
+# Regression estimators which depend on a single bit count are tabulated for
+# bit counts 1 through this value in the generated C++ code.
+DELAY_TABLE_MAX_BIT_COUNT = 256
+
 
 class Error(Exception):
   pass
@@ -201,6 +206,18 @@ def _operation_delay_expression(expression: delay_model_pb2.DelayExpression,
   return expression.constant
 
 
+def _delay_expression_factors(
+    expression: delay_model_pb2.DelayExpression
+) -> Sequence[delay_model_pb2.DelayFactor]:
+  """Returns the delay factors referenced by a delay expression."""
+  if expression.HasField('bin_op'):
+    return (list(_delay_expression_factors(expression.lhs_expression)) +
+            list(_delay_expression_factors(expression.rhs_expression)))
+  if expression.HasField('factor'):
+    return [expression.factor]
+  return []
+
+
 def _delay_factor_cpp_expression(factor: delay_model_pb2.DelayFactor,
                                  node_identifier: Text) -> Text:
   """Returns a C++ expression which computes a delay factor of an XLS Node*.
@@ -476,7 +493,67 @@ class RegressionEstimator(Estimator):
     """Returns the delay with delay expressions passed in as floats."""
     return self.delay_function(xargs)
 
+  def _table_factor(self) -> Optional[delay_model_pb2.DelayFactor]:
+    """Returns the single bit count factor the delay depends on, if any."""
+    factors = []
+    for expression in self.delay_expressions:
+      factors.extend(_delay_expression_factors(expression))
+    if not factors or any(f != factors[0] for f in factors):
+      return None
+    e = delay_model_pb2.DelayFactor.Source
+    if factors[0].source not in (e.RESULT_BIT_COUNT, e.OPERAND_BIT_COUNT,
+                                 e.OPERAND_ELEMENT_BIT_COUNT):
+      return None
+    return factors[0]
+
+  def delay_table(self) -> Optional[Sequence[int]]:
+    """Returns the delays for bit counts 1 to DELAY_TABLE_MAX_BIT_COUNT.
+
+    The delays are rounded as in the generated C++ code. Returns None if the
+    delay does not depend on exactly one bit count factor, or if a delay does
+    not fit in an int64_t.
+    """
+    factor = self._table_factor()
+    if factor is None:
+      return None
+    table = []
+    for bit_count in range(1, DELAY_TABLE_MAX_BIT_COUNT + 1):
+      operation = delay_model_pb2.Operation(bit_count=bit_count)
+      if factor.source != delay_model_pb2.DelayFactor.Source.RESULT_BIT_COUNT:
+        for _ in range(factor.operand_number + 1):
+          operation.operands.add()
+        operation.operands[factor.operand_number].bit_count = bit_count
+      delay = self.raw_delay(
+          tuple(
+              _operation_delay_expression(e, operation)
+              for e in self.delay_expressions))
+      if not math.isfinite(delay) or abs(delay) >= 2**63:
+        return None
+      # Round half away from zero like std::round.
+      table.append(int(math.copysign(math.floor(abs(delay) + 0.5), delay)))
+    return table
+
   def cpp_delay_code(self, node_identifier: Text) -> Text:
+    lines = []
+    table = self.delay_table()
+    if table is not None:
+      rows = [
+          ', '.join(str(d) for d in table[i:i + 16])
+          for i in range(0, len(table), 16)
+      ]
+      lines.append('static constexpr int64_t kDelayTable[] = {')
+      lines.append(',\n'.join('  ' + row for row in rows))
+      lines.append('};')
+      lines.append('const int64_t bit_count = {};'.format(
+          _delay_factor_cpp_expression(self._table_factor(), node_identifier)))
+      lines.append('if (bit_count >= 1 && bit_count <= {}) {{'.format(
+          len(table)))
+      lines.append('  return kDelayTable[bit_count - 1];')
+      lines.append('}')
+    lines.append(self._cpp_regression_code(node_identifier))
+    return '\n'.join(lines)
+
+  def _cpp_regression_code(self, node_identifier: Text) -> Text:
     terms = [str(self.params[0])]
     for i, expression in enumerate(self.delay_expressions):
       e_str = _delay_expression_cpp_expression(expression, node_identifier)
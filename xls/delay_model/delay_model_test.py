@@ -167,8 +167,21 @@ class DelayModelTest(absltest.TestCase):
         foo.operation_delay(_parse_operation('op: "kFoo" bit_count: 42')),
         4200,
         delta=2)
+    table = foo.delay_table()
+    self.assertLen(table, delay_model.DELAY_TABLE_MAX_BIT_COUNT)
+    for bit_count in (1, 2, 3, 42, 256):
+      self.assertAlmostEqual(
+          table[bit_count - 1],
+          foo.operation_delay(
+              _parse_operation('op: "kFoo" bit_count: %d' % bit_count)),
+          delta=1)
     self.assertEqualIgnoringWhitespaceAndFloats(
         foo.cpp_delay_code('node'), r"""
+          static constexpr int64_t kDelayTable[] = {%s};
+          const int64_t bit_count = node->GetType()->GetFlatBitCount();
+          if (bit_count >= 1 && bit_count <= 256) {
+            return kDelayTable[bit_count - 1];
+          }
           return std::round(
               0.0 + 0.0 * static_cast<float>(node->GetType()->GetFlatBitCount()) +
               0.0 *
@@ -178,7 +191,7 @@ class DelayModelTest(absltest.TestCase):
                  : static_cast<float>(node->GetType()->GetFlatBitCount())
               )
             );
-        """)
+        """ % ','.join(str(d) for d in table))
 
   def test_one_regression_estimator_operand_count(self):
 
@@ -204,6 +217,7 @@ class DelayModelTest(absltest.TestCase):
         foo.operation_delay(_parse_operation(gen_operation(4))), 12, delta=1)
     self.assertAlmostEqual(
         foo.operation_delay(_parse_operation(gen_operation(256))), 18, delta=1)
+    self.assertIsNone(foo.delay_table())
     self.assertEqualIgnoringWhitespaceAndFloats(
         foo.cpp_delay_code('node'), r"""
           return std::round(
@@ -812,6 +826,11 @@ class DelayModelTest(absltest.TestCase):
                 "Unhandled node for delay estimation: " +
                 node->ToStringWithOperandTypes());
             }
+            static constexpr int64_t kDelayTable[] = {%s};
+            const int64_t bit_count = node->GetType()->GetFlatBitCount();
+            if (bit_count >= 1 && bit_count <= 256) {
+              return kDelayTable[bit_count - 1];
+            }
             return std::round(
                 0.0 + 0.0 * static_cast<float>(node->GetType()->GetFlatBitCount()) +
                 0.0 * std::log2(
@@ -820,7 +839,7 @@ class DelayModelTest(absltest.TestCase):
                   static_cast<float>(node->GetType()->GetFlatBitCount())
                 ));
           }
-        """)
+        """ % ','.join(str(d) for d in op_model.estimator.delay_table()))
 
   def test_regression_estimator_generate_validation_sets(self):
     raw_data_points = [(0, 0), (1, 1), (2, 2), (3, 3), (4, 4), (5, 5)]
@@ -0,0 +1,331 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/delay_model/incremental_critical_path.h"
+
+#include <algorithm>
+#include <queue>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/node_iterator.h"
+
+namespace xls {
+
+IncrementalCriticalPathAnalysis::IncrementalCriticalPathAnalysis(
+    FunctionBase* f, std::optional<int64_t> clock_period_ps,
+    const DelayEstimator& delay_estimator)
+    : f_(f),
+      clock_period_ps_(clock_period_ps),
+      delay_estimator_(delay_estimator),
+      by_path_delay_([this](Node* a, Node* b) {
+        int64_t a_delay = entries_.at(a).path_delay;
+        int64_t b_delay = entries_.at(b).path_delay;
+        return a_delay > b_delay || (a_delay == b_delay && a->id() < b->id());
+      }) {}
+
+/* static */ absl::StatusOr<std::unique_ptr<IncrementalCriticalPathAnalysis>>
+IncrementalCriticalPathAnalysis::Create(FunctionBase* f,
+                                        std::optional<int64_t> clock_period_ps,
+                                        const DelayEstimator& delay_estimator) {
+  auto analysis = absl::WrapUnique(
+      new IncrementalCriticalPathAnalysis(f, clock_period_ps, delay_estimator));
+  std::vector<Node*> topo_sort = TopoSort(f).AsVector();
+  for (Node* node : topo_sort) {
+    NodeEntry& entry = analysis->entries_[node];
+    XLS_ASSIGN_OR_RETURN(entry.node_delay, analysis->GetNodeDelay(node));
+    entry.operands = std::vector<Node*>(node->operands().begin(),
+                                        node->operands().end());
+  }
+  analysis->RenumberNodes();
+  for (Node* node : topo_sort) {
+    analysis->UpdatePathDelay(node);
+  }
+  for (auto it = topo_sort.rbegin(); it != topo_sort.rend(); ++it) {
+    analysis->UpdateDownstreamDelay(*it);
+  }
+  return analysis;
+}
+
+absl::StatusOr<int64_t> IncrementalCriticalPathAnalysis::GetNodeDelay(
+    Node* node) const {
+  auto it = delay_overrides_.find(node);
+  if (it != delay_overrides_.end()) {
+    return it->second;
+  }
+  return delay_estimator_.GetOperationDelayInPs(node);
+}
+
+void IncrementalCriticalPathAnalysis::RenumberNodes() {
+  int64_t topo_index = 0;
+  for (Node* node : TopoSort(f_)) {
+    auto it = entries_.find(node);
+    if (it != entries_.end()) {
+      it->second.topo_index = topo_index++;
+    }
+  }
+}
+
+std::pair<int64_t, bool> IncrementalCriticalPathAnalysis::StartTime(
+    int64_t operand_delay, int64_t node_delay) const {
+  // If the dependency straddles a clock boundary the node has to start from
+  // the clock time.
+  if (clock_period_ps_.has_value() &&
+      (((operand_delay + node_delay) / clock_period_ps_.value()) >
+       (operand_delay / clock_period_ps_.value()))) {
+    return {RoundDownToNearest(operand_delay + node_delay,
+                               clock_period_ps_.value()),
+            true};
+  }
+  return {operand_delay, false};
+}
+
+bool IncrementalCriticalPathAnalysis::UpdatePathDelay(Node* node) {
+  // The maximum delay from any path up to but not including `node`.
+  int64_t max_path_delay = 0;
+  std::optional<Node*> critical_path_predecessor;
+  for (Node* operand : node->operands()) {
+    int64_t operand_path_delay = entries_.at(operand).path_delay;
+    if (operand_path_delay >= max_path_delay) {
+      max_path_delay = operand_path_delay;
+      critical_path_predecessor = operand;
+    }
+  }
+
+  // The ordering of `by_path_delay_` depends on the path delay so the node has
+  // to be removed while it changes.
+  by_path_delay_.erase(node);
+  NodeEntry& entry = entries_.at(node);
+  auto [start, delayed_by_cycle_boundary] =
+      StartTime(max_path_delay, entry.node_delay);
+  int64_t path_delay = start + entry.node_delay;
+  bool changed = path_delay != entry.path_delay ||
+                 critical_path_predecessor != entry.critical_path_predecessor ||
+                 delayed_by_cycle_boundary != entry.delayed_by_cycle_boundary;
+  entry.path_delay = path_delay;
+  entry.critical_path_predecessor = critical_path_predecessor;
+  entry.delayed_by_cycle_boundary = delayed_by_cycle_boundary;
+  by_path_delay_.insert(node);
+  return changed;
+}
+
+bool IncrementalCriticalPathAnalysis::UpdateDownstreamDelay(Node* node) {
+  int64_t downstream_delay = 0;
+  for (Node* user : node->users()) {
+    auto it = entries_.find(user);
+    if (it != entries_.end()) {
+      downstream_delay =
+          std::max(downstream_delay,
+                   it->second.node_delay + it->second.downstream_delay);
+    }
+  }
+  NodeEntry& entry = entries_.at(node);
+  bool changed = downstream_delay != entry.downstream_delay;
+  entry.downstream_delay = downstream_delay;
+  return changed;
+}
+
+void IncrementalCriticalPathAnalysis::Propagate(
+    absl::Span<Node* const> nodes, absl::Span<Node* const> upstream_nodes) {
+  // Path delays are recomputed in topological order so each node is visited
+  // at most once, after all of its affected operands.
+  std::set<std::pair<int64_t, Node*>> forward;
+  for (Node* node : nodes) {
+    forward.insert({entries_.at(node).topo_index, node});
+  }
+  absl::flat_hash_set<Node*> seeds(nodes.begin(), nodes.end());
+  while (!forward.empty()) {
+    Node* node = forward.begin()->second;
+    forward.erase(forward.begin());
+    if (!UpdatePathDelay(node) && !seeds.contains(node)) {
+      continue;
+    }
+    for (Node* user : node->users()) {
+      auto it = entries_.find(user);
+      if (it != entries_.end()) {
+        forward.insert({it->second.topo_index, user});
+      }
+    }
+  }
+
+  // Downstream delays are recomputed in reverse topological order.
+  std::set<std::pair<int64_t, Node*>, std::greater<>> backward;
+  for (Node* node : upstream_nodes) {
+    auto it = entries_.find(node);
+    if (it != entries_.end()) {
+      backward.insert({it->second.topo_index, node});
+    }
+  }
+  while (!backward.empty()) {
+    Node* node = backward.begin()->second;
+    backward.erase(backward.begin());
+    if (!UpdateDownstreamDelay(node)) {
+      continue;
+    }
+    for (Node* operand : node->operands()) {
+      backward.insert({entries_.at(operand).topo_index, operand});
+    }
+  }
+}
+
+absl::Status IncrementalCriticalPathAnalysis::SetNodeDelay(Node* node,
+                                                           int64_t delay_ps) {
+  XLS_RET_CHECK(entries_.contains(node)) << node->GetName();
+  delay_overrides_[node] = delay_ps;
+  entries_.at(node).node_delay = delay_ps;
+  Propagate({node}, node->operands());
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalCriticalPathAnalysis::ClearNodeDelay(Node* node) {
+  XLS_RET_CHECK(entries_.contains(node)) << node->GetName();
+  delay_overrides_.erase(node);
+  XLS_ASSIGN_OR_RETURN(entries_.at(node).node_delay, GetNodeDelay(node));
+  Propagate({node}, node->operands());
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalCriticalPathAnalysis::UpdateNode(Node* node) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_);
+  // Gather `node` and its operands which are not yet part of the analysis.
+  std::vector<Node*> updated = {node};
+  bool renumber = !entries_.contains(node);
+  entries_[node];
+  for (int64_t i = 0; i < updated.size(); ++i) {
+    for (Node* operand : updated[i]->operands()) {
+      if (!entries_.contains(operand)) {
+        entries_[operand];
+        updated.push_back(operand);
+        renumber = true;
+      }
+    }
+  }
+
+  // Downstream delays change for the former and the current operands of the
+  // updated nodes, and for the updated nodes themselves as they may be new.
+  std::vector<Node*> upstream_nodes = updated;
+  for (Node* n : updated) {
+    NodeEntry& entry = entries_.at(n);
+    upstream_nodes.insert(upstream_nodes.end(), entry.operands.begin(),
+                          entry.operands.end());
+    XLS_ASSIGN_OR_RETURN(entry.node_delay, GetNodeDelay(n));
+    entry.operands =
+        std::vector<Node*>(n->operands().begin(), n->operands().end());
+    upstream_nodes.insert(upstream_nodes.end(), entry.operands.begin(),
+                          entry.operands.end());
+  }
+
+  // The topological positions are only recomputed if nodes were added or the
+  // new operands of `node` break the existing order.
+  for (Node* operand : node->operands()) {
+    renumber = renumber || entries_.at(operand).topo_index >=
+                               entries_.at(node).topo_index;
+  }
+  if (renumber) {
+    RenumberNodes();
+  }
+  Propagate(updated, upstream_nodes);
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalCriticalPathAnalysis::RemoveNode(Node* node) {
+  XLS_RET_CHECK(entries_.contains(node)) << node->GetName();
+  XLS_RET_CHECK(node->users().empty()) << node->GetName();
+  std::vector<Node*> operands = std::move(entries_.at(node).operands);
+  by_path_delay_.erase(node);
+  entries_.erase(node);
+  delay_overrides_.erase(node);
+  Propagate({}, operands);
+  return absl::OkStatus();
+}
+
+int64_t IncrementalCriticalPathAnalysis::CriticalPathDelayPs() const {
+  return by_path_delay_.empty()
+             ? 0
+             : entries_.at(*by_path_delay_.begin()).path_delay;
+}
+
+std::vector<std::vector<CriticalPathEntry>>
+IncrementalCriticalPathAnalysis::CriticalPaths(int64_t count) const {
+  // The paths are enumerated best-first, walking backwards from the nodes
+  // without users. Each partial path is a suffix of complete paths; its
+  // priority is the delay of the longest completion, which is obtained by
+  // extending the path delay of its first node through the suffix. As path
+  // delays are monotonic in the delay of the operands, completed paths come out
+  // in order of decreasing delay.
+  struct PartialPath {
+    Node* node;
+    // The index of the partial path this one extends, or -1.
+    int64_t parent;
+  };
+  std::vector<PartialPath> partial_paths;
+  // Pairs of priority and negated index, so ties go to earlier partial paths.
+  std::priority_queue<std::pair<int64_t, int64_t>> queue;
+  auto push = [&](Node* node, int64_t parent) {
+    int64_t delay = entries_.at(node).path_delay;
+    for (int64_t i = parent; i != -1; i = partial_paths[i].parent) {
+      int64_t node_delay = entries_.at(partial_paths[i].node).node_delay;
+      delay = StartTime(delay, node_delay).first + node_delay;
+    }
+    partial_paths.push_back(PartialPath{.node = node, .parent = parent});
+    queue.push({delay, -static_cast<int64_t>(partial_paths.size() - 1)});
+  };
+  for (Node* node : f_->nodes()) {
+    if (entries_.contains(node) &&
+        std::none_of(node->users().begin(), node->users().end(),
+                     [&](Node* user) { return entries_.contains(user); })) {
+      push(node, -1);
+    }
+  }
+
+  std::vector<std::vector<CriticalPathEntry>> paths;
+  while (!queue.empty() && paths.size() < count) {
+    int64_t index = -queue.top().second;
+    queue.pop();
+    Node* node = partial_paths[index].node;
+    if (!node->operands().empty()) {
+      absl::flat_hash_set<Node*> visited;
+      for (Node* operand : node->operands()) {
+        if (visited.insert(operand).second) {
+          push(operand, index);
+        }
+      }
+      continue;
+    }
+
+    // A complete path; compute the delays along it from its first node.
+    std::vector<CriticalPathEntry> path;
+    int64_t path_delay = 0;
+    for (int64_t i = index; i != -1; i = partial_paths[i].parent) {
+      Node* path_node = partial_paths[i].node;
+      int64_t node_delay = entries_.at(path_node).node_delay;
+      auto [start, delayed_by_cycle_boundary] =
+          StartTime(path_delay, node_delay);
+      path_delay = start + node_delay;
+      path.push_back(CriticalPathEntry{
+          .node = path_node,
+          .node_delay_ps = node_delay,
+          .path_delay_ps = path_delay,
+          .delayed_by_cycle_boundary = delayed_by_cycle_boundary});
+    }
+    std::reverse(path.begin(), path.end());
+    paths.push_back(std::move(path));
+  }
+  return paths;
+}
+
+}  // namespace xls
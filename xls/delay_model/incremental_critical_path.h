@@ -0,0 +1,180 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DELAY_MODEL_INCREMENTAL_CRITICAL_PATH_H_
+#define XLS_DELAY_MODEL_INCREMENTAL_CRITICAL_PATH_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/delay_model/analyze_critical_path.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// A critical-path analysis which is kept up to date as node delays and the IR
+// change, for interactive what-if exploration. Path delays are computed as in
+// AnalyzeCriticalPath (including the effect of cycle boundaries if a clock
+// period is given) but are stored for every node. When a delay or a node
+// changes only the nodes whose values are affected are recomputed: the users
+// of the node transitively for path delays, and the operands of the node
+// transitively for downstream delays.
+//
+// Example:
+//
+//   XLS_ASSIGN_OR_RETURN(auto analysis,
+//                        IncrementalCriticalPathAnalysis::Create(
+//                            f, /*clock_period_ps=*/std::nullopt, estimator));
+//   XLS_RETURN_IF_ERROR(analysis->SetNodeDelay(add, 0));
+//   for (const auto& path : analysis->CriticalPaths(/*count=*/3)) {
+//     std::cout << CriticalPathToString(path);
+//   }
+class IncrementalCriticalPathAnalysis {
+ public:
+  // Analyzes `f`. The function base and the delay estimator must outlive the
+  // analysis.
+  static absl::StatusOr<std::unique_ptr<IncrementalCriticalPathAnalysis>>
+  Create(FunctionBase* f, std::optional<int64_t> clock_period_ps,
+         const DelayEstimator& delay_estimator);
+
+  // Overrides the delay of `node` with `delay_ps`. The override persists until
+  // ClearNodeDelay is called.
+  absl::Status SetNodeDelay(Node* node, int64_t delay_ps);
+
+  // Removes any override of the delay of `node`, restoring the delay given by
+  // the delay estimator.
+  absl::Status ClearNodeDelay(Node* node);
+
+  // Updates the analysis after `node` was added to the function base or its
+  // operands (or anything else affecting its delay) changed. Operands of
+  // `node` which are not yet known to the analysis are added as well. After
+  // replacing uses of one node with another this must be called on each user
+  // whose operands changed.
+  absl::Status UpdateNode(Node* node);
+
+  // Removes `node` from the analysis. Must be called before `node` is removed
+  // from the function base, at which point it has no users.
+  absl::Status RemoveNode(Node* node);
+
+  // Returns the delay of `node` itself.
+  int64_t NodeDelayPs(Node* node) const { return entries_.at(node).node_delay; }
+
+  // Returns the delay of the critical path up to and including `node`.
+  int64_t PathDelayPs(Node* node) const {
+    return entries_.at(node).path_delay;
+  }
+
+  // Returns the largest sum of node delays along a path from a user of `node`
+  // to a node without users. This does not include the delay of `node`.
+  int64_t DownstreamDelayPs(Node* node) const {
+    return entries_.at(node).downstream_delay;
+  }
+
+  // Returns how much the delay of `node` can grow before it is on the critical
+  // path. Cycle boundaries are not taken into account downstream of `node`, so
+  // if a clock period is given this is an upper bound on the slack.
+  int64_t SlackPs(Node* node) const {
+    return CriticalPathDelayPs() - PathDelayPs(node) - DownstreamDelayPs(node);
+  }
+
+  // Returns the delay of the critical path through the function base.
+  int64_t CriticalPathDelayPs() const;
+
+  // Returns the (at most) `count` longest paths ending at nodes without users,
+  // in order of decreasing delay (ties are broken arbitrarily). Each path is
+  // in the format returned by AnalyzeCriticalPath, starting with its last
+  // node. The path delays of the entries are those along the path itself,
+  // which for all but the first path may be less than PathDelayPs of the
+  // node.
+  std::vector<std::vector<CriticalPathEntry>> CriticalPaths(
+      int64_t count) const;
+
+ private:
+  struct NodeEntry {
+    // Delay of the node.
+    int64_t node_delay = 0;
+
+    // The delay of the critical path in the graph up to and including this
+    // node.
+    int64_t path_delay = 0;
+
+    // The predecessor on the critical path through this node.
+    std::optional<Node*> critical_path_predecessor;
+
+    // Whether this node was delayed by a cycle boundary.
+    bool delayed_by_cycle_boundary = false;
+
+    // See DownstreamDelayPs.
+    int64_t downstream_delay = 0;
+
+    // The operands of the node when it was last updated. These are needed to
+    // update the downstream delays of former operands.
+    std::vector<Node*> operands;
+
+    // The position of the node in a topological sort of the function base.
+    int64_t topo_index = 0;
+  };
+
+  IncrementalCriticalPathAnalysis(FunctionBase* f,
+                                  std::optional<int64_t> clock_period_ps,
+                                  const DelayEstimator& delay_estimator);
+
+  // Returns the delay of the given node using the override, if any.
+  absl::StatusOr<int64_t> GetNodeDelay(Node* node) const;
+
+  // Recomputes the topological positions of all nodes.
+  void RenumberNodes();
+
+  // Returns the starting time of a node with the given delay whose operands
+  // are available at `operand_delay`, and whether it was delayed by a cycle
+  // boundary.
+  std::pair<int64_t, bool> StartTime(int64_t operand_delay,
+                                     int64_t node_delay) const;
+
+  // Recomputes the path delays of `nodes` and their users transitively, and
+  // the downstream delays of `upstream_nodes` and their operands
+  // transitively. Propagation stops at nodes whose values do not change.
+  void Propagate(absl::Span<Node* const> nodes,
+                 absl::Span<Node* const> upstream_nodes);
+
+  // Recomputes the path delay of `node`. Returns whether it changed.
+  bool UpdatePathDelay(Node* node);
+
+  // Recomputes the downstream delay of `node`. Returns whether it changed.
+  bool UpdateDownstreamDelay(Node* node);
+
+  FunctionBase* f_;
+  std::optional<int64_t> clock_period_ps_;
+  const DelayEstimator& delay_estimator_;
+  absl::flat_hash_map<Node*, NodeEntry> entries_;
+  absl::flat_hash_map<Node*, int64_t> delay_overrides_;
+
+  // All nodes ordered by decreasing path delay, tie broken by node id.
+  std::set<Node*, std::function<bool(Node*, Node*)>> by_path_delay_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DELAY_MODEL_INCREMENTAL_CRITICAL_PATH_H_
@@ -0,0 +1,220 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/delay_model/incremental_critical_path.h"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/delay_model/analyze_critical_path.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+class IncrementalCriticalPathTest : public IrTestBase {
+ protected:
+  const DelayEstimator* delay_estimator_ = GetDelayEstimator("unit").value();
+};
+
+// Expects the path delays and the downstream delays of all nodes in `a` and
+// `b` to match.
+void ExpectSameDelays(FunctionBase* f,
+                      const IncrementalCriticalPathAnalysis& a,
+                      const IncrementalCriticalPathAnalysis& b) {
+  EXPECT_EQ(a.CriticalPathDelayPs(), b.CriticalPathDelayPs());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(a.PathDelayPs(node), b.PathDelayPs(node)) << node->GetName();
+    EXPECT_EQ(a.DownstreamDelayPs(node), b.DownstreamDelayPs(node))
+        << node->GetName();
+  }
+}
+
+TEST_F(IncrementalCriticalPathTest, MatchesAnalyzeCriticalPath) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  BValue value = x;
+  for (int64_t i = 0; i < 10; ++i) {
+    value = fb.Add(fb.Negate(value), i % 3 == 0 ? y : value);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  for (std::optional<int64_t> clock_period_ps :
+       {std::optional<int64_t>(), std::optional<int64_t>(3)}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<CriticalPathEntry> expected,
+        AnalyzeCriticalPath(f, clock_period_ps, *delay_estimator_));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+        IncrementalCriticalPathAnalysis::Create(f, clock_period_ps,
+                                                *delay_estimator_));
+    EXPECT_EQ(analysis->CriticalPathDelayPs(), expected.front().path_delay_ps);
+    std::vector<std::vector<CriticalPathEntry>> paths =
+        analysis->CriticalPaths(1);
+    ASSERT_EQ(paths.size(), 1);
+    ASSERT_EQ(paths[0].size(), expected.size());
+    for (int64_t i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(paths[0][i].path_delay_ps, expected[i].path_delay_ps);
+      EXPECT_EQ(paths[0][i].delayed_by_cycle_boundary,
+                expected[i].delayed_by_cycle_boundary);
+    }
+  }
+}
+
+TEST_F(IncrementalCriticalPathTest, WhatIfNodeDelays) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto rev_neg_x = fb.Reverse(neg_x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(rev_neg_x, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+      IncrementalCriticalPathAnalysis::Create(
+          f, /*clock_period_ps=*/std::nullopt, *delay_estimator_));
+  EXPECT_EQ(analysis->CriticalPathDelayPs(), 3);
+  EXPECT_EQ(analysis->SlackPs(neg_x.node()), 0);
+  EXPECT_EQ(analysis->SlackPs(neg_y.node()), 1);
+
+  // Both paths are returned, longest first, and no more.
+  std::vector<std::vector<CriticalPathEntry>> paths =
+      analysis->CriticalPaths(10);
+  ASSERT_EQ(paths.size(), 2);
+  EXPECT_EQ(paths[0].front().node, sum.node());
+  EXPECT_EQ(paths[0].front().path_delay_ps, 3);
+  EXPECT_EQ(paths[0].back().node, x.node());
+  EXPECT_EQ(paths[1].front().path_delay_ps, 2);
+  ASSERT_EQ(paths[1].size(), 3);
+  EXPECT_EQ(paths[1][1].node, neg_y.node());
+  EXPECT_EQ(paths[1].back().node, y.node());
+
+  XLS_ASSERT_OK(analysis->SetNodeDelay(neg_y.node(), 5));
+  EXPECT_EQ(analysis->CriticalPathDelayPs(), 6);
+  EXPECT_EQ(analysis->PathDelayPs(sum.node()), 6);
+  EXPECT_EQ(analysis->SlackPs(neg_x.node()), 3);
+  EXPECT_EQ(analysis->SlackPs(neg_y.node()), 0);
+  paths = analysis->CriticalPaths(1);
+  ASSERT_EQ(paths.size(), 1);
+  EXPECT_EQ(paths[0].back().node, y.node());
+
+  XLS_ASSERT_OK(analysis->ClearNodeDelay(neg_y.node()));
+  EXPECT_EQ(analysis->CriticalPathDelayPs(), 3);
+  EXPECT_EQ(analysis->SlackPs(neg_y.node()), 1);
+}
+
+TEST_F(IncrementalCriticalPathTest, IncrementalMatchesFromScratch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  std::vector<BValue> values = {x, y};
+  for (int64_t i = 0; i < 20; ++i) {
+    BValue a = values[(i * 7) % values.size()];
+    BValue b = values[(i * 3 + 1) % values.size()];
+    values.push_back(i % 2 == 0 ? fb.Add(a, b) : fb.Negate(a));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  for (std::optional<int64_t> clock_period_ps :
+       {std::optional<int64_t>(), std::optional<int64_t>(4)}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+        IncrementalCriticalPathAnalysis::Create(f, clock_period_ps,
+                                                *delay_estimator_));
+    std::vector<std::pair<Node*, int64_t>> overrides;
+    for (int64_t i = 0; i < 10; ++i) {
+      Node* node = values[2 + (i * 5) % 20].node();
+      int64_t delay = (i * 3) % 7;
+      XLS_ASSERT_OK(analysis->SetNodeDelay(node, delay));
+      overrides.push_back({node, delay});
+
+      XLS_ASSERT_OK_AND_ASSIGN(
+          std::unique_ptr<IncrementalCriticalPathAnalysis> from_scratch,
+          IncrementalCriticalPathAnalysis::Create(f, clock_period_ps,
+                                                  *delay_estimator_));
+      for (const auto& [n, d] : overrides) {
+        XLS_ASSERT_OK(from_scratch->SetNodeDelay(n, d));
+      }
+      ExpectSameDelays(f, *analysis, *from_scratch);
+    }
+  }
+}
+
+TEST_F(IncrementalCriticalPathTest, UpdateAndRemoveNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto neg_x = fb.Negate(x);
+  auto rev_neg_x = fb.Reverse(neg_x);
+  auto neg_y = fb.Negate(y);
+  auto sum = fb.Add(rev_neg_x, neg_y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+      IncrementalCriticalPathAnalysis::Create(
+          f, /*clock_period_ps=*/std::nullopt, *delay_estimator_));
+
+  // Lengthen the path through `y` with two new nodes.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg1, f->MakeNode<UnOp>(SourceInfo(), neg_y.node(), Op::kNeg));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg2,
+                           f->MakeNode<UnOp>(SourceInfo(), neg1, Op::kNeg));
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(1, neg2));
+  XLS_ASSERT_OK(analysis->UpdateNode(sum.node()));
+  EXPECT_EQ(analysis->PathDelayPs(neg2), 3);
+  EXPECT_EQ(analysis->CriticalPathDelayPs(), 4);
+  EXPECT_EQ(analysis->DownstreamDelayPs(neg_y.node()), 3);
+  EXPECT_EQ(analysis->SlackPs(neg_x.node()), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<IncrementalCriticalPathAnalysis> from_scratch,
+      IncrementalCriticalPathAnalysis::Create(
+          f, /*clock_period_ps=*/std::nullopt, *delay_estimator_));
+  ExpectSameDelays(f, *analysis, *from_scratch);
+
+  // And remove them again.
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(1, neg_y.node()));
+  XLS_ASSERT_OK(analysis->UpdateNode(sum.node()));
+  XLS_ASSERT_OK(analysis->RemoveNode(neg2));
+  XLS_ASSERT_OK(f->RemoveNode(neg2));
+  XLS_ASSERT_OK(analysis->RemoveNode(neg1));
+  XLS_ASSERT_OK(f->RemoveNode(neg1));
+  EXPECT_EQ(analysis->CriticalPathDelayPs(), 3);
+  EXPECT_EQ(analysis->DownstreamDelayPs(neg_y.node()), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      from_scratch,
+      IncrementalCriticalPathAnalysis::Create(
+          f, /*clock_period_ps=*/std::nullopt, *delay_estimator_));
+  ExpectSameDelays(f, *analysis, *from_scratch);
+}
+
+}  // namespace
+}  // namespace xls
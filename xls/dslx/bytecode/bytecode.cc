@@ -18,9 +18,11 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -690,9 +692,134 @@ absl::Status BytecodeFunction::Init() {
       num_slots_ = std::max(num_slots_, slot.value() + 1);
     }
   }
+
+  fused_binop_indices_.assign(bytecodes_.size(), -1);
+  fused_binops_.clear();
+  int64_t pc = 0;
+  while (pc < bytecodes_.size()) {
+    std::optional<FusedBinop> fused = MatchFusedBinop(pc);
+    if (!fused.has_value()) {
+      ++pc;
+      continue;
+    }
+    fused_binop_indices_[pc] = fused_binops_.size();
+    pc += fused->length;
+    fused_binops_.push_back(*fused);
+  }
   return absl::OkStatus();
 }
 
+namespace {
+
+// Returns whether `op` is a binary operation which takes two operands from the
+// stack and pushes its result, with no other effects.
+bool IsFusableBinop(Bytecode::Op op) {
+  switch (op) {
+    case Bytecode::Op::kAdd:
+    case Bytecode::Op::kAnd:
+    case Bytecode::Op::kConcat:
+    case Bytecode::Op::kDiv:
+    case Bytecode::Op::kEq:
+    case Bytecode::Op::kGe:
+    case Bytecode::Op::kGt:
+    case Bytecode::Op::kLe:
+    case Bytecode::Op::kLt:
+    case Bytecode::Op::kMul:
+    case Bytecode::Op::kNe:
+    case Bytecode::Op::kOr:
+    case Bytecode::Op::kShl:
+    case Bytecode::Op::kShr:
+    case Bytecode::Op::kSub:
+    case Bytecode::Op::kXor:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the operand pushed by `bytecode` if it is a kLoad or kLiteral.
+std::optional<FusedBinop::Operand> AsFusedOperand(const Bytecode& bytecode) {
+  if (bytecode.op() == Bytecode::Op::kLoad) {
+    absl::StatusOr<Bytecode::SlotIndex> slot = bytecode.slot_index();
+    if (!slot.ok()) {
+      return std::nullopt;
+    }
+    return FusedBinop::Operand{.kind = FusedBinop::OperandKind::kSlot,
+                               .slot = *slot,
+                               .literal = nullptr};
+  }
+  if (bytecode.op() == Bytecode::Op::kLiteral && bytecode.has_data() &&
+      std::holds_alternative<InterpValue>(bytecode.data().value())) {
+    return FusedBinop::Operand{
+        .kind = FusedBinop::OperandKind::kLiteral,
+        .slot = Bytecode::SlotIndex(0),
+        .literal = &std::get<InterpValue>(bytecode.data().value())};
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+std::optional<FusedBinop> BytecodeFunction::MatchFusedBinop(
+    int64_t pc) const {
+  const int64_t start_pc = pc;
+  const int64_t end_pc = bytecodes_.size();
+  if (bytecodes_[pc].op() == Bytecode::Op::kJumpDest) {
+    ++pc;
+  }
+  const int64_t first_pc = pc;
+
+  // Up to two pushes of the operands, the binop, then optionally a consumer of
+  // the result.
+  const FusedBinop::Operand stack_operand{
+      .kind = FusedBinop::OperandKind::kStack,
+      .slot = Bytecode::SlotIndex(0),
+      .literal = nullptr};
+  std::vector<FusedBinop::Operand> operands;
+  while (operands.size() < 2 && pc < end_pc) {
+    std::optional<FusedBinop::Operand> operand = AsFusedOperand(bytecodes_[pc]);
+    if (!operand.has_value()) {
+      break;
+    }
+    operands.push_back(*operand);
+    ++pc;
+  }
+  if (pc >= end_pc || !IsFusableBinop(bytecodes_[pc].op())) {
+    return std::nullopt;
+  }
+  FusedBinop fused{.length = 0,
+                   .op = bytecodes_[pc].op(),
+                   .lhs = operands.size() == 2 ? operands[0] : stack_operand,
+                   .rhs = operands.empty() ? stack_operand : operands.back(),
+                   .result_kind = FusedBinop::ResultKind::kPush,
+                   .store_slot = Bytecode::SlotIndex(0),
+                   .jump_target = Bytecode::JumpTarget(0)};
+  ++pc;
+
+  if (pc < end_pc && bytecodes_[pc].op() == Bytecode::Op::kStore) {
+    absl::StatusOr<Bytecode::SlotIndex> slot = bytecodes_[pc].slot_index();
+    if (slot.ok()) {
+      fused.result_kind = FusedBinop::ResultKind::kStore;
+      fused.store_slot = *slot;
+      ++pc;
+    }
+  } else if (pc < end_pc && bytecodes_[pc].op() == Bytecode::Op::kJumpRelIf) {
+    absl::StatusOr<Bytecode::JumpTarget> target = bytecodes_[pc].jump_target();
+    if (target.ok()) {
+      fused.result_kind = FusedBinop::ResultKind::kJumpRelIf;
+      fused.jump_target = *target;
+      ++pc;
+    }
+  }
+
+  // A lone binop gains nothing from fusion.
+  if (pc - first_pc < 2) {
+    return std::nullopt;
+  }
+  fused.length = pc - start_pc;
+  return fused;
+}
+
 std::vector<Bytecode> BytecodeFunction::CloneBytecodes() const {
   // Create a modifiable copy of the bytecodes.
   std::vector<Bytecode> bytecodes;
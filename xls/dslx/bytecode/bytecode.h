@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -390,6 +391,50 @@ class Bytecode {
 
 std::string OpToString(Bytecode::Op op);
 
+// A superinstruction: a binary operation fused with the bytecodes which load
+// its operands and consume its result, e.g., `load; literal; add; store` or
+// `load; literal; eq; jump_rel_if`. The interpreter executes it in one step,
+// reading operands directly from slots or literals and writing the result
+// directly to a slot or branching on it, without moving values through the
+// stack. Fused sequences never contain a kJumpDest (other than possibly as
+// the first bytecode), so no jump lands inside one.
+struct FusedBinop {
+  // Where an operand of the binary operation comes from.
+  enum class OperandKind : uint8_t {
+    // The value on the stack when the superinstruction starts.
+    kStack,
+    // A kLoad from `slot`.
+    kSlot,
+    // A kLiteral holding `literal`.
+    kLiteral,
+  };
+  struct Operand {
+    OperandKind kind;
+    Bytecode::SlotIndex slot;
+    // Points into the owning BytecodeFunction's bytecodes.
+    const InterpValue* literal;
+  };
+
+  // What happens to the result of the binary operation.
+  enum class ResultKind : uint8_t {
+    // Pushed onto the stack.
+    kPush,
+    // Stored to `store_slot`.
+    kStore,
+    // Branched on, jumping `jump_target` relative to the fused kJumpRelIf.
+    kJumpRelIf,
+  };
+
+  // Number of bytecodes covered, including any kJumpDest at the start.
+  int64_t length;
+  Bytecode::Op op;
+  Operand lhs;
+  Operand rhs;
+  ResultKind result_kind;
+  Bytecode::SlotIndex store_slot;
+  Bytecode::JumpTarget jump_target;
+};
+
 // Holds all the bytecode implementing a function along with useful metadata.
 class BytecodeFunction {
  public:
@@ -410,6 +455,13 @@ class BytecodeFunction {
   // Returns the total number of binding "slots" used by the bytecodes.
   int64_t num_slots() const { return num_slots_; }
 
+  // Returns the superinstruction starting at `pc`, or nullptr if the bytecode
+  // at `pc` is executed on its own.
+  const FusedBinop* fused_binop(int64_t pc) const {
+    int64_t index = fused_binop_indices_[pc];
+    return index < 0 ? nullptr : &fused_binops_[index];
+  }
+
   // Creates and returns a [caller-owned] copy of the internal bytecodes.
   std::vector<Bytecode> CloneBytecodes() const;
 
@@ -420,11 +472,20 @@ class BytecodeFunction {
                    const TypeInfo* type_info, std::vector<Bytecode> bytecode);
   absl::Status Init();
 
+  // Returns the superinstruction starting at `pc` if the bytecodes there form
+  // one.
+  std::optional<FusedBinop> MatchFusedBinop(int64_t pc) const;
+
   const Module* owner_;
   const Function* source_fn_;
   const TypeInfo* type_info_;
   std::vector<Bytecode> bytecodes_;
   int64_t num_slots_;
+
+  // Index into `fused_binops_` of the superinstruction starting at each PC, or
+  // -1 if there is none.
+  std::vector<int64_t> fused_binop_indices_;
+  std::vector<FusedBinop> fused_binops_;
 };
 
 // Converts the given sequence of bytecodes to a more human-readable string,
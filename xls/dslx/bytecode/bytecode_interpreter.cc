@@ -58,6 +58,54 @@ absl::StatusOr<std::string> ToStringMaybeFormatted(
   return std::string(indentation, ' ') + value.ToString(/*humanize=*/false);
 }
 
+// Evaluates the binary operation `op` on the given operands. Dispatches on the
+// op directly rather than through a callback since this is on the hot path of
+// both plain and fused binops.
+absl::StatusOr<InterpValue> EvalBinaryOp(Bytecode::Op op,
+                                         const InterpValue& lhs,
+                                         const InterpValue& rhs) {
+  switch (op) {
+    case Bytecode::Op::kAdd:
+      return lhs.Add(rhs);
+    case Bytecode::Op::kAnd:
+      return lhs.BitwiseAnd(rhs);
+    case Bytecode::Op::kConcat:
+      return lhs.Concat(rhs);
+    case Bytecode::Op::kDiv:
+      return lhs.FloorDiv(rhs);
+    case Bytecode::Op::kEq:
+      return InterpValue::MakeBool(lhs.Eq(rhs));
+    case Bytecode::Op::kGe:
+      return lhs.Ge(rhs);
+    case Bytecode::Op::kGt:
+      return lhs.Gt(rhs);
+    case Bytecode::Op::kLe:
+      return lhs.Le(rhs);
+    case Bytecode::Op::kLt:
+      return lhs.Lt(rhs);
+    case Bytecode::Op::kMul:
+      return lhs.Mul(rhs);
+    case Bytecode::Op::kNe:
+      return InterpValue::MakeBool(lhs.Ne(rhs));
+    case Bytecode::Op::kOr:
+      return lhs.BitwiseOr(rhs);
+    case Bytecode::Op::kShl:
+      return lhs.Shl(rhs);
+    case Bytecode::Op::kShr:
+      if (lhs.IsSigned()) {
+        return lhs.Shra(rhs);
+      }
+      return lhs.Shrl(rhs);
+    case Bytecode::Op::kSub:
+      return lhs.Sub(rhs);
+    case Bytecode::Op::kXor:
+      return lhs.BitwiseXor(rhs);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Not a binary operation: ", OpToString(op)));
+  }
+}
+
 }  // namespace
 
 // How much to indent the data value in the trace emitted when sending/receiving
@@ -138,13 +186,15 @@ absl::Status BytecodeInterpreter::Run(bool* progress_made) {
       XLS_VLOG(3) << " - TOS pre: "
                   << (stack_.empty() ? "-empty-" : stack_.back().ToString());
       int64_t old_pc = frame->pc();
+      const FusedBinop* fused = frame->bf()->fused_binop(old_pc);
+      int64_t next_pc = old_pc + (fused == nullptr ? 1 : fused->length);
       XLS_RETURN_IF_ERROR(EvalNextInstruction());
       XLS_VLOG(3) << " - TOS post: "
                   << (stack_.empty() ? "-empty-" : stack_.back().ToString());
 
       if (bytecode.op() == Bytecode::Op::kCall) {
         frame = &frames_.back();
-      } else if (frame->pc() != old_pc + 1) {
+      } else if (frame->pc() != next_pc) {
         XLS_RET_CHECK(bytecodes.at(frame->pc()).op() == Bytecode::Op::kJumpDest)
             << "Jumping from PC " << old_pc << " to PC: " << frame->pc()
             << " bytecode: " << bytecodes.at(frame->pc()).ToString()
@@ -194,6 +244,10 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
   const Bytecode& bytecode = bytecodes.at(frame->pc());
   XLS_VLOG(10) << "Running bytecode: " << bytecode.ToString()
                << " depth before: " << stack_.size();
+  if (const FusedBinop* fused = frame->bf()->fused_binop(frame->pc());
+      fused != nullptr) {
+    return EvalFusedBinop(*fused);
+  }
   switch (bytecode.op()) {
     case Bytecode::Op::kAdd: {
       XLS_RETURN_IF_ERROR(EvalAdd(bytecode));
@@ -404,27 +458,77 @@ absl::Status BytecodeInterpreter::EvalUnop(
   return absl::OkStatus();
 }
 
-absl::Status BytecodeInterpreter::EvalBinop(
-    const std::function<absl::StatusOr<InterpValue>(
-        const InterpValue& lhs, const InterpValue& rhs)>& op) {
+absl::Status BytecodeInterpreter::EvalBinop(Bytecode::Op op) {
   XLS_RET_CHECK_GE(stack_.size(), 2);
-  XLS_ASSIGN_OR_RETURN(InterpValue rhs, Pop());
-  XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
-  XLS_ASSIGN_OR_RETURN(InterpValue result, op(lhs, rhs));
-  stack_.push_back(std::move(result));
+  XLS_ASSIGN_OR_RETURN(
+      InterpValue result,
+      EvalBinaryOp(op, stack_[stack_.size() - 2], stack_.back()));
+  stack_.pop_back();
+  stack_.back() = std::move(result);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<const InterpValue*> BytecodeInterpreter::GetFusedOperand(
+    const FusedBinop::Operand& operand, std::optional<InterpValue>* storage) {
+  switch (operand.kind) {
+    case FusedBinop::OperandKind::kStack: {
+      XLS_ASSIGN_OR_RETURN(*storage, Pop());
+      return &storage->value();
+    }
+    case FusedBinop::OperandKind::kSlot: {
+      std::vector<InterpValue>& slots = frames_.back().slots();
+      if (slots.size() <= operand.slot.value()) {
+        return absl::InternalError(absl::StrFormat(
+            "Attempted to access local data in slot %d, which is out of "
+            "range.",
+            operand.slot.value()));
+      }
+      return &slots[operand.slot.value()];
+    }
+    case FusedBinop::OperandKind::kLiteral:
+      return operand.literal;
+  }
+  return absl::InternalError("Invalid fused operand kind");
+}
+
+absl::Status BytecodeInterpreter::EvalFusedBinop(const FusedBinop& fused) {
+  Frame* frame = &frames_.back();
+  // The rhs is fetched first as it is on top of the stack when both operands
+  // are.
+  std::optional<InterpValue> lhs_storage;
+  std::optional<InterpValue> rhs_storage;
+  XLS_ASSIGN_OR_RETURN(const InterpValue* rhs,
+                       GetFusedOperand(fused.rhs, &rhs_storage));
+  XLS_ASSIGN_OR_RETURN(const InterpValue* lhs,
+                       GetFusedOperand(fused.lhs, &lhs_storage));
+  XLS_ASSIGN_OR_RETURN(InterpValue result, EvalBinaryOp(fused.op, *lhs, *rhs));
+  switch (fused.result_kind) {
+    case FusedBinop::ResultKind::kPush:
+      stack_.push_back(std::move(result));
+      break;
+    case FusedBinop::ResultKind::kStore:
+      frame->StoreSlot(fused.store_slot, std::move(result));
+      break;
+    case FusedBinop::ResultKind::kJumpRelIf:
+      XLS_VLOG(2) << "jump_rel_if value: " << result.ToString();
+      if (result.IsTrue()) {
+        // The jump is relative to the fused kJumpRelIf, the last bytecode.
+        frame->set_pc(frame->pc() + fused.length - 1 +
+                      fused.jump_target.value());
+        return absl::OkStatus();
+      }
+      break;
+  }
+  frame->set_pc(frame->pc() + fused.length);
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalAdd(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Add(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalAnd(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseAnd(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::StatusOr<BytecodeFunction*> BytecodeInterpreter::GetBytecodeFn(
@@ -593,9 +697,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalConcat(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Concat(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalCreateArray(const Bytecode& bytecode) {
@@ -635,9 +737,7 @@ absl::Status BytecodeInterpreter::EvalCreateTuple(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalDiv(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.FloorDiv(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalDup(const Bytecode& bytecode) {
@@ -647,9 +747,7 @@ absl::Status BytecodeInterpreter::EvalDup(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalEq(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Eq(rhs));
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalExpandTuple(const Bytecode& bytecode) {
@@ -683,15 +781,11 @@ absl::Status BytecodeInterpreter::EvalFail(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalGe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Ge(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalGt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Gt(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalIndex(const Bytecode& bytecode) {
@@ -717,9 +811,7 @@ absl::Status BytecodeInterpreter::EvalInvert(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalLe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Le(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalLiteral(const Bytecode& bytecode) {
@@ -782,9 +874,7 @@ absl::Status BytecodeInterpreter::EvalLogicalOr(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalLt(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Lt(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::StatusOr<bool> BytecodeInterpreter::MatchArmEqualsInterpValue(
@@ -851,15 +941,11 @@ absl::Status BytecodeInterpreter::EvalMatchArm(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalMul(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Mul(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalNe(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return InterpValue::MakeBool(lhs.Ne(rhs));
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
@@ -870,9 +956,7 @@ absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalOr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseOr(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalPop(const Bytecode& bytecode) {
@@ -978,18 +1062,11 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalShl(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Shl(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalShr(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    if (lhs.IsSigned()) {
-      return lhs.Shra(rhs);
-    }
-    return lhs.Shrl(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalSlice(const Bytecode& bytecode) {
@@ -1070,9 +1147,7 @@ absl::StatusOr<std::optional<int64_t>> BytecodeInterpreter::EvalJumpRelIf(
 }
 
 absl::Status BytecodeInterpreter::EvalSub(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.Sub(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::EvalSwap(const Bytecode& bytecode) {
@@ -1184,9 +1259,7 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
 }
 
 absl::Status BytecodeInterpreter::EvalXor(const Bytecode& bytecode) {
-  return EvalBinop([](const InterpValue& lhs, const InterpValue& rhs) {
-    return lhs.BitwiseXor(rhs);
-  });
+  return EvalBinop(bytecode.op());
 }
 
 absl::Status BytecodeInterpreter::RunBuiltinFn(const Bytecode& bytecode,
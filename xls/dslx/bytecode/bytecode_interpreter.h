@@ -227,12 +227,20 @@ class BytecodeInterpreter {
   absl::Status EvalWidthSlice(const Bytecode& bytecode);
   absl::Status EvalXor(const Bytecode& bytecode);
 
+  // Executes the superinstruction `fused` starting at the current PC.
+  absl::Status EvalFusedBinop(const FusedBinop& fused);
+  // Returns the value of an operand of a superinstruction. Stack operands are
+  // popped into `storage`.
+  absl::StatusOr<const InterpValue*> GetFusedOperand(
+      const FusedBinop::Operand& operand,
+      std::optional<InterpValue>* storage);
+
   absl::Status EvalUnop(
       const std::function<absl::StatusOr<InterpValue>(const InterpValue& arg)>&
           op);
-  absl::Status EvalBinop(
-      const std::function<absl::StatusOr<InterpValue>(
-          const InterpValue& lhs, const InterpValue& rhs)>& op);
+  // Replaces the top two values on the stack with the result of the binary
+  // operation `op`.
+  absl::Status EvalBinop(Bytecode::Op op);
   absl::StatusOr<BytecodeFunction*> GetBytecodeFn(
       Function* function, const Invocation* invocation,
       const std::optional<ParametricEnv>& caller_bindings);
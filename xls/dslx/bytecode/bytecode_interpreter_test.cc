@@ -122,6 +122,82 @@ TEST(BytecodeInterpreterTest, DupEmptyStack) {
                ::testing::HasSubstr("!stack_.empty()")));
 }
 
+// Counts a slot down to zero in a loop whose header and decrement are each
+// executed as a single superinstruction.
+TEST(BytecodeInterpreterTest, FusedCompareAndBranchLoop) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kFakeSpan, InterpValue::MakeU32(3)));
+  bytecodes.push_back(Bytecode::MakeStore(kFakeSpan, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(kFakeSpan));
+  bytecodes.push_back(Bytecode::MakeLoad(kFakeSpan, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kFakeSpan, InterpValue::MakeU32(0)));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kEq);
+  bytecodes.push_back(
+      Bytecode::MakeJumpRelIf(kFakeSpan, Bytecode::JumpTarget(6)));
+  bytecodes.push_back(Bytecode::MakeLoad(kFakeSpan, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kFakeSpan, InterpValue::MakeU32(1)));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kSub);
+  bytecodes.push_back(Bytecode::MakeStore(kFakeSpan, Bytecode::SlotIndex(0)));
+  bytecodes.push_back(
+      Bytecode::MakeJumpRel(kFakeSpan, Bytecode::JumpTarget(-9)));
+  bytecodes.push_back(Bytecode::MakeJumpDest(kFakeSpan));
+  bytecodes.push_back(Bytecode::MakeLoad(kFakeSpan, Bytecode::SlotIndex(0)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto bfunc,
+      BytecodeFunction::Create(/*owner=*/nullptr, /*source_fn=*/nullptr,
+                               /*type_info=*/nullptr, std::move(bytecodes)));
+
+  EXPECT_EQ(bfunc->fused_binop(0), nullptr);
+  const FusedBinop* header = bfunc->fused_binop(2);
+  ASSERT_NE(header, nullptr);
+  EXPECT_EQ(header->length, 5);
+  EXPECT_EQ(header->result_kind, FusedBinop::ResultKind::kJumpRelIf);
+  const FusedBinop* decrement = bfunc->fused_binop(7);
+  ASSERT_NE(decrement, nullptr);
+  EXPECT_EQ(decrement->length, 4);
+  EXPECT_EQ(decrement->result_kind, FusedBinop::ResultKind::kStore);
+
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue result,
+                           BytecodeInterpreter::Interpret(
+                               /*import_data=*/nullptr, bfunc.get(), {}));
+  EXPECT_EQ(result.ToString(), "u32:0");
+}
+
+TEST(BytecodeInterpreterTest, FusedBinopStackOperands) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kFakeSpan, InterpValue::MakeU32(10)));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kFakeSpan, InterpValue::MakeU32(4)));
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kFakeSpan, InterpValue::MakeU32(1)));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kSub);
+  bytecodes.push_back(
+      Bytecode::MakeLiteral(kFakeSpan, InterpValue::MakeU32(2)));
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kSub);
+  bytecodes.emplace_back(kFakeSpan, Bytecode::Op::kAdd);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto bfunc,
+      BytecodeFunction::Create(/*owner=*/nullptr, /*source_fn=*/nullptr,
+                               /*type_info=*/nullptr, std::move(bytecodes)));
+
+  // (4 - 1) and (3 - 2) are fused; the final add is not.
+  ASSERT_NE(bfunc->fused_binop(1), nullptr);
+  EXPECT_EQ(bfunc->fused_binop(1)->lhs.kind,
+            FusedBinop::OperandKind::kLiteral);
+  ASSERT_NE(bfunc->fused_binop(4), nullptr);
+  EXPECT_EQ(bfunc->fused_binop(4)->lhs.kind, FusedBinop::OperandKind::kStack);
+  EXPECT_EQ(bfunc->fused_binop(6), nullptr);
+
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue result,
+                           BytecodeInterpreter::Interpret(
+                               /*import_data=*/nullptr, bfunc.get(), {}));
+  EXPECT_EQ(result.ToString(), "u32:11");
+}
+
 TEST(BytecodeInterpreterTest, TraceFmtStructValue) {
   constexpr std::string_view kProgram = R"(
 struct Point {
@@ -52,6 +52,7 @@ struct TranspileData {
   Module* module;
   TypeInfo* type_info;
   ImportData* import_data;
+  bool native_layout;
 };
 
 absl::StatusOr<InterpValue> InterpretExpr(
@@ -544,6 +545,218 @@ absl::StatusOr<std::optional<int64_t>> GetFieldWidth(
   return std::nullopt;
 }
 
+// The number of leaf (bits) elements of a type in the native layout of the JIT:
+// a constant plus the leaf counts of struct types, which are only known by
+// name, e.g., "3 + 4 * Foo::kNativeLayoutLeafCount".
+struct NativeLeafCount {
+  int64_t constant = 0;
+  std::vector<std::string> terms;
+
+  std::string ToString() const {
+    std::vector<std::string> pieces = terms;
+    if (constant != 0 || pieces.empty()) {
+      pieces.insert(pieces.begin(), absl::StrCat(constant));
+    }
+    return absl::StrJoin(pieces, " + ");
+  }
+};
+
+// Returns the type alias referred to by `type`, if any.
+const TypeAlias* GetTypeAlias(const TypeAnnotation* type) {
+  if (auto* typeref_type = dynamic_cast<const TypeRefTypeAnnotation*>(type);
+      typeref_type != nullptr &&
+      std::holds_alternative<TypeAlias*>(
+          typeref_type->type_ref()->type_definition())) {
+    return std::get<TypeAlias*>(typeref_type->type_ref()->type_definition());
+  }
+  return nullptr;
+}
+
+absl::StatusOr<uint64_t> GetArrayDim(const TranspileData& xpile_data,
+                                     const ArrayTypeAnnotation* array_type) {
+  XLS_ASSIGN_OR_RETURN(
+      InterpValue dim_value,
+      InterpretExpr(xpile_data.import_data, xpile_data.type_info,
+                    array_type->dim(), /*env=*/{}));
+  return dim_value.GetBitValueUint64();
+}
+
+// Adds the number of leaf elements of `type`, times `multiplier`, to `count`.
+absl::Status AddNativeLeafCount(const TranspileData& xpile_data,
+                                const TypeAnnotation* type,
+                                NativeLeafCount* count,
+                                uint64_t multiplier = 1) {
+  XLS_ASSIGN_OR_RETURN(std::optional<int64_t> width,
+                       GetFieldWidth(xpile_data, type));
+  if (width.has_value()) {
+    count->constant += multiplier;
+    return absl::OkStatus();
+  }
+  if (auto* array_type = dynamic_cast<const ArrayTypeAnnotation*>(type);
+      array_type != nullptr) {
+    XLS_ASSIGN_OR_RETURN(uint64_t dim, GetArrayDim(xpile_data, array_type));
+    return AddNativeLeafCount(xpile_data, array_type->element_type(), count,
+                              multiplier * dim);
+  }
+  if (const TypeAlias* type_alias = GetTypeAlias(type); type_alias != nullptr) {
+    return AddNativeLeafCount(xpile_data, type_alias->type_annotation(), count,
+                              multiplier);
+  }
+  if (auto* typeref_type = dynamic_cast<const TypeRefTypeAnnotation*>(type);
+      typeref_type != nullptr &&
+      std::holds_alternative<StructDef*>(
+          typeref_type->type_ref()->type_definition())) {
+    std::string struct_count = absl::StrCat(
+        CheckedCamelize(type->ToString()), "::kNativeLayoutLeafCount");
+    count->terms.push_back(
+        multiplier == 1 ? struct_count
+                        : absl::StrCat(multiplier, " * ", struct_count));
+    return absl::OkStatus();
+  }
+  return absl::UnimplementedError(
+      absl::StrCat("Unknown/unsupported type for native layout conversion: ",
+                   type->GetNodeTypeName()));
+}
+
+// Returns the C++ type holding a bits leaf of the given width in the native
+// layout of the JIT: the smallest unsigned integer type of a power-of-two
+// number of bytes.
+std::string NativeLeafType(int64_t bit_count) {
+  if (bit_count <= 8) {
+    return "uint8_t";
+  }
+  if (bit_count <= 16) {
+    return "uint16_t";
+  }
+  if (bit_count <= 32) {
+    return "uint32_t";
+  }
+  return "uint64_t";
+}
+
+// Generates code writing `src_element` into the native layout, at the offsets
+// starting at leaf index `leaf` (a variable of the generated code).
+absl::StatusOr<std::string> GenerateTypeToNativeLayout(
+    const TranspileData& xpile_data, std::string_view src_element,
+    const TypeAnnotation* type, int indent_level) {
+  std::string indent(indent_level * 2, ' ');
+  XLS_ASSIGN_OR_RETURN(std::optional<int64_t> width,
+                       GetFieldWidth(xpile_data, type));
+  if (width.has_value()) {
+    return absl::StrFormat(
+        "%sStoreNativeLeaf<%s>(static_cast<uint64_t>(%s), /*bit_count=*/%d, "
+        "buffer + leaf_offsets[leaf++]);",
+        indent, NativeLeafType(width.value()), src_element, width.value());
+  }
+  if (auto* array_type = dynamic_cast<const ArrayTypeAnnotation*>(type);
+      array_type != nullptr) {
+    constexpr std::string_view kTemplate =
+        R"($0for (int $1 = 0; $1 < $2; $1++) {
+$3
+$0})";
+    std::string index = absl::StrCat("idx_", indent_level);
+    XLS_ASSIGN_OR_RETURN(uint64_t dim, GetArrayDim(xpile_data, array_type));
+    XLS_ASSIGN_OR_RETURN(
+        std::string element_code,
+        GenerateTypeToNativeLayout(
+            xpile_data, absl::StrCat(src_element, "[", index, "]"),
+            array_type->element_type(), indent_level + 1));
+    return absl::Substitute(kTemplate, indent, index, dim, element_code);
+  }
+  if (const TypeAlias* type_alias = GetTypeAlias(type); type_alias != nullptr) {
+    return GenerateTypeToNativeLayout(
+        xpile_data, src_element, type_alias->type_annotation(), indent_level);
+  }
+  if (auto* typeref_type = dynamic_cast<const TypeRefTypeAnnotation*>(type);
+      typeref_type != nullptr &&
+      std::holds_alternative<StructDef*>(
+          typeref_type->type_ref()->type_definition())) {
+    return absl::Substitute(
+        R"($0$1.ToNativeLayout(leaf_offsets.subspan(leaf), buffer);
+$0leaf += $2::kNativeLayoutLeafCount;)",
+        indent, src_element, CheckedCamelize(type->ToString()));
+  }
+  return absl::UnimplementedError(
+      absl::StrCat("Unknown/unsupported type for native layout conversion: ",
+                   type->GetNodeTypeName()));
+}
+
+// Returns the expression loading the next bits leaf of the given builtin type
+// from the native layout.
+absl::StatusOr<std::string> GenerateLoadNativeLeaf(BuiltinType builtin_type) {
+  XLS_ASSIGN_OR_RETURN(bool is_signed, GetBuiltinTypeSignedness(builtin_type));
+  XLS_ASSIGN_OR_RETURN(int64_t bit_count, GetBuiltinTypeBitCount(builtin_type));
+  return absl::StrFormat(
+      "LoadNativeLeaf<%s>(buffer + leaf_offsets[leaf++], /*bit_count=*/%d, "
+      "/*is_signed=*/%s)",
+      NativeLeafType(bit_count), bit_count, is_signed ? "true" : "false");
+}
+
+// Generates code reading `dst_element` from the native layout, at the offsets
+// starting at leaf index `leaf` (a variable of the generated code).
+absl::StatusOr<std::string> GenerateTypeFromNativeLayout(
+    const TranspileData& xpile_data, std::string_view dst_element,
+    const TypeAnnotation* type, int indent_level) {
+  std::string indent(indent_level * 2, ' ');
+  XLS_ASSIGN_OR_RETURN(std::optional<BuiltinType> as_builtin_type,
+                       GetAsBuiltinType(xpile_data.module, xpile_data.type_info,
+                                        xpile_data.import_data, type));
+  if (as_builtin_type.has_value()) {
+    XLS_ASSIGN_OR_RETURN(std::string load,
+                         GenerateLoadNativeLeaf(as_builtin_type.value()));
+    return absl::StrFormat("%s%s = %s;", indent, dst_element, load);
+  }
+  if (auto* array_type = dynamic_cast<const ArrayTypeAnnotation*>(type);
+      array_type != nullptr) {
+    constexpr std::string_view kTemplate =
+        R"($0for (int $1 = 0; $1 < $2; $1++) {
+$3
+$0})";
+    std::string index = absl::StrCat("idx_", indent_level);
+    XLS_ASSIGN_OR_RETURN(uint64_t dim, GetArrayDim(xpile_data, array_type));
+    XLS_ASSIGN_OR_RETURN(
+        std::string element_code,
+        GenerateTypeFromNativeLayout(
+            xpile_data, absl::StrCat(dst_element, "[", index, "]"),
+            array_type->element_type(), indent_level + 1));
+    return absl::Substitute(kTemplate, indent, index, dim, element_code);
+  }
+  if (auto* typeref_type = dynamic_cast<const TypeRefTypeAnnotation*>(type);
+      typeref_type != nullptr) {
+    TypeDefinition type_definition =
+        typeref_type->type_ref()->type_definition();
+    if (std::holds_alternative<EnumDef*>(type_definition)) {
+      EnumDef* enum_def = std::get<EnumDef*>(type_definition);
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<BuiltinType> enum_builtin_type,
+          GetAsBuiltinType(xpile_data.module, xpile_data.type_info,
+                           xpile_data.import_data,
+                           enum_def->type_annotation()));
+      XLS_RET_CHECK(enum_builtin_type.has_value());
+      XLS_ASSIGN_OR_RETURN(std::string load,
+                           GenerateLoadNativeLeaf(enum_builtin_type.value()));
+      return absl::StrFormat("%s%s = static_cast<%s>(%s);", indent,
+                             dst_element,
+                             CheckedCamelize(enum_def->identifier()), load);
+    }
+    if (std::holds_alternative<StructDef*>(type_definition)) {
+      return absl::Substitute(
+          R"($0$1 = $2::FromNativeLayout(leaf_offsets.subspan(leaf), buffer);
+$0leaf += $2::kNativeLayoutLeafCount;)",
+          indent, dst_element, CheckedCamelize(type->ToString()));
+    }
+    if (std::holds_alternative<TypeAlias*>(type_definition)) {
+      return GenerateTypeFromNativeLayout(
+          xpile_data, dst_element,
+          std::get<TypeAlias*>(type_definition)->type_annotation(),
+          indent_level);
+    }
+  }
+  return absl::UnimplementedError(
+      absl::StrCat("Unknown/unsupported type for native layout conversion: ",
+                   type->GetNodeTypeName()));
+}
+
 // Should performance become an issue, optimizing struct layouts by reordering
 // (packing?) struct members could be considered.
 absl::StatusOr<std::string> TranspileStructDefHeader(
@@ -554,10 +767,24 @@ absl::StatusOr<std::string> TranspileStructDefHeader(
   ::xls::Value ToValue() const;
 
   friend std::ostream& operator<<(std::ostream& os, const $0& data);
-
+$3
 $1$2
 };)";
 
+  // $0: name.
+  // $1: number of leaf elements.
+  constexpr std::string_view kNativeLayoutTemplate = R"(
+  // Converts directly to and from the native data layout used by the JIT,
+  // without going through ::xls::Value. `leaf_offsets` holds the byte offset
+  // in `buffer` of each of the kNativeLayoutLeafCount leaf elements of the
+  // type, i.e., the offsets of the elements of its ::xls::TypeLayout.
+  static constexpr int64_t kNativeLayoutLeafCount = $1;
+  void ToNativeLayout(absl::Span<const int64_t> leaf_offsets,
+                      uint8_t* buffer) const;
+  static $0 FromNativeLayout(absl::Span<const int64_t> leaf_offsets,
+                             const uint8_t* buffer);
+)";
+
   std::string struct_body;
   std::vector<std::string> member_decls;
   std::vector<std::string> scalar_widths;
@@ -590,9 +817,19 @@ $1$2
   if (!width_block.empty()) {
     width_block = "\n\n" + width_block;
   }
-  return absl::Substitute(kStructTemplate,
-                          CheckedCamelize(struct_def->identifier()),
-                          absl::StrJoin(member_decls, "\n"), width_block);
+  std::string native_layout_block;
+  if (xpile_data.native_layout) {
+    NativeLeafCount leaf_count;
+    for (const auto& [name_def, type] : struct_def->members()) {
+      XLS_RETURN_IF_ERROR(AddNativeLeafCount(xpile_data, type, &leaf_count));
+    }
+    native_layout_block = absl::Substitute(
+        kNativeLayoutTemplate, CheckedCamelize(struct_def->identifier()),
+        leaf_count.ToString());
+  }
+  return absl::Substitute(
+      kStructTemplate, CheckedCamelize(struct_def->identifier()),
+      absl::StrJoin(member_decls, "\n"), width_block, native_layout_block);
 }
 
 absl::StatusOr<std::string> GenerateStructFromValue(
@@ -660,6 +897,47 @@ $0return ::xls::Value::Tuple(members);)";
                           absl::StrJoin(setters, "\n"));
 }
 
+// Generates the definitions of ToNativeLayout() and FromNativeLayout().
+absl::StatusOr<std::string> GenerateStructNativeLayout(
+    const TranspileData& xpile_data, const StructDef* struct_def) {
+  // $0: name.
+  // $1: ToNativeLayout element stores.
+  // $2: FromNativeLayout element loads.
+  constexpr std::string_view kTemplate =
+      R"(void $0::ToNativeLayout(absl::Span<const int64_t> leaf_offsets,
+                        uint8_t* buffer) const {
+  int64_t leaf = 0;
+$1
+}
+
+$0 $0::FromNativeLayout(absl::Span<const int64_t> leaf_offsets,
+                        const uint8_t* buffer) {
+  $0 result;
+  int64_t leaf = 0;
+$2
+  return result;
+})";
+
+  std::vector<std::string> stores;
+  std::vector<std::string> loads;
+  for (const auto& [name_def, type] : struct_def->members()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::string store,
+        GenerateTypeToNativeLayout(xpile_data, name_def->identifier(), type,
+                                   /*indent_level=*/1));
+    stores.push_back(store);
+    XLS_ASSIGN_OR_RETURN(
+        std::string load,
+        GenerateTypeFromNativeLayout(
+            xpile_data, absl::StrCat("result.", name_def->identifier()), type,
+            /*indent_level=*/1));
+    loads.push_back(load);
+  }
+  return absl::Substitute(kTemplate, CheckedCamelize(struct_def->identifier()),
+                          absl::StrJoin(stores, "\n"),
+                          absl::StrJoin(loads, "\n"));
+}
+
 absl::StatusOr<std::string> TranspileStructDefBody(
     const TranspileData& xpile_data, const StructDef* struct_def) {
   // $0: name.
@@ -689,6 +967,11 @@ $3)";
       kStructTemplate, CheckedCamelize(struct_def->identifier()),
       struct_from_value, struct_to_value,
       GenerateOutputOperator(xpile_data, struct_def));
+  if (xpile_data.native_layout) {
+    XLS_ASSIGN_OR_RETURN(std::string native_layout,
+                         GenerateStructNativeLayout(xpile_data, struct_def));
+    absl::StrAppend(&body, "\n\n", native_layout);
+  }
   return body;
 }
 
@@ -720,7 +1003,8 @@ absl::StatusOr<Sources> TranspileSingleToCpp(
 
 absl::StatusOr<Sources> TranspileToCpp(Module* module, ImportData* import_data,
                                        std::string_view output_header_path,
-                                       std::string namespaces) {
+                                       std::string namespaces,
+                                       bool native_layout) {
   constexpr std::string_view kHeaderTemplate =
       R"(// AUTOMATICALLY GENERATED FILE. DO NOT EDIT!
 #ifndef $0
@@ -729,7 +1013,7 @@ absl::StatusOr<Sources> TranspileToCpp(Module* module, ImportData* import_data,
 #include <ostream>
 
 #include "absl/status/statusor.h"
-#include "xls/public/value.h"
+$4#include "xls/public/value.h"
 
 $2$1$3
 
@@ -738,19 +1022,51 @@ $2$1$3
 
   constexpr std::string_view kSourceTemplate =
       R"(// AUTOMATICALLY GENERATED FILE. DO NOT EDIT!
-#include <vector>
+%s#include <vector>
 
 #include "%s"
 #include "absl/base/macros.h"
 #include "absl/status/status.h"
 #include "absl/types/span.h"
 
-%s
+%s%s
+)";
+
+  // Helpers of the native layout conversions. A bits leaf is stored in the
+  // smallest power-of-two number of bytes holding it, zero-extended, in the
+  // byte order of the host.
+  constexpr std::string_view kNativeLayoutHelpers =
+      R"(namespace {
+
+template <typename T>
+void StoreNativeLeaf(uint64_t value, int64_t bit_count, uint8_t* dst) {
+  if (bit_count < 64) {
+    value &= (uint64_t{1} << bit_count) - 1;
+  }
+  T leaf = static_cast<T>(value);
+  std::memcpy(dst, &leaf, sizeof(T));
+}
+
+template <typename T>
+uint64_t LoadNativeLeaf(const uint8_t* src, int64_t bit_count,
+                        bool is_signed) {
+  T leaf;
+  std::memcpy(&leaf, src, sizeof(T));
+  uint64_t value = leaf;
+  if (is_signed && bit_count < 64) {
+    uint64_t sign_bit = uint64_t{1} << (bit_count - 1);
+    value = (value ^ sign_bit) - sign_bit;
+  }
+  return value;
+}
+
+}  // namespace
+
 )";
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->GetRootTypeInfo(module));
   struct TranspileData xpile_data {
-    module, type_info, import_data
+    module, type_info, import_data, native_layout
   };
 
   std::vector<std::string> header;
@@ -782,10 +1098,21 @@ $2$1$3
     namespace_end = absl::StrCat("\n\n}  // namespace ", namespaces);
   }
 
+  std::string header_includes;
+  std::string source_includes;
+  std::string source_helpers;
+  if (native_layout) {
+    header_includes = "#include \"absl/types/span.h\"\n";
+    source_includes = "#include <cstring>\n";
+    source_helpers = kNativeLayoutHelpers;
+  }
+
   return Sources{absl::Substitute(kHeaderTemplate, header_guard,
                                   absl::StrJoin(header, "\n\n"),
-                                  namespace_begin, namespace_end),
-                 absl::StrFormat(kSourceTemplate, output_header_path,
+                                  namespace_begin, namespace_end,
+                                  header_includes),
+                 absl::StrFormat(kSourceTemplate, source_includes,
+                                 output_header_path, source_helpers,
                                  absl::StrJoin(body, "\n\n"))};
 }
 
@@ -50,9 +50,15 @@ struct Sources {
   std::string body;
 };
 
+// If `native_layout` is true, structs also get ToNativeLayout() and
+// FromNativeLayout() methods which write and read the native data layout used
+// by the JIT directly, given the offsets of its leaf elements (from the
+// xls::TypeLayout of the type), so structs can be passed to and from JIT-backed
+// functions without converting to and from xls::Value.
 absl::StatusOr<Sources> TranspileToCpp(Module* module, ImportData* import_data,
                                        std::string_view output_header_path,
-                                       std::string namespaces = "");
+                                       std::string namespaces = "",
+                                       bool native_layout = false);
 
 }  // namespace xls::dslx
 
@@ -37,6 +37,9 @@ ABSL_FLAG(std::string, namespaces, "",
           "Double-colon-delimited namespaces with which to wrap the "
           "generated code, e.g., \"my::namespace\" or "
           "\"::my::explicitly::top::level::namespace\".");
+ABSL_FLAG(bool, native_layout, false,
+          "Whether to also emit, for each struct, methods converting directly "
+          "to and from the native data layout used by the JIT.");
 ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
           "Path to DSLX standard library");
 
@@ -56,7 +59,7 @@ static absl::Status RealMain(const std::filesystem::path& module_path,
                              const std::filesystem::path& dslx_stdlib_path,
                              std::string_view output_header_path,
                              std::string_view output_source_path,
-                             std::string_view namespaces) {
+                             std::string_view namespaces, bool native_layout) {
   XLS_ASSIGN_OR_RETURN(std::string module_text, GetFileContents(module_path));
 
   ImportData import_data(
@@ -67,7 +70,7 @@ static absl::Status RealMain(const std::filesystem::path& module_path,
   XLS_ASSIGN_OR_RETURN(
       Sources sources,
       TranspileToCpp(module.module, &import_data, output_header_path,
-                     std::string(namespaces)));
+                     std::string(namespaces), native_layout));
 
   XLS_RETURN_IF_ERROR(SetFileContents(output_header_path, sources.header));
   XLS_RETURN_IF_ERROR(SetFileContents(output_source_path, sources.body));
@@ -91,7 +94,8 @@ int main(int argc, char* argv[]) {
       << "--output_source_path must be specified.";
   XLS_QCHECK_OK(xls::dslx::RealMain(
       args[0], absl::GetFlag(FLAGS_dslx_stdlib_path), output_header_path,
-      output_source_path, absl::GetFlag(FLAGS_namespaces)));
+      output_source_path, absl::GetFlag(FLAGS_namespaces),
+      absl::GetFlag(FLAGS_native_layout)));
 
   return 0;
 }
@@ -1035,5 +1035,75 @@ std::ostream& operator<<(std::ostream& os, const Bar& data) {
   ASSERT_EQ(result.body, kExpectedSource);
 }
 
+TEST(CppTranspilerTest, NativeLayout) {
+  constexpr std::string_view kModule = R"(
+enum MyEnum : u3 {
+  A = 0,
+  B = 5,
+}
+
+struct Inner {
+    a: s7,
+    e: MyEnum,
+}
+
+struct Outer {
+    x: u32,
+    arr: u12[2],
+    inner: Inner,
+    inners: Inner[3],
+}
+)";
+
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule module,
+      ParseAndTypecheck(kModule, "fake_path", "MyModule", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      TranspileToCpp(module.module, &import_data, "/tmp/fake_path.h",
+                     /*namespaces=*/"", /*native_layout=*/true));
+
+  EXPECT_THAT(result.header, HasSubstr(R"(#include "absl/types/span.h"
+#include "xls/public/value.h")"));
+  EXPECT_THAT(result.header,
+              HasSubstr("static constexpr int64_t kNativeLayoutLeafCount = 2;"));
+  EXPECT_THAT(result.header,
+              HasSubstr("static constexpr int64_t kNativeLayoutLeafCount = 3 + "
+                        "Inner::kNativeLayoutLeafCount + "
+                        "3 * Inner::kNativeLayoutLeafCount;"));
+  EXPECT_THAT(result.header,
+              HasSubstr(R"(  void ToNativeLayout(absl::Span<const int64_t> leaf_offsets,
+                      uint8_t* buffer) const;
+  static Outer FromNativeLayout(absl::Span<const int64_t> leaf_offsets,
+                             const uint8_t* buffer);)"));
+
+  EXPECT_THAT(result.body, HasSubstr(R"(#include <cstring>
+#include <vector>)"));
+  EXPECT_THAT(result.body, HasSubstr("void StoreNativeLeaf("));
+  EXPECT_THAT(result.body, HasSubstr(R"(  int64_t leaf = 0;
+  StoreNativeLeaf<uint32_t>(static_cast<uint64_t>(x), /*bit_count=*/32, buffer + leaf_offsets[leaf++]);
+  for (int idx_1 = 0; idx_1 < 2; idx_1++) {
+    StoreNativeLeaf<uint16_t>(static_cast<uint64_t>(arr[idx_1]), /*bit_count=*/12, buffer + leaf_offsets[leaf++]);
+  }
+  inner.ToNativeLayout(leaf_offsets.subspan(leaf), buffer);
+  leaf += Inner::kNativeLayoutLeafCount;
+  for (int idx_1 = 0; idx_1 < 3; idx_1++) {
+    inners[idx_1].ToNativeLayout(leaf_offsets.subspan(leaf), buffer);
+    leaf += Inner::kNativeLayoutLeafCount;
+  }
+})"));
+  EXPECT_THAT(result.body, HasSubstr(R"(  Inner result;
+  int64_t leaf = 0;
+  result.a = LoadNativeLeaf<uint8_t>(buffer + leaf_offsets[leaf++], /*bit_count=*/7, /*is_signed=*/true);
+  result.e = static_cast<MyEnum>(LoadNativeLeaf<uint8_t>(buffer + leaf_offsets[leaf++], /*bit_count=*/3, /*is_signed=*/false));
+  return result;
+})"));
+  EXPECT_THAT(result.body, HasSubstr(R"(
+    result.inners[idx_1] = Inner::FromNativeLayout(leaf_offsets.subspan(leaf), buffer);
+    leaf += Inner::kNativeLayoutLeafCount;
+)"));
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -43,6 +43,7 @@
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
+#include "xls/common/arena.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
@@ -3302,11 +3303,9 @@ class Module : public AstNode {
  private:
   template <typename T, typename... Args>
   T* MakeInternal(Args&&... args) {
-    std::unique_ptr<T> node =
-        std::make_unique<T>(this, std::forward<Args>(args)...);
-    T* ptr = node.get();
+    T* ptr = node_arena_.New<T>(this, std::forward<Args>(args)...);
     ptr->SetParentage();
-    nodes_.push_back(std::move(node));
+    nodes_.push_back(ptr);
     return ptr;
   }
 
@@ -3343,7 +3342,8 @@ class Module : public AstNode {
   const std::optional<std::filesystem::path> fs_path_;
 
   std::vector<ModuleMember> top_;  // Top-level members of this module.
-  std::vector<std::unique_ptr<AstNode>> nodes_;  // Lifetime-owned AST nodes.
+  // The AST nodes owned by `node_arena_`, in creation order.
+  std::vector<AstNode*> nodes_;
 
   // Map of top-level module member name to the member itself.
   absl::flat_hash_map<std::string, ModuleMember> top_by_name_;
@@ -3352,6 +3352,10 @@ class Module : public AstNode {
   // for any particular purpose at this time aside from cleanliness of not
   // having many definition nodes of the same builtin thing floating around.
   absl::flat_hash_map<std::string, BuiltinNameDef*> builtin_name_defs_;
+
+  // Owns the AST nodes. Declared last so the nodes are destroyed before the
+  // other members.
+  Arena node_arena_;
 };
 
 // Helper for determining whether an AST node is constant (e.g. can be
@@ -16,6 +16,7 @@
 
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -61,6 +62,36 @@ absl::StatusOr<ModuleInfo*> ImportData::Put(
   return pmodule_info;
 }
 
+absl::Status ImportData::Remove(const ImportTokens& subject) {
+  auto it = modules_.find(subject);
+  if (it == modules_.end()) {
+    return absl::NotFoundError("Module information was not found for import " +
+                               subject.ToString());
+  }
+  Module* module = &it->second->module();
+  path_to_module_info_.erase(std::string(it->second->path()));
+  top_level_bindings_.erase(module);
+  top_level_bindings_done_.erase(module);
+  typecheck_wip_.erase(module);
+  type_info_owner_.Remove(module);
+  modules_.erase(it);
+  return absl::OkStatus();
+}
+
+void ImportData::AddParsedImport(const ImportTokens& subject,
+                                 ParsedImport parsed) {
+  parsed_imports_.insert_or_assign(subject, std::move(parsed));
+}
+
+std::optional<ParsedImport> ImportData::TakeParsedImport(
+    const ImportTokens& subject) {
+  auto node = parsed_imports_.extract(subject);
+  if (node.empty()) {
+    return std::nullopt;
+  }
+  return std::move(node.mapped());
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
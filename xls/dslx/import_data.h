@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -58,6 +59,13 @@ class ModuleInfo {
   std::filesystem::path path_;
 };
 
+// A module which was located and parsed ahead of being imported, see
+// PrefetchImports() in import_routines.h.
+struct ParsedImport {
+  std::filesystem::path path;
+  std::unique_ptr<Module> module;
+};
+
 // Immutable "tuple" of tokens that name an absolute import location.
 //
 // e.g. ("std",) or ("xls", "examples", "foo")
@@ -130,6 +138,23 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Drops the module for `subject` along with its type information and any
+  // other state keyed on it, so that it may be Put() again (e.g. after its
+  // text was edited). No other module held here may import `subject`.
+  absl::Status Remove(const ImportTokens& subject);
+
+  // Notes a module parsed ahead of being imported. DoImport() typechecks it
+  // instead of locating and parsing the file again.
+  void AddParsedImport(const ImportTokens& subject, ParsedImport parsed);
+
+  // Returns whether a parsed module is waiting to be imported for `subject`.
+  bool HasParsedImport(const ImportTokens& subject) const {
+    return parsed_imports_.contains(subject);
+  }
+
+  // Removes and returns the parsed module for `subject`, if any.
+  std::optional<ParsedImport> TakeParsedImport(const ImportTokens& subject);
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -214,6 +239,7 @@ class ImportData {
   absl::StatusOr<const Module*> FindModule(const Span& span) const;
 
   absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_;
+  absl::flat_hash_map<ImportTokens, ParsedImport> parsed_imports_;
   absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_;
   absl::flat_hash_map<Module*, std::unique_ptr<InterpBindings>>
       top_level_bindings_;
@@ -14,11 +14,15 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
+#include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
@@ -34,6 +38,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/scanner.h"
 
@@ -134,6 +139,24 @@ static absl::StatusOr<std::filesystem::path> FindExistingPath(
                       GetCurrentDirectory().value(), stdlib_path));
 }
 
+// Locates the file for `subject` and parses it.
+static absl::StatusOr<ParsedImport> LocateAndParse(
+    const ImportTokens& subject, std::string_view stdlib_path,
+    absl::Span<const std::filesystem::path> additional_search_paths,
+    const Span& import_span) {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path found_path,
+                       FindExistingPath(subject, stdlib_path,
+                                        additional_search_paths, import_span));
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(found_path));
+
+  std::string fully_qualified_name = absl::StrJoin(subject.pieces(), ".");
+  Scanner scanner(found_path, contents);
+  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
+  return ParsedImport{.path = std::move(found_path),
+                      .module = std::move(module)};
+}
+
 absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const ImportTokens& subject,
                                      ImportData* import_data,
@@ -146,29 +169,94 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
 
   XLS_VLOG(3) << "DoImport (uncached) subject: " << subject.ToString();
 
-  XLS_ASSIGN_OR_RETURN(
-      std::filesystem::path found_path,
-      FindExistingPath(subject, import_data->stdlib_path(),
-                       import_data->additional_search_paths(), import_span));
+  // Use the module if it was already parsed by PrefetchImports.
+  std::optional<ParsedImport> parsed = import_data->TakeParsedImport(subject);
+  std::filesystem::path found_path;
+  if (parsed.has_value()) {
+    found_path = parsed->path;
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        found_path,
+        FindExistingPath(subject, import_data->stdlib_path(),
+                         import_data->additional_search_paths(), import_span));
+  }
 
   XLS_RETURN_IF_ERROR(import_data->AddToImporterStack(import_span, found_path));
   auto clenaup = absl::MakeCleanup(
       [&] { XLS_CHECK_OK(import_data->PopFromImporterStack(import_span)); });
 
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(found_path));
-
   absl::Span<std::string const> pieces = subject.pieces();
   std::string fully_qualified_name = absl::StrJoin(pieces, ".");
   XLS_VLOG(3) << "Parsing and typechecking " << fully_qualified_name
               << ": start";
 
-  Scanner scanner(found_path, contents);
-  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
+  std::unique_ptr<Module> module;
+  if (parsed.has_value()) {
+    module = std::move(parsed->module);
+  } else {
+    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(found_path));
+    Scanner scanner(found_path, contents);
+    Parser parser(/*module_name=*/fully_qualified_name, &scanner);
+    XLS_ASSIGN_OR_RETURN(module, parser.ParseModule());
+  }
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
   return import_data->Put(
       subject, std::make_unique<ModuleInfo>(std::move(module), type_info,
                                             std::move(found_path)));
 }
 
+void PrefetchImports(const Module& module, ImportData* import_data,
+                     int64_t thread_count) {
+  if (thread_count == 0) {
+    thread_count = std::numeric_limits<int64_t>::max();
+  }
+
+  // The imports of the next level of the import DAG which are neither imported
+  // nor parsed yet.
+  std::vector<std::pair<ImportTokens, Span>> frontier;
+  absl::flat_hash_set<ImportTokens> seen;
+  auto add_imports = [&](const Module& importer) {
+    for (const ModuleMember& member : importer.top()) {
+      if (!std::holds_alternative<Import*>(member)) {
+        continue;
+      }
+      Import* import = std::get<Import*>(member);
+      ImportTokens subject(import->subject());
+      if (import_data->Contains(subject) ||
+          import_data->HasParsedImport(subject) ||
+          !seen.insert(subject).second) {
+        continue;
+      }
+      frontier.push_back({std::move(subject), import->span()});
+    }
+  };
+  add_imports(module);
+
+  while (!frontier.empty()) {
+    std::vector<std::pair<ImportTokens, Span>> level = std::move(frontier);
+    frontier.clear();
+
+    // The files of a level are independent so they are located and parsed
+    // concurrently.
+    std::vector<absl::StatusOr<ParsedImport>> parsed(level.size());
+    BoundedParallelFor(0, level.size(), thread_count, [&](int64_t i) {
+      parsed[i] = LocateAndParse(level[i].first, import_data->stdlib_path(),
+                                 import_data->additional_search_paths(),
+                                 level[i].second);
+    });
+
+    for (int64_t i = 0; i < level.size(); ++i) {
+      if (!parsed[i].ok()) {
+        // DoImport reports the error when it reaches this import.
+        XLS_VLOG(3) << "Could not prefetch import " << level[i].first.ToString()
+                    << ": " << parsed[i].status();
+        continue;
+      }
+      add_imports(*parsed[i]->module);
+      import_data->AddParsedImport(level[i].first,
+                                   std::move(parsed[i]).value());
+    }
+  }
+}
+
 }  // namespace xls::dslx
@@ -15,6 +15,7 @@
 #ifndef XLS_DSLX_IMPORT_ROUTINES_H_
 #define XLS_DSLX_IMPORT_ROUTINES_H_
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <string>
@@ -51,6 +52,17 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      ImportData* import_data,
                                      const Span& import_span);
 
+// Locates and parses, ahead of typechecking, the modules transitively imported
+// by `module` which are not yet in `import_data`. The import DAG is walked a
+// level at a time and the files of a level are read and parsed concurrently on
+// the shared thread pool, at most `thread_count` at once (zero means no limit
+// beyond the size of the pool).
+// The parsed modules are noted in `import_data` so DoImport() only has to
+// typecheck them. Imports which cannot be located or parsed are skipped, and
+// DoImport() reports the error when it reaches them as before.
+void PrefetchImports(const Module& module, ImportData* import_data,
+                     int64_t thread_count = 0);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_IMPORT_ROUTINES_H_
@@ -0,0 +1,186 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/dslx/import_routines.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/typecheck.h"
+#include "xls/dslx/warning_collector.h"
+
+namespace xls::dslx {
+namespace {
+
+using ::testing::HasSubstr;
+
+// Imports `b` and `c`, which both import `d`.
+constexpr std::string_view kDiamondTop = R"(import b
+import c
+
+fn main() -> u32 { b::B + c::C }
+)";
+
+ImportTokens Subject(std::string_view name) {
+  return ImportTokens(std::vector<std::string>{std::string(name)});
+}
+
+class ImportRoutinesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(temp_dir_, TempDirectory::Create());
+    WriteModule("d", "pub const D = u32:1;\n");
+    WriteModule("b", "import d\n\npub const B = d::D + u32:1;\n");
+    WriteModule("c", "import d\n\npub const C = d::D + u32:2;\n");
+  }
+
+  void WriteModule(std::string_view name, std::string_view text) {
+    XLS_ASSERT_OK(SetFileContents(
+        temp_dir_->path() / absl::StrCat(name, ".x"), text));
+  }
+
+  ImportData MakeImportData() {
+    return CreateImportData(kDefaultDslxStdlibPath, {temp_dir_->path()});
+  }
+
+  // Parses and typechecks `text` as module `top` using `import_data`. If
+  // `prefetch_threads` is given the imports are first prefetched with that
+  // many threads; otherwise DoImport locates and parses every import itself.
+  absl::StatusOr<TypeInfo*> Typecheck(std::string_view text,
+                                      ImportData* import_data,
+                                      std::optional<int64_t> prefetch_threads) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module,
+                         ParseModule(text, "top.x", "top"));
+    if (prefetch_threads.has_value()) {
+      PrefetchImports(*module, import_data, *prefetch_threads);
+    }
+    WarningCollector warnings;
+    XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
+                         CheckModule(module.get(), import_data, &warnings));
+    modules_.push_back(std::move(module));
+    return type_info;
+  }
+
+  // Returns the value of the constant `constant` of the imported module
+  // `module_name`.
+  static absl::StatusOr<InterpValue> ConstantValue(
+      ImportData& import_data, std::string_view module_name,
+      std::string_view constant) {
+    XLS_ASSIGN_OR_RETURN(ModuleInfo * info,
+                         import_data.Get(Subject(module_name)));
+    XLS_ASSIGN_OR_RETURN(ConstantDef * def,
+                         info->module().GetConstantDef(constant));
+    return info->type_info()->GetConstExpr(def->value());
+  }
+
+  std::optional<TempDirectory> temp_dir_;
+  std::vector<std::unique_ptr<Module>> modules_;
+};
+
+TEST_F(ImportRoutinesTest, PrefetchParsesDiamondOnce) {
+  ImportData import_data = MakeImportData();
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Module> top,
+                           ParseModule(kDiamondTop, "top.x", "top"));
+  PrefetchImports(*top, &import_data, /*thread_count=*/4);
+  for (std::string_view name : {"b", "c", "d"}) {
+    EXPECT_TRUE(import_data.HasParsedImport(Subject(name))) << name;
+    EXPECT_FALSE(import_data.Contains(Subject(name))) << name;
+  }
+
+  // Typechecking consumes every prefetched module.
+  WarningCollector warnings;
+  XLS_ASSERT_OK(CheckModule(top.get(), &import_data, &warnings).status());
+  for (std::string_view name : {"b", "c", "d"}) {
+    EXPECT_FALSE(import_data.HasParsedImport(Subject(name))) << name;
+    EXPECT_TRUE(import_data.Contains(Subject(name))) << name;
+  }
+}
+
+TEST_F(ImportRoutinesTest, PrefetchedDiamondTypechecksLikeSerial) {
+  ImportData serial_data = MakeImportData();
+  XLS_ASSERT_OK(Typecheck(kDiamondTop, &serial_data, std::nullopt).status());
+
+  for (int64_t threads : {1, 2, 8}) {
+    ImportData import_data = MakeImportData();
+    XLS_ASSERT_OK(Typecheck(kDiamondTop, &import_data, threads).status());
+    for (auto [module_name, constant] :
+         {std::pair{"b", "B"}, std::pair{"c", "C"}, std::pair{"d", "D"}}) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          ModuleInfo * serial_info, serial_data.Get(Subject(module_name)));
+      XLS_ASSERT_OK_AND_ASSIGN(ModuleInfo * info,
+                               import_data.Get(Subject(module_name)));
+      EXPECT_EQ(info->path(), serial_info->path());
+      EXPECT_EQ(info->module().ToString(), serial_info->module().ToString());
+      XLS_ASSERT_OK_AND_ASSIGN(
+          InterpValue serial_value,
+          ConstantValue(serial_data, module_name, constant));
+      XLS_ASSERT_OK_AND_ASSIGN(InterpValue value,
+                               ConstantValue(import_data, module_name,
+                                             constant));
+      EXPECT_EQ(value, serial_value) << threads << " " << module_name;
+    }
+  }
+}
+
+TEST_F(ImportRoutinesTest, FailingImportReportsSameErrorAsSerial) {
+  WriteModule("bad", "pub const X = ;\n");
+  struct TestCase {
+    std::string_view top;
+    // The error is about the first failing import.
+    std::string_view expected_error;
+  };
+  // Imports are prefetched concurrently but the error reported must not
+  // depend on which imports failed to prefetch or in which order.
+  for (const TestCase& test_case :
+       {TestCase{"import b\nimport bad\nimport missing\n", "bad.x"},
+        TestCase{"import b\nimport missing\nimport bad\n",
+                 "Could not find DSLX file"},
+        TestCase{"import c\nimport missing\n", "Could not find DSLX file"}}) {
+    ImportData serial_data = MakeImportData();
+    absl::Status serial_status =
+        Typecheck(test_case.top, &serial_data, std::nullopt).status();
+    EXPECT_THAT(serial_status.message(), HasSubstr(test_case.expected_error))
+        << test_case.top;
+    for (int64_t threads : {1, 2, 8}) {
+      for (int64_t repeat = 0; repeat < 4; ++repeat) {
+        ImportData import_data = MakeImportData();
+        EXPECT_EQ(Typecheck(test_case.top, &import_data, threads).status(),
+                  serial_status)
+            << test_case.top << " with " << threads << " threads";
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -82,6 +82,16 @@ std::string TagToString(InterpValueTag tag) {
                          static_cast<int64_t>(tag));
 }
 
+/* static */ InterpValue::SharedValues InterpValue::MakeSharedValues(
+    std::vector<InterpValue> values) {
+  if (values.empty()) {
+    static const auto* empty =
+        new SharedValues(std::make_shared<const std::vector<InterpValue>>());
+    return *empty;
+  }
+  return std::make_shared<const std::vector<InterpValue>>(std::move(values));
+}
+
 /* static */ InterpValue InterpValue::MakeTuple(
     std::vector<InterpValue> members) {
   return InterpValue{InterpValueTag::kTuple, std::move(members)};
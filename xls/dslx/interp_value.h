@@ -310,13 +310,13 @@ class InterpValue {
   InterpValueTag tag() const { return tag_; }
 
   absl::StatusOr<const std::vector<InterpValue>*> GetValues() const {
-    if (!std::holds_alternative<std::vector<InterpValue>>(payload_)) {
+    if (!std::holds_alternative<SharedValues>(payload_)) {
       return absl::InvalidArgumentError("Value does not hold element values");
     }
-    return &std::get<std::vector<InterpValue>>(payload_);
+    return std::get<SharedValues>(payload_).get();
   }
   const std::vector<InterpValue>& GetValuesOrDie() const {
-    return std::get<std::vector<InterpValue>>(payload_);
+    return *std::get<SharedValues>(payload_);
   }
   absl::StatusOr<const FnData*> GetFunction() const {
     if (!std::holds_alternative<FnData>(payload_)) {
@@ -358,7 +358,7 @@ class InterpValue {
   }
 
   bool HasValues() const {
-    return std::holds_alternative<std::vector<InterpValue>>(payload_);
+    return std::holds_alternative<SharedValues>(payload_);
   }
 
   bool IsToken() const { return tag_ == InterpValueTag::kToken; }
@@ -416,12 +416,24 @@ class InterpValue {
   //
   // TODO(leary): 2020-02-10 When all Python bindings are eliminated we can more
   // easily make an interpreter scoped lifetime that InterpValues can live in.
-  using Payload =
-      std::variant<Bits, EnumData, std::vector<InterpValue>, FnData,
-                   std::shared_ptr<TokenData>, std::shared_ptr<Channel>>;
+  //
+  // The elements of tuples and arrays are immutable and held in shared storage
+  // so copying an aggregate (e.g. on the bytecode interpreter's stack) is a
+  // reference count increment rather than a deep copy. Bits of up to 64 bits
+  // are stored inline by Bits itself, so copying them does not allocate either.
+  using SharedValues = std::shared_ptr<const std::vector<InterpValue>>;
+  using Payload = std::variant<Bits, EnumData, SharedValues, FnData,
+                               std::shared_ptr<TokenData>,
+                               std::shared_ptr<Channel>>;
 
   InterpValue(InterpValueTag tag, Payload payload)
       : tag_(tag), payload_(std::move(payload)) {}
+  InterpValue(InterpValueTag tag, std::vector<InterpValue> values)
+      : tag_(tag), payload_(MakeSharedValues(std::move(values))) {}
+
+  // Returns shared storage holding `values`. All empty aggregates share a
+  // single instance so creating unit values does not allocate.
+  static SharedValues MakeSharedValues(std::vector<InterpValue> values);
 
   using CompareF = bool (*)(const Bits& lhs, const Bits& rhs);
 
@@ -153,6 +153,24 @@ TEST(InterpValueTest, ArrayOfU32HumanStr) {
   EXPECT_EQ(array->ToHumanString(), "[2, 3, 4]");
 }
 
+TEST(InterpValueTest, CopiedAggregatesShareElements) {
+  XLS_ASSERT_OK_AND_ASSIGN(InterpValue array,
+                           InterpValue::MakeArray({InterpValue::MakeU32(2),
+                                                   InterpValue::MakeU32(3)}));
+  InterpValue copy = array;
+  EXPECT_EQ(&array.GetValuesOrDie(), &copy.GetValuesOrDie());
+
+  // Updates produce new storage and leave the original untouched.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpValue updated,
+      array.Update(InterpValue::MakeU32(0), InterpValue::MakeU32(7)));
+  EXPECT_EQ(updated.ToHumanString(), "[7, 3]");
+  EXPECT_EQ(copy.ToHumanString(), "[2, 3]");
+
+  EXPECT_EQ(&InterpValue::MakeUnit().GetValuesOrDie(),
+            &InterpValue::MakeTuple({}).GetValuesOrDie());
+}
+
 TEST(InterpValueTest, TestPredicates) {
   auto false_value = InterpValue::MakeBool(false);
   EXPECT_TRUE(false_value.IsFalse());
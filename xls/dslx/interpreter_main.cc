@@ -15,6 +15,8 @@
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
+#include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -32,6 +34,7 @@
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/run_comparator.h"
 #include "xls/dslx/run_routines.h"
+#include "xls/jit/jit_object_cache.h"
 
 // LINT.IfChange
 ABSL_FLAG(std::string, dslx_path, "",
@@ -57,6 +60,22 @@ ABSL_FLAG(bool, trace_channels, false,
 ABSL_FLAG(int64_t, max_ticks, 100000,
           "If non-zero, the maximum number of ticks to execute on any proc. If "
           "exceeded an error is returned.");
+ABSL_FLAG(int64_t, test_parallelism, 1,
+          "Number of threads used to run the tests and quickchecks of the "
+          "module. Each thread has its own import data and comparator; output "
+          "is reported in the same order as a sequential run. Zero means use "
+          "the number of hardware threads.");
+ABSL_FLAG(int64_t, quickcheck_parallelism, 1,
+          "Number of threads used to run the samples of each quickcheck. The "
+          "samples and the reported counterexample do not depend on this "
+          "value. Zero means use the number of hardware threads.");
+ABSL_FLAG(std::string, jit_object_cache_dir, "",
+          "If non-empty, directory of a persistent cache of JIT-compiled "
+          "object code used by --compare=jit. Reusing the cache across "
+          "invocations avoids recompiling identical functions.");
+ABSL_FLAG(int64_t, jit_object_cache_max_bytes, int64_t{1} << 30,
+          "Maximum total size of the JIT object cache in bytes. Least "
+          "recently used entries are evicted beyond this size.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
 
 namespace xls::dslx {
@@ -79,22 +98,42 @@ absl::Status RealMain(std::string_view entry_module_path,
                       CompareFlag compare_flag, bool execute,
                       bool warnings_as_errors, std::optional<int64_t> seed,
                       bool trace_channels, std::optional<int64_t> max_ticks,
-                      bool* printed_error) {
+                      int64_t test_parallelism,
+                      int64_t quickcheck_parallelism, bool* printed_error) {
   XLS_ASSIGN_OR_RETURN(std::string program, GetFileContents(entry_module_path));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(entry_module_path));
 
-  std::unique_ptr<AbstractRunComparator> run_comparator;
+  // Shared by the comparators of all test threads.
+  std::unique_ptr<JitObjectCache> jit_object_cache;
+  if (compare_flag == CompareFlag::kJit &&
+      !absl::GetFlag(FLAGS_jit_object_cache_dir).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        jit_object_cache,
+        JitObjectCache::Create(
+            absl::GetFlag(FLAGS_jit_object_cache_dir),
+            absl::GetFlag(FLAGS_jit_object_cache_max_bytes)));
+  }
+
+  std::function<std::unique_ptr<AbstractRunComparator>()>
+      run_comparator_factory;
   switch (compare_flag) {
     case CompareFlag::kNone:
       break;
     case CompareFlag::kJit:
-      run_comparator = std::make_unique<RunComparator>(CompareMode::kJit);
+      run_comparator_factory = [cache = jit_object_cache.get()] {
+        return std::make_unique<RunComparator>(CompareMode::kJit, cache);
+      };
       break;
     case CompareFlag::kInterpreter:
-      run_comparator =
-          std::make_unique<RunComparator>(CompareMode::kInterpreter);
+      run_comparator_factory = [] {
+        return std::make_unique<RunComparator>(CompareMode::kInterpreter);
+      };
       break;
   }
+  std::unique_ptr<AbstractRunComparator> run_comparator;
+  if (run_comparator_factory != nullptr) {
+    run_comparator = run_comparator_factory();
+  }
 
   ParseAndTestOptions options = {
       .dslx_paths = dslx_paths,
@@ -105,7 +144,10 @@ absl::Status RealMain(std::string_view entry_module_path,
       .seed = seed,
       .warnings_as_errors = warnings_as_errors,
       .trace_channels = trace_channels,
-      .max_ticks = max_ticks};
+      .max_ticks = max_ticks,
+      .parallelism = test_parallelism,
+      .run_comparator_factory = run_comparator_factory,
+      .quickcheck_parallelism = quickcheck_parallelism};
   XLS_ASSIGN_OR_RETURN(
       TestResult test_result,
       ParseAndTest(program, module_name, entry_module_path, options));
@@ -176,7 +218,10 @@ int main(int argc, char* argv[]) {
   absl::Status status =
       xls::dslx::RealMain(args[0], dslx_paths, test_filter, preference.value(),
                           compare_flag, execute, warnings_as_errors, seed,
-                          trace_channels, max_ticks, &printed_error);
+                          trace_channels, max_ticks,
+                          absl::GetFlag(FLAGS_test_parallelism),
+                          absl::GetFlag(FLAGS_quickcheck_parallelism),
+                          &printed_error);
   if (printed_error) {
     return EXIT_FAILURE;
   }
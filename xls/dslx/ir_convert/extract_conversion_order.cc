@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -655,33 +656,58 @@ static absl::StatusOr<std::vector<Proc*>> GetTopLevelProcs(
   return procs;
 }
 
+// The conversion order under construction. Alongside the records it keeps an
+// index of the plain function instantiations (those without a proc id) so
+// that checking whether an instantiation is already in the order does not
+// scan the whole order, which is quadratic in the number of parametric
+// instantiations.
+class ReadyList {
+ public:
+  void Add(ConversionRecord cr) {
+    if (!cr.proc_id().has_value()) {
+      keys_.insert(Key{cr.f(), cr.module(), cr.parametric_env()});
+    }
+    records_.push_back(std::move(cr));
+  }
+
+  void Append(std::vector<ConversionRecord> crs) {
+    for (ConversionRecord& cr : crs) {
+      Add(std::move(cr));
+    }
+  }
+
+  // Returns whether the instantiation of `f` in `m` with `bindings` and no
+  // proc id is in the order.
+  bool Contains(Function* f, Module* m, const ParametricEnv& bindings) const {
+    return keys_.contains(Key{f, m, bindings});
+  }
+
+  std::vector<ConversionRecord>& records() { return records_; }
+
+ private:
+  using Key = std::tuple<Function*, Module*, ParametricEnv>;
+
+  std::vector<ConversionRecord> records_;
+  absl::flat_hash_set<Key> keys_;
+};
+
 // This function removes duplicate conversion records containing a non-derived
 // DSLX functions from a list. A non-derived non-parametric function is not an
 // inferred function (e.g. derived from a proc spawn/invocation or a parametric
-// function). The 'ready' input list is modified and cannot be nullptr.
+// function). The first record of each such function is kept. The 'ready' input
+// list is modified and cannot be nullptr.
 static void RemoveFunctionDuplicates(std::vector<ConversionRecord>* ready) {
-  for (auto iter_func = ready->begin(); iter_func != ready->end();
-       iter_func++) {
-    const ConversionRecord& function_cr = *iter_func;
-    for (auto iter_subject = iter_func + 1; iter_subject != ready->end();) {
-      const ConversionRecord& subject_cr = *iter_subject;
-
-      bool same_fns = function_cr.f() == subject_cr.f();
-      bool either_is_proc_instance_fn =
-          function_cr.f()->tag() == Function::Tag::kProcConfig ||
-          function_cr.f()->tag() == Function::Tag::kProcNext ||
-          subject_cr.f()->tag() == Function::Tag::kProcConfig ||
-          subject_cr.f()->tag() == Function::Tag::kProcNext;
-      bool either_is_parametric =
-          function_cr.f()->IsParametric() || subject_cr.f()->IsParametric();
-
-      if (same_fns && !either_is_proc_instance_fn && !either_is_parametric) {
-        iter_subject = ready->erase(iter_subject);
-        continue;
-      }
-      iter_subject++;
+  absl::flat_hash_set<Function*> seen;
+  auto is_duplicate = [&seen](const ConversionRecord& cr) {
+    bool is_proc_instance_fn = cr.f()->tag() == Function::Tag::kProcConfig ||
+                               cr.f()->tag() == Function::Tag::kProcNext;
+    if (is_proc_instance_fn || cr.f()->IsParametric()) {
+      return false;
     }
-  }
+    return !seen.insert(cr.f()).second;
+  };
+  ready->erase(std::remove_if(ready->begin(), ready->end(), is_duplicate),
+               ready->end());
 }
 
 // Traverses the definition of a node to find callees.
@@ -707,25 +733,14 @@ static absl::StatusOr<std::vector<Callee>> GetCallees(
 }
 
 static bool IsReady(std::variant<Function*, TestFunction*> f, Module* m,
-                    const ParametricEnv& bindings,
-                    const std::vector<ConversionRecord>* ready) {
+                    const ParametricEnv& bindings, const ReadyList* ready) {
   // Test functions are always the root and non-parametric, so they're always
   // ready.
   if (std::holds_alternative<TestFunction*>(f)) {
     return true;
   }
 
-  auto matches_fn = [&](const ConversionRecord& cr, Function* f) {
-    return cr.f() == f && cr.module() == m && cr.parametric_env() == bindings &&
-           !cr.proc_id().has_value();
-  };
-
-  for (const ConversionRecord& cr : *ready) {
-    if (matches_fn(cr, std::get<Function*>(f))) {
-      return true;
-    }
-  }
-  return false;
+  return ready->Contains(std::get<Function*>(f), m, bindings);
 }
 
 // Forward decl.
@@ -733,12 +748,12 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
                                const Invocation* invocation, Module* m,
                                TypeInfo* type_info,
                                const ParametricEnv& bindings,
-                               std::vector<ConversionRecord>* ready,
+                               ReadyList* ready,
                                std::optional<ProcId> proc_id,
                                bool is_top = false);
 
 static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
-                                   std::vector<ConversionRecord>* ready) {
+                                   ReadyList* ready) {
   // Knock out all callees that are already in the (ready) order.
   std::vector<Callee> non_ready;
   {
@@ -765,7 +780,7 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
                                const Invocation* invocation, Module* m,
                                TypeInfo* type_info,
                                const ParametricEnv& bindings,
-                               std::vector<ConversionRecord>* ready,
+                               ReadyList* ready,
                                const std::optional<ProcId> proc_id,
                                bool is_top) {
   XLS_CHECK_EQ(type_info->module(), m);
@@ -798,13 +813,13 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
       ConversionRecord cr,
       ConversionRecord::Make(fn, invocation, m, type_info, bindings,
                              orig_callees, proc_id, is_top));
-  ready->push_back(std::move(cr));
+  ready->Add(std::move(cr));
   return absl::OkStatus();
 }
 
 static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
     std::variant<Proc*, TestProc*> entry, TypeInfo* type_info, bool is_top) {
-  std::vector<ConversionRecord> ready;
+  ReadyList ready;
   Proc* p;
   if (std::holds_alternative<TestProc*>(entry)) {
     p = std::get<TestProc*>(entry)->proc();
@@ -829,7 +844,7 @@ static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
   std::vector<ConversionRecord> final_order;
   std::vector<ConversionRecord> config_fns;
   std::vector<ConversionRecord> next_fns;
-  for (const auto& record : ready) {
+  for (const auto& record : ready.records()) {
     if (record.f()->tag() == Function::Tag::kProcConfig) {
       config_fns.push_back(record);
     } else if (record.f()->tag() == Function::Tag::kProcNext) {
@@ -850,7 +865,7 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
                                                        TypeInfo* type_info,
                                                        bool traverse_tests) {
   XLS_CHECK_EQ(type_info->module(), module);
-  std::vector<ConversionRecord> ready;
+  ReadyList ready;
 
   for (ModuleMember member : module->top()) {
     if (std::holds_alternative<QuickCheck*>(member)) {
@@ -890,7 +905,7 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
 
     XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> proc_ready,
                          GetOrderForProc(proc, proc_ti, /*is_top=*/false));
-    ready.insert(ready.end(), proc_ready.begin(), proc_ready.end());
+    ready.Append(std::move(proc_ready));
   }
 
   // Collect tests.
@@ -904,7 +919,7 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
                            type_info->GetTopLevelProcTypeInfo(test->proc()));
       XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> proc_ready,
                            GetOrderForProc(test, proc_ti, /*is_top=*/false));
-      ready.insert(ready.end(), proc_ready.begin(), proc_ready.end());
+      ready.Append(std::move(proc_ready));
     }
   }
 
@@ -912,36 +927,39 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
   // the functions and the proc are converted in that order. However, procs may
   // call functions resulting in functions being accounted for twice. There must
   // be a single instance of the function to convert.
-  RemoveFunctionDuplicates(&ready);
+  std::vector<ConversionRecord> order = std::move(ready.records());
+  RemoveFunctionDuplicates(&order);
 
-  XLS_VLOG(5) << "Ready list: " << ConversionRecordsToString(ready);
+  XLS_VLOG(5) << "Ready list: " << ConversionRecordsToString(order);
 
-  return ready;
+  return order;
 }
 
 absl::StatusOr<std::vector<ConversionRecord>> GetOrderForEntry(
     std::variant<Function*, Proc*> entry, TypeInfo* type_info) {
-  std::vector<ConversionRecord> ready;
   if (std::holds_alternative<Function*>(entry)) {
     Function* f = std::get<Function*>(entry);
     if (f->proc().has_value()) {
       XLS_ASSIGN_OR_RETURN(
           type_info, type_info->GetTopLevelProcTypeInfo(f->proc().value()));
     }
+    ReadyList ready;
     XLS_RETURN_IF_ERROR(AddToReady(f,
                                    /*invocation=*/nullptr, f->owner(),
                                    type_info, ParametricEnv(), &ready, {},
                                    /*is_top=*/true));
-    RemoveFunctionDuplicates(&ready);
-    return ready;
+    std::vector<ConversionRecord> order = std::move(ready.records());
+    RemoveFunctionDuplicates(&order);
+    return order;
   }
 
   Proc* p = std::get<Proc*>(entry);
   XLS_ASSIGN_OR_RETURN(TypeInfo * new_ti,
                        type_info->GetTopLevelProcTypeInfo(p));
-  XLS_ASSIGN_OR_RETURN(ready, GetOrderForProc(p, new_ti, /*is_top=*/true));
-  RemoveFunctionDuplicates(&ready);
-  return ready;
+  XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> order,
+                       GetOrderForProc(p, new_ti, /*is_top=*/true));
+  RemoveFunctionDuplicates(&order);
+  return order;
 }
 
 }  // namespace xls::dslx
@@ -67,6 +67,34 @@ fn main() -> u32 { f(u2:0) }
   EXPECT_EQ(order[1].parametric_env(), ParametricEnv());
 }
 
+TEST(ExtractConversionOrderTest, RepeatedParametricInstantiations) {
+  constexpr std::string_view kProgram = R"(
+fn f<N: u32>(x: bits[N]) -> u32 { N }
+fn g() -> u32 { f(u2:0) + f(u3:0) }
+fn h() -> u32 { f(u3:0) + f(u2:1) + g() }
+fn main() -> u32 { g() + h() + f(u2:2) }
+)";
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ConversionRecord> order,
+                           GetOrder(tm.module, tm.type_info));
+  // Each instantiation is converted once, before its first caller.
+  ASSERT_EQ(5, order.size());
+  EXPECT_EQ(order[0].f()->identifier(), "f");
+  EXPECT_EQ(order[0].parametric_env(),
+            ParametricEnv(absl::flat_hash_map<std::string, InterpValue>{
+                {"N", InterpValue::MakeUBits(/*bit_count=*/32, /*value=*/2)}}));
+  EXPECT_EQ(order[1].f()->identifier(), "f");
+  EXPECT_EQ(order[1].parametric_env(),
+            ParametricEnv(absl::flat_hash_map<std::string, InterpValue>{
+                {"N", InterpValue::MakeUBits(/*bit_count=*/32, /*value=*/3)}}));
+  EXPECT_EQ(order[2].f()->identifier(), "g");
+  EXPECT_EQ(order[3].f()->identifier(), "h");
+  EXPECT_EQ(order[4].f()->identifier(), "main");
+}
+
 TEST(ExtractConversionOrderTest, TransitiveParametric) {
   constexpr std::string_view kProgram = R"(
 fn g<M: u32>(x: bits[M]) -> u32 { M }
@@ -14,6 +14,7 @@
 
 #include "xls/dslx/ir_convert/function_converter.h"
 
+#include "absl/container/btree_set.h"
 #include "absl/status/status.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/constexpr_evaluator.h"
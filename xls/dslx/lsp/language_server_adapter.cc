@@ -14,8 +14,14 @@
 
 #include "xls/dslx/lsp/language_server_adapter.h"
 
+#include <memory>
+#include <string_view>
+#include <utility>
+
 #include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/bindings.h"
+#include "xls/dslx/import_data.h"
 #include "xls/dslx/lsp/document_symbols.h"
 #include "xls/dslx/lsp/find_definition.h"
 #include "xls/dslx/lsp/lsp_type_utils.h"
@@ -65,12 +71,42 @@ LanguageServerAdapter::LanguageServerAdapter(
 void LanguageServerAdapter::Update(std::string_view file_uri,
                                    std::string_view dslx_code) {
   // TODO(hzeller): remember per file_uri for more sophisticated features.
-  last_import_data_.emplace(CreateImportData(stdlib_, dslx_paths_));
+  constexpr std::string_view kModuleName = "foo";
+  if (last_import_data_.has_value() && file_uri == last_file_uri_ &&
+      dslx_code == last_dslx_code_) {
+    return;  // Nothing changed since the last analysis.
+  }
+
+  // Keep the imports of the last update, dropping only the edited module (if
+  // the last update got as far as registering it).
+  if (file_uri != last_file_uri_) {
+    last_import_data_.reset();
+  } else if (last_import_data_.has_value() && last_parse_result_.ok()) {
+    absl::Status removed = last_import_data_->Remove(
+        ImportTokens::FromString(kModuleName).value());
+    if (!removed.ok()) {
+      LspLog() << "Dropping import cache: " << removed << std::endl;
+      last_import_data_.reset();
+    }
+  }
+  if (!last_import_data_.has_value()) {
+    last_import_data_.emplace(CreateImportData(stdlib_, dslx_paths_));
+  }
+
   const absl::Time start = absl::Now();
+  last_file_uri_ = file_uri;
   last_dslx_code_ = dslx_code;
-  last_parse_result_ =
-      ParseAndTypecheck(last_dslx_code_, /*path=*/"", /*module_name=*/"foo",
-                        &last_import_data_.value());
+  absl::StatusOr<std::unique_ptr<Module>> module =
+      ParseModule(last_dslx_code_, /*path=*/"", kModuleName);
+  if (module.ok()) {
+    last_parse_result_ = TypecheckModule(*std::move(module), /*path=*/"",
+                                         &last_import_data_.value());
+    if (!last_parse_result_.ok()) {
+      last_import_data_.reset();
+    }
+  } else {
+    last_parse_result_ = module.status();
+  }
   const absl::Duration duration = absl::Now() - start;
   if (duration > absl::Milliseconds(200)) {
     LspLog() << "Parsing " << file_uri << " took " << duration << std::endl;
@@ -35,7 +35,10 @@ class LanguageServerAdapter {
   LanguageServerAdapter(std::string_view stdlib,
                         const std::vector<std::filesystem::path>& dslx_paths);
 
-  // Note: this is parsing is triggered for every keystroke. Fine for now.
+  // Note: this is triggered for every keystroke. Content identical to the last
+  // update is not re-analyzed, and imported modules (parsed and typechecked)
+  // are kept across consecutive updates of the same file; only the edited
+  // module itself is re-parsed and re-typechecked.
   void Update(std::string_view file_uri, std::string_view dslx_code);
 
   // Generate LSP diagnostics for the last file update.
@@ -54,7 +57,11 @@ class LanguageServerAdapter {
   const std::string stdlib_;
   const std::vector<std::filesystem::path> dslx_paths_;
 
+  // Holds the imports of the last updated file. Reset when a different file is
+  // updated (it may be one of those imports) or when typechecking fails, as a
+  // failed typecheck can leave partial state behind.
   std::optional<ImportData> last_import_data_;
+  std::string last_file_uri_;
   std::string last_dslx_code_;
   absl::StatusOr<TypecheckedModule> last_parse_result_;
 };
@@ -34,6 +34,29 @@ TEST(LanguageServerAdapterTest, TestSingleFunctionModule) {
   ASSERT_EQ(symbols.size(), 1);
 }
 
+TEST(LanguageServerAdapterTest, TestSuccessiveUpdates) {
+  LanguageServerAdapter adapter(kDefaultDslxStdlibPath, {"."});
+  constexpr std::string_view kUri = "unused-for-now";
+  adapter.Update(kUri, "import std;\nfn f() -> u32 { std::popcount(u32:7) }");
+  EXPECT_TRUE(adapter.GenerateParseDiagnostics(kUri).empty());
+
+  // Same content again, then an edit that keeps the cached `std` import.
+  adapter.Update(kUri, "import std;\nfn f() -> u32 { std::popcount(u32:7) }");
+  EXPECT_TRUE(adapter.GenerateParseDiagnostics(kUri).empty());
+  adapter.Update(kUri, "import std;\nfn g() -> u32 { std::popcount(u32:3) }");
+  EXPECT_TRUE(adapter.GenerateParseDiagnostics(kUri).empty());
+  ASSERT_EQ(adapter.GenerateDocumentSymbols(kUri).size(), 1);
+
+  // A parse error, a type error, and recovery from both.
+  adapter.Update(kUri, "import std;\nfn g() -> u32 {");
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 1);
+  adapter.Update(kUri, "import std;\nfn g() -> u32 { u8:3 }");
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(kUri).size(), 1);
+  adapter.Update(kUri, "import std;\nfn h() -> u32 { std::popcount(u32:1) }");
+  EXPECT_TRUE(adapter.GenerateParseDiagnostics(kUri).empty());
+  ASSERT_EQ(adapter.GenerateDocumentSymbols(kUri).size(), 1);
+}
+
 TEST(LanguageServerAdapterTest, TestFindDefinitions) {
   LanguageServerAdapter adapter(kDefaultDslxStdlibPath, {"."});
   constexpr std::string_view kUri = "unused-for-now";
@@ -26,7 +26,8 @@ absl::StatusOr<FunctionJit*> RunComparator::GetOrCompileJitFunction(
     return it->second.get();
   }
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
-                       FunctionJit::Create(ir_function));
+                       FunctionJit::Create(ir_function, /*opt_level=*/3,
+                                           object_cache_));
   FunctionJit* result = jit.get();
   jit_cache_[ir_name] = std::move(jit);
   return result;
@@ -125,4 +126,12 @@ absl::StatusOr<InterpreterResult<xls::Value>> RunComparator::RunIrFunction(
   return jit->Run(ir_args);
 }
 
+absl::StatusOr<std::vector<xls::Value>> RunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_args) {
+  XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
+                       GetOrCompileJitFunction(ir_name, ir_function));
+  return jit->RunBatched(ir_args);
+}
+
 }  // namespace xls::dslx
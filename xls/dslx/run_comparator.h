@@ -18,6 +18,7 @@
 #include "xls/common/test_macros.h"
 #include "xls/dslx/run_routines.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/jit_object_cache.h"
 
 namespace xls::dslx {
 
@@ -36,7 +37,11 @@ enum class CompareMode {
 // inspect cache state more easily than closing over it, e.g. for testing.
 class RunComparator : public AbstractRunComparator {
  public:
-  explicit RunComparator(CompareMode mode) : mode_(mode) {}
+  // If `object_cache` is non-null, it is passed to the JIT so that functions
+  // compiled by earlier runs need not be compiled again.
+  explicit RunComparator(CompareMode mode,
+                         JitObjectCache* object_cache = nullptr)
+      : mode_(mode), object_cache_(object_cache) {}
 
   absl::Status RunComparison(Package* ir_package, bool requires_implicit_token,
                              const Function* f,
@@ -48,6 +53,11 @@ class RunComparator : public AbstractRunComparator {
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) override;
 
+  // Evaluates the whole batch with a single call into the jitted code.
+  absl::StatusOr<std::vector<xls::Value>> RunIrFunctionBatched(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> ir_args) override;
+
   // Returns the cached or newly-compiled jit function for ir_name.  ir_name has
   // already been mangled (see MangleDslxName) so it should be unique in the
   // program and is used as the cache key.
@@ -64,6 +74,7 @@ class RunComparator : public AbstractRunComparator {
 
   absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jit_cache_;
   CompareMode mode_;
+  JitObjectCache* object_cache_;
 };
 
 }  // namespace xls::dslx
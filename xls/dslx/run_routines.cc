@@ -16,19 +16,24 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <ctime>
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <random>
+#include <sstream>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -36,6 +41,8 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/optional.h"
 #include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
@@ -137,36 +144,134 @@ static bool TestMatchesFilter(std::string_view test_name,
   return test_name == *test_filter;
 }
 
+absl::StatusOr<std::vector<xls::Value>>
+AbstractRunComparator::RunIrFunctionBatched(
+    std::string_view ir_name, xls::Function* ir_function,
+    absl::Span<const std::vector<xls::Value>> ir_args) {
+  std::vector<xls::Value> results;
+  results.reserve(ir_args.size());
+  for (const std::vector<xls::Value>& args : ir_args) {
+    XLS_ASSIGN_OR_RETURN(
+        xls::Value result,
+        DropInterpreterEvents(RunIrFunction(ir_name, ir_function, args)));
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
 absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
     AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests) {
+  return DoQuickCheck(xls_function, ir_name, absl::MakeSpan(&run_comparator, 1),
+                      seed, num_tests);
+}
+
+namespace {
+
+// Number of quickcheck samples in a shard. A shard is the unit of work handed
+// to a thread and is evaluated as a single batch.
+constexpr int64_t kQuickCheckShardSize = 1024;
+
+// The samples of a quickcheck shard up to and including the first falsifying
+// example (if any).
+struct QuickCheckShard {
   QuickCheckResults results;
-  std::minstd_rand rng_engine(seed);
-
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(
-        RandomFunctionArguments(xls_function, &rng_engine));
-    // TODO(https://github.com/google/xls/issues/506): 2021-10-15
-    // Assertion failures should work out, but we should consciously decide
-    // if/how we want to dump traces when running QuickChecks (always, for
-    // failures, flag-controlled, ...).
-    XLS_ASSIGN_OR_RETURN(xls::Value result,
-                         DropInterpreterEvents(run_comparator->RunIrFunction(
-                             ir_name, xls_function, results.arg_sets.back())));
-    results.results.push_back(result);
-    if (result.IsAllZeros()) {
-      // We were able to falsify the xls_function (predicate), bail out early
-      // and present this evidence.
+  bool falsified = false;
+  absl::Status status;
+};
+
+absl::Status RunQuickCheckShard(xls::Function* xls_function,
+                                std::string_view ir_name,
+                                AbstractRunComparator* run_comparator,
+                                int64_t seed, int64_t shard, int64_t count,
+                                QuickCheckShard* result) {
+  // Each shard has its own generator so the samples do not depend on which
+  // thread runs the shard or in which order.
+  std::minstd_rand rng_engine(static_cast<std::minstd_rand::result_type>(
+      Xoshiro256StarStar(seed, shard)()));
+  std::vector<std::vector<Value>>& arg_sets = result->results.arg_sets;
+  arg_sets.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    arg_sets.push_back(RandomFunctionArguments(xls_function, &rng_engine));
+  }
+  // TODO(https://github.com/google/xls/issues/506): 2021-10-15
+  // Assertion failures should work out, but we should consciously decide
+  // if/how we want to dump traces when running QuickChecks (always, for
+  // failures, flag-controlled, ...).
+  XLS_ASSIGN_OR_RETURN(
+      result->results.results,
+      run_comparator->RunIrFunctionBatched(ir_name, xls_function, arg_sets));
+  std::vector<Value>& results = result->results.results;
+  XLS_RET_CHECK_EQ(results.size(), count);
+  for (int64_t i = 0; i < count; ++i) {
+    if (results[i].IsAllZeros()) {
+      // We were able to falsify the xls_function (predicate), drop the later
+      // samples so this evidence is last.
+      arg_sets.resize(i + 1);
+      results.resize(i + 1);
+      result->falsified = true;
       break;
     }
   }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<QuickCheckResults> DoQuickCheck(
+    xls::Function* xls_function, std::string_view ir_name,
+    absl::Span<AbstractRunComparator* const> run_comparators, int64_t seed,
+    int64_t num_tests) {
+  XLS_RET_CHECK(!run_comparators.empty());
+  const int64_t shard_count =
+      (num_tests + kQuickCheckShardSize - 1) / kQuickCheckShardSize;
+  std::vector<QuickCheckShard> shards(shard_count);
+
+  // Shards are claimed in increasing order. Once a shard falsifies the
+  // predicate (or fails) no later shard is started, but every earlier shard
+  // still runs to completion, so the first falsifying example is always found.
+  std::atomic<int64_t> next_shard = 0;
+  std::atomic<int64_t> first_stopped_shard = shard_count;
+  auto run_shards = [&](AbstractRunComparator* run_comparator) {
+    for (int64_t shard = next_shard++;
+         shard < shard_count && shard < first_stopped_shard.load();
+         shard = next_shard++) {
+      int64_t count = std::min(kQuickCheckShardSize,
+                               num_tests - shard * kQuickCheckShardSize);
+      QuickCheckShard& result = shards[shard];
+      result.status = RunQuickCheckShard(xls_function, ir_name, run_comparator,
+                                         seed, shard, count, &result);
+      if (result.falsified || !result.status.ok()) {
+        int64_t stopped = first_stopped_shard.load();
+        while (shard < stopped &&
+               !first_stopped_shard.compare_exchange_weak(stopped, shard)) {
+        }
+      }
+    }
+  };
+  const int64_t thread_count =
+      std::min<int64_t>(run_comparators.size(), shard_count);
+  // Calls running at the same time have distinct indices, so each comparator
+  // is only used by one thread at a time.
+  ParallelFor(0, thread_count,
+              [&](int64_t i) { run_shards(run_comparators[i]); });
 
+  QuickCheckResults results;
+  for (QuickCheckShard& shard : shards) {
+    XLS_RETURN_IF_ERROR(shard.status);
+    absl::c_move(shard.results.arg_sets, std::back_inserter(results.arg_sets));
+    absl::c_move(shard.results.results, std::back_inserter(results.results));
+    if (shard.falsified) {
+      break;
+    }
+  }
   return results;
 }
 
-static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
-                                  Package* ir_package, QuickCheck* quickcheck,
-                                  TypeInfo* type_info, int64_t seed) {
+static absl::Status RunQuickCheck(
+    absl::Span<AbstractRunComparator* const> run_comparators,
+    Package* ir_package, QuickCheck* quickcheck, TypeInfo* type_info,
+    int64_t seed) {
   Function* fn = quickcheck->f();
   XLS_ASSIGN_OR_RETURN(std::string ir_name,
                        MangleDslxName(fn->owner()->name(), fn->identifier(),
@@ -177,7 +282,7 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
 
   XLS_ASSIGN_OR_RETURN(
       QuickCheckResults qc_results,
-      DoQuickCheck(ir_function, std::move(ir_name), run_comparator, seed,
+      DoQuickCheck(ir_function, std::move(ir_name), run_comparators, seed,
                    quickcheck->test_count()));
   const auto& [arg_sets, results] = qc_results;
   XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
@@ -209,43 +314,210 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
                       results.size(), dslx_argset_str));
 }
 
-using HandleError = const std::function<void(
-    const absl::Status&, std::string_view test_name, bool is_quickcheck)>;
-
-static absl::Status RunQuickChecksIfJitEnabled(
-    Module* entry_module, TypeInfo* type_info,
-    AbstractRunComparator* run_comparator, Package* ir_package,
-    std::optional<int64_t> seed, const HandleError& handle_error) {
-  if (run_comparator == nullptr) {
-    std::cerr << "[ SKIPPING QUICKCHECKS  ] (JIT is disabled)"
-              << "\n";
-    return absl::OkStatus();
+// Prints the failure of the test (or quickcheck) `test_name` with the given
+// status to `out`.
+static void ReportFailure(const absl::Status& status,
+                          std::string_view test_name, bool is_quickcheck,
+                          std::ostream& out) {
+  XLS_VLOG(1) << "Handling error; status: " << status
+              << " test_name: " << test_name;
+  absl::StatusOr<PositionalErrorData> data_or = GetPositionalErrorData(status);
+  std::string suffix;
+  if (data_or.ok()) {
+    const auto& data = data_or.value();
+    XLS_CHECK_OK(PrintPositionalError(
+        data.span, data.GetMessageWithType(), out,
+        /*get_file_contents=*/nullptr, PositionalErrorColor::kErrorColor));
+  } else {
+    // If we can't extract positional data we log the error and put the error
+    // status into the "failed" prompted.
+    XLS_LOG(ERROR) << "Internal error: " << status;
+    suffix = absl::StrCat(": internal error: ", status.ToString());
   }
-  if (!seed.has_value()) {
-    // Note: we *want* to *provide* non-determinism by default. See
-    // https://abseil.io/docs/cpp/guides/random#stability-of-generated-sequences
-    // for rationale.
-    seed = static_cast<int64_t>(getpid()) * static_cast<int64_t>(time(nullptr));
+  std::string spaces((is_quickcheck ? kQuickcheckSpaces : kUnitSpaces), ' ');
+  out << absl::StreamFormat("[ %sFAILED ] %s%s", spaces, test_name, suffix)
+      << "\n";
+}
+
+// Returns the number of threads to use for a parallelism option, where zero
+// means the size of the shared thread pool.
+static int64_t ResolveThreadCount(int64_t parallelism) {
+  if (parallelism == 0) {
+    return ThreadPool::Default()->thread_count();
   }
-  std::cerr << absl::StreamFormat("[ SEED %*d ]", kQuickcheckSpaces + 1, *seed)
-            << "\n";
-  for (QuickCheck* quickcheck : entry_module->GetQuickChecks()) {
-    const std::string& test_name = quickcheck->identifier();
-    std::cerr << "[ RUN QUICKCHECK        ] " << test_name
-              << " count: " << quickcheck->test_count() << "\n";
-    absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
-    if (!status.ok()) {
-      handle_error(status, test_name, /*is_quickcheck=*/true);
+  return std::max<int64_t>(parallelism, 1);
+}
+
+// A unit test (or test proc) or quickcheck of the entry module to run.
+struct TestItem {
+  std::string name;
+  bool is_quickcheck;
+};
+
+// The state needed to run the tests and quickchecks of the entry module. The
+// import data holds the bytecode cache of the test being run and the
+// comparator holds a JIT cache, neither of which is thread-safe, so each
+// thread running tests has its own environment.
+struct TestEnvironment {
+  ImportData* import_data;
+  Module* entry_module;
+  TypeInfo* type_info;
+  AbstractRunComparator* run_comparator;
+  Package* ir_package;
+  PostFnEvalHook post_fn_eval_hook;
+};
+
+// Returns a hook which compares each DSLX function evaluation against the
+// execution of the corresponding IR function in `ir_package`.
+static PostFnEvalHook MakeComparisonHook(ImportData* import_data,
+                                         AbstractRunComparator* run_comparator,
+                                         Package* ir_package) {
+  return [import_data, run_comparator, ir_package](
+             const Function* f, absl::Span<const InterpValue> args,
+             const ParametricEnv* parametric_env,
+             const InterpValue& got) -> absl::Status {
+    std::optional<bool> requires_implicit_token =
+        import_data->GetRootTypeInfoForNode(f)
+            .value()
+            ->GetRequiresImplicitToken(f);
+    XLS_RET_CHECK(requires_implicit_token.has_value());
+    return run_comparator->RunComparison(ir_package, *requires_implicit_token,
+                                         f, args, parametric_env, got);
+  };
+}
+
+// Runs the unit test or quickcheck `item` and writes its progress and outcome
+// to `out`. Returns whether it failed; an error status is only returned if the
+// item could not be run at all.
+static absl::StatusOr<bool> RunTestItem(const TestEnvironment& env,
+                                        const TestItem& item,
+                                        const ParseAndTestOptions& options,
+                                        std::optional<int64_t> seed,
+                                        std::ostream& out) {
+  const std::string& test_name = item.name;
+  absl::Status status;
+  if (item.is_quickcheck) {
+    QuickCheck* quickcheck = nullptr;
+    for (QuickCheck* qc : env.entry_module->GetQuickChecks()) {
+      if (qc->identifier() == test_name) {
+        quickcheck = qc;
+        break;
+      }
+    }
+    XLS_RET_CHECK(quickcheck != nullptr) << test_name;
+    out << "[ RUN QUICKCHECK        ] " << test_name
+        << " count: " << quickcheck->test_count() << "\n";
+    // Comparators are not thread-safe so each additional quickcheck thread
+    // gets its own.
+    std::vector<std::unique_ptr<AbstractRunComparator>> thread_comparators;
+    std::vector<AbstractRunComparator*> run_comparators = {env.run_comparator};
+    int64_t quickcheck_thread_count =
+        ResolveThreadCount(options.quickcheck_parallelism);
+    for (int64_t i = 1; i < quickcheck_thread_count; ++i) {
+      thread_comparators.push_back(options.run_comparator_factory());
+      run_comparators.push_back(thread_comparators.back().get());
+    }
+    status = RunQuickCheck(run_comparators, env.ir_package, quickcheck,
+                           env.type_info, *seed);
+    if (status.ok()) {
+      out << "[                    OK ] " << test_name << "\n";
+    }
+  } else {
+    out << "[ RUN UNITTEST  ] " << test_name << std::endl;
+    ModuleMember* member =
+        env.entry_module->FindMemberWithName(test_name).value();
+    BytecodeInterpreterOptions interpreter_options;
+    interpreter_options.post_fn_eval_hook(env.post_fn_eval_hook)
+        .trace_hook(InfoLoggingTraceHook)
+        .trace_channels(options.trace_channels)
+        .max_ticks(options.max_ticks);
+    if (std::holds_alternative<TestFunction*>(*member)) {
+      XLS_ASSIGN_OR_RETURN(TestFunction * tf,
+                           env.entry_module->GetTest(test_name));
+      status = RunTestFunction(env.import_data, env.type_info,
+                               env.entry_module, tf, interpreter_options);
     } else {
-      std::cerr << "[                    OK ] " << test_name << "\n";
+      XLS_ASSIGN_OR_RETURN(TestProc * tp,
+                           env.entry_module->GetTestProc(test_name));
+      status = RunTestProc(env.import_data, env.type_info, env.entry_module,
+                           tp, interpreter_options);
+    }
+    if (status.ok()) {
+      out << "[            OK ]" << std::endl;
     }
   }
-  std::cerr << absl::StreamFormat(
-                   "[=======================] %d quickcheck(s) ran.",
-                   entry_module->GetQuickChecks().size())
-            << "\n";
-  return absl::OkStatus();
+  if (!status.ok()) {
+    ReportFailure(status, test_name, item.is_quickcheck, out);
+    return true;
+  }
+  return false;
+}
+
+// The buffered outcome of running a test item on a worker thread.
+struct TestItemOutcome {
+  std::string output;
+  bool failed = false;
+};
+
+// Runs `items` on `thread_count` workers on the shared thread pool and returns
+// their outcomes in the order of `items`. The first worker uses `env`; every
+// other worker parses and typechecks the program again into its own import
+// data and, if comparing, creates its own comparator and IR package.
+static absl::StatusOr<std::vector<TestItemOutcome>> RunTestItemsInParallel(
+    std::string_view program, std::string_view module_name,
+    std::string_view filename, const ParseAndTestOptions& options,
+    const TestEnvironment& env, absl::Span<const TestItem> items,
+    std::optional<int64_t> seed, int64_t thread_count) {
+  std::vector<TestItemOutcome> outcomes(items.size());
+  std::atomic<int64_t> next_item = 0;
+  auto run_items = [&](const TestEnvironment& thread_env) -> absl::Status {
+    for (int64_t i = next_item++; i < items.size(); i = next_item++) {
+      std::ostringstream out;
+      XLS_ASSIGN_OR_RETURN(outcomes[i].failed,
+                           RunTestItem(thread_env, items[i], options, seed,
+                                       out));
+      outcomes[i].output = out.str();
+    }
+    return absl::OkStatus();
+  };
+  auto run_items_in_new_environment = [&]() -> absl::Status {
+    // The workers share the thread pool, so this one may only start once the
+    // others have run every item.
+    if (next_item.load() >= items.size()) {
+      return absl::OkStatus();
+    }
+    auto import_data =
+        CreateImportData(options.stdlib_path, options.dslx_paths);
+    XLS_ASSIGN_OR_RETURN(
+        TypecheckedModule tm,
+        ParseAndTypecheck(program, filename, module_name, &import_data));
+    TestEnvironment thread_env = {.import_data = &import_data,
+                                  .entry_module = tm.module,
+                                  .type_info = tm.type_info};
+    std::unique_ptr<AbstractRunComparator> run_comparator;
+    std::unique_ptr<Package> ir_package;
+    if (env.run_comparator != nullptr) {
+      run_comparator = options.run_comparator_factory();
+      XLS_ASSIGN_OR_RETURN(
+          ir_package, ConvertModuleToPackage(tm.module, &import_data,
+                                             options.convert_options,
+                                             /*traverse_tests=*/true));
+      thread_env.run_comparator = run_comparator.get();
+      thread_env.ir_package = ir_package.get();
+      thread_env.post_fn_eval_hook = MakeComparisonHook(
+          &import_data, run_comparator.get(), ir_package.get());
+    }
+    return run_items(thread_env);
+  };
+
+  std::vector<absl::Status> statuses(thread_count);
+  ParallelFor(0, thread_count, [&](int64_t t) {
+    statuses[t] = t == 0 ? run_items(env) : run_items_in_new_environment();
+  });
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return outcomes;
 }
 
 absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
@@ -256,31 +528,6 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
   int64_t failed = 0;
   int64_t skipped = 0;
 
-  auto handle_error = [&](const absl::Status& status,
-                          std::string_view test_name, bool is_quickcheck) {
-    XLS_VLOG(1) << "Handling error; status: " << status
-                << " test_name: " << test_name;
-    absl::StatusOr<PositionalErrorData> data_or =
-        GetPositionalErrorData(status);
-    std::string suffix;
-    if (data_or.ok()) {
-      const auto& data = data_or.value();
-      XLS_CHECK_OK(PrintPositionalError(
-          data.span, data.GetMessageWithType(), std::cerr,
-          /*get_file_contents=*/nullptr, PositionalErrorColor::kErrorColor));
-    } else {
-      // If we can't extract positional data we log the error and put the error
-      // status into the "failed" prompted.
-      XLS_LOG(ERROR) << "Internal error: " << status;
-      suffix = absl::StrCat(": internal error: ", status.ToString());
-    }
-    std::string spaces((is_quickcheck ? kQuickcheckSpaces : kUnitSpaces), ' ');
-    std::cerr << absl::StreamFormat("[ %sFAILED ] %s%s", spaces, test_name,
-                                    suffix)
-              << "\n";
-    failed += 1;
-  };
-
   auto import_data = CreateImportData(options.stdlib_path, options.dslx_paths);
 
   absl::StatusOr<TypecheckedModule> tm_or =
@@ -327,53 +574,81 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
       return ir_package_or.status();
     }
     ir_package = std::move(ir_package_or).value();
-    post_fn_eval_hook = [&ir_package, &import_data, &options](
-                            const Function* f,
-                            absl::Span<const InterpValue> args,
-                            const ParametricEnv* parametric_env,
-                            const InterpValue& got) -> absl::Status {
-      std::optional<bool> requires_implicit_token =
-          import_data.GetRootTypeInfoForNode(f)
-              .value()
-              ->GetRequiresImplicitToken(f);
-      XLS_RET_CHECK(requires_implicit_token.has_value());
-      return options.run_comparator->RunComparison(ir_package.get(),
-                                                   *requires_implicit_token, f,
-                                                   args, parametric_env, got);
-    };
+    post_fn_eval_hook = MakeComparisonHook(
+        &import_data, options.run_comparator, ir_package.get());
   }
-
-  // Run unit tests.
+  TestEnvironment env = {.import_data = &import_data,
+                         .entry_module = entry_module,
+                         .type_info = tm_or.value().type_info,
+                         .run_comparator = options.run_comparator,
+                         .ir_package = ir_package.get(),
+                         .post_fn_eval_hook = post_fn_eval_hook};
+
+  // Collect the unit tests to run, followed by the quickchecks, which are only
+  // run if the JIT is enabled.
+  std::vector<TestItem> items;
   for (const std::string& test_name : entry_module->GetTestNames()) {
     if (!TestMatchesFilter(test_name, options.test_filter)) {
       skipped += 1;
       continue;
     }
-
-    ran += 1;
-    std::cerr << "[ RUN UNITTEST  ] " << test_name << std::endl;
-    absl::Status status;
-    ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
-    BytecodeInterpreterOptions interpreter_options;
-    interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
-        .trace_hook(InfoLoggingTraceHook)
-        .trace_channels(options.trace_channels)
-        .max_ticks(options.max_ticks);
-    if (std::holds_alternative<TestFunction*>(*member)) {
-      XLS_ASSIGN_OR_RETURN(TestFunction * tf, entry_module->GetTest(test_name));
-      status = RunTestFunction(&import_data, tm_or.value().type_info,
-                               entry_module, tf, interpreter_options);
-    } else {
-      XLS_ASSIGN_OR_RETURN(TestProc * tp, entry_module->GetTestProc(test_name));
-      status = RunTestProc(&import_data, tm_or.value().type_info, entry_module,
-                           tp, interpreter_options);
+    items.push_back(TestItem{.name = test_name, .is_quickcheck = false});
+  }
+  const int64_t unit_test_count = items.size();
+  std::optional<int64_t> seed = options.seed;
+  if (options.run_comparator != nullptr) {
+    for (QuickCheck* quickcheck : entry_module->GetQuickChecks()) {
+      items.push_back(
+          TestItem{.name = quickcheck->identifier(), .is_quickcheck = true});
     }
+    if (!seed.has_value()) {
+      // Note: we *want* to *provide* non-determinism by default. See
+      // https://abseil.io/docs/cpp/guides/random#stability-of-generated-sequences
+      // for rationale.
+      seed =
+          static_cast<int64_t>(getpid()) * static_cast<int64_t>(time(nullptr));
+    }
+  }
 
-    if (status.ok()) {
-      std::cerr << "[            OK ]" << std::endl;
+  int64_t thread_count = std::min<int64_t>(
+      ResolveThreadCount(options.parallelism),
+      std::max<int64_t>(items.size(), 1));
+  bool parallel_quickchecks =
+      ResolveThreadCount(options.quickcheck_parallelism) > 1;
+  if ((thread_count > 1 || parallel_quickchecks) &&
+      options.run_comparator != nullptr &&
+      options.run_comparator_factory == nullptr) {
+    return absl::InvalidArgumentError(
+        "A run comparator factory is required to run tests in parallel with a "
+        "run comparator.");
+  }
+
+  // When running in parallel the output of each item is buffered and replayed
+  // below in the same order as a sequential run would produce it.
+  std::vector<TestItemOutcome> outcomes;
+  if (thread_count > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        outcomes, RunTestItemsInParallel(program, module_name, filename,
+                                         options, env, items, seed,
+                                         thread_count));
+  }
+  auto run_item = [&](int64_t i) -> absl::Status {
+    bool item_failed;
+    if (outcomes.empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          item_failed, RunTestItem(env, items[i], options, seed, std::cerr));
     } else {
-      handle_error(status, test_name, /*is_quickcheck=*/false);
+      std::cerr << outcomes[i].output << std::flush;
+      item_failed = outcomes[i].failed;
     }
+    failed += item_failed ? 1 : 0;
+    return absl::OkStatus();
+  };
+
+  // Run unit tests.
+  for (int64_t i = 0; i < unit_test_count; ++i) {
+    ran += 1;
+    XLS_RETURN_IF_ERROR(run_item(i));
   }
 
   std::cerr << absl::StreamFormat(
@@ -383,9 +658,21 @@ absl::StatusOr<TestResult> ParseAndTest(std::string_view program,
 
   // Run quickchecks, but only if the JIT is enabled.
   if (!entry_module->GetQuickChecks().empty()) {
-    XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
-        entry_module, tm_or.value().type_info, options.run_comparator,
-        ir_package.get(), options.seed, handle_error));
+    if (options.run_comparator == nullptr) {
+      std::cerr << "[ SKIPPING QUICKCHECKS  ] (JIT is disabled)"
+                << "\n";
+    } else {
+      std::cerr << absl::StreamFormat("[ SEED %*d ]", kQuickcheckSpaces + 1,
+                                      *seed)
+                << "\n";
+      for (int64_t i = unit_test_count; i < items.size(); ++i) {
+        XLS_RETURN_IF_ERROR(run_item(i));
+      }
+      std::cerr << absl::StreamFormat(
+                       "[=======================] %d quickcheck(s) ran.",
+                       entry_module->GetQuickChecks().size())
+                << "\n";
+    }
   }
 
   return failed == 0 ? TestResult::kAllPassed : TestResult::kSomeFailed;
@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <functional>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -67,6 +68,15 @@ class AbstractRunComparator {
   virtual absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) = 0;
+
+  // As above, but runs the IR function on a batch of argument sets and returns
+  // the results in the same order, dropping any events. The default
+  // implementation calls RunIrFunction on each argument set; subclasses can
+  // override it to evaluate the whole batch at once (e.g. with a batched JIT
+  // entry point).
+  virtual absl::StatusOr<std::vector<xls::Value>> RunIrFunctionBatched(
+      std::string_view ir_name, xls::Function* ir_function,
+      absl::Span<const std::vector<xls::Value>> ir_args);
 };
 
 // Optional arguments to ParseAndTest (that have sensible defaults).
@@ -79,6 +89,16 @@ class AbstractRunComparator {
 //   seed: Seed for QuickCheck random input stimulus.
 //   convert_options: Options used in IR conversion, see `ConvertOptions` for
 //    details.
+//   parallelism: Number of threads used to run the tests and quickchecks; zero
+//    means use the number of hardware threads. Output is reported in the same
+//    order as a sequential run.
+//   run_comparator_factory: Creates a comparator equivalent to run_comparator
+//    for each additional thread, as comparators are not thread-safe. Required
+//    if run_comparator is given and more than one thread is used.
+//   quickcheck_parallelism: Number of threads used to run the samples of each
+//    quickcheck; zero means use the number of hardware threads. The samples
+//    and the reported counterexample do not depend on this value. Additional
+//    threads get their comparators from run_comparator_factory.
 struct ParseAndTestOptions {
   std::string stdlib_path = xls::kDefaultDslxStdlibPath;
   absl::Span<const std::filesystem::path> dslx_paths = {};
@@ -91,6 +111,10 @@ struct ParseAndTestOptions {
   bool warnings_as_errors = true;
   bool trace_channels = false;
   std::optional<int64_t> max_ticks;
+  int64_t parallelism = 1;
+  std::function<std::unique_ptr<AbstractRunComparator>()>
+      run_comparator_factory;
+  int64_t quickcheck_parallelism = 1;
 };
 
 enum class TestResult {
@@ -131,6 +155,16 @@ absl::StatusOr<QuickCheckResults> DoQuickCheck(
     xls::Function* xls_function, std::string_view ir_name,
     AbstractRunComparator* run_comparator, int64_t seed, int64_t num_tests);
 
+// As above, but the samples are evaluated in batches spread across one thread
+// per comparator (comparators are not thread-safe). The samples are split into
+// fixed-size shards, each drawing its arguments from a generator seeded by
+// `seed` and the shard index, so the results -- including the first
+// falsifying example -- do not depend on the number of comparators.
+absl::StatusOr<QuickCheckResults> DoQuickCheck(
+    xls::Function* xls_function, std::string_view ir_name,
+    absl::Span<AbstractRunComparator* const> run_comparators, int64_t seed,
+    int64_t num_tests);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_RUN_ROUTINES_H_
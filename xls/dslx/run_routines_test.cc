@@ -14,8 +14,10 @@
 
 #include "xls/dslx/run_routines.h"
 
+#include <atomic>
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -23,6 +25,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
@@ -139,6 +142,77 @@ proc doomed {
   EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed));
 }
 
+TEST(RunRoutinesTest, ParallelTestsAndQuickChecks) {
+  constexpr const char* kProgram = R"(
+fn id(x: u32) -> u32 { x }
+
+#[test]
+fn test_a() { assert_eq(id(u32:1), u32:1) }
+
+#[test]
+fn test_b() { assert_eq(id(u32:2), u32:2) }
+
+#[test]
+fn test_c() { assert_eq(id(u32:3), u32:3) }
+
+#[quickcheck(test_count=16)]
+fn trivial(x: u32) -> bool { id(x) == x }
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  RunComparator jit_comparator(CompareMode::kJit);
+  std::atomic<int64_t> comparators_created = 0;
+  ParseAndTestOptions options;
+  options.run_comparator = &jit_comparator;
+  options.seed = int64_t{2};
+  options.parallelism = 3;
+  options.run_comparator_factory = [&comparators_created] {
+    ++comparators_created;
+    return std::make_unique<RunComparator>(CompareMode::kJit);
+  };
+  absl::StatusOr<TestResult> result =
+      ParseAndTest(kProgram, kModuleName, kFilename, options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kAllPassed));
+  // The first thread uses the given comparator.
+  EXPECT_EQ(comparators_created, 2);
+}
+
+TEST(RunRoutinesTest, ParallelFailingTest) {
+  constexpr const char* kProgram = R"(
+#[test]
+fn test_pass() { assert_eq(u32:1, u32:1) }
+
+#[test]
+fn test_fail() { assert_eq(u32:1, u32:2) }
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto temp_file,
+                           TempFile::CreateWithContent(kProgram, "_test.x"));
+  constexpr const char* kModuleName = "test";
+  ParseAndTestOptions options;
+  options.parallelism = 2;
+  absl::StatusOr<TestResult> result = ParseAndTest(
+      kProgram, kModuleName, std::string(temp_file.path()), options);
+  EXPECT_THAT(result, status_testing::IsOkAndHolds(TestResult::kSomeFailed));
+}
+
+TEST(RunRoutinesTest, ParallelComparisonRequiresFactory) {
+  constexpr const char* kProgram = R"(
+#[test]
+fn test_a() { () }
+
+#[test]
+fn test_b() { () }
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  RunComparator jit_comparator(CompareMode::kJit);
+  ParseAndTestOptions options;
+  options.run_comparator = &jit_comparator;
+  options.parallelism = 2;
+  EXPECT_THAT(ParseAndTest(kProgram, kModuleName, kFilename, options),
+              status_testing::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 // Verifies that the QuickCheck mechanism can find counter-examples for a simple
 // erroneous function.
 TEST(QuickcheckTest, QuickCheckBits) {
@@ -260,6 +334,40 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// The samples, and so the first falsifying example, do not depend on the number
+// of threads evaluating them.
+TEST(QuickcheckTest, ShardedMatchesSingleThreaded) {
+  Package package("rarely_false");
+  std::string ir_text = R"(
+  fn ne_value(x: bits[16]) -> bits[1] {
+    literal.2: bits[16] = literal(value=42)
+    ret ne.3: bits[1] = ne(x, literal.2)
+  }
+  )";
+  int64_t seed = 7;
+  int64_t num_tests = 1000000;
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults single_threaded,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, num_tests));
+  EXPECT_EQ(single_threaded.results.back(), Value(UBits(0, 1)));
+  EXPECT_LT(single_threaded.results.size(), num_tests);
+
+  std::vector<std::unique_ptr<RunComparator>> comparators;
+  std::vector<AbstractRunComparator*> comparator_ptrs;
+  for (int64_t i = 0; i < 4; ++i) {
+    comparators.push_back(std::make_unique<RunComparator>(CompareMode::kJit));
+    comparator_ptrs.push_back(comparators.back().get());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults sharded,
+      DoQuickCheck(function, kFakeIrName, comparator_ptrs, seed, num_tests));
+  EXPECT_EQ(sharded.arg_sets, single_threaded.arg_sets);
+  EXPECT_EQ(sharded.results, single_threaded.results);
+}
+
 TEST(BytecodeInterpreterTest, DeadlockedProc) {
   // Test proc never sends to the subproc, so network is deadlocked.
   constexpr std::string_view kProgram = R"(
@@ -14,6 +14,7 @@
 
 #include "xls/dslx/type_system/type_info.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -74,6 +75,15 @@ absl::StatusOr<TypeInfo*> TypeInfoOwner::GetRootTypeInfo(const Module* module) {
   return it->second;
 }
 
+void TypeInfoOwner::Remove(const Module* module) {
+  module_to_root_.erase(module);
+  type_infos_.erase(std::remove_if(type_infos_.begin(), type_infos_.end(),
+                                   [module](const auto& type_info) {
+                                     return type_info->module() == module;
+                                   }),
+                    type_infos_.end());
+}
+
 // -- class TypeInfo
 
 void TypeInfo::NoteConstExpr(const AstNode* const_expr, InterpValue value) {
@@ -275,6 +285,24 @@ absl::StatusOr<TypeInfo*> TypeInfo::GetTopLevelProcTypeInfo(const Proc* p) {
   return top_level_proc_type_info_.at(p);
 }
 
+void TypeInfo::NoteInstantiationTypeInfo(const Function* f,
+                                         const ParametricEnv& env,
+                                         TypeInfo* type_info) {
+  XLS_CHECK_EQ(f->owner(), module_);
+  GetRoot()->instantiations_[{f, env}] = type_info;
+}
+
+std::optional<TypeInfo*> TypeInfo::GetInstantiationTypeInfo(
+    const Function* f, const ParametricEnv& env) const {
+  XLS_CHECK_EQ(f->owner(), module_);
+  const TypeInfo* root = GetRoot();
+  auto it = root->instantiations_.find({f, env});
+  if (it == root->instantiations_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
 std::optional<const ParametricEnv*> TypeInfo::GetInvocationCalleeBindings(
     const Invocation* invocation, const ParametricEnv& caller) const {
   XLS_CHECK_EQ(invocation->owner(), module_)
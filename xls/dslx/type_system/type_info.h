@@ -21,6 +21,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -89,6 +90,11 @@ class TypeInfoOwner {
   // status error if it is not present.
   absl::StatusOr<TypeInfo*> GetRootTypeInfo(const Module* module);
 
+  // Destroys all type information (root and derived) for the given module. The
+  // caller is responsible for ensuring nothing still refers to it, e.g. type
+  // information of modules that import it.
+  void Remove(const Module* module);
+
  private:
   // Mapping from module to the "root" (or "parentmost") type info -- these have
   // nullptr as their parent. There should only be one of these for any given
@@ -164,6 +170,15 @@ class TypeInfo {
   // called on the module root TypeInfo.
   absl::StatusOr<TypeInfo*> GetTopLevelProcTypeInfo(const Proc* p);
 
+  // Notes/retrieves the derived TypeInfo produced by typechecking the body of
+  // parametric function `f` under the parametric bindings `env`. Lets later
+  // invocations that resolve to the same instantiation reuse it instead of
+  // re-deducing the body. Stored on the root TypeInfo of `f`'s module.
+  void NoteInstantiationTypeInfo(const Function* f, const ParametricEnv& env,
+                                 TypeInfo* type_info);
+  std::optional<TypeInfo*> GetInstantiationTypeInfo(
+      const Function* f, const ParametricEnv& env) const;
+
   // Sets the type associated with the given AST node.
   void SetItem(const AstNode* key, const ConcreteType& value) {
     XLS_CHECK_EQ(key->owner(), module_);
@@ -287,6 +302,8 @@ class TypeInfo {
   absl::flat_hash_map<Slice*, SliceData> slices_;
   absl::flat_hash_map<const AstNode*, std::optional<InterpValue>> const_exprs_;
   absl::flat_hash_map<const Function*, bool> requires_implicit_token_;
+  absl::flat_hash_map<std::pair<const Function*, ParametricEnv>, TypeInfo*>
+      instantiations_;
 
   // Maps a Proc to the TypeInfo used for its top-level typechecking.
   absl::flat_hash_map<const Proc*, TypeInfo*> top_level_proc_type_info_;
@@ -26,6 +26,13 @@ namespace xls::dslx {
 
 // Converts the given type information object to protobuf form for
 // serialization.
+//
+// Note: the conversion is one-way. There is no TypeInfoFromProto, node types
+// are keyed by span, and resolving struct/enum types back requires the parsed
+// AST of every module in `import_data`. A persistent typecheck cache (keyed by
+// a hash of a module's contents and of its transitive imports) needs a TypeInfo
+// deserializer and an AST serialization to be able to skip parsing and
+// typechecking.
 absl::StatusOr<TypeInfoProto> TypeInfoToProto(const TypeInfo& type_info);
 
 // Converts the given protobuf representation of an AST node in module "m" into
@@ -817,9 +817,28 @@ absl::StatusOr<TypeAndBindings> CheckInvocation(
   parent_ctx->type_info()->SetItem(invocation->callee(), instantiated_ft);
   ctx->type_info()->SetItem(callee_fn->name_def(), instantiated_ft);
 
+  // A plain parametric function body typechecks identically for every
+  // invocation that resolves to the same parametric bindings, so reuse the
+  // derived TypeInfo of an earlier instantiation if there is one. Procs are
+  // excluded since each instantiation carries its own constexpr member values.
+  TypeInfo* original_ti = parent_ctx->type_info();
+  const bool memoizable =
+      !callee_fn->proc().has_value() && constexpr_env.empty();
+  if (memoizable) {
+    std::optional<TypeInfo*> cached =
+        ctx->type_info()->GetInstantiationTypeInfo(callee_fn,
+                                                   tab.parametric_env);
+    if (cached.has_value()) {
+      XLS_VLOG(5) << "Reusing instantiation of " << callee_fn->identifier()
+                  << " for " << tab.parametric_env;
+      original_ti->SetInvocationTypeInfo(invocation, tab.parametric_env,
+                                         cached.value());
+      return tab;
+    }
+  }
+
   // We need to deduce fn body, so we're going to call Deduce, which means we'll
   // need a new stack entry w/the new symbolic bindings.
-  TypeInfo* original_ti = parent_ctx->type_info();
   ctx->AddFnStackEntry(FnStackEntry::Make(
       callee_fn, tab.parametric_env, invocation,
       callee_fn->proc().has_value() ? WithinProc::kYes : WithinProc::kNo));
@@ -900,6 +919,10 @@ absl::StatusOr<TypeAndBindings> CheckInvocation(
 
   original_ti->SetInvocationTypeInfo(invocation, tab.parametric_env,
                                      ctx->type_info());
+  if (memoizable) {
+    ctx->type_info()->NoteInstantiationTypeInfo(callee_fn, tab.parametric_env,
+                                                ctx->type_info());
+  }
 
   XLS_RETURN_IF_ERROR(ctx->PopDerivedTypeInfo());
   ctx->PopFnStackEntry();
@@ -30,7 +30,9 @@
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/error_printer.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/interp_value.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/typecheck_test_helpers.h"
 
 namespace xls::dslx {
@@ -1173,6 +1175,43 @@ fn main() {
   EXPECT_TRUE(visitor.all_numbers_constexpr());
 }
 
+// Invocations that resolve to the same parametric bindings should share the
+// TypeInfo derived when the callee body was first typechecked.
+TEST(TypecheckTest, ParametricInstantiationTypeInfoIsShared) {
+  constexpr std::string_view kProgram = R"(
+fn id<N: u32>(x: bits[N]) -> bits[N] { x }
+fn main() -> u16 {
+  let a = id(u8:1);
+  let b = id(u8:2);
+  let c = id(u16:3);
+  c + (a ++ b)
+}
+)";
+
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "fake.x", "fake", &import_data));
+  std::vector<TypeInfo*> u8_type_infos;
+  std::vector<TypeInfo*> u16_type_infos;
+  for (const auto& [invocation, data] : tm.type_info->invocations()) {
+    if (invocation->callee()->ToString() != "id") {
+      continue;
+    }
+    ASSERT_EQ(data.instantiations.size(), 1);
+    const auto& [env, type_info] = *data.instantiations.begin();
+    if (env.ToMap().at("N") == InterpValue::MakeU32(8)) {
+      u8_type_infos.push_back(type_info);
+    } else {
+      u16_type_infos.push_back(type_info);
+    }
+  }
+  ASSERT_EQ(u8_type_infos.size(), 2);
+  ASSERT_EQ(u16_type_infos.size(), 1);
+  EXPECT_EQ(u8_type_infos[0], u8_type_infos[1]);
+  EXPECT_NE(u8_type_infos[0], u16_type_infos[0]);
+}
+
 TEST(TypecheckTest, BasicTupleIndex) {
   XLS_EXPECT_OK(Typecheck(R"(
 fn main() -> u18 {
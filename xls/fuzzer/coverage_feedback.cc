@@ -0,0 +1,225 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/coverage_feedback.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "absl/random/distributions.h"
+#include "absl/strings/str_cat.h"
+#include "google/protobuf/text_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/fuzzer/dslx_mutator.h"
+#include "xls/fuzzer/sample_generator.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+namespace {
+
+// The number of mutations of a corpus entry tried before giving up on one
+// that typechecks.
+constexpr int64_t kMutationAttempts = 8;
+
+// Returns `width` rounded up to a power of two, so e.g. all adds of 5 to 8
+// bits are one feature.
+int64_t WidthBucket(int64_t width) {
+  int64_t bucket = 1;
+  while (bucket < width) {
+    bucket <<= 1;
+  }
+  return width == 0 ? 0 : bucket;
+}
+
+void AddNodeFeatures(
+    std::string_view stage,
+    const google::protobuf::RepeatedPtrField<fuzzer::NodeProto>& nodes,
+    CoverageFeatures* features) {
+  for (const fuzzer::NodeProto& node : nodes) {
+    features->insert(absl::StrCat(stage, ":", node.op(), ":", node.type(), ":",
+                                  WidthBucket(node.width())));
+  }
+}
+
+bool SameOptions(const dslx::AstGeneratorOptions& a,
+                 const dslx::AstGeneratorOptions& b) {
+  return a.emit_signed_types == b.emit_signed_types &&
+         a.max_width_bits_types == b.max_width_bits_types &&
+         a.max_width_aggregate_types == b.max_width_aggregate_types &&
+         a.emit_loops == b.emit_loops && a.emit_gate == b.emit_gate &&
+         a.generate_proc == b.generate_proc &&
+         a.emit_stateless_proc == b.emit_stateless_proc;
+}
+
+// Returns the base options followed by those variations of them which differ
+// from the base options.
+std::vector<std::pair<std::string, dslx::AstGeneratorOptions>> MakeArms(
+    const dslx::AstGeneratorOptions& base) {
+  std::vector<std::pair<std::string, dslx::AstGeneratorOptions>> variations;
+  dslx::AstGeneratorOptions options = base;
+  options.max_width_bits_types =
+      std::min<int64_t>(base.max_width_bits_types, 8);
+  variations.push_back({"narrow_bits", options});
+
+  options = base;
+  options.max_width_bits_types = base.max_width_bits_types * 2;
+  variations.push_back({"wide_bits", options});
+
+  options = base;
+  options.max_width_aggregate_types =
+      std::min<int64_t>(base.max_width_aggregate_types, 64);
+  variations.push_back({"small_aggregates", options});
+
+  options = base;
+  options.emit_loops = false;
+  variations.push_back({"no_loops", options});
+
+  options = base;
+  options.emit_signed_types = false;
+  variations.push_back({"unsigned", options});
+
+  std::vector<std::pair<std::string, dslx::AstGeneratorOptions>> arms = {
+      {"base", base}};
+  for (auto& [name, variation] : variations) {
+    if (!SameOptions(variation, base)) {
+      arms.push_back({std::move(name), variation});
+    }
+  }
+  return arms;
+}
+
+}  // namespace
+
+CoverageFeatures CollectCoverage(const fuzzer::SampleSummaryProto& summary,
+                                 const std::filesystem::path& run_dir) {
+  CoverageFeatures features;
+  AddNodeFeatures("unopt", summary.unoptimized_nodes(), &features);
+  AddNodeFeatures("opt", summary.optimized_nodes(), &features);
+
+  absl::StatusOr<std::string> metrics_text =
+      GetFileContents(run_dir / "sample.opt.pass_metrics.textproto");
+  PassMetricsProto metrics;
+  if (metrics_text.ok() &&
+      google::protobuf::TextFormat::ParseFromString(*metrics_text, &metrics)) {
+    for (const PassInvocationProto& invocation : metrics.invocations()) {
+      if (invocation.ir_changed()) {
+        features.insert(absl::StrCat("pass:", invocation.pass_name()));
+      }
+    }
+  }
+  return features;
+}
+
+CoverageGuide::CoverageGuide(const dslx::AstGeneratorOptions& base_options)
+    : arms_([&] {
+        std::vector<Arm> arms;
+        for (auto& [name, options] : MakeArms(base_options)) {
+          arms.push_back(Arm{std::move(name), options});
+        }
+        return arms;
+      }()),
+      arm_stats_(arms_.size()) {}
+
+CoverageGuide::Plan CoverageGuide::NextPlan(absl::BitGenRef gen) {
+  absl::MutexLock lock(&mutex_);
+  Plan plan;
+  if (!corpus_.empty() && absl::Bernoulli(gen, kMutationProbability)) {
+    plan.mutation_source = corpus_[absl::Uniform<size_t>(gen, 0,
+                                                         corpus_.size())];
+    return plan;
+  }
+
+  // UCB1 over the arms, rewarding samples which found new features. Arms are
+  // charged for a sample when it is planned so concurrent workers spread over
+  // the untried arms.
+  int64_t total = 0;
+  for (const ArmStats& stats : arm_stats_) {
+    total += stats.samples;
+  }
+  double best_score = -1.0;
+  for (int64_t arm = 0; arm < arms_.size(); ++arm) {
+    const ArmStats& stats = arm_stats_[arm];
+    if (stats.samples == 0) {
+      plan.arm = arm;
+      break;
+    }
+    double score = static_cast<double>(stats.productive_samples) /
+                       stats.samples +
+                   std::sqrt(2.0 * std::log(total) / stats.samples);
+    if (score > best_score) {
+      best_score = score;
+      plan.arm = arm;
+    }
+  }
+  ++arm_stats_[plan.arm].samples;
+  return plan;
+}
+
+absl::StatusOr<Sample> CoverageGuide::ProduceSample(
+    const Plan& plan, const SampleOptions& sample_options,
+    ValueGenerator* value_gen) {
+  const dslx::AstGeneratorOptions& options = arms_[plan.arm].options;
+  if (plan.mutation_source.has_value()) {
+    for (int64_t attempt = 0; attempt < kMutationAttempts; ++attempt) {
+      absl::StatusOr<std::string> mutated =
+          dslx::RemoveDslxToken(*plan.mutation_source, value_gen->rng());
+      if (!mutated.ok()) {
+        continue;
+      }
+      absl::StatusOr<Sample> sample = GenerateSampleFromDslx(
+          *std::move(mutated), options, sample_options, value_gen);
+      if (sample.ok()) {
+        return sample;
+      }
+    }
+  }
+  return GenerateSample(options, sample_options, value_gen);
+}
+
+int64_t CoverageGuide::Record(const Plan& plan, const Sample& sample,
+                              const CoverageFeatures& features) {
+  absl::MutexLock lock(&mutex_);
+  ++sample_count_;
+  int64_t new_features = 0;
+  for (const std::string& feature : features) {
+    if (feature_hits_[feature]++ == 0) {
+      ++new_features;
+    }
+  }
+  if (new_features == 0) {
+    return 0;
+  }
+  if (!plan.mutation_source.has_value()) {
+    ++arm_stats_[plan.arm].productive_samples;
+  }
+  if (corpus_.size() < kMaxCorpusSize) {
+    corpus_.push_back(sample.input_text());
+  } else {
+    corpus_[sample_count_ % kMaxCorpusSize] = sample.input_text();
+  }
+  return new_features;
+}
+
+int64_t CoverageGuide::feature_count() const {
+  absl::MutexLock lock(&mutex_);
+  return feature_hits_.size();
+}
+
+int64_t CoverageGuide::corpus_size() const {
+  absl::MutexLock lock(&mutex_);
+  return corpus_.size();
+}
+
+}  // namespace xls
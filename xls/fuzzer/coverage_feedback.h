@@ -0,0 +1,137 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Coverage feedback for the fuzzer: lightweight coverage features of each
+// sample and a guide which steers generation towards samples with new ones.
+
+#ifndef XLS_FUZZER_COVERAGE_FEEDBACK_H_
+#define XLS_FUZZER_COVERAGE_FEEDBACK_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/fuzzer/value_generator.h"
+
+namespace xls {
+
+// The coverage features of a sample, e.g. "pass:cse" if common subexpression
+// elimination changed its IR or "opt:add:bits:8" if its optimized IR holds an
+// add of 5 to 8 bits.
+using CoverageFeatures = absl::flat_hash_set<std::string>;
+
+// Returns the coverage features of a sample with the given summary (see
+// SummarizePackage) run in `run_dir`:
+//
+//  * for each node of the unoptimized and optimized IR, its op, type and width
+//    rounded up to a power of two. As the JIT lowers nodes by op and type,
+//    the optimized IR features also approximate the lowering paths taken.
+//  * for each optimization pass which changed the IR, its name, read from the
+//    pass metrics left in `run_dir` by InProcessSampleRunner.
+//
+// Stages the sample did not reach contribute no features.
+CoverageFeatures CollectCoverage(const fuzzer::SampleSummaryProto& summary,
+                                 const std::filesystem::path& run_dir);
+
+// Steers sample generation towards samples which cover features no earlier
+// sample covered.
+//
+// Two kinds of feedback are used. Samples are generated with one of several
+// variations ("arms") of the base AstGeneratorOptions, e.g. narrow bits types
+// or no loops, chosen by a UCB1 bandit rewarding the arms whose samples found
+// new features. And samples which found new features are kept in a corpus,
+// from which some samples are derived by mutation (see RemoveDslxToken)
+// instead of being generated from scratch.
+//
+// Thread-safe. Runs guided by the feedback depend on the order in which the
+// samples complete, so they are not reproducible from the seed alone.
+class CoverageGuide {
+ public:
+  // How a sample was produced, for crediting its coverage.
+  struct Plan {
+    // Index of the arm whose options generate the sample. Mutations use the
+    // base options (arm 0) and are not credited to any arm.
+    int64_t arm = 0;
+    // If set, the sample is a mutation of this corpus entry.
+    std::optional<std::string> mutation_source;
+  };
+
+  // The number of corpus entries kept; beyond this entries are replaced in
+  // turn.
+  static constexpr int64_t kMaxCorpusSize = 256;
+
+  // The fraction of samples mutated from the corpus, once it is non-empty.
+  static constexpr double kMutationProbability = 0.25;
+
+  explicit CoverageGuide(const dslx::AstGeneratorOptions& base_options);
+
+  // Returns the plan for the next sample.
+  Plan NextPlan(absl::BitGenRef gen);
+
+  // Returns a sample produced according to `plan`. Mutations which do not
+  // typecheck are retried a few times before falling back to generating a
+  // fresh sample.
+  absl::StatusOr<Sample> ProduceSample(const Plan& plan,
+                                       const SampleOptions& sample_options,
+                                       ValueGenerator* value_gen);
+
+  // Records the coverage of a sample produced according to `plan` and returns
+  // the number of features it covered first.
+  int64_t Record(const Plan& plan, const Sample& sample,
+                 const CoverageFeatures& features);
+
+  const std::string& arm_name(int64_t arm) const { return arms_[arm].name; }
+  const dslx::AstGeneratorOptions& arm_options(int64_t arm) const {
+    return arms_[arm].options;
+  }
+  int64_t arm_count() const { return arms_.size(); }
+  int64_t feature_count() const;
+  int64_t corpus_size() const;
+
+ private:
+  struct Arm {
+    std::string name;
+    dslx::AstGeneratorOptions options;
+  };
+  struct ArmStats {
+    int64_t samples = 0;
+    // The samples which covered at least one new feature.
+    int64_t productive_samples = 0;
+  };
+
+  const std::vector<Arm> arms_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<ArmStats> arm_stats_ ABSL_GUARDED_BY(mutex_);
+  // The number of samples covering each feature seen so far.
+  absl::flat_hash_map<std::string, int64_t> feature_hits_
+      ABSL_GUARDED_BY(mutex_);
+  std::vector<std::string> corpus_ ABSL_GUARDED_BY(mutex_);
+  int64_t sample_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_COVERAGE_FEEDBACK_H_
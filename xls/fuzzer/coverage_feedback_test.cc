@@ -0,0 +1,117 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/coverage_feedback.h"
+
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+fuzzer::NodeProto MakeNode(std::string_view op, int64_t width) {
+  fuzzer::NodeProto node;
+  node.set_op(std::string(op));
+  node.set_type("bits");
+  node.set_width(width);
+  return node;
+}
+
+TEST(CollectCoverageTest, NodesAndChangedPasses) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory run_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(SetFileContents(
+      run_dir.path() / "sample.opt.pass_metrics.textproto",
+      R"(invocations { pass_name: "cse" ir_changed: true }
+         invocations { pass_name: "dce" ir_changed: false })"));
+  fuzzer::SampleSummaryProto summary;
+  *summary.add_unoptimized_nodes() = MakeNode("add", 5);
+  *summary.add_unoptimized_nodes() = MakeNode("add", 7);
+  *summary.add_optimized_nodes() = MakeNode("add", 9);
+  EXPECT_THAT(CollectCoverage(summary, run_dir.path()),
+              UnorderedElementsAre("unopt:add:bits:8", "opt:add:bits:16",
+                                   "pass:cse"));
+}
+
+TEST(CollectCoverageTest, MissingStages) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory run_dir, TempDirectory::Create());
+  EXPECT_TRUE(
+      CollectCoverage(fuzzer::SampleSummaryProto(), run_dir.path()).empty());
+}
+
+TEST(CoverageGuideTest, TriesEachArmFirst) {
+  CoverageGuide guide{dslx::AstGeneratorOptions()};
+  ASSERT_GT(guide.arm_count(), 1);
+  EXPECT_EQ(guide.arm_name(0), "base");
+  std::mt19937_64 rng(0);
+  absl::flat_hash_set<int64_t> arms;
+  for (int64_t i = 0; i < guide.arm_count(); ++i) {
+    arms.insert(guide.NextPlan(rng).arm);
+  }
+  EXPECT_EQ(arms.size(), guide.arm_count());
+}
+
+TEST(CoverageGuideTest, OmitsArmsEqualToBase) {
+  dslx::AstGeneratorOptions options;
+  options.emit_loops = false;
+  options.emit_signed_types = false;
+  CoverageGuide guide(options);
+  for (int64_t arm = 1; arm < guide.arm_count(); ++arm) {
+    EXPECT_NE(guide.arm_name(arm), "no_loops");
+    EXPECT_NE(guide.arm_name(arm), "unsigned");
+  }
+}
+
+TEST(CoverageGuideTest, RecordsNewFeaturesAndMutatesCorpus) {
+  CoverageGuide guide{dslx::AstGeneratorOptions()};
+  SampleOptions sample_options;
+  sample_options.set_calls_per_sample(2);
+  ValueGenerator value_gen(std::mt19937_64(0));
+
+  CoverageGuide::Plan plan = guide.NextPlan(value_gen.rng());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Sample sample,
+      guide.ProduceSample(plan, sample_options, &value_gen));
+  EXPECT_EQ(guide.Record(plan, sample, {"opt:add:bits:8", "pass:cse"}), 2);
+  EXPECT_EQ(guide.Record(plan, sample, {"opt:add:bits:8"}), 0);
+  EXPECT_EQ(guide.feature_count(), 2);
+  EXPECT_EQ(guide.corpus_size(), 1);
+
+  // Mutations of the corpus entry still yield runnable samples.
+  CoverageGuide::Plan mutation;
+  mutation.mutation_source = sample.input_text();
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Sample mutated,
+        guide.ProduceSample(mutation, sample_options, &value_gen));
+    EXPECT_EQ(mutated.args_batch().size(), 2);
+  }
+
+  // Once the corpus is non-empty some plans are mutations.
+  bool saw_mutation = false;
+  for (int64_t i = 0; i < 100 && !saw_mutation; ++i) {
+    saw_mutation = guide.NextPlan(value_gen.rng()).mutation_source.has_value();
+  }
+  EXPECT_TRUE(saw_mutation);
+}
+
+}  // namespace
+}  // namespace xls
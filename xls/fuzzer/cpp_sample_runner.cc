@@ -14,18 +14,171 @@
 
 #include "xls/fuzzer/cpp_sample_runner.h"
 
+#include <sys/resource.h>
+
+#include <utility>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/dslx/bytecode/bytecode_emitter.h"
+#include "xls/dslx/bytecode/bytecode_interpreter.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/interp_value_helpers.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/jit/function_jit.h"
+#include "xls/tools/opt.h"
 
 namespace xls {
 namespace {
 
+// Name (and file name stem) of the DSLX module of a sample.
+constexpr std::string_view kSampleModuleName = "sample";
+
 absl::StatusOr<std::string> ToIrString(const dslx::InterpValue& v) {
   XLS_ASSIGN_OR_RETURN(xls::Value value, v.ConvertToIr());
   return value.ToString(FormatPreference::kHex);
 }
 
+std::string ValuesToIrText(absl::Span<const Value> values) {
+  return absl::StrJoin(values, "\n", [](std::string* out, const Value& v) {
+    absl::StrAppend(out, v.ToString(FormatPreference::kHex));
+  });
+}
+
+// Returns the nanoseconds elapsed since `start`.
+int64_t ElapsedNs(absl::Time start) {
+  return absl::ToInt64Nanoseconds(absl::Now() - start);
+}
+
+// The ir_converter_main flags of a sample.
+struct IrConverterArgs {
+  std::optional<std::string> top;
+  dslx::ConvertOptions options;
+};
+
+// Parses the flags of SampleOptions::ir_converter_args. Only the flags which
+// affect the conversion of a single file are supported.
+absl::StatusOr<IrConverterArgs> ParseIrConverterArgs(
+    absl::Span<const std::string> args) {
+  IrConverterArgs result;
+  absl::flat_hash_map<std::string_view, bool*> bool_flags = {
+      {"emit_fail_as_assert", &result.options.emit_fail_as_assert},
+      {"verify", &result.options.verify_ir},
+      {"warnings_as_errors", &result.options.warnings_as_errors},
+  };
+  for (const std::string& arg : args) {
+    std::string_view flag = arg;
+    if (!absl::ConsumePrefix(&flag, "--")) {
+      absl::ConsumePrefix(&flag, "-");
+    }
+    std::pair<std::string_view, std::string_view> name_value =
+        absl::StrSplit(flag, absl::MaxSplits('=', 1));
+    auto [name, value] = name_value;
+    bool has_value = flag.size() > name.size();
+    if (name == "top" && has_value) {
+      result.top = std::string(value);
+      continue;
+    }
+    bool negated = !has_value && !bool_flags.contains(name) &&
+                   absl::ConsumePrefix(&name, "no");
+    auto it = bool_flags.find(name);
+    bool parsed = true;
+    if (it == bool_flags.end() ||
+        (has_value && !absl::SimpleAtob(value, &parsed))) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unsupported IR converter argument for in-process sample runs: ",
+          arg));
+    }
+    *it->second = parsed && !negated;
+  }
+  return result;
+}
+
+// Parses the newline-separated IR values printed by simulate_module_main.
+absl::StatusOr<std::vector<Value>> ParseValues(std::string_view text) {
+  std::vector<Value> values;
+  for (std::string_view line :
+       absl::StrSplit(text, '\n', absl::SkipWhitespace())) {
+    XLS_ASSIGN_OR_RETURN(values.emplace_back(),
+                         Parser::ParseTypedValue(absl::StripAsciiWhitespace(
+                             line)));
+  }
+  return values;
+}
+
+// Converts the arguments of `args_batch` to IR values.
+absl::StatusOr<std::vector<std::vector<Value>>> ArgsBatchToIrValues(
+    const ArgsBatch& args_batch) {
+  std::vector<std::vector<Value>> ir_args_batch;
+  ir_args_batch.reserve(args_batch.size());
+  for (const std::vector<dslx::InterpValue>& interp_args : args_batch) {
+    std::vector<Value>& args = ir_args_batch.emplace_back();
+    args.reserve(interp_args.size());
+    for (const dslx::InterpValue& interp_arg : interp_args) {
+      XLS_ASSIGN_OR_RETURN(args.emplace_back(), interp_arg.ConvertToIr());
+    }
+  }
+  return ir_args_batch;
+}
+
+// Returns the peak resident set size of this process in bytes.
+int64_t PeakRssBytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+  // Linux reports the size in kilobytes.
+  return int64_t{usage.ru_maxrss} * 1024;
+}
+
+// Runs the tool at the given runfile path in `run_dir`, recording its stderr
+// there, and returns its stdout.
+absl::StatusOr<std::string> RunTool(std::string_view tool_path,
+                                    std::vector<std::string> args,
+                                    const std::filesystem::path& run_dir,
+                                    const SampleOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path path,
+                       GetXlsRunfilePath(tool_path));
+  args.insert(args.begin(), path.string());
+  std::optional<absl::Duration> timeout;
+  if (options.timeout_seconds().has_value()) {
+    timeout = absl::Seconds(*options.timeout_seconds());
+  }
+  XLS_VLOG(1) << "Running: " << absl::StrJoin(args, " ");
+  XLS_ASSIGN_OR_RETURN(SubprocessResult result,
+                       InvokeSubprocess(args, run_dir, timeout));
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      run_dir / absl::StrCat(path.stem().string(), ".stderr"),
+      result.stderr));
+  if (result.timeout_expired) {
+    return absl::DeadlineExceededError(
+        absl::StrCat(path.stem().string(), " timed out after ",
+                     absl::FormatDuration(*timeout)));
+  }
+  XLS_ASSIGN_OR_RETURN(auto output,
+                       SubprocessResultToStrings(
+                           SubprocessErrorAsStatus(std::move(result))));
+  return output.first;
+}
+
 }  // namespace
 
 absl::Status CompareResultsFunction(
@@ -112,4 +265,429 @@ absl::Status CompareResultsFunction(
   return absl::OkStatus();
 }
 
+InProcessSampleRunner::InProcessSampleRunner(std::string dslx_stdlib_path,
+                                             JitObjectCache* jit_object_cache,
+                                             SampleStageCache* stage_cache)
+    : dslx_stdlib_path_(std::move(dslx_stdlib_path)),
+      jit_object_cache_(jit_object_cache),
+      stage_cache_(stage_cache) {}
+
+absl::Status InProcessSampleRunner::Run(const Sample& sample,
+                                        const std::filesystem::path& run_dir) {
+  timing_.Clear();
+  absl::Status status;
+  if (sample.options().top_type() == TopType::kFunction) {
+    status = RunFunction(sample, run_dir);
+  } else {
+    status = absl::UnimplementedError(
+        "The in-process sample runner only supports samples with a function "
+        "as the top.");
+  }
+  timing_.set_peak_rss_bytes(PeakRssBytes());
+  if (status.ok()) {
+    return status;
+  }
+  std::string message =
+      absl::StrCat(status.message(), "\n(run dir: ", run_dir.string(), ")");
+  XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "exception.txt", message));
+  return absl::Status(status.code(), message);
+}
+
+absl::StatusOr<std::string> InProcessSampleRunner::RunStage(
+    std::string_view stage, absl::Span<const std::string> inputs,
+    const std::filesystem::path& run_dir,
+    absl::Span<const std::string> side_outputs,
+    absl::FunctionRef<absl::StatusOr<std::string>()> run) {
+  auto run_and_note_timeout = [&]() -> absl::StatusOr<std::string> {
+    absl::StatusOr<std::string> output = run();
+    if (absl::IsDeadlineExceeded(output.status())) {
+      timing_.set_timed_out_stage(std::string(stage));
+    }
+    return output;
+  };
+  if (stage_cache_ == nullptr) {
+    return run_and_note_timeout();
+  }
+  auto side_output_key = [&](std::string_view file_name) {
+    return stage_cache_->Key(absl::StrCat(stage, ":", file_name), inputs);
+  };
+  std::string key = stage_cache_->Key(stage, inputs);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> output,
+                       stage_cache_->Lookup(key));
+  std::vector<std::pair<std::string, std::string>> side_output_contents;
+  for (const std::string& file_name : side_outputs) {
+    if (!output.has_value()) {
+      break;
+    }
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents,
+                         stage_cache_->Lookup(side_output_key(file_name)));
+    if (!contents.has_value()) {
+      output.reset();
+      break;
+    }
+    side_output_contents.push_back({file_name, *std::move(contents)});
+  }
+  if (output.has_value()) {
+    XLS_VLOG(1) << "Stage " << stage << " found in the stage cache.";
+    for (const auto& [file_name, contents] : side_output_contents) {
+      XLS_RETURN_IF_ERROR(SetFileContents(run_dir / file_name, contents));
+    }
+    return *std::move(output);
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::string result, run_and_note_timeout());
+  XLS_RETURN_IF_ERROR(stage_cache_->Insert(key, result));
+  for (const std::string& file_name : side_outputs) {
+    XLS_ASSIGN_OR_RETURN(std::string contents,
+                         GetFileContents(run_dir / file_name));
+    XLS_RETURN_IF_ERROR(
+        stage_cache_->Insert(side_output_key(file_name), contents));
+  }
+  return result;
+}
+
+absl::StatusOr<std::string> InProcessSampleRunner::ToolBuildId(
+    std::string_view tool_path) {
+  if (stage_cache_ == nullptr) {
+    return "";
+  }
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path path,
+                       GetXlsRunfilePath(tool_path));
+  return stage_cache_->FileBuildId(path);
+}
+
+absl::StatusOr<std::optional<std::string>> InProcessSampleRunner::RunDslx(
+    const Sample& sample, const std::filesystem::path& run_dir,
+    DifferentialExecutor* executor) {
+  const SampleOptions& options = sample.options();
+  std::vector<std::string> converter_arg_list =
+      options.ir_converter_args().value_or(std::vector<std::string>());
+  XLS_ASSIGN_OR_RETURN(IrConverterArgs converter_args,
+                       ParseIrConverterArgs(converter_arg_list));
+
+  // The sample is only parsed and typechecked if a stage needs it, i.e. is
+  // not in the stage cache.
+  std::optional<dslx::TypecheckedModule> typechecked;
+  // Drop the sample's module (keeping its imports) so the next sample can
+  // take its place.
+  absl::Cleanup remove_module = [&] {
+    if (!typechecked.has_value() || !import_data_.has_value()) {
+      return;
+    }
+    absl::Status removed = import_data_->Remove(
+        dslx::ImportTokens::FromString(kSampleModuleName).value());
+    if (!removed.ok()) {
+      XLS_LOG(WARNING) << "Dropping import data: " << removed;
+      import_data_.reset();
+    }
+  };
+  auto typecheck = [&]() -> absl::StatusOr<dslx::TypecheckedModule*> {
+    if (typechecked.has_value()) {
+      return &typechecked.value();
+    }
+    if (!import_data_.has_value()) {
+      import_data_.emplace(dslx::CreateImportData(
+          dslx_stdlib_path_, /*additional_search_paths=*/{}));
+    }
+    std::string path = absl::StrCat(kSampleModuleName, ".x");
+    absl::StatusOr<dslx::TypecheckedModule> checked = dslx::ParseAndTypecheck(
+        sample.input_text(), path, kSampleModuleName, &import_data_.value());
+    if (!checked.ok()) {
+      // A module which failed to typecheck may have left partial state
+      // behind, so start over with fresh import data.
+      import_data_.reset();
+      return checked.status();
+    }
+    typechecked = *std::move(checked);
+    return &typechecked.value();
+  };
+
+  if (!sample.args_batch().empty()) {
+    absl::Time start = absl::Now();
+    std::optional<std::vector<Value>> dslx_results;
+    XLS_ASSIGN_OR_RETURN(
+        std::string results_text,
+        RunStage(
+            "interpret_dslx",
+            {sample.input_text(), ArgsBatchToText(sample.args_batch())},
+            run_dir, /*side_outputs=*/{},
+            [&]() -> absl::StatusOr<std::string> {
+              XLS_ASSIGN_OR_RETURN(dslx::TypecheckedModule * tm, typecheck());
+              dslx::ImportData* import_data = &import_data_.value();
+              XLS_ASSIGN_OR_RETURN(
+                  dslx::Function * f,
+                  tm->module->GetMemberOrError<dslx::Function>("main"));
+              XLS_ASSIGN_OR_RETURN(
+                  dslx::FunctionType * fn_type,
+                  tm->type_info->GetItemAs<dslx::FunctionType>(f));
+              XLS_ASSIGN_OR_RETURN(
+                  std::unique_ptr<dslx::BytecodeFunction> bf,
+                  dslx::BytecodeEmitter::Emit(import_data, tm->type_info, f,
+                                              /*caller_bindings=*/{}));
+              dslx_results.emplace();
+              for (const std::vector<dslx::InterpValue>& unsigned_args :
+                   sample.args_batch()) {
+                XLS_ASSIGN_OR_RETURN(
+                    std::vector<dslx::InterpValue> args,
+                    dslx::SignConvertArgs(*fn_type, unsigned_args));
+                XLS_ASSIGN_OR_RETURN(dslx::InterpValue result,
+                                     dslx::BytecodeInterpreter::Interpret(
+                                         import_data, bf.get(), args));
+                XLS_ASSIGN_OR_RETURN(dslx_results->emplace_back(),
+                                     result.ConvertToIr());
+              }
+              return ValuesToIrText(*dslx_results);
+            }));
+    if (!dslx_results.has_value()) {
+      XLS_ASSIGN_OR_RETURN(dslx_results, ParseValues(results_text));
+    }
+    timing_.set_interpret_dslx_ns(ElapsedNs(start));
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(run_dir / "sample.x.results", results_text));
+    XLS_RETURN_IF_ERROR(
+        executor->Compare("interpreted DSLX", *dslx_results));
+  }
+
+  if (!options.convert_to_ir()) {
+    return std::nullopt;
+  }
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(
+      std::string ir_text,
+      RunStage(
+          "convert_ir",
+          {sample.input_text(), absl::StrJoin(converter_arg_list, " ")},
+          run_dir, /*side_outputs=*/{},
+          [&]() -> absl::StatusOr<std::string> {
+            XLS_ASSIGN_OR_RETURN(dslx::TypecheckedModule * tm, typecheck());
+            dslx::ImportData* import_data = &import_data_.value();
+            if (converter_args.options.warnings_as_errors &&
+                !tm->warnings.warnings().empty()) {
+              return absl::InvalidArgumentError(
+                  "Warnings encountered and warnings-as-errors set.");
+            }
+            Package package(kSampleModuleName);
+            if (converter_args.top.has_value()) {
+              XLS_RETURN_IF_ERROR(dslx::ConvertOneFunctionIntoPackage(
+                  tm->module, *converter_args.top, import_data,
+                  /*parametric_env=*/nullptr, converter_args.options,
+                  &package));
+            } else {
+              XLS_RETURN_IF_ERROR(dslx::ConvertModuleIntoPackage(
+                  tm->module, import_data, converter_args.options,
+                  /*traverse_tests=*/false, &package));
+            }
+            return package.DumpIr();
+          }));
+  timing_.set_convert_ir_ns(ElapsedNs(start));
+  return ir_text;
+}
+
+absl::Status InProcessSampleRunner::RunFunction(
+    const Sample& sample, const std::filesystem::path& run_dir) {
+  const SampleOptions& options = sample.options();
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      run_dir / (options.input_is_dslx() ? "sample.x" : "sample.ir"),
+      sample.input_text()));
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(run_dir / "options.json", options.ToJsonText()));
+  const ArgsBatch& args_batch = sample.args_batch();
+  bool has_args = !args_batch.empty();
+  std::string args_text = ArgsBatchToText(args_batch);
+  if (has_args) {
+    XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "args.txt", args_text));
+  }
+  // The arguments are converted to IR values once and shared by all the
+  // evaluations of the IR.
+  XLS_ASSIGN_OR_RETURN(std::vector<std::vector<Value>> ir_args_batch,
+                       ArgsBatchToIrValues(args_batch));
+
+  // Results are compared as each stage produces them, so a sample stops at
+  // the first mismatch rather than running its remaining stages.
+  DifferentialExecutor executor(ir_args_batch);
+  std::string ir_text;
+  if (options.input_is_dslx()) {
+    XLS_ASSIGN_OR_RETURN(std::optional<std::string> converted,
+                         RunDslx(sample, run_dir, &executor));
+    if (!converted.has_value()) {
+      return absl::OkStatus();
+    }
+    ir_text = *std::move(converted);
+    XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "sample.ir", ir_text));
+  } else {
+    ir_text = sample.input_text();
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text));
+
+  // Evaluates the top function of `p` (whose text is `p_text`), recording the
+  // results in the run directory under the given file name and comparing
+  // them as "evaluated <description> (JIT|interpreter)".
+  auto evaluate = [&](Package* p, const std::string& p_text,
+                      std::string_view ir_filename,
+                      std::string_view description, bool use_jit,
+                      int64_t* elapsed_ns) -> absl::Status {
+    absl::Time start = absl::Now();
+    std::string backend = absl::StrCat("evaluated ", description, " (",
+                                       use_jit ? "JIT" : "interpreter", ")");
+    std::optional<std::vector<Value>> values;
+    bool compared = false;
+    XLS_ASSIGN_OR_RETURN(
+        std::string results_text,
+        RunStage(
+            use_jit ? "evaluate_ir_jit" : "interpret_ir", {p_text, args_text},
+            run_dir, /*side_outputs=*/{},
+            [&]() -> absl::StatusOr<std::string> {
+              XLS_ASSIGN_OR_RETURN(Function * f, p->GetTopAsFunction());
+              if (use_jit) {
+                XLS_ASSIGN_OR_RETURN(
+                    std::unique_ptr<FunctionJit> jit,
+                    FunctionJit::Create(f, /*opt_level=*/3, jit_object_cache_));
+                XLS_ASSIGN_OR_RETURN(values, jit->RunBatched(ir_args_batch));
+                return ValuesToIrText(*values);
+              }
+              // The interpreter evaluates one element at a time, so compare
+              // each result as it is produced. A mismatch fails the stage,
+              // leaving the partial results out of the stage cache.
+              values.emplace();
+              compared = true;
+              XLS_RETURN_IF_ERROR(executor.Run(
+                  backend, [&](int64_t i) -> absl::StatusOr<Value> {
+                    XLS_ASSIGN_OR_RETURN(
+                        Value result, DropInterpreterEvents(InterpretFunction(
+                                          f, ir_args_batch[i])));
+                    values->push_back(result);
+                    return result;
+                  }));
+              return ValuesToIrText(*values);
+            }));
+    *elapsed_ns = ElapsedNs(start);
+    XLS_RETURN_IF_ERROR(SetFileContents(
+        run_dir / absl::StrCat(ir_filename, ".results"), results_text));
+    if (compared) {
+      return absl::OkStatus();
+    }
+    if (!values.has_value()) {
+      XLS_ASSIGN_OR_RETURN(values, ParseValues(results_text));
+    }
+    return executor.Compare(backend, *values);
+  };
+
+  int64_t elapsed_ns = 0;
+  if (has_args) {
+    // Unconditionally evaluate with the interpreter even if using the JIT.
+    // This exercises the interpreter and serves as a reference.
+    XLS_RETURN_IF_ERROR(evaluate(package.get(), ir_text, "sample.ir",
+                                 "unopt IR", /*use_jit=*/false, &elapsed_ns));
+    timing_.set_unoptimized_interpret_ir_ns(elapsed_ns);
+    if (options.use_jit()) {
+      XLS_RETURN_IF_ERROR(evaluate(package.get(), ir_text, "sample.ir",
+                                   "unopt IR", /*use_jit=*/true,
+                                   &elapsed_ns));
+      timing_.set_unoptimized_jit_ns(elapsed_ns);
+    }
+  }
+
+  if (options.optimize_ir()) {
+    absl::Time start = absl::Now();
+    tools::OptOptions opt_options;
+    opt_options.inline_procs = false;
+    // Records which passes changed the IR, e.g. for coverage feedback.
+    opt_options.pass_metrics_path =
+        (run_dir / "sample.opt.pass_metrics.textproto").string();
+    XLS_ASSIGN_OR_RETURN(
+        std::string opt_ir,
+        RunStage("optimize", {ir_text}, run_dir,
+                 {"sample.opt.pass_metrics.textproto"},
+                 [&]() -> absl::StatusOr<std::string> {
+                   return tools::OptimizeIrForTop(ir_text, opt_options);
+                 }));
+    timing_.set_optimize_ns(ElapsedNs(start));
+    XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "sample.opt.ir", opt_ir));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> opt_package,
+                         Parser::ParsePackage(opt_ir));
+
+    if (has_args) {
+      if (options.use_jit()) {
+        XLS_RETURN_IF_ERROR(evaluate(opt_package.get(), opt_ir,
+                                     "sample.opt.ir", "opt IR",
+                                     /*use_jit=*/true, &elapsed_ns));
+        timing_.set_optimized_jit_ns(elapsed_ns);
+      }
+      XLS_RETURN_IF_ERROR(evaluate(opt_package.get(), opt_ir,
+                                   "sample.opt.ir", "opt IR",
+                                   /*use_jit=*/false, &elapsed_ns));
+      timing_.set_optimized_interpret_ir_ns(elapsed_ns);
+    }
+
+    if (options.codegen()) {
+      start = absl::Now();
+      std::vector<std::string> codegen_args = {
+          "--output_signature_path=module_sig.textproto",
+          "--delay_model=unit"};
+      if (options.codegen_args().has_value()) {
+        codegen_args.insert(codegen_args.end(),
+                            options.codegen_args()->begin(),
+                            options.codegen_args()->end());
+      }
+      codegen_args.push_back("sample.opt.ir");
+      constexpr std::string_view kCodegenMain = "xls/tools/codegen_main";
+      XLS_ASSIGN_OR_RETURN(std::string codegen_build_id,
+                           ToolBuildId(kCodegenMain));
+      XLS_ASSIGN_OR_RETURN(
+          std::string verilog,
+          RunStage("codegen",
+                   {opt_ir, absl::StrJoin(codegen_args, " "),
+                    codegen_build_id},
+                   run_dir, {"module_sig.textproto"},
+                   [&]() -> absl::StatusOr<std::string> {
+                     return RunTool(kCodegenMain, codegen_args, run_dir,
+                                    options);
+                   }));
+      std::string verilog_filename =
+          options.use_system_verilog() ? "sample.sv" : "sample.v";
+      XLS_RETURN_IF_ERROR(
+          SetFileContents(run_dir / verilog_filename, verilog));
+      timing_.set_codegen_ns(ElapsedNs(start));
+
+      if (options.simulate()) {
+        XLS_RET_CHECK(has_args);
+        start = absl::Now();
+        std::vector<std::string> simulate_args = {
+            "--signature_file=module_sig.textproto", "--args_file=args.txt"};
+        if (options.simulator().has_value()) {
+          simulate_args.push_back(
+              absl::StrCat("--verilog_simulator=", *options.simulator()));
+        }
+        simulate_args.push_back(verilog_filename);
+        constexpr std::string_view kSimulateModuleMain =
+            "xls/tools/simulate_module_main";
+        XLS_ASSIGN_OR_RETURN(std::string simulate_build_id,
+                             ToolBuildId(kSimulateModuleMain));
+        XLS_ASSIGN_OR_RETURN(std::string signature,
+                             GetFileContents(run_dir / "module_sig.textproto"));
+        XLS_ASSIGN_OR_RETURN(
+            std::string results_text,
+            RunStage("simulate",
+                     {verilog, signature, args_text,
+                      absl::StrJoin(simulate_args, " "), simulate_build_id},
+                     run_dir, /*side_outputs=*/{},
+                     [&]() -> absl::StatusOr<std::string> {
+                       return RunTool(kSimulateModuleMain, simulate_args,
+                                      run_dir, options);
+                     }));
+        XLS_RETURN_IF_ERROR(SetFileContents(
+            run_dir / absl::StrCat(verilog_filename, ".results"),
+            results_text));
+        timing_.set_simulate_ns(ElapsedNs(start));
+        XLS_ASSIGN_OR_RETURN(std::vector<Value> simulated,
+                             ParseValues(results_text));
+        XLS_RETURN_IF_ERROR(executor.Compare("simulated", simulated));
+      }
+    }
+  }
+
+  return absl::OkStatus();
+}
+
 }  // namespace xls
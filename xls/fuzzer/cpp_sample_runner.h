@@ -15,12 +15,26 @@
 #ifndef XLS_FUZZER_CPP_SAMPLE_RUNNER_H_
 #define XLS_FUZZER_CPP_SAMPLE_RUNNER_H_
 
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
+#include "xls/fuzzer/differential_executor.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_stage_cache.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_object_cache.h"
 
 namespace xls {
 
@@ -42,6 +56,77 @@ absl::Status CompareResultsFunction(
         results,
     const ArgsBatch* maybe_args_batch);
 
+// Runs fuzzer samples with a function as the top within the calling process.
+// Where sample_runner.py launches a tool per stage, this calls the DSLX
+// frontend and interpreter, the IR converter, the optimizer, the IR interpreter
+// and the JIT as libraries. Modules imported by samples (e.g., the standard
+// library) are parsed and typechecked once and shared by all samples run by
+// the same runner, as is the JIT object cache, if any. Codegen and simulation
+// are configured by tool flags (SampleOptions::codegen_args) and so still run
+// codegen_main and simulate_module_main as subprocesses.
+//
+// As with sample_runner.py, the sample and the results of each stage are
+// written to the run directory so failures can be reproduced and minimized.
+// The per-pass metrics of the optimizer are written there too, as
+// "sample.opt.pass_metrics.textproto".
+//
+// If given a stage cache, the outputs of the stages are looked up there before
+// running them (and stored there afterwards), so re-running a sample, e.g. a
+// crasher, only runs the stages following the last one whose inputs or tools
+// changed. Stages found in the cache still write their outputs to the run
+// directory.
+//
+// Not thread-safe: use one runner per thread.
+class InProcessSampleRunner {
+ public:
+  explicit InProcessSampleRunner(
+      std::string dslx_stdlib_path = xls::kDefaultDslxStdlibPath,
+      JitObjectCache* jit_object_cache = nullptr,
+      SampleStageCache* stage_cache = nullptr);
+
+  // Runs the given sample in `run_dir`, which must exist. Returns an error if
+  // a stage fails or the results of the stages differ; the message of the
+  // latter starts with "SampleError:" as CompareResultsFunction's does. The
+  // results of each stage are compared in memory as they are produced (see
+  // DifferentialExecutor), and the run stops at the first mismatch.
+  absl::Status Run(const Sample& sample, const std::filesystem::path& run_dir);
+
+  // Returns the time taken by each stage of the last run.
+  const fuzzer::SampleTimingProto& timing() const { return timing_; }
+
+ private:
+  absl::Status RunFunction(const Sample& sample,
+                           const std::filesystem::path& run_dir);
+
+  // Interprets the DSLX of the given sample, comparing the results (if any)
+  // with `executor`, and converts it to IR. Returns the IR text, or nullopt if
+  // the sample is not to be converted.
+  absl::StatusOr<std::optional<std::string>> RunDslx(
+      const Sample& sample, const std::filesystem::path& run_dir,
+      DifferentialExecutor* executor);
+
+  // Returns the output of the stage `stage` run on `inputs` by `run`. With a
+  // stage cache, the output (and the files `side_outputs` the stage writes to
+  // `run_dir`) are taken from the cache if present, and otherwise stored there
+  // once the stage succeeds.
+  absl::StatusOr<std::string> RunStage(
+      std::string_view stage, absl::Span<const std::string> inputs,
+      const std::filesystem::path& run_dir,
+      absl::Span<const std::string> side_outputs,
+      absl::FunctionRef<absl::StatusOr<std::string>()> run);
+
+  // Returns the build ID of the tool at the given runfile path, to be keyed
+  // into the cached outputs of stages it runs, or an empty string if there is
+  // no stage cache.
+  absl::StatusOr<std::string> ToolBuildId(std::string_view tool_path);
+
+  std::string dslx_stdlib_path_;
+  JitObjectCache* jit_object_cache_;
+  SampleStageCache* stage_cache_;
+  std::optional<dslx::ImportData> import_data_;
+  fuzzer::SampleTimingProto timing_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_FUZZER_CPP_SAMPLE_RUNNER_H_
@@ -0,0 +1,159 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/cpp_sample_runner.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_stage_cache.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::_;
+using ::testing::HasSubstr;
+
+constexpr char kAddSample[] = R"(fn main(x: u8, y: u8) -> u8 { x + y })";
+
+SampleOptions MakeOptions() {
+  SampleOptions options;
+  options.set_ir_converter_args({"--top=main"});
+  return options;
+}
+
+ArgsBatch MakeArgsBatch() {
+  return {{dslx::InterpValue::MakeUBits(8, 1),
+           dslx::InterpValue::MakeUBits(8, 2)},
+          {dslx::InterpValue::MakeUBits(8, 200),
+           dslx::InterpValue::MakeUBits(8, 100)}};
+}
+
+TEST(InProcessSampleRunnerTest, RunsDslxSamples) {
+  InProcessSampleRunner runner;
+  // The second sample replaces the first's module in the shared import data.
+  for (int64_t i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(TempDirectory run_dir, TempDirectory::Create());
+    Sample sample(kAddSample, MakeOptions(), MakeArgsBatch());
+    XLS_ASSERT_OK(runner.Run(sample, run_dir.path()));
+    EXPECT_THAT(GetFileContents(run_dir.path() / "sample.x.results"),
+                IsOkAndHolds("bits[8]:0x3\nbits[8]:0x2c"));
+    EXPECT_THAT(GetFileContents(run_dir.path() / "sample.opt.ir.results"),
+                IsOkAndHolds("bits[8]:0x3\nbits[8]:0x2c"));
+    EXPECT_GT(runner.timing().optimize_ns(), 0);
+  }
+}
+
+TEST(InProcessSampleRunnerTest, RunsIrSample) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory run_dir, TempDirectory::Create());
+  SampleOptions options = MakeOptions().ReplaceInputIsDslx(false);
+  Sample sample(R"(package sample
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  ret sub.3: bits[8] = sub(x, y, id=3)
+}
+)",
+                options, MakeArgsBatch());
+  InProcessSampleRunner runner;
+  XLS_ASSERT_OK(runner.Run(sample, run_dir.path()));
+  EXPECT_THAT(GetFileContents(run_dir.path() / "sample.ir.results"),
+              IsOkAndHolds("bits[8]:0xff\nbits[8]:0x64"));
+}
+
+TEST(InProcessSampleRunnerTest, TypeErrorThenValidSample) {
+  InProcessSampleRunner runner;
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory run_dir, TempDirectory::Create());
+  Sample bad_sample(R"(fn main(x: u8, y: u8) -> u8 { x ++ y })",
+                    MakeOptions(), MakeArgsBatch());
+  EXPECT_THAT(runner.Run(bad_sample, run_dir.path()),
+              StatusIs(_, HasSubstr("run dir")));
+  EXPECT_TRUE(FileExists(run_dir.path() / "exception.txt").ok());
+
+  Sample sample(kAddSample, MakeOptions(), MakeArgsBatch());
+  XLS_EXPECT_OK(runner.Run(sample, run_dir.path()));
+}
+
+TEST(InProcessSampleRunnerTest, RerunsFromStageCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory cache_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SampleStageCache> cache,
+      SampleStageCache::Create(cache_dir.path(), /*build_id=*/"test"));
+  InProcessSampleRunner runner(xls::kDefaultDslxStdlibPath,
+                               /*jit_object_cache=*/nullptr, cache.get());
+  Sample sample(kAddSample, MakeOptions(), MakeArgsBatch());
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory first_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(runner.Run(sample, first_dir.path()));
+  EXPECT_EQ(cache->hit_count(), 0);
+  int64_t miss_count = cache->miss_count();
+  EXPECT_GT(miss_count, 0);
+
+  // Every stage of the re-run is found in the cache, and still leaves its
+  // outputs in the run directory.
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory second_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(runner.Run(sample, second_dir.path()));
+  EXPECT_EQ(cache->miss_count(), miss_count);
+  EXPECT_GT(cache->hit_count(), 0);
+  for (std::string_view file :
+       {"sample.ir", "sample.opt.ir", "sample.x.results",
+        "sample.opt.ir.results", "sample.opt.pass_metrics.textproto"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::string expected,
+                             GetFileContents(first_dir.path() / file));
+    EXPECT_THAT(GetFileContents(second_dir.path() / file),
+                IsOkAndHolds(expected))
+        << file;
+  }
+
+  // A changed sample misses the cache.
+  Sample changed(R"(fn main(x: u8, y: u8) -> u8 { x - y })", MakeOptions(),
+                 MakeArgsBatch());
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory third_dir, TempDirectory::Create());
+  XLS_ASSERT_OK(runner.Run(changed, third_dir.path()));
+  EXPECT_GT(cache->miss_count(), miss_count);
+}
+
+TEST(InProcessSampleRunnerTest, UnsupportedConverterArgument) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory run_dir, TempDirectory::Create());
+  SampleOptions options;
+  options.set_ir_converter_args({"--top=main", "--package_name=foo"});
+  Sample sample(kAddSample, options, MakeArgsBatch());
+  InProcessSampleRunner runner;
+  EXPECT_THAT(runner.Run(sample, run_dir.path()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("--package_name=foo")));
+}
+
+TEST(InProcessSampleRunnerTest, ProcSampleUnimplemented) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory run_dir, TempDirectory::Create());
+  SampleOptions options = MakeOptions();
+  options.set_top_type(TopType::kProc);
+  Sample sample(kAddSample, options, MakeArgsBatch());
+  InProcessSampleRunner runner;
+  EXPECT_THAT(runner.Run(sample, run_dir.path()),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+}  // namespace
+}  // namespace xls
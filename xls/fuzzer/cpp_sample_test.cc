@@ -0,0 +1,87 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/interp_value.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/bits.h"
+
+namespace xls {
+namespace {
+
+using dslx::InterpValue;
+using status_testing::StatusIs;
+
+std::vector<std::vector<InterpValue>> MakeArgsBatch() {
+  std::vector<std::vector<InterpValue>> args_batch;
+  for (int64_t i = 0; i < 3; ++i) {
+    args_batch.push_back(
+        {InterpValue::MakeUBits(7, i), InterpValue::MakeSBits(32, -i),
+         InterpValue::MakeTuple(
+             {InterpValue::MakeUBits(0, 0),
+              InterpValue::MakeArray({InterpValue::MakeUBits(3, i),
+                                      InterpValue::MakeUBits(3, 7 - i)})
+                  .value()}),
+         InterpValue::MakeBits(/*is_signed=*/false,
+                               Bits::PowerOfTwo(/*set_bit_index=*/97 + i,
+                                                /*bit_count=*/100))});
+  }
+  return args_batch;
+}
+
+TEST(CppSampleTest, ArgsBatchBinaryRoundTrip) {
+  std::vector<std::vector<InterpValue>> args_batch = MakeArgsBatch();
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary, ArgsBatchToBinary(args_batch));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<InterpValue>> parsed,
+                           ParseArgsBatchBinary(binary));
+  ASSERT_EQ(parsed.size(), args_batch.size());
+  for (int64_t i = 0; i < args_batch.size(); ++i) {
+    ASSERT_EQ(parsed[i].size(), args_batch[i].size());
+    for (int64_t j = 0; j < args_batch[i].size(); ++j) {
+      EXPECT_TRUE(parsed[i][j].Eq(args_batch[i][j]))
+          << parsed[i][j].ToString() << " vs " << args_batch[i][j].ToString();
+    }
+    EXPECT_TRUE(parsed[i][1].IsSBits());
+  }
+  // The binary form renders the same text as the original batch.
+  EXPECT_EQ(ArgsBatchToText(parsed), ArgsBatchToText(args_batch));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string empty, ArgsBatchToBinary({}));
+  EXPECT_THAT(ParseArgsBatchBinary(empty),
+              status_testing::IsOkAndHolds(testing::IsEmpty()));
+}
+
+TEST(CppSampleTest, ArgsBatchBinaryErrors) {
+  std::vector<std::vector<InterpValue>> args_batch = MakeArgsBatch();
+  args_batch[1][0] = InterpValue::MakeUBits(8, 1);
+  EXPECT_THAT(ArgsBatchToBinary(args_batch),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           ArgsBatchToBinary(MakeArgsBatch()));
+  EXPECT_THAT(ParseArgsBatchBinary(binary.substr(0, binary.size() - 1)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ParseArgsBatchBinary(binary + "x"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ParseArgsBatchBinary("bits[8]:0x1"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,86 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/differential_executor.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+absl::Status DifferentialExecutor::Run(
+    std::string_view backend,
+    absl::FunctionRef<absl::StatusOr<Value>(int64_t)> evaluate) {
+  XLS_RETURN_IF_ERROR(status_);
+  backends_.push_back(std::string(backend));
+  bool is_reference = backends_.size() == 1;
+  for (int64_t i = 0; i < args_batch_.size(); ++i) {
+    absl::StatusOr<Value> result = evaluate(i);
+    if (!result.ok()) {
+      // The reference may be incomplete, so nothing can be compared anymore.
+      status_ = result.status();
+      return status_;
+    }
+    if (is_reference) {
+      reference_.push_back(*std::move(result));
+      continue;
+    }
+    status_ = CompareElement(i, *result);
+    XLS_RETURN_IF_ERROR(status_);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DifferentialExecutor::Compare(std::string_view backend,
+                                           absl::Span<const Value> results) {
+  XLS_RETURN_IF_ERROR(status_);
+  if (results.size() != args_batch_.size()) {
+    status_ = absl::InvalidArgumentError(absl::StrFormat(
+        "SampleError: Results for %s has %d values, argument batch has %d "
+        "values",
+        backend, results.size(), args_batch_.size()));
+    return status_;
+  }
+  return Run(backend, [&](int64_t i) -> absl::StatusOr<Value> {
+    return results[i];
+  });
+}
+
+absl::Status DifferentialExecutor::CompareElement(int64_t index,
+                                                  const Value& result) const {
+  const Value& reference = reference_[index];
+  if (result == reference) {
+    return absl::OkStatus();
+  }
+  // All earlier backends agreed with the reference on this element, or the
+  // comparison would have stopped there.
+  std::string args = absl::StrJoin(
+      args_batch_[index], "; ", [](std::string* out, const Value& v) {
+        absl::StrAppend(out, v.ToString(FormatPreference::kHex));
+      });
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "SampleError: Result miscompare for sample %d:\nargs: %s\n%s =\n   "
+      "%s\n%s =\n   %s",
+      index, args,
+      absl::StrJoin(absl::MakeConstSpan(backends_).first(backends_.size() - 1),
+                    ", "),
+      reference.ToString(FormatPreference::kHex), backends_.back(),
+      result.ToString(FormatPreference::kHex)));
+}
+
+}  // namespace xls
@@ -0,0 +1,78 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_DIFFERENTIAL_EXECUTOR_H_
+#define XLS_FUZZER_DIFFERENTIAL_EXECUTOR_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Compares in memory the results of evaluating a sample with several backends
+// (e.g. the DSLX interpreter, the IR interpreter, the JIT and the simulated
+// RTL) on the same batch of arguments. The first backend to report results
+// provides the reference; the results of each later backend are compared with
+// it as they are produced, so a backend evaluating the batch element by element
+// stops at the first mismatch instead of evaluating the rest of the batch.
+//
+// A mismatch is reported as an error whose message starts with "SampleError:"
+// and gives the element of the batch, its arguments and the two results, as
+// CompareResultsFunction's messages do. After an error the executor keeps
+// returning it, so the remaining backends of a failed sample need not run.
+class DifferentialExecutor {
+ public:
+  // `args_batch` holds the arguments of each element of the batch; it must
+  // outlive the executor.
+  explicit DifferentialExecutor(
+      absl::Span<const std::vector<Value>> args_batch)
+      : args_batch_(args_batch) {}
+
+  // Evaluates `backend` on each element of the batch in order, `evaluate(i)`
+  // returning the result of the i-th element, and compares each result with
+  // the reference as it is produced. Returns the first mismatch or evaluation
+  // error.
+  absl::Status Run(std::string_view backend,
+                   absl::FunctionRef<absl::StatusOr<Value>(int64_t)> evaluate);
+
+  // Compares the results of `backend` on the whole batch, for backends which
+  // evaluate the batch at once.
+  absl::Status Compare(std::string_view backend,
+                       absl::Span<const Value> results);
+
+  // Returns the backends compared so far, in order.
+  absl::Span<const std::string> backends() const { return backends_; }
+
+ private:
+  // Compares the result of the last backend on the element `index` with the
+  // reference.
+  absl::Status CompareElement(int64_t index, const Value& result) const;
+
+  absl::Span<const std::vector<Value>> args_batch_;
+  std::vector<std::string> backends_;
+  std::vector<Value> reference_;
+  absl::Status status_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_DIFFERENTIAL_EXECUTOR_H_
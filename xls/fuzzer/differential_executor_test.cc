@@ -0,0 +1,106 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/differential_executor.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::AllOf;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+std::vector<std::vector<Value>> MakeArgsBatch(int64_t count) {
+  std::vector<std::vector<Value>> args_batch;
+  for (int64_t i = 0; i < count; ++i) {
+    args_batch.push_back({Value(UBits(i, 8))});
+  }
+  return args_batch;
+}
+
+TEST(DifferentialExecutorTest, MatchingBackends) {
+  std::vector<std::vector<Value>> args_batch = MakeArgsBatch(4);
+  DifferentialExecutor executor(args_batch);
+  auto double_arg = [&](int64_t i) -> absl::StatusOr<Value> {
+    return Value(UBits(2 * i, 8));
+  };
+  XLS_EXPECT_OK(executor.Run("interpreter", double_arg));
+  XLS_EXPECT_OK(executor.Run("jit", double_arg));
+  XLS_EXPECT_OK(executor.Compare(
+      "simulated", {Value(UBits(0, 8)), Value(UBits(2, 8)), Value(UBits(4, 8)),
+                    Value(UBits(6, 8))}));
+  EXPECT_THAT(executor.backends(),
+              ElementsAre("interpreter", "jit", "simulated"));
+}
+
+TEST(DifferentialExecutorTest, StopsAtFirstMismatch) {
+  std::vector<std::vector<Value>> args_batch = MakeArgsBatch(8);
+  DifferentialExecutor executor(args_batch);
+  XLS_ASSERT_OK(executor.Run("a", [&](int64_t i) -> absl::StatusOr<Value> {
+    return Value(UBits(i, 8));
+  }));
+  XLS_ASSERT_OK(executor.Run("b", [&](int64_t i) -> absl::StatusOr<Value> {
+    return Value(UBits(i, 8));
+  }));
+  int64_t evaluated = 0;
+  EXPECT_THAT(
+      executor.Run("c",
+                   [&](int64_t i) -> absl::StatusOr<Value> {
+                     ++evaluated;
+                     return Value(UBits(i == 2 ? 42 : i, 8));
+                   }),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               AllOf(HasSubstr("SampleError: Result miscompare for sample 2"),
+                     HasSubstr("args: bits[8]:0x2"), HasSubstr("a, b ="),
+                     HasSubstr("c =\n   bits[8]:0x2a"))));
+  EXPECT_EQ(evaluated, 3);
+
+  // The executor keeps failing once a mismatch was found.
+  EXPECT_THAT(executor.Compare("d", {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Result miscompare")));
+}
+
+TEST(DifferentialExecutorTest, WrongResultCount) {
+  std::vector<std::vector<Value>> args_batch = MakeArgsBatch(2);
+  DifferentialExecutor executor(args_batch);
+  EXPECT_THAT(executor.Compare("a", {Value(UBits(0, 8))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("argument batch has 2 values")));
+}
+
+TEST(DifferentialExecutorTest, EvaluationErrorsArePropagated) {
+  std::vector<std::vector<Value>> args_batch = MakeArgsBatch(2);
+  DifferentialExecutor executor(args_batch);
+  EXPECT_THAT(executor.Run("a",
+                           [&](int64_t i) -> absl::StatusOr<Value> {
+                             return absl::InternalError("boom");
+                           }),
+              StatusIs(absl::StatusCode::kInternal, "boom"));
+  EXPECT_THAT(executor.Compare("b", {Value(UBits(0, 8)), Value(UBits(1, 8))}),
+              StatusIs(absl::StatusCode::kInternal, "boom"));
+}
+
+}  // namespace
+}  // namespace xls
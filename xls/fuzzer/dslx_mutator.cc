@@ -14,9 +14,22 @@
 
 #include "xls/fuzzer/dslx_mutator.h"
 
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/random/random.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/dslx/create_import_data.h"
 #include "xls/dslx/frontend/scanner.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
 
 using absl::InvalidArgumentError;
 using absl::StatusOr;
@@ -30,6 +43,83 @@ std::string TokensToString(absl::Span<const Token> tokens) {
   }
   return result;
 }
+
+// Name of the module of minimization candidates.
+constexpr std::string_view kCandidateModuleName = "candidate";
+
+// Parses and typechecks minimization candidates. Imported modules stay
+// typechecked from one candidate to the next.
+class CandidateTypechecker {
+ public:
+  explicit CandidateTypechecker(std::string dslx_stdlib_path)
+      : dslx_stdlib_path_(std::move(dslx_stdlib_path)) {}
+
+  bool Typechecks(std::string_view dslx) {
+    if (!import_data_.has_value()) {
+      import_data_.emplace(CreateImportData(dslx_stdlib_path_,
+                                            /*additional_search_paths=*/{}));
+    }
+    absl::StatusOr<TypecheckedModule> checked = ParseAndTypecheck(
+        dslx, absl::StrCat(kCandidateModuleName, ".x"), kCandidateModuleName,
+        &import_data_.value());
+    if (!checked.ok()) {
+      // A module which failed to typecheck may have left partial state
+      // behind, so start over with fresh import data.
+      import_data_.reset();
+      return false;
+    }
+    absl::Status removed = import_data_->Remove(
+        ImportTokens::FromString(kCandidateModuleName).value());
+    if (!removed.ok()) {
+      XLS_LOG(WARNING) << "Dropping import data: " << removed;
+      import_data_.reset();
+    }
+    return true;
+  }
+
+ private:
+  std::string dslx_stdlib_path_;
+  std::optional<ImportData> import_data_;
+};
+
+// Returns `tokens` without the tokens at the given indices.
+std::vector<Token> RemoveTokens(absl::Span<const Token> tokens,
+                                absl::Span<const int64_t> indices) {
+  std::vector<Token> result;
+  result.reserve(tokens.size() - indices.size());
+  auto next = indices.begin();
+  for (int64_t i = 0; i < tokens.size(); ++i) {
+    if (next != indices.end() && *next == i) {
+      ++next;
+      continue;
+    }
+    result.push_back(tokens[i]);
+  }
+  return result;
+}
+
+// Tests the given candidates in parallel on the shared thread pool, returning
+// the index of the first one which passes, if any.
+absl::StatusOr<std::optional<int64_t>> TestCandidates(
+    absl::Span<const std::vector<Token>> candidates, DslxCandidateTest test,
+    absl::Span<std::optional<CandidateTypechecker>> typecheckers) {
+  std::vector<absl::StatusOr<bool>> results(candidates.size());
+  ParallelFor(0, candidates.size(), [&](int64_t i) {
+    std::string text = TokensToString(candidates[i]);
+    if (typecheckers[i].has_value() && !typecheckers[i]->Typechecks(text)) {
+      results[i] = false;
+      return;
+    }
+    results[i] = test(text, i);
+  });
+  for (int64_t i = 0; i < results.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(bool passed, results[i]);
+    if (passed) {
+      return i;
+    }
+  }
+  return std::nullopt;
+}
 }  // namespace
 
 StatusOr<std::string> RemoveDslxToken(std::string_view dslx,
@@ -46,4 +136,67 @@ StatusOr<std::string> RemoveDslxToken(std::string_view dslx,
   return TokensToString(tokens);
 }
 
+StatusOr<std::string> MinimizeDslx(std::string_view dslx,
+                                   DslxCandidateTest test,
+                                   const DslxMinimizerOptions& options) {
+  XLS_RET_CHECK_GE(options.parallelism, 1);
+  Scanner scan("x.x", std::string(dslx),
+               /*include_whitespace_and_comments=*/true);
+  XLS_ASSIGN_OR_RETURN(std::vector<Token> tokens, scan.PopAll());
+  std::vector<std::optional<CandidateTypechecker>> typecheckers(
+      options.parallelism);
+  if (options.dslx_stdlib_path.has_value()) {
+    for (std::optional<CandidateTypechecker>& typechecker : typecheckers) {
+      typechecker.emplace(*options.dslx_stdlib_path);
+    }
+  }
+
+  // Whitespace only separates the other tokens, so it is not removed on its
+  // own.
+  auto removable_indices = [&] {
+    std::vector<int64_t> indices;
+    for (int64_t i = 0; i < tokens.size(); ++i) {
+      if (tokens[i].kind() != TokenKind::kWhitespace) {
+        indices.push_back(i);
+      }
+    }
+    return indices;
+  };
+  std::vector<int64_t> removable = removable_indices();
+  int64_t chunk = removable.size();
+  while (chunk > 0) {
+    bool reduced = false;
+    for (int64_t start = 0; start < removable.size();) {
+      std::vector<int64_t> starts;
+      std::vector<std::vector<Token>> candidates;
+      for (int64_t begin = start; begin < removable.size() &&
+                                  candidates.size() < options.parallelism;
+           begin += chunk) {
+        int64_t end = std::min<int64_t>(begin + chunk, removable.size());
+        starts.push_back(begin);
+        candidates.push_back(
+            RemoveTokens(tokens, absl::MakeConstSpan(removable).subspan(
+                                     begin, end - begin)));
+      }
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<int64_t> passed,
+          TestCandidates(candidates, test, absl::MakeSpan(typecheckers)));
+      if (passed.has_value()) {
+        // The tokens following the removed run now start at the same index.
+        tokens = std::move(candidates[*passed]);
+        removable = removable_indices();
+        start = starts[*passed];
+        reduced = true;
+      } else {
+        start = starts.back() + chunk;
+      }
+    }
+    if (!reduced) {
+      chunk /= 2;
+    }
+    chunk = std::min<int64_t>(chunk, removable.size());
+  }
+  return TokensToString(tokens);
+}
+
 }  // namespace xls::dslx
@@ -15,6 +15,12 @@
 #ifndef XLS_FUZZER_DSLX_MUTATOR_H_
 #define XLS_FUZZER_DSLX_MUTATOR_H_
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/functional/function_ref.h"
 #include "absl/random/bit_gen_ref.h"
 #include "absl/status/statusor.h"
 
@@ -24,6 +30,36 @@ namespace xls::dslx {
 absl::StatusOr<std::string> RemoveDslxToken(std::string_view dslx,
                                             absl::BitGenRef gen);
 
+// Options for MinimizeDslx.
+struct DslxMinimizerOptions {
+  // The number of candidates tested concurrently.
+  int64_t parallelism = 1;
+
+  // If given, candidates which do not parse and typecheck (with the standard
+  // library at this path) are discarded without being tested. Each worker
+  // keeps the modules imported by the candidates typechecked across
+  // candidates, so only the candidate itself is typechecked each time.
+  std::optional<std::string> dslx_stdlib_path;
+};
+
+// Returns whether the candidate `dslx` still exhibits the failure being
+// minimized. Called concurrently for different candidates; `worker` (in
+// [0, parallelism)) identifies the calling worker so that tests may keep
+// per-worker state, e.g. a sample runner.
+using DslxCandidateTest =
+    absl::FunctionRef<absl::StatusOr<bool>(std::string_view dslx,
+                                           int64_t worker)>;
+
+// Minimizes `dslx`, for which `test` holds, by removing tokens while `test`
+// still holds. As in delta debugging, runs of tokens are removed, starting
+// with the whole text and halving the runs whenever no run can be removed.
+// The candidate removals are tested `options.parallelism` at a time; of each
+// batch the first candidate which passes is kept, so the result does not
+// depend on the parallelism.
+absl::StatusOr<std::string> MinimizeDslx(
+    std::string_view dslx, DslxCandidateTest test,
+    const DslxMinimizerOptions& options = DslxMinimizerOptions());
+
 }  // namespace xls::dslx
 
 #endif  // XLS_FUZZER_DSLX_MUTATOR_H_
@@ -19,6 +19,9 @@
 #include "absl/random/mock_distributions.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/common/status/matchers.h"
 
 using testing::_;
@@ -48,5 +51,64 @@ TEST(DslxMutator, RemoveDslxToken) {
               IsOkAndHolds("fn (x: u32, y: u32) -> u32 {"));
 }
 
+TEST(DslxMutator, MinimizeDslx) {
+  constexpr std::string_view kDslx = R"(
+fn helper(x: u32) -> u32 { x + u32:1 }
+fn main(a: u32, b: u32) -> u32 {
+  let foo = a * b;  // A comment.
+  helper(foo) ^ b
+}
+)";
+  for (int64_t parallelism : {1, 4}) {
+    DslxMinimizerOptions options;
+    options.parallelism = parallelism;
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::string minimized,
+        MinimizeDslx(
+            kDslx,
+            [](std::string_view dslx, int64_t worker) -> absl::StatusOr<bool> {
+              return absl::StrContains(dslx, "foo");
+            },
+            options));
+    EXPECT_EQ(absl::StripAsciiWhitespace(minimized), "foo");
+  }
+}
+
+TEST(DslxMutator, MinimizeDslxKeepsTypecheckingCandidates) {
+  constexpr std::string_view kDslx = R"(
+fn main(a: u32, b: u32) -> u32 {
+  let foo = a * b;
+  foo + a - b
+}
+)";
+  DslxMinimizerOptions options;
+  options.parallelism = 2;
+  options.dslx_stdlib_path = std::string(kDefaultDslxStdlibPath);
+  int64_t tested = 0;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string minimized,
+      MinimizeDslx(
+          kDslx,
+          [&](std::string_view dslx, int64_t worker) -> absl::StatusOr<bool> {
+            EXPECT_LT(worker, 2);
+            return absl::StrContains(dslx, "*");
+          },
+          options));
+  EXPECT_THAT(minimized, HasSubstr("a * b"));
+  EXPECT_THAT(minimized, HasSubstr("fn main"));
+  // The minimized function no longer uses `foo`.
+  EXPECT_FALSE(absl::StrContains(minimized, "foo + a - b"));
+}
+
+TEST(DslxMutator, MinimizeDslxPropagatesTestErrors) {
+  EXPECT_THAT(
+      MinimizeDslx("fn main() {}",
+                   [](std::string_view dslx,
+                      int64_t worker) -> absl::StatusOr<bool> {
+                     return absl::InternalError("boom");
+                   }),
+      StatusIs(absl::StatusCode::kInternal, "boom"));
+}
+
 }  // namespace
 }  // namespace xls::dslx
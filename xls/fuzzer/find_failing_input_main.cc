@@ -12,7 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -20,10 +27,13 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/random_value.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
@@ -37,64 +47,252 @@ interpreter. Prints the first input which results in a mismatch between the JIT
 and the interpreter. Returns a non-zer error code otherwise. Usage:
 
     find_failing_input_main --input-file=INPUT_FILE IR_FILE
+    find_failing_input_main --random_inputs=N IR_FILE
+
+Inputs are evaluated in batches across --worker_count threads. With
+--reference_ir_file the JIT-compiled function of IR_FILE is compared with the
+JIT-compiled top function of the reference IR (e.g. the unoptimized IR) instead
+of with the interpreter.
 )";
 
+ABSL_FLAG(int64_t, batch_size, 1024,
+          "Number of inputs evaluated at once by a worker.");
 ABSL_FLAG(std::string, input_file, "",
           "Inputs to JIT and interpreter, one set per line. Each line should "
           "contain a semicolon-separated set of typed values. Cannot be "
           "specified with --input.");
+ABSL_FLAG(int64_t, random_inputs, 0,
+          "Number of random inputs to try after the inputs of --input_file.");
+ABSL_FLAG(std::string, reference_ir_file, "",
+          "If given, compare the JIT-compiled function with the JIT-compiled "
+          "top function of this IR file rather than with the interpreter.");
+ABSL_FLAG(int64_t, seed, 0, "Seed of the random inputs.");
 ABSL_FLAG(
     std::string, test_only_inject_jit_result, "",
     "Test-only flag for injecting the result produced by the JIT. Used to "
     "force mismatches between JIT and interpreter for testing purposed.");
+ABSL_FLAG(int64_t, worker_count, 1,
+          "Number of threads evaluating inputs. If zero, use one thread per "
+          "hardware thread.");
 
 namespace xls {
 namespace {
 
+// Searches the inputs for the first one on which the JIT disagrees with the
+// reference (the interpreter, or the JIT of a reference function). Inputs are
+// numbered: the inputs of the input file come first, followed by
+// `random_input_count` random inputs. Workers claim batches of consecutive
+// inputs in order and stop as soon as some worker found a mismatch on an
+// earlier input, so the search reports the same input as a serial search.
+class FailingInputSearch {
+ public:
+  FailingInputSearch(Function* f, Function* reference,
+                     std::vector<std::vector<Value>> file_inputs,
+                     int64_t random_input_count, int64_t batch_size,
+                     int64_t seed, std::optional<Value> injected_jit_result)
+      : f_(f),
+        reference_(reference),
+        file_inputs_(std::move(file_inputs)),
+        input_count_(file_inputs_.size() + random_input_count),
+        batch_size_(std::max<int64_t>(batch_size, 1)),
+        seed_(seed),
+        injected_jit_result_(std::move(injected_jit_result)),
+        mismatch_index_(input_count_) {}
+
+  // Returns the first input resulting in a mismatch, if any.
+  absl::StatusOr<std::optional<std::vector<Value>>> Run(int64_t worker_count) {
+    // Workers run until a mismatch is found, so they get threads of their own
+    // rather than occupying the shared pool.
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int64_t i = 0; i < worker_count; ++i) {
+      threads.push_back(std::make_unique<Thread>([this]() {
+        absl::Status status = RunWorker();
+        if (!status.ok()) {
+          absl::MutexLock lock(&mutex_);
+          status_.Update(status);
+          // Stop the other workers.
+          mismatch_index_.store(-1);
+        }
+      }));
+    }
+    for (std::unique_ptr<Thread>& thread : threads) {
+      thread->Join();
+    }
+    XLS_RETURN_IF_ERROR(status_);
+    return mismatch_;
+  }
+
+ private:
+  // Returns the inputs of the given batch. Random inputs are generated from
+  // the seed and the batch index, so they do not depend on the number of
+  // workers.
+  std::vector<std::vector<Value>> BatchInputs(int64_t batch) const {
+    int64_t begin = batch * batch_size_;
+    int64_t end = std::min(begin + batch_size_, input_count_);
+    std::vector<std::vector<Value>> inputs;
+    inputs.reserve(end - begin);
+    std::seed_seq seed_seq({seed_, batch});
+    std::minstd_rand engine(seed_seq);
+    for (int64_t i = begin; i < end; ++i) {
+      if (i < file_inputs_.size()) {
+        inputs.push_back(file_inputs_[i]);
+      } else {
+        inputs.push_back(RandomFunctionArguments(f_, &engine));
+      }
+    }
+    return inputs;
+  }
+
+  // Evaluates `jit` on the inputs, all at once if possible.
+  static absl::StatusOr<std::vector<Value>> RunJit(
+      FunctionJit* jit, absl::Span<const std::vector<Value>> inputs) {
+    absl::StatusOr<std::vector<Value>> results = jit->RunBatched(inputs);
+    if (results.ok()) {
+      return results;
+    }
+    // Some input failed an assertion; the values are still compared (as the
+    // interpreter's are) so evaluate the inputs one at a time.
+    // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
+    // events once the JIT fully supports events (and we have decided how to
+    // handle event mismatches).
+    std::vector<Value> values;
+    for (const std::vector<Value>& args : inputs) {
+      XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result, jit->Run(args));
+      values.push_back(std::move(result.value));
+    }
+    return values;
+  }
+
+  absl::Status RunWorker() {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(f_));
+    std::unique_ptr<FunctionJit> reference_jit;
+    if (reference_ != nullptr) {
+      XLS_ASSIGN_OR_RETURN(reference_jit, FunctionJit::Create(reference_));
+    }
+    while (true) {
+      int64_t batch = next_batch_.fetch_add(1);
+      int64_t begin = batch * batch_size_;
+      if (begin >= mismatch_index_.load()) {
+        return absl::OkStatus();
+      }
+      std::vector<std::vector<Value>> inputs = BatchInputs(batch);
+      std::vector<Value> results;
+      if (injected_jit_result_.has_value()) {
+        results.assign(inputs.size(), *injected_jit_result_);
+      } else {
+        XLS_ASSIGN_OR_RETURN(results, RunJit(jit.get(), inputs));
+      }
+      std::vector<Value> reference_results;
+      if (reference_jit != nullptr) {
+        XLS_ASSIGN_OR_RETURN(reference_results,
+                             RunJit(reference_jit.get(), inputs));
+      }
+      for (int64_t i = 0; i < inputs.size(); ++i) {
+        if (begin + i >= mismatch_index_.load()) {
+          return absl::OkStatus();
+        }
+        Value expected;
+        if (reference_jit != nullptr) {
+          expected = reference_results[i];
+        } else {
+          XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> interpreter_result,
+                               InterpretFunction(f_, inputs[i]));
+          expected = std::move(interpreter_result.value);
+        }
+        if (results[i] != expected) {
+          RecordMismatch(begin + i, std::move(inputs[i]));
+          break;
+        }
+      }
+    }
+  }
+
+  void RecordMismatch(int64_t index, std::vector<Value> args) {
+    absl::MutexLock lock(&mutex_);
+    int64_t current = mismatch_index_.load();
+    if (current < 0 || index >= current) {
+      return;
+    }
+    mismatch_index_.store(index);
+    mismatch_ = std::move(args);
+  }
+
+  Function* f_;
+  Function* reference_;
+  std::vector<std::vector<Value>> file_inputs_;
+  int64_t input_count_;
+  int64_t batch_size_;
+  int64_t seed_;
+  std::optional<Value> injected_jit_result_;
+
+  std::atomic<int64_t> next_batch_ = 0;
+  // Index of the earliest mismatching input found so far (`input_count_` if
+  // none, -1 after an error). Only decreases.
+  std::atomic<int64_t> mismatch_index_;
+  absl::Mutex mutex_;
+  std::optional<std::vector<Value>> mismatch_ ABSL_GUARDED_BY(mutex_);
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
 absl::Status RealMain(std::string_view ir_path,
                       std::string_view inputs_path) {
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(std::string inputs_text, GetFileContents(inputs_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(ir_text, ir_path));
   XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
 
+  std::unique_ptr<Package> reference_package;
+  Function* reference = nullptr;
+  std::string reference_path = absl::GetFlag(FLAGS_reference_ir_file);
+  if (!reference_path.empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string reference_text,
+                         GetFileContents(reference_path));
+    XLS_ASSIGN_OR_RETURN(reference_package,
+                         Parser::ParsePackage(reference_text, reference_path));
+    XLS_ASSIGN_OR_RETURN(reference, reference_package->GetTopAsFunction());
+  }
+
   std::vector<std::vector<Value>> inputs;
-  for (const auto& args_line :
-       absl::StrSplit(inputs_text, '\n', absl::SkipWhitespace())) {
-    std::vector<Value> args;
-    for (const std::string_view& value_string :
-         absl::StrSplit(args_line, ';')) {
-      XLS_ASSIGN_OR_RETURN(Value arg, Parser::ParseTypedValue(value_string));
-      args.push_back(arg);
+  if (!inputs_path.empty()) {
+    XLS_ASSIGN_OR_RETURN(std::string inputs_text,
+                         GetFileContents(inputs_path));
+    for (const auto& args_line :
+         absl::StrSplit(inputs_text, '\n', absl::SkipWhitespace())) {
+      std::vector<Value> args;
+      for (const std::string_view& value_string :
+           absl::StrSplit(args_line, ';')) {
+        XLS_ASSIGN_OR_RETURN(Value arg, Parser::ParseTypedValue(value_string));
+        args.push_back(arg);
+      }
+      inputs.push_back(args);
     }
-    inputs.push_back(args);
   }
 
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
-                       FunctionJit::Create(f));
-  for (const std::vector<Value>& args : inputs) {
-    InterpreterResult<Value> jit_result;
-    if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
-      XLS_ASSIGN_OR_RETURN(jit_result, jit->Run(args));
-    } else {
-      XLS_ASSIGN_OR_RETURN(jit_result.value,
-                           Parser::ParseTypedValue(absl::GetFlag(
-                               FLAGS_test_only_inject_jit_result)));
-    }
-    // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
-    // events once the JIT fully supports events (and we have decided how to
-    // handle event mismatches).
-    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> interpreter_result,
-                         InterpretFunction(f, args));
-    if (jit_result.value != interpreter_result.value) {
-      std::cout << absl::StrJoin(args, "; ", ValueFormatterHex);
-      return absl::OkStatus();
-    }
+  std::optional<Value> injected_jit_result;
+  if (!absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
+    XLS_ASSIGN_OR_RETURN(injected_jit_result,
+                         Parser::ParseTypedValue(absl::GetFlag(
+                             FLAGS_test_only_inject_jit_result)));
+  }
+
+  int64_t worker_count = absl::GetFlag(FLAGS_worker_count);
+  if (worker_count <= 0) {
+    worker_count = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+  }
+  FailingInputSearch search(f, reference, std::move(inputs),
+                            absl::GetFlag(FLAGS_random_inputs),
+                            absl::GetFlag(FLAGS_batch_size),
+                            absl::GetFlag(FLAGS_seed), injected_jit_result);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::vector<Value>> mismatch,
+                       search.Run(worker_count));
+  if (mismatch.has_value()) {
+    std::cout << absl::StrJoin(*mismatch, "; ", ValueFormatterHex);
+    return absl::OkStatus();
   }
-  return absl::InvalidArgumentError(
-      "No input found which results in a mismatch between the JIT and "
-      "interpreter.");
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "No input found which results in a mismatch between the JIT and %s.",
+      reference == nullptr ? "interpreter" : "reference JIT"));
 }
 
 }  // namespace
@@ -107,7 +305,9 @@ int main(int argc, char** argv) {
     XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <ir-path>",
                                           argv[0]);
   }
-  XLS_QCHECK(!absl::GetFlag(FLAGS_input_file).empty());
+  XLS_QCHECK(!absl::GetFlag(FLAGS_input_file).empty() ||
+             absl::GetFlag(FLAGS_random_inputs) > 0)
+      << "Expected --input_file or --random_inputs.";
   XLS_QCHECK_OK(
       xls::RealMain(positional_arguments[0], absl::GetFlag(FLAGS_input_file)));
   return 0;
@@ -73,6 +73,35 @@ class EvalMainTest(test_base.TestCase):
                                      stderr=subprocess.PIPE)
     self.assertEqual(result.decode('utf-8'), 'bits[32]:0x42; bits[32]:0x123')
 
+  def test_random_inputs_with_failure(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    input_file = self.create_tempfile(content='bits[32]:0x0; bits[32]:0x0')
+    # The file input matches the injected result, so the first random input
+    # is reported regardless of the number of workers.
+    outputs = set()
+    for worker_count in (1, 4):
+      outputs.add(
+          subprocess.check_output([
+              FIND_FAILING_INPUT_MAIN, '--input_file=' + input_file.full_path,
+              '--random_inputs=1000', '--batch_size=16',
+              '--worker_count={}'.format(worker_count),
+              '--test_only_inject_jit_result=bits[32]:0x0', ir_file.full_path
+          ],
+                                  stderr=subprocess.PIPE).decode('utf-8'))
+    self.assertLen(outputs, 1)
+    self.assertNotEqual(outputs.pop(), 'bits[32]:0x0; bits[32]:0x0')
+
+  def test_random_inputs_no_failure(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    comp = subprocess.run([
+        FIND_FAILING_INPUT_MAIN, '--random_inputs=1000', '--batch_size=64',
+        '--worker_count=4', ir_file.full_path
+    ],
+                          stderr=subprocess.PIPE, check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('No input found which results in a mismatch',
+                  comp.stderr.decode('utf-8'))
+
 
 if __name__ == '__main__':
   test_base.main()
@@ -12,7 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -38,6 +47,12 @@ Example invocations:
 Show summary of a set of files emitted by the fuzzer:
 
   read_summary_main /tmp/summaries/summary_*.binarypb
+
+Besides the op coverage, the wall time of each stage of the samples is shown as
+percentiles, overall and by sample options and by the ops of the samples, along
+with the peak memory use of the sample runners and the stages at which samples
+timed out. Outliers there (e.g. a p99 optimization time far above the median)
+point at performance problems in the tools run by the fuzzer.
 )";
 
 namespace xls {
@@ -80,6 +95,42 @@ struct SummaryInfo {
   fuzzer::SampleTimingProto total_timing;
   // The maximum time spent on a single same for the various fuzzer operations.
   fuzzer::SampleTimingProto max_timing;
+
+  // The wall times (in nanoseconds) of each stage, by stage name, of the
+  // samples which ran the stage.
+  absl::flat_hash_map<std::string, std::vector<int64_t>> stage_ns;
+  // The total and optimization times of the samples, by sample options and by
+  // the ops (before optimization) of the samples.
+  absl::flat_hash_map<std::string, std::vector<int64_t>> total_ns_by_options;
+  absl::flat_hash_map<std::string, int64_t> failures_by_options;
+  absl::flat_hash_map<std::string, std::vector<int64_t>> total_ns_by_op;
+  absl::flat_hash_map<std::string, std::vector<int64_t>> optimize_ns_by_op;
+  // The peak RSS of the sample runners, where recorded.
+  std::vector<int64_t> peak_rss_bytes;
+  // The number of samples which timed out, by the stage they were running.
+  absl::flat_hash_map<std::string, int64_t> timeouts_by_stage;
+};
+
+// A stage of the samples with the field holding its wall time.
+struct StageTimeField {
+  std::string_view name;
+  int64_t (fuzzer::SampleTimingProto::*ns)() const;
+};
+
+const StageTimeField kStageTimeFields[] = {
+    {"total", &fuzzer::SampleTimingProto::total_ns},
+    {"generate_sample", &fuzzer::SampleTimingProto::generate_sample_ns},
+    {"interpret_dslx", &fuzzer::SampleTimingProto::interpret_dslx_ns},
+    {"convert_ir", &fuzzer::SampleTimingProto::convert_ir_ns},
+    {"unoptimized_interpret_ir",
+     &fuzzer::SampleTimingProto::unoptimized_interpret_ir_ns},
+    {"unoptimized_jit", &fuzzer::SampleTimingProto::unoptimized_jit_ns},
+    {"optimize", &fuzzer::SampleTimingProto::optimize_ns},
+    {"optimized_interpret_ir",
+     &fuzzer::SampleTimingProto::optimized_interpret_ir_ns},
+    {"optimized_jit", &fuzzer::SampleTimingProto::optimized_jit_ns},
+    {"codegen", &fuzzer::SampleTimingProto::codegen_ns},
+    {"simulate", &fuzzer::SampleTimingProto::simulate_ns},
 };
 
 // Aggregates the summary data in 'summary' into 'info'.
@@ -141,6 +192,142 @@ void AggregateSummary(const fuzzer::SampleSummaryProto& summary,
   AGGREGATE_FIELD(codegen_ns);
   AGGREGATE_FIELD(simulate_ns);
 #undef AGGREGATE_FIELD
+
+  const fuzzer::SampleTimingProto& timing = summary.timing();
+  for (const StageTimeField& field : kStageTimeFields) {
+    int64_t ns = (timing.*field.ns)();
+    if (ns > 0) {
+      info->stage_ns[field.name].push_back(ns);
+    }
+  }
+  std::string options = summary.options().empty() ? "(unknown)"
+                                                  : summary.options();
+  info->total_ns_by_options[options].push_back(timing.total_ns());
+  if (summary.failed()) {
+    info->failures_by_options[options]++;
+  }
+  absl::flat_hash_set<std::string> ops;
+  for (const fuzzer::NodeProto& node : summary.unoptimized_nodes()) {
+    ops.insert(node.op());
+  }
+  for (const std::string& op : ops) {
+    info->total_ns_by_op[op].push_back(timing.total_ns());
+    if (timing.optimize_ns() > 0) {
+      info->optimize_ns_by_op[op].push_back(timing.optimize_ns());
+    }
+  }
+  if (timing.peak_rss_bytes() > 0) {
+    info->peak_rss_bytes.push_back(timing.peak_rss_bytes());
+  }
+  if (!timing.timed_out_stage().empty()) {
+    info->timeouts_by_stage[timing.timed_out_stage()]++;
+  }
+}
+
+// Returns the `percentile`th percentile (nearest rank) of the sorted `values`,
+// which must not be empty.
+int64_t Percentile(absl::Span<const int64_t> values, double percentile) {
+  int64_t rank = static_cast<int64_t>(
+      std::ceil(percentile / 100.0 * static_cast<double>(values.size())));
+  return values[std::clamp<int64_t>(rank - 1, 0, values.size() - 1)];
+}
+
+// Returns the milliseconds in `nanoseconds`.
+double NsToMs(int64_t nanoseconds) {
+  return static_cast<double>(nanoseconds) / 1e6;
+}
+
+// Prints a row of the count, the 50th, 90th and 99th percentiles and the
+// maximum of `values` (sorting them), converted with `convert`.
+void PrintPercentileRow(std::string_view label, std::vector<int64_t>& values,
+                        double (*convert)(int64_t)) {
+  std::sort(values.begin(), values.end());
+  std::cout << absl::StreamFormat(
+      "%-40s %8d %12.2f %12.2f %12.2f %12.2f\n", label, values.size(),
+      convert(Percentile(values, 50)), convert(Percentile(values, 90)),
+      convert(Percentile(values, 99)), convert(values.back()));
+}
+
+void PrintPercentileHeader(std::string_view label, std::string_view unit) {
+  std::cout << absl::StreamFormat(
+      "%-40s %8s %12s %12s %12s %12s\n", label, "samples",
+      absl::StrCat("p50 ", unit), absl::StrCat("p90 ", unit),
+      absl::StrCat("p99 ", unit), absl::StrCat("max ", unit));
+  std::cout << std::string(40 + 9 + 4 * 13, '-') << "\n";
+}
+
+// Returns the keys of `map` in order.
+template <typename V>
+std::vector<std::string> SortedKeys(
+    const absl::flat_hash_map<std::string, V>& map) {
+  std::vector<std::string> keys;
+  for (const auto& [key, value] : map) {
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+// Prints percentile tables of the stage times, by stage, sample options and
+// op, along with the peak memory use and timeouts, to stdout.
+void DumpPercentiles(SummaryInfo& info) {
+  PrintPercentileHeader("stage", "ms");
+  for (const StageTimeField& field : kStageTimeFields) {
+    auto it = info.stage_ns.find(field.name);
+    if (it != info.stage_ns.end()) {
+      PrintPercentileRow(field.name, it->second, NsToMs);
+    }
+  }
+
+  std::cout << "\nTotal time by sample options:\n";
+  PrintPercentileHeader("options", "ms");
+  for (const std::string& options : SortedKeys(info.total_ns_by_options)) {
+    PrintPercentileRow(options, info.total_ns_by_options[options], NsToMs);
+  }
+  std::cout << absl::StreamFormat("\n%-40s %8s %8s %14s\n", "options",
+                                  "samples", "failed", "samples/sec");
+  for (const std::string& options : SortedKeys(info.total_ns_by_options)) {
+    const std::vector<int64_t>& total_ns = info.total_ns_by_options[options];
+    int64_t sum_ns = 0;
+    for (int64_t ns : total_ns) {
+      sum_ns += ns;
+    }
+    // Per worker, as samples run concurrently.
+    double samples_per_sec =
+        sum_ns == 0 ? 0.0 : 1e9 * total_ns.size() / static_cast<double>(sum_ns);
+    std::cout << absl::StreamFormat("%-40s %8d %8d %14.2f\n", options,
+                                    total_ns.size(),
+                                    info.failures_by_options[options],
+                                    samples_per_sec);
+  }
+
+  std::cout << "\nTotal time of the samples containing each op:\n";
+  PrintPercentileHeader("op", "ms");
+  for (const std::string& op : SortedKeys(info.total_ns_by_op)) {
+    PrintPercentileRow(op, info.total_ns_by_op[op], NsToMs);
+  }
+  std::cout << "\nOptimization time of the samples containing each op:\n";
+  PrintPercentileHeader("op", "ms");
+  for (const std::string& op : SortedKeys(info.optimize_ns_by_op)) {
+    PrintPercentileRow(op, info.optimize_ns_by_op[op], NsToMs);
+  }
+
+  if (!info.peak_rss_bytes.empty()) {
+    std::cout << "\nPeak RSS of the sample runners:\n";
+    PrintPercentileHeader("", "MiB");
+    PrintPercentileRow("peak RSS", info.peak_rss_bytes, [](int64_t bytes) {
+      return static_cast<double>(bytes) / (1024 * 1024);
+    });
+  }
+
+  std::cout << "\nTimeouts by stage:\n";
+  if (info.timeouts_by_stage.empty()) {
+    std::cout << "(none)\n";
+  }
+  for (const std::string& stage : SortedKeys(info.timeouts_by_stage)) {
+    std::cout << absl::StreamFormat("%-40s %8d\n", stage,
+                                    info.timeouts_by_stage[stage]);
+  }
 }
 
 // Print the timing info contained in 'info' to stdout.
@@ -264,6 +451,10 @@ absl::Status RealMain(absl::Span<const std::string_view> input_paths) {
   std::cout << "\nTiming\n";
   std::cout << "------\n";
   DumpTimingInfo(summary_info);
+
+  std::cout << "\nPercentiles\n";
+  std::cout << "-----------\n";
+  DumpPercentiles(summary_info);
   return absl::OkStatus();
 }
 
@@ -0,0 +1,570 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/run_fuzz_multithreaded.h"
+
+#include <openssl/sha.h>
+
+#include <atomic>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/common/thread.h"
+#include "xls/dslx/interp_value_helpers.h"
+#include "xls/fuzzer/coverage_feedback.h"
+#include "xls/fuzzer/cpp_run_fuzz.h"
+#include "xls/fuzzer/sample_generator.h"
+#include "xls/fuzzer/summarize_ir.h"
+#include "xls/fuzzer/value_generator.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+// The number of sample indices given to each worker when the sample count is
+// unbounded; large enough to never run out.
+constexpr int64_t kUnboundedRangeSize = int64_t{1} << 40;
+
+// How often (in samples) progress is logged.
+constexpr int64_t kProgressInterval = 16;
+
+// Returns the nanoseconds elapsed since `start`.
+int64_t ElapsedNs(absl::Time start) {
+  return absl::ToInt64Nanoseconds(absl::Now() - start);
+}
+
+// The hex-encoded SHA-256 digest of `text`.
+std::string Sha256Hex(std::string_view text) {
+  uint8_t digest[SHA256_DIGEST_LENGTH];
+  SHA256(reinterpret_cast<const uint8_t*>(text.data()), text.size(), digest);
+  return absl::BytesToHexString(std::string_view(
+      reinterpret_cast<const char*>(digest), SHA256_DIGEST_LENGTH));
+}
+
+// The sample indices [begin, end) not yet started by a worker.
+struct SampleRange {
+  absl::Mutex mutex;
+  int64_t begin ABSL_GUARDED_BY(mutex) = 0;
+  int64_t end ABSL_GUARDED_BY(mutex) = 0;
+};
+
+// Hands out sample indices to workers. Each worker takes indices from the
+// front of its own range and, once that is empty, steals the back half of the
+// largest range of the other workers. At most one range is locked at a time.
+class SampleQueue {
+ public:
+  SampleQueue(int64_t worker_count, std::optional<int64_t> sample_count);
+
+  // Returns the index of the next sample for `worker` to run, or nullopt if
+  // all samples have been handed out.
+  std::optional<int64_t> Next(int64_t worker);
+
+ private:
+  std::vector<std::unique_ptr<SampleRange>> ranges_;
+};
+
+SampleQueue::SampleQueue(int64_t worker_count,
+                         std::optional<int64_t> sample_count) {
+  ranges_.reserve(worker_count);
+  for (int64_t w = 0; w < worker_count; ++w) {
+    auto range = std::make_unique<SampleRange>();
+    {
+      absl::MutexLock lock(&range->mutex);
+      if (sample_count.has_value()) {
+        range->begin = *sample_count * w / worker_count;
+        range->end = *sample_count * (w + 1) / worker_count;
+      } else {
+        range->begin = w * kUnboundedRangeSize;
+        range->end = range->begin + kUnboundedRangeSize;
+      }
+    }
+    ranges_.push_back(std::move(range));
+  }
+}
+
+std::optional<int64_t> SampleQueue::Next(int64_t worker) {
+  SampleRange& own = *ranges_[worker];
+  while (true) {
+    {
+      absl::MutexLock lock(&own.mutex);
+      if (own.begin < own.end) {
+        return own.begin++;
+      }
+    }
+    int64_t victim = -1;
+    int64_t most_remaining = 0;
+    for (int64_t w = 0; w < ranges_.size(); ++w) {
+      if (w == worker) {
+        continue;
+      }
+      absl::MutexLock lock(&ranges_[w]->mutex);
+      int64_t remaining = ranges_[w]->end - ranges_[w]->begin;
+      if (remaining > most_remaining) {
+        victim = w;
+        most_remaining = remaining;
+      }
+    }
+    if (victim == -1) {
+      return std::nullopt;
+    }
+    int64_t stolen_begin;
+    int64_t stolen_end;
+    {
+      SampleRange& range = *ranges_[victim];
+      absl::MutexLock lock(&range.mutex);
+      int64_t remaining = range.end - range.begin;
+      if (remaining <= 0) {
+        // Drained since it was chosen; look again.
+        continue;
+      }
+      stolen_end = range.end;
+      stolen_begin = range.end - (remaining + 1) / 2;
+      range.end = stolen_begin;
+    }
+    absl::MutexLock lock(&own.mutex);
+    own.begin = stolen_begin;
+    own.end = stolen_end;
+  }
+}
+
+// Writes the files from which RunSampleInDirectory reads `sample`.
+absl::Status WriteSampleFiles(const Sample& sample,
+                              const std::filesystem::path& run_dir) {
+  const SampleOptions& options = sample.options();
+  XLS_RETURN_IF_ERROR(SetFileContents(
+      run_dir / (options.input_is_dslx() ? "sample.x" : "sample.ir"),
+      sample.input_text()));
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(run_dir / "options.json", options.ToJsonText()));
+  if (!sample.args_batch().empty()) {
+    XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "args.txt",
+                                        ArgsBatchToText(sample.args_batch())));
+    // The text form is kept for the command-line tools and for crashers; the
+    // binary form is what RunSampleInDirectory reads, as parsing large
+    // batches of text dominates short samples.
+    XLS_ASSIGN_OR_RETURN(std::string args_binary,
+                         ArgsBatchToBinary(sample.args_batch()));
+    XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "args.bin", args_binary));
+  }
+  return absl::OkStatus();
+}
+
+// Summarizes the IR file `ir_path` into `nodes` if it exists and parses; a
+// sample may fail before or while producing it.
+void SummarizeIrFile(
+    const std::filesystem::path& ir_path,
+    google::protobuf::RepeatedPtrField<fuzzer::NodeProto>* nodes) {
+  if (!FileExists(ir_path).ok()) {
+    return;
+  }
+  absl::StatusOr<std::string> ir_text = GetFileContents(ir_path);
+  if (!ir_text.ok()) {
+    return;
+  }
+  absl::StatusOr<std::unique_ptr<Package>> package = Parser::ParsePackage(
+      *ir_text, /*filename=*/ir_path.string());
+  if (package.ok()) {
+    SummarizePackage(package->get(), nodes);
+  }
+}
+
+// Returns the summary of the IR of the sample run in `run_dir`.
+fuzzer::SampleSummaryProto SummarizeSample(
+    const std::filesystem::path& run_dir) {
+  fuzzer::SampleSummaryProto summary;
+  SummarizeIrFile(run_dir / "sample.ir", summary.mutable_unoptimized_nodes());
+  SummarizeIrFile(run_dir / "sample.opt.ir",
+                  summary.mutable_optimized_nodes());
+  return summary;
+}
+
+// Returns a short description of the options of `sample` which determine
+// the stages run on it, by which read_summary_main aggregates costs.
+std::string DescribeOptions(const SampleOptions& options) {
+  std::vector<std::string> parts = {options.input_is_dslx() ? "dslx" : "ir"};
+  if (options.use_jit()) {
+    parts.push_back("jit");
+  }
+  if (options.optimize_ir()) {
+    parts.push_back("opt");
+  }
+  if (options.codegen()) {
+    parts.push_back("codegen");
+  }
+  if (options.simulate()) {
+    parts.push_back("simulate");
+  }
+  parts.push_back(absl::StrCat("calls=", options.calls_per_sample()));
+  return absl::StrJoin(parts, " ");
+}
+
+// Returns the stage a sample killed in `run_dir` was running, judging by the
+// outputs of the stages which completed. The names are those of the stages of
+// InProcessSampleRunner.
+std::string KilledSampleStage(const std::filesystem::path& run_dir) {
+  // The output of each stage, in order, with the name of the stage which
+  // follows it.
+  constexpr std::pair<std::string_view, std::string_view> kStageOutputs[] = {
+      {"sample.x.results", "convert_ir"},
+      {"sample.ir", "interpret_ir"},
+      {"sample.ir.results", "optimize"},
+      {"sample.opt.ir", "interpret_ir"},
+      {"sample.opt.ir.results", "codegen"},
+      {"module_sig.textproto", "simulate"},
+  };
+  std::string_view stage = "interpret_dslx";
+  for (const auto& [output, next_stage] : kStageOutputs) {
+    if (FileExists(run_dir / output).ok()) {
+      stage = next_stage;
+    }
+  }
+  return std::string(stage);
+}
+
+// The outcome of running one sample.
+struct SampleOutcome {
+  absl::Status status;
+  bool timed_out = false;
+  fuzzer::SampleTimingProto timing;
+};
+
+class FuzzDriver {
+ public:
+  FuzzDriver(const FuzzOptions& options, uint64_t seed)
+      : options_(options),
+        seed_(seed),
+        queue_(options.worker_count, options.sample_count) {
+    if (options.coverage_guided) {
+      guide_ = std::make_unique<CoverageGuide>(options.ast_generator_options);
+    }
+  }
+
+  absl::StatusOr<FuzzResult> Run();
+
+ private:
+  void WorkerMain(int64_t worker);
+
+  // Generates and runs sample `index`. Failures of the sample are recorded as
+  // crashers; an error is returned only if the driver itself fails.
+  absl::Status RunOneSample(int64_t index, InProcessSampleRunner* runner);
+
+  // Runs the sample in `run_dir` in a child process.
+  absl::StatusOr<SampleOutcome> RunIsolated(
+      const std::filesystem::path& run_dir);
+
+  absl::Status AppendSummary(const fuzzer::SampleSummaryProto& summary);
+
+  absl::Status SaveCrasher(const Sample& sample,
+                           const std::filesystem::path& run_dir,
+                           const SampleOutcome& outcome);
+
+  const FuzzOptions& options_;
+  const uint64_t seed_;
+  SampleQueue queue_;
+  // Null unless the run is coverage guided.
+  std::unique_ptr<CoverageGuide> guide_;
+  absl::Time start_;
+  std::atomic<int64_t> sample_count_ = 0;
+  std::atomic<int64_t> crasher_count_ = 0;
+  std::atomic<bool> stop_ = false;
+
+  absl::Mutex mutex_;
+  // The first driver error of any worker.
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  // Serializes appends to the summary file.
+  absl::Mutex summary_mutex_;
+};
+
+absl::StatusOr<FuzzResult> FuzzDriver::Run() {
+  start_ = absl::Now();
+  // Workers run for the whole fuzz session, so they get threads of their own
+  // rather than occupying the shared pool which their samples' passes use.
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(options_.worker_count);
+  for (int64_t w = 0; w < options_.worker_count; ++w) {
+    threads.push_back(std::make_unique<Thread>([this, w] { WorkerMain(w); }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  absl::MutexLock lock(&mutex_);
+  XLS_RETURN_IF_ERROR(status_);
+  FuzzResult result;
+  result.sample_count = sample_count_.load();
+  result.crasher_count = crasher_count_.load();
+  if (guide_ != nullptr) {
+    result.coverage_feature_count = guide_->feature_count();
+  }
+  return result;
+}
+
+void FuzzDriver::WorkerMain(int64_t worker) {
+  // Each worker has its own runner so the runners' import data is never
+  // shared between threads.
+  std::unique_ptr<InProcessSampleRunner> runner;
+  if (!options_.isolation_executable.has_value()) {
+    runner = std::make_unique<InProcessSampleRunner>();
+  }
+  while (!stop_.load()) {
+    if (options_.duration.has_value() &&
+        absl::Now() - start_ >= *options_.duration) {
+      return;
+    }
+    std::optional<int64_t> index = queue_.Next(worker);
+    if (!index.has_value()) {
+      return;
+    }
+    absl::Status status = RunOneSample(*index, runner.get());
+    if (!status.ok()) {
+      absl::MutexLock lock(&mutex_);
+      if (status_.ok()) {
+        status_ = status;
+      }
+      stop_.store(true);
+      return;
+    }
+    int64_t done = ++sample_count_;
+    if (done % kProgressInterval == 0) {
+      double seconds = absl::ToDoubleSeconds(absl::Now() - start_);
+      std::string coverage;
+      if (guide_ != nullptr) {
+        coverage = absl::StrFormat(", %d coverage features, corpus of %d",
+                                   guide_->feature_count(),
+                                   guide_->corpus_size());
+      }
+      XLS_LOG(INFO) << absl::StreamFormat(
+          "%d samples (%.2f samples/s), %d crashers%s", done, done / seconds,
+          crasher_count_.load(), coverage);
+    }
+  }
+}
+
+absl::Status FuzzDriver::RunOneSample(int64_t index,
+                                      InProcessSampleRunner* runner) {
+  absl::Time start = absl::Now();
+  ValueGenerator value_gen(std::mt19937_64(seed_ + index));
+  std::optional<CoverageGuide::Plan> plan;
+  if (guide_ != nullptr) {
+    plan = guide_->NextPlan(value_gen.rng());
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Sample sample,
+      plan.has_value()
+          ? guide_->ProduceSample(*plan, options_.sample_options, &value_gen)
+          : GenerateSample(options_.ast_generator_options,
+                           options_.sample_options, &value_gen));
+  int64_t generate_sample_ns = ElapsedNs(start);
+
+  std::optional<TempDirectory> temp_dir;
+  std::filesystem::path run_dir;
+  if (options_.top_run_dir.has_value()) {
+    run_dir = *options_.top_run_dir / absl::StrCat("sample", index);
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
+  } else {
+    XLS_ASSIGN_OR_RETURN(TempDirectory dir, TempDirectory::Create());
+    run_dir = dir.path();
+    temp_dir.emplace(std::move(dir));
+  }
+  XLS_RETURN_IF_ERROR(WriteSampleFiles(sample, run_dir));
+
+  SampleOutcome outcome;
+  if (options_.isolation_executable.has_value()) {
+    XLS_ASSIGN_OR_RETURN(outcome, RunIsolated(run_dir));
+  } else {
+    outcome.status = RunSampleInDirectory(run_dir, runner);
+    outcome.timing = runner->timing();
+  }
+  if (outcome.status.ok() && options_.force_failure) {
+    outcome.status = absl::InternalError("Forced sample failure.");
+  }
+  outcome.timing.set_generate_sample_ns(generate_sample_ns);
+  outcome.timing.set_total_ns(ElapsedNs(start));
+
+  if (options_.summary_file.has_value() || guide_ != nullptr) {
+    fuzzer::SampleSummaryProto summary = SummarizeSample(run_dir);
+    *summary.mutable_timing() = outcome.timing;
+    summary.set_options(DescribeOptions(sample.options()));
+    summary.set_failed(!outcome.status.ok());
+    if (options_.summary_file.has_value()) {
+      XLS_RETURN_IF_ERROR(AppendSummary(summary));
+    }
+    if (guide_ != nullptr) {
+      guide_->Record(*plan, sample, CollectCoverage(summary, run_dir));
+    }
+  }
+  if (!outcome.status.ok()) {
+    ++crasher_count_;
+    XLS_LOG(ERROR) << "Sample " << index << " failed: " << outcome.status;
+    if (options_.crasher_dir.has_value()) {
+      XLS_RETURN_IF_ERROR(SaveCrasher(sample, run_dir, outcome));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<SampleOutcome> FuzzDriver::RunIsolated(
+    const std::filesystem::path& run_dir) {
+  std::vector<std::string> argv = {
+      options_.isolation_executable->string(),
+      absl::StrCat("--run_sample_dir=", run_dir.string())};
+  XLS_ASSIGN_OR_RETURN(
+      SubprocessResult result,
+      InvokeSubprocess(argv, run_dir, options_.sample_timeout));
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(run_dir / "sample_runner.stderr", result.stderr));
+
+  SampleOutcome outcome;
+  if (result.timeout_expired) {
+    outcome.timed_out = true;
+    outcome.status = absl::DeadlineExceededError(
+        absl::StrCat("Sample timed out after ",
+                     absl::FormatDuration(*options_.sample_timeout)));
+  } else if (!result.normal_termination) {
+    outcome.status = absl::InternalError(
+        absl::StrCat("Sample runner terminated abnormally:\n", result.stderr));
+  } else if (result.exit_status != 0) {
+    // The child records the error of the sample itself in exception.txt; fall
+    // back to its stderr if it failed before getting that far.
+    absl::StatusOr<std::string> exception =
+        GetFileContents(run_dir / "exception.txt");
+    outcome.status = absl::InternalError(exception.ok() ? *exception
+                                                        : result.stderr);
+  }
+  absl::StatusOr<std::string> timing = GetFileContents(run_dir / "timing.pb");
+  if (timing.ok()) {
+    outcome.timing.ParseFromString(*timing);
+  }
+  if (outcome.timed_out) {
+    outcome.timing.set_timed_out_stage(KilledSampleStage(run_dir));
+  }
+  return outcome;
+}
+
+absl::Status FuzzDriver::AppendSummary(
+    const fuzzer::SampleSummaryProto& summary) {
+  fuzzer::SampleSummariesProto summaries;
+  *summaries.add_samples() = summary;
+  absl::MutexLock lock(&summary_mutex_);
+  return AppendStringToFile(*options_.summary_file,
+                            summaries.SerializeAsString());
+}
+
+absl::Status FuzzDriver::SaveCrasher(const Sample& sample,
+                                     const std::filesystem::path& run_dir,
+                                     const SampleOutcome& outcome) {
+  std::string digest = Sha256Hex(sample.input_text());
+  std::filesystem::path sample_crasher_dir =
+      *options_.crasher_dir / digest.substr(0, 8);
+  XLS_LOG(INFO) << "Saving crasher to " << sample_crasher_dir;
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(sample_crasher_dir));
+  std::error_code ec;
+  std::filesystem::copy(run_dir, sample_crasher_dir,
+                        std::filesystem::copy_options::recursive |
+                            std::filesystem::copy_options::overwrite_existing,
+                        ec);
+  if (ec) {
+    return absl::InternalError(absl::StrCat("Failed to copy ", run_dir.string(),
+                                            " to crasher directory: ",
+                                            ec.message()));
+  }
+  std::string message(outcome.status.message());
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(sample_crasher_dir / "exception.txt", message));
+  std::string crasher_name = absl::StrCat(
+      "crasher_",
+      absl::FormatTime("%Y-%m-%d", absl::Now(), absl::LocalTimeZone()), "_",
+      digest.substr(0, 4), ".x");
+  XLS_RETURN_IF_ERROR(SetFileContents(sample_crasher_dir / crasher_name,
+                                      sample.ToCrasher(message)));
+  // A forced failure does not reproduce outside the driver, so there is
+  // nothing for the minimizer to preserve.
+  if (!outcome.timed_out && !options_.force_failure) {
+    absl::StatusOr<std::optional<std::filesystem::path>> minimized =
+        MinimizeIr(sample, sample_crasher_dir, /*inject_jit_result=*/
+                   std::nullopt, options_.sample_timeout);
+    if (!minimized.ok()) {
+      XLS_LOG(WARNING) << "Failed to minimize crasher IR: "
+                       << minimized.status();
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<FuzzResult> RunFuzzMultithreaded(const FuzzOptions& options) {
+  if (options.worker_count < 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Worker count must be positive, got ", options.worker_count));
+  }
+  uint64_t seed = options.seed.has_value()
+                      ? *options.seed
+                      : (uint64_t{std::random_device()()} << 32) |
+                            std::random_device()();
+  XLS_LOG(INFO) << "Fuzzing with " << options.worker_count
+                << " workers from seed " << seed;
+  FuzzDriver driver(options, seed);
+  return driver.Run();
+}
+
+absl::Status RunSampleInDirectory(const std::filesystem::path& run_dir,
+                                  InProcessSampleRunner* runner) {
+  XLS_ASSIGN_OR_RETURN(std::string options_text,
+                       GetFileContents(run_dir / "options.json"));
+  XLS_ASSIGN_OR_RETURN(SampleOptions options,
+                       SampleOptions::FromJson(options_text));
+  XLS_ASSIGN_OR_RETURN(
+      std::string input_text,
+      GetFileContents(run_dir /
+                      (options.input_is_dslx() ? "sample.x" : "sample.ir")));
+  ArgsBatch args_batch;
+  if (FileExists(run_dir / "args.bin").ok()) {
+    XLS_ASSIGN_OR_RETURN(std::string args_binary,
+                         GetFileContents(run_dir / "args.bin"));
+    XLS_ASSIGN_OR_RETURN(args_batch, ParseArgsBatchBinary(args_binary));
+  } else if (FileExists(run_dir / "args.txt").ok()) {
+    XLS_ASSIGN_OR_RETURN(std::string args_text,
+                         GetFileContents(run_dir / "args.txt"));
+    XLS_ASSIGN_OR_RETURN(args_batch, dslx::ParseArgsBatch(args_text));
+  }
+  Sample sample(std::move(input_text), std::move(options),
+                std::move(args_batch));
+  absl::Status status = runner->Run(sample, run_dir);
+  XLS_RETURN_IF_ERROR(SetFileContents(run_dir / "timing.pb",
+                                      runner->timing().SerializeAsString()));
+  return status;
+}
+
+}  // namespace xls
@@ -0,0 +1,109 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Native multi-threaded fuzz driver; see RunFuzzMultithreaded.
+
+#ifndef XLS_FUZZER_RUN_FUZZ_MULTITHREADED_H_
+#define XLS_FUZZER_RUN_FUZZ_MULTITHREADED_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/cpp_sample_runner.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+
+struct FuzzOptions {
+  int64_t worker_count = 1;
+  dslx::AstGeneratorOptions ast_generator_options;
+  SampleOptions sample_options;
+
+  // Seed from which the seed of each sample is derived. If unset, a
+  // nondeterministic seed is chosen. Sample `i` is generated from seed + i no
+  // matter which worker runs it, so a run with a seed is reproducible.
+  std::optional<uint64_t> seed;
+
+  // If set, each sample runs in a subdirectory of this directory which is kept
+  // afterwards. Otherwise each sample runs in a temporary directory.
+  std::optional<std::filesystem::path> top_run_dir;
+
+  // If set, failing samples are copied into subdirectories of this directory
+  // along with a crasher file reproducing them.
+  std::optional<std::filesystem::path> crasher_dir;
+
+  // If set, a fuzzer::SampleSummariesProto holding one summary per sample is
+  // appended to this file as each sample completes.
+  std::optional<std::filesystem::path> summary_file;
+
+  // The number of samples to run. If unset, the number of samples is
+  // unbounded unless limited by `duration`.
+  std::optional<int64_t> sample_count;
+
+  // The time after which no more samples are started.
+  std::optional<absl::Duration> duration;
+
+  // If set, each sample runs in a child process running this executable with
+  // the flag --run_sample_dir=<run dir> (see RunSampleInDirectory), so a
+  // sample which crashes or hangs cannot take down the driver. Otherwise
+  // samples run on the worker threads.
+  std::optional<std::filesystem::path> isolation_executable;
+
+  // If set and samples are isolated, a sample running longer than this is
+  // killed and recorded as a (timed out) crasher.
+  std::optional<absl::Duration> sample_timeout;
+
+  // If set, generation is steered towards samples covering IR ops, types,
+  // widths and optimization passes which no earlier sample covered; see
+  // CoverageGuide. Guided runs are not reproducible from the seed alone.
+  bool coverage_guided = false;
+
+  // If set, every sample is considered a failure. Useful for testing failure
+  // paths.
+  bool force_failure = false;
+};
+
+struct FuzzResult {
+  int64_t sample_count = 0;
+  int64_t crasher_count = 0;
+  // The number of distinct coverage features seen by a coverage guided run.
+  int64_t coverage_feature_count = 0;
+};
+
+// Generates and runs fuzz samples on `worker_count` threads until the sample
+// count or duration is reached.
+//
+// Sample costs vary by orders of magnitude, so rather than giving each worker
+// a fixed quota the sample indices are split into a range per worker, and a
+// worker which runs out of samples steals the back half of the largest
+// remaining range of another worker. All workers thus stay busy until the
+// last samples are running.
+absl::StatusOr<FuzzResult> RunFuzzMultithreaded(const FuzzOptions& options);
+
+// Runs the sample whose files (sample.x or sample.ir, options.json and
+// args.txt) were written to `run_dir` by the driver. The stage timings are
+// written to the file "timing.pb" in `run_dir`. This is the entry point of the
+// child processes of an isolated run.
+absl::Status RunSampleInDirectory(const std::filesystem::path& run_dir,
+                                  InProcessSampleRunner* runner);
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_RUN_FUZZ_MULTITHREADED_H_
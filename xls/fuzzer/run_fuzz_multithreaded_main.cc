@@ -0,0 +1,368 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/parse_and_typecheck.h"
+#include "xls/fuzzer/cpp_sample_runner.h"
+#include "xls/fuzzer/dslx_mutator.h"
+#include "xls/fuzzer/run_fuzz_multithreaded.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_stage_cache.h"
+
+const char kUsage[] = R"(
+Multi-threaded fuzz driver. Generates and runs fuzz samples on a pool of
+worker threads, collecting failing samples into --crash_path:
+
+  run_fuzz_multithreaded_main --crash_path=DIR [--sample_count=N] \
+    [--duration=1h] [--summary_file=FILE]
+
+By default each sample runs in a child process (this binary invoked with
+--run_sample_dir) so that a crashing sample is recorded rather than taking
+down the driver.
+
+A crasher can be re-run with --run_crasher=FILE. Given --stage_cache_dir, the
+outputs of the stages of re-run samples are cached, so re-running a crasher
+(or the crasher corpus) against an unchanged build only runs the stages whose
+inputs changed.
+
+With --minimize_crasher=FILE, the DSLX of a crasher is minimized by removing
+tokens while the sample still fails the same way, testing --worker_count
+candidates in parallel, and the minimized crasher is printed to stdout.
+)";
+
+ABSL_FLAG(int64_t, calls_per_sample, 128, "Arguments to generate per sample.");
+ABSL_FLAG(bool, codegen, false, "Run code generation.");
+ABSL_FLAG(bool, coverage_guided, false,
+          "Steer sample generation towards samples covering new IR ops, types, "
+          "widths and optimization passes.");
+ABSL_FLAG(std::string, crash_path, "", "Path at which to place crash data.");
+ABSL_FLAG(absl::Duration, duration, absl::InfiniteDuration(),
+          "Duration to run the sample generator for.");
+ABSL_FLAG(bool, emit_loops, true, "Emit loops in generator.");
+ABSL_FLAG(bool, force_failure, false,
+          "Forces the samples to fail. Can be used to test failure code "
+          "paths.");
+ABSL_FLAG(bool, isolate_samples, true,
+          "Run each sample in a child process rather than on the worker "
+          "thread.");
+ABSL_FLAG(int64_t, max_width_aggregate_types, 1024,
+          "The maximum width of aggregate types (tuples and arrays) in the "
+          "generated samples.");
+ABSL_FLAG(int64_t, max_width_bits_types, 64,
+          "The maximum width of bits types in the generated samples.");
+ABSL_FLAG(std::string, minimize_crasher, "",
+          "Minimize the DSLX of the given crasher file, print the minimized "
+          "crasher and exit.");
+ABSL_FLAG(std::string, run_crasher, "",
+          "Run the sample of the given crasher file and exit. The sample runs "
+          "in --save_temps_path if given.");
+ABSL_FLAG(std::string, run_sample_dir, "",
+          "Internal: run the sample in the given directory and exit.");
+ABSL_FLAG(int64_t, sample_count, 0,
+          "Number of samples to generate; zero means no limit.");
+ABSL_FLAG(absl::Duration, sample_timeout, absl::InfiniteDuration(),
+          "Time after which an isolated sample is killed and recorded as a "
+          "crasher.");
+ABSL_FLAG(std::string, save_temps_path, "",
+          "Path of directory in which to save temporary files. A separate "
+          "subdirectory is created for each sample.");
+ABSL_FLAG(int64_t, seed, -1,
+          "Seed value for generation; negative chooses a random seed.");
+ABSL_FLAG(bool, simulate, false, "Run Verilog simulation.");
+ABSL_FLAG(std::string, stage_cache_dir, "",
+          "Directory of a cache of the outputs of the stages of samples run "
+          "with --run_crasher or --run_sample_dir, keyed by the stage inputs "
+          "and the build of the tools.");
+ABSL_FLAG(std::string, summary_file, "",
+          "File to which a summary of each sample (op types, widths, stage "
+          "timings) is appended as a fuzzer::SampleSummariesProto.");
+ABSL_FLAG(int64_t, timeout_seconds, 0,
+          "The timeout value in seconds for each subcommand invocation; zero "
+          "means no timeout.");
+ABSL_FLAG(bool, use_system_verilog, true,
+          "If true, emit SystemVerilog during codegen otherwise emit Verilog.");
+ABSL_FLAG(int64_t, worker_count, 0,
+          "Number of worker threads; defaults to the hardware concurrency.");
+
+namespace xls {
+namespace {
+
+// Returns the stage cache given by --stage_cache_dir, or nullptr if none.
+absl::StatusOr<std::unique_ptr<SampleStageCache>> OpenStageCache() {
+  std::string dir = absl::GetFlag(FLAGS_stage_cache_dir);
+  if (dir.empty()) {
+    return nullptr;
+  }
+  return SampleStageCache::Create(dir);
+}
+
+absl::Status RunSample(const std::filesystem::path& run_dir) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SampleStageCache> stage_cache,
+                       OpenStageCache());
+  InProcessSampleRunner runner(kDefaultDslxStdlibPath,
+                               /*jit_object_cache=*/nullptr,
+                               stage_cache.get());
+  return RunSampleInDirectory(run_dir, &runner);
+}
+
+absl::Status RunCrasher(const std::filesystem::path& crasher_path) {
+  XLS_ASSIGN_OR_RETURN(std::string crasher, GetFileContents(crasher_path));
+  XLS_ASSIGN_OR_RETURN(Sample sample, Sample::Deserialize(crasher));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SampleStageCache> stage_cache,
+                       OpenStageCache());
+
+  std::optional<TempDirectory> temp_dir;
+  std::filesystem::path run_dir;
+  if (!absl::GetFlag(FLAGS_save_temps_path).empty()) {
+    run_dir = absl::GetFlag(FLAGS_save_temps_path);
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
+  } else {
+    XLS_ASSIGN_OR_RETURN(TempDirectory dir, TempDirectory::Create());
+    run_dir = dir.path();
+    temp_dir.emplace(std::move(dir));
+  }
+
+  InProcessSampleRunner runner(kDefaultDslxStdlibPath,
+                               /*jit_object_cache=*/nullptr,
+                               stage_cache.get());
+  absl::Status status = runner.Run(sample, run_dir);
+  if (stage_cache != nullptr) {
+    XLS_LOG(INFO) << "Stage cache: " << stage_cache->hit_count()
+                  << " hits, " << stage_cache->miss_count() << " misses.";
+  }
+  return status;
+}
+
+// Returns the worker count given by --worker_count.
+int64_t WorkerCount() {
+  int64_t worker_count = absl::GetFlag(FLAGS_worker_count);
+  if (worker_count <= 0) {
+    worker_count = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+  }
+  return worker_count;
+}
+
+// Returns what identifies a sample failure while minimizing it: the status
+// code and the first line of the message, without digits so that e.g. the
+// index of a miscompared result may change.
+std::string FailureSignature(const absl::Status& status) {
+  std::string_view first_line =
+      *absl::StrSplit(status.message(), '\n').begin();
+  std::string signature =
+      absl::StrCat(absl::StatusCodeToString(status.code()), ": ");
+  for (char c : first_line) {
+    if (!absl::ascii_isdigit(c)) {
+      signature.push_back(c);
+    }
+  }
+  return signature;
+}
+
+absl::Status MinimizeCrasher(const std::filesystem::path& crasher_path) {
+  XLS_ASSIGN_OR_RETURN(std::string crasher, GetFileContents(crasher_path));
+  XLS_ASSIGN_OR_RETURN(Sample sample, Sample::Deserialize(crasher));
+  if (!sample.options().input_is_dslx()) {
+    return absl::InvalidArgumentError(
+        "Only crashers with DSLX samples can be minimized.");
+  }
+  XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+
+  // Each worker runs candidates with its own runner, which keeps the modules
+  // imported by the samples typechecked from one candidate to the next.
+  int64_t worker_count = WorkerCount();
+  std::vector<std::unique_ptr<InProcessSampleRunner>> runners;
+  for (int64_t i = 0; i < worker_count; ++i) {
+    runners.push_back(std::make_unique<InProcessSampleRunner>());
+  }
+  auto run = [&](std::string_view dslx, int64_t worker) -> absl::Status {
+    std::filesystem::path run_dir =
+        temp_dir.path() / absl::StrCat("worker", worker);
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
+    Sample candidate(std::string(dslx), sample.options(),
+                     sample.args_batch());
+    return runners[worker]->Run(candidate, run_dir);
+  };
+
+  absl::Status failure = run(sample.input_text(), 0);
+  if (failure.ok()) {
+    return absl::FailedPreconditionError(
+        "The sample of the crasher does not fail.");
+  }
+  std::string signature = FailureSignature(failure);
+  XLS_LOG(INFO) << "Minimizing failure: " << signature;
+
+  dslx::DslxMinimizerOptions options;
+  options.parallelism = worker_count;
+  // Unless the sample fails in the frontend, only candidates which typecheck
+  // can fail the same way, and the others are cheaply discarded.
+  dslx::ImportData import_data = dslx::CreateImportData(
+      std::string(kDefaultDslxStdlibPath), /*additional_search_paths=*/{});
+  if (dslx::ParseAndTypecheck(sample.input_text(), "sample.x", "sample",
+                              &import_data)
+          .ok()) {
+    options.dslx_stdlib_path = std::string(kDefaultDslxStdlibPath);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::string minimized,
+      dslx::MinimizeDslx(
+          sample.input_text(),
+          [&](std::string_view dslx, int64_t worker) -> absl::StatusOr<bool> {
+            absl::Status status = run(dslx, worker);
+            return !status.ok() && FailureSignature(status) == signature;
+          },
+          options));
+
+  absl::Status minimized_failure = run(minimized, 0);
+  XLS_RET_CHECK(!minimized_failure.ok());
+  Sample minimized_sample(std::move(minimized), sample.options(),
+                          sample.args_batch());
+  std::cout << minimized_sample.ToCrasher(minimized_failure.message());
+  return absl::OkStatus();
+}
+
+absl::Status RealMain() {
+  if (absl::GetFlag(FLAGS_simulate) && !absl::GetFlag(FLAGS_codegen)) {
+    return absl::InvalidArgumentError(
+        "Must specify --codegen when --simulate is given.");
+  }
+  FuzzOptions options;
+  options.worker_count = WorkerCount();
+
+  options.ast_generator_options.emit_gate = !absl::GetFlag(FLAGS_codegen);
+  options.ast_generator_options.emit_loops = absl::GetFlag(FLAGS_emit_loops);
+  options.ast_generator_options.max_width_bits_types =
+      absl::GetFlag(FLAGS_max_width_bits_types);
+  options.ast_generator_options.max_width_aggregate_types =
+      absl::GetFlag(FLAGS_max_width_aggregate_types);
+
+  SampleOptions& sample_options = options.sample_options;
+  sample_options.set_input_is_dslx(true);
+  sample_options.set_ir_converter_args({"--top=main"});
+  sample_options.set_calls_per_sample(absl::GetFlag(FLAGS_calls_per_sample));
+  sample_options.set_codegen(absl::GetFlag(FLAGS_codegen));
+  sample_options.set_simulate(absl::GetFlag(FLAGS_simulate));
+  sample_options.set_use_system_verilog(
+      absl::GetFlag(FLAGS_use_system_verilog));
+  if (absl::GetFlag(FLAGS_timeout_seconds) > 0) {
+    sample_options.set_timeout_seconds(absl::GetFlag(FLAGS_timeout_seconds));
+  }
+
+  if (absl::GetFlag(FLAGS_seed) >= 0) {
+    options.seed = absl::GetFlag(FLAGS_seed);
+  }
+  if (!absl::GetFlag(FLAGS_save_temps_path).empty()) {
+    options.top_run_dir = absl::GetFlag(FLAGS_save_temps_path);
+  }
+  options.crasher_dir = absl::GetFlag(FLAGS_crash_path);
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(*options.crasher_dir));
+  if (!absl::GetFlag(FLAGS_summary_file).empty()) {
+    options.summary_file = absl::GetFlag(FLAGS_summary_file);
+  }
+  if (absl::GetFlag(FLAGS_sample_count) > 0) {
+    options.sample_count = absl::GetFlag(FLAGS_sample_count);
+  }
+  if (absl::GetFlag(FLAGS_duration) != absl::InfiniteDuration()) {
+    options.duration = absl::GetFlag(FLAGS_duration);
+  }
+  if (absl::GetFlag(FLAGS_isolate_samples)) {
+    std::error_code ec;
+    options.isolation_executable =
+        std::filesystem::read_symlink("/proc/self/exe", ec);
+    if (ec) {
+      return absl::InternalError(
+          absl::StrCat("Failed to find the driver executable: ", ec.message()));
+    }
+  }
+  if (absl::GetFlag(FLAGS_sample_timeout) != absl::InfiniteDuration()) {
+    options.sample_timeout = absl::GetFlag(FLAGS_sample_timeout);
+  }
+  options.force_failure = absl::GetFlag(FLAGS_force_failure);
+  options.coverage_guided = absl::GetFlag(FLAGS_coverage_guided);
+
+  XLS_ASSIGN_OR_RETURN(FuzzResult result, RunFuzzMultithreaded(options));
+  XLS_LOG(INFO) << "Ran " << result.sample_count << " samples; "
+                << result.crasher_count << " crashers.";
+  if (options.coverage_guided) {
+    XLS_LOG(INFO) << result.coverage_feature_count << " coverage features.";
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (!positional_arguments.empty()) {
+    XLS_LOG(QFATAL) << "Usage:\n" << kUsage;
+  }
+
+  std::string run_crasher = absl::GetFlag(FLAGS_run_crasher);
+  if (!run_crasher.empty()) {
+    XLS_QCHECK_OK(xls::RunCrasher(run_crasher));
+    return EXIT_SUCCESS;
+  }
+
+  std::string minimize_crasher = absl::GetFlag(FLAGS_minimize_crasher);
+  if (!minimize_crasher.empty()) {
+    XLS_QCHECK_OK(xls::MinimizeCrasher(minimize_crasher));
+    return EXIT_SUCCESS;
+  }
+
+  std::string run_sample_dir = absl::GetFlag(FLAGS_run_sample_dir);
+  if (!run_sample_dir.empty()) {
+    // The sample's error is already recorded in its run directory; only the
+    // exit status matters to the driver.
+    absl::Status status = xls::RunSample(run_sample_dir);
+    if (!status.ok()) {
+      XLS_LOG(ERROR) << status;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  XLS_QCHECK(!absl::GetFlag(FLAGS_crash_path).empty())
+      << "Must specify --crash_path.";
+  XLS_QCHECK_OK(xls::RealMain());
+  return EXIT_SUCCESS;
+}
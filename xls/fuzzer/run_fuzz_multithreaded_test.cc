@@ -0,0 +1,133 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/run_fuzz_multithreaded.h"
+
+#include <filesystem>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample_summary.pb.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+
+FuzzOptions MakeOptions(const TempDirectory& temp_dir) {
+  FuzzOptions options;
+  options.worker_count = 2;
+  options.seed = 42;
+  options.sample_options.set_ir_converter_args({"--top=main"});
+  options.sample_options.set_calls_per_sample(4);
+  options.top_run_dir = temp_dir.path() / "runs";
+  options.summary_file = temp_dir.path() / "summary.pb";
+  return options;
+}
+
+TEST(RunFuzzMultithreadedTest, RunsSampleCount) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  FuzzOptions options = MakeOptions(temp_dir);
+  options.sample_count = 5;
+  XLS_ASSERT_OK_AND_ASSIGN(FuzzResult result, RunFuzzMultithreaded(options));
+  EXPECT_EQ(result.sample_count, 5);
+  EXPECT_EQ(result.crasher_count, 0);
+  for (int64_t i = 0; i < 5; ++i) {
+    XLS_EXPECT_OK(FileExists(*options.top_run_dir /
+                             absl::StrCat("sample", i) / "sample.x"));
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string summary_text,
+                           GetFileContents(*options.summary_file));
+  fuzzer::SampleSummariesProto summaries;
+  ASSERT_TRUE(summaries.ParseFromString(summary_text));
+  ASSERT_EQ(summaries.samples_size(), 5);
+  for (const fuzzer::SampleSummaryProto& summary : summaries.samples()) {
+    EXPECT_GT(summary.timing().total_ns(), 0);
+    EXPECT_GT(summary.unoptimized_nodes_size(), 0);
+    EXPECT_GT(summary.timing().peak_rss_bytes(), 0);
+    EXPECT_THAT(summary.options(), testing::HasSubstr("calls=4"));
+    EXPECT_FALSE(summary.failed());
+  }
+}
+
+TEST(RunFuzzMultithreadedTest, SeedDeterminesSamples) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  FuzzOptions options = MakeOptions(temp_dir);
+  options.sample_count = 3;
+  options.worker_count = 3;
+  XLS_ASSERT_OK(RunFuzzMultithreaded(options).status());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string first,
+      GetFileContents(*options.top_run_dir / "sample2" / "sample.x"));
+
+  options.worker_count = 1;
+  options.top_run_dir = temp_dir.path() / "runs_again";
+  XLS_ASSERT_OK(RunFuzzMultithreaded(options).status());
+  EXPECT_THAT(GetFileContents(*options.top_run_dir / "sample2" / "sample.x"),
+              status_testing::IsOkAndHolds(first));
+}
+
+TEST(RunFuzzMultithreadedTest, DurationBoundsUnlimitedRun) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  FuzzOptions options = MakeOptions(temp_dir);
+  options.top_run_dir.reset();
+  options.duration = absl::Seconds(2);
+  XLS_ASSERT_OK_AND_ASSIGN(FuzzResult result, RunFuzzMultithreaded(options));
+  EXPECT_GT(result.sample_count, 0);
+}
+
+TEST(RunFuzzMultithreadedTest, CoverageGuided) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  FuzzOptions options = MakeOptions(temp_dir);
+  options.sample_count = 8;
+  options.coverage_guided = true;
+  XLS_ASSERT_OK_AND_ASSIGN(FuzzResult result, RunFuzzMultithreaded(options));
+  EXPECT_EQ(result.sample_count, 8);
+  EXPECT_EQ(result.crasher_count, 0);
+  EXPECT_GT(result.coverage_feature_count, 0);
+}
+
+TEST(RunFuzzMultithreadedTest, ForcedFailuresAreSavedAsCrashers) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  FuzzOptions options = MakeOptions(temp_dir);
+  options.sample_count = 2;
+  options.crasher_dir = temp_dir.path() / "crashers";
+  options.force_failure = true;
+  XLS_ASSERT_OK_AND_ASSIGN(FuzzResult result, RunFuzzMultithreaded(options));
+  EXPECT_EQ(result.crasher_count, 2);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::filesystem::path> crashers,
+                           GetDirectoryEntries(*options.crasher_dir));
+  ASSERT_EQ(crashers.size(), 2);
+  EXPECT_THAT(GetFileContents(crashers[0] / "exception.txt"),
+              status_testing::IsOkAndHolds("Forced sample failure."));
+}
+
+TEST(RunFuzzMultithreadedTest, InvalidWorkerCount) {
+  FuzzOptions options;
+  options.worker_count = 0;
+  EXPECT_THAT(RunFuzzMultithreaded(options),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
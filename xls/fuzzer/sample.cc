@@ -19,8 +19,13 @@
 #include <vector>
 
 #include "absl/strings/ascii.h"
+#include "absl/strings/strip.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/dslx/interp_value_helpers.h"
 #include "xls/fuzzer/scrub_crasher.h"
 #include "re2/re2.h"
@@ -53,6 +58,207 @@ std::string ArgsBatchToText(
       });
 }
 
+// Leading bytes of the binary representation of an args batch.
+static constexpr std::string_view kArgsBatchBinaryMagic = "XLSARGS\x01";
+
+static void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// Appends a description of the type of `value` to `out`: 'u' or 's' and the
+// bit count for bits, 't' and the members for tuples, and 'a', the size and
+// (for non-empty arrays) the element type for arrays.
+static absl::Status AppendTypeDescriptor(const InterpValue& value,
+                                         std::string* out) {
+  if (value.IsBits()) {
+    out->push_back(value.IsSigned() ? 's' : 'u');
+    AppendVarint(value.GetBitCount().value(), out);
+    return absl::OkStatus();
+  }
+  if (value.IsTuple() || value.IsArray()) {
+    const std::vector<InterpValue>& elements = value.GetValuesOrDie();
+    out->push_back(value.IsTuple() ? 't' : 'a');
+    AppendVarint(elements.size(), out);
+    for (const InterpValue& element : elements) {
+      XLS_RETURN_IF_ERROR(AppendTypeDescriptor(element, out));
+      if (value.IsArray()) {
+        break;
+      }
+    }
+    return absl::OkStatus();
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unsupported argument value: ", value.ToString()));
+}
+
+static void AppendValueBytes(const InterpValue& value, std::string* out) {
+  if (value.IsBits()) {
+    std::vector<uint8_t> bytes = value.GetBitsOrDie().ToBytes();
+    out->append(bytes.begin(), bytes.end());
+    return;
+  }
+  for (const InterpValue& element : value.GetValuesOrDie()) {
+    AppendValueBytes(element, out);
+  }
+}
+
+absl::StatusOr<std::string> ArgsBatchToBinary(
+    const std::vector<std::vector<InterpValue>>& args_batch) {
+  std::string binary(kArgsBatchBinaryMagic);
+  AppendVarint(args_batch.size(), &binary);
+  if (args_batch.empty()) {
+    return binary;
+  }
+  const std::vector<InterpValue>& first = args_batch.front();
+  AppendVarint(first.size(), &binary);
+  std::vector<std::string> descriptors;
+  for (const InterpValue& arg : first) {
+    XLS_RETURN_IF_ERROR(AppendTypeDescriptor(arg, &descriptors.emplace_back()));
+    binary.append(descriptors.back());
+  }
+  for (int64_t i = 0; i < args_batch.size(); ++i) {
+    const std::vector<InterpValue>& args = args_batch[i];
+    if (args.size() != first.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Argument list %d has %d arguments, expected %d.", i, args.size(),
+          first.size()));
+    }
+    for (int64_t j = 0; j < args.size(); ++j) {
+      std::string descriptor;
+      XLS_RETURN_IF_ERROR(AppendTypeDescriptor(args[j], &descriptor));
+      if (descriptor != descriptors[j]) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Argument %d of argument list %d has a different type than in "
+            "the first argument list: %s",
+            j, i, args[j].ToString()));
+      }
+      AppendValueBytes(args[j], &binary);
+    }
+  }
+  return binary;
+}
+
+namespace {
+
+// Reads the binary representation of an args batch.
+class ArgsBatchBinaryReader {
+ public:
+  explicit ArgsBatchBinaryReader(std::string_view binary) : rest_(binary) {}
+
+  absl::StatusOr<uint64_t> ReadVarint() {
+    uint64_t value = 0;
+    for (int64_t shift = 0; shift < 64; shift += 7) {
+      XLS_ASSIGN_OR_RETURN(std::string_view byte, Read(1));
+      value |= static_cast<uint64_t>(byte[0] & 0x7f) << shift;
+      if ((byte[0] & 0x80) == 0) {
+        return value;
+      }
+    }
+    return absl::InvalidArgumentError("Malformed varint in binary args.");
+  }
+
+  absl::StatusOr<std::string_view> Read(int64_t size) {
+    if (rest_.size() < size) {
+      return absl::InvalidArgumentError("Truncated binary args.");
+    }
+    std::string_view result = rest_.substr(0, size);
+    rest_.remove_prefix(size);
+    return result;
+  }
+
+  // Reads the type descriptor of an argument, returning a value of that type
+  // whose bits are all zero.
+  absl::StatusOr<InterpValue> ReadType() {
+    XLS_ASSIGN_OR_RETURN(std::string_view kind, Read(1));
+    XLS_ASSIGN_OR_RETURN(uint64_t count, ReadVarint());
+    switch (kind[0]) {
+      case 'u':
+      case 's':
+        return InterpValue::MakeBits(kind[0] == 's', Bits(count));
+      case 't': {
+        std::vector<InterpValue> members;
+        for (uint64_t i = 0; i < count; ++i) {
+          XLS_ASSIGN_OR_RETURN(members.emplace_back(), ReadType());
+        }
+        return InterpValue::MakeTuple(std::move(members));
+      }
+      case 'a': {
+        if (count == 0) {
+          return InterpValue::MakeArray({});
+        }
+        XLS_ASSIGN_OR_RETURN(InterpValue element, ReadType());
+        return InterpValue::MakeArray(
+            std::vector<InterpValue>(count, element));
+      }
+      default:
+        return absl::InvalidArgumentError(
+            absl::StrCat("Invalid type in binary args: ", kind));
+    }
+  }
+
+  // Reads a value of the type of `type`.
+  absl::StatusOr<InterpValue> ReadValue(const InterpValue& type) {
+    if (type.IsBits()) {
+      int64_t bit_count = type.GetBitCount().value();
+      XLS_ASSIGN_OR_RETURN(std::string_view bytes,
+                           Read(CeilOfRatio(bit_count, int64_t{8})));
+      return InterpValue::MakeBits(
+          type.IsSigned(),
+          Bits::FromBytes(
+              absl::MakeConstSpan(
+                  reinterpret_cast<const uint8_t*>(bytes.data()),
+                  bytes.size()),
+              bit_count));
+    }
+    std::vector<InterpValue> elements;
+    for (const InterpValue& element_type : type.GetValuesOrDie()) {
+      XLS_ASSIGN_OR_RETURN(elements.emplace_back(), ReadValue(element_type));
+    }
+    if (type.IsTuple()) {
+      return InterpValue::MakeTuple(std::move(elements));
+    }
+    return InterpValue::MakeArray(std::move(elements));
+  }
+
+  bool AtEnd() const { return rest_.empty(); }
+
+ private:
+  std::string_view rest_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::vector<std::vector<InterpValue>>> ParseArgsBatchBinary(
+    std::string_view binary) {
+  if (!absl::ConsumePrefix(&binary, kArgsBatchBinaryMagic)) {
+    return absl::InvalidArgumentError("Not a binary args batch.");
+  }
+  ArgsBatchBinaryReader reader(binary);
+  XLS_ASSIGN_OR_RETURN(uint64_t call_count, reader.ReadVarint());
+  std::vector<std::vector<InterpValue>> args_batch;
+  if (call_count > 0) {
+    XLS_ASSIGN_OR_RETURN(uint64_t arg_count, reader.ReadVarint());
+    std::vector<InterpValue> types;
+    for (uint64_t i = 0; i < arg_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(types.emplace_back(), reader.ReadType());
+    }
+    for (uint64_t i = 0; i < call_count; ++i) {
+      std::vector<InterpValue>& args = args_batch.emplace_back();
+      for (const InterpValue& type : types) {
+        XLS_ASSIGN_OR_RETURN(args.emplace_back(), reader.ReadValue(type));
+      }
+    }
+  }
+  if (!reader.AtEnd()) {
+    return absl::InvalidArgumentError("Trailing bytes in binary args.");
+  }
+  return args_batch;
+}
+
 std::string IrChannelNamesToText(
     const std::vector<std::string>& ir_channel_names) {
   return absl::StrJoin(ir_channel_names, ", ");
@@ -30,6 +30,17 @@ namespace xls {
 // Returns a string representation of the args_batch.
 std::string ArgsBatchToText(
     const std::vector<std::vector<dslx::InterpValue>>& args_batch);
+
+// Returns a compact binary representation of the args_batch, for passing
+// large batches between processes. The types of the arguments are recorded
+// once for the whole batch, followed by the bits of each value as
+// little-endian bytes, so unlike the text representation it is cheap to write
+// and to read back. All argument lists of the batch must have the same types.
+absl::StatusOr<std::string> ArgsBatchToBinary(
+    const std::vector<std::vector<dslx::InterpValue>>& args_batch);
+// Parses the binary representation produced by ArgsBatchToBinary.
+absl::StatusOr<std::vector<std::vector<dslx::InterpValue>>>
+ParseArgsBatchBinary(std::string_view binary);
 // Returns a string representation of the ir_channel_names.
 std::string IrChannelNamesToText(
     const std::vector<std::string>& ir_channel_names);
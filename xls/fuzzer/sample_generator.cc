@@ -248,12 +248,9 @@ static absl::StatusOr<Sample> GenerateFunctionSample(
   std::vector<const ConcreteType*> params =
       TranslateConcreteTypeList(top_params);
 
-  std::vector<std::vector<InterpValue>> args_batch;
-  for (int64_t i = 0; i < sample_options.calls_per_sample(); ++i) {
-    XLS_ASSIGN_OR_RETURN(std::vector<InterpValue> args,
-                         value_gen->GenerateInterpValues(params));
-    args_batch.push_back(std::move(args));
-  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::vector<InterpValue>> args_batch,
+      value_gen->GenerateArgsBatch(params, sample_options.calls_per_sample()));
 
   return Sample(dslx_text, sample_options, std::move(args_batch));
 }
@@ -268,13 +265,10 @@ static absl::StatusOr<Sample> GenerateProcSample(
   std::vector<const ConcreteType*> input_channel_payload_types_ptr =
       TranslateConcreteTypeList(input_channel_payload_types);
 
-  std::vector<std::vector<InterpValue>> channel_values_batch;
-  for (int64_t i = 0; i < sample_options.proc_ticks().value(); ++i) {
-    XLS_ASSIGN_OR_RETURN(
-        std::vector<InterpValue> channel_values,
-        value_gen->GenerateInterpValues(input_channel_payload_types_ptr));
-    channel_values_batch.push_back(std::move(channel_values));
-  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::vector<InterpValue>> channel_values_batch,
+      value_gen->GenerateArgsBatch(input_channel_payload_types_ptr,
+                                   sample_options.proc_ticks().value()));
 
   std::vector<std::string> input_channel_names =
       GetInputChannelNamesOfProc(proc);
@@ -291,7 +285,6 @@ static absl::StatusOr<Sample> GenerateProcSample(
 absl::StatusOr<Sample> GenerateSample(
     const AstGeneratorOptions& generator_options,
     const SampleOptions& sample_options, ValueGenerator* value_gen) {
-  constexpr std::string_view top_name = "main";
   if (generator_options.generate_proc) {
     XLS_CHECK_EQ(sample_options.calls_per_sample(), 0)
         << "calls per sample must be zero when generating a proc sample.";
@@ -306,7 +299,14 @@ absl::StatusOr<Sample> GenerateSample(
 
   XLS_ASSIGN_OR_RETURN(std::string dslx_text,
                        Generate(generator_options, value_gen));
+  return GenerateSampleFromDslx(std::move(dslx_text), generator_options,
+                                sample_options, value_gen);
+}
 
+absl::StatusOr<Sample> GenerateSampleFromDslx(
+    std::string dslx_text, const AstGeneratorOptions& generator_options,
+    const SampleOptions& sample_options, ValueGenerator* value_gen) {
+  constexpr std::string_view top_name = "main";
   XLS_ASSIGN_OR_RETURN(bool has_nb_recv, HasNonBlockingRecv(dslx_text));
   // Generate the sample options which is how to *run* the generated
   // sample. AstGeneratorOptions 'options' is how to *generate* the sample.
@@ -337,16 +337,19 @@ absl::StatusOr<Sample> GenerateSample(
       ParseAndTypecheck(dslx_text, "sample.x", "sample", &import_data));
   std::optional<ModuleMember*> module_member =
       tm.module->FindMemberWithName(top_name);
-  XLS_CHECK(module_member.has_value());
+  if (!module_member.has_value()) {
+    return absl::NotFoundError(
+        absl::StrCat("Sample has no top member named ", top_name));
+  }
   ModuleMember* member = module_member.value();
 
   if (generator_options.generate_proc) {
-    XLS_CHECK(std::holds_alternative<dslx::Proc*>(*member));
+    XLS_RET_CHECK(std::holds_alternative<dslx::Proc*>(*member));
     sample_options_copy.set_top_type(TopType::kProc);
     return GenerateProcSample(std::get<dslx::Proc*>(*member), tm,
                               sample_options_copy, value_gen, dslx_text);
   }
-  XLS_CHECK(std::holds_alternative<dslx::Function*>(*member));
+  XLS_RET_CHECK(std::holds_alternative<dslx::Function*>(*member));
   sample_options_copy.set_top_type(TopType::kFunction);
   return GenerateFunctionSample(std::get<dslx::Function*>(*member), tm,
                                 sample_options_copy, value_gen, dslx_text);
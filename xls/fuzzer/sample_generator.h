@@ -16,6 +16,7 @@
 #define XLS_FUZZER_SAMPLE_GENERATOR_H_
 
 #include <random>
+#include <string>
 
 #include "absl/types/span.h"
 #include "xls/dslx/type_system/concrete_type.h"
@@ -30,6 +31,15 @@ absl::StatusOr<Sample> GenerateSample(
     const dslx::AstGeneratorOptions& generator_options,
     const SampleOptions& sample_options, ValueGenerator* value_gen);
 
+// Returns a Sample of the given DSLX, e.g. a mutation of a generated sample,
+// with arguments (and codegen arguments) generated as by GenerateSample. The
+// top member must be named "main" and be a proc iff
+// `generator_options.generate_proc`. Returns an error if the DSLX does not
+// typecheck.
+absl::StatusOr<Sample> GenerateSampleFromDslx(
+    std::string dslx_text, const dslx::AstGeneratorOptions& generator_options,
+    const SampleOptions& sample_options, ValueGenerator* value_gen);
+
 }  // namespace xls
 
 #endif  // XLS_FUZZER_SAMPLE_GENERATOR_H_
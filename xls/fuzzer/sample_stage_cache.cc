@@ -0,0 +1,84 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_stage_cache.h"
+
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+absl::StatusOr<std::unique_ptr<SampleStageCache>> SampleStageCache::Create(
+    const std::filesystem::path& directory,
+    std::optional<std::string> build_id) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  if (!build_id.has_value()) {
+    XLS_ASSIGN_OR_RETURN(build_id, ComputeFileBuildId("/proc/self/exe"));
+  }
+  return absl::WrapUnique(
+      new SampleStageCache(directory, *std::move(build_id)));
+}
+
+absl::StatusOr<std::string> SampleStageCache::FileBuildId(
+    const std::filesystem::path& path) {
+  absl::MutexLock lock(&mutex_);
+  auto it = file_build_ids_.find(path.string());
+  if (it != file_build_ids_.end()) {
+    return it->second;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string id, ComputeFileBuildId(path));
+  file_build_ids_[path.string()] = id;
+  return id;
+}
+
+std::string SampleStageCache::Key(std::string_view stage,
+                                  absl::Span<const std::string> inputs) const {
+  std::vector<std::string_view> pieces = {build_id_, stage};
+  pieces.insert(pieces.end(), inputs.begin(), inputs.end());
+  return ContentDigest(pieces);
+}
+
+absl::StatusOr<std::optional<std::string>> SampleStageCache::Lookup(
+    std::string_view key) {
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> output, cache_.Read(key));
+  absl::MutexLock lock(&mutex_);
+  if (!output.has_value()) {
+    ++miss_count_;
+    return std::nullopt;
+  }
+  ++hit_count_;
+  return output;
+}
+
+absl::Status SampleStageCache::Insert(std::string_view key,
+                                      std::string_view output) {
+  return cache_.Write(key, output);
+}
+
+int64_t SampleStageCache::hit_count() const {
+  absl::MutexLock lock(&mutex_);
+  return hit_count_;
+}
+
+int64_t SampleStageCache::miss_count() const {
+  absl::MutexLock lock(&mutex_);
+  return miss_count_;
+}
+
+}  // namespace xls
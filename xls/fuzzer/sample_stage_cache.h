@@ -0,0 +1,97 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SAMPLE_STAGE_CACHE_H_
+#define XLS_FUZZER_SAMPLE_STAGE_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/file/content_addressed_cache.h"
+
+namespace xls {
+
+// A content-addressed cache of the outputs of the stages of fuzz samples (IR,
+// optimized IR, Verilog, results, ...), kept in a directory so that re-running
+// a sample, e.g. when triaging a crasher, skips the stages whose inputs did
+// not change.
+//
+// An entry is keyed by the stage name, the stage inputs (e.g. the text of the
+// sample and the stage options) and the build IDs of the tools running the
+// stage, so rebuilding a tool invalidates its entries. Only the outputs of
+// stages which succeeded are cached; failing stages always run again.
+//
+// Thread-safe, and entries are written atomically, so several processes may
+// share a cache directory.
+class SampleStageCache {
+ public:
+  // Creates a cache in `directory`, creating it if need be. `build_id`
+  // identifies the build of the stages run in process; by default it is
+  // derived from the running executable (see FileBuildId).
+  static absl::StatusOr<std::unique_ptr<SampleStageCache>> Create(
+      const std::filesystem::path& directory,
+      std::optional<std::string> build_id = std::nullopt);
+
+  // Returns the ID of the build of the given executable (see
+  // ComputeFileBuildId). Memoized.
+  absl::StatusOr<std::string> FileBuildId(const std::filesystem::path& path);
+
+  // Returns the key of the stage `stage` run on `inputs` by this build. Stages
+  // run by other executables should include their FileBuildId in `inputs`.
+  std::string Key(std::string_view stage,
+                  absl::Span<const std::string> inputs) const;
+
+  // Returns the output stored under `key`, or nullopt if there is none.
+  absl::StatusOr<std::optional<std::string>> Lookup(std::string_view key);
+
+  // Stores `output` under `key`.
+  absl::Status Insert(std::string_view key, std::string_view output);
+
+  const std::string& build_id() const { return build_id_; }
+  int64_t hit_count() const;
+  int64_t miss_count() const;
+
+ private:
+  // Stage outputs are stored in files named by their key, in subdirectories
+  // named by the first characters of the key to keep directories small.
+  static constexpr int64_t kShardPrefixLength = 2;
+
+  SampleStageCache(std::filesystem::path directory, std::string build_id)
+      : cache_(std::move(directory), /*suffix=*/"", kShardPrefixLength),
+        build_id_(std::move(build_id)) {}
+
+  const ContentAddressedCache cache_;
+  const std::string build_id_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::string> file_build_ids_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SAMPLE_STAGE_CACHE_H_
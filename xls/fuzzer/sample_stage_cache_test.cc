@@ -0,0 +1,76 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_stage_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+TEST(SampleStageCacheTest, InsertAndLookup) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SampleStageCache> cache,
+                           SampleStageCache::Create(dir.path(), "build1"));
+  std::string key = cache->Key("optimize", {"package p"});
+  EXPECT_THAT(cache->Lookup(key), IsOkAndHolds(std::nullopt));
+  XLS_ASSERT_OK(cache->Insert(key, "optimized"));
+  EXPECT_THAT(cache->Lookup(key), IsOkAndHolds("optimized"));
+  EXPECT_EQ(cache->hit_count(), 1);
+  EXPECT_EQ(cache->miss_count(), 1);
+
+  // Entries persist across caches sharing the directory.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SampleStageCache> other,
+                           SampleStageCache::Create(dir.path(), "build1"));
+  EXPECT_THAT(other->Lookup(key), IsOkAndHolds("optimized"));
+}
+
+TEST(SampleStageCacheTest, KeysDistinguishStagesInputsAndBuilds) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SampleStageCache> cache,
+                           SampleStageCache::Create(dir.path(), "build1"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SampleStageCache> rebuilt,
+                           SampleStageCache::Create(dir.path(), "build2"));
+  std::string key = cache->Key("codegen", {"ab", "c"});
+  EXPECT_EQ(key, cache->Key("codegen", {"ab", "c"}));
+  EXPECT_NE(key, cache->Key("simulate", {"ab", "c"}));
+  EXPECT_NE(key, cache->Key("codegen", {"a", "bc"}));
+  EXPECT_NE(key, cache->Key("codegen", {"abc"}));
+  EXPECT_NE(key, rebuilt->Key("codegen", {"ab", "c"}));
+}
+
+TEST(SampleStageCacheTest, FileBuildId) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SampleStageCache> cache,
+                           SampleStageCache::Create(dir.path()));
+  EXPECT_FALSE(cache->build_id().empty());
+  XLS_ASSERT_OK(SetFileContents(dir.path() / "tool", "v1"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string id,
+                           cache->FileBuildId(dir.path() / "tool"));
+  EXPECT_THAT(cache->FileBuildId(dir.path() / "tool"), IsOkAndHolds(id));
+  EXPECT_FALSE(cache->FileBuildId(dir.path() / "missing").ok());
+}
+
+}  // namespace
+}  // namespace xls
@@ -13,6 +13,9 @@
 // limitations under the License.
 #include "xls/fuzzer/value_generator.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "xls/common/status/ret_check.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/type_system/unwrap_meta_type.h"
@@ -35,6 +38,79 @@ using dslx::Number;
 using dslx::TupleType;
 using dslx::TypeAnnotation;
 
+namespace {
+
+// A bits-typed leaf of an argument type.
+struct Leaf {
+  int64_t bit_count;
+};
+
+// Appends the bits leaves of `type` to `leaves` in pre-order.
+absl::Status FlattenLeaves(const ConcreteType& type,
+                           std::vector<Leaf>* leaves) {
+  if (auto* channel_type = dynamic_cast<const ChannelType*>(&type)) {
+    return FlattenLeaves(channel_type->payload_type(), leaves);
+  }
+  if (auto* tuple_type = dynamic_cast<const TupleType*>(&type)) {
+    for (const std::unique_ptr<ConcreteType>& t : tuple_type->members()) {
+      XLS_RETURN_IF_ERROR(FlattenLeaves(*t, leaves));
+    }
+    return absl::OkStatus();
+  }
+  if (auto* array_type = dynamic_cast<const ArrayType*>(&type)) {
+    XLS_ASSIGN_OR_RETURN(int64_t array_size, array_type->size().GetAsInt64());
+    for (int64_t i = 0; i < array_size; ++i) {
+      XLS_RETURN_IF_ERROR(FlattenLeaves(array_type->element_type(), leaves));
+    }
+    return absl::OkStatus();
+  }
+  auto* bits_type = dynamic_cast<const BitsType*>(&type);
+  XLS_RET_CHECK(bits_type != nullptr) << type.ToString();
+  XLS_ASSIGN_OR_RETURN(int64_t bit_count, bits_type->size().GetAsInt64());
+  leaves->push_back(Leaf{bit_count});
+  return absl::OkStatus();
+}
+
+// Returns the value of the given type whose bits leaves are taken from
+// `leaves`, starting at `*next_leaf`.
+absl::StatusOr<InterpValue> BuildValue(const ConcreteType& type,
+                                       std::vector<Bits>& leaves,
+                                       int64_t* next_leaf) {
+  if (auto* channel_type = dynamic_cast<const ChannelType*>(&type)) {
+    return BuildValue(channel_type->payload_type(), leaves, next_leaf);
+  }
+  if (auto* tuple_type = dynamic_cast<const TupleType*>(&type)) {
+    std::vector<InterpValue> members;
+    members.reserve(tuple_type->members().size());
+    for (const std::unique_ptr<ConcreteType>& t : tuple_type->members()) {
+      XLS_ASSIGN_OR_RETURN(InterpValue member,
+                           BuildValue(*t, leaves, next_leaf));
+      members.push_back(std::move(member));
+    }
+    return InterpValue::MakeTuple(std::move(members));
+  }
+  if (auto* array_type = dynamic_cast<const ArrayType*>(&type)) {
+    XLS_ASSIGN_OR_RETURN(int64_t array_size, array_type->size().GetAsInt64());
+    std::vector<InterpValue> elements;
+    elements.reserve(array_size);
+    for (int64_t i = 0; i < array_size; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          InterpValue element,
+          BuildValue(array_type->element_type(), leaves, next_leaf));
+      elements.push_back(std::move(element));
+    }
+    return InterpValue::MakeArray(std::move(elements));
+  }
+  auto* bits_type = dynamic_cast<const BitsType*>(&type);
+  XLS_RET_CHECK(bits_type != nullptr) << type.ToString();
+  XLS_RET_CHECK_LT(*next_leaf, leaves.size());
+  return InterpValue::MakeBits(
+      bits_type->is_signed() ? InterpValueTag::kSBits : InterpValueTag::kUBits,
+      std::move(leaves[(*next_leaf)++]));
+}
+
+}  // namespace
+
 bool ValueGenerator::RandomBool() {
   std::bernoulli_distribution d(0.5);
   return d(rng_);
@@ -84,6 +160,10 @@ int64_t ValueGenerator::RandRangeBiasedTowardsZero(int64_t limit) {
 }
 
 Bits ValueGenerator::GenerateBits(int64_t bit_count) {
+  return GenerateBitsImpl(bit_count, /*word_at_a_time=*/false);
+}
+
+Bits ValueGenerator::GenerateBitsImpl(int64_t bit_count, bool word_at_a_time) {
   if (bit_count == 0) {
     return Bits(0);
   }
@@ -129,8 +209,14 @@ Bits ValueGenerator::GenerateBits(int64_t bit_count) {
     }
     case kRandom: {
       InlineBitmap bitmap(bit_count);
-      for (int64_t i = 0; i < bit_count; ++i) {
-        bitmap.Set(i, RandomBool());
+      if (word_at_a_time) {
+        for (int64_t i = 0; i < bitmap.word_count(); ++i) {
+          bitmap.SetWord(i, rng_());
+        }
+      } else {
+        for (int64_t i = 0; i < bit_count; ++i) {
+          bitmap.Set(i, RandomBool());
+        }
       }
       return Bits::FromBitmap(std::move(bitmap));
     }
@@ -139,6 +225,60 @@ Bits ValueGenerator::GenerateBits(int64_t bit_count) {
   }
 }
 
+Bits ValueGenerator::GenerateCornerCaseBits(int64_t bit_count) {
+  if (bit_count == 0) {
+    return Bits(0);
+  }
+  enum CornerCase {
+    kZero,
+    kOne,
+    kAllOnes,
+    kSignedMax,
+    kSignedMin,
+    kOneHot,
+  };
+  CornerCase choice = static_cast<CornerCase>(RandRange(kOneHot + 1));
+  switch (choice) {
+    case kZero:
+      return Bits(bit_count);
+    case kOne:
+      return UBits(1, bit_count);
+    case kAllOnes:
+      return Bits::AllOnes(bit_count);
+    case kSignedMax:
+      return bits_ops::ShiftRightLogical(Bits::AllOnes(bit_count), 1);
+    case kSignedMin:
+      return Bits::PowerOfTwo(bit_count - 1, bit_count);
+    case kOneHot:
+      return Bits::PowerOfTwo(RandRange(bit_count), bit_count);
+  }
+  XLS_LOG(FATAL) << "Impossible choice: " << choice;
+}
+
+Bits ValueGenerator::MutateBits(
+    const Bits& bits, int64_t bit_count,
+    absl::FunctionRef<Bits(int64_t)> generate_bits) {
+  Bits to_mutate = bits;
+  if (bit_count > to_mutate.bit_count()) {
+    to_mutate = bits_ops::Concat(
+        {to_mutate, generate_bits(bit_count - to_mutate.bit_count())});
+  } else {
+    to_mutate = to_mutate.Slice(0, bit_count);
+  }
+  if (bit_count == 0) {
+    return to_mutate;
+  }
+
+  InlineBitmap bitmap = to_mutate.bitmap();
+  int64_t mutation_count = RandRangeBiasedTowardsZero(bit_count);
+  for (int64_t i = 0; i < mutation_count; ++i) {
+    // Pick a random bit and flip it.
+    int64_t bitno = RandRange(bit_count);
+    bitmap.Set(bitno, !bitmap.Get(bitno));
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
 absl::StatusOr<InterpValue> ValueGenerator::GenerateBitValue(int64_t bit_count,
                                                              bool is_signed) {
   InterpValueTag tag =
@@ -199,33 +339,16 @@ absl::StatusOr<InterpValue> ValueGenerator::GenerateInterpValue(
     return GenerateUnbiasedValue(*bits_type);
   }
 
-  Bits to_mutate = prior[index].GetBitsOrDie();
-
   XLS_ASSIGN_OR_RETURN(const int64_t target_bit_count,
                        bits_type->size().GetAsInt64());
-  if (target_bit_count > to_mutate.bit_count()) {
-    XLS_ASSIGN_OR_RETURN(
-        InterpValue addendum,
-        GenerateBitValue(target_bit_count - to_mutate.bit_count(),
-                         /*is_signed=*/false));
-    to_mutate = bits_ops::Concat({to_mutate, addendum.GetBitsOrDie()});
-  } else {
-    to_mutate = to_mutate.Slice(0, target_bit_count);
-  }
-
-  InlineBitmap bitmap = to_mutate.bitmap();
-  XLS_RET_CHECK_EQ(bitmap.bit_count(), target_bit_count);
-  int64_t mutation_count = RandRangeBiasedTowardsZero(target_bit_count);
-
-  for (int64_t i = 0; i < mutation_count; ++i) {
-    // Pick a random bit and flip it.
-    int64_t bitno = RandRange(target_bit_count);
-    bitmap.Set(bitno, !bitmap.Get(bitno));
-  }
+  Bits mutated = MutateBits(prior[index].GetBitsOrDie(), target_bit_count,
+                            [this](int64_t bit_count) {
+                              return GenerateBits(bit_count);
+                            });
 
   bool is_signed = bits_type->is_signed();
   auto tag = is_signed ? InterpValueTag::kSBits : InterpValueTag::kUBits;
-  return InterpValue::MakeBits(tag, Bits::FromBitmap(std::move(bitmap)));
+  return InterpValue::MakeBits(tag, std::move(mutated));
 }
 
 absl::StatusOr<std::vector<InterpValue>> ValueGenerator::GenerateInterpValues(
@@ -240,6 +363,63 @@ absl::StatusOr<std::vector<InterpValue>> ValueGenerator::GenerateInterpValues(
   return args;
 }
 
+absl::StatusOr<std::vector<std::vector<InterpValue>>>
+ValueGenerator::GenerateArgsBatch(
+    absl::Span<const ConcreteType* const> arg_types, int64_t count,
+    const ArgsBatchOptions& options) {
+  std::vector<std::vector<Leaf>> arg_leaves(arg_types.size());
+  for (int64_t i = 0; i < arg_types.size(); ++i) {
+    XLS_RET_CHECK(arg_types[i] != nullptr);
+    XLS_RET_CHECK(!arg_types[i]->IsMeta());
+    XLS_RETURN_IF_ERROR(FlattenLeaves(*arg_types[i], &arg_leaves[i]));
+  }
+
+  // Pick exactly the requested share of corner-case calls, spread over the
+  // batch.
+  std::vector<char> is_corner_case(count, 0);
+  int64_t corner_case_count = std::llround(
+      std::clamp(options.corner_case_fraction, 0.0, 1.0) * count);
+  std::fill_n(is_corner_case.begin(), corner_case_count, 1);
+  std::shuffle(is_corner_case.begin(), is_corner_case.end(), rng_);
+
+  auto generate_bits = [this](int64_t bit_count) {
+    return GenerateBitsImpl(bit_count, /*word_at_a_time=*/true);
+  };
+  std::vector<std::vector<InterpValue>> batch;
+  batch.reserve(count);
+  std::vector<Bits> leaves;
+  for (int64_t call = 0; call < count; ++call) {
+    std::vector<InterpValue> args;
+    args.reserve(arg_types.size());
+    for (int64_t i = 0; i < arg_types.size(); ++i) {
+      leaves.clear();
+      for (const Leaf& leaf : arg_leaves[i]) {
+        if (is_corner_case[call]) {
+          leaves.push_back(GenerateCornerCaseBits(leaf.bit_count));
+          continue;
+        }
+        // As in GenerateInterpValue, half of the leaves are mutations of a
+        // prior bits argument of the same call.
+        if (args.empty() || RandomDouble() < 0.5) {
+          leaves.push_back(generate_bits(leaf.bit_count));
+          continue;
+        }
+        const InterpValue& prior = args[RandRange(args.size())];
+        leaves.push_back(prior.IsBits()
+                             ? MutateBits(prior.GetBitsOrDie(), leaf.bit_count,
+                                          generate_bits)
+                             : generate_bits(leaf.bit_count));
+      }
+      int64_t next_leaf = 0;
+      XLS_ASSIGN_OR_RETURN(InterpValue arg,
+                           BuildValue(*arg_types[i], leaves, &next_leaf));
+      args.push_back(std::move(arg));
+    }
+    batch.push_back(std::move(args));
+  }
+  return batch;
+}
+
 absl::StatusOr<int64_t> ValueGenerator::GetArraySize(const Expr* dim) {
   if (const auto* number = dynamic_cast<const dslx::Number*>(dim);
       number != nullptr) {
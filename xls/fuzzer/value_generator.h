@@ -17,6 +17,7 @@
 #include <random>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/dslx/interp_value.h"
@@ -24,6 +25,15 @@
 
 namespace xls {
 
+// Options for ValueGenerator::GenerateArgsBatch.
+struct ArgsBatchOptions {
+  // The fraction of the calls in the batch whose arguments consist entirely of
+  // corner-case bits values: zero, one, all ones, the signed minimum and
+  // maximum, and one-hot values. Such values expose overflow and sign handling
+  // bugs which uniformly random values rarely reach.
+  double corner_case_fraction = 0.0;
+};
+
 // Contains logic to generate random values for use by fuzzer components.
 class ValueGenerator {
  public:
@@ -73,6 +83,16 @@ class ValueGenerator {
   absl::StatusOr<std::vector<dslx::InterpValue>> GenerateInterpValues(
       absl::Span<const dslx::ConcreteType* const> arg_types);
 
+  // Returns `count` lists of randomly generated values of the given types, as
+  // calling GenerateInterpValues `count` times would. For large batches this
+  // is considerably faster: the types are flattened into their bits leaves
+  // once for the whole batch, and random bits are generated a word rather than
+  // a bit at a time.
+  absl::StatusOr<std::vector<std::vector<dslx::InterpValue>>>
+  GenerateArgsBatch(absl::Span<const dslx::ConcreteType* const> arg_types,
+                    int64_t count,
+                    const ArgsBatchOptions& options = ArgsBatchOptions());
+
   // Randomly generates an Expr* holding a value of the given type.
   // Note: Currently, AstGenerator only produces single-dimensional arrays with
   // [AST] Number-typed or ConstantDef-defined sizes. If that changes, then this
@@ -86,6 +106,18 @@ class ValueGenerator {
   absl::StatusOr<dslx::InterpValue> GenerateUnbiasedValue(
       const dslx::BitsType& bits_type);
 
+  // As GenerateBits, but if `word_at_a_time` random bit patterns are filled a
+  // word at a time.
+  Bits GenerateBitsImpl(int64_t bit_count, bool word_at_a_time);
+
+  // Returns a corner-case value of the given size (see ArgsBatchOptions).
+  Bits GenerateCornerCaseBits(int64_t bit_count);
+
+  // Resizes `bits` to `bit_count` bits, extending it with bits from
+  // `generate_bits`, and flips a number of its bits biased towards zero.
+  Bits MutateBits(const Bits& bits, int64_t bit_count,
+                  absl::FunctionRef<Bits(int64_t)> generate_bits);
+
   // Evaluates the given Expr* (holding the declaration of an
   // ArrayTypeAnnotation's size) and returns its resolved integer value.
   // This relies on current behavior of AstGenerator, namely that array dims are
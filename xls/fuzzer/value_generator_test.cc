@@ -272,6 +272,74 @@ TEST(SampleGeneratorTest, GenerateArrayArgument) {
   EXPECT_THAT(arguments[0].GetValuesOrDie()[0].GetBitCount(), IsOkAndHolds(4));
 }
 
+TEST(SampleGeneratorTest, GenerateArgsBatch) {
+  std::vector<std::unique_ptr<dslx::ConcreteType>> tuple_members;
+  tuple_members.push_back(
+      std::make_unique<dslx::BitsType>(/*signed=*/false, /*size=*/130));
+  tuple_members.push_back(std::make_unique<dslx::ArrayType>(
+      std::make_unique<dslx::BitsType>(/*signed=*/true, /*size=*/4),
+      dslx::ConcreteTypeDim::CreateU32(3)));
+  std::vector<std::unique_ptr<dslx::ConcreteType>> param_types;
+  param_types.push_back(
+      std::make_unique<dslx::BitsType>(/*signed=*/true, /*size=*/7));
+  param_types.push_back(
+      std::make_unique<dslx::TupleType>(std::move(tuple_members)));
+  std::vector<const dslx::ConcreteType*> param_type_ptrs;
+  for (auto& t : param_types) {
+    param_type_ptrs.push_back(t.get());
+  }
+
+  ValueGenerator value_gen(std::mt19937_64{});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::vector<dslx::InterpValue>> batch,
+      value_gen.GenerateArgsBatch(param_type_ptrs, /*count=*/100));
+  ASSERT_EQ(batch.size(), 100);
+  for (const std::vector<dslx::InterpValue>& args : batch) {
+    ASSERT_EQ(args.size(), 2);
+    ASSERT_TRUE(args[0].IsSBits());
+    EXPECT_THAT(args[0].GetBitCount(), IsOkAndHolds(7));
+    ASSERT_TRUE(args[1].IsTuple());
+    const std::vector<dslx::InterpValue>& members =
+        args[1].GetValuesOrDie();
+    ASSERT_TRUE(members[0].IsUBits());
+    EXPECT_THAT(members[0].GetBitCount(), IsOkAndHolds(130));
+    EXPECT_THAT(members[1].GetLength(), IsOkAndHolds(3));
+    EXPECT_TRUE(members[1].GetValuesOrDie()[2].IsSBits());
+  }
+
+  // The batch is determined by the seed.
+  ValueGenerator same_gen(std::mt19937_64{});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::vector<dslx::InterpValue>> same_batch,
+      same_gen.GenerateArgsBatch(param_type_ptrs, /*count=*/100));
+  for (int64_t i = 0; i < batch.size(); ++i) {
+    for (int64_t j = 0; j < batch[i].size(); ++j) {
+      EXPECT_TRUE(batch[i][j].Eq(same_batch[i][j]));
+    }
+  }
+}
+
+TEST(SampleGeneratorTest, GenerateArgsBatchOfCornerCases) {
+  std::vector<std::unique_ptr<dslx::ConcreteType>> param_types;
+  param_types.push_back(
+      std::make_unique<dslx::BitsType>(/*signed=*/false, /*size=*/32));
+  std::vector<const dslx::ConcreteType*> param_type_ptrs = {
+      param_types[0].get()};
+  ArgsBatchOptions options;
+  options.corner_case_fraction = 1.0;
+  ValueGenerator value_gen(std::mt19937_64{});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::vector<dslx::InterpValue>> batch,
+      value_gen.GenerateArgsBatch(param_type_ptrs, /*count=*/200, options));
+  for (const std::vector<dslx::InterpValue>& args : batch) {
+    const Bits& bits = args[0].GetBitsOrDie();
+    // Every corner case is zero, all ones, the signed maximum or one-hot.
+    EXPECT_TRUE(bits.IsZero() || bits.IsAllOnes() ||
+                bits == UBits(0x7fffffff, 32) || bits.PopCount() == 1)
+        << bits.ToString();
+  }
+}
+
 TEST(SampleGeneratorTest, GenerateDslxConstantBits) {
   dslx::Module module("test", /*fs_path=*/std::nullopt);
   ValueGenerator value_gen(std::mt19937_64{});
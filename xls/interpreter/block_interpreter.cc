@@ -26,7 +26,7 @@ class BlockInterpreter : public IrInterpreter {
  public:
   BlockInterpreter(const absl::flat_hash_map<std::string, Value>& inputs,
                    const absl::flat_hash_map<std::string, Value>& reg_state)
-      : IrInterpreter(/*args=*/{}), inputs_(inputs), reg_state_(reg_state) {}
+      : inputs_(inputs), reg_state_(reg_state) {}
 
   absl::Status HandleInputPort(InputPort* input_port) override {
     auto port_iter = inputs_.find(input_port->GetName());
@@ -39,6 +39,9 @@ class BlockInterpreter : public IrInterpreter {
   }
 
   absl::Status HandleOutputPort(OutputPort* output_port) override {
+    // The operand value is recorded here as it may be freed once the output
+    // port is evaluated.
+    outputs_[output_port->GetName()] = ConsumeOperand(output_port, 0);
     // Output ports have empty tuple types.
     return SetValueResult(output_port, Value::Tuple({}));
   }
@@ -88,6 +91,10 @@ class BlockInterpreter : public IrInterpreter {
     return std::move(next_reg_state_);
   }
 
+  absl::flat_hash_map<std::string, Value>&& MoveOutputs() {
+    return std::move(outputs_);
+  }
+
  private:
   // Values fed to the input ports.
   const absl::flat_hash_map<std::string, Value> inputs_;
@@ -97,6 +104,9 @@ class BlockInterpreter : public IrInterpreter {
 
   // The next state for the registers.
   absl::flat_hash_map<std::string, Value> next_reg_state_;
+
+  // The values of the output ports by port name.
+  absl::flat_hash_map<std::string, Value> outputs_;
 };
 
 }  // namespace
@@ -133,13 +143,11 @@ absl::StatusOr<BlockRunResult> BlockRun(
   }
 
   BlockInterpreter interpreter(inputs, reg_state);
+  XLS_RETURN_IF_ERROR(interpreter.ReleaseValuesAfterLastUse(block));
   XLS_RETURN_IF_ERROR(block->Accept(&interpreter));
 
   BlockRunResult result;
-  for (Node* port : block->GetOutputPorts()) {
-    result.outputs[port->GetName()] =
-        interpreter.ResolveAsValue(port->operand(0));
-  }
+  result.outputs = std::move(interpreter.MoveOutputs());
   result.reg_state = std::move(interpreter.MoveRegState());
 
   return result;
@@ -445,20 +453,15 @@ absl::StatusOr<std::vector<uint64_t>> ChannelSink::GetOutputSequenceAsUint64()
   return ret;
 }
 
-absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
-    Block* block, absl::Span<ChannelSource> channel_sources,
+absl::StatusOr<BlockIOResults> RunChannelizedSequentialBlock(
+    Block* block, const BlockCycleFunction& run_cycle,
+    absl::Span<ChannelSource> channel_sources,
     absl::Span<ChannelSink> channel_sinks,
     absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
     std::optional<verilog::ResetProto> reset, int64_t seed) {
   std::minstd_rand random_engine;
   random_engine.seed(seed);
 
-  // Initial register state is zero for all registers.
-  absl::flat_hash_map<std::string, Value> reg_state;
-  for (Register* reg : block->GetRegisters()) {
-    reg_state[reg->name()] = ZeroOfType(reg->type());
-  }
-
   int64_t max_cycle_count = inputs.size();
 
   BlockIOResults block_io_results;
@@ -484,35 +487,55 @@ absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
     }
 
     // Block results
-    XLS_ASSIGN_OR_RETURN(BlockRunResult result,
-                         BlockRun(input_set, reg_state, block));
+    absl::flat_hash_map<std::string, Value> outputs;
+    XLS_ASSIGN_OR_RETURN(outputs, run_cycle(input_set));
 
     // Sources get ready
     for (ChannelSource& src : channel_sources) {
-      XLS_RETURN_IF_ERROR(src.GetBlockOutputs(cycle, result.outputs));
+      XLS_RETURN_IF_ERROR(src.GetBlockOutputs(cycle, outputs));
     }
 
     // Sinks get data/valid
     for (ChannelSink& sink : channel_sinks) {
-      XLS_RETURN_IF_ERROR(sink.GetBlockOutputs(cycle, result.outputs));
+      XLS_RETURN_IF_ERROR(sink.GetBlockOutputs(cycle, outputs));
     }
 
     if (XLS_VLOG_IS_ON(3)) {
       XLS_VLOG(3) << absl::StrFormat("Outputs Cycle %d", cycle);
-      for (auto [name, val] : result.outputs) {
+      for (auto [name, val] : outputs) {
         XLS_VLOG(3) << absl::StrFormat("%s: %s", name, val.ToString());
       }
     }
 
-    reg_state = std::move(result.reg_state);
-
     block_io_results.inputs.push_back(std::move(input_set));
-    block_io_results.outputs.push_back(std::move(result.outputs));
+    block_io_results.outputs.push_back(std::move(outputs));
   }
 
   return block_io_results;
 }
 
+absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset, int64_t seed) {
+  // Initial register state is zero for all registers.
+  absl::flat_hash_map<std::string, Value> reg_state;
+  for (Register* reg : block->GetRegisters()) {
+    reg_state[reg->name()] = ZeroOfType(reg->type());
+  }
+  auto run_cycle =
+      [&](const absl::flat_hash_map<std::string, Value>& input_set)
+      -> absl::StatusOr<absl::flat_hash_map<std::string, Value>> {
+    XLS_ASSIGN_OR_RETURN(BlockRunResult result,
+                         BlockRun(input_set, reg_state, block));
+    reg_state = std::move(result.reg_state);
+    return std::move(result.outputs);
+  };
+  return RunChannelizedSequentialBlock(block, run_cycle, channel_sources,
+                                       channel_sinks, inputs, reset, seed);
+}
+
 absl::StatusOr<BlockIOResultsAsUint64>
 InterpretChannelizedSequentialBlockWithUint64(
     Block* block, absl::Span<ChannelSource> channel_sources,
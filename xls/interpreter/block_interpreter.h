@@ -15,6 +15,7 @@
 #ifndef XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 #define XLS_INTERPRETER_BLOCK_INTERPRETER_H_
 
+#include <functional>
 #include <random>
 
 #include "absl/container/flat_hash_map.h"
@@ -216,6 +217,23 @@ absl::StatusOr<BlockIOResults> InterpretChannelizedSequentialBlock(
     absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
     std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
 
+// Evaluates one cycle of a block given the values of its input ports and
+// returns the values of its output ports. The function holds the register
+// state of the block and clocks the registers after each call.
+using BlockCycleFunction =
+    std::function<absl::StatusOr<absl::flat_hash_map<std::string, Value>>(
+        const absl::flat_hash_map<std::string, Value>& inputs)>;
+
+// As InterpretChannelizedSequentialBlock, but evaluates each cycle of the
+// block with `run_cycle`. This allows the same channel simulation to drive
+// different evaluators of the block (e.g., the interpreter or the JIT).
+absl::StatusOr<BlockIOResults> RunChannelizedSequentialBlock(
+    Block* block, const BlockCycleFunction& run_cycle,
+    absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
+
 // Variant which accepts and returns uint64_t values instead of xls::Values.
 absl::StatusOr<BlockIOResultsAsUint64>
 InterpretChannelizedSequentialBlockWithUint64(
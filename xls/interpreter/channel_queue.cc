@@ -14,6 +14,9 @@
 
 #include "xls/interpreter/channel_queue.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/status_macros.h"
@@ -73,6 +76,62 @@ void ChannelQueue::WriteInternal(const Value& value) {
 
 std::optional<Value> ChannelQueue::Read() {
   absl::MutexLock lock(&mutex_);
+  std::optional<Value> value = GenerateAndReadInternal();
+  XLS_VLOG(4) << absl::StreamFormat(
+      "Reading data from channel %s: %s", channel_->name(),
+      value.has_value() ? value->ToString() : "(none)");
+  XLS_VLOG(4) << absl::StreamFormat("Channel now has %d elements",
+                                    queue_.size());
+  return value;
+}
+
+absl::Status ChannelQueue::WriteBatch(absl::Span<const Value> values) {
+  XLS_VLOG(4) << absl::StreamFormat("Writing %d values to channel %s",
+                                    values.size(), channel_->name());
+  absl::MutexLock lock(&mutex_);
+  if (generator_.has_value()) {
+    return absl::InternalError(
+        "Cannot write to ChannelQueue because it has a generator function.");
+  }
+  for (const Value& value : values) {
+    if (!ValueConformsToType(value, channel_->type())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Channel %s expects values to have type %s, got: %s",
+          channel_->name(), channel_->type()->ToString(), value.ToString()));
+    }
+  }
+  for (const Value& value : values) {
+    WriteInternal(value);
+  }
+  return absl::OkStatus();
+}
+
+std::vector<Value> ChannelQueue::ReadBatch(int64_t max_count) {
+  absl::MutexLock lock(&mutex_);
+  if (channel_->kind() == ChannelKind::kSingleValue) {
+    max_count = std::min<int64_t>(max_count, 1);
+  }
+  std::vector<Value> values;
+  values.reserve(std::max<int64_t>(
+      std::min<int64_t>(max_count, GetSizeInternal()), 0));
+  while (static_cast<int64_t>(values.size()) < max_count) {
+    std::optional<Value> value = GenerateAndReadInternal();
+    if (!value.has_value()) {
+      break;
+    }
+    values.push_back(std::move(value.value()));
+  }
+  XLS_VLOG(4) << absl::StreamFormat("Read %d values from channel %s",
+                                    values.size(), channel_->name());
+  return values;
+}
+
+bool ChannelQueue::Peek(absl::FunctionRef<void(const Value&)> fn) {
+  absl::MutexLock lock(&mutex_);
+  return PeekInternal(fn);
+}
+
+std::optional<Value> ChannelQueue::GenerateAndReadInternal() {
   if (generator_.has_value()) {
     // Write/ReadInternal are virtual and may have other side-effects so rather
     // than directly returning the generated value, write then read it.
@@ -81,17 +140,19 @@ std::optional<Value> ChannelQueue::Read() {
       WriteInternal(generated_value.value());
     }
   }
-  std::optional<Value> value = ReadInternal();
-  XLS_VLOG(4) << absl::StreamFormat(
-      "Reading data from channel %s: %s", channel_->name(),
-      value.has_value() ? value->ToString() : "(none)");
-  XLS_VLOG(4) << absl::StreamFormat("Channel now has %d elements",
-                                    queue_.size());
-  return value;
+  return ReadInternal();
 }
 
 int64_t ChannelQueue::GetSizeInternal() const { return queue_.size(); }
 
+bool ChannelQueue::PeekInternal(absl::FunctionRef<void(const Value&)> fn) {
+  if (queue_.empty()) {
+    return false;
+  }
+  fn(queue_.front());
+  return true;
+}
+
 std::optional<Value> ChannelQueue::ReadInternal() {
   if (queue_.empty()) {
     return std::nullopt;
@@ -179,4 +240,27 @@ absl::StatusOr<ChannelQueue*> ChannelQueueManager::GetQueueByName(
   return queues_.at(channel).get();
 }
 
+absl::Status ChannelQueueManager::AttachModel(
+    std::unique_ptr<ChannelModel> model,
+    std::vector<std::unique_ptr<ChannelQueue>> queues) {
+  for (const std::unique_ptr<ChannelQueue>& queue : queues) {
+    if (!queues_.contains(queue->channel())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Channel `%s` for queue does not exist in package `%s`",
+          queue->channel()->name(), package_->name()));
+    }
+  }
+  for (std::unique_ptr<ChannelQueue>& queue : queues) {
+    Channel* channel = queue->channel();
+    for (ChannelQueue*& entry : queue_vec_) {
+      if (entry->channel() == channel) {
+        entry = queue.get();
+      }
+    }
+    queues_[channel] = std::move(queue);
+  }
+  models_.push_back(std::move(model));
+  return absl::OkStatus();
+}
+
 }  // namespace xls
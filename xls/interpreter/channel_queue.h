@@ -17,10 +17,13 @@
 
 #include <deque>
 #include <functional>
+#include <initializer_list>
 #include <vector>
 
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
@@ -61,12 +64,37 @@ class ChannelQueue {
   // the channel is empty.
   std::optional<Value> Read();
 
+  // Writes the given values on to the channel in order while holding the lock
+  // once. If any value does not conform to the type of the channel an error is
+  // returned and no value is written.
+  absl::Status WriteBatch(absl::Span<const Value> values);
+
+  // Reads and returns up to `max_count` values from the channel while holding
+  // the lock once. Fewer values are returned if the channel runs empty. Reads
+  // from single-value channels are not destructive so at most one value is
+  // returned for them.
+  std::vector<Value> ReadBatch(int64_t max_count);
+
+  // Calls `fn` with the value at the front of the channel without removing it
+  // from the channel. Returns false (and does not call `fn`) if the channel is
+  // empty. Values not yet produced by an attached generator are not visible.
+  // The value is passed by reference and is not copied for queues which store
+  // Values; it is only valid during the call and `fn` must not access the
+  // queue.
+  bool Peek(absl::FunctionRef<void(const Value&)> fn);
+
   // Attaches a function which generates values for the channel. The generator
   // is called when a value is needed for reading. If a generator is attached
   // then calling `Write` returns an error.
   using GeneratorFn = std::function<std::optional<Value>()>;
   absl::Status AttachGenerator(GeneratorFn generator);
 
+  // Returns whether a generator is attached to the queue.
+  bool HasGenerator() const {
+    absl::MutexLock lock(&mutex_);
+    return generator_.has_value();
+  }
+
  protected:
   mutable absl::Mutex mutex_;
 
@@ -75,6 +103,13 @@ class ChannelQueue {
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
   virtual std::optional<Value> ReadInternal()
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  virtual bool PeekInternal(absl::FunctionRef<void(const Value&)> fn)
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+
+  // Reads a value with ReadInternal, first producing one with the generator if
+  // one is attached.
+  std::optional<Value> GenerateAndReadInternal()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   Channel* channel_;
 
   std::deque<Value> queue_ ABSL_GUARDED_BY(mutex_);
@@ -85,28 +120,52 @@ class ChannelQueue {
 };
 
 // A functor which returns a sequence of Values when called. Maybe be attached
-// to a ChannelQueue as a generator.
+// to a ChannelQueue as a generator. The values are held in a vector which may
+// be moved in to avoid copying large input sequences, and each value is moved
+// out when generated.
 class FixedValueGenerator {
  public:
   explicit FixedValueGenerator(absl::Span<const Value> values)
       : values_(values.begin(), values.end()) {}
+  explicit FixedValueGenerator(std::vector<Value>&& values)
+      : values_(std::move(values)) {}
+  explicit FixedValueGenerator(std::initializer_list<Value> values)
+      : values_(values) {}
 
   std::optional<Value> operator()() {
-    if (values_.empty()) {
+    if (next_ >= values_.size()) {
       return std::nullopt;
     }
-    Value value = values_.front();
-    values_.pop_front();
-    return std::move(value);
+    return std::move(values_[next_++]);
   }
 
+  // Returns the number of values which have not been generated yet.
+  int64_t remaining() const { return values_.size() - next_; }
+
  private:
-  std::deque<Value> values_;
+  std::vector<Value> values_;
+  int64_t next_ = 0;
 };
 
 // An abstraction holding a collection of channel queues for interpreting the
 // procs within a single package. Essentially a map of channel queues with some
 // convenience methods.
+// Abstract base class for models of hardware which sits behind a set of
+// channels, e.g. a RAM. A model replaces the queues of its channels with
+// queues that act on the model directly and is ticked once per tick of the
+// proc network, after the procs.
+class ChannelModel {
+ public:
+  virtual ~ChannelModel() = default;
+
+  // Advances the model by one tick of the proc network.
+  virtual void Tick() = 0;
+
+  // Returns whether the model holds responses which will become available in
+  // a later tick. A proc network blocked on such responses is not deadlocked.
+  virtual bool HasPendingResponses() const = 0;
+};
+
 class ChannelQueueManager {
  public:
   virtual ~ChannelQueueManager() = default;
@@ -121,6 +180,8 @@ class ChannelQueueManager {
   // Get the channel queue associated with the channel with the given id/name.
   ChannelQueue& GetQueue(Channel* channel) { return *queues_.at(channel); }
 
+  Package* package() const { return package_; }
+
   // Returns the vector of all queues sorted by channel ID.
   absl::Span<ChannelQueue* const> queues() { return queue_vec_; }
 
@@ -129,6 +190,17 @@ class ChannelQueueManager {
   absl::StatusOr<ChannelQueue*> GetQueueById(int64_t channel_id);
   absl::StatusOr<ChannelQueue*> GetQueueByName(std::string_view name);
 
+  // Replaces the queues of the channels of `queues` with `queues` and takes
+  // ownership of `model`, which the queues act on. Must be called before any
+  // runtime is created from this manager.
+  absl::Status AttachModel(std::unique_ptr<ChannelModel> model,
+                           std::vector<std::unique_ptr<ChannelQueue>> queues);
+
+  // Returns the attached models in the order they were attached.
+  absl::Span<const std::unique_ptr<ChannelModel>> models() const {
+    return models_;
+  }
+
  protected:
   ChannelQueueManager(Package* package,
                       std::vector<std::unique_ptr<ChannelQueue>>&& queues);
@@ -140,6 +212,8 @@ class ChannelQueueManager {
 
   // Vector containing pointers to the channel queues held in queues_.
   std::vector<ChannelQueue*> queue_vec_;
+
+  std::vector<std::unique_ptr<ChannelModel>> models_;
 };
 
 }  // namespace xls
@@ -26,7 +26,9 @@ namespace xls {
 namespace {
 
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Optional;
 
 TEST_P(ChannelQueueTestBase, FifoChannelQueueTest) {
@@ -146,6 +148,92 @@ TEST_P(ChannelQueueTestBase, FixedValueGenerator) {
   EXPECT_EQ(queue->Read(), std::nullopt);
 }
 
+TEST_P(ChannelQueueTestBase, BatchAccess) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  auto queue = GetParam().CreateQueue(channel);
+
+  XLS_ASSERT_OK(queue->WriteBatch({Value(UBits(1, 32)), Value(UBits(2, 32)),
+                                   Value(UBits(3, 32))}));
+  XLS_ASSERT_OK(queue->Write(Value(UBits(4, 32))));
+  EXPECT_EQ(queue->GetSize(), 4);
+
+  // A batch with a mistyped value is not written at all.
+  EXPECT_THAT(queue->WriteBatch({Value(UBits(5, 32)), Value(UBits(6, 16))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expects values to have type bits[32]")));
+  EXPECT_EQ(queue->GetSize(), 4);
+
+  EXPECT_THAT(queue->ReadBatch(3),
+              ElementsAre(Value(UBits(1, 32)), Value(UBits(2, 32)),
+                          Value(UBits(3, 32))));
+  EXPECT_THAT(queue->ReadBatch(3), ElementsAre(Value(UBits(4, 32))));
+  EXPECT_THAT(queue->ReadBatch(3), IsEmpty());
+}
+
+TEST_P(ChannelQueueTestBase, SingleValueBatchAccess) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateSingleValueChannel("my_channel", ChannelOps::kSendReceive,
+                                       package.GetBitsType(32)));
+  auto queue = GetParam().CreateQueue(channel);
+
+  EXPECT_THAT(queue->ReadBatch(2), IsEmpty());
+  XLS_ASSERT_OK(
+      queue->WriteBatch({Value(UBits(1, 32)), Value(UBits(2, 32))}));
+  EXPECT_EQ(queue->GetSize(), 1);
+  EXPECT_THAT(queue->ReadBatch(2), ElementsAre(Value(UBits(2, 32))));
+  EXPECT_THAT(queue->ReadBatch(2), ElementsAre(Value(UBits(2, 32))));
+}
+
+TEST_P(ChannelQueueTestBase, Peek) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  auto queue = GetParam().CreateQueue(channel);
+
+  std::optional<Value> peeked;
+  auto peek = [&](const Value& value) { peeked = value; };
+  EXPECT_FALSE(queue->Peek(peek));
+  EXPECT_EQ(peeked, std::nullopt);
+
+  XLS_ASSERT_OK(queue->WriteBatch({Value(UBits(1, 32)), Value(UBits(2, 32))}));
+  EXPECT_TRUE(queue->Peek(peek));
+  EXPECT_THAT(peeked, Optional(Value(UBits(1, 32))));
+  EXPECT_EQ(queue->GetSize(), 2);
+
+  EXPECT_THAT(queue->Read(), Optional(Value(UBits(1, 32))));
+  EXPECT_TRUE(queue->Peek(peek));
+  EXPECT_THAT(peeked, Optional(Value(UBits(2, 32))));
+  EXPECT_EQ(queue->GetSize(), 1);
+}
+
+TEST_P(ChannelQueueTestBase, FixedValueGeneratorWithBatchRead) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kReceiveOnly,
+                                     package.GetBitsType(32)));
+  auto queue = GetParam().CreateQueue(channel);
+  std::vector<Value> values;
+  for (int64_t i = 0; i < 100; ++i) {
+    values.push_back(Value(UBits(i, 32)));
+  }
+  XLS_ASSERT_OK(queue->AttachGenerator(FixedValueGenerator(values)));
+
+  std::vector<Value> read = queue->ReadBatch(60);
+  EXPECT_EQ(read.size(), 60);
+  std::vector<Value> rest = queue->ReadBatch(60);
+  read.insert(read.end(), rest.begin(), rest.end());
+  EXPECT_EQ(read, values);
+}
+
 TEST_P(ChannelQueueTestBase, EmptyGenerator) {
   Package package(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -0,0 +1,469 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/compiled_function.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/dfs_visitor.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+// Records the nodes of a function base in the order in which IrInterpreter
+// visits them. Evaluating in the same order keeps the order of trace and
+// assert events identical to that of the interpreter.
+class VisitOrderRecorder : public DfsVisitorWithDefault {
+ public:
+  absl::Status DefaultHandler(Node* node) override {
+    order_.push_back(node);
+    return absl::OkStatus();
+  }
+
+  std::vector<Node*>& order() { return order_; }
+
+ private:
+  std::vector<Node*> order_;
+};
+
+// Returns the given bits value as a uint64_t value. If the value exceeds
+// upper_limit, then upper_limit is returned.
+uint64_t BitsToBoundedUint64(const Bits& bits, uint64_t upper_limit) {
+  if (Bits::MinBitCountUnsigned(upper_limit) <= bits.bit_count() &&
+      bits_ops::UGreaterThan(bits, UBits(upper_limit, bits.bit_count()))) {
+    return upper_limit;
+  }
+  return bits.ToUint64().value();
+}
+
+// Returns `bits` truncated or extended to `width` as IrInterpreter does for
+// the result of a multiply.
+Bits FitToWidth(Bits bits, int64_t width, bool is_signed) {
+  if (bits.bit_count() > width) {
+    return bits.Slice(0, width);
+  }
+  if (bits.bit_count() < width) {
+    return is_signed ? bits_ops::SignExtend(bits, width)
+                     : bits_ops::ZeroExtend(bits, width);
+  }
+  return bits;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledFunction>>
+CompiledFunction::Create(Function* function) {
+  auto compiled = absl::WrapUnique(new CompiledFunction(function));
+
+  VisitOrderRecorder recorder;
+  XLS_RETURN_IF_ERROR(function->Accept(&recorder));
+
+  absl::flat_hash_map<Node*, int64_t> slots;
+  for (Node* node : recorder.order()) {
+    if (node->Is<Literal>()) {
+      slots[node] = ~static_cast<int64_t>(compiled->constants_.size());
+      compiled->constants_.push_back(node->As<Literal>()->value());
+      continue;
+    }
+
+    Instruction instruction{.opcode = Opcode::kGeneric,
+                            .node = node,
+                            .result = compiled->register_count_++,
+                            .operand_begin = static_cast<int64_t>(
+                                compiled->operand_slots_.size()),
+                            .operand_count = node->operand_count(),
+                            .immediate = 0,
+                            .width = 0};
+    for (Node* operand : node->operands()) {
+      compiled->operand_slots_.push_back(slots.at(operand));
+    }
+    slots[node] = instruction.result;
+
+    // Operations on bits are evaluated directly only when all operands and the
+    // result are bits, which is where the IrInterpreter handlers for these
+    // operations apply.
+    bool all_bits = node->GetType()->IsBits();
+    for (Node* operand : node->operands()) {
+      all_bits = all_bits && operand->GetType()->IsBits();
+    }
+    auto bits_opcode = [&](Opcode opcode) {
+      return all_bits ? opcode : Opcode::kGeneric;
+    };
+    switch (node->op()) {
+      case Op::kParam: {
+        XLS_ASSIGN_OR_RETURN(instruction.immediate,
+                             function->GetParamIndex(node->As<Param>()));
+        instruction.opcode = Opcode::kParam;
+        break;
+      }
+      case Op::kIdentity:
+        instruction.opcode = Opcode::kIdentity;
+        break;
+      case Op::kAfterAll:
+        instruction.opcode = Opcode::kToken;
+        break;
+      case Op::kAdd:
+        instruction.opcode = bits_opcode(Opcode::kAdd);
+        break;
+      case Op::kSub:
+        instruction.opcode = bits_opcode(Opcode::kSub);
+        break;
+      case Op::kNeg:
+        instruction.opcode = bits_opcode(Opcode::kNeg);
+        break;
+      case Op::kNot:
+        instruction.opcode = bits_opcode(Opcode::kNot);
+        break;
+      case Op::kAnd:
+        instruction.opcode = bits_opcode(node->operand_count() == 2
+                                             ? Opcode::kAnd
+                                             : Opcode::kNaryAnd);
+        break;
+      case Op::kOr:
+        instruction.opcode = bits_opcode(
+            node->operand_count() == 2 ? Opcode::kOr : Opcode::kNaryOr);
+        break;
+      case Op::kXor:
+        instruction.opcode = bits_opcode(node->operand_count() == 2
+                                             ? Opcode::kXor
+                                             : Opcode::kNaryXor);
+        break;
+      case Op::kUMul:
+        instruction.opcode = bits_opcode(Opcode::kUMul);
+        instruction.immediate = all_bits ? node->BitCountOrDie() : 0;
+        break;
+      case Op::kSMul:
+        instruction.opcode = bits_opcode(Opcode::kSMul);
+        instruction.immediate = all_bits ? node->BitCountOrDie() : 0;
+        break;
+      case Op::kEq:
+        instruction.opcode = Opcode::kEq;
+        break;
+      case Op::kNe:
+        instruction.opcode = Opcode::kNe;
+        break;
+      case Op::kULt:
+        instruction.opcode = bits_opcode(Opcode::kULt);
+        break;
+      case Op::kULe:
+        instruction.opcode = bits_opcode(Opcode::kULe);
+        break;
+      case Op::kUGt:
+        instruction.opcode = bits_opcode(Opcode::kUGt);
+        break;
+      case Op::kUGe:
+        instruction.opcode = bits_opcode(Opcode::kUGe);
+        break;
+      case Op::kSLt:
+        instruction.opcode = bits_opcode(Opcode::kSLt);
+        break;
+      case Op::kSLe:
+        instruction.opcode = bits_opcode(Opcode::kSLe);
+        break;
+      case Op::kSGt:
+        instruction.opcode = bits_opcode(Opcode::kSGt);
+        break;
+      case Op::kSGe:
+        instruction.opcode = bits_opcode(Opcode::kSGe);
+        break;
+      case Op::kShll:
+        instruction.opcode = bits_opcode(Opcode::kShll);
+        break;
+      case Op::kShrl:
+        instruction.opcode = bits_opcode(Opcode::kShrl);
+        break;
+      case Op::kShra:
+        instruction.opcode = bits_opcode(Opcode::kShra);
+        break;
+      case Op::kConcat:
+        instruction.opcode = bits_opcode(Opcode::kConcat);
+        break;
+      case Op::kBitSlice:
+        instruction.opcode = bits_opcode(Opcode::kBitSlice);
+        instruction.immediate = node->As<BitSlice>()->start();
+        instruction.width = node->As<BitSlice>()->width();
+        break;
+      case Op::kZeroExt:
+        instruction.opcode = bits_opcode(Opcode::kZeroExt);
+        instruction.immediate = node->As<ExtendOp>()->new_bit_count();
+        break;
+      case Op::kSignExt:
+        instruction.opcode = bits_opcode(Opcode::kSignExt);
+        instruction.immediate = node->As<ExtendOp>()->new_bit_count();
+        break;
+      case Op::kSel:
+        instruction.opcode = Opcode::kSel;
+        break;
+      case Op::kTuple:
+        instruction.opcode = Opcode::kTuple;
+        break;
+      case Op::kTupleIndex:
+        instruction.opcode = Opcode::kTupleIndex;
+        instruction.immediate = node->As<TupleIndex>()->index();
+        break;
+      default:
+        break;
+    }
+    compiled->instructions_.push_back(instruction);
+  }
+  compiled->return_slot_ = slots.at(function->return_value());
+  XLS_VLOG(3) << absl::StreamFormat(
+      "Compiled function %s into %d instructions and %d constants",
+      function->name(), compiled->instructions_.size(),
+      compiled->constants_.size());
+  return compiled;
+}
+
+absl::Status CompiledFunction::RunGeneric(const Instruction& instruction,
+                                          std::vector<Value>& registers,
+                                          InterpreterEvents& events) const {
+  Node* node = instruction.node;
+  absl::flat_hash_map<Node*, Value> node_values;
+  for (int64_t i = 0; i < instruction.operand_count; ++i) {
+    // Operands may be duplicated so only the first occurrence is inserted.
+    node_values.try_emplace(
+        node->operand(i),
+        Resolve(operand_slots_[instruction.operand_begin + i], registers));
+  }
+  IrInterpreter visitor(&node_values, &events);
+  XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+  auto it = node_values.find(node);
+  if (it == node_values.end()) {
+    // Some side-effecting operations (e.g., cover) produce no value in the
+    // interpreter.
+    XLS_RET_CHECK(node->GetType()->IsToken()) << node->ToString();
+    registers[instruction.result] = Value::Token();
+  } else {
+    registers[instruction.result] = std::move(it->second);
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompiledFunction::Run(
+    absl::Span<const Value> args) const {
+  if (args.size() != function_->params().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function %s wants %d arguments, got %d.", function_->name(),
+        function_->params().size(), args.size()));
+  }
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    Type* param_type = function_->param(argno)->GetType();
+    if (!ValueConformsToType(args[argno], param_type)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got argument %s for parameter %d which is not of type %s",
+          args[argno].ToString(), argno, param_type->ToString()));
+    }
+  }
+
+  std::vector<Value> registers(register_count_);
+  InterpreterEvents events;
+  for (const Instruction& instruction : instructions_) {
+    auto operand = [&](int64_t i) -> const Value& {
+      return Resolve(operand_slots_[instruction.operand_begin + i], registers);
+    };
+    auto bits_operand = [&](int64_t i) -> const Bits& {
+      return operand(i).bits();
+    };
+    Value& result = registers[instruction.result];
+    switch (instruction.opcode) {
+      case Opcode::kParam:
+        result = args[instruction.immediate];
+        break;
+      case Opcode::kIdentity:
+        result = operand(0);
+        break;
+      case Opcode::kToken:
+        result = Value::Token();
+        break;
+      case Opcode::kAdd:
+        result = Value(bits_ops::Add(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kSub:
+        result = Value(bits_ops::Sub(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kNeg:
+        result = Value(bits_ops::Negate(bits_operand(0)));
+        break;
+      case Opcode::kNot:
+        result = Value(bits_ops::Not(bits_operand(0)));
+        break;
+      case Opcode::kAnd:
+        result = Value(bits_ops::And(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kOr:
+        result = Value(bits_ops::Or(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kXor:
+        result = Value(bits_ops::Xor(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kNaryAnd:
+      case Opcode::kNaryOr:
+      case Opcode::kNaryXor: {
+        std::vector<Bits> operands;
+        operands.reserve(instruction.operand_count);
+        for (int64_t i = 0; i < instruction.operand_count; ++i) {
+          operands.push_back(bits_operand(i));
+        }
+        if (instruction.opcode == Opcode::kNaryAnd) {
+          result = Value(bits_ops::NaryAnd(operands));
+        } else if (instruction.opcode == Opcode::kNaryOr) {
+          result = Value(bits_ops::NaryOr(operands));
+        } else {
+          result = Value(bits_ops::NaryXor(operands));
+        }
+        break;
+      }
+      case Opcode::kUMul:
+        result = Value(
+            FitToWidth(bits_ops::UMul(bits_operand(0), bits_operand(1)),
+                       instruction.immediate, /*is_signed=*/false));
+        break;
+      case Opcode::kSMul:
+        result = Value(
+            FitToWidth(bits_ops::SMul(bits_operand(0), bits_operand(1)),
+                       instruction.immediate, /*is_signed=*/true));
+        break;
+      case Opcode::kEq:
+        result = Value::Bool(operand(0) == operand(1));
+        break;
+      case Opcode::kNe:
+        result = Value::Bool(operand(0) != operand(1));
+        break;
+      case Opcode::kULt:
+        result =
+            Value::Bool(bits_ops::ULessThan(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kULe:
+        result = Value::Bool(
+            bits_ops::ULessThanOrEqual(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kUGt:
+        result = Value::Bool(
+            bits_ops::UGreaterThan(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kUGe:
+        result = Value::Bool(
+            bits_ops::UGreaterThanOrEqual(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kSLt:
+        result =
+            Value::Bool(bits_ops::SLessThan(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kSLe:
+        result = Value::Bool(
+            bits_ops::SLessThanOrEqual(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kSGt:
+        result = Value::Bool(
+            bits_ops::SGreaterThan(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kSGe:
+        result = Value::Bool(
+            bits_ops::SGreaterThanOrEqual(bits_operand(0), bits_operand(1)));
+        break;
+      case Opcode::kShll:
+      case Opcode::kShrl:
+      case Opcode::kShra: {
+        const Bits& input = bits_operand(0);
+        int64_t amount =
+            BitsToBoundedUint64(bits_operand(1), input.bit_count());
+        if (instruction.opcode == Opcode::kShll) {
+          result = Value(bits_ops::ShiftLeftLogical(input, amount));
+        } else if (instruction.opcode == Opcode::kShrl) {
+          result = Value(bits_ops::ShiftRightLogical(input, amount));
+        } else {
+          result = Value(bits_ops::ShiftRightArith(input, amount));
+        }
+        break;
+      }
+      case Opcode::kConcat: {
+        std::vector<Bits> operands;
+        operands.reserve(instruction.operand_count);
+        for (int64_t i = 0; i < instruction.operand_count; ++i) {
+          operands.push_back(bits_operand(i));
+        }
+        result = Value(bits_ops::Concat(operands));
+        break;
+      }
+      case Opcode::kBitSlice:
+        result = Value(
+            bits_operand(0).Slice(instruction.immediate, instruction.width));
+        break;
+      case Opcode::kZeroExt:
+        result =
+            Value(bits_ops::ZeroExtend(bits_operand(0), instruction.immediate));
+        break;
+      case Opcode::kSignExt:
+        result =
+            Value(bits_ops::SignExtend(bits_operand(0), instruction.immediate));
+        break;
+      case Opcode::kSel: {
+        // Operand 0 is the selector, followed by the cases and the optional
+        // default value.
+        Select* sel = instruction.node->As<Select>();
+        const Bits& selector = bits_operand(0);
+        int64_t case_count = sel->cases().size();
+        if (bits_ops::UGreaterThan(selector,
+                                   UBits(case_count - 1,
+                                         selector.bit_count()))) {
+          XLS_RET_CHECK(sel->default_value().has_value());
+          result = operand(case_count + 1);
+        } else {
+          XLS_ASSIGN_OR_RETURN(uint64_t i, selector.ToUint64());
+          result = operand(i + 1);
+        }
+        break;
+      }
+      case Opcode::kTuple: {
+        std::vector<Value> elements;
+        elements.reserve(instruction.operand_count);
+        for (int64_t i = 0; i < instruction.operand_count; ++i) {
+          elements.push_back(operand(i));
+        }
+        result = Value::TupleOwned(std::move(elements));
+        break;
+      }
+      case Opcode::kTupleIndex:
+        result = operand(0).element(instruction.immediate);
+        break;
+      case Opcode::kGeneric:
+        XLS_RETURN_IF_ERROR(RunGeneric(instruction, registers, events));
+        break;
+    }
+  }
+  Value result = Resolve(return_slot_, registers);
+  XLS_VLOG(2) << "Result = " << result;
+  return InterpreterResult<Value>{std::move(result), std::move(events)};
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompiledFunction::Run(
+    const absl::flat_hash_map<std::string, Value>& kwargs) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> args,
+                       KeywordArgsToPositional(*function_, kwargs));
+  return Run(args);
+}
+
+}  // namespace xls
@@ -0,0 +1,165 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_COMPILED_FUNCTION_H_
+#define XLS_INTERPRETER_COMPILED_FUNCTION_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// An interpreter for XLS functions which lowers the function once into a flat
+// array of instructions and then evaluates the instructions in order over a
+// dense register file. Unlike InterpretFunction, running a compiled function
+// does not traverse the graph or look up node values in a hash map, which
+// makes it a much faster alternative to the JIT when LLVM is unavailable or
+// when the function is run too few times to amortize JIT compilation.
+//
+// Common bits-typed operations are evaluated directly; all other operations
+// are evaluated with IrInterpreter one node at a time. Results (including
+// trace and assert events and their order) are the same as those of
+// InterpretFunction.
+//
+// Example:
+//
+//   XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunction> compiled,
+//                        CompiledFunction::Create(f));
+//   for (const std::vector<Value>& args : arg_sets) {
+//     XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result,
+//                          compiled->Run(args));
+//     ...
+//   }
+class CompiledFunction {
+ public:
+  // Lowers `function` into a sequence of instructions. The function must
+  // outlive the CompiledFunction and must not be modified after compilation.
+  static absl::StatusOr<std::unique_ptr<CompiledFunction>> Create(
+      Function* function);
+
+  // Evaluates the function with the given arguments. Thread-safe.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args) const;
+
+  // As above, but with arguments as key-value pairs.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      const absl::flat_hash_map<std::string, Value>& kwargs) const;
+
+  Function* function() const { return function_; }
+
+  // Returns the number of instructions evaluated per run.
+  int64_t instruction_count() const { return instructions_.size(); }
+
+ private:
+  // The operation performed by an instruction. kGeneric evaluates the node
+  // with IrInterpreter.
+  enum class Opcode {
+    kParam,
+    kIdentity,
+    kToken,
+    kAdd,
+    kSub,
+    kNeg,
+    kNot,
+    kAnd,
+    kOr,
+    kXor,
+    kNaryAnd,
+    kNaryOr,
+    kNaryXor,
+    kUMul,
+    kSMul,
+    kEq,
+    kNe,
+    kULt,
+    kULe,
+    kUGt,
+    kUGe,
+    kSLt,
+    kSLe,
+    kSGt,
+    kSGe,
+    kShll,
+    kShrl,
+    kShra,
+    kConcat,
+    kBitSlice,
+    kZeroExt,
+    kSignExt,
+    kSel,
+    kTuple,
+    kTupleIndex,
+    kGeneric,
+  };
+
+  struct Instruction {
+    Opcode opcode;
+    Node* node;
+
+    // The register holding the result.
+    int64_t result;
+
+    // The operands are the slots operand_slots_[operand_begin] through
+    // operand_slots_[operand_begin + operand_count - 1].
+    int64_t operand_begin;
+    int64_t operand_count;
+
+    // An immediate whose meaning depends on the opcode: the parameter index,
+    // the bit width of the result of a multiply or extension, the start of a
+    // bit slice or the index of a tuple element.
+    int64_t immediate;
+
+    // The width of a bit slice.
+    int64_t width;
+  };
+
+  explicit CompiledFunction(Function* function) : function_(function) {}
+
+  // Returns the value held by `slot`.
+  const Value& Resolve(int64_t slot, absl::Span<const Value> registers) const {
+    return slot >= 0 ? registers[slot] : constants_[~slot];
+  }
+
+  // Evaluates the node of `instruction` with IrInterpreter.
+  absl::Status RunGeneric(const Instruction& instruction,
+                          std::vector<Value>& registers,
+                          InterpreterEvents& events) const;
+
+  Function* function_;
+  std::vector<Instruction> instructions_;
+
+  // The operand slots of all instructions. A slot `s` refers to the register
+  // `s` if it is non-negative and to the constant `~s` otherwise.
+  std::vector<int64_t> operand_slots_;
+
+  // The values of the literals of the function, computed at compile time.
+  std::vector<Value> constants_;
+
+  int64_t register_count_ = 0;
+  int64_t return_slot_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_COMPILED_FUNCTION_H_
@@ -0,0 +1,127 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/compiled_function.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using testing::ElementsAre;
+
+INSTANTIATE_TEST_SUITE_P(
+    CompiledFunctionTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        [](Function* function, absl::Span<const Value> args)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunction> compiled,
+                               CompiledFunction::Create(function));
+          return compiled->Run(args);
+        },
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunction> compiled,
+                               CompiledFunction::Create(function));
+          return compiled->Run(kwargs);
+        })));
+
+class CompiledFunctionOnlyTest : public IrTestBase {};
+
+TEST_F(CompiledFunctionOnlyTest, RepeatedRunsMatchInterpreter) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+    fn f(x: bits[8], y: bits[8], s: bits[2]) -> (bits[8], bits[16], bits[1]) {
+      literal.1: bits[8] = literal(value=3)
+      add.2: bits[8] = add(x, literal.1)
+      umul.3: bits[16] = umul(add.2, y)
+      shll.4: bits[8] = shll(x, y)
+      and.5: bits[8] = and(x, y, add.2)
+      sel.6: bits[8] = sel(s, cases=[x, y, shll.4], default=and.5)
+      sign_ext.7: bits[16] = sign_ext(sel.6, new_bit_count=16)
+      sub.8: bits[16] = sub(sign_ext.7, umul.3)
+      ult.9: bits[1] = ult(x, y)
+      ret tuple.10: (bits[8], bits[16], bits[1]) = tuple(sel.6, sub.8, ult.9)
+    }
+  )",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunction> compiled,
+                           CompiledFunction::Create(f));
+  // The literal is a constant rather than an instruction.
+  EXPECT_EQ(compiled->instruction_count(), f->node_count() - 1);
+
+  std::minstd_rand engine;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> args = RandomFunctionArguments(f, &engine);
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(f, args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                             compiled->Run(args));
+    EXPECT_EQ(actual.value, expected.value);
+  }
+}
+
+TEST_F(CompiledFunctionOnlyTest, EventsInInterpreterOrder) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+    fn f(tkn: token, x: bits[8]) -> bits[8] {
+      literal.1: bits[1] = literal(value=1)
+      trace.2: token = trace(tkn, literal.1, format="x is {}", data_operands=[x])
+      literal.3: bits[8] = literal(value=1)
+      ugt.4: bits[1] = ugt(x, literal.3)
+      assert.5: token = assert(trace.2, ugt.4, message="x is too small")
+      neg.6: bits[8] = neg(x)
+      trace.7: token = trace(assert.5, literal.1, format="-x is {}", data_operands=[neg.6])
+      ret identity.8: bits[8] = identity(neg.6)
+    }
+  )",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledFunction> compiled,
+                           CompiledFunction::Create(f));
+  for (int64_t x : {0, 5}) {
+    std::vector<Value> args = {Value::Token(), Value(UBits(x, 8))};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(f, args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                             compiled->Run(args));
+    EXPECT_EQ(actual.value, expected.value);
+    EXPECT_EQ(actual.events.trace_msgs, expected.events.trace_msgs);
+    EXPECT_EQ(actual.events.assert_msgs, expected.events.assert_msgs);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           compiled->Run(std::vector<Value>{
+                               Value::Token(), Value(UBits(0, 8))}));
+  EXPECT_THAT(result.events.trace_msgs, ElementsAre("x is 0", "-x is 0"));
+  EXPECT_THAT(result.events.assert_msgs, ElementsAre("x is too small"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -35,7 +35,8 @@ class FunctionInterpreter : public IrInterpreter {
           "Parameter %s at index %d does not exist in args (of length %d)",
           param->ToString(), index, args_.size()));
     }
-    return SetValueResult(param, args_[index]);
+    // Each parameter is visited once so the argument can be moved.
+    return SetValueResult(param, std::move(args_[index]));
   }
 
  private:
@@ -65,6 +66,7 @@ absl::StatusOr<InterpreterResult<Value>> InterpretFunction(
     }
   }
   FunctionInterpreter visitor(args);
+  XLS_RETURN_IF_ERROR(visitor.ReleaseValuesAfterLastUse(function));
   XLS_RETURN_IF_ERROR(function->Accept(&visitor));
   Value result = visitor.ResolveAsValue(function->return_value());
   XLS_VLOG(2) << "Result = " << result;
@@ -19,16 +19,15 @@
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/ir/proc.h"
+#include "xls/jit/jit_channel_queue.h"
 
 namespace xls {
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
-CreateInterpreterSerialProcRuntime(Package* package) {
-  // Create a queue manager for the queues. This factory verifies that there an
-  // receive only queue for every receive only channel.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
-                       ChannelQueueManager::Create(package));
+namespace {
 
+// Creates a SerialProcRuntime of ProcInterpreters using `queue_manager`.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
+    Package* package, std::unique_ptr<ChannelQueueManager> queue_manager) {
   // Create a ProcInterpreter for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_interpreters;
   for (auto& proc : package->procs()) {
@@ -45,12 +44,35 @@ CreateInterpreterSerialProcRuntime(Package* package) {
   // Inject initial values into channels.
   for (Channel* channel : package->channels()) {
     ChannelQueue& queue = proc_runtime->queue_manager().GetQueue(channel);
-    for (const Value& value : channel->initial_values()) {
-      XLS_RETURN_IF_ERROR(queue.Write(value));
-    }
+    XLS_RETURN_IF_ERROR(queue.WriteBatch(channel->initial_values()));
   }
 
   return std::move(proc_runtime);
 }
 
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateInterpreterSerialProcRuntime(Package* package) {
+  // Create a queue manager for the queues. This factory verifies that there an
+  // receive only queue for every receive only channel.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
+                       ChannelQueueManager::Create(package));
+  return CreateRuntime(package, std::move(queue_manager));
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateInterpreterSerialProcRuntime(
+    Package* package, absl::Span<const RamModelConfig> ram_models) {
+  // The RAM models operate on the native layout of the JIT so the queues are
+  // JIT queues; the procs are still interpreted.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateThreadUnsafe(package));
+  for (const RamModelConfig& ram_model : ram_models) {
+    XLS_RETURN_IF_ERROR(
+        JitRamModel::Attach(ram_model, queue_manager.get()).status());
+  }
+  return CreateRuntime(package, std::move(queue_manager));
+}
+
 }  // namespace xls
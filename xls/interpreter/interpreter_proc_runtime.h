@@ -17,8 +17,10 @@
 
 #include <memory>
 
+#include "absl/types/span.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
+#include "xls/jit/jit_ram_model.h"
 
 namespace xls {
 
@@ -26,6 +28,12 @@ namespace xls {
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
 CreateInterpreterSerialProcRuntime(Package* package);
 
+// Create a SerialProcRuntime composed of ProcInterpreters in which the channels
+// of each RAM in `ram_models` are served by a JitRamModel.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateInterpreterSerialProcRuntime(
+    Package* package, absl::Span<const RamModelConfig> ram_models);
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_INTERPRETER_PROC_RUNTIME_H_
@@ -59,29 +59,94 @@ absl::StatusOr<Value> InterpretNode(Node* node,
   }
 
   XLS_RET_CHECK_EQ(node->operand_count(), operand_values.size());
-  IrInterpreter visitor;
   for (int64_t i = 0; i < operand_values.size(); ++i) {
-    // Operands may be duplicated so check to see if the operand value has
-    // already been set.
-    if (!visitor.HasResult(node->operand(i))) {
-      XLS_RETURN_IF_ERROR(
-          visitor.SetValueResult(node->operand(i), operand_values[i]));
+    if (!ValueConformsToType(operand_values[i], node->operand(i)->GetType())) {
+      return absl::InternalError(absl::StrFormat(
+          "Expected value %s to match type %s of node %s",
+          operand_values[i].ToString(), node->operand(i)->GetType()->ToString(),
+          node->operand(i)->GetName()));
     }
   }
+  // The operand values are referred to in place rather than copied into the
+  // visitor.
+  IrInterpreter visitor;
+  visitor.single_node_ = node;
+  visitor.single_node_operand_values_ = operand_values;
   XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
-  return visitor.ResolveAsValue(node);
+  XLS_RET_CHECK(visitor.single_node_value_.has_value());
+  return std::move(*visitor.single_node_value_);
 }
 
-absl::Status IrInterpreter::AddInterpreterEvents(
-    const InterpreterEvents& events) {
-  for (const std::string& trace_msg : events.trace_msgs) {
-    GetInterpreterEvents().trace_msgs.push_back(trace_msg);
+absl::Status IrInterpreter::ReleaseValuesAfterLastUse(FunctionBase* f) {
+  XLS_RET_CHECK(node_values_ptr_ == nullptr)
+      << "Values cannot be released from an existing node values map";
+  remaining_uses_.assign(f->node_table_size(), 0);
+  for (Node* node : f->nodes()) {
+    for (Node* operand : node->operands()) {
+      ++remaining_uses_[operand->node_table_index()];
+    }
+    if (f->HasImplicitUse(node)) {
+      ++remaining_uses_[node->node_table_index()];
+    }
+  }
+  return absl::OkStatus();
+}
+
+const Value* IrInterpreter::FindSingleNodeValue(Node* node) const {
+  if (node == single_node_) {
+    return single_node_value_.has_value() ? &*single_node_value_ : nullptr;
+  }
+  for (int64_t i = 0; i < single_node_->operand_count(); ++i) {
+    if (single_node_->operand(i) == node) {
+      return &single_node_operand_values_[i];
+    }
+  }
+  return nullptr;
+}
+
+Value IrInterpreter::ConsumeOperand(Node* node, int64_t operand_no) {
+  Node* operand = node->operand(operand_no);
+  if (!remaining_uses_.empty() &&
+      remaining_uses_[operand->node_table_index()] == 1) {
+    // `node` is the last use of the operand, which is freed after `node` is
+    // evaluated anyway.
+    std::optional<Value>& value = node_values_[operand->node_table_index()];
+    XLS_CHECK(value.has_value()) << "No value for node " << operand->GetName();
+    Value result = std::move(*value);
+    value.reset();
+    return result;
   }
+  return ResolveAsValue(operand);
+}
 
-  for (const std::string& assert_msg : events.assert_msgs) {
-    GetInterpreterEvents().assert_msgs.push_back(assert_msg);
+void IrInterpreter::StoreValue(Node* node, Value value) {
+  if (node_values_ptr_ != nullptr) {
+    (*node_values_ptr_)[node] = std::move(value);
+    return;
+  }
+  if (node == single_node_) {
+    single_node_value_ = std::move(value);
+    return;
+  }
+  int64_t index = node->node_table_index();
+  if (index >= node_values_.size()) {
+    node_values_.resize(node->function_base()->node_table_size());
+  }
+  node_values_[index] = std::move(value);
+  if (remaining_uses_.empty()) {
+    return;
+  }
+  for (Node* operand : node->operands()) {
+    int64_t operand_index = operand->node_table_index();
+    if (--remaining_uses_[operand_index] == 0) {
+      node_values_[operand_index].reset();
+    }
   }
+}
 
+absl::Status IrInterpreter::AddInterpreterEvents(
+    const InterpreterEvents& events) {
+  GetInterpreterEvents().Append(events);
   return absl::OkStatus();
 }
 
@@ -162,11 +227,12 @@ absl::Status IrInterpreter::HandleSend(Send* send) {
 
 absl::Status IrInterpreter::HandleArray(Array* array) {
   std::vector<Value> operand_values;
-  for (Node* operand : array->operands()) {
-    operand_values.push_back(ResolveAsValue(operand));
+  operand_values.reserve(array->operand_count());
+  for (int64_t i = 0; i < array->operand_count(); ++i) {
+    operand_values.push_back(ConsumeOperand(array, i));
   }
-  XLS_ASSIGN_OR_RETURN(Value result, Value::Array(operand_values));
-  return SetValueResult(array, result);
+  // The type of the result is checked by SetValueResult.
+  return SetValueResult(array, Value::ArrayOwned(std::move(operand_values)));
 }
 
 absl::Status IrInterpreter::HandleInputPort(InputPort* input_port) {
@@ -380,7 +446,7 @@ absl::Status IrInterpreter::HandleUGt(CompareOp* gt) {
 }
 
 absl::Status IrInterpreter::HandleIdentity(UnOp* identity) {
-  return SetValueResult(identity, ResolveAsValue(identity->operand(0)));
+  return SetValueResult(identity, ConsumeOperand(identity, 0));
 }
 
 // Recursive function for setting an element of a multidimensional array to a
@@ -481,7 +547,7 @@ absl::Status IrInterpreter::HandleAssert(Assert* assert_op) {
   XLS_VLOG(2) << "Checking assert " << assert_op->ToString();
   XLS_VLOG(2) << "Condition is " << ResolveAsBool(assert_op->condition());
   if (!ResolveAsBool(assert_op->condition())) {
-    GetInterpreterEvents().assert_msgs.push_back(assert_op->message());
+    GetInterpreterEvents().RecordAssert(assert_op->message());
   }
   return SetValueResult(assert_op, Value::Token());
 }
@@ -500,20 +566,15 @@ absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
           StepsToXlsFormatString(trace_op->format()), trace_op->ToString()));
     };
 
-    std::string trace_output;
-
-    for (auto step : trace_op->format()) {
-      if (std::holds_alternative<std::string>(step)) {
-        absl::StrAppend(&trace_output, std::get<std::string>(step));
-      }
-
+    // Only the operand values are captured here; the message is formatted by
+    // the recipient of the event.
+    TraceEvent event{.format = trace_op->format()};
+    for (const FormatStep& step : trace_op->format()) {
       if (std::holds_alternative<FormatPreference>(step)) {
         if (arg_node == arg_nodes.end()) {
           return make_error("Not enough operands");
         }
-        auto arg_format = std::get<FormatPreference>(step);
-        absl::StrAppend(&trace_output,
-                        ResolveAsValue(*arg_node).ToHumanString(arg_format));
+        event.args.push_back(ResolveAsValue(*arg_node));
         arg_node++;
       }
     }
@@ -522,9 +583,9 @@ absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
       return make_error("Too many operands");
     }
 
-    XLS_VLOG(3) << "Trace output: " << trace_output;
+    XLS_VLOG(3) << "Trace output: " << event.ToString();
 
-    GetInterpreterEvents().trace_msgs.push_back(trace_output);
+    GetInterpreterEvents().RecordTrace(std::move(event));
   }
   return SetValueResult(trace_op, Value::Token());
 }
@@ -731,10 +792,12 @@ absl::Status IrInterpreter::HandleSel(Select* sel) {
   if (bits_ops::UGreaterThan(
           selector, UBits(sel->cases().size() - 1, selector.bit_count()))) {
     XLS_RET_CHECK(sel->default_value().has_value());
-    return SetValueResult(sel, ResolveAsValue(*sel->default_value()));
+    // The default value is the last operand.
+    return SetValueResult(sel, ConsumeOperand(sel, sel->operand_count() - 1));
   }
   XLS_ASSIGN_OR_RETURN(uint64_t i, selector.ToUint64());
-  return SetValueResult(sel, ResolveAsValue(sel->get_case(i)));
+  // The cases follow the selector operand.
+  return SetValueResult(sel, ConsumeOperand(sel, i + 1));
 }
 
 absl::Status IrInterpreter::HandleShll(BinOp* shll) {
@@ -771,10 +834,11 @@ absl::Status IrInterpreter::HandleSub(BinOp* sub) {
 
 absl::Status IrInterpreter::HandleTuple(Tuple* tuple) {
   std::vector<Value> tuple_values;
-  for (Node* operand : tuple->operands()) {
-    tuple_values.push_back(ResolveAsValue(operand));
+  tuple_values.reserve(tuple->operand_count());
+  for (int64_t i = 0; i < tuple->operand_count(); ++i) {
+    tuple_values.push_back(ConsumeOperand(tuple, i));
   }
-  return SetValueResult(tuple, Value::Tuple(tuple_values));
+  return SetValueResult(tuple, Value::TupleOwned(std::move(tuple_values)));
 }
 
 absl::Status IrInterpreter::HandleTupleIndex(TupleIndex* index) {
@@ -808,11 +872,11 @@ absl::Status IrInterpreter::VerifyAllBitsTypes(Node* node) {
 }
 
 const Bits& IrInterpreter::ResolveAsBits(Node* node) {
-  return NodeValuesMap().at(node).bits();
+  return ResolveAsValue(node).bits();
 }
 
 bool IrInterpreter::ResolveAsBool(Node* node) {
-  const Bits& bits = NodeValuesMap().at(node).bits();
+  const Bits& bits = ResolveAsValue(node).bits();
   XLS_CHECK_EQ(bits.bit_count(), 1);
   return bits.IsAllOnes();
 }
@@ -844,26 +908,29 @@ absl::Status IrInterpreter::SetBitsResult(Node* node, const Bits& result) {
 }
 
 absl::Status IrInterpreter::SetValueResult(Node* node, Value result) {
-  if (XLS_VLOG_IS_ON(4) &&
-      std::all_of(node->operands().begin(), node->operands().end(),
-                  [this](Node* o) { return NodeValuesMap().contains(o); })) {
-    XLS_VLOG(4) << absl::StreamFormat("%s operands:", node->GetName());
-    for (int64_t i = 0; i < node->operand_count(); ++i) {
-      XLS_VLOG(4) << absl::StreamFormat(
-          "  operand %d (%s): %s", i, node->operand(i)->GetName(),
-          ResolveAsValue(node->operand(i)).ToString());
+  // This runs for every node evaluated so disabled logging costs one check.
+  if (XLS_VLOG_IS_ON(3)) {
+    if (XLS_VLOG_IS_ON(4) &&
+        std::all_of(node->operands().begin(), node->operands().end(),
+                    [this](Node* o) { return HasResult(o); })) {
+      XLS_VLOG(4) << absl::StreamFormat("%s operands:", node->GetName());
+      for (int64_t i = 0; i < node->operand_count(); ++i) {
+        XLS_VLOG(4) << absl::StreamFormat(
+            "  operand %d (%s): %s", i, node->operand(i)->GetName(),
+            ResolveAsValue(node->operand(i)).ToString());
+      }
     }
+    XLS_VLOG(3) << absl::StreamFormat("Result of %s: %s", node->ToString(),
+                                      result.ToString());
   }
-  XLS_VLOG(3) << absl::StreamFormat("Result of %s: %s", node->ToString(),
-                                    result.ToString());
 
-  XLS_RET_CHECK(!NodeValuesMap().contains(node));
+  XLS_RET_CHECK(!HasResult(node));
   if (!ValueConformsToType(result, node->GetType())) {
     return absl::InternalError(absl::StrFormat(
         "Expected value %s to match type %s of node %s", result.ToString(),
         node->GetType()->ToString(), node->GetName()));
   }
-  NodeValuesMap()[node] = std::move(result);
+  StoreValue(node, std::move(result));
   return absl::OkStatus();
 }
 
@@ -15,12 +15,18 @@
 #ifndef XLS_INTERPRETER_IR_INTERPRETER_H_
 #define XLS_INTERPRETER_IR_INTERPRETER_H_
 
+#include <cstdint>
+#include <optional>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -33,6 +39,7 @@ absl::StatusOr<Value> InterpretNode(Node* node,
 // A visitor for traversing and evaluating XLS IR.
 class IrInterpreter : public DfsVisitor {
  public:
+  // Node values are held in a vector indexed by Node::node_table_index.
   IrInterpreter() : node_values_ptr_(nullptr), events_ptr_(nullptr) {}
 
   // Constructor which takes an existing map of node values and events. Used for
@@ -42,6 +49,15 @@ class IrInterpreter : public DfsVisitor {
                 InterpreterEvents* events)
       : node_values_ptr_(node_values), events_ptr_(events) {}
 
+  // Frees the value of each node of `f` once all of its users have been
+  // evaluated, unless the node has an implicit use (e.g., the return value of
+  // a function). Values are moved rather than copied into a user which is the
+  // last use. Must be called before evaluation starts, and only when all of
+  // `f` is evaluated (e.g., via FunctionBase::Accept) as the values of nodes
+  // are no longer available afterwards. Not supported with an existing node
+  // values map.
+  absl::Status ReleaseValuesAfterLastUse(FunctionBase* f);
+
   // Sets the evaluated value for 'node' to the given Value. 'value' must be
   // passed in by value (ha!) because a use case is passing in a previously
   // evaluated value and inserting a into flat_hash_map (done below) invalidates
@@ -50,7 +66,9 @@ class IrInterpreter : public DfsVisitor {
 
   // Returns the previously evaluated value of 'node' as a Value.
   const Value& ResolveAsValue(Node* node) const {
-    return NodeValuesMap().at(node);
+    const Value* value = FindValue(node);
+    XLS_CHECK(value != nullptr) << "No value for node " << node->GetName();
+    return *value;
   }
 
   const InterpreterEvents& GetInterpreterEvents() const {
@@ -63,7 +81,7 @@ class IrInterpreter : public DfsVisitor {
   absl::Status AddInterpreterEvents(const InterpreterEvents& events);
 
   // Returns true if a value has been set for the result of the given node.
-  bool HasResult(Node* node) const { return NodeValuesMap().contains(node); }
+  bool HasResult(Node* node) const { return FindValue(node) != nullptr; }
 
   absl::Status HandleAdd(BinOp* add) override;
   absl::Status HandleAfterAll(AfterAll* after_all) override;
@@ -178,20 +196,59 @@ class IrInterpreter : public DfsVisitor {
   absl::StatusOr<Value> DeepOr(Type* input_type,
                                absl::Span<const Value* const> inputs);
 
-  // Returns the map which maps Node* to the Value computed for that node.
-  absl::flat_hash_map<Node*, Value>& NodeValuesMap() {
-    return node_values_ptr_ != nullptr ? *node_values_ptr_ : node_values_;
-  }
-  const absl::flat_hash_map<Node*, Value>& NodeValuesMap() const {
-    return node_values_ptr_ != nullptr ? *node_values_ptr_ : node_values_;
+  // Returns the value of operand `operand_no` of `node` for computing the
+  // value of `node`. The value is moved out of the operand if `node` is its
+  // last use (see ReleaseValuesAfterLastUse) and copied otherwise.
+  Value ConsumeOperand(Node* node, int64_t operand_no);
+
+ private:
+  friend absl::StatusOr<Value> InterpretNode(
+      Node* node, absl::Span<const Value> operand_values);
+
+  // Returns the evaluated value of `node` or nullptr if there is none.
+  const Value* FindValue(Node* node) const {
+    if (node_values_ptr_ != nullptr) {
+      auto it = node_values_ptr_->find(node);
+      return it == node_values_ptr_->end() ? nullptr : &it->second;
+    }
+    if (single_node_ != nullptr) {
+      return FindSingleNodeValue(node);
+    }
+    int64_t index = node->node_table_index();
+    if (index < 0 || index >= node_values_.size() ||
+        !node_values_[index].has_value()) {
+      return nullptr;
+    }
+    return &*node_values_[index];
   }
 
+  // Returns the value of `node` when evaluating only `single_node_`.
+  const Value* FindSingleNodeValue(Node* node) const;
+
+  // Stores `value` as the evaluated value of `node`, and frees the values of
+  // operands of `node` which have no remaining uses.
+  void StoreValue(Node* node, Value value);
+
   // The evaluated values for the nodes in the Function. To support
   // continuations, an existing map can either be passed in at construction time
-  // (`node_values_ptr_` is not null), or a freshly constructed map is used
-  // (`node_values_ptr` is null).
+  // (`node_values_ptr_` is not null). Otherwise the values are held in
+  // `node_values_` indexed by Node::node_table_index.
   absl::flat_hash_map<Node*, Value>* node_values_ptr_;
-  absl::flat_hash_map<Node*, Value> node_values_;
+  std::vector<std::optional<Value>> node_values_;
+
+  // The number of operand slots of not yet evaluated nodes which refer to each
+  // node, indexed by Node::node_table_index. Only populated by
+  // ReleaseValuesAfterLastUse. Nodes with implicit uses get an extra count so
+  // they are never freed.
+  std::vector<int64_t> remaining_uses_;
+
+  // When interpreting a single node with given operand values (InterpretNode),
+  // the node and the operand values which are referred to instead of copying
+  // them into `node_values_`. The value of the node itself is held in
+  // `single_node_value_`.
+  Node* single_node_ = nullptr;
+  absl::Span<const Value> single_node_operand_values_;
+  std::optional<Value> single_node_value_;
 
   // Events observed while interpreting (currently only trace messages). To
   // support continuations, an existing events object can either be passed in at
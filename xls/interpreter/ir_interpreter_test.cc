@@ -102,6 +102,68 @@ TEST_F(IrInterpreterOnlyTest, SideEffectingNodes) {
       IsOkAndHolds(Value(UBits(0, 5))));
 }
 
+TEST_F(IrInterpreterOnlyTest, EvaluateNodeWithRepeatedOperands) {
+  Package package("my_package");
+  std::string fn_text = R"(
+    fn f(x: bits[4], y: bits[4]) -> (bits[4], bits[4], bits[4]) {
+      ret tuple.1: (bits[4], bits[4], bits[4]) = tuple(x, y, x)
+    }
+    )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(fn_text, &package));
+
+  EXPECT_THAT(
+      InterpretNode(FindNode("tuple.1", function),
+                    {Value(UBits(1, 4)), Value(UBits(2, 4)),
+                     Value(UBits(1, 4))}),
+      IsOkAndHolds(Value::Tuple(
+          {Value(UBits(1, 4)), Value(UBits(2, 4)), Value(UBits(1, 4))})));
+  EXPECT_THAT(InterpretNode(FindNode("tuple.1", function),
+                            {Value(UBits(1, 4)), Value(UBits(2, 4))}),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(
+      InterpretNode(FindNode("tuple.1", function),
+                    {Value(UBits(1, 4)), Value(UBits(2, 4)),
+                     Value(UBits(1, 5))}),
+      StatusIs(absl::StatusCode::kInternal,
+               HasSubstr("Expected value bits[5]:1 to match type bits[4]")));
+}
+
+// Values which are moved into their last use or freed must not be observed by
+// other users, including users with repeated operands.
+TEST_F(IrInterpreterOnlyTest, ValuesReleasedAfterLastUse) {
+  Package package("my_package");
+  std::string fn_text = R"(
+    fn f(x: bits[8], s: bits[1]) -> (bits[8], (bits[8], bits[8])) {
+      literal.8: bits[8] = literal(value=0)
+      identity.1: bits[8] = identity(x)
+      tuple.2: (bits[8], bits[8]) = tuple(identity.1, identity.1)
+      tuple_index.3: bits[8] = tuple_index(tuple.2, index=1)
+      identity.4: bits[8] = identity(tuple_index.3)
+      sel.5: bits[8] = sel(s, cases=[identity.4, x])
+      add.6: bits[8] = add(sel.5, identity.4)
+      ret tuple.7: (bits[8], (bits[8], bits[8])) = tuple(add.6, tuple.2)
+    }
+    )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(fn_text, &package));
+  // Leave a tombstone in the node table.
+  XLS_ASSERT_OK(function->RemoveNode(FindNode("literal.8", function)));
+
+  Value x = Value(UBits(21, 8));
+  Value pair = Value::Tuple({x, x});
+  EXPECT_THAT(InterpretFunction(function, {x, Value::Bool(false)}),
+              IsOkAndHolds(testing::Field(
+                  &InterpreterResult<Value>::value,
+                  Value::Tuple({Value(UBits(42, 8)), pair}))));
+  EXPECT_THAT(InterpretFunction(function, {x, Value::Bool(true)}),
+              IsOkAndHolds(testing::Field(
+                  &InterpreterResult<Value>::value,
+                  Value::Tuple({Value(UBits(42, 8)), pair}))));
+}
+
 // TODO(https://github.com/google/xls/issues/506): 2021-10-05 Move these to the
 // common IR evaluator tests and make them more comprehensive once the JIT
 // supports the full range of trace operations.
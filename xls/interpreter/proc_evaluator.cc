@@ -14,9 +14,118 @@
 
 #include "xls/interpreter/proc_evaluator.h"
 
+#include <cstdint>
+
+#include "absl/strings/str_format.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
 
 namespace xls {
+namespace {
+
+void EncodeValueTo(const Value& value, std::string* bytes) {
+  if (value.IsBits()) {
+    std::vector<uint8_t> value_bytes = value.bits().ToBytes();
+    bytes->append(value_bytes.begin(), value_bytes.end());
+    return;
+  }
+  for (const Value& element : value.elements()) {
+    EncodeValueTo(element, bytes);
+  }
+}
+
+absl::StatusOr<Value> DecodeValueFrom(std::string_view bytes, Type* type,
+                                      int64_t* offset) {
+  switch (type->kind()) {
+    case TypeKind::kBits: {
+      int64_t bit_count = type->AsBitsOrDie()->bit_count();
+      int64_t byte_count = (bit_count + 7) / 8;
+      if (*offset + byte_count > bytes.size()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Snapshot value is too short for type %s", type->ToString()));
+      }
+      auto data = reinterpret_cast<const uint8_t*>(bytes.data()) + *offset;
+      *offset += byte_count;
+      return Value(Bits::FromBytes(absl::MakeConstSpan(data, byte_count),
+                                   bit_count));
+    }
+    case TypeKind::kTuple: {
+      std::vector<Value> elements;
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        XLS_ASSIGN_OR_RETURN(Value element,
+                             DecodeValueFrom(bytes, element_type, offset));
+        elements.push_back(std::move(element));
+      }
+      return Value::Tuple(elements);
+    }
+    case TypeKind::kArray: {
+      ArrayType* array_type = type->AsArrayOrDie();
+      std::vector<Value> elements;
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(
+            Value element,
+            DecodeValueFrom(bytes, array_type->element_type(), offset));
+        elements.push_back(std::move(element));
+      }
+      return Value::Array(elements);
+    }
+    case TypeKind::kToken:
+      return Value::Token();
+  }
+  XLS_LOG(FATAL) << "Invalid type kind: " << type->kind();
+}
+
+}  // namespace
+
+std::string EncodeSnapshotValue(const Value& value) {
+  std::string bytes;
+  EncodeValueTo(value, &bytes);
+  return bytes;
+}
+
+absl::StatusOr<Value> DecodeSnapshotValue(std::string_view bytes, Type* type) {
+  int64_t offset = 0;
+  XLS_ASSIGN_OR_RETURN(Value value, DecodeValueFrom(bytes, type, &offset));
+  if (offset != bytes.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Snapshot value is too long for type %s", type->ToString()));
+  }
+  return value;
+}
+
+void SaveStateSnapshot(Proc* proc, absl::Span<const Value> state,
+                       ProcContinuationSnapshotProto* snapshot) {
+  snapshot->set_proc(proc->name());
+  snapshot->clear_state();
+  for (const Value& value : state) {
+    snapshot->add_state(EncodeSnapshotValue(value));
+  }
+}
+
+absl::StatusOr<std::vector<Value>> RestoreStateSnapshot(
+    Proc* proc, const ProcContinuationSnapshotProto& snapshot) {
+  if (snapshot.proc() != proc->name()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Snapshot is of proc `%s`, expected proc `%s`",
+                        snapshot.proc(), proc->name()));
+  }
+  if (snapshot.state_size() != proc->GetStateElementCount()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Snapshot of proc `%s` has %d state elements, expected %d",
+        proc->name(), snapshot.state_size(), proc->GetStateElementCount()));
+  }
+  std::vector<Value> state;
+  state.reserve(snapshot.state_size());
+  for (int64_t i = 0; i < snapshot.state_size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(
+        Value value, DecodeSnapshotValue(snapshot.state(i),
+                                         proc->GetStateParam(i)->GetType()));
+    state.push_back(std::move(value));
+  }
+  return state;
+}
 
 bool TickResult::operator==(const TickResult& other) const {
   return execution_state == other.execution_state && channel == other.channel &&
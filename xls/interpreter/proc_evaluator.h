@@ -16,12 +16,18 @@
 #define XLS_INTERPRETER_PROC_EVALUATOR_H_
 
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/proc_runtime_snapshot.pb.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/events.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
 
 namespace xls {
@@ -45,8 +51,34 @@ class ProcContinuation {
   // of a tick, rather than, for example, blocked on a receive in the middle of
   // a tick execution.
   virtual bool AtStartOfTick() const = 0;
+
+  // Saves the execution state of the continuation to `snapshot`: the proc
+  // state and, if the continuation is in the middle of a tick, the progress
+  // through the tick. Events are not saved.
+  virtual absl::Status SaveSnapshot(
+      ProcContinuationSnapshotProto* snapshot) const = 0;
+
+  // Restores the execution state saved by SaveSnapshot. Snapshots taken at the
+  // start of a tick may come from a continuation of any evaluator of the proc;
+  // mid-tick snapshots must come from the same kind of evaluator.
+  virtual absl::Status RestoreSnapshot(
+      const ProcContinuationSnapshotProto& snapshot) = 0;
 };
 
+// Returns the compact encoding of `value` used in snapshots: the bytes of the
+// leaf bits values in order, each leaf padded to a whole number of bytes.
+std::string EncodeSnapshotValue(const Value& value);
+
+// Decodes a value of type `type` encoded with EncodeSnapshotValue.
+absl::StatusOr<Value> DecodeSnapshotValue(std::string_view bytes, Type* type);
+
+// Helpers for implementations of ProcContinuation which save and restore the
+// proc name and state held in `snapshot`.
+void SaveStateSnapshot(Proc* proc, absl::Span<const Value> state,
+                       ProcContinuationSnapshotProto* snapshot);
+absl::StatusOr<std::vector<Value>> RestoreStateSnapshot(
+    Proc* proc, const ProcContinuationSnapshotProto& snapshot);
+
 // The execution state that a proc may be left in after callin Tick.
 enum class TickExecutionState {
   // The proc tick completed.
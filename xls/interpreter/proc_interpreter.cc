@@ -14,7 +14,11 @@
 
 #include "xls/interpreter/proc_interpreter.h"
 
+#include <algorithm>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/node_iterator.h"
@@ -131,6 +135,72 @@ class ProcIrInterpreter : public IrInterpreter {
 
 }  // namespace
 
+absl::Status ProcInterpreterContinuation::SaveSnapshot(
+    ProcContinuationSnapshotProto* snapshot) const {
+  SaveStateSnapshot(proc_, state_, snapshot);
+  snapshot->clear_tick_progress();
+  if (AtStartOfTick()) {
+    return absl::OkStatus();
+  }
+  ProcInterpreterTickProto* progress = snapshot->mutable_interpreter();
+  progress->set_node_index(node_index_);
+  // Sort by node id so snapshots of the same state are identical.
+  std::vector<Node*> nodes;
+  nodes.reserve(node_values_.size());
+  for (const auto& [node, _] : node_values_) {
+    nodes.push_back(node);
+  }
+  std::sort(nodes.begin(), nodes.end(),
+            [](Node* a, Node* b) { return a->id() < b->id(); });
+  for (Node* node : nodes) {
+    progress->add_node_ids(node->id());
+    progress->add_node_values(EncodeSnapshotValue(node_values_.at(node)));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ProcInterpreterContinuation::RestoreSnapshot(
+    const ProcContinuationSnapshotProto& snapshot) {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> state,
+                       RestoreStateSnapshot(proc_, snapshot));
+  switch (snapshot.tick_progress_case()) {
+    case ProcContinuationSnapshotProto::TICK_PROGRESS_NOT_SET:
+      NextTick(std::move(state));
+      return absl::OkStatus();
+    case ProcContinuationSnapshotProto::kInterpreter:
+      break;
+    default:
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Snapshot of proc `%s` was taken in the middle of a tick by a "
+          "different evaluator",
+          proc_->name()));
+  }
+
+  const ProcInterpreterTickProto& progress = snapshot.interpreter();
+  XLS_RET_CHECK_EQ(progress.node_ids_size(), progress.node_values_size());
+  absl::flat_hash_map<int64_t, Node*> nodes_by_id;
+  for (Node* node : proc_->nodes()) {
+    nodes_by_id[node->id()] = node;
+  }
+  absl::flat_hash_map<Node*, Value> node_values;
+  for (int64_t i = 0; i < progress.node_ids_size(); ++i) {
+    auto it = nodes_by_id.find(progress.node_ids(i));
+    if (it == nodes_by_id.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Snapshot of proc `%s` refers to unknown node id %d",
+                          proc_->name(), progress.node_ids(i)));
+    }
+    XLS_ASSIGN_OR_RETURN(Value value,
+                         DecodeSnapshotValue(progress.node_values(i),
+                                             it->second->GetType()));
+    node_values[it->second] = std::move(value);
+  }
+  NextTick(std::move(state));
+  node_index_ = progress.node_index();
+  node_values_ = std::move(node_values);
+  return absl::OkStatus();
+}
+
 ProcInterpreter::ProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager)
     : proc_(proc),
       queue_manager_(queue_manager),
@@ -38,7 +38,8 @@ class ProcInterpreterContinuation : public ProcContinuation {
   // Construct a new continuation. Execution the proc begins with the state set
   // to its initial values with no proc nodes yet executed.
   explicit ProcInterpreterContinuation(Proc* proc)
-      : node_index_(0),
+      : proc_(proc),
+        node_index_(0),
         state_(proc->InitValues().begin(), proc->InitValues().end()) {}
 
   ~ProcInterpreterContinuation() override = default;
@@ -47,6 +48,10 @@ class ProcInterpreterContinuation : public ProcContinuation {
   const InterpreterEvents& GetEvents() const override { return events_; }
   InterpreterEvents& GetEvents() override { return events_; }
   bool AtStartOfTick() const override { return node_index_ == 0; }
+  absl::Status SaveSnapshot(
+      ProcContinuationSnapshotProto* snapshot) const override;
+  absl::Status RestoreSnapshot(
+      const ProcContinuationSnapshotProto& snapshot) override;
 
   // Resets the continuation so it will start executing at the beginning of the
   // proc with the given state values.
@@ -68,6 +73,7 @@ class ProcInterpreterContinuation : public ProcContinuation {
   }
 
  private:
+  Proc* proc_;
   int64_t node_index_;
   std::vector<Value> state_;
 
@@ -15,8 +15,12 @@
 #include "xls/interpreter/proc_runtime.h"
 
 #include <deque>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 
 namespace xls {
@@ -35,9 +39,26 @@ ProcRuntime::ProcRuntime(
   }
 }
 
-absl::Status ProcRuntime::Tick() {
-  std::vector<Channel*> blocked_channels;
+absl::StatusOr<ProcRuntime::NetworkTickResult>
+ProcRuntime::TickNetworkAndModels() {
+  absl::Span<const std::unique_ptr<ChannelModel>> models =
+      queue_manager_->models();
+  bool responses_pending = false;
+  for (const std::unique_ptr<ChannelModel>& model : models) {
+    responses_pending = responses_pending || model->HasPendingResponses();
+  }
   XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+  for (const std::unique_ptr<ChannelModel>& model : models) {
+    model->Tick();
+  }
+  // Procs waiting on a response which a model delivers in a later tick are
+  // not deadlocked.
+  result.progress_made = result.progress_made || responses_pending;
+  return result;
+}
+
+absl::Status ProcRuntime::Tick() {
+  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickNetworkAndModels());
   if (!result.progress_made) {
     // Not a single instruction executed on any proc. This is necessarily a
     // deadlock.
@@ -45,6 +66,7 @@ absl::Status ProcRuntime::Tick() {
         absl::StrFormat("Proc network is deadlocked. Blocked channels: %s",
                         absl::StrJoin(result.blocked_channels, ", ")));
   }
+  ++tick_count_;
   return absl::OkStatus();
 }
 
@@ -111,11 +133,12 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilBlocked(
                                     package_->name());
   int64_t ticks = 0;
   while (!max_ticks.has_value() || ticks < max_ticks.value()) {
-    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickNetworkAndModels());
     if (!result.progress_made) {
       return ticks;
     }
     ticks++;
+    ++tick_count_;
   }
   return absl::DeadlineExceededError(absl::StrFormat(
       "Exceeded limit of %d ticks of the proc network before blocking",
@@ -127,6 +150,125 @@ void ProcRuntime::ResetState() {
     EvaluatorContext& context = evaluator_contexts_[proc.get()];
     context.continuation = context.evaluator->NewContinuation();
   }
+  for (const auto& [proc, sink] : event_sinks_) {
+    evaluator_contexts_.at(proc).continuation->GetEvents().sink = sink;
+  }
+  tick_count_ = 0;
+}
+
+absl::StatusOr<ProcRuntimeSnapshotProto> ProcRuntime::SaveSnapshot() {
+  if (!queue_manager_->models().empty()) {
+    return absl::FailedPreconditionError(
+        "Cannot snapshot a proc network with channel models attached");
+  }
+  ProcRuntimeSnapshotProto snapshot;
+  snapshot.set_tick_count(tick_count_);
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    XLS_RETURN_IF_ERROR(
+        evaluator_contexts_.at(proc.get())
+            .continuation->SaveSnapshot(snapshot.add_procs()));
+  }
+  for (Channel* channel : package_->channels()) {
+    ChannelQueue& queue = queue_manager().GetQueue(channel);
+    if (queue.HasGenerator()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot snapshot channel `%s` which has a generator attached",
+          channel->name()));
+    }
+    std::vector<Value> values;
+    if (channel->kind() == ChannelKind::kSingleValue) {
+      // Reading a single-value channel does not consume the value.
+      values = queue.ReadBatch(1);
+    } else {
+      // Drain the queue and write the values straight back.
+      values = queue.ReadBatch(queue.GetSize());
+      XLS_RETURN_IF_ERROR(queue.WriteBatch(values));
+    }
+    ChannelQueueSnapshotProto* channel_snapshot = snapshot.add_channels();
+    channel_snapshot->set_channel(channel->name());
+    for (const Value& value : values) {
+      channel_snapshot->add_values(EncodeSnapshotValue(value));
+    }
+  }
+  return snapshot;
+}
+
+absl::Status ProcRuntime::RestoreSnapshot(
+    const ProcRuntimeSnapshotProto& snapshot) {
+  absl::flat_hash_map<std::string, const ProcContinuationSnapshotProto*>
+      proc_snapshots;
+  for (const ProcContinuationSnapshotProto& proc_snapshot : snapshot.procs()) {
+    proc_snapshots[proc_snapshot.proc()] = &proc_snapshot;
+  }
+  absl::flat_hash_map<std::string, const ChannelQueueSnapshotProto*>
+      channel_snapshots;
+  for (const ChannelQueueSnapshotProto& channel_snapshot :
+       snapshot.channels()) {
+    channel_snapshots[channel_snapshot.channel()] = &channel_snapshot;
+  }
+  if (proc_snapshots.size() != package_->procs().size() ||
+      channel_snapshots.size() != package_->channels().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Snapshot has %d procs and %d channels, expected %d procs and %d "
+        "channels",
+        proc_snapshots.size(), channel_snapshots.size(),
+        package_->procs().size(), package_->channels().size()));
+  }
+
+  // Decode the channel contents before modifying any state.
+  absl::flat_hash_map<Channel*, std::vector<Value>> channel_values;
+  for (Channel* channel : package_->channels()) {
+    auto it = channel_snapshots.find(channel->name());
+    if (it == channel_snapshots.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Snapshot has no contents for channel `%s`", channel->name()));
+    }
+    std::vector<Value>& values = channel_values[channel];
+    for (const std::string& bytes : it->second->values()) {
+      XLS_ASSIGN_OR_RETURN(Value value,
+                           DecodeSnapshotValue(bytes, channel->type()));
+      values.push_back(std::move(value));
+    }
+    ChannelQueue& queue = queue_manager().GetQueue(channel);
+    if (queue.HasGenerator()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot restore channel `%s` which has a generator attached",
+          channel->name()));
+    }
+    if (channel->kind() == ChannelKind::kSingleValue && values.empty() &&
+        !queue.IsEmpty()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot restore empty single-value channel `%s` as it already holds "
+          "a value",
+          channel->name()));
+    }
+  }
+
+  ResetState();
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    auto it = proc_snapshots.find(proc->name());
+    if (it == proc_snapshots.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Snapshot has no state for proc `%s`", proc->name()));
+    }
+    XLS_RETURN_IF_ERROR(
+        evaluator_contexts_.at(proc.get())
+            .continuation->RestoreSnapshot(*it->second));
+  }
+  for (Channel* channel : package_->channels()) {
+    ChannelQueue& queue = queue_manager().GetQueue(channel);
+    if (channel->kind() != ChannelKind::kSingleValue) {
+      queue.ReadBatch(queue.GetSize());
+    }
+    XLS_RETURN_IF_ERROR(queue.WriteBatch(channel_values.at(channel)));
+  }
+  tick_count_ = snapshot.tick_count();
+  return absl::OkStatus();
+}
+
+void ProcRuntime::SetEventSink(Proc* proc, EventSink* sink) {
+  event_sinks_[proc] = sink;
+  evaluator_contexts_.at(proc).continuation->GetEvents().sink = sink;
 }
 
 absl::StatusOr<JitChannelQueueManager*>
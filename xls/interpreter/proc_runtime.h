@@ -18,9 +18,11 @@
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_snapshot.pb.h"
 #include "xls/ir/events.h"
 #include "xls/ir/package.h"
 #include "xls/jit/jit_channel_queue.h"
@@ -80,13 +82,37 @@ class ProcRuntime {
   }
 
   // Reset the state of all of the procs to their initial state.
-  void ResetState();
+  virtual void ResetState();
+
+  // Returns the number of ticks of the proc network executed since
+  // construction or the last call to ResetState.
+  int64_t tick_count() const { return tick_count_; }
+
+  // Returns a snapshot of the execution state of the proc network: the state
+  // of each proc including progress through a partially executed tick, the
+  // contents of every channel queue, and the tick count. Events are not
+  // included. Returns an error if a channel queue has a generator attached or
+  // a channel model is attached as neither can be saved. Must not be called
+  // concurrently with ticking.
+  absl::StatusOr<ProcRuntimeSnapshotProto> SaveSnapshot();
+
+  // Restores the execution state of the proc network from a snapshot taken by
+  // SaveSnapshot of a runtime of the same package. The runtime may use
+  // different evaluators if no proc was in the middle of a tick. On error the
+  // state of the runtime is unspecified.
+  absl::Status RestoreSnapshot(const ProcRuntimeSnapshotProto& snapshot);
 
   // Returns the events for each proc in the network.
   const InterpreterEvents& GetInterpreterEvents(Proc* proc) const {
     return evaluator_contexts_.at(proc).continuation->GetEvents();
   }
 
+  // Sets the sink which receives the trace and assert events of `proc` as they
+  // are produced instead of having them accumulated in the events returned by
+  // GetInterpreterEvents. The sink is not owned and is retained across
+  // ResetState. A null sink restores accumulation.
+  void SetEventSink(Proc* proc, EventSink* sink);
+
  protected:
   // Execute (up to) a single iteration of every proc in the package.
   struct NetworkTickResult {
@@ -95,6 +121,10 @@ class ProcRuntime {
   };
   virtual absl::StatusOr<NetworkTickResult> TickInternal() = 0;
 
+  // Calls TickInternal and then ticks the channel models of the queue manager.
+  // Progress is reported if any model had responses pending.
+  absl::StatusOr<NetworkTickResult> TickNetworkAndModels();
+
   Package* package_;
   std::unique_ptr<ChannelQueueManager> queue_manager_;
   struct EvaluatorContext {
@@ -102,6 +132,8 @@ class ProcRuntime {
     std::unique_ptr<ProcContinuation> continuation;
   };
   absl::flat_hash_map<Proc*, EvaluatorContext> evaluator_contexts_;
+  absl::flat_hash_map<Proc*, EventSink*> event_sinks_;
+  int64_t tick_count_ = 0;
 };
 
 }  // namespace xls
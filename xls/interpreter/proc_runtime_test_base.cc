@@ -19,7 +19,9 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "xls/common/status/matchers.h"
+#include "xls/interpreter/proc_runtime_snapshot.pb.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/event_sinks.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
@@ -30,7 +32,9 @@ namespace {
 
 using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Optional;
 
 // Creates a proc which has a single send operation using the given channel
@@ -700,6 +704,82 @@ TEST_P(ProcRuntimeTestBase, StateReset) {
   EXPECT_THAT(output_queue.Read(), Optional(Value(SBits(14, 32))));
 }
 
+TEST_P(ProcRuntimeTestBase, TraceEventSink) {
+  auto package = CreatePackage();
+
+  ProcBuilder pb("tracer", /*token_name=*/"tkn", package.get());
+  BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+  BValue trace_token = pb.Trace(pb.GetTokenParam(), pb.Literal(UBits(1, 1)),
+                                {st}, "st is {}");
+  BValue next_st = pb.Add(st, pb.Literal(UBits(1, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build(trace_token, {next_st}));
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  RingBufferEventSink sink(/*capacity=*/2);
+  runtime->SetEventSink(proc, &sink);
+
+  for (int64_t i = 0; i < 5; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  EXPECT_THAT(runtime->GetInterpreterEvents(proc).trace_msgs, IsEmpty());
+  EXPECT_THAT(sink.GetTraceMessages(), ElementsAre("st is 3", "st is 4"));
+  EXPECT_EQ(sink.dropped_count(), 3);
+  ASSERT_EQ(sink.traces().size(), 2);
+  EXPECT_THAT(sink.traces().back().args, ElementsAre(Value(UBits(4, 32))));
+
+  // The sink is retained across a reset.
+  runtime->ResetState();
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_THAT(sink.GetTraceMessages(), ElementsAre("st is 4", "st is 0"));
+}
+
+TEST_P(ProcRuntimeTestBase, SnapshotAndRestore) {
+  auto package = CreatePackage();
+  Type* u32 = package->GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_in,
+      package->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_out,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK(
+      CreateAccumProc("accum", ch_in, ch_out, package.get()).status());
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(runtime->queue_manager().GetQueue(ch_in).WriteBatch(
+      {Value(UBits(1, 32)), Value(UBits(2, 32)), Value(UBits(3, 32))}));
+  // The accumulator is left blocked on its receive in the middle of a tick.
+  XLS_ASSERT_OK(runtime->TickUntilBlocked().status());
+  ChannelQueue& output_queue = runtime->queue_manager().GetQueue(ch_out);
+  EXPECT_THAT(output_queue.ReadBatch(2),
+              ElementsAre(Value(UBits(1, 32)), Value(UBits(3, 32))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(ProcRuntimeSnapshotProto snapshot,
+                           runtime->SaveSnapshot());
+  EXPECT_EQ(snapshot.tick_count(), runtime->tick_count());
+  EXPECT_EQ(output_queue.GetSize(), 1);
+
+  ProcRuntimeSnapshotProto parsed;
+  ASSERT_TRUE(parsed.ParseFromString(snapshot.SerializeAsString()));
+  std::unique_ptr<ProcRuntime> restored =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(restored->RestoreSnapshot(parsed));
+  EXPECT_EQ(restored->tick_count(), runtime->tick_count());
+  EXPECT_EQ(restored->ResolveState(package->procs().front().get()),
+            runtime->ResolveState(package->procs().front().get()));
+
+  // Both runtimes continue identically from the snapshot.
+  for (ProcRuntime* r : {runtime.get(), restored.get()}) {
+    XLS_ASSERT_OK(
+        r->queue_manager().GetQueue(ch_in).Write(Value(UBits(10, 32))));
+    XLS_ASSERT_OK(r->TickUntilBlocked().status());
+    EXPECT_THAT(r->queue_manager().GetQueue(ch_out).ReadBatch(3),
+                ElementsAre(Value(UBits(6, 32)), Value(UBits(16, 32))));
+  }
+}
+
 TEST_P(ProcRuntimeTestBase, NonBlockingReceivesProc) {
   auto package = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Channel * in0, package->CreateStreamingChannel(
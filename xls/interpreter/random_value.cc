@@ -14,7 +14,11 @@
 
 #include "xls/interpreter/random_value.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "absl/status/status.h"
+#include "xls/common/logging/logging.h"
 #include "xls/interpreter/function_interpreter.h"
 
 namespace xls {
@@ -95,4 +99,85 @@ absl::StatusOr<std::vector<Value>> RandomFunctionArguments(
       "or the limit should be increased."));
 }
 
+namespace {
+
+// Returns the next output of a splitmix64 generator with state `x`. Used to
+// expand seeds into the xoshiro state as recommended by its authors.
+uint64_t SplitMix64(uint64_t* x) {
+  uint64_t z = (*x += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+}  // namespace
+
+Xoshiro256StarStar::Xoshiro256StarStar(uint64_t seed, uint64_t stream) {
+  // Hash the seed and the stream separately before combining them so that
+  // adjacent (seed, stream) pairs do not yield overlapping splitmix sequences.
+  uint64_t seed_state = seed;
+  uint64_t stream_state = ~stream;
+  uint64_t x = SplitMix64(&seed_state) ^ SplitMix64(&stream_state);
+  for (uint64_t& word : state_) {
+    word = SplitMix64(&x);
+  }
+}
+
+RandomNativeValueGenerator::RandomNativeValueGenerator(
+    const TypeLayout& layout)
+    : layout_(layout), mask_((layout.size() + 7) / 8, 0) {
+  int64_t leaf_index = 0;
+  BuildMask(layout.type(), &leaf_index,
+            reinterpret_cast<uint8_t*>(mask_.data()));
+  XLS_CHECK_EQ(leaf_index, layout.elements().size());
+}
+
+void RandomNativeValueGenerator::BuildMask(Type* type, int64_t* leaf_index,
+                                           uint8_t* mask) {
+  if (type->IsTuple()) {
+    for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+      BuildMask(element_type, leaf_index, mask);
+    }
+    return;
+  }
+  if (type->IsArray()) {
+    ArrayType* array_type = type->AsArrayOrDie();
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      BuildMask(array_type->element_type(), leaf_index, mask);
+    }
+    return;
+  }
+  const ElementLayout& element = layout_.elements()[(*leaf_index)++];
+  if (type->IsToken()) {
+    return;
+  }
+  // Bits are stored little-endian so the data bits are the low bits of the
+  // leaf's data bytes.
+  int64_t bit_count = type->AsBitsOrDie()->bit_count();
+  uint8_t* leaf_mask = mask + element.offset;
+  std::memset(leaf_mask, 0xff, bit_count / 8);
+  if (bit_count % 8 != 0) {
+    leaf_mask[bit_count / 8] = (1 << (bit_count % 8)) - 1;
+  }
+}
+
+void RandomNativeValueGenerator::Generate(Xoshiro256StarStar* engine,
+                                          uint8_t* buffer) const {
+  int64_t remaining = size();
+  for (uint64_t mask_word : mask_) {
+    uint64_t word = (*engine)() & mask_word;
+    int64_t word_bytes = std::min<int64_t>(remaining, sizeof(word));
+    std::memcpy(buffer, &word, word_bytes);
+    buffer += word_bytes;
+    remaining -= word_bytes;
+  }
+}
+
+Value RandomNativeValueGenerator::GenerateValue(
+    Xoshiro256StarStar* engine) const {
+  std::vector<uint8_t> buffer(size());
+  Generate(engine, buffer.data());
+  return layout_.NativeLayoutToValue(buffer.data());
+}
+
 }  // namespace xls
@@ -22,6 +22,7 @@
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 namespace {
@@ -111,5 +112,61 @@ TEST(RandomValueTest, RandomOtherTypes) {
   }
 }
 
+TEST(RandomValueTest, Xoshiro256StarStarStreams) {
+  Xoshiro256StarStar engine0(/*seed=*/42, /*stream=*/0);
+  Xoshiro256StarStar engine0_again(/*seed=*/42, /*stream=*/0);
+  Xoshiro256StarStar engine1(/*seed=*/42, /*stream=*/1);
+  absl::flat_hash_set<uint64_t> samples;
+  for (int64_t i = 0; i < 1024; ++i) {
+    uint64_t sample = engine0();
+    EXPECT_EQ(sample, engine0_again());
+    EXPECT_TRUE(samples.insert(sample).second);
+    EXPECT_TRUE(samples.insert(engine1()).second);
+  }
+}
+
+TEST(RandomValueTest, RandomNativeValue) {
+  Package p("test_package");
+  // Layout of (bits[3], bits[42], token, bits[0]) with padding between and
+  // after the elements.
+  Type* type = p.GetTupleType({p.GetBitsType(3), p.GetBitsType(42),
+                               p.GetTokenType(), p.GetBitsType(0)});
+  TypeLayout layout(
+      type, 20,
+      {ElementLayout{.offset = 0, .data_size = 1, .padded_size = 1},
+       ElementLayout{.offset = 8, .data_size = 6, .padded_size = 8},
+       ElementLayout{.offset = 16, .data_size = 0, .padded_size = 0},
+       ElementLayout{.offset = 16, .data_size = 0, .padded_size = 0}});
+  RandomNativeValueGenerator generator(layout);
+  EXPECT_EQ(generator.size(), 20);
+
+  Xoshiro256StarStar engine(/*seed=*/0);
+  std::vector<uint8_t> ored(layout.size(), 0);
+  for (int64_t i = 0; i < 1024; ++i) {
+    std::vector<uint8_t> buffer(layout.size(), 0xaa);
+    generator.Generate(&engine, buffer.data());
+    for (int64_t j = 0; j < buffer.size(); ++j) {
+      ored[j] |= buffer[j];
+    }
+  }
+  // Every data bit is set at least once and all padding is cleared.
+  EXPECT_EQ(ored, std::vector<uint8_t>({0x07, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff,
+                                        0xff, 0xff, 0xff, 0x03, 0, 0, 0, 0, 0,
+                                        0}));
+
+  Value value = generator.GenerateValue(&engine);
+  EXPECT_TRUE(value.IsTuple());
+  EXPECT_EQ(value.element(0).bits().bit_count(), 3);
+  EXPECT_EQ(value.element(1).bits().bit_count(), 42);
+  EXPECT_TRUE(value.element(2).IsToken());
+  EXPECT_EQ(value.element(3).bits().bit_count(), 0);
+
+  // Generation is reproducible for a given seed and stream.
+  Xoshiro256StarStar engine0(/*seed=*/7, /*stream=*/3);
+  Xoshiro256StarStar engine1(/*seed=*/7, /*stream=*/3);
+  EXPECT_EQ(generator.GenerateValue(&engine0),
+            generator.GenerateValue(&engine1));
+}
+
 }  // namespace
 }  // namespace xls
@@ -53,8 +53,18 @@ SerialProcRuntime::TickInternal() {
 
   std::deque<Proc*> ready_procs;
 
-  // Put all procs on the ready list.
+  // Put all procs on the ready list except those which remain blocked on a
+  // receive from the last tick. A blocked proc becomes ready if its channel
+  // was written to since (e.g., by the user of the runtime).
   for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    auto it = blocked_procs_.find(proc.get());
+    if (it != blocked_procs_.end()) {
+      ChannelQueue& queue = queue_manager_->GetQueue(it->second);
+      if (queue.IsEmpty() && !queue.HasGenerator()) {
+        blocked_procs[it->second] = proc.get();
+        continue;
+      }
+    }
     XLS_VLOG(3) << absl::StreamFormat("Proc `%s` added to ready list",
                                       proc->name());
     ready_procs.push_back(proc.get());
@@ -92,6 +102,11 @@ SerialProcRuntime::TickInternal() {
       blocked_procs[channel] = proc;
     }
   }
+  blocked_procs_.clear();
+  for (auto [channel, proc] : blocked_procs) {
+    blocked_procs_[proc] = channel;
+  }
+
   auto get_blocked_channels = [&]() {
     std::vector<Channel*> channels;
     for (auto [channel, proc] : blocked_procs) {
@@ -107,4 +122,9 @@ SerialProcRuntime::TickInternal() {
   };
 }
 
+void SerialProcRuntime::ResetState() {
+  ProcRuntime::ResetState();
+  blocked_procs_.clear();
+}
+
 }  // namespace xls
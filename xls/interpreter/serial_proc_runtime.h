@@ -18,6 +18,7 @@
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
@@ -38,6 +39,8 @@ class SerialProcRuntime : public ProcRuntime {
       std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
       std::unique_ptr<ChannelQueueManager>&& queue_manager);
 
+  void ResetState() override;
+
  private:
   SerialProcRuntime(
       Package* package,
@@ -46,6 +49,12 @@ class SerialProcRuntime : public ProcRuntime {
       : ProcRuntime(package, std::move(evaluators), std::move(queue_manager)) {}
 
   absl::StatusOr<SerialProcRuntime::NetworkTickResult> TickInternal() override;
+
+  // Procs which were blocked on a receive at the end of the last network tick
+  // and the channel each is blocked on. A blocked proc is only ticked again
+  // once a value may be read from its channel so the cost of a network tick
+  // scales with the number of runnable procs rather than the number of procs.
+  absl::flat_hash_map<Proc*, Channel*> blocked_procs_;
 };
 
 }  // namespace xls
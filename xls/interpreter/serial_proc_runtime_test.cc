@@ -16,9 +16,13 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_proc_runtime.h"
@@ -27,6 +31,8 @@
 namespace xls {
 namespace {
 
+using ::testing::Optional;
+
 // Create a SerialProcRuntime composed of a mix of ProcInterpreters and
 // ProcJits.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateMixedSerialProcRuntime(
@@ -95,5 +101,96 @@ INSTANTIATE_TEST_SUITE_P(
       return info.param.name();
     });
 
+// A ProcInterpreter which counts the number of times it is ticked.
+class CountingProcInterpreter : public ProcInterpreter {
+ public:
+  CountingProcInterpreter(Proc* proc, ChannelQueueManager* queue_manager,
+                          int64_t* tick_count)
+      : ProcInterpreter(proc, queue_manager), tick_count_(tick_count) {}
+
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override {
+    ++*tick_count_;
+    return ProcInterpreter::Tick(continuation);
+  }
+
+ private:
+  int64_t* tick_count_;
+};
+
+class SerialProcRuntimeTest : public IrTestBase {};
+
+TEST_F(SerialProcRuntimeTest, BlockedProcsAreNotTicked) {
+  auto package = CreatePackage();
+  Type* u32 = package->GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * iota_out,
+      package->CreateStreamingChannel("iota_out", ChannelOps::kSendOnly, u32));
+
+  // A proc which passes values from `in` to `out` and so is blocked until a
+  // value is written to `in`.
+  ProcBuilder pass_pb("pass", /*token_name=*/"tok", package.get());
+  BValue token_input = pass_pb.Receive(in, pass_pb.GetTokenParam());
+  BValue send_token = pass_pb.Send(out, pass_pb.TupleIndex(token_input, 0),
+                                   pass_pb.TupleIndex(token_input, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * pass, pass_pb.Build(send_token, {}));
+
+  // A proc which is never blocked.
+  ProcBuilder iota_pb("iota", /*token_name=*/"tok", package.get());
+  BValue st = iota_pb.StateElement("st", Value(UBits(0, 32)));
+  BValue iota_send = iota_pb.Send(iota_out, iota_pb.GetTokenParam(), st);
+  XLS_ASSERT_OK(
+      iota_pb.Build(iota_send, {iota_pb.Add(st, iota_pb.Literal(UBits(1, 32)))})
+          .status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelQueueManager> queue_manager,
+                           ChannelQueueManager::Create(package.get()));
+  absl::flat_hash_map<Proc*, int64_t> tick_counts;
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    evaluators.push_back(std::make_unique<CountingProcInterpreter>(
+        proc.get(), queue_manager.get(), &tick_counts[proc.get()]));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      SerialProcRuntime::Create(package.get(), std::move(evaluators),
+                                std::move(queue_manager)));
+
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  // The pass-through proc blocked in the first tick and as nothing was written
+  // to its input channel it was not ticked again.
+  EXPECT_EQ(tick_counts.at(pass), 1);
+  EXPECT_EQ(runtime->queue_manager().GetQueue(iota_out).GetSize(), 10);
+
+  // A write to the input channel wakes the blocked proc.
+  XLS_ASSERT_OK(
+      runtime->queue_manager().GetQueue(in).Write(Value(UBits(42, 32))));
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_GT(tick_counts.at(pass), 1);
+  EXPECT_THAT(runtime->queue_manager().GetQueue(out).Read(),
+              Optional(Value(UBits(42, 32))));
+
+  // The proc blocks again in the next tick and then stays blocked.
+  XLS_ASSERT_OK(runtime->Tick());
+  int64_t tick_count = tick_counts.at(pass);
+  for (int64_t i = 0; i < 10; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+  EXPECT_EQ(tick_counts.at(pass), tick_count);
+
+  // Resetting the runtime resets the blocked procs.
+  runtime->ResetState();
+  XLS_ASSERT_OK(runtime->Tick());
+  EXPECT_EQ(tick_counts.at(pass), tick_count + 1);
+}
+
 }  // namespace
 }  // namespace xls
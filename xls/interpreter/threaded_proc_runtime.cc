@@ -0,0 +1,232 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/threaded_proc_runtime.h"
+
+#include <algorithm>
+#include <deque>
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+/* static */
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+ThreadedProcRuntime::Create(
+    Package* package, std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    int64_t thread_count) {
+  XLS_RET_CHECK_GE(thread_count, 0);
+  // Verify there exists exactly one evaluator per proc in the package.
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc.get()))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(), package->procs().size())
+      << "More evaluators than procs given.";
+  auto runtime = absl::WrapUnique(new ThreadedProcRuntime(
+      package, std::move(evaluator_map), std::move(queue_manager)));
+
+  if (thread_count == 0) {
+    thread_count = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+  }
+  int64_t worker_count =
+      std::min<int64_t>(thread_count, package->procs().size());
+  runtime->proc_groups_.resize(worker_count);
+  for (int64_t i = 0; i < package->procs().size(); ++i) {
+    runtime->proc_groups_[i % worker_count].push_back(
+        package->procs()[i].get());
+  }
+  {
+    absl::MutexLock lock(&runtime->mutex_);
+    runtime->blocked_channels_.resize(worker_count);
+  }
+  for (int64_t i = 0; i < worker_count; ++i) {
+    ThreadedProcRuntime* runtime_ptr = runtime.get();
+    runtime->workers_.push_back(std::make_unique<Thread>(
+        [runtime_ptr, i]() { runtime_ptr->WorkerLoop(i); }));
+  }
+  return std::move(runtime);
+}
+
+ThreadedProcRuntime::~ThreadedProcRuntime() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+void ThreadedProcRuntime::MaybeCompleteTick() {
+  if (blocked_workers_ + finished_workers_ == workers_.size()) {
+    completed_tick_ = current_tick_;
+  }
+}
+
+void ThreadedProcRuntime::WorkerLoop(int64_t worker_index) {
+  int64_t last_tick = 0;
+  while (true) {
+    int64_t tick;
+    {
+      absl::MutexLock lock(&mutex_);
+      auto tick_started = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return shutdown_ || current_tick_ > last_tick;
+      };
+      mutex_.Await(absl::Condition(&tick_started));
+      if (shutdown_) {
+        return;
+      }
+      tick = current_tick_;
+    }
+    RunWorkerTick(worker_index, tick);
+    last_tick = tick;
+  }
+}
+
+void ThreadedProcRuntime::RunWorkerTick(int64_t worker_index, int64_t tick) {
+  std::deque<Proc*> ready_procs(proc_groups_[worker_index].begin(),
+                                proc_groups_[worker_index].end());
+  // Procs blocked on receives and the channels they are blocked on.
+  std::vector<std::pair<Proc*, Channel*>> blocked_procs;
+  absl::Status status;
+  while (true) {
+    int64_t generation;
+    {
+      absl::MutexLock lock(&mutex_);
+      generation = send_generation_;
+    }
+
+    bool progress_made = false;
+    while (!ready_procs.empty()) {
+      Proc* proc = ready_procs.front();
+      ready_procs.pop_front();
+      EvaluatorContext& context = evaluator_contexts_.at(proc);
+
+      XLS_VLOG(3) << absl::StreamFormat("Worker %d ticking proc `%s`",
+                                        worker_index, proc->name());
+      absl::StatusOr<TickResult> tick_result =
+          context.evaluator->Tick(*context.continuation);
+      if (!tick_result.ok()) {
+        status = tick_result.status();
+        break;
+      }
+      XLS_VLOG(3) << "Tick result: " << *tick_result;
+
+      progress_made |= tick_result->progress_made;
+      if (tick_result->execution_state ==
+          TickExecutionState::kSentOnChannel) {
+        {
+          // Wake any workers blocked waiting for data. They are no longer
+          // idle.
+          absl::MutexLock lock(&mutex_);
+          ++send_generation_;
+          blocked_workers_ = 0;
+        }
+        ready_procs.push_back(proc);
+      } else if (tick_result->execution_state ==
+                 TickExecutionState::kBlockedOnReceive) {
+        blocked_procs.push_back({proc, tick_result->channel.value()});
+      }
+    }
+
+    absl::MutexLock lock(&mutex_);
+    progress_made_ |= progress_made;
+    if (!status.ok() || blocked_procs.empty()) {
+      // Either every proc in the group completed its iteration or an error
+      // occurred. Nothing more to do in this tick.
+      if (!status.ok() && status_.ok()) {
+        status_ = status;
+      }
+      blocked_channels_[worker_index].clear();
+      ++finished_workers_;
+      MaybeCompleteTick();
+      return;
+    }
+
+    if (send_generation_ == generation) {
+      // No data was sent since the blocked procs were ticked. Sleep until
+      // another worker sends data or the tick completes.
+      blocked_channels_[worker_index].clear();
+      for (auto [proc, channel] : blocked_procs) {
+        blocked_channels_[worker_index].push_back(channel);
+      }
+      ++blocked_workers_;
+      MaybeCompleteTick();
+      auto can_proceed = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+        return completed_tick_ >= tick || send_generation_ != generation;
+      };
+      mutex_.Await(absl::Condition(&can_proceed));
+      if (completed_tick_ >= tick) {
+        return;
+      }
+    }
+
+    // Data may have become available. Retry the blocked procs.
+    for (auto [proc, channel] : blocked_procs) {
+      ready_procs.push_back(proc);
+    }
+    blocked_procs.clear();
+  }
+}
+
+absl::StatusOr<ThreadedProcRuntime::NetworkTickResult>
+ThreadedProcRuntime::TickInternal() {
+  XLS_VLOG(3) << absl::StreamFormat("TickInternal on package %s",
+                                    package_->name());
+  if (workers_.empty()) {
+    return NetworkTickResult{.progress_made = false, .blocked_channels = {}};
+  }
+
+  absl::MutexLock lock(&mutex_);
+  progress_made_ = false;
+  status_ = absl::OkStatus();
+  blocked_workers_ = 0;
+  finished_workers_ = 0;
+  int64_t tick = ++current_tick_;
+  auto tick_completed = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return completed_tick_ >= tick;
+  };
+  mutex_.Await(absl::Condition(&tick_completed));
+  XLS_RETURN_IF_ERROR(status_);
+
+  std::vector<Channel*> blocked_channels;
+  for (const std::vector<Channel*>& channels : blocked_channels_) {
+    blocked_channels.insert(blocked_channels.end(), channels.begin(),
+                            channels.end());
+  }
+  std::sort(blocked_channels.begin(), blocked_channels.end(),
+            [](Channel* a, Channel* b) { return a->id() < b->id(); });
+  return NetworkTickResult{
+      .progress_made = progress_made_,
+      .blocked_channels = std::move(blocked_channels),
+  };
+}
+
+}  // namespace xls
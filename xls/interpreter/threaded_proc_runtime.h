@@ -0,0 +1,108 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_THREADED_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_THREADED_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+
+namespace xls {
+
+// Class for evaluating a network of procs on a pool of worker threads. The
+// procs are partitioned into groups with each group assigned to a worker. A
+// network tick has the same semantics as in SerialProcRuntime (every proc
+// executes up to one iteration) but the groups tick concurrently. A worker
+// whose procs are all blocked on receives sleeps until some other worker sends
+// data on a channel. The tick ends once every worker has either completed its
+// procs' iterations or is blocked with no other worker able to make progress.
+//
+// The channel queue manager must be thread-safe (e.g., created with
+// JitChannelQueueManager::CreateThreadSafe) and the evaluators must support
+// concurrently ticking different procs.
+class ThreadedProcRuntime : public ProcRuntime {
+ public:
+  // Creates a runtime which evaluates the procs in `package` with
+  // `thread_count` worker threads. If `thread_count` is zero, the number of
+  // hardware threads is used. The number of workers never exceeds the number
+  // of procs.
+  static absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>> Create(
+      Package* package,
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      int64_t thread_count = 0);
+
+  ~ThreadedProcRuntime() override;
+
+  int64_t worker_count() const { return workers_.size(); }
+
+ private:
+  ThreadedProcRuntime(
+      Package* package,
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager)
+      : ProcRuntime(package, std::move(evaluators), std::move(queue_manager)) {}
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  // The main loop of a worker thread.
+  void WorkerLoop(int64_t worker_index);
+
+  // Executes up to one iteration of each proc in the worker's group for the
+  // network tick `tick`.
+  void RunWorkerTick(int64_t worker_index, int64_t tick);
+
+  // Marks the current network tick complete if every worker is idle.
+  void MaybeCompleteTick() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // The procs assigned to each worker.
+  std::vector<std::vector<Proc*>> proc_groups_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+
+  absl::Mutex mutex_;
+  // Identifier of the most recently started network tick and of the most
+  // recently completed network tick.
+  int64_t current_tick_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t completed_tick_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Incremented every time a proc sends on a channel. Used to wake workers
+  // blocked on receives.
+  int64_t send_generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of workers sleeping until a send occurs and number of workers which
+  // have finished the current tick.
+  int64_t blocked_workers_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t finished_workers_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // Results of the current network tick.
+  bool progress_made_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  // The channels on which the procs of each worker are blocked.
+  std::vector<std::vector<Channel*>> blocked_channels_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_THREADED_PROC_RUNTIME_H_
@@ -0,0 +1,54 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/threaded_proc_runtime.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+// Instantiate and run all the tests in proc_runtime_test_base.cc using
+// threaded JIT runtimes with various numbers of worker threads.
+INSTANTIATE_TEST_SUITE_P(
+    ThreadedProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(
+        ProcRuntimeTestParam(
+            "jit_one_thread",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateJitThreadedProcRuntime(package, /*thread_count=*/1)
+                  .value();
+            }),
+        ProcRuntimeTestParam(
+            "jit_two_threads",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateJitThreadedProcRuntime(package, /*thread_count=*/2)
+                  .value();
+            }),
+        ProcRuntimeTestParam(
+            "jit_many_threads",
+            [](Package* package) -> std::unique_ptr<ProcRuntime> {
+              return CreateJitThreadedProcRuntime(package, /*thread_count=*/16)
+                  .value();
+            })),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+}  // namespace
+}  // namespace xls
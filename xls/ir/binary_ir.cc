@@ -0,0 +1,1216 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_ir.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/casts.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/memory_mapped_file.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+
+namespace xls {
+namespace {
+
+constexpr std::string_view kMagic = "XLSIRB";
+
+// Tags of the entries in the type, channel and function base tables. These are
+// part of the format and must not be renumbered.
+enum class TypeTag : uint8_t { kBits = 0, kArray = 1, kTuple = 2, kToken = 3 };
+enum class ChannelTag : uint8_t { kStreaming = 0, kSingleValue = 1 };
+enum class FunctionBaseTag : uint8_t { kFunction = 0, kProc = 1 };
+enum class FormatStepTag : uint8_t { kText = 0, kPreference = 1 };
+
+void PutVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void PutSigned(int64_t value, std::string* out) {
+  PutVarint((static_cast<uint64_t>(value) << 1) ^ (value >> 63), out);
+}
+
+void PutBytes(std::string_view bytes, std::string* out) {
+  PutVarint(bytes.size(), out);
+  out->append(bytes);
+}
+
+// Serializes a package. Strings, types and values are interned into tables as
+// they are encountered while encoding the channels and function bases so the
+// tables are emitted ahead of the sections referring to them at the end.
+class BinaryIrWriter {
+ public:
+  explicit BinaryIrWriter(Package* package) : package_(package) {}
+
+  absl::StatusOr<std::string> Write() {
+    if (!package_->blocks().empty()) {
+      return absl::UnimplementedError(
+          "Binary IR does not support packages containing blocks");
+    }
+    std::vector<FunctionBase*> function_bases = package_->GetFunctionBases();
+    for (int64_t i = 0; i < function_bases.size(); ++i) {
+      function_base_index_[function_bases[i]] = i;
+    }
+
+    std::string channels;
+    PutVarint(package_->channels().size(), &channels);
+    for (Channel* channel : package_->channels()) {
+      XLS_RETURN_IF_ERROR(WriteChannel(channel, &channels));
+    }
+
+    std::string function_base_headers;
+    std::string bodies;
+    PutVarint(function_bases.size(), &function_base_headers);
+    for (FunctionBase* function_base : function_bases) {
+      XLS_RETURN_IF_ERROR(WriteFunctionBase(function_base,
+                                            &function_base_headers, &bodies));
+    }
+
+    std::optional<FunctionBase*> top = package_->GetTop();
+    std::string top_index;
+    PutVarint(top.has_value() ? function_base_index_.at(*top) + 1 : 0,
+              &top_index);
+
+    std::vector<std::pair<Fileno, std::string>> filenames;
+    for (Fileno fileno : filenos_) {
+      std::optional<std::string> filename = package_->GetFilename(fileno);
+      if (filename.has_value()) {
+        filenames.push_back({fileno, *filename});
+      }
+    }
+    std::string filenos;
+    PutVarint(filenames.size(), &filenos);
+    for (const auto& [fileno, filename] : filenames) {
+      PutVarint(fileno.value(), &filenos);
+      PutVarint(StringIndex(filename), &filenos);
+    }
+    // The package name is interned last as the string pool is then complete.
+    int64_t package_name = StringIndex(package_->name());
+
+    std::string result(kMagic);
+    PutVarint(kBinaryIrVersion, &result);
+    PutVarint(strings_.size(), &result);
+    for (const std::string& s : strings_) {
+      PutBytes(s, &result);
+    }
+    PutVarint(package_name, &result);
+    absl::StrAppend(&result, filenos);
+    PutVarint(type_count_, &result);
+    absl::StrAppend(&result, types_);
+    PutVarint(value_count_, &result);
+    absl::StrAppend(&result, values_);
+    absl::StrAppend(&result, channels, function_base_headers, bodies,
+                    top_index);
+    return result;
+  }
+
+ private:
+  int64_t StringIndex(std::string_view s) {
+    auto [it, inserted] = string_index_.try_emplace(s, strings_.size());
+    if (inserted) {
+      strings_.push_back(std::string(s));
+    }
+    return it->second;
+  }
+
+  int64_t TypeIndex(Type* type) {
+    auto it = type_index_.find(type);
+    if (it != type_index_.end()) {
+      return it->second;
+    }
+    // Element types are emitted before the types containing them.
+    std::string entry;
+    switch (type->kind()) {
+      case TypeKind::kBits:
+        entry.push_back(static_cast<char>(TypeTag::kBits));
+        PutVarint(type->AsBitsOrDie()->bit_count(), &entry);
+        break;
+      case TypeKind::kArray: {
+        int64_t element = TypeIndex(type->AsArrayOrDie()->element_type());
+        entry.push_back(static_cast<char>(TypeTag::kArray));
+        PutVarint(type->AsArrayOrDie()->size(), &entry);
+        PutVarint(element, &entry);
+        break;
+      }
+      case TypeKind::kTuple: {
+        std::vector<int64_t> elements;
+        for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+          elements.push_back(TypeIndex(element_type));
+        }
+        entry.push_back(static_cast<char>(TypeTag::kTuple));
+        PutVarint(elements.size(), &entry);
+        for (int64_t element : elements) {
+          PutVarint(element, &entry);
+        }
+        break;
+      }
+      case TypeKind::kToken:
+        entry.push_back(static_cast<char>(TypeTag::kToken));
+        break;
+    }
+    absl::StrAppend(&types_, entry);
+    type_index_[type] = type_count_;
+    return type_count_++;
+  }
+
+  // Appends the encoding of `value` of type `type` to `out`. The type
+  // determines the shape of the value so only leaf bits are stored.
+  absl::Status EncodeValue(const Value& value, Type* type, std::string* out) {
+    switch (type->kind()) {
+      case TypeKind::kBits: {
+        XLS_RET_CHECK(value.IsBits());
+        XLS_RET_CHECK_EQ(value.bits().bit_count(),
+                         type->AsBitsOrDie()->bit_count());
+        std::vector<uint8_t> bytes = value.bits().ToBytes();
+        out->append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return absl::OkStatus();
+      }
+      case TypeKind::kArray:
+        XLS_RET_CHECK(value.IsArray());
+        XLS_RET_CHECK_EQ(value.size(), type->AsArrayOrDie()->size());
+        for (const Value& element : value.elements()) {
+          XLS_RETURN_IF_ERROR(EncodeValue(
+              element, type->AsArrayOrDie()->element_type(), out));
+        }
+        return absl::OkStatus();
+      case TypeKind::kTuple:
+        XLS_RET_CHECK(value.IsTuple());
+        XLS_RET_CHECK_EQ(value.size(), type->AsTupleOrDie()->size());
+        for (int64_t i = 0; i < value.size(); ++i) {
+          XLS_RETURN_IF_ERROR(EncodeValue(
+              value.element(i), type->AsTupleOrDie()->element_type(i), out));
+        }
+        return absl::OkStatus();
+      case TypeKind::kToken:
+        XLS_RET_CHECK(value.IsToken());
+        return absl::OkStatus();
+    }
+    return absl::InternalError("Unknown type kind");
+  }
+
+  absl::StatusOr<int64_t> ValueIndex(const Value& value, Type* type) {
+    std::string entry;
+    PutVarint(TypeIndex(type), &entry);
+    XLS_RETURN_IF_ERROR(EncodeValue(value, type, &entry));
+    auto [it, inserted] = value_index_.try_emplace(entry, value_count_);
+    if (inserted) {
+      absl::StrAppend(&values_, entry);
+      ++value_count_;
+    }
+    return it->second;
+  }
+
+  absl::Status WriteChannel(Channel* channel, std::string* out) {
+    bool streaming = channel->kind() == ChannelKind::kStreaming;
+    out->push_back(static_cast<char>(streaming ? ChannelTag::kStreaming
+                                               : ChannelTag::kSingleValue));
+    PutVarint(StringIndex(channel->name()), out);
+    PutVarint(channel->id(), out);
+    PutVarint(static_cast<uint64_t>(channel->supported_ops()), out);
+    PutVarint(TypeIndex(channel->type()), out);
+    PutBytes(channel->metadata().SerializeAsString(), out);
+    if (streaming) {
+      StreamingChannel* streaming_channel =
+          down_cast<StreamingChannel*>(channel);
+      PutVarint(channel->initial_values().size(), out);
+      for (const Value& value : channel->initial_values()) {
+        XLS_ASSIGN_OR_RETURN(int64_t index,
+                             ValueIndex(value, channel->type()));
+        PutVarint(index, out);
+      }
+      std::optional<int64_t> fifo_depth = streaming_channel->GetFifoDepth();
+      PutVarint(fifo_depth.has_value() ? *fifo_depth + 1 : 0, out);
+      PutVarint(static_cast<uint64_t>(streaming_channel->GetFlowControl()),
+                out);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteFunctionBase(FunctionBase* function_base,
+                                 std::string* header, std::string* body) {
+    // Nodes are written with the parameters first (in parameter order)
+    // followed by the remaining nodes in topological order, which is also the
+    // order in which the text parser creates them.
+    std::vector<Node*> nodes(function_base->params().begin(),
+                             function_base->params().end());
+    for (Node* node : TopoSort(function_base)) {
+      if (!node->Is<Param>()) {
+        nodes.push_back(node);
+      }
+    }
+    absl::flat_hash_map<Node*, int64_t> node_index;
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      node_index[nodes[i]] = i;
+    }
+
+    if (function_base->IsFunction()) {
+      header->push_back(static_cast<char>(FunctionBaseTag::kFunction));
+      PutVarint(StringIndex(function_base->name()), header);
+    } else {
+      XLS_RET_CHECK(function_base->IsProc());
+      Proc* proc = function_base->AsProcOrDie();
+      header->push_back(static_cast<char>(FunctionBaseTag::kProc));
+      PutVarint(StringIndex(proc->name()), header);
+      PutVarint(StringIndex(proc->TokenParam()->GetName()), header);
+      PutVarint(proc->GetStateElementCount(), header);
+      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+        PutVarint(StringIndex(proc->GetStateParam(i)->GetName()), header);
+        XLS_ASSIGN_OR_RETURN(int64_t value,
+                             ValueIndex(proc->GetInitValueElement(i),
+                                        proc->GetStateElementType(i)));
+        PutVarint(value, header);
+      }
+    }
+
+    PutVarint(nodes.size(), body);
+    for (Node* node : nodes) {
+      XLS_RETURN_IF_ERROR(WriteNode(node, node_index, body));
+    }
+
+    if (function_base->IsFunction()) {
+      Node* return_value = function_base->AsFunctionOrDie()->return_value();
+      PutVarint(return_value == nullptr ? 0 : node_index.at(return_value) + 1,
+                body);
+    } else {
+      Proc* proc = function_base->AsProcOrDie();
+      PutVarint(node_index.at(proc->NextToken()), body);
+      for (Node* next_state : proc->NextState()) {
+        PutVarint(node_index.at(next_state), body);
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteNode(Node* node,
+                         const absl::flat_hash_map<Node*, int64_t>& node_index,
+                         std::string* out) {
+    PutVarint(ToOpProto(node->op()), out);
+    PutVarint(node->id(), out);
+    PutVarint(node->HasAssignedName() ? StringIndex(node->GetName()) + 1 : 0,
+              out);
+    PutVarint(TypeIndex(node->GetType()), out);
+    PutVarint(node->loc().locations.size(), out);
+    for (const SourceLocation& location : node->loc().locations) {
+      filenos_.insert(location.fileno());
+      PutVarint(location.fileno().value(), out);
+      PutVarint(location.lineno().value(), out);
+      PutVarint(location.colno().value(), out);
+    }
+    PutVarint(node->operand_count(), out);
+    for (Node* operand : node->operands()) {
+      PutVarint(node_index.at(operand), out);
+    }
+    return WriteNodeData(node, out);
+  }
+
+  // Appends the data of `node` other than its operands and type required to
+  // reconstruct it.
+  absl::Status WriteNodeData(Node* node, std::string* out) {
+    switch (node->op()) {
+      case Op::kArraySlice:
+        PutVarint(node->As<ArraySlice>()->width(), out);
+        break;
+      case Op::kAssert: {
+        Assert* assert = node->As<Assert>();
+        PutVarint(StringIndex(assert->message()), out);
+        std::optional<std::string> label = assert->label();
+        PutVarint(label.has_value() ? StringIndex(*label) + 1 : 0, out);
+        break;
+      }
+      case Op::kCover:
+        PutVarint(StringIndex(node->As<Cover>()->label()), out);
+        break;
+      case Op::kTrace: {
+        absl::Span<const FormatStep> format = node->As<Trace>()->format();
+        PutVarint(format.size(), out);
+        for (const FormatStep& step : format) {
+          if (std::holds_alternative<std::string>(step)) {
+            out->push_back(static_cast<char>(FormatStepTag::kText));
+            PutVarint(StringIndex(std::get<std::string>(step)), out);
+          } else {
+            out->push_back(static_cast<char>(FormatStepTag::kPreference));
+            PutVarint(static_cast<uint64_t>(std::get<FormatPreference>(step)),
+                      out);
+          }
+        }
+        break;
+      }
+      case Op::kReceive:
+        PutVarint(node->As<Receive>()->channel_id(), out);
+        PutVarint(node->As<Receive>()->is_blocking() ? 1 : 0, out);
+        break;
+      case Op::kSend:
+        PutVarint(node->As<Send>()->channel_id(), out);
+        break;
+      case Op::kArray:
+        PutVarint(TypeIndex(node->As<Array>()->element_type()), out);
+        break;
+      case Op::kBitSlice:
+        PutVarint(node->As<BitSlice>()->start(), out);
+        PutVarint(node->As<BitSlice>()->width(), out);
+        break;
+      case Op::kDynamicBitSlice:
+        PutVarint(node->As<DynamicBitSlice>()->width(), out);
+        break;
+      case Op::kCountedFor:
+        PutVarint(node->As<CountedFor>()->trip_count(), out);
+        PutVarint(node->As<CountedFor>()->stride(), out);
+        PutVarint(function_base_index_.at(node->As<CountedFor>()->body()),
+                  out);
+        break;
+      case Op::kDynamicCountedFor:
+        PutVarint(
+            function_base_index_.at(node->As<DynamicCountedFor>()->body()),
+            out);
+        break;
+      case Op::kDecode:
+        PutVarint(node->As<Decode>()->width(), out);
+        break;
+      case Op::kSignExt:
+      case Op::kZeroExt:
+        PutVarint(node->As<ExtendOp>()->new_bit_count(), out);
+        break;
+      case Op::kSMul:
+      case Op::kUMul:
+        PutVarint(node->As<ArithOp>()->width(), out);
+        break;
+      case Op::kSMulp:
+      case Op::kUMulp:
+        PutVarint(node->As<PartialProductOp>()->width(), out);
+        break;
+      case Op::kInvoke:
+        PutVarint(function_base_index_.at(node->As<Invoke>()->to_apply()),
+                  out);
+        break;
+      case Op::kMap:
+        PutVarint(function_base_index_.at(node->As<Map>()->to_apply()), out);
+        break;
+      case Op::kLiteral: {
+        XLS_ASSIGN_OR_RETURN(
+            int64_t value,
+            ValueIndex(node->As<Literal>()->value(), node->GetType()));
+        PutVarint(value, out);
+        break;
+      }
+      case Op::kOneHot:
+        PutVarint(static_cast<uint64_t>(node->As<OneHot>()->priority()), out);
+        break;
+      case Op::kSel:
+        PutVarint(node->As<Select>()->default_value().has_value() ? 1 : 0,
+                  out);
+        break;
+      case Op::kTupleIndex:
+        PutVarint(node->As<TupleIndex>()->index(), out);
+        break;
+      case Op::kParam:
+        PutVarint(StringIndex(node->GetName()), out);
+        break;
+      case Op::kInputPort:
+      case Op::kOutputPort:
+      case Op::kRegisterRead:
+      case Op::kRegisterWrite:
+      case Op::kInstantiationInput:
+      case Op::kInstantiationOutput:
+        return absl::UnimplementedError(
+            absl::StrFormat("Binary IR does not support op %s",
+                            OpToString(node->op())));
+      default:
+        // The node is fully described by its op and operands.
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  Package* package_;
+  absl::flat_hash_map<FunctionBase*, int64_t> function_base_index_;
+
+  std::vector<std::string> strings_;
+  absl::flat_hash_map<std::string, int64_t> string_index_;
+
+  std::string types_;
+  int64_t type_count_ = 0;
+  absl::flat_hash_map<Type*, int64_t> type_index_;
+
+  std::string values_;
+  int64_t value_count_ = 0;
+  absl::flat_hash_map<std::string, int64_t> value_index_;
+
+  absl::btree_set<Fileno> filenos_;
+};
+
+// Deserializes a package. All reads are bounds checked so malformed and
+// truncated input results in an error rather than a crash.
+class BinaryIrReader {
+ public:
+  explicit BinaryIrReader(absl::Span<const uint8_t> data) : data_(data) {}
+
+  absl::StatusOr<std::unique_ptr<Package>> Read() {
+    XLS_RET_CHECK(IsBinaryIr(data_));
+    position_ = kMagic.size();
+    XLS_ASSIGN_OR_RETURN(uint64_t version, GetVarint());
+    if (version != kBinaryIrVersion) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Unsupported binary IR version %d, expected version %d", version,
+          kBinaryIrVersion));
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t string_count, GetCount());
+    strings_.reserve(string_count);
+    for (int64_t i = 0; i < string_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(int64_t size, GetCount());
+      XLS_ASSIGN_OR_RETURN(absl::Span<const uint8_t> bytes, GetBytes(size));
+      strings_.push_back(std::string_view(
+          reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+    }
+    XLS_ASSIGN_OR_RETURN(std::string_view package_name, GetString());
+    auto package = std::make_unique<Package>(package_name);
+    package_ = package.get();
+
+    XLS_ASSIGN_OR_RETURN(int64_t fileno_count, GetCount());
+    for (int64_t i = 0; i < fileno_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(uint64_t fileno, GetVarint());
+      XLS_ASSIGN_OR_RETURN(std::string_view filename, GetString());
+      package_->SetFileno(Fileno(static_cast<int32_t>(fileno)), filename);
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t type_count, GetCount());
+    types_.reserve(type_count);
+    for (int64_t i = 0; i < type_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Type * type, ReadType());
+      types_.push_back(type);
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t value_count, GetCount());
+    values_.reserve(value_count);
+    for (int64_t i = 0; i < value_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Type * type, GetType());
+      XLS_ASSIGN_OR_RETURN(Value value, ReadValue(type));
+      values_.push_back(std::move(value));
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t channel_count, GetCount());
+    for (int64_t i = 0; i < channel_count; ++i) {
+      XLS_RETURN_IF_ERROR(ReadChannel());
+    }
+
+    // Create all function bases before reading the bodies as nodes may refer
+    // to any function (e.g., invoke).
+    XLS_ASSIGN_OR_RETURN(int64_t function_base_count, GetCount());
+    for (int64_t i = 0; i < function_base_count; ++i) {
+      XLS_RETURN_IF_ERROR(ReadFunctionBaseHeader());
+    }
+    for (FunctionBase* function_base : function_bases_) {
+      XLS_RETURN_IF_ERROR(ReadBody(function_base));
+    }
+
+    XLS_ASSIGN_OR_RETURN(int64_t top, GetCount());
+    if (top != 0) {
+      XLS_ASSIGN_OR_RETURN(FunctionBase * top_function_base,
+                           GetFunctionBase(top - 1));
+      XLS_RETURN_IF_ERROR(package_->SetTop(top_function_base));
+    }
+    if (position_ != data_.size()) {
+      return absl::InvalidArgumentError(
+          "Unexpected trailing bytes in binary IR");
+    }
+    XLS_RETURN_IF_ERROR(VerifyPackage(package_));
+    return package;
+  }
+
+ private:
+  absl::Status Truncated() const {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Binary IR is truncated at offset %d", position_));
+  }
+
+  absl::StatusOr<uint64_t> GetVarint() {
+    uint64_t result = 0;
+    for (int64_t shift = 0; shift < 64; shift += 7) {
+      if (position_ >= data_.size()) {
+        return Truncated();
+      }
+      uint8_t byte = data_[position_++];
+      result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return result;
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Malformed varint in binary IR at offset %d",
+                        position_));
+  }
+
+  absl::StatusOr<int64_t> GetSigned() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, GetVarint());
+    return static_cast<int64_t>((value >> 1) ^ -(value & 1));
+  }
+
+  // Returns a varint which is used as a count or index and so must be (much)
+  // smaller than the input.
+  absl::StatusOr<int64_t> GetCount() {
+    XLS_ASSIGN_OR_RETURN(uint64_t value, GetVarint());
+    if (value > data_.size() * 8 + 64) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Implausible count %d in binary IR at offset %d", value, position_));
+    }
+    return static_cast<int64_t>(value);
+  }
+
+  absl::StatusOr<uint8_t> GetByte() {
+    if (position_ >= data_.size()) {
+      return Truncated();
+    }
+    return data_[position_++];
+  }
+
+  absl::StatusOr<absl::Span<const uint8_t>> GetBytes(int64_t size) {
+    if (size > data_.size() - position_) {
+      return Truncated();
+    }
+    absl::Span<const uint8_t> result = data_.subspan(position_, size);
+    position_ += size;
+    return result;
+  }
+
+  template <typename Table>
+  absl::StatusOr<typename Table::value_type> GetIndexed(
+      const Table& table, std::string_view table_name, int64_t index) {
+    if (index < 0 || index >= table.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid %s index %d in binary IR at offset %d",
+                          table_name, index, position_));
+    }
+    return table[index];
+  }
+
+  absl::StatusOr<std::string_view> GetString() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, GetCount());
+    return GetIndexed(strings_, "string", index);
+  }
+  absl::StatusOr<Type*> GetType() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, GetCount());
+    return GetIndexed(types_, "type", index);
+  }
+  absl::StatusOr<Value> GetValue() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, GetCount());
+    return GetIndexed(values_, "value", index);
+  }
+  absl::StatusOr<FunctionBase*> GetFunctionBase(int64_t index) {
+    return GetIndexed(function_bases_, "function", index);
+  }
+  absl::StatusOr<Function*> GetFunction() {
+    XLS_ASSIGN_OR_RETURN(int64_t index, GetCount());
+    XLS_ASSIGN_OR_RETURN(FunctionBase * function_base,
+                         GetFunctionBase(index));
+    if (!function_base->IsFunction()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Expected %s to be a function", function_base->name()));
+    }
+    return function_base->AsFunctionOrDie();
+  }
+
+  absl::StatusOr<Type*> ReadType() {
+    XLS_ASSIGN_OR_RETURN(uint8_t tag, GetByte());
+    switch (static_cast<TypeTag>(tag)) {
+      case TypeTag::kBits: {
+        XLS_ASSIGN_OR_RETURN(int64_t bit_count, GetCount());
+        return package_->GetBitsType(bit_count);
+      }
+      case TypeTag::kArray: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, GetCount());
+        XLS_ASSIGN_OR_RETURN(Type * element_type, GetType());
+        return package_->GetArrayType(size, element_type);
+      }
+      case TypeTag::kTuple: {
+        XLS_ASSIGN_OR_RETURN(int64_t size, GetCount());
+        std::vector<Type*> element_types;
+        element_types.reserve(size);
+        for (int64_t i = 0; i < size; ++i) {
+          XLS_ASSIGN_OR_RETURN(Type * element_type, GetType());
+          element_types.push_back(element_type);
+        }
+        return package_->GetTupleType(element_types);
+      }
+      case TypeTag::kToken:
+        return package_->GetTokenType();
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid type tag %d in binary IR", tag));
+  }
+
+  absl::StatusOr<Value> ReadValue(Type* type) {
+    switch (type->kind()) {
+      case TypeKind::kBits: {
+        int64_t bit_count = type->AsBitsOrDie()->bit_count();
+        XLS_ASSIGN_OR_RETURN(absl::Span<const uint8_t> bytes,
+                             GetBytes((bit_count + 7) / 8));
+        return Value(Bits::FromBytes(bytes, bit_count));
+      }
+      case TypeKind::kArray: {
+        std::vector<Value> elements;
+        elements.reserve(type->AsArrayOrDie()->size());
+        for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
+          XLS_ASSIGN_OR_RETURN(
+              Value element, ReadValue(type->AsArrayOrDie()->element_type()));
+          elements.push_back(std::move(element));
+        }
+        return Value::Array(elements);
+      }
+      case TypeKind::kTuple: {
+        std::vector<Value> elements;
+        elements.reserve(type->AsTupleOrDie()->size());
+        for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+          XLS_ASSIGN_OR_RETURN(Value element, ReadValue(element_type));
+          elements.push_back(std::move(element));
+        }
+        return Value::TupleOwned(std::move(elements));
+      }
+      case TypeKind::kToken:
+        return Value::Token();
+    }
+    return absl::InternalError("Unknown type kind");
+  }
+
+  absl::Status ReadChannel() {
+    XLS_ASSIGN_OR_RETURN(uint8_t tag, GetByte());
+    XLS_ASSIGN_OR_RETURN(std::string_view name, GetString());
+    XLS_ASSIGN_OR_RETURN(int64_t id, GetCount());
+    XLS_ASSIGN_OR_RETURN(uint64_t supported_ops, GetVarint());
+    XLS_RET_CHECK_LE(supported_ops,
+                     static_cast<uint64_t>(ChannelOps::kSendReceive));
+    XLS_ASSIGN_OR_RETURN(Type * type, GetType());
+    XLS_ASSIGN_OR_RETURN(int64_t metadata_size, GetCount());
+    XLS_ASSIGN_OR_RETURN(absl::Span<const uint8_t> metadata_bytes,
+                         GetBytes(metadata_size));
+    ChannelMetadataProto metadata;
+    if (!metadata.ParseFromArray(metadata_bytes.data(),
+                                 metadata_bytes.size())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid metadata of channel %s in binary IR", name));
+    }
+    switch (static_cast<ChannelTag>(tag)) {
+      case ChannelTag::kStreaming: {
+        XLS_ASSIGN_OR_RETURN(int64_t initial_value_count, GetCount());
+        std::vector<Value> initial_values;
+        for (int64_t i = 0; i < initial_value_count; ++i) {
+          XLS_ASSIGN_OR_RETURN(Value value, GetValue());
+          initial_values.push_back(std::move(value));
+        }
+        XLS_ASSIGN_OR_RETURN(int64_t fifo_depth, GetCount());
+        XLS_ASSIGN_OR_RETURN(uint64_t flow_control, GetVarint());
+        XLS_RET_CHECK_LE(flow_control,
+                         static_cast<uint64_t>(FlowControl::kReadyValid));
+        return package_
+            ->CreateStreamingChannel(
+                name, static_cast<ChannelOps>(supported_ops), type,
+                initial_values,
+                fifo_depth == 0 ? std::nullopt
+                                : std::make_optional(fifo_depth - 1),
+                static_cast<FlowControl>(flow_control), metadata, id)
+            .status();
+      }
+      case ChannelTag::kSingleValue:
+        return package_
+            ->CreateSingleValueChannel(name,
+                                       static_cast<ChannelOps>(supported_ops),
+                                       type, metadata, id)
+            .status();
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid channel tag %d in binary IR", tag));
+  }
+
+  absl::Status ReadFunctionBaseHeader() {
+    XLS_ASSIGN_OR_RETURN(uint8_t tag, GetByte());
+    XLS_ASSIGN_OR_RETURN(std::string_view name, GetString());
+    switch (static_cast<FunctionBaseTag>(tag)) {
+      case FunctionBaseTag::kFunction:
+        function_bases_.push_back(
+            package_->AddFunction(std::make_unique<Function>(name, package_)));
+        return absl::OkStatus();
+      case FunctionBaseTag::kProc: {
+        XLS_ASSIGN_OR_RETURN(std::string_view token_param_name, GetString());
+        Proc* proc = package_->AddProc(
+            std::make_unique<Proc>(name, token_param_name, package_));
+        XLS_ASSIGN_OR_RETURN(int64_t state_count, GetCount());
+        for (int64_t i = 0; i < state_count; ++i) {
+          XLS_ASSIGN_OR_RETURN(std::string_view state_name, GetString());
+          XLS_ASSIGN_OR_RETURN(Value init_value, GetValue());
+          XLS_RETURN_IF_ERROR(
+              proc->AppendStateElement(state_name, init_value).status());
+        }
+        function_bases_.push_back(proc);
+        return absl::OkStatus();
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid function base tag %d in binary IR", tag));
+  }
+
+  absl::Status ReadBody(FunctionBase* function_base) {
+    XLS_ASSIGN_OR_RETURN(int64_t node_count, GetCount());
+    std::vector<Node*> nodes;
+    nodes.reserve(node_count);
+    auto get_node = [&]() -> absl::StatusOr<Node*> {
+      XLS_ASSIGN_OR_RETURN(int64_t index, GetCount());
+      return GetIndexed(nodes, "node", index);
+    };
+    for (int64_t i = 0; i < node_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(Node * node, ReadNode(function_base, nodes));
+      nodes.push_back(node);
+    }
+    if (function_base->IsFunction()) {
+      XLS_ASSIGN_OR_RETURN(int64_t return_value, GetCount());
+      if (return_value != 0) {
+        XLS_ASSIGN_OR_RETURN(Node * node,
+                             GetIndexed(nodes, "node", return_value - 1));
+        XLS_RETURN_IF_ERROR(
+            function_base->AsFunctionOrDie()->set_return_value(node));
+      }
+    } else {
+      Proc* proc = function_base->AsProcOrDie();
+      XLS_ASSIGN_OR_RETURN(Node * next_token, get_node());
+      XLS_RETURN_IF_ERROR(proc->SetNextToken(next_token));
+      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+        XLS_ASSIGN_OR_RETURN(Node * next_state, get_node());
+        XLS_RETURN_IF_ERROR(proc->SetNextStateElement(i, next_state));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<Node*> ReadNode(FunctionBase* function_base,
+                                 absl::Span<Node* const> nodes) {
+    XLS_ASSIGN_OR_RETURN(uint64_t op_proto, GetVarint());
+    if (!OpProto_IsValid(op_proto) || op_proto == OP_INVALID) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid op %d in binary IR", op_proto));
+    }
+    Op op = FromOpProto(static_cast<OpProto>(op_proto));
+    XLS_ASSIGN_OR_RETURN(int64_t id, GetCount());
+    XLS_ASSIGN_OR_RETURN(int64_t name_index, GetCount());
+    std::string_view name;
+    if (name_index != 0) {
+      XLS_ASSIGN_OR_RETURN(name,
+                           GetIndexed(strings_, "string", name_index - 1));
+    }
+    XLS_ASSIGN_OR_RETURN(Type * type, GetType());
+    XLS_ASSIGN_OR_RETURN(int64_t location_count, GetCount());
+    std::vector<SourceLocation> locations;
+    locations.reserve(location_count);
+    for (int64_t i = 0; i < location_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(uint64_t fileno, GetVarint());
+      XLS_ASSIGN_OR_RETURN(uint64_t lineno, GetVarint());
+      XLS_ASSIGN_OR_RETURN(uint64_t colno, GetVarint());
+      locations.push_back(
+          SourceLocation(Fileno(static_cast<int32_t>(fileno)),
+                         Lineno(static_cast<int32_t>(lineno)),
+                         Colno(static_cast<int32_t>(colno))));
+    }
+    SourceInfo loc(locations);
+    XLS_ASSIGN_OR_RETURN(int64_t operand_count, GetCount());
+    std::vector<Node*> operands;
+    operands.reserve(operand_count);
+    for (int64_t i = 0; i < operand_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(int64_t index, GetCount());
+      XLS_ASSIGN_OR_RETURN(Node * operand, GetIndexed(nodes, "node", index));
+      operands.push_back(operand);
+    }
+
+    XLS_ASSIGN_OR_RETURN(
+        Node * node,
+        MakeNode(op, loc, name, type, operands, function_base, nodes.size()));
+    if (node->GetType() != type) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Node %s has type %s in binary IR but type %s when constructed",
+          node->GetName(), type->ToString(), node->GetType()->ToString()));
+    }
+    node->SetId(id);
+    return node;
+  }
+
+  // Checks that `operands` has a size in [min_count, max_count].
+  static absl::Status CheckOperandCount(Op op,
+                                        absl::Span<Node* const> operands,
+                                        int64_t min_count,
+                                        int64_t max_count) {
+    if (operands.size() < min_count || operands.size() > max_count) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid operand count %d for op %s in binary IR",
+                          operands.size(), OpToString(op)));
+    }
+    return absl::OkStatus();
+  }
+
+  template <typename NodeT, typename... Args>
+  static NodeT* AddNode(FunctionBase* function_base, Args&&... args) {
+    return function_base->AddNode(
+        std::make_unique<NodeT>(std::forward<Args>(args)..., function_base));
+  }
+
+  // Constructs the node with the given attributes and reads its op-specific
+  // data. `index` is the index of the node in the body.
+  absl::StatusOr<Node*> MakeNode(Op op, const SourceInfo& loc,
+                                 std::string_view name, Type* type,
+                                 absl::Span<Node* const> operands,
+                                 FunctionBase* fb, int64_t index) {
+    constexpr int64_t kAny = std::numeric_limits<int64_t>::max();
+    auto optional_operand = [&](int64_t i) -> std::optional<Node*> {
+      return i < operands.size() ? std::make_optional(operands[i])
+                                 : std::nullopt;
+    };
+    switch (op) {
+      case Op::kParam: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 0, 0));
+        XLS_ASSIGN_OR_RETURN(std::string_view param_name, GetString());
+        if (fb->IsProc()) {
+          // Proc parameters are created with the proc.
+          if (index >= fb->params().size() ||
+              fb->param(index)->GetName() != param_name) {
+            return absl::InvalidArgumentError(absl::StrFormat(
+                "Unexpected parameter %s of proc %s in binary IR", param_name,
+                fb->name()));
+          }
+          Param* param = fb->param(index);
+          param->SetLoc(loc);
+          return param;
+        }
+        return AddNode<Param>(fb, loc, param_name, type);
+      }
+      case Op::kAdd:
+      case Op::kSDiv:
+      case Op::kSMod:
+      case Op::kShll:
+      case Op::kShrl:
+      case Op::kShra:
+      case Op::kSub:
+      case Op::kUDiv:
+      case Op::kUMod:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        return AddNode<BinOp>(fb, loc, operands[0], operands[1], op, name);
+      case Op::kEq:
+      case Op::kNe:
+      case Op::kSGe:
+      case Op::kSGt:
+      case Op::kSLe:
+      case Op::kSLt:
+      case Op::kUGe:
+      case Op::kUGt:
+      case Op::kULe:
+      case Op::kULt:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        return AddNode<CompareOp>(fb, loc, operands[0], operands[1], op, name);
+      case Op::kAnd:
+      case Op::kNand:
+      case Op::kNor:
+      case Op::kOr:
+      case Op::kXor:
+        return AddNode<NaryOp>(fb, loc, operands, op, name);
+      case Op::kAndReduce:
+      case Op::kOrReduce:
+      case Op::kXorReduce:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        return AddNode<BitwiseReductionOp>(fb, loc, operands[0], op, name);
+      case Op::kIdentity:
+      case Op::kNeg:
+      case Op::kNot:
+      case Op::kReverse:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        return AddNode<UnOp>(fb, loc, operands[0], op, name);
+      case Op::kAssert: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        XLS_ASSIGN_OR_RETURN(std::string_view message, GetString());
+        XLS_ASSIGN_OR_RETURN(int64_t label_index, GetCount());
+        std::optional<std::string> label;
+        if (label_index != 0) {
+          XLS_ASSIGN_OR_RETURN(std::string_view label_view,
+                               GetIndexed(strings_, "string", label_index - 1));
+          label = std::string(label_view);
+        }
+        return AddNode<Assert>(fb, loc, operands[0], operands[1], message,
+                               label, name);
+      }
+      case Op::kCover: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        XLS_ASSIGN_OR_RETURN(std::string_view label, GetString());
+        return AddNode<Cover>(fb, loc, operands[0], operands[1], label, name);
+      }
+      case Op::kTrace: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, kAny));
+        XLS_ASSIGN_OR_RETURN(int64_t step_count, GetCount());
+        std::vector<FormatStep> format;
+        for (int64_t i = 0; i < step_count; ++i) {
+          XLS_ASSIGN_OR_RETURN(uint8_t tag, GetByte());
+          if (static_cast<FormatStepTag>(tag) == FormatStepTag::kText) {
+            XLS_ASSIGN_OR_RETURN(std::string_view text, GetString());
+            format.push_back(std::string(text));
+          } else {
+            XLS_ASSIGN_OR_RETURN(uint64_t preference, GetVarint());
+            XLS_RET_CHECK_LE(preference, static_cast<uint64_t>(
+                                             FormatPreference::kPlainHex));
+            format.push_back(static_cast<FormatPreference>(preference));
+          }
+        }
+        return AddNode<Trace>(fb, loc, operands[0], operands[1],
+                              operands.subspan(2), format, name);
+      }
+      case Op::kReceive: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 2));
+        XLS_ASSIGN_OR_RETURN(int64_t channel_id, GetCount());
+        XLS_ASSIGN_OR_RETURN(uint64_t is_blocking, GetVarint());
+        return AddNode<Receive>(fb, loc, operands[0], optional_operand(1),
+                                channel_id, is_blocking != 0, name);
+      }
+      case Op::kSend: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 3));
+        XLS_ASSIGN_OR_RETURN(int64_t channel_id, GetCount());
+        return AddNode<Send>(fb, loc, operands[0], operands[1],
+                             optional_operand(2), channel_id, name);
+      }
+      case Op::kAfterAll:
+        return AddNode<AfterAll>(fb, loc, operands, name);
+      case Op::kArray: {
+        XLS_ASSIGN_OR_RETURN(Type * element_type, GetType());
+        return AddNode<Array>(fb, loc, operands, element_type, name);
+      }
+      case Op::kArrayIndex:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, kAny));
+        return AddNode<ArrayIndex>(fb, loc, operands[0], operands.subspan(1),
+                                   name);
+      case Op::kArraySlice: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        XLS_ASSIGN_OR_RETURN(int64_t width, GetCount());
+        return AddNode<ArraySlice>(fb, loc, operands[0], operands[1], width,
+                                   name);
+      }
+      case Op::kArrayUpdate:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, kAny));
+        return AddNode<ArrayUpdate>(fb, loc, operands[0], operands[1],
+                                    operands.subspan(2), name);
+      case Op::kArrayConcat:
+        return AddNode<ArrayConcat>(fb, loc, operands, name);
+      case Op::kBitSlice: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        XLS_ASSIGN_OR_RETURN(int64_t start, GetCount());
+        XLS_ASSIGN_OR_RETURN(int64_t width, GetCount());
+        return AddNode<BitSlice>(fb, loc, operands[0], start, width, name);
+      }
+      case Op::kDynamicBitSlice: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        XLS_ASSIGN_OR_RETURN(int64_t width, GetCount());
+        return AddNode<DynamicBitSlice>(fb, loc, operands[0], operands[1],
+                                        width, name);
+      }
+      case Op::kBitSliceUpdate:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 3, 3));
+        return AddNode<BitSliceUpdate>(fb, loc, operands[0], operands[1],
+                                       operands[2], name);
+      case Op::kConcat:
+        return AddNode<Concat>(fb, loc, operands, name);
+      case Op::kCountedFor: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, kAny));
+        XLS_ASSIGN_OR_RETURN(int64_t trip_count, GetCount());
+        XLS_ASSIGN_OR_RETURN(int64_t stride, GetCount());
+        XLS_ASSIGN_OR_RETURN(Function * body, GetFunction());
+        return AddNode<CountedFor>(fb, loc, operands[0], operands.subspan(1),
+                                   trip_count, stride, body, name);
+      }
+      case Op::kDynamicCountedFor: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 3, kAny));
+        XLS_ASSIGN_OR_RETURN(Function * body, GetFunction());
+        return AddNode<DynamicCountedFor>(fb, loc, operands[0], operands[1],
+                                          operands[2], operands.subspan(3),
+                                          body, name);
+      }
+      case Op::kDecode: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        XLS_ASSIGN_OR_RETURN(int64_t width, GetCount());
+        return AddNode<Decode>(fb, loc, operands[0], width, name);
+      }
+      case Op::kEncode:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        return AddNode<Encode>(fb, loc, operands[0], name);
+      case Op::kSignExt:
+      case Op::kZeroExt: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        XLS_ASSIGN_OR_RETURN(int64_t new_bit_count, GetCount());
+        return AddNode<ExtendOp>(fb, loc, operands[0], new_bit_count, op,
+                                 name);
+      }
+      case Op::kSMul:
+      case Op::kUMul: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        XLS_ASSIGN_OR_RETURN(int64_t width, GetCount());
+        return AddNode<ArithOp>(fb, loc, operands[0], operands[1], width, op,
+                                name);
+      }
+      case Op::kSMulp:
+      case Op::kUMulp: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        XLS_ASSIGN_OR_RETURN(int64_t width, GetCount());
+        return AddNode<PartialProductOp>(fb, loc, operands[0], operands[1],
+                                         width, op, name);
+      }
+      case Op::kInvoke: {
+        XLS_ASSIGN_OR_RETURN(Function * to_apply, GetFunction());
+        return AddNode<Invoke>(fb, loc, operands, to_apply, name);
+      }
+      case Op::kMap: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        XLS_ASSIGN_OR_RETURN(Function * to_apply, GetFunction());
+        return AddNode<Map>(fb, loc, operands[0], to_apply, name);
+      }
+      case Op::kLiteral: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 0, 0));
+        XLS_ASSIGN_OR_RETURN(Value value, GetValue());
+        return AddNode<Literal>(fb, loc, std::move(value), name);
+      }
+      case Op::kOneHot: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        XLS_ASSIGN_OR_RETURN(uint64_t priority, GetVarint());
+        XLS_RET_CHECK_LE(priority, static_cast<uint64_t>(LsbOrMsb::kMsb));
+        return AddNode<OneHot>(fb, loc, operands[0],
+                               static_cast<LsbOrMsb>(priority), name);
+      }
+      case Op::kOneHotSel:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, kAny));
+        return AddNode<OneHotSelect>(fb, loc, operands[0],
+                                     operands.subspan(1), name);
+      case Op::kPrioritySel:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, kAny));
+        return AddNode<PrioritySelect>(fb, loc, operands[0],
+                                       operands.subspan(1), name);
+      case Op::kSel: {
+        XLS_ASSIGN_OR_RETURN(uint64_t has_default, GetVarint());
+        XLS_RETURN_IF_ERROR(
+            CheckOperandCount(op, operands, has_default != 0 ? 2 : 1, kAny));
+        if (has_default != 0) {
+          return AddNode<Select>(fb, loc, operands[0],
+                                 operands.subspan(1, operands.size() - 2),
+                                 operands.back(), name);
+        }
+        return AddNode<Select>(fb, loc, operands[0], operands.subspan(1),
+                               std::nullopt, name);
+      }
+      case Op::kTuple:
+        return AddNode<Tuple>(fb, loc, operands, name);
+      case Op::kTupleIndex: {
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 1, 1));
+        XLS_ASSIGN_OR_RETURN(int64_t tuple_index, GetCount());
+        return AddNode<TupleIndex>(fb, loc, operands[0], tuple_index, name);
+      }
+      case Op::kGate:
+        XLS_RETURN_IF_ERROR(CheckOperandCount(op, operands, 2, 2));
+        return AddNode<Gate>(fb, loc, operands[0], operands[1], name);
+      case Op::kInputPort:
+      case Op::kOutputPort:
+      case Op::kRegisterRead:
+      case Op::kRegisterWrite:
+      case Op::kInstantiationInput:
+      case Op::kInstantiationOutput:
+        break;
+    }
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Op %s is not supported in binary IR", OpToString(op)));
+  }
+
+  absl::Span<const uint8_t> data_;
+  int64_t position_ = 0;
+  Package* package_ = nullptr;
+
+  std::vector<std::string_view> strings_;
+  std::vector<Type*> types_;
+  std::vector<Value> values_;
+  std::vector<FunctionBase*> function_bases_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::string> DumpBinaryIr(Package* package) {
+  return BinaryIrWriter(package).Write();
+}
+
+bool IsBinaryIr(absl::Span<const uint8_t> data) {
+  return data.size() >= kMagic.size() &&
+         std::memcmp(data.data(), kMagic.data(), kMagic.size()) == 0;
+}
+
+bool IsBinaryIr(std::string_view data) {
+  return IsBinaryIr(absl::MakeConstSpan(
+      reinterpret_cast<const uint8_t*>(data.data()), data.size()));
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryIr(
+    absl::Span<const uint8_t> data) {
+  if (!IsBinaryIr(data)) {
+    return absl::InvalidArgumentError("Data is not binary IR");
+  }
+  return BinaryIrReader(data).Read();
+}
+
+absl::Status WriteBinaryIrFile(Package* package,
+                               const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string data, DumpBinaryIr(package));
+  return SetFileContents(path, data);
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageFile(
+    const std::filesystem::path& path) {
+  absl::StatusOr<std::unique_ptr<MemoryMappedFile>> mapped =
+      MemoryMappedFile::Open(path);
+  if (mapped.ok()) {
+    if (IsBinaryIr((*mapped)->data())) {
+      return ParseBinaryIr((*mapped)->data());
+    }
+    return Parser::ParsePackageParallel((*mapped)->contents(), path.string());
+  }
+  if (!absl::IsFailedPrecondition(mapped.status())) {
+    return mapped.status();
+  }
+  // Not a regular file so read it into memory.
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  if (IsBinaryIr(contents)) {
+    return ParseBinaryIr(absl::MakeConstSpan(
+        reinterpret_cast<const uint8_t*>(contents.data()), contents.size()));
+  }
+  return Parser::ParsePackageParallel(contents, path.string());
+}
+
+}  // namespace xls
@@ -0,0 +1,82 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_BINARY_IR_H_
+#define XLS_IR_BINARY_IR_H_
+
+// A compact binary serialization of XLS IR packages (conventionally stored in
+// files with the extension ".irb") which is much faster to load than the text
+// IR as no lexing or name resolution is required.
+//
+// The format is versioned. A file consists of a header holding the magic
+// string "XLSIRB" and the format version, followed by these tables in order:
+//
+//   string pool:     every string in the package (names, messages, filenames)
+//   file numbers:    fileno to filename mapping used by source locations
+//   type table:      every type, with element types preceding aggregates
+//   value table:     interned literal, initial state and channel values
+//   channel table
+//   function bases:  the kind and name of each function and proc
+//   bodies:          the nodes of each function base in topological order
+//
+// Integers are LEB128 varints (zigzag-encoded if signed) and references to
+// strings, types, values, function bases and nodes are indices into the
+// respective table. Strings are referenced in place when loading so a file
+// may be memory mapped and loaded without intermediate copies.
+//
+// Blocks are not supported.
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// The version of the binary IR format written by DumpBinaryIr. Files written
+// with a different version are rejected when loading.
+inline constexpr int64_t kBinaryIrVersion = 1;
+
+// Returns the binary serialization of the given package.
+absl::StatusOr<std::string> DumpBinaryIr(Package* package);
+
+// Returns true if `data` begins with the binary IR magic string.
+bool IsBinaryIr(absl::Span<const uint8_t> data);
+bool IsBinaryIr(std::string_view data);
+
+// Constructs a package from its binary serialization. As with
+// Parser::ParsePackage, the package is verified after construction.
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryIr(
+    absl::Span<const uint8_t> data);
+
+// Writes the binary serialization of `package` to the file at `path`.
+absl::Status WriteBinaryIrFile(Package* package,
+                               const std::filesystem::path& path);
+
+// Loads the package in the file at `path` which may hold either text or binary
+// IR (detected by the magic string rather than the file extension). Regular
+// files are memory mapped; other files (e.g., /dev/stdin) are read into
+// memory. Text IR is parsed with Parser::ParsePackageParallel.
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageFile(
+    const std::filesystem::path& path);
+
+}  // namespace xls
+
+#endif  // XLS_IR_BINARY_IR_H_
@@ -0,0 +1,190 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_ir.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+absl::Span<const uint8_t> AsBytes(std::string_view s) {
+  return absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(s.data()),
+                             s.size());
+}
+
+class BinaryIrTest : public IrTestBase {
+ protected:
+  // Parses the text IR, round trips it through the binary format and checks
+  // that the result dumps to the same text.
+  void RoundTrip(std::string_view text) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             Parser::ParsePackage(text));
+    XLS_ASSERT_OK_AND_ASSIGN(std::string binary, DumpBinaryIr(package.get()));
+    EXPECT_TRUE(IsBinaryIr(binary));
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> result,
+                             ParseBinaryIr(AsBytes(binary)));
+    EXPECT_EQ(result->DumpIr(), package->DumpIr());
+  }
+};
+
+TEST_F(BinaryIrTest, Function) {
+  RoundTrip(R"(package test
+
+fn f(x: bits[32], y: bits[32], p: bits[2]) -> (bits[32], bits[1], bits[64]) {
+  literal.1: bits[32] = literal(value=42, id=1, pos=[(0,3,11)])
+  add.2: bits[32] = add(x, literal.1, id=2, pos=[(0,4,2), (1,7,3)])
+  my_mul: bits[32] = umul(add.2, y, id=3)
+  sel.4: bits[32] = sel(p, cases=[x, y, my_mul], default=literal.1, id=4)
+  ult.5: bits[1] = ult(sel.4, x, id=5)
+  bit_slice.6: bits[8] = bit_slice(sel.4, start=3, width=8, id=6)
+  sign_ext.7: bits[64] = sign_ext(bit_slice.6, new_bit_count=64, id=7)
+  ret tuple.8: (bits[32], bits[1], bits[64]) = tuple(sel.4, ult.5, sign_ext.7, id=8)
+}
+)");
+}
+
+TEST_F(BinaryIrTest, AggregateLiterals) {
+  RoundTrip(R"(package test
+
+fn f(i: bits[2]) -> (bits[200], (bits[3], bits[5][2])) {
+  literal.1: bits[200] = literal(value=0xabcdef0123456789abcdef0123456789abcdef, id=1)
+  literal.2: (bits[3], bits[5][2]) = literal(value=(1, [2, 3]), id=2)
+  one_hot.3: bits[3] = one_hot(i, lsb_prio=false, id=3)
+  ret tuple.4: (bits[200], (bits[3], bits[5][2])) = tuple(literal.1, literal.2, id=4)
+}
+)");
+}
+
+TEST_F(BinaryIrTest, FunctionCalls) {
+  RoundTrip(R"(package test
+
+fn body(i: bits[16], acc: bits[16]) -> bits[16] {
+  ret add.3: bits[16] = add(i, acc, id=3)
+}
+
+fn not_fn(x: bits[16]) -> bits[16] {
+  ret not.5: bits[16] = not(x, id=5)
+}
+
+top fn f(x: bits[16], a: bits[16][4]) -> (bits[16], bits[16][4]) {
+  counted_for.8: bits[16] = counted_for(x, trip_count=4, stride=2, body=body, id=8)
+  invoke.9: bits[16] = invoke(counted_for.8, to_apply=not_fn, id=9)
+  map.10: bits[16][4] = map(a, to_apply=not_fn, id=10)
+  ret tuple.11: (bits[16], bits[16][4]) = tuple(invoke.9, map.10, id=11)
+}
+)");
+}
+
+TEST_F(BinaryIrTest, SideEffectingOps) {
+  RoundTrip(R"(package test
+
+fn f(tkn: token, cond: bits[1], x: bits[32]) -> token {
+  assert.1: token = assert(tkn, cond, message="x is bad", label="my_label", id=1)
+  trace.2: token = trace(assert.1, cond, format="x is {} or {:x}", data_operands=[x, x], id=2)
+  ret cover.3: token = cover(trace.2, cond, label="covered", id=3)
+}
+)");
+}
+
+TEST_F(BinaryIrTest, Proc) {
+  RoundTrip(R"(package test
+
+chan ch(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=none, metadata="""""")
+chan sv(bits[8], id=1, kind=single_value, ops=receive_only, metadata="""""")
+
+top proc my_proc(my_token: token, my_state: bits[32], other: (), init={42, ()}) {
+  send.1: token = send(my_token, my_state, channel_id=0, id=1)
+  literal.2: bits[1] = literal(value=1, id=2)
+  receive.3: (token, bits[32]) = receive(send.1, predicate=literal.2, channel_id=0, id=3)
+  tuple_index.4: token = tuple_index(receive.3, index=0, id=4)
+  tuple_index.5: bits[32] = tuple_index(receive.3, index=1, id=5)
+  receive.6: (token, bits[8]) = receive(tuple_index.4, channel_id=1, id=6)
+  tuple_index.7: token = tuple_index(receive.6, index=0, id=7)
+  next (tuple_index.7, tuple_index.5, other)
+}
+)");
+}
+
+TEST_F(BinaryIrTest, NotBinaryIr) {
+  EXPECT_FALSE(IsBinaryIr(std::string_view("package foo")));
+  EXPECT_THAT(ParseBinaryIr(AsBytes("package foo")),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not binary IR")));
+}
+
+TEST_F(BinaryIrTest, TruncatedInputIsAnError) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(package test
+
+fn f(x: bits[32]) -> bits[32] {
+  ret neg.1: bits[32] = neg(x, id=1)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary, DumpBinaryIr(package.get()));
+  for (int64_t size = 6; size < binary.size(); ++size) {
+    std::string_view truncated = std::string_view(binary).substr(0, size);
+    EXPECT_THAT(ParseBinaryIr(AsBytes(truncated)),
+                StatusIs(absl::StatusCode::kInvalidArgument))
+        << "size: " << size;
+  }
+}
+
+TEST_F(BinaryIrTest, BlocksAreUnsupported) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(package test
+
+block my_block(a: bits[32], out: bits[32]) {
+  a: bits[32] = input_port(name=a, id=1)
+  out: () = output_port(a, name=out, id=2)
+}
+)"));
+  EXPECT_THAT(DumpBinaryIr(package.get()),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+TEST_F(BinaryIrTest, ParsePackageFile) {
+  const std::string text = R"(package test
+
+fn f(x: bits[32]) -> bits[32] {
+  ret neg.1: bits[32] = neg(x, id=1)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(text));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile text_file,
+                           TempFile::CreateWithContent(text, ".ir"));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile binary_file, TempFile::Create(".irb"));
+  XLS_ASSERT_OK(WriteBinaryIrFile(package.get(), binary_file.path()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_text,
+                           ParsePackageFile(text_file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_binary,
+                           ParsePackageFile(binary_file.path()));
+  EXPECT_EQ(from_text->DumpIr(), package->DumpIr());
+  EXPECT_EQ(from_binary->DumpIr(), package->DumpIr());
+}
+
+}  // namespace
+}  // namespace xls
@@ -238,11 +238,8 @@ Bits Bits::Slice(int64_t start, int64_t width) const {
   XLS_CHECK_LE(start + width, bit_count())
       << "start: " << start << " width: " << width;
   Bits result(width);
-  for (int64_t i = 0; i < width; ++i) {
-    if (Get(start + i)) {
-      result.bitmap_.Set(i, true);
-    }
-  }
+  result.bitmap_.Overwrite(bitmap_, width, /*dst_offset=*/0,
+                           /*src_offset=*/start);
   return result;
 }
 
@@ -14,10 +14,16 @@
 
 #include "xls/ir/bits_ops.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/big_int.h"
+#include "xls/ir/word_arithmetic.h"
 
 namespace xls {
 namespace bits_ops {
@@ -35,13 +41,106 @@ Bits TruncateOrSignExtend(const Bits& bits, int64_t bit_count) {
   }
 }
 
+// Helpers for the fast paths of the operations below which are taken when the
+// operands fit in a single 64-bit word. These avoid the status checking of
+// Bits::ToUint64 and UBits which dominates the cost of narrow operations.
+
+// Returns the value of `bits`, which must be at most 64 bits wide, as an
+// unsigned word.
+uint64_t ToWord(const Bits& bits) { return bits.bitmap().GetWord(0); }
+
+// Returns the value of `bits`, which must be at most 64 bits wide, as a
+// sign-extended word.
+int64_t ToSignedWord(const Bits& bits) {
+  if (bits.bit_count() == 0) {
+    return 0;
+  }
+  const int64_t shift = 64 - bits.bit_count();
+  return static_cast<int64_t>(ToWord(bits) << shift) >> shift;
+}
+
+// Returns a Bits value of width `bit_count` holding the low bits of `word`.
+Bits FromWord(uint64_t word, int64_t bit_count) {
+  return Bits::FromBitmap(InlineBitmap::FromWord(word, bit_count));
+}
+
+// Helpers for multiplication and division of wide values which operate
+// directly on the words of the underlying bitmaps (see word_arithmetic.h).
+
+// Returns the words of the bitmap of `bits`.
+std::vector<uint64_t> ToWords(const Bits& bits) {
+  const InlineBitmap& bitmap = bits.bitmap();
+  std::vector<uint64_t> words(bitmap.word_count());
+  for (int64_t i = 0; i < words.size(); ++i) {
+    words[i] = bitmap.GetWord(i);
+  }
+  return words;
+}
+
+// Returns whether `bits` is negative in twos-complement representation.
+bool IsNegative(const Bits& bits) {
+  return bits.bit_count() > 0 && bits.msb();
+}
+
+// Negates the twos-complement value held in `words` modulo 2^(64 *
+// words.size()).
+void NegateWords(absl::Span<uint64_t> words) {
+  uint64_t carry = 1;
+  for (uint64_t& word : words) {
+    word = ~word + carry;
+    carry = (carry != 0 && word == 0) ? 1 : 0;
+  }
+}
+
+// Returns the words of the magnitude of `bits` interpreted as a
+// twos-complement value.
+std::vector<uint64_t> ToMagnitudeWords(const Bits& bits) {
+  std::vector<uint64_t> words = ToWords(bits);
+  if (IsNegative(bits)) {
+    // Sign-extend to a whole number of words before negating.
+    const int64_t top_bits = bits.bit_count() % 64;
+    if (top_bits != 0) {
+      words.back() |= ~Mask(top_bits);
+    }
+    NegateWords(absl::MakeSpan(words));
+  }
+  return words;
+}
+
+// Returns a Bits value of width `bit_count` holding the low bits of `words`.
+Bits FromWords(absl::Span<const uint64_t> words, int64_t bit_count) {
+  InlineBitmap bitmap(bit_count);
+  for (int64_t i = 0; i < bitmap.word_count() && i < words.size(); ++i) {
+    bitmap.SetWord(i, words[i]);
+  }
+  return Bits::FromBitmap(std::move(bitmap));
+}
+
+// Returns the product of the (unsigned) words.
+std::vector<uint64_t> WordProduct(absl::Span<const uint64_t> lhs,
+                                  absl::Span<const uint64_t> rhs) {
+  std::vector<uint64_t> product(lhs.size() + rhs.size());
+  MultiplyWords(lhs, rhs, absl::MakeSpan(product));
+  return product;
+}
+
+// Returns the quotient and remainder of the (unsigned) words. The divisor must
+// be non-zero.
+std::pair<std::vector<uint64_t>, std::vector<uint64_t>> WordDivide(
+    absl::Span<const uint64_t> dividend, absl::Span<const uint64_t> divisor) {
+  std::vector<uint64_t> quotient(dividend.size());
+  std::vector<uint64_t> remainder(divisor.size());
+  DivideWords(dividend, divisor, absl::MakeSpan(quotient),
+              absl::MakeSpan(remainder));
+  return {std::move(quotient), std::move(remainder)};
+}
+
 }  // namespace
 
 Bits And(const Bits& lhs, const Bits& rhs) {
   XLS_CHECK_EQ(lhs.bit_count(), rhs.bit_count());
   if (lhs.bit_count() <= 64) {
-    return UBits(lhs.ToUint64().value() & rhs.ToUint64().value(),
-                 lhs.bit_count());
+    return FromWord(ToWord(lhs) & ToWord(rhs), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -62,10 +161,7 @@ Bits NaryAnd(absl::Span<const Bits> operands) {
 Bits Or(const Bits& lhs, const Bits& rhs) {
   XLS_CHECK_EQ(lhs.bit_count(), rhs.bit_count());
   if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int | rhs_int);
-    return UBits(result, lhs.bit_count());
+    return FromWord(ToWord(lhs) | ToWord(rhs), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -86,10 +182,7 @@ Bits NaryOr(absl::Span<const Bits> operands) {
 Bits Xor(const Bits& lhs, const Bits& rhs) {
   XLS_CHECK_EQ(lhs.bit_count(), rhs.bit_count());
   if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int ^ rhs_int);
-    return UBits(result, lhs.bit_count());
+    return FromWord(ToWord(lhs) ^ ToWord(rhs), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -110,9 +203,7 @@ Bits NaryXor(absl::Span<const Bits> operands) {
 Bits Nand(const Bits& lhs, const Bits& rhs) {
   XLS_CHECK_EQ(lhs.bit_count(), rhs.bit_count());
   if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() & rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
+    return FromWord(~(ToWord(lhs) & ToWord(rhs)), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -133,9 +224,7 @@ Bits NaryNand(absl::Span<const Bits> operands) {
 Bits Nor(const Bits& lhs, const Bits& rhs) {
   XLS_CHECK_EQ(lhs.bit_count(), rhs.bit_count());
   if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() | rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
+    return FromWord(~(ToWord(lhs) | ToWord(rhs)), lhs.bit_count());
   }
   std::vector<uint8_t> bytes = lhs.ToBytes();
   std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
@@ -155,8 +244,7 @@ Bits NaryNor(absl::Span<const Bits> operands) {
 
 Bits Not(const Bits& bits) {
   if (bits.bit_count() <= 64) {
-    return UBits((~bits.ToUint64().value()) & Mask(bits.bit_count()),
-                 bits.bit_count());
+    return FromWord(~ToWord(bits), bits.bit_count());
   }
   std::vector<uint8_t> bytes = bits.ToBytes();
   for (uint8_t& byte : bytes) {
@@ -183,10 +271,7 @@ Bits XorReduce(const Bits& operand) {
 Bits Add(const Bits& lhs, const Bits& rhs) {
   XLS_CHECK_EQ(lhs.bit_count(), rhs.bit_count());
   if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int + rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
+    return FromWord(ToWord(lhs) + ToWord(rhs), lhs.bit_count());
   }
 
   Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
@@ -197,10 +282,7 @@ Bits Add(const Bits& lhs, const Bits& rhs) {
 Bits Sub(const Bits& lhs, const Bits& rhs) {
   XLS_CHECK_EQ(lhs.bit_count(), rhs.bit_count());
   if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
+    return FromWord(ToWord(lhs) - ToWord(rhs), lhs.bit_count());
   }
   Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
                   .ToSignedBits();
@@ -210,64 +292,61 @@ Bits Sub(const Bits& lhs, const Bits& rhs) {
 Bits Mul(const Bits& lhs, const Bits& rhs) {
   XLS_CHECK_EQ(lhs.bit_count(), rhs.bit_count());
   if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int * rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
+    return FromWord(ToWord(lhs) * ToWord(rhs), lhs.bit_count());
   }
 
-  BigInt product =
-      BigInt::Mul(BigInt::MakeSigned(SignExtend(lhs, lhs.bit_count())),
-                  BigInt::MakeSigned(SignExtend(rhs, lhs.bit_count())));
-  return product.ToSignedBitsWithBitCount(lhs.bit_count() * 2)
-      .value()
-      .Slice(0, lhs.bit_count());
+  // The low bits of the product are the same for signed and unsigned
+  // operands.
+  return FromWords(WordProduct(ToWords(lhs), ToWords(rhs)), lhs.bit_count());
 }
 
 Bits SMul(const Bits& lhs, const Bits& rhs) {
   const int64_t result_width = lhs.bit_count() + rhs.bit_count();
   if (result_width <= 64) {
-    int64_t lhs_int = lhs.ToInt64().value();
-    int64_t rhs_int = rhs.ToInt64().value();
-    int64_t result = lhs_int * rhs_int;
-    return SBits(result, result_width);
+    // The product of the sign-extended operands is computed modulo 2^64 to
+    // avoid signed overflow (only possible when result_width is 64).
+    uint64_t result = static_cast<uint64_t>(ToSignedWord(lhs)) *
+                      static_cast<uint64_t>(ToSignedWord(rhs));
+    return FromWord(result, result_width);
   }
 
-  BigInt product =
-      BigInt::Mul(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
-  return product.ToSignedBitsWithBitCount(result_width).value();
+  std::vector<uint64_t> product =
+      WordProduct(ToMagnitudeWords(lhs), ToMagnitudeWords(rhs));
+  if (IsNegative(lhs) != IsNegative(rhs)) {
+    NegateWords(absl::MakeSpan(product));
+  }
+  return FromWords(product, result_width);
 }
 
 Bits UMul(const Bits& lhs, const Bits& rhs) {
   const int64_t result_width = lhs.bit_count() + rhs.bit_count();
   if (result_width <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = lhs_int * rhs_int;
-    return UBits(result, result_width);
+    return FromWord(ToWord(lhs) * ToWord(rhs), result_width);
   }
 
-  BigInt product =
-      BigInt::Mul(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
-  return product.ToUnsignedBitsWithBitCount(result_width).value();
+  return FromWords(WordProduct(ToWords(lhs), ToWords(rhs)), result_width);
 }
 
 Bits UDiv(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits::AllOnes(lhs.bit_count());
   }
-  BigInt quotient =
-      BigInt::Div(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
-  return ZeroExtend(quotient.ToUnsignedBits(), lhs.bit_count());
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return FromWord(ToWord(lhs) / ToWord(rhs), lhs.bit_count());
+  }
+  return FromWords(WordDivide(ToWords(lhs), ToWords(rhs)).first,
+                   lhs.bit_count());
 }
 
 Bits UMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
-  BigInt modulo =
-      BigInt::Mod(BigInt::MakeUnsigned(lhs), BigInt::MakeUnsigned(rhs));
-  return ZeroExtend(modulo.ToUnsignedBits(), rhs.bit_count());
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return FromWord(ToWord(lhs) % ToWord(rhs), rhs.bit_count());
+  }
+  return FromWords(WordDivide(ToWords(lhs), ToWords(rhs)).second,
+                   rhs.bit_count());
 }
 
 Bits SDiv(const Bits& lhs, const Bits& rhs) {
@@ -285,20 +364,54 @@ Bits SDiv(const Bits& lhs, const Bits& rhs) {
       return ZeroExtend(Bits::AllOnes(lhs.bit_count() - 1), lhs.bit_count());
     }
   }
-  BigInt quotient =
-      BigInt::Div(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
-  return TruncateOrSignExtend(quotient.ToSignedBits(), lhs.bit_count());
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    int64_t lhs_int = ToSignedWord(lhs);
+    int64_t rhs_int = ToSignedWord(rhs);
+    // The quotient of the most negative value and -1 overflows int64_t. The
+    // result wraps to the most negative value after truncation.
+    if (rhs_int == -1) {
+      return FromWord(0 - static_cast<uint64_t>(lhs_int), lhs.bit_count());
+    }
+    return FromWord(lhs_int / rhs_int, lhs.bit_count());
+  }
+  // The quotient is rounded toward zero so it is the quotient of the
+  // magnitudes, negated if the signs of the operands differ. The quotient of
+  // the most negative value and -1 wraps to the most negative value.
+  std::vector<uint64_t> quotient =
+      WordDivide(ToMagnitudeWords(lhs), ToMagnitudeWords(rhs)).first;
+  if (IsNegative(lhs) != IsNegative(rhs)) {
+    NegateWords(absl::MakeSpan(quotient));
+  }
+  return FromWords(quotient, lhs.bit_count());
 }
 
 Bits SMod(const Bits& lhs, const Bits& rhs) {
   if (rhs.IsZero()) {
     return Bits(rhs.bit_count());
   }
-  BigInt modulo = BigInt::Mod(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
-  return TruncateOrSignExtend(modulo.ToSignedBits(), rhs.bit_count());
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    int64_t rhs_int = ToSignedWord(rhs);
+    // Avoid the overflow of the most negative value modulo -1.
+    if (rhs_int == -1) {
+      return Bits(rhs.bit_count());
+    }
+    // Like BigInt::Mod, the remainder takes the sign of the dividend.
+    return FromWord(ToSignedWord(lhs) % rhs_int, rhs.bit_count());
+  }
+  // The remainder takes the sign of the dividend and its magnitude is the
+  // remainder of the magnitudes.
+  std::vector<uint64_t> remainder =
+      WordDivide(ToMagnitudeWords(lhs), ToMagnitudeWords(rhs)).second;
+  if (IsNegative(lhs)) {
+    NegateWords(absl::MakeSpan(remainder));
+  }
+  return FromWords(remainder, rhs.bit_count());
 }
 
 bool UEqual(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return ToWord(lhs) == ToWord(rhs);
+  }
   return lhs.bitmap().UCmp(rhs.bitmap()) == 0;
 }
 
@@ -316,10 +429,16 @@ bool UGreaterThan(const Bits& lhs, const Bits& rhs) {
 }
 
 bool ULessThanOrEqual(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return ToWord(lhs) <= ToWord(rhs);
+  }
   return lhs.bitmap().UCmp(rhs.bitmap()) <= 0;
 }
 
 bool ULessThan(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return ToWord(lhs) < ToWord(rhs);
+  }
   return lhs.bitmap().UCmp(rhs.bitmap()) < 0;
 }
 
@@ -344,6 +463,9 @@ bool ULessThan(const Bits& lhs, int64_t rhs) {
 }
 
 bool SEqual(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return ToSignedWord(lhs) == ToSignedWord(rhs);
+  }
   return BigInt::MakeSigned(lhs) == BigInt::MakeSigned(rhs);
 }
 
@@ -360,12 +482,15 @@ bool SGreaterThan(const Bits& lhs, const Bits& rhs) {
 }
 
 bool SLessThanOrEqual(const Bits& lhs, const Bits& rhs) {
+  if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
+    return ToSignedWord(lhs) <= ToSignedWord(rhs);
+  }
   return SEqual(lhs, rhs) || SLessThan(lhs, rhs);
 }
 
 bool SLessThan(const Bits& lhs, const Bits& rhs) {
   if (lhs.bit_count() <= 64 && rhs.bit_count() <= 64) {
-    return lhs.ToInt64().value() < rhs.ToInt64().value();
+    return ToSignedWord(lhs) < ToSignedWord(rhs);
   }
   return BigInt::LessThan(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs));
 }
@@ -389,12 +514,18 @@ bool SLessThan(const Bits& lhs, int64_t rhs) {
 Bits ZeroExtend(const Bits& bits, int64_t new_bit_count) {
   XLS_CHECK_GE(new_bit_count, 0);
   XLS_CHECK_GE(new_bit_count, bits.bit_count());
+  if (new_bit_count <= 64) {
+    return FromWord(ToWord(bits), new_bit_count);
+  }
   return Concat({UBits(0, new_bit_count - bits.bit_count()), bits});
 }
 
 Bits SignExtend(const Bits& bits, int64_t new_bit_count) {
   XLS_CHECK_GE(new_bit_count, 0);
   XLS_CHECK_GE(new_bit_count, bits.bit_count());
+  if (new_bit_count <= 64) {
+    return FromWord(ToSignedWord(bits), new_bit_count);
+  }
   const int64_t ext_width = new_bit_count - bits.bit_count();
   return Concat(
       {bits.msb() ? Bits::AllOnes(ext_width) : Bits(ext_width), bits});
@@ -415,9 +546,8 @@ Bits Concat(absl::Span<const Bits> inputs) {
 }
 
 Bits Negate(const Bits& bits) {
-  if (bits.bit_count() < 64) {
-    return UBits((-bits.ToInt64().value()) & Mask(bits.bit_count()),
-                 bits.bit_count());
+  if (bits.bit_count() <= 64) {
+    return FromWord(0 - ToWord(bits), bits.bit_count());
   }
   Bits negated = BigInt::Negate(BigInt::MakeSigned(bits)).ToSignedBits();
   return TruncateOrSignExtend(negated, bits.bit_count());
@@ -429,6 +559,11 @@ Bits Abs(const Bits& bits) {
 
 Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
+  if (bits.bit_count() <= 64) {
+    return shift_amount >= bits.bit_count()
+               ? Bits(bits.bit_count())
+               : FromWord(ToWord(bits) << shift_amount, bits.bit_count());
+  }
   shift_amount = std::min(shift_amount, bits.bit_count());
   return Concat(
       {bits.Slice(0, bits.bit_count() - shift_amount), UBits(0, shift_amount)});
@@ -436,6 +571,11 @@ Bits ShiftLeftLogical(const Bits& bits, int64_t shift_amount) {
 
 Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
+  if (bits.bit_count() <= 64) {
+    return shift_amount >= bits.bit_count()
+               ? Bits(bits.bit_count())
+               : FromWord(ToWord(bits) >> shift_amount, bits.bit_count());
+  }
   shift_amount = std::min(shift_amount, bits.bit_count());
   return Concat({UBits(0, shift_amount),
                  bits.Slice(shift_amount, bits.bit_count() - shift_amount)});
@@ -443,6 +583,11 @@ Bits ShiftRightLogical(const Bits& bits, int64_t shift_amount) {
 
 Bits ShiftRightArith(const Bits& bits, int64_t shift_amount) {
   XLS_CHECK_GE(shift_amount, 0);
+  if (bits.bit_count() <= 64) {
+    // Shifting the sign-extended word by 63 replicates the sign bit.
+    return FromWord(ToSignedWord(bits) >> std::min(shift_amount, int64_t{63}),
+                    bits.bit_count());
+  }
   shift_amount = std::min(shift_amount, bits.bit_count());
   return Concat(
       {bits.msb() ? Bits::AllOnes(shift_amount) : UBits(0, shift_amount),
@@ -0,0 +1,111 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the bits_ops operations. The range argument is the bit width
+// of the operands; widths of at most 64 bits take the single-word fast paths
+// and the widest operands take the Karatsuba and Burnikel-Ziegler paths.
+
+#include <cstdint>
+
+#include "include/benchmark/benchmark.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+
+namespace xls {
+namespace {
+
+// Returns an arbitrary nonzero operand of the given width built by repeating
+// `word`.
+Bits Repeat(uint64_t word, int64_t bit_count) {
+  Bits result;
+  while (result.bit_count() < bit_count) {
+    result = bits_ops::Concat({result, UBits(word, 64)});
+  }
+  return result.Slice(0, bit_count);
+}
+
+// Return arbitrary nonzero operands of the given width.
+Bits Lhs(int64_t bit_count) { return Repeat(0xdeadbeefcafef00dULL, bit_count); }
+Bits Rhs(int64_t bit_count) { return Repeat(0x123456789abcdefULL, bit_count); }
+
+// Divides an operand of twice the given width by one of the given width.
+template <Bits (*kOp)(const Bits&, const Bits&)>
+void BM_WideDivide(benchmark::State& state) {
+  Bits lhs = Lhs(2 * state.range(0));
+  Bits rhs = bits_ops::ZeroExtend(Rhs(state.range(0)), 2 * state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kOp(lhs, rhs));
+  }
+}
+
+template <Bits (*kOp)(const Bits&, const Bits&)>
+void BM_BinaryOp(benchmark::State& state) {
+  Bits lhs = Lhs(state.range(0));
+  Bits rhs = Rhs(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kOp(lhs, rhs));
+  }
+}
+
+template <bool (*kOp)(const Bits&, const Bits&)>
+void BM_Comparison(benchmark::State& state) {
+  Bits lhs = Lhs(state.range(0));
+  Bits rhs = Rhs(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kOp(lhs, rhs));
+  }
+}
+
+template <Bits (*kOp)(const Bits&, int64_t)>
+void BM_Shift(benchmark::State& state) {
+  Bits bits = Lhs(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(kOp(bits, 3));
+  }
+}
+
+void BM_SignExtend(benchmark::State& state) {
+  Bits bits = Lhs(state.range(0) / 2);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(bits_ops::SignExtend(bits, state.range(0)));
+  }
+}
+
+#define BITS_BENCHMARK(...) BENCHMARK(__VA_ARGS__)->Arg(8)->Arg(64)->Arg(128)
+
+BITS_BENCHMARK(BM_BinaryOp<bits_ops::And>);
+BITS_BENCHMARK(BM_BinaryOp<bits_ops::Add>);
+BITS_BENCHMARK(BM_BinaryOp<bits_ops::UMul>);
+BITS_BENCHMARK(BM_BinaryOp<bits_ops::UDiv>);
+BITS_BENCHMARK(BM_BinaryOp<bits_ops::SDiv>);
+BITS_BENCHMARK(BM_BinaryOp<bits_ops::SMod>);
+BITS_BENCHMARK(BM_Comparison<bits_ops::UEqual>);
+BITS_BENCHMARK(BM_Comparison<bits_ops::ULessThan>);
+BITS_BENCHMARK(BM_Comparison<bits_ops::SLessThanOrEqual>);
+BITS_BENCHMARK(BM_Shift<bits_ops::ShiftLeftLogical>);
+BITS_BENCHMARK(BM_Shift<bits_ops::ShiftRightArith>);
+BITS_BENCHMARK(BM_SignExtend);
+
+#define WIDE_BITS_BENCHMARK(...) \
+  BENCHMARK(__VA_ARGS__)->Arg(512)->Arg(2048)->Arg(8192)
+
+WIDE_BITS_BENCHMARK(BM_BinaryOp<bits_ops::UMul>);
+WIDE_BITS_BENCHMARK(BM_BinaryOp<bits_ops::SMul>);
+WIDE_BITS_BENCHMARK(BM_WideDivide<bits_ops::UDiv>);
+WIDE_BITS_BENCHMARK(BM_WideDivide<bits_ops::SMod>);
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
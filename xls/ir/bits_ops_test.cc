@@ -14,9 +14,13 @@
 
 #include "xls/ir/bits_ops.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/number_parser.h"
@@ -828,5 +832,95 @@ TEST(BitsOpsTest, LongestCommonPrefixLSBMoreThan2) {
   EXPECT_EQ(bits_ops::LongestCommonPrefixLSB({x, y, z}), expected);
 }
 
+// Returns a set of interesting values of the given width for checking the
+// single-word fast paths of the bits_ops functions.
+std::vector<Bits> InterestingValues(int64_t bit_count) {
+  std::vector<uint64_t> words = {0,
+                                 1,
+                                 2,
+                                 3,
+                                 Mask(bit_count),
+                                 Mask(bit_count) - 1,
+                                 uint64_t{1} << (bit_count - 1),
+                                 (uint64_t{1} << (bit_count - 1)) - 1,
+                                 (uint64_t{1} << (bit_count - 1)) + 1,
+                                 0x5555555555555555ULL,
+                                 0xdeadbeefcafef00dULL};
+  std::vector<Bits> values;
+  for (uint64_t word : words) {
+    values.push_back(UBits(word & Mask(bit_count), bit_count));
+  }
+  return values;
+}
+
+// Checks that the results of the operations for operands of at most 64 bits
+// (which take single-word fast paths) match the results computed on operands
+// widened beyond 64 bits (which take the general paths).
+TEST(BitsOpsTest, SingleWordFastPathsMatchWidePaths) {
+  constexpr int64_t kWideBitCount = 130;
+  for (int64_t bit_count : {1, 2, 7, 32, 63, 64}) {
+    auto zext = [&](const Bits& b) {
+      return bits_ops::ZeroExtend(b, kWideBitCount);
+    };
+    auto sext = [&](const Bits& b) {
+      return bits_ops::SignExtend(b, kWideBitCount);
+    };
+    auto narrow = [&](const Bits& b) { return b.Slice(0, bit_count); };
+    for (const Bits& a : InterestingValues(bit_count)) {
+      SCOPED_TRACE(absl::StrCat("a: ", a.ToString()));
+      EXPECT_EQ(bits_ops::Negate(a), narrow(bits_ops::Negate(sext(a))));
+      EXPECT_EQ(bits_ops::Not(a), narrow(bits_ops::Not(zext(a))));
+      EXPECT_EQ(bits_ops::ZeroExtend(a, 64), zext(a).Slice(0, 64));
+      EXPECT_EQ(bits_ops::SignExtend(a, 64), sext(a).Slice(0, 64));
+      for (int64_t shift : {0, 1, 5, 31, 62, 63, 64, 100}) {
+        SCOPED_TRACE(absl::StrCat("shift: ", shift));
+        EXPECT_EQ(bits_ops::ShiftLeftLogical(a, shift),
+                  narrow(bits_ops::ShiftLeftLogical(zext(a), shift)));
+        EXPECT_EQ(bits_ops::ShiftRightLogical(a, shift),
+                  narrow(bits_ops::ShiftRightLogical(zext(a), shift)));
+        EXPECT_EQ(bits_ops::ShiftRightArith(a, shift),
+                  narrow(bits_ops::ShiftRightArith(sext(a), shift)));
+      }
+      for (const Bits& b : InterestingValues(bit_count)) {
+        SCOPED_TRACE(absl::StrCat("b: ", b.ToString()));
+        EXPECT_EQ(bits_ops::And(a, b), narrow(bits_ops::And(zext(a), zext(b))));
+        EXPECT_EQ(bits_ops::Nor(a, b), narrow(bits_ops::Nor(zext(a), zext(b))));
+        EXPECT_EQ(bits_ops::Add(a, b), narrow(bits_ops::Add(zext(a), zext(b))));
+        EXPECT_EQ(bits_ops::Sub(a, b), narrow(bits_ops::Sub(zext(a), zext(b))));
+        EXPECT_EQ(bits_ops::UMul(a, b),
+                  bits_ops::UMul(zext(a), zext(b)).Slice(0, 2 * bit_count));
+        EXPECT_EQ(bits_ops::SMul(a, b),
+                  bits_ops::SMul(sext(a), sext(b)).Slice(0, 2 * bit_count));
+        EXPECT_EQ(bits_ops::UDiv(a, b),
+                  narrow(bits_ops::UDiv(zext(a), zext(b))));
+        EXPECT_EQ(bits_ops::UMod(a, b),
+                  narrow(bits_ops::UMod(zext(a), zext(b))));
+        if (!b.IsZero()) {
+          // Division by zero saturates at the width of the operands.
+          EXPECT_EQ(bits_ops::SDiv(a, b),
+                    narrow(bits_ops::SDiv(sext(a), sext(b))));
+        }
+        EXPECT_EQ(bits_ops::SMod(a, b),
+                  narrow(bits_ops::SMod(sext(a), sext(b))));
+        EXPECT_EQ(bits_ops::UEqual(a, b), bits_ops::UEqual(zext(a), zext(b)));
+        EXPECT_EQ(bits_ops::ULessThan(a, b),
+                  bits_ops::ULessThan(zext(a), zext(b)));
+        EXPECT_EQ(bits_ops::ULessThanOrEqual(a, b),
+                  bits_ops::ULessThanOrEqual(zext(a), zext(b)));
+        EXPECT_EQ(bits_ops::SEqual(a, b), bits_ops::SEqual(sext(a), sext(b)));
+        EXPECT_EQ(bits_ops::SLessThan(a, b),
+                  bits_ops::SLessThan(sext(a), sext(b)));
+        EXPECT_EQ(bits_ops::SLessThanOrEqual(a, b),
+                  bits_ops::SLessThanOrEqual(sext(a), sext(b)));
+      }
+      // Mixed-width comparisons against a wider narrow value.
+      EXPECT_EQ(bits_ops::ULessThan(a, UBits(1, 64)),
+                bits_ops::ULessThan(zext(a), UBits(1, 64)));
+      EXPECT_EQ(bits_ops::SLessThan(a, SBits(-1, 64)),
+                bits_ops::SLessThan(sext(a), SBits(-1, 64)));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
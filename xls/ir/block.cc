@@ -628,8 +628,9 @@ absl::Span<InstantiationOutput* const> Block::GetInstantiationOutputs(
   return instantiation_outputs_.at(instantiation);
 }
 
-absl::StatusOr<Block*> Block::Clone(std::string_view new_name,
-                                    Package* target_package) const {
+absl::StatusOr<Block*> Block::Clone(
+    std::string_view new_name, Package* target_package,
+    const absl::flat_hash_map<const Block*, Block*>& block_remapping) const {
   absl::flat_hash_map<Node*, Node*> original_to_clone;
   absl::flat_hash_map<Register*, Register*> register_map;
   absl::flat_hash_map<Instantiation*, Instantiation*> instantiation_map;
@@ -660,10 +661,14 @@ absl::StatusOr<Block*> Block::Clone(std::string_view new_name,
     if (inst->kind() == InstantiationKind::kBlock) {
       auto block_inst = dynamic_cast<BlockInstantiation*>(inst);
       XLS_CHECK(block_inst != nullptr);
-      XLS_ASSIGN_OR_RETURN(
-          instantiation_map[inst],
-          cloned_block->AddBlockInstantiation(
-              block_inst->name(), block_inst->instantiated_block()));
+      Block* instantiated_block = block_inst->instantiated_block();
+      auto remapped_block = block_remapping.find(instantiated_block);
+      if (remapped_block != block_remapping.end()) {
+        instantiated_block = remapped_block->second;
+      }
+      XLS_ASSIGN_OR_RETURN(instantiation_map[inst],
+                           cloned_block->AddBlockInstantiation(
+                               block_inst->name(), instantiated_block));
     } else {
       XLS_LOG(FATAL) << "InstantiationKind not yet supported: " << inst->kind();
     }
@@ -15,6 +15,7 @@
 #ifndef XLS_IR_BLOCK_H_
 #define XLS_IR_BLOCK_H_
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/instantiation.h"
@@ -160,9 +161,13 @@ class Block : public FunctionBase {
 
   bool HasImplicitUse(Node* node) const override { return false; }
 
-  // Creates a clone of the block with the new name 'new_name'.
-  absl::StatusOr<Block*> Clone(std::string_view new_name,
-                               Package* target_package = nullptr) const;
+  // Creates a clone of the block with the new name 'new_name'. Instantiations
+  // of blocks which are keys of `block_remapping` instantiate the mapped block
+  // in the clone.
+  absl::StatusOr<Block*> Clone(
+      std::string_view new_name, Package* target_package = nullptr,
+      const absl::flat_hash_map<const Block*, Block*>& block_remapping = {})
+      const;
 
   std::string DumpIr() const override;
 
@@ -38,8 +38,8 @@ std::optional<Function*> CalledFunction(Node* node) {
       return std::nullopt;
   }
 }
+}  // namespace
 
-// Returns the functions called directly by the nodes of the given FunctionBase.
 std::vector<Function*> CalledFunctions(FunctionBase* function_base) {
   absl::flat_hash_set<Function*> called_set;
   std::vector<Function*> called;
@@ -53,7 +53,6 @@ std::vector<Function*> CalledFunctions(FunctionBase* function_base) {
   }
   return called;
 }
-}  // namespace
 
 // Recursive DFS visitor of the call graph induced by invoke
 // instructions. Builds a post order of functions in the post_order vector.
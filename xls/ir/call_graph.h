@@ -23,6 +23,10 @@
 
 namespace xls {
 
+// Returns the functions called directly by the nodes of the given
+// FunctionBase, in the order of the first node calling each.
+std::vector<Function*> CalledFunctions(FunctionBase* function_base);
+
 // Returns the functions called transitively by the given FunctionBase. Called
 // functions are returned before callee FunctionBases in the returned order. The
 // final element in the returned vector is `function_base`.
@@ -0,0 +1,73 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/event_sinks.h"
+
+#include <utility>
+
+namespace xls {
+
+void CallbackEventSink::RecordTrace(TraceEvent event) {
+  trace_callback_(std::move(event));
+}
+
+void CallbackEventSink::RecordAssert(std::string_view message) {
+  if (assert_callback_ != nullptr) {
+    assert_callback_(message);
+  }
+}
+
+void RingBufferEventSink::RecordTrace(TraceEvent event) {
+  if (capacity_ <= 0) {
+    ++dropped_count_;
+    return;
+  }
+  if (traces_.size() >= capacity_) {
+    traces_.pop_front();
+    ++dropped_count_;
+  }
+  traces_.push_back(std::move(event));
+}
+
+std::vector<std::string> RingBufferEventSink::GetTraceMessages() const {
+  std::vector<std::string> messages;
+  messages.reserve(traces_.size());
+  for (const TraceEvent& event : traces_) {
+    messages.push_back(event.ToString());
+  }
+  return messages;
+}
+
+void StreamEventSink::RecordTrace(TraceEvent event) {
+  buffer_.push_back(std::move(event));
+  if (buffer_.size() >= buffer_size_) {
+    Flush();
+  }
+}
+
+void StreamEventSink::RecordAssert(std::string_view message) {
+  // Write out the preceding traces first to preserve the order of the events.
+  Flush();
+  *stream_ << "assertion failed: " << message << "\n";
+}
+
+void StreamEventSink::Flush() {
+  for (const TraceEvent& event : buffer_) {
+    *stream_ << event.ToString() << "\n";
+  }
+  buffer_.clear();
+  stream_->flush();
+}
+
+}  // namespace xls
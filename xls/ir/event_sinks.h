@@ -0,0 +1,98 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_EVENT_SINKS_H_
+#define XLS_IR_EVENT_SINKS_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "xls/ir/events.h"
+
+namespace xls {
+
+// Event sink which invokes a callback for each trace and failed assertion.
+class CallbackEventSink : public EventSink {
+ public:
+  using TraceCallback = std::function<void(TraceEvent)>;
+  using AssertCallback = std::function<void(std::string_view)>;
+
+  explicit CallbackEventSink(TraceCallback trace_callback,
+                             AssertCallback assert_callback = nullptr)
+      : trace_callback_(std::move(trace_callback)),
+        assert_callback_(std::move(assert_callback)) {}
+
+  void RecordTrace(TraceEvent event) override;
+  void RecordAssert(std::string_view message) override;
+
+ private:
+  TraceCallback trace_callback_;
+  AssertCallback assert_callback_;
+};
+
+// Event sink which retains the most recent `capacity` traces. Older traces are
+// discarded so memory use is bounded regardless of the length of the
+// simulation. Traces are stored unformatted.
+class RingBufferEventSink : public EventSink {
+ public:
+  explicit RingBufferEventSink(int64_t capacity) : capacity_(capacity) {}
+
+  void RecordTrace(TraceEvent event) override;
+
+  // Returns the retained traces, oldest first.
+  const std::deque<TraceEvent>& traces() const { return traces_; }
+
+  // Returns the formatted messages of the retained traces, oldest first.
+  std::vector<std::string> GetTraceMessages() const;
+
+  // Returns the number of traces which have been discarded.
+  int64_t dropped_count() const { return dropped_count_; }
+
+ private:
+  int64_t capacity_;
+  std::deque<TraceEvent> traces_;
+  int64_t dropped_count_ = 0;
+};
+
+// Event sink which writes traces and failed assertions to a stream, one per
+// line. Traces are buffered unformatted and are formatted and written when
+// `buffer_size` traces have accumulated, on Flush, and on destruction. The
+// stream is not owned.
+class StreamEventSink : public EventSink {
+ public:
+  explicit StreamEventSink(std::ostream* stream, int64_t buffer_size = 1024)
+      : stream_(stream), buffer_size_(buffer_size) {}
+  ~StreamEventSink() override { Flush(); }
+
+  void RecordTrace(TraceEvent event) override;
+  void RecordAssert(std::string_view message) override;
+
+  // Formats and writes all buffered traces.
+  void Flush();
+
+ private:
+  std::ostream* stream_;
+  int64_t buffer_size_;
+  std::vector<TraceEvent> buffer_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_EVENT_SINKS_H_
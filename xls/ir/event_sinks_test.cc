@@ -0,0 +1,118 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/event_sinks.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class EventSinksTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(format_, ParseFormatString("x={} y={:x}"));
+  }
+
+  TraceEvent MakeEvent(int64_t x, int64_t y) {
+    return TraceEvent{.format = format_,
+                      .args = {Value(UBits(x, 32)), Value(UBits(y, 32))}};
+  }
+
+  std::vector<FormatStep> format_;
+};
+
+TEST_F(EventSinksTest, TraceEventToString) {
+  EXPECT_EQ(MakeEvent(10, 255).ToString(), "x=10 y=ff");
+  EXPECT_EQ(TraceEvent{.message = "hello"}.ToString(), "hello");
+}
+
+TEST_F(EventSinksTest, InterpreterEventsWithoutSink) {
+  InterpreterEvents events;
+  events.RecordTrace(MakeEvent(1, 2));
+  events.RecordAssert("oops");
+  EXPECT_THAT(events.trace_msgs, ElementsAre("x=1 y=2"));
+  EXPECT_THAT(events.assert_msgs, ElementsAre("oops"));
+}
+
+TEST_F(EventSinksTest, CallbackSink) {
+  std::vector<std::string> traces;
+  std::vector<std::string> asserts;
+  CallbackEventSink sink(
+      [&](TraceEvent event) { traces.push_back(event.ToString()); },
+      [&](std::string_view message) {
+        asserts.push_back(std::string(message));
+      });
+  InterpreterEvents events{.sink = &sink};
+  events.RecordTrace(MakeEvent(1, 2));
+  events.RecordAssert("oops");
+
+  EXPECT_THAT(traces, ElementsAre("x=1 y=2"));
+  EXPECT_THAT(asserts, ElementsAre("oops"));
+  // Traces are not accumulated, but assertions are as they determine the
+  // result status.
+  EXPECT_THAT(events.trace_msgs, IsEmpty());
+  EXPECT_THAT(events.assert_msgs, ElementsAre("oops"));
+}
+
+TEST_F(EventSinksTest, RingBufferSink) {
+  RingBufferEventSink sink(/*capacity=*/3);
+  InterpreterEvents events{.sink = &sink};
+  for (int64_t i = 0; i < 5; ++i) {
+    events.RecordTrace(MakeEvent(i, i));
+  }
+  EXPECT_THAT(sink.GetTraceMessages(),
+              ElementsAre("x=2 y=2", "x=3 y=3", "x=4 y=4"));
+  EXPECT_EQ(sink.dropped_count(), 2);
+
+  RingBufferEventSink empty_sink(/*capacity=*/0);
+  empty_sink.RecordTrace(MakeEvent(1, 1));
+  EXPECT_THAT(empty_sink.traces(), IsEmpty());
+  EXPECT_EQ(empty_sink.dropped_count(), 1);
+}
+
+TEST_F(EventSinksTest, StreamSink) {
+  std::stringstream stream;
+  {
+    StreamEventSink sink(&stream, /*buffer_size=*/2);
+    sink.RecordTrace(MakeEvent(1, 1));
+    // Traces are buffered until the buffer is full.
+    EXPECT_EQ(stream.str(), "");
+    sink.RecordTrace(MakeEvent(2, 2));
+    EXPECT_EQ(stream.str(), "x=1 y=1\nx=2 y=2\n");
+    sink.RecordTrace(MakeEvent(3, 3));
+    sink.RecordAssert("oops");
+    EXPECT_EQ(stream.str(),
+              "x=1 y=1\nx=2 y=2\nx=3 y=3\nassertion failed: oops\n");
+    sink.RecordTrace(MakeEvent(4, 4));
+  }
+  // The remaining traces are written on destruction.
+  EXPECT_EQ(stream.str(),
+            "x=1 y=1\nx=2 y=2\nx=3 y=3\nassertion failed: oops\nx=4 y=4\n");
+}
+
+}  // namespace
+}  // namespace xls
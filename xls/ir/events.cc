@@ -14,8 +14,59 @@
 
 #include "xls/ir/events.h"
 
+#include <utility>
+#include <variant>
+
+#include "absl/strings/str_cat.h"
+
 namespace xls {
 
+std::string TraceEvent::ToString() const {
+  if (format.empty()) {
+    return message;
+  }
+  std::string result;
+  auto arg = args.begin();
+  for (const FormatStep& step : format) {
+    if (std::holds_alternative<std::string>(step)) {
+      absl::StrAppend(&result, std::get<std::string>(step));
+    } else if (arg != args.end()) {
+      absl::StrAppend(&result,
+                      arg->ToHumanString(std::get<FormatPreference>(step)));
+      ++arg;
+    }
+  }
+  return result;
+}
+
+void InterpreterEvents::RecordTrace(TraceEvent event) {
+  if (sink != nullptr) {
+    sink->RecordTrace(std::move(event));
+    return;
+  }
+  if (event.format.empty()) {
+    trace_msgs.push_back(std::move(event.message));
+  } else {
+    trace_msgs.push_back(event.ToString());
+  }
+}
+
+void InterpreterEvents::RecordAssert(std::string message) {
+  if (sink != nullptr) {
+    sink->RecordAssert(message);
+  }
+  assert_msgs.push_back(std::move(message));
+}
+
+void InterpreterEvents::Append(const InterpreterEvents& other) {
+  for (const std::string& trace_msg : other.trace_msgs) {
+    RecordTrace(TraceEvent{.message = trace_msg});
+  }
+  for (const std::string& assert_msg : other.assert_msgs) {
+    RecordAssert(assert_msg);
+  }
+}
+
 absl::Status InterpreterEventsToStatus(const InterpreterEvents& events) {
   if (events.assert_msgs.empty()) {
     return absl::OkStatus();
@@ -15,17 +15,65 @@
 #ifndef XLS_IR_EVENTS_H_
 #define XLS_IR_EVENTS_H_
 
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
+// A trace produced by an interpreter. The event holds the operand values of
+// the trace rather than the formatted message so that formatting can be
+// deferred until (and unless) the message is needed.
+struct TraceEvent {
+  // The format of the trace node which produced the event. The format is owned
+  // by the package which must outlive the event. If empty, `message` holds the
+  // already formatted message.
+  absl::Span<const FormatStep> format;
+  std::vector<Value> args;
+  std::string message;
+
+  // Returns the formatted trace message.
+  std::string ToString() const;
+};
+
+// Interface for consumers of interpreter events which receive the events as
+// they are produced rather than having them accumulated in InterpreterEvents.
+// See xls/ir/event_sinks.h for implementations.
+class EventSink {
+ public:
+  virtual ~EventSink() = default;
+
+  virtual void RecordTrace(TraceEvent event) = 0;
+  virtual void RecordAssert(std::string_view message) {}
+};
+
 // Common structure capturing events that can be produced by any XLS interpreter
 // (DSLX, IR, JIT, etc.)
 struct InterpreterEvents {
   std::vector<std::string> trace_msgs;
   std::vector<std::string> assert_msgs;
 
+  // If non-null, traces are passed to the sink instead of being formatted and
+  // accumulated in `trace_msgs`. Assertion messages are passed to the sink and
+  // are also always accumulated in `assert_msgs` as they determine the status
+  // of the evaluation. The sink is not owned.
+  EventSink* sink = nullptr;
+
+  // Records a trace with the sink, or in `trace_msgs` if there is no sink.
+  void RecordTrace(TraceEvent event);
+
+  // Records a failed assertion.
+  void RecordAssert(std::string message);
+
+  // Records the events accumulated in `other` as if they had occurred here.
+  void Append(const InterpreterEvents& other);
+
   bool operator==(const InterpreterEvents& other) const {
     return trace_msgs == other.trace_msgs && assert_msgs == other.assert_msgs;
   }
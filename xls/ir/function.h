@@ -15,6 +15,7 @@
 #ifndef XLS_IR_FUNCTION_H_
 #define XLS_IR_FUNCTION_H_
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -37,9 +38,6 @@
 namespace xls {
 
 class Function : public FunctionBase {
- private:
-  using NodeList = std::list<std::unique_ptr<Node>>;
-
  public:
   Function(std::string_view name, Package* package)
       : FunctionBase(name, package) {}
@@ -54,6 +52,7 @@ class Function : public FunctionBase {
         "Return value node %s is not in this function %s (is in function %s)",
         n->GetName(), name(), n->function_base()->name());
     return_value_ = n;
+    NoteNodeChanged(n);
     return absl::OkStatus();
   }
 
@@ -84,6 +83,13 @@ class Function : public FunctionBase {
     return node == return_value();
   }
 
+ protected:
+  std::function<void()> SaveStateForRollback() override {
+    return [this, return_value = return_value_]() {
+      return_value_ = return_value;
+    };
+  }
+
  private:
   Node* return_value_ = nullptr;
 };
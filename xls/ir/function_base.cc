@@ -14,6 +14,13 @@
 
 #include "xls/ir/function_base.h"
 
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -29,6 +36,93 @@
 
 namespace xls {
 
+namespace {
+
+// The start of the private range of node ids used while staging. The range is
+// shared by all function bases as ids need only be unique within a function
+// base until staging ends.
+constexpr int64_t kStagedNodeIdBase = int64_t{1} << 62;
+
+}  // namespace
+
+int64_t FunctionBase::AllocateNodeId() {
+  if (!staged_next_node_id_.has_value() && package_->stage_node_ids_) {
+    BeginNodeIdStaging();
+  }
+  if (staged_next_node_id_.has_value()) {
+    return (*staged_next_node_id_)++;
+  }
+  return package_->GetNextNodeId();
+}
+
+void FunctionBase::BeginNodeIdStaging() {
+  XLS_CHECK(!staged_next_node_id_.has_value());
+  staged_next_node_id_ = kStagedNodeIdBase;
+}
+
+void FunctionBase::EndNodeIdStaging() {
+  XLS_CHECK(staged_next_node_id_.has_value());
+  staged_next_node_id_.reset();
+  for (Node* node : nodes()) {
+    if (node->id() >= kStagedNodeIdBase) {
+      node->SetId(package_->GetNextNodeId());
+    }
+  }
+}
+
+/* static */ int64_t FunctionBase::NextUid() {
+  // Function bases may be created concurrently (e.g., by
+  // Parser::ParsePackageParallel).
+  static std::atomic<int64_t> next_uid{0};
+  return next_uid.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t FunctionBase::GetFingerprint() const {
+  if (cached_fingerprint_.has_value() &&
+      cached_fingerprint_->first == change_count_) {
+    return cached_fingerprint_->second;
+  }
+  absl::flat_hash_map<Node*, uint64_t> node_hashes;
+  node_hashes.reserve(node_count());
+  // The hashes of the nodes are summed so the fingerprint does not depend on
+  // the order in which they are visited.
+  uint64_t node_hash_sum = 0;
+  for (Node* node : TopoSort(const_cast<FunctionBase*>(this))) {
+    std::vector<uint64_t> operand_hashes;
+    operand_hashes.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operand_hashes.push_back(node_hashes.at(operand));
+    }
+    uint64_t hash =
+        absl::HashOf(node->GetType()->ToString(), node->ToCanonicalString(),
+                     absl::MakeConstSpan(operand_hashes));
+    node_hashes[node] = hash;
+    node_hash_sum += hash;
+  }
+  std::vector<uint64_t> root_hashes;
+  for (Param* param : params()) {
+    root_hashes.push_back(node_hashes.at(param));
+  }
+  if (IsFunction()) {
+    Node* return_value =
+        static_cast<const Function*>(this)->return_value();
+    if (return_value != nullptr) {
+      root_hashes.push_back(node_hashes.at(return_value));
+    }
+  } else if (IsProc()) {
+    const Proc* proc = static_cast<const Proc*>(this);
+    root_hashes.push_back(node_hashes.at(proc->NextToken()));
+    for (Node* next_state : proc->NextState()) {
+      root_hashes.push_back(node_hashes.at(next_state));
+    }
+  }
+  uint64_t fingerprint =
+      absl::HashOf(IsFunction(), IsProc(), IsBlock(), node_hash_sum,
+                   absl::MakeConstSpan(root_hashes));
+  cached_fingerprint_ = std::make_pair(change_count_, fingerprint);
+  return fingerprint;
+}
+
 absl::StatusOr<Param*> FunctionBase::GetParamByName(
     std::string_view param_name) const {
   for (Param* param : params()) {
@@ -95,13 +189,44 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
     params_.erase(std::remove(params_.begin(), params_.end(), node),
                   params_.end());
   }
-  auto node_it = node_iterators_.find(node);
-  XLS_RET_CHECK(node_it != node_iterators_.end());
-  nodes_.erase(node_it->second);
-  node_iterators_.erase(node_it);
+  int64_t index = node->node_table_index_;
+  XLS_RET_CHECK(index >= 0 && index < nodes_.size() &&
+                nodes_[index].get() == node);
+  if (topo_order_ != nullptr) {
+    topo_order_->RemoveNode(node);
+  }
+  if (structural_hash_index_ != nullptr) {
+    structural_hash_index_->RemoveNode(node);
+  }
+  ++change_count_;
+  if (changed_nodes_.has_value()) {
+    changed_nodes_->erase(node);
+  }
+  if (checkpoint_ != nullptr) {
+    checkpoint_->removed_nodes.push_back(std::move(nodes_[index]));
+  } else {
+    nodes_[index].reset();
+  }
+  ++tombstone_count_;
   return absl::OkStatus();
 }
 
+void FunctionBase::CompactNodes() {
+  // Rollback restores removed nodes to their original slots in the table.
+  if (tombstone_count_ == 0 || checkpoint_ != nullptr) {
+    return;
+  }
+  int64_t next_index = 0;
+  for (std::unique_ptr<Node>& node : nodes_) {
+    if (node != nullptr) {
+      node->node_table_index_ = next_index;
+      nodes_[next_index++] = std::move(node);
+    }
+  }
+  nodes_.resize(next_index);
+  tombstone_count_ = 0;
+}
+
 absl::Status FunctionBase::Accept(DfsVisitor* visitor) {
   for (Node* node : nodes()) {
     if (node->users().empty()) {
@@ -164,10 +289,158 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
     params_.push_back(node->As<Param>());
   }
   Node* ptr = node.get();
-  node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
+  ptr->node_table_index_ = nodes_.size();
+  nodes_.push_back(std::move(node));
+  if (topo_order_ != nullptr) {
+    topo_order_->AddNode(ptr);
+  }
+  NoteNodeChanged(ptr);
   return ptr;
 }
 
+void FunctionBase::FinalizeNodeNames() {
+  if (!node_names_deferred_) {
+    return;
+  }
+  node_names_deferred_ = false;
+  for (Node* node : nodes()) {
+    if (node->name_pending_) {
+      node->name_ = UniquifyNodeName(node->name_);
+      node->name_pending_ = false;
+    }
+  }
+}
+
+void FunctionBase::SetIncrementalTopoSortEnabled(bool enabled) {
+  if (!enabled) {
+    topo_order_.reset();
+  } else if (topo_order_ == nullptr) {
+    // The order is computed lazily by the first TopoSort.
+    topo_order_ = std::make_unique<IncrementalTopoOrder>();
+  }
+}
+
+void FunctionBase::SetStructuralHashingEnabled(bool enabled) {
+  if (!enabled) {
+    structural_hash_index_.reset();
+  } else if (structural_hash_index_ == nullptr) {
+    structural_hash_index_ = std::make_unique<StructuralHashIndex>();
+    std::vector<Node*> nodes(this->nodes().begin(), this->nodes().end());
+    structural_hash_index_->Reset(nodes);
+  }
+}
+
+Node* FunctionBase::ReuseEquivalentNode(Node* node) {
+  if (structural_hash_index_ == nullptr || !node->users().empty() ||
+      HasImplicitUse(node)) {
+    return node;
+  }
+  Node* equivalent = structural_hash_index_->FindEquivalent(node);
+  if (equivalent == nullptr) {
+    return node;
+  }
+  XLS_CHECK_OK(RemoveNode(node));
+  return equivalent;
+}
+
+void FunctionBase::SetChangeTrackingEnabled(bool enabled) {
+  if (enabled) {
+    changed_nodes_.emplace();
+  } else {
+    changed_nodes_.reset();
+  }
+}
+
+absl::Status FunctionBase::Checkpoint() {
+  XLS_RET_CHECK(checkpoint_ == nullptr)
+      << "Function base " << name() << " already holds a checkpoint";
+  if (IsBlock()) {
+    return absl::UnimplementedError(
+        absl::StrFormat("Cannot checkpoint block %s", name()));
+  }
+  checkpoint_ = std::make_unique<CheckpointLog>();
+  checkpoint_->node_table_size = nodes_.size();
+  checkpoint_->tombstone_count = tombstone_count_;
+  checkpoint_->params = params_;
+  checkpoint_->restore_state = SaveStateForRollback();
+  return absl::OkStatus();
+}
+
+void FunctionBase::SaveNodeForRollbackInternal(Node* node) {
+  // Nodes added after the checkpoint (or under construction and not yet
+  // added) are destroyed by a rollback.
+  if (node->node_table_index_ < 0 ||
+      node->node_table_index_ >= checkpoint_->node_table_size ||
+      checkpoint_->saved_nodes.contains(node)) {
+    return;
+  }
+  checkpoint_->saved_nodes.emplace(
+      node, SavedNode{.operands = node->operands_,
+                      .users = node->users_,
+                      .name = node->name_,
+                      .id = node->id_,
+                      .loc = node->loc_});
+}
+
+absl::Status FunctionBase::RollbackToCheckpoint() {
+  XLS_RET_CHECK(checkpoint_ != nullptr)
+      << "Function base " << name() << " does not hold a checkpoint";
+  std::unique_ptr<CheckpointLog> log = std::move(checkpoint_);
+  const int64_t node_table_size = log->node_table_size;
+
+  // Destroy the nodes added since the checkpoint and return the removed nodes
+  // to their slots in the node table.
+  std::vector<std::unique_ptr<Node>> added_nodes;
+  for (int64_t i = node_table_size; i < nodes_.size(); ++i) {
+    if (nodes_[i] != nullptr) {
+      added_nodes.push_back(std::move(nodes_[i]));
+    }
+  }
+  nodes_.resize(node_table_size);
+  for (std::unique_ptr<Node>& node : log->removed_nodes) {
+    if (node->node_table_index_ >= node_table_size) {
+      added_nodes.push_back(std::move(node));
+    } else {
+      XLS_RET_CHECK(nodes_[node->node_table_index_] == nullptr);
+      NoteNodeChanged(node.get());
+      nodes_[node->node_table_index_] = std::move(node);
+    }
+  }
+  if (changed_nodes_.has_value()) {
+    for (const std::unique_ptr<Node>& node : added_nodes) {
+      changed_nodes_->erase(node.get());
+    }
+  }
+  added_nodes.clear();
+
+  for (auto& [node, saved] : log->saved_nodes) {
+    node->operands_ = std::move(saved.operands);
+    node->users_ = std::move(saved.users);
+    node->name_ = std::move(saved.name);
+    node->id_ = saved.id;
+    node->loc_ = std::move(saved.loc);
+    NoteNodeChanged(node);
+  }
+  tombstone_count_ = log->tombstone_count;
+  params_ = std::move(log->params);
+  log->restore_state();
+  if (topo_order_ != nullptr) {
+    topo_order_->Invalidate();
+  }
+  if (structural_hash_index_ != nullptr) {
+    std::vector<Node*> nodes(this->nodes().begin(), this->nodes().end());
+    structural_hash_index_->Reset(nodes);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status FunctionBase::CommitCheckpoint() {
+  XLS_RET_CHECK(checkpoint_ != nullptr)
+      << "Function base " << name() << " does not hold a checkpoint";
+  checkpoint_.reset();
+  return absl::OkStatus();
+}
+
 /*static*/ std::vector<std::string> FunctionBase::GetIrReservedWords() {
   std::vector<std::string> words(Token::GetKeywords().begin(),
                                  Token::GetKeywords().end());
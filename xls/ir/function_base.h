@@ -15,22 +15,31 @@
 #ifndef XLS_IR_FUNCTION_BASE_H_
 #define XLS_IR_FUNCTION_BASE_H_
 
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/common/casts.h"
 #include "xls/common/iterator_range.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/ir/dfs_visitor.h"
+#include "xls/ir/incremental_topo_order.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/structural_hash_index.h"
 #include "xls/ir/type.h"
-#include "xls/ir/unwrapping_iterator.h"
 #include "xls/ir/verifier.h"
 
 namespace xls {
@@ -41,12 +50,72 @@ class Proc;
 // Base class for Functions and Procs. A holder of a set of nodes.
 class FunctionBase {
  protected:
-  using NodeList = std::list<std::unique_ptr<Node>>;
+  // Nodes are held in a table indexed by Node::node_table_index_. Removed nodes
+  // leave null entries (tombstones) until the table is compacted.
+  using NodeTable = std::vector<std::unique_ptr<Node>>;
 
  public:
+  // Iterator over the nodes in insertion order which skips tombstones. The
+  // iterator holds an index into the node table so, as with a linked list,
+  // nodes may be added or removed (other than the one pointed to) while
+  // iterating, and nodes added during iteration are visited. The end iterator
+  // compares equal to any iterator past the current end of the table.
+  // Compacting the table invalidates iterators.
+  class NodeIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Node*;
+    using difference_type = ptrdiff_t;
+    using pointer = Node**;
+    using reference = Node*;
+
+    NodeIterator() = default;
+    NodeIterator(const NodeTable* nodes, int64_t index)
+        : nodes_(nodes), index_(index) {
+      SkipTombstones();
+    }
+
+    Node* operator*() const { return (*nodes_)[index_].get(); }
+    Node* operator->() const { return (*nodes_)[index_].get(); }
+    NodeIterator& operator++() {
+      ++index_;
+      SkipTombstones();
+      return *this;
+    }
+    NodeIterator operator++(int) {
+      NodeIterator temp = *this;
+      operator++();
+      return temp;
+    }
+
+    friend bool operator==(const NodeIterator& a, const NodeIterator& b) {
+      bool a_at_end = a.AtEnd();
+      bool b_at_end = b.AtEnd();
+      if (a_at_end || b_at_end) {
+        return a_at_end == b_at_end;
+      }
+      return a.index_ == b.index_;
+    }
+    friend bool operator!=(const NodeIterator& a, const NodeIterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    bool AtEnd() const {
+      return nodes_ == nullptr || index_ >= static_cast<int64_t>(nodes_->size());
+    }
+    void SkipTombstones() {
+      while (!AtEnd() && (*nodes_)[index_] == nullptr) {
+        ++index_;
+      }
+    }
+
+    const NodeTable* nodes_ = nullptr;
+    int64_t index_ = 0;
+  };
+
   FunctionBase(std::string_view name, Package* package)
-      : name_(name),
-        package_(package) {}
+      : name_(name), package_(package), uid_(NextUid()) {}
   virtual ~FunctionBase() = default;
 
   Package* package() const { return package_; }
@@ -81,18 +150,166 @@ class FunctionBase {
   // Moves the given param to the given index in the parameter list.
   absl::Status MoveParamToIndex(Param* param, int64_t index);
 
-  int64_t node_count() const { return nodes_.size(); }
+  int64_t node_count() const { return nodes_.size() - tombstone_count_; }
+
+  // Returns the size of the node table including tombstones. Every node's
+  // Node::node_table_index() is less than this, so it can be used to size
+  // vectors indexed by node.
+  int64_t node_table_size() const { return nodes_.size(); }
 
   // Expose Nodes, so that transformation passes can operate
   // on this function.
-  xabsl::iterator_range<UnwrappingIterator<NodeList::iterator>> nodes() {
-    return xabsl::make_range(MakeUnwrappingIterator(nodes_.begin()),
-                             MakeUnwrappingIterator(nodes_.end()));
+  xabsl::iterator_range<NodeIterator> nodes() const {
+    return xabsl::make_range(
+        NodeIterator(&nodes_, 0),
+        NodeIterator(&nodes_, std::numeric_limits<int64_t>::max()));
+  }
+
+  // Removes the tombstones left in the node table by removed nodes so that
+  // iteration over the nodes is a dense linear scan. Invalidates node
+  // iterators so must not be called while iterating over nodes(). Passes call
+  // this between transformations via MaybeCompactNodes. Does nothing while a
+  // checkpoint is held.
+  void CompactNodes();
+
+  // Compacts the node table if at least a quarter of its entries are
+  // tombstones.
+  void MaybeCompactNodes() {
+    if (tombstone_count_ > 0 && 4 * tombstone_count_ >= nodes_.size()) {
+      CompactNodes();
+    }
+  }
+
+  // Enables or disables maintenance of a topological order of the nodes which
+  // is updated incrementally as nodes are added, removed, and rewired. While
+  // enabled, TopoSort and ReverseTopoSort return a copy of the maintained order
+  // rather than computing one from scratch. The maintained order is a valid
+  // topological order but after mutations it may differ from the order
+  // TopoSort computes from scratch.
+  void SetIncrementalTopoSortEnabled(bool enabled);
+  bool IsIncrementalTopoSortEnabled() const { return topo_order_ != nullptr; }
+
+  // Returns the incrementally maintained topological order or nullptr if
+  // maintenance is not enabled. The order may be invalid; TopoSort then
+  // recomputes it.
+  IncrementalTopoOrder* incremental_topo_order() const {
+    return topo_order_.get();
+  }
+
+  // Enables or disables maintenance of an index of the nodes by their
+  // structure (see StructuralHashIndex) which makes common subexpression
+  // elimination incremental and enables hash-consing of new nodes with
+  // MakeOrReuseNode.
+  void SetStructuralHashingEnabled(bool enabled);
+  bool IsStructuralHashingEnabled() const {
+    return structural_hash_index_ != nullptr;
+  }
+
+  // Returns the structural hash index or nullptr if maintenance is not
+  // enabled.
+  StructuralHashIndex* structural_hash_index() const {
+    return structural_hash_index_.get();
+  }
+
+  // Enables or disables tracking of the nodes changed by mutations of the
+  // graph: nodes which are added, whose operands or users change, whose id
+  // changes, or which become the next token or next state of a proc. Used by
+  // VerifyPackageIncrementally to re-verify only the changed parts of the
+  // graph. Enabling tracking clears the set of changed nodes.
+  void SetChangeTrackingEnabled(bool enabled);
+  bool IsChangeTrackingEnabled() const { return changed_nodes_.has_value(); }
+
+  // Records that `node` has changed if change tracking is enabled. Always
+  // advances change_count().
+  void NoteNodeChanged(Node* node) {
+    ++change_count_;
+    if (changed_nodes_.has_value()) {
+      changed_nodes_->insert(node);
+    }
+    // Nodes under construction are indexed once they are added.
+    if (structural_hash_index_ != nullptr && node->node_table_index_ >= 0) {
+      structural_hash_index_->NoteNodeChanged(node);
+    }
+  }
+
+  // Returns the nodes changed since change tracking was enabled or the set of
+  // changed nodes was last cleared. Change tracking must be enabled. Removed
+  // nodes are not included.
+  const absl::flat_hash_set<Node*>& changed_nodes() const {
+    return *changed_nodes_;
   }
-  xabsl::iterator_range<UnwrappingIterator<NodeList::const_iterator>> nodes()
-      const {
-    return xabsl::make_range(MakeUnwrappingIterator(nodes_.begin()),
-                             MakeUnwrappingIterator(nodes_.end()));
+  void ClearChangedNodes() { changed_nodes_->clear(); }
+
+  // Returns the id for a new node in this function base: normally the next id
+  // of the package, or the next id of the private range while staging.
+  int64_t AllocateNodeId();
+
+  // While node ids are staged, nodes created in this function base take their
+  // ids from a private range instead of from the package. This is the only
+  // package state (other than the thread-safe type tables) mutated by the
+  // creation of nodes, so nodes may then be created in different function
+  // bases concurrently. EndNodeIdStaging gives the nodes created in the
+  // meantime ids from the package in the order of the node table so the ids
+  // do not depend on the interleaving of concurrent work.
+  void BeginNodeIdStaging();
+  void EndNodeIdStaging();
+  bool IsStagingNodeIds() const { return staged_next_node_id_.has_value(); }
+
+  // Returns an identifier of this function base which is unique among all
+  // function bases created by the process. Unlike pointers, identifiers are
+  // never reused.
+  int64_t uid() const { return uid_; }
+
+  // Returns the number of mutations of the graph made so far (any mutation
+  // noted by NoteNodeChanged and any removal of a node). The count only
+  // increases so the pair (uid(), change_count()) identifies a version of the
+  // graph: if the pair is unchanged then so is the graph.
+  int64_t change_count() const { return change_count_; }
+
+  // Returns a structural fingerprint of the graph: a hash of the types and
+  // canonical text (see Node::ToCanonicalString) of the nodes and of the edges
+  // between them. The fingerprint is unaffected by node names, node ids and
+  // the order of the nodes in the node table, so equal graphs built in
+  // different ways (e.g., a clone) have equal fingerprints. The order of the
+  // parameters, the return value of a function and the next token and next
+  // state of a proc are included. Called functions contribute only their
+  // names. The fingerprint is computed in a single pass over the graph and
+  // cached until change_count() advances.
+  uint64_t GetFingerprint() const;
+
+  // Begins recording an undo log of the mutations of this function base so
+  // they can be reverted with RollbackToCheckpoint without cloning the graph.
+  // The cost of a checkpoint is proportional to the number of nodes touched
+  // while it is held rather than to the size of the function base. While a
+  // checkpoint is held removed nodes are kept alive and the node table is not
+  // compacted. Only one checkpoint may be held at a time. Blocks are not
+  // supported.
+  //
+  // The graph structure (operands, users, ids, names and source locations of
+  // nodes), the set of nodes, the parameters and the function return value or
+  // proc next token, next state and initial values are restored. Other
+  // attributes of nodes (e.g., the channel of a send or receive) and the name
+  // of the function base are not. Names handed out by the name uniquer while
+  // the checkpoint is held remain reserved after a rollback.
+  absl::Status Checkpoint();
+
+  // Reverts all mutations made since Checkpoint and releases the checkpoint.
+  // Nodes added since the checkpoint are destroyed. Invalidates node iterators
+  // and the incrementally maintained topological order, if any.
+  absl::Status RollbackToCheckpoint();
+
+  // Releases the checkpoint keeping all mutations made since Checkpoint.
+  absl::Status CommitCheckpoint();
+
+  bool HasCheckpoint() const { return checkpoint_ != nullptr; }
+
+  // Saves the state of `node` in the undo log, if a checkpoint is held and the
+  // state of `node` has not already been saved. Must be called before `node`
+  // is mutated.
+  void SaveNodeForRollback(Node* node) {
+    if (checkpoint_ != nullptr) {
+      SaveNodeForRollbackInternal(node);
+    }
   }
 
   // Adds a node to the set owned by this function.
@@ -124,6 +341,21 @@ class FunctionBase {
     return new_node;
   }
 
+  // Like MakeNode but if structural hashing is enabled and the function base
+  // already contains a node structurally equal to the new node, returns the
+  // existing node instead (hash-consing).
+  template <typename NodeT, typename... Args>
+  absl::StatusOr<NodeT*> MakeOrReuseNode(Args&&... args) {
+    XLS_ASSIGN_OR_RETURN(NodeT * new_node,
+                         MakeNode<NodeT>(std::forward<Args>(args)...));
+    return down_cast<NodeT*>(ReuseEquivalentNode(new_node));
+  }
+
+  // If structural hashing is enabled and the function base contains a node
+  // structurally equal to `node` which has no users, removes `node` and
+  // returns the equal node. Otherwise returns `node`.
+  Node* ReuseEquivalentNode(Node* node);
+
   // Find a node by its name, as generated by DumpIr.
   absl::StatusOr<Node*> GetNode(std::string_view standard_node_name) const;
 
@@ -143,6 +375,18 @@ class FunctionBase {
     return node_name_uniquer_.GetSanitizedUniqueName(name);
   }
 
+  // Defers the sanitizing and uniquing of node names. Until FinalizeNodeNames
+  // is called, nodes other than params which are given a name keep it verbatim
+  // (so names may collide). FinalizeNodeNames then uniquifies the deferred
+  // names in node order. Used for bulk construction of large graphs (see
+  // BuilderBase::EnableBulkConstruction).
+  void DeferNodeNames() { node_names_deferred_ = true; }
+  bool NodeNamesDeferred() const { return node_names_deferred_; }
+  void FinalizeNodeNames();
+
+  // Reserves space in the node table for `count` nodes.
+  void ReserveNodes(int64_t count) { nodes_.reserve(count); }
+
   // Returns whether this FunctionBase is a function, proc, or block.
   bool IsFunction() const;
   bool IsProc() const;
@@ -168,20 +412,70 @@ class FunctionBase {
   // Returns a vector containing the reserved words in the IR.
   static std::vector<std::string> GetIrReservedWords();
 
+  // Returns a function which restores the state held by the subclass (e.g.,
+  // the return value of a function) to its current value. Called by
+  // Checkpoint.
+  virtual std::function<void()> SaveStateForRollback() { return []() {}; }
+
+  // The state of a node saved by SaveNodeForRollback.
+  struct SavedNode {
+    std::vector<Node*> operands;
+    NodeUserSet users;
+    std::string name;
+    int64_t id;
+    SourceInfo loc;
+  };
+
+  // The undo log recorded while a checkpoint is held. Nodes whose node table
+  // index is at least `node_table_size` were added after the checkpoint.
+  struct CheckpointLog {
+    int64_t node_table_size;
+    int64_t tombstone_count;
+    std::vector<Param*> params;
+    std::function<void()> restore_state;
+    absl::flat_hash_map<Node*, SavedNode> saved_nodes;
+    std::vector<std::unique_ptr<Node>> removed_nodes;
+  };
+
+  void SaveNodeForRollbackInternal(Node* node);
+
+  static int64_t NextUid();
+
   std::string name_;
   Package* package_;
+  int64_t uid_;
+  int64_t change_count_ = 0;
+
+  // The last computed fingerprint and the change count it was computed at.
+  mutable std::optional<std::pair<int64_t, uint64_t>> cached_fingerprint_;
+
+  // The next id of the private range while node ids are staged.
+  std::optional<int64_t> staged_next_node_id_;
   std::optional<int64_t> initiation_interval_;
 
-  // Store Nodes in std::list as they can be added and removed arbitrarily and
-  // we want a stable iteration order. Keep a map from instruction pointer to
-  // location in the list for fast lookup.
-  NodeList nodes_;
-  absl::flat_hash_map<const Node*, NodeList::iterator> node_iterators_;
+  // Nodes may be added and removed arbitrarily and we want a stable iteration
+  // order and cheap iteration. Nodes are appended to the table and removal
+  // replaces the entry with a tombstone; each node records its own index so
+  // removal requires no lookup.
+  NodeTable nodes_;
+  int64_t tombstone_count_ = 0;
 
   std::vector<Param*> params_;
 
+  std::unique_ptr<IncrementalTopoOrder> topo_order_;
+
+  std::unique_ptr<StructuralHashIndex> structural_hash_index_;
+
+  // The nodes changed since the last ClearChangedNodes. Present only while
+  // change tracking is enabled.
+  std::optional<absl::flat_hash_set<Node*>> changed_nodes_;
+
+  // The undo log of the checkpoint held, if any.
+  std::unique_ptr<CheckpointLog> checkpoint_;
+
   NameUniquer node_name_uniquer_ =
       NameUniquer(/*separator=*/"__", GetIrReservedWords());
+  bool node_names_deferred_ = false;
 };
 
 std::ostream& operator<<(std::ostream& os, const FunctionBase& function);
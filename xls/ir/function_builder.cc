@@ -71,7 +71,7 @@ BValue BValue::operator-() { return builder()->Negate(*this); }
 
 BValue BuilderBase::CreateBValue(Node* node, const SourceInfo& loc) {
   last_node_ = node;
-  if (should_verify_) {
+  if (should_verify_ && !bulk_construction_) {
     absl::Status verify_status = VerifyNode(last_node_);
     if (!verify_status.ok()) {
       return SetError(verify_status.message(), loc);
@@ -84,6 +84,11 @@ template <typename NodeT, typename... Args>
 BValue BuilderBase::AddNode(const SourceInfo& loc, Args&&... args) {
   last_node_ = function_->AddNode<NodeT>(std::make_unique<NodeT>(
       loc, std::forward<Args>(args)..., function_.get()));
+  // With structural hashing enabled, reuse an existing equivalent node unless
+  // the new node was explicitly named.
+  if (!last_node_->HasAssignedName()) {
+    last_node_ = function_->ReuseEquivalentNode(last_node_);
+  }
   return CreateBValue(last_node_, loc);
 }
 
@@ -947,6 +952,7 @@ absl::StatusOr<Function*> FunctionBuilder::BuildWithReturnValue(
     return absl::InvalidArgumentError("Could not build IR: " + msg);
   }
   XLS_RET_CHECK_EQ(return_value.builder(), this);
+  function_->FinalizeNodeNames();
   // down_cast the FunctionBase* to Function*. We know this is safe because
   // FunctionBuilder constructs and passes a Function to BuilderBase
   // constructor so function_ is always a Function.
@@ -1000,6 +1006,7 @@ absl::StatusOr<Proc*> ProcBuilder::Build(BValue token,
     }
   }
 
+  function_->FinalizeNodeNames();
   // down_cast the FunctionBase* to Proc*. We know this is safe because
   // ProcBuilder constructs and passes a Proc to BuilderBase constructor so
   // function_ is always a Proc.
@@ -1045,6 +1052,15 @@ BuilderBase::BuilderBase(std::unique_ptr<FunctionBase> function,
 
 BuilderBase::~BuilderBase() = default;
 
+void BuilderBase::EnableBulkConstruction(int64_t expected_node_count) {
+  bulk_construction_ = true;
+  function_->ReserveNodes(expected_node_count);
+  // Block ports are named strongly, so names are only deferred outside blocks.
+  if (!function_->IsBlock()) {
+    function_->DeferNodeNames();
+  }
+}
+
 Package* BuilderBase::package() const { return function_->package(); }
 
 BValue BuilderBase::AddArithOp(Op op, BValue lhs, BValue rhs,
@@ -125,6 +125,16 @@ class BuilderBase {
   // Get access to currently built up function (or proc).
   FunctionBase* function() const { return function_.get(); }
 
+  // Enables bulk construction, for generators which build very large graphs.
+  // Nodes are then not verified as they are added; the whole function is
+  // verified once when it is built instead, so errors the per-node check
+  // would have caught are reported by Build(). For functions and procs the
+  // names given to nodes are also only sanitized and uniquified by Build(),
+  // and are returned verbatim by GetName until then. Space for
+  // `expected_node_count` nodes is reserved up front. Should be called before
+  // any node is added.
+  void EnableBulkConstruction(int64_t expected_node_count = 0);
+
   // Declares a parameter to the function being built of type "type".
   virtual BValue Param(std::string_view name, Type* type,
                        const SourceInfo& loc = SourceInfo()) = 0;
@@ -606,6 +616,10 @@ class BuilderBase {
   // tests.
   bool should_verify_;
 
+  // Whether the verification of individual nodes is deferred to the
+  // verification of the built function. See EnableBulkConstruction.
+  bool bulk_construction_ = false;
+
   std::string error_msg_;
   std::string error_stacktrace_;
   SourceInfo error_loc_;
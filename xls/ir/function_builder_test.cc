@@ -1009,4 +1009,53 @@ TEST(FunctionBuilderTest, Registers) {
   EXPECT_THAT(get_reg_write(x_3)->load_enable().value(), m::InputPort("le"));
 }
 
+// Builds a chain of `length` adds accumulating `x`, named alternately "sum"
+// and "acc".
+absl::StatusOr<Function*> BuildSumChain(Package* p, int64_t length,
+                                        bool bulk) {
+  FunctionBuilder b("f", p);
+  if (bulk) {
+    b.EnableBulkConstruction(/*expected_node_count=*/length + 1);
+  }
+  BValue x = b.Param("x", p->GetBitsType(32));
+  BValue sum = x;
+  for (int64_t i = 0; i < length; ++i) {
+    sum = b.Add(sum, x, SourceInfo(), i % 2 == 0 ? "sum" : "acc");
+  }
+  return b.Build();
+}
+
+TEST(FunctionBuilderTest, BulkConstructionMatchesRegularConstruction) {
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * regular,
+                           BuildSumChain(&p, /*length=*/100, /*bulk=*/false));
+  Package bulk_p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Function * bulk, BuildSumChain(&bulk_p, /*length=*/100, /*bulk=*/true));
+  EXPECT_EQ(bulk->DumpIr(), regular->DumpIr());
+}
+
+TEST(FunctionBuilderTest, BulkConstructionDefersNames) {
+  Package p("p");
+  FunctionBuilder b("f", &p);
+  b.EnableBulkConstruction();
+  BValue x = b.Param("x", p.GetBitsType(32));
+  BValue a = b.Not(x, SourceInfo(), "y");
+  BValue c = b.Not(a, SourceInfo(), "y");
+  EXPECT_EQ(x.GetName(), "x");
+  EXPECT_EQ(a.GetName(), "y");
+  EXPECT_EQ(c.GetName(), "y");
+  XLS_ASSERT_OK(b.Build().status());
+  EXPECT_EQ(a.GetName(), "y");
+  EXPECT_EQ(c.GetName(), "y__1");
+}
+
+TEST(FunctionBuilderTest, BulkConstructionLargeGraph) {
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           BuildSumChain(&p, /*length=*/100000, /*bulk=*/true));
+  EXPECT_EQ(f->node_count(), 100001);
+  EXPECT_EQ(f->return_value()->GetName(), "acc__49999");
+}
+
 }  // namespace xls
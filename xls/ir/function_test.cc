@@ -220,6 +220,57 @@ TEST_F(FunctionTest, MoveParams) {
   EXPECT_EQ(func->params()[2]->GetName(), "y");
 }
 
+TEST_F(FunctionTest, NodeTableTombstonesAndCompaction) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[32]) -> bits[32] {
+  a: bits[32] = neg(x)
+  b: bits[32] = not(x)
+  c: bits[32] = neg(x)
+  ret d: bits[32] = add(x, x)
+}
+)",
+                                                       p.get()));
+  auto node_names = [&]() {
+    std::vector<std::string> names;
+    for (Node* node : f->nodes()) {
+      names.push_back(node->GetName());
+    }
+    return names;
+  };
+  EXPECT_EQ(f->node_count(), 5);
+  EXPECT_THAT(node_names(), ElementsAre("x", "a", "b", "c", "d"));
+
+  // Removed nodes are skipped by iteration, including while iterating.
+  XLS_ASSERT_OK(f->RemoveNode(FindNode("a", f)));
+  for (Node* node : f->nodes()) {
+    if (node->GetName() == "b") {
+      XLS_ASSERT_OK(f->RemoveNode(FindNode("c", f)));
+    }
+  }
+  EXPECT_EQ(f->node_count(), 3);
+  EXPECT_THAT(node_names(), ElementsAre("x", "b", "d"));
+
+  // Nodes added during iteration are visited.
+  int64_t visited = 0;
+  for (Node* node : f->nodes()) {
+    ++visited;
+    if (node->GetName() == "d") {
+      XLS_ASSERT_OK(
+          f->MakeNodeWithName<UnOp>(SourceInfo(), node, Op::kNot, "e")
+              .status());
+    }
+  }
+  EXPECT_EQ(visited, 4);
+
+  // Compaction preserves the order of the remaining nodes.
+  f->CompactNodes();
+  EXPECT_EQ(f->node_count(), 4);
+  EXPECT_THAT(node_names(), ElementsAre("x", "b", "d", "e"));
+  XLS_ASSERT_OK(f->RemoveNode(FindNode("e", f)));
+  EXPECT_THAT(node_names(), ElementsAre("x", "b", "d"));
+}
+
 TEST_F(FunctionTest, MakeInvalidNode) {
   Package p(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(Function * func, ParseFunction(R"(
@@ -357,6 +408,90 @@ TEST_F(FunctionTest, CloneInvokeForRemap) {
   EXPECT_EQ(invoke_b_clone->to_apply(), apply_b);
 }
 
+TEST_F(FunctionTest, FingerprintIgnoresNamesAndIds) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  one: bits[32] = literal(value=1, id=3)
+  sum: bits[32] = add(x, y, id=4)
+  ret result: bits[32] = sub(sum, one, id=5)
+}
+)",
+                                                       p.get()));
+  // The same graph with the nodes in a different order and with other names
+  // and ids.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, ParseFunction(R"(
+fn g(x: bits[32], y: bits[32]) -> bits[32] {
+  add.20: bits[32] = add(x, y, id=20)
+  literal.10: bits[32] = literal(value=1, id=10)
+  ret sub.30: bits[32] = sub(add.20, literal.10, id=30)
+}
+)",
+                                                       p.get()));
+  EXPECT_EQ(f->GetFingerprint(), g->GetFingerprint());
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * clone, f->Clone("clone"));
+  EXPECT_EQ(f->GetFingerprint(), clone->GetFingerprint());
+}
+
+TEST_F(FunctionTest, FingerprintReflectsStructure) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret sub.3: bits[32] = sub(x, y, id=3)
+}
+)",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * swapped_operands, ParseFunction(R"(
+fn swapped_operands(x: bits[32], y: bits[32]) -> bits[32] {
+  ret sub.3: bits[32] = sub(y, x, id=3)
+}
+)",
+                                                                      p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * other_op, ParseFunction(R"(
+fn other_op(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(x, y, id=3)
+}
+)",
+                                                              p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * dead_node, ParseFunction(R"(
+fn dead_node(x: bits[32], y: bits[32]) -> bits[32] {
+  add.3: bits[32] = add(x, y, id=3)
+  ret sub.4: bits[32] = sub(x, y, id=4)
+}
+)",
+                                                               p.get()));
+  EXPECT_NE(f->GetFingerprint(), swapped_operands->GetFingerprint());
+  EXPECT_NE(f->GetFingerprint(), other_op->GetFingerprint());
+  EXPECT_NE(f->GetFingerprint(), dead_node->GetFingerprint());
+}
+
+TEST_F(FunctionTest, FingerprintUpdatedAfterMutation) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(x, y, id=3)
+}
+)",
+                                                       p.get()));
+  uint64_t original = f->GetFingerprint();
+  EXPECT_EQ(f->GetFingerprint(), original);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg, f->MakeNode<UnOp>(SourceInfo(), f->return_value(), Op::kNeg));
+  XLS_ASSERT_OK(f->set_return_value(neg));
+  uint64_t mutated = f->GetFingerprint();
+  EXPECT_NE(mutated, original);
+
+  // The fingerprint is that of the graph as it now is.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * clone, f->Clone("clone"));
+  EXPECT_EQ(clone->GetFingerprint(), mutated);
+
+  XLS_ASSERT_OK(f->set_return_value(neg->operand(0)));
+  XLS_ASSERT_OK(f->RemoveNode(neg));
+  EXPECT_EQ(f->GetFingerprint(), original);
+}
+
 TEST_F(FunctionTest, IrReservedWordIdentifiers) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
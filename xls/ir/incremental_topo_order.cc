@@ -0,0 +1,199 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/incremental_topo_order.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+
+#include "absl/container/flat_hash_set.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+void IncrementalTopoOrder::Reset(absl::Span<Node* const> order) {
+  order_.assign(order.begin(), order.end());
+  hole_count_ = 0;
+  position_.clear();
+  position_.reserve(order_.size());
+  for (int64_t i = 0; i < order_.size(); ++i) {
+    position_[order_[i]] = i;
+  }
+  valid_ = true;
+}
+
+void IncrementalTopoOrder::Invalidate() {
+  valid_ = false;
+  order_.clear();
+  hole_count_ = 0;
+  position_.clear();
+}
+
+void IncrementalTopoOrder::AddNode(Node* node) {
+  if (!valid_) {
+    return;
+  }
+  position_[node] = order_.size();
+  order_.push_back(node);
+}
+
+void IncrementalTopoOrder::RemoveNode(Node* node) {
+  if (!valid_) {
+    return;
+  }
+  auto it = position_.find(node);
+  if (it == position_.end()) {
+    // The node was never added to the order which should not happen.
+    XLS_LOG(WARNING) << "Removed node " << node->GetName()
+                     << " is not in the topological order";
+    Invalidate();
+    return;
+  }
+  order_[it->second] = nullptr;
+  position_.erase(it);
+  ++hole_count_;
+  if (2 * hole_count_ > order_.size()) {
+    Compact();
+  }
+}
+
+void IncrementalTopoOrder::AddEdge(Node* operand, Node* user) {
+  if (!valid_) {
+    return;
+  }
+  // The user may not be in the order yet if it is under construction. It will
+  // be appended after all of its operands when it is added.
+  auto user_it = position_.find(user);
+  if (user_it == position_.end()) {
+    return;
+  }
+  const int64_t lower_bound = user_it->second;
+  const int64_t upper_bound = position_.at(operand);
+  if (upper_bound < lower_bound) {
+    return;
+  }
+  if (upper_bound == lower_bound) {
+    // Self edge.
+    Invalidate();
+    return;
+  }
+
+  // Find the nodes in the affected region [lower_bound, upper_bound] which are
+  // reachable from `user` (forward) or reach `operand` (backward).
+  absl::flat_hash_set<Node*> visited;
+  std::vector<Node*> forward = {user};
+  std::vector<Node*> worklist = {user};
+  visited.insert(user);
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* next : node->users()) {
+      auto it = position_.find(next);
+      if (it == position_.end() || it->second > upper_bound) {
+        continue;
+      }
+      if (it->second == upper_bound) {
+        // `operand` is reachable from `user` so the new edge closes a cycle.
+        Invalidate();
+        return;
+      }
+      if (visited.insert(next).second) {
+        forward.push_back(next);
+        worklist.push_back(next);
+      }
+    }
+  }
+  std::vector<Node*> backward = {operand};
+  worklist = {operand};
+  visited.insert(operand);
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* next : node->operands()) {
+      if (position_.at(next) < lower_bound) {
+        continue;
+      }
+      if (visited.insert(next).second) {
+        backward.push_back(next);
+        worklist.push_back(next);
+      }
+    }
+  }
+
+  // Reassign the positions held by the affected nodes such that the backward
+  // set precedes the forward set, preserving the relative order within each.
+  auto by_position = [&](Node* a, Node* b) {
+    return position_.at(a) < position_.at(b);
+  };
+  std::sort(forward.begin(), forward.end(), by_position);
+  std::sort(backward.begin(), backward.end(), by_position);
+  std::vector<int64_t> positions;
+  positions.reserve(forward.size() + backward.size());
+  for (Node* node : backward) {
+    positions.push_back(position_.at(node));
+  }
+  for (Node* node : forward) {
+    positions.push_back(position_.at(node));
+  }
+  std::inplace_merge(positions.begin(), positions.begin() + backward.size(),
+                     positions.end());
+  int64_t i = 0;
+  for (Node* node : backward) {
+    order_[positions[i]] = node;
+    position_[node] = positions[i++];
+  }
+  for (Node* node : forward) {
+    order_[positions[i]] = node;
+    position_[node] = positions[i++];
+  }
+}
+
+std::optional<int64_t> IncrementalTopoOrder::GetPosition(Node* node) const {
+  auto it = position_.find(node);
+  if (it == position_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+std::vector<Node*> IncrementalTopoOrder::GetOrder(bool reverse) const {
+  XLS_CHECK(valid_);
+  std::vector<Node*> result;
+  result.reserve(order_.size() - hole_count_);
+  if (reverse) {
+    std::copy_if(order_.rbegin(), order_.rend(), std::back_inserter(result),
+                 [](Node* n) { return n != nullptr; });
+  } else {
+    std::copy_if(order_.begin(), order_.end(), std::back_inserter(result),
+                 [](Node* n) { return n != nullptr; });
+  }
+  return result;
+}
+
+void IncrementalTopoOrder::Compact() {
+  int64_t next = 0;
+  for (Node* node : order_) {
+    if (node != nullptr) {
+      position_[node] = next;
+      order_[next++] = node;
+    }
+  }
+  order_.resize(next);
+  hole_count_ = 0;
+}
+
+}  // namespace xls
@@ -0,0 +1,87 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_INCREMENTAL_TOPO_ORDER_H_
+#define XLS_IR_INCREMENTAL_TOPO_ORDER_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+class Node;
+
+// A topological order of the nodes of a FunctionBase which is maintained
+// incrementally as the graph is mutated, using the dynamic topological sort
+// algorithm of Pearce and Kelly ("A Dynamic Topological Sort Algorithm for
+// Directed Acyclic Graphs", JEA 2007).
+//
+// Added nodes are appended to the order; a newly created node has no users so
+// this is always valid. Removed nodes leave holes which are compacted away
+// periodically. When an edge from an operand to a user is added which violates
+// the order, only the nodes between the two endpoints which are reachable
+// from (or reach) the endpoints are reordered.
+//
+// The order is invalid until Reset is called with a complete order, and
+// becomes invalid if an added edge creates a cycle. While invalid, updates are
+// ignored.
+class IncrementalTopoOrder {
+ public:
+  // Sets the order to `order` which must be a topological order of all nodes
+  // in the graph.
+  void Reset(absl::Span<Node* const> order);
+
+  // Marks the order as invalid.
+  void Invalidate();
+
+  bool valid() const { return valid_; }
+
+  // Updates the order after `node` has been added to the graph. `node` must
+  // have no users which are in the order.
+  void AddNode(Node* node);
+
+  // Updates the order after `node` has been removed from the graph.
+  void RemoveNode(Node* node);
+
+  // Updates the order after `user` has become a user of `operand`.
+  void AddEdge(Node* operand, Node* user);
+
+  // Returns the position of `node` in the order, or std::nullopt if it is not
+  // in the order. A node precedes the nodes with greater positions. The order
+  // must be valid.
+  std::optional<int64_t> GetPosition(Node* node) const;
+
+  // Returns the nodes in topological (or reverse topological) order. The order
+  // must be valid.
+  std::vector<Node*> GetOrder(bool reverse = false) const;
+
+ private:
+  // Removes holes left by removed nodes from `order_`.
+  void Compact();
+
+  bool valid_ = false;
+  // The nodes in topological order. Removed nodes leave nullptr entries.
+  std::vector<Node*> order_;
+  int64_t hole_count_ = 0;
+  // The index of each node in `order_`.
+  absl::flat_hash_map<Node*, int64_t> position_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_INCREMENTAL_TOPO_ORDER_H_
@@ -17,11 +17,14 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
-#include <list>
+#include <iterator>
+#include <limits>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/optional.h"
@@ -33,6 +36,85 @@
 #include "xls/ir/interval.h"
 
 namespace xls {
+namespace {
+
+// Intervals of at most 64 bits as inclusive (lower, upper) bound pairs, which
+// compare and sort far more cheaply than pairs of `Bits`.
+using FastInterval = std::pair<uint64_t, uint64_t>;
+using FastIntervals = absl::InlinedVector<FastInterval, 8>;
+
+// Appends `interval` to `intervals`, splitting it into two proper intervals if
+// it is improper.
+void AppendFastInterval(const Interval& interval, int64_t bit_count,
+                        FastIntervals* intervals) {
+  uint64_t lower = interval.LowerBound().ToUint64().value();
+  uint64_t upper = interval.UpperBound().ToUint64().value();
+  if (upper < lower) {
+    uint64_t max = bit_count == 64 ? std::numeric_limits<uint64_t>::max()
+                                   : (uint64_t{1} << bit_count) - 1;
+    intervals->push_back({0, upper});
+    intervals->push_back({lower, max});
+  } else {
+    intervals->push_back({lower, upper});
+  }
+}
+
+// Converts the proper intervals of a normalized interval set.
+FastIntervals ToFastIntervals(absl::Span<const Interval> intervals) {
+  FastIntervals result;
+  result.reserve(intervals.size());
+  for (const Interval& interval : intervals) {
+    result.push_back({interval.LowerBound().ToUint64().value(),
+                      interval.UpperBound().ToUint64().value()});
+  }
+  return result;
+}
+
+std::vector<Interval> FromFastIntervals(const FastIntervals& intervals,
+                                        int64_t bit_count) {
+  std::vector<Interval> result;
+  result.reserve(intervals.size());
+  for (const FastInterval& interval : intervals) {
+    result.push_back(Interval(UBits(interval.first, bit_count),
+                              UBits(interval.second, bit_count)));
+  }
+  return result;
+}
+
+// Merges overlapping or abutting neighbours of the given sorted proper
+// intervals in place.
+void CoalesceSorted(FastIntervals* intervals) {
+  if (intervals->empty()) {
+    return;
+  }
+  auto last = intervals->begin();
+  for (auto it = std::next(last); it != intervals->end(); ++it) {
+    if (last->second == std::numeric_limits<uint64_t>::max() ||
+        it->first <= last->second + 1) {
+      last->second = std::max(last->second, it->second);
+    } else {
+      *++last = *it;
+    }
+  }
+  intervals->erase(std::next(last), intervals->end());
+}
+
+void CoalesceSorted(std::vector<Interval>* intervals) {
+  if (intervals->empty()) {
+    return;
+  }
+  auto last = intervals->begin();
+  for (auto it = std::next(last); it != intervals->end(); ++it) {
+    if (Interval::Overlaps(*last, *it) || Interval::Abuts(*last, *it)) {
+      *last = Interval::ConvexHull(*last, *it);
+    } else {
+      *++last = std::move(*it);
+    }
+  }
+  intervals->erase(std::next(last), intervals->end());
+}
+
+}  // namespace
 
 IntervalSet IntervalSet::Maximal(int64_t bit_count) {
   IntervalSet result(bit_count);
@@ -63,9 +145,26 @@ void IntervalSet::SetIntervals(absl::Span<const Interval> intervals) {
 }
 
 void IntervalSet::Normalize() {
+  if (is_normalized_) {
+    return;
+  }
+  if (BitCount() <= 64) {
+    FastIntervals fast;
+    fast.reserve(intervals_.size());
+    for (const Interval& interval : intervals_) {
+      AppendFastInterval(interval, BitCount(), &fast);
+    }
+    std::sort(fast.begin(), fast.end());
+    CoalesceSorted(&fast);
+    intervals_ = FromFastIntervals(fast, BitCount());
+    is_normalized_ = true;
+    return;
+  }
+
   Bits zero(BitCount());
   Bits max = Bits::AllOnes(BitCount());
   std::vector<Interval> expand_improper;
+  expand_improper.reserve(intervals_.size());
   for (const Interval& interval : intervals_) {
     if (interval.IsImproper()) {
       expand_improper.push_back(Interval(zero, interval.UpperBound()));
@@ -76,19 +175,8 @@ void IntervalSet::Normalize() {
   }
 
   std::sort(expand_improper.begin(), expand_improper.end());
-
-  intervals_.clear();
-  for (int32_t i = 0; i < expand_improper.size();) {
-    Interval interval = expand_improper[i];
-    while ((i < expand_improper.size()) &&
-           (Interval::Overlaps(interval, expand_improper[i]) ||
-            Interval::Abuts(interval, expand_improper[i]))) {
-      interval = Interval::ConvexHull(interval, expand_improper[i]);
-      ++i;
-    }
-    intervals_.push_back(interval);
-  }
-
+  CoalesceSorted(&expand_improper);
+  intervals_ = std::move(expand_improper);
   is_normalized_ = true;
 }
 
@@ -159,13 +247,35 @@ IntervalSet IntervalSet::Combine(const IntervalSet& lhs,
                                  const IntervalSet& rhs) {
   XLS_CHECK_EQ(lhs.BitCount(), rhs.BitCount());
   IntervalSet combined(lhs.BitCount());
-  for (const Interval& interval : lhs.intervals_) {
-    combined.AddInterval(interval);
+  if (!lhs.is_normalized_ || !rhs.is_normalized_) {
+    combined.intervals_.reserve(lhs.intervals_.size() + rhs.intervals_.size());
+    for (const Interval& interval : lhs.intervals_) {
+      combined.AddInterval(interval);
+    }
+    for (const Interval& interval : rhs.intervals_) {
+      combined.AddInterval(interval);
+    }
+    combined.Normalize();
+    return combined;
   }
-  for (const Interval& interval : rhs.intervals_) {
-    combined.AddInterval(interval);
+
+  // Both sides are already sorted, so merging them and coalescing neighbours
+  // normalizes the union without sorting again.
+  if (lhs.BitCount() <= 64) {
+    FastIntervals lhs_fast = ToFastIntervals(lhs.intervals_);
+    FastIntervals rhs_fast = ToFastIntervals(rhs.intervals_);
+    FastIntervals merged(lhs_fast.size() + rhs_fast.size());
+    std::merge(lhs_fast.begin(), lhs_fast.end(), rhs_fast.begin(),
+               rhs_fast.end(), merged.begin());
+    CoalesceSorted(&merged);
+    combined.intervals_ = FromFastIntervals(merged, lhs.BitCount());
+  } else {
+    combined.intervals_.resize(lhs.intervals_.size() + rhs.intervals_.size());
+    std::merge(lhs.intervals_.begin(), lhs.intervals_.end(),
+               rhs.intervals_.begin(), rhs.intervals_.end(),
+               combined.intervals_.begin());
+    CoalesceSorted(&combined.intervals_);
   }
-  combined.Normalize();
   return combined;
 }
 
@@ -174,56 +284,45 @@ IntervalSet IntervalSet::Intersect(const IntervalSet& lhs,
   XLS_CHECK_EQ(lhs.BitCount(), rhs.BitCount());
   XLS_CHECK(lhs.is_normalized_);
   XLS_CHECK(rhs.is_normalized_);
+  // Both sides are sorted, disjoint and non-abutting, so a single sweep which
+  // always advances past the interval ending first yields pieces which are
+  // themselves sorted, disjoint and non-abutting, i.e., already normalized.
   IntervalSet result(lhs.BitCount());
-  std::list<Interval> lhs_intervals(lhs.Intervals().begin(),
-                                    lhs.Intervals().end());
-  std::list<Interval> rhs_intervals(rhs.Intervals().begin(),
-                                    rhs.Intervals().end());
-  auto left = lhs_intervals.begin();
-  auto right = rhs_intervals.begin();
-  // lhs/rhs_intervals should be sorted in increasing lexicographic order
-  // (i.e.: compare on lower bound, then upper bound if lower bounds are equal)
-  // at this point, since we CHECK that they are normalized.
-  while ((left != lhs_intervals.end()) && (right != rhs_intervals.end())) {
-    if (bits_ops::ULessThan(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*right, *left);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          right = rhs_intervals.insert(right, remainder);
-        }
+  if (lhs.BitCount() <= 64) {
+    FastIntervals lhs_fast = ToFastIntervals(lhs.intervals_);
+    FastIntervals rhs_fast = ToFastIntervals(rhs.intervals_);
+    FastIntervals intersection;
+    auto left = lhs_fast.begin();
+    auto right = rhs_fast.begin();
+    while (left != lhs_fast.end() && right != rhs_fast.end()) {
+      uint64_t lower = std::max(left->first, right->first);
+      uint64_t upper = std::min(left->second, right->second);
+      if (lower <= upper) {
+        intersection.push_back({lower, upper});
       }
-      ++left;
-      continue;
-    }
-    if (bits_ops::ULessThan(right->UpperBound(), left->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-        // The difference should only ever contain 0 or 1 interval.
-        std::vector<Interval> difference = Interval::Difference(*left, *right);
-        std::reverse(difference.begin(), difference.end());
-        for (const Interval& remainder : difference) {
-          left = lhs_intervals.insert(left, remainder);
-        }
+      if (left->second < right->second) {
+        ++left;
+      } else {
+        ++right;
       }
-      ++right;
-      continue;
     }
-    if (bits_ops::UEqual(left->UpperBound(), right->UpperBound())) {
-      if (std::optional<Interval> intersection =
-              Interval::Intersect(*left, *right)) {
-        result.AddInterval(*intersection);
-      }
+    result.intervals_ = FromFastIntervals(intersection, lhs.BitCount());
+    return result;
+  }
+
+  auto left = lhs.intervals_.begin();
+  auto right = rhs.intervals_.begin();
+  while (left != lhs.intervals_.end() && right != rhs.intervals_.end()) {
+    if (std::optional<Interval> intersection =
+            Interval::Intersect(*left, *right)) {
+      result.intervals_.push_back(*intersection);
+    }
+    if (bits_ops::ULessThan(left->UpperBound(), right->UpperBound())) {
       ++left;
+    } else {
       ++right;
-      continue;
     }
   }
-  result.Normalize();
   return result;
 }
 
@@ -99,6 +99,8 @@ class IntervalSet {
   // 5. The result of a call to `Intervals()` has the smallest possible size
   //    of any set of intervals representing the same set of points that
   //    contains no improper intervals (hence the name "normalization").
+  //
+  // Normalizing an already normalized set is a no-op.
   void Normalize();
 
   // Return the smallest single proper interval that contains all points in this
@@ -120,7 +122,7 @@ class IntervalSet {
   bool ForEachElement(std::function<bool(const Bits&)> callback) const;
 
   // Returns a normalized set of intervals comprising the union of the two given
-  // interval sets.
+  // interval sets. If both are normalized, this is a linear merge.
   static IntervalSet Combine(const IntervalSet& lhs, const IntervalSet& rhs);
 
   // Returns a normalized set of intervals comprising the intersection of the
@@ -196,6 +196,73 @@ TEST(IntervalTest, Intersect) {
   }
 }
 
+TEST(IntervalTest, NormalizedCombineAndIntersectMatchSets) {
+  // Normalized operands take the merging paths; compare them against the
+  // same operations on unnormalized copies and on explicit point sets.
+  int64_t seed = 20221015;
+  for (int64_t i = 0; i < 30; ++i) {
+    IntervalSet lhs = IntervalSet::Random(seed, 10, 6);
+    IntervalSet rhs = IntervalSet::Random(seed + 1, 10, 6);
+    seed = seed + 2;
+
+    IntervalSet unnormalized_lhs(10);
+    for (const Interval& interval : lhs.Intervals()) {
+      unnormalized_lhs.AddInterval(interval);
+    }
+    EXPECT_EQ(IntervalSet::Combine(lhs, rhs),
+              IntervalSet::Combine(unnormalized_lhs, rhs));
+
+    absl::flat_hash_set<Bits> union_set;
+    absl::flat_hash_set<Bits> lhs_set;
+    lhs.ForEachElement([&](const Bits& bits) -> bool {
+      lhs_set.insert(bits);
+      union_set.insert(bits);
+      return false;
+    });
+    int64_t intersection_size = 0;
+    rhs.ForEachElement([&](const Bits& bits) -> bool {
+      intersection_size += lhs_set.contains(bits) ? 1 : 0;
+      union_set.insert(bits);
+      return false;
+    });
+    EXPECT_EQ(IntervalSet::Combine(lhs, rhs).Size().value(),
+              static_cast<int64_t>(union_set.size()));
+    EXPECT_EQ(IntervalSet::Intersect(lhs, rhs).Size().value(),
+              intersection_size);
+  }
+}
+
+TEST(IntervalTest, WideAndEdgeIntervals) {
+  // 64 bits is the widest width using native integers; 65 bits and up use
+  // `Bits` comparisons. Both must agree at the top of the range.
+  for (int64_t width : {64, 65, 128}) {
+    Bits max = Bits::AllOnes(width);
+    Bits max_minus_one = max.UpdateWithSet(0, false);
+    IntervalSet wrapping(width);
+    wrapping.AddInterval(Interval(max_minus_one, UBits(3, width)));
+    wrapping.Normalize();
+    EXPECT_EQ(wrapping.Intervals(),
+              (std::vector<Interval>{Interval(UBits(0, width), UBits(3, width)),
+                                     Interval(max_minus_one, max)}));
+
+    IntervalSet top(width);
+    top.AddInterval(Interval(UBits(4, width), max_minus_one));
+    top.Normalize();
+    EXPECT_TRUE(IntervalSet::Combine(wrapping, top).IsMaximal());
+    EXPECT_EQ(IntervalSet::Intersect(wrapping, top),
+              IntervalSet::Precise(max_minus_one));
+
+    IntervalSet ends(width);
+    ends.AddInterval(Interval(max, max));
+    ends.AddInterval(Interval(max_minus_one, max_minus_one));
+    ends.AddInterval(Interval(UBits(0, width), UBits(0, width)));
+    ends.Normalize();
+    EXPECT_EQ(ends.Intervals(),
+              (std::vector<Interval>{Interval(UBits(0, width), UBits(0, width)),
+                                     Interval(max_minus_one, max)}));
+  }
+}
+
 TEST(IntervalTest, Size) {
   IntervalSet example(32);
   example.AddInterval(MakeInterval(5, 10, 32));
@@ -14,13 +14,21 @@
 
 #include "xls/ir/ir_parser.h"
 
+#include <algorithm>
+#include <limits>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/common/visitor.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.pb.h"
@@ -29,6 +37,7 @@
 #include "xls/ir/number_parser.h"
 #include "xls/ir/op.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value_helpers.h"
 #include "xls/ir/verifier.h"
 
 namespace xls {
@@ -468,7 +477,7 @@ absl::StatusOr<Value> Parser::ParseValueInternal(std::optional<Type*> type) {
                            ParseValueInternal(element_type));
       values.push_back(std::move(element_value));
     }
-    return Value::Tuple(values);
+    return Value::TupleOwned(std::move(values));
   }
   if (type_kind == TypeKind::kToken) {
     XLS_RETURN_IF_ERROR(scanner_.DropKeywordOrError("token"));
@@ -2058,6 +2067,73 @@ absl::StatusOr<DeclAttributes> Parser::MaybeParseAttributes() {
 
 // Verifies the given package. Replaces InternalError status codes with
 // InvalidArgument status code which is more appropriate for the parser.
+absl::Status Parser::ParseDeclaration(
+    Package* package, std::string_view filename,
+    std::optional<Token>* previous_top_token) {
+  XLS_ASSIGN_OR_RETURN(DeclAttributes attributes, MaybeParseAttributes());
+
+  XLS_ASSIGN_OR_RETURN(Token peek, scanner_.PeekToken());
+
+  bool is_top = false;
+  // The fn, proc or block is a top entity.
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "top") {
+    is_top = true;
+    XLS_RETURN_IF_ERROR(scanner_.DropKeywordOrError("top"));
+    XLS_ASSIGN_OR_RETURN(peek, scanner_.PeekToken());
+    if (package->HasTop() && previous_top_token->has_value()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Top declared more than once, previous declaration @ %s",
+          previous_top_token->value().pos().ToHumanString()));
+    }
+    *previous_top_token = peek;
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "fn") {
+    XLS_ASSIGN_OR_RETURN(Function * fn, ParseFunction(package, attributes),
+                         _ << "@ " << filename);
+    if (is_top) {
+      XLS_RETURN_IF_ERROR(package->SetTop(fn));
+    }
+    return absl::OkStatus();
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "proc") {
+    XLS_ASSIGN_OR_RETURN(Proc * proc, ParseProc(package, attributes),
+                         _ << "@ " << filename);
+    if (is_top) {
+      XLS_RETURN_IF_ERROR(package->SetTop(proc));
+    }
+    return absl::OkStatus();
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "block") {
+    XLS_ASSIGN_OR_RETURN(Block * block, ParseBlock(package, attributes),
+                         _ << "@ " << filename);
+    if (is_top) {
+      XLS_RETURN_IF_ERROR(package->SetTop(block));
+    }
+    return absl::OkStatus();
+  }
+  if (is_top) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
+                        peek.value(), peek.pos().ToHumanString()));
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "chan") {
+    XLS_RETURN_IF_ERROR(ParseChannel(package, attributes).status())
+        << "@ " << filename;
+    return absl::OkStatus();
+  }
+  if (peek.type() == LexicalTokenType::kKeyword &&
+      peek.value() == "file_number") {
+    XLS_RETURN_IF_ERROR(ParseFileNumber(package, attributes))
+        << "@ " << filename;
+    return absl::OkStatus();
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Expected attribute or declaration "
+                      "(`fn`, `proc`, `block`, `chan`, `file_number`), "
+                      "got %s @ %s",
+                      peek.value(), peek.pos().ToHumanString()));
+}
+
 static absl::Status VerifyAndSwapError(Package* package) {
   absl::Status status = VerifyPackage(package);
   if (!status.ok() && status.code() == absl::StatusCode::kInternal) {
@@ -2150,6 +2226,319 @@ absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageNoVerify(
   return ParseDerivedPackageNoVerify<Package>(input_string, filename, entry);
 }
 
+namespace {
+
+// Automatically assigned node ids in the scratch packages used by
+// ParsePackageParallel start at this value to distinguish them from ids given
+// in the text.
+constexpr int64_t kScratchNodeIdBase = int64_t{1} << 62;
+
+// A top-level declaration in the text of a package.
+struct TextDeclaration {
+  std::string_view text;
+  // The name of the function if the declaration is a function definition.
+  std::optional<std::string_view> function_name;
+  bool is_top = false;
+};
+
+bool IsIdentifierChar(char c) {
+  return absl::ascii_isalnum(c) || c == '_' || c == '.';
+}
+
+// Returns the identifier at the start of `text` (which may be empty).
+std::string_view LeadingIdentifier(std::string_view text) {
+  int64_t size = 0;
+  while (size < text.size() && IsIdentifierChar(text[size])) {
+    ++size;
+  }
+  return text.substr(0, size);
+}
+
+// If `text` starts with the given keyword, removes the keyword and any
+// following whitespace from `text` and returns true.
+bool ConsumeKeyword(std::string_view keyword, std::string_view* text) {
+  if (!absl::StartsWith(*text, keyword) ||
+      (text->size() > keyword.size() &&
+       IsIdentifierChar((*text)[keyword.size()]))) {
+    return false;
+  }
+  *text = absl::StripLeadingAsciiWhitespace(text->substr(keyword.size()));
+  return true;
+}
+
+// Splits the text of a package into its top-level declarations, the first of
+// which holds the package name. A declaration is assumed to begin at the start
+// of a line with a keyword or an attribute, as in IR emitted by DumpIr. A split
+// at the wrong place (e.g., inside a multi-line string) results in an error
+// when parsing the declarations.
+std::vector<TextDeclaration> SplitDeclarations(std::string_view text) {
+  constexpr std::string_view kDeclarationKeywords[] = {
+      "package", "top", "fn", "proc", "block", "chan", "file_number"};
+  std::vector<int64_t> starts = {0};
+  bool attributes_only = false;
+  for (int64_t pos = 0; pos < text.size();) {
+    int64_t end = text.find('\n', pos);
+    if (end == std::string_view::npos) {
+      end = text.size();
+    }
+    std::string_view line = text.substr(pos, end - pos);
+    bool is_attribute = absl::StartsWith(line, "#[");
+    if (is_attribute ||
+        absl::c_any_of(kDeclarationKeywords, [&](std::string_view keyword) {
+          std::string_view rest = line;
+          return ConsumeKeyword(keyword, &rest);
+        })) {
+      if (!attributes_only && pos != 0) {
+        starts.push_back(pos);
+      }
+      attributes_only = is_attribute;
+    }
+    pos = end + 1;
+  }
+
+  std::vector<TextDeclaration> declarations;
+  for (int64_t i = 0; i < starts.size(); ++i) {
+    int64_t end = i + 1 < starts.size() ? starts[i + 1] : text.size();
+    TextDeclaration declaration{.text =
+                                    text.substr(starts[i], end - starts[i])};
+    // Skip attributes to find the kind of the declaration.
+    std::string_view rest = declaration.text;
+    while (absl::StartsWith(rest, "#[")) {
+      int64_t line_end = rest.find('\n');
+      rest = line_end == std::string_view::npos ? std::string_view()
+                                                : rest.substr(line_end + 1);
+    }
+    declaration.is_top = ConsumeKeyword("top", &rest);
+    if (i != 0 && ConsumeKeyword("fn", &rest)) {
+      declaration.function_name = LeadingIdentifier(rest);
+    }
+    declarations.push_back(declaration);
+  }
+  return declarations;
+}
+
+// Adds a copy of `function`, parsed into a scratch package by
+// ParsePackageParallel, to `package`. Nodes are added in the same order as in
+// `function` and keep their names and any ids given in the text so the result
+// is identical to parsing the function directly into `package`. Functions
+// invoked by `function` are resolved by name in `package`.
+absl::StatusOr<Function*> TransplantFunction(Function* function,
+                                             Package* package) {
+  Function* result = package->AddFunction(
+      std::make_unique<Function>(function->name(), package));
+  auto callee = [&](Function* f) { return package->GetFunction(f->name()); };
+  absl::flat_hash_map<Node*, Node*> node_map;
+  for (Node* node : function->nodes()) {
+    std::vector<Node*> operands;
+    operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      operands.push_back(node_map.at(operand));
+    }
+    std::string_view name = node->HasAssignedName() ? node->GetName() : "";
+    Node* new_node;
+    switch (node->op()) {
+      case Op::kInvoke: {
+        XLS_ASSIGN_OR_RETURN(Function * to_apply,
+                             callee(node->As<Invoke>()->to_apply()));
+        XLS_ASSIGN_OR_RETURN(new_node,
+                             result->MakeNodeWithName<Invoke>(
+                                 node->loc(), operands, to_apply, name));
+        break;
+      }
+      case Op::kMap: {
+        XLS_ASSIGN_OR_RETURN(Function * to_apply,
+                             callee(node->As<Map>()->to_apply()));
+        XLS_ASSIGN_OR_RETURN(new_node,
+                             result->MakeNodeWithName<Map>(
+                                 node->loc(), operands[0], to_apply, name));
+        break;
+      }
+      case Op::kCountedFor: {
+        CountedFor* counted_for = node->As<CountedFor>();
+        XLS_ASSIGN_OR_RETURN(Function * body, callee(counted_for->body()));
+        XLS_ASSIGN_OR_RETURN(
+            new_node,
+            result->MakeNodeWithName<CountedFor>(
+                node->loc(), operands[0],
+                absl::MakeConstSpan(operands).subspan(1),
+                counted_for->trip_count(), counted_for->stride(), body, name));
+        break;
+      }
+      case Op::kDynamicCountedFor: {
+        XLS_ASSIGN_OR_RETURN(Function * body,
+                             callee(node->As<DynamicCountedFor>()->body()));
+        XLS_ASSIGN_OR_RETURN(
+            new_node, result->MakeNodeWithName<DynamicCountedFor>(
+                          node->loc(), operands[0], operands[1], operands[2],
+                          absl::MakeConstSpan(operands).subspan(3), body,
+                          name));
+        break;
+      }
+      default:
+        XLS_ASSIGN_OR_RETURN(new_node,
+                             node->CloneInNewFunction(operands, result));
+        break;
+    }
+    if (node->id() < kScratchNodeIdBase) {
+      new_node->SetId(node->id());
+    }
+    node_map[node] = new_node;
+  }
+  if (function->return_value() != nullptr) {
+    XLS_RETURN_IF_ERROR(
+        result->set_return_value(node_map.at(function->return_value())));
+  }
+  if (function->GetInitiationInterval().has_value()) {
+    result->SetInitiationInterval(*function->GetInitiationInterval());
+  }
+  return result;
+}
+
+}  // namespace
+
+/* static */
+absl::Status Parser::AddFunctionStub(std::string_view input_string,
+                                     Package* package) {
+  // The signature ends with the opening brace of the body.
+  int64_t brace = input_string.find('{');
+  if (brace == std::string_view::npos) {
+    return absl::InvalidArgumentError("Expected '{' in function definition");
+  }
+  XLS_ASSIGN_OR_RETURN(auto scanner,
+                       Scanner::Create(input_string.substr(0, brace + 1)));
+  Parser p(std::move(scanner));
+  XLS_RETURN_IF_ERROR(p.MaybeParseAttributes().status());
+  p.scanner_.TryDropKeyword("top");
+  XLS_RETURN_IF_ERROR(p.scanner_.DropKeywordOrError("fn"));
+  absl::flat_hash_map<std::string, BValue> name_to_value;
+  XLS_ASSIGN_OR_RETURN(auto function_data,
+                       p.ParseFunctionSignature(&name_to_value, package));
+  FunctionBuilder* fb = function_data.first.get();
+  return fb->BuildWithReturnValue(fb->Literal(ZeroOfType(function_data.second)))
+      .status();
+}
+
+/* static */
+absl::StatusOr<std::pair<std::unique_ptr<Package>, Function*>>
+Parser::ParseFunctionInScratchPackage(
+    std::string_view input_string,
+    const absl::flat_hash_map<std::string_view, std::string_view>&
+        function_definitions) {
+  auto package = std::make_unique<Package>("scratch");
+  package->set_next_node_id(kScratchNodeIdBase);
+
+  // Add stubs for the functions referred to by keyword arguments such as
+  // `to_apply=foo` or `body=foo`. Spurious matches (e.g., in strings) only
+  // result in unused stubs.
+  absl::flat_hash_set<std::string_view> stubs;
+  for (std::string_view keyword : {"to_apply=", "body="}) {
+    for (int64_t pos = input_string.find(keyword);
+         pos != std::string_view::npos;
+         pos = input_string.find(keyword, pos + 1)) {
+      std::string_view name =
+          LeadingIdentifier(input_string.substr(pos + keyword.size()));
+      auto it = function_definitions.find(name);
+      if (it == function_definitions.end() ||
+          it->second.data() == input_string.data() ||
+          !stubs.insert(name).second) {
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(AddFunctionStub(it->second, package.get()));
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(input_string));
+  Parser p(std::move(scanner));
+  std::optional<Token> previous_top_token;
+  XLS_RETURN_IF_ERROR(
+      p.ParseDeclaration(package.get(), "<scratch>", &previous_top_token));
+  if (!p.AtEof()) {
+    return absl::InvalidArgumentError(
+        "Expected a single function definition");
+  }
+  Function* function = package->functions().back().get();
+  return std::make_pair(std::move(package), function);
+}
+
+/* static */
+absl::StatusOr<std::unique_ptr<Package>> Parser::ParsePackageParallel(
+    std::string_view input_string, std::optional<std::string_view> filename,
+    std::optional<int64_t> thread_count) {
+  std::vector<TextDeclaration> declarations = SplitDeclarations(input_string);
+  absl::flat_hash_map<std::string_view, std::string_view> function_definitions;
+  std::vector<std::string_view> function_texts;
+  int64_t top_count = 0;
+  bool has_duplicate_names = false;
+  for (const TextDeclaration& declaration : declarations) {
+    if (declaration.is_top) {
+      ++top_count;
+    }
+    if (declaration.function_name.has_value()) {
+      has_duplicate_names |= !function_definitions
+                                  .insert({*declaration.function_name,
+                                           declaration.text})
+                                  .second;
+      function_texts.push_back(declaration.text);
+    }
+  }
+  // Leave erroneous packages and those with too few functions to benefit from
+  // parallelism to the serial parser.
+  if (function_texts.size() < 2 || top_count > 1 || has_duplicate_names) {
+    return ParsePackage(input_string, filename);
+  }
+
+  // Parse the function definitions in parallel into scratch packages.
+  std::vector<absl::StatusOr<std::pair<std::unique_ptr<Package>, Function*>>>
+      parsed_functions(function_texts.size());
+  BoundedParallelFor(
+      0, function_texts.size(),
+      thread_count.value_or(std::numeric_limits<int64_t>::max()),
+      [&](int64_t index) {
+        parsed_functions[index] = ParseFunctionInScratchPackage(
+            function_texts[index], function_definitions);
+      });
+
+  // Assemble the package serially, parsing the other declarations in place.
+  std::string filename_str =
+      (filename.has_value() ? std::string(filename.value()) : "<unknown file>");
+  auto assemble = [&]() -> absl::StatusOr<std::unique_ptr<Package>> {
+    XLS_ASSIGN_OR_RETURN(auto scanner, Scanner::Create(declarations[0].text));
+    Parser p(std::move(scanner));
+    XLS_ASSIGN_OR_RETURN(std::string package_name, p.ParsePackageName());
+    auto package = std::make_unique<Package>(package_name);
+    std::optional<Token> previous_top_token;
+    int64_t function_index = 0;
+    for (int64_t i = 0; i < declarations.size(); ++i) {
+      if (declarations[i].function_name.has_value()) {
+        const auto& parsed = parsed_functions[function_index++];
+        XLS_RETURN_IF_ERROR(parsed.status());
+        XLS_ASSIGN_OR_RETURN(Function * function,
+                             TransplantFunction(parsed->second, package.get()));
+        if (declarations[i].is_top) {
+          XLS_RETURN_IF_ERROR(package->SetTop(function));
+        }
+        continue;
+      }
+      if (i != 0) {
+        XLS_ASSIGN_OR_RETURN(scanner, Scanner::Create(declarations[i].text));
+        p = Parser(std::move(scanner));
+      }
+      while (!p.AtEof()) {
+        XLS_RETURN_IF_ERROR(p.ParseDeclaration(package.get(), filename_str,
+                                               &previous_top_token));
+      }
+    }
+    return package;
+  };
+  absl::StatusOr<std::unique_ptr<Package>> package = assemble();
+  if (!package.ok()) {
+    // Reparse serially so the error is the same as that of ParsePackage.
+    return ParsePackage(input_string, filename);
+  }
+  XLS_RETURN_IF_ERROR(VerifyAndSwapError(package->get()));
+  return package;
+}
+
 /* static */
 absl::StatusOr<Value> Parser::ParseValue(std::string_view input_string,
                                          Type* expected_type) {
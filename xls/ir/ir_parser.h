@@ -56,6 +56,18 @@ class Parser {
       std::string_view input_string,
       std::optional<std::string_view> filename = std::nullopt);
 
+  // As above, but parses the function definitions on up to `thread_count`
+  // threads of the shared thread pool (by default, all of them). The resulting
+  // package is identical to that returned by ParsePackage, including node ids
+  // and names. Useful for large packages with many functions such as those
+  // produced by frontends. Falls back to parsing serially if the input cannot
+  // be split into independent definitions, and in the case of errors so that
+  // error messages match those of ParsePackage.
+  static absl::StatusOr<std::unique_ptr<Package>> ParsePackageParallel(
+      std::string_view input_string,
+      std::optional<std::string_view> filename = std::nullopt,
+      std::optional<int64_t> thread_count = std::nullopt);
+
   // As above, but sets the entry function to be the given name in the returned
   // package.
   static absl::StatusOr<std::unique_ptr<Package>> ParsePackageWithEntry(
@@ -299,6 +311,29 @@ class Parser {
   absl::Status ParseFileNumber(Package* package,
                                const DeclAttributes& attributes = {});
 
+  // Parses the next top-level declaration (a fn, proc, block, chan or
+  // file_number, possibly preceded by attributes and "top") into the
+  // package. `previous_top_token` is the token of the previous declaration of
+  // a top entity, if any, and is updated if this declaration is the top.
+  absl::Status ParseDeclaration(Package* package, std::string_view filename,
+                                std::optional<Token>* previous_top_token);
+
+  // Parses the function definition in `input_string` into a new scratch
+  // package for ParsePackageParallel. Functions invoked by the definition must
+  // be in `function_definitions` (a map from function name to its definition)
+  // and are added to the scratch package as stubs with the same signature.
+  static absl::StatusOr<std::pair<std::unique_ptr<Package>, Function*>>
+  ParseFunctionInScratchPackage(
+      std::string_view input_string,
+      const absl::flat_hash_map<std::string_view, std::string_view>&
+          function_definitions);
+
+  // Parses the signature of the function definition in `input_string` and
+  // adds a function with that signature to the package. The body of the
+  // function returns a literal of the return type.
+  static absl::Status AddFunctionStub(std::string_view input_string,
+                                      Package* package);
+
   // Parse a sequence of attributes of the form:
   //
   // #[<ident>(<literal>)]
@@ -324,73 +359,8 @@ absl::StatusOr<std::unique_ptr<PackageT>> Parser::ParseDerivedPackageNoVerify(
   std::string filename_str =
       (filename.has_value() ? std::string(filename.value()) : "<unknown file>");
   while (!parser.AtEof()) {
-    XLS_ASSIGN_OR_RETURN(DeclAttributes attributes,
-                         parser.MaybeParseAttributes());
-
-    XLS_ASSIGN_OR_RETURN(Token peek, parser.scanner_.PeekToken());
-
-    bool is_top = false;
-    // The fn, proc or block is a top entity.
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "top") {
-      is_top = true;
-      XLS_RETURN_IF_ERROR(parser.scanner_.DropKeywordOrError("top"));
-      XLS_ASSIGN_OR_RETURN(peek, parser.scanner_.PeekToken());
-      if (package.get()->HasTop() && previous_top_token.has_value()) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Top declared more than once, previous declaration @ %s",
-            previous_top_token.value().pos().ToHumanString()));
-      }
-      previous_top_token = peek;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "fn") {
-      XLS_ASSIGN_OR_RETURN(Function * fn,
-                           parser.ParseFunction(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(fn));
-      }
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "proc") {
-      XLS_ASSIGN_OR_RETURN(Proc * proc,
-                           parser.ParseProc(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(proc));
-      }
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "block") {
-      XLS_ASSIGN_OR_RETURN(Block * block,
-                           parser.ParseBlock(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(block));
-      }
-      continue;
-    }
-    if (is_top) {
-      return absl::InvalidArgumentError(
-          absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
-                          peek.value(), peek.pos().ToHumanString()));
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "chan") {
-      XLS_RETURN_IF_ERROR(
-          parser.ParseChannel(package.get(), attributes).status())
-          << "@ " << filename_str;
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword &&
-        peek.value() == "file_number") {
-      XLS_RETURN_IF_ERROR(parser.ParseFileNumber(package.get(), attributes))
-          << "@ " << filename_str;
-      continue;
-    }
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Expected attribute or declaration "
-                        "(`fn`, `proc`, `block`, `chan`, `file_number`), "
-                        "got %s @ %s",
-                        peek.value(), peek.pos().ToHumanString()));
+    XLS_RETURN_IF_ERROR(parser.ParseDeclaration(package.get(), filename_str,
+                                                &previous_top_token));
   }
 
   // Verify the given entry function exists in the package.
@@ -3088,4 +3088,74 @@ file_number 0 "fake_file.x"
               "Attributes are not supported on file number declarations.")));
 }
 
+TEST(IrParserTest, ParsePackageParallelMatchesSerialParse) {
+  const std::string input = R"(package test
+
+file_number 0 "fake_file.x"
+
+chan ch(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=none, metadata="""""")
+
+fn body(i: bits[16], acc: bits[16]) -> bits[16] {
+  ret add.3: bits[16] = add(i, acc, id=3)
+}
+
+// A function without node ids.
+fn not_fn(x: bits[16]) -> bits[16] {
+  not.1: bits[16] = not(x)
+  ret my_neg: bits[16] = neg(not.1, pos=[(0,1,2)])
+}
+
+#[initiation_interval(2)]
+fn caller(x: bits[16], a: bits[16][4]) -> (bits[16], bits[16][4]) {
+  counted_for.8: bits[16] = counted_for(x, trip_count=4, stride=2, body=body, id=8)
+  invoke.9: bits[16] = invoke(counted_for.8, to_apply=not_fn, id=9)
+  map.10: bits[16][4] = map(a, to_apply=not_fn, id=10)
+  ret tuple.11: (bits[16], bits[16][4]) = tuple(invoke.9, map.10, id=11)
+}
+
+top proc my_proc(my_token: token, my_state: bits[32], init={42}) {
+  send.12: token = send(my_token, my_state, channel_id=0, id=12)
+  ret_val: bits[16] = bit_slice(my_state, start=0, width=16, id=13)
+  invoke.14: bits[16] = invoke(ret_val, to_apply=not_fn, id=14)
+  next (send.12, my_state)
+}
+
+fn last(x: bits[8]) -> bits[8] {
+  ret identity.15: bits[8] = identity(x)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> serial,
+                           Parser::ParsePackage(input));
+  for (int64_t thread_count : {1, 2, 8}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<Package> parallel,
+        Parser::ParsePackageParallel(input, std::nullopt, thread_count));
+    EXPECT_EQ(parallel->DumpIr(), serial->DumpIr());
+    EXPECT_EQ(parallel->next_node_id(), serial->next_node_id());
+    XLS_ASSERT_OK_AND_ASSIGN(Function * caller,
+                             parallel->GetFunction("caller"));
+    EXPECT_THAT(caller->GetInitiationInterval(), Optional(2));
+  }
+}
+
+TEST(IrParserTest, ParsePackageParallelErrorsMatchSerialParse) {
+  const std::string input = R"(package test
+
+fn f(x: bits[16]) -> bits[16] {
+  ret invoke.1: bits[16] = invoke(x, to_apply=g, id=1)
+}
+
+fn g(x: bits[16]) -> bits[16] {
+  ret not.2: bits[16] = not(x, id=2)
+}
+
+fn h(x: bits[16]) -> bits[16] {
+  ret not.3: bits[16] = not(y, id=3)
+}
+)";
+  absl::Status serial = Parser::ParsePackage(input).status();
+  ASSERT_FALSE(serial.ok());
+  EXPECT_EQ(Parser::ParsePackageParallel(input).status(), serial);
+}
+
 }  // namespace xls
@@ -14,18 +14,24 @@
 
 #include "xls/ir/node.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
+#include "xls/ir/incremental_topo_order.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
@@ -38,15 +44,19 @@ namespace xls {
 Node::Node(Op op, Type* type, const SourceInfo& loc, std::string_view name,
            FunctionBase* function_base)
     : function_base_(function_base),
-      id_(function_base_->package()->GetNextNodeId()),
+      id_(function_base_->AllocateNodeId()),
       op_(op),
       type_(type),
-      loc_(loc),
-      name_(name.empty() ? "" : function_base_->UniquifyNodeName(name)) {}
+      loc_(loc) {
+  if (!name.empty()) {
+    AssignName(name);
+  }
+}
 
 void Node::AddOperand(Node* operand) {
   XLS_VLOG(3) << " Adding operand " << operand->GetName() << " as #"
               << operands_.size() << " operand of " << GetName();
+  function_base_->SaveNodeForRollback(this);
   operands_.push_back(operand);
   operand->AddUser(this);
   XLS_VLOG(3) << " " << operand->GetName()
@@ -72,10 +82,84 @@ absl::Status Node::AddNodeToFunctionAndReplace(
   return ReplaceUsesWith(replacement_ptr);
 }
 
-void Node::AddUser(Node* user) { users_.insert(user); }
+bool NodeUserSet::contains(const Node* node) const {
+  auto it = absl::c_lower_bound(users_, node, Node::NodeIdLessThan());
+  return it != users_.end() && *it == node;
+}
+
+bool NodeUserSet::insert(Node* node) {
+  if (users_.empty() || Node::NodeIdLessThan()(users_.back(), node)) {
+    users_.push_back(node);
+    return true;
+  }
+  auto it = absl::c_lower_bound(users_, node, Node::NodeIdLessThan());
+  if (it != users_.end() && *it == node) {
+    return false;
+  }
+  users_.insert(it, node);
+  return true;
+}
+
+int64_t NodeUserSet::erase(const Node* node) {
+  auto it = absl::c_lower_bound(users_, node, Node::NodeIdLessThan());
+  if (it == users_.end() || *it != node) {
+    return 0;
+  }
+  users_.erase(it);
+  return 1;
+}
+
+void NodeUserSet::InsertSorted(absl::Span<Node* const> nodes) {
+  if (nodes.empty()) {
+    return;
+  }
+  absl::InlinedVector<Node*, kInlineUserCount> merged;
+  merged.reserve(users_.size() + nodes.size());
+  std::set_union(users_.begin(), users_.end(), nodes.begin(), nodes.end(),
+                 std::back_inserter(merged), Node::NodeIdLessThan());
+  users_ = std::move(merged);
+}
+
+void NodeUserSet::EraseSorted(absl::Span<Node* const> nodes) {
+  if (nodes.empty()) {
+    return;
+  }
+  auto out = users_.begin();
+  auto to_erase = nodes.begin();
+  for (Node* user : users_) {
+    if (to_erase != nodes.end() && *to_erase == user) {
+      ++to_erase;
+    } else {
+      *out++ = user;
+    }
+  }
+  XLS_CHECK(to_erase == nodes.end());
+  users_.erase(out, users_.end());
+}
+
+void Node::AddUser(Node* user) {
+  if (function_base_ != nullptr) {
+    function_base_->SaveNodeForRollback(this);
+  }
+  if (users_.insert(user) && function_base_ != nullptr) {
+    if (IncrementalTopoOrder* topo_order =
+            function_base_->incremental_topo_order()) {
+      topo_order->AddEdge(this, user);
+    }
+    function_base_->NoteNodeChanged(this);
+    function_base_->NoteNodeChanged(user);
+  }
+}
 
 void Node::RemoveUser(Node* user) {
+  if (function_base_ != nullptr) {
+    function_base_->SaveNodeForRollback(this);
+  }
   XLS_CHECK_EQ(users_.erase(user), 1) << GetName();
+  if (function_base_ != nullptr) {
+    function_base_->NoteNodeChanged(this);
+    function_base_->NoteNodeChanged(user);
+  }
 }
 
 absl::Status Node::VisitSingleNode(DfsVisitor* visitor) {
@@ -394,15 +478,53 @@ std::string Node::GetName() const {
 }
 
 void Node::SetName(std::string_view name) {
-  name_ = function_base()->UniquifyNodeName(name);
+  function_base()->SaveNodeForRollback(this);
+  AssignName(name);
+}
+
+void Node::AssignName(std::string_view name) {
+  // Params are looked up by name so their names are never deferred.
+  if (function_base_->NodeNamesDeferred() && op_ != Op::kParam) {
+    name_ = std::string(name);
+    name_pending_ = true;
+  } else {
+    name_ = function_base_->UniquifyNodeName(name);
+    name_pending_ = false;
+  }
 }
 
 void Node::ClearName() {
   XLS_CHECK(!Is<Param>());
+  function_base()->SaveNodeForRollback(this);
   name_ = "";
+  name_pending_ = false;
 }
 
-void Node::SetLoc(const SourceInfo& loc) { loc_ = loc; }
+void Node::SetLoc(const SourceInfo& loc) {
+  function_base()->SaveNodeForRollback(this);
+  loc_ = loc;
+}
+
+std::string Node::ToCanonicalString() const {
+  std::string text = ToString();
+  // Drop the "name: type = " prefix.
+  text = text.substr(text.find(" = ") + 3);
+  // The id is the last attribute other than the source location.
+  text = text.substr(0, text.rfind("id="));
+  absl::flat_hash_map<std::string, int64_t> operand_numbers;
+  for (int64_t i = 0; i < operand_count(); ++i) {
+    operand_numbers.emplace(operand(i)->GetName(), i);
+  }
+  std::vector<std::string> tokens;
+  for (std::string_view token :
+       absl::StrSplit(text, absl::ByAnyChar(" ,()[]="))) {
+    auto it = operand_numbers.find(token);
+    tokens.push_back(it == operand_numbers.end()
+                         ? std::string(token)
+                         : absl::StrCat("%", it->second));
+  }
+  return absl::StrJoin(tokens, " ");
+}
 
 std::string Node::ToStringInternal(bool include_operand_types) const {
   std::string ret = absl::StrCat(GetName(), ": ", GetType()->ToString(), " = ",
@@ -654,9 +776,15 @@ int64_t Node::OperandInstanceCount(const Node* target) const {
 }
 
 void Node::SetId(int64_t id) {
-  // The data structure (btree) containing the users of each node is sorted by
-  // node id. To avoid violating invariants of the data structure, remove this
-  // node from all users lists, change id, then read to users list.
+  // The data structure (NodeUserSet) containing the users of each node is
+  // sorted by node id. To avoid violating invariants of the data structure,
+  // remove this node from all users lists, change id, then read to users list.
+  if (function_base_ != nullptr) {
+    function_base_->SaveNodeForRollback(this);
+    for (Node* operand : operands()) {
+      function_base_->SaveNodeForRollback(operand);
+    }
+  }
   for (Node* operand : operands()) {
     operand->users_.erase(this);
   }
@@ -664,9 +792,22 @@ void Node::SetId(int64_t id) {
   for (Node* operand : operands()) {
     operand->users_.insert(this);
   }
+  if (function_base_ != nullptr) {
+    function_base_->NoteNodeChanged(this);
+    if (function_base_->IsStagingNodeIds()) {
+      return;
+    }
+  }
   package()->set_next_node_id(std::max(id + 1, package()->next_node_id()));
 }
 
+void Node::SwapOperands(int64_t a, int64_t b) {
+  // Operand/user chains already set up properly.
+  function_base_->SaveNodeForRollback(this);
+  std::swap(operands_[a], operands_[b]);
+  function_base_->NoteNodeChanged(this);
+}
+
 bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
   // The following test is necessary, because of the following scenario
   // during IR manipulation. Assume we want to replace a node 'sub' with
@@ -680,6 +821,7 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
   if (this == new_operand) {
     return true;
   }
+  function_base_->SaveNodeForRollback(this);
   bool did_replace = false;
   for (int64_t i = 0; i < operand_count(); ++i) {
     if (operands_[i] == old_operand) {
@@ -707,7 +849,9 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
   // AddUser is idempotent so even if the new operand is already used by this
   // node in another operand slot, it is safe to call.
   new_operand->AddUser(this);
+  function_base_->SaveNodeForRollback(this);
   operands_[operand_no] = new_operand;
+  function_base_->NoteNodeChanged(this);
 
   for (Node* operand : operands()) {
     if (operand == old_operand) {
@@ -724,9 +868,40 @@ absl::Status Node::ReplaceUsesWith(Node* replacement) {
   XLS_RET_CHECK(GetType() == replacement->GetType())
       << "type was: " << GetType()->ToString()
       << " replacement: " << replacement->GetType()->ToString();
-  std::vector<Node*> orig_users(users().begin(), users().end());
-  for (Node* user : orig_users) {
-    XLS_RET_CHECK(user->ReplaceOperand(this, replacement));
+  // Rewire all users at once rather than with ReplaceOperand to avoid
+  // updating the user sets one element at a time which is quadratic for nodes
+  // with many users. As in ReplaceOperand, `replacement` itself remains a user
+  // of this node if it is one.
+  function_base_->SaveNodeForRollback(this);
+  function_base_->SaveNodeForRollback(replacement);
+  std::vector<Node*> moved_users;
+  moved_users.reserve(users_.size());
+  for (Node* user : users_) {
+    if (user == replacement) {
+      continue;
+    }
+    function_base_->SaveNodeForRollback(user);
+    for (Node*& operand : user->operands_) {
+      if (operand == this) {
+        operand = replacement;
+      }
+    }
+    moved_users.push_back(user);
+  }
+  users_.EraseSorted(moved_users);
+  replacement->users_.InsertSorted(moved_users);
+  if (IncrementalTopoOrder* topo_order =
+          function_base_->incremental_topo_order()) {
+    for (Node* user : moved_users) {
+      topo_order->AddEdge(replacement, user);
+    }
+  }
+  if (!moved_users.empty()) {
+    function_base_->NoteNodeChanged(this);
+    function_base_->NoteNodeChanged(replacement);
+    for (Node* user : moved_users) {
+      function_base_->NoteNodeChanged(user);
+    }
   }
 
   // Handle replacement of nodes which have special positions within the
@@ -20,7 +20,7 @@
 #include <utility>
 #include <vector>
 
-#include "absl/container/btree_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -39,6 +39,43 @@ class Package;
 class Node;
 class FunctionBase;
 
+// Set of the users of a node sorted by node id (see Node::NodeIdLessThan) so
+// iteration order is deterministic. Most nodes have few users so the set is a
+// sorted vector holding up to kInlineUserCount users without allocation. Newly
+// created nodes have the largest ids so adding them as users appends to the
+// end of the vector.
+class NodeUserSet {
+ public:
+  static constexpr int64_t kInlineUserCount = 4;
+
+  using value_type = Node*;
+  using const_iterator = Node* const*;
+  using iterator = const_iterator;
+
+  const_iterator begin() const { return users_.data(); }
+  const_iterator end() const { return users_.data() + users_.size(); }
+  int64_t size() const { return users_.size(); }
+  bool empty() const { return users_.empty(); }
+  absl::Span<Node* const> AsSpan() const { return users_; }
+
+  bool contains(const Node* node) const;
+
+  // Adds `node` to the set. Returns true if it was not already present.
+  bool insert(Node* node);
+
+  // Removes `node` from the set. Returns the number of removed elements.
+  int64_t erase(const Node* node);
+
+  // Adds/removes all of `nodes` which must be sorted by NodeIdLessThan with
+  // no duplicates. Runs in time linear in the sizes of the set and `nodes`.
+  // Every element of `nodes` passed to EraseSorted must be in the set.
+  void InsertSorted(absl::Span<Node* const> nodes);
+  void EraseSorted(absl::Span<Node* const> nodes);
+
+ private:
+  absl::InlinedVector<Node*, kInlineUserCount> users_;
+};
+
 // Forward decaration to avoid circular dependency.
 class DfsVisitor;
 
@@ -118,10 +155,7 @@ class Node {
   absl::StatusOr<bool> ReplaceImplicitUsesWith(Node* replacement);
 
   // Swaps the operands at indices 'a' and 'b' in the operands sequence.
-  void SwapOperands(int64_t a, int64_t b) {
-    // Operand/user chains already set up properly.
-    std::swap(operands_[a], operands_[b]);
-  }
+  void SwapOperands(int64_t a, int64_t b);
 
   // Returns true if analysis indicates that this node always produces the
   // same value as 'other' when run with the same operands. The analysis is
@@ -177,6 +211,13 @@ class Node {
     return ToStringInternal(true);
   }
 
+  // Returns the text of the node as printed in the IR with the names of the
+  // node and its operands, the node id and the source location removed so that
+  // the result is unaffected by renumbering and renaming. Operand names (which
+  // may appear in attributes such as the cases of a select) are replaced by
+  // their operand number. The type of the node is not included.
+  std::string ToCanonicalString() const;
+
   // Returns a string of operand names; e.g. "[param.2, literal.7]".
   std::string GetOperandsString() const;
 
@@ -198,7 +239,7 @@ class Node {
   };
 
   // Returns the unique set of users of this node sorted by id.
-  const absl::btree_set<Node*, NodeIdLessThan>& users() const { return users_; }
+  const NodeUserSet& users() const { return users_; }
 
   // Helper for querying whether "target" is a user of this node.
   bool HasUser(const Node* target) const;
@@ -225,6 +266,11 @@ class Node {
 
   int64_t id() const { return id_; }
 
+  // Returns the index of the node in the node table of its function base. The
+  // indices of a function base are dense (see FunctionBase::node_table_size)
+  // and are stable until FunctionBase::CompactNodes is called.
+  int64_t node_table_index() const { return node_table_index_; }
+
   // Sets the id of the node. Mutates the user sets of the operands of the node
   // because user sets are sorted by id.  Note: this should only be used by the
   // parser and ideally not even there.
@@ -282,17 +328,26 @@ class Node {
   void AddUser(Node* user);
   void RemoveUser(Node* user);
 
+  // Sets `name_` to the uniquified `name`, or to `name` verbatim if node names
+  // are deferred by the function base.
+  void AssignName(std::string_view name);
+
   FunctionBase* function_base_;
+  // Index of the node in the node table of `function_base_`.
+  int64_t node_table_index_ = -1;
   int64_t id_;
   Op op_;
   Type* type_;
   SourceInfo loc_;
   std::string name_;
+  // Whether `name_` is the name as given, to be sanitized and uniquified by
+  // FunctionBase::FinalizeNodeNames.
+  bool name_pending_ = false;
 
   std::vector<Node*> operands_;
 
   // Set of users sorted by node_id for stability.
-  absl::btree_set<Node*, NodeIdLessThan> users_;
+  NodeUserSet users_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Node& node) {
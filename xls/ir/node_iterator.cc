@@ -20,10 +20,32 @@
 #include "xls/common/logging/logging.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/incremental_topo_order.h"
 
 namespace xls {
 
-void NodeIterator::Initialize() {
+void NodeIterator::Initialize(bool reverse) {
+  IncrementalTopoOrder* topo_order = f_->incremental_topo_order();
+  if (topo_order != nullptr && topo_order->valid()) {
+    ordered_ = std::make_unique<std::vector<Node*>>(
+        topo_order->GetOrder(/*reverse=*/reverse));
+    return;
+  }
+  ComputeReverseOrder();
+  if (topo_order != nullptr) {
+    std::vector<Node*> order(ordered_->rbegin(), ordered_->rend());
+    topo_order->Reset(order);
+    if (!reverse) {
+      *ordered_ = std::move(order);
+    }
+    return;
+  }
+  if (!reverse) {
+    std::reverse(ordered_->begin(), ordered_->end());
+  }
+}
+
+void NodeIterator::ComputeReverseOrder() {
   // For topological traversal we only add nodes to the order when all of its
   // users have been scheduled.
   //
@@ -37,8 +59,8 @@ void NodeIterator::Initialize() {
   // keeps track of how many more users must be seen (before that node is ready
   // to place into the ordering).
   //
-  // NOTE: Initialize sorts reverse-topologically.  To sort topologically,
-  // reverse the this->ordered_
+  // NOTE: this sorts reverse-topologically.  To sort topologically, reverse
+  // this->ordered_
   absl::flat_hash_map<Node*, int64_t> pending_to_remaining_users;
   pending_to_remaining_users.reserve(f_->node_count());
   std::deque<Node*> ready;
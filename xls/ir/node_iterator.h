@@ -29,14 +29,13 @@ class NodeIterator {
  public:
   static NodeIterator Create(FunctionBase* f) {
     NodeIterator it(f);
-    it.Initialize();
-    std::reverse(it.ordered_->begin(), it.ordered_->end());
+    it.Initialize(/*reverse=*/false);
     return it;
   }
 
   static NodeIterator CreateReverse(FunctionBase* f) {
     NodeIterator it(f);
-    it.Initialize();
+    it.Initialize(/*reverse=*/true);
     return it;
   }
 
@@ -48,7 +47,13 @@ class NodeIterator {
  private:
   explicit NodeIterator(FunctionBase* f) : f_(f) {}
 
-  void Initialize();
+  // Computes the order. If `f_` maintains an incremental topological order
+  // which is valid the order is copied from it, otherwise it is computed from
+  // scratch (and used to reset the incremental order if there is one).
+  void Initialize(bool reverse);
+
+  // Computes a reverse topological order from scratch.
+  void ComputeReverseOrder();
 
   // The vector of nodes is wrapped in a unique_ptr so that the
   // NodeIterator may be movable but the iterators returned to the
@@ -67,7 +72,10 @@ class NodeIterator {
 // satisfied).
 //
 // Note that the ordering for all nodes is computed up front, *not*
-// incrementally as iteration proceeds.
+// incrementally as iteration proceeds, so the function may be mutated while
+// iterating. If incremental topological sorting is enabled on the function
+// (FunctionBase::SetIncrementalTopoSortEnabled) the order is copied from the
+// maintained order rather than computed from scratch.
 inline NodeIterator TopoSort(FunctionBase* f) {
   return NodeIterator::Create(f);
 }
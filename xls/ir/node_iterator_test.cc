@@ -14,10 +14,16 @@
 
 #include "xls/ir/node_iterator.h"
 
+#include <random>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/random/distributions.h"
+#include "absl/random/random.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -267,5 +273,125 @@ TEST(NodeIteratorTest, RpoVsTopo) {
   EXPECT_EQ(rni.end(), it);
 }
 
+// Returns true if `order` contains every node of `f` exactly once with every
+// node after its operands.
+bool IsTopologicalOrder(FunctionBase* f, const std::vector<Node*>& order) {
+  absl::flat_hash_map<Node*, int64_t> position;
+  for (int64_t i = 0; i < order.size(); ++i) {
+    if (!position.insert({order[i], i}).second) {
+      return false;
+    }
+  }
+  if (position.size() != f->node_count()) {
+    return false;
+  }
+  for (Node* node : f->nodes()) {
+    for (Node* operand : node->operands()) {
+      if (position.at(operand) >= position.at(node)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TEST(NodeIteratorTest, IncrementalTopoSort) {
+  std::string program = R"(
+  fn computation(a: bits[32], b: bits[32]) -> bits[32] {
+    x: bits[32] = neg(a)
+    y: bits[32] = neg(b)
+    z: bits[32] = add(x, y)
+    ret r: bits[32] = add(z, a)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+  std::vector<Node*> from_scratch = TopoSort(f).AsVector();
+
+  f->SetIncrementalTopoSortEnabled(true);
+  ASSERT_NE(f->incremental_topo_order(), nullptr);
+  EXPECT_FALSE(f->incremental_topo_order()->valid());
+  // The first sort computes the order from scratch.
+  EXPECT_EQ(TopoSort(f).AsVector(), from_scratch);
+  EXPECT_TRUE(f->incremental_topo_order()->valid());
+
+  // Add a node which is then used by a node earlier in the order.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * x, f->GetNode("x"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * y, f->GetNode("y"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * not_b,
+                           f->MakeNode<UnOp>(SourceInfo(), f->param(1),
+                                             Op::kNot));
+  XLS_ASSERT_OK(x->ReplaceOperandNumber(0, not_b));
+  EXPECT_TRUE(f->incremental_topo_order()->valid());
+  std::vector<Node*> order = TopoSort(f).AsVector();
+  EXPECT_TRUE(IsTopologicalOrder(f, order));
+
+  // Replace uses of a node with one later in the order.
+  XLS_ASSERT_OK_AND_ASSIGN(Node * neg_not_b,
+                           f->MakeNode<UnOp>(SourceInfo(), not_b, Op::kNeg));
+  XLS_ASSERT_OK(y->ReplaceUsesWith(neg_not_b));
+  XLS_ASSERT_OK(f->RemoveNode(y));
+  EXPECT_TRUE(IsTopologicalOrder(f, TopoSort(f).AsVector()));
+
+  std::vector<Node*> reverse = ReverseTopoSort(f).AsVector();
+  std::reverse(reverse.begin(), reverse.end());
+  EXPECT_EQ(reverse, TopoSort(f).AsVector());
+
+  f->SetIncrementalTopoSortEnabled(false);
+  EXPECT_EQ(f->incremental_topo_order(), nullptr);
+  EXPECT_TRUE(IsTopologicalOrder(f, TopoSort(f).AsVector()));
+}
+
+TEST(NodeIteratorTest, IncrementalTopoSortRandomMutations) {
+  Package p("p");
+  FunctionBuilder fb("f", &p);
+  std::vector<BValue> values = {fb.Param("a", p.GetBitsType(8)),
+                                fb.Param("b", p.GetBitsType(8))};
+  for (int64_t i = 0; i < 40; ++i) {
+    values.push_back(fb.Add(values[i], values[i + 1]));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(
+                                             fb.Concat(values)));
+  f->SetIncrementalTopoSortEnabled(true);
+  TopoSort(f);
+
+  std::minstd_rand bitgen;
+  for (int64_t iteration = 0; iteration < 200; ++iteration) {
+    // Pick a random add and a random replacement for one of its operands
+    // which keeps the graph acyclic, i.e. a node with a smaller index in
+    // `nodes` which lists the adds in construction order.
+    std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
+    std::vector<Node*> adds;
+    for (Node* node : nodes) {
+      if (node->op() == Op::kAdd) {
+        adds.push_back(node);
+      }
+    }
+    std::sort(adds.begin(), adds.end(), Node::NodeIdLessThan());
+    int64_t user_index = absl::Uniform<int64_t>(bitgen, 1, adds.size());
+    Node* user = adds[user_index];
+    if (absl::Bernoulli(bitgen, 0.3)) {
+      // Add a new node which the user then uses.
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Node * new_node,
+          f->MakeNode<UnOp>(SourceInfo(), adds[user_index - 1], Op::kNeg));
+      XLS_ASSERT_OK(user->ReplaceOperandNumber(0, new_node));
+    } else {
+      int64_t operand_index = absl::Uniform<int64_t>(bitgen, 0, user_index);
+      XLS_ASSERT_OK(user->ReplaceOperandNumber(
+          absl::Uniform<int64_t>(bitgen, 0, 2), adds[operand_index]));
+    }
+    // Remove dead nodes.
+    for (Node* node : TopoSort(f)) {
+      if (node->users().empty() && !f->HasImplicitUse(node) &&
+          !node->Is<Param>()) {
+        XLS_ASSERT_OK(f->RemoveNode(node));
+      }
+    }
+    ASSERT_TRUE(f->incremental_topo_order()->valid());
+    ASSERT_TRUE(IsTopologicalOrder(f, TopoSort(f).AsVector()));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -37,6 +37,7 @@ namespace xls {
 namespace {
 
 using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::UnorderedElementsAre;
 
@@ -499,6 +500,64 @@ fn ReplaceUses(x: bits[8], y: bits[8]) -> bits[16] {
   EXPECT_EQ(f->return_value()->op(), Op::kLiteral);
 }
 
+TEST_F(NodeTest, ReplaceUsesMergesUsersInIdOrder) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn ReplaceUses(x: bits[8], y: bits[8]) -> bits[8] {
+  not.1: bits[8] = not(x)
+  neg.2: bits[8] = neg(y)
+  and.3: bits[8] = and(x, x, y)
+  not.4: bits[8] = not(y)
+  neg.5: bits[8] = neg(x)
+  ret or.6: bits[8] = or(not.1, neg.2, and.3, not.4, neg.5)
+}
+)",
+                                                       p.get()));
+  Node* x = FindNode("x", f);
+  Node* y = FindNode("y", f);
+  XLS_ASSERT_OK(x->ReplaceUsesWith(y));
+  EXPECT_TRUE(x->users().empty());
+  EXPECT_THAT(y->users(),
+              ElementsAre(FindNode("not.1", f), FindNode("neg.2", f),
+                          FindNode("and.3", f), FindNode("not.4", f),
+                          FindNode("neg.5", f)));
+  EXPECT_THAT(FindNode("and.3", f)->operands(), ElementsAre(y, y, y));
+  XLS_ASSERT_OK(VerifyFunction(f));
+
+  // Adding and removing individual users keeps the set sorted by id.
+  XLS_ASSERT_OK(FindNode("neg.2", f)->ReplaceOperandNumber(0, x));
+  XLS_ASSERT_OK(FindNode("not.1", f)->ReplaceOperandNumber(0, x));
+  XLS_ASSERT_OK(FindNode("neg.5", f)->ReplaceOperandNumber(0, x));
+  EXPECT_THAT(x->users(),
+              ElementsAre(FindNode("not.1", f), FindNode("neg.2", f),
+                          FindNode("neg.5", f)));
+  EXPECT_THAT(y->users(),
+              ElementsAre(FindNode("and.3", f), FindNode("not.4", f)));
+  XLS_ASSERT_OK(VerifyFunction(f));
+}
+
+TEST_F(NodeTest, ReplaceUsesWithUserOfSelf) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn ReplaceUses(x: bits[8]) -> bits[8] {
+  not.1: bits[8] = not(x)
+  neg.2: bits[8] = neg(x)
+  ret add.3: bits[8] = add(x, neg.2)
+}
+)",
+                                                       p.get()));
+  // Replace x with a user of x, as is done when interposing a node between x
+  // and its users. The replacement keeps x as its operand.
+  Node* x = FindNode("x", f);
+  Node* neg = FindNode("neg.2", f);
+  XLS_ASSERT_OK(x->ReplaceUsesWith(neg));
+  EXPECT_THAT(x->users(), ElementsAre(neg));
+  EXPECT_THAT(neg->operands(), ElementsAre(x));
+  EXPECT_THAT(neg->users(),
+              ElementsAre(FindNode("not.1", f), FindNode("add.3", f)));
+  EXPECT_THAT(FindNode("add.3", f)->operands(), ElementsAre(neg, neg));
+}
+
 TEST_F(NodeTest, ReplaceUsesWithInvalidNewNode) {
   Package p(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
@@ -16,6 +16,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <limits>
 #include <list>
 #include <memory>
 #include <optional>
@@ -25,6 +27,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
@@ -32,10 +35,12 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/block.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/channel.h"
@@ -47,6 +52,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/instantiation.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -56,6 +62,18 @@
 
 namespace xls {
 
+struct Package::CheckpointLog {
+  std::optional<FunctionBase*> top;
+  int64_t next_node_id;
+  int64_t next_channel_id;
+  std::vector<Function*> functions;
+  std::vector<Proc*> procs;
+  std::vector<Channel*> channels;
+  std::vector<std::unique_ptr<Function>> removed_functions;
+  std::vector<std::unique_ptr<Proc>> removed_procs;
+  std::vector<std::unique_ptr<Channel>> removed_channels;
+};
+
 Package::Package(std::string_view name) : name_(name) {
   owned_types_.insert(&token_type_);
 }
@@ -147,16 +165,19 @@ absl::StatusOr<FunctionBase*> Package::GetFunctionBaseByName(
 }
 
 Function* Package::AddFunction(std::unique_ptr<Function> f) {
+  absl::MutexLock lock(&function_bases_mutex_);
   functions_.push_back(std::move(f));
   return functions_.back().get();
 }
 
 Proc* Package::AddProc(std::unique_ptr<Proc> proc) {
+  absl::MutexLock lock(&function_bases_mutex_);
   procs_.push_back(std::move(proc));
   return procs_.back().get();
 }
 
 Block* Package::AddBlock(std::unique_ptr<Block> block) {
+  absl::MutexLock lock(&function_bases_mutex_);
   blocks_.push_back(std::move(block));
   return blocks_.back().get();
 }
@@ -318,6 +339,124 @@ absl::StatusOr<Package::PackageMergeResult> Package::AddPackage(
       .channel_id_updates = std::move(channel_id_updates)};
 }
 
+absl::StatusOr<std::unique_ptr<Package>> Package::ClonePackage(
+    std::optional<std::string_view> new_name,
+    std::optional<int64_t> thread_count) const {
+  auto clone = std::make_unique<Package>(new_name.value_or(name_));
+  clone->maximum_fileno_ = maximum_fileno_;
+  clone->fileno_to_filename_ = fileno_to_filename_;
+  clone->filename_to_fileno_ = filename_to_fileno_;
+  absl::flat_hash_map<int64_t, int64_t> channel_remapping;
+  for (Channel* channel : channel_vec_) {
+    XLS_ASSIGN_OR_RETURN(Channel * cloned_channel,
+                         clone->CloneChannel(channel, channel->name()));
+    channel_remapping[channel->id()] = cloned_channel->id();
+  }
+
+  // Group the function bases into levels such that each depends only on
+  // function bases of lower levels. The function bases of a level are cloned
+  // concurrently once the lower levels are cloned.
+  std::vector<FunctionBase*> function_bases = GetFunctionBases();
+  absl::flat_hash_map<FunctionBase*, int64_t> levels;
+  std::function<int64_t(FunctionBase*)> get_level =
+      [&](FunctionBase* function_base) -> int64_t {
+    auto it = levels.find(function_base);
+    if (it != levels.end()) {
+      return it->second;
+    }
+    int64_t level = 0;
+    for (Function* callee : CalledFunctions(function_base)) {
+      level = std::max(level, get_level(callee) + 1);
+    }
+    if (function_base->IsBlock()) {
+      for (Instantiation* inst :
+           function_base->AsBlockOrDie()->GetInstantiations()) {
+        if (inst->kind() == InstantiationKind::kBlock) {
+          Block* instantiated = static_cast<BlockInstantiation*>(inst)
+                                    ->instantiated_block();
+          level = std::max(level, get_level(instantiated) + 1);
+        }
+      }
+    }
+    levels[function_base] = level;
+    return level;
+  };
+  std::vector<std::vector<int64_t>> indices_by_level;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    int64_t level = get_level(function_bases[i]);
+    if (level >= indices_by_level.size()) {
+      indices_by_level.resize(level + 1);
+    }
+    indices_by_level[level].push_back(i);
+  }
+
+  absl::flat_hash_map<const FunctionBase*, FunctionBase*>
+      function_base_remapping;
+  absl::flat_hash_map<const Function*, Function*> function_remapping;
+  absl::flat_hash_map<const Block*, Block*> block_remapping;
+  std::vector<absl::StatusOr<FunctionBase*>> clones(function_bases.size());
+  auto clone_function_base =
+      [&](FunctionBase* function_base) -> absl::StatusOr<FunctionBase*> {
+    if (function_base->IsFunction()) {
+      return function_base->AsFunctionOrDie()->Clone(
+          function_base->name(), clone.get(), function_remapping);
+    }
+    if (function_base->IsProc()) {
+      return function_base->AsProcOrDie()->Clone(
+          function_base->name(), clone.get(), channel_remapping,
+          function_base_remapping);
+    }
+    return function_base->AsBlockOrDie()->Clone(function_base->name(),
+                                               clone.get(), block_remapping);
+  };
+  clone->stage_node_ids_ = true;
+  for (const std::vector<int64_t>& indices : indices_by_level) {
+    BoundedParallelFor(
+        0, indices.size(),
+        thread_count.value_or(std::numeric_limits<int64_t>::max()),
+        [&](int64_t index) {
+          clones[indices[index]] =
+              clone_function_base(function_bases[indices[index]]);
+        });
+    for (int64_t index : indices) {
+      XLS_ASSIGN_OR_RETURN(FunctionBase * cloned, clones[index]);
+      FunctionBase* function_base = function_bases[index];
+      function_base_remapping[function_base] = cloned;
+      if (function_base->IsFunction()) {
+        function_remapping[function_base->AsFunctionOrDie()] =
+            cloned->AsFunctionOrDie();
+      } else if (function_base->IsBlock()) {
+        block_remapping[function_base->AsBlockOrDie()] =
+            cloned->AsBlockOrDie();
+      }
+    }
+  }
+  clone->stage_node_ids_ = false;
+
+  // Give the function bases the order and the nodes the ids they would have
+  // had if the function bases were cloned one at a time in order.
+  absl::flat_hash_map<const FunctionBase*, int64_t> clone_order;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    FunctionBase* cloned = function_base_remapping.at(function_bases[i]);
+    clone_order[cloned] = i;
+    if (cloned->IsStagingNodeIds()) {
+      cloned->EndNodeIdStaging();
+    }
+  }
+  auto by_clone_order = [&](const auto& a, const auto& b) {
+    return clone_order.at(a.get()) < clone_order.at(b.get());
+  };
+  absl::c_sort(clone->functions_, by_clone_order);
+  absl::c_sort(clone->procs_, by_clone_order);
+  absl::c_sort(clone->blocks_, by_clone_order);
+
+  if (top_.has_value()) {
+    XLS_RETURN_IF_ERROR(
+        clone->SetTop(function_base_remapping.at(top_.value())));
+  }
+  return clone;
+}
+
 absl::StatusOr<Function*> Package::GetFunction(
     std::string_view func_name) const {
   for (auto& f : functions_) {
@@ -394,14 +533,17 @@ absl::Status Package::RemoveFunction(Function* function) {
         "Cannot remove function: %s. The function is the top entity.",
         function->name()));
   }
-  auto it = std::remove_if(
+  auto it = std::find_if(
       functions_.begin(), functions_.end(),
       [&](const std::unique_ptr<Function>& f) { return f.get() == function; });
   if (it == functions_.end()) {
     return absl::NotFoundError(absl::StrFormat(
         "`%s` is not a function in package `%s`", function->name(), name()));
   }
-  functions_.erase(it, functions_.end());
+  if (checkpoint_ != nullptr) {
+    checkpoint_->removed_functions.push_back(std::move(*it));
+  }
+  functions_.erase(it);
   return absl::OkStatus();
 }
 
@@ -410,14 +552,17 @@ absl::Status Package::RemoveProc(Proc* proc) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Cannot remove proc: %s. The proc is the top entity.", proc->name()));
   }
-  auto it = std::remove_if(
+  auto it = std::find_if(
       procs_.begin(), procs_.end(),
       [&](const std::unique_ptr<Proc>& f) { return f.get() == proc; });
   if (it == procs_.end()) {
     return absl::NotFoundError(absl::StrFormat(
         "`%s` is not a proc in package `%s`", proc->name(), name()));
   }
-  procs_.erase(it, procs_.end());
+  if (checkpoint_ != nullptr) {
+    checkpoint_->removed_procs.push_back(std::move(*it));
+  }
+  procs_.erase(it);
   return absl::OkStatus();
 }
 
@@ -438,6 +583,127 @@ absl::Status Package::RemoveBlock(Block* block) {
   return absl::OkStatus();
 }
 
+namespace {
+
+// Moves the elements of `owned` and `removed` whose pointers appear in
+// `order` into a vector in that order. The remaining elements (those added
+// since `order` was recorded) are returned in `added`.
+template <typename T>
+absl::StatusOr<std::vector<std::unique_ptr<T>>> RestoreOrder(
+    absl::Span<T* const> order, std::vector<std::unique_ptr<T>>& owned,
+    std::vector<std::unique_ptr<T>>& removed,
+    std::vector<std::unique_ptr<T>>& added) {
+  absl::flat_hash_map<T*, std::unique_ptr<T>> by_pointer;
+  for (std::unique_ptr<T>& element : owned) {
+    T* ptr = element.get();
+    by_pointer[ptr] = std::move(element);
+  }
+  for (std::unique_ptr<T>& element : removed) {
+    T* ptr = element.get();
+    by_pointer[ptr] = std::move(element);
+  }
+  std::vector<std::unique_ptr<T>> result;
+  result.reserve(order.size());
+  for (T* ptr : order) {
+    auto it = by_pointer.find(ptr);
+    XLS_RET_CHECK(it != by_pointer.end());
+    result.push_back(std::move(it->second));
+    by_pointer.erase(it);
+  }
+  for (auto& [ptr, element] : by_pointer) {
+    added.push_back(std::move(element));
+  }
+  return result;
+}
+
+}  // namespace
+
+absl::Status Package::Checkpoint() {
+  XLS_RET_CHECK(checkpoint_ == nullptr)
+      << "Package " << name() << " already holds a checkpoint";
+  if (!blocks_.empty()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Cannot checkpoint package %s which contains blocks", name()));
+  }
+  auto log = std::make_unique<CheckpointLog>();
+  log->top = top_;
+  log->next_node_id = next_node_id_;
+  log->next_channel_id = next_channel_id_;
+  log->channels = channel_vec_;
+  for (std::unique_ptr<Function>& function : functions_) {
+    XLS_RETURN_IF_ERROR(function->Checkpoint());
+    log->functions.push_back(function.get());
+  }
+  for (std::unique_ptr<Proc>& proc : procs_) {
+    XLS_RETURN_IF_ERROR(proc->Checkpoint());
+    log->procs.push_back(proc.get());
+  }
+  checkpoint_ = std::move(log);
+  return absl::OkStatus();
+}
+
+absl::Status Package::RollbackToCheckpoint() {
+  XLS_RET_CHECK(checkpoint_ != nullptr)
+      << "Package " << name() << " does not hold a checkpoint";
+  std::unique_ptr<CheckpointLog> log = std::move(checkpoint_);
+
+  // Entities added since the checkpoint are destroyed only after the entities
+  // which may refer to them have been restored.
+  std::vector<std::unique_ptr<Function>> added_functions;
+  std::vector<std::unique_ptr<Proc>> added_procs;
+  std::vector<std::unique_ptr<Channel>> added_channels;
+  XLS_ASSIGN_OR_RETURN(
+      functions_,
+      RestoreOrder<Function>(log->functions, functions_,
+                             log->removed_functions, added_functions));
+  XLS_ASSIGN_OR_RETURN(procs_, RestoreOrder<Proc>(log->procs, procs_,
+                                                  log->removed_procs,
+                                                  added_procs));
+  // The package held no blocks at the checkpoint.
+  std::vector<std::unique_ptr<Block>> added_blocks = std::move(blocks_);
+  blocks_.clear();
+  for (std::unique_ptr<Function>& function : functions_) {
+    XLS_RETURN_IF_ERROR(function->RollbackToCheckpoint());
+  }
+  for (std::unique_ptr<Proc>& proc : procs_) {
+    XLS_RETURN_IF_ERROR(proc->RollbackToCheckpoint());
+  }
+
+  std::vector<std::unique_ptr<Channel>> owned_channels;
+  owned_channels.reserve(channels_.size());
+  for (auto& [id, channel] : channels_) {
+    owned_channels.push_back(std::move(channel));
+  }
+  channels_.clear();
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::unique_ptr<Channel>> channels,
+      RestoreOrder<Channel>(log->channels, owned_channels,
+                            log->removed_channels, added_channels));
+  for (std::unique_ptr<Channel>& channel : channels) {
+    int64_t id = channel->id();
+    channels_[id] = std::move(channel);
+  }
+  channel_vec_ = std::move(log->channels);
+
+  top_ = log->top;
+  next_node_id_ = log->next_node_id;
+  next_channel_id_ = log->next_channel_id;
+  return absl::OkStatus();
+}
+
+absl::Status Package::CommitCheckpoint() {
+  XLS_RET_CHECK(checkpoint_ != nullptr)
+      << "Package " << name() << " does not hold a checkpoint";
+  std::unique_ptr<CheckpointLog> log = std::move(checkpoint_);
+  for (Function* function : log->functions) {
+    XLS_RETURN_IF_ERROR(function->CommitCheckpoint());
+  }
+  for (Proc* proc : log->procs) {
+    XLS_RETURN_IF_ERROR(proc->CommitCheckpoint());
+  }
+  return absl::OkStatus();
+}
+
 SourceLocation Package::AddSourceLocation(std::string_view filename,
                                           Lineno lineno, Colno colno) {
   Fileno this_fileno = GetOrCreateFileno(filename);
@@ -488,6 +754,7 @@ absl::StatusOr<Type*> Package::MapTypeFromOtherPackage(
 }
 
 BitsType* Package::GetBitsType(int64_t bit_count) {
+  absl::MutexLock lock(&types_mutex_);
   if (bit_count_to_type_.find(bit_count) != bit_count_to_type_.end()) {
     return &bit_count_to_type_.at(bit_count);
   }
@@ -499,10 +766,11 @@ BitsType* Package::GetBitsType(int64_t bit_count) {
 
 ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
   ArrayKey key{size, element_type};
+  absl::MutexLock lock(&types_mutex_);
   if (array_types_.find(key) != array_types_.end()) {
     return &array_types_.at(key);
   }
-  XLS_CHECK(IsOwnedType(element_type))
+  XLS_CHECK(owned_types_.contains(element_type))
       << "Type is not owned by package: " << *element_type;
   auto it = array_types_.emplace(key, ArrayType(size, element_type));
   ArrayType* new_type = &(it.first->second);
@@ -512,11 +780,12 @@ ArrayType* Package::GetArrayType(int64_t size, Type* element_type) {
 
 TupleType* Package::GetTupleType(absl::Span<Type* const> element_types) {
   TypeVec key(element_types.begin(), element_types.end());
+  absl::MutexLock lock(&types_mutex_);
   if (tuple_types_.find(key) != tuple_types_.end()) {
     return &tuple_types_.at(key);
   }
   for (const Type* element_type : element_types) {
-    XLS_CHECK(IsOwnedType(element_type))
+    XLS_CHECK(owned_types_.contains(element_type))
         << "Type is not owned by package: " << *element_type;
   }
   auto it = tuple_types_.emplace(key, TupleType(element_types));
@@ -530,11 +799,12 @@ TokenType* Package::GetTokenType() { return &token_type_; }
 FunctionType* Package::GetFunctionType(absl::Span<Type* const> args_types,
                                        Type* return_type) {
   std::string key = FunctionType(args_types, return_type).ToString();
+  absl::MutexLock lock(&types_mutex_);
   if (function_types_.find(key) != function_types_.end()) {
     return &function_types_.at(key);
   }
   for (Type* t : args_types) {
-    XLS_CHECK(IsOwnedType(t))
+    XLS_CHECK(owned_types_.contains(t))
         << "Parameter type is not owned by package: " << t->ToString();
   }
   auto it = function_types_.emplace(key, FunctionType(args_types, return_type));
@@ -660,7 +930,7 @@ std::optional<std::string> Package::GetFilename(Fileno file_number) const {
 
 int64_t Package::GetNodeCount() const {
   int64_t count = 0;
-  for (const auto& f : functions()) {
+  for (FunctionBase* f : GetFunctionBases()) {
     count += f->node_count();
   }
   return count;
@@ -845,8 +1115,12 @@ absl::Status Package::RemoveChannel(Channel* channel) {
   channel_vec_.erase(it);
 
   // Remove from channel map.
-  XLS_RET_CHECK(channels_.contains(channel->id()));
-  channels_.erase(channel->id());
+  auto channel_it = channels_.find(channel->id());
+  XLS_RET_CHECK(channel_it != channels_.end());
+  if (checkpoint_ != nullptr) {
+    checkpoint_->removed_channels.push_back(std::move(channel_it->second));
+  }
+  channels_.erase(channel_it);
 
   return absl::OkStatus();
 }
@@ -30,6 +30,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel.pb.h"
@@ -81,13 +82,18 @@ class Package {
 
   // Returns whether the given type is one of the types owned by this package.
   bool IsOwnedType(const Type* type) const {
-    return owned_types_.find(type) != owned_types_.end();
+    absl::MutexLock lock(&types_mutex_);
+    return owned_types_.contains(type);
   }
   bool IsOwnedFunctionType(const FunctionType* function_type) const {
-    return owned_function_types_.find(function_type) !=
-           owned_function_types_.end();
+    absl::MutexLock lock(&types_mutex_);
+    return owned_function_types_.contains(function_type);
   }
 
+  // Returns the owned type with the given structure, creating it if
+  // necessary. These methods (and IsOwnedType and IsOwnedFunctionType) are
+  // thread-safe so nodes may be created in different function bases
+  // concurrently (see FunctionBase::BeginNodeIdStaging).
   BitsType* GetBitsType(int64_t bit_count);
   ArrayType* GetArrayType(int64_t size, Type* element_type);
   TupleType* GetTupleType(absl::Span<Type* const> element_types);
@@ -107,7 +113,7 @@ class Package {
   Type* GetTypeForValue(const Value& value);
 
   // Add a function, proc, or block to the package. Ownership is tranferred to
-  // the package.
+  // the package. These methods may be called concurrently with each other.
   Function* AddFunction(std::unique_ptr<Function> f);
   Proc* AddProc(std::unique_ptr<Proc> proc);
   Block* AddBlock(std::unique_ptr<Block> block);
@@ -123,6 +129,15 @@ class Package {
   // package.
   absl::StatusOr<PackageMergeResult> AddPackage(const Package* other);
 
+  // Returns a copy of this package, named `new_name` if given. The function
+  // bases are cloned on up to `thread_count` threads of the shared thread pool
+  // (by default, all of them): function bases which do not depend on each
+  // other through calls or block instantiations are cloned concurrently. The
+  // result, including the node ids, does not depend on the number of threads.
+  absl::StatusOr<std::unique_ptr<Package>> ClonePackage(
+      std::optional<std::string_view> new_name = std::nullopt,
+      std::optional<int64_t> thread_count = std::nullopt) const;
+
   // Get a function, proc, or block by name. Returns an error if no such
   // construct of the indicated kind exists with that name.
   absl::StatusOr<Function*> GetFunction(std::string_view func_name) const;
@@ -139,6 +154,28 @@ class Package {
   absl::Status RemoveProc(Proc* proc);
   absl::Status RemoveBlock(Block* block);
 
+  // Begins recording an undo log of the mutations of this package so they can
+  // be reverted with RollbackToCheckpoint. This is much cheaper than cloning
+  // the package when trying speculative transformations (e.g., in the IR
+  // minimizer) as the cost is proportional to the number of nodes touched
+  // rather than the size of the package. A checkpoint is held on each function
+  // and proc (see FunctionBase::Checkpoint for what is restored). In addition
+  // the set of functions, procs and channels, the top entity and the next node
+  // and channel ids are restored. Function bases and channels removed while
+  // the checkpoint is held are kept alive. Attributes of channels are not
+  // restored. Packages containing blocks are not supported.
+  absl::Status Checkpoint();
+
+  // Reverts all mutations made since Checkpoint and releases the checkpoint.
+  // Function bases, nodes and channels added since the checkpoint are
+  // destroyed.
+  absl::Status RollbackToCheckpoint();
+
+  // Releases the checkpoint keeping all mutations made since Checkpoint.
+  absl::Status CommitCheckpoint();
+
+  bool HasCheckpoint() const { return checkpoint_ != nullptr; }
+
   // Returns a new SourceLocation object containing a Fileno and Lineno pair.
   // SourceLocation objects are added to XLS IR nodes and used for debug
   // tracing.
@@ -179,8 +216,8 @@ class Package {
   // Get the filename corresponding to the given `Fileno`.
   std::optional<std::string> GetFilename(Fileno file_number) const;
 
-  // Returns the total number of nodes in the graph. Traverses the functions and
-  // sums the node counts.
+  // Returns the total number of nodes in the graph. Traverses the functions,
+  // procs and blocks and sums the node counts.
   int64_t GetNodeCount() const;
 
   // Returns the functions in this package.
@@ -330,6 +367,7 @@ class Package {
   // Adds the given channel to the package.
   absl::Status AddChannel(std::unique_ptr<Channel> channel);
 
+  friend class FunctionBase;
   friend class FunctionBuilder;
 
   std::optional<FunctionBase*> top_;
@@ -344,10 +382,21 @@ class Package {
   // Ordinal to assign to the next node created in this package.
   int64_t next_node_id_ = 1;
 
+  // Guards the addition of function bases.
+  absl::Mutex function_bases_mutex_;
+
   std::vector<std::unique_ptr<Function>> functions_;
   std::vector<std::unique_ptr<Proc>> procs_;
   std::vector<std::unique_ptr<Block>> blocks_;
 
+  // While set, function bases stage the ids of the nodes created in them (see
+  // FunctionBase::BeginNodeIdStaging) so they may be populated concurrently.
+  // Set by ClonePackage.
+  bool stage_node_ids_ = false;
+
+  // Guards the owned types and the maps from type structure to owned type.
+  mutable absl::Mutex types_mutex_;
+
   // Set of owned types in this package.
   absl::flat_hash_set<const Type*> owned_types_;
 
@@ -395,6 +444,10 @@ class Package {
 
   // The next channel ID to assign.
   int64_t next_channel_id_ = 0;
+
+  // The undo log of the checkpoint held, if any.
+  struct CheckpointLog;
+  std::unique_ptr<CheckpointLog> checkpoint_;
 };
 
 std::ostream& operator<<(std::ostream& os, const Package& package);
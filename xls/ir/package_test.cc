@@ -15,7 +15,9 @@
 #include "xls/ir/package.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <vector>
 
@@ -26,14 +28,21 @@
 #include "xls/common/casts.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/block.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
+#include "xls/ir/instantiation.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
 #include "xls/ir/xls_type.pb.h"
 
 namespace xls {
@@ -1075,5 +1084,221 @@ top fn main(a: bits[32]) -> bits[32][0] {
               StatusIs(absl::StatusCode::kUnimplemented,
                        HasSubstr("Empty array Values are not supported.")));
 }
+
+TEST_F(PackageTest, CheckpointRollbackRestoresFunctions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package test
+
+fn dead(x: bits[32]) -> bits[32] {
+  ret neg.1: bits[32] = neg(x, id=1)
+}
+
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  my_add: bits[32] = add(x, y, id=3)
+  ret sub.4: bits[32] = sub(my_add, y, id=4)
+}
+)"));
+  const std::string original = p->DumpIr();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * dead, p->GetFunction("dead"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * add, main->GetNode("my_add"));
+  Node* sub = main->return_value();
+
+  XLS_ASSERT_OK(p->Checkpoint());
+  EXPECT_TRUE(p->HasCheckpoint());
+  EXPECT_TRUE(main->HasCheckpoint());
+  XLS_ASSERT_OK(add->ReplaceUsesWithNew<Literal>(Value(UBits(42, 32)))
+                    .status());
+  XLS_ASSERT_OK(main->RemoveNode(add));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg, main->MakeNode<UnOp>(SourceInfo(), sub, Op::kNeg));
+  XLS_ASSERT_OK(main->set_return_value(neg));
+  sub->SetName("renamed");
+  sub->SwapOperands(0, 1);
+  XLS_ASSERT_OK(p->RemoveFunction(dead));
+  XLS_ASSERT_OK(main->Clone("main_clone").status());
+  EXPECT_NE(p->DumpIr(), original);
+
+  XLS_ASSERT_OK(p->RollbackToCheckpoint());
+  EXPECT_FALSE(p->HasCheckpoint());
+  EXPECT_FALSE(main->HasCheckpoint());
+  EXPECT_EQ(p->DumpIr(), original);
+  EXPECT_EQ(main->return_value(), sub);
+  EXPECT_THAT(main->GetNode("my_add"), IsOkAndHolds(add));
+  EXPECT_THAT(p->GetFunction("dead"), IsOkAndHolds(dead));
+  EXPECT_EQ(p->functions().size(), 2);
+  XLS_EXPECT_OK(VerifyPackage(p.get()));
+}
+
+TEST_F(PackageTest, CheckpointRollbackRestoresProcsAndChannels) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan unused(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+
+top proc my_proc(tkn: token, a: bits[32], b: bits[32], init={1, 2}) {
+  receive.1: (token, bits[32]) = receive(tkn, channel_id=0, id=1)
+  tuple_index.2: token = tuple_index(receive.1, index=0, id=2)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1, id=3)
+  add.4: bits[32] = add(a, tuple_index.3, id=4)
+  next (tuple_index.2, add.4, b)
+}
+)"));
+  const std::string original = p->DumpIr();
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, p->GetProc("my_proc"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * unused, p->GetChannel("unused"));
+
+  XLS_ASSERT_OK(p->Checkpoint());
+  XLS_ASSERT_OK(proc->SetNextStateElement(1, proc->GetStateParam(0)));
+  XLS_ASSERT_OK(proc->RemoveStateElement(1));
+  XLS_ASSERT_OK(proc->SetNextToken(proc->TokenParam()));
+  XLS_ASSERT_OK(proc->AppendStateElement("c", Value(UBits(3, 32))).status());
+  XLS_ASSERT_OK(p->RemoveChannel(unused));
+  XLS_ASSERT_OK(p->CreateStreamingChannel("new_chan", ChannelOps::kSendOnly,
+                                          p->GetBitsType(8))
+                    .status());
+  EXPECT_NE(p->DumpIr(), original);
+
+  XLS_ASSERT_OK(p->RollbackToCheckpoint());
+  EXPECT_EQ(p->DumpIr(), original);
+  EXPECT_THAT(p->GetChannel("unused"), IsOkAndHolds(unused));
+  EXPECT_FALSE(p->GetChannel("new_chan").ok());
+  EXPECT_EQ(proc->GetStateElementCount(), 2);
+  XLS_EXPECT_OK(VerifyPackage(p.get()));
+}
+
+TEST_F(PackageTest, CheckpointCommitKeepsChanges) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package test
+
+top fn main(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, p->GetFunction("main"));
+  XLS_ASSERT_OK(p->Checkpoint());
+  XLS_ASSERT_OK(main->set_return_value(main->param(0)));
+  XLS_ASSERT_OK(main->RemoveNode(main->GetNode("neg.2").value()));
+  XLS_ASSERT_OK(p->CommitCheckpoint());
+  EXPECT_FALSE(main->HasCheckpoint());
+  EXPECT_EQ(main->node_count(), 1);
+  EXPECT_EQ(main->return_value(), main->param(0));
+  EXPECT_THAT(p->RollbackToCheckpoint(),
+              StatusIs(absl::StatusCode::kInternal));
+
+  // The package may be checkpointed again after a commit.
+  const std::string committed = p->DumpIr();
+  XLS_ASSERT_OK(p->Checkpoint());
+  XLS_ASSERT_OK(
+      main->MakeNode<UnOp>(SourceInfo(), main->param(0), Op::kNot).status());
+  XLS_ASSERT_OK(p->RollbackToCheckpoint());
+  EXPECT_EQ(p->DumpIr(), committed);
+}
+
+TEST_F(PackageTest, CheckpointWithBlocksIsUnimplemented) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package test
+
+block my_block(a: bits[32], out: bits[32]) {
+  a: bits[32] = input_port(name=a, id=1)
+  out: () = output_port(a, name=out, id=2)
+}
+)"));
+  EXPECT_THAT(p->Checkpoint(), StatusIs(absl::StatusCode::kUnimplemented));
+  EXPECT_FALSE(p->HasCheckpoint());
+}
+
+TEST_F(PackageTest, ClonePackage) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="""""")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="""""")
+
+fn leaf(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+
+fn other_leaf(x: bits[32]) -> bits[32] {
+  ret not.4: bits[32] = not(x, id=4)
+}
+
+fn middle(x: bits[32]) -> bits[32] {
+  invoke.6: bits[32] = invoke(x, to_apply=leaf, id=6)
+  ret invoke.7: bits[32] = invoke(invoke.6, to_apply=other_leaf, id=7)
+}
+
+top fn main(x: bits[32]) -> bits[32] {
+  invoke.9: bits[32] = invoke(x, to_apply=middle, id=9)
+  ret add.10: bits[32] = add(invoke.9, x, id=10)
+}
+
+proc my_proc(tkn: token, st: bits[32], init={42}) {
+  receive.13: (token, bits[32]) = receive(tkn, channel_id=0, id=13)
+  tuple_index.14: token = tuple_index(receive.13, index=0, id=14)
+  tuple_index.15: bits[32] = tuple_index(receive.13, index=1, id=15)
+  invoke.16: bits[32] = invoke(tuple_index.15, to_apply=leaf, id=16)
+  send.17: token = send(tuple_index.14, invoke.16, channel_id=1, id=17)
+  next (send.17, invoke.16)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> serial_clone,
+                           p->ClonePackage("clone", /*thread_count=*/1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> parallel_clone,
+                           p->ClonePackage("clone", /*thread_count=*/4));
+  EXPECT_EQ(serial_clone->name(), "clone");
+  EXPECT_EQ(serial_clone->DumpIr(), parallel_clone->DumpIr());
+  XLS_ASSERT_OK(VerifyPackage(parallel_clone.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> clone, p->ClonePackage());
+  EXPECT_EQ(clone->name(), p->name());
+  EXPECT_EQ(clone->GetNodeCount(), p->GetNodeCount());
+
+  // The clone refers only to its own function bases.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * main, clone->GetTopAsFunction());
+  EXPECT_EQ(main->name(), "main");
+  for (FunctionBase* function_base : clone->GetFunctionBases()) {
+    for (Node* node : function_base->nodes()) {
+      if (node->Is<Invoke>()) {
+        EXPECT_EQ(node->As<Invoke>()->to_apply()->package(), clone.get());
+      }
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(FunctionBase * original,
+                             p->GetFunctionBaseByName(function_base->name()));
+    EXPECT_EQ(function_base->GetFingerprint(), original->GetFingerprint());
+  }
+}
+
+TEST_F(PackageTest, ClonePackageWithBlockInstantiation) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+package test
+
+block sub_block(in: bits[32], out: bits[32]) {
+  in: bits[32] = input_port(name=in, id=1)
+  out: () = output_port(in, name=out, id=2)
+}
+
+block my_block(x: bits[32], y: bits[32]) {
+  instantiation foo(block=sub_block, kind=block)
+  x: bits[32] = input_port(name=x, id=3)
+  foo_in: () = instantiation_input(x, instantiation=foo, port_name=in, id=4)
+  foo_out: bits[32] = instantiation_output(instantiation=foo, port_name=out, id=5)
+  y: () = output_port(foo_out, name=y, id=6)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> clone,
+                           p->ClonePackage(std::nullopt,
+                                           /*thread_count=*/2));
+  XLS_ASSERT_OK(VerifyPackage(clone.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * my_block, clone->GetBlock("my_block"));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub_block, clone->GetBlock("sub_block"));
+  ASSERT_EQ(my_block->GetInstantiations().size(), 1);
+  auto* instantiation = dynamic_cast<BlockInstantiation*>(
+      my_block->GetInstantiations().front());
+  ASSERT_NE(instantiation, nullptr);
+  EXPECT_EQ(instantiation->instantiated_block(), sub_block);
+}
+
 }  // namespace
 }  // namespace xls
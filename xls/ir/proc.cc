@@ -102,6 +102,7 @@ absl::Status Proc::SetNextToken(Node* next) {
         next->GetName(), next->GetType()->ToString()));
   }
   next_token_ = next;
+  NoteNodeChanged(next);
   return absl::OkStatus();
 }
 
@@ -136,6 +137,7 @@ absl::Status Proc::SetNextStateElement(int64_t index, Node* next) {
         GetStateElementType(index)->ToString()));
   }
   next_state_[index] = next;
+  NoteNodeChanged(next);
   return absl::OkStatus();
 }
 
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -163,6 +164,16 @@ class Proc : public FunctionBase {
 
   std::string DumpIr() const override;
 
+ protected:
+  std::function<void()> SaveStateForRollback() override {
+    return [this, init_values = init_values_, next_token = next_token_,
+            next_state = next_state_]() {
+      init_values_ = init_values;
+      next_token_ = next_token;
+      next_state_ = next_state;
+    };
+  }
+
  private:
   std::vector<Value> init_values_;
 
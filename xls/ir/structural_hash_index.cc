@@ -0,0 +1,183 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/structural_hash_index.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
+#include "absl/types/span.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+bool IsIndexed(Node* node) { return !OpIsSideEffecting(node->op()); }
+
+// Returns the nodes of `nodes` ordered by id.
+std::vector<Node*> SortedById(const absl::flat_hash_set<Node*>& nodes) {
+  std::vector<Node*> result(nodes.begin(), nodes.end());
+  std::sort(result.begin(), result.end(),
+            [](Node* a, Node* b) { return a->id() < b->id(); });
+  return result;
+}
+
+// Returns the operands of `node` for the purpose of comparison, ordered by id
+// for commutative ops so that operand order does not matter.
+absl::InlinedVector<Node*, 4> OperandsForComparison(Node* node) {
+  absl::InlinedVector<Node*, 4> operands(node->operands().begin(),
+                                         node->operands().end());
+  if (OpIsCommutative(node->op())) {
+    std::sort(operands.begin(), operands.end(),
+              [](Node* a, Node* b) { return a->id() < b->id(); });
+  }
+  return operands;
+}
+
+}  // namespace
+
+/* static */ uint64_t StructuralHashIndex::Hash(Node* node) {
+  // Hash the operands by pointer rather than id so the hash is unaffected by
+  // renumbering. Ordering commutative operands by pointer is as good as by id
+  // for hashing.
+  absl::InlinedVector<Node*, 4> operands(node->operands().begin(),
+                                         node->operands().end());
+  if (OpIsCommutative(node->op())) {
+    std::sort(operands.begin(), operands.end());
+  }
+  // Types are uniqued within a package so may be hashed by pointer. Literal
+  // values are combined into the hash so literals are not all placed in the
+  // same bucket. Hashing is cheap as aggregate values cache their hash.
+  uint64_t hash = absl::HashOf(node->op(), node->GetType(),
+                               absl::MakeConstSpan(operands));
+  if (node->Is<Literal>()) {
+    hash = absl::HashOf(hash, node->As<Literal>()->value());
+  }
+  return hash;
+}
+
+/* static */ bool StructuralHashIndex::IsStructurallyEqual(Node* a, Node* b) {
+  if (a->op() != b->op() || a->operand_count() != b->operand_count()) {
+    return false;
+  }
+  return OperandsForComparison(a) == OperandsForComparison(b) &&
+         a->IsDefinitelyEqualTo(b);
+}
+
+void StructuralHashIndex::Reset(absl::Span<Node* const> nodes) {
+  hashes_.clear();
+  buckets_.clear();
+  stale_.clear();
+  changed_.clear();
+  for (Node* node : nodes) {
+    if (IsIndexed(node)) {
+      Rehash(node);
+      changed_.insert(node);
+    }
+  }
+}
+
+void StructuralHashIndex::NoteNodeChanged(Node* node) {
+  if (IsIndexed(node)) {
+    stale_.insert(node);
+    changed_.insert(node);
+  }
+}
+
+void StructuralHashIndex::RemoveNode(Node* node) {
+  stale_.erase(node);
+  changed_.erase(node);
+  auto it = hashes_.find(node);
+  if (it == hashes_.end()) {
+    return;
+  }
+  std::vector<Node*>& bucket = buckets_.at(it->second);
+  bucket.erase(absl::c_find(bucket, node));
+  if (bucket.empty()) {
+    buckets_.erase(it->second);
+  }
+  hashes_.erase(it);
+}
+
+void StructuralHashIndex::Rehash(Node* node) {
+  uint64_t hash = Hash(node);
+  auto [it, inserted] = hashes_.insert({node, hash});
+  if (!inserted) {
+    if (it->second == hash) {
+      return;
+    }
+    std::vector<Node*>& bucket = buckets_.at(it->second);
+    bucket.erase(absl::c_find(bucket, node));
+    if (bucket.empty()) {
+      buckets_.erase(it->second);
+    }
+    it->second = hash;
+  }
+  buckets_[hash].push_back(node);
+}
+
+void StructuralHashIndex::Refresh() {
+  if (stale_.empty()) {
+    return;
+  }
+  // Rehash in id order so the order of the buckets is deterministic.
+  for (Node* node : SortedById(stale_)) {
+    Rehash(node);
+  }
+  stale_.clear();
+}
+
+Node* StructuralHashIndex::FindEquivalent(Node* node) {
+  Refresh();
+  auto it = buckets_.find(Hash(node));
+  if (it == buckets_.end()) {
+    return nullptr;
+  }
+  for (Node* candidate : it->second) {
+    if (candidate != node && IsStructurallyEqual(node, candidate)) {
+      return candidate;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<Node*> StructuralHashIndex::GetEquivalentNodes(Node* node) {
+  Refresh();
+  std::vector<Node*> result;
+  auto it = buckets_.find(Hash(node));
+  if (it == buckets_.end()) {
+    return result;
+  }
+  for (Node* candidate : it->second) {
+    if (candidate == node || IsStructurallyEqual(node, candidate)) {
+      result.push_back(candidate);
+    }
+  }
+  return result;
+}
+
+std::vector<Node*> StructuralHashIndex::TakeChangedNodes() {
+  std::vector<Node*> result = SortedById(changed_);
+  changed_.clear();
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,93 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_STRUCTURAL_HASH_INDEX_H_
+#define XLS_IR_STRUCTURAL_HASH_INDEX_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+class Node;
+
+// An index of the nodes of a FunctionBase by their structure: op, operands
+// (as an unordered set for commutative ops), type and attributes such as
+// literal values. Two nodes are structurally equal if they compute the same
+// value by construction; side-effecting nodes are never structurally equal
+// and are not indexed.
+//
+// The index is maintained incrementally as the graph is mutated. Mutated nodes
+// are rehashed lazily on the next lookup and are also recorded as changed so
+// common subexpression elimination need only consider the nodes changed since
+// it last ran. Within a bucket nodes are kept in the order they were indexed
+// so the oldest of a set of equal nodes is found first.
+class StructuralHashIndex {
+ public:
+  // Sets the index to contain `nodes` (all of the nodes of the graph). All
+  // nodes are considered changed.
+  void Reset(absl::Span<Node* const> nodes);
+
+  // Updates the index after `node` has been added to the graph or its
+  // operands have changed.
+  void NoteNodeChanged(Node* node);
+
+  // Updates the index after `node` has been removed from the graph.
+  void RemoveNode(Node* node);
+
+  // Returns the oldest indexed node other than `node` which is structurally
+  // equal to `node`, or nullptr if there is none.
+  Node* FindEquivalent(Node* node);
+
+  // Returns the indexed nodes structurally equal to `node` (including `node`
+  // itself if it is indexed) from oldest to newest.
+  std::vector<Node*> GetEquivalentNodes(Node* node);
+
+  // Returns the nodes changed since the last call, ordered by id, and clears
+  // the set of changed nodes.
+  std::vector<Node*> TakeChangedNodes();
+
+  // Returns the number of indexed nodes.
+  int64_t size() const { return hashes_.size(); }
+
+  // Returns the structural hash of `node` and whether two nodes are
+  // structurally equal.
+  static uint64_t Hash(Node* node);
+  static bool IsStructurallyEqual(Node* a, Node* b);
+
+ private:
+  // Rehashes the stale nodes.
+  void Refresh();
+
+  // Moves `node` to the bucket of its current hash.
+  void Rehash(Node* node);
+
+  // The hash under which each indexed node is bucketed.
+  absl::flat_hash_map<Node*, uint64_t> hashes_;
+  absl::flat_hash_map<uint64_t, std::vector<Node*>> buckets_;
+
+  // The nodes whose hash may have changed since they were bucketed.
+  absl::flat_hash_set<Node*> stale_;
+
+  // The nodes changed since the last TakeChangedNodes.
+  absl::flat_hash_set<Node*> changed_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_STRUCTURAL_HASH_INDEX_H_
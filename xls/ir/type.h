@@ -124,8 +124,12 @@ class TupleType : public Type {
   explicit TupleType(absl::Span<Type* const> members)
       : Type(TypeKind::kTuple), members_(members.begin(), members.end()) {
     leaf_count_ = 0;
+    flat_bit_count_ = 0;
+    leaf_offsets_.reserve(members.size());
     for (Type* t : members) {
+      leaf_offsets_.push_back(leaf_count_);
       leaf_count_ += t->leaf_count();
+      flat_bit_count_ += t->GetFlatBitCount();
     }
   }
   ~TupleType() override = default;
@@ -145,17 +149,19 @@ class TupleType : public Type {
 
   int64_t leaf_count() const override { return leaf_count_; }
 
-  int64_t GetFlatBitCount() const override {
-    int64_t total = 0;
-    for (const Type* type : members_) {
-      total += type->GetFlatBitCount();
-    }
-    return total;
+  // Returns the number of leaves in the elements preceding the given element;
+  // that is, the index of the element's first leaf among the tuple's leaves.
+  int64_t element_leaf_offset(int64_t index) const {
+    return leaf_offsets_.at(index);
   }
 
+  int64_t GetFlatBitCount() const override { return flat_bit_count_; }
+
  private:
   int64_t leaf_count_;
+  int64_t flat_bit_count_;
   std::vector<Type*> members_;
+  std::vector<int64_t> leaf_offsets_;
 };
 
 // Represents a type that is a one-dimensional array of identical types.
@@ -164,7 +170,10 @@ class TupleType : public Type {
 class ArrayType : public Type {
  public:
   explicit ArrayType(int64_t size, Type* element_type)
-      : Type(TypeKind::kArray), size_(size), element_type_(element_type) {}
+      : Type(TypeKind::kArray),
+        size_(size),
+        element_type_(element_type),
+        flat_bit_count_(element_type->GetFlatBitCount() * size) {}
   ~ArrayType() override = default;
   std::string ToString() const override;
 
@@ -174,9 +183,7 @@ class ArrayType : public Type {
   Type* element_type() const { return element_type_; }
   int64_t size() const { return size_; }
 
-  int64_t GetFlatBitCount() const override {
-    return element_type_->GetFlatBitCount() * size_;
-  }
+  int64_t GetFlatBitCount() const override { return flat_bit_count_; }
 
   int64_t leaf_count() const override {
     return size_ * element_type()->leaf_count();
@@ -185,6 +192,7 @@ class ArrayType : public Type {
  private:
   int64_t size_;
   Type* element_type_;
+  int64_t flat_bit_count_;
 };
 
 // Represents a token type used for ordering channel accesses.
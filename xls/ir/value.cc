@@ -15,6 +15,7 @@
 #include "xls/ir/value.h"
 
 #include "absl/algorithm/container.h"
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -25,6 +26,16 @@
 
 namespace xls {
 
+Value::Aggregate::Aggregate(std::vector<Value>&& elements)
+    : elements(std::move(elements)),
+      hash(absl::Hash<absl::Span<const Value>>()(this->elements)) {}
+
+/* static */ const Value::AggregatePtr& Value::EmptyAggregate() {
+  static const AggregatePtr* empty =
+      new AggregatePtr(std::make_shared<const Aggregate>(std::vector<Value>()));
+  return *empty;
+}
+
 /* static */ absl::StatusOr<Value> Value::Array(
     absl::Span<const Value> elements) {
   if (elements.empty()) {
@@ -235,7 +246,7 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
 }
 
 absl::StatusOr<std::vector<Value>> Value::GetElements() const {
-  if (!std::holds_alternative<std::vector<Value>>(payload_)) {
+  if (!std::holds_alternative<AggregatePtr>(payload_)) {
     return absl::InvalidArgumentError("Value does not hold elements.");
   }
   return std::vector<Value>(elements().begin(), elements().end());
@@ -346,13 +357,22 @@ bool Value::operator==(const Value& other) const {
   if (IsBits()) {
     return bits() == other.bits();
   }
+  if (kind() == ValueKind::kInvalid) {
+    return true;
+  }
 
-  // All non-Bits types are container types -- should have a size attribute.
-  if (size() != other.size()) {
+  // All other kinds are container types. Copies of a value share storage, and
+  // the cached hashes distinguish most unequal values without visiting the
+  // elements.
+  const AggregatePtr& lhs = std::get<AggregatePtr>(payload_);
+  const AggregatePtr& rhs = std::get<AggregatePtr>(other.payload_);
+  if (lhs == rhs) {
+    return true;
+  }
+  if (lhs->hash != rhs->hash || lhs->elements.size() != rhs->elements.size()) {
     return false;
   }
-
-  return absl::c_equal(elements(), other.elements());
+  return absl::c_equal(lhs->elements, rhs->elements);
 }
 
 }  // namespace xls
@@ -15,6 +15,11 @@
 #ifndef XLS_IR_VALUE_H_
 #define XLS_IR_VALUE_H_
 
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -51,6 +56,13 @@ inline std::ostream& operator<<(std::ostream& os, ValueKind kind) {
 // values, or arrays or values. Arrays are represented similarly to tuples, but
 // are monomorphic and potentially multi-dimensional.
 //
+// The elements of tuple and array values are held in immutable,
+// reference-counted storage which is shared between copies of the value, so
+// copying a Value is O(1) regardless of its size (e.g., a large lookup table
+// held in a literal). The structural hash of an aggregate is computed once on
+// construction, and comparing copies of the same value is a pointer
+// comparison.
+//
 // TODO(leary): 2019-04-04 Arrays are not currently multi-dimensional, we had
 // some discussion around this, maybe they should be?
 class Value {
@@ -59,7 +71,7 @@ class Value {
     return Value(ValueKind::kTuple, elements);
   }
   static Value TupleOwned(std::vector<Value>&& elements) {
-    return Value(ValueKind::kTuple, elements);
+    return Value(ValueKind::kTuple, std::move(elements));
   }
 
   // All members of "elements" must be of the same type, or an error status will
@@ -93,9 +105,7 @@ class Value {
     return Value(ValueKind::kArray, std::move(elements));
   }
 
-  static Value Token() {
-    return Value(ValueKind::kToken, std::vector<Value>({}));
-  }
+  static Value Token() { return Value(ValueKind::kToken, EmptyAggregate()); }
   static Value Bool(bool enabled) {
     return Value(UBits(/*value=*/enabled, /*bit_count=*/1));
   }
@@ -118,9 +128,7 @@ class Value {
 
   absl::StatusOr<std::vector<Value>> GetElements() const;
 
-  absl::Span<const Value> elements() const {
-    return std::get<std::vector<Value>>(payload_);
-  }
+  absl::Span<const Value> elements() const { return aggregate().elements; }
   const Value& element(int64_t i) const { return elements().at(i); }
   int64_t size() const { return elements().size(); }
   bool empty() const { return elements().empty(); }
@@ -156,16 +164,52 @@ class Value {
   bool operator==(const Value& other) const;
   bool operator!=(const Value& other) const { return !(*this == other); }
 
+  template <typename H>
+  friend H AbslHashValue(H h, const Value& value) {
+    h = H::combine(std::move(h), value.kind_);
+    if (value.IsBits()) {
+      return H::combine(std::move(h), value.bits());
+    }
+    if (std::holds_alternative<AggregatePtr>(value.payload_)) {
+      return H::combine(std::move(h), value.aggregate().hash);
+    }
+    return h;
+  }
+
  private:
+  // The shared storage of the elements of a tuple, array or token (which has
+  // no elements) value.
+  struct Aggregate {
+    explicit Aggregate(std::vector<Value>&& elements);
+
+    const std::vector<Value> elements;
+    // Structural hash of the elements.
+    const size_t hash;
+  };
+  using AggregatePtr = std::shared_ptr<const Aggregate>;
+
+  // Returns the storage shared by all values without elements.
+  static const AggregatePtr& EmptyAggregate();
+
   Value(ValueKind kind, absl::Span<const Value> elements)
-      : kind_(kind),
-        payload_(std::vector<Value>(elements.begin(), elements.end())) {}
+      : Value(kind, std::vector<Value>(elements.begin(), elements.end())) {}
 
   Value(ValueKind kind, std::vector<Value>&& elements)
-      : kind_(kind), payload_(std::move(elements)) {}
+      : kind_(kind),
+        payload_(elements.empty()
+                     ? EmptyAggregate()
+                     : std::make_shared<const Aggregate>(std::move(elements))) {
+  }
+
+  Value(ValueKind kind, AggregatePtr aggregate)
+      : kind_(kind), payload_(std::move(aggregate)) {}
+
+  const Aggregate& aggregate() const {
+    return *std::get<AggregatePtr>(payload_);
+  }
 
   ValueKind kind_;
-  std::variant<std::nullptr_t, std::vector<Value>, Bits> payload_;
+  std::variant<std::nullptr_t, AggregatePtr, Bits> payload_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Value& value) {
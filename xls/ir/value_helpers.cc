@@ -104,13 +104,16 @@ absl::StatusOr<float> TupleToF32(const Value& v) {
   return absl::bit_cast<float>(x);
 }
 
-absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree) {
+namespace {
+
+absl::StatusOr<Value> LeafTypeTreeViewToValue(
+    const LeafTypeTreeView<Value>& tree) {
   Type* type = tree.type();
   if (type->IsTuple()) {
     std::vector<Value> values;
     for (int64_t i = 0; i < type->AsTupleOrDie()->size(); ++i) {
       XLS_ASSIGN_OR_RETURN(Value value,
-                           LeafTypeTreeToValue(tree.CopySubtree({i})));
+                           LeafTypeTreeViewToValue(tree.AsView({i})));
       values.push_back(value);
     }
     return Value::TupleOwned(std::move(values));
@@ -119,7 +122,7 @@ absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree) {
     std::vector<Value> values;
     for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
       XLS_ASSIGN_OR_RETURN(Value value,
-                           LeafTypeTreeToValue(tree.CopySubtree({i})));
+                           LeafTypeTreeViewToValue(tree.AsView({i})));
       values.push_back(value);
     }
     return Value::ArrayOrDie(values);
@@ -127,6 +130,12 @@ absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree) {
   return tree.Get({});
 }
 
+}  // namespace
+
+absl::StatusOr<Value> LeafTypeTreeToValue(const LeafTypeTree<Value>& tree) {
+  return LeafTypeTreeViewToValue(tree.AsView());
+}
+
 absl::StatusOr<LeafTypeTree<Value>> ValueToLeafTypeTree(const Value& value,
                                                         Type* type) {
   XLS_RET_CHECK(ValueConformsToType(value, type));
@@ -14,8 +14,12 @@
 
 #include "xls/ir/value.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/hash/hash.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/package.h"
@@ -330,4 +334,42 @@ TEST(ValueTest, XBitsArrayWrongSizes) {
               HasSubstr("elements of arrays should have consistent size."));
 }
 
+TEST(ValueTest, CopiesShareElements) {
+  std::vector<Value> elements;
+  for (int64_t i = 0; i < 1024; ++i) {
+    elements.push_back(Value(UBits(i, 32)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value array, Value::Array(elements));
+  Value copy = array;
+  EXPECT_EQ(copy.elements().data(), array.elements().data());
+  EXPECT_EQ(copy, array);
+
+  // Structurally equal values in separate storage are equal and hash equally.
+  XLS_ASSERT_OK_AND_ASSIGN(Value other, Value::Array(elements));
+  EXPECT_NE(other.elements().data(), array.elements().data());
+  EXPECT_EQ(other, array);
+  EXPECT_EQ(absl::Hash<Value>()(other), absl::Hash<Value>()(array));
+
+  elements.back() = Value(UBits(0, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value different, Value::Array(elements));
+  EXPECT_NE(different, array);
+}
+
+TEST(ValueTest, Hash) {
+  Value a = Value::Tuple({Value(UBits(1, 8)), Value::Token()});
+  Value b = Value::Tuple({Value(UBits(1, 8)), Value::Token()});
+  Value c = Value::Tuple({Value(UBits(2, 8)), Value::Token()});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value d, Value::Array({Value(UBits(1, 8)), Value(UBits(2, 8))}));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value e, Value::Array({Value(UBits(1, 8)), Value(UBits(2, 8))}));
+  EXPECT_EQ(absl::Hash<Value>()(a), absl::Hash<Value>()(b));
+  EXPECT_EQ(absl::Hash<Value>()(d), absl::Hash<Value>()(e));
+  EXPECT_NE(absl::Hash<Value>()(a), absl::Hash<Value>()(c));
+  EXPECT_NE(absl::Hash<Value>()(a), absl::Hash<Value>()(d));
+  EXPECT_EQ(Value::Token(), Value::Token());
+  EXPECT_EQ(Value::Tuple({}), Value::Tuple({}));
+  EXPECT_NE(Value::Tuple({}), Value::Token());
+}
+
 }  // namespace xls
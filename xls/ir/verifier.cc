@@ -14,10 +14,21 @@
 
 #include "xls/ir/verifier.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
@@ -28,6 +39,7 @@
 #include "xls/ir/channel.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
+#include "xls/ir/incremental_topo_order.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/nodes.h"
@@ -1407,6 +1419,22 @@ absl::Status VerifyNodeIdUnique(Node* node, absl::flat_hash_set<int64_t>* ids) {
   return absl::OkStatus();
 }
 
+// Verifies that the parameters in FunctionBase::params() are unique and have
+// unique names. Returns the set of parameters.
+absl::StatusOr<absl::flat_hash_set<Node*>> VerifyParamList(
+    FunctionBase* function) {
+  absl::flat_hash_set<std::string> param_names;
+  absl::flat_hash_set<Node*> param_set;
+  for (Node* param : function->params()) {
+    XLS_RET_CHECK(param_set.insert(param).second)
+        << "Param appears more than once in Function::params()";
+    XLS_RET_CHECK(param_names.insert(param->GetName()).second)
+        << "Param name " << param->GetName()
+        << " is duplicated in Function::params()";
+  }
+  return param_set;
+}
+
 // Verify common invariants to function-level constucts.
 absl::Status VerifyFunctionBase(FunctionBase* function) {
   XLS_VLOG(2) << absl::StreamFormat("Verifying function %s:", function->name());
@@ -1441,15 +1469,8 @@ absl::Status VerifyFunctionBase(FunctionBase* function) {
 
   // Verify the set of parameter nodes is exactly Function::params(), and that
   // the parameter names are unique.
-  absl::flat_hash_set<std::string> param_names;
-  absl::flat_hash_set<Node*> param_set;
-  for (Node* param : function->params()) {
-    XLS_RET_CHECK(param_set.insert(param).second)
-        << "Param appears more than once in Function::params()";
-    XLS_RET_CHECK(param_names.insert(param->GetName()).second)
-        << "Param name " << param->GetName()
-        << " is duplicated in Function::params()";
-  }
+  XLS_ASSIGN_OR_RETURN(absl::flat_hash_set<Node*> param_set,
+                       VerifyParamList(function));
   int64_t param_node_count = 0;
   for (Node* node : function->nodes()) {
     if (node->Is<Param>()) {
@@ -1672,6 +1693,206 @@ absl::Status VerifyChannels(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
+// Verify function, proc, block names are unique among functions/procs/blocks.
+absl::Status VerifyFunctionBaseNames(Package* package) {
+  absl::flat_hash_set<FunctionBase*> function_bases;
+  absl::flat_hash_set<std::string> function_names;
+  absl::flat_hash_set<std::string> proc_names;
+  absl::flat_hash_set<std::string> block_names;
+  for (FunctionBase* function_base : package->GetFunctionBases()) {
+    absl::flat_hash_set<std::string>* name_set;
+    if (function_base->IsFunction()) {
+      name_set = &function_names;
+    } else if (function_base->IsProc()) {
+      name_set = &proc_names;
+    } else {
+      XLS_RET_CHECK(function_base->IsBlock());
+      name_set = &block_names;
+    }
+    XLS_RET_CHECK(!name_set->contains(function_base->name()))
+        << "Function/proc/block with name " << function_base->name()
+        << " is not unique within package " << package->name();
+    name_set->insert(function_base->name());
+
+    XLS_RET_CHECK(!function_bases.contains(function_base))
+        << "Function or proc with name " << function_base->name()
+        << " appears more than once in within package" << package->name();
+    function_bases.insert(function_base);
+  }
+  return absl::OkStatus();
+}
+
+// Verifies the invariants of the state of the given proc.
+absl::Status VerifyProcState(Proc* proc) {
+  // A Proc has a single token parameter and zero or more state paramers.
+  XLS_RET_CHECK_EQ(proc->params().size(), proc->GetStateElementCount() + 1);
+
+  XLS_RET_CHECK_EQ(proc->param(0), proc->TokenParam());
+  XLS_RET_CHECK_EQ(proc->param(0)->GetType(), proc->package()->GetTokenType())
+      << absl::StreamFormat("Parameter 0 of a proc %s is not token type, is %s",
+                            proc->name(),
+                            proc->param(1)->GetType()->ToString());
+
+  XLS_RET_CHECK_EQ(proc->GetStateElementCount(), proc->InitValues().size());
+  XLS_RET_CHECK_EQ(proc->GetStateElementCount(), proc->NextState().size());
+  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+    // Verify that the order of parameters matches the state element order.
+    XLS_RET_CHECK_EQ(proc->param(i + 1), proc->GetStateParam(i));
+
+    // Verify type of state param matches type of the corresponding initial
+    // value and next state element.
+    XLS_RET_CHECK_EQ(proc->GetStateParam(i)->GetType(),
+                     proc->GetNextStateElement(i)->GetType())
+        << absl::StreamFormat(
+               "State parameter %d of proc %s does not match next state type "
+               "%s, is %s",
+               i, proc->name(),
+               proc->GetNextStateElement(i)->GetType()->ToString(),
+               proc->GetStateParam(i)->GetType()->ToString());
+
+    XLS_RET_CHECK(ValueConformsToType(proc->GetInitValueElement(i),
+                                      proc->GetStateParam(i)->GetType()));
+  }
+
+  // Next token must be token type.
+  XLS_RET_CHECK(proc->NextToken()->GetType()->IsToken());
+  return absl::OkStatus();
+}
+
+// Returns whether the incrementally maintained topological order of
+// `function`, if any, proves that the edges into `nodes` close no cycle: each
+// operand precedes its user in the order. The order is kept consistent with
+// all other edges as they are added.
+bool TopoOrderProvesAcyclic(FunctionBase* function,
+                            absl::Span<Node* const> nodes) {
+  IncrementalTopoOrder* order = function->incremental_topo_order();
+  if (order == nullptr || !order->valid()) {
+    return false;
+  }
+  for (Node* node : nodes) {
+    std::optional<int64_t> position = order->GetPosition(node);
+    if (!position.has_value()) {
+      return false;
+    }
+    for (Node* operand : node->operands()) {
+      std::optional<int64_t> operand_position = order->GetPosition(operand);
+      if (!operand_position.has_value() || *operand_position >= *position) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Returns an error if there is a cycle through any of `roots`. Such a cycle
+// leads from a root back to itself along users, so only the nodes reachable
+// from the roots are searched, each at most once.
+absl::Status VerifyNoCycleThrough(absl::Span<Node* const> roots) {
+  enum class VisitState { kOnPath, kDone };
+  absl::flat_hash_map<Node*, VisitState> states;
+  // The current path from a root, each node with the index of its next user
+  // to visit.
+  std::vector<std::pair<Node*, int64_t>> path;
+  for (Node* root : roots) {
+    if (!states.try_emplace(root, VisitState::kOnPath).second) {
+      continue;
+    }
+    path.push_back({root, 0});
+    while (!path.empty()) {
+      Node* node = path.back().first;
+      int64_t user_index = path.back().second++;
+      if (user_index == node->users().size()) {
+        states[node] = VisitState::kDone;
+        path.pop_back();
+        continue;
+      }
+      Node* user = node->users().begin()[user_index];
+      auto [it, inserted] = states.try_emplace(user, VisitState::kOnPath);
+      if (inserted) {
+        path.push_back({user, 0});
+        continue;
+      }
+      if (it->second == VisitState::kOnPath) {
+        std::vector<std::string> cycle_names;
+        auto start = std::find_if(path.begin(), path.end(), [&](auto& entry) {
+          return entry.first == user;
+        });
+        for (auto entry = start; entry != path.end(); ++entry) {
+          cycle_names.push_back(entry->first->GetName());
+        }
+        cycle_names.push_back(user->GetName());
+        return absl::InternalError(absl::StrFormat(
+            "Cycle detected: [%s]", absl::StrJoin(cycle_names, " -> ")));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+// Verifies the nodes of the given function or proc which have changed since
+// change tracking was enabled or last cleared, and the users of those nodes.
+// Invariants which span the whole graph are checked only as far as they can
+// be violated by the changes:
+//
+//  * A new cycle must pass through a node whose operands changed, so only
+//    paths from the changed nodes are searched for cycles, and not even those
+//    if the maintained topological order proves there is none.
+//  * Node ids are checked against Package::next_node_id() but not for
+//    uniqueness.
+//
+// Returns whether any of the verified nodes is token-typed or side-effecting,
+// in which case token connectivity and channel invariants must be reverified.
+absl::StatusOr<bool> VerifyChangedNodes(FunctionBase* function,
+                                        bool codegen) {
+  absl::flat_hash_set<Node*> node_set;
+  for (Node* node : function->changed_nodes()) {
+    node_set.insert(node);
+    node_set.insert(node->users().begin(), node->users().end());
+  }
+  // Sort the nodes so errors are reported deterministically.
+  std::vector<Node*> nodes(node_set.begin(), node_set.end());
+  std::sort(nodes.begin(), nodes.end(), [](Node* a, Node* b) {
+    return a->id() != b->id() ? a->id() < b->id()
+                              : a->GetName() < b->GetName();
+  });
+  XLS_VLOG(2) << absl::StreamFormat("Verifying %d changed nodes of %s:",
+                                    nodes.size(), function->name());
+
+  Package* package = function->package();
+  for (Node* node : nodes) {
+    XLS_RET_CHECK(node->package() == package);
+    XLS_RET_CHECK(package->IsOwnedType(node->GetType()));
+    XLS_RET_CHECK_LT(node->id(), package->next_node_id());
+    if (node->Is<Param>()) {
+      XLS_RET_CHECK(absl::c_linear_search(function->params(), node))
+          << "Param " << node->GetName() << " is not in Function::params()";
+    }
+    if (function->IsFunction() && (node->Is<Send>() || node->Is<Receive>())) {
+      return absl::InternalError(absl::StrFormat(
+          "Send and receive nodes can only be in procs, not functions (%s)",
+          node->GetName()));
+    }
+  }
+  XLS_RETURN_IF_ERROR(VerifyParamList(function).status());
+  for (Param* param : function->params()) {
+    XLS_RET_CHECK(param->function_base() == function)
+        << "Param " << param->GetName() << " is not owned by "
+        << function->name();
+  }
+
+  if (!TopoOrderProvesAcyclic(function, nodes)) {
+    XLS_RETURN_IF_ERROR(VerifyNoCycleThrough(nodes));
+  }
+
+  bool token_nodes_changed = false;
+  for (Node* node : nodes) {
+    XLS_RETURN_IF_ERROR(VerifyNode(node, codegen));
+    token_nodes_changed |=
+        TypeHasToken(node->GetType()) || OpIsSideEffecting(node->op());
+  }
+  return token_nodes_changed;
+}
+
 }  // namespace
 
 absl::Status VerifyPackage(Package* package, bool codegen) {
@@ -1710,31 +1931,7 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
   }
   XLS_RET_CHECK_GT(package->next_node_id(), max_id_seen);
 
-  // Verify function, proc, block names are unique among functions/procs/blocks.
-  absl::flat_hash_set<FunctionBase*> function_bases;
-  absl::flat_hash_set<std::string> function_names;
-  absl::flat_hash_set<std::string> proc_names;
-  absl::flat_hash_set<std::string> block_names;
-  for (FunctionBase* function_base : package->GetFunctionBases()) {
-    absl::flat_hash_set<std::string>* name_set;
-    if (function_base->IsFunction()) {
-      name_set = &function_names;
-    } else if (function_base->IsProc()) {
-      name_set = &proc_names;
-    } else {
-      XLS_RET_CHECK(function_base->IsBlock());
-      name_set = &block_names;
-    }
-    XLS_RET_CHECK(!name_set->contains(function_base->name()))
-        << "Function/proc/block with name " << function_base->name()
-        << " is not unique within package " << package->name();
-    name_set->insert(function_base->name());
-
-    XLS_RET_CHECK(!function_bases.contains(function_base))
-        << "Function or proc with name " << function_base->name()
-        << " appears more than once in within package" << package->name();
-    function_bases.insert(function_base);
-  }
+  XLS_RETURN_IF_ERROR(VerifyFunctionBaseNames(package));
 
   XLS_RETURN_IF_ERROR(VerifyChannels(package, codegen));
 
@@ -1746,6 +1943,56 @@ absl::Status VerifyPackage(Package* package, bool codegen) {
   return absl::OkStatus();
 }
 
+absl::Status VerifyPackageIncrementally(Package* package, bool codegen) {
+  std::vector<FunctionBase*> function_bases = package->GetFunctionBases();
+  if (absl::c_none_of(function_bases, [](FunctionBase* f) {
+        return f->IsChangeTrackingEnabled();
+      })) {
+    XLS_RETURN_IF_ERROR(VerifyPackage(package, codegen));
+  } else {
+    bool channel_ops_changed = false;
+    for (FunctionBase* f : function_bases) {
+      XLS_RET_CHECK(f->package() == package);
+      if (!f->IsChangeTrackingEnabled() || f->IsBlock()) {
+        // Newly created function bases and blocks are verified in full.
+        if (f->IsFunction()) {
+          XLS_RETURN_IF_ERROR(VerifyFunction(f->AsFunctionOrDie(), codegen));
+        } else if (f->IsProc()) {
+          XLS_RETURN_IF_ERROR(VerifyProc(f->AsProcOrDie(), codegen));
+          channel_ops_changed = true;
+        } else {
+          XLS_RETURN_IF_ERROR(VerifyBlock(f->AsBlockOrDie(), codegen));
+        }
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(bool token_nodes_changed,
+                           VerifyChangedNodes(f, codegen));
+      if (f->IsProc()) {
+        Proc* proc = f->AsProcOrDie();
+        XLS_RETURN_IF_ERROR(VerifyProcState(proc));
+        if (token_nodes_changed) {
+          XLS_RETURN_IF_ERROR(VerifyTokenConnectivity(proc->TokenParam(),
+                                                      proc->NextToken(), proc));
+          channel_ops_changed = true;
+        }
+      }
+    }
+    XLS_RETURN_IF_ERROR(VerifyFunctionBaseNames(package));
+    if (channel_ops_changed) {
+      XLS_RETURN_IF_ERROR(VerifyChannels(package, codegen));
+    }
+  }
+
+  for (FunctionBase* f : function_bases) {
+    if (f->IsChangeTrackingEnabled()) {
+      f->ClearChangedNodes();
+    } else {
+      f->SetChangeTrackingEnabled(true);
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status VerifyFunction(Function* function, bool codegen) {
   XLS_VLOG(4) << "Verifying function:\n";
   XLS_VLOG_LINES(4, function->DumpIr());
@@ -1768,39 +2015,7 @@ absl::Status VerifyProc(Proc* proc, bool codegen) {
   XLS_VLOG_LINES(4, proc->DumpIr());
 
   XLS_RETURN_IF_ERROR(VerifyFunctionBase(proc));
-
-  // A Proc has a single token parameter and zero or more state paramers.
-  XLS_RET_CHECK_EQ(proc->params().size(), proc->GetStateElementCount() + 1);
-
-  XLS_RET_CHECK_EQ(proc->param(0), proc->TokenParam());
-  XLS_RET_CHECK_EQ(proc->param(0)->GetType(), proc->package()->GetTokenType())
-      << absl::StreamFormat("Parameter 0 of a proc %s is not token type, is %s",
-                            proc->name(),
-                            proc->param(1)->GetType()->ToString());
-
-  XLS_RET_CHECK_EQ(proc->GetStateElementCount(), proc->InitValues().size());
-  XLS_RET_CHECK_EQ(proc->GetStateElementCount(), proc->NextState().size());
-  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
-    // Verify that the order of parameters matches the state element order.
-    XLS_RET_CHECK_EQ(proc->param(i + 1), proc->GetStateParam(i));
-
-    // Verify type of state param matches type of the corresponding initial
-    // value and next state element.
-    XLS_RET_CHECK_EQ(proc->GetStateParam(i)->GetType(),
-                     proc->GetNextStateElement(i)->GetType())
-        << absl::StreamFormat(
-               "State parameter %d of proc %s does not match next state type "
-               "%s, is %s",
-               i, proc->name(),
-               proc->GetNextStateElement(i)->GetType()->ToString(),
-               proc->GetStateParam(i)->GetType()->ToString());
-
-    XLS_RET_CHECK(ValueConformsToType(proc->GetInitValueElement(i),
-                                      proc->GetStateParam(i)->GetType()));
-  }
-
-  // Next token must be token type.
-  XLS_RET_CHECK(proc->NextToken()->GetType()->IsToken());
+  XLS_RETURN_IF_ERROR(VerifyProcState(proc));
 
   // Verify that all side-effecting operations which produce tokens are
   // connected to the token parameter and the return value via paths of tokens.
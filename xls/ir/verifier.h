@@ -33,6 +33,21 @@ absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
 absl::Status VerifyNode(Node* Node, bool codegen = false);
 
+// Verifies the package as VerifyPackage does but, for functions and procs with
+// change tracking enabled (see FunctionBase::SetChangeTrackingEnabled), only
+// reverifies the nodes changed since the previous call and their users. On
+// success, change tracking is enabled on every function base in the package
+// and the changed nodes are cleared. If no function base has change tracking
+// enabled the package is verified in full, so the first call is as thorough as
+// VerifyPackage.
+//
+// Some invariants which span the package are not rechecked incrementally
+// (e.g., uniqueness of node ids, and channel invariants affected only by
+// adding or removing channels) so callers should periodically call
+// VerifyPackage, for example at the end of a pass pipeline.
+absl::Status VerifyPackageIncrementally(Package* package,
+                                        bool codegen = false);
+
 }  // namespace xls
 
 #endif  // XLS_IR_VERIFIER_H_
@@ -17,8 +17,10 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/incremental_topo_order.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node_iterator.h"
 
 namespace xls {
 namespace {
@@ -550,5 +552,118 @@ block my_block(a: bits[32], b: bits[32], out: bits[32]) {
   XLS_ASSERT_OK(VerifyBlock(FindBlock("my_block", p.get())));
 }
 
+TEST_F(VerifierTest, IncrementalVerification) {
+  std::string input = R"(
+package IncrementalVerification
+
+fn graph(p: bits[42], q: bits[42], r: bits[8]) -> bits[42] {
+  and.1: bits[42] = and(p, q)
+  add.2: bits[42] = add(and.1, q)
+  ret sub.3: bits[42] = sub(add.2, add.2)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  Function* f = FindFunction("graph", p.get());
+  EXPECT_FALSE(f->IsChangeTrackingEnabled());
+
+  // The first call verifies the package in full and enables change tracking.
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get()));
+  ASSERT_TRUE(f->IsChangeTrackingEnabled());
+  EXPECT_TRUE(f->changed_nodes().empty());
+
+  // Well-formed changes verify and are cleared.
+  Node* add = FindNode("add.2", f);
+  XLS_ASSERT_OK(add->ReplaceOperandNumber(1, FindNode("p", f)));
+  EXPECT_FALSE(f->changed_nodes().empty());
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get()));
+  EXPECT_TRUE(f->changed_nodes().empty());
+
+  // A change which breaks the changed node is detected.
+  XLS_ASSERT_OK(add->ReplaceOperandNumber(1, FindNode("r", f),
+                                          /*type_must_match=*/false));
+  EXPECT_THAT(VerifyPackageIncrementally(p.get()),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 1 of add.2")));
+}
+
+TEST_F(VerifierTest, IncrementalVerificationDetectsCycle) {
+  std::string input = R"(
+package IncrementalVerificationDetectsCycle
+
+fn graph(p: bits[42], q: bits[42]) -> bits[42] {
+  and.1: bits[42] = and(p, q)
+  add.2: bits[42] = add(and.1, q)
+  ret sub.3: bits[42] = sub(add.2, add.2)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  Function* f = FindFunction("graph", p.get());
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get()));
+
+  XLS_ASSERT_OK(
+      FindNode("and.1", f)->ReplaceOperandNumber(0, FindNode("sub.3", f)));
+  EXPECT_THAT(VerifyPackageIncrementally(p.get()),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Cycle detected")));
+}
+
+TEST_F(VerifierTest, IncrementalVerificationWithTopoOrder) {
+  std::string input = R"(
+package IncrementalVerificationWithTopoOrder
+
+fn graph(p: bits[42], q: bits[42]) -> bits[42] {
+  and.1: bits[42] = and(p, q)
+  add.2: bits[42] = add(and.1, q)
+  neg.3: bits[42] = neg(p)
+  ret sub.4: bits[42] = sub(add.2, neg.3)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  Function* f = FindFunction("graph", p.get());
+  f->SetIncrementalTopoSortEnabled(true);
+  // The order is maintained from the first sort on.
+  TopoSort(f);
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get()));
+
+  // An edge against the creation order which closes no cycle verifies.
+  XLS_ASSERT_OK(
+      FindNode("and.1", f)->ReplaceOperandNumber(0, FindNode("neg.3", f)));
+  EXPECT_TRUE(f->incremental_topo_order()->valid());
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get()));
+
+  // A cycle invalidates the maintained order and is still detected.
+  XLS_ASSERT_OK(
+      FindNode("neg.3", f)->ReplaceOperandNumber(0, FindNode("add.2", f)));
+  EXPECT_THAT(VerifyPackageIncrementally(p.get()),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Cycle detected")));
+}
+
+TEST_F(VerifierTest, IncrementalVerificationSkipsUnchangedNodes) {
+  std::string input = R"(
+package IncrementalVerificationSkipsUnchangedNodes
+
+fn graph(p: bits[42], q: bits[42], r: bits[8]) -> bits[42] {
+  and.1: bits[42] = and(p, q)
+  add.2: bits[42] = add(and.1, q)
+  ret sub.3: bits[42] = sub(add.2, add.2)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackageNoVerify(input));
+  Function* f = FindFunction("graph", p.get());
+  XLS_ASSERT_OK(VerifyPackageIncrementally(p.get()));
+
+  // Break the graph without recording the change. Only a full verification
+  // detects the problem.
+  f->SetChangeTrackingEnabled(false);
+  XLS_ASSERT_OK(FindNode("add.2", f)->ReplaceOperandNumber(
+      1, FindNode("r", f), /*type_must_match=*/false));
+  f->SetChangeTrackingEnabled(true);
+  XLS_EXPECT_OK(VerifyPackageIncrementally(p.get()));
+  EXPECT_THAT(VerifyPackage(p.get()),
+              StatusIs(absl::StatusCode::kInternal,
+                       HasSubstr("Expected operand 1 of add.2")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,473 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/word_arithmetic.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/numeric/int128.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+
+namespace xls {
+namespace {
+
+using ConstWords = absl::Span<const uint64_t>;
+using MutableWords = absl::Span<uint64_t>;
+using Words = std::vector<uint64_t>;
+
+constexpr int64_t kWordBits = 64;
+
+// Returns `x` without its most significant zero words.
+ConstWords Trim(ConstWords x) {
+  int64_t size = x.size();
+  while (size > 0 && x[size - 1] == 0) {
+    --size;
+  }
+  return x.subspan(0, size);
+}
+
+int64_t BitLength(ConstWords x) {
+  x = Trim(x);
+  if (x.empty()) {
+    return 0;
+  }
+  return x.size() * kWordBits - absl::countl_zero(x.back());
+}
+
+// Returns -1, 0 or 1 if `a` is less than, equal to or greater than `b`.
+int Compare(ConstWords a, ConstWords b) {
+  a = Trim(a);
+  b = Trim(b);
+  if (a.size() != b.size()) {
+    return a.size() < b.size() ? -1 : 1;
+  }
+  for (int64_t i = a.size() - 1; i >= 0; --i) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+void Copy(ConstWords from, MutableWords to) {
+  XLS_DCHECK_LE(from.size(), to.size());
+  std::copy(from.begin(), from.end(), to.begin());
+}
+
+void Clear(MutableWords x) { std::fill(x.begin(), x.end(), 0); }
+
+// Adds `x` to `acc` propagating the carry through the words of `acc`. Returns
+// the carry out of the most significant word of `acc`.
+uint64_t AddInPlace(MutableWords acc, ConstWords x) {
+  XLS_DCHECK_LE(x.size(), acc.size());
+  uint64_t carry = 0;
+  int64_t i = 0;
+  for (; i < x.size(); ++i) {
+    absl::uint128 sum = absl::uint128(acc[i]) + x[i] + carry;
+    acc[i] = absl::Uint128Low64(sum);
+    carry = absl::Uint128High64(sum);
+  }
+  for (; carry != 0 && i < acc.size(); ++i) {
+    ++acc[i];
+    carry = acc[i] == 0 ? 1 : 0;
+  }
+  return carry;
+}
+
+// Subtracts `x` from `acc` propagating the borrow through the words of `acc`.
+// Returns the borrow out of the most significant word of `acc`.
+uint64_t SubInPlace(MutableWords acc, ConstWords x) {
+  XLS_DCHECK_LE(x.size(), acc.size());
+  uint64_t borrow = 0;
+  int64_t i = 0;
+  for (; i < x.size(); ++i) {
+    uint64_t difference = acc[i] - x[i];
+    uint64_t next_borrow = acc[i] < x[i] ? 1 : 0;
+    next_borrow |= difference < borrow ? 1 : 0;
+    acc[i] = difference - borrow;
+    borrow = next_borrow;
+  }
+  for (; borrow != 0 && i < acc.size(); ++i) {
+    borrow = acc[i] == 0 ? 1 : 0;
+    --acc[i];
+  }
+  return borrow;
+}
+
+// Returns the low `size` words of `x` shifted left by `shift` bits.
+Words ShiftLeft(ConstWords x, int64_t shift, int64_t size) {
+  Words result(size, 0);
+  const int64_t word_shift = shift / kWordBits;
+  const int64_t bit_shift = shift % kWordBits;
+  for (int64_t i = 0; i < x.size() && i + word_shift < size; ++i) {
+    result[i + word_shift] |= x[i] << bit_shift;
+    if (bit_shift != 0 && i + word_shift + 1 < size) {
+      result[i + word_shift + 1] |= x[i] >> (kWordBits - bit_shift);
+    }
+  }
+  return result;
+}
+
+// Returns the low `size` words of `x` shifted right by `shift` bits.
+Words ShiftRight(ConstWords x, int64_t shift, int64_t size) {
+  Words result(size, 0);
+  const int64_t word_shift = shift / kWordBits;
+  const int64_t bit_shift = shift % kWordBits;
+  for (int64_t i = 0; i < size && i + word_shift < x.size(); ++i) {
+    uint64_t word = x[i + word_shift] >> bit_shift;
+    if (bit_shift != 0 && i + word_shift + 1 < x.size()) {
+      word |= x[i + word_shift + 1] << (kWordBits - bit_shift);
+    }
+    result[i] = word;
+  }
+  return result;
+}
+
+void SchoolbookMultiply(ConstWords lhs, ConstWords rhs, MutableWords product) {
+  Clear(product);
+  for (int64_t i = 0; i < lhs.size(); ++i) {
+    if (lhs[i] == 0) {
+      continue;
+    }
+    uint64_t carry = 0;
+    for (int64_t j = 0; j < rhs.size(); ++j) {
+      absl::uint128 t =
+          absl::uint128(lhs[i]) * rhs[j] + product[i + j] + carry;
+      product[i + j] = absl::Uint128Low64(t);
+      carry = absl::Uint128High64(t);
+    }
+    product[i + rhs.size()] = carry;
+  }
+}
+
+// Sets `product`, which must have lhs.size() + rhs.size() words, to the
+// product of the operands.
+void Multiply(ConstWords lhs, ConstWords rhs, MutableWords product) {
+  if (lhs.size() < rhs.size()) {
+    std::swap(lhs, rhs);
+  }
+  if (rhs.size() < kKaratsubaThresholdWords) {
+    SchoolbookMultiply(lhs, rhs, product);
+    return;
+  }
+  if (2 * rhs.size() <= lhs.size()) {
+    // The operands are unbalanced so the splitting below would not reduce the
+    // work. Multiply the shorter operand by chunks of the longer one instead.
+    Clear(product);
+    Words partial(2 * rhs.size());
+    for (int64_t offset = 0; offset < lhs.size(); offset += rhs.size()) {
+      ConstWords chunk = lhs.subspan(offset, rhs.size());
+      MutableWords partial_product =
+          absl::MakeSpan(partial).subspan(0, chunk.size() + rhs.size());
+      Multiply(chunk, rhs, partial_product);
+      AddInPlace(product.subspan(offset), partial_product);
+    }
+    return;
+  }
+
+  // Karatsuba: with lhs = l1 * B^half + l0 and rhs = r1 * B^half + r0,
+  //   lhs * rhs = z2 * B^(2 * half) + z1 * B^half + z0
+  // where z0 = l0 * r0, z2 = l1 * r1 and
+  //   z1 = (l0 + l1) * (r0 + r1) - z0 - z2.
+  // As rhs is more than half the size of lhs, r1 is not empty.
+  const int64_t half = lhs.size() / 2;
+  ConstWords l0 = lhs.subspan(0, half);
+  ConstWords l1 = lhs.subspan(half);
+  ConstWords r0 = rhs.subspan(0, half);
+  ConstWords r1 = rhs.subspan(half);
+  MutableWords z0 = product.subspan(0, 2 * half);
+  MutableWords z2 = product.subspan(2 * half);
+  Multiply(l0, r0, z0);
+  Multiply(l1, r1, z2);
+
+  Words lhs_sum(l1.size() + 1, 0);
+  Copy(l1, absl::MakeSpan(lhs_sum));
+  AddInPlace(absl::MakeSpan(lhs_sum), l0);
+  Words rhs_sum(std::max(r0.size(), r1.size()) + 1, 0);
+  Copy(r1, absl::MakeSpan(rhs_sum));
+  AddInPlace(absl::MakeSpan(rhs_sum), r0);
+  Words z1(lhs_sum.size() + rhs_sum.size());
+  Multiply(lhs_sum, rhs_sum, absl::MakeSpan(z1));
+  SubInPlace(absl::MakeSpan(z1), z0);
+  SubInPlace(absl::MakeSpan(z1), z2);
+  AddInPlace(product.subspan(half), Trim(z1));
+}
+
+// Divides `u` by the single word `v`. `quotient` must have u.size() words.
+uint64_t DivideByWord(ConstWords u, uint64_t v, MutableWords quotient) {
+  uint64_t remainder = 0;
+  for (int64_t i = u.size() - 1; i >= 0; --i) {
+    absl::uint128 numerator = absl::MakeUint128(remainder, u[i]);
+    quotient[i] = absl::Uint128Low64(numerator / v);
+    remainder = absl::Uint128Low64(numerator % v);
+  }
+  return remainder;
+}
+
+// Knuth's algorithm D (The Art of Computer Programming, Vol. 2, 4.3.1). `v`
+// must have at least two words and a non-zero most significant word.
+// `quotient` must have u.size() words and `remainder` v.size() words.
+void KnuthDivide(ConstWords u, ConstWords v, MutableWords quotient,
+                 MutableWords remainder) {
+  Clear(quotient);
+  Clear(remainder);
+  const int64_t n = v.size();
+  u = Trim(u);
+  if (u.size() < n) {
+    Copy(u, remainder);
+    return;
+  }
+  const int64_t m = u.size() - n;
+
+  // Normalize so the most significant bit of the divisor is set which bounds
+  // the error of the quotient digit estimates below.
+  const int64_t shift = absl::countl_zero(v[n - 1]);
+  Words vn = ShiftLeft(v, shift, n);
+  Words un = ShiftLeft(u, shift, u.size() + 1);
+
+  for (int64_t j = m; j >= 0; --j) {
+    // Estimate the quotient digit from the top two words of the running
+    // remainder and the top word of the divisor, then refine it with the
+    // second word of the divisor. The estimate is then at most one too large.
+    absl::uint128 numerator = absl::MakeUint128(un[j + n], un[j + n - 1]);
+    absl::uint128 qhat = numerator / vn[n - 1];
+    absl::uint128 rhat = numerator - qhat * vn[n - 1];
+    while (absl::Uint128High64(qhat) != 0 ||
+           qhat * vn[n - 2] >
+               absl::MakeUint128(absl::Uint128Low64(rhat), un[j + n - 2])) {
+      --qhat;
+      rhat += vn[n - 1];
+      if (absl::Uint128High64(rhat) != 0) {
+        break;
+      }
+    }
+
+    // Subtract qhat times the divisor from the running remainder.
+    uint64_t q = absl::Uint128Low64(qhat);
+    uint64_t carry = 0;
+    uint64_t borrow = 0;
+    for (int64_t i = 0; i < n; ++i) {
+      absl::uint128 p = absl::uint128(q) * vn[i] + carry;
+      carry = absl::Uint128High64(p);
+      uint64_t p_low = absl::Uint128Low64(p);
+      uint64_t difference = un[i + j] - p_low;
+      uint64_t next_borrow = un[i + j] < p_low ? 1 : 0;
+      next_borrow |= difference < borrow ? 1 : 0;
+      un[i + j] = difference - borrow;
+      borrow = next_borrow;
+    }
+    absl::uint128 top_subtrahend = absl::uint128(carry) + borrow;
+    uint64_t top = un[j + n];
+    un[j + n] = top - absl::Uint128Low64(top_subtrahend);
+    if (absl::uint128(top) < top_subtrahend) {
+      // The estimate was one too large. Add the divisor back.
+      --q;
+      uint64_t add_carry = 0;
+      for (int64_t i = 0; i < n; ++i) {
+        absl::uint128 sum = absl::uint128(un[i + j]) + vn[i] + add_carry;
+        un[i + j] = absl::Uint128Low64(sum);
+        add_carry = absl::Uint128High64(sum);
+      }
+      un[j + n] += add_carry;
+    }
+    quotient[j] = q;
+  }
+
+  Words unnormalized = ShiftRight(absl::MakeConstSpan(un).subspan(0, n + 1),
+                                  shift, n);
+  Copy(unnormalized, remainder);
+}
+
+// Divides `u` by `v` which must have a non-zero most significant word.
+// `quotient` must have u.size() words and `remainder` v.size() words.
+void SchoolbookDivide(ConstWords u, ConstWords v, MutableWords quotient,
+                      MutableWords remainder) {
+  if (v.size() == 1) {
+    Clear(remainder);
+    remainder[0] = DivideByWord(u, v[0], quotient);
+    return;
+  }
+  KnuthDivide(u, v, quotient, remainder);
+}
+
+void Divide3n2n(ConstWords a, ConstWords b, MutableWords quotient,
+                MutableWords remainder);
+
+// Divides the 2n-word value `a` by the n-word value `b` which must have its
+// most significant bit set. The quotient must fit in n words (i.e., a < b *
+// B^n). `quotient` and `remainder` must have n words. This is algorithm 1 of
+// Burnikel and Ziegler.
+void Divide2n1n(ConstWords a, ConstWords b, MutableWords quotient,
+                MutableWords remainder) {
+  const int64_t n = b.size();
+  XLS_DCHECK_EQ(a.size(), 2 * n);
+  if (n % 2 != 0 || n < kBurnikelZieglerThresholdWords) {
+    Words full_quotient(a.size());
+    SchoolbookDivide(a, b, absl::MakeSpan(full_quotient), remainder);
+    XLS_DCHECK(Trim(full_quotient).size() <= n);
+    Copy(absl::MakeConstSpan(full_quotient).subspan(0, n), quotient);
+    return;
+  }
+
+  // With a = [a1 a2 a3 a4] in half-size words, divide [a1 a2 a3] by b giving
+  // the high half of the quotient and a remainder r, then divide [r a4] by b
+  // giving the low half of the quotient and the remainder.
+  const int64_t half = n / 2;
+  Words high_remainder(n);
+  Divide3n2n(a.subspan(half, 3 * half), b, quotient.subspan(half, half),
+             absl::MakeSpan(high_remainder));
+  Words next(3 * half);
+  Copy(a.subspan(0, half), absl::MakeSpan(next));
+  Copy(high_remainder, absl::MakeSpan(next).subspan(half));
+  Divide3n2n(next, b, quotient.subspan(0, half), remainder);
+}
+
+// Divides the 3k-word value `a` by the 2k-word value `b` which must have its
+// most significant bit set. The quotient must fit in k words (i.e., a < b *
+// B^k). `quotient` must have k words and `remainder` 2k words. This is
+// algorithm 2 of Burnikel and Ziegler.
+void Divide3n2n(ConstWords a, ConstWords b, MutableWords quotient,
+                MutableWords remainder) {
+  const int64_t k = b.size() / 2;
+  XLS_DCHECK_EQ(a.size(), 3 * k);
+  ConstWords a1 = a.subspan(2 * k);
+  ConstWords a12 = a.subspan(k);
+  ConstWords a3 = a.subspan(0, k);
+  ConstWords b1 = b.subspan(k);
+  ConstWords b2 = b.subspan(0, k);
+
+  // Estimate the quotient as [a1 a2] / b1 and compute
+  //   r = ([a1 a2] mod b1) * B^k + a3
+  // which is at most 2k + 1 words.
+  Words r(2 * k + 2, 0);
+  Copy(a3, absl::MakeSpan(r));
+  if (Compare(a1, b1) < 0) {
+    Words r1(k);
+    Divide2n1n(a12, b1, quotient, absl::MakeSpan(r1));
+    Copy(r1, absl::MakeSpan(r).subspan(k));
+  } else {
+    // As a < b * B^k, a1 equals b1 and the quotient is at most B^k - 1 for
+    // which the remainder is [a1 a2] - b1 * B^k + b1 = a2 + b1.
+    std::fill(quotient.begin(), quotient.end(), ~uint64_t{0});
+    Copy(a12.subspan(0, k), absl::MakeSpan(r).subspan(k));
+    AddInPlace(absl::MakeSpan(r).subspan(k), b1);
+  }
+
+  // Correct the estimate which is at most two too large as b is normalized.
+  Words d(2 * k);
+  MultiplyWords(quotient, b2, absl::MakeSpan(d));
+  const uint64_t one = 1;
+  while (Compare(r, d) < 0) {
+    AddInPlace(absl::MakeSpan(r), b);
+    SubInPlace(quotient, absl::MakeConstSpan(&one, 1));
+  }
+  SubInPlace(absl::MakeSpan(r), d);
+  XLS_DCHECK(Trim(r).size() <= 2 * k);
+  Copy(absl::MakeConstSpan(r).subspan(0, 2 * k), remainder);
+}
+
+// Divides `u` by `v` which must have a non-zero most significant word by
+// splitting `u` into blocks of the (normalized and padded) size of `v` and
+// dividing two blocks at a time with Divide2n1n. `quotient` must have u.size()
+// words and `remainder` v.size() words.
+void BurnikelZieglerDivide(ConstWords u, ConstWords v, MutableWords quotient,
+                           MutableWords remainder) {
+  // Pad the divisor to n = j * m words where m is a power of two such that
+  // the recursion of Divide2n1n can halve the divisor down to j words which is
+  // below the threshold, and normalize it so its most significant bit is set.
+  const int64_t s = v.size();
+  const int64_t m = int64_t{1} << absl::bit_width(static_cast<uint64_t>(
+                        s / kBurnikelZieglerThresholdWords));
+  const int64_t n = CeilOfRatio(s, m) * m;
+  const int64_t shift = n * kWordBits - BitLength(v);
+  Words b = ShiftLeft(v, shift, n);
+
+  // Split the shifted dividend into t blocks of n words with at least one
+  // leading zero bit so the top block is less than the divisor.
+  const int64_t t =
+      std::max<int64_t>(2, (BitLength(u) + shift) / (n * kWordBits) + 1);
+  Words a = ShiftLeft(u, shift, t * n);
+
+  Clear(quotient);
+  Words z(2 * n);
+  Copy(absl::MakeConstSpan(a).subspan((t - 2) * n), absl::MakeSpan(z));
+  Words block_quotient(n);
+  Words block_remainder(n);
+  for (int64_t i = t - 2; i >= 0; --i) {
+    Divide2n1n(z, b, absl::MakeSpan(block_quotient),
+               absl::MakeSpan(block_remainder));
+    // The quotient fits in `quotient` so any words beyond it are zero.
+    const int64_t offset = i * n;
+    if (offset < quotient.size()) {
+      const int64_t count =
+          std::min<int64_t>(n, static_cast<int64_t>(quotient.size()) - offset);
+      Copy(absl::MakeConstSpan(block_quotient).subspan(0, count),
+           quotient.subspan(offset));
+    }
+    if (i > 0) {
+      Copy(absl::MakeConstSpan(a).subspan((i - 1) * n, n), absl::MakeSpan(z));
+      Copy(block_remainder, absl::MakeSpan(z).subspan(n));
+    }
+  }
+  Words unnormalized = ShiftRight(block_remainder, shift, s);
+  Copy(unnormalized, remainder);
+}
+
+}  // namespace
+
+void MultiplyWords(absl::Span<const uint64_t> lhs,
+                   absl::Span<const uint64_t> rhs,
+                   absl::Span<uint64_t> product) {
+  XLS_CHECK_EQ(product.size(), lhs.size() + rhs.size());
+  lhs = Trim(lhs);
+  rhs = Trim(rhs);
+  Clear(product);
+  if (lhs.empty() || rhs.empty()) {
+    return;
+  }
+  Multiply(lhs, rhs, product.subspan(0, lhs.size() + rhs.size()));
+}
+
+void DivideWords(absl::Span<const uint64_t> dividend,
+                 absl::Span<const uint64_t> divisor,
+                 absl::Span<uint64_t> quotient,
+                 absl::Span<uint64_t> remainder) {
+  XLS_CHECK_EQ(quotient.size(), dividend.size());
+  XLS_CHECK_EQ(remainder.size(), divisor.size());
+  ConstWords u = Trim(dividend);
+  ConstWords v = Trim(divisor);
+  XLS_CHECK(!v.empty()) << "Division by zero";
+  Clear(quotient);
+  Clear(remainder);
+  if (Compare(u, v) < 0) {
+    Copy(u, remainder);
+    return;
+  }
+  MutableWords q = quotient.subspan(0, u.size());
+  MutableWords r = remainder.subspan(0, v.size());
+  if (v.size() >= kBurnikelZieglerThresholdWords &&
+      u.size() - v.size() >= kBurnikelZieglerThresholdWords) {
+    BurnikelZieglerDivide(u, v, q, r);
+  } else {
+    SchoolbookDivide(u, v, q, r);
+  }
+}
+
+}  // namespace xls
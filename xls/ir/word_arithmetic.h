@@ -0,0 +1,58 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_WORD_ARITHMETIC_H_
+#define XLS_IR_WORD_ARITHMETIC_H_
+
+// Unsigned multiplication and division of arbitrary width integers held as
+// little-endian sequences of 64-bit words (the layout of InlineBitmap). Used by
+// bits_ops for operations on values wider than a single word.
+//
+// Multiplication uses Karatsuba's algorithm for large operands and division
+// uses the recursive algorithm of Burnikel and Ziegler ("Fast Recursive
+// Division", MPI-I-98-1-022, 1998) for large divisors. Both fall back to the
+// schoolbook algorithms (Knuth's algorithm D for division) below a threshold
+// size.
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+namespace xls {
+
+// Operands with fewer words than this are multiplied with the schoolbook
+// algorithm.
+inline constexpr int64_t kKaratsubaThresholdWords = 24;
+
+// Divisors (and quotients) with fewer words than this are computed with
+// Knuth's algorithm D.
+inline constexpr int64_t kBurnikelZieglerThresholdWords = 40;
+
+// Sets `product` to `lhs` * `rhs`. The size of `product` must be
+// lhs.size() + rhs.size(). `product` must not overlap the operands.
+void MultiplyWords(absl::Span<const uint64_t> lhs,
+                   absl::Span<const uint64_t> rhs,
+                   absl::Span<uint64_t> product);
+
+// Sets `quotient` and `remainder` to the quotient and remainder of `dividend`
+// divided by `divisor`. The divisor must be non-zero. The size of `quotient`
+// must be dividend.size() and the size of `remainder` must be divisor.size().
+// The outputs must not overlap the inputs.
+void DivideWords(absl::Span<const uint64_t> dividend,
+                 absl::Span<const uint64_t> divisor,
+                 absl::Span<uint64_t> quotient, absl::Span<uint64_t> remainder);
+
+}  // namespace xls
+
+#endif  // XLS_IR_WORD_ARITHMETIC_H_
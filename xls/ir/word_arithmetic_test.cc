@@ -0,0 +1,158 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/word_arithmetic.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/big_int.h"
+#include "xls/ir/bits.h"
+
+namespace xls {
+namespace {
+
+using Words = std::vector<uint64_t>;
+
+BigInt ToBigInt(absl::Span<const uint64_t> words) {
+  InlineBitmap bitmap(words.size() * 64);
+  for (int64_t i = 0; i < words.size(); ++i) {
+    bitmap.SetWord(i, words[i]);
+  }
+  return BigInt::MakeUnsigned(Bits::FromBitmap(std::move(bitmap)));
+}
+
+// Kinds of operand values which exercise different paths of the algorithms
+// (e.g., carries across all words and the normalization of divisors).
+enum class Kind { kRandom, kAllOnes, kSmallTopWord, kPowerOfTwo };
+
+Words MakeWords(int64_t size, Kind kind, std::mt19937_64& rng) {
+  Words words(size);
+  for (uint64_t& word : words) {
+    word = kind == Kind::kAllOnes ? ~uint64_t{0} : rng();
+  }
+  if (size > 0) {
+    if (kind == Kind::kSmallTopWord) {
+      words.back() = 1 + rng() % 7;
+    } else if (kind == Kind::kPowerOfTwo) {
+      std::fill(words.begin(), words.end(), 0);
+      words.back() = uint64_t{1} << (rng() % 64);
+    }
+  }
+  return words;
+}
+
+constexpr Kind kKinds[] = {Kind::kRandom, Kind::kAllOnes, Kind::kSmallTopWord,
+                           Kind::kPowerOfTwo};
+
+TEST(WordArithmeticTest, MultiplySmall) {
+  Words product(2);
+  MultiplyWords(Words{0xffffffffffffffff}, Words{0xffffffffffffffff},
+                absl::MakeSpan(product));
+  EXPECT_THAT(product, testing::ElementsAre(1, 0xfffffffffffffffe));
+
+  product.resize(3);
+  MultiplyWords(Words{0, 0}, Words{42}, absl::MakeSpan(product));
+  EXPECT_THAT(product, testing::ElementsAre(0, 0, 0));
+
+  MultiplyWords(Words{3, 1}, Words{5}, absl::MakeSpan(product));
+  EXPECT_THAT(product, testing::ElementsAre(15, 5, 0));
+}
+
+TEST(WordArithmeticTest, MultiplyMatchesBigInt) {
+  std::mt19937_64 rng;
+  // The sizes straddle kKaratsubaThresholdWords and include unbalanced pairs.
+  const int64_t kSizes[] = {1, 2, 23, 24, 25, 32, 49, 64, 100, 130};
+  for (int64_t lhs_size : kSizes) {
+    for (int64_t rhs_size : kSizes) {
+      for (Kind kind : kKinds) {
+        Words lhs = MakeWords(lhs_size, kind, rng);
+        Words rhs = MakeWords(rhs_size, Kind::kRandom, rng);
+        Words product(lhs_size + rhs_size);
+        MultiplyWords(lhs, rhs, absl::MakeSpan(product));
+        EXPECT_EQ(ToBigInt(product), ToBigInt(lhs) * ToBigInt(rhs))
+            << "lhs_size: " << lhs_size << " rhs_size: " << rhs_size;
+      }
+    }
+  }
+}
+
+TEST(WordArithmeticTest, DivideSmall) {
+  Words quotient(2);
+  Words remainder(1);
+  DivideWords(Words{0, 1}, Words{3}, absl::MakeSpan(quotient),
+              absl::MakeSpan(remainder));
+  EXPECT_THAT(quotient, testing::ElementsAre(0x5555555555555555, 0));
+  EXPECT_THAT(remainder, testing::ElementsAre(1));
+
+  // Dividend less than divisor.
+  quotient.resize(1);
+  remainder.resize(2);
+  DivideWords(Words{7}, Words{0, 1}, absl::MakeSpan(quotient),
+              absl::MakeSpan(remainder));
+  EXPECT_THAT(quotient, testing::ElementsAre(0));
+  EXPECT_THAT(remainder, testing::ElementsAre(7, 0));
+}
+
+TEST(WordArithmeticTest, DivideMatchesBigInt) {
+  std::mt19937_64 rng;
+  // The sizes straddle kBurnikelZieglerThresholdWords and include divisors
+  // which are padded and halved by the recursion.
+  const int64_t kDividendSizes[] = {1, 2, 3, 40, 79, 80, 81, 150, 300};
+  const int64_t kDivisorSizes[] = {1, 2, 3, 39, 40, 41, 64, 80, 100};
+  for (int64_t dividend_size : kDividendSizes) {
+    for (int64_t divisor_size : kDivisorSizes) {
+      for (Kind kind : kKinds) {
+        Words dividend = MakeWords(dividend_size, Kind::kRandom, rng);
+        Words divisor = MakeWords(divisor_size, kind, rng);
+        Words quotient(dividend_size);
+        Words remainder(divisor_size);
+        DivideWords(dividend, divisor, absl::MakeSpan(quotient),
+                    absl::MakeSpan(remainder));
+        BigInt u = ToBigInt(dividend);
+        BigInt v = ToBigInt(divisor);
+        EXPECT_EQ(ToBigInt(quotient), BigInt::Div(u, v))
+            << "dividend_size: " << dividend_size
+            << " divisor_size: " << divisor_size;
+        EXPECT_EQ(ToBigInt(remainder), BigInt::Mod(u, v))
+            << "dividend_size: " << dividend_size
+            << " divisor_size: " << divisor_size;
+      }
+    }
+  }
+}
+
+TEST(WordArithmeticTest, DivideExactMultiple) {
+  std::mt19937_64 rng;
+  for (int64_t size : {2, 41, 64}) {
+    Words divisor = MakeWords(size, Kind::kRandom, rng);
+    Words multiplier = MakeWords(2 * size, Kind::kRandom, rng);
+    Words dividend(3 * size);
+    MultiplyWords(divisor, multiplier, absl::MakeSpan(dividend));
+    Words quotient(dividend.size());
+    Words remainder(divisor.size());
+    DivideWords(dividend, divisor, absl::MakeSpan(quotient),
+                absl::MakeSpan(remainder));
+    EXPECT_EQ(ToBigInt(quotient), ToBigInt(multiplier));
+    EXPECT_EQ(ToBigInt(remainder), BigInt::Zero());
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,80 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Minimal C interface for calling ahead-of-time compiled XLS functions.
+//
+// For each entry point `fn` of a library built with xls_ir_cc_library, the
+// generated header declares the following functions with C linkage, where
+// `<prefix>` is the configured namespaces joined by underscores followed by an
+// underscore (e.g., `a_b_fn` for namespaces "a,b"):
+//
+//   int64_t <prefix>fn_arg_count(void);
+//   int64_t <prefix>fn_arg_buffer_size(int64_t index);
+//   int64_t <prefix>fn_result_buffer_size(void);
+//   int64_t <prefix>fn_temp_buffer_size(void);
+//   int <prefix>fn_run(const uint8_t* const* args, uint8_t* result,
+//                      uint8_t* temp_buffer, XlsAotEvents* events);
+//
+// Arguments and the result are in the packed layout used by PackedBitsView
+// and PackedTupleView (xls/ir/value_view.h), with no padding between
+// elements. `args` holds one buffer per parameter of at least
+// `arg_buffer_size(i)` bytes and `result` must hold at least
+// `result_buffer_size()` bytes. `temp_buffer` is scratch space of at least
+// `temp_buffer_size()` bytes aligned to XLS_AOT_BUFFER_ALIGNMENT; it may be
+// reused across calls but not by concurrent calls. The run function performs
+// no heap allocation and constructs no xls::Value: it returns
+// XLS_AOT_OK, or XLS_AOT_ASSERTION_FAILED if an assertion fired during the
+// call.
+//
+// `events` may be NULL. Otherwise it is left untouched unless a trace or an
+// assertion fires, in which case the message is appended to it; messages
+// accumulate across calls until xls_aot_events_clear() is called.
+
+#ifndef XLS_JIT_AOT_C_API_H_
+#define XLS_JIT_AOT_C_API_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define XLS_AOT_BUFFER_ALIGNMENT 16
+
+#define XLS_AOT_OK 0
+#define XLS_AOT_ASSERTION_FAILED 1
+
+// Opaque collection of the trace and assertion messages of calls.
+typedef struct XlsAotEvents XlsAotEvents;
+
+XlsAotEvents* xls_aot_events_create(void);
+void xls_aot_events_destroy(XlsAotEvents* events);
+
+// Removes all messages. Keeps the allocated storage for reuse.
+void xls_aot_events_clear(XlsAotEvents* events);
+
+// Accessors for the recorded messages. The returned strings are owned by
+// `events` and are valid until it is next cleared, modified or destroyed.
+int64_t xls_aot_events_trace_count(const XlsAotEvents* events);
+const char* xls_aot_events_trace_message(const XlsAotEvents* events,
+                                         int64_t index);
+int64_t xls_aot_events_assert_count(const XlsAotEvents* events);
+const char* xls_aot_events_assert_message(const XlsAotEvents* events,
+                                          int64_t index);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // XLS_JIT_AOT_C_API_H_
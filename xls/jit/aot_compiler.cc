@@ -24,6 +24,7 @@
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/strip.h"
+#include "absl/types/span.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
@@ -34,12 +35,17 @@
 #include "xls/jit/function_jit.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.pb.h"
 
 ABSL_FLAG(std::string, input, "", "Path to the IR to compile.");
 ABSL_FLAG(std::string, top, "",
-          "IR function to compile. "
-          "If unspecified, the package top function will be used - "
-          "in that case, the package-scoping mangling will be removed.");
+          "Comma-separated list of IR functions to compile into a single "
+          "library. If unspecified, the package top function will be used. "
+          "The package-scoping mangling is removed from the names of the "
+          "generated wrappers.");
+ABSL_FLAG(bool, all_functions, false,
+          "If true, compile every function in the package into the library. "
+          "Exclusive with --top.");
 ABSL_FLAG(std::string, namespaces, "",
           "Comma-separated list of namespaces into which to place the "
           "generated code. Earlier-specified namespaces enclose "
@@ -60,54 +66,95 @@ ABSL_FLAG(
 namespace xls {
 namespace {
 
-// Returns the text serialization of the TypeLayouts for the arguments of
-// `f`. Returned string is a text proto of type TypeLayoutsProto.
-std::string ArgLayoutsSerialization(Function* f,
-                                    LlvmTypeConverter& type_converter) {
-  TypeLayoutsProto layouts_proto;
-  for (Param* param : f->params()) {
-    *layouts_proto.add_layouts() =
-        type_converter.CreateTypeLayout(param->GetType()).ToProto();
+// Returns the text serialization of the TypeLayouts of the arguments and
+// return values of `functions`. Returned string is a text proto of type
+// FunctionLayoutsProto.
+std::string FunctionLayoutsSerialization(absl::Span<Function* const> functions,
+                                         LlvmTypeConverter& type_converter) {
+  FunctionLayoutsProto layouts_proto;
+  for (Function* f : functions) {
+    FunctionLayoutProto* function_layout = layouts_proto.add_functions();
+    function_layout->set_name(f->name());
+    for (Param* param : f->params()) {
+      *function_layout->mutable_arg_layouts()->add_layouts() =
+          type_converter.CreateTypeLayout(param->GetType()).ToProto();
+    }
+    *function_layout->mutable_result_layout() =
+        type_converter.CreateTypeLayout(f->return_value()->GetType())
+            .ToProto();
   }
   std::string text;
   XLS_CHECK(google::protobuf::TextFormat::PrintToString(layouts_proto, &text));
   return text;
 }
 
-// Returns the text serialization of the TypeLayout for the return value of
-// `f`. Returned string is a text proto of type TypeLayoutProto.
-std::string ResultLayoutSerialization(Function* f,
-                                      LlvmTypeConverter& type_converter) {
-  TypeLayoutProto layout_proto =
-      type_converter.CreateTypeLayout(f->return_value()->GetType()).ToProto();
-  std::string text;
-  XLS_CHECK(google::protobuf::TextFormat::PrintToString(layout_proto, &text));
-  return text;
+// Returns the name of the wrapper of `f`: the function name with the package
+// name prefix removed.
+std::string WrapperFunctionName(Function* f) {
+  std::string package_prefix = absl::StrCat("__", f->package()->name(), "__");
+  return std::string(absl::StripPrefix(f->name(), package_prefix));
 }
 
-// Produces a simple header file containing a call with the same name as the
-// target function (with the package name prefix removed).
+// Returns the prefix of the names of the C entry points of `f`: the namespaces
+// and the wrapper name joined by underscores.
+std::string CEntryPointPrefix(Function* f,
+                              const std::vector<std::string>& namespaces) {
+  std::vector<std::string> parts = namespaces;
+  parts.push_back(WrapperFunctionName(f));
+  return absl::StrJoin(parts, "_");
+}
+
+// Returns the parameter list of the wrapper of `f`.
+std::string WrapperParams(Function* f) {
+  std::vector<std::string> params;
+  for (const Param* param : f->params()) {
+    params.push_back(absl::StrCat("const ::xls::Value& ", param->name()));
+  }
+  return absl::StrJoin(params, ", ");
+}
+
+// Produces a simple header file containing a call for each of the target
+// functions with the same name as the function (with the package name prefix
+// removed).
 absl::StatusOr<std::string> GenerateHeader(
-    Package* p, Function* f, const std::vector<std::string>& namespaces) {
+    absl::Span<Function* const> functions,
+    const std::vector<std::string>& namespaces) {
   constexpr std::string_view kTemplate =
       R"(// AUTO-GENERATED FILE! DO NOT EDIT!
+#include <stdint.h>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/value.h"
+#include "xls/jit/aot_c_api.h"
 
 {{open_ns}}
-absl::StatusOr<xls::Value> {{wrapper_fn_name}}({{wrapper_params}});
-{{close_ns}})";
+{{wrapper_decls}}
+{{close_ns}}
+// Allocation-free entry points with C linkage; see xls/jit/aot_c_api.h.
+extern "C" {
+{{c_decls}}
+}  // extern "C"
+)";
 
   absl::flat_hash_map<std::string, std::string> substitution_map;
-  std::string package_prefix = absl::StrCat("__", p->name(), "__");
-  substitution_map["{{wrapper_fn_name}}"] =
-      absl::StripPrefix(f->name(), package_prefix);
-
-  std::vector<std::string> params;
-  for (const Param* param : f->params()) {
-    params.push_back(absl::StrCat("const ::xls::Value& ", param->name()));
+  std::vector<std::string> wrapper_decls;
+  std::vector<std::string> c_decls;
+  for (Function* f : functions) {
+    wrapper_decls.push_back(
+        absl::StrFormat("absl::StatusOr<xls::Value> %s(%s);",
+                        WrapperFunctionName(f), WrapperParams(f)));
+    std::string prefix = CEntryPointPrefix(f, namespaces);
+    c_decls.push_back(absl::StrFormat(
+        "\nint64_t %s_arg_count(void);\n"
+        "int64_t %s_arg_buffer_size(int64_t index);\n"
+        "int64_t %s_result_buffer_size(void);\n"
+        "int64_t %s_temp_buffer_size(void);\n"
+        "int %s_run(const uint8_t* const* args, uint8_t* result,\n"
+        "    uint8_t* temp_buffer, XlsAotEvents* events);",
+        prefix, prefix, prefix, prefix, prefix));
   }
-  substitution_map["{{wrapper_params}}"] = absl::StrJoin(params, ", ");
+  substitution_map["{{wrapper_decls}}"] = absl::StrJoin(wrapper_decls, "\n");
+  substitution_map["{{c_decls}}"] = absl::StrJoin(c_decls, "\n");
 
   if (namespaces.empty()) {
     substitution_map["{{open_ns}}"] = "";
@@ -122,19 +169,120 @@ absl::StatusOr<xls::Value> {{wrapper_fn_name}}({{wrapper_params}});
   return absl::StrReplaceAll(kTemplate, substitution_map);
 }
 
-// Generates a source file to wrap invocation of the generated function.
+// Generates the wrapper for a single entry point of the library. `index` is the
+// index of the entry point in the library's type layout.
+std::string GenerateWrapper(const JitLibraryObjectCode::EntryPoint& entry_point,
+                            int64_t index) {
+  constexpr std::string_view kTemplate =
+      R"~(absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
+  const xls::aot_compile::FunctionTypeLayout& layout =
+    GetLibraryTypeLayout().function_layout({{layout_index}});
+{{arg_buffer_decls}}
+  uint8_t* arg_buffers[] = {{arg_buffer_collector}};
+  uint8_t result_buffer[{{result_size}}];
+  layout.ArgValuesToNativeLayout(
+    {{{param_names}}}, absl::MakeSpan(arg_buffers, {{arg_count}}));
+
+  uint8_t* output_buffers[1] = {result_buffer};
+  ::xls::InterpreterEvents events;
+  {{extern_fn}}(arg_buffers, output_buffers, GetTempBuffer(),
+                &events, /*user_data=*/nullptr, /*jit_runtime=*/nullptr,
+                /*continuation_point=*/0);
+
+  return layout.NativeLayoutResultToValue(result_buffer);
+}
+)~";
+  Function* f = entry_point.function;
+  absl::flat_hash_map<std::string, std::string> substitution_map;
+  substitution_map["{{extern_fn}}"] = entry_point.function_name;
+  substitution_map["{{layout_index}}"] = absl::StrCat(index);
+
+  std::vector<std::string> param_names;
+  std::vector<std::string> arg_buffer_decls;
+  std::vector<std::string> arg_buffer_names;
+  for (int64_t i = 0; i < f->params().size(); ++i) {
+    Param* param = f->param(i);
+    param_names.push_back(std::string(param->name()));
+    arg_buffer_decls.push_back(
+        absl::StrFormat("  uint8_t %s_buffer[%d];", param->name(),
+                        entry_point.parameter_buffer_sizes[i]));
+    arg_buffer_names.push_back(absl::StrCat(param->name(), "_buffer"));
+  }
+  substitution_map["{{wrapper_params}}"] = WrapperParams(f);
+  substitution_map["{{param_names}}"] = absl::StrJoin(param_names, ", ");
+  substitution_map["{{arg_buffer_decls}}"] =
+      absl::StrJoin(arg_buffer_decls, "\n");
+  substitution_map["{{arg_buffer_collector}}"] =
+      absl::StrFormat("{%s}", absl::StrJoin(arg_buffer_names, ", "));
+  substitution_map["{{result_size}}"] =
+      absl::StrCat(entry_point.return_buffer_size);
+  substitution_map["{{arg_count}}"] = absl::StrCat(f->params().size());
+  substitution_map["{{wrapper_fn_name}}"] = WrapperFunctionName(f);
+  return absl::StrReplaceAll(kTemplate, substitution_map);
+}
+
+// Generates the C entry points of a single entry point of the library. These
+// call the packed wrapper of the jitted function directly on the caller's
+// buffers, so no Values are constructed and nothing is allocated.
+std::string GenerateCEntryPoints(
+    const JitLibraryObjectCode::EntryPoint& entry_point,
+    int64_t temp_buffer_size, const std::vector<std::string>& namespaces) {
+  constexpr std::string_view kTemplate =
+      R"~(int64_t {{prefix}}_arg_count(void) { return {{arg_count}}; }
+
+int64_t {{prefix}}_arg_buffer_size(int64_t index) {
+  // The trailing zero keeps the array non-empty for nullary functions.
+  static constexpr int64_t kSizes[] = {{{arg_sizes}}};
+  return kSizes[index];
+}
+
+int64_t {{prefix}}_result_buffer_size(void) { return {{result_size}}; }
+
+int64_t {{prefix}}_temp_buffer_size(void) { return {{temp_buffer_size}}; }
+
+int {{prefix}}_run(const uint8_t* const* args, uint8_t* result,
+    uint8_t* temp_buffer, XlsAotEvents* events) {
+  // Default-constructed events do not allocate.
+  ::xls::InterpreterEvents local_events;
+  ::xls::InterpreterEvents* call_events =
+      events == nullptr ? &local_events : &events->events;
+  const size_t assert_count = call_events->assert_msgs.size();
+  uint8_t* output_buffers[1] = {result};
+  {{packed_fn}}(args, output_buffers, temp_buffer, call_events,
+                /*user_data=*/nullptr, /*jit_runtime=*/nullptr,
+                /*continuation_point=*/0);
+  return call_events->assert_msgs.size() == assert_count
+             ? XLS_AOT_OK : XLS_AOT_ASSERTION_FAILED;
+}
+)~";
+  std::vector<int64_t> arg_sizes = entry_point.packed_parameter_buffer_sizes;
+  arg_sizes.push_back(0);
+  absl::flat_hash_map<std::string, std::string> substitution_map;
+  substitution_map["{{prefix}}"] =
+      CEntryPointPrefix(entry_point.function, namespaces);
+  substitution_map["{{arg_count}}"] =
+      absl::StrCat(entry_point.function->params().size());
+  substitution_map["{{arg_sizes}}"] = absl::StrJoin(arg_sizes, ", ");
+  substitution_map["{{result_size}}"] =
+      absl::StrCat(entry_point.packed_return_buffer_size);
+  substitution_map["{{temp_buffer_size}}"] = absl::StrCat(temp_buffer_size);
+  substitution_map["{{packed_fn}}"] = entry_point.packed_function_name;
+  return absl::StrReplaceAll(kTemplate, substitution_map);
+}
+
+// Generates a source file to wrap invocation of the generated functions.
 // This is more complicated than one might expect due to the fact that we need
 // to use some LLVM internals (via the LlvmTypeConverter) to know how to convert
 // an XLS Value into a bit buffer packed in the manner expected by LLVM.
-// We also need to know the arguments and return types of the function for the
+// We also need to know the arguments and return types of the functions for the
 // same reason. This requires having those types described in this source file.
-// To do that, we encode the Function's FunctionType as a text-format proto and
-// decode it on first execution.
+// To do that, we encode the TypeLayouts of all entry points as a single
+// text-format proto and decode it on first execution.
 // On that note, we do as much work as we can in one-time initialization to
-// reduce the tax paid during normal execution.
+// reduce the tax paid during normal execution. The decoded layouts and the
+// temporary buffer are shared by all entry points of the library.
 absl::StatusOr<std::string> GenerateWrapperSource(
-    Function* f, const JitObjectCode& object_code,
-    const std::string& header_path,
+    const JitLibraryObjectCode& object_code, const std::string& header_path,
     const std::vector<std::string>& namespaces) {
   constexpr std::string_view kTemplate =
       R"~(// AUTO-GENERATED FILE! DO NOT EDIT!
@@ -150,60 +298,71 @@ absl::StatusOr<std::string> GenerateWrapperSource(
 #include "xls/jit/aot_runtime.h"
 
 extern "C" {
-void {{extern_fn}}(const uint8_t* const* inputs,
-                   uint8_t* const* outputs,
-                   uint8_t* temp_buffer,
-                   ::xls::InterpreterEvents* events,
-                   void* unused,
-                   int64_t continuation_point);
+{{extern_decls}}
 }
 {{open_ns}}
 
 namespace {
 
-const char* kArgLayouts = R"|({{arg_layouts_proto}})|";
-const char* kResultLayout = R"|({{result_layout_proto}})|";
+const char* kFunctionLayouts = R"|({{function_layouts_proto}})|";
 
-const xls::aot_compile::FunctionTypeLayout& GetFunctionTypeLayout() {
-  static std::unique_ptr<xls::aot_compile::FunctionTypeLayout> function_layout =
-    xls::aot_compile::FunctionTypeLayout::Create(kArgLayouts, kResultLayout).value();
-  return *function_layout;
+const xls::aot_compile::LibraryTypeLayout& GetLibraryTypeLayout() {
+  static std::unique_ptr<xls::aot_compile::LibraryTypeLayout> library_layout =
+    xls::aot_compile::LibraryTypeLayout::Create(kFunctionLayouts).value();
+  return *library_layout;
 }
 
-}  //  namespace
+uint8_t* GetTempBuffer() {
+  return xls::aot_compile::GetThreadLocalTempBuffer({{temp_buffer_size}}).data();
+}
 
-absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
-{{arg_buffer_decls}}
-  uint8_t* arg_buffers[] = {{arg_buffer_collector}};
-  uint8_t result_buffer[{{result_size}}];
-  GetFunctionTypeLayout().ArgValuesToNativeLayout(
-    {{{param_names}}}, absl::MakeSpan(arg_buffers, {{arg_count}}));
+}  //  namespace
 
-  uint8_t* output_buffers[1] = {result_buffer};
-  std::vector<uint8_t> temp_buffers({{temp_buffer_size}});
-  ::xls::InterpreterEvents events;
-  {{extern_fn}}(arg_buffers, output_buffers, temp_buffers.data(),
-                &events, /*unused=*/nullptr, /*continuation_point=*/0);
+{{wrappers}}
+{{close_ns}}
 
-  return GetFunctionTypeLayout().NativeLayoutResultToValue(result_buffer);
-}
+extern "C" {
 
-{{close_ns}}
+{{c_entry_points}}
+}  // extern "C"
 )~";
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
                        orc_jit->CreateDataLayout());
   LlvmTypeConverter type_converter(orc_jit->GetContext(), data_layout);
 
+  std::vector<Function*> functions;
+  std::vector<std::string> extern_decls;
+  std::vector<std::string> wrappers;
+  std::vector<std::string> c_entry_points;
+  for (int64_t i = 0; i < object_code.entry_points.size(); ++i) {
+    const JitLibraryObjectCode::EntryPoint& entry_point =
+        object_code.entry_points[i];
+    functions.push_back(entry_point.function);
+    extern_decls.push_back(absl::StrFormat(
+        "void %s(const uint8_t* const* inputs, uint8_t* const* outputs, "
+        "uint8_t* temp_buffer, ::xls::InterpreterEvents* events, "
+        "void* user_data, void* jit_runtime, int64_t continuation_point);",
+        entry_point.function_name));
+    extern_decls.push_back(absl::StrFormat(
+        "void %s(const uint8_t* const* inputs, uint8_t* const* outputs, "
+        "uint8_t* temp_buffer, ::xls::InterpreterEvents* events, "
+        "void* user_data, void* jit_runtime, int64_t continuation_point);",
+        entry_point.packed_function_name));
+    wrappers.push_back(GenerateWrapper(entry_point, i));
+    c_entry_points.push_back(GenerateCEntryPoints(
+        entry_point, object_code.temp_buffer_size, namespaces));
+  }
+
   absl::flat_hash_map<std::string, std::string> substitution_map;
   substitution_map["{{header_path}}"] = header_path;
-  substitution_map["{{extern_fn}}"] = object_code.function_name;
-  substitution_map["{{arg_layouts_proto}}"] =
-      ArgLayoutsSerialization(f, type_converter);
-  substitution_map["{{result_layout_proto}}"] =
-      ResultLayoutSerialization(f, type_converter);
+  substitution_map["{{extern_decls}}"] = absl::StrJoin(extern_decls, "\n");
+  substitution_map["{{function_layouts_proto}}"] =
+      FunctionLayoutsSerialization(functions, type_converter);
   substitution_map["{{temp_buffer_size}}"] =
       absl::StrCat(object_code.temp_buffer_size);
+  substitution_map["{{wrappers}}"] = absl::StrJoin(wrappers, "\n");
+  substitution_map["{{c_entry_points}}"] = absl::StrJoin(c_entry_points, "\n");
 
   if (namespaces.empty()) {
     substitution_map["{{open_ns}}"] = "";
@@ -214,42 +373,26 @@ absl::StatusOr<::xls::Value> {{wrapper_fn_name}}({{wrapper_params}}) {
     substitution_map["{{close_ns}}"] =
         absl::StrFormat("}  // namespace %s", absl::StrJoin(namespaces, "::"));
   }
+  return absl::StrReplaceAll(kTemplate, substitution_map);
+}
 
-  int64_t return_type_bytes = object_code.return_buffer_size;
-
-  std::vector<std::string> params;
-  std::vector<std::string> param_names;
-  std::vector<std::string> arg_buffer_decls;
-  std::vector<std::string> arg_buffer_names;
-  for (int64_t i = 0; i < f->params().size(); ++i) {
-    Param* param = f->param(i);
-    params.push_back(absl::StrCat("const ::xls::Value& ", param->name()));
-    param_names.push_back(std::string(param->name()));
-    arg_buffer_decls.push_back(
-        absl::StrFormat("  uint8_t %s_buffer[%d];", param->name(),
-                        object_code.parameter_buffer_sizes[i]));
-    arg_buffer_names.push_back(absl::StrCat(param->name(), "_buffer"));
+// Returns the function named `name` in `package`. `name` may be either the full
+// name of the function or the name without the package-scoping mangling.
+absl::StatusOr<Function*> GetFunction(Package* package, std::string_view name) {
+  absl::StatusOr<Function*> f = package->GetFunction(name);
+  if (f.ok()) {
+    return f;
   }
-  substitution_map["{{wrapper_params}}"] = absl::StrJoin(params, ", ");
-  substitution_map["{{param_names}}"] = absl::StrJoin(param_names, ", ");
-  substitution_map["{{arg_buffer_decls}}"] =
-      absl::StrJoin(arg_buffer_decls, "\n");
-  substitution_map["{{arg_buffer_collector}}"] =
-      absl::StrFormat("{%s}", absl::StrJoin(arg_buffer_names, ", "));
-  substitution_map["{{result_size}}"] = absl::StrCat(return_type_bytes);
-  substitution_map["{{arg_count}}"] = absl::StrCat(params.size());
-
-  std::string type_textproto;
-  google::protobuf::TextFormat::PrintToString(f->GetType()->ToProto(), &type_textproto);
-  substitution_map["{{type_textproto}}"] = type_textproto;
-
-  std::string package_prefix = absl::StrCat("__", f->package()->name(), "__");
-  substitution_map["{{wrapper_fn_name}}"] =
-      absl::StripPrefix(f->name(), package_prefix);
-  return absl::StrReplaceAll(kTemplate, substitution_map);
+  absl::StatusOr<Function*> mangled_f =
+      package->GetFunction(absl::StrCat("__", package->name(), "__", name));
+  if (mangled_f.ok()) {
+    return mangled_f;
+  }
+  return f.status();
 }
 
-absl::Status RealMain(const std::string& input_ir_path, std::string top,
+absl::Status RealMain(const std::string& input_ir_path,
+                      const std::vector<std::string>& tops, bool all_functions,
                       const std::string& output_object_path,
                       const std::string& output_header_path,
                       const std::string& output_source_path,
@@ -259,26 +402,37 @@ absl::Status RealMain(const std::string& input_ir_path, std::string top,
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(input_ir, input_ir_path));
 
-  Function* f;
-  std::string package_prefix = absl::StrCat("__", package->name(), "__");
-  if (top.empty()) {
-    XLS_ASSIGN_OR_RETURN(f, package->GetTopAsFunction());
+  std::vector<Function*> functions;
+  if (all_functions) {
+    for (const std::unique_ptr<Function>& f : package->functions()) {
+      functions.push_back(f.get());
+    }
+  } else if (tops.empty()) {
+    XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+    functions.push_back(f);
   } else {
-    XLS_ASSIGN_OR_RETURN(f, package->GetFunction(top));
+    for (const std::string& top : tops) {
+      XLS_ASSIGN_OR_RETURN(Function * f, GetFunction(package.get(), top));
+      functions.push_back(f);
+    }
   }
-  XLS_ASSIGN_OR_RETURN(JitObjectCode object_code,
-                       FunctionJit::CreateObjectCode(f));
+  if (functions.empty()) {
+    return absl::InvalidArgumentError("No functions to compile.");
+  }
+
+  XLS_ASSIGN_OR_RETURN(JitLibraryObjectCode object_code,
+                       FunctionJit::CreateLibraryObjectCode(functions));
   XLS_RETURN_IF_ERROR(SetFileContents(
       output_object_path, std::string(object_code.object_code.begin(),
                                       object_code.object_code.end())));
 
   XLS_ASSIGN_OR_RETURN(std::string header_text,
-                       GenerateHeader(package.get(), f, namespaces));
+                       GenerateHeader(functions, namespaces));
   XLS_RETURN_IF_ERROR(SetFileContents(output_header_path, header_text));
 
   XLS_ASSIGN_OR_RETURN(
       std::string source_text,
-      GenerateWrapperSource(f, object_code, header_include_path, namespaces));
+      GenerateWrapperSource(object_code, header_include_path, namespaces));
   XLS_RETURN_IF_ERROR(SetFileContents(output_source_path, source_text));
 
   return absl::OkStatus();
@@ -293,7 +447,14 @@ int main(int argc, char** argv) {
   XLS_QCHECK(!input_ir_path.empty())
       << "--input must be specified." << std::endl;
 
-  std::string top = absl::GetFlag(FLAGS_top);
+  std::vector<std::string> tops;
+  std::string top_string = absl::GetFlag(FLAGS_top);
+  if (!top_string.empty()) {
+    tops = absl::StrSplit(top_string, ',');
+  }
+  bool all_functions = absl::GetFlag(FLAGS_all_functions);
+  XLS_QCHECK(!all_functions || tops.empty())
+      << "At most one of --top and --all_functions may be specified.";
 
   std::string output_object_path = absl::GetFlag(FLAGS_output_object);
   std::string output_header_path = absl::GetFlag(FLAGS_output_header);
@@ -312,8 +473,9 @@ int main(int argc, char** argv) {
     namespaces = absl::StrSplit(namespaces_string, ',');
   }
   absl::Status status =
-      xls::RealMain(input_ir_path, top, output_object_path, output_header_path,
-                    output_source_path, header_include_path, namespaces);
+      xls::RealMain(input_ir_path, tops, all_functions, output_object_path,
+                    output_header_path, output_source_path,
+                    header_include_path, namespaces);
   if (!status.ok()) {
     std::cout << status.message();
     return 1;
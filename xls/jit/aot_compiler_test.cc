@@ -12,13 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
+#include "xls/jit/aot_c_api.h"
 #include "xls/jit/compound_type_cc.h"
+#include "xls/jit/multi_function_cc.h"
 #include "xls/jit/null_function_cc.h"
 #include "xls/modules/fp/fp32_add_2_cc.h"
 #include "xls/modules/fp/fp32_fma_cc.h"
@@ -71,6 +76,48 @@ TEST(AotCompileTest, CompoundType) {
   EXPECT_EQ(result, Value::Tuple({b, Value(UBits(43, 32)), c}));
 }
 
+TEST(AotCompileTest, MultipleEntryPoints) {
+  Value x = Value(UBits(41, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value result, xls::multi::add_one(x));
+  EXPECT_EQ(result, Value(UBits(42, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(result, xls::multi::add_two(x));
+  EXPECT_EQ(result, Value(UBits(43, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      result, xls::multi::scale(x, Value::Tuple({Value(UBits(3, 8)),
+                                                 Value(UBits(7, 16))})));
+  EXPECT_EQ(result, Value::Tuple({Value(UBits(123, 32)), Value(UBits(7, 16))}));
+}
+
+TEST(AotCompileTest, CEntryPoints) {
+  EXPECT_EQ(xls_multi_add_two_arg_count(), 1);
+  EXPECT_EQ(xls_multi_add_two_arg_buffer_size(0), 4);
+  EXPECT_EQ(xls_multi_add_two_result_buffer_size(), 4);
+  EXPECT_EQ(xls_multi_scale_arg_count(), 2);
+  EXPECT_EQ(xls_multi_scale_arg_buffer_size(1), 3);
+  EXPECT_EQ(xls_multi_scale_result_buffer_size(), 6);
+
+  // Heap allocations are aligned to at least XLS_AOT_BUFFER_ALIGNMENT.
+  std::vector<uint8_t> temp_buffer(xls_multi_add_two_temp_buffer_size());
+  uint32_t x = 41;
+  uint32_t result = 0;
+  const uint8_t* args[] = {reinterpret_cast<const uint8_t*>(&x)};
+  XlsAotEvents* events = xls_aot_events_create();
+  EXPECT_EQ(xls_multi_add_two_run(args, reinterpret_cast<uint8_t*>(&result),
+                                  temp_buffer.data(), events),
+            XLS_AOT_OK);
+  EXPECT_EQ(result, 43);
+  EXPECT_EQ(xls_aot_events_trace_count(events), 0);
+  EXPECT_EQ(xls_aot_events_assert_count(events), 0);
+  xls_aot_events_destroy(events);
+
+  // Events are optional.
+  x = 100;
+  EXPECT_EQ(xls_multi_add_two_run(args, reinterpret_cast<uint8_t*>(&result),
+                                  temp_buffer.data(), /*events=*/nullptr),
+            XLS_AOT_OK);
+  EXPECT_EQ(result, 102);
+}
+
 #ifndef NDEBUG
 // In non-opt mode, argument values are type-checked using DCHECK.
 TEST(AotCompileTest, InvalidTypes) {
@@ -18,6 +18,22 @@
 
 namespace xls::aot_compile {
 
+/* static */ absl::StatusOr<std::unique_ptr<FunctionTypeLayout>>
+FunctionTypeLayout::FromProtos(const TypeLayoutsProto& arg_layouts_proto,
+                               const TypeLayoutProto& result_layout_proto,
+                               Package* package) {
+  std::vector<TypeLayout> arg_layouts;
+  for (const TypeLayoutProto& layout_proto : arg_layouts_proto.layouts()) {
+    XLS_ASSIGN_OR_RETURN(TypeLayout arg_layout,
+                         TypeLayout::FromProto(layout_proto, package));
+    arg_layouts.push_back(std::move(arg_layout));
+  }
+  XLS_ASSIGN_OR_RETURN(TypeLayout result_layout,
+                       TypeLayout::FromProto(result_layout_proto, package));
+  return absl::WrapUnique(new FunctionTypeLayout(
+      /*package=*/nullptr, std::move(arg_layouts), std::move(result_layout)));
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<FunctionTypeLayout>>
 FunctionTypeLayout::Create(std::string_view serialized_arg_layouts,
                            std::string_view serialized_result_layout) {
@@ -29,25 +45,78 @@ FunctionTypeLayout::Create(std::string_view serialized_arg_layouts,
     return absl::InvalidArgumentError(
         "Unable to parse TypeLayoutsProto for arguments");
   }
-  std::vector<TypeLayout> arg_layouts;
-  for (const TypeLayoutProto& layout_proto : arg_layouts_proto.layouts()) {
-    XLS_ASSIGN_OR_RETURN(
-        TypeLayout arg_layout,
-        TypeLayout::FromProto(layout_proto, dummy_package.get()));
-    arg_layouts.push_back(std::move(arg_layout));
-  }
   TypeLayoutProto result_layout_proto;
   if (!google::protobuf::TextFormat::ParseFromString(
           std::string(serialized_result_layout), &result_layout_proto)) {
     return absl::InvalidArgumentError(
         "Unable to parse TypeLayoutProto for result");
   }
-  XLS_ASSIGN_OR_RETURN(
-      TypeLayout result_layout,
-      TypeLayout::FromProto(result_layout_proto, dummy_package.get()));
-  return absl::WrapUnique(new FunctionTypeLayout(std::move(dummy_package),
-                                                 std::move(arg_layouts),
-                                                 std::move(result_layout)));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionTypeLayout> function_layout,
+                       FromProtos(arg_layouts_proto, result_layout_proto,
+                                  dummy_package.get()));
+  function_layout->package_ = std::move(dummy_package);
+  return function_layout;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<LibraryTypeLayout>>
+LibraryTypeLayout::Create(std::string_view serialized_function_layouts) {
+  FunctionLayoutsProto function_layouts_proto;
+  if (!google::protobuf::TextFormat::ParseFromString(
+          std::string(serialized_function_layouts), &function_layouts_proto)) {
+    return absl::InvalidArgumentError(
+        "Unable to parse FunctionLayoutsProto");
+  }
+  auto library_layout = absl::WrapUnique(
+      new LibraryTypeLayout(std::make_unique<Package>("__aot_compiler")));
+  for (const FunctionLayoutProto& function_layout_proto :
+       function_layouts_proto.functions()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<FunctionTypeLayout> function_layout,
+        FunctionTypeLayout::FromProtos(function_layout_proto.arg_layouts(),
+                                       function_layout_proto.result_layout(),
+                                       library_layout->package_.get()));
+    library_layout->function_layouts_.push_back(std::move(function_layout));
+  }
+  return library_layout;
+}
+
+absl::Span<uint8_t> GetThreadLocalTempBuffer(int64_t size) {
+  static thread_local std::vector<uint8_t> buffer;
+  if (buffer.size() < size) {
+    buffer.resize(size);
+  }
+  return absl::MakeSpan(buffer);
 }
 
 }  // namespace xls::aot_compile
+
+extern "C" {
+
+XlsAotEvents* xls_aot_events_create(void) { return new XlsAotEvents(); }
+
+void xls_aot_events_destroy(XlsAotEvents* events) { delete events; }
+
+void xls_aot_events_clear(XlsAotEvents* events) {
+  events->events.trace_msgs.clear();
+  events->events.assert_msgs.clear();
+}
+
+int64_t xls_aot_events_trace_count(const XlsAotEvents* events) {
+  return events->events.trace_msgs.size();
+}
+
+const char* xls_aot_events_trace_message(const XlsAotEvents* events,
+                                         int64_t index) {
+  return events->events.trace_msgs.at(index).c_str();
+}
+
+int64_t xls_aot_events_assert_count(const XlsAotEvents* events) {
+  return events->events.assert_msgs.size();
+}
+
+const char* xls_aot_events_assert_message(const XlsAotEvents* events,
+                                          int64_t index) {
+  return events->events.assert_msgs.at(index).c_str();
+}
+
+}  // extern "C"
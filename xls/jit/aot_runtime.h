@@ -18,15 +18,25 @@
 #ifndef XLS_JIT_AOT_RUNTIME_H_
 #define XLS_JIT_AOT_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
+#include <string_view>
 #include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/ir/events.h"
 #include "xls/ir/package.h"
+#include "xls/jit/aot_c_api.h"
 #include "xls/jit/type_layout.h"
 #include "xls/jit/type_layout.pb.h"
 
+// Definition of the events type which is opaque in the C interface. The
+// generated C entry points pass `events` straight to the jitted code.
+struct XlsAotEvents {
+  xls::InterpreterEvents events;
+};
+
 namespace xls::aot_compile {
 
 // Data structure for converting the arguments and return value of an XLS
@@ -58,6 +68,8 @@ class FunctionTypeLayout {
   }
 
  private:
+  friend class LibraryTypeLayout;
+
   FunctionTypeLayout(std::unique_ptr<Package> package,
                      std::vector<TypeLayout> arg_layouts,
                      TypeLayout result_layout)
@@ -65,13 +77,51 @@ class FunctionTypeLayout {
         arg_layouts_(std::move(arg_layouts)),
         result_layout_(std::move(result_layout)) {}
 
+  // Creates a FunctionTypeLayout whose types are owned by `package`.
+  static absl::StatusOr<std::unique_ptr<FunctionTypeLayout>> FromProtos(
+      const TypeLayoutsProto& arg_layouts_proto,
+      const TypeLayoutProto& result_layout_proto, Package* package);
+
   // Dummy package used for owning Types required by the TypeLayout data
-  // structures.
+  // structures. May be null if the types are owned elsewhere (e.g., by a
+  // LibraryTypeLayout).
   std::unique_ptr<Package> package_;
   std::vector<TypeLayout> arg_layouts_;
   TypeLayout result_layout_;
 };
 
+// Data structure holding the FunctionTypeLayouts of all entry points of an
+// AOT-compiled library of functions. The layouts share a single package owning
+// their types.
+class LibraryTypeLayout {
+ public:
+  // Creates and returns a LibraryTypeLayout based on
+  // `serialized_function_layouts`, a text serialization of a
+  // FunctionLayoutsProto.
+  static absl::StatusOr<std::unique_ptr<LibraryTypeLayout>> Create(
+      std::string_view serialized_function_layouts);
+
+  // Returns the layout of the entry point at the given index.
+  const FunctionTypeLayout& function_layout(int64_t index) const {
+    return *function_layouts_[index];
+  }
+  int64_t function_count() const { return function_layouts_.size(); }
+
+ private:
+  explicit LibraryTypeLayout(std::unique_ptr<Package> package)
+      : package_(std::move(package)) {}
+
+  // Dummy package used for owning Types of all of the function layouts.
+  std::unique_ptr<Package> package_;
+  std::vector<std::unique_ptr<FunctionTypeLayout>> function_layouts_;
+};
+
+// Returns a buffer of at least `size` bytes for use as the temporary buffer of
+// AOT-compiled functions. The buffer is allocated once per thread and shared by
+// all AOT-compiled functions called on that thread, which avoids allocating a
+// buffer on each call.
+absl::Span<uint8_t> GetThreadLocalTempBuffer(int64_t size);
+
 }  // namespace xls::aot_compile
 
 #endif  // XLS_JIT_AOT_RUNTIME_H_
@@ -0,0 +1,289 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/block_jit.h"
+
+#include <cstring>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/jit/jit_trace_buffer.h"
+#include "xls/jit/llvm_type_converter.h"
+
+namespace xls {
+namespace {
+
+// Returns whether the single-bit value in the native layout `buffer` is one.
+bool IsBitSet(const uint8_t* buffer) { return (buffer[0] & 1) != 0; }
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<BlockJit>> BlockJit::Create(
+    Block* block, JitObjectCache* object_cache) {
+  if (!block->GetInstantiations().empty()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Block '%s' has instantiations which are not supported by the JIT",
+        block->name()));
+  }
+
+  auto jit = absl::WrapUnique(new BlockJit(block));
+  XLS_ASSIGN_OR_RETURN(
+      jit->orc_jit_,
+      OrcJit::Create(/*opt_level=*/3, /*emit_object_code=*/false,
+                     object_cache));
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       OrcJit::CreateDataLayout());
+  jit->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
+  XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
+                       BuildBlockFunction(block, *jit->orc_jit_));
+
+  // Pre-allocate input, output, and temporary buffers.
+  for (int64_t size : jit->jitted_function_base_.input_buffer_sizes) {
+    jit->input_buffers_.push_back(std::vector<uint8_t>(size));
+    jit->input_ptrs_.push_back(jit->input_buffers_.back().data());
+  }
+  for (int64_t size : jit->jitted_function_base_.output_buffer_sizes) {
+    jit->output_buffers_.push_back(std::vector<uint8_t>(size));
+    jit->output_ptrs_.push_back(jit->output_buffers_.back().data());
+  }
+  jit->temp_buffer_.resize(jit->jitted_function_base_.temp_buffer_size);
+
+  // The layouts follow the order of the inputs and outputs of the jitted
+  // function (see BuildBlockFunction).
+  LlvmTypeConverter type_converter(jit->orc_jit_->GetContext(), data_layout);
+  for (InputPort* port : block->GetInputPorts()) {
+    jit->input_layouts_.push_back(
+        type_converter.CreateTypeLayout(port->GetType()));
+  }
+  for (OutputPort* port : block->GetOutputPorts()) {
+    jit->output_layouts_.push_back(
+        type_converter.CreateTypeLayout(port->operand(0)->GetType()));
+  }
+  int64_t input_index = block->GetInputPorts().size();
+  int64_t output_index = block->GetOutputPorts().size();
+  for (Register* reg : block->GetRegisters()) {
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * reg_write,
+                         block->GetRegisterWrite(reg));
+    TypeLayout layout = type_converter.CreateTypeLayout(reg->type());
+    RegisterInfo info{.reg = reg,
+                      .input_index = input_index++,
+                      .data_index = output_index++};
+    jit->output_layouts_.push_back(layout);
+    if (reg_write->load_enable().has_value()) {
+      info.load_enable_index = output_index++;
+      jit->output_layouts_.push_back(type_converter.CreateTypeLayout(
+          reg_write->load_enable().value()->GetType()));
+    }
+    if (reg_write->reset().has_value()) {
+      XLS_RET_CHECK(reg->reset().has_value()) << absl::StrFormat(
+          "Register '%s' has a reset signal but no reset value", reg->name());
+      info.reset_index = output_index++;
+      jit->output_layouts_.push_back(type_converter.CreateTypeLayout(
+          reg_write->reset().value()->GetType()));
+      info.reset_value.resize(layout.size());
+      layout.ValueToNativeLayout(reg->reset()->reset_value,
+                                 info.reset_value.data());
+      info.reset_active_low = reg->reset()->active_low;
+    }
+    jit->input_layouts_.push_back(std::move(layout));
+    jit->registers_.push_back(std::move(info));
+  }
+  XLS_RET_CHECK_EQ(jit->input_layouts_.size(), jit->input_buffers_.size());
+  XLS_RET_CHECK_EQ(jit->output_layouts_.size(), jit->output_buffers_.size());
+
+  // Initial register state is zero for all registers.
+  for (const RegisterInfo& info : jit->registers_) {
+    jit->input_layouts_[info.input_index].ValueToNativeLayout(
+        ZeroOfType(info.reg->type()), jit->input_ptrs_[info.input_index]);
+  }
+
+  return jit;
+}
+
+absl::Status BlockJit::SetInputs(absl::Span<const Value> inputs) {
+  absl::Span<InputPort* const> ports = block_->GetInputPorts();
+  if (inputs.size() != ports.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Input list to block '%s' has the wrong size: %d vs expected %d",
+        block_->name(), inputs.size(), ports.size()));
+  }
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    if (!ValueConformsToType(inputs[i], ports[i]->GetType())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got value %s for input port '%s' which is not of type %s",
+          inputs[i].ToString(), ports[i]->GetName(),
+          ports[i]->GetType()->ToString()));
+    }
+  }
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    input_layouts_[i].ValueToNativeLayout(inputs[i], input_ptrs_[i]);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status BlockJit::SetInputs(
+    const absl::flat_hash_map<std::string, Value>& inputs) {
+  // Verify each input corresponds to an input port.
+  absl::flat_hash_set<std::string> input_port_names;
+  for (InputPort* port : block_->GetInputPorts()) {
+    input_port_names.insert(port->GetName());
+  }
+  for (const auto& [name, value] : inputs) {
+    if (!input_port_names.contains(name)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Block has no input port '%s'", name));
+    }
+  }
+
+  std::vector<Value> positional_inputs;
+  positional_inputs.reserve(block_->GetInputPorts().size());
+  for (InputPort* port : block_->GetInputPorts()) {
+    auto it = inputs.find(port->GetName());
+    if (it == inputs.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Missing input for port '%s'", port->GetName()));
+    }
+    positional_inputs.push_back(it->second);
+  }
+  return SetInputs(positional_inputs);
+}
+
+absl::Status BlockJit::SetRegisters(
+    const absl::flat_hash_map<std::string, Value>& reg_state) {
+  // Verify each register value corresponds to a register.
+  absl::flat_hash_set<std::string> reg_names;
+  for (Register* reg : block_->GetRegisters()) {
+    reg_names.insert(reg->name());
+  }
+  for (const auto& [name, value] : reg_state) {
+    if (!reg_names.contains(name)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Block has no register '%s'", name));
+    }
+  }
+
+  for (const RegisterInfo& info : registers_) {
+    auto it = reg_state.find(info.reg->name());
+    if (it == reg_state.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Missing value for register '%s'", info.reg->name()));
+    }
+    if (!ValueConformsToType(it->second, info.reg->type())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got value %s for register '%s' which is not of type %s",
+          it->second.ToString(), info.reg->name(),
+          info.reg->type()->ToString()));
+    }
+  }
+  for (const RegisterInfo& info : registers_) {
+    input_layouts_[info.input_index].ValueToNativeLayout(
+        reg_state.at(info.reg->name()), input_ptrs_[info.input_index]);
+  }
+  return absl::OkStatus();
+}
+
+absl::flat_hash_map<std::string, Value> BlockJit::GetRegisters() const {
+  absl::flat_hash_map<std::string, Value> reg_state;
+  for (const RegisterInfo& info : registers_) {
+    reg_state[info.reg->name()] =
+        input_layouts_[info.input_index].NativeLayoutToValue(
+            input_ptrs_[info.input_index]);
+  }
+  return reg_state;
+}
+
+void BlockJit::RunOneCycle() {
+  jitted_function_base_.function(input_ptrs_.data(), output_ptrs_.data(),
+                                 temp_buffer_.data(), &events_,
+                                 /*user_data=*/nullptr, runtime(),
+                                 /*continuation_point=*/0);
+  JitTraceBuffer::ForCurrentThread().Flush(*runtime(), &events_);
+
+  // Clock the registers. The next value of a register is its reset value if
+  // reset is asserted, its current value if the load enable is deasserted,
+  // and the data operand of its register write otherwise.
+  for (const RegisterInfo& info : registers_) {
+    uint8_t* reg_buffer = input_ptrs_[info.input_index];
+    if (info.reset_index.has_value() &&
+        IsBitSet(output_ptrs_[*info.reset_index]) != info.reset_active_low) {
+      std::memcpy(reg_buffer, info.reset_value.data(),
+                  info.reset_value.size());
+      continue;
+    }
+    if (info.load_enable_index.has_value() &&
+        !IsBitSet(output_ptrs_[*info.load_enable_index])) {
+      continue;
+    }
+    std::memcpy(reg_buffer, output_ptrs_[info.data_index],
+                input_buffers_[info.input_index].size());
+  }
+}
+
+std::vector<Value> BlockJit::GetOutputs() const {
+  std::vector<Value> outputs;
+  outputs.reserve(block_->GetOutputPorts().size());
+  for (int64_t i = 0; i < block_->GetOutputPorts().size(); ++i) {
+    outputs.push_back(output_layouts_[i].NativeLayoutToValue(output_ptrs_[i]));
+  }
+  return outputs;
+}
+
+absl::flat_hash_map<std::string, Value> BlockJit::GetOutputsMap() const {
+  absl::flat_hash_map<std::string, Value> outputs;
+  absl::Span<OutputPort* const> ports = block_->GetOutputPorts();
+  for (int64_t i = 0; i < ports.size(); ++i) {
+    outputs[ports[i]->GetName()] =
+        output_layouts_[i].NativeLayoutToValue(output_ptrs_[i]);
+  }
+  return outputs;
+}
+
+absl::StatusOr<BlockRunResult> BlockJit::Run(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    const absl::flat_hash_map<std::string, Value>& reg_state) {
+  XLS_RETURN_IF_ERROR(SetInputs(inputs));
+  XLS_RETURN_IF_ERROR(SetRegisters(reg_state));
+  RunOneCycle();
+  return BlockRunResult{.outputs = GetOutputsMap(),
+                        .reg_state = GetRegisters()};
+}
+
+absl::StatusOr<BlockIOResults> JitChannelizedSequentialBlock(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset, int64_t seed) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockJit> jit, BlockJit::Create(block));
+  // The register state stays in the native layout of the jit between cycles.
+  auto run_cycle =
+      [&jit](const absl::flat_hash_map<std::string, Value>& input_set)
+      -> absl::StatusOr<absl::flat_hash_map<std::string, Value>> {
+    XLS_RETURN_IF_ERROR(jit->SetInputs(input_set));
+    jit->RunOneCycle();
+    return jit->GetOutputsMap();
+  };
+  return RunChannelizedSequentialBlock(block, run_cycle, channel_sources,
+                                       channel_sinks, inputs, reset, seed);
+}
+
+}  // namespace xls
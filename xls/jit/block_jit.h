@@ -0,0 +1,165 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_BLOCK_JIT_H_
+#define XLS_JIT_BLOCK_JIT_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/block.h"
+#include "xls/ir/events.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_object_cache.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// This class provides a facility to simulate XLS blocks cycle by cycle (on the
+// host) by compiling the combinational logic of one clock cycle to native code.
+// Each cycle the jitted code computes the output port values and the operands
+// of the register writes from the input port values and the current register
+// values, after which the registers are clocked.
+//
+// The jit holds the input port and register values in the native data layout
+// so that cycles can be run without converting values, e.g.:
+//
+//   XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockJit> jit,
+//                        BlockJit::Create(block));
+//   XLS_RETURN_IF_ERROR(jit->SetRegisters(initial_state));
+//   for (...) {
+//     XLS_RETURN_IF_ERROR(jit->SetInputs(inputs));
+//     jit->RunOneCycle();
+//     ... jit->GetOutputs() ...
+//   }
+//
+// Register state is initially zero. Not thread-safe.
+class BlockJit {
+ public:
+  // Returns an object containing a host-compiled version of the specified XLS
+  // block. If `object_cache` is non-null, previously compiled object code for
+  // an identical block is reused from the cache.
+  static absl::StatusOr<std::unique_ptr<BlockJit>> Create(
+      Block* block, JitObjectCache* object_cache = nullptr);
+
+  // Sets the values of the input ports for the following cycles. `inputs` are
+  // in the order of Block::GetInputPorts.
+  absl::Status SetInputs(absl::Span<const Value> inputs);
+
+  // As above, but with the values given by port name. There must be a value
+  // for each input port.
+  absl::Status SetInputs(const absl::flat_hash_map<std::string, Value>& inputs);
+
+  // Sets the values of the registers by register name. There must be a value
+  // for each register.
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& reg_state);
+
+  // Returns the current values of the registers by register name.
+  absl::flat_hash_map<std::string, Value> GetRegisters() const;
+
+  // Evaluates the block for one cycle with the current input port values and
+  // register values, and then clocks the registers.
+  void RunOneCycle();
+
+  // Returns the values of the output ports computed by the last call to
+  // RunOneCycle, in the order of Block::GetOutputPorts.
+  std::vector<Value> GetOutputs() const;
+
+  // As above, but by port name.
+  absl::flat_hash_map<std::string, Value> GetOutputsMap() const;
+
+  // Runs a single cycle of the block with the given input port and register
+  // values, like BlockRun. The register values of the jit are left at the next
+  // register state.
+  absl::StatusOr<BlockRunResult> Run(
+      const absl::flat_hash_map<std::string, Value>& inputs,
+      const absl::flat_hash_map<std::string, Value>& reg_state);
+
+  // Returns the trace and assert events of all cycles run so far.
+  const InterpreterEvents& GetEvents() const { return events_; }
+  InterpreterEvents& GetEvents() { return events_; }
+
+  Block* block() const { return block_; }
+
+  JitRuntime* runtime() const { return jit_runtime_.get(); }
+
+ private:
+  // Describes how the next value of a register is selected from the outputs of
+  // the jitted function.
+  struct RegisterInfo {
+    Register* reg;
+
+    // Index of the register value in the inputs of the jitted function.
+    int64_t input_index;
+
+    // Indices of the register write operands in the outputs of the jitted
+    // function.
+    int64_t data_index;
+    std::optional<int64_t> load_enable_index;
+    std::optional<int64_t> reset_index;
+
+    // The reset value in the native layout, and whether reset is active low.
+    std::vector<uint8_t> reset_value;
+    bool reset_active_low = false;
+  };
+
+  explicit BlockJit(Block* block) : block_(block) {}
+
+  Block* block_;
+  std::unique_ptr<OrcJit> orc_jit_;
+  std::unique_ptr<JitRuntime> jit_runtime_;
+  JittedFunctionBase jitted_function_base_;
+
+  std::vector<RegisterInfo> registers_;
+
+  // The layouts of the inputs and outputs of the jitted function.
+  std::vector<TypeLayout> input_layouts_;
+  std::vector<TypeLayout> output_layouts_;
+
+  // Buffers to hold the inputs, outputs, and temporary storage. These are
+  // allocated once and re-used for each cycle.
+  std::vector<std::vector<uint8_t>> input_buffers_;
+  std::vector<std::vector<uint8_t>> output_buffers_;
+  std::vector<uint8_t*> input_ptrs_;
+  std::vector<uint8_t*> output_ptrs_;
+  std::vector<uint8_t> temp_buffer_;
+
+  InterpreterEvents events_;
+};
+
+// Simulates a block with channel sources and sinks as
+// InterpretChannelizedSequentialBlock does, but evaluates each cycle with a
+// BlockJit.
+absl::StatusOr<BlockIOResults> JitChannelizedSequentialBlock(
+    Block* block, absl::Span<ChannelSource> channel_sources,
+    absl::Span<ChannelSink> channel_sinks,
+    absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+    std::optional<verilog::ResetProto> reset = std::nullopt, int64_t seed = 0);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_BLOCK_JIT_H_
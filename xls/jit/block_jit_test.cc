@@ -0,0 +1,287 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/block_jit.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+
+namespace xls {
+namespace {
+
+using status_testing::StatusIs;
+using testing::ElementsAre;
+using testing::HasSubstr;
+using testing::Pair;
+using testing::UnorderedElementsAre;
+
+class BlockJitTest : public IrTestBase {
+ protected:
+  // Runs `inputs` through the block with the jit and the interpreter from the
+  // given register state and expects the same outputs and register state
+  // after each cycle.
+  void ExpectSameAsInterpreter(
+      Block* block,
+      absl::Span<const absl::flat_hash_map<std::string, Value>> inputs,
+      absl::flat_hash_map<std::string, Value> reg_state) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                             BlockJit::Create(block));
+    XLS_ASSERT_OK(jit->SetRegisters(reg_state));
+    for (const absl::flat_hash_map<std::string, Value>& input_set : inputs) {
+      XLS_ASSERT_OK_AND_ASSIGN(BlockRunResult expected,
+                               BlockRun(input_set, reg_state, block));
+      XLS_ASSERT_OK(jit->SetInputs(input_set));
+      jit->RunOneCycle();
+      EXPECT_EQ(jit->GetOutputsMap(), expected.outputs);
+      EXPECT_EQ(jit->GetRegisters(), expected.reg_state);
+      reg_state = std::move(expected.reg_state);
+    }
+  }
+};
+
+TEST_F(BlockJitTest, CombinationalBlock) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  b.OutputPort("sum", b.Add(x, y));
+  b.OutputPort("diff", b.Subtract(x, y));
+  b.OutputPort("x_out", x);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  XLS_ASSERT_OK(jit->SetInputs(
+      std::vector<Value>{Value(UBits(42, 32)), Value(UBits(10, 32))}));
+  jit->RunOneCycle();
+  EXPECT_THAT(jit->GetOutputs(),
+              ElementsAre(Value(UBits(52, 32)), Value(UBits(32, 32)),
+                          Value(UBits(42, 32))));
+}
+
+TEST_F(BlockJitTest, InputErrors) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg, b.block()->AddRegister("r", package->GetBitsType(8)));
+  BValue x = b.InputPort("x", package->GetBitsType(8));
+  b.RegisterWrite(reg, x);
+  b.OutputPort("out", b.RegisterRead(reg));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  EXPECT_THAT(jit->SetInputs(absl::flat_hash_map<std::string, Value>{
+                  {"y", Value(UBits(1, 8))}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Block has no input port 'y'")));
+  EXPECT_THAT(
+      jit->SetInputs(absl::flat_hash_map<std::string, Value>()),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("Missing input for port 'x'")));
+  EXPECT_THAT(jit->SetInputs(std::vector<Value>{Value(UBits(1, 32))}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("which is not of type bits[8]")));
+  EXPECT_THAT(jit->SetRegisters({{"q", Value(UBits(1, 8))}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Block has no register 'q'")));
+  EXPECT_THAT(jit->SetRegisters({}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Missing value for register 'r'")));
+}
+
+TEST_F(BlockJitTest, PipelinedAdder) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue y = b.InputPort("y", package->GetBitsType(32));
+  BValue x_d = b.InsertRegister("x_d", x);
+  BValue y_d = b.InsertRegister("y_d", y);
+  BValue x_plus_y_d = b.InsertRegister("x_plus_y_d", b.Add(x_d, y_d));
+  b.OutputPort("out", x_plus_y_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::vector<Value> outputs;
+  for (int64_t i = 0; i < 5; ++i) {
+    XLS_ASSERT_OK(jit->SetInputs(
+        std::vector<Value>{Value(UBits(i, 32)), Value(UBits(i, 32))}));
+    jit->RunOneCycle();
+    outputs.push_back(jit->GetOutputs().front());
+  }
+  // Registers are initially zero.
+  EXPECT_THAT(outputs, ElementsAre(Value(UBits(0, 32)), Value(UBits(0, 32)),
+                                   Value(UBits(0, 32)), Value(UBits(2, 32)),
+                                   Value(UBits(4, 32))));
+}
+
+TEST_F(BlockJitTest, RegisterWithResetAndLoadEnable) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue rst_n = b.InputPort("rst_n", package->GetBitsType(1));
+  BValue rst = b.InputPort("rst", package->GetBitsType(1));
+  BValue le = b.InputPort("le", package->GetBitsType(1));
+  BValue x_d =
+      b.InsertRegister("x_d", x, rst_n,
+                       Reset{Value(UBits(42, 32)), /*asynchronous=*/false,
+                             /*active_low=*/true},
+                       le);
+  BValue y_d = b.InsertRegister(
+      "y_d", b.Add(x, x_d), rst,
+      Reset{Value(UBits(7, 32)), /*asynchronous=*/false, /*active_low=*/false});
+  b.OutputPort("out0", x_d);
+  b.OutputPort("out1", y_d);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+  for (int64_t i = 0; i < 16; ++i) {
+    inputs.push_back({{"x", Value(UBits(i + 1, 32))},
+                      {"rst_n", Value(UBits((i % 5) != 1, 1))},
+                      {"rst", Value(UBits((i % 7) == 3, 1))},
+                      {"le", Value(UBits((i % 3) != 0, 1))}});
+  }
+  ExpectSameAsInterpreter(
+      block, inputs,
+      {{"x_d", Value(UBits(5, 32))}, {"y_d", Value(UBits(6, 32))}});
+}
+
+TEST_F(BlockJitTest, AggregateRegisters) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  Type* u16 = package->GetBitsType(16);
+  Type* tuple_type =
+      package->GetTupleType({u16, package->GetArrayType(2, u16)});
+  XLS_ASSERT_OK_AND_ASSIGN(Register * reg,
+                           b.block()->AddRegister("state", tuple_type));
+  BValue x = b.InputPort("x", u16);
+  BValue state = b.RegisterRead(reg);
+  BValue count = b.Add(b.TupleIndex(state, 0), x);
+  BValue history = b.TupleIndex(state, 1);
+  BValue next_history =
+      b.Array({b.ArrayIndex(history, {b.Literal(UBits(1, 1))}), count}, u16);
+  b.RegisterWrite(reg, b.Tuple({count, next_history}));
+  b.OutputPort("out", state);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs;
+  for (int64_t i = 0; i < 8; ++i) {
+    inputs.push_back({{"x", Value(UBits(3 * i + 1, 16))}});
+  }
+  ExpectSameAsInterpreter(block, inputs,
+                          {{"state", ZeroOfType(tuple_type)}});
+}
+
+TEST_F(BlockJitTest, RunMatchesBlockRun) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue next_accum = b.Add(x, b.RegisterRead(reg));
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("out", next_accum);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockRunResult result,
+      jit->Run({{"x", Value(UBits(3, 32))}}, {{"accum", Value(UBits(4, 32))}}));
+  EXPECT_THAT(result.outputs,
+              UnorderedElementsAre(Pair("out", Value(UBits(7, 32)))));
+  EXPECT_THAT(result.reg_state,
+              UnorderedElementsAre(Pair("accum", Value(UBits(7, 32)))));
+}
+
+TEST_F(BlockJitTest, ChannelizedAccumulatorRegister) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue x_vld = b.InputPort("x_vld", package->GetBitsType(1));
+  BValue out_rdy = b.InputPort("out_rdy", package->GetBitsType(1));
+
+  BValue input_valid_and_output_ready = b.And(x_vld, out_rdy);
+  BValue accum = b.RegisterRead(reg);
+  BValue x_add_accum = b.Add(x, accum);
+  BValue next_accum =
+      b.Select(input_valid_and_output_ready, {accum, x_add_accum});
+
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("x_rdy", out_rdy);
+  b.OutputPort("out", next_accum);
+  b.OutputPort("out_vld", x_vld);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs(100);
+  auto make_sources = [&]() {
+    std::vector<ChannelSource> sources{
+        ChannelSource("x", "x_vld", "x_rdy", 0.5, block)};
+    XLS_CHECK_OK(
+        sources.at(0).SetDataSequence(std::vector<uint64_t>{1, 2, 3, 4, 5}));
+    return sources;
+  };
+  auto make_sinks = [&]() {
+    return std::vector<ChannelSink>{
+        ChannelSink("out", "out_vld", "out_rdy", 0.1, block)};
+  };
+
+  std::vector<ChannelSource> jit_sources = make_sources();
+  std::vector<ChannelSink> jit_sinks = make_sinks();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockIOResults jit_io,
+      JitChannelizedSequentialBlock(block, absl::MakeSpan(jit_sources),
+                                    absl::MakeSpan(jit_sinks), inputs));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<uint64_t> output_sequence,
+                           jit_sinks.at(0).GetOutputSequenceAsUint64());
+  EXPECT_EQ(output_sequence, (std::vector<uint64_t>{1, 3, 6, 10, 15}));
+
+  // The same seed drives the same inputs so every cycle matches the
+  // interpreter.
+  std::vector<ChannelSource> sources = make_sources();
+  std::vector<ChannelSink> sinks = make_sinks();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockIOResults io,
+      InterpretChannelizedSequentialBlock(block, absl::MakeSpan(sources),
+                                          absl::MakeSpan(sinks), inputs));
+  EXPECT_EQ(jit_io.inputs, io.inputs);
+  EXPECT_EQ(jit_io.outputs, io.outputs);
+}
+
+}  // namespace
+}  // namespace xls
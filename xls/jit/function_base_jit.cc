@@ -13,7 +13,11 @@
 // limitations under the License.
 #include "xls/jit/function_base_jit.h"
 
+#include <optional>
+
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/Function.h"
@@ -284,6 +288,16 @@ class BufferAllocator {
     return temp_block_offsets_.at(node);
   }
 
+  // Assigns `node` allocation kind kTempBlock, reusing the temp buffer of
+  // `source`. The value of `source` must not be used after `node` is computed.
+  void ShareTempBuffer(Node* node, Node* source) {
+    XLS_CHECK(!allocation_kinds_.contains(node));
+    allocation_kinds_[node] = AllocationKind::kTempBlock;
+    temp_block_offsets_[node] = GetOffset(source);
+    XLS_VLOG(3) << absl::StreamFormat("Allocated %s in the buffer of %s",
+                                      node->GetName(), source->GetName());
+  }
+
   // Returns the total size of the allocated memory.
   int64_t size() const { return current_offset_; }
 
@@ -451,6 +465,12 @@ std::vector<Partition> PartitionFunctionBase(FunctionBase* f) {
   return partitions;
 }
 
+// Returns whether `node` is an output port or register write of a block. These
+// nodes have no value and are not evaluated by the jitted function.
+bool IsBlockSink(Node* node) {
+  return node->Is<OutputPort>() || node->Is<RegisterWrite>();
+}
+
 // Builds an LLVM function of the given `name` which executes the given set of
 // nodes. The signature of the partition function is the same as the jitted
 // function implementing a FunctionBase (i.e., `JitFunctionType`). A partition
@@ -507,6 +527,11 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
   // The pointers to the buffers of nodes in the partition.
   absl::flat_hash_map<Node*, llvm::Value*> value_buffers;
   for (Node* node : partition.nodes) {
+    if (IsBlockSink(node)) {
+      // Output ports and register writes produce no value. The values they
+      // consume are among the global output nodes of a block.
+      continue;
+    }
     if (wrapper.IsInputNode(node)) {
       // Node is an input node. There is no need to generate a node function for
       // this node (its value is an input and already computed). Simply copy the
@@ -514,11 +539,20 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       XLS_RET_CHECK(allocator.GetAllocationKind(node) == AllocationKind::kNone);
       if (wrapper.IsOutputNode(node)) {
         // `node` is also an output node. This can occur, for example, if a
-        // state param is the next state value for a proc.
+        // state param is the next state value for a proc. A proc state param
+        // which is the next state value of its own state element shares its
+        // input and output buffer (see BuildProcFunction) so nothing is
+        // copied for that output.
         llvm::Value* input_buffer = wrapper.GetInputBuffer(node, b);
-        for (llvm::Value* output_buffer : wrapper.GetOutputBuffers(node, b)) {
+        for (int64_t output_index : wrapper.GetOutputArgIndices(node)) {
+          if (node->function_base()->IsProc() &&
+              output_index == wrapper.GetInputArgIndex(node)) {
+            continue;
+          }
           LlvmMemcpy(
-              output_buffer, input_buffer,
+              LoadPointerFromPointerArray(output_index, wrapper.GetOutputsArg(),
+                                          &b),
+              input_buffer,
               jit_context.type_converter().GetTypeByteSize(node->GetType()), b);
         }
       }
@@ -536,9 +570,20 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
           wrapper.GetOffsetIntoTempBuffer(allocator.GetOffset(node), b)};
     } else if (allocator.GetAllocationKind(node) == AllocationKind::kAlloca) {
       // `node` is used exclusively inside this partition (not an input, output,
-      // nor has a temp buffer). Allocate a buffer on the stack with alloca.
-      output_buffers = {b.CreateAlloca(
-          jit_context.type_converter().ConvertToLlvmType(node->GetType()))};
+      // nor has a temp buffer). Allocate a buffer on the stack with alloca
+      // unless `node` is an array update which can be done in place.
+      std::optional<Node*> source = GetInPlaceUpdateSource(node, allocator);
+      if (source.has_value() && value_buffers.contains(*source)) {
+        output_buffers = {value_buffers.at(*source)};
+      } else if (source.has_value() &&
+                 allocator.GetAllocationKind(*source) ==
+                     AllocationKind::kTempBlock) {
+        output_buffers = {wrapper.GetOffsetIntoTempBuffer(
+            allocator.GetOffset(*source), b)};
+      } else {
+        output_buffers = {b.CreateAlloca(
+            jit_context.type_converter().ConvertToLlvmType(node->GetType()))};
+      }
     } else {
       // Node has no allocation and is not an output buffer. Nothing to emit for
       // this node.
@@ -596,7 +641,9 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
       args.push_back(wrapper.GetUserDataArg());
       args.push_back(wrapper.GetJitRuntimeArg());
     }
-    llvm::CallInst* node_blocked = b.CreateCall(node_function.function, args);
+    XLS_ASSIGN_OR_RETURN(
+        llvm::CallInst * node_blocked,
+        CallNodeFunction(node_function, args, b, jit_context));
 
     if (partition.early_exit_point.has_value()) {
       XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
@@ -613,6 +660,26 @@ absl::StatusOr<llvm::Function*> BuildPartitionFunction(
   return wrapper.function();
 }
 
+// Returns the array updated by `node` if `node` is an array update which may
+// write its result into the buffer of that array rather than copying it. This
+// is the case when the update is the only user of the array and the array has
+// a buffer of its own (i.e., it is not an input or output of the function).
+std::optional<Node*> GetInPlaceUpdateSource(Node* node,
+                                            const BufferAllocator& allocator) {
+  if (!node->Is<ArrayUpdate>()) {
+    return std::nullopt;
+  }
+  Node* array = node->As<ArrayUpdate>()->array_to_update();
+  if (array->users().size() != 1) {
+    return std::nullopt;
+  }
+  AllocationKind kind = allocator.GetAllocationKind(array);
+  if (kind != AllocationKind::kTempBlock && kind != AllocationKind::kAlloca) {
+    return std::nullopt;
+  }
+  return array;
+}
+
 // Determine the type of buffers required by each node. Allocates the temporary
 // buffers for nodes as needed.
 absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
@@ -622,8 +689,8 @@ absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
     absl::flat_hash_set<Node*> partition_set(partition.nodes.begin(),
                                              partition.nodes.end());
     for (Node* node : partition.nodes) {
-      if (wrapper.IsInputNode(node) || wrapper.IsOutputNode(node) ||
-          ShouldMaterializeAtUse(node)) {
+      if (IsBlockSink(node) || wrapper.IsInputNode(node) ||
+          wrapper.IsOutputNode(node) || ShouldMaterializeAtUse(node)) {
         allocator.SetAllocationKind(node, AllocationKind::kNone);
       } else if (std::all_of(
                      node->users().begin(), node->users().end(),
@@ -631,7 +698,14 @@ absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
         // All of the uses of node are in the partition.
         allocator.SetAllocationKind(node, AllocationKind::kAlloca);
       } else {
-        // Node has a use in another partition.
+        // Node has a use in another partition. Array updates of a temp buffer
+        // which has no other use are done in place.
+        std::optional<Node*> source = GetInPlaceUpdateSource(node, allocator);
+        if (source.has_value() && allocator.GetAllocationKind(*source) ==
+                                      AllocationKind::kTempBlock) {
+          allocator.ShareTempBuffer(node, *source);
+          continue;
+        }
         allocator.SetAllocationKind(node, AllocationKind::kTempBlock);
       }
     }
@@ -642,6 +716,17 @@ absl::Status AllocateBuffers(absl::Span<const Partition> partitions,
 // Returns the nodes which comprise the inputs to a jitted function implementing
 // `function_base`. These nodes are passed in via the `inputs` argument.
 std::vector<Node*> GetJittedFunctionInputs(FunctionBase* function_base) {
+  if (function_base->IsBlock()) {
+    // The inputs of a block are its input ports and the values read from its
+    // registers.
+    Block* block = function_base->AsBlockOrDie();
+    std::vector<Node*> inputs(block->GetInputPorts().begin(),
+                              block->GetInputPorts().end());
+    for (Register* reg : block->GetRegisters()) {
+      inputs.push_back(block->GetRegisterRead(reg).value());
+    }
+    return inputs;
+  }
   std::vector<Node*> inputs(function_base->params().begin(),
                             function_base->params().end());
   return inputs;
@@ -655,6 +740,27 @@ std::vector<Node*> GetJittedFunctionOutputs(FunctionBase* function_base) {
     Function* f = function_base->AsFunctionOrDie();
     return {f->return_value()};
   }
+  if (function_base->IsBlock()) {
+    // The outputs of a block are the values driving its output ports and the
+    // operands of its register writes. The next register values are selected
+    // from the latter by the caller.
+    Block* block = function_base->AsBlockOrDie();
+    std::vector<Node*> outputs;
+    for (OutputPort* port : block->GetOutputPorts()) {
+      outputs.push_back(port->operand(0));
+    }
+    for (Register* reg : block->GetRegisters()) {
+      RegisterWrite* reg_write = block->GetRegisterWrite(reg).value();
+      outputs.push_back(reg_write->data());
+      if (reg_write->load_enable().has_value()) {
+        outputs.push_back(reg_write->load_enable().value());
+      }
+      if (reg_write->reset().has_value()) {
+        outputs.push_back(reg_write->reset().value());
+      }
+    }
+    return outputs;
+  }
   XLS_CHECK(function_base->IsProc());
   // The outputs of a proc are the next state values.
   Proc* proc = function_base->AsProcOrDie();
@@ -1135,79 +1241,231 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
-// Jits a function implementing `xls_function`. Also jits all transitively
-// dependent xls::Functions which may be called by `xls_function`.
-absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
-    FunctionBase* xls_function, JitBuilderContext& jit_context,
-    bool build_packed_wrapper) {
-  std::vector<FunctionBase*> functions = GetDependentFunctions(xls_function);
+// Builds a wrapper around the jitted function `callee` which evaluates
+// `callee` on a batch of inputs. Each input (output) pointer passed to the
+// wrapper points to a buffer holding `count` consecutive values of the
+// respective input (output) in the native LLVM data layout, i.e. the buffers
+// are in struct-of-arrays form. The number of elements in the batch is passed
+// in as the final argument of the wrapper. Returns zero.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    JitBuilderContext& jit_context) {
+  llvm::LLVMContext* context = &jit_context.context();
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* i8 = llvm::Type::getInt8Ty(*context);
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_batched", xls_function->name()), inputs, outputs,
+      i64, jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "count", .type = i64});
+  llvm::IRBuilder<>& entry_builder = wrapper.entry_builder();
+  llvm::Function* fn = wrapper.function();
+
+  // Arrays of pointers to the elements of the batch currently being evaluated.
+  llvm::Value* input_arg_array = entry_builder.CreateAlloca(
+      llvm::ArrayType::get(llvm::PointerType::get(*context, 0), inputs.size()));
+  llvm::Value* output_arg_array =
+      entry_builder.CreateAlloca(llvm::ArrayType::get(
+          llvm::PointerType::get(*context, 0), outputs.size()));
+
+  // Hoist the loads of the base pointers of the batch buffers out of the loop.
+  std::vector<llvm::Value*> input_bases;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_bases.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetInputsArg(), &entry_builder));
+  }
+  std::vector<llvm::Value*> output_bases;
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_bases.push_back(LoadPointerFromPointerArray(
+        i, wrapper.GetOutputsArg(), &entry_builder));
+  }
+
+  llvm::BasicBlock* entry_block = entry_builder.GetInsertBlock();
+  llvm::BasicBlock* header_block =
+      llvm::BasicBlock::Create(*context, "batch_header", fn);
+  llvm::BasicBlock* body_block =
+      llvm::BasicBlock::Create(*context, "batch_body", fn);
+  llvm::BasicBlock* exit_block =
+      llvm::BasicBlock::Create(*context, "batch_exit", fn);
+  entry_builder.CreateBr(header_block);
+
+  llvm::IRBuilder<> header_builder(header_block);
+  llvm::PHINode* index = header_builder.CreatePHI(i64, 2, "index");
+  index->addIncoming(llvm::ConstantInt::get(i64, 0), entry_block);
+  header_builder.CreateCondBr(
+      header_builder.CreateICmpSLT(index, wrapper.GetExtraArg().value()),
+      body_block, exit_block);
+
+  llvm::IRBuilder<> body_builder(body_block);
+  llvm::Type* pointer_array_type =
+      llvm::ArrayType::get(llvm::Type::getInt8PtrTy(*context), 0);
+  auto store_element_pointer = [&](llvm::Value* array, int64_t i,
+                                   llvm::Value* base, Node* node) {
+    int64_t stride =
+        jit_context.type_converter().GetTypeByteSize(node->GetType());
+    llvm::Value* element = body_builder.CreateGEP(
+        i8, base,
+        body_builder.CreateMul(index, llvm::ConstantInt::get(i64, stride)));
+    llvm::Value* gep = body_builder.CreateGEP(
+        pointer_array_type, array,
+        {
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0),
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i),
+        });
+    body_builder.CreateStore(element, gep);
+  };
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    store_element_pointer(input_arg_array, i, input_bases[i], inputs[i]);
+  }
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    store_element_pointer(output_arg_array, i, output_bases[i], outputs[i]);
+  }
+
+  std::vector<llvm::Value*> args;
+  args.push_back(input_arg_array);
+  args.push_back(output_arg_array);
+  args.push_back(wrapper.GetTempBufferArg());
+  args.push_back(wrapper.GetInterpreterEventsArg());
+  args.push_back(wrapper.GetUserDataArg());
+  args.push_back(wrapper.GetJitRuntimeArg());
+  args.push_back(/*continuation_point=*/llvm::ConstantInt::get(i64, 0));
+  body_builder.CreateCall(callee, args);
+
+  llvm::Value* next_index =
+      body_builder.CreateAdd(index, llvm::ConstantInt::get(i64, 1));
+  index->addIncoming(next_index, body_block);
+  body_builder.CreateBr(header_block);
+
+  llvm::IRBuilder<> exit_builder(exit_block);
+  exit_builder.CreateRet(llvm::ConstantInt::get(i64, 0));
+
+  return fn;
+}
+
+// Jits functions implementing each of `xls_functions` in a single module. Also
+// jits all transitively dependent xls::Functions which may be called by
+// `xls_functions`; dependencies shared by more than one of `xls_functions` are
+// jitted once. The returned JittedFunctionBases are in the same order as
+// `xls_functions`. All of the functions share a single temporary buffer
+// allocation so `temp_buffer_size` is the same for each.
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildFunctionsAndDependencies(
+    absl::Span<FunctionBase* const> xls_functions,
+    JitBuilderContext& jit_context, bool build_packed_wrapper) {
+  absl::flat_hash_set<FunctionBase*> tops(xls_functions.begin(),
+                                          xls_functions.end());
+  XLS_RET_CHECK_EQ(tops.size(), xls_functions.size())
+      << "Functions to jit must be unique";
   BufferAllocator allocator(&jit_context.type_converter());
-  llvm::Function* top_function = nullptr;
-  std::vector<Partition> top_partitions;
-  for (FunctionBase* f : functions) {
-    XLS_ASSIGN_OR_RETURN(
-        PartitionedFunction partitioned_function,
-        BuildFunctionInternal(f, allocator, jit_context,
-                              /*unpoison_outputs=*/f == xls_function));
-    jit_context.SetLlvmFunction(f, partitioned_function.function);
-    if (f == xls_function) {
-      top_function = partitioned_function.function;
-      top_partitions = std::move(partitioned_function.partitions);
+  absl::flat_hash_map<FunctionBase*, llvm::Function*> top_functions;
+  absl::flat_hash_map<FunctionBase*, std::vector<Partition>> top_partitions;
+  for (FunctionBase* xls_function : xls_functions) {
+    for (FunctionBase* f : GetDependentFunctions(xls_function)) {
+      if (jit_context.HasLlvmFunction(f)) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          PartitionedFunction partitioned_function,
+          BuildFunctionInternal(f, allocator, jit_context,
+                                /*unpoison_outputs=*/tops.contains(f)));
+      jit_context.SetLlvmFunction(f, partitioned_function.function);
+      if (tops.contains(f)) {
+        top_functions[f] = partitioned_function.function;
+        top_partitions[f] = std::move(partitioned_function.partitions);
+      }
     }
   }
-  XLS_RET_CHECK(top_function != nullptr);
 
-  std::string function_name = top_function->getName().str();
-  std::string packed_wrapper_name;
+  struct WrapperNames {
+    std::string packed;
+    std::string batched;
+  };
+  std::vector<WrapperNames> wrapper_names;
   if (build_packed_wrapper) {
-    XLS_ASSIGN_OR_RETURN(
-        llvm::Function * packed_wrapper_function,
-        BuildPackedWrapper(xls_function, top_function, jit_context));
-    packed_wrapper_name = packed_wrapper_function->getName().str();
+    for (FunctionBase* xls_function : xls_functions) {
+      llvm::Function* top_function = top_functions.at(xls_function);
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Function * packed_wrapper_function,
+          BuildPackedWrapper(xls_function, top_function, jit_context));
+      XLS_ASSIGN_OR_RETURN(
+          llvm::Function * batched_wrapper_function,
+          BuildBatchedWrapper(xls_function, top_function, jit_context));
+      wrapper_names.push_back(WrapperNames{
+          .packed = packed_wrapper_function->getName().str(),
+          .batched = batched_wrapper_function->getName().str()});
+    }
   }
 
   XLS_RETURN_IF_ERROR(
       jit_context.orc_jit().CompileModule(jit_context.ConsumeModule()));
 
-  JittedFunctionBase jitted_function;
-
-  jitted_function.function_name = function_name;
-  XLS_ASSIGN_OR_RETURN(auto fn_address,
-                       jit_context.orc_jit().LoadSymbol(function_name));
-  jitted_function.function = absl::bit_cast<JitFunctionType>(fn_address);
+  std::vector<JittedFunctionBase> jitted_functions;
+  for (int64_t i = 0; i < xls_functions.size(); ++i) {
+    FunctionBase* xls_function = xls_functions[i];
+    JittedFunctionBase jitted_function;
 
-  if (build_packed_wrapper) {
-    jitted_function.packed_function_name = packed_wrapper_name;
-    XLS_ASSIGN_OR_RETURN(auto packed_fn_address,
-                         jit_context.orc_jit().LoadSymbol(packed_wrapper_name));
-    jitted_function.packed_function =
-        absl::bit_cast<JitFunctionType>(packed_fn_address);
-  }
+    jitted_function.function_name =
+        top_functions.at(xls_function)->getName().str();
+    XLS_ASSIGN_OR_RETURN(
+        auto fn_address,
+        jit_context.orc_jit().LoadSymbol(jitted_function.function_name));
+    jitted_function.function = absl::bit_cast<JitFunctionType>(fn_address);
+
+    if (build_packed_wrapper) {
+      jitted_function.packed_function_name = wrapper_names[i].packed;
+      XLS_ASSIGN_OR_RETURN(
+          auto packed_fn_address,
+          jit_context.orc_jit().LoadSymbol(wrapper_names[i].packed));
+      jitted_function.packed_function =
+          absl::bit_cast<JitFunctionType>(packed_fn_address);
+
+      jitted_function.batched_function_name = wrapper_names[i].batched;
+      XLS_ASSIGN_OR_RETURN(
+          auto batched_fn_address,
+          jit_context.orc_jit().LoadSymbol(wrapper_names[i].batched));
+      jitted_function.batched_function =
+          absl::bit_cast<JitFunctionType>(batched_fn_address);
+    }
 
-  for (const Node* input : GetJittedFunctionInputs(xls_function)) {
-    jitted_function.input_buffer_sizes.push_back(
-        jit_context.type_converter().GetTypeByteSize(input->GetType()));
-    jitted_function.packed_input_buffer_sizes.push_back(
-        jit_context.type_converter().GetPackedTypeByteSize(input->GetType()));
-  }
-  for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
-    jitted_function.output_buffer_sizes.push_back(
-        jit_context.type_converter().GetTypeByteSize(output->GetType()));
-    jitted_function.packed_output_buffer_sizes.push_back(
-        jit_context.type_converter().GetPackedTypeByteSize(output->GetType()));
-  }
-  jitted_function.temp_buffer_size = allocator.size();
+    for (const Node* input : GetJittedFunctionInputs(xls_function)) {
+      jitted_function.input_buffer_sizes.push_back(
+          jit_context.type_converter().GetTypeByteSize(input->GetType()));
+      jitted_function.packed_input_buffer_sizes.push_back(
+          jit_context.type_converter().GetPackedTypeByteSize(
+              input->GetType()));
+    }
+    for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
+      jitted_function.output_buffer_sizes.push_back(
+          jit_context.type_converter().GetTypeByteSize(output->GetType()));
+      jitted_function.packed_output_buffer_sizes.push_back(
+          jit_context.type_converter().GetPackedTypeByteSize(
+              output->GetType()));
+    }
+    jitted_function.temp_buffer_size = allocator.size();
 
-  // Indicate which nodes correspond to which early exit points.
-  for (const Partition& partition : top_partitions) {
-    if (partition.early_exit_point.has_value()) {
-      XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
-      jitted_function.continuation_points[partition.early_exit_point->id] =
-          partition.nodes.front();
+    // Indicate which nodes correspond to which early exit points.
+    for (const Partition& partition : top_partitions.at(xls_function)) {
+      if (partition.early_exit_point.has_value()) {
+        XLS_RET_CHECK_EQ(partition.nodes.size(), 1);
+        jitted_function.continuation_points[partition.early_exit_point->id] =
+            partition.nodes.front();
+      }
     }
+    jitted_functions.push_back(std::move(jitted_function));
   }
 
-  return std::move(jitted_function);
+  return std::move(jitted_functions);
+}
+
+// Jits a function implementing `xls_function`. Also jits all transitively
+// dependent xls::Functions which may be called by `xls_function`.
+absl::StatusOr<JittedFunctionBase> BuildFunctionAndDependencies(
+    FunctionBase* xls_function, JitBuilderContext& jit_context,
+    bool build_packed_wrapper) {
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_functions,
+                       BuildFunctionsAndDependencies(
+                           {xls_function}, jit_context, build_packed_wrapper));
+  return std::move(jitted_functions.front());
 }
 
 }  // namespace
@@ -1219,11 +1477,28 @@ absl::StatusOr<JittedFunctionBase> BuildFunction(Function* xls_function,
                                       /*build_packed_wrapper=*/true);
 }
 
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildFunctions(
+    absl::Span<Function* const> xls_functions, OrcJit& orc_jit) {
+  JitBuilderContext jit_context(orc_jit);
+  std::vector<FunctionBase*> function_bases(xls_functions.begin(),
+                                            xls_functions.end());
+  return BuildFunctionsAndDependencies(function_bases, jit_context,
+                                       /*build_packed_wrapper=*/true);
+}
+
 absl::StatusOr<JittedFunctionBase> BuildProcFunction(
-    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit) {
-  JitBuilderContext jit_context(orc_jit, queue_mgr);
+    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit,
+    JitNodeProfile* profile) {
+  JitBuilderContext jit_context(orc_jit, queue_mgr, profile);
   return BuildFunctionAndDependencies(proc, jit_context,
                                       /*build_packed_wrapper=*/false);
 }
 
+absl::StatusOr<JittedFunctionBase> BuildBlockFunction(Block* block,
+                                                      OrcJit& orc_jit) {
+  JitBuilderContext jit_context(orc_jit);
+  return BuildFunctionAndDependencies(block, jit_context,
+                                      /*build_packed_wrapper=*/false);
+}
+
 }  // namespace xls
@@ -17,10 +17,13 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/ir/block.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/proc.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_profile.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
@@ -69,6 +72,14 @@ struct JittedFunctionBase {
   std::optional<std::string> packed_function_name;
   std::optional<JitFunctionType> packed_function;
 
+  // Name and function pointer for the jitted function which evaluates the
+  // function on a batch of arguments. Inputs and outputs are buffers holding
+  // consecutive values in LLVM native format (struct-of-arrays) and the final
+  // argument is the number of elements in the batch rather than a continuation
+  // point. Only exists for JITted xls::Functions, not procs.
+  std::optional<std::string> batched_function_name;
+  std::optional<JitFunctionType> batched_function;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes;
   std::vector<int64_t> output_buffer_sizes;
@@ -90,10 +101,34 @@ struct JittedFunctionBase {
 absl::StatusOr<JittedFunctionBase> BuildFunction(Function* xls_function,
                                                  OrcJit& orc_jit);
 
+// Builds LLVM IR functions implementing each of the given XLS functions and
+// compiles them as a single module. Functions invoked by more than one of
+// `xls_functions` are built once. The returned objects are in the same order as
+// `xls_functions` and share a single temporary buffer size.
+absl::StatusOr<std::vector<JittedFunctionBase>> BuildFunctions(
+    absl::Span<Function* const> xls_functions, OrcJit& orc_jit);
+
 // Builds and returns an LLVM IR function implementing the given XLS
-// proc.
+// proc. If `profile` is non-null the generated code records per-node execution
+// counts and cycles in it. The inputs of the function are the proc params and
+// the outputs are the next token followed by the next state values, so state
+// element i is input i + 1 and output i + 1. A state element whose next state
+// value is its own param is not copied: the caller must pass the same buffer as
+// its input and its output.
 absl::StatusOr<JittedFunctionBase> BuildProcFunction(
-    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit);
+    Proc* proc, JitChannelQueueManager* queue_mgr, OrcJit& orc_jit,
+    JitNodeProfile* profile = nullptr);
+
+// Builds and returns an LLVM IR function evaluating one clock cycle of the
+// given XLS block. The inputs of the function are the input ports in the order
+// of Block::GetInputPorts followed by the current values of the registers in
+// the order of Block::GetRegisters. The outputs are the values driving the
+// output ports in the order of Block::GetOutputPorts followed by, for each
+// register in order, the data, load enable (if any) and reset (if any)
+// operands of its register write. Register writes themselves are not
+// evaluated; the caller computes the next register values from these outputs.
+absl::StatusOr<JittedFunctionBase> BuildBlockFunction(Block* block,
+                                                      OrcJit& orc_jit);
 
 }  // namespace xls
 
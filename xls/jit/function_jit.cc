@@ -14,12 +14,19 @@
 
 #include "xls/jit/function_jit.h"
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/keyword_args.h"
@@ -27,12 +34,38 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/llvm_type_converter.h"
 
 namespace xls {
+namespace {
+
+// The scratch buffers used to invoke jitted functions.
+enum class ScratchBuffer { kArgs, kResult, kTemp, kCount };
+
+// Returns a buffer of at least `size` bytes. The buffers are allocated once per
+// thread and shared by all FunctionJits called on that thread, which makes
+// concurrent calls to a FunctionJit safe without allocating on each call.
+uint8_t* GetThreadLocalBuffer(ScratchBuffer kind, int64_t size) {
+  static thread_local std::array<std::vector<uint8_t>,
+                                 static_cast<int>(ScratchBuffer::kCount)>
+      buffers;
+  std::vector<uint8_t>& buffer = buffers[static_cast<int>(kind)];
+  if (buffer.size() < size) {
+    buffer.resize(size);
+  }
+  return buffer.data();
+}
+
+// Alignment of each argument within the argument buffer, enough for any
+// native type.
+constexpr int64_t kArgBufferAlignment = 16;
+
+}  // namespace
 
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::Create(
-    Function* xls_function, int64_t opt_level) {
-  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false);
+    Function* xls_function, int64_t opt_level, JitObjectCache* object_cache) {
+  return CreateInternal(xls_function, opt_level, /*emit_object_code=*/false,
+                        object_cache);
 }
 
 absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
@@ -49,24 +82,59 @@ absl::StatusOr<JitObjectCode> FunctionJit::CreateObjectCode(
   };
 }
 
+absl::StatusOr<JitLibraryObjectCode> FunctionJit::CreateLibraryObjectCode(
+    absl::Span<Function* const> xls_functions, int64_t opt_level) {
+  XLS_RET_CHECK(!xls_functions.empty());
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(opt_level, /*emit_object_code=*/true));
+  XLS_ASSIGN_OR_RETURN(std::vector<JittedFunctionBase> jitted_functions,
+                       BuildFunctions(xls_functions, *orc_jit));
+  JitLibraryObjectCode library{
+      .object_code = orc_jit->GetObjectCode(),
+      .temp_buffer_size = jitted_functions.front().temp_buffer_size};
+  for (int64_t i = 0; i < xls_functions.size(); ++i) {
+    JittedFunctionBase& jitted_function = jitted_functions[i];
+    library.entry_points.push_back(JitLibraryObjectCode::EntryPoint{
+        .function = xls_functions[i],
+        .function_name = jitted_function.function_name,
+        .parameter_buffer_sizes = jitted_function.input_buffer_sizes,
+        .return_buffer_size = jitted_function.output_buffer_sizes[0],
+        .packed_function_name = jitted_function.packed_function_name.value(),
+        .packed_parameter_buffer_sizes =
+            jitted_function.packed_input_buffer_sizes,
+        .packed_return_buffer_size =
+            jitted_function.packed_output_buffer_sizes[0]});
+  }
+  return library;
+}
+
 absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
-    Function* xls_function, int64_t opt_level, bool emit_object_code) {
+    Function* xls_function, int64_t opt_level, bool emit_object_code,
+    JitObjectCache* object_cache) {
   auto jit = absl::WrapUnique(new FunctionJit(xls_function));
-  XLS_ASSIGN_OR_RETURN(jit->orc_jit_,
-                       OrcJit::Create(opt_level, emit_object_code));
+  XLS_ASSIGN_OR_RETURN(
+      jit->orc_jit_,
+      OrcJit::Create(opt_level, emit_object_code, object_cache));
   XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
                        OrcJit::CreateDataLayout());
   jit->jit_runtime_ = std::make_unique<JitRuntime>(data_layout);
   XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
                        BuildFunction(xls_function, *jit->orc_jit_));
 
-  // Pre-allocate argument, result, and temporary buffers.
+  // Lay the arguments out one after the other in the argument buffer.
   for (int64_t i = 0; i < xls_function->params().size(); ++i) {
-    jit->arg_buffers_.push_back(std::vector<uint8_t>(jit->GetArgTypeSize(i)));
-    jit->arg_buffer_ptrs_.push_back(jit->arg_buffers_.back().data());
+    jit->arg_buffer_offsets_.push_back(jit->arg_buffers_size_);
+    jit->arg_buffers_size_ +=
+        RoundUpToNearest(jit->GetArgTypeSize(i), kArgBufferAlignment);
+  }
+
+  LlvmTypeConverter type_converter(jit->orc_jit_->GetContext(), data_layout);
+  for (Param* param : xls_function->params()) {
+    jit->arg_layouts_.push_back(
+        type_converter.CreateTypeLayout(param->GetType()));
   }
-  jit->result_buffer_.resize(jit->GetReturnTypeSize());
-  jit->temp_buffer_.resize(jit->GetTempBufferSize());
+  jit->result_layout_ = type_converter.CreateTypeLayout(
+      xls_function->return_value()->GetType());
 
   return jit;
 }
@@ -88,19 +156,20 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     }
   }
 
-  std::vector<Type*> param_types;
-  for (const Param* param : xls_function_->params()) {
-    param_types.push_back(param->GetType());
+  // Copy the arg Values into this thread's argument buffer.
+  uint8_t* arg_buffer =
+      GetThreadLocalBuffer(ScratchBuffer::kArgs, arg_buffers_size_);
+  absl::InlinedVector<uint8_t*, 8> arg_buffer_ptrs;
+  for (int64_t i = 0; i < args.size(); ++i) {
+    arg_buffer_ptrs.push_back(arg_buffer + arg_buffer_offsets_[i]);
+    arg_layouts_[i].ValueToNativeLayout(args[i], arg_buffer_ptrs.back());
   }
 
-  // Allocate argument buffers and copy in arg Values.
-  XLS_RETURN_IF_ERROR(jit_runtime_->PackArgs(args, param_types,
-                                             absl::MakeSpan(arg_buffer_ptrs_)));
-
+  uint8_t* result_buffer =
+      GetThreadLocalBuffer(ScratchBuffer::kResult, GetReturnTypeSize());
   InterpreterEvents events;
-  InvokeJitFunction(arg_buffer_ptrs_, result_buffer_.data(), &events);
-  Value result = jit_runtime_->UnpackBuffer(
-      result_buffer_.data(), xls_function_->return_value()->GetType());
+  InvokeJitFunction(arg_buffer_ptrs, result_buffer, &events);
+  Value result = result_layout_->NativeLayoutToValue(result_buffer);
 
   return InterpreterResult<Value>{std::move(result), std::move(events)};
 }
@@ -132,13 +201,91 @@ absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
   return absl::OkStatus();
 }
 
+absl::Status FunctionJit::RunBatched(absl::Span<const uint8_t* const> args,
+                                     absl::Span<uint8_t> result_buffer,
+                                     int64_t count, InterpreterEvents* events) {
+  XLS_RET_CHECK(jitted_function_base_.batched_function.has_value());
+  absl::Span<Param* const> params = xls_function_->params();
+  if (args.size() != params.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), xls_function_->params().size()));
+  }
+  if (count < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Batch size must be non-negative, got %d.", count));
+  }
+  if (result_buffer.size() < count * GetReturnTypeSize()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Result buffer too small - must be at least %d bytes!",
+        count * GetReturnTypeSize()));
+  }
+
+  uint8_t* output_buffers[1] = {result_buffer.data()};
+  jitted_function_base_.batched_function.value()(
+      args.data(), output_buffers, GetTempBuffer(), events,
+      /*user_data=*/nullptr, runtime(), /*count=*/count);
+  JitTraceBuffer::ForCurrentThread().Flush(*runtime(), events);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Value>> FunctionJit::RunBatched(
+    absl::Span<const std::vector<Value>> args) {
+  absl::Span<Param* const> params = xls_function_->params();
+  const int64_t count = args.size();
+
+  // Lay the arguments out in struct-of-arrays form.
+  std::vector<std::vector<uint8_t>> batch_buffers(params.size());
+  std::vector<const uint8_t*> batch_buffer_ptrs(params.size());
+  for (int64_t i = 0; i < params.size(); ++i) {
+    batch_buffers[i].resize(count * GetArgTypeSize(i));
+    batch_buffer_ptrs[i] = batch_buffers[i].data();
+  }
+  for (int64_t j = 0; j < count; ++j) {
+    if (args[j].size() != params.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arg list %d to '%s' has the wrong size: %d vs expected %d.", j,
+          xls_function_->name(), args[j].size(), params.size()));
+    }
+    for (int64_t i = 0; i < params.size(); ++i) {
+      if (!ValueConformsToType(args[j][i], params[i]->GetType())) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Got argument %s for parameter %d which is not of type %s",
+            args[j][i].ToString(), i, params[i]->GetType()->ToString()));
+      }
+      arg_layouts_[i].ValueToNativeLayout(
+          args[j][i], batch_buffers[i].data() + j * GetArgTypeSize(i));
+    }
+  }
+
+  std::vector<uint8_t> result_buffer(count * GetReturnTypeSize());
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(RunBatched(batch_buffer_ptrs,
+                                 absl::MakeSpan(result_buffer), count,
+                                 &events));
+  XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(events));
+
+  std::vector<Value> results;
+  results.reserve(count);
+  for (int64_t j = 0; j < count; ++j) {
+    results.push_back(result_layout_->NativeLayoutToValue(
+        result_buffer.data() + j * GetReturnTypeSize()));
+  }
+  return results;
+}
+
 void FunctionJit::InvokeJitFunction(absl::Span<uint8_t* const> arg_buffers,
                                     uint8_t* output_buffer,
                                     InterpreterEvents* events) {
   uint8_t* output_buffers[1] = {output_buffer};
   jitted_function_base_.function(
-      arg_buffers.data(), output_buffers, temp_buffer_.data(), events,
+      arg_buffers.data(), output_buffers, GetTempBuffer(), events,
       /*user_data=*/nullptr, runtime(), /*continuation_point=*/0);
+  JitTraceBuffer::ForCurrentThread().Flush(*runtime(), events);
+}
+
+uint8_t* FunctionJit::GetTempBuffer() const {
+  return GetThreadLocalBuffer(ScratchBuffer::kTemp, GetTempBufferSize());
 }
 
 }  // namespace xls
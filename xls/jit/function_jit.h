@@ -22,8 +22,11 @@
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
 #include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/jit_trace_buffer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -42,21 +45,62 @@ struct JitObjectCode {
   int64_t temp_buffer_size;
 };
 
+// Data structure containing the object code of several jitted functions
+// compiled together along with metadata about how to call each of them.
+struct JitLibraryObjectCode {
+  struct EntryPoint {
+    // The XLS function and the name of the jitted function implementing it in
+    // the object code.
+    Function* function;
+    std::string function_name;
+
+    // Size of the buffers for the parameters and result.
+    std::vector<int64_t> parameter_buffer_sizes;
+    int64_t return_buffer_size;
+
+    // The name of the wrapper of the jitted function taking its parameters and
+    // result in the packed layout, and the size of their buffers.
+    std::string packed_function_name;
+    std::vector<int64_t> packed_parameter_buffer_sizes;
+    int64_t packed_return_buffer_size;
+  };
+
+  std::vector<uint8_t> object_code;
+  std::vector<EntryPoint> entry_points;
+
+  // Minimum size of the temporary buffer passed to any of the jitted
+  // functions. A single buffer of this size may be shared by all entry points
+  // (though not concurrently).
+  int64_t temp_buffer_size;
+};
+
 // This class provides a facility to execute XLS functions (on the host) by
-// converting it to LLVM IR, compiling it, and finally executing it. Not
-// thread-safe due to sharing of result and temporary buffers between
-// invocations of Run.
+// converting it to LLVM IR, compiling it, and finally executing it.
+//
+// The Run methods are thread-safe: the compiled function is shared, while the
+// argument, result and temporary buffers are thread-local (and shared by all
+// FunctionJits called on the thread), so one FunctionJit may serve several
+// threads without locking or recompiling.
 class FunctionJit {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // function.
+  // function. If `object_cache` is non-null, previously compiled object code
+  // for an identical function is reused from the cache.
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
-      Function* xls_function, int64_t opt_level = 3);
+      Function* xls_function, int64_t opt_level = 3,
+      JitObjectCache* object_cache = nullptr);
 
   // Returns the bytes of an object file containing the compiled XLS function.
   static absl::StatusOr<JitObjectCode> CreateObjectCode(Function* xls_function,
                                                         int64_t opt_level = 3);
 
+  // Returns the bytes of a single object file containing all of the given XLS
+  // functions. Functions invoked by more than one of `xls_functions` are
+  // included once. The entry points of the result are in the same order as
+  // `xls_functions`.
+  static absl::StatusOr<JitLibraryObjectCode> CreateLibraryObjectCode(
+      absl::Span<Function* const> xls_functions, int64_t opt_level = 3);
+
   // Executes the compiled function with the specified arguments.
   absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
 
@@ -80,6 +124,24 @@ class FunctionJit {
                             absl::Span<uint8_t> result_buffer,
                             InterpreterEvents* events);
 
+  // Executes the compiled function on a batch of `count` argument sets. The
+  // arguments and results are in struct-of-arrays form: `args[i]` points to a
+  // buffer holding `count` consecutive values of the i-th parameter in the
+  // native LLVM data layout (each GetArgTypeSize(i) bytes) and `result_buffer`
+  // must hold at least `count * GetReturnTypeSize()` bytes. The loop over the
+  // batch is compiled into the jitted code so the per-call overhead is paid
+  // once per batch rather than once per element. Events from all elements of
+  // the batch are accumulated in `events`.
+  absl::Status RunBatched(absl::Span<const uint8_t* const> args,
+                          absl::Span<uint8_t> result_buffer, int64_t count,
+                          InterpreterEvents* events);
+
+  // As above, but with the arguments given as Values. `args[j]` holds the
+  // arguments for the j-th element of the batch. Returns an error if any
+  // element of the batch fails an assertion.
+  absl::StatusOr<std::vector<Value>> RunBatched(
+      absl::Span<const std::vector<Value>> args);
+
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
   // between them. The function return value is specified as the last arg - its
@@ -110,8 +172,9 @@ class FunctionJit {
     InterpreterEvents events;
     uint8_t* output_buffers[1] = {result_buffer};
     jitted_function_base_.packed_function.value()(
-        arg_buffers, output_buffers, temp_buffer_.data(), &events,
+        arg_buffers, output_buffers, GetTempBuffer(), &events,
         /*user_data=*/nullptr, runtime(), /*continuation_point=*/0);
+    JitTraceBuffer::ForCurrentThread().Flush(*runtime(), &events);
 
     return InterpreterEventsToStatus(events);
   }
@@ -128,13 +191,20 @@ class FunctionJit {
     return jitted_function_base_.output_buffer_sizes[0];
   }
 
+  // Gets the native LLVM data layout of the compiled function's arguments (or
+  // return value), e.g., to write arguments directly into the native layout.
+  const TypeLayout& GetArgTypeLayout(int arg_index) const {
+    return arg_layouts_.at(arg_index);
+  }
+  const TypeLayout& GetReturnTypeLayout() const { return *result_layout_; }
+
   // Gets the size of the compiled function's arguments (or return value) in the
   // packed layout.
   int64_t GetPackedArgTypeSize(int arg_index) const {
     return jitted_function_base_.packed_input_buffer_sizes.at(arg_index);
   }
   int64_t GetPackedReturnTypeSize() const {
-    return jitted_function_base_.output_buffer_sizes[0];
+    return jitted_function_base_.packed_output_buffer_sizes[0];
   }
 
   // Returns the size of the temporary buffer which must be passed to the jitted
@@ -155,7 +225,8 @@ class FunctionJit {
   explicit FunctionJit(Function* xls_function) : xls_function_(xls_function) {}
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
-      Function* xls_function, int64_t opt_level, bool emit_object_code);
+      Function* xls_function, int64_t opt_level, bool emit_object_code,
+      JitObjectCache* object_cache = nullptr);
 
   // Builds a function which wraps the natively compiled XLS function `callee`
   // (as built by xls::BuildFunction) with another function which accepts the
@@ -198,18 +269,23 @@ class FunctionJit {
   void InvokeJitFunction(absl::Span<uint8_t* const> arg_buffers,
                          uint8_t* output_buffer, InterpreterEvents* events);
 
+  // Returns this thread's temporary buffer, of at least GetTempBufferSize()
+  // bytes.
+  uint8_t* GetTempBuffer() const;
+
   std::unique_ptr<OrcJit> orc_jit_;
 
   Function* xls_function_;
 
-  // Buffers to hold the arguments, result, temporary storage. This is allocated
-  // once and then re-used with each invocation of Run. Not thread-safe.
-  std::vector<std::vector<uint8_t>> arg_buffers_;
-  std::vector<uint8_t> result_buffer_;
-  std::vector<uint8_t> temp_buffer_;
+  // Offsets of the arguments within this thread's argument buffer when Run is
+  // given Values, and the size of the buffer holding all of them.
+  std::vector<int64_t> arg_buffer_offsets_;
+  int64_t arg_buffers_size_ = 0;
 
-  // Raw pointers to the buffers held in `arg_buffers_`.
-  std::vector<uint8_t*> arg_buffer_ptrs_;
+  // Layouts of the parameters and the return value used to convert Values to
+  // and from the native layout in Run and RunBatched.
+  std::vector<TypeLayout> arg_layouts_;
+  std::optional<TypeLayout> result_layout_;
 
   JittedFunctionBase jitted_function_base_;
   std::unique_ptr<JitRuntime> jit_runtime_;
@@ -22,8 +22,11 @@
 #include "absl/random/random.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/substitute.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/function_builder.h"
@@ -183,6 +186,109 @@ TEST(FunctionJitTest, ReuseTest) {
               IsOkAndHolds(Value(UBits(7, 8))));
 }
 
+TEST(FunctionJitTest, ConcurrentRuns) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn mul_add(x: bits[32], y: bits[32]) -> bits[32] {
+    add.1: bits[32] = add(x, y)
+    ret umul.2: bits[32] = umul(x, add.1)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  // Each thread checks the results for its own arguments, which would get
+  // mixed up if threads shared argument, result or temporary buffers.
+  constexpr int64_t kThreadCount = 8;
+  std::vector<int64_t> mismatches(kThreadCount);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      for (uint32_t i = 0; i < 2000; ++i) {
+        uint32_t x = t * 100000 + i;
+        uint32_t y = i * 7;
+        uint32_t expected = x * (x + y);
+        absl::StatusOr<Value> result = RunJitNoEvents(
+            jit.get(), {Value(UBits(x, 32)), Value(UBits(y, 32))});
+        if (!result.ok() || *result != Value(UBits(expected, 32))) {
+          ++mismatches[t];
+        }
+
+        uint32_t packed_result = 0;
+        PackedBitsView<32> x_view(reinterpret_cast<uint8_t*>(&x), 0);
+        PackedBitsView<32> y_view(reinterpret_cast<uint8_t*>(&y), 0);
+        PackedBitsView<32> result_view(
+            reinterpret_cast<uint8_t*>(&packed_result), 0);
+        if (!jit->RunWithPackedViews(x_view, y_view, result_view).ok() ||
+            packed_result != expected) {
+          ++mismatches[t];
+        }
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_THAT(mismatches, testing::Each(0));
+}
+
+TEST(FunctionJitTest, RunBatched) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn add_tuple(x: bits[8], y: (bits[16], bits[8])) -> bits[16] {
+    y0: bits[16] = tuple_index(y, index=0)
+    y1: bits[8] = tuple_index(y, index=1)
+    x_ext: bits[16] = zero_ext(x, new_bit_count=16)
+    y1_ext: bits[16] = zero_ext(y1, new_bit_count=16)
+    sum: bits[16] = add(x_ext, y0)
+    ret result: bits[16] = add(sum, y1_ext)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  std::vector<std::vector<Value>> args;
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < 100; ++i) {
+    args.push_back(
+        {Value(UBits(i, 8)), Value::Tuple({Value(UBits(1000 * i, 16)),
+                                           Value(UBits(2 * i, 8))})});
+    expected.push_back(Value(UBits(1003 * i, 16)));
+  }
+  EXPECT_THAT(jit->RunBatched(args), IsOkAndHolds(expected));
+
+  // An empty batch is a no-op.
+  EXPECT_THAT(jit->RunBatched(std::vector<std::vector<Value>>()),
+              IsOkAndHolds(testing::IsEmpty()));
+
+  // The batched entry point agrees with the single-element entry point.
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args[42]),
+              IsOkAndHolds(expected[42]));
+}
+
+TEST(FunctionJitTest, RunBatchedAssert) {
+  Package p("assert_test");
+  FunctionBuilder b("fun", &p);
+  auto p0 = b.Param("tkn", p.GetTokenType());
+  auto p1 = b.Param("cond", p.GetBitsType(1));
+  b.Assert(p0, p1, "the assertion error message");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+  std::vector<std::vector<Value>> ok_args(
+      3, {Value::Token(), Value(UBits(1, 1))});
+  EXPECT_THAT(jit->RunBatched(ok_args),
+              IsOkAndHolds(std::vector<Value>(3, Value::Token())));
+
+  std::vector<std::vector<Value>> fail_args = ok_args;
+  fail_args[1][1] = Value(UBits(0, 1));
+  EXPECT_THAT(jit->RunBatched(fail_args),
+              StatusIs(absl::StatusCode::kAborted,
+                       testing::HasSubstr("the assertion error message")));
+}
+
 TEST(FunctionJitTest, OneHotZeroBit) {
   Package package("my_package");
   std::string ir_text = R"(
@@ -565,6 +671,75 @@ TEST(FunctionJitTest, ArrayConcatArrayOfArrays) {
   EXPECT_THAT(RunJitNoEvents(jit.get(), args), IsOkAndHolds(ret));
 }
 
+TEST(FunctionJitTest, ArrayUpdateChain) {
+  Package package("my_package");
+
+  // The first two updates are performed in place on the buffer of their
+  // operand; u1 has two users so u2 must copy it.
+  std::string ir_text = R"(
+  fn f(a: bits[32][4], i: bits[32], x: bits[32]) -> (bits[32][4], bits[32][4]) {
+    zero: bits[32] = literal(value=0)
+    one: bits[32] = literal(value=1)
+    b: bits[32][4] = identity(a)
+    u0: bits[32][4] = array_update(b, x, indices=[zero])
+    u1: bits[32][4] = array_update(u0, x, indices=[i])
+    u2: bits[32][4] = array_update(u1, one, indices=[one])
+    ret result: (bits[32][4], bits[32][4]) = tuple(u1, u2)
+  }
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Value a, Value::UBitsArray({1, 2, 3, 4}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value in_bounds0,
+                           Value::UBitsArray({7, 2, 7, 4}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value in_bounds1,
+                           Value::UBitsArray({7, 1, 7, 4}, 32));
+  std::vector<Value> args{a, Value(UBits(2, 32)), Value(UBits(7, 32))};
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args),
+              IsOkAndHolds(Value::Tuple({in_bounds0, in_bounds1})));
+
+  // An out-of-bounds update leaves the array unchanged.
+  XLS_ASSERT_OK_AND_ASSIGN(Value out_of_bounds0,
+                           Value::UBitsArray({7, 2, 3, 4}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value out_of_bounds1,
+                           Value::UBitsArray({7, 1, 3, 4}, 32));
+  args = {a, Value(UBits(100, 32)), Value(UBits(7, 32))};
+  EXPECT_THAT(RunJitNoEvents(jit.get(), args),
+              IsOkAndHolds(Value::Tuple({out_of_bounds0, out_of_bounds1})));
+}
+
+TEST(FunctionJitTest, ArraySlicePartiallyOutOfBounds) {
+  Package package("my_package");
+
+  std::string ir_text = R"(
+  fn f(a: bits[32][5], start: bits[32]) -> bits[32][4] {
+    ret array_slice.1: bits[32][4] = array_slice(a, start, width=4)
+  }
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Value a, Value::UBitsArray({1, 2, 3, 4, 5}, 32));
+  auto run = [&](int64_t start) {
+    std::vector<Value> args{a, Value(UBits(start, 32))};
+    return RunJitNoEvents(jit.get(), args);
+  };
+  // Elements past the end of the array are filled with its last element.
+  XLS_ASSERT_OK_AND_ASSIGN(Value at0, Value::UBitsArray({1, 2, 3, 4}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value at1, Value::UBitsArray({2, 3, 4, 5}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value at3, Value::UBitsArray({4, 5, 5, 5}, 32));
+  XLS_ASSERT_OK_AND_ASSIGN(Value at100, Value::UBitsArray({5, 5, 5, 5}, 32));
+  EXPECT_THAT(run(0), IsOkAndHolds(at0));
+  EXPECT_THAT(run(1), IsOkAndHolds(at1));
+  EXPECT_THAT(run(3), IsOkAndHolds(at3));
+  EXPECT_THAT(run(100), IsOkAndHolds(at100));
+}
+
 // The assert tests below are duplicates of the ones in
 // xls/interpereter/ir_evaluator_test_base.cc because those recompile
 // the test function each time they run it. These tests check that
@@ -668,6 +843,52 @@ TEST(FunctionJitTest, TwoAssert) {
                        testing::HasSubstr("first assertion error message")));
 }
 
+// Verifies the limb-wise lowering of arithmetic on wide values against the
+// interpreter. The widths cover the native, unrolled, and looped lowerings as
+// well as widths with padding bits.
+TEST(FunctionJitTest, WideArithmetic) {
+  std::minstd_rand bitgen;
+  for (int64_t width : {65, 127, 129, 200, 256, 511, 1024, 1500, 2048, 4096}) {
+    Package package("wide_arithmetic");
+    FunctionBuilder b("wide", &package);
+    BValue x = b.Param("x", package.GetBitsType(width));
+    BValue y = b.Param("y", package.GetBitsType(width));
+    BValue narrow = b.Param("narrow", package.GetBitsType(width / 2 + 1));
+    BValue amount = b.Param("amount", package.GetBitsType(16));
+    b.Tuple({b.Add(x, y), b.Subtract(x, y), b.Negate(x), b.UMul(x, y),
+             b.SMul(x, y), b.UMul(x, narrow, width), b.SMul(narrow, x, width),
+             b.UMul(narrow, narrow, width), b.Shll(x, amount),
+             b.Shrl(x, amount), b.Shra(x, amount)});
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+    XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+    int64_t llvm_width = int64_t{1} << CeilOfLog2(width);
+    std::vector<int64_t> amounts = {0,         1,          63,
+                                    64,        65,         width - 1,
+                                    width,     width + 1,  llvm_width - 1,
+                                    llvm_width, 0xffff};
+    for (int64_t i = 0; i < 8; ++i) {
+      amounts.push_back(absl::Uniform<int64_t>(bitgen, 0, width));
+    }
+    for (int64_t amount_value : amounts) {
+      std::vector<Value> args;
+      for (Param* param : f->params()) {
+        args.push_back(RandomValue(param->GetType(), &bitgen));
+      }
+      args.back() = Value(UBits(amount_value, 16));
+      if (amount_value % 3 == 0) {
+        // Exercise the carry chains with all-ones operands.
+        args[0] = Value(Bits::AllOnes(width));
+      }
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                               InterpretFunction(f, args));
+      EXPECT_THAT(RunJitNoEvents(jit.get(), args),
+                  IsOkAndHolds(expected.value))
+          << "width: " << width << ", amount: " << amount_value;
+    }
+  }
+}
+
 TEST(FunctionJitTest, TokenCompareError) {
   Package p("token_eq");
   FunctionBuilder b("fun", &p);
@@ -15,14 +15,17 @@
 
 #include "absl/base/config.h"  // IWYU pragma: keep
 #include "absl/status/status.h"
+#include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/Constants.h"
 #include "llvm/include/llvm/IR/DerivedTypes.h"
 #include "llvm/include/llvm/IR/IRBuilder.h"
 #include "llvm/include/llvm/IR/Instructions.h"
+#include "llvm/include/llvm/IR/Intrinsics.h"
 #include "llvm/include/llvm/IR/LLVMContext.h"
 #include "llvm/include/llvm/IR/Module.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/events.h"
@@ -32,6 +35,7 @@
 #include "xls/ir/value_helpers.h"
 #include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/jit_trace_buffer.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 
@@ -52,6 +56,10 @@ class LlvmIrLoop {
  public:
   LlvmIrLoop(int64_t loop_count, llvm::IRBuilder<>& builder, int64_t stride = 1,
              llvm::BasicBlock* insert_before = nullptr);
+  // As above but with a loop count computed at run time. `loop_count` must be
+  // an i64 value available in the block of `builder`.
+  LlvmIrLoop(llvm::Value* loop_count, llvm::IRBuilder<>& builder,
+             int64_t stride = 1, llvm::BasicBlock* insert_before = nullptr);
   ~LlvmIrLoop() { XLS_CHECK(finalized_); }
 
   // Index value ranging from 0 ... (N-1) * stride. Type is i64.
@@ -115,6 +123,11 @@ class LlvmIrLoop {
 // Creates a simple loop in LLVM IR which interates `loop_count` times.
 LlvmIrLoop::LlvmIrLoop(int64_t loop_count, llvm::IRBuilder<>& builder,
                        int64_t stride, llvm::BasicBlock* insert_before)
+    : LlvmIrLoop(builder.getInt64(loop_count), builder, stride,
+                 insert_before) {}
+
+LlvmIrLoop::LlvmIrLoop(llvm::Value* loop_count, llvm::IRBuilder<>& builder,
+                       int64_t stride, llvm::BasicBlock* insert_before)
     : stride_(stride) {
   llvm::Function* function = builder.GetInsertBlock()->getParent();
   llvm::LLVMContext& context = builder.getContext();
@@ -129,10 +142,11 @@ LlvmIrLoop::LlvmIrLoop(int64_t loop_count, llvm::IRBuilder<>& builder,
   exit_builder_ = std::make_unique<llvm::IRBuilder<>>(
       llvm::BasicBlock::Create(context, "exit", function, insert_before));
 
+  llvm::Value* index_limit = builder.CreateMul(
+      loop_count, builder.getInt64(stride), "index_limit");
   builder.CreateBr(preheader_block_);
 
   llvm::Value* init_index = preheader_builder->getInt64(0);
-  llvm::Value* index_limit = preheader_builder->getInt64(loop_count * stride);
 
   index_ = preheader_builder->CreatePHI(llvm::Type::getInt64Ty(context), 2);
   index_->setName("index");
@@ -258,6 +272,211 @@ llvm::Value* EmitShiftOp(Node* shift, llvm::Value* lhs, llvm::Value* rhs,
              : builder->CreateTrunc(result, lhs->getType());
 }
 
+// Bits values wider than this many bits in their LLVM representation are
+// lowered to operations on 64-bit limbs rather than to LLVM's arbitrary-width
+// integer operations. LLVM legalizes wide multiplies and variable shifts into
+// straight-line code which grows superlinearly with the width.
+constexpr int64_t kMaxNativeArithmeticBitCount = 128;
+
+// Loops over limbs with at most this many iterations are fully unrolled. Wider
+// values are handled with loops to bound the size of the generated code.
+constexpr int64_t kMaxUnrolledLimbCount = 16;
+
+constexpr int64_t kLimbBitCount = 64;
+
+// Returns true if arithmetic producing values of type `type` should be lowered
+// to operations on 64-bit limbs.
+bool UseWideLowering(Type* type, LlvmTypeConverter* type_converter) {
+  return type->IsBits() &&
+         type_converter->GetLlvmBitCount(type->AsBitsOrDie()) >
+             kMaxNativeArithmeticBitCount;
+}
+
+// Returns the number of 64-bit limbs in the LLVM representation of `type`.
+// LLVM bit counts of wide values are powers of two so there is no partial
+// limb.
+int64_t LimbCount(Type* type, LlvmTypeConverter* type_converter) {
+  return type_converter->GetLlvmBitCount(type->AsBitsOrDie()) / kLimbBitCount;
+}
+
+// Returns a pointer to the limb at (i64) `index` of the wide value pointed to
+// by `ptr`. Limb zero is the least significant limb.
+llvm::Value* LimbPtr(llvm::Value* ptr, llvm::Value* index,
+                     llvm::IRBuilder<>& b) {
+  llvm::Type* limb_type = b.getInt64Ty();
+  return b.CreateGEP(limb_type,
+                     b.CreateBitCast(ptr, limb_type->getPointerTo()), index);
+}
+
+llvm::Value* LoadLimb(llvm::Value* ptr, llvm::Value* index,
+                      llvm::IRBuilder<>& b) {
+  return b.CreateLoad(b.getInt64Ty(), LimbPtr(ptr, index, b));
+}
+
+void StoreLimb(llvm::Value* limb, llvm::Value* ptr, llvm::Value* index,
+               llvm::IRBuilder<>& b) {
+  b.CreateStore(limb, LimbPtr(ptr, index, b));
+}
+
+// Emits code calling `emit_body` for each (i64) limb index in [0, count). The
+// loop is fully unrolled with constant indices if `count` is a constant no
+// greater than kMaxUnrolledLimbCount, otherwise an LLVM loop is emitted.
+// `emit_body` may replace the builder it is passed if it emits control flow. On
+// return `builder` is the builder for the code following the loop.
+void EmitLimbLoop(
+    llvm::Value* count, std::unique_ptr<llvm::IRBuilder<>>& builder,
+    const std::function<void(llvm::Value*,
+                             std::unique_ptr<llvm::IRBuilder<>>&)>& emit_body) {
+  auto* constant_count = llvm::dyn_cast<llvm::ConstantInt>(count);
+  if (constant_count != nullptr &&
+      constant_count->getZExtValue() <= kMaxUnrolledLimbCount) {
+    for (int64_t i = 0; i < constant_count->getZExtValue(); ++i) {
+      emit_body(builder->getInt64(i), builder);
+    }
+    return;
+  }
+  LlvmIrLoop loop(count, *builder);
+  std::unique_ptr<llvm::IRBuilder<>> body_builder = loop.ConsumeBodyBuilder();
+  emit_body(loop.index(), body_builder);
+  loop.Finalize(body_builder.get());
+  builder = loop.ConsumeExitBuilder();
+}
+
+// Emits `result = lhs + rhs` or, if `is_sub`, `result = lhs - rhs` as a carry
+// (borrow) chain over `limb_count` 64-bit limbs. The operands and result are
+// pointers to wide values. `lhs` may be null in which case it is taken to be
+// zero (used for negation).
+void EmitWideAddSub(llvm::Value* lhs, llvm::Value* rhs, llvm::Value* result,
+                    int64_t limb_count, bool is_sub,
+                    std::unique_ptr<llvm::IRBuilder<>>& builder) {
+  llvm::Type* limb_type = builder->getInt64Ty();
+  llvm::Type* double_limb_type = builder->getInt128Ty();
+  llvm::Value* carry = builder->CreateAlloca(limb_type, nullptr, "carry");
+  builder->CreateStore(builder->getInt64(0), carry);
+  EmitLimbLoop(
+      builder->getInt64(limb_count), builder,
+      [&](llvm::Value* i, std::unique_ptr<llvm::IRBuilder<>>& b) {
+        llvm::Value* a = b->CreateZExt(
+            lhs == nullptr ? b->getInt64(0) : LoadLimb(lhs, i, *b),
+            double_limb_type);
+        llvm::Value* c =
+            b->CreateZExt(LoadLimb(rhs, i, *b), double_limb_type);
+        llvm::Value* carry_in =
+            b->CreateZExt(b->CreateLoad(limb_type, carry), double_limb_type);
+        llvm::Value* sum = is_sub
+                               ? b->CreateSub(b->CreateSub(a, c), carry_in)
+                               : b->CreateAdd(b->CreateAdd(a, c), carry_in);
+        StoreLimb(b->CreateTrunc(sum, limb_type), result, i, *b);
+        llvm::Value* carry_out = b->CreateTrunc(
+            b->CreateLShr(sum, kLimbBitCount), limb_type);
+        if (is_sub) {
+          // A borrow sets all of the upper bits of the difference.
+          carry_out = b->CreateAnd(carry_out, 1);
+        }
+        b->CreateStore(carry_out, carry);
+      });
+}
+
+// Emits the low `limb_count` limbs of the product `lhs * rhs` into `result`
+// using schoolbook multiplication. Each limb product is computed as a 128-bit
+// value. Partial products which only contribute to limbs above the result are
+// not computed so roughly half of the limb products of a full-width product
+// are emitted.
+void EmitWideMul(llvm::Value* lhs, llvm::Value* rhs, llvm::Value* result,
+                 int64_t limb_count,
+                 std::unique_ptr<llvm::IRBuilder<>>& builder) {
+  llvm::Type* limb_type = builder->getInt64Ty();
+  llvm::Type* double_limb_type = builder->getInt128Ty();
+  llvm::Value* carry = builder->CreateAlloca(limb_type, nullptr, "carry");
+  builder->CreateMemSet(result, builder->getInt8(0),
+                        limb_count * kLimbBitCount / 8, llvm::MaybeAlign(8));
+  EmitLimbLoop(
+      builder->getInt64(limb_count), builder,
+      [&](llvm::Value* i, std::unique_ptr<llvm::IRBuilder<>>& outer) {
+        llvm::Value* a =
+            outer->CreateZExt(LoadLimb(lhs, i, *outer), double_limb_type);
+        outer->CreateStore(outer->getInt64(0), carry);
+        EmitLimbLoop(
+            outer->CreateSub(outer->getInt64(limb_count), i), outer,
+            [&](llvm::Value* j, std::unique_ptr<llvm::IRBuilder<>>& b) {
+              // result[i + j] += a[i] * b[j] + carry. The sum fits in 128 bits.
+              llvm::Value* k = b->CreateAdd(i, j);
+              llvm::Value* t = b->CreateMul(
+                  a, b->CreateZExt(LoadLimb(rhs, j, *b), double_limb_type));
+              t = b->CreateAdd(
+                  t, b->CreateZExt(LoadLimb(result, k, *b), double_limb_type));
+              t = b->CreateAdd(t, b->CreateZExt(b->CreateLoad(limb_type, carry),
+                                                double_limb_type));
+              StoreLimb(b->CreateTrunc(t, limb_type), result, k, *b);
+              b->CreateStore(
+                  b->CreateTrunc(b->CreateLShr(t, kLimbBitCount), limb_type),
+                  carry);
+            });
+      });
+}
+
+// Emits `result = value << amount` (`op` kShll) or `value >> amount` (kShrl,
+// kShra) where `value` is a wide value of `limb_count` limbs and `amount` is an
+// i64 less than the bit width of `value`. The value is placed in a buffer of
+// twice its width next to the limbs being shifted in (zeros or copies of the
+// sign) such that each result limb is a funnel shift of two adjacent limbs of
+// the buffer.
+void EmitWideShift(Op op, llvm::Value* value, llvm::Value* amount,
+                   llvm::Value* result, int64_t limb_count,
+                   std::unique_ptr<llvm::IRBuilder<>>& builder) {
+  llvm::Type* limb_type = builder->getInt64Ty();
+  llvm::Value* buffer = builder->CreateAlloca(
+      llvm::ArrayType::get(limb_type, 2 * limb_count), nullptr, "shift_buffer");
+  int64_t value_offset = op == Op::kShll ? limb_count : 0;
+  int64_t fill_offset = op == Op::kShll ? 0 : limb_count;
+  builder->CreateStore(
+      value,
+      builder->CreateBitCast(
+          LimbPtr(buffer, builder->getInt64(value_offset), *builder),
+          value->getType()->getPointerTo()));
+  llvm::Value* fill =
+      op == Op::kShra
+          ? builder->CreateAShr(
+                LoadLimb(buffer,
+                         builder->getInt64(value_offset + limb_count - 1),
+                         *builder),
+                kLimbBitCount - 1)
+          : builder->getInt64(0);
+  EmitLimbLoop(builder->getInt64(limb_count), builder,
+               [&](llvm::Value* i, std::unique_ptr<llvm::IRBuilder<>>& b) {
+                 StoreLimb(fill, buffer,
+                           b->CreateAdd(i, b->getInt64(fill_offset)), *b);
+               });
+
+  llvm::Value* limb_shift =
+      builder->CreateLShr(amount, CeilOfLog2(kLimbBitCount));
+  llvm::Value* bit_shift = builder->CreateAnd(amount, kLimbBitCount - 1);
+  EmitLimbLoop(
+      builder->getInt64(limb_count), builder,
+      [&](llvm::Value* i, std::unique_ptr<llvm::IRBuilder<>>& b) {
+        llvm::Value* limb;
+        if (op == Op::kShll) {
+          // result[i] = buffer[n + i - limb_shift : n + i - limb_shift - 1]
+          llvm::Value* hi_index = b->CreateSub(
+              b->CreateAdd(i, b->getInt64(limb_count)), limb_shift);
+          llvm::Value* lo_index = b->CreateSub(hi_index, b->getInt64(1));
+          limb = b->CreateIntrinsic(
+              llvm::Intrinsic::fshl, {limb_type},
+              {LoadLimb(buffer, hi_index, *b), LoadLimb(buffer, lo_index, *b),
+               bit_shift});
+        } else {
+          // result[i] = buffer[i + limb_shift + 1 : i + limb_shift]
+          llvm::Value* lo_index = b->CreateAdd(i, limb_shift);
+          llvm::Value* hi_index = b->CreateAdd(lo_index, b->getInt64(1));
+          limb = b->CreateIntrinsic(
+              llvm::Intrinsic::fshr, {limb_type},
+              {LoadLimb(buffer, hi_index, *b), LoadLimb(buffer, lo_index, *b),
+               bit_shift});
+        }
+        StoreLimb(limb, result, i, *b);
+      });
+}
+
 llvm::Value* EmitDiv(llvm::Value* lhs, llvm::Value* rhs, int64_t bit_count,
                      bool is_signed, LlvmTypeConverter* type_converter,
                      llvm::IRBuilder<>* builder) {
@@ -415,146 +634,60 @@ llvm::Value* ClampIndexInBounds(llvm::Value* index, ArrayType* array_type,
   return inbounds_index;
 }
 
-// This is a shim to let JIT code add a new trace fragment to an existing trace
-// buffer.
-void PerformStringStep(char* step_string, std::string* buffer) {
-  buffer->append(step_string);
-}
-
-// Build the LLVM IR that handles string fragment format steps.
-absl::Status InvokeStringStepCallback(llvm::IRBuilder<>* builder,
-                                      const std::string& step_string,
-                                      llvm::Value* buffer_ptr) {
-  llvm::Constant* step_constant = builder->CreateGlobalStringPtr(step_string);
-
-  std::vector<llvm::Type*> params = {step_constant->getType(),
-                                     buffer_ptr->getType()};
-
-  llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args = {step_constant, buffer_ptr};
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&PerformStringStep));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
-  return absl::OkStatus();
-}
-
-void PerformFormatStep(JitRuntime* runtime, const xls::Type* type,
-                       const uint8_t* value, uint64_t format_u64,
-                       std::string* buffer) {
-  FormatPreference format = static_cast<FormatPreference>(format_u64);
-  Value ir_value = runtime->UnpackBuffer(value, type, /*unpoison=*/true);
-  absl::StrAppend(buffer, ir_value.ToHumanString(format));
-}
-
-// Build the LLVM IR that handles formatting a runtime value according to a
-// format preference.
-absl::Status InvokeFormatStepCallback(llvm::IRBuilder<>* builder,
-                                      FormatPreference format,
-                                      xls::Type* operand_type,
-                                      llvm::Value* operand,
-                                      llvm::Value* buffer_ptr,
-                                      llvm::Value* jit_runtime_ptr) {
-  llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
-  auto* i64_type = llvm::Type::getInt64Ty(builder->getContext());
-
-  llvm::ConstantInt* llvm_format =
-      llvm::ConstantInt::get(i64_type, static_cast<uint64_t>(format));
-
-  // Note: we assume the package lifetime is >= that of the JIT code by
-  // capturing this type pointer as a value burned into the JIT code, which
-  // should always be true.
-  llvm::ConstantInt* llvm_operand_type =
-      llvm::ConstantInt::get(i64_type, absl::bit_cast<uint64_t>(operand_type));
-
-  std::vector<llvm::Type*> params = {
-      jit_runtime_ptr->getType(), llvm_operand_type->getType(),
-      operand->getType(), llvm_format->getType(), buffer_ptr->getType()};
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args = {jit_runtime_ptr, llvm_operand_type, operand,
-                                    llvm_format, buffer_ptr};
-
-  llvm::ConstantInt* fn_addr = llvm::ConstantInt::get(
-      i64_type, absl::bit_cast<uint64_t>(&PerformFormatStep));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
-  return absl::OkStatus();
-}
-
-// This a shim to let JIT code record a completed trace as an interpreter event.
-void RecordTrace(std::string* buffer, xls::InterpreterEvents* events) {
-  events->trace_msgs.push_back(*buffer);
-  delete buffer;
+// This is a shim to let JIT code record a trace. `operands` points to the
+// `size` byte record holding the trace operand values in the native layout,
+// which is copied into the trace buffer of the calling thread to be decoded
+// after the jitted function returns.
+void RecordTrace(const Trace* trace, const uint8_t* operands, int64_t size) {
+  JitTraceBuffer::ForCurrentThread().Append(trace, operands, size);
 }
 
 // Build the LLVM IR to invoke the callback that records traces.
 absl::Status InvokeRecordTraceCallback(llvm::IRBuilder<>* builder,
-                                       llvm::Value* buffer_ptr,
-                                       llvm::Value* interpreter_events_ptr) {
+                                       Trace* trace, llvm::Value* operands_ptr,
+                                       int64_t size,
+                                       JitBuilderContext& jit_context) {
   llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
+  auto* i64_type = llvm::Type::getInt64Ty(builder->getContext());
 
-  std::vector<llvm::Type*> params = {buffer_ptr->getType(), ptr_type};
+  // Note: we assume the package lifetime is >= that of the JIT code by
+  // binding a symbol to this node pointer, which should always be true.
+  XLS_ASSIGN_OR_RETURN(
+      llvm::Constant * llvm_trace,
+      jit_context.GetExternalObject(
+          absl::StrFormat("__xls_trace_%d", trace->id()),
+          llvm::Type::getInt8Ty(builder->getContext()),
+          absl::bit_cast<uint64_t>(trace)));
+
+  std::vector<llvm::Type*> params = {ptr_type, ptr_type, i64_type};
 
   llvm::Type* void_type = llvm::Type::getVoidTy(builder->getContext());
 
   llvm::FunctionType* fn_type =
       llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
 
-  std::vector<llvm::Value*> args = {buffer_ptr, interpreter_events_ptr};
+  std::vector<llvm::Value*> args = {llvm_trace, operands_ptr,
+                                    llvm::ConstantInt::get(i64_type, size)};
 
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&RecordTrace));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
+  XLS_ASSIGN_OR_RETURN(
+      llvm::FunctionCallee fn,
+      jit_context.GetExternalFunction("__xls_record_trace", fn_type,
+                                      absl::bit_cast<uint64_t>(&RecordTrace)));
+  builder->CreateCall(fn, args);
   return absl::OkStatus();
 }
 
-// This is a shim to let JIT code create a buffer for accumulating trace
-// fragments.
-std::string* CreateTraceBuffer() { return new std::string(); }
-
-// Build the LLVM IR to invoke the callback that creates a trace buffer.
-absl::StatusOr<llvm::Value*> InvokeCreateBufferCallback(
-    llvm::IRBuilder<>* builder) {
-  std::vector<llvm::Type*> params;
-
-  llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
-
-  llvm::FunctionType* fn_type =
-      llvm::FunctionType::get(ptr_type, params, /*isVarArg=*/false);
-
-  std::vector<llvm::Value*> args;
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&CreateTraceBuffer));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  return builder->CreateCall(fn_type, fn_ptr, args);
-}
-
 // This a shim to let JIT code record an assertion failure as an interpreter
 // event.
 void RecordAssertion(char* msg, xls::InterpreterEvents* events) {
-  events->assert_msgs.push_back(msg);
+  events->RecordAssert(msg);
 }
 
 // Build the LLVM IR to invoke the callback that records assertions.
 absl::Status InvokeAssertCallback(llvm::IRBuilder<>* builder,
                                   const std::string& message,
-                                  llvm::Value* interpreter_events_ptr) {
+                                  llvm::Value* interpreter_events_ptr,
+                                  JitBuilderContext& jit_context) {
   llvm::Constant* msg_constant = builder->CreateGlobalStringPtr(message);
 
   llvm::Type* msg_type = msg_constant->getType();
@@ -570,12 +703,12 @@ absl::Status InvokeAssertCallback(llvm::IRBuilder<>* builder,
 
   std::vector<llvm::Value*> args = {msg_constant, interpreter_events_ptr};
 
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder->getContext()),
-                             absl::bit_cast<uint64_t>(&RecordAssertion));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
+  XLS_ASSIGN_OR_RETURN(
+      llvm::FunctionCallee fn,
+      jit_context.GetExternalFunction(
+          "__xls_record_assertion", fn_type,
+          absl::bit_cast<uint64_t>(&RecordAssertion)));
+  builder->CreateCall(fn, args);
   return absl::OkStatus();
 }
 
@@ -982,6 +1115,13 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
       Node* node, std::function<llvm::Value*(absl::Span<llvm::Value* const>,
                                              llvm::IRBuilder<>&)>);
 
+  // Handlers for arithmetic on values wider than kMaxNativeArithmeticBitCount
+  // which lower the operation to a sequence of operations on 64-bit limbs.
+  // HandleWideAddSub handles add, sub, and neg (a single operand).
+  absl::Status HandleWideAddSub(Node* node, bool is_sub);
+  absl::Status HandleWideMul(ArithOp* mul, bool is_signed);
+  absl::Status HandleWideShift(BinOp* shift);
+
   // HandleBinaryOp variant which converts the operands to result type prior to
   // calling `build_result`.
   absl::Status HandleBinaryOpWithOperandConversion(
@@ -1042,6 +1182,14 @@ class IrBuilderVisitor : public DfsVisitorWithDefault {
                            Send* send, llvm::Value* send_data_ptr,
                            llvm::Value* user_data);
 
+  // Returns a pointer to `queue`, the queue of the channel with the given id.
+  absl::StatusOr<llvm::Constant*> GetQueueSymbol(JitChannelQueue* queue,
+                                                 int64_t channel_id) {
+    return jit_context_.GetExternalObject(
+        absl::StrFormat("__xls_queue_%d", channel_id),
+        llvm::Type::getInt8Ty(ctx()), absl::bit_cast<uint64_t>(queue));
+  }
+
   int64_t output_arg_count_;
   JitBuilderContext& jit_context_;
   std::optional<NodeIrContext> node_context_;
@@ -1053,6 +1201,9 @@ absl::Status IrBuilderVisitor::DefaultHandler(Node* node) {
 }
 
 absl::Status IrBuilderVisitor::HandleAdd(BinOp* binop) {
+  if (UseWideLowering(binop->GetType(), type_converter())) {
+    return HandleWideAddSub(binop, /*is_sub=*/false);
+  }
   return HandleBinaryOp(
       binop, [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return b.CreateAdd(lhs, rhs);
@@ -1102,7 +1253,8 @@ absl::Status IrBuilderVisitor::HandleAssert(Assert* assert_op) {
   llvm::IRBuilder<> fail_builder(fail_block);
   XLS_RETURN_IF_ERROR(
       InvokeAssertCallback(&fail_builder, assert_op->message(),
-                           node_context.GetInterpreterEventsArg()));
+                           node_context.GetInterpreterEventsArg(),
+                           jit_context_));
 
   fail_builder.CreateBr(after_block);
 
@@ -1147,13 +1299,15 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
       NewNodeIrContext(
           trace_op,
           ConcatVectors({"tkn", "condition"},
-                        NumberedStrings("arg", trace_op->args().size())),
-          /*include_wrapper_args=*/true));
+                        NumberedStrings("arg", trace_op->args().size()))));
+  if (!JitTracesEnabled()) {
+    // The trace is compiled out and only produces its token.
+    return FinalizeNodeIrContextWithValue(std::move(node_context),
+                                          type_converter()->GetToken());
+  }
 
   llvm::IRBuilder<>& b = node_context.entry_builder();
   llvm::Value* condition = node_context.LoadOperand(1);
-  llvm::Value* events_ptr = node_context.GetInterpreterEventsArg();
-  llvm::Value* jit_runtime_ptr = node_context.GetJitRuntimeArg();
 
   std::string trace_name = trace_op->GetName();
 
@@ -1171,36 +1325,33 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
       ctx(), absl::StrCat(trace_name, "_print"), node_context.llvm_function());
   llvm::IRBuilder<> print_builder(print_block);
 
-  XLS_ASSIGN_OR_RETURN(llvm::Value * buffer_ptr,
-                       InvokeCreateBufferCallback(&print_builder));
-
   // Operands are: (tok, pred, ..data_operands..)
   XLS_RET_CHECK_EQ(trace_op->operand(0)->GetType(),
                    trace_op->package()->GetTokenType());
   XLS_RET_CHECK_EQ(trace_op->operand(1)->GetType(),
                    trace_op->package()->GetBitsType(1));
 
-  size_t operand_index = 2;
-  for (const FormatStep& step : trace_op->format()) {
-    if (std::holds_alternative<std::string>(step)) {
-      XLS_RETURN_IF_ERROR(InvokeStringStepCallback(
-          &print_builder, std::get<std::string>(step), buffer_ptr));
-    } else {
-      xls::Node* o = trace_op->operand(operand_index);
-      llvm::Value* operand = node_context.LoadOperand(operand_index);
-      llvm::AllocaInst* alloca = print_builder.CreateAlloca(operand->getType());
-      print_builder.CreateStore(operand, alloca);
-      // The way our format strings are currently formed we implicitly refer to
-      // the next operand after formatting this one.
-      operand_index += 1;
-      XLS_RETURN_IF_ERROR(InvokeFormatStepCallback(
-          &print_builder, std::get<FormatPreference>(step), o->GetType(),
-          alloca, buffer_ptr, jit_runtime_ptr));
-    }
+  // Spill the data operands into a single record laid out as expected by
+  // JitTraceBuffer and pass it to the callback.
+  std::vector<int64_t> offsets;
+  int64_t record_size = 0;
+  for (Node* arg : trace_op->args()) {
+    offsets.push_back(JitTraceBuffer::AlignOperandOffset(record_size));
+    record_size =
+        offsets.back() + type_converter()->GetTypeByteSize(arg->GetType());
+  }
+  llvm::Type* i8_type = llvm::Type::getInt8Ty(ctx());
+  llvm::AllocaInst* record = print_builder.CreateAlloca(
+      llvm::ArrayType::get(i8_type, std::max<int64_t>(record_size, 1)));
+  record->setAlignment(llvm::Align(JitTraceBuffer::kOperandAlignment));
+  for (int64_t i = 0; i < offsets.size(); ++i) {
+    llvm::Value* slot = print_builder.CreateGEP(
+        i8_type, record, print_builder.getInt64(offsets[i]));
+    print_builder.CreateStore(node_context.LoadOperand(i + 2), slot);
   }
 
-  XLS_RETURN_IF_ERROR(
-      InvokeRecordTraceCallback(&print_builder, buffer_ptr, events_ptr));
+  XLS_RETURN_IF_ERROR(InvokeRecordTraceCallback(
+      &print_builder, trace_op, record, record_size, jit_context_));
 
   print_builder.CreateBr(after_block);
 
@@ -1265,40 +1416,53 @@ absl::Status IrBuilderVisitor::HandleArraySlice(ArraySlice* slice) {
                      llvm::ConstantInt::get(i64, input_array_size));
   clamped_start->setName("clamped_start");
 
-  // Create a loop which copies one array element at a time.
-  LlvmIrLoop loop(width, node_context.entry_builder());
-
-  // Compute the index of the element in the operand array. The index should be
-  // clamped to the maximum index value.
-  llvm::Value* index =
-      loop.body_builder().CreateAdd(clamped_start, loop.index());
-  llvm::Value* max_index = llvm::ConstantInt::get(i64, input_array_size - 1);
-  llvm::Value* clamped_index = loop.body_builder().CreateSelect(
-      loop.body_builder().CreateICmpULE(index, max_index), index, max_index);
-  clamped_index->setName("clamped_index");
+  // The elements of the slice which are within the operand array are copied
+  // with a single memcpy:
+  //
+  //   inbounds_count = min(width, input_array_size - clamped_start)
+  //
+  // The remaining elements (if any) are copies of the last element of the
+  // operand array and are copied one at a time.
+  llvm::Value* available =
+      b.CreateSub(llvm::ConstantInt::get(i64, input_array_size), clamped_start);
+  llvm::Value* width_value = llvm::ConstantInt::get(i64, width);
+  llvm::Value* inbounds_count =
+      b.CreateSelect(b.CreateICmpULT(available, width_value), available,
+                     width_value);
+  inbounds_count->setName("inbounds_count");
 
-  // Compute the address of the element in the operand array.
   llvm::Value* operand_buffer = node_context.GetOperandPtr(0);
   llvm::Type* src_array_type =
       type_converter()->ConvertToLlvmType(input_array_type);
-  llvm::Value* src_element = loop.body_builder().CreateGEP(
-      src_array_type, operand_buffer,
-      {llvm::ConstantInt::get(i32, 0), clamped_index});
-  src_element->setName("src_element");
-
-  // Compute the address of the element in the result array.
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
   llvm::Type* tgt_array_type =
       type_converter()->ConvertToLlvmType(slice->GetType());
+  int64_t element_size = type_converter()->GetTypeByteSize(
+      slice->array()->GetType()->AsArrayOrDie()->element_type());
+
+  llvm::Value* src_start = b.CreateGEP(
+      src_array_type, operand_buffer,
+      {llvm::ConstantInt::get(i32, 0), clamped_start});
+  b.CreateMemCpy(output_buffer, llvm::MaybeAlign(1), src_start,
+                 llvm::MaybeAlign(1),
+                 b.CreateMul(inbounds_count,
+                             llvm::ConstantInt::get(i64, element_size)));
+
+  // Create a loop which fills the out-of-bounds elements of the result one at a
+  // time with the last element of the operand array.
+  llvm::Value* last_element = b.CreateGEP(
+      src_array_type, operand_buffer,
+      {llvm::ConstantInt::get(i32, 0),
+       llvm::ConstantInt::get(i64, input_array_size - 1)});
+  last_element->setName("last_element");
+  LlvmIrLoop loop(b.CreateSub(width_value, inbounds_count),
+                  node_context.entry_builder());
   llvm::Value* tgt_element = loop.body_builder().CreateGEP(
       tgt_array_type, output_buffer,
-      {llvm::ConstantInt::get(i32, 0), loop.index()});
+      {llvm::ConstantInt::get(i32, 0),
+       loop.body_builder().CreateAdd(inbounds_count, loop.index())});
   tgt_element->setName("tgt_element");
-
-  // Copy the element from the operand buffer to the result buffer.
-  int64_t element_size = type_converter()->GetTypeByteSize(
-      slice->array()->GetType()->AsArrayOrDie()->element_type());
-  LlvmMemcpy(tgt_element, src_element, element_size, loop.body_builder());
+  LlvmMemcpy(tgt_element, last_element, element_size, loop.body_builder());
 
   loop.Finalize();
 
@@ -1315,10 +1479,9 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
                         NumberedStrings("index", update->indices().size()))));
   llvm::IRBuilder<>& b = node_context.entry_builder();
 
-  // First, copy the entire array to update (operand 0) to the output buffer.
   llvm::Value* output_buffer = node_context.GetOutputPtr(0);
-  LlvmMemcpy(output_buffer, node_context.GetOperandPtr(0),
-             type_converter()->GetTypeByteSize(update->GetType()), b);
+  llvm::Value* array_buffer = node_context.GetOperandPtr(0);
+  llvm::Value* update_value_buffer = node_context.GetOperandPtr(1);
 
   // Determine whether the indices are all inbounds. If any are out of bounds
   // then the array update operation is a NOP. Also, gather the GEP indices for
@@ -1344,6 +1507,23 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
     array_type = array_type->AsArrayOrDie()->element_type();
   }
 
+  // Copy the entire array to update (operand 0) to the output buffer. The two
+  // are the same buffer when the update is performed in place (the JIT does
+  // this when the update is the only user of the array), in which case nothing
+  // is copied.
+  llvm::BasicBlock* copy_block =
+      llvm::BasicBlock::Create(ctx(), "copy", node_context.llvm_function());
+  llvm::IRBuilder<> copy_builder(copy_block);
+  llvm::BasicBlock* update_block =
+      llvm::BasicBlock::Create(ctx(), "update", node_context.llvm_function());
+  llvm::IRBuilder<> update_builder(update_block);
+  LlvmMemcpy(output_buffer, array_buffer,
+             type_converter()->GetTypeByteSize(update->GetType()),
+             copy_builder);
+  copy_builder.CreateBr(update_block);
+  b.CreateCondBr(b.CreateICmpNE(output_buffer, array_buffer), copy_block,
+                 update_block);
+
   llvm::BasicBlock* inbounds_block =
       llvm::BasicBlock::Create(ctx(), "inbounds", node_context.llvm_function());
   llvm::IRBuilder<> inbounds_builder(inbounds_block);
@@ -1357,14 +1537,14 @@ absl::Status IrBuilderVisitor::HandleArrayUpdate(ArrayUpdate* update) {
   llvm::Value* output_element = inbounds_builder.CreateGEP(
       type_converter()->ConvertToLlvmType(update->GetType()), output_buffer,
       gep_indices);
-  LlvmMemcpy(output_element, node_context.GetOperandPtr(1),
+  LlvmMemcpy(output_element, update_value_buffer,
              type_converter()->GetTypeByteSize(update->operand(1)->GetType()),
              inbounds_builder);
   inbounds_builder.CreateBr(exit_block);
 
-  // From the entry block, branch to the inbounds block if the index is
-  // inbounds. Otherwise branch to the exit block.
-  b.CreateCondBr(is_inbounds, inbounds_block, exit_block);
+  // After the copy, branch to the inbounds block if the index is inbounds.
+  // Otherwise branch to the exit block.
+  update_builder.CreateCondBr(is_inbounds, inbounds_block, exit_block);
 
   return FinalizeNodeIrContextWithPointerToValue(std::move(node_context),
                                                  output_buffer, &exit_builder);
@@ -1962,6 +2142,9 @@ absl::Status IrBuilderVisitor::HandleMap(Map* map) {
 }
 
 absl::Status IrBuilderVisitor::HandleSMul(ArithOp* mul) {
+  if (UseWideLowering(mul->GetType(), type_converter())) {
+    return HandleWideMul(mul, /*is_signed=*/true);
+  }
   return HandleBinaryOpWithOperandConversion(
       mul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
@@ -1971,6 +2154,9 @@ absl::Status IrBuilderVisitor::HandleSMul(ArithOp* mul) {
 }
 
 absl::Status IrBuilderVisitor::HandleUMul(ArithOp* mul) {
+  if (UseWideLowering(mul->GetType(), type_converter())) {
+    return HandleWideMul(mul, /*is_signed=*/false);
+  }
   return HandleBinaryOpWithOperandConversion(
       mul,
       [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
@@ -2111,6 +2297,9 @@ absl::Status IrBuilderVisitor::HandleNe(CompareOp* ne) {
 }
 
 absl::Status IrBuilderVisitor::HandleNeg(UnOp* neg) {
+  if (UseWideLowering(neg->GetType(), type_converter())) {
+    return HandleWideAddSub(neg, /*is_sub=*/true);
+  }
   return HandleUnaryOp(neg, [](llvm::Value* operand, llvm::IRBuilder<>& b) {
     return b.CreateNeg(operand);
   });
@@ -2447,6 +2636,9 @@ absl::Status IrBuilderVisitor::HandleSLt(CompareOp* lt) {
 }
 
 absl::Status IrBuilderVisitor::HandleShll(BinOp* binop) {
+  if (UseWideLowering(binop->GetType(), type_converter())) {
+    return HandleWideShift(binop);
+  }
   return HandleBinaryOp(
       binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return EmitShiftOp(binop, lhs, rhs, &b, type_converter());
@@ -2454,6 +2646,9 @@ absl::Status IrBuilderVisitor::HandleShll(BinOp* binop) {
 }
 
 absl::Status IrBuilderVisitor::HandleShra(BinOp* binop) {
+  if (UseWideLowering(binop->GetType(), type_converter())) {
+    return HandleWideShift(binop);
+  }
   return HandleBinaryOp(
       binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         // Only the LHS is treated as a signed number.
@@ -2465,6 +2660,9 @@ absl::Status IrBuilderVisitor::HandleShra(BinOp* binop) {
 }
 
 absl::Status IrBuilderVisitor::HandleShrl(BinOp* binop) {
+  if (UseWideLowering(binop->GetType(), type_converter())) {
+    return HandleWideShift(binop);
+  }
   return HandleBinaryOp(
       binop, [&](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return EmitShiftOp(binop, lhs, rhs, &b, type_converter());
@@ -2472,6 +2670,9 @@ absl::Status IrBuilderVisitor::HandleShrl(BinOp* binop) {
 }
 
 absl::Status IrBuilderVisitor::HandleSub(BinOp* binop) {
+  if (UseWideLowering(binop->GetType(), type_converter())) {
+    return HandleWideAddSub(binop, /*is_sub=*/true);
+  }
   return HandleBinaryOp(
       binop, [](llvm::Value* lhs, llvm::Value* rhs, llvm::IRBuilder<>& b) {
         return b.CreateSub(lhs, rhs);
@@ -2635,6 +2836,103 @@ absl::Status IrBuilderVisitor::HandleNaryOp(
       build_result(args, node_context.entry_builder()));
 }
 
+absl::Status IrBuilderVisitor::HandleWideAddSub(Node* node, bool is_sub) {
+  bool is_neg = node->operand_count() == 1;
+  XLS_ASSIGN_OR_RETURN(
+      NodeIrContext node_context,
+      NewNodeIrContext(node, is_neg ? std::vector<std::string>{"operand"}
+                                    : std::vector<std::string>{"lhs", "rhs"}));
+  llvm::IRBuilder<>& entry_builder = node_context.entry_builder();
+  llvm::Type* result_type =
+      type_converter()->ConvertToLlvmType(node->GetType());
+  llvm::Value* lhs = is_neg ? nullptr : node_context.GetOperandPtr(0);
+  llvm::Value* rhs = node_context.GetOperandPtr(is_neg ? 0 : 1);
+  llvm::Value* result_buffer = entry_builder.CreateAlloca(result_type);
+
+  auto b = std::make_unique<llvm::IRBuilder<>>(entry_builder.GetInsertBlock());
+  EmitWideAddSub(lhs, rhs, result_buffer,
+                 LimbCount(node->GetType(), type_converter()), is_sub, b);
+  return FinalizeNodeIrContextWithValue(
+      std::move(node_context), b->CreateLoad(result_type, result_buffer),
+      b.get());
+}
+
+absl::Status IrBuilderVisitor::HandleWideMul(ArithOp* mul, bool is_signed) {
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(mul, {"lhs", "rhs"}));
+  llvm::IRBuilder<>& entry_builder = node_context.entry_builder();
+  llvm::Type* result_type = type_converter()->ConvertToLlvmType(mul->GetType());
+
+  // Operands may be narrower or wider than the result so they are converted
+  // to the result type in buffers of their own.
+  std::vector<llvm::Value*> operand_buffers;
+  for (int64_t i = 0; i < 2; ++i) {
+    llvm::Value* operand =
+        MaybeAsSigned(node_context.LoadOperand(i), mul->operand(i)->GetType(),
+                      entry_builder, is_signed);
+    llvm::Value* buffer = entry_builder.CreateAlloca(result_type);
+    entry_builder.CreateStore(
+        entry_builder.CreateIntCast(operand, result_type, is_signed), buffer);
+    operand_buffers.push_back(buffer);
+  }
+  llvm::Value* result_buffer = entry_builder.CreateAlloca(result_type);
+
+  // The low bits of the product are the same for signed and unsigned
+  // multiplication of the sign- or zero-extended operands.
+  auto b = std::make_unique<llvm::IRBuilder<>>(entry_builder.GetInsertBlock());
+  EmitWideMul(operand_buffers[0], operand_buffers[1], result_buffer,
+              LimbCount(mul->GetType(), type_converter()), b);
+  return FinalizeNodeIrContextWithValue(
+      std::move(node_context), b->CreateLoad(result_type, result_buffer),
+      b.get());
+}
+
+absl::Status IrBuilderVisitor::HandleWideShift(BinOp* shift) {
+  XLS_ASSIGN_OR_RETURN(NodeIrContext node_context,
+                       NewNodeIrContext(shift, {"lhs", "rhs"}));
+  llvm::IRBuilder<>& entry_builder = node_context.entry_builder();
+  llvm::Type* result_type =
+      type_converter()->ConvertToLlvmType(shift->GetType());
+  int64_t bit_count = result_type->getIntegerBitWidth();
+
+  llvm::Value* lhs = node_context.LoadOperand(0);
+  if (shift->op() == Op::kShra) {
+    lhs = type_converter()->AsSignedValue(lhs, shift->operand(0)->GetType(),
+                                          entry_builder);
+  }
+
+  // Shift amounts of at least the width of the LLVM type produce the overshift
+  // value. Smaller amounts are handled by the limb-wise shift; bits shifted
+  // into the padding are cleared on finalization.
+  llvm::Value* rhs = node_context.LoadOperand(1);
+  llvm::Type* amount_type = llvm::Type::getIntNTy(
+      ctx(), std::max<int64_t>(rhs->getType()->getIntegerBitWidth(),
+                               kLimbBitCount));
+  rhs = entry_builder.CreateZExt(rhs, amount_type);
+  llvm::Value* is_overshift = entry_builder.CreateICmpUGE(
+      rhs, llvm::ConstantInt::get(amount_type, bit_count));
+  llvm::Value* amount = entry_builder.CreateTrunc(
+      entry_builder.CreateSelect(is_overshift,
+                                 llvm::ConstantInt::get(amount_type, 0), rhs),
+      entry_builder.getInt64Ty());
+  llvm::Value* zero = llvm::ConstantInt::get(result_type, 0);
+  llvm::Value* overshift_value =
+      shift->op() == Op::kShra
+          ? entry_builder.CreateSelect(
+                entry_builder.CreateICmpSLT(lhs, zero),
+                llvm::ConstantInt::getSigned(result_type, -1), zero)
+          : zero;
+  llvm::Value* result_buffer = entry_builder.CreateAlloca(result_type);
+
+  auto b = std::make_unique<llvm::IRBuilder<>>(entry_builder.GetInsertBlock());
+  EmitWideShift(shift->op(), lhs, amount, result_buffer,
+                LimbCount(shift->GetType(), type_converter()), b);
+  llvm::Value* result = b->CreateSelect(
+      is_overshift, overshift_value, b->CreateLoad(result_type, result_buffer));
+  return FinalizeNodeIrContextWithValue(std::move(node_context), result,
+                                        b.get());
+}
+
 absl::Status IrBuilderVisitor::HandleBinaryOpWithOperandConversion(
     Node* node,
     std::function<llvm::Value*(llvm::Value*, llvm::Value*, llvm::IRBuilder<>&)>
@@ -2744,17 +3042,16 @@ absl::StatusOr<llvm::Value*> IrBuilderVisitor::ReceiveFromQueue(
       llvm::FunctionType::get(bool_type, params, /*isVarArg=*/false);
 
   // Call the wrapper to JitChannelQueue::Recv.
-  llvm::Value* queue_address = llvm::ConstantInt::get(
-      llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
-  std::vector<llvm::Value*> args = {
-      builder->CreateIntToPtr(queue_address, ptr_type), output_ptr};
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
-                             absl::bit_cast<uint64_t>(&QueueReceiveWrapper));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  llvm::Value* receive_fired = builder->CreateCall(fn_type, fn_ptr, args);
+  XLS_ASSIGN_OR_RETURN(llvm::Constant * queue_ptr,
+                       GetQueueSymbol(queue, receive->channel_id()));
+  std::vector<llvm::Value*> args = {queue_ptr, output_ptr};
+
+  XLS_ASSIGN_OR_RETURN(
+      llvm::FunctionCallee fn,
+      jit_context_.GetExternalFunction(
+          "__xls_queue_receive", fn_type,
+          absl::bit_cast<uint64_t>(&QueueReceiveWrapper)));
+  llvm::Value* receive_fired = builder->CreateCall(fn, args);
   return receive_fired;
 }
 
@@ -2883,17 +3180,16 @@ absl::Status IrBuilderVisitor::SendToQueue(llvm::IRBuilder<>* builder,
   llvm::FunctionType* fn_type =
       llvm::FunctionType::get(void_type, params, /*isVarArg=*/false);
 
-  llvm::Value* queue_address = llvm::ConstantInt::get(
-      llvm::Type::getInt64Ty(ctx()), absl::bit_cast<uint64_t>(queue));
-  std::vector<llvm::Value*> args = {
-      builder->CreateIntToPtr(queue_address, ptr_type), send_data_ptr};
-
-  llvm::ConstantInt* fn_addr =
-      llvm::ConstantInt::get(llvm::Type::getInt64Ty(ctx()),
-                             absl::bit_cast<uint64_t>(&QueueSendWrapper));
-  llvm::Value* fn_ptr =
-      builder->CreateIntToPtr(fn_addr, llvm::PointerType::get(fn_type, 0));
-  builder->CreateCall(fn_type, fn_ptr, args);
+  XLS_ASSIGN_OR_RETURN(llvm::Constant * queue_ptr,
+                       GetQueueSymbol(queue, send->channel_id()));
+  std::vector<llvm::Value*> args = {queue_ptr, send_data_ptr};
+
+  XLS_ASSIGN_OR_RETURN(
+      llvm::FunctionCallee fn,
+      jit_context_.GetExternalFunction(
+          "__xls_queue_send", fn_type,
+          absl::bit_cast<uint64_t>(&QueueSendWrapper)));
+  builder->CreateCall(fn, args);
   return absl::OkStatus();
 }
 
@@ -2960,12 +3256,65 @@ absl::Status IrBuilderVisitor::HandleSend(Send* send) {
 
 }  // namespace
 
+absl::StatusOr<llvm::FunctionCallee> JitBuilderContext::GetExternalFunction(
+    std::string_view name, llvm::FunctionType* type, uint64_t address) {
+  XLS_RETURN_IF_ERROR(orc_jit_.DefineAbsoluteSymbol(name, address));
+  return module_->getOrInsertFunction(llvm::StringRef(name.data(), name.size()),
+                                      type);
+}
+
+absl::StatusOr<llvm::Constant*> JitBuilderContext::GetExternalObject(
+    std::string_view name, llvm::Type* type, uint64_t address) {
+  XLS_RETURN_IF_ERROR(orc_jit_.DefineAbsoluteSymbol(name, address));
+  return module_->getOrInsertGlobal(llvm::StringRef(name.data(), name.size()),
+                                    type);
+}
+
 llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                         llvm::IRBuilder<>& builder) {
   return builder.CreateMemCpy(tgt, llvm::MaybeAlign(1), src,
                               llvm::MaybeAlign(1), size);
 }
 
+absl::StatusOr<llvm::CallInst*> CallNodeFunction(
+    const NodeFunction& node_function, llvm::ArrayRef<llvm::Value*> args,
+    llvm::IRBuilder<>& builder, JitBuilderContext& jit_context) {
+  JitNodeProfile* profile = jit_context.profile();
+  if (profile == nullptr) {
+    return builder.CreateCall(node_function.function, args);
+  }
+
+  llvm::Function* read_cycle_counter = llvm::Intrinsic::getDeclaration(
+      jit_context.module(), llvm::Intrinsic::readcyclecounter);
+  llvm::Value* start = builder.CreateCall(read_cycle_counter);
+  llvm::CallInst* call = builder.CreateCall(node_function.function, args);
+  llvm::Value* end = builder.CreateCall(read_cycle_counter);
+
+  // The counters live at fixed addresses in the profile so symbols are bound
+  // directly to them.
+  JitNodeProfile::Counters* counters =
+      profile->GetCounters(node_function.node);
+  auto add_to_counter = [&](std::string_view name,
+                            std::atomic<uint64_t>* counter,
+                            llvm::Value* value) -> absl::Status {
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Constant * counter_ptr,
+        jit_context.GetExternalObject(
+            absl::StrFormat("__xls_profile_%d_%s", node_function.node->id(),
+                            name),
+            builder.getInt64Ty(), absl::bit_cast<uint64_t>(counter)));
+    builder.CreateAtomicRMW(llvm::AtomicRMWInst::Add, counter_ptr, value,
+                            llvm::MaybeAlign(sizeof(uint64_t)),
+                            llvm::AtomicOrdering::Monotonic);
+    return absl::OkStatus();
+  };
+  XLS_RETURN_IF_ERROR(add_to_counter("invocations", &counters->invocations,
+                                     builder.getInt64(1)));
+  XLS_RETURN_IF_ERROR(add_to_counter("cycles", &counters->cycles,
+                                     builder.CreateSub(end, start)));
+  return call;
+}
+
 absl::StatusOr<NodeFunction> CreateNodeFunction(
     Node* node, int64_t output_arg_count, JitBuilderContext& jit_context) {
   IrBuilderVisitor visitor(output_arg_count, jit_context);
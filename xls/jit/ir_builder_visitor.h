@@ -14,12 +14,17 @@
 #ifndef XLS_JIT_IR_BUILDER_VISITOR_H_
 #define XLS_JIT_IR_BUILDER_VISITOR_H_
 
+#include <cstdint>
+#include <string_view>
 #include <vector>
 
 #include "absl/status/statusor.h"
 #include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/Instructions.h"
 #include "xls/ir/node.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_profile.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
@@ -30,17 +35,20 @@ namespace xls {
 bool ShouldMaterializeAtUse(Node* node);
 
 // An object gathering necessary information for jitting XLS functions, procs,
-// etc.
+// etc. If `profile` is non-null the generated code records per-node execution
+// counts and cycle counts in it (see JitNodeProfile).
 class JitBuilderContext {
  public:
   explicit JitBuilderContext(
       OrcJit& orc_jit,
-      std::optional<JitChannelQueueManager*> queue_mgr = std::nullopt)
+      std::optional<JitChannelQueueManager*> queue_mgr = std::nullopt,
+      JitNodeProfile* profile = nullptr)
       : module_(orc_jit.NewModule("__module")),
         orc_jit_(orc_jit),
         type_converter_(orc_jit.GetContext(),
                         orc_jit.CreateDataLayout().value()),
-        queue_manager_(queue_mgr) {}
+        queue_manager_(queue_mgr),
+        profile_(profile) {}
 
   llvm::Module* module() const { return module_.get(); }
   llvm::LLVMContext& context() const { return module_->getContext(); }
@@ -55,6 +63,12 @@ class JitBuilderContext {
     return llvm_functions_.at(xls_fn);
   }
 
+  // Returns true if an llvm::Function implementing the given FunctionBase has
+  // been set.
+  bool HasLlvmFunction(FunctionBase* xls_fn) const {
+    return llvm_functions_.contains(xls_fn);
+  }
+
   // Sets the llvm::Function implementing the given FunctionBase to
   // `llvm_function`.
   void SetLlvmFunction(FunctionBase* xls_fn, llvm::Function* llvm_function) {
@@ -65,11 +79,27 @@ class JitBuilderContext {
     return queue_manager_;
   }
 
+  JitNodeProfile* profile() const { return profile_; }
+
+  // Returns a declaration in the module of the external function `name`,
+  // which is bound to `address` when the module is linked (see
+  // OrcJit::DefineAbsoluteSymbol). Process-specific addresses must only be
+  // referenced this way so the object code can be reused across processes.
+  absl::StatusOr<llvm::FunctionCallee> GetExternalFunction(
+      std::string_view name, llvm::FunctionType* type, uint64_t address);
+
+  // As above, but returns a pointer to the external object `name` of type
+  // `type`.
+  absl::StatusOr<llvm::Constant*> GetExternalObject(std::string_view name,
+                                                    llvm::Type* type,
+                                                    uint64_t address);
+
  private:
   std::unique_ptr<llvm::Module> module_;
   OrcJit& orc_jit_;
   LlvmTypeConverter type_converter_;
   std::optional<JitChannelQueueManager*> queue_manager_;
+  JitNodeProfile* profile_;
 
   // Map from FunctionBase to the associated JITed llvm::Function.
   absl::flat_hash_map<FunctionBase*, llvm::Function*> llvm_functions_;
@@ -121,6 +151,14 @@ absl::StatusOr<NodeFunction> CreateNodeFunction(Node* node,
                                                 int64_t output_arg_count,
                                                 JitBuilderContext& jit_context);
 
+// Emits a call of the given node function with arguments `args`. If
+// `jit_context` has a node profile, the call is bracketed by reads of the
+// processor cycle counter and the invocation count and elapsed cycles are added
+// to the counters of the node in the profile.
+absl::StatusOr<llvm::CallInst*> CallNodeFunction(
+    const NodeFunction& node_function, llvm::ArrayRef<llvm::Value*> args,
+    llvm::IRBuilder<>& builder, JitBuilderContext& jit_context);
+
 // Constructs a call to memcpy from `src` to `tgt` of `size` bytes.
 llvm::Value* LlvmMemcpy(llvm::Value* tgt, llvm::Value* src, int64_t size,
                         llvm::IRBuilder<>& builder);
@@ -14,22 +14,27 @@
 
 #include "xls/jit/jit_channel_queue.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/proc.h"
 
 namespace xls {
 namespace {
 
+template <typename QueueT>
 void WriteValueOnQueue(const Value& value, Type* type, JitRuntime& runtime,
-                       ByteQueue& queue) {
+                       QueueT& queue) {
   absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
       queue.element_size());
   runtime.BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
   queue.Write(buffer.data());
 }
 
+template <typename QueueT>
 std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
-                                        ByteQueue& queue) {
+                                        QueueT& queue) {
   std::vector<uint8_t> buffer(queue.element_size());
   if (!queue.Read(buffer.data())) {
     return std::nullopt;
@@ -37,6 +42,47 @@ std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
   return runtime.UnpackBuffer(buffer.data(), type, /*unpoision=*/true);
 }
 
+template <typename QueueT>
+bool PeekValueFromQueue(Type* type, JitRuntime& runtime, QueueT& queue,
+                        absl::FunctionRef<void(const Value&)> fn) {
+  std::vector<uint8_t> buffer(queue.element_size());
+  if (!queue.Peek(buffer.data())) {
+    return false;
+  }
+  fn(runtime.UnpackBuffer(buffer.data(), type, /*unpoision=*/true));
+  return true;
+}
+
+// Returns the streaming channels in the package which are sent on by exactly
+// one proc and received on by exactly one proc.
+absl::flat_hash_set<Channel*> GetSingleSenderSingleReceiverChannels(
+    Package* package) {
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<Proc*>> senders;
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<Proc*>> receivers;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    for (Node* node : proc->nodes()) {
+      if (node->Is<Send>()) {
+        senders[node->As<Send>()->channel_id()].insert(proc.get());
+      } else if (node->Is<Receive>()) {
+        receivers[node->As<Receive>()->channel_id()].insert(proc.get());
+      }
+    }
+  }
+  absl::flat_hash_set<Channel*> result;
+  for (Channel* channel : package->channels()) {
+    if (channel->kind() != ChannelKind::kStreaming) {
+      continue;
+    }
+    auto sender_it = senders.find(channel->id());
+    auto receiver_it = receivers.find(channel->id());
+    if (sender_it != senders.end() && sender_it->second.size() == 1 &&
+        receiver_it != receivers.end() && receiver_it->second.size() == 1) {
+      result.insert(channel);
+    }
+  }
+  return result;
+}
+
 }  // namespace
 
 ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
@@ -83,6 +129,55 @@ void ByteQueue::Resize() {
   }
 }
 
+SpscByteQueue::Segment::Segment(int64_t capacity,
+                                int64_t allocated_element_size)
+    : capacity(capacity),
+      allocated_element_size(allocated_element_size),
+      buffer(std::make_unique<uint8_t[]>(capacity * allocated_element_size)) {
+  XLS_CHECK(IsPowerOfTwo(static_cast<uint64_t>(capacity)));
+}
+
+SpscByteQueue::SpscByteQueue(int64_t channel_element_size)
+    : channel_element_size_(channel_element_size),
+      allocated_element_size_(
+          RoundUpToNearest(channel_element_size,
+                           static_cast<int64_t>(alignof(std::max_align_t)))) {
+  // Special case to handle empty tuples. See ByteQueue.
+  if (allocated_element_size_ == 0) {
+    allocated_element_size_ = 1;
+  }
+  // Size the initial segment to hold at least ByteQueue::kInitBufferSize bytes.
+  int64_t capacity =
+      int64_t{1} << CeilOfLog2(CeilOfRatio(ByteQueue::kInitBufferSize,
+                                           allocated_element_size_));
+  read_segment_ = new Segment(capacity, allocated_element_size_);
+  write_segment_ = read_segment_;
+}
+
+SpscByteQueue::~SpscByteQueue() {
+  Segment* segment = read_segment_;
+  while (segment != nullptr) {
+    Segment* next = segment->next.load(std::memory_order_acquire);
+    delete segment;
+    segment = next;
+  }
+}
+
+SpscByteQueue::Segment* SpscByteQueue::AppendSegment() {
+  Segment* segment =
+      new Segment(write_segment_->capacity * 2, allocated_element_size_);
+  write_segment_->next.store(segment, std::memory_order_release);
+  write_segment_ = segment;
+  return segment;
+}
+
+SpscByteQueue::Segment* SpscByteQueue::AdvanceReadSegment() {
+  Segment* next = read_segment_->next.load(std::memory_order_acquire);
+  delete read_segment_;
+  read_segment_ = next;
+  return next;
+}
+
 int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
@@ -95,6 +190,11 @@ std::optional<Value> ThreadSafeJitChannelQueue::ReadInternal() {
   return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
 }
 
+bool ThreadSafeJitChannelQueue::PeekInternal(
+    absl::FunctionRef<void(const Value&)> fn) {
+  return PeekValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_, fn);
+}
+
 int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
@@ -107,14 +207,43 @@ std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
   return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
 }
 
+bool ThreadUnsafeJitChannelQueue::PeekInternal(
+    absl::FunctionRef<void(const Value&)> fn) {
+  return PeekValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_, fn);
+}
+
+int64_t SpscJitChannelQueue::GetSizeInternal() const {
+  return byte_queue_.size();
+}
+
+void SpscJitChannelQueue::WriteInternal(const Value& value) {
+  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+}
+
+std::optional<Value> SpscJitChannelQueue::ReadInternal() {
+  return ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+}
+
+bool SpscJitChannelQueue::PeekInternal(
+    absl::FunctionRef<void(const Value&)> fn) {
+  return PeekValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_, fn);
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(Package* package) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitRuntime> runtime,
                        JitRuntime::Create());
+  absl::flat_hash_set<Channel*> spsc_channels =
+      GetSingleSenderSingleReceiverChannels(package);
   std::vector<std::unique_ptr<ChannelQueue>> queues;
   for (Channel* channel : package->channels()) {
-    queues.push_back(
-        std::make_unique<ThreadSafeJitChannelQueue>(channel, runtime.get()));
+    if (spsc_channels.contains(channel)) {
+      queues.push_back(
+          std::make_unique<SpscJitChannelQueue>(channel, runtime.get()));
+    } else {
+      queues.push_back(
+          std::make_unique<ThreadSafeJitChannelQueue>(channel, runtime.get()));
+    }
   }
   return absl::WrapUnique(new JitChannelQueueManager(package, std::move(queues),
                                                      std::move(runtime)));
@@ -15,11 +15,14 @@
 #define XLS_JIT_JIT_CHANNEL_QUEUE_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/status/status.h"
@@ -88,6 +91,17 @@ class ByteQueue {
     return true;
   }
 
+  // Copies the element at the front of the queue into `buffer` without
+  // removing it. Returns false if the queue is empty.
+  bool Peek(uint8_t* buffer) const {
+    if (bytes_used_ == 0) {
+      return false;
+    }
+    memcpy(buffer, circular_buffer_.data() + read_index_,
+           channel_element_size_);
+    return true;
+  }
+
   int64_t size() const { return bytes_used_ / allocated_element_size_; }
 
   static constexpr int64_t kInitBufferSize = 128;
@@ -114,20 +128,201 @@ class ByteQueue {
   bool is_single_value_;
 };
 
+// A single-producer single-consumer FIFO queue from which raw bytes may be
+// written or read. Write and Read take no locks and may be called concurrently
+// from one producer thread and one consumer thread respectively. Read is
+// wait-free; Write is wait-free except when it allocates a new segment.
+//
+// The queue is unbounded. Elements are stored in a chain of ring buffers
+// (segments) each with a power-of-two capacity. When the producer fills its
+// segment it allocates a new segment of twice the capacity and links it
+// behind the current one rather than resizing in place; the consumer frees a
+// segment once it has drained it and observed the link. The head and tail
+// indices of each segment live on separate cache lines to avoid false sharing
+// between the producer and consumer.
+class SpscByteQueue {
+ public:
+  explicit SpscByteQueue(int64_t channel_element_size);
+  ~SpscByteQueue();
+
+  SpscByteQueue(const SpscByteQueue&) = delete;
+  SpscByteQueue& operator=(const SpscByteQueue&) = delete;
+
+  int64_t element_size() const { return channel_element_size_; }
+
+  // Writes `element_size()` bytes from `data` on to the queue. Must only be
+  // called by the producer.
+  void Write(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, channel_element_size_);
+#endif
+    Segment* segment = write_segment_;
+    int64_t tail = segment->tail.load(std::memory_order_relaxed);
+    if (tail - segment->cached_head == segment->capacity) {
+      segment->cached_head = segment->head.load(std::memory_order_acquire);
+      if (tail - segment->cached_head == segment->capacity) {
+        segment = AppendSegment();
+        tail = 0;
+      }
+    }
+    memcpy(segment->slot(tail), data, channel_element_size_);
+    segment->tail.store(tail + 1, std::memory_order_release);
+    write_count_.store(write_count_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_release);
+  }
+
+  // Reads `element_size()` bytes from the queue into `buffer`. Returns false if
+  // the queue is empty. Must only be called by the consumer.
+  bool Read(uint8_t* buffer) {
+    const uint8_t* front = Front();
+    if (front == nullptr) {
+      return false;
+    }
+    memcpy(buffer, front, channel_element_size_);
+    Segment* segment = read_segment_;
+    segment->head.store(segment->head.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    read_count_.store(read_count_.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_release);
+    return true;
+  }
+
+  // Copies the element at the front of the queue into `buffer` without
+  // removing it. Returns false if the queue is empty. Must only be called by
+  // the consumer.
+  bool Peek(uint8_t* buffer) {
+    const uint8_t* front = Front();
+    if (front == nullptr) {
+      return false;
+    }
+    memcpy(buffer, front, channel_element_size_);
+    return true;
+  }
+
+  // Returns the number of elements in the queue. The value is exact only if
+  // neither the producer nor consumer is concurrently accessing the queue.
+  int64_t size() const {
+    int64_t read_count = read_count_.load(std::memory_order_acquire);
+    return write_count_.load(std::memory_order_acquire) - read_count;
+  }
+
+ private:
+  struct Segment {
+    Segment(int64_t capacity, int64_t allocated_element_size);
+
+    uint8_t* slot(int64_t index) {
+      return buffer.get() + (index & (capacity - 1)) * allocated_element_size;
+    }
+
+    // Number of elements in the segment. Always a power of two.
+    const int64_t capacity;
+    const int64_t allocated_element_size;
+    std::unique_ptr<uint8_t[]> buffer;
+
+    // Index of the next element to read. Written only by the consumer.
+    alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> head = 0;
+    // Consumer's last observed value of `tail`.
+    int64_t cached_tail = 0;
+
+    // Index of the next element to write. Written only by the producer.
+    alignas(ABSL_CACHELINE_SIZE) std::atomic<int64_t> tail = 0;
+    // Producer's last observed value of `head`.
+    int64_t cached_head = 0;
+    // The segment the producer moved on to after filling this one.
+    std::atomic<Segment*> next = nullptr;
+  };
+
+  // Allocates a new segment behind the current write segment and makes it the
+  // write segment. Called by the producer.
+  Segment* AppendSegment();
+
+  // Frees the current (drained) read segment and makes the next segment the
+  // read segment. Called by the consumer.
+  Segment* AdvanceReadSegment();
+
+  // Returns a pointer to the element at the front of the queue, or nullptr if
+  // the queue is empty. Drained segments are freed along the way so the
+  // returned element is in `read_segment_`. Called by the consumer.
+  const uint8_t* Front() {
+    Segment* segment = read_segment_;
+    int64_t head = segment->head.load(std::memory_order_relaxed);
+    while (head == segment->cached_tail) {
+      segment->cached_tail = segment->tail.load(std::memory_order_acquire);
+      if (head != segment->cached_tail) {
+        break;
+      }
+      if (segment->next.load(std::memory_order_acquire) == nullptr) {
+        return nullptr;
+      }
+      // The producer has moved on to a later segment. Elements written to this
+      // segment before the link was published are visible now so recheck
+      // before discarding it.
+      segment->cached_tail = segment->tail.load(std::memory_order_acquire);
+      if (head != segment->cached_tail) {
+        break;
+      }
+      segment = AdvanceReadSegment();
+      head = 0;
+    }
+    return segment->slot(head);
+  }
+
+  // Size of an element in the channel in units of bytes.
+  int64_t channel_element_size_;
+  // Allocated size of an element in a segment in units of bytes. The elements
+  // are aligned to the largest scalar type.
+  int64_t allocated_element_size_;
+
+  // Owned by the consumer. Segments are owned by the queue and form a chain
+  // from `read_segment_` to `write_segment_`.
+  alignas(ABSL_CACHELINE_SIZE) Segment* read_segment_;
+  std::atomic<int64_t> read_count_ = 0;
+
+  // Owned by the producer.
+  alignas(ABSL_CACHELINE_SIZE) Segment* write_segment_;
+  std::atomic<int64_t> write_count_ = 0;
+};
+
 // Abstract base class for channel queues which may be used by the JIT. These
 // queues support reading and writing raw bytes to the queue rather the just
 // xls::Values.
 class JitChannelQueue : public ChannelQueue {
  public:
   JitChannelQueue(Channel* channel, JitRuntime* jit_runtime)
-      : ChannelQueue(channel), jit_runtime_(jit_runtime) {}
+      : ChannelQueue(channel),
+        jit_runtime_(jit_runtime),
+        element_size_(jit_runtime->GetTypeByteSize(channel->type())) {}
   ~JitChannelQueue() override = default;
 
   virtual void WriteRaw(const uint8_t* data) = 0;
   virtual bool ReadRaw(uint8_t* buffer) = 0;
 
+  // Writes `count` values in LLVM's native format stored consecutively in
+  // `data`, each occupying `element_size()` bytes.
+  virtual void WriteRawBatch(const uint8_t* data, int64_t count) {
+    for (int64_t i = 0; i < count; ++i) {
+      WriteRaw(data + i * element_size_);
+    }
+  }
+
+  // Reads up to `max_count` values in LLVM's native format into consecutive
+  // `element_size()`-byte slots of `buffer`. Returns the number of values
+  // read.
+  virtual int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) {
+    int64_t count = 0;
+    while (count < max_count && ReadRaw(buffer + count * element_size_)) {
+      ++count;
+    }
+    return count;
+  }
+
+  // Returns the size in bytes of a value of the channel in LLVM's native
+  // format.
+  int64_t element_size() const { return element_size_; }
+
  protected:
   JitRuntime* jit_runtime_;
+  int64_t element_size_;
 };
 
 // A thread-safe version of the JIT channel queue. All accesses are guarded by a
@@ -159,12 +354,38 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
     return byte_queue_.Read(buffer);
   }
 
+  void WriteRawBatch(const uint8_t* data, int64_t count) override {
+    absl::MutexLock lock(&mutex_);
+    for (int64_t i = 0; i < count; ++i) {
+      byte_queue_.Write(data + i * element_size_);
+    }
+  }
+
+  int64_t ReadRawBatch(uint8_t* buffer, int64_t max_count) override {
+    absl::MutexLock lock(&mutex_);
+    int64_t count = 0;
+    for (; count < max_count; ++count) {
+      if (generator_.has_value()) {
+        std::optional<Value> generated_value = (*generator_)();
+        if (generated_value.has_value()) {
+          WriteInternal(generated_value.value());
+        }
+      }
+      if (!byte_queue_.Read(buffer + count * element_size_)) {
+        break;
+      }
+    }
+    return count;
+  }
+
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value)
       ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   std::optional<Value> ReadInternal()
       ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  bool PeekInternal(absl::FunctionRef<void(const Value&)> fn)
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
 
   ByteQueue byte_queue_ ABSL_GUARDED_BY(mutex_);
 };
@@ -193,17 +414,58 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value) override;
   std::optional<Value> ReadInternal() override;
+  bool PeekInternal(absl::FunctionRef<void(const Value&)> fn) override;
 
   ByteQueue byte_queue_;
 };
 
+// A JIT channel queue for a streaming channel with exactly one sending proc and
+// one receiving proc. The sender and receiver may run on different threads.
+// WriteRaw and ReadRaw are wait-free and take no lock. The methods of the
+// ChannelQueue base class (Write, Read, etc) count as a producer and consumer
+// access respectively, so the queue may not be written externally while the
+// sending proc is running nor read externally while the receiving proc is
+// running.
+class SpscJitChannelQueue : public JitChannelQueue {
+ public:
+  SpscJitChannelQueue(Channel* channel, JitRuntime* jit_runtime)
+      : JitChannelQueue(channel, jit_runtime),
+        byte_queue_(jit_runtime->GetTypeByteSize(channel->type())) {
+    XLS_CHECK_EQ(channel->kind(), ChannelKind::kStreaming);
+  }
+  ~SpscJitChannelQueue() override = default;
+
+  void WriteRaw(const uint8_t* data) override { byte_queue_.Write(data); }
+  bool ReadRaw(uint8_t* buffer) override {
+    // A generator makes the reader the only producer for the queue as a
+    // generator excludes other writes.
+    if (generator_.has_value()) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+    }
+    return byte_queue_.Read(buffer);
+  }
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+  bool PeekInternal(absl::FunctionRef<void(const Value&)> fn) override;
+
+  SpscByteQueue byte_queue_;
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
   ~JitChannelQueueManager() override = default;
 
-  // Factories which create a queue manager with exclusively ThreadSafe/Unsafe
-  // queues.
+  // Factories which create a queue manager with thread-safe or thread-unsafe
+  // queues. For thread-safe managers, streaming channels which are sent on by
+  // exactly one proc and received on by exactly one proc get a lock-free
+  // SpscJitChannelQueue; all other channels get a ThreadSafeJitChannelQueue.
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
   CreateThreadSafe(Package* package);
   static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
@@ -16,6 +16,7 @@
 
 #include "include/benchmark/benchmark.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/thread.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 #include "xls/jit/jit_channel_queue.h"
@@ -80,6 +81,67 @@ BENCHMARK(BM_QueueWriteThenRead<ThreadUnsafeJitChannelQueue>)
     ->ArgPair(2048, 1)
     ->ArgPair(2048, 128);
 
+BENCHMARK(BM_QueueWriteThenRead<SpscJitChannelQueue>)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 128)
+    ->ArgPair(8, 1)
+    ->ArgPair(8, 128)
+    ->ArgPair(32, 1)
+    ->ArgPair(32, 128)
+    ->ArgPair(2048, 1)
+    ->ArgPair(2048, 128);
+
+// Benchmark evaluating a producer thread writing to the channel concurrently
+// with a consumer thread reading from the channel. This models a pair of
+// streaming procs running on separate threads.
+template <typename QueueT,
+          typename std::enable_if<std::is_base_of_v<JitChannelQueue, QueueT>,
+                                  QueueT>::type* = nullptr>
+static void BM_QueueProducerConsumer(benchmark::State& state) {
+  int64_t element_size_bytes = state.range(0);
+
+  Package package("benchmark");
+  std::unique_ptr<JitRuntime> jit_runtime = JitRuntime::Create().value();
+  Channel* channel =
+      package
+          .CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                  package.GetBitsType(8 * element_size_bytes))
+          .value();
+  QueueT queue(channel, jit_runtime.get());
+
+  int64_t send_count = state.range(1);
+  std::vector<uint8_t> send_buffer(element_size_bytes);
+  std::vector<uint8_t> recv_buffer(element_size_bytes);
+  std::fill(send_buffer.begin(), send_buffer.end(), 42);
+  for (auto _ : state) {
+    Thread producer([&]() {
+      for (int64_t i = 0; i < send_count; ++i) {
+        queue.WriteRaw(send_buffer.data());
+      }
+    });
+    for (int64_t i = 0; i < send_count;) {
+      if (queue.ReadRaw(recv_buffer.data())) {
+        ++i;
+      }
+    }
+    producer.Join();
+  }
+  state.SetItemsProcessed(state.iterations() * send_count);
+}
+
+// The first element in the pair denotes the buffer size written/read from the
+// channel queue. The second element in the pair denotes the number of elements
+// passed from the producer to the consumer.
+BENCHMARK(BM_QueueProducerConsumer<ThreadSafeJitChannelQueue>)
+    ->ArgPair(8, 1 << 16)
+    ->ArgPair(32, 1 << 16)
+    ->ArgPair(2048, 1 << 12);
+
+BENCHMARK(BM_QueueProducerConsumer<SpscJitChannelQueue>)
+    ->ArgPair(8, 1 << 16)
+    ->ArgPair(32, 1 << 16)
+    ->ArgPair(2048, 1 << 12);
+
 }  // namespace
 }  // namespace xls
 
@@ -19,9 +19,11 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/channel_queue_test_base.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 
 namespace xls {
@@ -54,7 +56,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     SpscJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -124,6 +127,36 @@ TYPED_TEST(JitChannelQueueTest, BasicAccess) {
   EXPECT_TRUE(queue.IsEmpty());
 }
 
+TYPED_TEST(JitChannelQueueTest, RawBatchAccess) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  TypeParam queue(channel, GetJitRuntime());
+  ASSERT_EQ(queue.element_size(), 4);
+
+  std::vector<uint32_t> send_values = {1, 2, 3, 4, 5};
+  queue.WriteRawBatch(reinterpret_cast<const uint8_t*>(send_values.data()),
+                      send_values.size());
+  EXPECT_EQ(queue.GetSize(), 5);
+
+  std::optional<Value> peeked;
+  EXPECT_TRUE(queue.Peek([&](const Value& value) { peeked = value; }));
+  EXPECT_EQ(peeked, Value(UBits(1, 32)));
+
+  std::vector<uint32_t> recv_values(4);
+  EXPECT_EQ(queue.ReadRawBatch(reinterpret_cast<uint8_t*>(recv_values.data()),
+                               recv_values.size()),
+            4);
+  EXPECT_EQ(recv_values, std::vector<uint32_t>({1, 2, 3, 4}));
+  EXPECT_EQ(queue.ReadRawBatch(reinterpret_cast<uint8_t*>(recv_values.data()),
+                               recv_values.size()),
+            1);
+  EXPECT_EQ(recv_values[0], 5);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
 TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
   Package package("test");
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -155,5 +188,115 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TYPED_TEST(JitChannelQueueTest, ManyElements) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  TypeParam queue(channel, GetJitRuntime());
+
+  // Interleave writes and reads so the queue wraps around and grows several
+  // times.
+  std::vector<uint8_t> buffer(8);
+  uint64_t next_read = 0;
+  uint64_t next_write = 0;
+  for (int64_t round = 0; round < 10; ++round) {
+    for (int64_t i = 0; i < 100 * (round + 1); ++i) {
+      memcpy(buffer.data(), &next_write, 8);
+      queue.WriteRaw(buffer.data());
+      ++next_write;
+    }
+    for (int64_t i = 0; i < 50 * (round + 1); ++i) {
+      ASSERT_TRUE(queue.ReadRaw(buffer.data()));
+      uint64_t value;
+      memcpy(&value, buffer.data(), 8);
+      EXPECT_EQ(value, next_read);
+      ++next_read;
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+  }
+  while (queue.ReadRaw(buffer.data())) {
+    uint64_t value;
+    memcpy(&value, buffer.data(), 8);
+    EXPECT_EQ(value, next_read);
+    ++next_read;
+  }
+  EXPECT_EQ(next_read, next_write);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(SpscJitChannelQueueTest, ConcurrentProducerAndConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  SpscJitChannelQueue queue(channel, GetJitRuntime());
+
+  constexpr uint64_t kCount = 200000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    uint64_t value;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(JitChannelQueueManagerTest, ThreadSafeManagerUsesSpscQueues) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(R"(
+package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=none, metadata="")
+chan a_b(bits[32], id=1, kind=streaming, ops=send_receive, flow_control=none, metadata="")
+chan b_a(bits[32], id=2, kind=single_value, ops=send_receive, metadata="")
+chan out(bits[32], id=3, kind=streaming, ops=send_only, flow_control=none, metadata="")
+
+proc a(tkn: token, state: (), init={()}) {
+  receive.1: (token, bits[32]) = receive(tkn, channel_id=0)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  send.4: token = send(tuple_index.2, tuple_index.3, channel_id=1)
+  receive.5: (token, bits[32]) = receive(send.4, channel_id=2)
+  tuple_index.6: token = tuple_index(receive.5, index=0)
+  next (tuple_index.6, state)
+}
+
+proc b(tkn: token, state: (), init={()}) {
+  literal.10: bits[32] = literal(value=1)
+  receive.11: (token, bits[32]) = receive(tkn, channel_id=1)
+  tuple_index.12: token = tuple_index(receive.11, index=0)
+  tuple_index.13: bits[32] = tuple_index(receive.11, index=1)
+  send.14: token = send(tuple_index.12, literal.10, channel_id=2)
+  send.15: token = send(send.14, tuple_index.13, channel_id=3)
+  next (send.15, state)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> manager,
+      JitChannelQueueManager::CreateThreadSafe(package.get()));
+  auto queue_for = [&](std::string_view name) -> JitChannelQueue* {
+    return &manager->GetJitQueue(package->GetChannel(name).value());
+  };
+  // Only the internal streaming channel has both a single sender and a single
+  // receiver.
+  EXPECT_NE(dynamic_cast<ThreadSafeJitChannelQueue*>(queue_for("in")),
+            nullptr);
+  EXPECT_NE(dynamic_cast<SpscJitChannelQueue*>(queue_for("a_b")), nullptr);
+  EXPECT_NE(dynamic_cast<ThreadSafeJitChannelQueue*>(queue_for("b_a")),
+            nullptr);
+  EXPECT_NE(dynamic_cast<ThreadSafeJitChannelQueue*>(queue_for("out")),
+            nullptr);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,136 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_node_profile.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_format.h"
+#include "xls/ir/function_base.h"
+
+namespace xls {
+
+JitNodeProfile::Counters* JitNodeProfile::GetCounters(Node* node) {
+  absl::MutexLock lock(&mutex_);
+  auto it = record_index_.find(node);
+  if (it != record_index_.end()) {
+    return &it->second->counters;
+  }
+  Record& record = records_.emplace_back();
+  record.function_base = node->function_base()->name();
+  record.node = node->GetName();
+  record.node_id = node->id();
+  record.op = node->op();
+  record_index_[node] = &record;
+  return &record.counters;
+}
+
+std::vector<JitNodeProfile::NodeEntry> JitNodeProfile::GetNodeHotList() const {
+  std::vector<NodeEntry> entries;
+  {
+    absl::MutexLock lock(&mutex_);
+    entries.reserve(records_.size());
+    for (const Record& record : records_) {
+      entries.push_back(NodeEntry{
+          .function_base = record.function_base,
+          .node = record.node,
+          .node_id = record.node_id,
+          .op = record.op,
+          .invocations =
+              record.counters.invocations.load(std::memory_order_relaxed),
+          .cycles = record.counters.cycles.load(std::memory_order_relaxed)});
+    }
+  }
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const NodeEntry& a, const NodeEntry& b) {
+                     return a.cycles > b.cycles;
+                   });
+  return entries;
+}
+
+std::vector<JitNodeProfile::OpEntry> JitNodeProfile::GetOpHotList() const {
+  absl::flat_hash_map<Op, OpEntry> by_op;
+  for (const NodeEntry& node_entry : GetNodeHotList()) {
+    auto [it, inserted] =
+        by_op.try_emplace(node_entry.op, OpEntry{.op = node_entry.op,
+                                                 .node_count = 0,
+                                                 .invocations = 0,
+                                                 .cycles = 0});
+    it->second.node_count++;
+    it->second.invocations += node_entry.invocations;
+    it->second.cycles += node_entry.cycles;
+  }
+  std::vector<OpEntry> entries;
+  entries.reserve(by_op.size());
+  for (const auto& [op, entry] : by_op) {
+    entries.push_back(entry);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const OpEntry& a, const OpEntry& b) {
+              if (a.cycles != b.cycles) {
+                return a.cycles > b.cycles;
+              }
+              return a.op < b.op;
+            });
+  return entries;
+}
+
+void JitNodeProfile::Reset() {
+  absl::MutexLock lock(&mutex_);
+  for (Record& record : records_) {
+    record.counters.invocations.store(0, std::memory_order_relaxed);
+    record.counters.cycles.store(0, std::memory_order_relaxed);
+  }
+}
+
+std::string JitNodeProfile::ToString(int64_t limit) const {
+  std::vector<NodeEntry> nodes = GetNodeHotList();
+  std::vector<OpEntry> ops = GetOpHotList();
+  uint64_t total_cycles = 0;
+  for (const NodeEntry& entry : nodes) {
+    total_cycles += entry.cycles;
+  }
+  auto percent = [&](uint64_t cycles) {
+    return total_cycles == 0 ? 0.0 : 100.0 * cycles / total_cycles;
+  };
+
+  std::string result = absl::StrFormat(
+      "Hottest nodes (%d profiled, %d total cycles):\n", nodes.size(),
+      total_cycles);
+  absl::StrAppendFormat(&result, "  %7s %14s %12s %10s  %s\n", "%cycles",
+                        "cycles", "invocations", "cyc/inv", "node");
+  for (int64_t i = 0; i < std::min<int64_t>(limit, nodes.size()); ++i) {
+    const NodeEntry& entry = nodes[i];
+    absl::StrAppendFormat(
+        &result, "  %6.2f%% %14d %12d %10.1f  %s::%s (id=%d, %s)\n",
+        percent(entry.cycles), entry.cycles, entry.invocations,
+        entry.invocations == 0
+            ? 0.0
+            : static_cast<double>(entry.cycles) / entry.invocations,
+        entry.function_base, entry.node, entry.node_id, OpToString(entry.op));
+  }
+  absl::StrAppendFormat(&result, "Hottest ops:\n");
+  absl::StrAppendFormat(&result, "  %7s %14s %12s %6s  %s\n", "%cycles",
+                        "cycles", "invocations", "nodes", "op");
+  for (int64_t i = 0; i < std::min<int64_t>(limit, ops.size()); ++i) {
+    const OpEntry& entry = ops[i];
+    absl::StrAppendFormat(&result, "  %6.2f%% %14d %12d %6d  %s\n",
+                          percent(entry.cycles), entry.cycles,
+                          entry.invocations, entry.node_count,
+                          OpToString(entry.op));
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,109 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_NODE_PROFILE_H_
+#define XLS_JIT_JIT_NODE_PROFILE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+
+// Execution profile of the IR nodes evaluated by jitted code. When a profile is
+// passed to the JIT, the call of each node function is bracketed by reads of
+// the processor cycle counter (rdtsc on x86) and the number of invocations and
+// elapsed cycles are accumulated into per-node counters owned by this object.
+// The addresses of the counters are embedded in the generated code so the
+// profile must outlive any code compiled with it.
+//
+// Cycle counts are approximate: LLVM may schedule instructions of neighboring
+// nodes across the counter reads, and the counters include the overhead of the
+// instrumentation itself.
+class JitNodeProfile {
+ public:
+  // Counters updated by the jitted code. Updates are relaxed atomic adds so a
+  // profile may be shared by code running on multiple threads.
+  struct Counters {
+    std::atomic<uint64_t> invocations{0};
+    std::atomic<uint64_t> cycles{0};
+  };
+  static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t));
+
+  // Profile data of a single node.
+  struct NodeEntry {
+    std::string function_base;
+    std::string node;
+    int64_t node_id;
+    Op op;
+    uint64_t invocations;
+    uint64_t cycles;
+  };
+
+  // Profile data aggregated over all nodes of a particular op.
+  struct OpEntry {
+    Op op;
+    int64_t node_count;
+    uint64_t invocations;
+    uint64_t cycles;
+  };
+
+  JitNodeProfile() = default;
+  JitNodeProfile(const JitNodeProfile&) = delete;
+  JitNodeProfile& operator=(const JitNodeProfile&) = delete;
+
+  // Returns the counters associated with `node`, creating them if they do not
+  // exist. The returned pointer is stable for the lifetime of the profile.
+  Counters* GetCounters(Node* node);
+
+  // Returns the profiled nodes sorted by decreasing cycle count.
+  std::vector<NodeEntry> GetNodeHotList() const;
+
+  // Returns the profile aggregated by op sorted by decreasing cycle count.
+  std::vector<OpEntry> GetOpHotList() const;
+
+  // Zeroes all counters.
+  void Reset();
+
+  // Returns a human-readable table of the `limit` hottest nodes followed by the
+  // `limit` hottest ops.
+  std::string ToString(int64_t limit = 20) const;
+
+ private:
+  struct Record {
+    std::string function_base;
+    std::string node;
+    int64_t node_id;
+    Op op;
+    Counters counters;
+  };
+
+  mutable absl::Mutex mutex_;
+  // A deque is used so references to records remain valid as records are
+  // added.
+  std::deque<Record> records_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<Node*, Record*> record_index_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_NODE_PROFILE_H_
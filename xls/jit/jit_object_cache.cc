@@ -0,0 +1,132 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <algorithm>
+#include <system_error>  // NOLINT
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<JitObjectCache>>
+JitObjectCache::Create(const std::filesystem::path& directory,
+                       int64_t max_size_bytes) {
+  XLS_RET_CHECK_GT(max_size_bytes, 0);
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new JitObjectCache(directory, max_size_bytes));
+}
+
+/* static */ std::string JitObjectCache::ComputeKey(
+    std::string_view module_ir, int64_t opt_level,
+    std::string_view target_description) {
+  return ContentDigest(
+      {absl::StrCat(opt_level), target_description, module_ir});
+}
+
+absl::StatusOr<std::optional<std::vector<uint8_t>>> JitObjectCache::Lookup(
+    std::string_view key) {
+  absl::MutexLock lock(&mutex_);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents, cache_.Read(key));
+  if (!contents.has_value()) {
+    ++miss_count_;
+    return std::nullopt;
+  }
+  ++hit_count_;
+  std::filesystem::path path = cache_.EntryPath(key);
+
+  // Touch the entry so eviction is least-recently-used rather than
+  // least-recently-inserted. Failure here is benign.
+  std::error_code ec;
+  std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), ec);
+
+  XLS_VLOG(1) << "JIT object cache hit: " << path;
+  return std::vector<uint8_t>(contents->begin(), contents->end());
+}
+
+absl::Status JitObjectCache::Insert(std::string_view key,
+                                    absl::Span<const uint8_t> object_code) {
+  absl::MutexLock lock(&mutex_);
+  std::filesystem::path path = cache_.EntryPath(key);
+  absl::Status status = cache_.Write(
+      key, std::string_view(reinterpret_cast<const char*>(object_code.data()),
+                            object_code.size()));
+  if (!status.ok()) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to add JIT object cache entry %s: %s",
+                        path.string(), status.message()));
+  }
+  XLS_VLOG(1) << "Added JIT object cache entry: " << path;
+  return Evict();
+}
+
+absl::Status JitObjectCache::Evict() {
+  struct Entry {
+    std::filesystem::path path;
+    std::filesystem::file_time_type last_write_time;
+    int64_t size;
+  };
+  XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> paths,
+                       GetDirectoryEntries(directory_));
+  std::vector<Entry> entries;
+  int64_t total_size = 0;
+  for (const std::filesystem::path& path : paths) {
+    if (path.extension() != kEntrySuffix) {
+      continue;
+    }
+    std::error_code size_ec;
+    std::error_code time_ec;
+    Entry entry{.path = path,
+                .last_write_time = std::filesystem::last_write_time(path,
+                                                                    time_ec),
+                .size = static_cast<int64_t>(
+                    std::filesystem::file_size(path, size_ec))};
+    if (size_ec || time_ec) {
+      // The entry may have been removed concurrently.
+      continue;
+    }
+    total_size += entry.size;
+    entries.push_back(std::move(entry));
+  }
+  if (total_size <= max_size_bytes_) {
+    return absl::OkStatus();
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.last_write_time < b.last_write_time;
+            });
+  for (const Entry& entry : entries) {
+    if (total_size <= max_size_bytes_) {
+      break;
+    }
+    std::error_code ec;
+    if (std::filesystem::remove(entry.path, ec)) {
+      XLS_VLOG(1) << "Evicted JIT object cache entry: " << entry.path;
+      total_size -= entry.size;
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,108 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/file/content_addressed_cache.h"
+
+namespace xls {
+
+// A persistent on-disk cache of object code produced by the JIT. Entries are
+// stored as individual files in a directory and keyed by a hash of everything
+// which determines the generated code: the (unoptimized) LLVM IR of the module,
+// the LLVM optimization level, and the host target description. The total size
+// of the cache directory is kept under a cap by evicting the least recently
+// used entries.
+//
+// The generated code refers to process-specific runtime objects (e.g., trace
+// nodes and channel queues) only through named external symbols which are
+// bound when the object code is linked (see OrcJit::DefineAbsoluteSymbol), so
+// entries are reusable across processes.
+//
+// Thread-safe.
+class JitObjectCache {
+ public:
+  // Creates a cache backed by `directory` (created if it does not exist) whose
+  // total size is kept below `max_size_bytes`.
+  static absl::StatusOr<std::unique_ptr<JitObjectCache>> Create(
+      const std::filesystem::path& directory, int64_t max_size_bytes);
+
+  // Returns the cache key for an LLVM module with the given textual IR
+  // compiled at the given optimization level for the given target.
+  // `target_description` should uniquely identify the code generation target
+  // (e.g., triple, CPU, and feature string).
+  static std::string ComputeKey(std::string_view module_ir, int64_t opt_level,
+                                std::string_view target_description);
+
+  // Returns the object code associated with `key` or std::nullopt if no entry
+  // exists.
+  absl::StatusOr<std::optional<std::vector<uint8_t>>> Lookup(
+      std::string_view key);
+
+  // Adds `object_code` to the cache under `key` and evicts entries as
+  // necessary to keep the cache within its size limit.
+  absl::Status Insert(std::string_view key,
+                      absl::Span<const uint8_t> object_code);
+
+  const std::filesystem::path& directory() const { return directory_; }
+  int64_t max_size_bytes() const { return max_size_bytes_; }
+
+  // Returns the number of lookups which did/did not find an entry.
+  int64_t hit_count() const {
+    absl::MutexLock lock(&mutex_);
+    return hit_count_;
+  }
+  int64_t miss_count() const {
+    absl::MutexLock lock(&mutex_);
+    return miss_count_;
+  }
+
+ private:
+  JitObjectCache(const std::filesystem::path& directory,
+                 int64_t max_size_bytes)
+      : directory_(directory),
+        cache_(directory, kEntrySuffix),
+        max_size_bytes_(max_size_bytes) {}
+
+  static constexpr std::string_view kEntrySuffix = ".o";
+
+  // Removes the least recently used entries until the total size of the cache
+  // is at most `max_size_bytes_`.
+  absl::Status Evict() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  std::filesystem::path directory_;
+  ContentAddressedCache cache_;
+  int64_t max_size_bytes_;
+
+  mutable absl::Mutex mutex_;
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
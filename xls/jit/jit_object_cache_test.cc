@@ -0,0 +1,115 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::Optional;
+
+TEST(JitObjectCacheTest, InsertAndLookup) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path(), 1024));
+
+  std::string key = JitObjectCache::ComputeKey("module", 3, "target");
+  EXPECT_THAT(cache->Lookup(key), IsOkAndHolds(std::nullopt));
+  EXPECT_EQ(cache->miss_count(), 1);
+
+  std::vector<uint8_t> object_code = {1, 2, 3, 4};
+  XLS_ASSERT_OK(cache->Insert(key, object_code));
+  EXPECT_THAT(cache->Lookup(key), IsOkAndHolds(Optional(object_code)));
+  EXPECT_EQ(cache->hit_count(), 1);
+
+  // The cache persists across instances.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> other_cache,
+                           JitObjectCache::Create(temp_dir.path(), 1024));
+  EXPECT_THAT(other_cache->Lookup(key), IsOkAndHolds(Optional(object_code)));
+}
+
+TEST(JitObjectCacheTest, KeyDependsOnAllComponents) {
+  std::string key = JitObjectCache::ComputeKey("module", 3, "target");
+  EXPECT_EQ(key, JitObjectCache::ComputeKey("module", 3, "target"));
+  EXPECT_NE(key, JitObjectCache::ComputeKey("module2", 3, "target"));
+  EXPECT_NE(key, JitObjectCache::ComputeKey("module", 2, "target"));
+  EXPECT_NE(key, JitObjectCache::ComputeKey("module", 3, "target2"));
+  EXPECT_NE(JitObjectCache::ComputeKey("ab", 3, "c"),
+            JitObjectCache::ComputeKey("a", 3, "bc"));
+}
+
+TEST(JitObjectCacheTest, EvictsBeyondSizeLimit) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitObjectCache> cache,
+                           JitObjectCache::Create(temp_dir.path(), 250));
+  std::vector<uint8_t> object_code(100, 42);
+  XLS_ASSERT_OK(cache->Insert("a", object_code));
+  XLS_ASSERT_OK(cache->Insert("b", object_code));
+  XLS_ASSERT_OK(cache->Insert("c", object_code));
+
+  // At most two entries fit and the most recently inserted entry is retained.
+  int64_t present = 0;
+  for (std::string_view key : {"a", "b", "c"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::optional<std::vector<uint8_t>> entry,
+                             cache->Lookup(key));
+    present += entry.has_value() ? 1 : 0;
+  }
+  EXPECT_LE(present, 2);
+  EXPECT_THAT(cache->Lookup("c"), IsOkAndHolds(Optional(object_code)));
+}
+
+TEST(JitObjectCacheTest, FunctionJitReusesCachedObjectCode) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitObjectCache> cache,
+      JitObjectCache::Create(temp_dir.path(), int64_t{1} << 24));
+
+  Package package("my_package");
+  FunctionBuilder fb("add", &package);
+  fb.Add(fb.Param("x", package.GetBitsType(32)),
+         fb.Param("y", package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  std::vector<Value> args = {Value(UBits(40, 32)), Value(UBits(2, 32))};
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        auto jit, FunctionJit::Create(f, /*opt_level=*/3, cache.get()));
+    EXPECT_EQ(cache->hit_count(), 0);
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+    EXPECT_EQ(result.value, Value(UBits(42, 32)));
+  }
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        auto jit, FunctionJit::Create(f, /*opt_level=*/3, cache.get()));
+    EXPECT_EQ(cache->hit_count(), 1);
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+    EXPECT_EQ(result.value, Value(UBits(42, 32)));
+  }
+}
+
+}  // namespace
+}  // namespace xls
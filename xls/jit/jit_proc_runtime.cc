@@ -22,25 +22,67 @@
 #include "xls/ir/proc.h"
 #include "xls/ir/value.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_ram_model.h"
 #include "xls/jit/proc_jit.h"
+#include "xls/jit/tiered_evaluator.h"
 
 namespace xls {
 
+namespace {
+
+// Creates a ProcJit for each proc in `package`.
+absl::StatusOr<std::vector<std::unique_ptr<ProcEvaluator>>> CreateProcJits(
+    Package* package, JitChannelQueueManager* queue_manager,
+    JitObjectCache* object_cache, JitNodeProfile* profile) {
+  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
+  for (auto& proc : package->procs()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ProcJit> proc_jit,
+        ProcJit::Create(proc.get(), &queue_manager->runtime(), queue_manager,
+                        object_cache, profile));
+    proc_jits.push_back(std::move(proc_jit));
+  }
+  return std::move(proc_jits);
+}
+
+// Attaches a JitRamModel for each of `ram_models` to `queue_manager`.
+absl::Status AttachRamModels(absl::Span<const RamModelConfig> ram_models,
+                             JitChannelQueueManager* queue_manager) {
+  for (const RamModelConfig& ram_model : ram_models) {
+    XLS_RETURN_IF_ERROR(
+        JitRamModel::Attach(ram_model, queue_manager).status());
+  }
+  return absl::OkStatus();
+}
+
+// Injects the initial values of the channels in the package into the queues
+// of `runtime`.
+absl::Status InjectChannelInitialValues(Package* package,
+                                        ProcRuntime* runtime) {
+  for (Channel* channel : package->channels()) {
+    ChannelQueue& queue = runtime->queue_manager().GetQueue(channel);
+    XLS_RETURN_IF_ERROR(queue.WriteBatch(channel->initial_values()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
-    Package* package) {
+    Package* package, JitObjectCache* object_cache, JitNodeProfile* profile,
+    absl::Span<const RamModelConfig> ram_models) {
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
                        JitChannelQueueManager::CreateThreadSafe(package));
+  // The ProcJits bind the queues when compiled so the RAM queues must be in
+  // place first.
+  XLS_RETURN_IF_ERROR(AttachRamModels(ram_models, queue_manager.get()));
 
   // Create a ProcJit for each Proc.
-  std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
-  for (auto& proc : package->procs()) {
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcJit> proc_jit,
-                         ProcJit::Create(proc.get(), &queue_manager->runtime(),
-                                         queue_manager.get()));
-    proc_jits.push_back(std::move(proc_jit));
-  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::unique_ptr<ProcEvaluator>> proc_jits,
+      CreateProcJits(package, queue_manager.get(), object_cache, profile));
 
   // Create a runtime.
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
@@ -48,14 +90,51 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
                                                  std::move(queue_manager)));
 
   // Inject initial values into channels.
-  for (Channel* channel : package->channels()) {
-    ChannelQueue& queue = proc_runtime->queue_manager().GetQueue(channel);
-    for (const Value& value : channel->initial_values()) {
-      XLS_RETURN_IF_ERROR(queue.Write(value));
-    }
-  }
+  XLS_RETURN_IF_ERROR(InjectChannelInitialValues(package, proc_runtime.get()));
 
   return std::move(proc_runtime);
 }
 
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+CreateJitThreadedProcRuntime(Package* package, int64_t thread_count,
+                             JitObjectCache* object_cache,
+                             JitNodeProfile* profile,
+                             absl::Span<const RamModelConfig> ram_models) {
+  // The queues are accessed concurrently by the worker threads so they must be
+  // thread-safe.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateThreadSafe(package));
+  XLS_RETURN_IF_ERROR(AttachRamModels(ram_models, queue_manager.get()));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::unique_ptr<ProcEvaluator>> proc_jits,
+      CreateProcJits(package, queue_manager.get(), object_cache, profile));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ThreadedProcRuntime> proc_runtime,
+      ThreadedProcRuntime::Create(package, std::move(proc_jits),
+                                  std::move(queue_manager), thread_count));
+  XLS_RETURN_IF_ERROR(InjectChannelInitialValues(package, proc_runtime.get()));
+  return std::move(proc_runtime);
+}
+
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateTieredSerialProcRuntime(Package* package, JitObjectCache* object_cache) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<JitChannelQueueManager> queue_manager,
+                       JitChannelQueueManager::CreateThreadSafe(package));
+  // Creating the evaluators starts the JIT compilation of all procs
+  // concurrently.
+  std::vector<std::unique_ptr<ProcEvaluator>> evaluators;
+  for (auto& proc : package->procs()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<TieredProcEvaluator> evaluator,
+        TieredProcEvaluator::Create(proc.get(), &queue_manager->runtime(),
+                                    queue_manager.get(), object_cache));
+    evaluators.push_back(std::move(evaluator));
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> proc_runtime,
+                       SerialProcRuntime::Create(package, std::move(evaluators),
+                                                 std::move(queue_manager)));
+  XLS_RETURN_IF_ERROR(InjectChannelInitialValues(package, proc_runtime.get()));
+  return std::move(proc_runtime);
+}
+
 }  // namespace xls
@@ -18,14 +18,43 @@
 #include <memory>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/interpreter/threaded_proc_runtime.h"
 #include "xls/ir/package.h"
+#include "xls/jit/jit_node_profile.h"
+#include "xls/jit/jit_object_cache.h"
+#include "xls/jit/jit_ram_model.h"
 
 namespace xls {
 
 // Create a SerialProcRuntime composed of ProcJits.
+// Creates a SerialProcRuntime for the procs in `package` in which each proc is
+// evaluated with a ProcJit. If `object_cache` is non-null it is used to
+// reuse previously compiled object code. If `profile` is non-null the procs
+// record per-node execution counts and cycles in it (see ProcJit::Create).
+// The channels of each RAM in `ram_models` are served by a JitRamModel.
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
-    Package* package);
+    Package* package, JitObjectCache* object_cache = nullptr,
+    JitNodeProfile* profile = nullptr,
+    absl::Span<const RamModelConfig> ram_models = {});
+
+// Creates a ThreadedProcRuntime for the procs in `package` in which each proc
+// is evaluated with a ProcJit and the procs are ticked concurrently on
+// `thread_count` worker threads (zero means use the number of hardware
+// threads).
+absl::StatusOr<std::unique_ptr<ThreadedProcRuntime>>
+CreateJitThreadedProcRuntime(Package* package, int64_t thread_count = 0,
+                             JitObjectCache* object_cache = nullptr,
+                             JitNodeProfile* profile = nullptr,
+                             absl::Span<const RamModelConfig> ram_models = {});
+
+// Creates a SerialProcRuntime for the procs in `package` in which each proc is
+// evaluated with a TieredProcEvaluator: procs are interpreted while they are
+// JIT-compiled in the background and switch to the JIT once compiled.
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
+CreateTieredSerialProcRuntime(Package* package,
+                              JitObjectCache* object_cache = nullptr);
 
 }  // namespace xls
 
@@ -0,0 +1,448 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/jit/jit_ram_model.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/jit/type_layout.h"
+#include "xls/passes/ram_rewrite_pass.h"
+
+namespace xls {
+
+// Queue of a request channel of a RAM. Requests are performed on the RAM as
+// they are written so the queue is always empty.
+class RamRequestQueue : public JitChannelQueue {
+ public:
+  RamRequestQueue(Channel* channel, JitRuntime* jit_runtime,
+                  JitRamModel* model,
+                  const JitRamModel::RequestLayout* request_layout)
+      : JitChannelQueue(channel, jit_runtime),
+        model_(model),
+        request_layout_(request_layout),
+        type_layout_(jit_runtime->CreateTypeLayout(channel->type())) {}
+
+  void WriteRaw(const uint8_t* data) override {
+    model_->HandleRequest(*request_layout_, data);
+  }
+  bool ReadRaw(uint8_t* buffer) override { return false; }
+
+ protected:
+  int64_t GetSizeInternal() const override { return 0; }
+  void WriteInternal(const Value& value) override {
+    std::vector<uint8_t> buffer(element_size());
+    type_layout_.ValueToNativeLayout(value, buffer.data());
+    model_->HandleRequest(*request_layout_, buffer.data());
+  }
+  std::optional<Value> ReadInternal() override { return std::nullopt; }
+  bool PeekInternal(absl::FunctionRef<void(const Value&)> fn) override {
+    return false;
+  }
+
+ private:
+  JitRamModel* model_;
+  const JitRamModel::RequestLayout* request_layout_;
+  TypeLayout type_layout_;
+};
+
+// Queue of a response channel of a RAM. Only responses which are ready are
+// visible.
+class RamResponseQueue : public JitChannelQueue {
+ public:
+  RamResponseQueue(Channel* channel, JitRuntime* jit_runtime,
+                   JitRamModel* model,
+                   JitRamModel::ResponseChannel* response_channel)
+      : JitChannelQueue(channel, jit_runtime),
+        model_(model),
+        response_channel_(response_channel),
+        type_layout_(jit_runtime->CreateTypeLayout(channel->type())) {}
+
+  void WriteRaw(const uint8_t* data) override {
+    model_->InjectResponse(*response_channel_, data);
+  }
+  bool ReadRaw(uint8_t* buffer) override {
+    return model_->ReadResponse(*response_channel_, buffer);
+  }
+
+ protected:
+  int64_t GetSizeInternal() const override {
+    return model_->ResponseCount(*response_channel_);
+  }
+  void WriteInternal(const Value& value) override {
+    std::vector<uint8_t> buffer(element_size());
+    type_layout_.ValueToNativeLayout(value, buffer.data());
+    model_->InjectResponse(*response_channel_, buffer.data());
+  }
+  std::optional<Value> ReadInternal() override {
+    std::vector<uint8_t> buffer(element_size());
+    if (!model_->ReadResponse(*response_channel_, buffer.data())) {
+      return std::nullopt;
+    }
+    return type_layout_.NativeLayoutToValue(buffer.data());
+  }
+  bool PeekInternal(absl::FunctionRef<void(const Value&)> fn) override {
+    std::vector<uint8_t> buffer(element_size());
+    if (!model_->PeekResponse(*response_channel_, buffer.data())) {
+      return false;
+    }
+    fn(type_layout_.NativeLayoutToValue(buffer.data()));
+    return true;
+  }
+
+ private:
+  JitRamModel* model_;
+  JitRamModel::ResponseChannel* response_channel_;
+  TypeLayout type_layout_;
+};
+
+namespace {
+
+// Returns the type of `channel` if it is a tuple of `size` elements.
+absl::StatusOr<TupleType*> GetTupleType(Channel* channel, int64_t size) {
+  if (!channel->type()->IsTuple() ||
+      channel->type()->AsTupleOrDie()->size() != size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "RAM channel `%s` must be a tuple with %d elements, is %s",
+        channel->name(), size, channel->type()->ToString()));
+  }
+  return channel->type()->AsTupleOrDie();
+}
+
+// Returns the layout of the first leaf of element `index` of `type`, or
+// nullopt if the element has no leaves. Tuples are laid out with their
+// elements embedded so this is also the offset of the element itself.
+std::optional<ElementLayout> GetElementLayout(const TypeLayout& layout,
+                                              TupleType* type, int64_t index) {
+  if (type->element_type(index)->leaf_count() == 0) {
+    return std::nullopt;
+  }
+  return layout.elements()[type->element_leaf_offset(index)];
+}
+
+}  // namespace
+
+absl::StatusOr<JitRamModel*> JitRamModel::Attach(
+    const RamModelConfig& config, JitChannelQueueManager* queue_manager) {
+  if (config.latency < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("RAM latency must be non-negative, is %d",
+                        config.latency));
+  }
+  std::vector<RamLogicalChannel> request_channels;
+  RamLogicalChannel read_response_channel;
+  switch (config.config.kind) {
+    case RamKind::kAbstract:
+      request_channels = {RamLogicalChannel::kAbstractReadReq,
+                          RamLogicalChannel::kAbstractWriteReq};
+      read_response_channel = RamLogicalChannel::kAbstractReadResp;
+      break;
+    case RamKind::k1RW:
+      request_channels = {RamLogicalChannel::k1RWReq};
+      read_response_channel = RamLogicalChannel::k1RWResp;
+      break;
+    case RamKind::k1R1W:
+      request_channels = {RamLogicalChannel::k1R1WReadReq,
+                          RamLogicalChannel::k1R1WWriteReq};
+      read_response_channel = RamLogicalChannel::k1R1WReadResp;
+      break;
+    case RamKind::k2RW:
+      return absl::UnimplementedError("2RW RAMs cannot be modeled");
+  }
+
+  Package* package = queue_manager->package();
+  absl::flat_hash_map<RamLogicalChannel, Channel*> channels;
+  for (const auto& [logical_name, physical_name] :
+       config.channels_logical_to_physical) {
+    XLS_ASSIGN_OR_RETURN(RamLogicalChannel logical_channel,
+                         RamLogicalChannelFromName(logical_name));
+    if (logical_channel != read_response_channel &&
+        logical_channel != RamLogicalChannel::kWriteCompletion &&
+        std::find(request_channels.begin(), request_channels.end(),
+                  logical_channel) == request_channels.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Logical channel %s is not a channel of a %s RAM", logical_name,
+          RamKindToString(config.config.kind)));
+    }
+    XLS_ASSIGN_OR_RETURN(Channel * channel,
+                         package->GetChannel(physical_name));
+    if (channel->kind() != ChannelKind::kStreaming) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "RAM channel `%s` must be a streaming channel", physical_name));
+    }
+    channels[logical_channel] = channel;
+  }
+  for (RamLogicalChannel logical_channel : request_channels) {
+    if (!channels.contains(logical_channel)) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("RAM has no %s channel",
+                          RamLogicalChannelName(logical_channel)));
+    }
+  }
+  if (!channels.contains(read_response_channel)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("RAM has no %s channel",
+                        RamLogicalChannelName(read_response_channel)));
+  }
+
+  JitRuntime* runtime = &queue_manager->runtime();
+  Channel* read_response = channels.at(read_response_channel);
+  XLS_ASSIGN_OR_RETURN(TupleType * read_response_type,
+                       GetTupleType(read_response, 1));
+  Type* data_type = read_response_type->element_type(0);
+  auto model = absl::WrapUnique(
+      new JitRamModel(runtime, data_type, config.config.depth,
+                      config.config.word_partition_size, config.latency));
+  if (config.config.initial_value.has_value()) {
+    const std::vector<Value>& words = *config.config.initial_value;
+    if (words.size() != model->depth_) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "RAM initial value has %d words, expected %d", words.size(),
+          model->depth_));
+    }
+    for (int64_t address = 0; address < words.size(); ++address) {
+      XLS_RETURN_IF_ERROR(model->WriteWord(address, words[address]));
+    }
+  }
+
+  // Masks are only applied to bits words; other words are written whole.
+  std::optional<Type*> write_mask_type;
+  if (model->word_partition_size_.has_value() && data_type->IsBits()) {
+    write_mask_type = package->GetBitsType(
+        *config.config.mask_width(data_type->GetFlatBitCount()));
+  } else {
+    model->word_partition_size_ = std::nullopt;
+  }
+
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (RamLogicalChannel logical_channel : request_channels) {
+    Channel* channel = channels.at(logical_channel);
+    bool is_1rw = logical_channel == RamLogicalChannel::k1RWReq;
+    bool reads = logical_channel == RamLogicalChannel::kAbstractReadReq ||
+                 logical_channel == RamLogicalChannel::k1R1WReadReq;
+    // Read requests are (addr, mask), write requests (addr, data, mask), and
+    // 1RW requests (addr, data, write_mask, read_mask, we, re).
+    XLS_ASSIGN_OR_RETURN(TupleType * type,
+                         GetTupleType(channel, is_1rw ? 6 : (reads ? 2 : 3)));
+    TypeLayout layout = runtime->CreateTypeLayout(type);
+    auto request_layout = std::make_unique<RequestLayout>();
+    request_layout->reads = reads;
+    std::optional<ElementLayout> addr = GetElementLayout(layout, type, 0);
+    if (!type->element_type(0)->IsBits() || !addr.has_value() ||
+        addr->data_size > sizeof(uint64_t)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Address of RAM channel `%s` must be bits of at most 64 bits, is %s",
+          channel->name(), type->element_type(0)->ToString()));
+    }
+    request_layout->addr_offset = addr->offset;
+    request_layout->addr_size = addr->data_size;
+    if (!reads) {
+      if (!type->element_type(1)->IsEqualTo(data_type)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Data of RAM channel `%s` must be %s, is %s", channel->name(),
+            data_type->ToString(), type->element_type(1)->ToString()));
+      }
+      std::optional<ElementLayout> data = GetElementLayout(layout, type, 1);
+      request_layout->data_offset = data.has_value() ? data->offset : 0;
+      if (write_mask_type.has_value()) {
+        if (!type->element_type(2)->IsEqualTo(*write_mask_type)) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Write mask of RAM channel `%s` must be %s, is %s",
+              channel->name(), (*write_mask_type)->ToString(),
+              type->element_type(2)->ToString()));
+        }
+        request_layout->write_mask_offset =
+            GetElementLayout(layout, type, 2)->offset;
+      }
+    }
+    if (is_1rw) {
+      request_layout->we_offset = GetElementLayout(layout, type, 4)->offset;
+      request_layout->re_offset = GetElementLayout(layout, type, 5)->offset;
+    }
+    queues.push_back(std::make_unique<RamRequestQueue>(
+        channel, runtime, model.get(), request_layout.get()));
+    model->request_layouts_.push_back(std::move(request_layout));
+  }
+
+  TypeLayout read_response_layout =
+      runtime->CreateTypeLayout(read_response_type);
+  std::optional<ElementLayout> read_data =
+      GetElementLayout(read_response_layout, read_response_type, 0);
+  model->read_response_ = std::make_unique<ResponseChannel>(
+      read_response_layout.size(),
+      read_data.has_value() ? read_data->offset : 0);
+  queues.push_back(std::make_unique<RamResponseQueue>(
+      read_response, runtime, model.get(), model->read_response_.get()));
+  if (channels.contains(RamLogicalChannel::kWriteCompletion)) {
+    Channel* write_completion =
+        channels.at(RamLogicalChannel::kWriteCompletion);
+    XLS_RETURN_IF_ERROR(GetTupleType(write_completion, 0).status());
+    model->write_completion_ = std::make_unique<ResponseChannel>(
+        runtime->GetTypeByteSize(write_completion->type()), 0);
+    queues.push_back(std::make_unique<RamResponseQueue>(
+        write_completion, runtime, model.get(),
+        model->write_completion_.get()));
+  }
+
+  JitRamModel* model_ptr = model.get();
+  XLS_RETURN_IF_ERROR(
+      queue_manager->AttachModel(std::move(model), std::move(queues)));
+  return model_ptr;
+}
+
+void JitRamModel::HandleRequest(const RequestLayout& layout,
+                                const uint8_t* data) {
+  uint64_t address = 0;
+  std::memcpy(&address, data + layout.addr_offset, layout.addr_size);
+  bool reads = layout.re_offset.has_value() ? (data[*layout.re_offset] & 1)
+                                            : layout.reads;
+  bool writes = layout.we_offset.has_value() ? (data[*layout.we_offset] & 1)
+                                             : !layout.reads;
+
+  absl::MutexLock lock(&mutex_);
+  uint8_t* word = address < depth_ ? memory_.data() + address * word_size_
+                                   : nullptr;
+  if (reads) {
+    ResponseChannel& response = *read_response_;
+    std::fill(response.buffer.begin(), response.buffer.end(), 0);
+    if (word != nullptr) {
+      std::memcpy(response.buffer.data() + response.data_offset, word,
+                  word_size_);
+    }
+    Respond(response);
+  }
+  if (writes) {
+    if (word != nullptr) {
+      if (layout.write_mask_offset.has_value()) {
+        MaskedWrite(data + *layout.data_offset,
+                    data + *layout.write_mask_offset, word);
+      } else {
+        std::memcpy(word, data + *layout.data_offset, word_size_);
+      }
+    }
+    if (write_completion_ != nullptr) {
+      Respond(*write_completion_);
+    }
+  }
+}
+
+void JitRamModel::MaskedWrite(const uint8_t* word, const uint8_t* mask,
+                              uint8_t* dest) const {
+  const int64_t bit_count = data_type_->GetFlatBitCount();
+  for (int64_t bit = 0; bit < bit_count; ++bit) {
+    int64_t partition = bit / *word_partition_size_;
+    if (((mask[partition / 8] >> (partition % 8)) & 1) == 0) {
+      continue;
+    }
+    uint8_t bit_mask = uint8_t{1} << (bit % 8);
+    dest[bit / 8] = (dest[bit / 8] & ~bit_mask) | (word[bit / 8] & bit_mask);
+  }
+}
+
+void JitRamModel::Respond(ResponseChannel& channel) {
+  if (latency_ == 0) {
+    channel.ready.Write(channel.buffer.data());
+    return;
+  }
+  channel.delayed.Write(channel.buffer.data());
+  channel.ready_ticks.push_back(tick_ + latency_);
+}
+
+void JitRamModel::InjectResponse(ResponseChannel& channel,
+                                 const uint8_t* data) {
+  absl::MutexLock lock(&mutex_);
+  channel.ready.Write(data);
+}
+
+bool JitRamModel::ReadResponse(ResponseChannel& channel, uint8_t* buffer) {
+  absl::MutexLock lock(&mutex_);
+  return channel.ready.Read(buffer);
+}
+
+bool JitRamModel::PeekResponse(const ResponseChannel& channel,
+                               uint8_t* buffer) const {
+  absl::MutexLock lock(&mutex_);
+  return channel.ready.Peek(buffer);
+}
+
+int64_t JitRamModel::ResponseCount(const ResponseChannel& channel) const {
+  absl::MutexLock lock(&mutex_);
+  return channel.ready.size();
+}
+
+void JitRamModel::Tick() {
+  absl::MutexLock lock(&mutex_);
+  ++tick_;
+  for (ResponseChannel* channel :
+       {read_response_.get(), write_completion_.get()}) {
+    if (channel == nullptr) {
+      continue;
+    }
+    while (!channel->ready_ticks.empty() &&
+           channel->ready_ticks.front() <= tick_) {
+      channel->delayed.Read(channel->buffer.data());
+      channel->ready.Write(channel->buffer.data());
+      channel->ready_ticks.pop_front();
+    }
+  }
+}
+
+bool JitRamModel::HasPendingResponses() const {
+  absl::MutexLock lock(&mutex_);
+  return !read_response_->ready_ticks.empty() ||
+         (write_completion_ != nullptr &&
+          !write_completion_->ready_ticks.empty());
+}
+
+absl::StatusOr<Value> JitRamModel::ReadWord(int64_t address) const {
+  if (address < 0 || address >= depth_) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Address %d is out of range of RAM of depth %d", address, depth_));
+  }
+  absl::MutexLock lock(&mutex_);
+  return runtime_->UnpackBuffer(memory_.data() + address * word_size_,
+                                data_type_);
+}
+
+absl::Status JitRamModel::WriteWord(int64_t address, const Value& value) {
+  if (address < 0 || address >= depth_) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Address %d is out of range of RAM of depth %d", address, depth_));
+  }
+  if (!ValueConformsToType(value, data_type_)) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Value %s is not of RAM data type %s",
+                        value.ToString(), data_type_->ToString()));
+  }
+  absl::MutexLock lock(&mutex_);
+  runtime_->BlitValueToBuffer(
+      value, data_type_,
+      absl::MakeSpan(memory_.data() + address * word_size_, word_size_));
+  return absl::OkStatus();
+}
+
+}  // namespace xls
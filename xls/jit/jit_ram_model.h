@@ -0,0 +1,166 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef XLS_JIT_JIT_RAM_MODEL_H_
+#define XLS_JIT_JIT_RAM_MODEL_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Configuration of a RAM modeled natively during proc evaluation.
+struct RamModelConfig {
+  // Kind, depth, word partitioning and initial contents of the RAM.
+  RamConfig config;
+  // Mapping of the logical channels of the RAM (e.g. read_req) to the names
+  // of the channels in the package, as in RamRewrite. The write_completion
+  // channel is optional.
+  absl::flat_hash_map<std::string, std::string> channels_logical_to_physical;
+  // Number of ticks of the proc network between a request and its response
+  // becoming available. With a latency of zero a response may be received in
+  // the same tick as its request.
+  int64_t latency = 0;
+};
+
+// A RAM backed by a flat array of words in the native layout of the JIT. The
+// queues of the RAM's channels are replaced by queues which access the array
+// directly when a request is sent, so requests are never queued and responses
+// are copied into the response queues without conversion to xls::Values.
+//
+// Reads return the word at the time of the request. Out-of-bounds reads return
+// zero and out-of-bounds writes are dropped. Write masks are applied for RAMs
+// with a word partition and a bits data type; read masks are ignored. A 1RW
+// request which both reads and writes returns the word before the write.
+class JitRamModel : public ChannelModel {
+ public:
+  // Creates the model described by `config` and attaches it to
+  // `queue_manager`, which owns it. Must be called before any evaluator is
+  // created from `queue_manager`.
+  static absl::StatusOr<JitRamModel*> Attach(
+      const RamModelConfig& config, JitChannelQueueManager* queue_manager);
+
+  void Tick() override;
+  bool HasPendingResponses() const override;
+
+  int64_t depth() const { return depth_; }
+  Type* data_type() const { return data_type_; }
+
+  // Returns or overwrites the word at `address` of the RAM.
+  absl::StatusOr<Value> ReadWord(int64_t address) const;
+  absl::Status WriteWord(int64_t address, const Value& value);
+
+ private:
+  friend class RamRequestQueue;
+  friend class RamResponseQueue;
+
+  // A queue of responses of one of the response channels. Responses with a
+  // non-zero latency wait in `delayed` until the tick in `ready_ticks`.
+  struct ResponseChannel {
+    ResponseChannel(int64_t element_size, int64_t data_offset)
+        : element_size(element_size),
+          data_offset(data_offset),
+          ready(element_size, /*is_single_value=*/false),
+          delayed(element_size, /*is_single_value=*/false),
+          buffer(element_size) {}
+
+    int64_t element_size;
+    // Byte offset of the data word in a response, if the response has one.
+    int64_t data_offset;
+    ByteQueue ready;
+    ByteQueue delayed;
+    std::deque<int64_t> ready_ticks;
+    // Scratch space for assembling a response.
+    std::vector<uint8_t> buffer;
+  };
+
+  // The position of the fields of a request in the native layout of a request
+  // channel.
+  struct RequestLayout {
+    int64_t addr_offset;
+    int64_t addr_size;
+    std::optional<int64_t> data_offset;
+    std::optional<int64_t> write_mask_offset;
+    // Byte offsets of the write and read enables of 1RW requests. Requests of
+    // other channels always read or always write as given by `reads`.
+    std::optional<int64_t> we_offset;
+    std::optional<int64_t> re_offset;
+    bool reads;
+  };
+
+  JitRamModel(JitRuntime* runtime, Type* data_type, int64_t depth,
+              std::optional<int64_t> word_partition_size, int64_t latency)
+      : runtime_(runtime),
+        data_type_(data_type),
+        depth_(depth),
+        word_partition_size_(word_partition_size),
+        latency_(latency),
+        word_size_(runtime->GetTypeByteSize(data_type)),
+        memory_(depth * word_size_) {}
+
+  // Performs the request laid out as `layout` in `data`.
+  void HandleRequest(const RequestLayout& layout, const uint8_t* data);
+
+  // Writes `word` to the RAM word `dest` under the write mask of the request
+  // at `mask`.
+  void MaskedWrite(const uint8_t* word, const uint8_t* mask, uint8_t* dest)
+      const;
+
+  // Enqueues the response assembled in the buffer of `channel`.
+  void Respond(ResponseChannel& channel) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Enqueues `data` as a response of `channel` which is ready immediately.
+  void InjectResponse(ResponseChannel& channel, const uint8_t* data);
+
+  // Reads the next ready response of `channel` into `buffer`. Returns false if
+  // there is none.
+  bool ReadResponse(ResponseChannel& channel, uint8_t* buffer);
+  bool PeekResponse(const ResponseChannel& channel, uint8_t* buffer) const;
+  int64_t ResponseCount(const ResponseChannel& channel) const;
+
+  JitRuntime* runtime_;
+  Type* data_type_;
+  int64_t depth_;
+  std::optional<int64_t> word_partition_size_;
+  int64_t latency_;
+  int64_t word_size_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<uint8_t> memory_ ABSL_GUARDED_BY(mutex_);
+  int64_t tick_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::vector<std::unique_ptr<RequestLayout>> request_layouts_;
+  // Responses to reads, and write completions if the RAM has such a channel.
+  // The contents of the response channels are guarded by `mutex_`.
+  std::unique_ptr<ResponseChannel> read_response_;
+  std::unique_ptr<ResponseChannel> write_completion_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_RAM_MODEL_H_
@@ -0,0 +1,210 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/jit/jit_ram_model.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// A proc which writes 3*i to address i of an abstract RAM, reads it back and
+// sends it to `out`.
+constexpr std::string_view kWriteThenReadIr = R"(
+package test
+
+chan ram_read_req((bits[4], ()), id=0, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+chan ram_read_resp((bits[32]), id=1, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+chan ram_write_req((bits[4], bits[32], ()), id=2, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+chan ram_write_completion((), id=3, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+chan out(bits[32], id=4, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+
+proc main(tkn: token, i: bits[4], init={0}) {
+  empty: () = tuple()
+  index: bits[32] = zero_ext(i, new_bit_count=32)
+  three: bits[32] = literal(value=3)
+  data: bits[32] = umul(index, three)
+  write_req: (bits[4], bits[32], ()) = tuple(i, data, empty)
+  write: token = send(tkn, write_req, channel_id=2)
+  completion: (token, ()) = receive(write, channel_id=3)
+  completion_tkn: token = tuple_index(completion, index=0)
+  read_req: (bits[4], ()) = tuple(i, empty)
+  read: token = send(completion_tkn, read_req, channel_id=0)
+  resp: (token, (bits[32])) = receive(read, channel_id=1)
+  resp_tkn: token = tuple_index(resp, index=0)
+  resp_data: (bits[32]) = tuple_index(resp, index=1)
+  word: bits[32] = tuple_index(resp_data, index=0)
+  send_out: token = send(resp_tkn, word, channel_id=4)
+  one: bits[4] = literal(value=1)
+  next_i: bits[4] = add(i, one)
+  next (send_out, next_i)
+}
+)";
+
+RamModelConfig AbstractRamConfig(int64_t latency) {
+  return RamModelConfig{
+      .config = RamConfig{.kind = RamKind::kAbstract, .depth = 16},
+      .channels_logical_to_physical =
+          {{"abstract_read_req", "ram_read_req"},
+           {"abstract_read_resp", "ram_read_resp"},
+           {"abstract_write_req", "ram_write_req"},
+           {"write_completion", "ram_write_completion"}},
+      .latency = latency};
+}
+
+JitRamModel* GetRamModel(ProcRuntime* runtime) {
+  return dynamic_cast<JitRamModel*>(
+      runtime->queue_manager().models().front().get());
+}
+
+enum class RuntimeKind { kInterpreter, kSerialJit, kThreadedJit };
+
+class JitRamModelTest
+    : public ::testing::TestWithParam<std::tuple<RuntimeKind, int64_t>> {
+ protected:
+  absl::StatusOr<std::unique_ptr<ProcRuntime>> CreateRuntime(
+      Package* package, const RamModelConfig& config) {
+    switch (std::get<0>(GetParam())) {
+      case RuntimeKind::kInterpreter:
+        return CreateInterpreterSerialProcRuntime(package, {config});
+      case RuntimeKind::kSerialJit:
+        return CreateJitSerialProcRuntime(package, /*object_cache=*/nullptr,
+                                          /*profile=*/nullptr, {config});
+      case RuntimeKind::kThreadedJit:
+        return CreateJitThreadedProcRuntime(package, /*thread_count=*/2,
+                                            /*object_cache=*/nullptr,
+                                            /*profile=*/nullptr, {config});
+    }
+  }
+};
+
+TEST_P(JitRamModelTest, WriteThenRead) {
+  const int64_t latency = std::get<1>(GetParam());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kWriteThenReadIr));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcRuntime> runtime,
+      CreateRuntime(package.get(), AbstractRamConfig(latency)));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, package->GetChannel("out"));
+
+  constexpr int64_t kCount = 8;
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t ticks,
+                           runtime->TickUntilOutput({{out, kCount}}));
+  if (latency == 0) {
+    EXPECT_EQ(ticks, kCount);
+  } else {
+    // Each iteration waits on the write completion and the read response.
+    EXPECT_GE(ticks, kCount * 2 * latency);
+  }
+
+  ChannelQueue& out_queue = runtime->queue_manager().GetQueue(out);
+  JitRamModel* ram = GetRamModel(runtime.get());
+  ASSERT_NE(ram, nullptr);
+  for (int64_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(out_queue.Read(), Value(UBits(3 * i, 32)));
+    EXPECT_THAT(ram->ReadWord(i), IsOkAndHolds(Value(UBits(3 * i, 32))));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    JitRamModelTest, JitRamModelTest,
+    ::testing::Combine(::testing::Values(RuntimeKind::kInterpreter,
+                                         RuntimeKind::kSerialJit,
+                                         RuntimeKind::kThreadedJit),
+                       ::testing::Values(0, 2)));
+
+TEST(JitRamModelStandaloneTest, MaskedWriteAndInitialValue) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+chan req((bits[2], bits[32], bits[4], bits[4], bits[1], bits[1]), id=0, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+chan resp((bits[32]), id=1, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadUnsafe(package.get()));
+  std::vector<Value> initial_value(4, Value(UBits(0xffffffff, 32)));
+  RamModelConfig config{
+      .config = RamConfig{.kind = RamKind::k1RW,
+                          .depth = 4,
+                          .word_partition_size = 8,
+                          .initial_value = initial_value},
+      .channels_logical_to_physical = {{"abstract_read_req", "req"},
+                                       {"1rw_resp", "resp"}}};
+  // Channels of other kinds of RAM are rejected.
+  EXPECT_THAT(JitRamModel::Attach(config, queue_manager.get()).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not a channel of a 1rw RAM")));
+  config.channels_logical_to_physical = {{"1rw_req", "req"},
+                                         {"1rw_resp", "resp"}};
+  XLS_ASSERT_OK_AND_ASSIGN(JitRamModel * ram,
+                           JitRamModel::Attach(config, queue_manager.get()));
+
+  // Read and write address 1 in the same request, writing zero to bytes 0
+  // and 2 only. The read sees the word before the write.
+  auto request = [](int64_t addr, int64_t data, int64_t mask, bool we,
+                    bool re) {
+    return Value::Tuple({Value(UBits(addr, 2)), Value(UBits(data, 32)),
+                         Value(UBits(mask, 4)), Value(UBits(0, 4)),
+                         Value(UBits(we, 1)), Value(UBits(re, 1))});
+  };
+  ChannelQueue& req_queue = queue_manager->GetQueue(
+      package->GetChannel("req").value());
+  ChannelQueue& resp_queue = queue_manager->GetQueue(
+      package->GetChannel("resp").value());
+  XLS_ASSERT_OK(req_queue.Write(request(1, 0, 0b0101, true, true)));
+  EXPECT_EQ(resp_queue.Read(),
+            Value::Tuple({Value(UBits(0xffffffff, 32))}));
+  EXPECT_THAT(ram->ReadWord(1), IsOkAndHolds(Value(UBits(0xff00ff00, 32))));
+  EXPECT_THAT(ram->ReadWord(0), IsOkAndHolds(Value(UBits(0xffffffff, 32))));
+
+  // A write-only request produces no response.
+  XLS_ASSERT_OK(req_queue.Write(request(2, 42, 0b1111, true, false)));
+  EXPECT_TRUE(resp_queue.IsEmpty());
+  EXPECT_THAT(ram->ReadWord(2), IsOkAndHolds(Value(UBits(42, 32))));
+  EXPECT_THAT(ram->ReadWord(4), StatusIs(absl::StatusCode::kOutOfRange));
+}
+
+TEST(JitRamModelStandaloneTest, SnapshotUnsupported) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kWriteThenReadIr));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      CreateInterpreterSerialProcRuntime(package.get(),
+                                         {AbstractRamConfig(1)}));
+  EXPECT_THAT(runtime->SaveSnapshot(),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("channel models")));
+}
+
+}  // namespace
+}  // namespace xls
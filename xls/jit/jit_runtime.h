@@ -61,6 +61,12 @@ class JitRuntime {
     return type_converter_->GetTypeByteSize(xls_type);
   }
 
+  // Returns the native layout of the given type.
+  TypeLayout CreateTypeLayout(Type* xls_type) {
+    absl::MutexLock lock(&mutex_);
+    return type_converter_->CreateTypeLayout(xls_type);
+  }
+
  private:
   Value UnpackBufferInternal(const uint8_t* buffer, const Type* result_type,
                              bool unpoison) ABSL_SHARED_LOCKS_REQUIRED(mutex_);
@@ -0,0 +1,67 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_trace_buffer.h"
+
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+namespace xls {
+namespace {
+
+std::atomic<bool> traces_enabled = true;
+
+}  // namespace
+
+/* static */ JitTraceBuffer& JitTraceBuffer::ForCurrentThread() {
+  static thread_local JitTraceBuffer buffer;
+  return buffer;
+}
+
+void JitTraceBuffer::Append(const Trace* trace, const uint8_t* operands,
+                            int64_t size) {
+  int64_t offset = AlignOperandOffset(bytes_.size());
+  records_.push_back(Record{.trace = trace, .offset = offset});
+  bytes_.resize(offset + size);
+  if (size > 0) {
+    std::memcpy(bytes_.data() + offset, operands, size);
+  }
+}
+
+void JitTraceBuffer::Flush(JitRuntime& runtime, InterpreterEvents* events) {
+  if (events != nullptr) {
+    for (const Record& record : records_) {
+      TraceEvent event{.format = record.trace->format()};
+      event.args.reserve(record.trace->args().size());
+      int64_t offset = 0;
+      for (Node* arg : record.trace->args()) {
+        offset = AlignOperandOffset(offset);
+        event.args.push_back(
+            runtime.UnpackBuffer(bytes_.data() + record.offset + offset,
+                                 arg->GetType(), /*unpoison=*/true));
+        offset += runtime.GetTypeByteSize(arg->GetType());
+      }
+      events->RecordTrace(std::move(event));
+    }
+  }
+  records_.clear();
+  bytes_.clear();
+}
+
+void SetJitTracesEnabled(bool enabled) { traces_enabled = enabled; }
+
+bool JitTracesEnabled() { return traces_enabled; }
+
+}  // namespace xls
@@ -0,0 +1,89 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_TRACE_BUFFER_H_
+#define XLS_JIT_JIT_TRACE_BUFFER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "xls/common/math_util.h"
+#include "xls/ir/events.h"
+#include "xls/ir/nodes.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+
+// Binary buffer of the traces emitted by jitted code. The jitted code neither
+// formats trace messages nor builds Values for their operands: each trace
+// appends a record holding the trace node, which identifies the format, and
+// the raw bytes of its operands in the native layout. The records are decoded
+// into TraceEvents once the jitted function has returned, and formatting is
+// left to the recipient of the events (see InterpreterEvents::RecordTrace), so
+// traces read through an EventSink are only formatted if they are inspected.
+//
+// Each thread has its own buffer so concurrent runs of jitted code do not
+// contend; the callers of jitted code flush the buffer of the calling thread
+// after each invocation.
+class JitTraceBuffer {
+ public:
+  // Alignment of each operand within a record.
+  static constexpr int64_t kOperandAlignment = 16;
+
+  // Returns the offset within a record of the operand following one which
+  // ends at `offset`.
+  static int64_t AlignOperandOffset(int64_t offset) {
+    return RoundUpToNearest(offset, kOperandAlignment);
+  }
+
+  // Returns the buffer of the calling thread.
+  static JitTraceBuffer& ForCurrentThread();
+
+  JitTraceBuffer() = default;
+  JitTraceBuffer(const JitTraceBuffer&) = delete;
+  JitTraceBuffer& operator=(const JitTraceBuffer&) = delete;
+
+  // Appends a record of `trace` whose operands, laid out one after the other
+  // at offsets given by AlignOperandOffset, are the `size` bytes at
+  // `operands`.
+  void Append(const Trace* trace, const uint8_t* operands, int64_t size);
+
+  // Returns the number of buffered records.
+  int64_t size() const { return records_.size(); }
+  bool empty() const { return records_.empty(); }
+
+  // Decodes the buffered records in the order they were appended, records them
+  // in `events` (if non-null) and clears the buffer.
+  void Flush(JitRuntime& runtime, InterpreterEvents* events);
+
+ private:
+  struct Record {
+    const Trace* trace;
+    int64_t offset;
+  };
+
+  std::vector<Record> records_;
+  std::vector<uint8_t> bytes_;
+};
+
+// Sets whether trace operations are compiled into jitted code which is built
+// afterwards. Traces are compiled in by default. When disabled, trace nodes
+// only produce their token so instrumented designs run at the speed of
+// uninstrumented ones. Code which has already been built is unaffected.
+void SetJitTracesEnabled(bool enabled);
+bool JitTracesEnabled();
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_TRACE_BUFFER_H_
@@ -0,0 +1,140 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_trace_buffer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/event_sinks.h"
+#include "xls/ir/events.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+constexpr char kTraceIr[] = R"(
+fn f(tkn: token, x: bits[8], t: (bits[4], bits[40])) -> token {
+  pred: bits[1] = literal(value=1)
+  t0: bits[4] = tuple_index(t, index=0)
+  ret trace.1: token = trace(tkn, pred, format="x={} t={} t0={}", data_operands=[x, t, t0])
+}
+)";
+
+std::vector<Value> TraceArgs(int64_t x) {
+  return {Value::Token(), Value(UBits(x, 8)),
+          Value::Tuple({Value(UBits(3, 4)), Value(UBits(x << 32, 40))})};
+}
+
+TEST(JitTraceBufferTest, TracesFormattedAfterRun) {
+  Package package("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(kTraceIr, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           jit->Run(TraceArgs(42)));
+  EXPECT_THAT(result.events.trace_msgs,
+              ElementsAre("x=42 t=(3, 180388626432) t0=3"));
+  EXPECT_TRUE(JitTraceBuffer::ForCurrentThread().empty());
+}
+
+TEST(JitTraceBufferTest, SinkReceivesUnformattedTraces) {
+  Package package("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(kTraceIr, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  RingBufferEventSink sink(/*capacity=*/16);
+  InterpreterEvents events;
+  events.sink = &sink;
+  std::vector<Value> args = TraceArgs(7);
+  std::vector<std::vector<uint8_t>> arg_buffers;
+  std::vector<uint8_t*> arg_ptrs;
+  for (int64_t i = 0; i < args.size(); ++i) {
+    arg_buffers.emplace_back(jit->GetArgTypeSize(i));
+    jit->GetArgTypeLayout(i).ValueToNativeLayout(args[i],
+                                                 arg_buffers.back().data());
+    arg_ptrs.push_back(arg_buffers.back().data());
+  }
+  std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+  XLS_ASSERT_OK(
+      jit->RunWithViews(arg_ptrs, absl::MakeSpan(result_buffer), &events));
+
+  EXPECT_THAT(events.trace_msgs, IsEmpty());
+  ASSERT_EQ(sink.traces().size(), 1);
+  const TraceEvent& event = sink.traces().front();
+  EXPECT_FALSE(event.format.empty());
+  EXPECT_THAT(event.args, ElementsAre(args[1], args[2], Value(UBits(3, 4))));
+  EXPECT_EQ(event.ToString(), "x=7 t=(3, 30064771072) t0=3");
+}
+
+TEST(JitTraceBufferTest, BatchedTracesInOrder) {
+  Package package("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(R"(
+fn f(x: bits[8]) -> bits[8] {
+  tkn: token = after_all()
+  pred: bits[1] = literal(value=1)
+  trace.1: token = trace(tkn, pred, format="x={}", data_operands=[x])
+  ret identity.2: bits[8] = identity(x)
+}
+)",
+                                                 &package));
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+
+  constexpr int64_t kCount = 100;
+  std::vector<uint8_t> xs(kCount * jit->GetArgTypeSize(0));
+  for (int64_t j = 0; j < kCount; ++j) {
+    jit->GetArgTypeLayout(0).ValueToNativeLayout(
+        Value(UBits(j, 8)), xs.data() + j * jit->GetArgTypeSize(0));
+  }
+  std::vector<uint8_t> results(kCount * jit->GetReturnTypeSize());
+  InterpreterEvents events;
+  const uint8_t* args[] = {xs.data()};
+  XLS_ASSERT_OK(
+      jit->RunBatched(args, absl::MakeSpan(results), kCount, &events));
+  ASSERT_EQ(events.trace_msgs.size(), kCount);
+  for (int64_t j = 0; j < kCount; ++j) {
+    EXPECT_EQ(events.trace_msgs[j], absl::StrCat("x=", j));
+  }
+}
+
+TEST(JitTraceBufferTest, TracesCompiledOut) {
+  Package package("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(kTraceIr, &package));
+  SetJitTracesEnabled(false);
+  auto jit = FunctionJit::Create(function);
+  SetJitTracesEnabled(true);
+  XLS_ASSERT_OK(jit.status());
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result,
+                           jit.value()->Run(TraceArgs(42)));
+  EXPECT_EQ(result.value, Value::Token());
+  EXPECT_THAT(result.events.trace_msgs, IsEmpty());
+}
+
+}  // namespace
+}  // namespace xls
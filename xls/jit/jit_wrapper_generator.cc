@@ -354,6 +354,9 @@ std::string GenerateWrapperHeader(const Function& function,
 namespace {{namespace}} {
 
 // JIT execution wrapper for the {{function_name}} XLS IR module.
+// Thread-safe: the function is compiled once by Create() and Run() may be
+// called concurrently from any number of threads, each of which gets its own
+// scratch buffers.
 class {{class_name}} {
  public:
   static absl::StatusOr<std::unique_ptr<{{class_name}}>> Create();
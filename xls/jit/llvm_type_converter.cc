@@ -79,7 +79,8 @@ llvm::Type* LlvmTypeConverter::ConvertToPackedLlvmType(const Type* type) const {
 }
 
 int64_t LlvmTypeConverter::GetPackedTypeByteSize(const Type* type) const {
-  return RoundUpToNearest(PackedLlvmTypeWidth(type), int64_t{8});
+  // The packed width is already a whole number of bytes.
+  return PackedLlvmTypeWidth(type) / 8;
 }
 
 absl::StatusOr<llvm::Constant*> LlvmTypeConverter::ToLlvmConstant(
@@ -14,37 +14,54 @@
 
 #include "xls/jit/orc_jit.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <memory>
 #include <system_error>  // NOLINT
+#include <vector>
 
+#include <unistd.h>
+
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm-c/Target.h"
 #include "llvm/include/llvm/ADT/StringExtras.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
 #include "llvm/include/llvm/Analysis/LoopAnalysisManager.h"
+#include "llvm/include/llvm/Bitcode/BitcodeReader.h"
+#include "llvm/include/llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/include/llvm/ExecutionEngine/JITEventListener.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/ExecutorProcessControl.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/include/llvm/ExecutionEngine/Orc/Mangling.h"
 #include "llvm/include/llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/include/llvm/IR/LegacyPassManager.h"
+#include "llvm/include/llvm/Object/SymbolSize.h"
 #include "llvm/include/llvm/IR/PassManager.h"
 #include "llvm/include/llvm/Passes/OptimizationLevel.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
+#include "llvm/include/llvm/Transforms/Utils/Cloning.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/data_structures/union_find.h"
 
 namespace xls {
 namespace {
@@ -85,9 +102,111 @@ class BadOptLevelError : public llvm::ErrorInfo<BadOptLevelError> {
 
 char BadOptLevelError::ID;
 
+std::atomic<bool> perf_map_enabled = false;
+
+// JIT event listener which appends an entry for each function in loaded object
+// code to /tmp/perf-<pid>.map. This is the format `perf` uses to symbolize
+// code which is not backed by a file on disk. Each line has the form:
+//
+//   <start address hex> <size hex> <symbol name>
+//
+// A single listener is shared by all OrcJit instances in the process.
+class PerfMapListener : public llvm::JITEventListener {
+ public:
+  static PerfMapListener& Get() {
+    static PerfMapListener* listener = new PerfMapListener();
+    return *listener;
+  }
+
+  void notifyObjectLoaded(
+      ObjectKey key, const llvm::object::ObjectFile& object,
+      const llvm::RuntimeDyld::LoadedObjectInfo& info) override {
+    // The debug object has its sections relocated to their load addresses.
+    llvm::object::OwningBinary<llvm::object::ObjectFile> debug_object =
+        info.getObjectForDebug(object);
+    if (debug_object.getBinary() == nullptr) {
+      return;
+    }
+    absl::MutexLock lock(&mutex_);
+    if (file_ == nullptr) {
+      return;
+    }
+    for (const auto& [symbol, size] :
+         llvm::object::computeSymbolSizes(*debug_object.getBinary())) {
+      llvm::Expected<llvm::object::SymbolRef::Type> type = symbol.getType();
+      if (!type) {
+        llvm::consumeError(type.takeError());
+        continue;
+      }
+      if (*type != llvm::object::SymbolRef::ST_Function) {
+        continue;
+      }
+      llvm::Expected<llvm::StringRef> name = symbol.getName();
+      if (!name) {
+        llvm::consumeError(name.takeError());
+        continue;
+      }
+      llvm::Expected<uint64_t> address = symbol.getAddress();
+      if (!address) {
+        llvm::consumeError(address.takeError());
+        continue;
+      }
+      absl::FPrintF(file_, "%x %x %s\n", *address, size, name->str());
+    }
+    std::fflush(file_);
+  }
+
+ private:
+  PerfMapListener() {
+    std::string path = absl::StrFormat("/tmp/perf-%d.map", getpid());
+    file_ = std::fopen(path.c_str(), "a");
+    if (file_ == nullptr) {
+      XLS_LOG(WARNING) << "Unable to open perf map file " << path;
+    }
+  }
+
+  absl::Mutex mutex_;
+  std::FILE* file_ ABSL_GUARDED_BY(mutex_);
+};
+
 }  // namespace
 
-OrcJit::OrcJit(int64_t opt_level, bool emit_object_code)
+class OrcJit::ObjectCacheNotifier : public llvm::ObjectCache {
+ public:
+  explicit ObjectCacheNotifier(OrcJit* jit) : jit_(jit) {}
+
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) override {
+    auto it = jit_->pending_cache_keys_.find(module);
+    if (it == jit_->pending_cache_keys_.end()) {
+      return;
+    }
+    absl::Status status = jit_->object_cache_->Insert(
+        it->second,
+        absl::MakeConstSpan(
+            reinterpret_cast<const uint8_t*>(object.getBufferStart()),
+            object.getBufferSize()));
+    if (!status.ok()) {
+      // The cache is only an optimization so failures are not fatal.
+      XLS_LOG(WARNING) << "Unable to add object code to JIT object cache: "
+                       << status;
+    }
+    jit_->pending_cache_keys_.erase(it);
+  }
+
+  // Lookups are performed in OrcJit::CompileModule before optimization so that
+  // hits skip the optimization pipeline as well as code generation.
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) override {
+    return nullptr;
+  }
+
+ private:
+  OrcJit* jit_;
+};
+
+OrcJit::OrcJit(int64_t opt_level, bool emit_object_code,
+               JitObjectCache* object_cache)
     : context_(std::make_unique<llvm::LLVMContext>()),
       execution_session_(
           std::make_unique<llvm::orc::UnsupportedExecutorProcessControl>()),
@@ -97,7 +216,9 @@ OrcJit::OrcJit(int64_t opt_level, bool emit_object_code)
       dylib_(execution_session_.createBareJITDylib("main")),
       opt_level_(opt_level),
       emit_object_code_(emit_object_code),
-      data_layout_("") {}
+      compile_thread_count_(ThreadPool::Default()->thread_count()),
+      data_layout_(""),
+      object_cache_(object_cache) {}
 
 OrcJit::~OrcJit() {
   if (auto err = execution_session_.endSession()) {
@@ -105,11 +226,11 @@ OrcJit::~OrcJit() {
   }
 }
 
-llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
-    llvm::orc::ThreadSafeModule module,
-    const llvm::orc::MaterializationResponsibility& responsibility) {
-  llvm::Module* bare_module = module.getModuleUnlocked();
+namespace {
 
+// Runs the LLVM optimization pipeline at the given level on `bare_module`.
+llvm::Error OptimizeModule(llvm::Module* bare_module, int64_t opt_level,
+                           llvm::TargetMachine& target_machine) {
   XLS_VLOG(2) << "Unoptimized module IR:";
   XLS_VLOG_LINES(2, DumpLlvmModuleToString(bare_module));
 
@@ -126,7 +247,7 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
   pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
 
   llvm::OptimizationLevel llvm_opt_level;
-  switch (opt_level_) {
+  switch (opt_level) {
     case 0:
       llvm_opt_level = llvm::OptimizationLevel::O0;
       break;
@@ -140,8 +261,7 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
       llvm_opt_level = llvm::OptimizationLevel::O3;
       break;
     default:
-      return llvm::Expected<llvm::orc::ThreadSafeModule>(
-          llvm::Error(std::make_unique<BadOptLevelError>(opt_level_)));
+      return llvm::Error(std::make_unique<BadOptLevelError>(opt_level));
   }
   llvm::ModulePassManager mpm;
   if (llvm_opt_level == llvm::OptimizationLevel::O0) {
@@ -163,8 +283,8 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     llvm::SmallVector<char, 0> stream_buffer;
     llvm::raw_svector_ostream ostream(stream_buffer);
     llvm::legacy::PassManager mpm;
-    if (target_machine_->addPassesToEmitFile(mpm, ostream, nullptr,
-                                             llvm::CGFT_AssemblyFile)) {
+    if (target_machine.addPassesToEmitFile(mpm, ostream, nullptr,
+                                           llvm::CGFT_AssemblyFile)) {
       XLS_VLOG(3) << "Could not create ASM generation pass!";
     }
     mpm.run(*bare_module);
@@ -172,14 +292,108 @@ llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
     XLS_VLOG_LINES(3, std::string(stream_buffer.begin(), stream_buffer.end()));
   }
 
+  return llvm::Error::success();
+}
+
+// Appends to `result` the global values (functions and global variables) which
+// reference `value` either directly or through constant expressions.
+void GetReferencingGlobals(const llvm::Value* value,
+                           std::vector<const llvm::GlobalValue*>& result) {
+  for (const llvm::User* user : value->users()) {
+    if (const auto* inst = llvm::dyn_cast<llvm::Instruction>(user)) {
+      result.push_back(inst->getFunction());
+    } else if (const auto* global = llvm::dyn_cast<llvm::GlobalValue>(user)) {
+      result.push_back(global);
+    } else if (llvm::isa<llvm::Constant>(user)) {
+      GetReferencingGlobals(user, result);
+    }
+  }
+}
+
+// Partitions the global values defined in `module` into at most `max_parts`
+// non-empty sets which can be compiled as separate modules. Global values with
+// local linkage (e.g., the private node functions of a partition function) are
+// placed in the same set as every global value which references them so no
+// module refers to a local symbol defined in another module. Sets are balanced
+// by LLVM instruction count. The result is deterministic for a given module.
+std::vector<absl::flat_hash_set<const llvm::GlobalValue*>> PartitionModule(
+    const llvm::Module& module, int64_t max_parts) {
+  std::vector<const llvm::GlobalValue*> definitions;
+  UnionFind<const llvm::GlobalValue*> groups;
+  for (const llvm::GlobalValue& global : module.global_values()) {
+    if (!global.isDeclaration()) {
+      definitions.push_back(&global);
+      groups.Insert(&global);
+    }
+  }
+  for (const llvm::GlobalValue* global : definitions) {
+    if (!global->hasLocalLinkage()) {
+      continue;
+    }
+    std::vector<const llvm::GlobalValue*> referencing;
+    GetReferencingGlobals(global, referencing);
+    for (const llvm::GlobalValue* user : referencing) {
+      groups.Union(global, user);
+    }
+  }
+
+  // Gather groups in module order along with their sizes.
+  absl::flat_hash_map<const llvm::GlobalValue*, int64_t> group_index;
+  std::vector<std::vector<const llvm::GlobalValue*>> group_members;
+  std::vector<int64_t> group_sizes;
+  for (const llvm::GlobalValue* global : definitions) {
+    auto [it, inserted] =
+        group_index.insert({groups.Find(global), group_members.size()});
+    if (inserted) {
+      group_members.emplace_back();
+      group_sizes.push_back(0);
+    }
+    group_members[it->second].push_back(global);
+    if (const auto* function = llvm::dyn_cast<llvm::Function>(global)) {
+      group_sizes[it->second] += function->getInstructionCount();
+    }
+  }
+
+  // Greedily assign the largest remaining group to the smallest part.
+  std::vector<int64_t> order(group_members.size());
+  for (int64_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return group_sizes[a] > group_sizes[b];
+  });
+  int64_t part_count =
+      std::min(max_parts, static_cast<int64_t>(group_members.size()));
+  std::vector<absl::flat_hash_set<const llvm::GlobalValue*>> parts(part_count);
+  std::vector<int64_t> part_sizes(part_count, 0);
+  for (int64_t group : order) {
+    int64_t part = std::min_element(part_sizes.begin(), part_sizes.end()) -
+                   part_sizes.begin();
+    part_sizes[part] += group_sizes[group];
+    parts[part].insert(group_members[group].begin(),
+                       group_members[group].end());
+  }
+  return parts;
+}
+
+}  // namespace
+
+llvm::Expected<llvm::orc::ThreadSafeModule> OrcJit::Optimizer(
+    llvm::orc::ThreadSafeModule module,
+    const llvm::orc::MaterializationResponsibility& responsibility) {
+  if (llvm::Error error = OptimizeModule(module.getModuleUnlocked(),
+                                         opt_level_, *target_machine_)) {
+    return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(error));
+  }
   return module;
 }
 
-absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(int64_t opt_level,
-                                                       bool emit_object_code) {
+
+absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
+    int64_t opt_level, bool emit_object_code, JitObjectCache* object_cache) {
   absl::call_once(once, OnceInit);
-  std::unique_ptr<OrcJit> jit =
-      absl::WrapUnique(new OrcJit(opt_level, emit_object_code));
+  std::unique_ptr<OrcJit> jit = absl::WrapUnique(
+      new OrcJit(opt_level, emit_object_code, object_cache));
   XLS_RETURN_IF_ERROR(jit->Init());
   return std::move(jit);
 }
@@ -191,6 +405,10 @@ absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(int64_t opt_level,
   return target_machine->createDataLayout();
 }
 
+/* static */ void OrcJit::SetPerfMapEnabled(bool enabled) {
+  perf_map_enabled = enabled;
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
 OrcJit::CreateTargetMachine() {
   auto error_or_target_builder =
@@ -235,7 +453,15 @@ absl::Status OrcJit::Init() {
             data_layout_.getGlobalPrefix())));
   });
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  if (perf_map_enabled) {
+    object_layer_.registerJITEventListener(PerfMapListener::Get());
+  }
+
+  if (object_cache_ != nullptr) {
+    object_cache_notifier_ = std::make_unique<ObjectCacheNotifier>(this);
+  }
+  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(
+      *target_machine_, object_cache_notifier_.get());
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -322,8 +548,150 @@ absl::Status VerifyModule(const llvm::Module& module) {
 
 }  // namespace
 
+std::string OrcJit::GetTargetDescription() const {
+  return absl::StrCat(target_machine_->getTargetTriple().normalize(), ";",
+                      target_machine_->getTargetCPU().str(), ";",
+                      target_machine_->getTargetFeatureString().str());
+}
+
+absl::Status OrcJit::AddObjectCode(absl::Span<const uint8_t> object_code,
+                                   std::string_view name) {
+  llvm::Error error = object_layer_.add(
+      dylib_,
+      llvm::MemoryBuffer::getMemBufferCopy(
+          llvm::StringRef(reinterpret_cast<const char*>(object_code.data()),
+                          object_code.size()),
+          name));
+  if (error) {
+    return absl::UnknownError(absl::StrFormat(
+        "Error loading object code: %s", llvm::toString(std::move(error))));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status OrcJit::CompileModuleInParallel(
+    std::unique_ptr<llvm::Module>&& module) {
+  // A module split into parts to be compiled independently. LLVM contexts are
+  // not thread-safe so each part is serialized to bitcode here and
+  // deserialized in a fresh context on the compiling thread.
+  struct Part {
+    std::string name;
+    llvm::SmallVector<char, 0> bitcode;
+    std::optional<std::string> cache_key;
+    std::vector<uint8_t> object_code;
+    absl::Status status;
+  };
+  std::vector<Part> parts;
+  std::vector<absl::flat_hash_set<const llvm::GlobalValue*>> partition =
+      PartitionModule(*module, compile_thread_count_);
+  for (int64_t i = 0; i < partition.size(); ++i) {
+    llvm::ValueToValueMapTy value_map;
+    std::unique_ptr<llvm::Module> part_module = llvm::CloneModule(
+        *module, value_map, [&](const llvm::GlobalValue* global) {
+          return partition[i].contains(global);
+        });
+    Part& part = parts.emplace_back();
+    part.name = absl::StrFormat("%s.part%d",
+                                module->getModuleIdentifier(), i);
+    part_module->setModuleIdentifier(part.name);
+    if (object_cache_ != nullptr) {
+      part.cache_key =
+          JitObjectCache::ComputeKey(DumpLlvmModuleToString(*part_module),
+                                     opt_level_, GetTargetDescription());
+      XLS_ASSIGN_OR_RETURN(std::optional<std::vector<uint8_t>> object_code,
+                           object_cache_->Lookup(*part.cache_key));
+      if (object_code.has_value()) {
+        part.object_code = *std::move(object_code);
+        continue;
+      }
+    }
+    llvm::raw_svector_ostream ostream(part.bitcode);
+    llvm::WriteBitcodeToFile(*part_module, ostream);
+  }
+  XLS_VLOG(1) << absl::StreamFormat(
+      "Compiling module `%s` (%d instructions) as %d parts",
+      module->getModuleIdentifier(), module->getInstructionCount(),
+      parts.size());
+  module.reset();
+
+  auto compile_part = [this](Part& part) -> absl::Status {
+    llvm::LLVMContext context;
+    llvm::Expected<std::unique_ptr<llvm::Module>> part_module =
+        llvm::parseBitcodeFile(
+            llvm::MemoryBufferRef(
+                llvm::StringRef(part.bitcode.data(), part.bitcode.size()),
+                part.name),
+            context);
+    if (!part_module) {
+      return absl::InternalError(
+          absl::StrFormat("Unable to parse bitcode of module `%s`: %s",
+                          part.name, llvm::toString(part_module.takeError())));
+    }
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> target_machine,
+                         CreateTargetMachine());
+    if (llvm::Error error = OptimizeModule(part_module->get(), opt_level_,
+                                           *target_machine)) {
+      return absl::InternalError(
+          absl::StrFormat("Error optimizing module `%s`: %s", part.name,
+                          llvm::toString(std::move(error))));
+    }
+    llvm::orc::SimpleCompiler compiler(*target_machine);
+    llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object =
+        compiler(**part_module);
+    if (!object) {
+      return absl::InternalError(
+          absl::StrFormat("Error compiling module `%s`: %s", part.name,
+                          llvm::toString(object.takeError())));
+    }
+    part.object_code = std::vector<uint8_t>((*object)->getBufferStart(),
+                                            (*object)->getBufferEnd());
+    return absl::OkStatus();
+  };
+
+  // Parts with a non-empty bitcode missed in the cache and must be compiled.
+  BoundedParallelFor(0, parts.size(), compile_thread_count_, [&](int64_t i) {
+    if (!parts[i].bitcode.empty()) {
+      parts[i].status = compile_part(parts[i]);
+    }
+  });
+
+  for (Part& part : parts) {
+    XLS_RETURN_IF_ERROR(part.status);
+    if (part.cache_key.has_value() && !part.bitcode.empty()) {
+      absl::Status status =
+          object_cache_->Insert(*part.cache_key, part.object_code);
+      if (!status.ok()) {
+        // The cache is only an optimization so failures are not fatal.
+        XLS_LOG(WARNING) << "Unable to add object code to JIT object cache: "
+                         << status;
+      }
+    }
+    XLS_RETURN_IF_ERROR(AddObjectCode(part.object_code, part.name));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
+  if (!emit_object_code_ && compile_thread_count_ > 1 &&
+      module->getInstructionCount() >= parallel_compile_threshold_) {
+    return CompileModuleInParallel(std::move(module));
+  }
+  if (object_cache_ != nullptr) {
+    std::string key = JitObjectCache::ComputeKey(
+        DumpLlvmModuleToString(*module), opt_level_, GetTargetDescription());
+    XLS_ASSIGN_OR_RETURN(std::optional<std::vector<uint8_t>> object_code,
+                         object_cache_->Lookup(key));
+    if (object_code.has_value()) {
+      XLS_RETURN_IF_ERROR(
+          AddObjectCode(*object_code, module->getModuleIdentifier()));
+      if (emit_object_code_) {
+        object_code_ = *std::move(object_code);
+      }
+      return absl::OkStatus();
+    }
+    pending_cache_keys_[module.get()] = std::move(key);
+  }
   llvm::Error error = transform_layer_->add(
       dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
   if (error) {
@@ -333,6 +701,28 @@ absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   return absl::OkStatus();
 }
 
+absl::Status OrcJit::DefineAbsoluteSymbol(std::string_view name,
+                                          uint64_t address) {
+  auto [it, inserted] = absolute_symbols_.try_emplace(name, address);
+  if (!inserted) {
+    XLS_RET_CHECK_EQ(it->second, address)
+        << "Symbol `" << name << "` is already defined at another address";
+    return absl::OkStatus();
+  }
+  llvm::orc::MangleAndInterner mangle(execution_session_, data_layout_);
+  llvm::orc::SymbolMap symbols;
+  symbols[mangle(llvm::StringRef(name.data(), name.size()))] =
+      llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr(address),
+                                   llvm::JITSymbolFlags::Exported);
+  if (llvm::Error error =
+          dylib_.define(llvm::orc::absoluteSymbols(std::move(symbols)))) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to define symbol `%s`: %s", name,
+                        llvm::toString(std::move(error))));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<llvm::orc::ExecutorAddr> OrcJit::LoadSymbol(
     std::string_view function_name) {
   llvm::Expected<llvm::orc::ExecutorSymbolDef> symbol =
@@ -15,8 +15,11 @@
 #ifndef XLS_JIT_ORC_JIT_H_
 #define XLS_JIT_ORC_JIT_H_
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
@@ -24,6 +27,7 @@
 #include "llvm/include/llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/jit/jit_object_cache.h"
 
 namespace xls {
 
@@ -34,9 +38,28 @@ class OrcJit {
   ~OrcJit();
   // Create an LLVM ORC JIT instance which compiles at the given optimization
   // level. If `emit_object_code` is true then `GetObjectCode` can be called
-  // after compilation to get the object code.
+  // after compilation to get the object code. If `object_cache` is non-null,
+  // compiled modules are looked up in (and added to) the cache which allows
+  // skipping LLVM optimization and code generation entirely on a hit.
   static absl::StatusOr<std::unique_ptr<OrcJit>> Create(
-      int64_t opt_level = 3, bool emit_object_code = false);
+      int64_t opt_level = 3, bool emit_object_code = false,
+      JitObjectCache* object_cache = nullptr);
+
+  // Configures parallel compilation. Modules passed to `CompileModule` with at
+  // least `min_instruction_count` LLVM instructions are split along function
+  // boundaries into as many as `thread_count` modules which are optimized and
+  // compiled concurrently on the shared thread pool, each in its own LLVM
+  // context, and then linked together in the JIT. A `thread_count` of one
+  // disables parallel compilation. Parallel compilation is never used when
+  // `emit_object_code` is true as a single object file is produced in that
+  // case. By default `thread_count` is the size of the shared thread pool.
+  static constexpr int64_t kDefaultParallelCompileThreshold = 50000;
+  void SetParallelCompilation(
+      int64_t thread_count,
+      int64_t min_instruction_count = kDefaultParallelCompileThreshold) {
+    compile_thread_count_ = thread_count;
+    parallel_compile_threshold_ = min_instruction_count;
+  }
 
   // Creates and returns a new LLVM module of the given name.
   std::unique_ptr<llvm::Module> NewModule(std::string_view name);
@@ -44,6 +67,14 @@ class OrcJit {
   // Compiles the given LLVM module into the JIT's execution session.
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module);
 
+  // Binds the external symbol `name` to `address` for all code compiled by
+  // this JIT. Generated code must refer to process-specific addresses (runtime
+  // helpers, channel queues, etc.) only through such symbols rather than
+  // embedding them, so that its LLVM IR, and hence its object cache key, is the
+  // same in every process. Defining a name again with the same address is a
+  // no-op.
+  absl::Status DefineAbsoluteSymbol(std::string_view name, uint64_t address);
+
   // Returns the address of the given JIT'ed function.
   absl::StatusOr<llvm::orc::ExecutorAddr> LoadSymbol(
       std::string_view function_name);
@@ -52,19 +83,42 @@ class OrcJit {
   llvm::LLVMContext* GetContext() { return context_.getContext(); }
 
   // Returns the object code which was created in the previous CompileModule
-  // call (if `emit_object_code` is true).
+  // call (if `emit_object_code` is true). Note that object code is only
+  // produced once the compiled symbols are first looked up.
   const std::vector<uint8_t>& GetObjectCode() { return object_code_; }
 
   // Creates and returns a data layout object.
   static absl::StatusOr<llvm::DataLayout> CreateDataLayout();
 
+  // Enables or disables writing the address, size, and name of each jitted
+  // function to /tmp/perf-<pid>.map which allows `perf` to symbolize samples in
+  // jitted code. Only affects OrcJit instances created after the call.
+  static void SetPerfMapEnabled(bool enabled);
+
  private:
-  OrcJit(int64_t opt_level, bool emit_object_code);
+  // Adapts the JitObjectCache to LLVM's ObjectCache interface to capture the
+  // object code of newly compiled modules.
+  class ObjectCacheNotifier;
+
+  OrcJit(int64_t opt_level, bool emit_object_code,
+         JitObjectCache* object_cache);
   absl::Status Init();
 
+  // Returns a string uniquely identifying the code generation target. Used as
+  // part of the object cache key.
+  std::string GetTargetDescription() const;
+
   static absl::StatusOr<std::unique_ptr<llvm::TargetMachine>>
   CreateTargetMachine();
 
+  // Splits `module` into separate modules and compiles them concurrently. See
+  // `SetParallelCompilation`.
+  absl::Status CompileModuleInParallel(std::unique_ptr<llvm::Module>&& module);
+
+  // Adds the given object code to the JIT's execution session.
+  absl::Status AddObjectCode(absl::Span<const uint8_t> object_code,
+                             std::string_view name);
+
   // Method which optimizes the given module. Used within the JIT to form an IR
   // transform layer.
   llvm::Expected<llvm::orc::ThreadSafeModule> Optimizer(
@@ -78,6 +132,8 @@ class OrcJit {
 
   int64_t opt_level_;
   bool emit_object_code_;
+  int64_t compile_thread_count_;
+  int64_t parallel_compile_threshold_ = kDefaultParallelCompileThreshold;
 
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   llvm::DataLayout data_layout_;
@@ -90,6 +146,15 @@ class OrcJit {
   // When `CompileModule` is called and `emit_object_code` is true, this vector
   // will be allocated and filled with the object code of the compiled module.
   std::vector<uint8_t> object_code_;
+
+  // Optional cache of compiled object code (not owned) along with the keys of
+  // modules which missed in the cache and are pending compilation.
+  JitObjectCache* object_cache_;
+  std::unique_ptr<ObjectCacheNotifier> object_cache_notifier_;
+  absl::flat_hash_map<const llvm::Module*, std::string> pending_cache_keys_;
+
+  // Addresses of the symbols defined by `DefineAbsoluteSymbol`.
+  absl::flat_hash_map<std::string, uint64_t> absolute_symbols_;
 };
 
 // Calls the dump method on the given LLVM object and returns the string.
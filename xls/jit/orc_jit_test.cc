@@ -0,0 +1,149 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/orc_jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/base/casts.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "llvm/include/llvm/AsmParser/Parser.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/Support/SourceMgr.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/jit/jit_object_cache.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kFunctionCount = 32;
+
+// Returns LLVM IR for a module with `kFunctionCount` external functions each
+// of which calls a private helper function which reads a private global. The
+// function `top` calls every external function and returns the sum:
+//
+//   top(x) = sum_i (x * i + i)
+std::string MakeModuleIr() {
+  std::string ir;
+  for (int64_t i = 0; i < kFunctionCount; ++i) {
+    absl::StrAppendFormat(&ir, R"(
+@c_%d = private constant i64 %d
+
+define private i64 @g_%d(i64 %%x) {
+  %%c = load i64, ptr @c_%d
+  %%m = mul i64 %%x, %%c
+  %%r = add i64 %%m, %%c
+  ret i64 %%r
+}
+
+define i64 @f_%d(i64 %%x) {
+  %%r = call i64 @g_%d(i64 %%x)
+  ret i64 %%r
+}
+)",
+                          i, i, i, i, i, i);
+  }
+  absl::StrAppend(&ir, "\ndefine i64 @top(i64 %x) {\n  %s_0 = add i64 0, 0\n");
+  for (int64_t i = 0; i < kFunctionCount; ++i) {
+    absl::StrAppendFormat(&ir,
+                          "  %%v_%d = call i64 @f_%d(i64 %%x)\n"
+                          "  %%s_%d = add i64 %%s_%d, %%v_%d\n",
+                          i, i, i + 1, i, i);
+  }
+  absl::StrAppendFormat(&ir, "  ret i64 %%s_%d\n}\n", kFunctionCount);
+  return ir;
+}
+
+int64_t ExpectedTop(int64_t x) {
+  int64_t sum = 0;
+  for (int64_t i = 0; i < kFunctionCount; ++i) {
+    sum += x * i + i;
+  }
+  return sum;
+}
+
+absl::StatusOr<int64_t (*)(int64_t)> CompileTop(OrcJit& jit) {
+  llvm::SMDiagnostic diagnostic;
+  std::unique_ptr<llvm::Module> module =
+      llvm::parseAssemblyString(MakeModuleIr(), diagnostic, *jit.GetContext());
+  XLS_RET_CHECK(module != nullptr) << diagnostic.getMessage().str();
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       OrcJit::CreateDataLayout());
+  module->setDataLayout(data_layout);
+  XLS_RETURN_IF_ERROR(jit.CompileModule(std::move(module)));
+  XLS_ASSIGN_OR_RETURN(llvm::orc::ExecutorAddr address,
+                       jit.LoadSymbol("top"));
+  return absl::bit_cast<int64_t (*)(int64_t)>(address);
+}
+
+TEST(OrcJitTest, SerialCompilation) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OrcJit> jit, OrcJit::Create());
+  jit->SetParallelCompilation(/*thread_count=*/1);
+  XLS_ASSERT_OK_AND_ASSIGN(auto top, CompileTop(*jit));
+  EXPECT_EQ(top(0), ExpectedTop(0));
+  EXPECT_EQ(top(7), ExpectedTop(7));
+}
+
+TEST(OrcJitTest, ParallelCompilation) {
+  for (int64_t thread_count : {2, 4, 64}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OrcJit> jit, OrcJit::Create());
+    jit->SetParallelCompilation(thread_count, /*min_instruction_count=*/0);
+    XLS_ASSERT_OK_AND_ASSIGN(auto top, CompileTop(*jit));
+    EXPECT_EQ(top(0), ExpectedTop(0));
+    EXPECT_EQ(top(-3), ExpectedTop(-3));
+    EXPECT_EQ(top(12345), ExpectedTop(12345));
+  }
+}
+
+TEST(OrcJitTest, ParallelCompilationWithObjectCache) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitObjectCache> cache,
+      JitObjectCache::Create(temp_dir.path(), /*max_size_bytes=*/1 << 24));
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OrcJit> jit,
+                             OrcJit::Create(/*opt_level=*/3,
+                                            /*emit_object_code=*/false,
+                                            cache.get()));
+    jit->SetParallelCompilation(4, /*min_instruction_count=*/0);
+    XLS_ASSERT_OK_AND_ASSIGN(auto top, CompileTop(*jit));
+    EXPECT_EQ(top(5), ExpectedTop(5));
+  }
+  EXPECT_EQ(cache->hit_count(), 0);
+  int64_t misses = cache->miss_count();
+  EXPECT_GT(misses, 1);
+
+  // Every part should hit the second time around.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OrcJit> jit,
+                           OrcJit::Create(/*opt_level=*/3,
+                                          /*emit_object_code=*/false,
+                                          cache.get()));
+  jit->SetParallelCompilation(4, /*min_instruction_count=*/0);
+  XLS_ASSERT_OK_AND_ASSIGN(auto top, CompileTop(*jit));
+  EXPECT_EQ(top(5), ExpectedTop(5));
+  EXPECT_EQ(cache->hit_count(), misses);
+  EXPECT_EQ(cache->miss_count(), misses);
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,30 +14,47 @@
 
 #include "xls/jit/proc_jit.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/jit/jit_trace_buffer.h"
 
 namespace xls {
 
 ProcJitContinuation::ProcJitContinuation(Proc* proc, int64_t temp_buffer_size,
                                          JitRuntime* jit_runtime)
     : proc_(proc), continuation_point_(0), jit_runtime_(jit_runtime) {
-  // Pre-allocate input, output, and temporary buffers.
-  for (Param* param : proc->params()) {
+  // Pre-allocate input, output, and temporary buffers. A param which is its
+  // own next value is never modified so it uses a single buffer as both input
+  // and output.
+  std::vector<Node*> next_values = {proc->NextToken()};
+  next_values.insert(next_values.end(), proc->NextState().begin(),
+                     proc->NextState().end());
+  for (int64_t i = 0; i < proc->params().size(); ++i) {
+    Param* param = proc->param(i);
     int64_t param_size = jit_runtime_->GetTypeByteSize(param->GetType());
-    input_buffers_.push_back(std::vector<uint8_t>(param_size));
-    output_buffers_.push_back(std::vector<uint8_t>(param_size));
-    input_ptrs_.push_back(input_buffers_.back().data());
-    output_ptrs_.push_back(output_buffers_.back().data());
+    bool unmodified = next_values[i] == param;
+    buffer_sizes_.push_back(param_size);
+    buffers_[0].push_back(std::vector<uint8_t>(param_size));
+    buffers_[1].push_back(std::vector<uint8_t>(unmodified ? 0 : param_size));
+    input_ptrs_.push_back(buffers_[0].back().data());
+    output_ptrs_.push_back(unmodified ? input_ptrs_.back()
+                                      : buffers_[1].back().data());
   }
 
   // Write initial state value to the input_buffer.
@@ -46,7 +63,7 @@ ProcJitContinuation::ProcJitContinuation(Proc* proc, int64_t temp_buffer_size,
     int64_t state_index = proc->GetStateParamIndex(state_param).value();
     jit_runtime->BlitValueToBuffer(proc->GetInitValueElement(state_index),
                                    state_param->GetType(),
-                                   absl::MakeSpan(input_buffers_[param_index]));
+                                   GetInputBuffer(param_index));
   }
 
   temp_buffer_.resize(temp_buffer_size);
@@ -63,22 +80,109 @@ std::vector<Value> ProcJitContinuation::GetState() const {
   return state;
 }
 
+absl::Status ProcJitContinuation::SetState(absl::Span<const Value> state) {
+  XLS_RET_CHECK(AtStartOfTick());
+  XLS_RET_CHECK_EQ(state.size(), proc()->GetStateElementCount());
+  for (int64_t i = 0; i < state.size(); ++i) {
+    Param* state_param = proc()->GetStateParam(i);
+    XLS_RET_CHECK(ValueConformsToType(state[i], state_param->GetType()))
+        << absl::StreamFormat("Value %s does not match type %s of state %s",
+                              state[i].ToString(),
+                              state_param->GetType()->ToString(),
+                              state_param->GetName());
+    int64_t param_index = proc()->GetParamIndex(state_param).value();
+    jit_runtime_->BlitValueToBuffer(state[i], state_param->GetType(),
+                                    GetInputBuffer(param_index));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ProcJitContinuation::SaveSnapshot(
+    ProcContinuationSnapshotProto* snapshot) const {
+  SaveStateSnapshot(proc(), GetState(), snapshot);
+  snapshot->clear_tick_progress();
+  if (AtStartOfTick()) {
+    return absl::OkStatus();
+  }
+  // Mid-tick the values computed so far live in the buffers, so save them
+  // verbatim.
+  ProcJitTickProto* progress = snapshot->mutable_jit();
+  progress->set_continuation_point(continuation_point_);
+  for (int64_t i = 0; i < buffer_sizes_.size(); ++i) {
+    progress->add_input_buffers(input_ptrs_[i], buffer_sizes_[i]);
+    progress->add_output_buffers(output_ptrs_[i], buffer_sizes_[i]);
+  }
+  progress->set_temp_buffer(temp_buffer_.data(), temp_buffer_.size());
+  return absl::OkStatus();
+}
+
+absl::Status ProcJitContinuation::RestoreSnapshot(
+    const ProcContinuationSnapshotProto& snapshot) {
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> state,
+                       RestoreStateSnapshot(proc(), snapshot));
+  switch (snapshot.tick_progress_case()) {
+    case ProcContinuationSnapshotProto::TICK_PROGRESS_NOT_SET:
+      continuation_point_ = 0;
+      return SetState(state);
+    case ProcContinuationSnapshotProto::kJit:
+      break;
+    default:
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Snapshot of proc `%s` was taken in the middle of a tick by a "
+          "different evaluator",
+          proc()->name()));
+  }
+
+  const ProcJitTickProto& progress = snapshot.jit();
+  auto restore_buffer = [&](const std::string& bytes,
+                            absl::Span<uint8_t> buffer) -> absl::Status {
+    if (bytes.size() != buffer.size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Snapshot of proc `%s` does not match the layout of the JIT",
+          proc()->name()));
+    }
+    std::copy(bytes.begin(), bytes.end(), buffer.begin());
+    return absl::OkStatus();
+  };
+  if (progress.input_buffers_size() != buffer_sizes_.size() ||
+      progress.output_buffers_size() != buffer_sizes_.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Snapshot of proc `%s` does not match the layout of the JIT",
+        proc()->name()));
+  }
+  for (int64_t i = 0; i < buffer_sizes_.size(); ++i) {
+    XLS_RETURN_IF_ERROR(
+        restore_buffer(progress.input_buffers(i), GetInputBuffer(i)));
+    XLS_RETURN_IF_ERROR(restore_buffer(
+        progress.output_buffers(i),
+        absl::MakeSpan(output_ptrs_[i], buffer_sizes_[i])));
+  }
+  XLS_RETURN_IF_ERROR(
+      restore_buffer(progress.temp_buffer(), absl::MakeSpan(temp_buffer_)));
+  continuation_point_ = progress.continuation_point();
+  return absl::OkStatus();
+}
+
 void ProcJitContinuation::NextTick() {
   continuation_point_ = 0;
-  {
-    using std::swap;
-    swap(input_buffers_, output_buffers_);
-    swap(input_ptrs_, output_ptrs_);
-  }
+  // The next state values become the inputs of the next tick. Only the
+  // pointers are swapped; no state is copied.
+  std::swap(input_ptrs_, output_ptrs_);
 }
 
 absl::StatusOr<std::unique_ptr<ProcJit>> ProcJit::Create(
-    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr) {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+    Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+    JitObjectCache* object_cache, JitNodeProfile* profile) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<OrcJit> orc_jit,
+      OrcJit::Create(/*opt_level=*/3,
+                     /*emit_object_code=*/false,
+                     profile == nullptr ? object_cache : nullptr));
   auto jit =
       absl::WrapUnique(new ProcJit(proc, jit_runtime, std::move(orc_jit)));
-  XLS_ASSIGN_OR_RETURN(jit->jitted_function_base_,
-                       BuildProcFunction(proc, queue_mgr, jit->GetOrcJit()));
+  XLS_ASSIGN_OR_RETURN(
+      jit->jitted_function_base_,
+      BuildProcFunction(proc, queue_mgr, jit->GetOrcJit(), profile));
   return jit;
 }
 
@@ -99,6 +203,7 @@ absl::StatusOr<TickResult> ProcJit::Tick(ProcContinuation& continuation) const {
       cont->GetInputBuffers().data(), cont->GetOutputBuffers().data(),
       cont->GetTempBuffer().data(), &cont->GetEvents(),
       /*user_data=*/nullptr, runtime(), cont->GetContinuationPoint());
+  JitTraceBuffer::ForCurrentThread().Flush(*runtime(), &cont->GetEvents());
 
   if (next_continuation_point == 0) {
     // The proc successfully completed its tick.
@@ -15,6 +15,11 @@
 #ifndef XLS_JIT_PROC_JIT_H_
 #define XLS_JIT_PROC_JIT_H_
 
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
@@ -25,6 +30,8 @@
 #include "xls/ir/value.h"
 #include "xls/jit/function_base_jit.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_profile.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
@@ -45,9 +52,17 @@ class ProcJitContinuation : public ProcContinuation {
   ~ProcJitContinuation() override = default;
 
   std::vector<Value> GetState() const override;
+
+  // Sets the proc state to `state`. Must only be called at the start of a tick.
+  absl::Status SetState(absl::Span<const Value> state);
+
   const InterpreterEvents& GetEvents() const override { return events_; }
   InterpreterEvents& GetEvents() override { return events_; }
   bool AtStartOfTick() const override { return continuation_point_ == 0; }
+  absl::Status SaveSnapshot(
+      ProcContinuationSnapshotProto* snapshot) const override;
+  absl::Status RestoreSnapshot(
+      const ProcContinuationSnapshotProto& snapshot) override;
 
   // Get/Set the point at which execution will resume in the proc in the next
   // call to Tick.
@@ -75,12 +90,23 @@ class ProcJitContinuation : public ProcContinuation {
 
   InterpreterEvents events_;
 
-  // Buffers to hold inputs, outputs, and temporary storage. This is allocated
-  // once and then re-used with each invocation of Run. Not thread-safe.
-  std::vector<std::vector<uint8_t>> input_buffers_;
-  std::vector<std::vector<uint8_t>> output_buffers_;
+  // Returns the input buffer of the param with the given index.
+  absl::Span<uint8_t> GetInputBuffer(int64_t param_index) {
+    return absl::MakeSpan(input_ptrs_[param_index],
+                          buffer_sizes_[param_index]);
+  }
 
-  // Raw pointers to the buffers held in `input_buffers_` and `output_buffers_`.
+  // Two sets of buffers, each with one buffer per proc param, and temporary
+  // storage. This is allocated once and then re-used with each invocation of
+  // Run. Not thread-safe. In each tick one set holds the inputs and the other
+  // receives the next values; the sets trade roles at the end of the tick by
+  // swapping `input_ptrs_` and `output_ptrs_`. A param which is its own next
+  // value uses its buffer in `buffers_[0]` as both input and output and has an
+  // empty buffer in `buffers_[1]`.
+  std::array<std::vector<std::vector<uint8_t>>, 2> buffers_;
+  std::vector<int64_t> buffer_sizes_;
+
+  // Raw pointers to the input and output buffers held in `buffers_`.
   std::vector<uint8_t*> input_ptrs_;
   std::vector<uint8_t*> output_ptrs_;
   std::vector<uint8_t> temp_buffer_;
@@ -91,9 +117,15 @@ class ProcJitContinuation : public ProcContinuation {
 class ProcJit : public ProcEvaluator {
  public:
   // Returns an object containing a host-compiled version of the specified XLS
-  // proc.
+  // proc. If `object_cache` is non-null, previously compiled object code for an
+  // identical proc is reused from the cache. If `profile` is non-null the
+  // generated code records per-node execution counts and cycles in it; the
+  // object cache is not used in this case as the code embeds the addresses of
+  // the profile counters.
   static absl::StatusOr<std::unique_ptr<ProcJit>> Create(
-      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr);
+      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+      JitObjectCache* object_cache = nullptr,
+      JitNodeProfile* profile = nullptr);
 
   ~ProcJit() override = default;
 
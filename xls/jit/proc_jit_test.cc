@@ -16,18 +16,26 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/proc.h"
 #include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_node_profile.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/orc_jit.h"
 
 namespace xls {
 namespace {
 
+using status_testing::IsOkAndHolds;
+
 JitRuntime* GetJitRuntime() {
   static auto jit_runtime =
       std::make_unique<JitRuntime>(OrcJit::CreateDataLayout().value());
@@ -50,5 +58,156 @@ INSTANTIATE_TEST_SUITE_P(
           return JitChannelQueueManager::CreateThreadSafe(package).value();
         })));
 
+TEST(ProcJitTest, UnmodifiedStateElements) {
+  // `mem` is its own next state value so it shares a single buffer between
+  // ticks; `copy` is updated from it every tick.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+proc p(tkn: token, x: bits[32], mem: bits[32][4], copy: bits[32][4],
+       init={0, [1, 2, 3, 4], [0, 0, 0, 0]}) {
+  literal.1: bits[32] = literal(value=1)
+  add.2: bits[32] = add(x, literal.1)
+  next (tkn, add.2, mem, mem)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, package->GetProc("p"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::Create(proc, GetJitRuntime(), queue_manager.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Value mem, Value::UBitsArray({1, 2, 3, 4}, 32));
+
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+  for (int64_t i = 0; i < 3; ++i) {
+    XLS_ASSERT_OK(jit->Tick(*continuation));
+  }
+  EXPECT_THAT(continuation->GetState(),
+              testing::ElementsAre(Value(UBits(3, 32)), mem, mem));
+
+  // Setting the state after an odd number of ticks writes to the buffers which
+  // are currently the inputs.
+  XLS_ASSERT_OK_AND_ASSIGN(Value new_mem, Value::UBitsArray({5, 6, 7, 8}, 32));
+  ProcJitContinuation* jit_continuation =
+      dynamic_cast<ProcJitContinuation*>(continuation.get());
+  ASSERT_NE(jit_continuation, nullptr);
+  XLS_ASSERT_OK(
+      jit_continuation->SetState({Value(UBits(10, 32)), new_mem, mem}));
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  EXPECT_THAT(continuation->GetState(),
+              testing::ElementsAre(Value(UBits(11, 32)), new_mem, new_mem));
+  XLS_ASSERT_OK(jit->Tick(*continuation));
+  EXPECT_THAT(continuation->GetState(),
+              testing::ElementsAre(Value(UBits(12, 32)), new_mem, new_mem));
+}
+
+TEST(ProcJitTest, NodeProfile) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+proc counter(tkn: token, x: bits[32], init={1}) {
+  literal.1: bits[32] = literal(value=1)
+  add.2: bits[32] = add(x, literal.1)
+  umul.3: bits[32] = umul(add.2, x)
+  next (tkn, umul.3)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, package->GetProc("counter"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(package.get()));
+  JitNodeProfile profile;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ProcJit> jit,
+      ProcJit::Create(proc, GetJitRuntime(), queue_manager.get(),
+                      /*object_cache=*/nullptr, &profile));
+
+  std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+  constexpr int64_t kTicks = 10;
+  for (int64_t i = 0; i < kTicks; ++i) {
+    XLS_ASSERT_OK(jit->Tick(*continuation));
+  }
+
+  std::vector<JitNodeProfile::NodeEntry> nodes = profile.GetNodeHotList();
+  ASSERT_EQ(nodes.size(), 2);
+  for (const JitNodeProfile::NodeEntry& entry : nodes) {
+    EXPECT_EQ(entry.function_base, "counter");
+    EXPECT_THAT(entry.op, testing::AnyOf(Op::kAdd, Op::kUMul));
+    EXPECT_EQ(entry.invocations, kTicks);
+  }
+  EXPECT_GE(nodes[0].cycles, nodes[1].cycles);
+
+  std::vector<JitNodeProfile::OpEntry> ops = profile.GetOpHotList();
+  ASSERT_EQ(ops.size(), 2);
+  EXPECT_EQ(ops[0].node_count, 1);
+  EXPECT_EQ(ops[0].invocations, kTicks);
+  EXPECT_THAT(profile.ToString(), testing::HasSubstr("counter::add.2"));
+
+  profile.Reset();
+  EXPECT_EQ(profile.GetNodeHotList()[0].invocations, 0);
+}
+
+TEST(ProcJitTest, ObjectCacheHitsWithOtherQueues) {
+  // The jitted code refers to the queues and the trace node by name rather
+  // than by address, so a second JIT with queues elsewhere in memory (as in
+  // another process) reuses the cached object code.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+
+proc p(tkn: token, st: (), init={()}) {
+  receive.1: (token, bits[32]) = receive(tkn, channel_id=0)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  literal.4: bits[1] = literal(value=1)
+  trace.5: token = trace(tuple_index.2, literal.4, format="x is {}", data_operands=[tuple_index.3], id=5)
+  literal.6: bits[32] = literal(value=1)
+  add.7: bits[32] = add(tuple_index.3, literal.6)
+  send.8: token = send(trace.5, add.7, channel_id=1)
+  next (send.8, st)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, package->GetProc("p"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, package->GetChannel("in"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, package->GetChannel("out"));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitObjectCache> cache,
+      JitObjectCache::Create(temp_dir.path(), /*max_size_bytes=*/1 << 24));
+
+  auto run = [&](int64_t input) -> absl::StatusOr<Value> {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<JitChannelQueueManager> queue_manager,
+        JitChannelQueueManager::CreateThreadSafe(package.get()));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<ProcJit> jit,
+                         ProcJit::Create(proc, GetJitRuntime(),
+                                         queue_manager.get(), cache.get()));
+    XLS_RETURN_IF_ERROR(
+        queue_manager->GetQueue(in).Write(Value(UBits(input, 32))));
+    std::unique_ptr<ProcContinuation> continuation = jit->NewContinuation();
+    XLS_RETURN_IF_ERROR(jit->Tick(*continuation).status());
+    XLS_RET_CHECK_EQ(continuation->GetEvents().trace_msgs.size(), 1);
+    std::optional<Value> result = queue_manager->GetQueue(out).Read();
+    XLS_RET_CHECK(result.has_value());
+    return *result;
+  };
+
+  EXPECT_THAT(run(41), IsOkAndHolds(Value(UBits(42, 32))));
+  EXPECT_EQ(cache->hit_count(), 0);
+  int64_t misses = cache->miss_count();
+  EXPECT_GT(misses, 0);
+
+  EXPECT_THAT(run(99), IsOkAndHolds(Value(UBits(100, 32))));
+  EXPECT_EQ(cache->hit_count(), misses);
+  EXPECT_EQ(cache->miss_count(), misses);
+}
+
 }  // namespace
 }  // namespace xls
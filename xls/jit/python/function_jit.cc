@@ -0,0 +1,271 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/function_jit.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "pybind11/numpy.h"
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+#include "pybind11_abseil/statusor_caster.h"
+#include "xls/common/status/import_status_module.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/events.h"
+#include "xls/ir/python/wrapper_types.h"
+#include "xls/jit/type_layout.h"
+
+namespace py = pybind11;
+
+namespace xls {
+namespace {
+
+// Returns the leaf elements of the native layout of `type` if it is a bits type
+// of 1 to 64 bits, or a tuple of such bits types. These are the types which map
+// onto numpy arrays of unsigned integers (or structured arrays thereof).
+absl::StatusOr<std::vector<ElementLayout>> GetNumpyLeaves(
+    const TypeLayout& layout) {
+  Type* type = layout.type();
+  std::vector<Type*> leaf_types;
+  if (type->IsTuple()) {
+    absl::Span<Type* const> element_types =
+        type->AsTupleOrDie()->element_types();
+    leaf_types.assign(element_types.begin(), element_types.end());
+  } else {
+    leaf_types.push_back(type);
+  }
+  bool supported = true;
+  for (Type* leaf_type : leaf_types) {
+    supported = supported && leaf_type->IsBits() &&
+                leaf_type->GetFlatBitCount() > 0 &&
+                leaf_type->GetFlatBitCount() <= 64;
+  }
+  if (!supported) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Type %s is not supported by batched numpy evaluation; only bits "
+        "types of 1 to 64 bits and tuples of them are.",
+        type->ToString()));
+  }
+  XLS_RET_CHECK_EQ(layout.elements().size(), leaf_types.size());
+  std::vector<ElementLayout> leaves(layout.elements().begin(),
+                                    layout.elements().end());
+  for (const ElementLayout& leaf : leaves) {
+    XLS_RET_CHECK(leaf.padded_size == 1 || leaf.padded_size == 2 ||
+                  leaf.padded_size == 4 || leaf.padded_size == 8)
+        << leaf.ToString();
+  }
+  return leaves;
+}
+
+// A FunctionJit which evaluates its function over numpy arrays. Keeps the
+// package of the function alive.
+class NumpyFunctionJit {
+ public:
+  static absl::StatusOr<std::unique_ptr<NumpyFunctionJit>> Create(
+      FunctionHolder function, int64_t opt_level) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(&function.deref(), opt_level));
+    std::vector<std::vector<ElementLayout>> arg_leaves;
+    for (int64_t i = 0; i < function.deref().params().size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(std::vector<ElementLayout> leaves,
+                           GetNumpyLeaves(jit->GetArgTypeLayout(i)));
+      arg_leaves.push_back(std::move(leaves));
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<ElementLayout> return_leaves,
+                         GetNumpyLeaves(jit->GetReturnTypeLayout()));
+    return absl::WrapUnique(new NumpyFunctionJit(
+        function.package(), std::move(jit), std::move(arg_leaves),
+        std::move(return_leaves)));
+  }
+
+  // Evaluates the function on each element of the given arrays, one per
+  // parameter, and returns an array of the results. See the module docstring.
+  absl::StatusOr<py::array> RunBatched(const std::vector<py::array>& args) {
+    if (args.size() != arg_leaves_.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Expected %d arrays, one per parameter, got %d.",
+                          arg_leaves_.size(), args.size()));
+    }
+    int64_t count = 0;
+    for (int64_t i = 0; i < args.size(); ++i) {
+      if (args[i].ndim() != 1) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Argument %d must be a one-dimensional array.", i));
+      }
+      if (i == 0) {
+        count = args[i].shape(0);
+      } else if (args[i].shape(0) != count) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "All arguments must have the same length; argument %d has %d "
+            "elements, expected %d.",
+            i, args[i].shape(0), count));
+      }
+    }
+
+    // The leaf values of each argument, as uint64s. Casting is done by numpy,
+    // so signed values wrap around and are then truncated to the bit count.
+    std::vector<std::vector<py::array_t<uint64_t, py::array::forcecast>>>
+        arg_leaf_arrays(args.size());
+    for (int64_t i = 0; i < args.size(); ++i) {
+      if (!jit_->function()->param(i)->GetType()->IsTuple()) {
+        arg_leaf_arrays[i].push_back(
+            py::array_t<uint64_t, py::array::forcecast>::ensure(args[i]));
+      } else {
+        py::object names = args[i].dtype().attr("names");
+        if (names.is_none() || py::len(names) != arg_leaves_[i].size()) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Argument %d must be a structured array with %d fields, one per "
+              "tuple element.",
+              i, arg_leaves_[i].size()));
+        }
+        for (py::handle name : names) {
+          py::object field = args[i][name];
+          arg_leaf_arrays[i].push_back(
+              py::array_t<uint64_t, py::array::forcecast>::ensure(field));
+        }
+      }
+      for (const auto& leaf_array : arg_leaf_arrays[i]) {
+        if (!leaf_array) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Argument %d cannot be converted to unsigned integers.", i));
+        }
+      }
+    }
+
+    // The result is written by the JIT straight into the numpy array: the
+    // structured dtype mirrors the native layout of the return type.
+    py::array result(ResultDtype(), {count});
+    auto result_data = static_cast<uint8_t*>(result.mutable_data());
+
+    std::vector<std::vector<uint8_t>> arg_buffers(args.size());
+    std::vector<const uint8_t*> arg_buffer_ptrs(args.size());
+    InterpreterEvents events;
+    absl::Status status;
+    {
+      // Packing only touches the raw numpy buffers, so the whole evaluation
+      // runs without the GIL.
+      py::gil_scoped_release release;
+      for (int64_t i = 0; i < args.size(); ++i) {
+        const int64_t size = jit_->GetArgTypeSize(i);
+        arg_buffers[i].resize(count * size);
+        arg_buffer_ptrs[i] = arg_buffers[i].data();
+        for (int64_t k = 0; k < arg_leaves_[i].size(); ++k) {
+          PackLeaf(arg_leaf_arrays[i][k], arg_leaves_[i][k],
+                   jit_->function()->param(i)->GetType(), k, size,
+                   arg_buffers[i].data());
+        }
+      }
+      status = jit_->RunBatched(
+          arg_buffer_ptrs,
+          absl::MakeSpan(result_data, count * jit_->GetReturnTypeSize()),
+          count, &events);
+    }
+    XLS_RETURN_IF_ERROR(status);
+    XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(events));
+    return result;
+  }
+
+ private:
+  NumpyFunctionJit(std::shared_ptr<Package> package,
+                   std::unique_ptr<FunctionJit> jit,
+                   std::vector<std::vector<ElementLayout>> arg_leaves,
+                   std::vector<ElementLayout> return_leaves)
+      : package_(std::move(package)),
+        jit_(std::move(jit)),
+        arg_leaves_(std::move(arg_leaves)),
+        return_leaves_(std::move(return_leaves)) {}
+
+  // Writes the values of `leaf_array`, truncated to the bit count of the leaf,
+  // into the `leaf` element of each of the consecutive values of `stride`
+  // bytes at `buffer`, assuming a little-endian host.
+  static void PackLeaf(
+      const py::array_t<uint64_t, py::array::forcecast>& leaf_array,
+      const ElementLayout& leaf, Type* type, int64_t leaf_index,
+      int64_t stride, uint8_t* buffer) {
+    Type* leaf_type =
+        type->IsTuple() ? type->AsTupleOrDie()->element_type(leaf_index) : type;
+    const int64_t bit_count = leaf_type->GetFlatBitCount();
+    const uint64_t mask =
+        bit_count == 64 ? ~uint64_t{0} : (uint64_t{1} << bit_count) - 1;
+    auto values = leaf_array.unchecked<1>();
+    for (py::ssize_t j = 0; j < values.shape(0); ++j) {
+      const uint64_t value = values(j) & mask;
+      std::memcpy(buffer + j * stride + leaf.offset, &value, leaf.data_size);
+    }
+  }
+
+  // Returns the numpy dtype matching the native layout of the return type: an
+  // unsigned integer for bits, and a structured dtype with fields f0, f1, ...
+  // at the native offsets for tuples.
+  py::dtype ResultDtype() const {
+    auto unsigned_dtype = [](const ElementLayout& leaf) {
+      return py::dtype(absl::StrFormat("u%d", leaf.padded_size));
+    };
+    if (!jit_->function()->return_value()->GetType()->IsTuple()) {
+      return unsigned_dtype(return_leaves_.front());
+    }
+    py::list names;
+    py::list formats;
+    py::list offsets;
+    for (int64_t k = 0; k < return_leaves_.size(); ++k) {
+      names.append(py::str(absl::StrFormat("f%d", k)));
+      formats.append(unsigned_dtype(return_leaves_[k]));
+      offsets.append(py::int_(return_leaves_[k].offset));
+    }
+    return py::dtype(names, formats, offsets, jit_->GetReturnTypeSize());
+  }
+
+  std::shared_ptr<Package> package_;
+  std::unique_ptr<FunctionJit> jit_;
+  std::vector<std::vector<ElementLayout>> arg_leaves_;
+  std::vector<ElementLayout> return_leaves_;
+};
+
+}  // namespace
+
+PYBIND11_MODULE(function_jit, m) {
+  ImportStatusModule();
+  py::module::import("xls.ir.python.function");
+
+  m.doc() = R"(Evaluates XLS functions with the JIT over numpy arrays.
+
+Each parameter is given as a one-dimensional array holding its value for every
+element of the batch: an array of integers for bits parameters, or a structured
+array with one field per element for tuple parameters. Values are truncated to
+the bit count of the parameter, so negative values are in two's complement.
+Results are returned in the same form, as unsigned integers of the smallest
+sufficient size; tuple results have fields f0, f1, ...
+
+Only bits types of 1 to 64 bits, and tuples of them, are supported.)";
+
+  py::class_<NumpyFunctionJit>(m, "FunctionJit")
+      .def_static("create", &NumpyFunctionJit::Create, py::arg("function"),
+                  py::arg("opt_level") = 3,
+                  "Compiles the function; the function may not be modified "
+                  "afterwards.")
+      .def("run_batched", &NumpyFunctionJit::RunBatched, py::arg("args"),
+           "Evaluates the function on each element of the argument arrays, "
+           "with the GIL released.");
+}
+
+}  // namespace xls
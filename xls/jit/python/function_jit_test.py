@@ -0,0 +1,93 @@
+# Copyright 2022 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for xls.jit.python.function_jit."""
+
+import numpy as np
+
+from xls.ir.python import ir_parser
+from xls.jit.python import function_jit
+from absl.testing import absltest
+
+_IR = """package test_package
+
+fn my_add(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y)
+}
+
+fn swap_add(t: (bits[8], bits[24])) -> (bits[24], bits[8]) {
+  t0: bits[8] = tuple_index(t, index=0)
+  t1: bits[24] = tuple_index(t, index=1)
+  t0_ext: bits[24] = zero_ext(t0, new_bit_count=24)
+  sum: bits[24] = add(t0_ext, t1)
+  ret result: (bits[24], bits[8]) = tuple(sum, t0)
+}
+
+fn wide(x: bits[128]) -> bits[128] {
+  ret identity.2: bits[128] = identity(x)
+}
+"""
+
+
+def get_jit(name):
+  package = ir_parser.Parser.parse_package(_IR)
+  return function_jit.FunctionJit.create(package.get_function(name))
+
+
+class FunctionJitTest(absltest.TestCase):
+
+  def test_bits(self):
+    jit = get_jit('my_add')
+    x = np.arange(1000, dtype=np.uint32)
+    y = np.full(1000, 0xffffffff, dtype=np.uint64)
+    result = jit.run_batched([x, y])
+    self.assertEqual(result.dtype, np.uint32)
+    np.testing.assert_array_equal(result, (x - 1).astype(np.uint32))
+
+  def test_signed_arguments_truncated(self):
+    jit = get_jit('my_add')
+    result = jit.run_batched(
+        [np.array([-1, -2], dtype=np.int64),
+         np.array([1, 1], dtype=np.int8)])
+    np.testing.assert_array_equal(result, [0, 0xffffffff])
+
+  def test_tuples(self):
+    jit = get_jit('swap_add')
+    t = np.zeros(3, dtype=[('a', np.uint8), ('b', np.uint32)])
+    t['a'] = [1, 2, 255]
+    t['b'] = [10, 20, 0xffffff]
+    result = jit.run_batched([t])
+    np.testing.assert_array_equal(result['f0'], [11, 22, 254])
+    np.testing.assert_array_equal(result['f1'], [1, 2, 255])
+
+  def test_empty_batch(self):
+    jit = get_jit('my_add')
+    result = jit.run_batched(
+        [np.array([], dtype=np.uint32),
+         np.array([], dtype=np.uint32)])
+    self.assertEqual(result.shape, (0,))
+
+  def test_mismatched_lengths(self):
+    jit = get_jit('my_add')
+    with self.assertRaisesRegex(Exception, 'same length'):
+      jit.run_batched([np.zeros(2), np.zeros(3)])
+
+  def test_unsupported_type(self):
+    package = ir_parser.Parser.parse_package(_IR)
+    with self.assertRaisesRegex(Exception, 'not supported'):
+      function_jit.FunctionJit.create(package.get_function('wide'))
+
+
+if __name__ == '__main__':
+  absltest.main()
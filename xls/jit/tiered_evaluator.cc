@@ -0,0 +1,131 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/tiered_evaluator.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+namespace {
+
+// Logs failed JIT compilations. Compilation failure is not fatal as evaluation
+// continues in the interpreter.
+template <typename JitT>
+absl::StatusOr<std::unique_ptr<JitT>> LogIfError(
+    absl::StatusOr<std::unique_ptr<JitT>> jit, std::string_view name) {
+  if (!jit.ok()) {
+    XLS_LOG(WARNING) << "JIT compilation of " << name
+                     << " failed, continuing in the interpreter: "
+                     << jit.status();
+  }
+  return jit;
+}
+
+}  // namespace
+
+TieredFunction::TieredFunction(Function* function,
+                               std::unique_ptr<CompiledFunction> interpreter,
+                               int64_t opt_level, JitObjectCache* object_cache)
+    : function_(function),
+      interpreter_(std::move(interpreter)),
+      compilation_([function, opt_level, object_cache]() {
+        return LogIfError(
+            FunctionJit::Create(function, opt_level, object_cache),
+            function->name());
+      }) {}
+
+absl::StatusOr<std::unique_ptr<TieredFunction>> TieredFunction::Create(
+    Function* function, int64_t opt_level, JitObjectCache* object_cache) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunction> interpreter,
+                       CompiledFunction::Create(function));
+  return absl::WrapUnique(new TieredFunction(function, std::move(interpreter),
+                                             opt_level, object_cache));
+}
+
+absl::StatusOr<InterpreterResult<Value>> TieredFunction::Run(
+    absl::Span<const Value> args) {
+  if (FunctionJit* jit = compilation_.Get()) {
+    return jit->Run(args);
+  }
+  return interpreter_->Run(args);
+}
+
+absl::StatusOr<InterpreterResult<Value>> TieredFunction::Run(
+    const absl::flat_hash_map<std::string, Value>& kwargs) {
+  if (FunctionJit* jit = compilation_.Get()) {
+    return jit->Run(kwargs);
+  }
+  return interpreter_->Run(kwargs);
+}
+
+TieredProcEvaluator::TieredProcEvaluator(Proc* proc, JitRuntime* jit_runtime,
+                                         JitChannelQueueManager* queue_mgr,
+                                         JitObjectCache* object_cache)
+    : interpreter_(proc, queue_mgr),
+      compilation_([proc, jit_runtime, queue_mgr, object_cache]() {
+        return LogIfError(
+            ProcJit::Create(proc, jit_runtime, queue_mgr, object_cache),
+            proc->name());
+      }) {}
+
+absl::StatusOr<std::unique_ptr<TieredProcEvaluator>>
+TieredProcEvaluator::Create(Proc* proc, JitRuntime* jit_runtime,
+                            JitChannelQueueManager* queue_mgr,
+                            JitObjectCache* object_cache) {
+  return absl::WrapUnique(
+      new TieredProcEvaluator(proc, jit_runtime, queue_mgr, object_cache));
+}
+
+std::unique_ptr<ProcContinuation> TieredProcEvaluator::NewContinuation() const {
+  return std::make_unique<TieredProcContinuation>(
+      interpreter_.NewContinuation());
+}
+
+absl::StatusOr<TickResult> TieredProcEvaluator::Tick(
+    ProcContinuation& continuation) const {
+  TieredProcContinuation* cont =
+      dynamic_cast<TieredProcContinuation*>(&continuation);
+  XLS_RET_CHECK_NE(cont, nullptr)
+      << "TieredProcEvaluator requires a continuation of type "
+         "TieredProcContinuation";
+
+  // Execution can only move to the JIT between ticks as the interpreter and the
+  // JIT represent mid-tick execution points differently.
+  ProcJit* jit = compilation_.Get();
+  if (jit != nullptr && !cont->IsJitted() && cont->AtStartOfTick()) {
+    auto jit_continuation = absl::WrapUnique(
+        static_cast<ProcJitContinuation*>(jit->NewContinuation().release()));
+    ProcContinuation& interpreter_continuation =
+        *cont->interpreter_continuation_;
+    XLS_RETURN_IF_ERROR(
+        jit_continuation->SetState(interpreter_continuation.GetState()));
+    jit_continuation->GetEvents() =
+        std::move(interpreter_continuation.GetEvents());
+    XLS_VLOG(1) << "Proc " << proc()->name() << " switched to the JIT";
+    cont->jit_continuation_ = std::move(jit_continuation);
+    cont->interpreter_continuation_.reset();
+  }
+
+  if (cont->IsJitted()) {
+    return jit->Tick(*cont->jit_continuation_);
+  }
+  return interpreter_.Tick(*cont->interpreter_continuation_);
+}
+
+}  // namespace xls
@@ -0,0 +1,210 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_TIERED_EVALUATOR_H_
+#define XLS_JIT_TIERED_EVALUATOR_H_
+
+// Evaluators which start executing with the IR interpreter while the JIT
+// compiles the function or proc in the background, and switch to the
+// jitted code once compilation completes. This avoids paying for LLVM
+// compilation in short runs while retaining JIT throughput in long ones.
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/notification.h"
+#include "absl/types/span.h"
+#include "xls/common/thread_pool.h"
+#include "xls/interpreter/compiled_function.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_interpreter.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_object_cache.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/proc_jit.h"
+
+namespace xls {
+namespace internal {
+
+// Runs `compile` as a task of the shared thread pool and holds the result, so
+// that the compilations of many evaluators are bounded by the pool size. The
+// destructor skips the compilation if it has not started, and otherwise
+// blocks until it finishes as LLVM compilation cannot be cancelled.
+template <typename JitT>
+class BackgroundJitCompilation {
+ public:
+  explicit BackgroundJitCompilation(
+      std::function<absl::StatusOr<std::unique_ptr<JitT>>()> compile) {
+    group_.Schedule([this, compile = std::move(compile)]() {
+      result_ = compile();
+      done_.Notify();
+    });
+  }
+
+  ~BackgroundJitCompilation() { group_.Cancel(); }
+
+  // Returns the compiled JIT or nullptr if compilation has not yet finished or
+  // it failed.
+  JitT* Get() const {
+    if (!done_.HasBeenNotified() || !result_.ok()) {
+      return nullptr;
+    }
+    return result_->get();
+  }
+
+  // Blocks until compilation finishes and returns its status. Compiles on the
+  // calling thread if no worker of the pool has started yet.
+  absl::Status Wait() const {
+    group_.Wait();
+    return result_.status();
+  }
+
+ private:
+  // `result_` is written only by the compilation task before `done_` is
+  // notified and read only after.
+  absl::StatusOr<std::unique_ptr<JitT>> result_ =
+      absl::UnavailableError("JIT compilation has not finished");
+  absl::Notification done_;
+  // Declared last so the task is finished before the other members are
+  // destroyed.
+  mutable TaskGroup group_;
+};
+
+}  // namespace internal
+
+// Evaluates an XLS function with the IR interpreter (as a CompiledFunction)
+// until a FunctionJit compiled in the background is ready, then with the
+// JIT. Not thread-safe (as is FunctionJit).
+class TieredFunction {
+ public:
+  // Returns a tiered evaluator for `function` and starts JIT compilation in the
+  // background. `opt_level` and `object_cache` are passed to FunctionJit.
+  static absl::StatusOr<std::unique_ptr<TieredFunction>> Create(
+      Function* function, int64_t opt_level = 3,
+      JitObjectCache* object_cache = nullptr);
+
+  // Evaluates the function with the given arguments.
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
+
+  // As above, but with arguments as key-value pairs.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      const absl::flat_hash_map<std::string, Value>& kwargs);
+
+  // Returns true if subsequent calls to Run will execute jitted code.
+  bool IsJitReady() const { return compilation_.Get() != nullptr; }
+
+  // Blocks until JIT compilation finishes and returns its status. If
+  // compilation failed the function continues to be interpreted.
+  absl::Status WaitForJit() const { return compilation_.Wait(); }
+
+  Function* function() const { return function_; }
+
+ private:
+  TieredFunction(Function* function,
+                 std::unique_ptr<CompiledFunction> interpreter,
+                 int64_t opt_level, JitObjectCache* object_cache);
+
+  Function* function_;
+  std::unique_ptr<CompiledFunction> interpreter_;
+  internal::BackgroundJitCompilation<FunctionJit> compilation_;
+};
+
+// A continuation used by the TieredProcEvaluator. Wraps a continuation of the
+// interpreter and, once execution has moved to the JIT, a continuation of the
+// ProcJit.
+class TieredProcContinuation : public ProcContinuation {
+ public:
+  explicit TieredProcContinuation(
+      std::unique_ptr<ProcContinuation> interpreter_continuation)
+      : interpreter_continuation_(std::move(interpreter_continuation)) {}
+
+  ~TieredProcContinuation() override = default;
+
+  std::vector<Value> GetState() const override { return active().GetState(); }
+  const InterpreterEvents& GetEvents() const override {
+    return active().GetEvents();
+  }
+  InterpreterEvents& GetEvents() override { return active().GetEvents(); }
+  bool AtStartOfTick() const override { return active().AtStartOfTick(); }
+  absl::Status SaveSnapshot(
+      ProcContinuationSnapshotProto* snapshot) const override {
+    return active().SaveSnapshot(snapshot);
+  }
+  // Mid-tick snapshots can only be restored into the tier which took them.
+  absl::Status RestoreSnapshot(
+      const ProcContinuationSnapshotProto& snapshot) override {
+    return active().RestoreSnapshot(snapshot);
+  }
+
+  // Returns true if this continuation is executed by the JIT.
+  bool IsJitted() const { return jit_continuation_ != nullptr; }
+
+ private:
+  friend class TieredProcEvaluator;
+
+  ProcContinuation& active() const {
+    return IsJitted() ? *jit_continuation_ : *interpreter_continuation_;
+  }
+
+  std::unique_ptr<ProcContinuation> interpreter_continuation_;
+  std::unique_ptr<ProcJitContinuation> jit_continuation_;
+};
+
+// A proc evaluator which ticks the proc with the ProcInterpreter until a
+// ProcJit compiled in the background is ready. Continuations move to the
+// JIT at the start of the first tick after compilation finishes; the proc state
+// is carried over so the switch is not observable other than in speed.
+class TieredProcEvaluator : public ProcEvaluator {
+ public:
+  // Returns a tiered evaluator for `proc` and starts JIT compilation in the
+  // background. The arguments are as for ProcJit::Create.
+  static absl::StatusOr<std::unique_ptr<TieredProcEvaluator>> Create(
+      Proc* proc, JitRuntime* jit_runtime, JitChannelQueueManager* queue_mgr,
+      JitObjectCache* object_cache = nullptr);
+
+  ~TieredProcEvaluator() override = default;
+
+  std::unique_ptr<ProcContinuation> NewContinuation() const override;
+  absl::StatusOr<TickResult> Tick(
+      ProcContinuation& continuation) const override;
+  Proc* proc() const override { return interpreter_.proc(); }
+
+  // Returns true if ticks starting after this point will execute jitted code.
+  bool IsJitReady() const { return compilation_.Get() != nullptr; }
+
+  // Blocks until JIT compilation finishes and returns its status. If
+  // compilation failed the proc continues to be interpreted.
+  absl::Status WaitForJit() const { return compilation_.Wait(); }
+
+ private:
+  TieredProcEvaluator(Proc* proc, JitRuntime* jit_runtime,
+                      JitChannelQueueManager* queue_mgr,
+                      JitObjectCache* object_cache);
+
+  ProcInterpreter interpreter_;
+  internal::BackgroundJitCompilation<ProcJit> compilation_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_TIERED_EVALUATOR_H_
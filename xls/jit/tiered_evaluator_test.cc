@@ -0,0 +1,188 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/tiered_evaluator.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/interpreter/proc_evaluator_test_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+JitRuntime* GetJitRuntime() {
+  static auto jit_runtime =
+      std::make_unique<JitRuntime>(OrcJit::CreateDataLayout().value());
+  return jit_runtime.get();
+}
+
+// Runs the evaluator test suites with evaluation started immediately (likely in
+// the interpreter) and after waiting for the JIT.
+INSTANTIATE_TEST_SUITE_P(
+    TieredFunctionTest, IrEvaluatorTestBase,
+    testing::Values(
+        IrEvaluatorTestParam(
+            [](Function* function, absl::Span<const Value> args)
+                -> absl::StatusOr<InterpreterResult<Value>> {
+              XLS_ASSIGN_OR_RETURN(auto tiered,
+                                   TieredFunction::Create(function));
+              return tiered->Run(args);
+            },
+            [](Function* function,
+               const absl::flat_hash_map<std::string, Value>& kwargs)
+                -> absl::StatusOr<InterpreterResult<Value>> {
+              XLS_ASSIGN_OR_RETURN(auto tiered,
+                                   TieredFunction::Create(function));
+              return tiered->Run(kwargs);
+            }),
+        IrEvaluatorTestParam(
+            [](Function* function, absl::Span<const Value> args)
+                -> absl::StatusOr<InterpreterResult<Value>> {
+              XLS_ASSIGN_OR_RETURN(auto tiered,
+                                   TieredFunction::Create(function));
+              XLS_RETURN_IF_ERROR(tiered->WaitForJit());
+              return tiered->Run(args);
+            },
+            [](Function* function,
+               const absl::flat_hash_map<std::string, Value>& kwargs)
+                -> absl::StatusOr<InterpreterResult<Value>> {
+              XLS_ASSIGN_OR_RETURN(auto tiered,
+                                   TieredFunction::Create(function));
+              XLS_RETURN_IF_ERROR(tiered->WaitForJit());
+              return tiered->Run(kwargs);
+            })));
+
+INSTANTIATE_TEST_SUITE_P(
+    TieredProcEvaluatorTest, ProcEvaluatorTestBase,
+    testing::Values(
+        ProcEvaluatorTestParam(
+            [](Proc* proc, ChannelQueueManager* queue_manager)
+                -> std::unique_ptr<ProcEvaluator> {
+              JitChannelQueueManager* jit_queue_manager =
+                  dynamic_cast<JitChannelQueueManager*>(queue_manager);
+              XLS_CHECK(jit_queue_manager != nullptr);
+              return TieredProcEvaluator::Create(proc, GetJitRuntime(),
+                                                 jit_queue_manager)
+                  .value();
+            },
+            [](Package* package) -> std::unique_ptr<ChannelQueueManager> {
+              return JitChannelQueueManager::CreateThreadSafe(package).value();
+            }),
+        ProcEvaluatorTestParam(
+            [](Proc* proc, ChannelQueueManager* queue_manager)
+                -> std::unique_ptr<ProcEvaluator> {
+              JitChannelQueueManager* jit_queue_manager =
+                  dynamic_cast<JitChannelQueueManager*>(queue_manager);
+              XLS_CHECK(jit_queue_manager != nullptr);
+              std::unique_ptr<TieredProcEvaluator> evaluator =
+                  TieredProcEvaluator::Create(proc, GetJitRuntime(),
+                                              jit_queue_manager)
+                      .value();
+              XLS_CHECK_OK(evaluator->WaitForJit());
+              return evaluator;
+            },
+            [](Package* package) -> std::unique_ptr<ChannelQueueManager> {
+              return JitChannelQueueManager::CreateThreadSafe(package).value();
+            })));
+
+TEST(TieredEvaluatorTest, ProcStateCarriedAcrossSwitch) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+proc counter(tkn: token, x: bits[32], y: (bits[8], bits[64]), init={3, (1, 2)}) {
+  literal.1: bits[32] = literal(value=5)
+  umul.2: bits[32] = umul(x, literal.1)
+  tuple_index.3: bits[8] = tuple_index(y, index=0)
+  tuple_index.4: bits[64] = tuple_index(y, index=1)
+  add.5: bits[64] = add(tuple_index.4, tuple_index.4)
+  literal.6: bits[8] = literal(value=1)
+  add.7: bits[8] = add(tuple_index.3, literal.6)
+  tuple.8: (bits[8], bits[64]) = tuple(add.7, add.5)
+  next (tkn, umul.2, tuple.8)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, package->GetProc("counter"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> queue_manager,
+      JitChannelQueueManager::CreateThreadSafe(package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TieredProcEvaluator> evaluator,
+      TieredProcEvaluator::Create(proc, GetJitRuntime(), queue_manager.get()));
+
+  std::unique_ptr<ProcContinuation> continuation = evaluator->NewContinuation();
+  auto* tiered_continuation =
+      dynamic_cast<TieredProcContinuation*>(continuation.get());
+  ASSERT_NE(tiered_continuation, nullptr);
+
+  auto expected_state = [](int64_t tick) {
+    uint64_t x = 3;
+    uint64_t y0 = 1;
+    uint64_t y1 = 2;
+    for (int64_t i = 0; i < tick; ++i) {
+      x = (x * 5) & 0xffffffff;
+      y0 = (y0 + 1) & 0xff;
+      y1 = y1 * 2;
+    }
+    return std::vector<Value>{
+        Value(UBits(x, 32)),
+        Value::Tuple({Value(UBits(y0, 8)), Value(UBits(y1, 64))})};
+  };
+
+  // Tick a few times (typically in the interpreter), wait for the JIT, then
+  // continue ticking in the JIT.
+  int64_t tick = 0;
+  for (; tick < 3; ++tick) {
+    EXPECT_EQ(continuation->GetState(), expected_state(tick));
+    XLS_ASSERT_OK(evaluator->Tick(*continuation));
+  }
+  XLS_ASSERT_OK(evaluator->WaitForJit());
+  EXPECT_TRUE(evaluator->IsJitReady());
+  for (; tick < 10; ++tick) {
+    EXPECT_EQ(continuation->GetState(), expected_state(tick));
+    XLS_ASSERT_OK(evaluator->Tick(*continuation));
+    EXPECT_TRUE(tiered_continuation->IsJitted());
+  }
+  EXPECT_EQ(continuation->GetState(), expected_state(tick));
+}
+
+TEST(TieredEvaluatorTest, FunctionSwitchesToJit) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(
+package test
+
+fn f(x: bits[16], y: bits[16]) -> bits[16] {
+  ret add.3: bits[16] = add(x, y)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TieredFunction> tiered,
+                           TieredFunction::Create(f));
+  std::vector<Value> args = {Value(UBits(40, 16)), Value(UBits(2, 16))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, tiered->Run(args));
+  EXPECT_EQ(result.value, Value(UBits(42, 16)));
+
+  XLS_ASSERT_OK(tiered->WaitForJit());
+  EXPECT_TRUE(tiered->IsJitReady());
+  XLS_ASSERT_OK_AND_ASSIGN(result, tiered->Run(args));
+  EXPECT_EQ(result.value, Value(UBits(42, 16)));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,115 +14,210 @@
 
 #include "xls/jit/type_layout.h"
 
+#include <cstring>
+#include <vector>
+
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value_helpers.h"
 
 namespace xls {
 
-static bool IsLeafValue(const Value& value) {
-  return value.IsBits() || value.IsToken();
+TypeLayout::TypeLayout(Type* type, int64_t size,
+                       absl::Span<const ElementLayout> elements)
+    : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
+  XLS_CHECK_EQ(elements.size(), type->leaf_count());
+  int64_t leaf_index = 0;
+  BuildPlan(type_, &leaf_index, /*base_offset=*/0);
+  XLS_CHECK_EQ(leaf_index, elements_.size());
 }
 
-static void LeafValueToNativeLayout(const Value& value,
-                                    const ElementLayout& element_layout,
-                                    uint8_t* buffer) {
-  uint8_t* element_buffer = buffer + element_layout.offset;
-  if (value.IsBits()) {
-    // Write the bytes from the Bits object into the buffer.
-    value.bits().ToBytes(
-        absl::MakeSpan(element_buffer, element_layout.data_size));
-    // Clear any padding bytes.
-    std::memset(element_buffer + element_layout.data_size, 0,
-                element_layout.padded_size - element_layout.data_size);
-    return;
+bool TypeLayout::HasConstantStride(ArrayType* array_type, int64_t leaf_index,
+                                   int64_t* stride) const {
+  int64_t leaves_per_element = array_type->element_type()->leaf_count();
+  if (leaves_per_element == 0 || array_type->size() < 2) {
+    *stride = 0;
+    return true;
   }
-  XLS_CHECK(value.IsToken());
-  std::memset(buffer, 0, element_layout.padded_size);
+  *stride = elements_[leaf_index + leaves_per_element].offset -
+            elements_[leaf_index].offset;
+  for (int64_t i = 1; i < array_type->size(); ++i) {
+    for (int64_t j = 0; j < leaves_per_element; ++j) {
+      const ElementLayout& first = elements_[leaf_index + j];
+      const ElementLayout& element =
+          elements_[leaf_index + i * leaves_per_element + j];
+      if (element.offset != first.offset + i * *stride ||
+          element.data_size != first.data_size ||
+          element.padded_size != first.padded_size) {
+        return false;
+      }
+    }
+  }
+  return true;
 }
 
-void TypeLayout::ValueToNativeLayout(const Value& value,
-                                     uint8_t* buffer) const {
-  XLS_DCHECK(ValueConformsToType(value, type())) << absl::StreamFormat(
-      "Value `%s` is not of type `%s`", value.ToString(), type()->ToString());
-
-  if (IsLeafValue(value)) {
-    return LeafValueToNativeLayout(value, elements_.front(), buffer);
+void TypeLayout::BuildPlan(Type* element_type, int64_t* leaf_index,
+                           int64_t base_offset) {
+  if (element_type->IsBits() || element_type->IsToken()) {
+    const ElementLayout& element_layout = elements_.at(*leaf_index);
+    ++(*leaf_index);
+    plan_.push_back(ConversionStep{
+        .kind = element_type->IsBits() ? ConversionStep::Kind::kBits
+                                       : ConversionStep::Kind::kToken,
+        .count = element_type->GetFlatBitCount(),
+        .offset = element_layout.offset - base_offset,
+        .data_size = element_layout.data_size,
+        .padded_size = element_layout.padded_size,
+        .stride = 0,
+        .subtree_size = 0});
+    return;
   }
 
-  // At this point, `value` is a compound type. To avoid the expense of
-  // recursive calls enumerating the type elements, manually keep a stack to
-  // perform the enumeration.
-  struct Frame {
-    // Type being handled. Necessarily is a compound type (array or tuple).
-    const Value* value;
-    // The index of the current element of `value` being handled.
-    int64_t index;
-    // The number of elements in `value`.
-    int64_t limit;
-  };
-  absl::InlinedVector<Frame, 5> stack;
-  // Adds the compound type value to the stack for enumeration through its
-  // elements.
-  auto push_frame = [&](const Value& v) {
-    stack.push_back(Frame{.value = &v, .index = 0, .limit = v.size()});
-  };
-  push_frame(value);
-
-  // The linear index of the current leaf element being handled.
-  int64_t leaf_index = 0;
-  while (!stack.empty()) {
-    Frame& frame = stack.back();
-    if (frame.index == frame.limit) {
-      stack.pop_back();
-      continue;
+  int64_t step_index = plan_.size();
+  plan_.push_back(ConversionStep{.count = 0,
+                                 .offset = 0,
+                                 .data_size = 0,
+                                 .padded_size = 0,
+                                 .stride = 0,
+                                 .subtree_size = 0});
+  if (element_type->IsTuple()) {
+    TupleType* tuple_type = element_type->AsTupleOrDie();
+    plan_[step_index].kind = ConversionStep::Kind::kTuple;
+    plan_[step_index].count = tuple_type->size();
+    for (Type* tuple_element_type : tuple_type->element_types()) {
+      BuildPlan(tuple_element_type, leaf_index, base_offset);
     }
-    const Value& value_element = frame.value->element(frame.index);
-    if (IsLeafValue(value_element)) {
-      LeafValueToNativeLayout(value_element, elements_.at(leaf_index), buffer);
-      ++frame.index;
-      ++leaf_index;
+  } else {
+    XLS_CHECK(element_type->IsArray());
+    ArrayType* array_type = element_type->AsArrayOrDie();
+    plan_[step_index].count = array_type->size();
+    int64_t stride;
+    if (array_type->size() > 0 &&
+        HasConstantStride(array_type, *leaf_index, &stride)) {
+      // Describe only the first element. Offsets of its leaves are relative to
+      // the start of the element.
+      int64_t first_leaf = *leaf_index;
+      int64_t element_offset = array_type->element_type()->leaf_count() > 0
+                                   ? elements_[first_leaf].offset
+                                   : base_offset;
+      plan_[step_index].kind = ConversionStep::Kind::kStridedArray;
+      plan_[step_index].offset = element_offset - base_offset;
+      plan_[step_index].stride = stride;
+      BuildPlan(array_type->element_type(), leaf_index, element_offset);
+      *leaf_index = first_leaf + array_type->size() *
+                                     array_type->element_type()->leaf_count();
     } else {
-      ++frame.index;
-      push_frame(value_element);
+      plan_[step_index].kind = ConversionStep::Kind::kArray;
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        BuildPlan(array_type->element_type(), leaf_index, base_offset);
+      }
     }
   }
-  XLS_CHECK_EQ(leaf_index, elements_.size());
+  plan_[step_index].subtree_size = plan_.size() - step_index - 1;
 }
 
-Value TypeLayout::NativeLayoutToValueInternal(Type* element_type,
-                                              const uint8_t* buffer,
-                                              int64_t* leaf_index) const {
-  if (element_type->IsBits()) {
-    int64_t bit_count = element_type->AsBitsOrDie()->bit_count();
-    const ElementLayout& element_layout = elements_.at(*leaf_index);
-    ++(*leaf_index);
-    return Value(
-        Bits::FromBytes(absl::MakeSpan(buffer + element_layout.offset,
-                                       CeilOfRatio(bit_count, int64_t{8})),
-                        bit_count));
-  }
-  if (element_type->IsToken()) {
-    ++(*leaf_index);
-    return Value::Token();
-  }
-  if (element_type->IsTuple()) {
-    TupleType* tuple_type = element_type->AsTupleOrDie();
-    std::vector<Value> elements;
-    for (int64_t i = 0; i < tuple_type->size(); ++i) {
-      elements.push_back(NativeLayoutToValueInternal(
-          tuple_type->element_type(i), buffer, leaf_index));
+void TypeLayout::ValueToNativeLayoutInternal(const Value& value,
+                                             int64_t step_index,
+                                             uint8_t* buffer) const {
+  const ConversionStep& step = plan_[step_index];
+  switch (step.kind) {
+    case ConversionStep::Kind::kBits:
+      // Write the bytes from the Bits object into the buffer and clear any
+      // padding bytes.
+      value.bits().ToBytes(absl::MakeSpan(buffer + step.offset, step.data_size));
+      std::memset(buffer + step.offset + step.data_size, 0,
+                  step.padded_size - step.data_size);
+      return;
+    case ConversionStep::Kind::kToken:
+      std::memset(buffer + step.offset, 0, step.padded_size);
+      return;
+    case ConversionStep::Kind::kTuple:
+    case ConversionStep::Kind::kArray: {
+      int64_t element_step_index = step_index + 1;
+      for (const Value& element : value.elements()) {
+        ValueToNativeLayoutInternal(element, element_step_index, buffer);
+        element_step_index += plan_[element_step_index].subtree_size + 1;
+      }
+      return;
+    }
+    case ConversionStep::Kind::kStridedArray: {
+      uint8_t* element_buffer = buffer + step.offset;
+      const ConversionStep& element_step = plan_[step_index + 1];
+      if (element_step.kind == ConversionStep::Kind::kBits) {
+        // Fast path for arrays of bits.
+        for (const Value& element : value.elements()) {
+          element.bits().ToBytes(absl::MakeSpan(
+              element_buffer + element_step.offset, element_step.data_size));
+          std::memset(
+              element_buffer + element_step.offset + element_step.data_size, 0,
+              element_step.padded_size - element_step.data_size);
+          element_buffer += step.stride;
+        }
+        return;
+      }
+      for (const Value& element : value.elements()) {
+        ValueToNativeLayoutInternal(element, step_index + 1, element_buffer);
+        element_buffer += step.stride;
+      }
+      return;
     }
-    return Value::TupleOwned(std::move(elements));
   }
+}
 
-  XLS_CHECK(element_type->IsArray());
-  ArrayType* array_type = element_type->AsArrayOrDie();
-  std::vector<Value> elements;
-  for (int64_t i = 0; i < array_type->size(); ++i) {
-    elements.push_back(NativeLayoutToValueInternal(array_type->element_type(),
-                                                   buffer, leaf_index));
+void TypeLayout::ValueToNativeLayout(const Value& value,
+                                     uint8_t* buffer) const {
+  XLS_DCHECK(ValueConformsToType(value, type())) << absl::StreamFormat(
+      "Value `%s` is not of type `%s`", value.ToString(), type()->ToString());
+  ValueToNativeLayoutInternal(value, /*step_index=*/0, buffer);
+}
+
+Value TypeLayout::NativeLayoutToValueInternal(int64_t step_index,
+                                              const uint8_t* buffer) const {
+  const ConversionStep& step = plan_[step_index];
+  switch (step.kind) {
+    case ConversionStep::Kind::kBits:
+      return Value(Bits::FromBytes(
+          absl::MakeSpan(buffer + step.offset, step.data_size), step.count));
+    case ConversionStep::Kind::kToken:
+      return Value::Token();
+    case ConversionStep::Kind::kTuple:
+    case ConversionStep::Kind::kArray: {
+      std::vector<Value> elements;
+      elements.reserve(step.count);
+      int64_t element_step_index = step_index + 1;
+      for (int64_t i = 0; i < step.count; ++i) {
+        elements.push_back(
+            NativeLayoutToValueInternal(element_step_index, buffer));
+        element_step_index += plan_[element_step_index].subtree_size + 1;
+      }
+      return step.kind == ConversionStep::Kind::kTuple
+                 ? Value::TupleOwned(std::move(elements))
+                 : Value::ArrayOwned(std::move(elements));
+    }
+    case ConversionStep::Kind::kStridedArray: {
+      std::vector<Value> elements;
+      elements.reserve(step.count);
+      const uint8_t* element_buffer = buffer + step.offset;
+      const ConversionStep& element_step = plan_[step_index + 1];
+      if (element_step.kind == ConversionStep::Kind::kBits) {
+        // Fast path for arrays of bits.
+        for (int64_t i = 0; i < step.count; ++i) {
+          elements.push_back(Value(Bits::FromBytes(
+              absl::MakeSpan(element_buffer + element_step.offset,
+                             element_step.data_size),
+              element_step.count)));
+          element_buffer += step.stride;
+        }
+      } else {
+        for (int64_t i = 0; i < step.count; ++i) {
+          elements.push_back(
+              NativeLayoutToValueInternal(step_index + 1, element_buffer));
+          element_buffer += step.stride;
+        }
+      }
+      return Value::ArrayOwned(std::move(elements));
+    }
   }
-  return Value::ArrayOwned(std::move(elements));
+  XLS_LOG(FATAL) << "Invalid conversion step kind";
 }
 
 Value TypeLayout::NativeLayoutToValue(const uint8_t* buffer) const {
@@ -131,8 +226,7 @@ Value TypeLayout::NativeLayoutToValue(const uint8_t* buffer) const {
   // sanitizers.
   __msan_unpoison(buffer, size());
 #endif  // ABSL_HAVE_MEMORY_SANITIZER
-  int64_t leaf_index = 0;
-  return NativeLayoutToValueInternal(type_, buffer, &leaf_index);
+  return NativeLayoutToValueInternal(/*step_index=*/0, buffer);
 }
 
 std::string TypeLayout::ToString() const {
@@ -79,15 +79,17 @@ struct ElementLayout {
 //                      ElementLayout{.offset=8, .data_size=2, .padded_size=4},
 //                      ElementLayout{.offset=12, .data_size=1, .padded_size=4}}
 //
+// Conversion to and from the native layout is driven by a plan which is
+// computed once from the element layouts on construction. The plan is a flat
+// pre-order list of steps over the type tree in which arrays whose elements are
+// laid out at a constant stride are described by the steps of a single element.
+//
 // TODO(https://github.com/google/xls/issues/760): Reduce the redundancy in the
 // array element layouts.
 class TypeLayout {
  public:
   explicit TypeLayout(Type* type, int64_t size,
-                      absl::Span<const ElementLayout> elements)
-      : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
-    XLS_CHECK_EQ(elements.size(), type->leaf_count());
-  }
+                      absl::Span<const ElementLayout> elements);
 
   // Converts TypeLayout objects to/from TypeLayoutProtos.
   static absl::StatusOr<TypeLayout> FromProto(const TypeLayoutProto& proto,
@@ -112,12 +114,52 @@ class TypeLayout {
   std::string ToString() const;
 
  private:
-  Value NativeLayoutToValueInternal(Type* element_type, const uint8_t* buffer,
-                                    int64_t* leaf_index) const;
+  // A single step of the conversion plan.
+  struct ConversionStep {
+    enum class Kind : uint8_t {
+      kBits,
+      kToken,
+      kTuple,
+      // An array whose elements are at a constant stride. Only the first
+      // element is described by the steps which follow.
+      kStridedArray,
+      // An array whose elements are each described by the steps which follow.
+      kArray,
+    };
+    Kind kind;
+    // Number of bits for kBits steps. Number of elements for aggregate steps.
+    int64_t count;
+    // Byte offset, data size, and padded size of leaf steps. The offset is
+    // relative to the enclosing strided array element, if any.
+    int64_t offset;
+    int64_t data_size;
+    int64_t padded_size;
+    // Distance in bytes between elements of kStridedArray steps.
+    int64_t stride;
+    // Number of steps describing the elements of an aggregate, i.e., the step
+    // following this step's subtree is at index `this + 1 + subtree_size`.
+    int64_t subtree_size;
+  };
+
+  // Appends the steps for `element_type` to the plan. `leaf_index` is the
+  // index of the first leaf of `element_type` in `elements_` and
+  // `base_offset` is the offset of the enclosing strided array element.
+  void BuildPlan(Type* element_type, int64_t* leaf_index, int64_t base_offset);
+
+  // Returns whether the leaves of the elements of `array_type` starting at
+  // `leaf_index` are laid out at a constant stride. Sets `stride` if so.
+  bool HasConstantStride(ArrayType* array_type, int64_t leaf_index,
+                         int64_t* stride) const;
+
+  void ValueToNativeLayoutInternal(const Value& value, int64_t step_index,
+                                   uint8_t* buffer) const;
+  Value NativeLayoutToValueInternal(int64_t step_index,
+                                    const uint8_t* buffer) const;
 
   Type* type_;
   int64_t size_;
   std::vector<ElementLayout> elements_;
+  std::vector<ConversionStep> plan_;
 };
 
 std::ostream& operator<<(std::ostream& os, ElementLayout layout);
@@ -28,6 +28,7 @@
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/number_parser.h"
 #include "xls/ir/type.h"
+#include "xls/jit/jit_runtime.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/orc_jit.h"
 
@@ -290,6 +291,79 @@ TEST_F(TypeLayoutTest, SimpleArray) {
           ElementLayout{.offset = 4, .data_size = 2, .padded_size = 2}));
 }
 
+TEST_F(TypeLayoutTest, ArrayWithNonConstantStride) {
+  // Element layouts which do not have a constant stride can not be described by
+  // a single array element.
+  auto package = CreatePackage();
+  Type* array = package->GetArrayType(3, package->GetBitsType(8));
+  TypeLayout layout(
+      array, 8,
+      {ElementLayout{.offset = 0, .data_size = 1, .padded_size = 1},
+       ElementLayout{.offset = 1, .data_size = 1, .padded_size = 2},
+       ElementLayout{.offset = 5, .data_size = 1, .padded_size = 1}});
+  Value value = Parser::ParseValue("[0x12, 0x34, 0x56]", array).value();
+  std::vector<uint8_t> buffer(8, 0xff);
+  layout.ValueToNativeLayout(value, buffer.data());
+  EXPECT_THAT(buffer, ElementsAre(0x12, 0x34, 0x00, 0xff, 0xff, 0x56, 0xff,
+                                  0xff));
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+}
+
+TEST_F(TypeLayoutTest, NestedArraysOfTuples) {
+  auto package = CreatePackage();
+  // Type: (bits[8], bits[16])[2][2]. Each tuple is four bytes.
+  Type* tuple =
+      package->GetTupleType({package->GetBitsType(8), package->GetBitsType(16)});
+  Type* array = package->GetArrayType(2, package->GetArrayType(2, tuple));
+  std::vector<ElementLayout> elements;
+  for (int64_t i = 0; i < 4; ++i) {
+    elements.push_back(
+        ElementLayout{.offset = 4 * i, .data_size = 1, .padded_size = 1});
+    elements.push_back(
+        ElementLayout{.offset = 4 * i + 2, .data_size = 2, .padded_size = 2});
+  }
+  TypeLayout layout(array, 16, elements);
+  Value value = Parser::ParseValue(
+                    "[[(0x1, 0x203), (0x4, 0x506)], [(0x7, 0x809), (0xa, "
+                    "0xb0c)]]",
+                    array)
+                    .value();
+  std::vector<uint8_t> buffer(16, 0xff);
+  layout.ValueToNativeLayout(value, buffer.data());
+  EXPECT_THAT(buffer, ElementsAre(0x01, 0xff, 0x03, 0x02, 0x04, 0xff, 0x06,
+                                  0x05, 0x07, 0xff, 0x09, 0x08, 0x0a, 0xff,
+                                  0x0c, 0x0b));
+  EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+}
+
+TEST_F(TypeLayoutTest, MatchesJitRuntime) {
+  // The conversion plan must produce exactly the same bytes as the JitRuntime
+  // which walks the LLVM types.
+  auto package = CreatePackage();
+  std::minstd_rand bitgen;
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<JitRuntime> jit_runtime,
+                           JitRuntime::Create());
+  for (const char* type_str :
+       {"bits[13]", "bits[64][7]", "(bits[1], bits[65])[3]",
+        "(bits[3], (), bits[5], bits[7])[2][1][3]", "()[4]",
+        "(token, bits[9][2])"}) {
+    XLS_ASSERT_OK_AND_ASSIGN(Type * type,
+                             Parser::ParseType(type_str, package.get()));
+    TypeLayout layout = CreateTypeLayout(type);
+    for (int64_t i = 0; i < 10; ++i) {
+      Value value = RandomValue(type, &bitgen);
+      std::vector<uint8_t> layout_buffer(layout.size(), 0);
+      std::vector<uint8_t> runtime_buffer(layout.size(), 0);
+      layout.ValueToNativeLayout(value, layout_buffer.data());
+      jit_runtime->BlitValueToBuffer(value, type,
+                                     absl::MakeSpan(runtime_buffer));
+      EXPECT_EQ(layout_buffer, runtime_buffer) << type_str;
+      EXPECT_EQ(layout.NativeLayoutToValue(runtime_buffer.data()), value);
+      EXPECT_EQ(jit_runtime->UnpackBuffer(layout_buffer.data(), type), value);
+    }
+  }
+}
+
 TEST_F(TypeLayoutTest, JitTypes) {
   // Randomly test the layout of a bunch of types. TypeLayouts are generated by
   // the JIT and random xls::Values are round-tripped through the native layout.
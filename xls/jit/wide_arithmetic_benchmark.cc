@@ -0,0 +1,178 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of JIT compilation time and execution time of arithmetic on wide
+// bits values.
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "absl/strings/substitute.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/jit/function_jit.h"
+
+namespace xls {
+namespace {
+
+enum class WideOp { kAdd, kSub, kUMul, kShll, kShra, kULt };
+
+// Returns the IR of a function performing `op` on operands of the given width.
+std::string WideOpIr(WideOp op, int64_t width) {
+  switch (op) {
+    case WideOp::kAdd:
+    case WideOp::kSub:
+    case WideOp::kUMul: {
+      std::string op_name = op == WideOp::kAdd   ? "add"
+                            : op == WideOp::kSub ? "sub"
+                                                 : "umul";
+      return absl::Substitute(R"(
+package wide
+
+top fn f(x: bits[$0], y: bits[$0]) -> bits[$0] {
+  ret $1.3: bits[$0] = $1(x, y)
+}
+)",
+                              width, op_name);
+    }
+    case WideOp::kShll:
+    case WideOp::kShra:
+      return absl::Substitute(R"(
+package wide
+
+top fn f(x: bits[$0], y: bits[32]) -> bits[$0] {
+  ret $1.3: bits[$0] = $1(x, y)
+}
+)",
+                              width, op == WideOp::kShll ? "shll" : "shra");
+    case WideOp::kULt:
+      return absl::Substitute(R"(
+package wide
+
+top fn f(x: bits[$0], y: bits[$0]) -> bits[1] {
+  ret ult.3: bits[1] = ult(x, y)
+}
+)",
+                              width);
+  }
+  XLS_LOG(FATAL) << "Unknown op";
+}
+
+// Measures the time to JIT-compile a function performing `op` on values of
+// width state.range(0).
+void BM_WideOpCompile(benchmark::State& state, WideOp op) {
+  std::unique_ptr<Package> package =
+      Parser::ParsePackage(WideOpIr(op, state.range(0))).value();
+  Function* f = package->GetTopAsFunction().value();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FunctionJit::Create(f).value());
+  }
+}
+
+// Measures the run time of the jitted function performing `op` on values of
+// width state.range(0). The arguments are passed as views to avoid measuring
+// conversion from Values.
+void BM_WideOpRun(benchmark::State& state, WideOp op) {
+  std::unique_ptr<Package> package =
+      Parser::ParsePackage(WideOpIr(op, state.range(0))).value();
+  Function* f = package->GetTopAsFunction().value();
+  std::unique_ptr<FunctionJit> jit = FunctionJit::Create(f).value();
+
+  // The benchmarked widths are powers of two so the native layout has no
+  // padding and random bytes are valid values.
+  std::minstd_rand bitgen;
+  std::vector<std::vector<uint8_t>> arg_buffers;
+  std::vector<uint8_t*> arg_ptrs;
+  for (int64_t i = 0; i < f->params().size(); ++i) {
+    std::vector<uint8_t>& buffer =
+        arg_buffers.emplace_back(jit->GetArgTypeSize(i));
+    for (uint8_t& byte : buffer) {
+      byte = bitgen();
+    }
+  }
+  if (op == WideOp::kShll || op == WideOp::kShra) {
+    // Use an in-range shift amount which is not a multiple of the limb size.
+    uint32_t amount = state.range(0) / 3;
+    std::memcpy(arg_buffers[1].data(), &amount, sizeof(amount));
+  }
+  for (std::vector<uint8_t>& buffer : arg_buffers) {
+    arg_ptrs.push_back(buffer.data());
+  }
+  std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+  InterpreterEvents events;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        jit->RunWithViews(arg_ptrs, absl::MakeSpan(result_buffer), &events));
+  }
+}
+
+BENCHMARK_CAPTURE(BM_WideOpCompile, add, WideOp::kAdd)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WideOpRun, add, WideOp::kAdd)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096);
+
+BENCHMARK_CAPTURE(BM_WideOpCompile, sub, WideOp::kSub)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WideOpRun, sub, WideOp::kSub)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096);
+
+BENCHMARK_CAPTURE(BM_WideOpCompile, umul, WideOp::kUMul)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WideOpRun, umul, WideOp::kUMul)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096);
+
+BENCHMARK_CAPTURE(BM_WideOpCompile, shll, WideOp::kShll)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WideOpRun, shll, WideOp::kShll)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096);
+
+BENCHMARK_CAPTURE(BM_WideOpCompile, shra, WideOp::kShra)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WideOpRun, shra, WideOp::kShra)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096);
+
+BENCHMARK_CAPTURE(BM_WideOpCompile, ult, WideOp::kULt)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_WideOpRun, ult, WideOp::kULt)
+    ->RangeMultiplier(2)
+    ->Range(64, 4096);
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
@@ -29,11 +29,62 @@ import std
 
 type APFloat = apfloat::APFloat;
 
+// Counts the leading zeroes of `x` a chunk of CHUNK_SZ bits at a time, most
+// significant chunk first. This is a chain of small leading-zero counts
+// rather than a single N-bit one, which the scheduler can split across
+// pipeline stages. If CHUNK_SZ >= N, this is simply clz(x).
+pub fn clz_chunked<N: u32, CHUNK_SZ: u32,
+    NUM_CHUNKS: u32 = {(N + CHUNK_SZ - u32:1) / CHUNK_SZ},
+    PADDED_SZ: u32 = {NUM_CHUNKS * CHUNK_SZ}>(x: uN[N]) -> uN[N] {
+  // Left-align `x` so that its bits fill the leading chunks.
+  let padded = (x as uN[PADDED_SZ]) << (PADDED_SZ - N);
+  let (count, _) = for (i, (count, found)): (u32, (u32, bool))
+      in range(u32:0, NUM_CHUNKS) {
+    let chunk = padded[(PADDED_SZ - (i + u32:1) * CHUNK_SZ) +: uN[CHUNK_SZ]];
+    if found { (count, found) }
+    else { (count + (clz(chunk) as u32), chunk != uN[CHUNK_SZ]:0) }
+  }((u32:0, false));
+  // The padding below `x` is only counted if `x` is zero.
+  (if count > N { N } else { count }) as uN[N]
+}
+
+#[test]
+fn clz_chunked_test() {
+  let _ = assert_eq(clz_chunked<u32:28, u32:8>(u28:0), u28:28);
+  let _ = assert_eq(clz_chunked<u32:28, u32:8>(u28:1), u28:27);
+  let _ = assert_eq(clz_chunked<u32:28, u32:8>(u28:0x800_0000), u28:0);
+  let _ = assert_eq(clz_chunked<u32:28, u32:8>(u28:0x10_0000), u28:7);
+  let _ = assert_eq(clz_chunked<u32:28, u32:8>(u28:0x8_0000), u28:8);
+  let _ = assert_eq(clz_chunked<u32:28, u32:28>(u28:0x8_0000), u28:8);
+  let _ = assert_eq(clz_chunked<u32:28, u32:32>(u28:0x8_0000), u28:8);
+  let _ = assert_eq(clz_chunked<u32:5, u32:2>(u5:0b00011), u5:3);
+  let _ = assert_eq(clz_chunked<u32:5, u32:2>(u5:0), u5:5);
+}
+
 // Usage:
 //  - EXP_SZ: The number of bits in the exponent.
 //  - FRACTION_SZ: The number of bits in the fractional part of the FP value.
 //  - x, y: The two floating-point numbers to add.
 //
+// See add_pipelined for the derived parametrics.
+pub fn add<EXP_SZ: u32, FRACTION_SZ: u32,
+    WIDE_FRACTION: u32 = {FRACTION_SZ + u32:5}>(
+    x: APFloat<EXP_SZ, FRACTION_SZ>, y: APFloat<EXP_SZ, FRACTION_SZ>) ->
+    APFloat<EXP_SZ, FRACTION_SZ> {
+  add_pipelined<EXP_SZ, FRACTION_SZ, WIDE_FRACTION>(x, y)
+}
+
+// Variant of `add` with a structure more amenable to pipelining.
+//
+// Usage:
+//  - EXP_SZ: The number of bits in the exponent.
+//  - FRACTION_SZ: The number of bits in the fractional part of the FP value.
+//  - LZC_CHUNK_SZ: The width of the chunks of the leading-zero count of the
+//    normalization step (see clz_chunked). Smaller chunks allow shorter
+//    pipeline stages at the cost of a longer total delay; WIDE_FRACTION or
+//    more yields `add`.
+//  - x, y: The two floating-point numbers to add.
+//
 // Derived parametrics:
 //  - WIDE_EXP: Widened exponent to capture a possible carry bit.
 //  - CARRY_EXP: WIDE_EXP plus one sign bit.
@@ -42,7 +93,7 @@ type APFloat = apfloat::APFloat;
 //  - CARRY_FRACTION: WIDE_FRACTION plus one bit to capture a possible carry bit.
 //  - NORMALIZED_FRACTION: WIDE_FRACTION minus one bit for post normalization
 //    (where the implicit leading 1 bit is dropped).
-pub fn add<EXP_SZ: u32, FRACTION_SZ: u32,
+pub fn add_pipelined<EXP_SZ: u32, FRACTION_SZ: u32, LZC_CHUNK_SZ: u32,
     WIDE_EXP: u32 = {EXP_SZ + u32:1},
     CARRY_EXP: u32 = {WIDE_EXP + u32:1},
     WIDE_FRACTION: u32 = {FRACTION_SZ + u32:5},
@@ -106,7 +157,8 @@ pub fn add<EXP_SZ: u32, FRACTION_SZ: u32,
 
   // If we cancelled higher bits, then we'll need to shift left.
   // Leading zeroes will be 1 if there's no carry or cancellation.
-  let leading_zeroes = clz(abs_fraction);
+  let leading_zeroes =
+      clz_chunked<WIDE_FRACTION, LZC_CHUNK_SZ>(abs_fraction);
   let cancel = leading_zeroes > uN[WIDE_FRACTION]:1;
   let cancel_fraction = (abs_fraction << (leading_zeroes - uN[WIDE_FRACTION]:1)) as uN[NORMALIZED_FRACTION];
   let shifted_fraction = match(carry_bit, cancel) {
@@ -197,3 +249,27 @@ pub fn add<EXP_SZ: u32, FRACTION_SZ: u32,
   APFloat<EXP_SZ, FRACTION_SZ> { sign: result_sign, bexp: result_exponent,
                             fraction: result_fraction as uN[FRACTION_SZ] }
 }
+
+// Streaming wrapper of `add_pipelined`: receives pairs of operands and sends
+// their sums, one per activation, so the adder can be scheduled and generated
+// as a pipelined proc.
+pub proc add_stream<EXP_SZ: u32, FRACTION_SZ: u32, LZC_CHUNK_SZ: u32> {
+    input: chan<(APFloat<EXP_SZ, FRACTION_SZ>,
+                 APFloat<EXP_SZ, FRACTION_SZ>)> in;
+    output: chan<APFloat<EXP_SZ, FRACTION_SZ>> out;
+
+    init { () }
+
+    config(input: chan<(APFloat<EXP_SZ, FRACTION_SZ>,
+                        APFloat<EXP_SZ, FRACTION_SZ>)> in,
+           output: chan<APFloat<EXP_SZ, FRACTION_SZ>> out) {
+        (input, output)
+    }
+
+    next(tok: token, state: ()) {
+        let (tok, (x, y)) = recv(tok, input);
+        let sum = add_pipelined<EXP_SZ, FRACTION_SZ, LZC_CHUNK_SZ>(x, y);
+        let _ = send(tok, output, sum);
+        ()
+    }
+}
@@ -0,0 +1,558 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_module.h"
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+constexpr int32_t kZeroSlot = 0;
+constexpr int32_t kOneSlot = 1;
+
+// Pins defined by a state table are compiled from their truth table, which is
+// only enumerated for cells with at most this many inputs.
+constexpr int64_t kMaxStateTableInputs = 8;
+
+}  // namespace
+
+// Inlines, levelizes and translates a module into a CompiledModule.
+class ModuleCompiler {
+ public:
+  explicit ModuleCompiler(const rtl::Netlist& netlist) : netlist_(netlist) {}
+
+  absl::StatusOr<CompiledModule> Compile(const rtl::Module& module);
+
+ private:
+  using OpKind = CompiledModule::OpKind;
+  using NetSlots = absl::flat_hash_map<rtl::NetRef, int32_t>;
+
+  // A cell of the inlined module with the value slots of its input and output
+  // pins (in the order of the pins of the cell). A null `cell` denotes an
+  // assignment of the single input to the single output.
+  struct FlatCell {
+    const rtl::Cell* cell;
+    std::vector<int32_t> inputs;
+    std::vector<int32_t> outputs;
+  };
+
+  int32_t NewSlot(std::string name) {
+    slot_names_.push_back(std::move(name));
+    return slot_names_.size() - 1;
+  }
+
+  // Adds the cells of `module` to cells_, inlining submodule instances.
+  // `net_slots` holds the slots of the nets already connected outside of the
+  // module (its ports, for a submodule).
+  absl::Status Inline(const rtl::Module& module, std::string_view prefix,
+                      NetSlots& net_slots);
+
+  // Orders cells_ by level, the length of the longest path of cells leading
+  // to each.
+  absl::Status Levelize();
+
+  absl::Status EmitCell(const FlatCell& cell);
+
+  // Emits the operations computing `ast` for `cell`, returning the slot
+  // holding its value.
+  absl::StatusOr<int32_t> EmitAst(const function::Ast& ast,
+                                  const FlatCell& cell);
+
+  // Emits the operations computing the internal pin `pin` of `cell` as the sum
+  // of the minterms of its truth table.
+  absl::StatusOr<int32_t> EmitStateTablePin(const FlatCell& cell,
+                                            const std::string& pin);
+
+  int32_t EmitOp(OpKind kind, int32_t lhs, int32_t rhs = kZeroSlot) {
+    int32_t dst = NewSlot("");
+    result_.ops_.push_back(CompiledModule::Op{kind, dst, lhs, rhs});
+    return dst;
+  }
+
+  absl::StatusOr<const function::Ast*> GetFunction(
+      const CellLibraryEntry* entry, const std::string& pin);
+
+  absl::StatusOr<const std::vector<bool>*> GetTruthTable(
+      const rtl::Cell& cell, const std::string& pin);
+
+  const rtl::Netlist& netlist_;
+  // The name of each slot (empty for temporaries), for error messages.
+  std::vector<std::string> slot_names_;
+  std::vector<FlatCell> cells_;
+
+  // The parsed functions and truth tables of the pins of cell library
+  // entries, shared by all instances.
+  absl::flat_hash_map<std::pair<const CellLibraryEntry*, std::string>,
+                      function::Ast>
+      functions_;
+  absl::flat_hash_map<std::pair<const CellLibraryEntry*, std::string>,
+                      std::vector<bool>>
+      truth_tables_;
+
+  CompiledModule result_;
+};
+
+absl::StatusOr<CompiledModule> ModuleCompiler::Compile(
+    const rtl::Module& module) {
+  NewSlot("0");
+  NewSlot("1");
+  NetSlots net_slots;
+  for (rtl::NetRef input : module.inputs()) {
+    int32_t slot = NewSlot(input->name());
+    net_slots[input] = slot;
+    result_.input_slots_.push_back(slot);
+  }
+  XLS_RETURN_IF_ERROR(Inline(module, "", net_slots));
+  for (rtl::NetRef output : module.outputs()) {
+    auto it = net_slots.find(output);
+    if (it == net_slots.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Output %s is not driven.", output->name()));
+    }
+    result_.output_slots_.push_back(it->second);
+  }
+  XLS_RETURN_IF_ERROR(Levelize());
+  for (const FlatCell& cell : cells_) {
+    XLS_RETURN_IF_ERROR(EmitCell(cell));
+  }
+  result_.slot_count_ = slot_names_.size();
+  return std::move(result_);
+}
+
+absl::Status ModuleCompiler::Inline(const rtl::Module& module,
+                                    std::string_view prefix,
+                                    NetSlots& net_slots) {
+  net_slots[module.zero()] = kZeroSlot;
+  net_slots[module.one()] = kOneSlot;
+  auto slot = [&](rtl::NetRef net) {
+    auto [it, inserted] = net_slots.try_emplace(net, kZeroSlot);
+    if (inserted) {
+      it->second = NewSlot(absl::StrCat(prefix, net->name()));
+    }
+    return it->second;
+  };
+  // Unconnected output pins all refer to the dummy net; each gets its own slot
+  // so that every slot has a single driver.
+  auto output_slot = [&](rtl::NetRef net) {
+    if (net == module.GetDummyRef()) {
+      return NewSlot(absl::StrCat(prefix, net->name()));
+    }
+    return slot(net);
+  };
+
+  for (const auto& [lhs, rhs] : module.assigns()) {
+    cells_.push_back(FlatCell{nullptr, {slot(rhs)}, {output_slot(lhs)}});
+  }
+
+  for (const auto& cell : module.cells()) {
+    std::optional<const rtl::Module*> submodule =
+        netlist_.MaybeGetModule(cell->cell_library_entry()->name());
+    if (!submodule.has_value()) {
+      FlatCell flat_cell{cell.get()};
+      for (const auto& input : cell->inputs()) {
+        flat_cell.inputs.push_back(slot(input.netref));
+      }
+      for (const auto& output : cell->outputs()) {
+        flat_cell.outputs.push_back(output_slot(output.netref));
+      }
+      cells_.push_back(std::move(flat_cell));
+      continue;
+    }
+
+    // Inline the submodule with its ports bound to the slots of the nets
+    // connected to the instance. As in the Interpreter, the inputs of a module
+    // are in the order of its cell library entry's input names.
+    const rtl::Module* child = submodule.value();
+    absl::Span<const std::string> input_names =
+        child->AsCellLibraryEntry()->input_names();
+    NetSlots child_slots;
+    for (const auto& input : cell->inputs()) {
+      auto it = std::find(input_names.begin(), input_names.end(), input.name);
+      XLS_RET_CHECK(it != input_names.end()) << absl::StrFormat(
+          "Could not find input pin \"%s\" in module \"%s\", referenced in "
+          "cell \"%s\"!",
+          input.name, child->name(), cell->name());
+      child_slots[child->inputs()[it - input_names.begin()]] =
+          slot(input.netref);
+    }
+    for (const auto& output : cell->outputs()) {
+      XLS_ASSIGN_OR_RETURN(rtl::NetRef child_net,
+                           child->ResolveNet(output.name));
+      child_slots[child_net] = output_slot(output.netref);
+    }
+    XLS_RETURN_IF_ERROR(
+        Inline(*child, absl::StrCat(prefix, cell->name(), "/"), child_slots));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ModuleCompiler::Levelize() {
+  constexpr int64_t kUndriven = -1;
+  constexpr int64_t kPrimary = -2;
+  std::vector<int64_t> drivers(slot_names_.size(), kUndriven);
+  drivers[kZeroSlot] = kPrimary;
+  drivers[kOneSlot] = kPrimary;
+  for (int32_t slot : result_.input_slots_) {
+    drivers[slot] = kPrimary;
+  }
+  for (int64_t i = 0; i < cells_.size(); ++i) {
+    for (int32_t slot : cells_[i].outputs) {
+      if (drivers[slot] != kUndriven) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Net %s has more than one driver.", slot_names_[slot]));
+      }
+      drivers[slot] = i;
+    }
+  }
+  for (int32_t slot : result_.output_slots_) {
+    if (drivers[slot] == kUndriven) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Output %s is not driven.", slot_names_[slot]));
+    }
+  }
+
+  // Visit the cells in topological order, computing the level of each.
+  std::vector<std::vector<int64_t>> users(slot_names_.size());
+  std::vector<int64_t> missing_inputs(cells_.size(), 0);
+  std::vector<int64_t> levels(cells_.size(), 0);
+  std::deque<int64_t> ready;
+  for (int64_t i = 0; i < cells_.size(); ++i) {
+    for (int32_t slot : cells_[i].inputs) {
+      if (drivers[slot] == kUndriven) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Net %s is not driven.", slot_names_[slot]));
+      }
+      if (drivers[slot] >= 0) {
+        users[slot].push_back(i);
+        ++missing_inputs[i];
+      }
+    }
+    if (missing_inputs[i] == 0) {
+      ready.push_back(i);
+    }
+  }
+  std::vector<int64_t> order;
+  order.reserve(cells_.size());
+  while (!ready.empty()) {
+    int64_t i = ready.front();
+    ready.pop_front();
+    order.push_back(i);
+    for (int32_t slot : cells_[i].outputs) {
+      for (int64_t user : users[slot]) {
+        levels[user] = std::max(levels[user], levels[i] + 1);
+        if (--missing_inputs[user] == 0) {
+          ready.push_back(user);
+        }
+      }
+    }
+  }
+  if (order.size() != cells_.size()) {
+    for (int64_t i = 0; i < cells_.size(); ++i) {
+      if (missing_inputs[i] > 0 && !cells_[i].outputs.empty()) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains a cycle and cannot be compiled. Example: net %s",
+            slot_names_[cells_[i].outputs.front()]));
+      }
+    }
+  }
+
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return levels[a] < levels[b];
+  });
+  std::vector<FlatCell> sorted_cells;
+  sorted_cells.reserve(cells_.size());
+  for (int64_t i : order) {
+    sorted_cells.push_back(std::move(cells_[i]));
+    result_.level_count_ = std::max(result_.level_count_, levels[i] + 1);
+  }
+  cells_ = std::move(sorted_cells);
+  return absl::OkStatus();
+}
+
+absl::Status ModuleCompiler::EmitCell(const FlatCell& cell) {
+  std::vector<CompiledModule::Op>& ops = result_.ops_;
+  if (cell.cell == nullptr) {
+    ops.push_back(CompiledModule::Op{OpKind::kCopy, cell.outputs[0],
+                                     cell.inputs[0], kZeroSlot});
+    return absl::OkStatus();
+  }
+  const CellLibraryEntry* entry = cell.cell->cell_library_entry();
+  for (int64_t i = 0; i < cell.outputs.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(const function::Ast* function,
+                         GetFunction(entry, cell.cell->outputs()[i].name));
+    int64_t first_op = ops.size();
+    XLS_ASSIGN_OR_RETURN(int32_t value, EmitAst(*function, cell));
+    // Write the value computed by the last operation directly to the output
+    // rather than copying it there.
+    if (ops.size() > first_op && ops.back().dst == value) {
+      ops.back().dst = cell.outputs[i];
+    } else {
+      ops.push_back(CompiledModule::Op{OpKind::kCopy, cell.outputs[i], value,
+                                       kZeroSlot});
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int32_t> ModuleCompiler::EmitAst(const function::Ast& ast,
+                                                const FlatCell& cell) {
+  switch (ast.kind()) {
+    case function::Ast::Kind::kIdentifier: {
+      absl::Span<const rtl::Cell::Pin> inputs = cell.cell->inputs();
+      for (int64_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].name == ast.name()) {
+          return cell.inputs[i];
+        }
+      }
+      for (const auto& internal : cell.cell->internal_pins()) {
+        if (internal.name == ast.name()) {
+          return EmitStateTablePin(cell, internal.name);
+        }
+      }
+      return absl::NotFoundError(
+          absl::StrFormat("Identifier \"%s\" not found in cell %s's inputs "
+                          "or internal signals.",
+                          ast.name(), cell.cell->name()));
+    }
+    case function::Ast::Kind::kLiteralZero:
+      return kZeroSlot;
+    case function::Ast::Kind::kLiteralOne:
+      return kOneSlot;
+    case function::Ast::Kind::kNot: {
+      XLS_ASSIGN_OR_RETURN(int32_t value, EmitAst(ast.children()[0], cell));
+      return EmitOp(OpKind::kNot, value);
+    }
+    case function::Ast::Kind::kAnd:
+    case function::Ast::Kind::kOr:
+    case function::Ast::Kind::kXor: {
+      XLS_ASSIGN_OR_RETURN(int32_t lhs, EmitAst(ast.children()[0], cell));
+      XLS_ASSIGN_OR_RETURN(int32_t rhs, EmitAst(ast.children()[1], cell));
+      OpKind kind = ast.kind() == function::Ast::Kind::kAnd  ? OpKind::kAnd
+                    : ast.kind() == function::Ast::Kind::kOr ? OpKind::kOr
+                                                             : OpKind::kXor;
+      return EmitOp(kind, lhs, rhs);
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown AST element type: ", static_cast<int>(ast.kind())));
+}
+
+absl::StatusOr<int32_t> ModuleCompiler::EmitStateTablePin(
+    const FlatCell& cell, const std::string& pin) {
+  XLS_ASSIGN_OR_RETURN(const std::vector<bool>* truth_table,
+                       GetTruthTable(*cell.cell, pin));
+  std::vector<std::optional<int32_t>> inverted_inputs(cell.inputs.size());
+  int32_t result = kZeroSlot;
+  for (int64_t row = 0; row < truth_table->size(); ++row) {
+    if (!(*truth_table)[row]) {
+      continue;
+    }
+    int32_t minterm = kOneSlot;
+    for (int64_t i = 0; i < cell.inputs.size(); ++i) {
+      int32_t literal;
+      if ((row >> i) & 1) {
+        literal = cell.inputs[i];
+      } else {
+        if (!inverted_inputs[i].has_value()) {
+          inverted_inputs[i] = EmitOp(OpKind::kNot, cell.inputs[i]);
+        }
+        literal = inverted_inputs[i].value();
+      }
+      minterm = minterm == kOneSlot ? literal
+                                    : EmitOp(OpKind::kAnd, minterm, literal);
+    }
+    result = result == kZeroSlot ? minterm
+                                 : EmitOp(OpKind::kOr, result, minterm);
+  }
+  return result;
+}
+
+absl::StatusOr<const function::Ast*> ModuleCompiler::GetFunction(
+    const CellLibraryEntry* entry, const std::string& pin) {
+  auto key = std::make_pair(entry, pin);
+  auto it = functions_.find(key);
+  if (it == functions_.end()) {
+    auto function_it = entry->output_pin_to_function().find(pin);
+    if (function_it == entry->output_pin_to_function().end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Output pin %s of cell %s has no function.", pin, entry->name()));
+    }
+    XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                         function::Parser::ParseFunction(function_it->second));
+    it = functions_.emplace(key, std::move(ast)).first;
+  }
+  return &it->second;
+}
+
+absl::StatusOr<const std::vector<bool>*> ModuleCompiler::GetTruthTable(
+    const rtl::Cell& cell, const std::string& pin) {
+  const CellLibraryEntry* entry = cell.cell_library_entry();
+  auto key = std::make_pair(entry, pin);
+  auto it = truth_tables_.find(key);
+  if (it != truth_tables_.end()) {
+    return &it->second;
+  }
+  XLS_RET_CHECK(entry->state_table().has_value());
+  int64_t input_count = cell.inputs().size();
+  if (input_count > kMaxStateTableInputs) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Cannot compile the state table of cell %s: it has %d inputs; at most "
+        "%d are supported.",
+        entry->name(), input_count, kMaxStateTableInputs));
+  }
+  std::vector<bool> truth_table(int64_t{1} << input_count);
+  for (int64_t row = 0; row < truth_table.size(); ++row) {
+    StateTable::InputStimulus stimulus;
+    for (int64_t i = 0; i < input_count; ++i) {
+      stimulus[cell.inputs()[i].name] = (row >> i) & 1;
+    }
+    XLS_ASSIGN_OR_RETURN(bool value,
+                         entry->state_table()->GetSignalValue(stimulus, pin));
+    truth_table[row] = value;
+  }
+  return &truth_tables_.emplace(key, std::move(truth_table)).first->second;
+}
+
+absl::StatusOr<CompiledModule> CompiledModule::Compile(
+    const rtl::Netlist& netlist, const rtl::Module& module) {
+  return ModuleCompiler(netlist).Compile(module);
+}
+
+std::vector<uint64_t> CompiledModule::Evaluate(
+    absl::Span<const uint64_t> inputs, int64_t word_count) const {
+  XLS_CHECK_EQ(inputs.size(), input_count() * word_count);
+  std::vector<uint64_t> values(slot_count_ * word_count, 0);
+  std::fill_n(values.begin() + kOneSlot * word_count, word_count,
+              ~uint64_t{0});
+  for (int64_t i = 0; i < input_count(); ++i) {
+    std::copy_n(inputs.begin() + i * word_count, word_count,
+                values.begin() + input_slots_[i] * word_count);
+  }
+
+  uint64_t* words = values.data();
+  for (const Op& op : ops_) {
+    uint64_t* dst = words + op.dst * word_count;
+    const uint64_t* lhs = words + op.lhs * word_count;
+    const uint64_t* rhs = words + op.rhs * word_count;
+    switch (op.kind) {
+      case OpKind::kCopy:
+        for (int64_t w = 0; w < word_count; ++w) {
+          dst[w] = lhs[w];
+        }
+        break;
+      case OpKind::kNot:
+        for (int64_t w = 0; w < word_count; ++w) {
+          dst[w] = ~lhs[w];
+        }
+        break;
+      case OpKind::kAnd:
+        for (int64_t w = 0; w < word_count; ++w) {
+          dst[w] = lhs[w] & rhs[w];
+        }
+        break;
+      case OpKind::kOr:
+        for (int64_t w = 0; w < word_count; ++w) {
+          dst[w] = lhs[w] | rhs[w];
+        }
+        break;
+      case OpKind::kXor:
+        for (int64_t w = 0; w < word_count; ++w) {
+          dst[w] = lhs[w] ^ rhs[w];
+        }
+        break;
+    }
+  }
+
+  std::vector<uint64_t> outputs(output_count() * word_count);
+  for (int64_t i = 0; i < output_count(); ++i) {
+    std::copy_n(values.begin() + output_slots_[i] * word_count, word_count,
+                outputs.begin() + i * word_count);
+  }
+  return outputs;
+}
+
+void CompiledModule::EvaluateBatch(
+    absl::Span<const std::vector<bool>> vectors, int64_t start,
+    int64_t word_count, std::vector<std::vector<bool>>& outputs) const {
+  int64_t end = std::min<int64_t>(vectors.size(),
+                                  start + word_count * kVectorsPerWord);
+  std::vector<uint64_t> inputs(input_count() * word_count, 0);
+  for (int64_t v = start; v < end; ++v) {
+    int64_t word = (v - start) / kVectorsPerWord;
+    uint64_t bit = uint64_t{1} << ((v - start) % kVectorsPerWord);
+    for (int64_t i = 0; i < input_count(); ++i) {
+      if (vectors[v][i]) {
+        inputs[i * word_count + word] |= bit;
+      }
+    }
+  }
+  std::vector<uint64_t> results = Evaluate(inputs, word_count);
+  for (int64_t v = start; v < end; ++v) {
+    int64_t word = (v - start) / kVectorsPerWord;
+    int64_t bit = (v - start) % kVectorsPerWord;
+    std::vector<bool>& output = outputs[v];
+    output.resize(output_count());
+    for (int64_t i = 0; i < output_count(); ++i) {
+      output[i] = (results[i * word_count + word] >> bit) & 1;
+    }
+  }
+}
+
+absl::StatusOr<std::vector<std::vector<bool>>> CompiledModule::EvaluateVectors(
+    absl::Span<const std::vector<bool>> vectors, int64_t batch_words,
+    int64_t num_threads) const {
+  XLS_RET_CHECK_GT(batch_words, 0);
+  for (int64_t v = 0; v < vectors.size(); ++v) {
+    if (vectors[v].size() != input_count()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Vector %d has %d values; the module has %d inputs.", v,
+          vectors[v].size(), input_count()));
+    }
+  }
+
+  // Batches are independent, so the threads only share the (immutable)
+  // program and write the outputs of distinct vectors.
+  std::vector<std::vector<bool>> outputs(vectors.size());
+  int64_t batch_size = batch_words * kVectorsPerWord;
+  int64_t batch_count = CeilOfRatio<int64_t>(vectors.size(), batch_size);
+  BoundedParallelFor(0, batch_count, std::max<int64_t>(num_threads, 1),
+                     [&](int64_t b) {
+                       EvaluateBatch(vectors, b * batch_size, batch_words,
+                                     outputs);
+                     });
+  return outputs;
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,115 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_MODULE_H_
+#define XLS_NETLIST_COMPILED_MODULE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// A netlist module compiled to a straight-line program of bitwise operations
+// on 64-bit words, for fast evaluation of many input vectors. Bit i of each
+// word holds the value of a net under the i-th of 64 independent vectors, so
+// one pass over the program evaluates 64 vectors.
+//
+// Compilation inlines submodule instances, levelizes the cells and translates
+// the function of each cell output pin (or, for pins defined by a state table,
+// its truth table) into operations, so evaluation involves no lookups. Like
+// the Interpreter, cells are evaluated as combinational functions of their
+// inputs; flops pass their input through.
+class CompiledModule {
+ public:
+  // The number of vectors evaluated per word.
+  static constexpr int64_t kVectorsPerWord = 64;
+
+  // Compiles `module`; instances of other modules of `netlist` are inlined.
+  static absl::StatusOr<CompiledModule> Compile(const rtl::Netlist& netlist,
+                                                const rtl::Module& module);
+
+  int64_t input_count() const { return input_slots_.size(); }
+  int64_t output_count() const { return output_slots_.size(); }
+
+  // Returns the number of levels of cells, i.e., the length of the longest
+  // path through the (inlined) module in cells.
+  int64_t level_count() const { return level_count_; }
+
+  // Returns the number of word operations evaluated per pass.
+  int64_t op_count() const { return ops_.size(); }
+
+  // Evaluates `word_count` words of vectors. `inputs` holds `word_count` words
+  // for each module input, in the order of rtl::Module::inputs() (the words
+  // of input i are at inputs[i * word_count + w]). Returns the values of the
+  // module outputs in the same layout. Evaluating several words per pass
+  // amortizes the dispatch of each operation and lets the compiler vectorize
+  // it, e.g., 512 vectors per instruction with AVX-512 and a `word_count` of
+  // 8.
+  std::vector<uint64_t> Evaluate(absl::Span<const uint64_t> inputs,
+                                 int64_t word_count) const;
+
+  // Evaluates each of `vectors`, which holds the value of each module input
+  // in order, and returns the values of the module outputs for each. Vectors
+  // are evaluated in batches of `batch_words` words; the batches are divided
+  // between up to `num_threads` threads of the shared thread pool (the calling
+  // thread if zero).
+  absl::StatusOr<std::vector<std::vector<bool>>> EvaluateVectors(
+      absl::Span<const std::vector<bool>> vectors, int64_t batch_words = 8,
+      int64_t num_threads = 0) const;
+
+ private:
+  friend class ModuleCompiler;
+
+  enum class OpKind : uint8_t {
+    kCopy,
+    kNot,
+    kAnd,
+    kOr,
+    kXor,
+  };
+
+  // An operation writing the words of slot `dst`; `rhs` is unused by unary
+  // operations.
+  struct Op {
+    OpKind kind;
+    int32_t dst;
+    int32_t lhs;
+    int32_t rhs;
+  };
+
+  CompiledModule() = default;
+
+  // Evaluates the vectors at indices [start, start + word_count * 64) of
+  // `vectors` (or up to the end), writing their outputs to `outputs`.
+  void EvaluateBatch(absl::Span<const std::vector<bool>> vectors,
+                     int64_t start, int64_t word_count,
+                     std::vector<std::vector<bool>>& outputs) const;
+
+  // The value slots: slot 0 always holds zeros and slot 1 ones.
+  int64_t slot_count_ = 2;
+  std::vector<int32_t> input_slots_;
+  std::vector<int32_t> output_slots_;
+  std::vector<Op> ops_;
+  int64_t level_count_ = 0;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_MODULE_H_
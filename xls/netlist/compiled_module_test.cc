@@ -0,0 +1,244 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_module.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class CompiledModuleTest : public ::testing::Test {
+ protected:
+  void Parse(std::string_view module_text) {
+    XLS_ASSERT_OK_AND_ASSIGN(cell_library_, MakeFakeCellLibrary());
+    rtl::Scanner scanner(module_text);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        netlist_, rtl::Parser::ParseNetlist(&cell_library_, &scanner));
+    XLS_ASSERT_OK_AND_ASSIGN(module_, netlist_->GetModule("main"));
+  }
+
+  // Evaluates all combinations of the module inputs with both the compiled
+  // module and the Interpreter and checks that they agree.
+  void ExpectMatchesInterpreter(const CompiledModule& compiled) {
+    int64_t input_count = module_->inputs().size();
+    std::vector<std::vector<bool>> vectors;
+    for (int64_t i = 0; i < (int64_t{1} << input_count); ++i) {
+      std::vector<bool>& vector = vectors.emplace_back();
+      for (int64_t j = 0; j < input_count; ++j) {
+        vector.push_back((i >> j) & 1);
+      }
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::vector<std::vector<bool>> outputs,
+        compiled.EvaluateVectors(vectors, /*batch_words=*/1));
+    ASSERT_EQ(outputs.size(), vectors.size());
+
+    Interpreter interpreter(netlist_.get());
+    for (int64_t i = 0; i < vectors.size(); ++i) {
+      NetRef2Value inputs;
+      for (int64_t j = 0; j < input_count; ++j) {
+        inputs[module_->inputs()[j]] = vectors[i][j];
+      }
+      XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value expected,
+                               interpreter.InterpretModule(module_, inputs));
+      ASSERT_EQ(outputs[i].size(), module_->outputs().size());
+      for (int64_t j = 0; j < outputs[i].size(); ++j) {
+        EXPECT_EQ(outputs[i][j], expected.at(module_->outputs()[j]))
+            << "vector " << i << ", output " << j;
+      }
+    }
+  }
+
+  CellLibrary cell_library_;
+  std::unique_ptr<rtl::Netlist> netlist_;
+  const rtl::Module* module_ = nullptr;
+};
+
+TEST_F(CompiledModuleTest, Tree) {
+  Parse(R"(
+module main(i0, i1, i2, i3, o0);
+  input i0, i1, i2, i3;
+  output o0;
+  wire and_o, or_o;
+
+  AND and0 ( .A(i0), .B(i1), .Z(and_o) );
+  OR or0 ( .A(i2), .B(i3), .Z(or_o) );
+  XOR xor0 ( .A(and_o), .B(or_o), .Z(o0) );
+endmodule
+)");
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(*netlist_, *module_));
+  EXPECT_EQ(compiled.input_count(), 4);
+  EXPECT_EQ(compiled.output_count(), 1);
+  EXPECT_EQ(compiled.level_count(), 2);
+  ExpectMatchesInterpreter(compiled);
+}
+
+TEST_F(CompiledModuleTest, Evaluate) {
+  Parse(R"(
+module main(a, b, o);
+  input a, b;
+  output o;
+
+  NAND nand0 ( .A(a), .B(b), .ZN(o) );
+endmodule
+)");
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(*netlist_, *module_));
+  // Two words of vectors for each input.
+  std::vector<uint64_t> outputs = compiled.Evaluate(
+      {0xff00ff00ff00ff00, 0x1, 0xf0f0f0f0f0f0f0f0, 0x3}, /*word_count=*/2);
+  EXPECT_THAT(outputs, ::testing::ElementsAre(~uint64_t{0xf000f000f000f000},
+                                              ~uint64_t{0x1}));
+}
+
+TEST_F(CompiledModuleTest, Submodules) {
+  Parse(R"(
+module submodule_0 (i2_0, i2_1, o2_0);
+  input i2_0, i2_1;
+  output o2_0;
+
+  AND and0( .A(i2_0), .B(i2_1), .Z(o2_0) );
+endmodule
+
+module submodule_1 (i2_2, i2_3, o2_1);
+  input i2_2, i2_3;
+  output o2_1;
+
+  OR or0( .A(i2_2), .B(i2_3), .Z(o2_1) );
+endmodule
+
+module submodule_2 (i1_0, i1_1, i1_2, i1_3, o1_0);
+  input i1_0, i1_1, i1_2, i1_3;
+  output o1_0;
+  wire res0, res1;
+
+  submodule_0 and0 ( .i2_0(i1_0), .i2_1(i1_1), .o2_0(res0) );
+  submodule_1 or0 ( .i2_2(i1_2), .i2_3(i1_3), .o2_1(res1) );
+  XOR xor0 ( .A(res0), .B(res1), .Z(o1_0) );
+endmodule
+
+module main (i0, i1, i2, i3, o0);
+  input i0, i1, i2, i3;
+  output o0;
+
+  submodule_2 bleh( .i1_0(i0), .i1_1(i1), .i1_2(i2), .i1_3(i3), .o1_0(o0) );
+endmodule
+)");
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(*netlist_, *module_));
+  ExpectMatchesInterpreter(compiled);
+}
+
+TEST_F(CompiledModuleTest, StateTables) {
+  Parse(R"(
+module main(i0, i1, i2, i3, o0);
+  input i0, i1, i2, i3;
+  output o0;
+  wire and0_out, and1_out;
+
+  AND and0 ( .A(i0), .B(i1), .Z(and0_out) );
+  STATETABLE_AND and1 (.A(i2), .B(i3), .Z(and1_out) );
+  AND and2 ( .A(and0_out), .B(and1_out), .Z(o0) );
+endmodule
+)");
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(*netlist_, *module_));
+  ExpectMatchesInterpreter(compiled);
+}
+
+TEST_F(CompiledModuleTest, Assigns) {
+  Parse(R"(
+module main (A, B, out);
+  input A;
+  input B;
+  wire [1:0] i0;
+  wire [2:0] i1;
+  output [7:0] out;
+  wire [7:0] out;
+
+  assign i0 = { A, B };
+  assign i1 = { 1'b1, i0 };
+  assign out = { i1, B, 4'ha };
+endmodule
+)");
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(*netlist_, *module_));
+  ExpectMatchesInterpreter(compiled);
+}
+
+TEST_F(CompiledModuleTest, ManyVectorsOnThreads) {
+  Parse(R"(
+module main(i0, i1, i2, o0, o1);
+  input i0, i1, i2;
+  output o0, o1;
+
+  AOI21 aoi0 ( .A(i0), .B(i1), .C(i2), .ZN(o0) );
+  NOR4 nor0 ( .A(i0), .B(i1), .C(i2), .D(o0), .ZN(o1) );
+endmodule
+)");
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(*netlist_, *module_));
+  // More vectors than fit in a batch, with a partial last word.
+  std::vector<std::vector<bool>> vectors;
+  for (int64_t i = 0; i < 1000; ++i) {
+    vectors.push_back({(i % 2) == 1, (i % 3) == 1, (i % 7) == 1});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<std::vector<bool>> outputs,
+                           compiled.EvaluateVectors(vectors, /*batch_words=*/2,
+                                                    /*num_threads=*/3));
+  ASSERT_EQ(outputs.size(), vectors.size());
+  for (int64_t i = 0; i < vectors.size(); ++i) {
+    bool o0 = !((vectors[i][0] && vectors[i][1]) || vectors[i][2]);
+    bool o1 = !(vectors[i][0] || vectors[i][1] || vectors[i][2] || o0);
+    EXPECT_EQ(outputs[i], std::vector<bool>({o0, o1})) << "vector " << i;
+  }
+}
+
+TEST_F(CompiledModuleTest, WrongVectorSize) {
+  Parse(R"(
+module main(a, o);
+  input a;
+  output o;
+
+  INV inv0 ( .A(a), .ZN(o) );
+endmodule
+)");
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledModule compiled,
+                           CompiledModule::Compile(*netlist_, *module_));
+  std::vector<std::vector<bool>> vectors = {{true, false}};
+  EXPECT_THAT(compiled.EvaluateVectors(vectors),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("the module has 1 inputs")));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
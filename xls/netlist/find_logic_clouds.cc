@@ -14,6 +14,12 @@
 
 #include "xls/netlist/find_logic_clouds.h"
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/logging/logging.h"
@@ -39,114 +45,135 @@ void Cluster::SortCells() {
   std::sort(other_cells_.begin(), other_cells_.end(), cell_name_lt);
 }
 
-std::vector<Cluster> FindLogicClouds(const Module& module,
-                                     bool include_vacuous) {
-  UnionFind<Cell*> cell_to_uf;
-
-  // Gets-or-adds the given cell to the UnionFind.
-  auto get_uf = [&cell_to_uf](Cell* c) -> Cell* {
-    cell_to_uf.Insert(c);
-    return cell_to_uf.Find(c);
-  };
-
-  // Helper for debugging that counts the number of equivalence classes in
-  // cell_to_uf.
-  auto count_equivalence_classes = [&cell_to_uf]() -> int64_t {
-    return cell_to_uf.GetRepresentatives().size();
-  };
-
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    XLS_VLOG(4) << "Considering cell: " << cell->name();
+LogicClouds FindLogicCloudsDense(const Module& module, bool include_vacuous) {
+  absl::Span<const std::unique_ptr<Cell>> cells = module.cells();
+  DenseUnionFind cell_uf(cells.size());
 
-    // Flop output connectivity is excluded from the equivalence class, so we
-    // get partitions along flop (output) boundaries.
+  // Flop output connectivity is excluded from the equivalence classes, so we
+  // get partitions along flop (output) boundaries: a logic cell joins the class
+  // of every cell on its output nets, flops included, while the logic cells
+  // reading a net join each other's class whatever drives it.
+  for (const std::unique_ptr<Cell>& cell : cells) {
     if (cell->kind() == CellKind::kFlop) {
-      // For flops we just make sure an equivalence class is present in the
-      // map, in case it doesn't have any cells on the input side.
-      get_uf(cell);
-      XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                  << " equivalence classes for " << cell_to_uf.size()
-                  << " cells.";
       continue;
     }
-
-    for (auto& input : cell->inputs()) {
-      XLS_VLOG(4) << "- Considering input net: " << input.netref->name();
-      for (Cell* connected : input.netref->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        if (connected->kind() == CellKind::kFlop) {
-          XLS_VLOG(4) << absl::StreamFormat(
-              "-- Cell is connected to flop cell %s on an input pin; not "
-              "merging equivalence classes.",
-              connected->name());
-          continue;
-        }
-        XLS_VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                          cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                    << " equivalence classes for " << cell_to_uf.size()
-                    << " cells.";
+    for (const auto& output : cell->outputs()) {
+      for (Cell* connected : output.netref->connected_cells()) {
+        cell_uf.Union(cell->id(), connected->id());
       }
     }
-
-    for (const auto& iter : cell->outputs()) {
-      NetRef output = iter.netref;
-      XLS_VLOG(4) << "- Considering output net: " << output->name();
-      for (Cell* connected : output->connected_cells()) {
-        if (cell == connected) {
-          continue;
-        }
-        XLS_VLOG(4) << absl::StreamFormat("-- Cell %s is connected to cell %s",
-                                          cell->name(), connected->name());
-        cell_to_uf.Union(get_uf(cell), get_uf(connected));
-        XLS_VLOG(4) << "--- Now " << count_equivalence_classes()
-                    << " equivalence classes for " << cell_to_uf.size()
-                    << " cells.";
+  }
+  for (const std::unique_ptr<NetDef>& net : module.nets()) {
+    int64_t first_reader = -1;
+    for (Cell* reader : net->connected_input_cells()) {
+      if (reader->kind() == CellKind::kFlop) {
+        continue;
+      }
+      if (first_reader == -1) {
+        first_reader = reader->id();
+      } else {
+        cell_uf.Union(first_reader, reader->id());
       }
     }
   }
-
-  // Run through the cells and put them into clusters according to their
-  // equivalence classes.
-  absl::flat_hash_map<Cell*, Cluster> equivalence_set_to_cluster;
-  for (auto& item : module.cells()) {
-    Cell* cell = item.get();
-    equivalence_set_to_cluster[get_uf(cell)].Add(cell);
+  XLS_VLOG(3) << cell_uf.set_count() << " equivalence classes for "
+              << cells.size() << " cells.";
+
+  // Number the classes in order of their smallest cell id and count their
+  // flops and other cells.
+  std::vector<int64_t> cloud_of(cells.size(), -1);
+  std::vector<int64_t> flop_counts;
+  std::vector<int64_t> other_counts;
+  for (int64_t id = 0; id < cells.size(); ++id) {
+    int64_t root = cell_uf.Find(id);
+    if (cloud_of[root] == -1) {
+      cloud_of[root] = flop_counts.size();
+      flop_counts.push_back(0);
+      other_counts.push_back(0);
+    }
+    cloud_of[id] = cloud_of[root];
+    if (cells[id]->kind() == CellKind::kFlop) {
+      ++flop_counts[cloud_of[id]];
+    } else {
+      ++other_counts[cloud_of[id]];
+    }
   }
 
-  // Put them into a vector and sort each cluster's internal cells for
-  // determinism.
-  std::vector<Cluster> clusters;
-  for (auto& item : equivalence_set_to_cluster) {
-    Cluster& cluster = item.second;
-    if (!include_vacuous && (cluster.terminating_flops().size() == 1 &&
-                             cluster.other_cells().empty())) {
-      // Vacuous 'just a flop' cluster.
+  // Drop vacuous 'just a flop' clouds if requested and lay out the rest.
+  LogicClouds clouds;
+  std::vector<int64_t> final_index(flop_counts.size(), -1);
+  for (int64_t i = 0; i < flop_counts.size(); ++i) {
+    if (!include_vacuous && flop_counts[i] == 1 && other_counts[i] == 0) {
       continue;
     }
-    cluster.SortCells();
-    clusters.push_back(std::move(cluster));
+    final_index[i] = clouds.size();
+    clouds.flop_counts.push_back(flop_counts[i]);
+    clouds.offsets.push_back(clouds.offsets.back() + flop_counts[i] +
+                             other_counts[i]);
+  }
+  clouds.cell_ids.resize(clouds.offsets.back());
+  std::vector<int64_t> next_flop(clouds.offsets.begin(),
+                                 clouds.offsets.end() - 1);
+  std::vector<int64_t> next_other(clouds.size());
+  for (int64_t i = 0; i < clouds.size(); ++i) {
+    next_other[i] = clouds.offsets[i] + clouds.flop_counts[i];
+  }
+  for (int64_t id = 0; id < cells.size(); ++id) {
+    int64_t cloud = final_index[cloud_of[id]];
+    if (cloud == -1) {
+      continue;
+    }
+    if (cells[id]->kind() == CellKind::kFlop) {
+      clouds.cell_ids[next_flop[cloud]++] = id;
+    } else {
+      clouds.cell_ids[next_other[cloud]++] = id;
+    }
+  }
+  return clouds;
+}
+
+std::vector<Cluster> FindLogicClouds(const Module& module,
+                                     bool include_vacuous) {
+  LogicClouds clouds = FindLogicCloudsDense(module, include_vacuous);
+
+  // Build the clusters, sorting each one's internal cells for determinism.
+  absl::Span<const std::unique_ptr<Cell>> cells = module.cells();
+  std::vector<Cluster> clusters(clouds.size());
+  for (int64_t i = 0; i < clouds.size(); ++i) {
+    for (int64_t id : clouds.terminating_flops(i)) {
+      clusters[i].Add(cells[id].get());
+    }
+    for (int64_t id : clouds.other_cells(i)) {
+      clusters[i].Add(cells[id].get());
+    }
+    clusters[i].SortCells();
   }
 
   // For convenience (for now) we convert the cell names to a string and rely on
-  // string comparison for deterministic order.
+  // string comparison for deterministic order. The keys are built once up
+  // front rather than in every comparison.
   auto cells_to_str = [](absl::Span<const Cell* const> cells) {
     return absl::StrJoin(cells, ", ", [](std::string* out, const Cell* cell) {
       absl::StrAppend(out, cell->name());
     });
   };
-  auto cluster_sort_lt = [cells_to_str](const Cluster& a, const Cluster& b) {
-    return std::make_pair(cells_to_str(a.terminating_flops()),
-                          cells_to_str(a.other_cells())) <
-           std::make_pair(cells_to_str(b.terminating_flops()),
-                          cells_to_str(b.other_cells()));
-  };
-  std::sort(clusters.begin(), clusters.end(), cluster_sort_lt);
-  return clusters;
+  std::vector<std::pair<std::string, std::string>> keys;
+  keys.reserve(clusters.size());
+  for (const Cluster& cluster : clusters) {
+    keys.push_back({cells_to_str(cluster.terminating_flops()),
+                    cells_to_str(cluster.other_cells())});
+  }
+  std::vector<int64_t> order(clusters.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&keys](int64_t a, int64_t b) { return keys[a] < keys[b]; });
+
+  std::vector<Cluster> sorted;
+  sorted.reserve(clusters.size());
+  for (int64_t i : order) {
+    sorted.push_back(std::move(clusters[i]));
+  }
+  return sorted;
 }
 
 std::string ClustersToString(absl::Span<const Cluster> clusters) {
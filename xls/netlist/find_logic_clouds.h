@@ -15,8 +15,11 @@
 #ifndef XLS_NETLIST_FIND_LOGIC_CLOUDS_H_
 #define XLS_NETLIST_FIND_LOGIC_CLOUDS_H_
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "xls/netlist/netlist.h"
 
 namespace xls {
@@ -43,8 +46,39 @@ class Cluster {
   std::vector<Cell*> other_cells_;
 };
 
+// The logic clouds of a module in compressed sparse row form, which stays
+// compact for modules of millions of cells. Cells are identified by their ids
+// (see Cell::id()). The cells of cloud i are cell_ids[offsets[i]] through
+// cell_ids[offsets[i + 1] - 1]: first its terminating flops, then its other
+// cells, each in increasing order of id. Clouds are ordered by the smallest id
+// of their cells.
+struct LogicClouds {
+  // Has one entry more than there are clouds.
+  std::vector<int64_t> offsets = {0};
+  // The number of terminating flops of each cloud.
+  std::vector<int64_t> flop_counts;
+  std::vector<int64_t> cell_ids;
+
+  int64_t size() const { return flop_counts.size(); }
+
+  absl::Span<const int64_t> terminating_flops(int64_t cloud) const {
+    return absl::MakeConstSpan(cell_ids).subspan(offsets[cloud],
+                                                 flop_counts[cloud]);
+  }
+  absl::Span<const int64_t> other_cells(int64_t cloud) const {
+    int64_t start = offsets[cloud] + flop_counts[cloud];
+    return absl::MakeConstSpan(cell_ids).subspan(start,
+                                                 offsets[cloud + 1] - start);
+  }
+};
+
+// Finds the logic clouds of the given module as for FindLogicClouds below, in
+// time and space linear in the size of the module.
+LogicClouds FindLogicCloudsDense(const Module& module,
+                                 bool include_vacuous = false);
+
 // Finds the connected clusters of logic cells between flops in the given module
-// and returns them. As noted in the definition of "Cluster", flops are
+// and returns them, ordered by the names of their cells. As noted in the definition of "Cluster", flops are
 // associated with their "input side" subgraphs; any logic following a final
 // flop stage has no associated "terminating flop".
 //
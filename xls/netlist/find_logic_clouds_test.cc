@@ -28,6 +28,9 @@ namespace netlist {
 namespace rtl {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
 TEST(ClusterTest, TwoSimpleClusters) {
   std::string netlist = R"(module main(clk, ai, ao);
   input clk;
@@ -131,6 +134,40 @@ cluster {
             ClustersToString(clusters));
 }
 
+TEST(ClusterTest, DenseCloudsInCsrForm) {
+  std::string netlist = R"(module main(clk, ai, ao);
+  input clk;
+  input ai;
+  output ao;
+  wire ain, a1, a1n, a2;
+
+  INV inv_a(.A(ai), .ZN(ain));
+  DFF dff_0(.D(ain), .Q(a1), .CLK(clk));
+  INV inv_b(.A(a1), .ZN(a1n));
+  DFF dff_1(.D(a1n), .Q(a2), .CLK(clk));
+  INV inv_c(.A(a2), .ZN(ao));
+endmodule)";
+  Scanner scanner(netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> n,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  for (int64_t i = 0; i < m->cells().size(); ++i) {
+    EXPECT_EQ(m->cells()[i]->id(), i);
+  }
+
+  // Cell ids follow declaration order: inv_a, dff_0, inv_b, dff_1, inv_c.
+  LogicClouds clouds = FindLogicCloudsDense(*m);
+  ASSERT_EQ(clouds.size(), 3);
+  EXPECT_THAT(clouds.offsets, ElementsAre(0, 2, 4, 5));
+  EXPECT_THAT(clouds.flop_counts, ElementsAre(1, 1, 0));
+  EXPECT_THAT(clouds.cell_ids, ElementsAre(1, 0, 3, 2, 4));
+  EXPECT_THAT(clouds.terminating_flops(1), ElementsAre(3));
+  EXPECT_THAT(clouds.other_cells(1), ElementsAre(2));
+  EXPECT_THAT(clouds.terminating_flops(2), IsEmpty());
+  EXPECT_THAT(clouds.other_cells(2), ElementsAre(4));
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
@@ -14,12 +14,21 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <filesystem>
+#include <memory>
+#include <string>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/variant.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -41,6 +50,16 @@ constexpr const char kPinKind[] = "pin";
 constexpr const char kFfKind[] = "ff";
 constexpr const char kStateTableKind[] = "statetable";
 
+// Bumped whenever extraction changes, invalidating cached CellLibraryProtos.
+constexpr std::string_view kCacheVersion = "1";
+
+// Returns the path of the cache entry of the Liberty file at `path` with the
+// given contents.
+std::string CacheEntryPath(std::string_view path, std::string_view contents) {
+  return absl::StrCat(path, ".", ContentDigest({kCacheVersion, contents}),
+                      ".cell_library.pb");
+}
+
 // Translates an individual signal value char to the protobuf equivalent.
 absl::StatusOr<StateTableSignalProto> LibertyToTableSignal(
     const std::string& input) {
@@ -291,6 +310,38 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   return proto;
 }
 
+absl::StatusOr<CellLibraryProto> ExtractFunctionsFromPath(
+    std::string_view path) {
+  std::filesystem::path entry;
+  {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<MemoryMappedFile> file,
+                         MemoryMappedFile::Open(path));
+    entry = CacheEntryPath(path, file->contents());
+  }
+  if (FileExists(entry).ok()) {
+    XLS_ASSIGN_OR_RETURN(std::string serialized, GetFileContents(entry));
+    CellLibraryProto proto;
+    if (proto.ParseFromString(serialized)) {
+      XLS_VLOG(1) << "Using cell library cached in " << entry;
+      return proto;
+    }
+    XLS_LOG(WARNING) << "Ignoring unparseable cell library cache entry "
+                     << entry;
+  }
+
+  XLS_ASSIGN_OR_RETURN(cell_lib::CharStream stream,
+                       cell_lib::CharStream::FromMemoryMappedFile(path));
+  XLS_ASSIGN_OR_RETURN(CellLibraryProto proto, ExtractFunctions(&stream));
+
+  absl::Status status =
+      AtomicallySetFileContents(entry, proto.SerializeAsString());
+  if (!status.ok()) {
+    XLS_LOG(WARNING) << "Unable to write cell library cache entry: "
+                     << status;
+  }
+  return proto;
+}
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
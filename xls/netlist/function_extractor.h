@@ -16,6 +16,7 @@
 #define XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 
 #include <string>
+#include <string_view>
 
 #include "absl/status/statusor.h"
 #include "xls/netlist/lib_parser.h"
@@ -31,6 +32,15 @@ namespace function {
 // logical operation of the cell or pin (in the case of multiple output pins).
 absl::StatusOr<CellLibraryProto> ExtractFunctions(cell_lib::CharStream* stream);
 
+// Returns the functions of the cells of the Liberty file at `path`, as
+// ExtractFunctions does. Parsing a large library takes minutes, so the result
+// is cached next to the file (as "<path>.<digest>.cell_library.pb", where
+// <digest> is a SHA-256 digest of the file contents) and read back by later
+// calls on the same contents. Failing to write the cache entry, e.g., because
+// the directory is read-only, is not an error.
+absl::StatusOr<CellLibraryProto> ExtractFunctionsFromPath(
+    std::string_view path);
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
@@ -14,9 +14,17 @@
 
 #include "xls/netlist/function_extractor.h"
 
+#include <filesystem>
+#include <string>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_replace.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/status/matchers.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
@@ -216,6 +224,79 @@ library (simple_statetable_cells) {
   EXPECT_EQ(row.next_internal_signals().at("X"), STATE_TABLE_SIGNAL_HIGH);
 }
 
+// Returns the cell library cache entries in `dir`.
+std::vector<std::filesystem::path> CacheEntries(
+    const std::filesystem::path& dir) {
+  std::vector<std::filesystem::path> entries;
+  for (const auto& file : std::filesystem::directory_iterator(dir)) {
+    if (absl::EndsWith(file.path().string(), ".cell_library.pb")) {
+      entries.push_back(file.path());
+    }
+  }
+  return entries;
+}
+
+TEST(FunctionExtractorTest, ExtractFromPathCachesProto) {
+  std::string lib = R"(
+library (blah) {
+  cell (cell_1) {
+    pin (i0) {
+      direction: input;
+    }
+    pin (o) {
+      direction: output;
+      function: "!i0";
+    }
+  }
+}
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path lib_path = temp_dir.path() / "cells.lib";
+  XLS_ASSERT_OK(SetFileContents(lib_path, lib));
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto,
+                           ExtractFunctionsFromPath(lib_path.string()));
+  ASSERT_EQ(proto.entries_size(), 1);
+  EXPECT_EQ(proto.entries(0).name(), "cell_1");
+  std::vector<std::filesystem::path> entries = CacheEntries(temp_dir.path());
+  ASSERT_EQ(entries.size(), 1);
+
+  // Later calls read the cache entry rather than the library.
+  CellLibraryProto cached_proto = proto;
+  cached_proto.mutable_entries(0)->set_name("cached");
+  XLS_ASSERT_OK(SetFileContents(entries[0], cached_proto.SerializeAsString()));
+  XLS_ASSERT_OK_AND_ASSIGN(proto, ExtractFunctionsFromPath(lib_path.string()));
+  EXPECT_EQ(proto.entries(0).name(), "cached");
+
+  // Changing the library invalidates the entry.
+  XLS_ASSERT_OK(SetFileContents(lib_path, absl::StrReplaceAll(
+                                              lib, {{"cell_1", "cell_2"}})));
+  XLS_ASSERT_OK_AND_ASSIGN(proto, ExtractFunctionsFromPath(lib_path.string()));
+  EXPECT_EQ(proto.entries(0).name(), "cell_2");
+  EXPECT_EQ(CacheEntries(temp_dir.path()).size(), 2);
+}
+
+TEST(FunctionExtractorTest, MemoryMappedStream) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path lib_path = temp_dir.path() / "cells.lib";
+  XLS_ASSERT_OK(SetFileContents(lib_path, R"(
+library (blah) {
+  cell (cell_1) {
+    pin (o) {
+      direction: output;
+      function: "1";
+    }
+  }
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      cell_lib::CharStream stream,
+      cell_lib::CharStream::FromMemoryMappedFile(lib_path.string()));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto, ExtractFunctions(&stream));
+  ASSERT_EQ(proto.entries_size(), 1);
+  EXPECT_EQ(proto.entries(0).output_pin_list().pins(0).function(), "1");
+}
+
 }  // namespace
 }  // namespace function
 }  // namespace netlist
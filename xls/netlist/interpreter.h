@@ -160,7 +160,10 @@ class AbstractInterpreter {
   absl::Mutex output_queue_guard_;  // protects output_queue_
   std::queue<QueueEntry> output_queue_ ABSL_GUARDED_BY(output_queue_guard_);
 
-  // Thread pool.
+  // Worker threads, which live as long as the interpreter and block on
+  // input_queue_ between modules. They are kept apart from the shared pool
+  // because InterpretModule only dispatches to threads blocked on the queue,
+  // and tasks of a busy pool would never be counted as available.
   std::vector<std::unique_ptr<xls::Thread>> threads_;
 
   // Keeps track of threads blocked on the input_queue_, ready to get a
@@ -17,6 +17,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
 
 namespace xls {
 namespace netlist {
@@ -32,6 +33,13 @@ namespace cell_lib {
       absl::StrCat("Could not open file at path: ", path));
 }
 
+/* static */ absl::StatusOr<CharStream> CharStream::FromMemoryMappedFile(
+    std::string_view path) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<MemoryMappedFile> mapped_file,
+                       MemoryMappedFile::Open(path));
+  return CharStream(std::move(mapped_file));
+}
+
 /* static */ absl::StatusOr<CharStream> CharStream::FromText(std::string text) {
   return CharStream(std::move(text));
 }
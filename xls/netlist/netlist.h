@@ -23,6 +23,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 
@@ -58,6 +59,11 @@ using AbstractNetRef = AbstractNetDef<EvalT>*;
 // The default and most common case is for bool.
 using NetRef = AbstractNetRef<>;
 
+// Forward declaration for use in AbstractCell and AbstractNetDef, whose ids are
+// assigned by the module.
+template <typename EvalT>
+class AbstractModule;
+
 // Represents a function that computes the value of an output pin of a cell.
 template <typename EvalT>
 using CellOutputEvalFn =
@@ -107,6 +113,11 @@ class AbstractCell {
   const std::string& name() const { return name_; }
   CellKind kind() const { return cell_library_entry_->kind(); }
 
+  // Returns the index of this cell in its module's cells(), or -1 if it has
+  // not been added to a module. Ids are dense, so they can index flat arrays
+  // of per-cell data.
+  int64_t id() const { return id_; }
+
   absl::Span<const Pin> inputs() const { return inputs_; }
   absl::Span<const OutputPin> outputs() const { return outputs_; }
   absl::Span<const Pin> internal_pins() const { return internal_pins_; }
@@ -150,6 +161,9 @@ class AbstractCell {
   std::vector<OutputPin> outputs_;
   std::vector<Pin> internal_pins_;
   std::optional<AbstractNetRef<EvalT>> clock_;
+  int64_t id_ = -1;
+
+  friend class AbstractModule<EvalT>;
 };
 
 using Cell = AbstractCell<>;
@@ -199,7 +213,13 @@ class AbstractNetDef {
 
   NetDeclKind kind() const { return kind_; }
 
+  // Returns the index of this net in its module's nets(), or -1 if it has not
+  // been added to a module.
+  int64_t id() const { return id_; }
+
  private:
+  friend class AbstractModule<EvalT>;
+
   std::string name_;
   // connected_cells_ contains all cells connected to this wire, as both inputs
   // and outputs;
@@ -209,6 +229,7 @@ class AbstractNetDef {
   // connected_cells_--all pointes in the former are also in the latter..
   std::vector<AbstractCell<EvalT>*> connected_input_cells_;
   NetDeclKind kind_;
+  int64_t id_ = -1;
 };
 
 using NetDef = AbstractNetDef<>;
@@ -476,9 +497,11 @@ class AbstractModule {
   absl::flat_hash_map<AbstractNetRef<EvalT>, AbstractNetRef<EvalT>>
       assign_nets_;
   std::vector<std::unique_ptr<AbstractNetDef<EvalT>>> nets_;
-  absl::flat_hash_map<std::string, AbstractNetRef<EvalT>> name_to_netref_;
+  // The keys of the name maps are views of the names held by the (stable)
+  // nets and cells, so that each name is stored once.
+  absl::flat_hash_map<std::string_view, AbstractNetRef<EvalT>> name_to_netref_;
   std::vector<std::unique_ptr<AbstractCell<EvalT>>> cells_;
-  absl::flat_hash_map<std::string, AbstractCell<EvalT>*> name_to_cell_;
+  absl::flat_hash_map<std::string_view, AbstractCell<EvalT>*> name_to_cell_;
   AbstractNetRef<EvalT> zero_;
   AbstractNetRef<EvalT> one_;
   AbstractNetRef<EvalT> dummy_;
@@ -601,9 +624,10 @@ absl::StatusOr<AbstractCell<EvalT>*> AbstractModule<EvalT>::AddCell(
         absl::StrCat("Module already has a cell with name: ", cell.name()));
   }
 
-  cells_.push_back(std::make_unique<AbstractCell<EvalT>>(cell));
+  cells_.push_back(std::make_unique<AbstractCell<EvalT>>(std::move(cell)));
   auto cell_ptr = cells_.back().get();
-  name_to_cell_[cell.name()] = cell_ptr;
+  cell_ptr->id_ = cells_.size() - 1;
+  name_to_cell_[cell_ptr->name()] = cell_ptr;
   return cell_ptr;
 }
 
@@ -622,7 +646,8 @@ absl::Status AbstractModule<EvalT>::AddNetDecl(NetDeclKind kind,
 
   nets_.emplace_back(std::make_unique<AbstractNetDef<EvalT>>(name, kind));
   AbstractNetRef<EvalT> ref = nets_.back().get();
-  name_to_netref_[name] = ref;
+  ref->id_ = nets_.size() - 1;
+  name_to_netref_[ref->name()] = ref;
   switch (kind) {
     case NetDeclKind::kInput:
       input_nets_.push_back(ref);
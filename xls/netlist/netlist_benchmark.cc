@@ -0,0 +1,225 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of netlist parsing, interpretation and analysis on synthetic
+// netlists of 10K to 10M cells. Each benchmark reports its throughput in
+// cells per second and the peak resident set size of the process so far.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/find_logic_clouds.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+#include "xls/solvers/z3_netlist_translator.h"
+#include "../z3/src/api/z3_api.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// The number of cells in each layer of a synthetic netlist, and the width of
+// its input and output ports.
+constexpr int64_t kLayerWidth = 64;
+
+// Returns the text of a module "main" of (about) `cell_count` cells in layers
+// of kLayerWidth. The first layer inverts the inputs, each later layer NANDs
+// adjacent outputs of the previous layer, and the last layer drives the
+// outputs. If `flop_period` is nonzero, every `flop_period`th layer is a layer
+// of flops instead, splitting the module into logic clouds.
+std::string GenerateNetlist(int64_t cell_count, int64_t flop_period) {
+  int64_t layer_count = std::max<int64_t>(cell_count / kLayerWidth, 2);
+  std::string text;
+  // Roughly the size of one cell instance.
+  text.reserve(layer_count * kLayerWidth * 48);
+  bool has_flops = flop_period > 0;
+  absl::StrAppend(&text, "module main(", has_flops ? "clk, " : "", "i, o);\n");
+  if (has_flops) {
+    absl::StrAppend(&text, "  input clk;\n");
+  }
+  absl::StrAppend(&text, "  input [", kLayerWidth - 1, ":0] i;\n");
+  absl::StrAppend(&text, "  output [", kLayerWidth - 1, ":0] o;\n");
+  absl::StrAppend(&text, "  wire [", layer_count * kLayerWidth - 1,
+                  ":0] n;\n");
+  for (int64_t layer = 0; layer < layer_count; ++layer) {
+    for (int64_t j = 0; j < kLayerWidth; ++j) {
+      int64_t index = layer * kLayerWidth + j;
+      std::string output = layer == layer_count - 1
+                               ? absl::StrCat("o[", j, "]")
+                               : absl::StrCat("n[", index, "]");
+      int64_t prev = index - kLayerWidth;
+      if (layer == 0) {
+        absl::StrAppend(&text, "  INV c", index, "(.A(i[", j, "]), .ZN(",
+                        output, "));\n");
+      } else if (has_flops && layer % flop_period == 0) {
+        absl::StrAppend(&text, "  DFF c", index, "(.D(n[", prev, "]), .Q(",
+                        output, "), .CLK(clk));\n");
+      } else {
+        int64_t neighbor = prev - j + (j + 1) % kLayerWidth;
+        absl::StrAppend(&text, "  NAND c", index, "(.A(n[", prev, "]), .B(n[",
+                        neighbor, "]), .ZN(", output, "));\n");
+      }
+    }
+  }
+  absl::StrAppend(&text, "endmodule\n");
+  return text;
+}
+
+// Records the throughput and the peak resident set size. The latter is the
+// high-water mark of the whole process, so it is only meaningful for the
+// largest benchmark run so far, or when running one benchmark per process.
+void SetCounters(benchmark::State& state, int64_t cell_count) {
+  state.counters["cells_per_second"] =
+      benchmark::Counter(static_cast<double>(cell_count),
+                         benchmark::Counter::kIsIterationInvariantRate);
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    // Reported in kilobytes on Linux.
+    state.counters["peak_rss_bytes"] =
+        benchmark::Counter(static_cast<double>(usage.ru_maxrss) * 1024,
+                           benchmark::Counter::kDefaults,
+                           benchmark::Counter::OneK::kIs1024);
+  }
+}
+
+std::unique_ptr<rtl::Netlist> ParseNetlist(CellLibrary* cell_library,
+                                           const std::string& text) {
+  rtl::Scanner scanner(text);
+  return rtl::Parser::ParseNetlist(cell_library, &scanner).value();
+}
+
+const rtl::Module* GetMainModule(const rtl::Netlist& netlist) {
+  return netlist.GetModule("main").value();
+}
+
+void BM_MakeFakeCellLibrary(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MakeFakeCellLibrary().value());
+  }
+}
+
+// Measures parsing the netlist text, including building the module.
+void BM_ParseNetlist(benchmark::State& state) {
+  CellLibrary cell_library = MakeFakeCellLibrary().value();
+  std::string text = GenerateNetlist(state.range(0), /*flop_period=*/8);
+  int64_t cell_count = 0;
+  for (auto _ : state) {
+    std::unique_ptr<rtl::Netlist> netlist = ParseNetlist(&cell_library, text);
+    cell_count = GetMainModule(*netlist)->cells().size();
+  }
+  SetCounters(state, cell_count);
+}
+
+// Measures interpreting a combinational module with state.range(1) worker
+// threads (zero evaluates all cells on the calling thread).
+void BM_InterpretModule(benchmark::State& state) {
+  CellLibrary cell_library = MakeFakeCellLibrary().value();
+  std::unique_ptr<rtl::Netlist> netlist = ParseNetlist(
+      &cell_library, GenerateNetlist(state.range(0), /*flop_period=*/0));
+  const rtl::Module* module = GetMainModule(*netlist);
+  Interpreter interpreter(netlist.get(), false, true,
+                          /*num_threads=*/state.range(1));
+  NetRef2Value inputs;
+  for (int64_t i = 0; i < module->inputs().size(); ++i) {
+    inputs[module->inputs()[i]] = i % 3 == 0;
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        interpreter.InterpretModule(module, inputs).value());
+  }
+  SetCounters(state, module->cells().size());
+}
+
+void BM_FindLogicClouds(benchmark::State& state) {
+  CellLibrary cell_library = MakeFakeCellLibrary().value();
+  std::unique_ptr<rtl::Netlist> netlist = ParseNetlist(
+      &cell_library, GenerateNetlist(state.range(0), /*flop_period=*/8));
+  const rtl::Module* module = GetMainModule(*netlist);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FindLogicClouds(*module));
+  }
+  SetCounters(state, module->cells().size());
+}
+
+void BM_FindLogicCloudsDense(benchmark::State& state) {
+  CellLibrary cell_library = MakeFakeCellLibrary().value();
+  std::unique_ptr<rtl::Netlist> netlist = ParseNetlist(
+      &cell_library, GenerateNetlist(state.range(0), /*flop_period=*/8));
+  const rtl::Module* module = GetMainModule(*netlist);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(FindLogicCloudsDense(*module));
+  }
+  SetCounters(state, module->cells().size());
+}
+
+// Measures translating a combinational module into Z3, each iteration in a
+// fresh context.
+void BM_Z3NetlistTranslatorCreate(benchmark::State& state) {
+  CellLibrary cell_library = MakeFakeCellLibrary().value();
+  std::unique_ptr<rtl::Netlist> netlist = ParseNetlist(
+      &cell_library, GenerateNetlist(state.range(0), /*flop_period=*/0));
+  const rtl::Module* module = GetMainModule(*netlist);
+  for (auto _ : state) {
+    Z3_config config = Z3_mk_config();
+    Z3_context ctx = Z3_mk_context(config);
+    {
+      std::unique_ptr<solvers::z3::NetlistTranslator> translator =
+          solvers::z3::NetlistTranslator::CreateAndTranslate(ctx, module, {})
+              .value();
+      benchmark::DoNotOptimize(translator.get());
+    }
+    Z3_del_context(ctx);
+    Z3_del_config(config);
+  }
+  SetCounters(state, module->cells().size());
+}
+
+BENCHMARK(BM_MakeFakeCellLibrary);
+BENCHMARK(BM_ParseNetlist)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 10'000'000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_InterpretModule)
+    ->ArgsProduct({{10'000, 100'000, 1'000'000}, {0, 4}})
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FindLogicClouds)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 1'000'000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_FindLogicCloudsDense)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 10'000'000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Z3NetlistTranslatorCreate)
+    ->RangeMultiplier(10)
+    ->Range(10'000, 100'000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
+
+BENCHMARK_MAIN();
@@ -187,9 +187,10 @@ absl::StatusOr<Token> Scanner::Pop() {
   return result;
 }
 
-absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
-  std::string chars;
-  chars.push_back(startc);
+absl::StatusOr<Token> Scanner::ScanNumber(Pos pos) {
+  // The token's value is the text from its first character (already popped by
+  // the caller) to the last character popped below.
+  int64_t start = index_ - 1;
   bool seen_separator = false;
   auto is_hex_char = [](char c) {
     return absl::ascii_isxdigit(absl::ascii_toupper(c));
@@ -204,20 +205,19 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
   while (!AtEofInternal()) {
     char c = PeekCharOrDie();
     if (is_hex_char(c)) {
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
     } else if (c == '\'' && !seen_separator) {
       // If we see a base separator, pop it, then the optional signedness
       // indicator (s|S), then the base indicator (d|b|o|h|D|B|O|H).
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
       XLS_RET_CHECK(!AtEofInternal()) << "Saw EOF while scanning number base!";
-      chars.push_back(PopCharOrDie());
-      if (chars.back() == 's' || chars.back() == 'S') {
+      c = PopCharOrDie();
+      if (c == 's' || c == 'S') {
         XLS_RET_CHECK(!AtEofInternal())
             << "Saw EOF while scanning number base (post-signedness)!";
-        chars.push_back(PopCharOrDie());
+        c = PopCharOrDie();
       }
 
-      c = chars.back();
       XLS_RET_CHECK(c == 'd' || c == 'b' || c == 'o' || c == 'h' || c == 'D' ||
                     c == 'B' || c == 'O' || c == 'H')
           << "Expected [dbohDBOH], saw '" << c << "'";
@@ -228,23 +228,22 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, Pos pos) {
     }
   }
 
-  return Token{TokenKind::kNumber, pos, chars};
+  return Token{TokenKind::kNumber, pos, text_.substr(start, index_ - start)};
 }
 
-absl::StatusOr<Token> Scanner::ScanName(char startc, Pos pos, bool is_escaped) {
-  std::string chars;
-  chars.push_back(startc);
+absl::StatusOr<Token> Scanner::ScanName(Pos pos, bool is_escaped) {
+  int64_t start = index_ - 1;
   while (!AtEofInternal()) {
     char c = PeekCharOrDie();
     bool is_whitespace = c == ' ' || c == '\t' || c == '\n';
     if ((is_escaped && !is_whitespace) || isalpha(c) || isdigit(c) ||
         c == '_') {
-      chars.push_back(PopCharOrDie());
+      DropCharOrDie();
     } else {
       break;
     }
   }
-  return Token{TokenKind::kName, pos, chars};
+  return Token{TokenKind::kName, pos, text_.substr(start, index_ - start)};
 }
 
 absl::StatusOr<Token> Scanner::PeekInternal() {
@@ -287,10 +286,10 @@ absl::StatusOr<Token> Scanner::PeekInternal() {
       [[fallthrough]];
     default:
       if (isdigit(c)) {
-        return ScanNumber(c, pos);
+        return ScanNumber(pos);
       }
       if (isalpha(c) || c == '\\' || c == '_') {
-        return ScanName(c, pos, c == '\\');
+        return ScanName(pos, c == '\\');
       }
       return absl::UnimplementedError(absl::StrFormat(
           "Unsupported character: '%c' (%#x) @ %s", c, c, pos.ToHumanString()));
@@ -18,6 +18,7 @@
 #include <sys/types.h>
 
 #include <string>
+#include <string_view>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -72,15 +73,19 @@ struct Pos {
 };
 
 // Represents a scanned token (that comes from scanning a character stream).
+// The value of a name or number token is a view of the scanned text, so the
+// text must outlive the token.
 struct Token {
   TokenKind kind;
   Pos pos;
-  std::string value;
+  std::string_view value;
 
   std::string ToString() const;
 };
 
-// Token scanner for netlist files.
+// Token scanner for netlist files. The scanner does not copy `text`, which
+// may be, e.g., the contents of a MemoryMappedFile, so that large netlists
+// need not be read into memory.
 class Scanner {
  public:
   explicit Scanner(std::string_view text) : text_(text) {}
@@ -95,8 +100,10 @@ class Scanner {
   }
 
  private:
-  absl::StatusOr<Token> ScanName(char startc, Pos pos, bool is_escaped);
-  absl::StatusOr<Token> ScanNumber(char startc, Pos pos);
+  // Scans the rest of a name or number token whose first character has been
+  // popped.
+  absl::StatusOr<Token> ScanName(Pos pos, bool is_escaped);
+  absl::StatusOr<Token> ScanNumber(Pos pos);
   absl::StatusOr<Token> PeekInternal();
 
   // Drops any characters that should not be converted to Tokens, including
@@ -295,7 +302,7 @@ template <typename EvalT>
 absl::StatusOr<std::string> AbstractParser<EvalT>::PopNameOrError() {
   XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
   if (token.kind == TokenKind::kName) {
-    return token.value;
+    return std::string(token.value);
   }
   return absl::InvalidArgumentError("Expected name token; got: " +
                                     token.ToString());
@@ -310,8 +317,8 @@ absl::StatusOr<int64_t> AbstractParser<EvalT>::PopNumberOrError(size_t& width) {
     std::string width_string, signed_string, base_string, value_string;
     // Precompute the regex matcher for Verilog number literals.
     static LazyRE2 number_re_ = {R"(([0-9]+)'([Ss]?)([bodhBODH])([0-9a-f]+))"};
-    if (RE2::FullMatch(token.value, *number_re_, &width_string, &signed_string,
-                       &base_string, &value_string)) {
+    if (RE2::FullMatch(std::string(token.value), *number_re_, &width_string,
+                       &signed_string, &base_string, &value_string)) {
       XLS_RET_CHECK(
           absl::SimpleAtoi(width_string, reinterpret_cast<size_t*>(&width)))
           << "Unable to parse number width: " << width_string;
@@ -342,9 +349,9 @@ absl::StatusOr<int64_t> AbstractParser<EvalT>::PopNumberOrError(size_t& width) {
 
     int64_t result;
     if (!absl::SimpleAtoi(token.value, &result)) {
-      return absl::InternalError(
-          "Number token's value cannot be parsed as an int64_t: " +
-          token.value);
+      return absl::InternalError(absl::StrCat(
+          "Number token's value cannot be parsed as an int64_t: ",
+          token.value));
     }
     // Size field defaults to 32 when not explicitly specified.
     width = 32;
@@ -366,7 +373,7 @@ AbstractParser<EvalT>::PopNameOrNumberOrError(size_t& width) {
   TokenKind kind = scanner_->Peek()->kind;
   if (kind == TokenKind::kName) {
     XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
-    return token.value;
+    return std::string(token.value);
   } else if (kind == TokenKind::kNumber) {
     return PopNumberOrError(width);
   }
@@ -80,6 +80,40 @@ endmodule)";
   EXPECT_EQ("baz", baz->name());
 }
 
+TEST(NetlistParserTest, TokensAreViewsOfText) {
+  std::string text = "foo \\bar[0] 8'hff";
+  Scanner scanner(text);
+  XLS_ASSERT_OK_AND_ASSIGN(Token foo, scanner.Pop());
+  XLS_ASSERT_OK_AND_ASSIGN(Token bar, scanner.Pop());
+  XLS_ASSERT_OK_AND_ASSIGN(Token number, scanner.Pop());
+  EXPECT_EQ(foo.value, "foo");
+  EXPECT_EQ(bar.value, "\\bar[0]");
+  EXPECT_EQ(number.kind, TokenKind::kNumber);
+  EXPECT_EQ(number.value, "8'hff");
+  EXPECT_EQ(foo.value.data(), text.data());
+  EXPECT_TRUE(scanner.AtEof());
+}
+
+TEST(NetlistParserTest, NamesOutliveText) {
+  auto text = std::make_unique<std::string>(R"(module main(a, z);
+  input a;
+  output z;
+  INV inv_0(.A(a), .ZN(z));
+endmodule)");
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  std::unique_ptr<Netlist> n;
+  {
+    Scanner scanner(*text);
+    XLS_ASSERT_OK_AND_ASSIGN(n, Parser::ParseNetlist(&cell_library, &scanner));
+  }
+  text.reset();
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* m, n->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef a, m->ResolveNet("a"));
+  EXPECT_EQ(a->name(), "a");
+  XLS_ASSERT_OK_AND_ASSIGN(Cell * inv, m->ResolveCell("inv_0"));
+  EXPECT_EQ(inv->name(), "inv_0");
+}
+
 TEST(NetlistParserTest, Attributes) {
   std::string netlist = R"((* on_module  = "foo" *)
 module main(_a, z);
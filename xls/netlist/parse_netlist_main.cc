@@ -16,6 +16,7 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
@@ -38,8 +39,11 @@ absl::Status RealMain(std::string_view netlist_path,
                          netlist::CellLibrary::FromProto(cell_library_proto));
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
+  // Map rather than read the netlist: the scanner works on views of the text,
+  // so multi-gigabyte netlists are paged in as they are scanned.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<MemoryMappedFile> netlist_file,
+                       MemoryMappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file->contents());
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<netlist::rtl::Netlist> netlist,
       netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
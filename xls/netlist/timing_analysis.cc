@@ -0,0 +1,387 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/timing_analysis.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/logical_effort.h"
+
+namespace xls {
+namespace netlist {
+
+absl::StatusOr<TimingAnalysis> TimingAnalysis::Create(
+    const rtl::Module& module, const TimingOptions& options) {
+  TimingAnalysis analysis(&module);
+  analysis.output_load_ = options.output_load;
+  absl::Span<const std::unique_ptr<rtl::Cell>> cells = module.cells();
+  const int64_t cell_count = cells.size();
+
+  analysis.is_flop_.resize(cell_count);
+  analysis.logical_effort_.resize(cell_count);
+  analysis.parasitic_delay_.resize(cell_count);
+  analysis.size_.assign(cell_count, 1.0);
+  for (int64_t id = 0; id < cell_count; ++id) {
+    const rtl::Cell& cell = *cells[id];
+    if (cell.kind() == CellKind::kFlop) {
+      // Flops only matter as loads; model their inputs as unit inverters.
+      analysis.is_flop_[id] = true;
+      analysis.logical_effort_[id] = 1.0;
+      analysis.parasitic_delay_[id] = 0.0;
+      continue;
+    }
+    absl::Status status = analysis.SetCellModel(id, cell.kind());
+    if (!status.ok()) {
+      XLS_VLOG(2) << "Modeling cell " << cell.name()
+                  << " as an inverter: " << status;
+      analysis.logical_effort_[id] = 1.0;
+      analysis.parasitic_delay_[id] = 1.0;
+      ++analysis.unmodeled_cell_count_;
+    }
+  }
+
+  // The cell driving each net, if any, and the module outputs.
+  std::vector<int64_t> driver(module.nets().size(), -1);
+  std::vector<bool> is_output_net(module.nets().size());
+  for (const std::unique_ptr<rtl::Cell>& cell : cells) {
+    for (const auto& output : cell->outputs()) {
+      driver[output.netref->id()] = cell->id();
+    }
+  }
+  for (rtl::NetRef output : module.outputs()) {
+    is_output_net[output->id()] = true;
+  }
+
+  // Build the fanins of the combinational cells and invert them into the
+  // fanouts of all cells.
+  analysis.output_count_.assign(cell_count, 0);
+  analysis.is_endpoint_.assign(cell_count, false);
+  std::vector<int64_t> fanout_counts(cell_count, 0);
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t id = 0; id < cell_count; ++id) {
+    for (const auto& output : cells[id]->outputs()) {
+      if (is_output_net[output.netref->id()]) {
+        ++analysis.output_count_[id];
+        analysis.is_endpoint_[id] = true;
+      }
+    }
+    for (const auto& input : cells[id]->inputs()) {
+      int64_t d = driver[input.netref->id()];
+      if (d == -1 || analysis.is_flop_[d]) {
+        continue;
+      }
+      edges.push_back({d, id});
+      ++fanout_counts[d];
+      if (analysis.is_flop_[id]) {
+        analysis.is_endpoint_[d] = true;
+      }
+    }
+  }
+  analysis.fanin_offsets_.assign(cell_count + 1, 0);
+  analysis.fanout_offsets_.assign(cell_count + 1, 0);
+  for (const auto& [from, to] : edges) {
+    if (!analysis.is_flop_[to]) {
+      ++analysis.fanin_offsets_[to + 1];
+    }
+  }
+  for (int64_t id = 0; id < cell_count; ++id) {
+    analysis.fanin_offsets_[id + 1] += analysis.fanin_offsets_[id];
+    analysis.fanout_offsets_[id + 1] =
+        analysis.fanout_offsets_[id] + fanout_counts[id];
+  }
+  analysis.fanins_.resize(analysis.fanin_offsets_.back());
+  analysis.fanouts_.resize(analysis.fanout_offsets_.back());
+  {
+    std::vector<int64_t> next_fanin(analysis.fanin_offsets_.begin(),
+                                    analysis.fanin_offsets_.end() - 1);
+    std::vector<int64_t> next_fanout(analysis.fanout_offsets_.begin(),
+                                     analysis.fanout_offsets_.end() - 1);
+    for (const auto& [from, to] : edges) {
+      if (!analysis.is_flop_[to]) {
+        analysis.fanins_[next_fanin[to]++] = from;
+      }
+      analysis.fanouts_[next_fanout[from]++] = to;
+    }
+  }
+
+  // Levelize the combinational cells.
+  std::vector<int64_t> pending_fanins(cell_count);
+  std::vector<int64_t> level(cell_count, 0);
+  std::vector<int64_t> ready;
+  int64_t combinational_count = 0;
+  for (int64_t id = 0; id < cell_count; ++id) {
+    if (analysis.is_flop_[id]) {
+      continue;
+    }
+    ++combinational_count;
+    pending_fanins[id] =
+        analysis.fanin_offsets_[id + 1] - analysis.fanin_offsets_[id];
+    if (pending_fanins[id] == 0) {
+      ready.push_back(id);
+      level[id] = 1;
+    }
+  }
+  analysis.topo_index_.assign(cell_count, -1);
+  while (!ready.empty()) {
+    int64_t id = ready.back();
+    ready.pop_back();
+    analysis.topo_index_[id] = analysis.order_.size();
+    analysis.order_.push_back(id);
+    analysis.level_count_ = std::max(analysis.level_count_, level[id]);
+    for (int64_t i = analysis.fanout_offsets_[id];
+         i < analysis.fanout_offsets_[id + 1]; ++i) {
+      int64_t load = analysis.fanouts_[i];
+      if (analysis.is_flop_[load]) {
+        continue;
+      }
+      level[load] = std::max(level[load], level[id] + 1);
+      if (--pending_fanins[load] == 0) {
+        ready.push_back(load);
+      }
+    }
+  }
+  if (analysis.order_.size() != combinational_count) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Module %s has a combinational cycle through %d cells.", module.name(),
+        combinational_count - analysis.order_.size()));
+  }
+
+  analysis.delay_.assign(cell_count, 0.0);
+  analysis.arrival_.assign(cell_count, 0.0);
+  for (int64_t id : analysis.order_) {
+    analysis.delay_[id] = analysis.ComputeDelay(id);
+    analysis.arrival_[id] = analysis.ComputeArrival(id);
+  }
+  analysis.required_time_ = options.required_time.has_value()
+                                ? *options.required_time
+                                : analysis.GetWorstArrival();
+  analysis.required_.assign(cell_count, analysis.required_time_);
+  for (auto it = analysis.order_.rbegin(); it != analysis.order_.rend(); ++it) {
+    analysis.required_[*it] = analysis.ComputeRequired(*it);
+  }
+  return analysis;
+}
+
+absl::Status TimingAnalysis::SetCellModel(int64_t id, CellKind kind) {
+  int64_t input_count = module_->cells()[id]->inputs().size();
+  if (kind == CellKind::kBuffer) {
+    logical_effort_[id] = 1.0;
+    parasitic_delay_[id] = 2.0;
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(double g,
+                       logical_effort::GetLogicalEffort(kind, input_count));
+  XLS_ASSIGN_OR_RETURN(double p,
+                       logical_effort::GetParasiticDelay(kind, input_count));
+  logical_effort_[id] = g;
+  parasitic_delay_[id] = p;
+  return absl::OkStatus();
+}
+
+double TimingAnalysis::ComputeDelay(int64_t id) const {
+  double load = output_count_[id] * output_load_;
+  for (int64_t i = fanout_offsets_[id]; i < fanout_offsets_[id + 1]; ++i) {
+    load += logical_effort_[fanouts_[i]] * size_[fanouts_[i]];
+  }
+  return load / size_[id] + parasitic_delay_[id];
+}
+
+double TimingAnalysis::ComputeArrival(int64_t id) const {
+  double latest_input = 0.0;
+  for (int64_t i = fanin_offsets_[id]; i < fanin_offsets_[id + 1]; ++i) {
+    latest_input = std::max(latest_input, arrival_[fanins_[i]]);
+  }
+  return latest_input + delay_[id];
+}
+
+double TimingAnalysis::ComputeRequired(int64_t id) const {
+  // Endpoints and dangling cells must meet the required time.
+  bool dangling = fanout_offsets_[id] == fanout_offsets_[id + 1];
+  double required = is_endpoint_[id] || dangling
+                        ? required_time_
+                        : std::numeric_limits<double>::infinity();
+  for (int64_t i = fanout_offsets_[id]; i < fanout_offsets_[id + 1]; ++i) {
+    int64_t load = fanouts_[i];
+    if (!is_flop_[load]) {
+      required = std::min(required, required_[load] - delay_[load]);
+    }
+  }
+  return required;
+}
+
+double TimingAnalysis::GetWorstArrival() const {
+  double worst = 0.0;
+  for (int64_t id : order_) {
+    if (is_endpoint_[id]) {
+      worst = std::max(worst, arrival_[id]);
+    }
+  }
+  return worst;
+}
+
+std::vector<TimingPath> TimingAnalysis::GetWorstPaths(int64_t count) const {
+  std::vector<int64_t> endpoints;
+  for (int64_t id : order_) {
+    if (is_endpoint_[id]) {
+      endpoints.push_back(id);
+    }
+  }
+  auto slack_of = [this](int64_t id) { return required_[id] - arrival_[id]; };
+  count = std::min(count, static_cast<int64_t>(endpoints.size()));
+  std::partial_sort(endpoints.begin(), endpoints.begin() + count,
+                    endpoints.end(), [&](int64_t a, int64_t b) {
+                      return std::make_pair(slack_of(a), -arrival_[a]) <
+                             std::make_pair(slack_of(b), -arrival_[b]);
+                    });
+
+  std::vector<TimingPath> paths;
+  for (int64_t i = 0; i < count; ++i) {
+    int64_t id = endpoints[i];
+    TimingPath& path = paths.emplace_back();
+    path.arrival = arrival_[id];
+    path.slack = slack_of(id);
+    // Walk back through the latest-arriving fanin of each cell.
+    while (id != -1) {
+      path.cells.push_back(module_->cells()[id].get());
+      int64_t latest = -1;
+      for (int64_t j = fanin_offsets_[id]; j < fanin_offsets_[id + 1]; ++j) {
+        if (latest == -1 || arrival_[fanins_[j]] > arrival_[latest]) {
+          latest = fanins_[j];
+        }
+      }
+      id = latest;
+    }
+    std::reverse(path.cells.begin(), path.cells.end());
+  }
+  return paths;
+}
+
+absl::Status TimingAnalysis::ResizeCell(const rtl::Cell& cell, double size) {
+  XLS_RET_CHECK_EQ(module_->cells()[cell.id()].get(), &cell);
+  if (is_flop_[cell.id()]) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Cannot resize flop %s.", cell.name()));
+  }
+  if (size <= 0.0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid size for cell %s: %f", cell.name(), size));
+  }
+  size_[cell.id()] = size;
+  Update(cell.id());
+  return absl::OkStatus();
+}
+
+absl::Status TimingAnalysis::SwapCell(const rtl::Cell& cell, CellKind kind) {
+  XLS_RET_CHECK_EQ(module_->cells()[cell.id()].get(), &cell);
+  if (is_flop_[cell.id()] || kind == CellKind::kFlop) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Cannot swap cell %s between a flop and a combinational cell.",
+        cell.name()));
+  }
+  XLS_RETURN_IF_ERROR(SetCellModel(cell.id(), kind));
+  Update(cell.id());
+  return absl::OkStatus();
+}
+
+void TimingAnalysis::Update(int64_t changed) {
+  // The delay of the changed cell depends on its own parameters, and the
+  // delays of its drivers on its input capacitance.
+  std::vector<int64_t> delay_changed = {changed};
+  for (int64_t i = fanin_offsets_[changed]; i < fanin_offsets_[changed + 1];
+       ++i) {
+    delay_changed.push_back(fanins_[i]);
+  }
+  for (int64_t id : delay_changed) {
+    delay_[id] = ComputeDelay(id);
+  }
+
+  // Propagate arrival times forward in topological order.
+  std::vector<bool> queued(is_flop_.size(), false);
+  std::priority_queue<int64_t, std::vector<int64_t>, std::greater<int64_t>>
+      forward;
+  for (int64_t id : delay_changed) {
+    if (!queued[id]) {
+      queued[id] = true;
+      forward.push(topo_index_[id]);
+    }
+  }
+  int64_t visited = 0;
+  while (!forward.empty()) {
+    int64_t id = order_[forward.top()];
+    forward.pop();
+    queued[id] = false;
+    ++visited;
+    double arrival = ComputeArrival(id);
+    if (arrival == arrival_[id]) {
+      continue;
+    }
+    arrival_[id] = arrival;
+    for (int64_t i = fanout_offsets_[id]; i < fanout_offsets_[id + 1]; ++i) {
+      int64_t load = fanouts_[i];
+      if (!is_flop_[load] && !queued[load]) {
+        queued[load] = true;
+        forward.push(topo_index_[load]);
+      }
+    }
+  }
+
+  // Propagate required times backward in reverse topological order, starting
+  // from the cells loaded by cells whose delay changed.
+  std::priority_queue<int64_t> backward;
+  for (int64_t id : delay_changed) {
+    for (int64_t i = fanin_offsets_[id]; i < fanin_offsets_[id + 1]; ++i) {
+      int64_t fanin = fanins_[i];
+      if (!queued[fanin]) {
+        queued[fanin] = true;
+        backward.push(topo_index_[fanin]);
+      }
+    }
+  }
+  while (!backward.empty()) {
+    int64_t id = order_[backward.top()];
+    backward.pop();
+    queued[id] = false;
+    ++visited;
+    double required = ComputeRequired(id);
+    if (required == required_[id]) {
+      continue;
+    }
+    required_[id] = required;
+    for (int64_t i = fanin_offsets_[id]; i < fanin_offsets_[id + 1]; ++i) {
+      int64_t fanin = fanins_[i];
+      if (!queued[fanin]) {
+        queued[fanin] = true;
+        backward.push(topo_index_[fanin]);
+      }
+    }
+  }
+  XLS_VLOG(3) << "Timing update of " << module_->cells()[changed]->name()
+              << " visited " << visited << " cells.";
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,164 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Static timing analysis of a netlist module based on the method of logical
+// effort.
+
+#ifndef XLS_NETLIST_TIMING_ANALYSIS_H_
+#define XLS_NETLIST_TIMING_ANALYSIS_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+struct TimingOptions {
+  // The time by which every endpoint (module output or flop input) must be
+  // reached, in units of tau. If unset, the worst arrival time of the initial
+  // analysis is used, so the critical path starts with zero slack and later
+  // incremental updates show how it moves.
+  std::optional<double> required_time;
+
+  // The capacitance each module output presents to its driver, in units of
+  // the input capacitance of a unit-size inverter.
+  double output_load = 1.0;
+};
+
+// A path of combinational cells from a timing start point (module input or
+// flop output) to an endpoint.
+struct TimingPath {
+  std::vector<const rtl::Cell*> cells;
+  // Arrival time at the output of the last cell.
+  double arrival;
+  double slack;
+};
+
+// Computes arrival and required times of the combinational cells of a module.
+//
+// Each cell is modeled by its logical effort g, parasitic delay p and size s
+// (a unit-size cell has s = 1). Each input pin presents a capacitance of g * s
+// (in units of the input capacitance of a unit-size inverter), so the delay of
+// a cell driving a load capacitance C is d = g * h + p = C / s + p. This agrees
+// with logical_effort::ComputeDelay where the latter applies, and also handles
+// loads of mixed kinds. Buffers are modeled as a pair of inverters (g = 1,
+// p = 2); cells of other kinds without logical-effort parameters are modeled
+// as inverters and counted by unmodeled_cell_count().
+//
+// The cells are levelized once and times are propagated in topological order
+// over flat arrays indexed by cell id. ResizeCell and SwapCell update the
+// times incrementally, revisiting only the cells whose times change. Assigns
+// are not followed: a net driven through an assign is a start point.
+class TimingAnalysis {
+ public:
+  static absl::StatusOr<TimingAnalysis> Create(
+      const rtl::Module& module, const TimingOptions& options = {});
+
+  // Returns the delay of the given cell; zero for flops.
+  double delay(const rtl::Cell& cell) const { return delay_[cell.id()]; }
+
+  // Returns the arrival time at the output of the given cell; zero for flops.
+  double arrival(const rtl::Cell& cell) const { return arrival_[cell.id()]; }
+
+  // Returns the latest time the output of the given cell may arrive without
+  // violating the required time of an endpoint.
+  double required(const rtl::Cell& cell) const {
+    return required_[cell.id()];
+  }
+
+  double slack(const rtl::Cell& cell) const {
+    return required(cell) - arrival(cell);
+  }
+
+  double required_time() const { return required_time_; }
+
+  // Returns the latest arrival time at any endpoint.
+  double GetWorstArrival() const;
+
+  // Returns the number of levels of combinational cells, i.e., the number of
+  // cells on the longest path.
+  int64_t level_count() const { return level_count_; }
+
+  int64_t unmodeled_cell_count() const { return unmodeled_cell_count_; }
+
+  // Returns the critical paths to the (up to) `count` endpoints with the least
+  // slack, worst first.
+  std::vector<TimingPath> GetWorstPaths(int64_t count) const;
+
+  // Sets the size of the given combinational cell, e.g., after it has been
+  // swapped for a stronger or weaker variant, and updates the affected times.
+  absl::Status ResizeCell(const rtl::Cell& cell, double size);
+
+  // Models the given combinational cell as a cell of `kind` with the same
+  // inputs, e.g., after it has been swapped for a cell of another function,
+  // and updates the affected times.
+  absl::Status SwapCell(const rtl::Cell& cell, CellKind kind);
+
+ private:
+  explicit TimingAnalysis(const rtl::Module* module) : module_(module) {}
+
+  // Sets the logical effort and parasitic delay of cell `id` for the given
+  // kind.
+  absl::Status SetCellModel(int64_t id, CellKind kind);
+
+  double ComputeDelay(int64_t id) const;
+  double ComputeArrival(int64_t id) const;
+  double ComputeRequired(int64_t id) const;
+
+  // Recomputes the delays of `changed` and the cells loaded by them, and
+  // propagates the resulting arrival and required time changes.
+  void Update(int64_t changed);
+
+  const rtl::Module* module_;
+  double output_load_ = 1.0;
+  double required_time_ = 0.0;
+  int64_t level_count_ = 0;
+  int64_t unmodeled_cell_count_ = 0;
+
+  // Per cell, indexed by id.
+  std::vector<bool> is_flop_;
+  std::vector<double> logical_effort_;
+  std::vector<double> parasitic_delay_;
+  std::vector<double> size_;
+  std::vector<double> delay_;
+  std::vector<double> arrival_;
+  std::vector<double> required_;
+  // The number of module outputs driven by the cell.
+  std::vector<int64_t> output_count_;
+  // Whether the cell drives a flop input or a module output.
+  std::vector<bool> is_endpoint_;
+  // Position of the cell in topological order; -1 for flops.
+  std::vector<int64_t> topo_index_;
+
+  // Combinational cells in topological order.
+  std::vector<int64_t> order_;
+
+  // The combinational cells driving the inputs of each cell, and the cells
+  // (including flops) loading its outputs, once per pin, in CSR form.
+  std::vector<int64_t> fanin_offsets_;
+  std::vector<int64_t> fanins_;
+  std::vector<int64_t> fanout_offsets_;
+  std::vector<int64_t> fanouts_;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_TIMING_ANALYSIS_H_
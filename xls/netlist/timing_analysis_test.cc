@@ -0,0 +1,169 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/timing_analysis.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+class TimingAnalysisTest : public ::testing::Test {
+ protected:
+  void Parse(std::string_view module_text) {
+    XLS_ASSERT_OK_AND_ASSIGN(cell_library_, MakeFakeCellLibrary());
+    rtl::Scanner scanner(module_text);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        netlist_, rtl::Parser::ParseNetlist(&cell_library_, &scanner));
+    XLS_ASSERT_OK_AND_ASSIGN(module_, netlist_->GetModule("main"));
+  }
+
+  const rtl::Cell& GetCell(std::string_view name) {
+    return *module_->ResolveCell(name).value();
+  }
+
+  CellLibrary cell_library_;
+  std::unique_ptr<rtl::Netlist> netlist_;
+  const rtl::Module* module_ = nullptr;
+};
+
+// Per Logical Effort book example 1.2, with each fanned-out-to inverter
+// driving a module output.
+constexpr char kFo4Netlist[] = R"(module main(i, o);
+  input i;
+  wire i_n;
+  output [3:0] o;
+
+  INV inv_0(.A(i), .ZN(i_n));
+  INV inv_fo0(.A(i_n), .ZN(o[0]));
+  INV inv_fo1(.A(i_n), .ZN(o[1]));
+  INV inv_fo2(.A(i_n), .ZN(o[2]));
+  INV inv_fo3(.A(i_n), .ZN(o[3]));
+endmodule)";
+
+TEST_F(TimingAnalysisTest, FO4) {
+  Parse(kFo4Netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(TimingAnalysis analysis,
+                           TimingAnalysis::Create(*module_));
+  EXPECT_DOUBLE_EQ(analysis.delay(GetCell("inv_0")), 5.0);
+  EXPECT_DOUBLE_EQ(analysis.delay(GetCell("inv_fo0")), 2.0);
+  EXPECT_DOUBLE_EQ(analysis.arrival(GetCell("inv_fo3")), 7.0);
+  EXPECT_DOUBLE_EQ(analysis.GetWorstArrival(), 7.0);
+  EXPECT_DOUBLE_EQ(analysis.slack(GetCell("inv_0")), 0.0);
+  EXPECT_EQ(analysis.level_count(), 2);
+  EXPECT_EQ(analysis.unmodeled_cell_count(), 0);
+
+  std::vector<TimingPath> paths = analysis.GetWorstPaths(2);
+  ASSERT_EQ(paths.size(), 2);
+  EXPECT_DOUBLE_EQ(paths[0].arrival, 7.0);
+  EXPECT_DOUBLE_EQ(paths[0].slack, 0.0);
+  ASSERT_EQ(paths[0].cells.size(), 2);
+  EXPECT_EQ(paths[0].cells[0]->name(), "inv_0");
+  EXPECT_EQ(analysis.GetWorstPaths(10).size(), 4);
+}
+
+TEST_F(TimingAnalysisTest, IncrementalResize) {
+  Parse(kFo4Netlist);
+  XLS_ASSERT_OK_AND_ASSIGN(TimingAnalysis analysis,
+                           TimingAnalysis::Create(*module_));
+  EXPECT_DOUBLE_EQ(analysis.required_time(), 7.0);
+
+  // A 4x driver: d = 4 / 4 + 1.
+  XLS_ASSERT_OK(analysis.ResizeCell(GetCell("inv_0"), 4.0));
+  EXPECT_DOUBLE_EQ(analysis.delay(GetCell("inv_0")), 2.0);
+  EXPECT_DOUBLE_EQ(analysis.arrival(GetCell("inv_fo1")), 4.0);
+  EXPECT_DOUBLE_EQ(analysis.slack(GetCell("inv_fo1")), 3.0);
+  EXPECT_DOUBLE_EQ(analysis.required(GetCell("inv_0")), 5.0);
+  EXPECT_DOUBLE_EQ(analysis.slack(GetCell("inv_0")), 3.0);
+
+  // Doubling a load speeds it up but loads the driver more heavily.
+  XLS_ASSERT_OK(analysis.ResizeCell(GetCell("inv_0"), 1.0));
+  XLS_ASSERT_OK(analysis.ResizeCell(GetCell("inv_fo0"), 2.0));
+  EXPECT_DOUBLE_EQ(analysis.delay(GetCell("inv_0")), 6.0);
+  EXPECT_DOUBLE_EQ(analysis.arrival(GetCell("inv_fo0")), 7.5);
+  EXPECT_DOUBLE_EQ(analysis.arrival(GetCell("inv_fo1")), 8.0);
+  EXPECT_DOUBLE_EQ(analysis.GetWorstArrival(), 8.0);
+  EXPECT_DOUBLE_EQ(analysis.slack(GetCell("inv_0")), -1.0);
+  EXPECT_DOUBLE_EQ(analysis.GetWorstPaths(1)[0].slack, -1.0);
+
+  EXPECT_THAT(analysis.ResizeCell(GetCell("inv_0"), 0.0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(analysis.SwapCell(GetCell("inv_0"), CellKind::kFlop),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(TimingAnalysisTest, PathsBetweenFlops) {
+  Parse(R"(module main(clk, a, b, o);
+  input clk, a, b;
+  output o;
+  wire a_q, b_q, n0, n1, n1_q;
+
+  DFF dff_a(.D(a), .Q(a_q), .CLK(clk));
+  DFF dff_b(.D(b), .Q(b_q), .CLK(clk));
+  NAND nand0(.A(a_q), .B(b_q), .ZN(n0));
+  INV inv0(.A(n0), .ZN(n1));
+  DFF dff_o(.D(n1), .Q(n1_q), .CLK(clk));
+  INV inv1(.A(n1_q), .ZN(o));
+endmodule)");
+  TimingOptions options;
+  options.required_time = 10.0;
+  XLS_ASSERT_OK_AND_ASSIGN(TimingAnalysis analysis,
+                           TimingAnalysis::Create(*module_, options));
+  // nand0 drives one inverter (g = 4/3, p = 2); inv0 drives one flop input.
+  EXPECT_DOUBLE_EQ(analysis.delay(GetCell("nand0")), 3.0);
+  EXPECT_DOUBLE_EQ(analysis.arrival(GetCell("inv0")), 5.0);
+  EXPECT_DOUBLE_EQ(analysis.arrival(GetCell("inv1")), 2.0);
+  EXPECT_EQ(analysis.level_count(), 2);
+
+  std::vector<TimingPath> paths = analysis.GetWorstPaths(2);
+  ASSERT_EQ(paths.size(), 2);
+  std::vector<std::string> names;
+  for (const rtl::Cell* cell : paths[0].cells) {
+    names.push_back(cell->name());
+  }
+  EXPECT_THAT(names, ElementsAre("nand0", "inv0"));
+  EXPECT_DOUBLE_EQ(paths[0].slack, 5.0);
+  EXPECT_DOUBLE_EQ(paths[1].slack, 8.0);
+}
+
+TEST_F(TimingAnalysisTest, CombinationalCycle) {
+  Parse(R"(module main(i, o);
+  input i;
+  output o;
+  wire x;
+
+  NAND nand0(.A(i), .B(x), .ZN(o));
+  INV inv0(.A(o), .ZN(x));
+endmodule)");
+  EXPECT_THAT(TimingAnalysis::Create(*module_),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("combinational cycle")));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
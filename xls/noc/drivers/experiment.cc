@@ -26,6 +26,7 @@
 #include "xls/noc/simulation/simulator_to_link_monitor_service_shim.h"
 #include "xls/noc/simulation/simulator_to_traffic_injector_shim.h"
 #include "xls/noc/simulation/traffic_description.h"
+#include "xls/noc/simulation/traffic_statistics.h"
 
 namespace xls::noc {
 
@@ -126,23 +127,44 @@ absl::Status ExperimentMetrics::DebugDump() const {
   return absl::OkStatus();
 }
 
-absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
-    const ExperimentConfig& experiment_config,
-    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
-    const {
+absl::StatusOr<std::unique_ptr<ExperimentNetwork>> ExperimentNetwork::Build(
+    const NetworkConfigProto& network_config,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder) {
   // Build and assign simulation objects.
-  NetworkManager graph;
-  NocParameters params;
+  auto network = std::make_unique<ExperimentNetwork>();
+  NetworkManager& graph = network->graph;
+  NocParameters& params = network->params;
 
-  XLS_RETURN_IF_ERROR(BuildNetworkGraphFromProto(
-      experiment_config.GetNetworkConfig(), &graph, &params));
+  XLS_RETURN_IF_ERROR(
+      BuildNetworkGraphFromProto(network_config, &graph, &params));
 
   // Create global routing table.
   XLS_ASSIGN_OR_RETURN(
-      DistributedRoutingTable routing_table,
+      network->routing_table,
       distributed_routing_table_builder.BuildNetworkRoutingTables(
           graph.GetNetworkIds()[0], graph, params));
 
+  return network;
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
+    const ExperimentConfig& experiment_config,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ExperimentNetwork> network,
+      ExperimentNetwork::Build(experiment_config.GetNetworkConfig(),
+                               distributed_routing_table_builder));
+  return RunExperiment(experiment_config, *network);
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
+    const ExperimentConfig& experiment_config,
+    ExperimentNetwork& network) const {
+  NetworkManager& graph = network.graph;
+  NocParameters& params = network.params;
+  DistributedRoutingTable& routing_table = network.routing_table;
+
   // Build traffic model.
   RandomNumberInterface rnd;
   rnd.SetSeed(seed_);
@@ -163,6 +185,7 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
 
   // Build simulator objects.
   NocSimulator simulator;
+  simulator.SetRetainReceivedTraffic(retain_received_flits_);
   XLS_RET_CHECK_OK(simulator.Initialize(graph, params, routing_table,
                                         graph.GetNetworkIds()[0]));
   simulator.Dump();
@@ -222,7 +245,7 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
     metrics.SetFloatMetric(entry_name, traffic_rate);
 
     entry_name = absl::StrFormat("Sink:%s:FlitCount", nc_name);
-    metrics.SetIntegerMetric(entry_name, sink->GetReceivedTraffic().size());
+    metrics.SetIntegerMetric(entry_name, sink->GetReceivedFlitCount());
 
     // Per VC Metrics
     int64_t vc_count =
@@ -233,30 +256,33 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
       traffic_rate = sink->MeasuredTrafficRateInMiBps(cycle_time_in_ps_, vc);
       metrics.SetFloatMetric(entry_name, traffic_rate);
       // Latency stats
-      const internal::Stats stats =
-          GetStats(internal::GetPacketInfo(sink->GetReceivedTraffic(), 0));
+      const ReceivedTrafficStatistics& stats =
+          sink->GetReceivedTrafficStatistics(vc);
+      const LogHistogram& latency = stats.GetPacketLatency();
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:MinimumInjectionTime", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.min_injection_cycle_time);
+      metrics.SetIntegerMetric(entry_name, stats.MinInjectionCycle());
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:MaximumInjectionTime", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.max_injection_cycle_time);
+      metrics.SetIntegerMetric(entry_name, stats.MaxInjectionCycle());
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:MinimumArrivalTime", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.min_arrival_cycle_time);
+      metrics.SetIntegerMetric(entry_name, stats.MinArrivalCycle());
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:MaximumArrivalTime", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.max_arrival_cycle_time);
+      metrics.SetIntegerMetric(entry_name, stats.MaxArrivalCycle());
       entry_name = absl::StrFormat("Sink:%s:VC:%d:MinimumLatency", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.min_latency);
+      metrics.SetIntegerMetric(entry_name, latency.Min());
       entry_name = absl::StrFormat("Sink:%s:VC:%d:MaximumLatency", nc_name, vc);
-      metrics.SetIntegerMetric(entry_name, stats.max_latency);
+      metrics.SetIntegerMetric(entry_name, latency.Max());
       entry_name = absl::StrFormat("Sink:%s:VC:%d:AverageLatency", nc_name, vc);
-      metrics.SetFloatMetric(entry_name, stats.average_latency);
+      metrics.SetFloatMetric(entry_name, latency.Mean());
+      entry_name = absl::StrFormat("Sink:%s:VC:%d:P99Latency", nc_name, vc);
+      metrics.SetIntegerMetric(entry_name, latency.ValueAtQuantile(0.99));
+      // Keyed by the lowest latency of each histogram bucket.
       entry_name =
           absl::StrFormat("Sink:%s:VC:%d:LatencyHistogram", nc_name, vc);
-      metrics.SetIntegerIntegerMapMetric(entry_name,
-                                         std::move(stats.latency_histogram));
+      metrics.SetIntegerIntegerMapMetric(entry_name, latency.GetBucketCounts());
       for (const TimedDataFlit& timed_data_flit : sink->GetReceivedTraffic()) {
         entry_name =
             absl::StrFormat("Sink:%s:VC:%d:TimedRouteInfo", nc_name, vc);
@@ -280,6 +306,18 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   }
 
   // Get info from link monitor.
+  for (auto& [nc_id, flit_count] : link_monitor.GetLinkToFlitCountMap()) {
+    XLS_ASSIGN_OR_RETURN(NetworkComponentParam link_param,
+                         params.GetNetworkComponentParam(nc_id));
+    std::string metric_name = absl::StrFormat(
+        "Link:%s:Utilization",
+        absl::visit([](const auto& nc_param) { return nc_param.GetName(); },
+                    link_param));
+    metrics.SetFloatMetric(
+        metric_name, static_cast<double>(flit_count) /
+                         static_cast<double>(total_simulation_cycle_count_));
+  }
+
   const absl::flat_hash_map<NetworkComponentId, DestinationToPacketCount>&
       link_to_packet_count_map = link_monitor.GetLinkToPacketCountMap();
   for (auto& [nc_id, dest_packet_count] : link_to_packet_count_map) {
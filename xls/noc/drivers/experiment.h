@@ -15,6 +15,7 @@
 #ifndef XLS_NOC_EXPERIMENT_H_
 #define XLS_NOC_EXPERIMENT_H_
 
+#include <memory>
 #include <queue>
 #include <vector>
 
@@ -28,6 +29,8 @@
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/traffic_description.h"
 
 // This file contains classes used to construct different
@@ -136,6 +139,18 @@ class ExperimentMetrics {
     return integer_integer_map_metrics_.at(metric);
   }
 
+  // Returns all the metrics of each kind, ordered by name.
+  const absl::btree_map<std::string, int64_t>& GetIntegerMetrics() const {
+    return integer_metrics_;
+  }
+  const absl::btree_map<std::string, double>& GetFloatMetrics() const {
+    return float_metrics_;
+  }
+  const absl::btree_map<std::string, absl::flat_hash_map<int64_t, int64_t>>&
+  GetIntegerIntegerMapMetrics() const {
+    return integer_integer_map_metrics_;
+  }
+
   // Prints out the metrics and values stored.
   absl::Status DebugDump() const;
 
@@ -208,6 +223,22 @@ struct ExperimentData {
   ExperimentInfo info;
 };
 
+// The network graph, parameters, and routing table built from a network
+// config.
+//
+// The routing table refers to the graph and parameters, so the object is
+// built in place and never moved. Simulations only read it, so experiments
+// on the same network may share it, including concurrently.
+struct ExperimentNetwork {
+  static absl::StatusOr<std::unique_ptr<ExperimentNetwork>> Build(
+      const NetworkConfigProto& network_config,
+      DistributedRoutingTableBuilderBase& distributed_routing_table_builder);
+
+  NetworkManager graph;
+  NocParameters params;
+  DistributedRoutingTable routing_table;
+};
+
 // Class to setup and run a single step of the experiment,
 // including the setup and initialization of the traffic model.
 class ExperimentRunner {
@@ -220,6 +251,12 @@ class ExperimentRunner {
       DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
           DistributedRoutingTableBuilderForTrees()) const;
 
+  // Runs the experiment on a network already built from the experiment
+  // config's network config. The network is only read.
+  absl::StatusOr<ExperimentData> RunExperiment(
+      const ExperimentConfig& experiment_config,
+      ExperimentNetwork& network) const;
+
   ExperimentRunner& SetSimulationCycleCount(int64_t count) {
     XLS_CHECK_GE(count, 0);
     total_simulation_cycle_count_ = count;
@@ -242,6 +279,15 @@ class ExperimentRunner {
     return *this;
   }
 
+  // If enabled, sinks keep every flit received and the route of each flit is
+  // reported as TimedRouteInfo. Otherwise (the default), only statistics
+  // accumulated as flits are received are reported, so memory use does not
+  // grow with the simulation cycle count.
+  ExperimentRunner& SetRetainReceivedFlits(bool retain) {
+    retain_received_flits_ = retain;
+    return *this;
+  }
+
   int64_t GetSimulationCycleCount() const {
     return total_simulation_cycle_count_;
   }
@@ -249,11 +295,13 @@ class ExperimentRunner {
 
   int16_t GetSeed() const { return seed_; }
   std::string_view GetTrafficMode() const { return mode_name_; }
+  bool RetainsReceivedFlits() const { return retain_received_flits_; }
 
  private:
   int64_t total_simulation_cycle_count_;
   int64_t cycle_time_in_ps_;
   int16_t seed_;
+  bool retain_received_flits_ = false;
 
   std::string mode_name_;
 };
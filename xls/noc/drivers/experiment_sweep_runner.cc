@@ -0,0 +1,162 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/drivers/experiment_sweep_runner.h"
+
+#include <atomic>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_replace.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+
+namespace xls::noc {
+namespace {
+
+// Quotes a CSV field if needed.
+std::string CsvField(std::string_view field) {
+  if (field.find_first_of(",\"\n") == std::string_view::npos) {
+    return std::string(field);
+  }
+  return absl::StrCat("\"", absl::StrReplaceAll(field, {{"\"", "\"\""}}),
+                      "\"");
+}
+
+// Returns the CSV rows holding the metrics of a step.
+std::string MetricsToCsvRows(int64_t step, const ExperimentMetrics& metrics) {
+  std::string rows;
+  for (const auto& [name, value] : metrics.GetIntegerMetrics()) {
+    absl::StrAppendFormat(&rows, "%d,%s,%d\n", step, CsvField(name), value);
+  }
+  for (const auto& [name, value] : metrics.GetFloatMetrics()) {
+    absl::StrAppendFormat(&rows, "%d,%s,%.17g\n", step, CsvField(name), value);
+  }
+  for (const auto& [name, map] : metrics.GetIntegerIntegerMapMetrics()) {
+    // Keys are sorted so the output does not depend on the hash order.
+    std::vector<std::pair<int64_t, int64_t>> entries(map.begin(), map.end());
+    std::sort(entries.begin(), entries.end());
+    for (const auto& [key, value] : entries) {
+      absl::StrAppendFormat(&rows, "%d,%s,%d\n", step,
+                            CsvField(absl::StrFormat("%s[%d]", name, key)),
+                            value);
+    }
+  }
+  return rows;
+}
+
+}  // namespace
+
+ExperimentSweepRunner& ExperimentSweepRunner::SetWorkerCount(int64_t count) {
+  XLS_CHECK_GE(count, 0);
+  worker_count_ = count;
+  return *this;
+}
+
+absl::Status ExperimentSweepRunner::Run(
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder,
+    const ResultCallback& on_result) {
+  {
+    absl::MutexLock lock(&networks_mutex_);
+    networks_.clear();
+    network_build_count_ = 0;
+  }
+
+  int64_t step_count = experiment_->GetStepCount();
+  int64_t worker_count = worker_count_ == 0
+                             ? std::numeric_limits<int64_t>::max()
+                             : worker_count_;
+
+  std::atomic<bool> failed = false;
+  absl::Mutex result_mutex;
+  absl::Status status;
+
+  BoundedParallelFor(0, step_count, worker_count, [&](int64_t step) {
+    if (failed.load()) {
+      return;
+    }
+    XLS_VLOG(1) << absl::StreamFormat("Experiment Step %d", step);
+    absl::StatusOr<ExperimentData> data =
+        RunStep(step, distributed_routing_table_builder);
+
+    absl::MutexLock lock(&result_mutex);
+    if (!status.ok()) {
+      return;
+    }
+    status = data.ok() ? on_result(step, *data) : data.status();
+    if (!status.ok()) {
+      failed.store(true);
+    }
+  });
+
+  absl::MutexLock lock(&result_mutex);
+  return status;
+}
+
+absl::Status ExperimentSweepRunner::RunToFile(
+    const std::filesystem::path& path,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder) {
+  XLS_RETURN_IF_ERROR(SetFileContents(path, "step,metric,value\n"));
+  return Run(distributed_routing_table_builder,
+             [&](int64_t step, const ExperimentData& data) {
+               return AppendStringToFile(
+                   path, MetricsToCsvRows(step, data.metrics));
+             });
+}
+
+absl::StatusOr<ExperimentData> ExperimentSweepRunner::RunStep(
+    int64_t step,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder) {
+  XLS_ASSIGN_OR_RETURN(ExperimentConfig config,
+                       experiment_->GetConfigForStep(step));
+  XLS_ASSIGN_OR_RETURN(
+      ExperimentNetwork * network,
+      GetOrBuildNetwork(config.GetNetworkConfig(),
+                        distributed_routing_table_builder));
+  return experiment_->GetRunner().RunExperiment(config, *network);
+}
+
+absl::StatusOr<ExperimentNetwork*> ExperimentSweepRunner::GetOrBuildNetwork(
+    const NetworkConfigProto& network_config,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder) {
+  CachedNetwork* cached;
+  {
+    absl::MutexLock lock(&networks_mutex_);
+    std::unique_ptr<CachedNetwork>& entry =
+        networks_[network_config.SerializeAsString()];
+    if (entry == nullptr) {
+      entry = std::make_unique<CachedNetwork>();
+      ++network_build_count_;
+    }
+    cached = entry.get();
+  }
+
+  // Steps waiting for the same network block here while it is built; other
+  // networks are built concurrently.
+  absl::MutexLock lock(&cached->mutex);
+  if (!cached->built) {
+    cached->network = ExperimentNetwork::Build(
+        network_config, distributed_routing_table_builder);
+    cached->built = true;
+  }
+  XLS_RETURN_IF_ERROR(cached->network.status());
+  return cached->network->get();
+}
+
+}  // namespace xls::noc
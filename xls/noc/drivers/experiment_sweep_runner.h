@@ -0,0 +1,108 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_EXPERIMENT_SWEEP_RUNNER_H_
+#define XLS_NOC_EXPERIMENT_SWEEP_RUNNER_H_
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/drivers/experiment.h"
+#include "xls/noc/simulation/global_routing_table.h"
+
+namespace xls::noc {
+
+// Runs all the steps of an experiment's sweep concurrently.
+//
+// Steps are claimed in order by threads of the shared thread pool. The network
+// graph and routing table are built once per distinct network config and
+// shared by all the steps simulating that network, so sweeps which only vary
+// the traffic rebuild nothing.
+class ExperimentSweepRunner {
+ public:
+  // Called with the data of each step as soon as the step is done. Calls are
+  // serialized, but steps complete in any order.
+  using ResultCallback =
+      std::function<absl::Status(int64_t step, const ExperimentData& data)>;
+
+  // `experiment` must outlive the runner.
+  explicit ExperimentSweepRunner(const Experiment& experiment)
+      : experiment_(&experiment) {}
+
+  // Sets the maximum number of steps run at once, 0 (the default) meaning one
+  // per thread of the shared thread pool.
+  ExperimentSweepRunner& SetWorkerCount(int64_t count);
+
+  // Runs every step, building routing tables with
+  // `distributed_routing_table_builder`, and passes the results to
+  // `on_result`. Returns the first error from a step or from `on_result`;
+  // no new step is started once an error occurred.
+  //
+  // Note: The builder may be called concurrently for different networks.
+  absl::Status Run(
+      DistributedRoutingTableBuilderBase& distributed_routing_table_builder,
+      const ResultCallback& on_result);
+
+  // Runs every step and streams the metrics of each step, as it completes,
+  // into a CSV file with the columns "step,metric,value". Map metrics are
+  // written one row per key, as "metric[key]".
+  absl::Status RunToFile(
+      const std::filesystem::path& path,
+      DistributedRoutingTableBuilderBase& distributed_routing_table_builder);
+
+  // Returns the number of distinct networks built by the last run.
+  int64_t GetNetworkBuildCount() {
+    absl::MutexLock lock(&networks_mutex_);
+    return network_build_count_;
+  }
+
+ private:
+  // A network shared by all the steps with the same network config.
+  struct CachedNetwork {
+    absl::Mutex mutex;
+    bool built = false;
+    absl::StatusOr<std::unique_ptr<ExperimentNetwork>> network;
+  };
+
+  // Builds the config of `step` and simulates it.
+  absl::StatusOr<ExperimentData> RunStep(
+      int64_t step,
+      DistributedRoutingTableBuilderBase& distributed_routing_table_builder);
+
+  // Returns the network for `network_config`, building it on first use.
+  absl::StatusOr<ExperimentNetwork*> GetOrBuildNetwork(
+      const NetworkConfigProto& network_config,
+      DistributedRoutingTableBuilderBase& distributed_routing_table_builder);
+
+  const Experiment* experiment_;
+  int64_t worker_count_ = 0;
+
+  absl::Mutex networks_mutex_;
+  int64_t network_build_count_ ABSL_GUARDED_BY(networks_mutex_) = 0;
+  // Keyed by the serialized network config.
+  absl::flat_hash_map<std::string, std::unique_ptr<CachedNetwork>> networks_
+      ABSL_GUARDED_BY(networks_mutex_);
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_EXPERIMENT_SWEEP_RUNNER_H_
@@ -0,0 +1,110 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/drivers/experiment_sweep_runner.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/noc/drivers/experiment_factory.h"
+#include "xls/noc/drivers/sample_experiments.h"
+
+namespace xls::noc {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::StartsWith;
+
+TEST(ExperimentSweepRunnerTest, MatchesSequentialSteps) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+  int64_t step_count = experiment.GetStepCount();
+  ASSERT_EQ(step_count, 4);
+
+  absl::Mutex mutex;
+  std::vector<ExperimentData> parallel_data(step_count);
+  std::vector<bool> done(step_count, false);
+  ExperimentSweepRunner runner(experiment);
+  DistributedRoutingTableBuilderForTrees builder;
+  XLS_ASSERT_OK(runner.SetWorkerCount(3).Run(
+      builder, [&](int64_t step, const ExperimentData& data) {
+        absl::MutexLock lock(&mutex);
+        parallel_data[step] = data;
+        done[step] = true;
+        return absl::OkStatus();
+      }));
+
+  // Steps 0 and 1 share a network, as do steps 2 and 3.
+  EXPECT_EQ(runner.GetNetworkBuildCount(), 2);
+
+  for (int64_t step = 0; step < step_count; ++step) {
+    ASSERT_TRUE(done[step]);
+    XLS_ASSERT_OK_AND_ASSIGN(ExperimentData data, experiment.RunStep(step));
+    EXPECT_EQ(parallel_data[step].metrics.GetIntegerMetrics(),
+              data.metrics.GetIntegerMetrics());
+    EXPECT_EQ(parallel_data[step].metrics.GetFloatMetrics(),
+              data.metrics.GetFloatMetrics());
+  }
+}
+
+TEST(ExperimentSweepRunnerTest, RunToFile) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory dir, TempDirectory::Create());
+  std::filesystem::path path = dir.path() / "sweep.csv";
+  DistributedRoutingTableBuilderForTrees builder;
+  XLS_ASSERT_OK(ExperimentSweepRunner(experiment).RunToFile(path, builder));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(path));
+  EXPECT_THAT(contents, StartsWith("step,metric,value\n"));
+  for (int64_t step = 0; step < experiment.GetStepCount(); ++step) {
+    EXPECT_THAT(contents,
+                HasSubstr(absl::StrFormat(
+                    "\n%d,Flow:flow_0:TrafficRateInMiBps,", step)));
+  }
+}
+
+TEST(ExperimentSweepRunnerTest, ResultErrorStopsSweep) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  DistributedRoutingTableBuilderForTrees builder;
+  EXPECT_THAT(ExperimentSweepRunner(experiment)
+                  .SetWorkerCount(1)
+                  .Run(builder,
+                       [](int64_t step, const ExperimentData& data) {
+                         return absl::InternalError("stop");
+                       }),
+              status_testing::StatusIs(absl::StatusCode::kInternal, "stop"));
+}
+
+}  // namespace
+}  // namespace xls::noc
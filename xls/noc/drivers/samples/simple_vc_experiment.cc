@@ -157,7 +157,8 @@ SimpleVCExperimentBuilder::BuildExperimentRunner() {
   runner.SetSimulationCycleCount(100'000)
       .SetCycleTimeInPs(500)
       .SetTrafficMode("Main")
-      .SetSimulationSeed(100);
+      .SetSimulationSeed(100)
+      .SetRetainReceivedFlits(true);
   return runner;
 }
 
@@ -14,8 +14,10 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <queue>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -192,6 +194,27 @@ DistributedRoutingTable::GetRouterOutputPortByIndex(PortAndVCIndex from,
                       sink.AsUInt64()));
 }
 
+absl::Status DistributedRoutingTable::RouteByIndexNotFoundError(
+    NetworkComponentId router, PortIndexAndVCIndex from,
+    int64_t destination_index) const {
+  XLS_ASSIGN_OR_RETURN(PortId input_port,
+                       port_indices_.GetPortByIndex(
+                           router, PortDirection::kInput, from.port_index_));
+  XLS_ASSIGN_OR_RETURN(
+      NetworkComponentId sink,
+      sink_indices_.GetNetworkComponentByIndex(destination_index));
+  XLS_ASSIGN_OR_RETURN(PortParam port_param,
+                       network_parameters_->GetPortParam(input_port));
+  XLS_ASSIGN_OR_RETURN(NetworkComponentParam sink_param,
+                       network_parameters_->GetNetworkComponentParam(sink));
+
+  return absl::NotFoundError(absl::StrFormat(
+      "Unable to find hop from port %s (%x) vc %d to sink %s (%x)",
+      port_param.GetName(), input_port.AsUInt64(), from.vc_index_,
+      std::get<NetworkInterfaceSinkParam>(sink_param).GetName(),
+      sink.AsUInt64()));
+}
+
 absl::Status DistributedRoutingTable::DumpRouterRoutingTable(
     NetworkId network_id) const {
   const Network& network = network_manager_->GetNetwork(network_id);
@@ -302,49 +325,116 @@ absl::Status DistributedRoutingTableBuilderBase::BuildNetworkInterfaceIndices(
 absl::Status
 DistributedRoutingTableBuilderBase::BuildPortAndVirtualChannelIndices(
     NetworkId network_id, DistributedRoutingTable* routing_table) {
-  PortIndexMapBuilder port_index_builder;
-  VirtualChannelIndexMapBuilder vc_index_builder;
-
   NetworkManager* network_manager = routing_table->network_manager_;
   NocParameters* network_parameters = routing_table->network_parameters_;
+  Network& network = network_manager->GetNetwork(network_id);
 
-  for (NetworkComponent& nc :
-       network_manager->GetNetwork(network_id).GetNetworkComponents()) {
-    int64_t input_port_index = 0;
-    int64_t output_port_index = 0;
+  // Ports and virtual channels are indexed in-order, so both maps are filled
+  // in a single pass over the network.
+  PortIndexMap& port_indices = routing_table->port_indices_;
+  VirtualChannelIndexMap& vc_indices = routing_table->vc_indices_;
+  port_indices = PortIndexMap();
+  vc_indices = VirtualChannelIndexMap();
+  port_indices.Reserve(network.GetNetworkComponentCount());
+
+  for (NetworkComponent& nc : network.GetNetworkComponents()) {
+    std::vector<PortId> input_ports;
+    std::vector<PortId> output_ports;
 
     for (Port& ports : nc.GetPorts()) {
-      // This function assigns port indicies in-order.
       if (ports.direction() == PortDirection::kInput) {
-        XLS_RET_CHECK_OK(port_index_builder.SetPortIndex(
-            ports.id(), ports.direction(), input_port_index));
-        ++input_port_index;
+        input_ports.push_back(ports.id());
       } else {
-        XLS_RET_CHECK_OK(port_index_builder.SetPortIndex(
-            ports.id(), ports.direction(), output_port_index));
-        ++output_port_index;
+        output_ports.push_back(ports.id());
       }
 
-      // This function assigns virtual channel indices in-order, per port.
       XLS_ASSIGN_OR_RETURN(PortParam port_param,
                            network_parameters->GetPortParam(ports.id()));
+      if (port_param.VirtualChannelCount() > 0) {
+        vc_indices.AddOrdered(ports.id(), port_param.GetVirtualChannels());
+      }
+    }
 
-      int64_t vc_count = port_param.VirtualChannelCount();
+    port_indices.AddOrdered(nc.id(), std::move(input_ports),
+                            std::move(output_ports));
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status DistributedRoutingTableBuilderBase::BuildCompiledRoutes(
+    NetworkId network_id, DistributedRoutingTable* routing_table) {
+  const Network& network =
+      routing_table->network_manager_->GetNetwork(network_id);
+  const PortIndexMap& port_indices = routing_table->port_indices_;
+  int64_t destination_count =
+      routing_table->sink_indices_.NetworkComponentCount();
+
+  std::vector<DistributedRoutingTable::CompiledRouterRoutes>& routers =
+      routing_table->compiled_routers_;
+  std::vector<PortIndexAndVCIndex>& routes = routing_table->compiled_routes_;
+  routers.clear();
+  routes.clear();
+  routing_table->compiled_network_ = network_id;
+  routing_table->compiled_destination_count_ = destination_count;
+
+  for (NetworkComponentId nc_id : network.GetNetworkComponentIds()) {
+    if (network.GetNetworkComponent(nc_id).kind() !=
+        NetworkComponentKind::kRouter) {
+      continue;
+    }
+    if (routers.size() <= nc_id.id()) {
+      routers.resize(nc_id.id() + 1);
+    }
 
-      if (vc_count > 0) {
-        for (int64_t i = 0; i < vc_count; ++i) {
-          XLS_RET_CHECK_OK(vc_index_builder.SetVirtualChannelIndex(
-              ports.id(), port_param, i, i));
+    const DistributedRoutingTable::RouterRoutingTable& table =
+        routing_table->GetRoutingTable(nc_id);
+    XLS_ASSIGN_OR_RETURN(int64_t input_port_count,
+                         port_indices.InputPortCount(nc_id));
+
+    // Ports without vcs are routed on the default vc 0, so the vc dimension
+    // is given by the routing lists rather than the vc indices.
+    std::vector<PortId> input_ports;
+    int64_t vc_count = 0;
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          PortId port_id,
+          port_indices.GetPortByIndex(nc_id, PortDirection::kInput, i));
+      input_ports.push_back(port_id);
+      if (port_id.id() < table.routes.size()) {
+        vc_count = std::max<int64_t>(vc_count,
+                                     table.routes[port_id.id()].size());
+      }
+    }
+
+    DistributedRoutingTable::CompiledRouterRoutes& compiled =
+        routers[nc_id.id()];
+    compiled.offset = routes.size();
+    compiled.input_port_count = input_port_count;
+    compiled.vc_count = vc_count;
+    routes.resize(routes.size() +
+                      input_port_count * vc_count * destination_count,
+                  PortIndexAndVCIndex{-1, -1});
+
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      if (input_ports[i].id() >= table.routes.size()) {
+        continue;
+      }
+      const std::vector<DistributedRoutingTable::PortRoutingList>& port_routes =
+          table.routes[input_ports[i].id()];
+      for (int64_t vc = 0; vc < port_routes.size(); ++vc) {
+        for (const auto& [destination_index, to] : port_routes[vc]) {
+          XLS_ASSIGN_OR_RETURN(
+              int64_t output_port_index,
+              port_indices.GetPortIndex(to.port_id_, PortDirection::kOutput));
+          routes[compiled.offset +
+                 (i * vc_count + vc) * destination_count + destination_index] =
+              PortIndexAndVCIndex{output_port_index, to.vc_index_};
         }
       }
     }
   }
 
-  XLS_ASSIGN_OR_RETURN(routing_table->port_indices_,
-                       port_index_builder.BuildPortIndex());
-  XLS_ASSIGN_OR_RETURN(routing_table->vc_indices_,
-                       vc_index_builder.BuildVirtualChannelIndex());
-
   return absl::OkStatus();
 }
 
@@ -361,6 +451,7 @@ DistributedRoutingTableBuilderForTrees::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(BuildCompiledRoutes(network_id, &routing_table));
 
   return routing_table;
 }
@@ -490,6 +581,7 @@ DistributedRoutingTableBuilderForMultiplePaths::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(BuildCompiledRoutes(network_id, &routing_table));
 
   return routing_table;
 }
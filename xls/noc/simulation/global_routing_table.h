@@ -19,7 +19,11 @@
 #ifndef XLS_NOC_SIMULATION_GLOBAL_ROUTING_TABLE_H_
 #define XLS_NOC_SIMULATION_GLOBAL_ROUTING_TABLE_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/indexer.h"
 #include "xls/noc/simulation/network_graph.h"
@@ -100,8 +104,37 @@ class DistributedRoutingTable {
   absl::StatusOr<PortAndVCIndex> GetRouterOutputPortByIndex(
       PortAndVCIndex from, int64_t destination_index);
 
-  // TODO(tedhong): 2020-01-25 Add indexer for input/output ports of a router
-  //                          and support routing directly via indices.
+  // Given the index of an input port of a router (see GetPortIndices()), a
+  // local virtual channel, and final destination index (sink), return the
+  // index of the output port and the vc the data should go out on.
+  //
+  // Routes are read from a dense
+  //   [router][input port index][vc][destination index]
+  // array compiled once the table is built, so this avoids searching the
+  // routing lists and translating ports on every flit hop.
+  absl::StatusOr<PortIndexAndVCIndex> GetRouterOutputPortIndexByIndex(
+      NetworkComponentId router, PortIndexAndVCIndex from,
+      int64_t destination_index) const {
+    if (router.network() == compiled_network_.id() &&
+        router.id() < compiled_routers_.size() && destination_index >= 0 &&
+        destination_index < compiled_destination_count_) {
+      const CompiledRouterRoutes& compiled = compiled_routers_[router.id()];
+      if (from.port_index_ >= 0 &&
+          from.port_index_ < compiled.input_port_count &&
+          from.vc_index_ >= 0 && from.vc_index_ < compiled.vc_count) {
+        const PortIndexAndVCIndex& to =
+            compiled_routes_[compiled.offset +
+                             (from.port_index_ * compiled.vc_count +
+                              from.vc_index_) *
+                                 compiled_destination_count_ +
+                             destination_index];
+        if (to.port_index_ >= 0) {
+          return to;
+        }
+      }
+    }
+    return RouteByIndexNotFoundError(router, from, destination_index);
+  }
 
   // Returns mapping of vc params to local indicies.
   const VirtualChannelIndexMap& GetVirtualChannelIndices() {
@@ -143,6 +176,19 @@ class DistributedRoutingTable {
         .at(port_and_vc.vc_index_);
   }
 
+  // Returns the error reported by GetRouterOutputPortIndexByIndex() when no
+  // route is found.
+  absl::Status RouteByIndexNotFoundError(NetworkComponentId router,
+                                         PortIndexAndVCIndex from,
+                                         int64_t destination_index) const;
+
+  // Location of the routes of a router within compiled_routes_.
+  struct CompiledRouterRoutes {
+    int64_t offset = 0;
+    int64_t input_port_count = 0;
+    int64_t vc_count = 0;
+  };
+
   PortIndexMap port_indices_;
   VirtualChannelIndexMap vc_indices_;
   NetworkComponentIndexMap source_indices_;
@@ -157,6 +203,16 @@ class DistributedRoutingTable {
   // ie. routing table for ComponentId id is
   //  routing_tables_[id.network()][id.id()]
   std::vector<std::vector<RouterRoutingTable>> routing_tables_;
+
+  // Routing tables of the routers of compiled_network_ compiled to flat
+  // arrays, see GetRouterOutputPortIndexByIndex().
+  //
+  // compiled_routers_ is indexed by the component local id, and
+  // compiled_routes_ holds {-1, -1} where no route exists.
+  NetworkId compiled_network_ = NetworkId::kInvalid;
+  int64_t compiled_destination_count_ = 0;
+  std::vector<CompiledRouterRoutes> compiled_routers_;
+  std::vector<PortIndexAndVCIndex> compiled_routes_;
 };
 
 // Abstract base class for distributed routing table builder.
@@ -176,6 +232,13 @@ class DistributedRoutingTableBuilderBase {
   // Setup port_indices_ and vc_indices_ for network.
   virtual absl::Status BuildPortAndVirtualChannelIndices(
       NetworkId network_id, DistributedRoutingTable* routing_table);
+
+  // Compiles the routing tables of the routers of the network into the
+  // flat arrays used by GetRouterOutputPortIndexByIndex().
+  //
+  // Must be called once the routing tables are built.
+  virtual absl::Status BuildCompiledRoutes(
+      NetworkId network_id, DistributedRoutingTable* routing_table);
 };
 
 // Build a routing table given a network with a tree topology.
@@ -14,6 +14,11 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/logging/logging.h"
@@ -40,6 +45,56 @@ void LogRoute(std::string_view route_name,
   }
 }
 
+// Checks that routing through the compiled arrays by port index matches
+// routing through the per-port routing lists for every router input.
+void ExpectCompiledRoutesMatchRoutingLists(
+    DistributedRoutingTable& routing_table, NetworkManager& graph,
+    const NocParameters& params) {
+  const Network& network = graph.GetNetwork(graph.GetNetworkIds()[0]);
+  int64_t destination_count =
+      routing_table.GetSinkIndices().NetworkComponentCount();
+  int64_t route_count = 0;
+  for (NetworkComponentId nc_id : network.GetNetworkComponentIds()) {
+    if (network.GetNetworkComponent(nc_id).kind() !=
+        NetworkComponentKind::kRouter) {
+      continue;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(
+        int64_t input_port_count,
+        routing_table.GetPortIndices().InputPortCount(nc_id));
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(PortId port_id,
+                               routing_table.GetPortIndices().GetPortByIndex(
+                                   nc_id, PortDirection::kInput, i));
+      XLS_ASSERT_OK_AND_ASSIGN(PortParam port_param,
+                               params.GetPortParam(port_id));
+      int64_t vc_count = std::max<int64_t>(port_param.VirtualChannelCount(), 1);
+      for (int64_t vc = 0; vc < vc_count; ++vc) {
+        for (int64_t dest = 0; dest < destination_count; ++dest) {
+          absl::StatusOr<PortAndVCIndex> expected =
+              routing_table.GetRouterOutputPortByIndex(
+                  PortAndVCIndex{port_id, vc}, dest);
+          absl::StatusOr<PortIndexAndVCIndex> compiled =
+              routing_table.GetRouterOutputPortIndexByIndex(
+                  nc_id, PortIndexAndVCIndex{i, vc}, dest);
+          ASSERT_EQ(compiled.ok(), expected.ok());
+          if (!expected.ok()) {
+            continue;
+          }
+          XLS_ASSERT_OK_AND_ASSIGN(
+              int64_t expected_port_index,
+              routing_table.GetPortIndices().GetPortIndex(
+                  expected->port_id_, PortDirection::kOutput));
+          EXPECT_EQ(compiled->port_index_, expected_port_index);
+          EXPECT_EQ(compiled->vc_index_, expected->vc_index_);
+          ++route_count;
+        }
+      }
+    }
+  }
+  EXPECT_GT(route_count, 0);
+}
+
 TEST(GlobalRoutingTableTest, Index) {
   XLS_LOG(INFO) << "Setting up network ...";
   NetworkConfigProtoBuilder builder("Test");
@@ -621,6 +676,122 @@ TEST(GlobalRoutingTableTest, MultiplePathsBetweenRoutersWithLoop1) {
                                               linkbo1_id, recvport3));
 }
 
+TEST(GlobalRoutingTableTest, CompiledRoutes) {
+  NetworkConfigProto tree_proto;
+  NetworkManager tree_graph;
+  NocParameters tree_params;
+  XLS_ASSERT_OK(
+      BuildNetworkGraphLoop000(&tree_proto, &tree_graph, &tree_params));
+  DistributedRoutingTableBuilderForTrees tree_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      DistributedRoutingTable tree_table,
+      tree_builder.BuildNetworkRoutingTables(tree_graph.GetNetworkIds()[0],
+                                             tree_graph, tree_params));
+  ExpectCompiledRoutesMatchRoutingLists(tree_table, tree_graph, tree_params);
+
+  NetworkConfigProto paths_proto;
+  NetworkManager paths_graph;
+  NocParameters paths_params;
+  XLS_ASSERT_OK(
+      BuildNetworkGraphLinear001(&paths_proto, &paths_graph, &paths_params));
+  DistributedRoutingTableBuilderForMultiplePaths paths_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      DistributedRoutingTable paths_table,
+      paths_builder.BuildNetworkRoutingTables(paths_graph.GetNetworkIds()[0],
+                                              paths_graph, paths_params));
+  ExpectCompiledRoutesMatchRoutingLists(paths_table, paths_graph,
+                                        paths_params);
+
+  // Out of range inputs are reported as errors.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId routera_id,
+      FindNetworkComponentByName("RouterA", paths_graph, paths_params));
+  EXPECT_FALSE(paths_table
+                   .GetRouterOutputPortIndexByIndex(
+                       routera_id, PortIndexAndVCIndex{0, 0}, 100)
+                   .ok());
+  EXPECT_FALSE(paths_table
+                   .GetRouterOutputPortIndexByIndex(
+                       routera_id, PortIndexAndVCIndex{100, 0}, 0)
+                   .ok());
+}
+
+// Checks that every source reaches every sink of a network, and returns the
+// number of components on each route, indexed by source and sink index.
+std::vector<std::vector<int64_t>> ComputeAllRouteLengths(
+    DistributedRoutingTable& routing_table) {
+  absl::Span<const NetworkComponentId> sources =
+      routing_table.GetSourceIndices().GetNetworkComponents();
+  absl::Span<const NetworkComponentId> sinks =
+      routing_table.GetSinkIndices().GetNetworkComponents();
+  std::vector<std::vector<int64_t>> lengths(
+      sources.size(), std::vector<int64_t>(sinks.size(), -1));
+  for (int64_t i = 0; i < sources.size(); ++i) {
+    for (int64_t j = 0; j < sinks.size(); ++j) {
+      absl::StatusOr<std::vector<NetworkComponentId>> route =
+          routing_table.ComputeRoute(sources[i], sinks[j]);
+      EXPECT_TRUE(route.ok()) << route.status();
+      if (route.ok()) {
+        lengths[i][j] = route->size();
+      }
+    }
+  }
+  return lengths;
+}
+
+TEST(GlobalRoutingTableTest, ParameterizedSampleNetworks) {
+  // Routes are a source, a link, the routers with a link after each, and a
+  // sink.
+  {
+    NetworkConfigProto proto;
+    NetworkManager graph;
+    NocParameters params;
+    XLS_ASSERT_OK(BuildNetworkGraphButterfly(3, &proto, &graph, &params));
+    DistributedRoutingTableBuilderForTrees builder;
+    XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                             builder.BuildNetworkRoutingTables(
+                                 graph.GetNetworkIds()[0], graph, params));
+    std::vector<std::vector<int64_t>> lengths =
+        ComputeAllRouteLengths(routing_table);
+    ASSERT_EQ(lengths.size(), 8);
+    for (const std::vector<int64_t>& row : lengths) {
+      EXPECT_THAT(row, ::testing::Each(2 * 3 + 3));
+    }
+  }
+  {
+    NetworkConfigProto proto;
+    NetworkManager graph;
+    NocParameters params;
+    XLS_ASSERT_OK(BuildNetworkGraphMesh(3, 2, &proto, &graph, &params));
+    DistributedRoutingTableBuilderForMultiplePaths builder;
+    XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                             builder.BuildNetworkRoutingTables(
+                                 graph.GetNetworkIds()[0], graph, params));
+    std::vector<std::vector<int64_t>> lengths =
+        ComputeAllRouteLengths(routing_table);
+    ASSERT_EQ(lengths.size(), 6);
+    // Endpoint indices are ordered as the ports of the network, i.e.
+    // row-major, and routes are minimal.
+    for (int64_t i = 0; i < 6; ++i) {
+      for (int64_t j = 0; j < 6; ++j) {
+        int64_t hops = std::abs(i % 3 - j % 3) + std::abs(i / 3 - j / 3);
+        EXPECT_EQ(lengths[i][j], 2 * hops + 5) << i << " " << j;
+      }
+    }
+  }
+  {
+    NetworkConfigProto proto;
+    NetworkManager graph;
+    NocParameters params;
+    XLS_ASSERT_OK(BuildNetworkGraphTree(3, 2, &proto, &graph, &params));
+    DistributedRoutingTableBuilderForTrees builder;
+    XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                             builder.BuildNetworkRoutingTables(
+                                 graph.GetNetworkIds()[0], graph, params));
+    EXPECT_EQ(ComputeAllRouteLengths(routing_table).size(), 4);
+  }
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
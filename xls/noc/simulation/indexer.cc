@@ -14,7 +14,8 @@
 
 #include "xls/noc/simulation/indexer.h"
 
-#include "absl/container/flat_hash_set.h"
+#include <utility>
+
 #include "absl/strings/str_format.h"
 
 namespace xls {
@@ -36,7 +37,8 @@ absl::StatusOr<std::vector<T>> ConstructOrderedIndex(
 
   std::vector<T> ordered_index(count, unordered_index.begin()->first);
 
-  absl::flat_hash_set<int64_t> present_indices;
+  std::vector<bool> present_indices(count, false);
+  int64_t present_count = 0;
 
   for (auto [id, index] : unordered_index) {
     if (index < 0 || index >= count) {
@@ -46,11 +48,14 @@ absl::StatusOr<std::vector<T>> ConstructOrderedIndex(
                           id_name, index, count));
     }
 
-    present_indices.insert(index);
+    if (!present_indices[index]) {
+      present_indices[index] = true;
+      ++present_count;
+    }
     ordered_index.at(index) = id;
   }
 
-  if (present_indices.size() != count) {
+  if (present_count != count) {
     return absl::InternalError("Unable to add index, duplicate indices used");
   }
 
@@ -158,6 +163,14 @@ absl::Status PortIndexMap::Add(
   return absl::OkStatus();
 }
 
+void PortIndexMap::AddOrdered(NetworkComponentId nc_id,
+                              std::vector<PortId> input_ports,
+                              std::vector<PortId> output_ports) {
+  PortOrder& port_order = nc_to_ports_[nc_id];
+  port_order.ordered_input_ports = std::move(input_ports);
+  port_order.ordered_output_ports = std::move(output_ports);
+}
+
 absl::StatusOr<int64_t> PortIndexMap::InputPortCount(
     NetworkComponentId nc_id) const {
   if (!nc_to_ports_.contains(nc_id)) {
@@ -381,10 +394,9 @@ absl::StatusOr<int64_t> NetworkComponentIndexMap::GetNetworkComponentIndex(
 absl::StatusOr<int64_t>
 NetworkComponentIndexMapBuilder::GetNetworkComponentIndex(
     NetworkComponentId id) const {
-  for (auto [nc_id, index] : component_index_) {
-    if (nc_id == id) {
-      return index;
-    }
+  auto iter = component_index_.find(id);
+  if (iter != component_index_.end()) {
+    return iter->second;
   }
 
   return absl::OutOfRangeError(
@@ -24,6 +24,7 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -61,6 +62,17 @@ class PortIndexMap {
   absl::Status Add(NetworkComponentId nc_id, PortDirection dir,
                    absl::Span<const std::pair<PortId, int64_t>> port_index);
 
+  // Adds the ports of a network component, already ordered by index.
+  // Used to index a whole network in a single pass without the
+  // validation done by Add().
+  void AddOrdered(NetworkComponentId nc_id, std::vector<PortId> input_ports,
+                  std::vector<PortId> output_ports);
+
+  // Preallocates storage for the ports of component_count components.
+  void Reserve(int64_t component_count) {
+    nc_to_ports_.reserve(component_count);
+  }
+
  private:
   // Stores ordering of a particular network component's ports.
   struct PortOrder {
@@ -128,6 +140,16 @@ class VirtualChannelIndexMap {
       PortId port_id,
       absl::Span<const std::pair<VirtualChannelParam, int64_t>> vc_index);
 
+  // Adds the virtual channels of a port, already ordered by index.
+  // Used to index a whole network in a single pass without the
+  // validation done by Add().
+  void AddOrdered(PortId port_id, std::vector<VirtualChannelParam> vcs) {
+    port_to_vcs_[port_id] = std::move(vcs);
+  }
+
+  // Preallocates storage for the virtual channels of port_count ports.
+  void Reserve(int64_t port_count) { port_to_vcs_.reserve(port_count); }
+
  private:
   // Stores ordering of a particular port's virtual channels.
   using VirtualChannelOrder = std::vector<VirtualChannelParam>;
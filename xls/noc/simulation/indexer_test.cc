@@ -178,6 +178,40 @@ TEST(SimIndexerTest, PortVirtualChannelIndexerTest) {
   EXPECT_EQ(index2.GetVirtualChannelByIndex(out1_id, 3)->GetName(), "VC0");
 }
 
+TEST(SimIndexerTest, AddOrdered) {
+  NetworkConfigProtoBuilder builder("Test");
+  builder.WithVirtualChannel("VC0");
+  builder.WithVirtualChannel("VC1");
+  auto router = builder.WithRouter("Router0");
+  router.WithOutputPort("out0").WithVirtualChannel("VC1").WithVirtualChannel(
+      "VC0");
+  XLS_ASSERT_OK_AND_ASSIGN(NetworkConfigProto nc_proto, builder.Build());
+  PortParam out0_param(nc_proto, nc_proto.routers(0).ports(0));
+
+  NetworkComponentId nc_id(0, 0);
+  PortId in0_id(0, 0, 0);
+  PortId out0_id(0, 0, 1);
+  PortId out1_id(0, 0, 2);
+
+  PortIndexMap port_indexer;
+  port_indexer.Reserve(1);
+  port_indexer.AddOrdered(nc_id, {in0_id}, {out1_id, out0_id});
+  XLS_EXPECT_OK_AND_EQ(port_indexer.InputPortCount(nc_id), 1);
+  XLS_EXPECT_OK_AND_EQ(port_indexer.OutputPortCount(nc_id), 2);
+  XLS_EXPECT_OK_AND_EQ(
+      port_indexer.GetPortByIndex(nc_id, PortDirection::kOutput, 0), out1_id);
+  XLS_EXPECT_OK_AND_EQ(
+      port_indexer.GetPortIndex(out0_id, PortDirection::kOutput), 1);
+
+  VirtualChannelIndexMap vc_indexer;
+  vc_indexer.Reserve(1);
+  vc_indexer.AddOrdered(out0_id, out0_param.GetVirtualChannels());
+  XLS_EXPECT_OK_AND_EQ(vc_indexer.VirtualChannelCount(out0_id), 2);
+  XLS_EXPECT_OK_AND_EQ(vc_indexer.GetVirtualChannelIndexByName(out0_id, "VC0"),
+                       1);
+  EXPECT_EQ(vc_indexer.GetVirtualChannelByIndex(out0_id, 0)->GetName(), "VC1");
+}
+
 TEST(SimIndexerTest, NetworkComponentIndexerTest0) {
   NetworkComponentIndexMapBuilder index_builder;
   NetworkComponentId nc0(0, 0);
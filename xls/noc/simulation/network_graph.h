@@ -122,6 +122,9 @@ class NetworkComponent {
   // Creates/adds a port to a network component.
   absl::StatusOr<PortId> CreatePort(PortDirection dir);
 
+  // Preallocates storage for count ports.
+  void ReservePorts(int64_t count) { ports_.reserve(count); }
+
   // Get Port object given an id.
   Port& GetPort(PortId id);
 
@@ -186,6 +189,13 @@ class Network {
   absl::StatusOr<NetworkComponentId> CreateNetworkComponent(
       NetworkComponentKind kind);
 
+  // Preallocates storage for the given number of components and
+  // connections.
+  void Reserve(int64_t component_count, int64_t connection_count) {
+    components_.reserve(component_count);
+    connections_.reserve(connection_count);
+  }
+
   // Creates/adds a port to a network component.
   absl::StatusOr<PortId> CreatePort(NetworkComponentId component,
                                     PortDirection dir);
@@ -319,6 +329,13 @@ class NetworkManager {
   absl::StatusOr<NetworkComponentId> CreateNetworkComponent(
       NetworkId network, NetworkComponentKind kind);
 
+  // Preallocates storage for the components and connections of a network,
+  // so that large networks are built without repeated reallocation.
+  void Reserve(NetworkId network, int64_t component_count,
+               int64_t connection_count) {
+    GetNetwork(network).Reserve(component_count, connection_count);
+  }
+
   // Creates/adds a port to a network component.
   absl::StatusOr<PortId> CreatePort(NetworkComponentId component,
                                     PortDirection dir);
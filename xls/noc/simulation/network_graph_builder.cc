@@ -106,6 +106,21 @@ absl::Status NetworkGraphBuilderImpl::BuildNetwork(
   XLS_ASSIGN_OR_RETURN(NetworkId network_id, mgr_->CreateNetwork());
   params_->SetNetworkParam(network_id, network_param);
 
+  // Size all containers up front: each network port becomes a network
+  // interface with one port and each link a component with two ports and
+  // two connections.
+  int64_t router_port_count = 0;
+  for (const RouterConfigProto& router : network.routers()) {
+    router_port_count += router.ports_size();
+  }
+  int64_t component_count =
+      network.ports_size() + network.routers_size() + network.links_size();
+  int64_t port_count =
+      network.ports_size() + router_port_count + 2 * network.links_size();
+  mgr_->Reserve(network_id, component_count, 2 * network.links_size());
+  params_->Reserve(component_count, port_count);
+  network_ports_.reserve(network.ports_size() + router_port_count);
+
   for (const PortConfigProto& port : network.ports()) {
     XLS_RETURN_IF_ERROR(BuildNetworkInterface(network_id, network, port));
   }
@@ -129,6 +144,7 @@ absl::Status NetworkGraphBuilderImpl::BuildRouter(
       NetworkComponentId component_id,
       mgr_->CreateNetworkComponent(network_id, NetworkComponentKind::kRouter));
   params_->SetNetworkComponentParam(component_id, RouterParam(network, router));
+  mgr_->GetNetworkComponent(component_id).ReservePorts(router.ports_size());
 
   for (const PortConfigProto& port : router.ports()) {
     XLS_RETURN_IF_ERROR(BuildRouterPort(component_id, network, port));
@@ -160,6 +176,7 @@ absl::Status NetworkGraphBuilderImpl::BuildLink(
       NetworkComponentId component_id,
       mgr_->CreateNetworkComponent(network_id, NetworkComponentKind::kLink));
   params_->SetNetworkComponentParam(component_id, LinkParam(network, link));
+  mgr_->GetNetworkComponent(component_id).ReservePorts(2);
 
   // Create ports and create connections to the other side of the link.
   ConnectionId conn_id;
@@ -237,8 +254,9 @@ void NetworkGraphBuilderImpl::MemoizePortNameToId(const std::string& name,
 
 absl::StatusOr<PortId> NetworkGraphBuilderImpl::GetPortIdFromName(
     const std::string& name) {
-  if (network_ports_.contains(name)) {
-    return network_ports_[name];
+  auto iter = network_ports_.find(name);
+  if (iter != network_ports_.end()) {
+    return iter->second;
   }
 
   return absl::InternalError(
@@ -14,6 +14,10 @@
 
 #include "xls/noc/simulation/network_graph_builder.h"
 
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/logging/logging.h"
@@ -168,6 +172,47 @@ TEST(SimNetworkGraphBuilderTest, UnitTest) {
   }
 }
 
+TEST(SimNetworkGraphBuilderTest, LargeChain) {
+  // SendPort -> Router0 -> ... -> Router{N-1} -> RecvPort
+  constexpr int64_t kRouterCount = 1000;
+
+  NetworkConfigProtoBuilder builder("Chain");
+  builder.WithPort("SendPort").AsInputDirection();
+  builder.WithPort("RecvPort").AsOutputDirection();
+  std::string prev_port = "SendPort";
+  for (int64_t i = 0; i < kRouterCount; ++i) {
+    auto router = builder.WithRouter(absl::StrCat("Router", i));
+    router.WithInputPort(absl::StrCat("in", i));
+    router.WithOutputPort(absl::StrCat("out", i));
+    builder.WithLink(absl::StrCat("Link", i))
+        .WithSourcePort(prev_port)
+        .WithSinkPort(absl::StrCat("in", i));
+    prev_port = absl::StrCat("out", i);
+  }
+  builder.WithLink("LinkOut").WithSourcePort(prev_port).WithSinkPort(
+      "RecvPort");
+  XLS_ASSERT_OK_AND_ASSIGN(NetworkConfigProto network, builder.Build());
+
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphFromProto(network, &graph, &params));
+
+  // 2 network interfaces, the routers, and a link before each router and
+  // the sink.
+  const Network& built = graph.GetNetworkByIndex(0);
+  EXPECT_EQ(built.GetNetworkComponentCount(), 2 * kRouterCount + 3);
+  EXPECT_EQ(built.GetConnectionCount(), 2 * (kRouterCount + 1));
+  for (const Connection& connection : built.GetConnections()) {
+    EXPECT_TRUE(connection.src().IsValid());
+    EXPECT_TRUE(connection.sink().IsValid());
+  }
+  for (const NetworkComponent& nc : built.GetNetworkComponents()) {
+    for (PortId port : nc.GetPortIds()) {
+      XLS_EXPECT_OK(params.GetPortParam(port));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
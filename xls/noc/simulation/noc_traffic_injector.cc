@@ -14,6 +14,8 @@
 
 #include "xls/noc/simulation/noc_traffic_injector.h"
 
+#include <utility>
+
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/logging/logging.h"
@@ -33,8 +35,12 @@ absl::Status NocTrafficInjector::RunCycle() {
 
   for (int64_t i = 0; i < traffic_models_.size(); ++i) {
     // Retrieve packets.
-    std::vector<DataPacket> packets =
-        traffic_models_[i]->GetNewCyclePackets(cycle_);
+    std::vector<DataPacket> packets;
+    if (schedules_.empty()) {
+      packets = traffic_models_[i]->GetNewCyclePackets(cycle_);
+    } else {
+      XLS_ASSIGN_OR_RETURN(packets, GetScheduledPackets(i));
+    }
 
     this->traffic_model_monitor_[i].AcceptNewPackets(absl::MakeSpan(packets),
                                                      cycle_);
@@ -72,6 +78,63 @@ absl::Status NocTrafficInjector::RunCycle() {
   return absl::OkStatus();
 }
 
+absl::Status NocTrafficInjector::PrecomputeInjectionSchedules(
+    int64_t cycle_count, uint64_t seed) {
+  if (cycle_ != -1) {
+    return absl::FailedPreconditionError(
+        "Injection schedules must be computed before the first cycle is run.");
+  }
+
+  // Keys of different flows are spread apart so that streams of nearby seeds
+  // do not overlap.
+  CounterBasedRandomNumbers flow_keys(seed);
+
+  schedules_.clear();
+  schedules_.reserve(traffic_models_.size());
+  for (int64_t i = 0; i < traffic_models_.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(InjectionSchedule schedule,
+                         traffic_models_[i]->GenerateInjectionSchedule(
+                             cycle_count, flow_keys.Bits(i)));
+    schedules_.push_back(std::move(schedule));
+  }
+  schedule_positions_.assign(traffic_models_.size(), 0);
+  schedule_cycle_count_ = cycle_count;
+
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<DataPacket>> NocTrafficInjector::GetScheduledPackets(
+    int64_t flow_index) {
+  if (cycle_ >= schedule_cycle_count_) {
+    return absl::OutOfRangeError(absl::StrFormat(
+        "Cycle %d is past the %d cycles of the precomputed injection "
+        "schedules.",
+        cycle_, schedule_cycle_count_));
+  }
+
+  const InjectionSchedule& schedule = schedules_[flow_index];
+  const TrafficModel& model = *traffic_models_[flow_index];
+  int64_t& position = schedule_positions_[flow_index];
+
+  std::vector<DataPacket> packets;
+  for (; position < schedule.cycles.size() &&
+         schedule.cycles[position] == cycle_;
+       ++position) {
+    XLS_ASSIGN_OR_RETURN(
+        DataPacket packet,
+        DataPacketBuilder()
+            .Valid(true)
+            .ZeroedData(schedule.packet_size_bits[position])
+            .VirtualChannel(model.GetVCIndex())
+            .SourceIndex(model.GetSourceIndex())
+            .DestinationIndex(model.GetDestinationIndex())
+            .Build());
+    packets.push_back(std::move(packet));
+  }
+
+  return packets;
+}
+
 namespace {
 
 // Function that calls run_action(i, j) for each flow and network_component
@@ -45,6 +45,17 @@ class NocTrafficInjector {
   // on the current_cycle.
   absl::Status RunCycle();
 
+  // Generates the packets each flow injects in cycles [0, cycle_count) ahead
+  // of time, with TrafficModel::GenerateInjectionSchedule(), instead of
+  // querying the traffic models every cycle. Flow i uses the random stream
+  // keyed by (seed, i), so the injected traffic is reproducible regardless of
+  // how flows are grouped or the order in which they are simulated.
+  //
+  // Must be called before the first RunCycle(); RunCycle() then returns an
+  // error once cycle_count cycles have been run.
+  absl::Status PrecomputeInjectionSchedules(int64_t cycle_count,
+                                            uint64_t seed);
+
   // Provides the interface between this object and the NOC simulator.
   void SetSimulatorShim(NocSimulatorTrafficServiceShim& simulator) {
     simulator_ = &simulator;
@@ -104,6 +115,11 @@ class NocTrafficInjector {
  private:
   friend NocTrafficInjectorBuilder;
 
+  // Returns the packets flow_index injects on cycle_ according to its
+  // precomputed schedule.
+  absl::StatusOr<std::vector<DataPacket>> GetScheduledPackets(
+      int64_t flow_index);
+
   // Interface to simulator for injecting flits.
   NocSimulatorTrafficServiceShim* simulator_ = nullptr;
 
@@ -142,6 +158,14 @@ class NocTrafficInjector {
 
   // Measure injected traffic rate.
   std::vector<TrafficModelMonitor> traffic_model_monitor_;
+
+  // Precomputed packets of each flow and the index of the next packet to be
+  // injected, used instead of the traffic models if schedules_ is not empty.
+  std::vector<InjectionSchedule> schedules_;
+  std::vector<int64_t> schedule_positions_;
+
+  // Number of cycles covered by the precomputed schedules.
+  int64_t schedule_cycle_count_ = 0;
 };
 
 // Builder for constructing a NocTrafficInjector.
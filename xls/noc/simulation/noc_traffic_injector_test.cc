@@ -642,5 +642,108 @@ TEST(NocTrafficInjectorTest, ReplaySource) {
   EXPECT_DOUBLE_EQ(replay_model->GetPacketSizeInBits(), 128);
 }
 
+TEST(NocTrafficInjectorTest, PrecomputedInjectionSchedules) {
+  // Construct traffic flows
+  NocTrafficManager traffic_mgr;
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow0_id,
+                           traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(8 * 1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow1_id,
+                           traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow1_id)
+      .SetName("flow1")
+      .SetSource("SendPort1")
+      .SetDestination("RecvPort0")
+      .SetVC("VC1")
+      .SetTrafficRateInMiBps(18 * 1024)
+      .SetPacketSizeInBits(256)
+      .SetBurstProbInMils(1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficModeId mode0_id,
+                           traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id)
+      .SetName("Mode 0")
+      .RegisterTrafficFlow(flow0_id)
+      .RegisterTrafficFlow(flow1_id);
+
+  // Build and assign simulation objects
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphTree001(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  // Counts the bits sent on each cycle.
+  class BitCountingSink : public NocSimulatorTrafficServiceShim {
+   public:
+    absl::Status RunCycle() override { return absl::OkStatus(); }
+
+    absl::Status SendFlitAtTime(TimedDataFlit flit,
+                                NetworkComponentId source) override {
+      bits_sent_per_cycle_[flit.cycle] += flit.flit.data_bit_count;
+      return absl::OkStatus();
+    }
+
+    const absl::flat_hash_map<int64_t, int64_t>& bits_sent_per_cycle() const {
+      return bits_sent_per_cycle_;
+    }
+
+   private:
+    absl::flat_hash_map<int64_t, int64_t> bits_sent_per_cycle_;
+  };
+
+  // Injectors with the same seed inject the same traffic whatever the state
+  // of their random number interface.
+  int64_t cycle_time_in_ps = 1000;
+  int64_t cycle_count = 200'000;
+  std::vector<BitCountingSink> sinks(2);
+  std::vector<NocTrafficInjector> injectors;
+  for (int64_t i = 0; i < sinks.size(); ++i) {
+    RandomNumberInterface rnd;
+    rnd.SetSeed(i);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NocTrafficInjector traffic_injector,
+        NocTrafficInjectorBuilder().Build(
+            cycle_time_in_ps, mode0_id,
+            routing_table.GetSourceIndices().GetNetworkComponents(),
+            routing_table.GetSinkIndices().GetNetworkComponents(),
+            params.GetNetworkParam(graph.GetNetworkIds()[0])
+                ->GetVirtualChannels(),
+            traffic_mgr, graph, params, rnd));
+    XLS_ASSERT_OK(
+        traffic_injector.PrecomputeInjectionSchedules(cycle_count, 1234));
+    traffic_injector.SetSimulatorShim(sinks[i]);
+    for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+      XLS_ASSERT_OK(traffic_injector.RunCycle());
+    }
+    EXPECT_THAT(traffic_injector.RunCycle(),
+                status_testing::StatusIs(absl::StatusCode::kOutOfRange));
+    injectors.push_back(std::move(traffic_injector));
+  }
+
+  EXPECT_EQ(sinks[0].bits_sent_per_cycle(), sinks[1].bits_sent_per_cycle());
+  for (int64_t flow = 0; flow < 2; ++flow) {
+    EXPECT_EQ(injectors[0].MeasuredBitsSent(flow),
+              injectors[1].MeasuredBitsSent(flow));
+  }
+  EXPECT_NEAR(injectors[0].MeasuredTrafficRateInMiBps(cycle_time_in_ps, 0),
+              8 * 1024, 8 * 1024 * 0.02);
+  EXPECT_NEAR(injectors[0].MeasuredTrafficRateInMiBps(cycle_time_in_ps, 1),
+              18 * 1024, 18 * 1024 * 0.02);
+}
+
 }  // namespace
 }  // namespace xls::noc
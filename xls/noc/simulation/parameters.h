@@ -275,6 +275,13 @@ using NetworkComponentParam =
 // Associates Param objects with NetworkGraph objects.
 class NocParameters {
  public:
+  // Preallocates storage for the params of the given number of network
+  // components and ports.
+  void Reserve(int64_t component_count, int64_t port_count) {
+    components_.reserve(components_.size() + component_count);
+    ports_.reserve(ports_.size() + port_count);
+  }
+
   // Associates a Network's Id and Param.
   void SetNetworkParam(NetworkId id, NetworkParam p) {
     networks_.emplace(std::make_pair(id, p));
@@ -15,8 +15,14 @@
 #ifndef XLS_NOC_SIMULATION_RANDOM_NUMBER_INTERFACE_H_
 #define XLS_NOC_SIMULATION_RANDOM_NUMBER_INTERFACE_H_
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <random>
 
+#include "absl/types/span.h"
+
 // This file contains classes used manage and obtain random numbers
 // from different distributions.
 
@@ -70,6 +76,69 @@ class RandomNumberInterface {
   std::minstd_rand random_engine_;
 };
 
+// Stateless generator whose n-th random number depends only on its key and
+// on n, so a stream of random numbers can be drawn in bulk, in any order and
+// independently of the other streams (e.g. one stream per flow).
+//
+// Each number is the SplitMix64 finalizer of a Weyl sequence indexed by n.
+class CounterBasedRandomNumbers {
+ public:
+  explicit CounterBasedRandomNumbers(uint64_t key) : key_(Mix(key)) {}
+
+  // Returns the counter-th 64-bit random number of the stream.
+  uint64_t Bits(uint64_t counter) const {
+    return Mix(key_ + (counter + 1) * kGoldenGamma);
+  }
+
+  // Returns the counter-th random number of the stream uniformly distributed
+  // in (0, 1].
+  double Uniform(uint64_t counter) const {
+    return static_cast<double>((Bits(counter) >> 11) + 1) * 0x1.0p-53;
+  }
+
+  // Fills deltas with successive inter-arrival times of the generalized
+  // geometric distribution (see RandomNumberInterface::GeneralizedGeometric),
+  // the i-th delta being drawn from counters 2 * (first + i) and
+  // 2 * (first + i) + 1.
+  //
+  // The geometric distribution is sampled by inversion so that the loop has
+  // no data-dependent control flow and can be vectorized by the compiler.
+  // A delta of std::numeric_limits<int64_t>::max() means no further packet
+  // is ever sent (i.e. lambda * (1 - burst_prob) is 0).
+  void GeneralizedGeometric(double lambda, double burst_prob, uint64_t first,
+                            absl::Span<int64_t> deltas) const {
+    double geo_p = lambda * (1.0 - burst_prob);
+    if (geo_p <= 0.0) {
+      for (int64_t i = 0; i < deltas.size(); ++i) {
+        deltas[i] = Uniform(2 * (first + i)) <= burst_prob
+                        ? 0
+                        : std::numeric_limits<int64_t>::max();
+      }
+      return;
+    }
+    // log(1 - p) is -inf for p == 1, giving a geometric sample of 0.
+    double inv_log_q = 1.0 / std::log1p(-std::min(geo_p, 1.0));
+    for (int64_t i = 0; i < deltas.size(); ++i) {
+      uint64_t counter = 2 * (first + i);
+      bool burst = Uniform(counter) <= burst_prob;
+      int64_t geometric = static_cast<int64_t>(
+          std::floor(std::log(Uniform(counter + 1)) * inv_log_q));
+      deltas[i] = burst ? 0 : 1 + geometric;
+    }
+  }
+
+ private:
+  static constexpr uint64_t kGoldenGamma = 0x9e3779b97f4a7c15ULL;
+
+  static uint64_t Mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  uint64_t key_;
+};
+
 }  // namespace xls::noc
 
 #endif  // XLS_NOC_SIMULATION_RANDOM_NUMBER_INTERFACE_H_
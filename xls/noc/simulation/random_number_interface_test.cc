@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/random_number_interface.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -78,5 +79,36 @@ TEST(RandomNumberInterfaceTest, SmokeTest) {
   }
 }
 
+TEST(RandomNumberInterfaceTest, CounterBasedGeneralizedGeometric) {
+  CounterBasedRandomNumbers rnd0(100);
+  CounterBasedRandomNumbers rnd1(100);
+  CounterBasedRandomNumbers rnd2(1034);
+
+  double lambda = 0.25;
+  double burst_prob = 0.1;
+  std::vector<int64_t> all(100'000);
+  rnd0.GeneralizedGeometric(lambda, burst_prob, 0, absl::MakeSpan(all));
+
+  // Any range of the stream can be drawn separately.
+  std::vector<int64_t> tail(1000);
+  rnd1.GeneralizedGeometric(lambda, burst_prob, 5000, absl::MakeSpan(tail));
+  EXPECT_TRUE(std::equal(tail.begin(), tail.end(), all.begin() + 5000));
+
+  std::vector<int64_t> other(1000);
+  rnd2.GeneralizedGeometric(lambda, burst_prob, 5000, absl::MakeSpan(other));
+  EXPECT_NE(tail, other);
+
+  // The mean inter-arrival time is 1 / lambda.
+  int64_t sum = 0;
+  int64_t bursts = 0;
+  for (int64_t delta : all) {
+    EXPECT_GE(delta, 0);
+    sum += delta;
+    bursts += delta == 0 ? 1 : 0;
+  }
+  EXPECT_NEAR(static_cast<double>(sum) / all.size(), 1.0 / lambda, 0.1);
+  EXPECT_NEAR(static_cast<double>(bursts) / all.size(), burst_prob, 0.01);
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -0,0 +1,112 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_SIMULATION_RING_BUFFER_H_
+#define XLS_NOC_SIMULATION_RING_BUFFER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "xls/common/logging/logging.h"
+
+namespace xls::noc {
+
+// A first-in first-out queue stored in a circular buffer.
+//
+// Used in place of std::queue for the buffers and pipeline stages of the
+// simulation objects: their capacity is known from the network parameters
+// (e.g. the depth of a virtual channel), so the storage is allocated once.
+// Elements stay in their slot once popped and are overwritten by later
+// pushes, so the storage of their members (e.g. the words of a Bits) is
+// reused as well.
+//
+// If pushed beyond its capacity, the buffer doubles its capacity.
+template <typename T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(int64_t capacity = 0) { Reserve(capacity); }
+
+  // Grows the buffer to hold at least `capacity` elements.
+  void Reserve(int64_t capacity) {
+    if (capacity <= slots_.size()) {
+      return;
+    }
+    std::vector<T> slots(capacity);
+    for (int64_t i = 0; i < size_; ++i) {
+      slots[i] = std::move(slots_[Slot(i)]);
+    }
+    slots_ = std::move(slots);
+    head_ = 0;
+  }
+
+  void push(const T& value) {
+    if (size_ == slots_.size()) {
+      Reserve(std::max<int64_t>(1, 2 * slots_.size()));
+    }
+    slots_[Slot(size_)] = value;
+    ++size_;
+  }
+
+  void push(T&& value) {
+    if (size_ == slots_.size()) {
+      Reserve(std::max<int64_t>(1, 2 * slots_.size()));
+    }
+    slots_[Slot(size_)] = std::move(value);
+    ++size_;
+  }
+
+  // Returns the oldest element.
+  const T& front() const {
+    XLS_DCHECK(!empty());
+    return slots_[head_];
+  }
+  T& front() {
+    XLS_DCHECK(!empty());
+    return slots_[head_];
+  }
+
+  // Returns the i-th oldest element.
+  const T& operator[](int64_t i) const {
+    XLS_DCHECK_LT(i, size_);
+    return slots_[Slot(i)];
+  }
+
+  // Removes the oldest element.
+  void pop() {
+    XLS_DCHECK(!empty());
+    head_ = Slot(1);
+    --size_;
+  }
+
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  int64_t capacity() const { return slots_.size(); }
+
+ private:
+  // Returns the slot of the i-th oldest element.
+  int64_t Slot(int64_t i) const {
+    int64_t slot = head_ + i;
+    return slot >= slots_.size() ? slot - slots_.size() : slot;
+  }
+
+  std::vector<T> slots_;
+  int64_t head_ = 0;
+  int64_t size_ = 0;
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_RING_BUFFER_H_
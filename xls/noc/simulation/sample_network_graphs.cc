@@ -14,9 +14,13 @@
 
 #include "xls/noc/simulation/sample_network_graphs.h"
 
+#include <cstdint>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/noc/config/network_config.pb.h"
@@ -25,6 +29,54 @@
 
 namespace xls::noc {
 
+namespace {
+
+// Settings shared by the parameterized networks.
+constexpr int64_t kSampleFlitBitWidth = 128;
+constexpr int64_t kSampleVirtualChannelDepth = 8;
+
+void AddSampleVirtualChannel(NetworkConfigProtoBuilder& builder) {
+  builder.WithVirtualChannel("VC0")
+      .WithFlitBitWidth(kSampleFlitBitWidth)
+      .WithDepth(kSampleVirtualChannelDepth);
+}
+
+void AddSampleLink(NetworkConfigProtoBuilder& builder,
+                   std::string_view source_port, std::string_view sink_port) {
+  builder.WithLink(absl::StrFormat("Link_%s_%s", source_port, sink_port))
+      .WithSourcePort(source_port)
+      .WithSinkPort(sink_port)
+      .WithPhitBitWidth(kSampleFlitBitWidth)
+      .WithSourceSinkPipelineStage(1)
+      .WithSinkSourcePipelineStage(1);
+}
+
+// Adds SendPort<index> and RecvPort<index>, linked to a router's
+// `router_in` and `router_out` ports.
+void AddSampleEndpoint(NetworkConfigProtoBuilder& builder, int64_t index,
+                       RouterConfigProtoBuilder& router,
+                       std::string_view router_in,
+                       std::string_view router_out) {
+  std::string send_port = absl::StrFormat("SendPort%d", index);
+  std::string recv_port = absl::StrFormat("RecvPort%d", index);
+  builder.WithPort(send_port).AsInputDirection().WithVirtualChannel("VC0");
+  builder.WithPort(recv_port).AsOutputDirection().WithVirtualChannel("VC0");
+  router.WithInputPort(router_in).WithVirtualChannel("VC0");
+  router.WithOutputPort(router_out).WithVirtualChannel("VC0");
+  AddSampleLink(builder, send_port, router_in);
+  AddSampleLink(builder, router_out, recv_port);
+}
+
+absl::Status BuildSampleNetworkGraph(NetworkConfigProtoBuilder& builder,
+                                     NetworkConfigProto* nc_proto,
+                                     NetworkManager* graph,
+                                     NocParameters* params) {
+  XLS_ASSIGN_OR_RETURN(*nc_proto, builder.Build());
+  return BuildNetworkGraphFromProto(*nc_proto, graph, params);
+}
+
+}  // namespace
+
 absl::Status BuildNetworkGraphLinear000(NetworkConfigProto* nc_proto,
                                         NetworkManager* graph,
                                         NocParameters* params) {
@@ -484,4 +536,173 @@ absl::Status BuildNetworkGraphLoop001(NetworkConfigProto* nc_proto,
   return absl::OkStatus();
 }
 
+absl::Status BuildNetworkGraphMesh(int64_t columns, int64_t rows,
+                                   NetworkConfigProto* nc_proto,
+                                   NetworkManager* graph,
+                                   NocParameters* params) {
+  XLS_RET_CHECK(columns > 0 && rows > 0);
+  NetworkConfigProtoBuilder builder("Mesh");
+  AddSampleVirtualChannel(builder);
+
+  auto router_name = [](int64_t column, int64_t row) {
+    return absl::StrFormat("Router_%d_%d", column, row);
+  };
+  for (int64_t row = 0; row < rows; ++row) {
+    for (int64_t column = 0; column < columns; ++column) {
+      std::string name = router_name(column, row);
+      RouterConfigProtoBuilder router = builder.WithRouter(name);
+      AddSampleEndpoint(builder, row * columns + column, router,
+                        absl::StrCat(name, "_in_local"),
+                        absl::StrCat(name, "_out_local"));
+
+      // Ports towards each neighbor, named by the neighbor's direction.
+      const struct {
+        std::string_view direction;
+        int64_t column;
+        int64_t row;
+      } neighbors[] = {{"west", column - 1, row},
+                       {"east", column + 1, row},
+                       {"north", column, row - 1},
+                       {"south", column, row + 1}};
+      for (const auto& neighbor : neighbors) {
+        if (neighbor.column < 0 || neighbor.column >= columns ||
+            neighbor.row < 0 || neighbor.row >= rows) {
+          continue;
+        }
+        router.WithInputPort(absl::StrCat(name, "_in_", neighbor.direction))
+            .WithVirtualChannel("VC0");
+        router.WithOutputPort(absl::StrCat(name, "_out_", neighbor.direction))
+            .WithVirtualChannel("VC0");
+      }
+    }
+  }
+
+  // Link each router to its east and south neighbors, in both directions.
+  for (int64_t row = 0; row < rows; ++row) {
+    for (int64_t column = 0; column < columns; ++column) {
+      std::string name = router_name(column, row);
+      if (column + 1 < columns) {
+        std::string east = router_name(column + 1, row);
+        AddSampleLink(builder, absl::StrCat(name, "_out_east"),
+                      absl::StrCat(east, "_in_west"));
+        AddSampleLink(builder, absl::StrCat(east, "_out_west"),
+                      absl::StrCat(name, "_in_east"));
+      }
+      if (row + 1 < rows) {
+        std::string south = router_name(column, row + 1);
+        AddSampleLink(builder, absl::StrCat(name, "_out_south"),
+                      absl::StrCat(south, "_in_north"));
+        AddSampleLink(builder, absl::StrCat(south, "_out_north"),
+                      absl::StrCat(name, "_in_south"));
+      }
+    }
+  }
+
+  return BuildSampleNetworkGraph(builder, nc_proto, graph, params);
+}
+
+absl::Status BuildNetworkGraphTree(int64_t depth, int64_t radix,
+                                   NetworkConfigProto* nc_proto,
+                                   NetworkManager* graph,
+                                   NocParameters* params) {
+  XLS_RET_CHECK(depth > 0 && radix > 0);
+  NetworkConfigProtoBuilder builder("Tree");
+  AddSampleVirtualChannel(builder);
+
+  // Routers are numbered level by level, so the children of router i are
+  // routers i * radix + 1 to i * radix + radix.
+  int64_t level_size = 1;
+  int64_t router_index = 0;
+  int64_t leaf_index = 0;
+  for (int64_t level = 0; level < depth; ++level) {
+    for (int64_t i = 0; i < level_size; ++i, ++router_index) {
+      std::string name = absl::StrFormat("Router%d", router_index);
+      RouterConfigProtoBuilder router = builder.WithRouter(name);
+      if (level > 0) {
+        router.WithInputPort(absl::StrCat(name, "_in_parent"))
+            .WithVirtualChannel("VC0");
+        router.WithOutputPort(absl::StrCat(name, "_out_parent"))
+            .WithVirtualChannel("VC0");
+      }
+      if (level == depth - 1) {
+        AddSampleEndpoint(builder, leaf_index++, router,
+                          absl::StrCat(name, "_in_local"),
+                          absl::StrCat(name, "_out_local"));
+        continue;
+      }
+      for (int64_t c = 0; c < radix; ++c) {
+        std::string child =
+            absl::StrFormat("Router%d", router_index * radix + c + 1);
+        std::string in_port = absl::StrFormat("%s_in_child%d", name, c);
+        std::string out_port = absl::StrFormat("%s_out_child%d", name, c);
+        router.WithInputPort(in_port).WithVirtualChannel("VC0");
+        router.WithOutputPort(out_port).WithVirtualChannel("VC0");
+        AddSampleLink(builder, out_port, absl::StrCat(child, "_in_parent"));
+        AddSampleLink(builder, absl::StrCat(child, "_out_parent"), in_port);
+      }
+    }
+    level_size *= radix;
+  }
+
+  return BuildSampleNetworkGraph(builder, nc_proto, graph, params);
+}
+
+absl::Status BuildNetworkGraphButterfly(int64_t stage_count,
+                                        NetworkConfigProto* nc_proto,
+                                        NetworkManager* graph,
+                                        NocParameters* params) {
+  XLS_RET_CHECK(stage_count > 0 && stage_count < 20);
+  NetworkConfigProtoBuilder builder("Butterfly");
+  AddSampleVirtualChannel(builder);
+
+  int64_t routers_per_stage = int64_t{1} << (stage_count - 1);
+  auto port_name = [](std::string_view dir, int64_t stage, int64_t router,
+                      int64_t port) {
+    return absl::StrFormat("Router_%d_%d_%s%d", stage, router, dir, port);
+  };
+
+  for (int64_t stage = 0; stage < stage_count; ++stage) {
+    for (int64_t r = 0; r < routers_per_stage; ++r) {
+      RouterConfigProtoBuilder router =
+          builder.WithRouter(absl::StrFormat("Router_%d_%d", stage, r));
+      for (int64_t port = 0; port < 2; ++port) {
+        router.WithInputPort(port_name("in", stage, r, port))
+            .WithVirtualChannel("VC0");
+        router.WithOutputPort(port_name("out", stage, r, port))
+            .WithVirtualChannel("VC0");
+      }
+    }
+  }
+
+  for (int64_t r = 0; r < routers_per_stage; ++r) {
+    for (int64_t port = 0; port < 2; ++port) {
+      int64_t endpoint = 2 * r + port;
+      std::string send_port = absl::StrFormat("SendPort%d", endpoint);
+      std::string recv_port = absl::StrFormat("RecvPort%d", endpoint);
+      builder.WithPort(send_port).AsInputDirection().WithVirtualChannel("VC0");
+      builder.WithPort(recv_port).AsOutputDirection().WithVirtualChannel(
+          "VC0");
+      AddSampleLink(builder, send_port, port_name("in", 0, r, port));
+      AddSampleLink(builder, port_name("out", stage_count - 1, r, port),
+                    recv_port);
+    }
+  }
+
+  // Output `port` of a router of stage s leads to the router of stage s + 1
+  // whose number has bit (stage_count - 2 - s) set to `port`, i.e. each
+  // stage resolves one bit of the destination, most significant first.
+  for (int64_t stage = 0; stage + 1 < stage_count; ++stage) {
+    int64_t bit = stage_count - 2 - stage;
+    for (int64_t r = 0; r < routers_per_stage; ++r) {
+      for (int64_t port = 0; port < 2; ++port) {
+        int64_t next = (r & ~(int64_t{1} << bit)) | (port << bit);
+        AddSampleLink(builder, port_name("out", stage, r, port),
+                      port_name("in", stage + 1, next, (r >> bit) & 1));
+      }
+    }
+  }
+
+  return BuildSampleNetworkGraph(builder, nc_proto, graph, params);
+}
+
 }  // namespace xls::noc
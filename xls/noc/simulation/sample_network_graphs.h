@@ -15,6 +15,8 @@
 #ifndef XLS_NOC_SIMULATION_SAMPLE_NETWORK_GRAPHS_H_
 #define XLS_NOC_SIMULATION_SAMPLE_NETWORK_GRAPHS_H_
 
+#include <cstdint>
+
 #include "absl/status/statusor.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
@@ -143,6 +145,41 @@ absl::Status BuildNetworkGraphLoop001(NetworkConfigProto* nc_proto,
                                       NetworkManager* graph,
                                       NocParameters* params);
 
+// The networks below are parameterized by size and used to benchmark the
+// simulator. All ports use a single virtual channel VC0 with 128-bit flits,
+// and the network interfaces are named SendPort<i> and RecvPort<i>.
+
+// Builds a columns x rows mesh of routers.
+//
+// The router at (column, row) is attached to SendPort<i> and RecvPort<i>,
+// with i = row * columns + column, and has a link to and from each of its
+// up to four neighbors.
+absl::Status BuildNetworkGraphMesh(int64_t columns, int64_t rows,
+                                   NetworkConfigProto* nc_proto,
+                                   NetworkManager* graph,
+                                   NocParameters* params);
+
+// Builds a tree with `depth` levels of routers, each router but the leaves
+// having `radix` children with a link to and from each child.
+//
+// The leaf routers are each attached to SendPort<i> and RecvPort<i>, for i
+// in [0, radix^(depth - 1)).
+absl::Status BuildNetworkGraphTree(int64_t depth, int64_t radix,
+                                   NetworkConfigProto* nc_proto,
+                                   NetworkManager* graph,
+                                   NocParameters* params);
+
+// Builds a unidirectional 2-ary butterfly with `stage_count` stages of
+// 2^(stage_count - 1) 2x2 routers.
+//
+// The 2^stage_count send ports feed the first stage and the last stage
+// feeds the receive ports. There is a single path from each send port to
+// each receive port.
+absl::Status BuildNetworkGraphButterfly(int64_t stage_count,
+                                        NetworkConfigProto* nc_proto,
+                                        NetworkManager* graph,
+                                        NocParameters* params);
+
 }  // namespace xls::noc
 
 #endif  // XLS_NOC_SIMULATION_SAMPLE_NETWORK_GRAPHS_H_
@@ -0,0 +1,220 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <sys/resource.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "include/benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/noc_traffic_injector.h"
+#include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/random_number_interface.h"
+#include "xls/noc/simulation/sample_network_graphs.h"
+#include "xls/noc/simulation/sim_objects.h"
+#include "xls/noc/simulation/simulator_to_traffic_injector_shim.h"
+#include "xls/noc/simulation/traffic_description.h"
+
+// Benchmarks of the NoC simulator on parameterized sample networks.
+//
+// Each benchmark simulates kCyclesPerIteration cycles per iteration, with
+// each source sending to the sink halfway across the network at a fraction
+// of the link bandwidth, and reports the simulated cycles and received flits
+// per second along with the peak resident set size.
+
+namespace xls::noc {
+namespace {
+
+constexpr int64_t kCyclesPerIteration = 1000;
+constexpr int64_t kCycleTimeInPs = 500;
+// The sample networks use 128-bit flits and links.
+constexpr int64_t kFlitBitWidth = 128;
+constexpr int64_t kPacketSizeInBits = 4 * kFlitBitWidth;
+
+using NetworkGraphBuilder = std::function<absl::Status(
+    NetworkConfigProto*, NetworkManager*, NocParameters*)>;
+
+// A network together with the traffic injected into it and the simulator.
+//
+// Members refer to each other, so the object is never moved.
+class SimulationFixture {
+ public:
+  absl::Status Build(const NetworkGraphBuilder& build_graph,
+                     DistributedRoutingTableBuilderBase& routing_builder,
+                     int64_t injection_rate_percent) {
+    XLS_RETURN_IF_ERROR(build_graph(&proto_, &graph_, &params_));
+    NetworkId network_id = graph_.GetNetworkIds()[0];
+    XLS_ASSIGN_OR_RETURN(routing_table_,
+                         routing_builder.BuildNetworkRoutingTables(
+                             network_id, graph_, params_));
+
+    int64_t endpoint_count =
+        routing_table_.GetSourceIndices().NetworkComponentCount();
+    XLS_ASSIGN_OR_RETURN(TrafficModeId mode_id,
+                         traffic_manager_.CreateTrafficMode());
+    TrafficMode& mode = traffic_manager_.GetTrafficMode(mode_id);
+    mode.SetName("Main");
+    for (int64_t i = 0; i < endpoint_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(TrafficFlowId flow_id,
+                           traffic_manager_.CreateTrafficFlow());
+      int64_t destination = (i + endpoint_count / 2) % endpoint_count;
+      traffic_manager_.GetTrafficFlow(flow_id)
+          .SetName(absl::StrFormat("Flow%d", i))
+          .SetSource(absl::StrFormat("SendPort%d", i))
+          .SetDestination(absl::StrFormat("RecvPort%d", destination))
+          .SetVC("VC0")
+          .SetTrafficRateInBitsPerPS(kFlitBitWidth * injection_rate_percent,
+                                     kCycleTimeInPs * 100)
+          .SetPacketSizeInBits(kPacketSizeInBits);
+      mode.RegisterTrafficFlow(flow_id);
+    }
+
+    random_.SetSeed(1);
+    XLS_ASSIGN_OR_RETURN(
+        injector_,
+        NocTrafficInjectorBuilder().Build(
+            kCycleTimeInPs, mode_id,
+            routing_table_.GetSourceIndices().GetNetworkComponents(),
+            routing_table_.GetSinkIndices().GetNetworkComponents(),
+            params_.GetNetworkParam(network_id)->GetVirtualChannels(),
+            traffic_manager_, graph_, params_, random_));
+
+    simulator_.SetRetainReceivedTraffic(false);
+    XLS_RETURN_IF_ERROR(
+        simulator_.Initialize(graph_, params_, routing_table_, network_id));
+    injector_shim_ = std::make_unique<NocSimulatorToNocTrafficInjectorShim>(
+        simulator_, *injector_);
+    injector_->SetSimulatorShim(*injector_shim_);
+    simulator_.RegisterPreCycleService(*injector_shim_);
+    return absl::OkStatus();
+  }
+
+  NocSimulator& simulator() { return simulator_; }
+
+  int64_t GetReceivedFlitCount() {
+    int64_t count = 0;
+    for (NetworkComponentId sink :
+         routing_table_.GetSinkIndices().GetNetworkComponents()) {
+      count += simulator_.GetSimNetworkInterfaceSink(sink).value()
+                   ->GetReceivedFlitCount();
+    }
+    return count;
+  }
+
+ private:
+  NetworkConfigProto proto_;
+  NetworkManager graph_;
+  NocParameters params_;
+  DistributedRoutingTable routing_table_;
+  NocTrafficManager traffic_manager_;
+  RandomNumberInterface random_;
+  std::optional<NocTrafficInjector> injector_;
+  NocSimulator simulator_;
+  std::unique_ptr<NocSimulatorToNocTrafficInjectorShim> injector_shim_;
+};
+
+// Records the simulation throughput and the peak resident set size. The
+// latter is the high-water mark of the whole process, so it is only
+// meaningful for the largest benchmark run so far, or when running one
+// benchmark per process.
+void SetCounters(benchmark::State& state, int64_t flit_count) {
+  state.counters["cycles_per_second"] =
+      benchmark::Counter(static_cast<double>(kCyclesPerIteration),
+                         benchmark::Counter::kIsIterationInvariantRate);
+  state.counters["flits_per_second"] = benchmark::Counter(
+      static_cast<double>(flit_count), benchmark::Counter::kIsRate);
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    // Reported in kilobytes on Linux.
+    state.counters["peak_rss_bytes"] =
+        benchmark::Counter(static_cast<double>(usage.ru_maxrss) * 1024,
+                           benchmark::Counter::kDefaults,
+                           benchmark::Counter::OneK::kIs1024);
+  }
+}
+
+void RunSimulation(benchmark::State& state,
+                   const NetworkGraphBuilder& build_graph,
+                   DistributedRoutingTableBuilderBase& routing_builder) {
+  SimulationFixture fixture;
+  XLS_CHECK_OK(fixture.Build(build_graph, routing_builder,
+                             /*injection_rate_percent=*/state.range(1)));
+
+  int64_t start_flit_count = fixture.GetReceivedFlitCount();
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kCyclesPerIteration; ++i) {
+      XLS_CHECK_OK(fixture.simulator().RunCycle());
+    }
+  }
+  SetCounters(state, fixture.GetReceivedFlitCount() - start_flit_count);
+}
+
+// Arguments: mesh width (and height), injection rate in percent.
+void BM_SimulateMesh(benchmark::State& state) {
+  int64_t width = state.range(0);
+  // Meshes have several paths between endpoints; routes are minimal hop.
+  DistributedRoutingTableBuilderForMultiplePaths routing_builder;
+  RunSimulation(
+      state,
+      [&](NetworkConfigProto* proto, NetworkManager* graph,
+          NocParameters* params) {
+        return BuildNetworkGraphMesh(width, width, proto, graph, params);
+      },
+      routing_builder);
+}
+
+// Arguments: tree depth (with radix 4), injection rate in percent.
+void BM_SimulateTree(benchmark::State& state) {
+  int64_t depth = state.range(0);
+  DistributedRoutingTableBuilderForTrees routing_builder;
+  RunSimulation(
+      state,
+      [&](NetworkConfigProto* proto, NetworkManager* graph,
+          NocParameters* params) {
+        return BuildNetworkGraphTree(depth, /*radix=*/4, proto, graph, params);
+      },
+      routing_builder);
+}
+
+// Arguments: butterfly stage count, injection rate in percent.
+void BM_SimulateButterfly(benchmark::State& state) {
+  int64_t stage_count = state.range(0);
+  DistributedRoutingTableBuilderForTrees routing_builder;
+  RunSimulation(
+      state,
+      [&](NetworkConfigProto* proto, NetworkManager* graph,
+          NocParameters* params) {
+        return BuildNetworkGraphButterfly(stage_count, proto, graph, params);
+      },
+      routing_builder);
+}
+
+BENCHMARK(BM_SimulateMesh)->ArgsProduct({{2, 4, 8}, {10, 30, 60}});
+BENCHMARK(BM_SimulateTree)->ArgsProduct({{2, 3, 4}, {10, 30, 60}});
+BENCHMARK(BM_SimulateButterfly)->ArgsProduct({{2, 4, 6}, {10, 30, 60}});
+
+}  // namespace
+}  // namespace xls::noc
+
+BENCHMARK_MAIN();
@@ -14,12 +14,19 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
 #include "xls/ir/bits.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
@@ -41,7 +48,7 @@ class SimplePipelineImpl {
  public:
   SimplePipelineImpl(int64_t stage_count, DataTimePhitT& from_channel,
                      DataTimePhitT& to_channel,
-                     std::queue<DataTimePhitT>& state,
+                     RingBuffer<DataTimePhitT>& state,
                      int64_t& internal_propagated_cycle)
       : stage_count_(stage_count),
         from_(from_channel),
@@ -56,7 +63,7 @@ class SimplePipelineImpl {
   DataTimePhitT& from_;
   DataTimePhitT& to_;
   // TODO(vmirian) 09-07-21 Optimize to select flit data and its metadata
-  std::queue<DataTimePhitT>& state_;
+  RingBuffer<DataTimePhitT>& state_;
   int64_t& internal_propagated_cycle_;
 };
 
@@ -122,8 +129,97 @@ bool SimplePipelineImpl<DataTimePhitT>::TryPropagation(
   return internal_propagated_cycle_ == current_cycle;
 }
 
+// Returns true if the metadata flit updates the credit count of its receiver.
+bool CarriesCredit(const TimedMetadataFlit& flit) {
+  return flit.flit.type != FlitType::kInvalid && !flit.flit.data.IsZero();
+}
+
+// A barrier which threads pass together any number of times, e.g. once per
+// simulation tick.
+class ReusableBarrier {
+ public:
+  explicit ReusableBarrier(int64_t thread_count)
+      : thread_count_(thread_count) {}
+
+  // Blocks until all threads called Wait(). The last thread to arrive runs
+  // `on_arrival` before the others are released.
+  void Wait(absl::FunctionRef<void()> on_arrival) {
+    absl::MutexLock lock(&mutex_);
+    int64_t generation = generation_;
+    if (++arrived_count_ == thread_count_) {
+      on_arrival();
+      arrived_count_ = 0;
+      ++generation_;
+      cond_var_.SignalAll();
+      return;
+    }
+    while (generation_ == generation) {
+      cond_var_.Wait(&mutex_);
+    }
+  }
+
+ private:
+  int64_t thread_count_;
+  absl::Mutex mutex_;
+  absl::CondVar cond_var_;
+  int64_t arrived_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
 }  // namespace
 
+struct NocSimulator::ParallelState {
+  // A connection from a link in one partition into a router of another.
+  //
+  // The router reads and writes a shadow copy of the connection, which is
+  // synchronized with the connection between ticks: the forward channel is
+  // copied to the shadow and the reverse channels back to the connection.
+  struct BoundaryConnection {
+    int64_t connection_index;
+    int64_t shadow_index;
+  };
+
+  struct Partition {
+    // Components of the partition in the order they are ticked.
+    std::vector<SimNetworkComponentBase*> components;
+
+    // Boundary connections into the routers of this partition.
+    std::vector<BoundaryConnection> boundaries;
+
+    bool converged = false;
+  };
+
+  explicit ParallelState(int64_t partition_count)
+      : partitions(partition_count), barrier(partition_count) {}
+
+  // Partition 0 is ticked by the thread calling RunCycle, partition i > 0 by
+  // threads[i - 1].
+  std::vector<Partition> partitions;
+  std::vector<std::unique_ptr<Thread>> threads;
+  ReusableBarrier barrier;
+
+  // Set before the threads start a cycle, or by the last thread to reach the
+  // barrier after a tick.
+  int64_t max_ticks = 0;
+  int64_t tick_count = 0;
+  bool cycle_done = false;
+  bool shutdown = false;
+  absl::Status status;
+};
+
+NocSimulator::NocSimulator()
+    : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+
+NocSimulator::~NocSimulator() {
+  if (parallel_ != nullptr) {
+    parallel_->shutdown = true;
+    parallel_->barrier.Wait([] {});
+    for (std::unique_ptr<Thread>& thread : parallel_->threads) {
+      thread->Join();
+    }
+  }
+}
+
 absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
   Network& network_obj = mgr_->GetNetwork(network);
 
@@ -259,19 +355,34 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
     XLS_RET_CHECK_OK(svc->RunCycle());
   }
 
-  bool converged = false;
-  int64_t nticks = 0;
-  while (!converged) {
-    XLS_VLOG(2) << absl::StreamFormat("Tick %d", nticks);
-    converged = Tick();
-    ++nticks;
-    if (nticks >= max_ticks) {
-      return absl::InternalError(absl::StrFormat(
-          "Simulator unable to converge after %d ticks for cycle %d", nticks,
-          cycle_));
+  // New flits only enter an idle network through the sources.
+  auto is_idle = [](const SimNetworkComponentBase& nc) { return nc.IsIdle(); };
+  if (skip_idle_cycles_ && network_idle_ &&
+      std::all_of(network_interface_sources_.begin(),
+                  network_interface_sources_.end(), is_idle)) {
+    XLS_VLOG(2) << "Network idle, skipping cycle";
+    ++skipped_cycle_count_;
+  } else if (parallel_ != nullptr) {
+    XLS_RETURN_IF_ERROR(RunParallelTicks(max_ticks));
+  } else {
+    bool converged = false;
+    int64_t nticks = 0;
+    while (!converged) {
+      XLS_VLOG(2) << absl::StreamFormat("Tick %d", nticks);
+      converged = Tick();
+      ++nticks;
+      if (nticks >= max_ticks) {
+        return absl::InternalError(absl::StrFormat(
+            "Simulator unable to converge after %d ticks for cycle %d", nticks,
+            cycle_));
+      }
     }
   }
 
+  if (skip_idle_cycles_) {
+    network_idle_ = IsNetworkIdle();
+  }
+
   for (int64_t i = 0; i < connections_.size(); ++i) {
     XLS_VLOG(2) << absl::StreamFormat("  Connection %d (%x)", i,
                                       connections_[i].id.AsUInt64());
@@ -292,6 +403,30 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
   return absl::OkStatus();
 }
 
+bool NocSimulator::IsNetworkIdle() const {
+  // Cycle 0 sends the initial credits.
+  if (cycle_ < 1) {
+    return false;
+  }
+  for (const SimConnectionState& connection : connections_) {
+    if (connection.forward_channels.flit.type != FlitType::kInvalid) {
+      return false;
+    }
+    for (const TimedMetadataFlit& credit : connection.reverse_channels) {
+      if (CarriesCredit(credit)) {
+        return false;
+      }
+    }
+  }
+  auto is_idle = [](const SimNetworkComponentBase& nc) { return nc.IsIdle(); };
+  return std::all_of(network_interface_sources_.begin(),
+                     network_interface_sources_.end(), is_idle) &&
+         std::all_of(links_.begin(), links_.end(), is_idle) &&
+         std::all_of(routers_.begin(), routers_.end(), is_idle) &&
+         std::all_of(network_interface_sinks_.begin(),
+                     network_interface_sinks_.end(), is_idle);
+}
+
 bool NocSimulator::Tick() {
   // Goes through each simulator object and run atick.
   // Converges when everyone returns True -- that determines new cycle
@@ -337,6 +472,235 @@ bool NocSimulator::Tick() {
   return converged;
 }
 
+absl::Status NocSimulator::SetWorkerCount(int64_t worker_count) {
+  XLS_RET_CHECK(parallel_ == nullptr) << "Worker count already set";
+  XLS_RET_CHECK_EQ(cycle_, -1) << "Worker count set after RunCycle()";
+  if (worker_count <= 1) {
+    return absl::OkStatus();
+  }
+
+  // All components in the order Tick() ticks them.
+  std::vector<SimNetworkComponentBase*> components;
+  for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
+    components.push_back(&nc);
+  }
+  for (SimLink& nc : links_) {
+    components.push_back(&nc);
+  }
+  for (SimInputBufferedVCRouter& nc : routers_) {
+    components.push_back(&nc);
+  }
+  for (SimNetworkInterfaceSink& nc : network_interface_sinks_) {
+    components.push_back(&nc);
+  }
+  absl::flat_hash_map<NetworkComponentId, int64_t> component_index;
+  for (int64_t i = 0; i < components.size(); ++i) {
+    component_index[components[i]->GetId()] = i;
+  }
+
+  // Returns the component driving the input of a link, if any.
+  auto link_driver = [&](NetworkComponentId link) {
+    for (PortId port : mgr_->GetNetworkComponent(link).GetInputPortIds()) {
+      ConnectionId connection = mgr_->GetPort(port).connection();
+      if (connection.IsValid() &&
+          mgr_->GetConnection(connection).src().IsValid()) {
+        return mgr_->GetConnection(connection).src().GetNetworkComponentId();
+      }
+    }
+    return NetworkComponentId::kInvalid;
+  };
+  auto is_router = [&](NetworkComponentId id) {
+    return id.IsValid() && mgr_->GetNetworkComponent(id).kind() ==
+                               NetworkComponentKind::kRouter;
+  };
+
+  // Group the components connected other than by a link between two routers.
+  std::vector<int64_t> group(components.size());
+  std::iota(group.begin(), group.end(), 0);
+  auto find_group = [&](int64_t i) {
+    while (group[i] != i) {
+      group[i] = group[group[i]];
+      i = group[i];
+    }
+    return i;
+  };
+  std::vector<int64_t> cut_connections;
+  for (int64_t i = 0; i < connections_.size(); ++i) {
+    const Connection& connection = mgr_->GetConnection(connections_[i].id);
+    if (!connection.src().IsValid() || !connection.sink().IsValid()) {
+      continue;
+    }
+    NetworkComponentId src = connection.src().GetNetworkComponentId();
+    NetworkComponentId sink = connection.sink().GetNetworkComponentId();
+    if (mgr_->GetNetworkComponent(src).kind() == NetworkComponentKind::kLink &&
+        is_router(link_driver(src)) && is_router(sink)) {
+      cut_connections.push_back(i);
+      continue;
+    }
+    group[find_group(component_index.at(src))] =
+        find_group(component_index.at(sink));
+  }
+
+  // Order the groups by their first component in the network, so that
+  // partitions hold components which are close in the network index order.
+  Network& network_obj = mgr_->GetNetwork(network_);
+  absl::flat_hash_map<int64_t, int64_t> group_position;
+  for (int64_t i = 0; i < network_obj.GetNetworkComponentCount(); ++i) {
+    NetworkComponentId id = network_obj.GetNetworkComponentIdByIndex(i);
+    group_position.try_emplace(find_group(component_index.at(id)), i);
+  }
+  std::vector<std::pair<int64_t, int64_t>> ordered_groups;
+  absl::flat_hash_map<int64_t, int64_t> group_size;
+  for (int64_t i = 0; i < components.size(); ++i) {
+    ++group_size[find_group(i)];
+  }
+  for (auto [root, position] : group_position) {
+    ordered_groups.push_back({position, root});
+  }
+  std::sort(ordered_groups.begin(), ordered_groups.end());
+
+  // Split the groups into partitions of about the same number of components.
+  int64_t partition_count =
+      std::min<int64_t>(worker_count, ordered_groups.size());
+  if (partition_count <= 1) {
+    return absl::OkStatus();
+  }
+  absl::flat_hash_map<int64_t, int64_t> group_partition;
+  int64_t partition = 0;
+  int64_t assigned_count = 0;
+  for (auto [position, root] : ordered_groups) {
+    group_partition[root] = partition;
+    assigned_count += group_size.at(root);
+    if (partition + 1 < partition_count &&
+        assigned_count * partition_count >=
+            (partition + 1) * static_cast<int64_t>(components.size())) {
+      ++partition;
+    }
+  }
+  partition_count = partition + 1;
+
+  auto parallel = std::make_unique<ParallelState>(partition_count);
+  std::vector<int64_t> component_partition(components.size());
+  for (int64_t i = 0; i < components.size(); ++i) {
+    component_partition[i] = group_partition.at(find_group(i));
+    parallel->partitions[component_partition[i]].components.push_back(
+        components[i]);
+  }
+
+  // Give the routers a shadow copy of the connections crossing partitions.
+  for (int64_t index : cut_connections) {
+    const Connection& connection = mgr_->GetConnection(connections_[index].id);
+    int64_t src_partition = component_partition[component_index.at(
+        connection.src().GetNetworkComponentId())];
+    int64_t sink_partition = component_partition[component_index.at(
+        connection.sink().GetNetworkComponentId())];
+    if (src_partition == sink_partition) {
+      continue;
+    }
+    int64_t shadow_index = connections_.size();
+    connections_.push_back(connections_[index]);
+    std::replace(component_to_connection_index_.begin(),
+                 component_to_connection_index_.end(), index, shadow_index);
+    parallel->partitions[sink_partition].boundaries.push_back(
+        ParallelState::BoundaryConnection{index, shadow_index});
+  }
+
+  XLS_VLOG(1) << absl::StreamFormat(
+      "Simulating %d components in %d partitions with %d boundary "
+      "connections",
+      components.size(), partition_count,
+      connections_.size() - connection_index_map_.size());
+
+  parallel_ = std::move(parallel);
+  for (int64_t i = 1; i < partition_count; ++i) {
+    parallel_->threads.push_back(std::make_unique<Thread>([this, i]() {
+      while (true) {
+        parallel_->barrier.Wait([] {});
+        if (parallel_->shutdown) {
+          return;
+        }
+        RunPartitionCycle(i);
+      }
+    }));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status NocSimulator::RunParallelTicks(int64_t max_ticks) {
+  parallel_->max_ticks = max_ticks;
+  parallel_->tick_count = 0;
+  parallel_->status = absl::OkStatus();
+  // Start the other threads on the cycle.
+  parallel_->barrier.Wait([] {});
+  RunPartitionCycle(0);
+  return parallel_->status;
+}
+
+bool NocSimulator::TickPartition(int64_t partition) {
+  absl::Span<SimNetworkComponentBase* const> components =
+      parallel_->partitions[partition].components;
+  int64_t previous_converged_count = -1;
+  while (true) {
+    int64_t converged_count = 0;
+    for (SimNetworkComponentBase* nc : components) {
+      if (nc->Tick(*this)) {
+        ++converged_count;
+      }
+    }
+    if (converged_count == components.size()) {
+      return true;
+    }
+    // Waiting for the other partitions.
+    if (converged_count <= previous_converged_count) {
+      return false;
+    }
+    previous_converged_count = converged_count;
+  }
+}
+
+void NocSimulator::RunPartitionCycle(int64_t partition) {
+  ParallelState& parallel = *parallel_;
+  while (true) {
+    parallel.partitions[partition].converged = TickPartition(partition);
+    parallel.barrier.Wait([&] {
+      ++parallel.tick_count;
+      XLS_VLOG(2) << absl::StreamFormat("Tick %d", parallel.tick_count);
+      parallel.cycle_done =
+          std::all_of(parallel.partitions.begin(), parallel.partitions.end(),
+                      [](const ParallelState::Partition& p) {
+                        return p.converged;
+                      });
+      if (!parallel.cycle_done && parallel.tick_count >= parallel.max_ticks) {
+        parallel.status = absl::InternalError(absl::StrFormat(
+            "Simulator unable to converge after %d ticks for cycle %d",
+            parallel.tick_count, cycle_));
+        parallel.cycle_done = true;
+      }
+    });
+    if (parallel.cycle_done) {
+      return;
+    }
+
+    // Each thread synchronizes the connections into its partition; the
+    // components are not ticked meanwhile.
+    for (const ParallelState::BoundaryConnection& boundary :
+         parallel.partitions[partition].boundaries) {
+      SimConnectionState& connection = connections_[boundary.connection_index];
+      SimConnectionState& shadow = connections_[boundary.shadow_index];
+      if (shadow.forward_channels.cycle != connection.forward_channels.cycle) {
+        shadow.forward_channels = connection.forward_channels;
+      }
+      for (int64_t vc = 0; vc < shadow.reverse_channels.size(); ++vc) {
+        if (connection.reverse_channels[vc].cycle !=
+            shadow.reverse_channels[vc].cycle) {
+          connection.reverse_channels[vc] = shadow.reverse_channels[vc];
+        }
+      }
+    }
+    parallel.barrier.Wait([] {});
+  }
+}
+
 bool SimNetworkComponentBase::Tick(NocSimulator& simulator) {
   int64_t cycle = simulator.GetCurrentCycle();
 
@@ -366,6 +730,35 @@ int64_t SimLink::GetSinkConnectionIndex() const {
   return sink_connection_index_;
 }
 
+bool SimLink::IsIdle() const {
+  // Without pipeline stages the link holds no state. Otherwise the stages
+  // must be full, as a flit entering a partially filled pipeline takes longer
+  // to leave it.
+  if (forward_pipeline_stages_ > 0) {
+    if (forward_data_stages_.size() != forward_pipeline_stages_) {
+      return false;
+    }
+    for (int64_t i = 0; i < forward_data_stages_.size(); ++i) {
+      if (forward_data_stages_[i].flit.type != FlitType::kInvalid) {
+        return false;
+      }
+    }
+  }
+  if (reverse_pipeline_stages_ > 0) {
+    for (const RingBuffer<TimedMetadataFlit>& stages : reverse_credit_stages_) {
+      if (stages.size() != reverse_pipeline_stages_) {
+        return false;
+      }
+      for (int64_t i = 0; i < stages.size(); ++i) {
+        if (CarriesCredit(stages[i])) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
 absl::Status SimLink::InitializeImpl(NocSimulator& simulator) {
   XLS_ASSIGN_OR_RETURN(
       NetworkComponentParam nc_param,
@@ -403,7 +796,10 @@ absl::Status SimLink::InitializeImpl(NocSimulator& simulator) {
       simulator.GetSimConnectionByIndex(sink_connection_index_);
 
   int64_t reverse_channel_count = sink.reverse_channels.size();
-  reverse_credit_stages_.resize(reverse_channel_count);
+  forward_data_stages_.Reserve(forward_pipeline_stages_);
+  reverse_credit_stages_.resize(reverse_channel_count,
+                                RingBuffer<TimedMetadataFlit>(
+                                    reverse_pipeline_stages_));
   internal_reverse_propagated_cycle_ =
       std::vector(reverse_channel_count, simulator.GetCurrentCycle());
 
@@ -434,6 +830,15 @@ absl::Status SimNetworkInterfaceSrc::InitializeImpl(NocSimulator& simulator) {
   return absl::OkStatus();
 }
 
+bool SimNetworkInterfaceSrc::IsIdle() const {
+  for (int64_t vc = 0; vc < data_to_send_.size(); ++vc) {
+    if (!data_to_send_[vc].empty() || credit_update_[vc].credit != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
 absl::Status SimNetworkInterfaceSrc::SendFlitAtTime(TimedDataFlit flit) {
   int64_t vc_index = flit.flit.vc;
 
@@ -461,8 +866,12 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
 
   for (int64_t vc = 0; vc < virtual_channel_count; ++vc) {
     input_buffers_[vc].max_queue_size = vc_params[vc].GetDepth();
+    input_buffers_[vc].queue.Reserve(vc_params[vc].GetDepth());
   }
 
+  // Traffic without vcs is received on vc 0.
+  received_statistics_.resize(std::max<int64_t>(virtual_channel_count, 1));
+
   NetworkManager* network_manager = simulator.GetNetworkManager();
   PortId src_port =
       network_manager->GetNetworkComponent(id_).GetPortIdByIndex(0);
@@ -476,6 +885,24 @@ absl::Status SimNetworkInterfaceSink::InitializeImpl(NocSimulator& simulator) {
 int64_t SimInputBufferedVCRouter::GetUtilizationCycleCount() const {
   return utilization_cycle_count_;
 }
+
+bool SimInputBufferedVCRouter::IsIdle() const {
+  for (const std::vector<DataFlitQueue>& port_buffers : input_buffers_) {
+    for (const DataFlitQueue& buffer : port_buffers) {
+      if (!buffer.queue.empty()) {
+        return false;
+      }
+    }
+  }
+  for (const std::vector<CreditState>& port_credits : credit_update_) {
+    for (const CreditState& credit : port_credits) {
+      if (credit.credit != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
 absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
   NetworkManager* network_manager = simulator.GetNetworkManager();
   NetworkComponent& nc = network_manager->GetNetworkComponent(id_);
@@ -509,6 +936,7 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
     input_buffers_[i].resize(port_param.VirtualChannelCount());
     for (int64_t vc = 0; vc < port_param.VirtualChannelCount(); ++vc) {
       input_buffers_[i][vc].max_queue_size = vc_params[vc].GetDepth();
+      input_buffers_[i][vc].queue.Reserve(vc_params[vc].GetDepth());
     }
     input_credit_to_send_[i].resize(port_param.VirtualChannelCount());
     if (max_vc_ < port_param.VirtualChannelCount()) {
@@ -621,7 +1049,7 @@ bool SimNetworkInterfaceSrc::TryForwardPropagation(NocSimulator& simulator) {
   bool flit_sent = false;
 
   for (int64_t vc = 0; vc < data_to_send_.size(); ++vc) {
-    std::queue<TimedDataFlit>& send_queue = data_to_send_[vc];
+    RingBuffer<TimedDataFlit>& send_queue = data_to_send_[vc];
     if (!send_queue.empty() && send_queue.front().cycle <= current_cycle) {
       if (credit_[vc] > 0) {
         sink.forward_channels.flit = send_queue.front().flit;
@@ -709,21 +1137,13 @@ SimInputBufferedVCRouter::GetDestinationPortIndexAndVcIndex(
     int64_t destination_index) {
   DistributedRoutingTable* routes = simulator.GetRoutingTable();
 
-  XLS_ASSIGN_OR_RETURN(PortId input_port,
-                       routes->GetPortIndices().GetPortByIndex(
-                           GetId(), PortDirection::kInput, input.port_index));
-
-  PortAndVCIndex port_from{input_port, input.vc_index};
-
   XLS_ASSIGN_OR_RETURN(
-      PortAndVCIndex port_to,
-      routes->GetRouterOutputPortByIndex(port_from, destination_index));
-
-  XLS_ASSIGN_OR_RETURN(int64_t output_port_index,
-                       routes->GetPortIndices().GetPortIndex(
-                           port_to.port_id_, PortDirection::kOutput));
+      noc::PortIndexAndVCIndex port_to,
+      routes->GetRouterOutputPortIndexByIndex(
+          GetId(), noc::PortIndexAndVCIndex{input.port_index, input.vc_index},
+          destination_index));
 
-  return PortIndexAndVCIndex{output_port_index, port_to.vc_index_};
+  return PortIndexAndVCIndex{port_to.port_index_, port_to.vc_index_};
 }
 
 bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
@@ -815,8 +1235,9 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
+      const DataFlit& flit = input_buffers_[i][vc].queue.front().flit;
+      const TimedDataFlitInfo& metadata =
+          input_buffers_[i][vc].queue.front().metadata;
       int64_t destination_index = flit.destination_index;
 
       PortIndexAndVCIndex input{i, vc};
@@ -1006,7 +1427,11 @@ bool SimNetworkInterfaceSink::TryForwardPropagation(NocSimulator& simulator) {
     received_flit.metadata = src.forward_channels.metadata;
     received_flit.metadata.timed_route_info.route.push_back(
         TimedRouteItem{id_, current_cycle});
-    received_traffic_.push_back(received_flit);
+    received_statistics_.at(vc).AddFlit(received_flit);
+    last_received_cycle_ = current_cycle;
+    if (simulator.RetainsReceivedTraffic()) {
+      received_traffic_.push_back(std::move(received_flit));
+    }
 
     // Send one credit back
     src.reverse_channels[vc].cycle = current_cycle;
@@ -16,7 +16,7 @@
 #define XLS_NOC_SIMULATION_SIM_OBJECTS_H_
 
 #include <cstdint>
-#include <queue>
+#include <memory>
 #include <vector>
 
 #include "absl/status/statusor.h"
@@ -24,7 +24,9 @@
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
 #include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/ring_buffer.h"
 #include "xls/noc/simulation/simulator_shims.h"
+#include "xls/noc/simulation/traffic_statistics.h"
 
 // This file contains classes used to store, access, and define simulation
 // objects.  Each network object (defined network_graph.h) is associated
@@ -54,14 +56,15 @@ struct DataFlitQueueElement {
 };
 
 // Represents a fifo/buffer used to store phits.
+// The queue is sized to max_queue_size upon initialization.
 struct DataFlitQueue {
-  std::queue<DataFlitQueueElement> queue;
+  RingBuffer<DataFlitQueueElement> queue;
   int64_t max_queue_size;
 };
 
 // Represents a fifo/buffer used to store metadata phits.
 struct MetadataFlitQueue {
-  std::queue<MetadataFlit> queue;
+  RingBuffer<MetadataFlit> queue;
   int64_t max_queue_size;
 };
 
@@ -84,6 +87,10 @@ class SimNetworkComponentBase {
   // Returns the associated NetworkComponentId.
   NetworkComponentId GetId() const { return id_; }
 
+  // Returns true if the component holds no flits and no credits to apply.
+  // Simulating a cycle of an idle component then only propagates bubbles.
+  virtual bool IsIdle() const { return true; }
+
   virtual ~SimNetworkComponentBase() = default;
 
  protected:
@@ -156,6 +163,9 @@ class SimLink : public SimNetworkComponentBase {
   // Get the sink connection index that in used in the simulator.
   int64_t GetSinkConnectionIndex() const;
 
+  // A link is idle once its pipeline stages hold only bubbles.
+  bool IsIdle() const override;
+
  private:
   SimLink() = default;
 
@@ -173,10 +183,11 @@ class SimLink : public SimNetworkComponentBase {
   int64_t src_connection_index_;
   int64_t sink_connection_index_;
 
-  std::queue<TimedDataFlit> forward_data_stages_;
+  // Sized to the number of pipeline stages upon initialization.
+  RingBuffer<TimedDataFlit> forward_data_stages_;
   int64_t internal_forward_propagated_cycle_;
 
-  std::vector<std::queue<TimedMetadataFlit>> reverse_credit_stages_;
+  std::vector<RingBuffer<TimedMetadataFlit>> reverse_credit_stages_;
   std::vector<int64_t> internal_reverse_propagated_cycle_;
 };
 
@@ -193,6 +204,8 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   // Register a flit to be sent at a specific time.
   absl::Status SendFlitAtTime(TimedDataFlit flit);
 
+  bool IsIdle() const override;
+
  private:
   SimNetworkInterfaceSrc() = default;
 
@@ -203,7 +216,7 @@ class SimNetworkInterfaceSrc : public SimNetworkComponentBase {
   int64_t sink_connection_index_;
   std::vector<int64_t> credit_;
   std::vector<CreditState> credit_update_;
-  std::vector<std::queue<TimedDataFlit>> data_to_send_;
+  std::vector<RingBuffer<TimedDataFlit>> data_to_send_;
 };
 
 // Sink - traffic leaves the network via a sink.
@@ -218,32 +231,42 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
 
   // Returns all traffic received by this sink from the beginning
   // of the simulation.
+  //
+  // Note: Empty unless the simulator retains received traffic, see
+  //       NocSimulator::SetRetainReceivedTraffic().
   absl::Span<const TimedDataFlit> GetReceivedTraffic() {
     return received_traffic_;
   }
 
+  // Returns the number of flits received from the beginning of the
+  // simulation.
+  int64_t GetReceivedFlitCount() const {
+    int64_t count = 0;
+    for (const ReceivedTrafficStatistics& stats : received_statistics_) {
+      count += stats.FlitCount();
+    }
+    return count;
+  }
+
+  // Returns the statistics of the traffic received on a vc index.
+  const ReceivedTrafficStatistics& GetReceivedTrafficStatistics(
+      int64_t vc) const {
+    return received_statistics_.at(vc);
+  }
+
   // Returns the observed rate of traffic in MebiBytes Per Second from the
   // beginning of simulation to the last flit processed by this sink.
   //
   // VC is used to filter out the traffic as received on a specific vc index.
   // Negative VC is used to match any vc.
   double MeasuredTrafficRateInMiBps(int64_t cycle_time_ps, int64_t vc = -1) {
-    // TODO(tedhong): 2021-07-01 Factor this logic out into common library.
     int64_t num_bits = 0;
-    int64_t max_cycle = 0;
-    for (TimedDataFlit& f : received_traffic_) {
-      if (vc < 0) {
-        num_bits += f.flit.data_bit_count;
-      } else {
-        if (f.flit.vc == vc) {
-          num_bits += f.flit.data_bit_count;
-        }
-      }
-
-      if (max_cycle < f.cycle) {
-        max_cycle = f.cycle;
+    for (int64_t i = 0; i < received_statistics_.size(); ++i) {
+      if (vc < 0 || vc == i) {
+        num_bits += received_statistics_[i].BitCount();
       }
     }
+    int64_t max_cycle = last_received_cycle_;
 
     double total_sec = static_cast<double>(max_cycle + 1) *
                        static_cast<double>(cycle_time_ps) * 1.0e-12;
@@ -261,6 +284,10 @@ class SimNetworkInterfaceSink : public SimNetworkComponentBase {
   int64_t src_connection_index_;
   std::vector<DataFlitQueue> input_buffers_;
   std::vector<TimedDataFlit> received_traffic_;
+
+  // Accumulated per vc as flits are received.
+  std::vector<ReceivedTrafficStatistics> received_statistics_;
+  int64_t last_received_cycle_ = 0;
 };
 
 // Represents an input-buffered, fixed priority, credit-based, virtual-channel
@@ -296,6 +323,8 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   int64_t GetUtilizationCycleCount() const;
 
+  bool IsIdle() const override;
+
  private:
   SimInputBufferedVCRouter() = default;
 
@@ -367,8 +396,8 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 // state and objects.
 class NocSimulator {
  public:
-  NocSimulator()
-      : mgr_(nullptr), params_(nullptr), routing_(nullptr), cycle_(-1) {}
+  NocSimulator();
+  ~NocSimulator();
 
   // Creates all simulation objects for a given network.
   // NetworkManager, NocParameters, and DistributedRoutingTable should
@@ -448,6 +477,42 @@ class NocSimulator {
   // Runs a single tick of the simulator.
   bool Tick();
 
+  // If enabled, RunCycle() does not tick the network components on cycles
+  // where they would only propagate bubbles: the network holds no flits and
+  // no credits in flight, and no source has flits to send. Such a cycle
+  // leaves the state of the network unchanged, so idle stretches between
+  // injections cost only the pre- and post-cycle services. The simulation
+  // results are the same as when every cycle is ticked.
+  void SetSkipIdleCycles(bool skip) { skip_idle_cycles_ = skip; }
+
+  // Returns the number of cycles RunCycle() skipped since the start.
+  int64_t GetSkippedCycleCount() const { return skipped_cycle_count_; }
+
+  // If enabled (the default), network interface sinks keep every flit they
+  // receive (see SimNetworkInterfaceSink::GetReceivedTraffic()). Otherwise
+  // they only accumulate statistics, so memory use does not grow with the
+  // length of the simulation.
+  void SetRetainReceivedTraffic(bool retain) {
+    retain_received_traffic_ = retain;
+  }
+  bool RetainsReceivedTraffic() const { return retain_received_traffic_; }
+
+  // Simulates each cycle with `worker_count` threads (including the thread
+  // calling RunCycle).
+  //
+  // The network is cut at the links between routers: each router is grouped
+  // with the links it drives and the network interfaces attached to it, and
+  // the groups are split into `worker_count` partitions of consecutive
+  // network components. Partitions are ticked concurrently to a local fixed
+  // point; flits and credits crossing partitions are exchanged at a barrier
+  // between ticks, until all partitions converged. Links with pipeline stages
+  // decouple the partitions, so a cycle typically converges in a few ticks.
+  // The simulation results are the same as with a single thread.
+  //
+  // Must be called after Initialize() and before the first RunCycle().
+  // A worker_count of 1 or less simulates on the calling thread.
+  absl::Status SetWorkerCount(int64_t worker_count);
+
   // Register a service to run once at the beginning of each cycle.
   // TODO(tedhong): 2021-07-27 Add a scheme to provide a total order
   //                of services.
@@ -483,6 +548,24 @@ class NocSimulator {
   absl::Status CreateLink(NetworkComponentId nc_id);
   absl::Status CreateRouter(NetworkComponentId nc_id);
 
+  // Returns true if all components are idle and all connections carry
+  // bubbles and no credits.
+  bool IsNetworkIdle() const;
+
+  // State of the simulation with several threads, see SetWorkerCount().
+  struct ParallelState;
+
+  // Runs the ticks of the current cycle across the partitions of parallel_.
+  absl::Status RunParallelTicks(int64_t max_ticks);
+
+  // Ticks the components of a partition until they converged or no longer
+  // make progress. Returns true if they converged.
+  bool TickPartition(int64_t partition);
+
+  // Runs the ticks of the current cycle for a partition, in lockstep with
+  // the other partitions.
+  void RunPartitionCycle(int64_t partition);
+
   NetworkManager* mgr_;
   NocParameters* params_;
   DistributedRoutingTable* routing_;
@@ -490,6 +573,13 @@ class NocSimulator {
   NetworkId network_;
   int64_t cycle_;
 
+  bool retain_received_traffic_ = true;
+
+  bool skip_idle_cycles_ = false;
+  int64_t skipped_cycle_count_ = 0;
+  // True if the network was idle at the end of the last simulated cycle.
+  bool network_idle_ = false;
+
   // Map a specific ConnectionId to an index used to access
   // a specific SimConnectionState via the connections_ object.
   absl::flat_hash_map<ConnectionId, int64_t> connection_index_map_;
@@ -524,6 +614,9 @@ class NocSimulator {
 
   // Shims to services to run at the end of each cycle.
   std::vector<NocSimulatorServiceShim*> post_cycle_services_;
+
+  // Null unless the simulation runs on several threads.
+  std::unique_ptr<ParallelState> parallel_;
 };
 
 }  // namespace noc
@@ -14,6 +14,8 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/logging/logging.h"
@@ -295,6 +297,73 @@ TEST(SimObjectsTest, TreeNetwork0) {
       38146);
 }
 
+TEST(SimObjectsTest, TreeNetwork0SkipIdleCycles) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphTree000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId send_port_1,
+      FindNetworkComponentByName("SendPort1", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recv_port_3,
+      FindNetworkComponentByName("RecvPort3", graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t dest_index_3,
+      routing_table.GetSinkIndices().GetNetworkComponentIndex(recv_port_3));
+
+  // Sends a flit early, and another once the network has been idle for a
+  // while, with and without skipping the idle cycles.
+  std::vector<std::vector<int64_t>> receive_cycles;
+  for (bool skip_idle_cycles : {false, true}) {
+    NocSimulator simulator;
+    XLS_ASSERT_OK(simulator.Initialize(graph, params, routing_table,
+                                       graph.GetNetworkIds()[0]));
+    simulator.SetSkipIdleCycles(skip_idle_cycles);
+    XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSrc * sim_send_port_1,
+                             simulator.GetSimNetworkInterfaceSrc(send_port_1));
+
+    for (int64_t send_cycle : {1, 40}) {
+      while (simulator.GetCurrentCycle() < send_cycle - 1) {
+        XLS_ASSERT_OK(simulator.RunCycle());
+      }
+      XLS_ASSERT_OK_AND_ASSIGN(TimedDataFlit flit,
+                               DataFlitBuilder()
+                                   .Cycle(send_cycle)
+                                   .Type(FlitType::kTail)
+                                   .VirtualChannel(1)
+                                   .SourceIndex(0)
+                                   .DestinationIndex(dest_index_3)
+                                   .Data(UBits(send_cycle, 64))
+                                   .BuildTimedFlit());
+      XLS_ASSERT_OK(sim_send_port_1->SendFlitAtTime(flit));
+    }
+    while (simulator.GetCurrentCycle() < 60) {
+      XLS_ASSERT_OK(simulator.RunCycle());
+    }
+
+    if (skip_idle_cycles) {
+      EXPECT_GT(simulator.GetSkippedCycleCount(), 0);
+    } else {
+      EXPECT_EQ(simulator.GetSkippedCycleCount(), 0);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSink * sim_recv_port_3,
+                             simulator.GetSimNetworkInterfaceSink(recv_port_3));
+    std::vector<int64_t>& cycles = receive_cycles.emplace_back();
+    for (const TimedDataFlit& flit : sim_recv_port_3->GetReceivedTraffic()) {
+      cycles.push_back(flit.cycle);
+    }
+  }
+  EXPECT_EQ(receive_cycles[0].size(), 2);
+  EXPECT_EQ(receive_cycles[1], receive_cycles[0]);
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
@@ -12,6 +12,8 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/strings/str_format.h"
@@ -302,6 +304,83 @@ TEST(SimTrafficTest, NetworkWithRouterLoopAndReplay) {
   EXPECT_EQ(simulator.GetRouters()[1].GetUtilizationCycleCount(), 10);
 }
 
+TEST(SimTrafficTest, NetworkWithRouterLoopInParallel) {
+  // Construct traffic flows
+  NocTrafficManager traffic_mgr;
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficFlowId flow0_id,
+                           traffic_mgr.CreateTrafficFlow());
+  TrafficFlow& flow0 = traffic_mgr.GetTrafficFlow(flow0_id);
+  flow0.SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort1")
+      .SetVC("VC0")
+      .SetPacketSizeInBits(128)
+      .SetClockCycleTimes({0, 1, 2, 3, 4, 5, 6, 7, 8, 9});
+
+  XLS_ASSERT_OK_AND_ASSIGN(TrafficModeId mode0_id,
+                           traffic_mgr.CreateTrafficMode());
+  TrafficMode& mode0 = traffic_mgr.GetTrafficMode(mode0_id);
+  mode0.SetName("Mode 0").RegisterTrafficFlow(flow0_id);
+
+  // Build and assign simulation objects
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLoop000(&proto, &graph, &params));
+
+  // Create global routing table.
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetworkComponentId recv_port_1,
+      FindNetworkComponentByName("RecvPort1", graph, params));
+
+  // Simulate on one thread, then with each router in its own partition.
+  std::vector<std::vector<int64_t>> receive_cycles;
+  for (int64_t worker_count : {1, 2}) {
+    RandomNumberInterface rnd;
+    rnd.SetSeed(1000);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        NocTrafficInjector traffic_injector,
+        NocTrafficInjectorBuilder().Build(
+            /*cycle_time_in_ps=*/400, mode0_id,
+            routing_table.GetSourceIndices().GetNetworkComponents(),
+            routing_table.GetSinkIndices().GetNetworkComponents(),
+            params.GetNetworkParam(graph.GetNetworkIds()[0])
+                ->GetVirtualChannels(),
+            traffic_mgr, graph, params, rnd));
+
+    NocSimulator simulator;
+    XLS_ASSERT_OK(simulator.Initialize(graph, params, routing_table,
+                                       graph.GetNetworkIds()[0]));
+    XLS_ASSERT_OK(simulator.SetWorkerCount(worker_count));
+
+    NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                       traffic_injector);
+    traffic_injector.SetSimulatorShim(injector_shim);
+    simulator.RegisterPreCycleService(injector_shim);
+
+    for (int64_t i = 0; i < 20; ++i) {
+      XLS_ASSERT_OK(simulator.RunCycle());
+    }
+
+    EXPECT_EQ(simulator.GetRouters()[0].GetUtilizationCycleCount(), 10);
+    EXPECT_EQ(simulator.GetRouters()[1].GetUtilizationCycleCount(), 10);
+
+    XLS_ASSERT_OK_AND_ASSIGN(SimNetworkInterfaceSink * sink,
+                             simulator.GetSimNetworkInterfaceSink(recv_port_1));
+    std::vector<int64_t>& cycles = receive_cycles.emplace_back();
+    for (const TimedDataFlit& flit : sink->GetReceivedTraffic()) {
+      cycles.push_back(flit.cycle);
+    }
+  }
+  EXPECT_EQ(receive_cycles[0].size(), 10);
+  EXPECT_EQ(receive_cycles[1], receive_cycles[0]);
+}
+
 TEST(SimTrafficTest, NetworkWithMultiplePathsAndReplay) {
   // Construct traffic flows
   NocTrafficManager traffic_mgr;
@@ -21,12 +21,17 @@ NocSimulatorToLinkMonitorServiceShim::NocSimulatorToLinkMonitorServiceShim(
     : simulator_(simulator) {}
 
 absl::Status NocSimulatorToLinkMonitorServiceShim::RunCycle() {
-  // Count the number of packet passing through the link. A tail flit indicates
-  // the end of a packet.
+  ++cycle_count_;
+
+  // Count the number of flits and packets passing through the link. A tail
+  // flit indicates the end of a packet.
   for (const SimLink& link : simulator_.GetLinks()) {
     SimConnectionState& src =
         simulator_.GetSimConnectionByIndex(link.GetSourceConnectionIndex());
     const DataFlit& flit = src.forward_channels.flit;
+    if (flit.type != FlitType::kInvalid) {
+      ++link_to_flit_count_map_[link.GetId()];
+    }
     if (flit.type == FlitType::kTail) {
       DestinationToPacketCount& destination_to_pkt_count_map =
           link_to_packet_count_map_[link.GetId()];
@@ -42,4 +47,14 @@ NocSimulatorToLinkMonitorServiceShim::GetLinkToPacketCountMap() const {
   return link_to_packet_count_map_;
 }
 
+double NocSimulatorToLinkMonitorServiceShim::GetLinkUtilization(
+    NetworkComponentId link) const {
+  auto iter = link_to_flit_count_map_.find(link);
+  if (cycle_count_ == 0 || iter == link_to_flit_count_map_.end()) {
+    return 0.0;
+  }
+  return static_cast<double>(iter->second) /
+         static_cast<double>(cycle_count_);
+}
+
 }  // namespace xls::noc
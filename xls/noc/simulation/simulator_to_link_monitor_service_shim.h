@@ -53,10 +53,25 @@ class NocSimulatorToLinkMonitorServiceShim
   const absl::flat_hash_map<NetworkComponentId, DestinationToPacketCount>&
   GetLinkToPacketCountMap() const;
 
+  // Returns the number of flits that entered each link.
+  const absl::flat_hash_map<NetworkComponentId, int64_t>&
+  GetLinkToFlitCountMap() const {
+    return link_to_flit_count_map_;
+  }
+
+  // Returns the number of cycles monitored.
+  int64_t GetCycleCount() const { return cycle_count_; }
+
+  // Returns the fraction of the monitored cycles in which a flit entered the
+  // link.
+  double GetLinkUtilization(NetworkComponentId link) const;
+
  private:
   // Contains the packet count for each destination/vc pair at each link.
   absl::flat_hash_map<NetworkComponentId, DestinationToPacketCount>
       link_to_packet_count_map_;
+  absl::flat_hash_map<NetworkComponentId, int64_t> link_to_flit_count_map_;
+  int64_t cycle_count_ = 0;
   // TODO(vmirian) 11-8-21 should be const, but other API require change. So it
   // leave for now.
   NocSimulator& simulator_;
@@ -0,0 +1,41 @@
+// Copyright 2021 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_SIMULATION_SIMULATOR_TO_PROC_RUNTIME_SHIM_H_
+#define XLS_NOC_SIMULATION_SIMULATOR_TO_PROC_RUNTIME_SHIM_H_
+
+#include "absl/status/status.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/noc/simulation/simulator_shims.h"
+
+namespace xls::noc {
+
+// Shim which ticks a proc runtime once each time it is run, i.e., once per
+// simulated cycle when registered as a pre- or post-cycle service.
+class NocSimulatorToProcRuntimeShim : public NocSimulatorServiceShim {
+ public:
+  explicit NocSimulatorToProcRuntimeShim(ProcRuntime& runtime)
+      : runtime_(&runtime) {}
+
+  absl::Status RunCycle() override { return runtime_->Tick(); }
+
+  ProcRuntime& runtime() { return *runtime_; }
+
+ private:
+  ProcRuntime* runtime_;
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_SIMULATOR_TO_PROC_RUNTIME_SHIM_H_
@@ -0,0 +1,95 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "xls/noc/simulation/simulator_to_proc_runtime_shim.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
+#include "xls/noc/simulation/sample_network_graphs.h"
+#include "xls/noc/simulation/sim_objects.h"
+
+namespace xls::noc {
+namespace {
+
+using ::testing::ElementsAre;
+
+// A proc counting its own iterations.
+constexpr std::string_view kCounterIr = R"(package counter
+
+proc counter(tkn: token, count: bits[32], init={0}) {
+  literal.1: bits[32] = literal(value=1, id=1)
+  add.2: bits[32] = add(count, literal.1, id=2)
+  next (tkn, add.2)
+}
+)";
+
+class SimulatorToProcRuntimeShimTest : public ::testing::TestWithParam<bool> {
+};
+
+TEST_P(SimulatorToProcRuntimeShimTest, ProcsTickOncePerSimulatedCycle) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLinear000(&proto, &graph, &params));
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(DistributedRoutingTable routing_table,
+                           route_builder.BuildNetworkRoutingTables(
+                               graph.GetNetworkIds()[0], graph, params));
+  NocSimulator simulator;
+  XLS_ASSERT_OK(simulator.Initialize(graph, params, routing_table,
+                                     graph.GetNetworkIds()[0]));
+  // Services run on skipped idle cycles too.
+  simulator.SetSkipIdleCycles(GetParam());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kCounterIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * counter, package->GetProc("counter"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                           CreateInterpreterSerialProcRuntime(package.get()));
+  NocSimulatorToProcRuntimeShim shim(*runtime);
+  simulator.RegisterPostCycleService(shim);
+
+  constexpr int64_t kCycles = 20;
+  for (int64_t i = 0; i < kCycles; ++i) {
+    XLS_ASSERT_OK(simulator.RunCycle());
+    // Cycles are numbered from zero.
+    EXPECT_EQ(runtime->tick_count(), simulator.GetCurrentCycle() + 1);
+  }
+  EXPECT_EQ(&shim.runtime(), runtime.get());
+  EXPECT_EQ(runtime->tick_count(), kCycles);
+  EXPECT_THAT(runtime->ResolveState(counter),
+              ElementsAre(Value(UBits(kCycles, 32))));
+}
+
+INSTANTIATE_TEST_SUITE_P(SimulatorToProcRuntimeShimTestInstantiation,
+                         SimulatorToProcRuntimeShimTest, ::testing::Bool());
+
+}  // namespace
+}  // namespace xls::noc
@@ -72,6 +72,43 @@ std::vector<DataPacket> GeneralizedGeometricTrafficModel::GetNewCyclePackets(
   return packets;
 }
 
+absl::StatusOr<InjectionSchedule>
+GeneralizedGeometricTrafficModel::GenerateInjectionSchedule(
+    int64_t cycle_count, uint64_t key) const {
+  if (burst_prob_ >= 1.0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unable to schedule an unbounded burst, burst probability is %f.",
+        burst_prob_));
+  }
+
+  // Inter-arrival times are drawn a block at a time.
+  constexpr int64_t kBlockSize = 1024;
+  CounterBasedRandomNumbers rnd(key);
+  std::vector<int64_t> deltas(kBlockSize);
+  uint64_t next_delta_index = 0;
+
+  // As in GetNewCyclePackets, packets sent on cycle 0 are only due to a
+  // burst and every other packet is sent delta cycles after the previous one.
+  InjectionSchedule schedule;
+  int64_t cycle = 0;
+  while (cycle < cycle_count) {
+    rnd.GeneralizedGeometric(lambda_, burst_prob_, next_delta_index,
+                             absl::MakeSpan(deltas));
+    next_delta_index += kBlockSize;
+    for (int64_t delta : deltas) {
+      if (delta >= cycle_count - cycle) {
+        cycle = cycle_count;
+        break;
+      }
+      cycle += delta;
+      schedule.cycles.push_back(cycle);
+    }
+  }
+  schedule.packet_size_bits.assign(schedule.cycles.size(), packet_size_bits_);
+
+  return schedule;
+}
+
 GeneralizedGeometricTrafficModelBuilder::
     GeneralizedGeometricTrafficModelBuilder(double lambda, double burst_prob,
                                             int64_t packet_size_bits,
@@ -140,6 +177,16 @@ std::vector<DataPacket> ReplayTrafficModel::GetNewCyclePackets(int64_t cycle) {
   return packets;
 }
 
+absl::StatusOr<InjectionSchedule> ReplayTrafficModel::GenerateInjectionSchedule(
+    int64_t cycle_count, uint64_t key) const {
+  InjectionSchedule schedule;
+  auto end = std::lower_bound(clock_cycles_.begin(), clock_cycles_.end(),
+                              cycle_count);
+  schedule.cycles.assign(clock_cycles_.begin(), end);
+  schedule.packet_size_bits.assign(schedule.cycles.size(), packet_size_bits_);
+  return schedule;
+}
+
 double ReplayTrafficModel::ExpectedTrafficRateInMiBps(
     int64_t cycle_time_ps) const {
   double total_sec = static_cast<double>(cycle_count_ + 1) *
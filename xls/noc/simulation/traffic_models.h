@@ -32,6 +32,14 @@
 
 namespace xls::noc {
 
+// Packets of a flow injected over a range of cycles, stored as flat arrays
+// sorted by cycle: the i-th packet is sent on cycles[i] and is
+// packet_size_bits[i] bits long.
+struct InjectionSchedule {
+  std::vector<int64_t> cycles;
+  std::vector<int64_t> packet_size_bits;
+};
+
 // Traffic Model Base Class
 class TrafficModel {
  public:
@@ -48,6 +56,15 @@ class TrafficModel {
   // TODO(tedhong): 2021-06-27 Add an interface to support fast-forwarding.
   virtual std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) = 0;
 
+  // Returns all the packets sent in cycles [0, cycle_count), generated in bulk
+  // instead of cycle by cycle. Random decisions are drawn from a
+  // CounterBasedRandomNumbers stream keyed by `key`, so the schedule only
+  // depends on the key and not on the state of the model or of other flows.
+  //
+  // Note: This does not advance the model's internal state.
+  virtual absl::StatusOr<InjectionSchedule> GenerateInjectionSchedule(
+      int64_t cycle_count, uint64_t key) const = 0;
+
   // Returns expected rate of traffic injected in MebiBytes Per Sec.
   virtual double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const = 0;
 
@@ -143,6 +160,9 @@ class GeneralizedGeometricTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
+  absl::StatusOr<InjectionSchedule> GenerateInjectionSchedule(
+      int64_t cycle_count, uint64_t key) const override;
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override {
     double num_cycles = 1.0e12 / static_cast<double>(cycle_time_ps);
     double num_packets = lambda_ * num_cycles;
@@ -205,6 +225,10 @@ class ReplayTrafficModel : public TrafficModel {
 
   std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
 
+  // The key is unused as replayed traffic has no random decisions.
+  absl::StatusOr<InjectionSchedule> GenerateInjectionSchedule(
+      int64_t cycle_count, uint64_t key) const override;
+
   double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override;
 
   // Sets clock cycles to list and sorts the complete list of clock cycle.
@@ -14,6 +14,9 @@
 
 #include "xls/noc/simulation/traffic_models.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
@@ -186,5 +189,51 @@ TEST(TrafficModelsTest, ReplayModelClockCycleClearTest) {
   EXPECT_EQ(model.GetClockCycles(), std::vector<int64_t>({6, 7, 8, 9, 10}));
 }
 
+TEST(TrafficModelsTest, GeneralizedGeometricModelScheduleTest) {
+  double lambda = 0.2;
+  double burst_prob = 0.1;
+  int64_t packet_size_bits = 128;
+  int64_t cycle_count = 1'000'000;
+
+  RandomNumberInterface rnd;
+  GeneralizedGeometricTrafficModel model(lambda, burst_prob, packet_size_bits,
+                                         rnd);
+
+  XLS_ASSERT_OK_AND_ASSIGN(InjectionSchedule schedule,
+                           model.GenerateInjectionSchedule(cycle_count, 7));
+  ASSERT_EQ(schedule.cycles.size(), schedule.packet_size_bits.size());
+  EXPECT_TRUE(std::is_sorted(schedule.cycles.begin(), schedule.cycles.end()));
+  EXPECT_GE(schedule.cycles.front(), 0);
+  EXPECT_LT(schedule.cycles.back(), cycle_count);
+  EXPECT_THAT(schedule.packet_size_bits, testing::Each(packet_size_bits));
+  EXPECT_NEAR(static_cast<double>(schedule.cycles.size()) / cycle_count,
+              lambda, 1e-2);
+
+  // Schedules are reproducible and a shorter schedule is a prefix of a
+  // longer one.
+  XLS_ASSERT_OK_AND_ASSIGN(InjectionSchedule same,
+                           model.GenerateInjectionSchedule(cycle_count, 7));
+  EXPECT_EQ(same.cycles, schedule.cycles);
+  XLS_ASSERT_OK_AND_ASSIGN(InjectionSchedule prefix,
+                           model.GenerateInjectionSchedule(1000, 7));
+  EXPECT_TRUE(std::equal(prefix.cycles.begin(), prefix.cycles.end(),
+                         schedule.cycles.begin()));
+  XLS_ASSERT_OK_AND_ASSIGN(InjectionSchedule other,
+                           model.GenerateInjectionSchedule(cycle_count, 8));
+  EXPECT_NE(other.cycles, schedule.cycles);
+
+  model.SetBurstProb(1.0);
+  EXPECT_FALSE(model.GenerateInjectionSchedule(cycle_count, 7).ok());
+}
+
+TEST(TrafficModelsTest, ReplayModelScheduleTest) {
+  std::vector<int64_t> clock_cycles = {9, 2, 5, 100};
+  ReplayTrafficModel model(64, clock_cycles);
+  XLS_ASSERT_OK_AND_ASSIGN(InjectionSchedule schedule,
+                           model.GenerateInjectionSchedule(100, 0));
+  EXPECT_THAT(schedule.cycles, testing::ElementsAre(2, 5, 9));
+  EXPECT_THAT(schedule.packet_size_bits, testing::ElementsAre(64, 64, 64));
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -0,0 +1,122 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/traffic_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/numeric/bits.h"
+#include "xls/common/logging/logging.h"
+
+namespace xls::noc {
+
+LogHistogram::LogHistogram(int64_t sub_bucket_bits)
+    : sub_bucket_bits_(sub_bucket_bits) {
+  XLS_CHECK(sub_bucket_bits >= 0 && sub_bucket_bits < 32);
+}
+
+// Values v < 2^b (b = sub_bucket_bits_) have a bucket each. Otherwise, with
+// shift = floor(log2(v)) - b, the 2^b buckets of width 2^shift cover
+// [2^(b + shift), 2^(b + shift + 1)).
+int64_t LogHistogram::BucketIndex(int64_t value) const {
+  int64_t sub_bucket_count = int64_t{1} << sub_bucket_bits_;
+  if (value < sub_bucket_count) {
+    return value;
+  }
+  int64_t shift =
+      63 - absl::countl_zero(static_cast<uint64_t>(value)) - sub_bucket_bits_;
+  int64_t sub_bucket = (value >> shift) - sub_bucket_count;
+  return sub_bucket_count * (shift + 1) + sub_bucket;
+}
+
+int64_t LogHistogram::BucketLowerBound(int64_t index) const {
+  int64_t sub_bucket_count = int64_t{1} << sub_bucket_bits_;
+  if (index < sub_bucket_count) {
+    return index;
+  }
+  int64_t shift = index / sub_bucket_count - 1;
+  int64_t sub_bucket = index % sub_bucket_count;
+  return (sub_bucket_count + sub_bucket) << shift;
+}
+
+void LogHistogram::Add(int64_t value, int64_t count) {
+  XLS_CHECK_GE(value, 0);
+  int64_t index = BucketIndex(value);
+  if (index >= counts_.size()) {
+    counts_.resize(index + 1, 0);
+  }
+  counts_[index] += count;
+
+  count_ += count;
+  sum_ += value * count;
+  min_ = std::min(min_, value);
+  max_ = std::max(max_, value);
+}
+
+double LogHistogram::Mean() const {
+  if (count_ == 0) {
+    return 0.0;
+  }
+  return static_cast<double>(sum_) / static_cast<double>(count_);
+}
+
+int64_t LogHistogram::ValueAtQuantile(double q) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  int64_t rank = std::max<int64_t>(
+      1, static_cast<int64_t>(std::ceil(q * static_cast<double>(count_))));
+  int64_t seen = 0;
+  for (int64_t i = 0; i < counts_.size(); ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return BucketLowerBound(i);
+    }
+  }
+  return BucketLowerBound(counts_.size() - 1);
+}
+
+absl::flat_hash_map<int64_t, int64_t> LogHistogram::GetBucketCounts() const {
+  absl::flat_hash_map<int64_t, int64_t> bucket_counts;
+  for (int64_t i = 0; i < counts_.size(); ++i) {
+    if (counts_[i] != 0) {
+      bucket_counts[BucketLowerBound(i)] = counts_[i];
+    }
+  }
+  return bucket_counts;
+}
+
+void ReceivedTrafficStatistics::AddFlit(const TimedDataFlit& flit) {
+  ++flit_count_;
+  bit_count_ += flit.flit.data_bit_count;
+  bit_count_per_source_[flit.flit.source_index] += flit.flit.data_bit_count;
+
+  if (flit.flit.type == FlitType::kHead) {
+    head_injection_cycle_ = flit.metadata.injection_cycle_time;
+  } else if (flit.flit.type == FlitType::kTail) {
+    int64_t injection_cycle = head_injection_cycle_ >= 0
+                                  ? head_injection_cycle_
+                                  : flit.metadata.injection_cycle_time;
+    head_injection_cycle_ = -1;
+
+    packet_latency_.Add(flit.cycle - injection_cycle);
+    min_injection_cycle_ = std::min(min_injection_cycle_, injection_cycle);
+    max_injection_cycle_ = std::max(max_injection_cycle_, injection_cycle);
+    min_arrival_cycle_ = std::min(min_arrival_cycle_, flit.cycle);
+    max_arrival_cycle_ = std::max(max_arrival_cycle_, flit.cycle);
+  }
+}
+
+}  // namespace xls::noc
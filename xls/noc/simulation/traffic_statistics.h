@@ -0,0 +1,120 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_SIMULATION_TRAFFIC_STATISTICS_H_
+#define XLS_NOC_SIMULATION_TRAFFIC_STATISTICS_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "xls/noc/simulation/flit.h"
+
+// This file contains accumulators used to measure traffic as it flows
+// through the simulator, using memory independent of the length of the
+// simulation.
+
+namespace xls::noc {
+
+// Histogram of non-negative values with logarithmically sized buckets, in the
+// manner of HDR histograms.
+//
+// Values below 2^sub_bucket_bits are counted exactly. Larger values are
+// counted in buckets whose width is at most a 2^-sub_bucket_bits fraction of
+// the values they hold, so the memory used grows with the log of the largest
+// value rather than with the number of values.
+class LogHistogram {
+ public:
+  explicit LogHistogram(int64_t sub_bucket_bits = 7);
+
+  // Adds count occurrences of value.
+  void Add(int64_t value, int64_t count = 1);
+
+  int64_t Count() const { return count_; }
+
+  // Min, max and mean of the values added, exact regardless of bucketing.
+  // The min and max are respectively int64_t max and min if empty, and the
+  // mean is 0.
+  int64_t Min() const { return min_; }
+  int64_t Max() const { return max_; }
+  double Mean() const;
+
+  // Returns the lowest value of the bucket holding the value at quantile
+  // q in [0, 1], or 0 if empty.
+  int64_t ValueAtQuantile(double q) const;
+
+  // Returns the count of each non-empty bucket, keyed by the lowest value of
+  // the bucket.
+  absl::flat_hash_map<int64_t, int64_t> GetBucketCounts() const;
+
+ private:
+  int64_t BucketIndex(int64_t value) const;
+  int64_t BucketLowerBound(int64_t index) const;
+
+  int64_t sub_bucket_bits_;
+  std::vector<int64_t> counts_;
+
+  int64_t count_ = 0;
+  int64_t sum_ = 0;
+  int64_t min_ = std::numeric_limits<int64_t>::max();
+  int64_t max_ = std::numeric_limits<int64_t>::min();
+};
+
+// Statistics of the flits received on a single vc, accumulated one flit at a
+// time.
+//
+// The latency of a packet is measured from the injection of its head flit (or
+// of its tail flit for single flit packets) to the arrival of its tail flit.
+class ReceivedTrafficStatistics {
+ public:
+  // Accounts for a flit received on cycle `flit.cycle`.
+  void AddFlit(const TimedDataFlit& flit);
+
+  int64_t FlitCount() const { return flit_count_; }
+  int64_t BitCount() const { return bit_count_; }
+
+  // Bits received from each source index.
+  const absl::flat_hash_map<int64_t, int64_t>& GetBitCountPerSource() const {
+    return bit_count_per_source_;
+  }
+
+  // Packet latency in cycles.
+  const LogHistogram& GetPacketLatency() const { return packet_latency_; }
+
+  // Injection and arrival cycles of the received packets, int64_t max (min)
+  // for the minimum (maximum) if no packet was received.
+  int64_t MinInjectionCycle() const { return min_injection_cycle_; }
+  int64_t MaxInjectionCycle() const { return max_injection_cycle_; }
+  int64_t MinArrivalCycle() const { return min_arrival_cycle_; }
+  int64_t MaxArrivalCycle() const { return max_arrival_cycle_; }
+
+ private:
+  int64_t flit_count_ = 0;
+  int64_t bit_count_ = 0;
+  absl::flat_hash_map<int64_t, int64_t> bit_count_per_source_;
+
+  LogHistogram packet_latency_;
+  int64_t min_injection_cycle_ = std::numeric_limits<int64_t>::max();
+  int64_t max_injection_cycle_ = std::numeric_limits<int64_t>::min();
+  int64_t min_arrival_cycle_ = std::numeric_limits<int64_t>::max();
+  int64_t max_arrival_cycle_ = std::numeric_limits<int64_t>::min();
+
+  // Injection cycle of the head flit of the packet being received, or -1.
+  int64_t head_injection_cycle_ = -1;
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_TRAFFIC_STATISTICS_H_
@@ -0,0 +1,97 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/traffic_statistics.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/noc/simulation/flit.h"
+
+namespace xls::noc {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(TrafficStatisticsTest, LogHistogramSmallValuesAreExact) {
+  LogHistogram histogram(/*sub_bucket_bits=*/3);
+  EXPECT_EQ(histogram.Count(), 0);
+  EXPECT_EQ(histogram.ValueAtQuantile(0.5), 0);
+
+  for (int64_t i = 0; i < 16; ++i) {
+    histogram.Add(i);
+  }
+  histogram.Add(3, 4);
+
+  EXPECT_EQ(histogram.Count(), 20);
+  EXPECT_EQ(histogram.Min(), 0);
+  EXPECT_EQ(histogram.Max(), 15);
+  EXPECT_DOUBLE_EQ(histogram.Mean(), (120.0 + 12.0) / 20.0);
+  EXPECT_EQ(histogram.ValueAtQuantile(0.0), 0);
+  EXPECT_EQ(histogram.ValueAtQuantile(0.5), 5);
+  EXPECT_EQ(histogram.ValueAtQuantile(1.0), 15);
+  EXPECT_EQ(histogram.GetBucketCounts().at(3), 5);
+  EXPECT_EQ(histogram.GetBucketCounts().size(), 16);
+}
+
+TEST(TrafficStatisticsTest, LogHistogramLargeValuesAreBucketed) {
+  LogHistogram histogram(/*sub_bucket_bits=*/3);
+  // 8 buckets per power of two above 8: [64, 72), [72, 80), ...
+  histogram.Add(64);
+  histogram.Add(71);
+  histogram.Add(72);
+  histogram.Add(1'000'000'000);
+
+  EXPECT_EQ(histogram.Max(), 1'000'000'000);
+  EXPECT_THAT(histogram.GetBucketCounts(),
+              UnorderedElementsAre(Pair(64, 2), Pair(72, 1),
+                                   Pair(939'524'096, 1)));
+  EXPECT_EQ(histogram.ValueAtQuantile(1.0), 939'524'096);
+}
+
+TEST(TrafficStatisticsTest, ReceivedTrafficStatistics) {
+  auto make_flit = [](FlitType type, int64_t source, int64_t injection_cycle,
+                      int64_t cycle) {
+    TimedDataFlit flit;
+    flit.cycle = cycle;
+    flit.flit.type = type;
+    flit.flit.source_index = source;
+    flit.flit.data_bit_count = 32;
+    flit.metadata.injection_cycle_time = injection_cycle;
+    return flit;
+  };
+
+  ReceivedTrafficStatistics stats;
+  // A two flit packet from source 0 and a single flit packet from source 1.
+  stats.AddFlit(make_flit(FlitType::kHead, 0, 10, 15));
+  stats.AddFlit(make_flit(FlitType::kTail, 0, 11, 17));
+  stats.AddFlit(make_flit(FlitType::kTail, 1, 12, 20));
+
+  EXPECT_EQ(stats.FlitCount(), 3);
+  EXPECT_EQ(stats.BitCount(), 96);
+  EXPECT_THAT(stats.GetBitCountPerSource(),
+              UnorderedElementsAre(Pair(0, 64), Pair(1, 32)));
+  EXPECT_EQ(stats.GetPacketLatency().Count(), 2);
+  EXPECT_EQ(stats.GetPacketLatency().Min(), 7);
+  EXPECT_EQ(stats.GetPacketLatency().Max(), 8);
+  EXPECT_EQ(stats.MinInjectionCycle(), 10);
+  EXPECT_EQ(stats.MaxInjectionCycle(), 12);
+  EXPECT_EQ(stats.MinArrivalCycle(), 17);
+  EXPECT_EQ(stats.MaxArrivalCycle(), 20);
+}
+
+}  // namespace
+}  // namespace xls::noc
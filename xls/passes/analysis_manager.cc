@@ -0,0 +1,103 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/analysis_manager.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+AnalysisManager::AnalysisManager(AnalysisManager&& other) {
+  absl::MutexLock lock(&other.mutex_);
+  analyses_ = std::move(other.analyses_);
+  hit_count_ = other.hit_count_;
+  miss_count_ = other.miss_count_;
+}
+
+AnalysisManager& AnalysisManager::operator=(AnalysisManager&& other) {
+  if (this != &other) {
+    absl::MutexLock lock(&mutex_);
+    absl::MutexLock other_lock(&other.mutex_);
+    analyses_ = std::move(other.analyses_);
+    hit_count_ = other.hit_count_;
+    miss_count_ = other.miss_count_;
+  }
+  return *this;
+}
+
+std::optional<std::shared_ptr<void>> AnalysisManager::Lookup(FunctionBase* f,
+                                                             const void* key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = analyses_.find({f->uid(), key});
+  if (it == analyses_.end() || it->second.change_count != f->change_count()) {
+    ++miss_count_;
+    return std::nullopt;
+  }
+  ++hit_count_;
+  return it->second.analysis;
+}
+
+void AnalysisManager::Insert(FunctionBase* f, const void* key,
+                             std::shared_ptr<void> analysis) {
+  absl::MutexLock lock(&mutex_);
+  analyses_[{f->uid(), key}] =
+      CachedAnalysis{.change_count = f->change_count(),
+                     .analysis = std::move(analysis)};
+}
+
+void AnalysisManager::MarkPreserved(FunctionBase* f, const void* key) {
+  absl::MutexLock lock(&mutex_);
+  auto it = analyses_.find({f->uid(), key});
+  if (it != analyses_.end()) {
+    it->second.change_count = f->change_count();
+  }
+}
+
+void AnalysisManager::DropStaleAnalyses(Package* p) {
+  absl::flat_hash_map<int64_t, int64_t> change_counts;
+  for (FunctionBase* f : p->GetFunctionBases()) {
+    change_counts[f->uid()] = f->change_count();
+  }
+  absl::MutexLock lock(&mutex_);
+  absl::erase_if(analyses_, [&](const auto& entry) {
+    auto it = change_counts.find(entry.first.first);
+    return it == change_counts.end() ||
+           it->second != entry.second.change_count;
+  });
+}
+
+int64_t AnalysisManager::size() const {
+  absl::MutexLock lock(&mutex_);
+  return analyses_.size();
+}
+
+int64_t AnalysisManager::hit_count() const {
+  absl::MutexLock lock(&mutex_);
+  return hit_count_;
+}
+
+int64_t AnalysisManager::miss_count() const {
+  absl::MutexLock lock(&mutex_);
+  return miss_count_;
+}
+
+}  // namespace xls
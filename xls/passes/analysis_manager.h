@@ -0,0 +1,133 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_ANALYSIS_MANAGER_H_
+#define XLS_PASSES_ANALYSIS_MANAGER_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// A cache of analyses of function bases (query engines, dominator analyses,
+// etc.) shared by the passes of a pipeline so that passes running on an
+// unchanged function base reuse the analyses computed by earlier passes rather
+// than recomputing them.
+//
+// Analyses are identified by their C++ type and are valid for the version of
+// the function base (FunctionBase::change_count) they were computed for, so
+// any mutation of the function base invalidates them unless the mutating pass
+// declares the analysis preserved with MarkPreserved. Stale analyses are
+// freed by DropStaleAnalyses which FunctionBasePass calls after each run.
+//
+// The methods are thread-safe so that passes running on different function
+// bases concurrently may use the cache.
+class AnalysisManager {
+ public:
+  AnalysisManager() = default;
+  AnalysisManager(AnalysisManager&& other);
+  AnalysisManager& operator=(AnalysisManager&& other);
+
+  // Returns the analysis of type T of `f`. Unless an analysis computed for the
+  // current version of `f` is cached, calls `compute` and caches the result.
+  // The returned analysis remains usable after it is dropped from the cache.
+  template <typename T>
+  absl::StatusOr<std::shared_ptr<T>> GetOrCompute(
+      FunctionBase* f,
+      absl::FunctionRef<absl::StatusOr<std::unique_ptr<T>>(FunctionBase*)>
+          compute) {
+    if (std::optional<std::shared_ptr<void>> cached = Lookup(f, Key<T>());
+        cached.has_value()) {
+      return std::static_pointer_cast<T>(*std::move(cached));
+    }
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<T> computed, compute(f));
+    std::shared_ptr<T> analysis = std::move(computed);
+    Insert(f, Key<T>(), analysis);
+    return analysis;
+  }
+
+  // Returns the query engine of type T (which must be default constructible)
+  // populated with `f`.
+  template <typename T>
+  absl::StatusOr<std::shared_ptr<T>> GetQueryEngine(FunctionBase* f) {
+    return GetOrCompute<T>(
+        f, [](FunctionBase* f) -> absl::StatusOr<std::unique_ptr<T>> {
+          auto query_engine = std::make_unique<T>();
+          XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
+          return query_engine;
+        });
+  }
+
+  // Declares that the mutations of `f` since the cached analysis of type T (if
+  // any) was computed do not affect the analysis so it remains valid for the
+  // current version of `f`.
+  template <typename T>
+  void MarkPreserved(FunctionBase* f) {
+    MarkPreserved(f, Key<T>());
+  }
+
+  // Drops the cached analyses of function bases which have changed since the
+  // analyses were computed or which are no longer in `p`.
+  void DropStaleAnalyses(Package* p);
+
+  // Returns the number of cached analyses.
+  int64_t size() const;
+
+  // Returns the number of calls to GetOrCompute which found the analysis in
+  // the cache and which computed the analysis, respectively.
+  int64_t hit_count() const;
+  int64_t miss_count() const;
+
+ private:
+  struct CachedAnalysis {
+    // The version of the function base the analysis is valid for.
+    int64_t change_count;
+    std::shared_ptr<void> analysis;
+  };
+
+  // The key of the cache by which analyses of type T are identified.
+  template <typename T>
+  static const void* Key() {
+    static const char kKey = 0;
+    return &kKey;
+  }
+
+  std::optional<std::shared_ptr<void>> Lookup(FunctionBase* f,
+                                              const void* key);
+  void Insert(FunctionBase* f, const void* key,
+              std::shared_ptr<void> analysis);
+  void MarkPreserved(FunctionBase* f, const void* key);
+
+  mutable absl::Mutex mutex_;
+  // Keyed by the uid of the function base and the key of the analysis type.
+  absl::flat_hash_map<std::pair<int64_t, const void*>, CachedAnalysis>
+      analyses_ ABSL_GUARDED_BY(mutex_);
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_ANALYSIS_MANAGER_H_
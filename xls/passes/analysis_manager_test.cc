@@ -0,0 +1,110 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/analysis_manager.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+// An analysis which records the number of nodes of the function base.
+struct NodeCount {
+  int64_t count;
+};
+
+class AnalysisManagerTest : public IrTestBase {
+ protected:
+  absl::StatusOr<std::shared_ptr<NodeCount>> GetNodeCount(
+      AnalysisManager& analyses, FunctionBase* f) {
+    return analyses.GetOrCompute<NodeCount>(
+        f, [&](FunctionBase* f) -> absl::StatusOr<std::unique_ptr<NodeCount>> {
+          ++compute_count_;
+          return std::make_unique<NodeCount>(NodeCount{f->node_count()});
+        });
+  }
+
+  int64_t compute_count_ = 0;
+};
+
+TEST_F(AnalysisManagerTest, CachesUntilChanged) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  AnalysisManager analyses;
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<NodeCount> count,
+                           GetNodeCount(analyses, f));
+  EXPECT_EQ(count->count, 2);
+  XLS_ASSERT_OK_AND_ASSIGN(count, GetNodeCount(analyses, f));
+  EXPECT_EQ(count->count, 2);
+  EXPECT_EQ(compute_count_, 1);
+  EXPECT_EQ(analyses.hit_count(), 1);
+  EXPECT_EQ(analyses.miss_count(), 1);
+
+  // Analyses of different types are cached separately.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<TernaryQueryEngine> query_engine,
+      analyses.GetQueryEngine<TernaryQueryEngine>(f));
+  EXPECT_TRUE(query_engine->IsTracked(f->return_value()));
+  EXPECT_EQ(analyses.size(), 2);
+
+  // Mutating the function invalidates the analyses.
+  XLS_ASSERT_OK(
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(0, 8))).status());
+  XLS_ASSERT_OK_AND_ASSIGN(count, GetNodeCount(analyses, f));
+  EXPECT_EQ(count->count, 3);
+  EXPECT_EQ(compute_count_, 2);
+
+  // The query engine is stale and dropped; the node count is not.
+  analyses.DropStaleAnalyses(p.get());
+  EXPECT_EQ(analyses.size(), 1);
+}
+
+TEST_F(AnalysisManagerTest, MarkPreserved) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Not(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  AnalysisManager analyses;
+  XLS_ASSERT_OK(GetNodeCount(analyses, f).status());
+  // Renaming a node does not change the node count.
+  x.node()->SetName("y");
+  f->NoteNodeChanged(x.node());
+  analyses.MarkPreserved<NodeCount>(f);
+  XLS_ASSERT_OK(GetNodeCount(analyses, f).status());
+  EXPECT_EQ(compute_count_, 1);
+
+  // Analyses of function bases removed from the package are dropped.
+  XLS_ASSERT_OK(p->RemoveFunction(f));
+  analyses.DropStaleAnalyses(p.get());
+  EXPECT_EQ(analyses.size(), 0);
+}
+
+}  // namespace
+}  // namespace xls
@@ -31,6 +31,8 @@ class ArithSimplificationPass : public FunctionBasePass {
         opt_level_(opt_level) {}
   ~ArithSimplificationPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   int64_t opt_level_;
 
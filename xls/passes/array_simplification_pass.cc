@@ -14,6 +14,10 @@
 
 #include "xls/passes/array_simplification_pass.h"
 
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/bits_ops.h"
@@ -22,6 +26,7 @@
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/passes/ternary_query_engine.h"
 
 namespace xls {
@@ -150,6 +155,46 @@ absl::StatusOr<bool> SimplifyArrayIndex(ArrayIndex* array_index,
     return true;
   }
 
+  // An array index into a literal whose leading indices are literals can be
+  // replaced by a literal of the indexed element, or an index into it:
+  //
+  //   array_index(L, {2, i, j, ...}) => array_index(L[2], {i, j, ...})
+  //
+  // The new literal shares storage with L so this is cheap even for very large
+  // literal arrays such as lookup tables.
+  if (array_index->array()->Is<Literal>()) {
+    const Value* element = &array_index->array()->As<Literal>()->value();
+    int64_t literal_index_count = 0;
+    for (Node* index : array_index->indices()) {
+      if (!index->Is<Literal>() || element->empty()) {
+        break;
+      }
+      // Out-of-bounds indices are clamped to the last element.
+      const Bits& index_bits = index->As<Literal>()->value().bits();
+      int64_t i = bits_ops::UGreaterThanOrEqual(index_bits, element->size())
+                      ? element->size() - 1
+                      : index_bits.ToUint64().value();
+      element = &element->element(i);
+      ++literal_index_count;
+    }
+    if (literal_index_count > 0) {
+      XLS_ASSIGN_OR_RETURN(Literal * literal,
+                           array_index->function_base()->MakeNode<Literal>(
+                               array_index->loc(), *element));
+      if (literal_index_count == array_index->indices().size()) {
+        XLS_RETURN_IF_ERROR(array_index->ReplaceUsesWith(literal));
+      } else {
+        XLS_RETURN_IF_ERROR(
+            array_index
+                ->ReplaceUsesWithNew<ArrayIndex>(
+                    literal,
+                    array_index->indices().subspan(literal_index_count))
+                .status());
+      }
+      return true;
+    }
+  }
+
   // An array index which indexes into a kArray operation and whose first
   // index element is a literal can be simplified by bypassing the kArray
   // operation:
@@ -542,6 +587,111 @@ absl::StatusOr<bool> SimplifyArrayUpdate(ArrayUpdate* array_update,
   return false;
 }
 
+// Returns true if the given node is an array update whose update value and
+// indices are all literals.
+bool IsLiteralArrayUpdate(Node* node) {
+  if (!node->Is<ArrayUpdate>()) {
+    return false;
+  }
+  ArrayUpdate* array_update = node->As<ArrayUpdate>();
+  if (!array_update->update_value()->Is<Literal>()) {
+    return false;
+  }
+  for (Node* index : array_update->indices()) {
+    if (!index->Is<Literal>()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns `value` with the element at the given literal indices replaced by
+// `update_value`, or `value` itself if an index is out of bounds. Only the
+// arrays along the indexed path are rebuilt; all other elements share storage
+// with `value`.
+Value UpdateLiteralValue(const Value& value, absl::Span<Node* const> indices,
+                         const Value& update_value) {
+  if (indices.empty()) {
+    return update_value;
+  }
+  const Bits& index_bits = indices.front()->As<Literal>()->value().bits();
+  if (bits_ops::UGreaterThanOrEqual(index_bits, value.size())) {
+    return value;
+  }
+  uint64_t i = index_bits.ToUint64().value();
+  std::vector<Value> elements(value.elements().begin(),
+                              value.elements().end());
+  elements[i] = UpdateLiteralValue(elements[i], indices.subspan(1),
+                                   update_value);
+  return Value::ArrayOwned(std::move(elements));
+}
+
+// Returns the value of the literal array `base` after applying the given chain
+// of literal array updates, which is ordered from the last update to the
+// first. The elements of `base` are gathered once for the whole chain.
+Value ApplyLiteralArrayUpdates(const Value& base,
+                               absl::Span<ArrayUpdate* const> chain) {
+  std::vector<Value> elements(base.elements().begin(), base.elements().end());
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    ArrayUpdate* array_update = *it;
+    const Value& update_value =
+        array_update->update_value()->As<Literal>()->value();
+    absl::Span<Node* const> indices = array_update->indices();
+    if (indices.empty()) {
+      elements.assign(update_value.elements().begin(),
+                      update_value.elements().end());
+      continue;
+    }
+    const Bits& index_bits = indices.front()->As<Literal>()->value().bits();
+    if (bits_ops::UGreaterThanOrEqual(index_bits, elements.size())) {
+      continue;
+    }
+    uint64_t i = index_bits.ToUint64().value();
+    elements[i] =
+        UpdateLiteralValue(elements[i], indices.subspan(1), update_value);
+  }
+  return Value::ArrayOwned(std::move(elements));
+}
+
+// Replaces chains of literal array updates (see IsLiteralArrayUpdate) of a
+// literal array with a single literal. Each chain is folded in one step from
+// its last update, so a large literal array (e.g., a table initialized by an
+// unrolled loop) is rebuilt once per chain rather than once per update, and is
+// never exploded into a kArray of element literals by SimplifyArrayUpdate.
+absl::StatusOr<bool> FoldLiteralArrayUpdateChains(FunctionBase* func) {
+  // Updates which only feed a chain already folded. They are dead.
+  absl::flat_hash_set<Node*> folded;
+  bool changed = false;
+  // Visit the last update of each chain before the earlier ones.
+  for (Node* node : ReverseTopoSort(func)) {
+    if (!IsLiteralArrayUpdate(node) || folded.contains(node)) {
+      continue;
+    }
+    std::vector<ArrayUpdate*> chain;
+    Node* source = node;
+    while (IsLiteralArrayUpdate(source)) {
+      ArrayUpdate* array_update = source->As<ArrayUpdate>();
+      chain.push_back(array_update);
+      source = array_update->array_to_update();
+      if (source->users().size() == 1 && !func->HasImplicitUse(source)) {
+        folded.insert(source);
+      }
+    }
+    if (!source->Is<Literal>()) {
+      continue;
+    }
+    XLS_VLOG(3) << absl::StreamFormat(
+        "Folding chain of %d literal array updates ending at %s", chain.size(),
+        node->GetName());
+    XLS_RETURN_IF_ERROR(
+        node->ReplaceUsesWithNew<Literal>(
+                ApplyLiteralArrayUpdates(source->As<Literal>()->value(), chain))
+            .status());
+    changed = true;
+  }
+  return changed;
+}
+
 // Tries to flatten a chain of consecutive array update operations into a single
 // kArray op which gathers the elements written into the array. Returns a vector
 // of the optimized away update operations or nullopt is no optimization was
@@ -912,8 +1062,13 @@ absl::StatusOr<bool> ArraySimplificationPass::RunOnFunctionBaseInternal(
   XLS_ASSIGN_OR_RETURN(bool clamp_changed, ClampArrayIndexIndices(func));
   changed |= clamp_changed;
 
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  XLS_ASSIGN_OR_RETURN(bool fold_changed, FoldLiteralArrayUpdateChains(func));
+  changed |= fold_changed;
+
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<TernaryQueryEngine> shared_query_engine,
+      results->analyses.GetQueryEngine<TernaryQueryEngine>(func));
+  const TernaryQueryEngine& query_engine = *shared_query_engine;
 
   for (Node* node : TopoSort(func)) {
     if (node->Is<ArrayIndex>()) {
@@ -29,6 +29,8 @@ class ArraySimplificationPass : public FunctionBasePass {
       : FunctionBasePass("array_simp", "Array Simplification"),
         opt_level_(opt_level) {}
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   int64_t opt_level_;
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
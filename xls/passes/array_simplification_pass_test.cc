@@ -848,6 +848,85 @@ TEST_F(ArraySimplificationPassTest, UpdateOfLiteralArrayNested) {
                m::Literal(Value::UBitsArray({44, 55, 66}, 32).value())));
 }
 
+TEST_F(ArraySimplificationPassTest, LiteralUpdateChainOfLiteralArray) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+ fn func() -> bits[32][4] {
+  zero: bits[14] = literal(value=0)
+  three: bits[14] = literal(value=3)
+  oob: bits[14] = literal(value=7)
+  v0: bits[32] = literal(value=10)
+  v1: bits[32] = literal(value=40)
+  v2: bits[32] = literal(value=11)
+  v3: bits[32] = literal(value=99)
+  a: bits[32][4] = literal(value=[1, 2, 3, 4])
+  u0: bits[32][4] = array_update(a, v0, indices=[zero])
+  u1: bits[32][4] = array_update(u0, v1, indices=[three])
+  u2: bits[32][4] = array_update(u1, v2, indices=[zero])
+  ret u3: bits[32][4] = array_update(u2, v3, indices=[oob])
+ }
+  )",
+                                                       p.get()));
+  // The whole chain is folded in a single run of the pass, without
+  // constant folding.
+  PassResults results;
+  EXPECT_THAT(
+      ArraySimplificationPass().RunOnFunctionBase(f, PassOptions(), &results),
+      IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Literal(Value::UBitsArray({11, 2, 3, 40}, 32).value()));
+}
+
+TEST_F(ArraySimplificationPassTest, LiteralUpdateChainOfLiteralArrayNested) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+ fn func() -> (bits[32][2][2], bits[32][2][2]) {
+  zero: bits[14] = literal(value=0)
+  one: bits[14] = literal(value=1)
+  v: bits[32] = literal(value=7)
+  row: bits[32][2] = literal(value=[8, 9])
+  a: bits[32][2][2] = literal(value=[[1, 2], [3, 4]])
+  u0: bits[32][2][2] = array_update(a, v, indices=[one, zero])
+  u1: bits[32][2][2] = array_update(u0, row, indices=[zero])
+  ret result: (bits[32][2][2], bits[32][2][2]) = tuple(u0, u1)
+ }
+  )",
+                                                       p.get()));
+  PassResults results;
+  EXPECT_THAT(
+      ArraySimplificationPass().RunOnFunctionBase(f, PassOptions(), &results),
+      IsOkAndHolds(true));
+  // u0 has a use outside of the chain so it is folded on its own.
+  EXPECT_THAT(
+      f->return_value(),
+      m::Tuple(m::Literal(Value::UBits2DArray({{1, 2}, {7, 4}}, 32).value()),
+               m::Literal(Value::UBits2DArray({{8, 9}, {7, 4}}, 32).value())));
+}
+
+TEST_F(ArraySimplificationPassTest, IndexOfLiteralArray) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+ fn func(i: bits[32]) -> (bits[32], bits[32]) {
+  one: bits[14] = literal(value=1)
+  oob: bits[14] = literal(value=5)
+  a: bits[32][2][3] = literal(value=[[1, 2], [3, 4], [5, 6]])
+  x: bits[32] = array_index(a, indices=[one, i])
+  y: bits[32] = array_index(a, indices=[oob, oob])
+  ret result: (bits[32], bits[32]) = tuple(x, y)
+ }
+  )",
+                                                       p.get()));
+  PassResults results;
+  EXPECT_THAT(
+      ArraySimplificationPass().RunOnFunctionBase(f, PassOptions(), &results),
+      IsOkAndHolds(true));
+  EXPECT_THAT(
+      f->return_value(),
+      m::Tuple(m::ArrayIndex(m::Literal(Value::UBitsArray({3, 4}, 32).value()),
+                             /*indices=*/{m::Param("i")}),
+               m::Literal(6)));
+}
+
 TEST_F(ArraySimplificationPassTest,
        ConditionalAssignmentOfArrayElementUpdatedOnTrue) {
   auto p = CreatePackage();
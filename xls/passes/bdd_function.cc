@@ -105,12 +105,10 @@ class SaturatingBddEvaluator
         std::holds_alternative<TooManyPaths>(b)) {
       return TooManyPaths();
     }
+    int64_t variable_count = bdd_->variable_count();
     BddNodeIndex result =
         bdd_->And(std::get<BddNodeIndex>(a), std::get<BddNodeIndex>(b));
-    if (path_limit_ > 0 && bdd_->path_count(result) > path_limit_) {
-      return TooManyPaths();
-    }
-    return result;
+    return Saturate(result, variable_count);
   }
 
   SaturatingBddNodeIndex Or(const SaturatingBddNodeIndex& a,
@@ -119,15 +117,28 @@ class SaturatingBddEvaluator
         std::holds_alternative<TooManyPaths>(b)) {
       return TooManyPaths();
     }
+    int64_t variable_count = bdd_->variable_count();
     BddNodeIndex result =
         bdd_->Or(std::get<BddNodeIndex>(a), std::get<BddNodeIndex>(b));
+    return Saturate(result, variable_count);
+  }
+
+ private:
+  // Returns the given result of an And/Or operation or TooManyPaths if the
+  // result exceeds the path limit or if the operation hit the node limit of
+  // the BDD (in which case the BDD returns a new variable, creating which is
+  // detected by the change of the variable count).
+  SaturatingBddNodeIndex Saturate(BddNodeIndex result,
+                                  int64_t variable_count) const {
+    if (bdd_->variable_count() != variable_count) {
+      return TooManyPaths();
+    }
     if (path_limit_ > 0 && bdd_->path_count(result) > path_limit_) {
       return TooManyPaths();
     }
     return result;
   }
 
- private:
   int64_t path_limit_;
   BinaryDecisionDiagram* bdd_;
 };
@@ -266,11 +277,13 @@ bool ShouldEvaluate(Node* node) {
 
 /* static */ absl::StatusOr<std::unique_ptr<BddFunction>> BddFunction::Run(
     FunctionBase* f, int64_t path_limit,
-    std::optional<std::function<bool(const Node*)>> node_filter) {
+    std::optional<std::function<bool(const Node*)>> node_filter,
+    int64_t node_limit) {
   XLS_VLOG(1) << absl::StreamFormat("BddFunction::Run(%s):", f->name());
   XLS_VLOG_LINES(5, f->DumpIr());
 
   auto bdd_function = absl::WrapUnique(new BddFunction(f));
+  bdd_function->bdd().set_node_limit(node_limit);
   SaturatingBddEvaluator evaluator(path_limit, &bdd_function->bdd());
 
   // Create and return a vector containing newly defined BDD variables.
@@ -285,6 +298,7 @@ bool ShouldEvaluate(Node* node) {
 
   XLS_VLOG(3) << "BDD expressions:";
   absl::flat_hash_map<Node*, SaturatingBddNodeVector> values;
+  bool collect_garbage = true;
   for (Node* node : TopoSort(f)) {
     XLS_VLOG(3) << "node: " << node->ToString();
     if (!node->GetType()->IsBits()) {
@@ -321,13 +335,35 @@ bool ShouldEvaluate(Node* node) {
         }
       }
     }
-    XLS_VLOG(5) << "  " << node->GetName() << ":";
-    for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
-      XLS_VLOG(5) << absl::StreamFormat(
-          "    bit %d : %s", i,
-          bdd_function->bdd().ToStringDnf(
-              std::get<BddNodeIndex>(values.at(node)[i]),
-              /*minterm_limit=*/15));
+
+    // If the node limit was hit, free the nodes of the intermediate
+    // expressions so the remaining nodes may still be evaluated precisely.
+    // Stop collecting once a collection frees too little to be worthwhile.
+    if (bdd_function->bdd().node_limit_exceeded()) {
+      bdd_function->bdd().ClearNodeLimitExceeded();
+      if (collect_garbage) {
+        std::vector<BddNodeIndex> roots;
+        for (const auto& [_, vector] : values) {
+          for (const SaturatingBddNodeIndex& value : vector) {
+            roots.push_back(std::get<BddNodeIndex>(value));
+          }
+        }
+        bdd_function->bdd().GarbageCollect(roots);
+        collect_garbage = bdd_function->bdd().size() < node_limit * 9 / 10;
+        XLS_VLOG(2) << absl::StreamFormat(
+            "  node limit hit, %d nodes after garbage collection",
+            bdd_function->bdd().size());
+      }
+    }
+    if (XLS_VLOG_IS_ON(5)) {
+      XLS_VLOG(5) << "  " << node->GetName() << ":";
+      for (int64_t i = 0; i < node->BitCountOrDie(); ++i) {
+        XLS_VLOG(5) << absl::StreamFormat(
+            "    bit %d : %s", i,
+            bdd_function->bdd().ToStringDnf(
+                std::get<BddNodeIndex>(values.at(node)[i]),
+                /*minterm_limit=*/15));
+      }
     }
   }
 
@@ -337,9 +373,18 @@ bool ShouldEvaluate(Node* node) {
   for (const auto& pair : values) {
     bdd_function->node_map_[pair.first] = ToBddNodeVector(pair.second);
   }
+  bdd_function->GarbageCollect();
   return std::move(bdd_function);
 }
 
+void BddFunction::GarbageCollect() {
+  std::vector<BddNodeIndex> roots;
+  for (const auto& [_, vector] : node_map_) {
+    roots.insert(roots.end(), vector.begin(), vector.end());
+  }
+  bdd_.GarbageCollect(roots);
+}
+
 absl::StatusOr<Value> BddFunction::Evaluate(
     absl::Span<const Value> args) const {
   if (!func_base_->IsFunction()) {
@@ -48,6 +48,12 @@ class BddFunction {
   // variable. This provides a mechanism for limiting the growth of the BDD.
   static constexpr int64_t kDefaultPathLimit = 16 * 1024;
 
+  // The default limit on the number of nodes in the BDD. Operations which
+  // would exceed the limit produce new BDD variables like those exceeding the
+  // path limit. After such an operation the nodes of intermediate expressions
+  // are garbage collected.
+  static constexpr int64_t kDefaultNodeLimit = 1 << 20;
+
   // Construct a BDD representing the given function/proc.
   // `node_filter` is an optional function which filters the nodes to be
   // evaluated. If this function returns false for a node then the node will not
@@ -55,10 +61,12 @@ class BddFunction {
   // for which no information is known. If `node_filter` returns true, the node
   // still might *not* be evaluated because some kinds of nodes are never
   // evaluated for various reasons including computation expense.
+  // `node_limit` bounds the number of nodes in the BDD (zero means no limit).
   static absl::StatusOr<std::unique_ptr<BddFunction>> Run(
       FunctionBase* f, int64_t path_limit = 0,
       std::optional<std::function<bool(const Node*)>> node_filter =
-          std::nullopt);
+          std::nullopt,
+      int64_t node_limit = kDefaultNodeLimit);
 
   // Returns the underlying BDD.
   const BinaryDecisionDiagram& bdd() const { return bdd_; }
@@ -77,6 +85,10 @@ class BddFunction {
   // FunctionBase used to build the BddFunction must be a function not a proc.
   absl::StatusOr<Value> Evaluate(absl::Span<const Value> args) const;
 
+  // Frees the BDD nodes which are not part of the expression of any XLS node.
+  // BDD nodes created by the user of the BDD are freed as well.
+  void GarbageCollect();
+
  private:
   explicit BddFunction(FunctionBase* f) : func_base_(f) {}
 
@@ -112,6 +112,39 @@ TEST_F(BddFunctionTest, Parity) {
   }
 }
 
+TEST_F(BddFunctionTest, NodeLimit) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  BValue parity = fb.Literal(UBits(0, 1));
+  for (int64_t i = 0; i < 16; ++i) {
+    parity = fb.Xor(parity, fb.And(fb.BitSlice(x, i, 1), fb.BitSlice(y, i, 1)));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // Hitting the node limit loses precision but the BDD remains correct.
+  const int64_t kNumSamples = 100;
+  std::minstd_rand engine;
+  for (int64_t node_limit : {0, 40, 100, 1000}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<BddFunction> bdd_function,
+        BddFunction::Run(f, /*path_limit=*/0, /*node_filter=*/std::nullopt,
+                         node_limit));
+    if (node_limit > 0) {
+      EXPECT_LE(bdd_function->bdd().size(),
+                node_limit + bdd_function->bdd().variable_count());
+    }
+    for (int64_t i = 0; i < kNumSamples; ++i) {
+      std::vector<Value> inputs = RandomFunctionArguments(f, &engine);
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Value expected, DropInterpreterEvents(InterpretFunction(f, inputs)));
+      XLS_ASSERT_OK_AND_ASSIGN(Value actual, bdd_function->Evaluate(inputs));
+      EXPECT_EQ(expected, actual);
+    }
+  }
+}
+
 TEST_F(BddFunctionTest, BenchmarkTest) {
   // Run samples through various bechmarks and verify against the interpreter.
   //
@@ -28,7 +28,8 @@ namespace xls {
 
 absl::StatusOr<ReachedFixpoint> BddQueryEngine::Populate(FunctionBase* f) {
   XLS_ASSIGN_OR_RETURN(bdd_function_,
-                       BddFunction::Run(f, path_limit_, node_filter_));
+                       BddFunction::Run(f, path_limit_, node_filter_,
+                                        node_limit_));
   // Construct the Bits objects indication which bit values are statically known
   // for each node and what those values are (0 or 1) if known.
   BinaryDecisionDiagram& bdd = this->bdd();
@@ -69,8 +70,19 @@ absl::StatusOr<ReachedFixpoint> BddQueryEngine::Populate(FunctionBase* f) {
   return rf;
 }
 
+void BddQueryEngine::MaybeGarbageCollect() const {
+  // Queries which hit the node limit conservatively fail (the BDD returns new
+  // variables about which nothing is known) so the limit only needs to be
+  // reset between queries.
+  if (bdd().node_limit_exceeded()) {
+    bdd().ClearNodeLimitExceeded();
+    bdd_function_->GarbageCollect();
+  }
+}
+
 bool BddQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
+  MaybeGarbageCollect();
   // Computing this property is quadratic (at least) so limit the width.
   const int64_t kMaxWidth = 64;
   if (bits.size() > kMaxWidth) {
@@ -102,6 +114,7 @@ bool BddQueryEngine::AtMostOneTrue(
 
 bool BddQueryEngine::AtLeastOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
+  MaybeGarbageCollect();
   BddNodeIndex result = bdd().zero();
   // At least one bit is true is equivalent to an OR-reduction of all the bits.
   for (const TreeBitLocation& location : bits) {
@@ -128,6 +141,7 @@ bool BddQueryEngine::Implies(const TreeBitLocation& a,
   if (!IsTracked(a.node()) || !IsTracked(b.node())) {
     return false;
   }
+  MaybeGarbageCollect();
   return Implies(GetBddNode(a), GetBddNode(b));
 }
 
@@ -137,6 +151,7 @@ std::optional<Bits> BddQueryEngine::ImpliedNodeValue(
   if (!IsTracked(node) || !node->GetType()->IsBits()) {
     return std::nullopt;
   }
+  MaybeGarbageCollect();
 
   // Create a Bdd node for the predicate_bit_values.
   BddNodeIndex bdd_predicate_bit = bdd().one();
@@ -40,11 +40,16 @@ class BddQueryEngine : public QueryEngine {
   // terminals 0 and 1 to allow for a BDD expression before truncating it.
   // `node_filter` is an optional function which can be used to limit the nodes
   // which the BDD evaluates (returning false means the node will node be
-  // evaluated). See BddFunction for details.
-  explicit BddQueryEngine(int64_t path_limit = 0,
-                          std::optional<std::function<bool(const Node*)>>
-                              node_filter = std::nullopt)
-      : path_limit_(path_limit), node_filter_(node_filter) {}
+  // evaluated). `node_limit` is the maximum number of nodes in the BDD. See
+  // BddFunction for details.
+  explicit BddQueryEngine(
+      int64_t path_limit = 0,
+      std::optional<std::function<bool(const Node*)>> node_filter =
+          std::nullopt,
+      int64_t node_limit = BddFunction::kDefaultNodeLimit)
+      : path_limit_(path_limit),
+        node_filter_(node_filter),
+        node_limit_(node_limit) {}
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
@@ -83,6 +88,11 @@ class BddQueryEngine : public QueryEngine {
   // TODO(meheff): Enable queries on a BDD with out mutating the BDD itself.
   BinaryDecisionDiagram& bdd() const { return bdd_function_->bdd(); }
 
+  // Frees the BDD nodes created by earlier queries if a query hit the node
+  // limit. Must only be called on entry to a query as it invalidates the BDD
+  // nodes of the expressions computed by queries.
+  void MaybeGarbageCollect() const;
+
   // Returns the BDD node associated with the given bit.
   BddNodeIndex GetBddNode(const TreeBitLocation& location) const {
     XLS_CHECK(location.tree_index().empty());
@@ -107,6 +117,9 @@ class BddQueryEngine : public QueryEngine {
 
   std::optional<std::function<bool(const Node*)>> node_filter_;
 
+  // The maximum number of nodes in the BDD.
+  int64_t node_limit_;
+
   // Indicates the bits at the output of each node which have known values.
   absl::flat_hash_map<Node*, Bits> known_bits_;
 
@@ -32,6 +32,8 @@ class BddSimplificationPass : public FunctionBasePass {
         opt_level_(opt_level) {}
   ~BddSimplificationPass() override = default;
 
+  bool IsExpensive() const override { return true; }
+
  protected:
   // Run all registered passes in order of registration.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
@@ -30,6 +30,8 @@ class BitSliceSimplificationPass : public FunctionBasePass {
         opt_level_(opt_level) {}
   ~BitSliceSimplificationPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   int64_t opt_level_;
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
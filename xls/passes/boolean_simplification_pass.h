@@ -69,6 +69,8 @@ class BooleanSimplificationPass : public FunctionBasePass {
   BooleanSimplificationPass()
       : FunctionBasePass("bool_simp", "boolean simplification") {}
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
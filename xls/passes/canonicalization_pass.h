@@ -34,6 +34,8 @@ class CanonicalizationPass : public FunctionBasePass {
       : FunctionBasePass("canon", "Canonicalization") {}
   ~CanonicalizationPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
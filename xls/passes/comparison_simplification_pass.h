@@ -33,6 +33,8 @@ class ComparisonSimplificationPass : public FunctionBasePass {
       : FunctionBasePass("comparison_simp", "Comparison Simplification") {}
   ~ComparisonSimplificationPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
@@ -16,6 +16,7 @@
 
 #include <sstream>
 
+#include "absl/container/btree_set.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "xls/ir/bits_ops.h"
@@ -32,6 +32,8 @@ class ConditionalSpecializationPass : public FunctionBasePass {
         use_bdd_(use_bdd) {}
   ~ConditionalSpecializationPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   bool use_bdd_;
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
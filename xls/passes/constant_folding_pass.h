@@ -28,6 +28,10 @@ class ConstantFoldingPass : public FunctionBasePass {
   ConstantFoldingPass() : FunctionBasePass("const_fold", "Constant folding") {}
   ~ConstantFoldingPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+  // Folding invokes and other calls interprets the called functions.
+  bool AccessesOnlyFunctionBase() const override { return false; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
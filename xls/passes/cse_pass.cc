@@ -16,11 +16,16 @@
 
 #include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/structural_hash_index.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 
@@ -49,13 +54,57 @@ absl::Span<Node* const> GetOperandsForCse(
   return *span_backing_store;
 }
 
+// Performs CSE using the structural hash index maintained by the function
+// base. Only the nodes changed since the last run need be considered: any
+// newly equal pair of nodes includes a changed node. Of each set of equal
+// nodes the oldest in the index is kept.
+absl::StatusOr<bool> RunCseWithIndex(
+    FunctionBase* f, StructuralHashIndex* index,
+    absl::flat_hash_map<Node*, Node*>* replacements) {
+  bool changed = false;
+  // Replacing a node changes its users which may make them equal to other
+  // nodes so iterate until no nodes are changed.
+  std::vector<Node*> worklist = index->TakeChangedNodes();
+  while (!worklist.empty()) {
+    for (Node* node : worklist) {
+      std::vector<Node*> equivalents = index->GetEquivalentNodes(node);
+      if (equivalents.size() < 2) {
+        continue;
+      }
+      Node* kept = equivalents.front();
+      for (Node* equivalent : absl::MakeSpan(equivalents).subspan(1)) {
+        // Skip nodes which are already dead, e.g., replaced earlier.
+        if (equivalent->users().empty() && !f->HasImplicitUse(equivalent)) {
+          continue;
+        }
+        XLS_VLOG(3) << absl::StreamFormat(
+            "Replacing %s with equivalent node %s", equivalent->GetName(),
+            kept->GetName());
+        XLS_RETURN_IF_ERROR(equivalent->ReplaceUsesWith(kept));
+        if (replacements != nullptr) {
+          (*replacements)[equivalent] = kept;
+        }
+        changed = true;
+      }
+    }
+    worklist = index->TakeChangedNodes();
+  }
+  return changed;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> RunCse(FunctionBase* f,
                             absl::flat_hash_map<Node*, Node*>* replacements) {
+  if (StructuralHashIndex* index = f->structural_hash_index();
+      index != nullptr) {
+    return RunCseWithIndex(f, index, replacements);
+  }
+
   // To improve efficiency, bucket potentially common nodes together. The
   // bucketing is done via an int64_t hash value which is constructed from the
-  // op() of the node and the uid's of the node's operands.
+  // op() of the node, the uid's of the node's operands and the values of
+  // literals.
   auto hasher = absl::Hash<std::vector<int64_t>>();
   auto node_hash = [&](Node* n) {
     std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
@@ -63,8 +112,13 @@ absl::StatusOr<bool> RunCse(FunctionBase* f,
     for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
       values_to_hash.push_back(operand->id());
     }
-    // If this is slow because of many literals, the Literal values could be
-    // combined into the hash. As is, all literals get the same hash value.
+    // Literal values are combined into the hash so literals are not all
+    // placed in the same bucket. Hashing is cheap as aggregate values cache
+    // their hash.
+    if (n->Is<Literal>()) {
+      values_to_hash.push_back(
+          static_cast<int64_t>(absl::Hash<Value>()(n->As<Literal>()->value())));
+    }
     return hasher(values_to_hash);
   };
 
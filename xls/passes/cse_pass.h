@@ -51,12 +51,16 @@ absl::flat_hash_map<T, T> FixedPointOfSPO(
 
 // Pass which performs common subexpression elimination. Equivalent ops with the
 // same operands are commoned. The pass can find arbitrarily large common
-// expressions.
+// expressions. If structural hashing is enabled on the function base (see
+// FunctionBase::SetStructuralHashingEnabled) the pass only considers the nodes
+// changed since it last ran.
 class CsePass : public FunctionBasePass {
  public:
   CsePass() : FunctionBasePass("cse", "Common subexpression elimination") {}
   ~CsePass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
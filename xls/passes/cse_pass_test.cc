@@ -23,6 +23,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/passes/dce_pass.h"
 
@@ -226,5 +227,66 @@ TEST_F(CsePassTest, NonCommutativeOperands) {
   EXPECT_NE(f->return_value()->operand(0), f->return_value()->operand(1));
 }
 
+TEST_F(CsePassTest, StructuralHashing) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn nontrivial(x: bits[8], y: bits[8], z: bits[8]) -> bits[8] {
+        and.1: bits[8] = and(x, y)
+        neg.2: bits[8] = neg(and.1)
+        or.3: bits[8] = or(neg.2, z)
+
+        and.4: bits[8] = and(y, x)
+        neg.5: bits[8] = neg(and.4)
+        or.6: bits[8] = or(z, neg.5)
+
+        ret add.7: bits[8] = add(or.3, or.6)
+     }
+  )",
+                                                       p.get()));
+  f->SetStructuralHashingEnabled(true);
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(f->node_count(), 7);
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+
+  // Only the nodes changed since the previous run are considered but
+  // equivalences they introduce are found.
+  Node* or_node = f->return_value()->operand(0);
+  Node* x = FindNode("x", f);
+  Node* y = FindNode("y", f);
+  Node* z = FindNode("z", f);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_and,
+      f->MakeNode<NaryOp>(SourceInfo(), std::vector<Node*>{y, x}, Op::kAnd));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_neg, f->MakeNode<UnOp>(SourceInfo(), new_and, Op::kNeg));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_or, f->MakeNode<NaryOp>(SourceInfo(),
+                                         std::vector<Node*>{new_neg, z},
+                                         Op::kOr));
+  XLS_ASSERT_OK(f->return_value()->ReplaceOperandNumber(1, new_or));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(f->node_count(), 7);
+  EXPECT_EQ(f->return_value()->operand(0), or_node);
+  EXPECT_EQ(f->return_value()->operand(1), or_node);
+}
+
+TEST_F(CsePassTest, HashConsingBuilder) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.function()->SetStructuralHashingEnabled(true);
+  Type* u32 = p->GetBitsType(32);
+  BValue x = fb.Param("x", u32);
+  BValue y = fb.Param("y", u32);
+  BValue and_xy = fb.And(x, y);
+  BValue and_yx = fb.And(y, x);
+  BValue named_and = fb.And(x, y, SourceInfo(), "named");
+  EXPECT_EQ(and_xy.node(), and_yx.node());
+  EXPECT_NE(and_xy.node(), named_and.node());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Add(and_yx, named_and)));
+  EXPECT_EQ(f->node_count(), 5);
+}
+
 }  // namespace
 }  // namespace xls
@@ -32,6 +32,8 @@ class DeadCodeEliminationPass : public FunctionBasePass {
       : FunctionBasePass("dce", "Dead Code Elimination") {}
   ~DeadCodeEliminationPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   // Iterate all nodes, mark and eliminate the unvisited nodes.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
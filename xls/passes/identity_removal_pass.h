@@ -32,6 +32,8 @@ class IdentityRemovalPass : public FunctionBasePass {
       : FunctionBasePass("ident_remove", "Identity Removal") {}
   ~IdentityRemovalPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   // Iterate all nodes and eliminate identities.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
@@ -14,9 +14,18 @@
 
 #include "xls/passes/inlining_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/call_graph.h"
 #include "xls/ir/node_iterator.h"
@@ -24,42 +33,84 @@
 namespace xls {
 namespace {
 
-// Return the name that 'node' should have when it is inlined at the callsite
-// given by 'invoke'. The node must be in the function called by 'invoke'. The
-// name is generated by first determining if the name of 'node' is likely
-// derived from the parameter name of its function. If so, a new name is
-// generated using the respective operand name of 'invoke' substituted for the
-// parameter name. If no meaningful name could be determined then nullopt is
-// returned.
-std::optional<std::string> GetInlinedNodeName(Node* node, Invoke* invoke) {
-  if (!node->HasAssignedName()) {
-    return std::nullopt;
-  }
+// A function prepared for inlining at each of its callsites. The function is
+// analyzed once and then instantiated at every callsite, so the topological
+// sort and the matching of node names against parameter names are not repeated
+// per callsite.
+struct InlineTemplate {
+  struct Entry {
+    Node* node;
+    // If `node` is a parameter, its index; otherwise -1.
+    int64_t param_index = -1;
+    // Indices into `InlineTemplate::entries` of the operands of `node`.
+    std::vector<int64_t> operand_indices;
+    // The parameters whose name is a prefix of the name of `node`, longest
+    // name first, each with the remainder of the name of `node`.
+    std::vector<std::pair<int64_t, std::string>> name_params;
+  };
 
-  // Find the parameter in the invoked function whose name is a prefix of the
-  // name of 'node'. If such a parameter exists we assume the name of 'node' is
-  // derived from the name of this param. If there are multiple matches, then
-  // choose the param with the longest name (e.g., if the node's name is
-  // 'foo_bar_42' and there are parameters named 'foo' and 'foo_bar' we assume
-  // 'foo_bar_42' is derived from 'foo_bar').
-  Param* matching_param = nullptr;
-  std::string derived_name;
-  for (int64_t i = 0; i < invoke->operand_count(); ++i) {
-    Param* param = invoke->to_apply()->param(i);
-    Node* operand = invoke->operand(i);
-    if (operand->HasAssignedName() &&
-        absl::StartsWith(node->GetName(), param->GetName()) &&
-        (matching_param == nullptr ||
-         matching_param->GetName().size() < param->GetName().size())) {
-      matching_param = param;
-      std::string suffix = node->GetName().substr(param->GetName().size());
-      derived_name = absl::StrCat(operand->GetName(), suffix);
+  // The nodes of the function in topological order.
+  std::vector<Entry> entries;
+  // Indices into `entries` of the nodes in the order of Function::nodes(), the
+  // order in which inlined nodes are renamed.
+  std::vector<int64_t> rename_order;
+  // Index into `entries` of the return value of the function.
+  int64_t return_index;
+};
+
+absl::StatusOr<InlineTemplate> CreateInlineTemplate(Function* f) {
+  InlineTemplate result;
+  absl::flat_hash_map<Node*, int64_t> node_index;
+  for (Node* node : TopoSort(f)) {
+    InlineTemplate::Entry entry{.node = node};
+    for (Node* operand : node->operands()) {
+      entry.operand_indices.push_back(node_index.at(operand));
     }
+    if (node->Is<Param>()) {
+      XLS_ASSIGN_OR_RETURN(entry.param_index,
+                           f->GetParamIndex(node->As<Param>()));
+    } else if (node->HasAssignedName()) {
+      for (int64_t i = 0; i < f->params().size(); ++i) {
+        const std::string& param_name = f->param(i)->GetName();
+        if (absl::StartsWith(node->GetName(), param_name)) {
+          entry.name_params.push_back(
+              {i, node->GetName().substr(param_name.size())});
+        }
+      }
+      std::stable_sort(entry.name_params.begin(), entry.name_params.end(),
+                       [&](const auto& a, const auto& b) {
+                         return f->param(a.first)->GetName().size() >
+                                f->param(b.first)->GetName().size();
+                       });
+    }
+    node_index[node] = result.entries.size();
+    result.entries.push_back(std::move(entry));
+  }
+  for (Node* node : f->nodes()) {
+    result.rename_order.push_back(node_index.at(node));
   }
-  if (matching_param == nullptr) {
-    return std::nullopt;
+  result.return_index = node_index.at(f->return_value());
+  return result;
+}
+
+// Return the name that the node of 'entry' should have when it is inlined at
+// the callsite given by 'invoke'. The name is generated by first determining if
+// the name of the node is likely derived from the parameter name of its
+// function. If so, a new name is generated using the respective operand name of
+// 'invoke' substituted for the parameter name. If there are multiple matches,
+// then the param with the longest name is chosen (e.g., if the node's name is
+// 'foo_bar_42' and there are parameters named 'foo' and 'foo_bar' we assume
+// 'foo_bar_42' is derived from 'foo_bar'). If no meaningful name could be
+// determined then nullopt is returned.
+std::optional<std::string> GetInlinedNodeName(
+    const InlineTemplate::Entry& entry, Invoke* invoke) {
+  for (const auto& [param_index, suffix] : entry.name_params) {
+    Node* operand = invoke->operand(param_index);
+    if (operand->HasAssignedName()) {
+      return absl::StrCat(operand->GetName(), suffix);
+    }
   }
-  return derived_name;
+  return std::nullopt;
 }
 
 // Inlining can cause coverpoints to be duplicated, which will then conflict, as
@@ -74,34 +125,32 @@ std::string GetPrefixedLabel(Invoke* invoke, std::string_view label,
 }
 
 // Inlines the node "invoke" by replacing it with the contents of the called
-// function.
-absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
-  Function* invoked = invoke->to_apply();
-  absl::flat_hash_map<Node*, Node*> invoked_node_to_replacement;
-  for (int64_t i = 0; i < invoked->params().size(); ++i) {
-    Node* param = invoked->param(i);
-    invoked_node_to_replacement[param] = invoke->operand(i);
-  }
-
-  for (Node* node : TopoSort(invoked)) {
-    if (invoked_node_to_replacement.contains(node)) {
-      // Already taken care of (e.g. parameters above).
+// function, as given by `inline_template`.
+absl::Status InlineInvoke(Invoke* invoke, const InlineTemplate& inline_template,
+                          int inline_count) {
+  const std::vector<InlineTemplate::Entry>& entries = inline_template.entries;
+  std::vector<Node*> replacements(entries.size());
+  std::vector<Node*> new_operands;
+  for (int64_t i = 0; i < entries.size(); ++i) {
+    const InlineTemplate::Entry& entry = entries[i];
+    if (entry.param_index >= 0) {
+      replacements[i] = invoke->operand(entry.param_index);
       continue;
     }
-    XLS_RET_CHECK(!node->Is<Invoke>())
+    XLS_RET_CHECK(!entry.node->Is<Invoke>())
         << "No invokes should remain in function to inline: "
-        << node->GetName();
-    std::vector<Node*> new_operands;
-    for (Node* operand : node->operands()) {
-      new_operands.push_back(invoked_node_to_replacement.at(operand));
+        << entry.node->GetName();
+    new_operands.clear();
+    for (int64_t operand_index : entry.operand_indices) {
+      new_operands.push_back(replacements[operand_index]);
     }
     XLS_ASSIGN_OR_RETURN(
         Node * new_node,
-        node->CloneInNewFunction(new_operands, invoke->function_base()));
+        entry.node->CloneInNewFunction(new_operands, invoke->function_base()));
     if (new_node->loc().Empty()) {
       new_node->SetLoc(invoke->loc());
     }
-    invoked_node_to_replacement[node] = new_node;
+    replacements[i] = new_node;
   }
 
   // Update names for each of the newly inlined nodes. For example,
@@ -121,26 +170,28 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
   // 'foo_negated'. Coverpoint and assert names are also updated to include the
   // call stack to differentiate in case inlining would otherwise result in
   // multiple statements with the same labels.
-  for (Node* node : invoked->nodes()) {
-    if (node->Is<Param>()) {
+  for (int64_t i : inline_template.rename_order) {
+    const InlineTemplate::Entry& entry = entries[i];
+    Node* node = entry.node;
+    if (entry.param_index >= 0) {
       continue;
     }
-    if (node == invoked->return_value() && invoke->HasAssignedName()) {
+    if (i == inline_template.return_index && invoke->HasAssignedName()) {
       // Node is the return value of the function, it should get its name from
       // the invoke node itself. By clearing the name here ReplaceUseWith will
       // properly move the name from the invoke instruction to the node.
-      invoked_node_to_replacement.at(node)->ClearName();
+      replacements[i]->ClearName();
       continue;
     }
-    std::optional<std::string> new_name = GetInlinedNodeName(node, invoke);
+    std::optional<std::string> new_name = GetInlinedNodeName(entry, invoke);
     if (new_name.has_value()) {
-      invoked_node_to_replacement.at(node)->SetName(new_name.value());
+      replacements[i]->SetName(new_name.value());
     }
 
     if (node->Is<Cover>()) {
       std::string new_label =
           GetPrefixedLabel(invoke, node->As<Cover>()->label(), inline_count);
-      Cover* cover = invoked_node_to_replacement.at(node)->As<Cover>();
+      Cover* cover = replacements[i]->As<Cover>();
       Node* token = cover->token();
       Node* condition = cover->condition();
       XLS_ASSIGN_OR_RETURN(
@@ -149,11 +200,11 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
               cover->loc(), token, condition, new_label, cover->GetName()));
       XLS_RETURN_IF_ERROR(cover->ReplaceUsesWith(new_cover));
       XLS_RETURN_IF_ERROR(cover->function_base()->RemoveNode(cover));
-      invoked_node_to_replacement.at(node) = new_cover;
+      replacements[i] = new_cover;
     } else if (node->Is<Assert>() && node->As<Assert>()->label().has_value()) {
       std::string new_label = GetPrefixedLabel(
           invoke, node->As<Assert>()->label().value(), inline_count);
-      Assert* asrt = invoked_node_to_replacement.at(node)->As<Assert>();
+      Assert* asrt = replacements[i]->As<Assert>();
       Node* token = asrt->token();
       Node* condition = asrt->condition();
       XLS_ASSIGN_OR_RETURN(auto new_assert,
@@ -162,12 +213,12 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
                                new_label, asrt->GetName()));
       XLS_RETURN_IF_ERROR(asrt->ReplaceUsesWith(new_assert));
       XLS_RETURN_IF_ERROR(asrt->function_base()->RemoveNode(asrt));
-      invoked_node_to_replacement.at(node) = new_assert;
+      replacements[i] = new_assert;
     }
   }
 
-  XLS_RETURN_IF_ERROR(invoke->ReplaceUsesWith(
-      invoked_node_to_replacement.at(invoked->return_value())));
+  XLS_RETURN_IF_ERROR(
+      invoke->ReplaceUsesWith(replacements[inline_template.return_index]));
   return invoke->function_base()->RemoveNode(invoke);
 }
 
@@ -181,14 +232,27 @@ absl::StatusOr<bool> InliningPass::RunInternal(Package* p,
   // post order of the call graph (leaves first). This ensures that when a
   // function Foo is inlined into its callsites, no invokes remain in Foo. This
   // avoid duplicate work.
+  //
+  // Each invoked function is analyzed once into an InlineTemplate which is then
+  // instantiated at all of its callsites.
   int inline_count = 0;
+  absl::flat_hash_map<Function*, InlineTemplate> inline_templates;
   for (FunctionBase* f : FunctionsInPostOrder(p)) {
     // Create copy of nodes() because we will be adding and removing nodes
     // during inlining.
     std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
     for (Node* node : nodes) {
       if (node->Is<Invoke>()) {
-        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
+        Invoke* invoke = node->As<Invoke>();
+        auto it = inline_templates.find(invoke->to_apply());
+        if (it == inline_templates.end()) {
+          XLS_ASSIGN_OR_RETURN(InlineTemplate inline_template,
+                               CreateInlineTemplate(invoke->to_apply()));
+          it = inline_templates
+                   .insert({invoke->to_apply(), std::move(inline_template)})
+                   .first;
+        }
+        XLS_RETURN_IF_ERROR(InlineInvoke(invoke, it->second, inline_count++));
         changed = true;
       }
     }
@@ -141,6 +141,31 @@ fn operands_not_named() -> bits[32] {
   }
 }
 
+TEST_F(InliningPassTest, NamePropagationPrefersLongestNamedParam) {
+  const std::string program = R"(
+package some_package
+
+fn callee(a: bits[32], a_b: bits[32]) -> bits[32] {
+  a_b_sum: bits[32] = add(a, a_b)
+  ret result: bits[32] = not(a_b_sum)
+}
+
+fn f(foo: bits[32], bar: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=1)
+  invoke.2: bits[32] = invoke(foo, bar, to_apply=callee)
+  invoke.3: bits[32] = invoke(foo, literal.1, to_apply=callee)
+  ret add.4: bits[32] = add(invoke.2, invoke.3)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(program));
+  ASSERT_THAT(Inline(package.get()), IsOkAndHolds(true));
+  Node* ret = FindFunction("f", package.get())->return_value();
+  // The name of `a_b_sum` is derived from the operand for `a_b` when that
+  // operand is named, and otherwise from the operand for `a`.
+  EXPECT_THAT(ret, m::Add(m::Not(m::Name("bar_sum")),
+                          m::Not(m::Name("foo_b_sum"))));
+}
+
 TEST_F(InliningPassTest, NamePropagationWithPassThroughParam) {
   const std::string program = R"(
 package some_package
@@ -14,7 +14,15 @@
 
 #include "xls/passes/narrowing_pass.h"
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
@@ -907,43 +915,26 @@ static absl::StatusOr<bool> MaybeReplacePreciseWithLiteral(
   return true;
 }
 
-static absl::StatusOr<std::unique_ptr<QueryEngine>> GetQueryEngine(
-    FunctionBase* f, bool use_range_analysis) {
-  std::unique_ptr<QueryEngine> query_engine;
-  if (use_range_analysis) {
-    auto ternary_query_engine = std::make_unique<TernaryQueryEngine>();
-    auto range_query_engine = std::make_unique<RangeQueryEngine>();
-
-    if (XLS_VLOG_IS_ON(3)) {
-      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
-    }
-
-    std::vector<std::unique_ptr<QueryEngine>> engines;
-    engines.push_back(std::move(ternary_query_engine));
-    engines.push_back(std::move(range_query_engine));
-    query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
-  } else {
-    query_engine = std::make_unique<TernaryQueryEngine>();
-  }
-  XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
-  return std::move(query_engine);
-}
-
-absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
-    FunctionBase* f, const PassOptions& options, PassResults* results) const {
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<QueryEngine> query_engine,
-                       GetQueryEngine(f, use_range_analysis_));
+// The maximum number of sweeps over the nodes in a single run of the pass.
+// Further narrowing is left to later runs.
+static constexpr int64_t kMaxSweeps = 8;
 
+// Narrows those of the given nodes, which must be in topological order, that
+// `query_engine` shows can be narrowed. Returns true if anything was changed.
+static absl::StatusOr<bool> NarrowNodes(absl::Span<Node* const> nodes,
+                                        const PassOptions& options,
+                                        bool use_range_analysis,
+                                        const QueryEngine& query_engine) {
   bool modified = false;
 
-  for (Node* node : TopoSort(f)) {
+  for (Node* node : nodes) {
     if (OpIsSideEffecting(node->op())) {
       continue;
     }
     bool node_modified = false;
     if (!node->Is<Literal>() && !node->Is<Param>()) {
       XLS_ASSIGN_OR_RETURN(node_modified,
-                           MaybeReplacePreciseWithLiteral(node, *query_engine));
+                           MaybeReplacePreciseWithLiteral(node, query_engine));
       if (node_modified) {
         modified = true;
         continue;
@@ -954,28 +945,28 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
       case Op::kShrl:
       case Op::kShra: {
         XLS_ASSIGN_OR_RETURN(node_modified,
-                             MaybeNarrowShiftAmount(node, *query_engine));
+                             MaybeNarrowShiftAmount(node, query_engine));
         break;
       }
       case Op::kArrayIndex: {
         XLS_ASSIGN_OR_RETURN(
             node_modified,
-            MaybeNarrowArrayIndex(use_range_analysis_, options,
-                                  node->As<ArrayIndex>(), *query_engine));
+            MaybeNarrowArrayIndex(use_range_analysis, options,
+                                  node->As<ArrayIndex>(), query_engine));
         break;
       }
       case Op::kSMul:
       case Op::kUMul: {
         XLS_ASSIGN_OR_RETURN(
             node_modified,
-            MaybeNarrowMultiply(node->As<ArithOp>(), *query_engine));
+            MaybeNarrowMultiply(node->As<ArithOp>(), query_engine));
         break;
       }
       case Op::kSMulp:
       case Op::kUMulp: {
         XLS_ASSIGN_OR_RETURN(node_modified,
                              MaybeNarrowPartialMultiply(
-                                 node->As<PartialProductOp>(), *query_engine));
+                                 node->As<PartialProductOp>(), query_engine));
         break;
       }
       case Op::kULe:
@@ -990,12 +981,12 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
       case Op::kNe: {
         XLS_ASSIGN_OR_RETURN(
             node_modified,
-            MaybeNarrowCompare(node->As<CompareOp>(), *query_engine));
+            MaybeNarrowCompare(node->As<CompareOp>(), query_engine));
         break;
       }
       case Op::kAdd: {
         XLS_ASSIGN_OR_RETURN(node_modified,
-                             MaybeNarrowAdd(node, *query_engine));
+                             MaybeNarrowAdd(node, query_engine));
         break;
       }
       default:
@@ -1006,4 +997,88 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
   return modified;
 }
 
+absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const PassOptions& options, PassResults* results) const {
+  // Range analysis is considerably more expensive than ternary analysis so fall
+  // back to the latter when the time budget runs low.
+  bool use_range_analysis =
+      use_range_analysis_ &&
+      GetTimeBudgetState(*results) == TimeBudgetState::kAmple;
+
+  // The query engines are shared with the rest of the pipeline so they are
+  // only populated if `f` changed since they were last computed.
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<TernaryQueryEngine> ternary_query_engine,
+      results->analyses.GetQueryEngine<TernaryQueryEngine>(f));
+  std::shared_ptr<RangeQueryEngine> range_query_engine;
+  std::vector<QueryEngine*> engines = {ternary_query_engine.get()};
+  if (use_range_analysis) {
+    XLS_ASSIGN_OR_RETURN(
+        range_query_engine,
+        results->analyses.GetQueryEngine<RangeQueryEngine>(f));
+    engines.push_back(range_query_engine.get());
+    if (XLS_VLOG_IS_ON(3)) {
+      RangeAnalysisLog(f, *ternary_query_engine, *range_query_engine);
+    }
+  }
+  UnionQueryEngine query_engine(std::move(engines));
+
+  // Narrowing a node replaces it, which may enable narrowing its users (e.g.,
+  // along chains of adds and compares). Rather than leaving those to later
+  // runs of the pass, the engines are updated incrementally with the nodes
+  // changed by each sweep and the live nodes whose operands were replaced are
+  // revisited. Change tracking may already be enabled for incremental
+  // verification, in which case the changed nodes must not be cleared; later
+  // sweeps then also see the nodes changed by earlier ones, which is merely
+  // slower.
+  const bool change_tracking_was_enabled = f->IsChangeTrackingEnabled();
+  if (!change_tracking_was_enabled) {
+    f->SetChangeTrackingEnabled(true);
+  }
+  absl::Cleanup restore_change_tracking = [&] {
+    if (!change_tracking_was_enabled) {
+      f->SetChangeTrackingEnabled(false);
+    }
+  };
+  bool modified = false;
+  int64_t sweep_count = 0;
+  std::vector<Node*> nodes = TopoSort(f).AsVector();
+  while (!nodes.empty() && sweep_count < kMaxSweeps) {
+    ++sweep_count;
+    absl::flat_hash_set<Node*> swept_nodes(nodes.begin(), nodes.end());
+    XLS_ASSIGN_OR_RETURN(
+        bool sweep_modified,
+        NarrowNodes(nodes, options, use_range_analysis, query_engine));
+    if (!sweep_modified) {
+      break;
+    }
+    modified = true;
+    std::vector<Node*> changed(f->changed_nodes().begin(),
+                               f->changed_nodes().end());
+    XLS_RETURN_IF_ERROR(query_engine.Update(changed).status());
+
+    // Nodes created by the sweep are already narrowed and replaced nodes are
+    // dead, so only the users of replaced nodes are worth revisiting.
+    nodes.clear();
+    for (Node* node : TopoSort(f)) {
+      if (f->changed_nodes().contains(node) && swept_nodes.contains(node) &&
+          (!node->users().empty() || f->HasImplicitUse(node))) {
+        nodes.push_back(node);
+      }
+    }
+    if (!change_tracking_was_enabled) {
+      f->ClearChangedNodes();
+    }
+  }
+  XLS_VLOG(3) << absl::StreamFormat("Narrowing %s took %d sweeps", f->name(),
+                                    sweep_count);
+
+  // The engines now reflect the narrowed function.
+  results->analyses.MarkPreserved<TernaryQueryEngine>(f);
+  if (use_range_analysis) {
+    results->analyses.MarkPreserved<RangeQueryEngine>(f);
+  }
+  return modified;
+}
+
 }  // namespace xls
@@ -32,6 +32,8 @@ class NarrowingPass : public FunctionBasePass {
         opt_level_(opt_level) {}
   ~NarrowingPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   bool use_range_analysis_;
   int64_t opt_level_;
@@ -14,6 +14,9 @@
 
 #include "xls/passes/narrowing_pass.h"
 
+#include <cstdint>
+#include <memory>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
@@ -22,6 +25,7 @@
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/ternary_query_engine.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -528,6 +532,42 @@ TEST_P(NarrowingPassTest, ConvertArrayIndexToSelect) {
   }
 }
 
+TEST_P(NarrowingPassTest, CompareOfNarrowedAdd) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue sum = fb.Add(fb.ZeroExtend(fb.Param("lhs", p->GetBitsType(10)), 42),
+                      fb.ZeroExtend(fb.Param("rhs", p->GetBitsType(30)), 42));
+  fb.UGt(sum, fb.ZeroExtend(fb.Param("c", p->GetBitsType(20)), 42));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  // The compare is narrowed in the same run as the add feeding it.
+  EXPECT_THAT(
+      f->return_value(),
+      m::UGt(m::BitSlice(m::ZeroExt(m::Add()), /*start=*/0, /*width=*/31),
+             m::BitSlice(m::ZeroExt(m::Param("c")), /*start=*/0,
+                         /*width=*/31)));
+}
+
+TEST_P(NarrowingPassTest, QueryEnginesPreservedAfterNarrowing) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Add(fb.ZeroExtend(fb.Param("lhs", p->GetBitsType(10)), 42),
+         fb.ZeroExtend(fb.Param("rhs", p->GetBitsType(30)), 42));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  PassResults results;
+  ASSERT_THAT(NarrowingPass(/*use_range_analysis=*/GetParam())
+                  .Run(p.get(), PassOptions(), &results),
+              IsOkAndHolds(true));
+  // The cached engine was updated along with the function rather than
+  // invalidated.
+  int64_t miss_count = results.analyses.miss_count();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<TernaryQueryEngine> query_engine,
+      results.analyses.GetQueryEngine<TernaryQueryEngine>(f));
+  EXPECT_EQ(results.analyses.miss_count(), miss_count);
+  EXPECT_TRUE(query_engine->IsTracked(f->return_value()));
+}
+
 TEST_P(NarrowingPassTest, SideEffectfulButNarrowable) {
   auto p = CreatePackage();
   Block* to_instantiate = nullptr;
@@ -0,0 +1,115 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of IR transformations dominated by maintenance of the user sets
+// of nodes (Node::users), e.g. ReplaceUsesWith on nodes with high fanout.
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "xls/common/logging/logging.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/passes/constant_folding_pass.h"
+#include "xls/passes/cse_pass.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/passes.h"
+
+namespace xls {
+namespace {
+
+// Returns a function in which each of two parameters has `fanout` users, each
+// a not of the parameter, which are combined with an and-reduction tree.
+Function* BuildFanoutFunction(Package* package, int64_t fanout) {
+  FunctionBuilder fb("fanout", package);
+  BValue x = fb.Param("x", package->GetBitsType(32));
+  BValue y = fb.Param("y", package->GetBitsType(32));
+  std::vector<BValue> values;
+  for (int64_t i = 0; i < fanout; ++i) {
+    values.push_back(fb.Not(x));
+    values.push_back(fb.Not(y));
+  }
+  return fb.BuildWithReturnValue(fb.And(values)).value();
+}
+
+// Measures moving the `fanout` users of one node to another and back.
+void BM_ReplaceUsesWith(benchmark::State& state) {
+  Package package("benchmark");
+  Function* f = BuildFanoutFunction(&package, state.range(0));
+  Node* x = f->param(0);
+  Node* y = f->param(1);
+  for (auto _ : state) {
+    XLS_CHECK_OK(x->ReplaceUsesWith(y));
+    // Move back only the users which were originally users of `x` so each
+    // iteration does equivalent work.
+    std::vector<Node*> users(y->users().begin(), y->users().end());
+    for (int64_t i = 0; i < users.size(); i += 2) {
+      XLS_CHECK(users[i]->ReplaceOperand(y, x));
+    }
+  }
+}
+
+// Measures CSE followed by DCE of a function with `fanout` identical users of
+// each of two parameters. CSE replaces all but one of each set of identical
+// nodes so the users of the surviving nodes are repeatedly extended.
+void BM_CseHighFanout(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    Package package("benchmark");
+    Function* f = BuildFanoutFunction(&package, state.range(0));
+    XLS_CHECK_OK(package.SetTop(f));
+    state.ResumeTiming();
+    PassResults results;
+    XLS_CHECK_OK(CsePass().Run(&package, PassOptions(), &results).status());
+    XLS_CHECK_OK(DeadCodeEliminationPass()
+                     .Run(&package, PassOptions(), &results)
+                     .status());
+  }
+}
+
+// Measures constant folding of a chain of literal arithmetic in which
+// every folded node is replaced with a literal.
+void BM_ConstantFoldChain(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    Package package("benchmark");
+    FunctionBuilder fb("chain", &package);
+    BValue x = fb.Param("x", package.GetBitsType(32));
+    BValue one = fb.Literal(UBits(1, 32));
+    BValue value = one;
+    std::vector<BValue> values;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      value = fb.Add(value, one);
+      values.push_back(fb.Add(x, value));
+    }
+    Function* f = fb.BuildWithReturnValue(fb.Concat(values)).value();
+    XLS_CHECK_OK(package.SetTop(f));
+    state.ResumeTiming();
+    PassResults results;
+    XLS_CHECK_OK(
+        ConstantFoldingPass().Run(&package, PassOptions(), &results).status());
+  }
+}
+
+BENCHMARK(BM_ReplaceUsesWith)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK(BM_CseHighFanout)->RangeMultiplier(4)->Range(4, 4096);
+BENCHMARK(BM_ConstantFoldChain)->RangeMultiplier(4)->Range(4, 4096);
+
+}  // namespace
+}  // namespace xls
+
+BENCHMARK_MAIN();
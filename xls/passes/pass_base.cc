@@ -14,16 +14,48 @@
 
 #include "xls/passes/pass_base.h"
 
+#include <sys/resource.h>
+
 #include <cstdint>
 #include <string>
 #include <utility>
 
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 
 namespace xls {
 
+int64_t GetPeakRssBytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  // Reported in bytes on macOS.
+  return usage.ru_maxrss;
+#else
+  // Reported in kilobytes on Linux.
+  return int64_t{usage.ru_maxrss} * 1024;
+#endif
+}
+
+TimeBudgetState GetTimeBudgetState(const PassResults& results) {
+  if (!results.budget_deadline.has_value()) {
+    return TimeBudgetState::kAmple;
+  }
+  absl::Time now = absl::Now();
+  if (now >= *results.budget_deadline) {
+    return TimeBudgetState::kExhausted;
+  }
+  absl::Duration budget = *results.budget_deadline - *results.budget_start;
+  if (*results.budget_deadline - now < budget / 4) {
+    return TimeBudgetState::kLow;
+  }
+  return TimeBudgetState::kAmple;
+}
+
 std::string_view RamKindToString(RamKind kind) {
   switch (kind) {
     case RamKind::kAbstract:
@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_PASS_BASE_H_
 #define XLS_PASSES_PASS_BASE_H_
 
+#include <cstdint>
 #include <filesystem>
 #include <memory>
 #include <optional>
@@ -22,6 +23,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -33,6 +35,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
+#include "xls/passes/analysis_manager.h"
 
 namespace xls {
 
@@ -40,6 +43,8 @@ namespace xls {
 // pass pipelines. The base classes are templated allowing polymorphism of the
 // data types the pass operates on.
 
+class ProofService;
+
 // Metadata for RAMs.
 // TODO(google/xls#873): Ideally this metadata should live in the IR.
 //
@@ -134,6 +139,48 @@ struct PassOptions {
   // List of RAM rewrites, generally lowering abstract RAMs into concrete
   // variants.
   std::vector<RamRewrite> ram_rewrites;
+
+  // Whether the verifier invariant checker (VerifierChecker) should reverify
+  // only the nodes changed since its previous run rather than the entire
+  // package. See VerifyPackageIncrementally.
+  bool incremental_verification = false;
+
+  // Whether passes within fixed point compound passes should skip function
+  // bases which are unchanged since the pass last ran on them without
+  // changing them. Applies only to passes declaring that their effect on a
+  // function base depends only on that function base. See
+  // FunctionBasePass::DependsOnlyOnFunctionBase.
+  bool incremental_fixed_point = false;
+
+  // If set, function base passes which access only the function base they run
+  // on are run on up to this many function bases of the package at once on
+  // the shared thread pool. The node ids of the resulting IR do not depend on
+  // the number of threads. See FunctionBasePass::AccessesOnlyFunctionBase.
+  std::optional<int64_t> function_base_pass_threads;
+
+  // If set, the wall-clock time the pass pipeline should take. As the budget
+  // runs low, expensive passes (see PassBase::IsExpensive) are skipped and
+  // some passes fall back to cheaper analyses; once it is exhausted fixed
+  // point loops stop iterating. The remaining passes still run so the time
+  // budget is not a hard limit. See GetTimeBudgetState.
+  std::optional<absl::Duration> time_budget;
+
+  // If set, ProofSimplificationPass submits claims about the IR to this service
+  // to be proven with Z3 in the background. Not owned.
+  ProofService* proof_service = nullptr;
+};
+
+// A compound pass enclosing a pass invocation.
+struct PassNestingLevel {
+  // The short name of the compound pass.
+  std::string pass_name;
+
+  // Whether the compound pass runs its passes to fixed point.
+  bool fixed_point = false;
+
+  // The iteration (counting from zero) of the fixed point loop. Always zero if
+  // the compound pass is not a fixed point pass.
+  int64_t iteration = 0;
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -147,6 +194,28 @@ struct PassInvocation {
 
   // The run duration of the pass.
   absl::Duration run_duration;
+
+  // The number of nodes in the IR before and after the pass.
+  int64_t node_count_before = 0;
+  int64_t node_count_after = 0;
+
+  // The growth of the peak resident set size of the process during the pass in
+  // bytes. This is zero unless the pass raised the high-water mark.
+  int64_t peak_rss_delta_bytes = 0;
+
+  // The compound passes enclosing the invocation, outermost first.
+  std::vector<PassNestingLevel> nesting;
+};
+
+// The wall-clock time spent in a coarse phase of compilation around the pass
+// pipelines, e.g. scheduling or Verilog emission. See ScopedPhaseTimer.
+struct PhaseTiming {
+  std::string name;
+  absl::Duration duration;
+
+  // The growth of the peak resident set size of the process during the phase
+  // in bytes.
+  int64_t peak_rss_delta_bytes = 0;
 };
 
 // A object to which metadata may be written in each pass invocation. This data
@@ -154,14 +223,86 @@ struct PassInvocation {
 struct PassResults {
   // This vector contains and entry for each invocation of each pass.
   std::vector<PassInvocation> invocations;
+
+  // The compound passes currently running, outermost first. Maintained by
+  // CompoundPassBase.
+  std::vector<PassNestingLevel> nesting;
+
+  // For PassOptions::incremental_fixed_point, the version
+  // (FunctionBase::change_count) of each function base at the end of the most
+  // recent run of a pass on it which did not change it. Keyed by the pass and
+  // the uid of the function base.
+  absl::flat_hash_map<std::pair<const void*, int64_t>, int64_t>
+      unchanged_function_bases;
+
+  // Analyses of the function bases shared by the passes of the pipeline.
+  AnalysisManager analyses;
+
+  // For PassOptions::time_budget, the time the top-level compound pass started
+  // and the time by which the pipeline should finish.
+  std::optional<absl::Time> budget_start;
+  std::optional<absl::Time> budget_deadline;
+
+  // The passes skipped because of the time budget, in order. Fixed point
+  // loops cut short are recorded as "<name> (fixed point)".
+  std::vector<std::string> skipped_passes;
+
+  // Timings of the compilation phases run by the tool driving the pipelines,
+  // in the order they finished.
+  std::vector<PhaseTiming> phases;
+};
+
+// Returns the peak resident set size of the process in bytes.
+int64_t GetPeakRssBytes();
+
+// Records the time from construction to destruction as a PhaseTiming named
+// `name` in `results`. Does nothing if `results` is null.
+class ScopedPhaseTimer {
+ public:
+  ScopedPhaseTimer(PassResults* results, std::string name)
+      : results_(results),
+        name_(std::move(name)),
+        start_(absl::Now()),
+        start_peak_rss_bytes_(results == nullptr ? 0 : GetPeakRssBytes()) {}
+  ~ScopedPhaseTimer() {
+    if (results_ != nullptr) {
+      results_->phases.push_back(
+          PhaseTiming{.name = std::move(name_),
+                      .duration = absl::Now() - start_,
+                      .peak_rss_delta_bytes =
+                          GetPeakRssBytes() - start_peak_rss_bytes_});
+    }
+  }
+
+  ScopedPhaseTimer(const ScopedPhaseTimer&) = delete;
+  ScopedPhaseTimer& operator=(const ScopedPhaseTimer&) = delete;
+
+ private:
+  PassResults* results_;
+  std::string name_;
+  absl::Time start_;
+  int64_t start_peak_rss_bytes_;
+};
+
+// The state of the time budget of a pass pipeline (PassOptions::time_budget).
+enum class TimeBudgetState {
+  // There is no budget or most of it remains.
+  kAmple,
+  // Less than a quarter of the budget remains. Expensive passes are skipped.
+  kLow,
+  // The budget is spent. Fixed point loops stop iterating.
+  kExhausted,
 };
 
+TimeBudgetState GetTimeBudgetState(const PassResults& results);
+
 // Base class for all compiler passes. Template parameters:
 //
 //   IrT : The data type that the pass operates on (e.g., xls::Package). The
-//     type should define 'DumpIr' and 'name' methods used for dumping and
-//     logging in compound passes. A pass which strictly operate on the XLS IR
-//     may use the xls::Package type as the IrT template argument. Passes which
+//     type should define 'DumpIr', 'name' and 'GetNodeCount' methods used for
+//     dumping, logging and recording pass invocations in compound passes. A
+//     pass which strictly operate on the XLS IR may use the xls::Package type
+//     as the IrT template argument. Passes which
 //     operate on the IR and a schedule may be instantiated on a data structure
 //     containing both an xls::Package and a schedule. Roughly, IrT should
 //     contain the IR and (optionally) any metadata generated or transformed by
@@ -209,6 +350,11 @@ class PassBase {
   // Returns true if this is a compound pass.
   virtual bool IsCompound() const { return false; }
 
+  // Returns true if the pass may take a long time relative to typical passes.
+  // Expensive passes are skipped when the time budget of the pipeline runs
+  // low (see PassOptions::time_budget).
+  virtual bool IsExpensive() const { return false; }
+
  protected:
   // Derived classes should override this function which is invoked from Run.
   virtual absl::StatusOr<bool> RunInternal(IrT* ir, const OptionsT& options,
@@ -279,6 +425,11 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
 
   absl::StatusOr<bool> RunInternal(IrT* ir, const OptionsT& options,
                                    ResultsT* results) const override {
+    if (options.time_budget.has_value() &&
+        !results->budget_deadline.has_value()) {
+      results->budget_start = absl::Now();
+      results->budget_deadline = *results->budget_start + *options.time_budget;
+    }
     if (!options.ir_dump_path.empty()) {
       // Start of the top-level pass. Dump IR.
       XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, this->short_name(),
@@ -295,11 +446,23 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
   virtual absl::StatusOr<bool> RunNested(
       IrT* ir, const OptionsT& options, ResultsT* results,
       std::string_view top_level_name,
-      absl::Span<const InvariantChecker* const> invariant_checkers) const;
+      absl::Span<const InvariantChecker* const> invariant_checkers) const {
+    results->nesting.push_back(PassNestingLevel{this->short_name()});
+    absl::StatusOr<bool> changed =
+        RunPasses(ir, options, results, top_level_name, invariant_checkers);
+    results->nesting.pop_back();
+    return changed;
+  }
 
   bool IsCompound() const override { return true; }
 
  protected:
+  // Runs each of the passes once. `results->nesting` should include this pass.
+  absl::StatusOr<bool> RunPasses(
+      IrT* ir, const OptionsT& options, ResultsT* results,
+      std::string_view top_level_name,
+      absl::Span<const InvariantChecker* const> invariant_checkers) const;
+
   // Dump the IR to a file in the given directory. Name is determined by the
   // various arguments passed in. File names will be lexographically ordered by
   // package name and ordinal.
@@ -338,19 +501,32 @@ class FixedPointCompoundPassBase
           invariant_checkers) const override {
     bool local_changed = true;
     bool global_changed = false;
-    while (local_changed) {
-      XLS_ASSIGN_OR_RETURN(
-          local_changed,
-          (CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
-              ir, options, results, top_level_name, invariant_checkers)));
+    for (int64_t iteration = 0; local_changed; ++iteration) {
+      results->nesting.push_back(PassNestingLevel{
+          .pass_name = this->short_name(),
+          .fixed_point = true,
+          .iteration = iteration,
+      });
+      absl::StatusOr<bool> changed = this->RunPasses(
+          ir, options, results, top_level_name, invariant_checkers);
+      results->nesting.pop_back();
+      XLS_ASSIGN_OR_RETURN(local_changed, changed);
       global_changed = global_changed || local_changed;
+      if (local_changed &&
+          GetTimeBudgetState(*results) == TimeBudgetState::kExhausted) {
+        XLS_VLOG(1) << "Stopping fixed point pass " << this->short_name()
+                    << ". Time budget exhausted.";
+        results->skipped_passes.push_back(
+            absl::StrCat(this->short_name(), " (fixed point)"));
+        break;
+      }
     }
     return global_changed;
   }
 };
 
 template <typename IrT, typename OptionsT, typename ResultsT>
-absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
+absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunPasses(
     IrT* ir, const OptionsT& options, ResultsT* results,
     std::string_view top_level_name,
     absl::Span<const InvariantChecker* const> invariant_checkers) const {
@@ -403,11 +579,24 @@ absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
       continue;
     }
 
+    if (pass->IsExpensive() &&
+        GetTimeBudgetState(*results) != TimeBudgetState::kAmple) {
+      XLS_VLOG(1) << "Skipping pass. Time budget is low.";
+      results->skipped_passes.push_back(pass->short_name());
+      continue;
+    }
+
 #ifdef DEBUG
     // Verify that the IR should change iff Run returns true. This is slow, so
     // do not check it in optimized builds.
     std::string ir_before = ir->DumpIr();
 #endif
+    int64_t node_count_before = 0;
+    int64_t peak_rss_before = 0;
+    if (!pass->IsCompound()) {
+      node_count_before = ir->GetNodeCount();
+      peak_rss_before = GetPeakRssBytes();
+    }
     absl::Time start = absl::Now();
     bool pass_changed;
     if (pass->IsCompound()) {
@@ -442,8 +631,15 @@ absl::StatusOr<bool> CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
         pass->short_name(),
         (pass_changed ? "changed IR" : "did not change IR"));
     if (!pass->IsCompound()) {
-      results->invocations.push_back(
-          {pass->short_name(), pass_changed, duration});
+      results->invocations.push_back(PassInvocation{
+          .pass_name = pass->short_name(),
+          .ir_changed = pass_changed,
+          .run_duration = duration,
+          .node_count_before = node_count_before,
+          .node_count_after = ir->GetNodeCount(),
+          .peak_rss_delta_bytes = GetPeakRssBytes() - peak_rss_before,
+          .nesting = results->nesting,
+      });
     }
     if (!options.ir_dump_path.empty()) {
       XLS_RETURN_IF_ERROR(DumpIr(options.ir_dump_path, ir, top_level_name,
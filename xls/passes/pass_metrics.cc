@@ -0,0 +1,80 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_metrics.h"
+
+#include <string>
+
+#include "google/protobuf/util/json_util.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+PassMetricsProto PassResultsToProto(const PassResults& results) {
+  PassMetricsProto proto;
+  absl::Duration total_duration;
+  for (const PassInvocation& invocation : results.invocations) {
+    PassInvocationProto* invocation_proto = proto.add_invocations();
+    invocation_proto->set_pass_name(invocation.pass_name);
+    invocation_proto->set_ir_changed(invocation.ir_changed);
+    invocation_proto->set_run_duration_us(
+        absl::ToInt64Microseconds(invocation.run_duration));
+    invocation_proto->set_node_count_before(invocation.node_count_before);
+    invocation_proto->set_node_count_after(invocation.node_count_after);
+    invocation_proto->set_peak_rss_delta_bytes(invocation.peak_rss_delta_bytes);
+    for (const PassNestingLevel& level : invocation.nesting) {
+      PassNestingLevelProto* level_proto = invocation_proto->add_nesting();
+      level_proto->set_pass_name(level.pass_name);
+      level_proto->set_fixed_point(level.fixed_point);
+      level_proto->set_iteration(level.iteration);
+    }
+    total_duration += invocation.run_duration;
+  }
+  proto.set_total_run_duration_us(absl::ToInt64Microseconds(total_duration));
+  for (const PhaseTiming& phase : results.phases) {
+    PhaseTimingProto* phase_proto = proto.add_phases();
+    phase_proto->set_name(phase.name);
+    phase_proto->set_duration_us(absl::ToInt64Microseconds(phase.duration));
+    phase_proto->set_peak_rss_delta_bytes(phase.peak_rss_delta_bytes);
+  }
+  return proto;
+}
+
+absl::StatusOr<std::string> PassMetricsToJson(const PassMetricsProto& metrics) {
+  std::string serialized_json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+  auto status = google::protobuf::util::MessageToJsonString(
+      metrics, &serialized_json, print_options);
+  if (!status.ok()) {
+    return absl::InternalError(std::string{status.message()});
+  }
+  return serialized_json;
+}
+
+absl::Status WritePassMetrics(const PassResults& results,
+                              const std::filesystem::path& path) {
+  PassMetricsProto metrics = PassResultsToProto(results);
+  if (path.extension() == ".json") {
+    XLS_ASSIGN_OR_RETURN(std::string json, PassMetricsToJson(metrics));
+    return SetFileContents(path, json);
+  }
+  return SetTextProtoFile(path, metrics);
+}
+
+}  // namespace xls
@@ -0,0 +1,42 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PASS_METRICS_H_
+#define XLS_PASSES_PASS_METRICS_H_
+
+#include <filesystem>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+
+// Returns the per-invocation metrics recorded in the given pass results.
+PassMetricsProto PassResultsToProto(const PassResults& results);
+
+// Returns the JSON serialization of the given metrics.
+absl::StatusOr<std::string> PassMetricsToJson(const PassMetricsProto& metrics);
+
+// Writes the metrics recorded in the given pass results to the file at
+// `path`. The metrics are written as JSON if the file name has the extension
+// ".json" and as a text proto otherwise.
+absl::Status WritePassMetrics(const PassResults& results,
+                              const std::filesystem::path& path);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PASS_METRICS_H_
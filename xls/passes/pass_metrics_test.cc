@@ -0,0 +1,104 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/pass_metrics.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using ::testing::HasSubstr;
+
+PassResults MakeResults() {
+  PassResults results;
+  results.invocations.push_back(PassInvocation{
+      .pass_name = "dce",
+      .ir_changed = true,
+      .run_duration = absl::Microseconds(42),
+      .node_count_before = 10,
+      .node_count_after = 7,
+      .peak_rss_delta_bytes = 4096,
+      .nesting = {PassNestingLevel{.pass_name = "ir"},
+                  PassNestingLevel{.pass_name = "simp",
+                                   .fixed_point = true,
+                                   .iteration = 3}},
+  });
+  results.invocations.push_back(PassInvocation{
+      .pass_name = "cse",
+      .ir_changed = false,
+      .run_duration = absl::Microseconds(8),
+      .node_count_before = 7,
+      .node_count_after = 7,
+  });
+  results.phases.push_back(PhaseTiming{.name = "scheduling",
+                                       .duration = absl::Milliseconds(3),
+                                       .peak_rss_delta_bytes = 8192});
+  return results;
+}
+
+TEST(PassMetricsTest, PassResultsToProto) {
+  PassMetricsProto proto = PassResultsToProto(MakeResults());
+  EXPECT_EQ(proto.total_run_duration_us(), 50);
+  ASSERT_EQ(proto.invocations_size(), 2);
+
+  const PassInvocationProto& dce = proto.invocations(0);
+  EXPECT_EQ(dce.pass_name(), "dce");
+  EXPECT_TRUE(dce.ir_changed());
+  EXPECT_EQ(dce.run_duration_us(), 42);
+  EXPECT_EQ(dce.node_count_before(), 10);
+  EXPECT_EQ(dce.node_count_after(), 7);
+  EXPECT_EQ(dce.peak_rss_delta_bytes(), 4096);
+  ASSERT_EQ(dce.nesting_size(), 2);
+  EXPECT_EQ(dce.nesting(0).pass_name(), "ir");
+  EXPECT_FALSE(dce.nesting(0).fixed_point());
+  EXPECT_EQ(dce.nesting(1).pass_name(), "simp");
+  EXPECT_TRUE(dce.nesting(1).fixed_point());
+  EXPECT_EQ(dce.nesting(1).iteration(), 3);
+
+  EXPECT_EQ(proto.invocations(1).pass_name(), "cse");
+  EXPECT_EQ(proto.invocations(1).nesting_size(), 0);
+
+  ASSERT_EQ(proto.phases_size(), 1);
+  EXPECT_EQ(proto.phases(0).name(), "scheduling");
+  EXPECT_EQ(proto.phases(0).duration_us(), 3000);
+  EXPECT_EQ(proto.phases(0).peak_rss_delta_bytes(), 8192);
+}
+
+TEST(PassMetricsTest, ScopedPhaseTimer) {
+  PassResults results;
+  {
+    ScopedPhaseTimer timer(&results, "emission");
+    // A null PassResults records nothing.
+    ScopedPhaseTimer unrecorded(nullptr, "unrecorded");
+  }
+  ASSERT_EQ(results.phases.size(), 1);
+  EXPECT_EQ(results.phases[0].name, "emission");
+  EXPECT_GE(results.phases[0].duration, absl::ZeroDuration());
+}
+
+TEST(PassMetricsTest, PassMetricsToJson) {
+  EXPECT_THAT(PassMetricsToJson(PassResultsToProto(MakeResults())),
+              IsOkAndHolds(HasSubstr("\"node_count_before\": \"10\"")));
+}
+
+}  // namespace
+}  // namespace xls
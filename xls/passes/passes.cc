@@ -14,11 +14,19 @@
 
 #include "xls/passes/passes.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 
 namespace xls {
 
@@ -41,11 +49,64 @@ absl::StatusOr<bool> FunctionBasePass::RunOnFunctionBase(
 absl::StatusOr<bool> FunctionBasePass::RunInternal(Package* p,
                                                    const PassOptions& options,
                                                    PassResults* results) const {
-  bool changed = false;
+  bool incremental = options.incremental_fixed_point &&
+                     DependsOnlyOnFunctionBase() &&
+                     absl::c_any_of(results->nesting,
+                                    [](const PassNestingLevel& level) {
+                                      return level.fixed_point;
+                                    });
+  std::vector<FunctionBase*> function_bases;
   for (FunctionBase* f : p->GetFunctionBases()) {
-    XLS_ASSIGN_OR_RETURN(bool function_changed,
-                         RunOnFunctionBaseInternal(f, options, results));
-    changed |= function_changed;
+    if (incremental) {
+      auto it = results->unchanged_function_bases.find({this, f->uid()});
+      if (it != results->unchanged_function_bases.end() &&
+          it->second == f->change_count()) {
+        XLS_VLOG(2) << absl::StreamFormat(
+            "Skipping %s on unchanged function_base %s", long_name(),
+            f->name());
+        continue;
+      }
+    }
+    function_bases.push_back(f);
+  }
+
+  std::vector<absl::StatusOr<bool>> function_changed(function_bases.size(),
+                                                     false);
+  bool parallel = options.function_base_pass_threads.has_value() &&
+                  AccessesOnlyFunctionBase() && function_bases.size() > 1;
+  if (parallel) {
+    for (FunctionBase* f : function_bases) {
+      f->BeginNodeIdStaging();
+    }
+    BoundedParallelFor(
+        0, function_bases.size(),
+        std::max<int64_t>(options.function_base_pass_threads.value(), 1),
+        [&](int64_t index) {
+          function_changed[index] = RunOnFunctionBaseInternal(
+              function_bases[index], options, results);
+        });
+    for (FunctionBase* f : function_bases) {
+      f->EndNodeIdStaging();
+    }
+  }
+
+  bool changed = false;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    FunctionBase* f = function_bases[i];
+    if (!parallel) {
+      function_changed[i] = RunOnFunctionBaseInternal(f, options, results);
+    }
+    XLS_RETURN_IF_ERROR(function_changed[i].status());
+    // Drop the tombstones of nodes removed by the pass so later passes iterate
+    // over a dense node table.
+    f->MaybeCompactNodes();
+    if (incremental && !function_changed[i].value()) {
+      results->unchanged_function_bases[{this, f->uid()}] = f->change_count();
+    }
+    changed |= function_changed[i].value();
+  }
+  if (changed) {
+    results->analyses.DropStaleAnalyses(p);
   }
   return changed;
 }
@@ -109,6 +170,7 @@ absl::StatusOr<bool> ProcPass::RunInternal(Package* p,
   for (const auto& proc : p->procs()) {
     XLS_ASSIGN_OR_RETURN(bool proc_changed,
                          RunOnProcInternal(proc.get(), options, results));
+    proc->MaybeCompactNodes();
     changed |= proc_changed;
   }
   return changed;
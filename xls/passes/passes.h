@@ -58,9 +58,30 @@ class FunctionBasePass : public Pass {
                                          const PassOptions& options,
                                          PassResults* results) const;
 
+  // Returns true if whether the pass changes a function base depends only on
+  // the function base itself (not on other function bases, channels or
+  // previous runs of the pass). The pass then never changes a function base
+  // which is unchanged since the pass last ran on it and left it unchanged, so
+  // such reruns are skipped within fixed point compound passes when
+  // PassOptions::incremental_fixed_point is set.
+  virtual bool DependsOnlyOnFunctionBase() const { return false; }
+
+  // Returns true if running the pass on a function base reads and writes only
+  // that function base (and the types of the package), so the pass may run on
+  // different function bases concurrently when
+  // PassOptions::function_base_pass_threads is set. Such passes must not
+  // modify the PassResults other than through the (thread-safe)
+  // PassResults::analyses. Passes which depend only on the function base
+  // generally qualify, but not those which inspect other function bases (e.g.,
+  // by interpreting invoked functions).
+  virtual bool AccessesOnlyFunctionBase() const {
+    return DependsOnlyOnFunctionBase();
+  }
+
  protected:
   // Iterates over each function and proc in the package calling
-  // RunOnFunctionBase.
+  // RunOnFunctionBase. Afterwards drops the analyses in PassResults::analyses
+  // invalidated by the pass.
   absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
                                    PassResults* results) const override;
 
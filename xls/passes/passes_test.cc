@@ -14,10 +14,18 @@
 
 #include "xls/passes/passes.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
@@ -27,8 +35,11 @@
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
 
 namespace xls {
 namespace {
@@ -114,6 +125,253 @@ TEST(PassesTest, AddPasses) {
               ElementsAre("d1", "d2", "d3", "d4", "d5", "d6"));
 }
 
+// Pass which adds a literal to the top function in each of its first
+// `change_count` invocations.
+class AddLiteralPass : public Pass {
+ public:
+  explicit AddLiteralPass(int64_t change_count)
+      : Pass("add_literal", "Add literal"), change_count_(change_count) {}
+
+  absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
+                                   PassResults* results) const override {
+    if (run_count_++ >= change_count_) {
+      return false;
+    }
+    XLS_ASSIGN_OR_RETURN(Function * f, p->GetTopAsFunction());
+    XLS_RETURN_IF_ERROR(
+        f->MakeNode<Literal>(SourceInfo(), Value(UBits(0, 32))).status());
+    return true;
+  }
+
+ private:
+  int64_t change_count_;
+  mutable int64_t run_count_ = 0;
+};
+
+TEST(PassesTest, InvocationMetrics) {
+  std::unique_ptr<Package> p = BuildShift0().first;
+  XLS_ASSERT_OK(p->SetTopByName("simple_arith"));
+  int64_t initial_node_count = p->GetNodeCount();
+
+  CompoundPass pass_mgr("TOP", "Top level pass manager");
+  pass_mgr.Add<DummyPass>("d1", "Dummy Pass 1");
+  auto fixed_point =
+      pass_mgr.Add<FixedPointCompoundPass>("fp", "Fixed point pass");
+  fixed_point->Add<AddLiteralPass>(/*change_count=*/2);
+
+  PassResults results;
+  EXPECT_THAT(pass_mgr.Run(p.get(), PassOptions(), &results),
+              IsOkAndHolds(true));
+  EXPECT_TRUE(results.nesting.empty());
+  ASSERT_EQ(results.invocations.size(), 4);
+
+  const PassInvocation& d1 = results.invocations[0];
+  EXPECT_EQ(d1.pass_name, "d1");
+  EXPECT_FALSE(d1.ir_changed);
+  EXPECT_EQ(d1.node_count_before, initial_node_count);
+  EXPECT_EQ(d1.node_count_after, initial_node_count);
+  ASSERT_EQ(d1.nesting.size(), 1);
+  EXPECT_EQ(d1.nesting[0].pass_name, "TOP");
+  EXPECT_FALSE(d1.nesting[0].fixed_point);
+
+  for (int64_t i = 0; i < 3; ++i) {
+    const PassInvocation& invocation = results.invocations[i + 1];
+    EXPECT_EQ(invocation.pass_name, "add_literal");
+    EXPECT_EQ(invocation.ir_changed, i < 2);
+    EXPECT_EQ(invocation.node_count_before,
+              initial_node_count + std::min<int64_t>(i, 2));
+    EXPECT_EQ(invocation.node_count_after,
+              initial_node_count + std::min<int64_t>(i + 1, 2));
+    EXPECT_GE(invocation.peak_rss_delta_bytes, 0);
+    ASSERT_EQ(invocation.nesting.size(), 2);
+    EXPECT_EQ(invocation.nesting[0].pass_name, "TOP");
+    EXPECT_EQ(invocation.nesting[1].pass_name, "fp");
+    EXPECT_TRUE(invocation.nesting[1].fixed_point);
+    EXPECT_EQ(invocation.nesting[1].iteration, i);
+  }
+}
+
+// Pass which never changes the IR and counts the number of times it is run on
+// each function base.
+class CountingPass : public FunctionBasePass {
+ public:
+  CountingPass() : FunctionBasePass("counting", "Counting") {}
+
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
+  int64_t run_count(std::string_view name) const {
+    return run_counts_.contains(name) ? run_counts_.at(name) : 0;
+  }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const PassOptions& options,
+      PassResults* results) const override {
+    ++run_counts_[f->name()];
+    return false;
+  }
+
+ private:
+  mutable absl::flat_hash_map<std::string, int64_t> run_counts_;
+};
+
+TEST(PassesTest, IncrementalFixedPoint) {
+  const char kPackage[] = R"(
+package p
+
+top fn a(x: bits[32]) -> bits[32] {
+  ret identity.1: bits[32] = identity(x)
+}
+
+fn b(x: bits[32]) -> bits[32] {
+  ret neg.2: bits[32] = neg(x)
+}
+)";
+  for (bool incremental : {false, true}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                             Parser::ParsePackage(kPackage));
+    CompoundPass pass_mgr("TOP", "Top level pass manager");
+    // The counting pass outside of the fixed point pass is not affected.
+    CountingPass* outer = pass_mgr.Add<CountingPass>();
+    auto fixed_point =
+        pass_mgr.Add<FixedPointCompoundPass>("fp", "Fixed point pass");
+    // Changes function `a` in the first two iterations.
+    fixed_point->Add<AddLiteralPass>(/*change_count=*/2);
+    CountingPass* inner = fixed_point->Add<CountingPass>();
+    pass_mgr.Add<CountingPass>();
+
+    PassOptions options;
+    options.incremental_fixed_point = incremental;
+    PassResults results;
+    EXPECT_THAT(pass_mgr.Run(p.get(), options, &results), IsOkAndHolds(true));
+    EXPECT_EQ(outer->run_count("a"), 1);
+    EXPECT_EQ(outer->run_count("b"), 1);
+    // The fixed point pass runs three iterations. Incrementally, `a` is
+    // skipped in the last iteration and `b` in all but the first.
+    EXPECT_EQ(inner->run_count("a"), incremental ? 2 : 3);
+    EXPECT_EQ(inner->run_count("b"), incremental ? 1 : 3);
+  }
+}
+
+// Pass which rewires the return value of the top function in each of its first
+// `change_count` invocations, either by swapping its operands or by replacing
+// its first operand with the other one. Neither adds or removes a node.
+class RewireOperandsPass : public Pass {
+ public:
+  RewireOperandsPass(bool swap, int64_t change_count)
+      : Pass("rewire", "Rewire operands"),
+        swap_(swap),
+        change_count_(change_count) {}
+
+  absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
+                                   PassResults* results) const override {
+    if (run_count_++ >= change_count_) {
+      return false;
+    }
+    XLS_ASSIGN_OR_RETURN(Function * f, p->GetTopAsFunction());
+    Node* node = f->return_value();
+    if (swap_) {
+      node->SwapOperands(0, 1);
+    } else {
+      XLS_RETURN_IF_ERROR(node->ReplaceOperandNumber(0, node->operand(1)));
+    }
+    return true;
+  }
+
+ private:
+  bool swap_;
+  int64_t change_count_;
+  mutable int64_t run_count_ = 0;
+};
+
+TEST(PassesTest, IncrementalFixedPointSeesOperandRewiring) {
+  const char kPackage[] = R"(
+package p
+
+top fn a(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.1: bits[32] = add(x, y)
+}
+)";
+  for (bool swap : {false, true}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                             Parser::ParsePackage(kPackage));
+    CompoundPass pass_mgr("TOP", "Top level pass manager");
+    auto fixed_point =
+        pass_mgr.Add<FixedPointCompoundPass>("fp", "Fixed point pass");
+    // Changes `a` only through SwapOperands or ReplaceOperandNumber in the
+    // first two iterations.
+    fixed_point->Add<RewireOperandsPass>(swap, /*change_count=*/2);
+    CountingPass* counting = fixed_point->Add<CountingPass>();
+
+    PassOptions options;
+    options.incremental_fixed_point = true;
+    PassResults results;
+    EXPECT_THAT(pass_mgr.Run(p.get(), options, &results), IsOkAndHolds(true));
+    // `a` is rerun after each of the two changes and only skipped in the
+    // third, unchanged, iteration.
+    EXPECT_EQ(counting->run_count("a"), 2) << (swap ? "swap" : "replace");
+  }
+}
+
+// Pass which negates the return value of each function base which is a
+// function, creating a literal of a width unique to the function on the way.
+class NegateReturnValuePass : public FunctionBasePass {
+ public:
+  NegateReturnValuePass() : FunctionBasePass("negate", "Negate") {}
+
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const PassOptions& options,
+      PassResults* results) const override {
+    if (!f->IsFunction()) {
+      return false;
+    }
+    Function* function = f->AsFunctionOrDie();
+    XLS_RETURN_IF_ERROR(
+        function
+            ->MakeNode<Literal>(SourceInfo(),
+                                Value(UBits(0, 100 + function->node_count())))
+            .status());
+    XLS_ASSIGN_OR_RETURN(
+        Node * neg, function->MakeNode<UnOp>(
+                        SourceInfo(), function->return_value(), Op::kNeg));
+    XLS_RETURN_IF_ERROR(function->set_return_value(neg));
+    return true;
+  }
+};
+
+TEST(PassesTest, FunctionBasePassThreads) {
+  auto run = [](std::optional<int64_t> threads) -> std::string {
+    auto p = std::make_unique<Package>("p");
+    for (int64_t i = 0; i < 8; ++i) {
+      FunctionBuilder fb(absl::StrFormat("f%d", i), p.get());
+      BValue x = fb.Param("x", p->GetBitsType(32));
+      for (int64_t j = 0; j < i; ++j) {
+        x = fb.Not(x);
+      }
+      XLS_CHECK_OK(fb.Build().status());
+    }
+    CompoundPass pass_mgr("TOP", "Top level pass manager");
+    pass_mgr.Add<NegateReturnValuePass>();
+    pass_mgr.Add<NegateReturnValuePass>();
+    PassOptions options;
+    options.function_base_pass_threads = threads;
+    PassResults results;
+    XLS_CHECK_OK(pass_mgr.Run(p.get(), options, &results).status());
+    XLS_CHECK_OK(VerifyPackage(p.get()));
+    return p->DumpIr();
+  };
+  // The node ids do not depend on the number of threads. As the pass removes
+  // none of the nodes it creates, they also match those of a serial run.
+  std::string ir = run(1);
+  EXPECT_EQ(run(4), ir);
+  EXPECT_EQ(run(16), ir);
+  EXPECT_EQ(run(std::nullopt), ir);
+  EXPECT_THAT(ir, HasSubstr("neg"));
+}
+
 // Invariant checker which returns an error if the package has function with a
 // particular name.
 class PackageNameChecker : public InvariantChecker {
@@ -442,6 +700,89 @@ TEST(PassesTest, RunOnlyAndSkipPassesOption) {
   }
 }
 
+// Recording pass which claims to be expensive and optionally claims to always
+// change the IR.
+class ExpensiveRecordingPass : public RecordingPass {
+ public:
+  ExpensiveRecordingPass(std::string name, std::vector<std::string>* record,
+                         bool always_changes = false)
+      : RecordingPass(name, record), always_changes_(always_changes) {}
+
+  bool IsExpensive() const override { return true; }
+
+  absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
+                                   PassResults* results) const override {
+    XLS_RETURN_IF_ERROR(
+        RecordingPass::RunInternal(p, options, results).status());
+    return always_changes_;
+  }
+
+ private:
+  bool always_changes_;
+};
+
+TEST(PassesTest, TimeBudgetOption) {
+  std::unique_ptr<Package> p = BuildShift0().first;
+
+  std::vector<std::string> record;
+  CompoundPass compound("compound", "Compound pass");
+  compound.Add<RecordingPass>("foo", &record);
+  compound.Add<ExpensiveRecordingPass>("bar", &record);
+  compound.Add<RecordingPass>("qux", &record);
+
+  {
+    PassOptions options;
+    options.time_budget = absl::Hours(1);
+    PassResults results;
+    EXPECT_THAT(compound.Run(p.get(), options, &results),
+                IsOkAndHolds(false));
+    EXPECT_THAT(record, ElementsAre("foo", "bar", "qux"));
+    EXPECT_THAT(results.skipped_passes, ElementsAre());
+  }
+
+  {
+    // With the budget spent expensive passes are skipped and the others still
+    // run.
+    PassOptions options;
+    options.time_budget = absl::ZeroDuration();
+    PassResults results;
+    record.clear();
+    EXPECT_THAT(compound.Run(p.get(), options, &results),
+                IsOkAndHolds(false));
+    EXPECT_THAT(record, ElementsAre("foo", "qux"));
+    EXPECT_THAT(results.skipped_passes, ElementsAre("bar"));
+  }
+}
+
+TEST(PassesTest, TimeBudgetStopsFixedPoint) {
+  std::unique_ptr<Package> p = BuildShift0().first;
+
+  // The fixed point pass never converges as its pass always changes the IR.
+  std::vector<std::string> record;
+  CompoundPass compound("compound", "Compound pass");
+  auto fixed_point =
+      compound.Add<FixedPointCompoundPass>("fixed_point", "Fixed point");
+  fixed_point->Add<RecordingPass>("foo", &record);
+  fixed_point->Add<ExpensiveRecordingPass>("bar", &record,
+                                           /*always_changes=*/true);
+
+  PassOptions options;
+  options.time_budget = absl::ZeroDuration();
+  PassResults results;
+  // The expensive pass is skipped so the loop converges.
+  EXPECT_THAT(compound.Run(p.get(), options, &results), IsOkAndHolds(false));
+  EXPECT_THAT(record, ElementsAre("foo"));
+
+  // A non-converging loop of cheap passes stops after one iteration.
+  CompoundPass cheap("cheap", "Cheap compound pass");
+  auto cheap_fixed_point =
+      cheap.Add<FixedPointCompoundPass>("fixed_point", "Fixed point");
+  cheap_fixed_point->Add<AddLiteralPass>(/*change_count=*/100);
+  results = PassResults();
+  EXPECT_THAT(cheap.Run(p.get(), options, &results), IsOkAndHolds(true));
+  EXPECT_THAT(results.skipped_passes, ElementsAre("fixed_point (fixed point)"));
+}
+
 class NaiveDcePass : public FunctionBasePass {
  public:
   NaiveDcePass() : FunctionBasePass("naive_dce", "naive dce") {}
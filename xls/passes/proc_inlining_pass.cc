@@ -30,6 +30,8 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/logging.h"
@@ -703,6 +705,36 @@ GetReceiveDataDependencies(Proc* inlined_proc) {
   return std::move(result);
 }
 
+// A BddQueryEngine over the container proc which is only populated when first
+// queried. Building the BDD is the only analysis which spans the whole inlined
+// network, so it is skipped entirely when no received data needs to be checked
+// (e.g., all receives are on single-value channels or have no users).
+class LazyBddQueryEngine {
+ public:
+  explicit LazyBddQueryEngine(Proc* container_proc)
+      : container_proc_(container_proc),
+        query_engine_(BddFunction::kDefaultPathLimit, IsCheapForBdds) {}
+
+  absl::StatusOr<const BddQueryEngine*> Get() {
+    if (!populated_) {
+      absl::Time start = absl::Now();
+      XLS_RETURN_IF_ERROR(query_engine_.Populate(container_proc_).status());
+      populated_ = true;
+      XLS_VLOG(1) << absl::StreamFormat(
+          "Built BDD over %d nodes of %s in %s", container_proc_->node_count(),
+          container_proc_->name(), absl::FormatDuration(absl::Now() - start));
+    }
+    return &query_engine_;
+  }
+
+  bool populated() const { return populated_; }
+
+ private:
+  Proc* container_proc_;
+  BddQueryEngine query_engine_;
+  bool populated_ = false;
+};
+
 // Abstraction representing a proc thread. A proc thread contains the logic
 // required to virtually evaluate a proc (the "inlined proc") within another
 // proc (the "container proc"). An activation bit is threaded through the proc's
@@ -939,11 +971,13 @@ class ProcThread {
     return result;
   }
 
-  // Add state as necessary to the proc to save the results of receives in the
-  // proc thread. Received data must be saved to the proc state if the
-  // side-effecting uses of the data may not necessarily be activated in the
-  // same tick of the container proc state.
-  absl::Status MaybeSaveReceivedData(const BddQueryEngine& query_engine) {
+  // Returns the receives (as activation nodes) of the proc thread whose
+  // results must be saved to the proc state. Received data must be saved if
+  // the side-effecting uses of the data may not necessarily be activated in
+  // the same tick of the container proc state. Does not modify the container
+  // proc, so that the BDD answers queries about the IR it was built over.
+  absl::StatusOr<std::vector<const ActivationNode*>> GetReceivesToSave(
+      LazyBddQueryEngine& query_engine) {
     // Determine which receive nodes (including virtual receive nodes) must save
     // their result as state. A receive must save its result as state if any
     // side-effecting users of the receive might not be activated in the same
@@ -954,7 +988,8 @@ class ProcThread {
 
     // Use a BDD to determine whether the activation of a particular receive
     // necessarily implies the activation of every side-effecting user of the
-    // receive. If not, then insert state to save the received data.
+    // receive. If not, then the received data must be saved.
+    std::vector<const ActivationNode*> receives;
     for (const ActivationNode& anode : activation_nodes_) {
       if (!anode.original_node.has_value() ||
           !anode.original_node.value()->Is<Receive>()) {
@@ -1028,7 +1063,9 @@ class ProcThread {
           }
         }
 
-        bool user_always_ready = query_engine.Implies(
+        XLS_ASSIGN_OR_RETURN(const BddQueryEngine* bdd_query_engine,
+                             query_engine.Get());
+        bool user_always_ready = bdd_query_engine->Implies(
             TreeBitLocation{anode.activation_out, 0},
             TreeBitLocation{user_anode->activation_out, 0});
         if (!user_always_ready) {
@@ -1046,13 +1083,24 @@ class ProcThread {
             "    No need to save data. All users activated.");
         continue;
       }
+      receives.push_back(&anode);
+    }
+    return receives;
+  }
 
+  // Adds state to the proc to save the results of the given receives, as
+  // returned by GetReceivesToSave.
+  absl::Status SaveReceivedData(
+      absl::Span<const ActivationNode* const> receives) {
+    for (const ActivationNode* anode : receives) {
+      XLS_ASSIGN_OR_RETURN(Channel * channel,
+                           GetChannelUsedByNode(anode->original_node.value()));
       // Add state which saves the data value of the receive.
       XLS_ASSIGN_OR_RETURN(
           StateElement * data_state,
           AllocateState(absl::StrFormat("%s_data_state", channel->name()),
                         ZeroOfType(channel->type())));
-      Node* receive_out = anode.data_out.value();
+      Node* receive_out = anode->data_out.value();
       std::vector<Node*> old_users(receive_out->users().begin(),
                                    receive_out->users().end());
       XLS_ASSIGN_OR_RETURN(Node * receive_data,
@@ -1063,7 +1111,7 @@ class ProcThread {
           Node * maybe_saved_data,
           container_proc_->MakeNodeWithName<Select>(
               SourceInfo(),
-              /*selector=*/anode.activation_out, /*cases=*/
+              /*selector=*/anode->activation_out, /*cases=*/
               std::vector<Node*>{data_state->GetState(), receive_data},
               /*default_case=*/std::nullopt,
               absl::StrFormat("%s_data", channel->name())));
@@ -1722,20 +1770,51 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(Package* p,
   // virtual send/receives.
   // TODO(meheff): 2022/02/11 Add analysis which determines whether inlining is
   // a legal transformation.
+  //
+  // The time and node growth of each step is logged so that the cost of
+  // inlining large proc networks can be attributed to individual procs.
+  absl::Time inlining_start = absl::Now();
   for (Proc* proc : procs_to_inline) {
+    absl::Time start = absl::Now();
+    int64_t nodes_before = container_proc->node_count();
     XLS_ASSIGN_OR_RETURN(
         ProcThread proc_thread,
         InlineProcAsProcThread(proc, container_proc, virtual_channels));
     proc_threads.push_back(std::move(proc_thread));
+    XLS_VLOG(1) << absl::StreamFormat(
+        "Inlined proc %s (%d nodes) in %s: container grew from %d to %d nodes",
+        proc->name(), proc->node_count(),
+        absl::FormatDuration(absl::Now() - start), nodes_before,
+        container_proc->node_count());
   }
 
   XLS_VLOG(3) << "After inlining procs:\n" << p->DumpIr();
 
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit, IsCheapForBdds);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(container_proc).status());
-
-  for (ProcThread& proc_thread : proc_threads) {
-    XLS_RETURN_IF_ERROR(proc_thread.MaybeSaveReceivedData(query_engine));
+  {
+    absl::Time start = absl::Now();
+    int64_t nodes_before = container_proc->node_count();
+    LazyBddQueryEngine query_engine(container_proc);
+    if (always_build_bdd_) {
+      XLS_RETURN_IF_ERROR(query_engine.Get().status());
+    }
+    // Every query is answered before any received data is saved, as the BDD
+    // only describes the IR it was built over.
+    std::vector<std::vector<const ActivationNode*>> receives_to_save;
+    for (ProcThread& proc_thread : proc_threads) {
+      XLS_ASSIGN_OR_RETURN(std::vector<const ActivationNode*> receives,
+                           proc_thread.GetReceivesToSave(query_engine));
+      receives_to_save.push_back(std::move(receives));
+    }
+    for (int64_t i = 0; i < proc_threads.size(); ++i) {
+      XLS_RETURN_IF_ERROR(
+          proc_threads[i].SaveReceivedData(receives_to_save[i]));
+    }
+    XLS_VLOG(1) << absl::StreamFormat(
+        "Saved received data in %s (BDD %s): container grew from %d to %d "
+        "nodes",
+        absl::FormatDuration(absl::Now() - start),
+        query_engine.populated() ? "built" : "not needed", nodes_before,
+        container_proc->node_count());
   }
 
   // Add the inlined (and top) proc state and activation bits.
@@ -1796,6 +1875,11 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(Package* p,
   }
 
   XLS_VLOG(3) << "After deleting inlined procs:\n" << p->DumpIr();
+  XLS_VLOG(1) << absl::StreamFormat(
+      "Inlined %d procs and %d channels into %s (%d nodes) in %s",
+      procs_to_inline.size(), virtual_channels.size(), top_proc_name,
+      container_proc->node_count(),
+      absl::FormatDuration(absl::Now() - inlining_start));
 
   return true;
 }
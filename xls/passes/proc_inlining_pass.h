@@ -23,12 +23,20 @@ namespace xls {
 // Pass which inlines all procs into the top-level proc.
 class ProcInliningPass : public Pass {
  public:
-  ProcInliningPass() : Pass("proc_inlining", "Proc inlining") {}
+  // The BDD over the inlined procs is only built if some received data needs
+  // checking. If `always_build_bdd` is true it is built regardless, which must
+  // not change the result.
+  explicit ProcInliningPass(bool always_build_bdd = false)
+      : Pass("proc_inlining", "Proc inlining"),
+        always_build_bdd_(always_build_bdd) {}
   ~ProcInliningPass() override = default;
 
  protected:
   absl::StatusOr<bool> RunInternal(Package* p, const PassOptions& options,
                                    PassResults* results) const override;
+
+ private:
+  bool always_build_bdd_;
 };
 
 }  // namespace xls
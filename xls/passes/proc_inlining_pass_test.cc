@@ -22,6 +22,7 @@
 #include <random>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -64,7 +65,8 @@ class ProcInliningPassTest : public IrTestBase {
   ProcInliningPassTest() = default;
 
   absl::StatusOr<bool> Run(Package* p,
-                           std::optional<std::string> top = std::nullopt) {
+                           std::optional<std::string> top = std::nullopt,
+                           bool always_build_bdd = false) {
     if (top.has_value()) {
       XLS_RETURN_IF_ERROR(p->SetTopByName(top.value()));
     }
@@ -72,8 +74,9 @@ class ProcInliningPassTest : public IrTestBase {
     PassOptions options;
     options.inline_procs = true;
     PassResults results;
-    XLS_ASSIGN_OR_RETURN(bool changed,
-                         ProcInliningPass().Run(p, options, &results));
+    XLS_ASSIGN_OR_RETURN(
+        bool changed,
+        ProcInliningPass(always_build_bdd).Run(p, options, &results));
     // Run dce to clean things up.
     XLS_RETURN_IF_ERROR(
         DeadCodeEliminationPass().Run(p, PassOptions(), &results).status());
@@ -3790,5 +3793,52 @@ TEST_F(ProcInliningPassTest, ProcWithTrace) {
                   HasSubstr("data: 500")));
 }
 
+TEST_F(ProcInliningPassTest, BddBuiltOnDemandGivesSameIr) {
+  // B and C both have conditional receives whose data may need saving, so the
+  // first proc thread could be rewritten before the second is queried.
+  auto make_package = [&]() -> absl::StatusOr<std::unique_ptr<Package>> {
+    auto p = CreatePackage();
+    Type* u32 = p->GetBitsType(32);
+    XLS_ASSIGN_OR_RETURN(
+        Channel * ch_in,
+        p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+    XLS_ASSIGN_OR_RETURN(
+        Channel * a_to_b,
+        p->CreateStreamingChannel("a_to_b", ChannelOps::kSendReceive, u32));
+    XLS_ASSIGN_OR_RETURN(
+        Channel * b_to_c,
+        p->CreateStreamingChannel("b_to_c", ChannelOps::kSendReceive, u32));
+    XLS_ASSIGN_OR_RETURN(
+        Channel * ch_out,
+        p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+    XLS_RETURN_IF_ERROR(MakeLoopbackProc("A", ch_in, a_to_b, p.get()).status());
+    for (auto [name, in, out] : {std::tuple{"B", a_to_b, b_to_c},
+                                 std::tuple{"C", b_to_c, ch_out}}) {
+      // Receives every other tick and sends the sum of the last two values
+      // received.
+      TokenlessProcBuilder b(name, "tkn", p.get());
+      BValue st = b.StateElement("st", Value(UBits(0, 1)));
+      BValue prev = b.StateElement("prev", Value(UBits(0, 32)));
+      BValue x = b.ReceiveIf(in, st);
+      b.SendIf(out, st, b.Add(x, prev));
+      XLS_RETURN_IF_ERROR(
+          b.Build({b.Not(st), b.Select(st, {prev, x})}).status());
+    }
+    return p;
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> on_demand,
+                           make_package());
+  ASSERT_THAT(Run(on_demand.get(), /*top=*/"A"), IsOkAndHolds(true));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> eager, make_package());
+  ASSERT_THAT(Run(eager.get(), /*top=*/"A", /*always_build_bdd=*/true),
+              IsOkAndHolds(true));
+
+  EXPECT_EQ(on_demand->DumpIr(), eager->DumpIr());
+  XLS_EXPECT_OK(EvalAndExpect(on_demand.get(), {{"in", {1, 2, 3, 4}}},
+                              {{"out", {1, 4, 8, 12}}})
+                    .status());
+}
+
 }  // namespace
 }  // namespace xls
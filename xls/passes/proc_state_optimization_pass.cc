@@ -14,6 +14,14 @@
 
 #include "xls/passes/proc_state_optimization_pass.h"
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/numeric/bits.h"
 #include "absl/strings/str_join.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
@@ -106,30 +114,55 @@ class StateDependencyVisitor : public DataFlowVisitor<InlineBitmap> {
   Proc* proc_;
 };
 
-// Computes which state elements each node is dependent upon. Dependence is
-// represented as a bit-vector with one bit per state element in the proc.
-// Dependencies are only computed in a single forward pass so dependencies
-// through the proc back edge are not considered.
+// Calls `f` with the index of each bit set in `bitmap`, in ascending order.
+template <typename F>
+void ForEachSetBit(const InlineBitmap& bitmap, F f) {
+  for (int64_t wordno = 0; wordno < bitmap.word_count(); ++wordno) {
+    uint64_t word = bitmap.GetWord(wordno);
+    while (word != 0) {
+      f(wordno * 64 + absl::countr_zero(word));
+      word &= word - 1;
+    }
+  }
+}
+
+// Returns the names of the state elements whose bits are set in `bitmap`.
+std::vector<std::string> StateElementNames(Proc* proc,
+                                           const InlineBitmap& bitmap) {
+  std::vector<std::string> names;
+  ForEachSetBit(bitmap, [&](int64_t i) {
+    names.push_back(proc->GetStateParam(i)->GetName());
+  });
+  return names;
+}
+
+// Computes which state elements the side-effecting nodes and the next-state
+// nodes of the proc are dependent upon; these are the only nodes through which
+// a state element can be observed. Dependence is represented as a bit-vector
+// with one bit per state element in the proc. Dependencies are only computed in
+// a single forward pass so dependencies through the proc back edge are not
+// considered.
 absl::StatusOr<absl::flat_hash_map<Node*, InlineBitmap>>
 ComputeStateDependencies(Proc* proc) {
   StateDependencyVisitor visitor(proc);
   XLS_RETURN_IF_ERROR(proc->Accept(&visitor));
+  absl::flat_hash_set<Node*> next_state_nodes(proc->NextState().begin(),
+                                              proc->NextState().end());
   absl::flat_hash_map<Node*, InlineBitmap> state_dependencies;
   for (Node* node : proc->nodes()) {
-    state_dependencies.insert({node, visitor.FlattenNodeBitmaps(node)});
+    if ((OpIsSideEffecting(node->op()) && !node->Is<Param>()) ||
+        next_state_nodes.contains(node)) {
+      state_dependencies.insert({node, visitor.FlattenNodeBitmaps(node)});
+    }
   }
   if (XLS_VLOG_IS_ON(3)) {
     XLS_VLOG(3) << "State dependencies (** side-effecting operation):";
     for (Node* node : TopoSort(proc)) {
-      std::vector<std::string> dependent_elements;
-      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
-        if (state_dependencies.at(node).Get(i)) {
-          dependent_elements.push_back(proc->GetStateParam(i)->GetName());
-        }
-      }
-      XLS_VLOG(3) << absl::StrFormat("  %s : {%s}%s", node->GetName(),
-                                     absl::StrJoin(dependent_elements, ", "),
-                                     OpIsSideEffecting(node->op()) ? "**" : "");
+      XLS_VLOG(3) << absl::StrFormat(
+          "  %s : {%s}%s", node->GetName(),
+          absl::StrJoin(
+              StateElementNames(proc, visitor.FlattenNodeBitmaps(node)), ", "),
+          OpIsSideEffecting(node->op()) ? "**" : "");
     }
   }
   return std::move(state_dependencies);
@@ -138,15 +171,26 @@ ComputeStateDependencies(Proc* proc) {
 // Removes unobservable state elements. A state element X is observable if:
 //   (1) a side-effecting operation depends on X, OR
 //   (2) the next-state value of an observable state element depends on X.
+//
+// The dependencies of all state elements are computed in one shared pass over
+// the proc and combined a word of the bit-vectors at a time, rather than
+// testing every state element at every node.
 absl::StatusOr<bool> RemoveUnobservableStateElements(Proc* proc) {
   absl::flat_hash_map<Node*, InlineBitmap> state_dependencies;
   XLS_ASSIGN_OR_RETURN(state_dependencies, ComputeStateDependencies(proc));
 
-  // Map from node to the state element indices for which the node is the
-  // next-state value.
-  absl::flat_hash_map<Node*, std::vector<int64_t>> next_state_indices;
-  for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
-    next_state_indices[proc->GetNextStateElement(i)].push_back(i);
+  // The state elements which side-effecting operations depend upon.
+  InlineBitmap observed(proc->GetStateElementCount());
+  for (Node* node : proc->nodes()) {
+    if (OpIsSideEffecting(node->op()) && !node->Is<Param>()) {
+      const InlineBitmap& dependencies = state_dependencies.at(node);
+      XLS_VLOG(4) << absl::StreamFormat(
+          "State elements {%s} are observable because side-effecting node "
+          "`%s` depends on them",
+          absl::StrJoin(StateElementNames(proc, dependencies), ", "),
+          node->GetName());
+      observed.Union(dependencies);
+    }
   }
 
   // The equivalence classes of state element indices. State element X is in the
@@ -162,46 +206,28 @@ absl::StatusOr<bool> RemoveUnobservableStateElements(Proc* proc) {
   // won't have a way to represent the equivalence class until it contains at
   // least one value, so we use `std::optional`.
   std::optional<int64_t> observable_state_index;
-
-  // Merge state elements which depend on each other and identify observable
-  // state indices.
-  for (Node* node : proc->nodes()) {
-    if (OpIsSideEffecting(node->op()) && !node->Is<Param>()) {
-      // `node` is side-effecting. All state elements that `node` is dependent
-      // on are observable.
-      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
-        if (state_dependencies.at(node).Get(i)) {
-          XLS_VLOG(4) << absl::StreamFormat(
-              "State element `%s` (%d) is observable because side-effecting "
-              "node `%s` depends on it",
-              proc->GetStateParam(i)->GetName(), i, node->GetName());
-          if (!observable_state_index.has_value()) {
-            observable_state_index = i;
-          } else {
-            state_components.Union(i, observable_state_index.value());
-          }
-        }
-      }
-    }
-    if (next_state_indices.contains(node)) {
-      for (int64_t next_state_index : next_state_indices.at(node)) {
-        // `node` is the next state node for state element with index
-        // `next_state_index`. Union `next_state_index` with each state index
-        // that `node` is dependent on.
-        for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
-          if (state_dependencies.at(node).Get(i)) {
-            XLS_VLOG(4) << absl::StreamFormat(
-                "Unioning state elements `%s` (%d) and `%s` (%d) because next "
-                "state of `%s` (node `%s`) depends on `%s`",
-                proc->GetStateParam(next_state_index)->GetName(),
-                next_state_index, proc->GetStateParam(i)->GetName(), i,
-                proc->GetStateParam(next_state_index)->GetName(),
-                node->GetName(), proc->GetStateParam(i)->GetName());
-            state_components.Union(i, next_state_index);
-          }
-        }
-      }
+  ForEachSetBit(observed, [&](int64_t i) {
+    if (!observable_state_index.has_value()) {
+      observable_state_index = i;
+    } else {
+      state_components.Union(i, observable_state_index.value());
     }
+  });
+
+  // Merge state elements which depend on each other.
+  for (int64_t next_state_index = 0;
+       next_state_index < proc->GetStateElementCount(); ++next_state_index) {
+    Node* node = proc->GetNextStateElement(next_state_index);
+    const InlineBitmap& dependencies = state_dependencies.at(node);
+    XLS_VLOG(4) << absl::StreamFormat(
+        "Unioning state element `%s` (%d) with {%s} because its next state "
+        "(node `%s`) depends on them",
+        proc->GetStateParam(next_state_index)->GetName(), next_state_index,
+        absl::StrJoin(StateElementNames(proc, dependencies), ", "),
+        node->GetName());
+    ForEachSetBit(dependencies, [&](int64_t i) {
+      state_components.Union(i, next_state_index);
+    });
   }
   if (observable_state_index.has_value()) {
     // Set to the representative value of the union-find data structure.
@@ -30,6 +30,8 @@ class ProcStateOptimizationPass : public ProcPass {
       : ProcPass("proc_state_opt", "Proc State Optimization") {}
   ~ProcStateOptimizationPass() override = default;
 
+  bool IsExpensive() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnProcInternal(Proc* proc, const PassOptions& options,
                                          PassResults* results) const override;
@@ -17,6 +17,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
@@ -125,6 +126,36 @@ TEST_F(ProcStateOptimizationPassTest, CrissCrossDeadAndLiveElements) {
   EXPECT_THAT(proc->StateParams(), ElementsAre(a.node(), b.node(), c.node()));
 }
 
+TEST_F(ProcStateOptimizationPassTest, ManyStateElements) {
+  // Two chains of state elements spanning several words of the dependency
+  // bit-vectors. Only the first chain feeds a send.
+  constexpr int64_t kChainLength = 150;
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+
+  TokenlessProcBuilder pb("p", "tkn", p.get());
+  std::vector<BValue> state;
+  for (int64_t i = 0; i < 2 * kChainLength; ++i) {
+    state.push_back(pb.StateElement(absl::StrCat("s", i), Value(UBits(0, 32))));
+  }
+  pb.Send(out, state[0]);
+  std::vector<BValue> next_state;
+  for (int64_t i = 0; i < 2 * kChainLength; ++i) {
+    next_state.push_back((i + 1) % kChainLength == 0 ? pb.Not(state[i])
+                                                     : state[i + 1]);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build(next_state));
+
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  ASSERT_EQ(proc->GetStateElementCount(), kChainLength);
+  for (int64_t i = 0; i < kChainLength; ++i) {
+    EXPECT_EQ(proc->GetStateParam(i), state[i].node());
+  }
+}
+
 TEST_F(ProcStateOptimizationPassTest, ProcWithZeroWidthElement) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(
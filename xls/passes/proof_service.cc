@@ -0,0 +1,275 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proof_service.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+#include "xls/solvers/z3_ir_translator.h"
+
+namespace xls {
+namespace {
+
+// Returns true if `node` is not copied into cones but is replaced by a
+// parameter. Nodes with side effects and nodes referring to other functions
+// cannot be copied into a standalone function.
+bool IsLeaf(Node* node) {
+  return node->Is<Param>() || OpIsSideEffecting(node->op()) ||
+         node->Is<Invoke>() || node->Is<Map>() || node->Is<CountedFor>() ||
+         node->Is<DynamicCountedFor>();
+}
+
+}  // namespace
+
+ProofService::ProofService(int64_t thread_count, absl::Duration timeout,
+                           int64_t max_cone_size)
+    : timeout_(timeout), max_cone_size_(max_cone_size) {
+  for (int64_t i = 0; i < std::max<int64_t>(thread_count, 1); ++i) {
+    workers_.push_back(std::make_unique<Thread>([this]() { WorkerLoop(); }));
+  }
+}
+
+ProofService::~ProofService() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutting_down_ = true;
+  }
+  // The destructors of the workers join the threads.
+  workers_.clear();
+}
+
+absl::StatusOr<ProofAnswer> ProofService::IsAlwaysZero(Node* node) {
+  return Query(QueryKind::kAlwaysZero, node, nullptr, nullptr);
+}
+
+absl::StatusOr<ProofAnswer> ProofService::IsNeverZero(Node* node) {
+  return Query(QueryKind::kNeverZero, node, nullptr, nullptr);
+}
+
+absl::StatusOr<ProofAnswer> ProofService::IsNeverEqualTo(Node* node,
+                                                         const Bits& value) {
+  return Query(QueryKind::kNeverEqualTo, node, nullptr, &value);
+}
+
+absl::StatusOr<ProofAnswer> ProofService::AreEquivalent(Node* a, Node* b) {
+  return Query(QueryKind::kEquivalent, a, b, nullptr);
+}
+
+absl::StatusOr<ProofAnswer> ProofService::Implies(Node* a, Node* b) {
+  return Query(QueryKind::kImplies, a, b, nullptr);
+}
+
+absl::StatusOr<ProofAnswer> ProofService::Query(QueryKind kind, Node* a,
+                                                Node* b, const Bits* value) {
+  XLS_RET_CHECK(a->GetType()->IsBits()) << a->ToString();
+  if (b != nullptr) {
+    XLS_RET_CHECK_EQ(a->GetType(), b->GetType());
+  }
+  if (kind == QueryKind::kNeverEqualTo) {
+    XLS_RET_CHECK_EQ(a->BitCountOrDie(), value->bit_count());
+  }
+  if (kind == QueryKind::kImplies) {
+    XLS_RET_CHECK_EQ(a->BitCountOrDie(), 1);
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ExtractCone(kind, a, b, value));
+  XLS_ASSIGN_OR_RETURN(Function * cone, package->GetFunction("cone"));
+  bool claim_zero =
+      kind == QueryKind::kAlwaysZero || kind == QueryKind::kNeverEqualTo;
+  std::string key =
+      absl::StrCat(claim_zero ? "zero\n" : "nonzero\n", cone->DumpIr());
+
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = answers_.insert({key, ProofAnswer::kPending});
+  if (!inserted) {
+    return it->second;
+  }
+  jobs_.push_back(Job{.key = std::move(key),
+                      .package = std::move(package),
+                      .claim_zero = claim_zero});
+  ++pending_count_;
+  return ProofAnswer::kPending;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ProofService::ExtractCone(
+    QueryKind kind, Node* a, Node* b, const Bits* value) {
+  // Gather the cone in operand-first order, copying at most `max_cone_size_`
+  // nodes. The order depends only on the structure of the cone so equivalent
+  // cones produce identical functions.
+  std::vector<Node*> order;
+  absl::flat_hash_set<Node*> visited;
+  absl::flat_hash_set<Node*> leaves;
+  int64_t interior_count = 0;
+  // Each entry is a node and the index of its next operand to visit.
+  std::vector<std::pair<Node*, int64_t>> stack;
+  auto visit = [&](Node* node) {
+    if (!visited.insert(node).second) {
+      return;
+    }
+    if (IsLeaf(node) || interior_count >= max_cone_size_) {
+      leaves.insert(node);
+      order.push_back(node);
+      return;
+    }
+    ++interior_count;
+    stack.push_back({node, 0});
+  };
+  for (Node* root : {a, b}) {
+    if (root == nullptr) {
+      continue;
+    }
+    visit(root);
+    while (!stack.empty()) {
+      Node* node = stack.back().first;
+      int64_t operand_no = stack.back().second++;
+      if (operand_no < node->operand_count()) {
+        visit(node->operand(operand_no));
+      } else {
+        order.push_back(node);
+        stack.pop_back();
+      }
+    }
+  }
+
+  auto package = std::make_unique<Package>("proof_cone");
+  Function* cone =
+      package->AddFunction(std::make_unique<Function>("cone", package.get()));
+  absl::flat_hash_map<Node*, Node*> clones;
+  int64_t leaf_count = 0;
+  for (Node* node : order) {
+    if (leaves.contains(node)) {
+      XLS_ASSIGN_OR_RETURN(Type * type,
+                           package->MapTypeFromOtherPackage(node->GetType()));
+      XLS_ASSIGN_OR_RETURN(
+          clones[node],
+          cone->MakeNodeWithName<Param>(
+              SourceInfo(), absl::StrCat("leaf", leaf_count++), type));
+      continue;
+    }
+    std::vector<Node*> new_operands;
+    for (Node* operand : node->operands()) {
+      new_operands.push_back(clones.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(Node * clone,
+                         node->CloneInNewFunction(new_operands, cone));
+    // Names and locations do not affect the claim; clear them so they do not
+    // affect the cache key.
+    clone->ClearName();
+    clone->SetLoc(SourceInfo());
+    clones[node] = clone;
+  }
+
+  Node* result = clones.at(a);
+  switch (kind) {
+    case QueryKind::kAlwaysZero:
+    case QueryKind::kNeverZero:
+      break;
+    case QueryKind::kNeverEqualTo: {
+      XLS_ASSIGN_OR_RETURN(
+          Node * literal, cone->MakeNode<Literal>(SourceInfo(), Value(*value)));
+      XLS_ASSIGN_OR_RETURN(result, cone->MakeNode<CompareOp>(
+                                       SourceInfo(), result, literal, Op::kEq));
+      break;
+    }
+    case QueryKind::kEquivalent: {
+      XLS_ASSIGN_OR_RETURN(
+          result, cone->MakeNode<CompareOp>(SourceInfo(), result, clones.at(b),
+                                            Op::kEq));
+      break;
+    }
+    case QueryKind::kImplies: {
+      XLS_ASSIGN_OR_RETURN(
+          Node * not_a, cone->MakeNode<UnOp>(SourceInfo(), result, Op::kNot));
+      XLS_ASSIGN_OR_RETURN(
+          result, cone->MakeNode<NaryOp>(
+                      SourceInfo(), std::vector<Node*>{not_a, clones.at(b)},
+                      Op::kOr));
+      break;
+    }
+  }
+  XLS_RETURN_IF_ERROR(cone->set_return_value(result));
+  return package;
+}
+
+void ProofService::WorkerLoop() {
+  auto has_work = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return shutting_down_ || !jobs_.empty();
+  };
+  while (true) {
+    Job job;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(&has_work));
+      if (shutting_down_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    Function* cone = job.package->GetFunction("cone").value();
+    absl::StatusOr<bool> proven = solvers::z3::TryProve(
+        cone, cone->return_value(),
+        job.claim_zero ? solvers::z3::Predicate::EqualToZero()
+                       : solvers::z3::Predicate::NotEqualToZero(),
+        timeout_);
+    if (!proven.ok()) {
+      XLS_VLOG(2) << "Unable to prove claim: " << proven.status();
+    }
+    absl::MutexLock lock(&mutex_);
+    answers_[job.key] = (proven.ok() && proven.value())
+                            ? ProofAnswer::kProven
+                            : ProofAnswer::kUnproven;
+    --pending_count_;
+  }
+}
+
+bool ProofService::WaitForPending(absl::Duration timeout) {
+  auto done = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+    return pending_count_ == 0;
+  };
+  absl::MutexLock lock(&mutex_);
+  return mutex_.AwaitWithTimeout(absl::Condition(&done), timeout);
+}
+
+int64_t ProofService::answer_count() const {
+  absl::MutexLock lock(&mutex_);
+  return answers_.size() - pending_count_;
+}
+
+int64_t ProofService::proven_count() const {
+  absl::MutexLock lock(&mutex_);
+  return std::count_if(answers_.begin(), answers_.end(), [](const auto& entry) {
+    return entry.second == ProofAnswer::kProven;
+  });
+}
+
+}  // namespace xls
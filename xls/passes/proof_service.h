@@ -0,0 +1,142 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PROOF_SERVICE_H_
+#define XLS_PASSES_PROOF_SERVICE_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "xls/common/thread.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// The answer to a query of a ProofService.
+enum class ProofAnswer {
+  // The query has been submitted but not yet answered.
+  kPending,
+  // The claim holds for all values of the leaves of the cone.
+  kProven,
+  // The claim was disproven, the solver timed out or the cone could not be
+  // translated.
+  kUnproven,
+};
+
+// A service which proves claims about the values of nodes with Z3 on a pool of
+// worker threads so that passes need not wait on the solver.
+//
+// A claim is made about the cone of logic feeding the queried nodes. The cone
+// is copied into a standalone function whose parameters are the leaves of the
+// cone (parameters, side-effecting nodes and the nodes beyond the size limit)
+// so the claim holds for the queried nodes if it holds for the cone. Answers
+// are cached by the structure of the cone, so a claim about an equivalent cone
+// in a later fixed point iteration, in another function or in a later run of
+// the pipeline with the same service is answered from the cache.
+//
+// Queries return kPending the first time they are made; the caller is
+// expected to repeat the query (for example in a later fixed point iteration)
+// once the answer is available. Each query may spend at most the given
+// timeout in the solver.
+//
+// The methods are thread-safe. Queries read only the graph of the queried
+// nodes so passes may query nodes of different function bases concurrently.
+class ProofService {
+ public:
+  ProofService(int64_t thread_count, absl::Duration timeout,
+               int64_t max_cone_size = 64);
+  ~ProofService();
+
+  // Queries whether `node` (which must be bits-typed) is always zero or never
+  // zero, respectively.
+  absl::StatusOr<ProofAnswer> IsAlwaysZero(Node* node);
+  absl::StatusOr<ProofAnswer> IsNeverZero(Node* node);
+
+  // Queries whether `node` (which must be bits-typed) never has the value
+  // `value`.
+  absl::StatusOr<ProofAnswer> IsNeverEqualTo(Node* node, const Bits& value);
+
+  // Queries whether `a` and `b` always have the same value.
+  absl::StatusOr<ProofAnswer> AreEquivalent(Node* a, Node* b);
+
+  // Queries whether `a` being one implies `b` is one. `a` and `b` must be
+  // single bits.
+  absl::StatusOr<ProofAnswer> Implies(Node* a, Node* b);
+
+  // Blocks until all submitted queries are answered or `timeout` has
+  // elapsed. Returns true if all queries were answered.
+  bool WaitForPending(absl::Duration timeout);
+
+  // Returns the number of cached answers and the number of those which are
+  // proofs.
+  int64_t answer_count() const;
+  int64_t proven_count() const;
+
+  absl::Duration timeout() const { return timeout_; }
+
+ private:
+  enum class QueryKind {
+    kAlwaysZero,
+    kNeverZero,
+    kNeverEqualTo,
+    kEquivalent,
+    kImplies,
+  };
+
+  // A cone awaiting a worker. The claim is always that the return value of
+  // the function in `package` is zero or is never zero.
+  struct Job {
+    std::string key;
+    std::unique_ptr<Package> package;
+    bool claim_zero;
+  };
+
+  absl::StatusOr<ProofAnswer> Query(QueryKind kind, Node* a, Node* b,
+                                    const Bits* value);
+
+  // Returns a package containing a function named "cone" computing the claim
+  // of the query from a copy of the cones of `a` and `b` (if not null).
+  absl::StatusOr<std::unique_ptr<Package>> ExtractCone(QueryKind kind, Node* a,
+                                                       Node* b,
+                                                       const Bits* value);
+
+  void WorkerLoop();
+
+  absl::Duration timeout_;
+  int64_t max_cone_size_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, ProofAnswer> answers_
+      ABSL_GUARDED_BY(mutex_);
+  std::deque<Job> jobs_ ABSL_GUARDED_BY(mutex_);
+  // The number of submitted queries not yet answered.
+  int64_t pending_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutting_down_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::vector<std::unique_ptr<Thread>> workers_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PROOF_SERVICE_H_
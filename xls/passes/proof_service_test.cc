@@ -0,0 +1,113 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proof_service.h"
+
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class ProofServiceTest : public IrTestBase {};
+
+TEST_F(ProofServiceTest, AnswersAreCachedByConeStructure) {
+  auto p = CreatePackage();
+  ProofService service(/*thread_count=*/2, /*timeout=*/absl::Seconds(10));
+
+  // Bit 1 of the square of a number is always zero.
+  auto build = [&](std::string_view name) {
+    FunctionBuilder fb(name, p.get());
+    BValue x = fb.Param(absl::StrCat(name, "_x"), p->GetBitsType(8));
+    fb.BitSlice(fb.UMul(x, x), /*start=*/1, /*width=*/1);
+    return fb.Build().value();
+  };
+  Function* f = build("f");
+  EXPECT_THAT(service.IsAlwaysZero(f->return_value()),
+              IsOkAndHolds(ProofAnswer::kPending));
+  EXPECT_THAT(service.IsAlwaysZero(f->return_value()),
+              IsOkAndHolds(ProofAnswer::kPending));
+  ASSERT_TRUE(service.WaitForPending(absl::Seconds(30)));
+  EXPECT_THAT(service.IsAlwaysZero(f->return_value()),
+              IsOkAndHolds(ProofAnswer::kProven));
+  EXPECT_THAT(service.IsNeverZero(f->return_value()),
+              IsOkAndHolds(ProofAnswer::kPending));
+  ASSERT_TRUE(service.WaitForPending(absl::Seconds(30)));
+  EXPECT_THAT(service.IsNeverZero(f->return_value()),
+              IsOkAndHolds(ProofAnswer::kUnproven));
+  EXPECT_EQ(service.answer_count(), 2);
+  EXPECT_EQ(service.proven_count(), 1);
+
+  // The same cone with different names in another function is answered from
+  // the cache.
+  Function* g = build("g");
+  EXPECT_THAT(service.IsAlwaysZero(g->return_value()),
+              IsOkAndHolds(ProofAnswer::kProven));
+  EXPECT_EQ(service.answer_count(), 2);
+}
+
+TEST_F(ProofServiceTest, EquivalenceAndImplication) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y);
+  BValue reversed_sum = fb.Add(y, x);
+  BValue difference = fb.Subtract(x, y);
+  BValue x_is_zero = fb.Eq(x, fb.Literal(UBits(0, 8)));
+  BValue x_is_small = fb.ULt(x, fb.Literal(UBits(4, 8)));
+  fb.Tuple({sum, reversed_sum, difference, x_is_zero, x_is_small});
+  XLS_ASSERT_OK(fb.Build().status());
+
+  ProofService service(/*thread_count=*/1, /*timeout=*/absl::Seconds(10));
+  auto answer = [&](auto query) {
+    EXPECT_THAT(query(), IsOkAndHolds(ProofAnswer::kPending));
+    EXPECT_TRUE(service.WaitForPending(absl::Seconds(30)));
+    return query().value();
+  };
+  EXPECT_EQ(answer([&]() {
+              return service.AreEquivalent(sum.node(), reversed_sum.node());
+            }),
+            ProofAnswer::kProven);
+  EXPECT_EQ(answer([&]() {
+              return service.AreEquivalent(sum.node(), difference.node());
+            }),
+            ProofAnswer::kUnproven);
+  EXPECT_EQ(answer([&]() {
+              return service.Implies(x_is_zero.node(), x_is_small.node());
+            }),
+            ProofAnswer::kProven);
+  EXPECT_EQ(answer([&]() {
+              return service.Implies(x_is_small.node(), x_is_zero.node());
+            }),
+            ProofAnswer::kUnproven);
+  EXPECT_EQ(answer([&]() {
+              return service.IsNeverEqualTo(x.node(), UBits(42, 8));
+            }),
+            ProofAnswer::kUnproven);
+}
+
+}  // namespace
+}  // namespace xls
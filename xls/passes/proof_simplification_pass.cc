@@ -0,0 +1,130 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proof_simplification_pass.h"
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_helpers.h"
+#include "xls/passes/proof_service.h"
+
+namespace xls {
+namespace {
+
+// The maximum number of unanswered claims per run on a function base so large
+// functions do not flood the service. Claims already answered do not count,
+// so later runs get past the nodes whose claims were settled earlier.
+constexpr int64_t kMaxPendingQueriesPerRun = 256;
+
+// Simplifies `f` with the claims proven by `service`. Sets `pending` if any of
+// the claims queried are not yet answered.
+absl::StatusOr<bool> ApplyProofs(FunctionBase* f, ProofService& service,
+                                 bool* pending) {
+  bool changed = false;
+  int64_t pending_count = 0;
+  auto proven = [&](absl::StatusOr<ProofAnswer> answer)
+      -> absl::StatusOr<bool> {
+    XLS_RETURN_IF_ERROR(answer.status());
+    if (answer.value() == ProofAnswer::kPending) {
+      ++pending_count;
+      *pending = true;
+    }
+    return answer.value() == ProofAnswer::kProven;
+  };
+  for (Node* node : TopoSort(f)) {
+    if (pending_count >= kMaxPendingQueriesPerRun) {
+      break;
+    }
+    if (node->Is<Literal>() || node->Is<Param>() ||
+        OpIsSideEffecting(node->op()) ||
+        (node->users().empty() && !f->HasImplicitUse(node))) {
+      continue;
+    }
+
+    if (node->GetType()->IsBits() && node->BitCountOrDie() == 1) {
+      for (bool value : {false, true}) {
+        XLS_ASSIGN_OR_RETURN(bool is_constant,
+                             proven(value ? service.IsNeverZero(node)
+                                          : service.IsAlwaysZero(node)));
+        if (is_constant) {
+          XLS_VLOG(3) << "Proved " << node->GetName() << " is always "
+                      << value;
+          XLS_RETURN_IF_ERROR(
+              node->ReplaceUsesWithNew<Literal>(Value(UBits(value, 1)))
+                  .status());
+          changed = true;
+          break;
+        }
+      }
+      continue;
+    }
+
+    // Replace the arms of selects which are never selected with zero.
+    if (node->Is<Select>() && !node->As<Select>()->selector()->Is<Literal>()) {
+      Select* select = node->As<Select>();
+      Node* selector = select->selector();
+      for (int64_t i = 0; i < select->cases().size(); ++i) {
+        Node* arm = select->get_case(i);
+        if (arm->Is<Literal>()) {
+          continue;
+        }
+        XLS_ASSIGN_OR_RETURN(
+            bool unreachable,
+            proven(service.IsNeverEqualTo(
+                selector, UBits(i, selector->BitCountOrDie()))));
+        if (unreachable) {
+          XLS_VLOG(3) << "Proved case " << i << " of " << select->GetName()
+                      << " is never selected";
+          XLS_ASSIGN_OR_RETURN(Literal * zero,
+                               f->MakeNode<Literal>(
+                                   select->loc(), ZeroOfType(arm->GetType())));
+          XLS_RETURN_IF_ERROR(select->ReplaceOperandNumber(i + 1, zero));
+          changed = true;
+        }
+      }
+    }
+  }
+  return changed;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ProofSimplificationPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const PassOptions& options, PassResults* results) const {
+  if (options.proof_service == nullptr) {
+    return false;
+  }
+  ProofService& service = *options.proof_service;
+  bool pending = false;
+  XLS_ASSIGN_OR_RETURN(bool changed, ApplyProofs(f, service, &pending));
+  if (!changed && pending) {
+    // Nothing else may change in the enclosing fixed point pass, in which case
+    // answers arriving later would go unused. Wait (at most as long as a single
+    // query may take) for the outstanding answers and apply them.
+    service.WaitForPending(service.timeout());
+    pending = false;
+    XLS_ASSIGN_OR_RETURN(changed, ApplyProofs(f, service, &pending));
+  }
+  return changed;
+}
+
+}  // namespace xls
@@ -0,0 +1,44 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PROOF_SIMPLIFICATION_PASS_H_
+#define XLS_PASSES_PROOF_SIMPLIFICATION_PASS_H_
+
+#include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/passes.h"
+
+namespace xls {
+
+// Pass which simplifies the IR with facts proven by the proof service of the
+// pipeline (PassOptions::proof_service) which ternary and range analysis
+// cannot establish: single-bit nodes which are constant and select arms which
+// are unreachable. Claims are submitted to the service as they are found and
+// applied once proven, generally in a later iteration of the enclosing fixed
+// point pass. Does nothing if the pipeline has no proof service.
+class ProofSimplificationPass : public FunctionBasePass {
+ public:
+  ProofSimplificationPass()
+      : FunctionBasePass("proof_simp", "Proof-based simplification") {}
+  ~ProofSimplificationPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const PassOptions& options,
+      PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PROOF_SIMPLIFICATION_PASS_H_
@@ -0,0 +1,125 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/proof_simplification_pass.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/proof_service.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using status_testing::IsOkAndHolds;
+
+class ProofSimplificationPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Function* f, ProofService* service) {
+    PassOptions options;
+    options.proof_service = service;
+    PassResults results;
+    XLS_ASSIGN_OR_RETURN(
+        bool changed,
+        ProofSimplificationPass().RunOnFunctionBase(f, options, &results));
+    XLS_RETURN_IF_ERROR(DeadCodeEliminationPass()
+                            .RunOnFunctionBase(f, PassOptions(), &results)
+                            .status());
+    return changed;
+  }
+};
+
+TEST_F(ProofSimplificationPassTest, NoProofService) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.BitSlice(fb.UMul(x, x), /*start=*/1, /*width=*/1);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  EXPECT_THAT(Run(f, /*service=*/nullptr), IsOkAndHolds(false));
+}
+
+TEST_F(ProofSimplificationPassTest, ConstantBit) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  // Bit 1 of the square of a number is always zero.
+  BValue bit = fb.BitSlice(fb.UMul(x, x), /*start=*/1, /*width=*/1);
+  fb.Concat({bit, fb.BitSlice(x, /*start=*/0, /*width=*/1)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ProofService service(/*thread_count=*/2, /*timeout=*/absl::Seconds(10));
+  EXPECT_THAT(Run(f, &service), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Concat(m::Literal(0), m::BitSlice(m::Param("x"))));
+  EXPECT_THAT(Run(f, &service), IsOkAndHolds(false));
+}
+
+TEST_F(ProofSimplificationPassTest, UnreachableSelectArms) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(4));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  // The square of a four-bit number modulo 16 is 0, 1, 4 or 9, so bits 1 and 2
+  // of the square are never 1 or 3.
+  BValue selector = fb.BitSlice(fb.UMul(x, x), /*start=*/1, /*width=*/2);
+  fb.Select(selector, {fb.Not(y), fb.Negate(y), fb.Identity(y), fb.Reverse(y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ProofService service(/*thread_count=*/2, /*timeout=*/absl::Seconds(10));
+  EXPECT_THAT(Run(f, &service), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Select(m::BitSlice(),
+                        /*cases=*/{m::Not(), m::Literal(0), m::Identity(),
+                                   m::Literal(0)}));
+}
+
+TEST_F(ProofSimplificationPassTest, AnsweredClaimsDoNotLimitLaterRuns) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(300));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  // More unprovable claims come first in topological order than a single run
+  // may leave pending.
+  std::vector<BValue> bits;
+  for (int64_t i = 0; i < 300; ++i) {
+    bits.push_back(fb.BitSlice(x, /*start=*/i, /*width=*/1));
+  }
+  bits.push_back(fb.BitSlice(fb.UMul(y, y), /*start=*/1, /*width=*/1));
+  fb.Concat(bits);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ProofService service(/*thread_count=*/2, /*timeout=*/absl::Seconds(10));
+  bool changed = false;
+  for (int64_t run = 0; run < 4 && !changed; ++run) {
+    XLS_ASSERT_OK_AND_ASSIGN(changed, Run(f, &service));
+  }
+  EXPECT_TRUE(changed);
+  EXPECT_THAT(f->return_value()->operands().back(), m::Literal(0));
+}
+
+}  // namespace
+}  // namespace xls
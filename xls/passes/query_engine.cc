@@ -14,7 +14,14 @@
 
 #include "xls/passes/query_engine.h"
 
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/ternary.h"
 
@@ -207,4 +214,58 @@ std::string QueryEngine::ToString(Node* node) const {
   return xls::ToString(GetTernary(node).Get({}));
 }
 
+/* static */ absl::StatusOr<ReachedFixpoint> QueryEngine::UpdateForwardCone(
+    absl::Span<Node* const> changed,
+    absl::FunctionRef<absl::StatusOr<bool>(Node*)> reevaluate) {
+  // Gather the forward cone of the changed nodes.
+  absl::flat_hash_set<Node*> cone(changed.begin(), changed.end());
+  std::vector<Node*> worklist(changed.begin(), changed.end());
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* user : node->users()) {
+      if (cone.insert(user).second) {
+        worklist.push_back(user);
+      }
+    }
+  }
+
+  // Visit the cone in topological order, counting for each node the operands
+  // in the cone which have not been visited yet.
+  absl::flat_hash_map<Node*, int64_t> pending_operands;
+  std::deque<Node*> ready;
+  for (Node* node : cone) {
+    absl::flat_hash_set<Node*> operands;
+    for (Node* operand : node->operands()) {
+      if (cone.contains(operand)) {
+        operands.insert(operand);
+      }
+    }
+    if (operands.empty()) {
+      ready.push_back(node);
+    } else {
+      pending_operands[node] = operands.size();
+    }
+  }
+  absl::flat_hash_set<Node*> dirty(changed.begin(), changed.end());
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  while (!ready.empty()) {
+    Node* node = ready.front();
+    ready.pop_front();
+    if (dirty.contains(node)) {
+      XLS_ASSIGN_OR_RETURN(bool node_changed, reevaluate(node));
+      if (node_changed) {
+        rf = ReachedFixpoint::Changed;
+        dirty.insert(node->users().begin(), node->users().end());
+      }
+    }
+    for (Node* user : node->users()) {
+      if (--pending_operands.at(user) == 0) {
+        ready.push_back(user);
+      }
+    }
+  }
+  return rf;
+}
+
 }  // namespace xls
@@ -15,7 +15,10 @@
 #ifndef XLS_PASSES_QUERY_ENGINE_H_
 #define XLS_PASSES_QUERY_ENGINE_H_
 
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
@@ -79,6 +82,21 @@ class QueryEngine {
 
   virtual absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) = 0;
 
+  // Updates the information held by the engine after the function base it was
+  // populated with has been mutated, which is much cheaper than populating a
+  // new engine. `changed` must include every node added or whose operands were
+  // changed since the engine was populated or last updated (for example,
+  // FunctionBase::changed_nodes) and no removed nodes. The information about
+  // these nodes is recomputed (rather than refined, so it may become less
+  // precise than after repeated calls to Populate) and the recomputation is
+  // propagated to users for as long as the information changes. Returns an
+  // error if the engine does not support incremental updates.
+  virtual absl::StatusOr<ReachedFixpoint> Update(
+      absl::Span<Node* const> changed) {
+    return absl::UnimplementedError(
+        "Query engine does not support incremental updates");
+  }
+
   // Returns whether any information is available for this node.
   virtual bool IsTracked(Node* node) const = 0;
 
@@ -192,6 +210,15 @@ class QueryEngine {
   // Returns the known bits information of the given node as a string of ternary
   // symbols (0, 1, or X) with a '0b' prefix. For example: 0b1XX0.
   std::string ToString(Node* node) const;
+
+ protected:
+  // Helper for implementations of Update. Calls `reevaluate` on the nodes in
+  // `changed` and on the users of every node for which `reevaluate` returns
+  // true (i.e., the information about the node changed), visiting the nodes in
+  // topological order. Only the forward cone of `changed` is traversed.
+  static absl::StatusOr<ReachedFixpoint> UpdateForwardCone(
+      absl::Span<Node* const> changed,
+      absl::FunctionRef<absl::StatusOr<bool>(Node*)> reevaluate);
 };
 
 }  // namespace xls
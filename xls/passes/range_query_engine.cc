@@ -15,6 +15,8 @@
 #include "xls/passes/range_query_engine.h"
 
 #include <limits>
+#include <optional>
+#include <utility>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
@@ -372,6 +374,28 @@ absl::StatusOr<ReachedFixpoint> RangeQueryEngine::Populate(FunctionBase* f) {
   return visitor.GetReachedFixpoint();
 }
 
+absl::StatusOr<ReachedFixpoint> RangeQueryEngine::Update(
+    absl::Span<Node* const> changed) {
+  RangeQueryVisitor visitor(this);
+  return UpdateForwardCone(changed, [&](Node* node) -> absl::StatusOr<bool> {
+    // Drop the information about the node so the visitor recomputes it from
+    // scratch rather than intersecting with the stale information.
+    std::optional<IntervalSetTree> old_interval_sets;
+    if (auto it = interval_sets_.find(node); it != interval_sets_.end()) {
+      old_interval_sets = std::move(it->second);
+      interval_sets_.erase(it);
+    }
+    known_bits_.erase(node);
+    known_bit_values_.erase(node);
+    XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
+    auto it = interval_sets_.find(node);
+    if (!old_interval_sets.has_value()) {
+      return it != interval_sets_.end();
+    }
+    return it == interval_sets_.end() || !(it->second == *old_interval_sets);
+  });
+}
+
 IntervalSetTree RangeQueryEngine::GetIntervalSetTree(Node* node) const {
   if (interval_sets_.contains(node)) {
     return interval_sets_.at(node);
@@ -690,16 +714,17 @@ absl::Status RangeQueryVisitor::HandleArray(Array* array) {
 
 absl::Status RangeQueryVisitor::HandleArrayConcat(ArrayConcat* array_concat) {
   engine_->InitializeNode(array_concat);
-  std::vector<LeafTypeTree<IntervalSet>> elements;
+  // The leaves of the result are those of the operands, in order.
+  std::vector<IntervalSet> elements;
   for (Node* element : array_concat->operands()) {
     LeafTypeTree<IntervalSet> concatee = GetIntervalSetTree(element);
-    const int64_t arr_size = element->GetType()->AsArrayOrDie()->size();
-    for (int32_t i = 0; i < arr_size; ++i) {
-      elements.push_back(concatee.CopySubtree({i}));
+    for (IntervalSet& interval_set : concatee.elements()) {
+      elements.push_back(std::move(interval_set));
     }
   }
-  SetIntervalSetTree(array_concat, LeafTypeTree<IntervalSet>(
-                                       array_concat->GetType(), elements));
+  SetIntervalSetTree(array_concat,
+                     LeafTypeTree<IntervalSet>(array_concat->GetType(),
+                                               absl::MakeSpan(elements)));
   return absl::OkStatus();
 }
 
@@ -925,9 +950,13 @@ absl::Status RangeQueryVisitor::HandleArrayIndex(ArrayIndex* array_index) {
         return false;
       }
     }
-    result = IntervalSetTree::Zip<IntervalSet, IntervalSet>(
-        IntervalSet::Combine, result,
-        array_interval_set_tree.CopySubtree(indexes));
+    LeafTypeTreeView<IntervalSet> element =
+        array_interval_set_tree.AsView(indexes);
+    XLS_CHECK_EQ(element.size(), result.size());
+    for (int64_t i = 0; i < result.size(); ++i) {
+      result.elements()[i] =
+          IntervalSet::Combine(result.elements()[i], element.elements()[i]);
+    }
     return false;
   });
 
@@ -1262,7 +1291,15 @@ absl::Status RangeQueryVisitor::HandleTuple(Tuple* tuple) {
 
 absl::Status RangeQueryVisitor::HandleTupleIndex(TupleIndex* index) {
   engine_->InitializeNode(index);
-  LeafTypeTree<IntervalSet> arg = GetIntervalSetTree(index->operand(0));
+  // View the operand's intervals in place when they are known, rather than
+  // copying the whole tuple to extract one element.
+  auto it = engine_->interval_sets_.find(index->operand(0));
+  if (it != engine_->interval_sets_.end()) {
+    SetIntervalSetTree(
+        index, IntervalSetTree(it->second.AsView({index->index()})));
+    return absl::OkStatus();
+  }
+  IntervalSetTree arg = GetIntervalSetTree(index->operand(0));
   SetIntervalSetTree(index, arg.CopySubtree({index->index()}));
   return absl::OkStatus();
 }
@@ -49,6 +49,9 @@ class RangeQueryEngine : public QueryEngine {
   // given `FunctionBase*`;
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  absl::StatusOr<ReachedFixpoint> Update(
+      absl::Span<Node* const> changed) override;
+
   bool IsTracked(Node* node) const override {
     return known_bits_.contains(node);
   }
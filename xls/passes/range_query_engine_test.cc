@@ -139,6 +139,40 @@ TEST_F(RangeQueryEngineTest, Add) {
             "[[0, 1048575]]");
 }
 
+TEST_F(RangeQueryEngineTest, Update) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.ZeroExtend(fb.Param("x", p->GetBitsType(4)), 8);
+  BValue sum = fb.Add(x, fb.Literal(UBits(16, 8)));
+  BValue other = fb.Add(fb.Param("y", p->GetBitsType(8)), x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Tuple({sum, other})));
+  RangeQueryEngine engine;
+  XLS_ASSERT_OK(engine.Populate(f));
+  EXPECT_EQ(IntervalSetTreeToString(engine.GetIntervalSetTree(sum.node())),
+            "[[16, 31]]");
+
+  f->SetChangeTrackingEnabled(true);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Literal * addend,
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(100, 8))));
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(1, addend));
+  std::vector<Node*> changed(f->changed_nodes().begin(),
+                             f->changed_nodes().end());
+  XLS_ASSERT_OK(engine.Update(changed));
+  EXPECT_EQ(IntervalSetTreeToString(engine.GetIntervalSetTree(sum.node())),
+            "[[100, 115]]");
+
+  // The updated engine agrees with an engine populated from scratch.
+  RangeQueryEngine fresh_engine;
+  XLS_ASSERT_OK(fresh_engine.Populate(f));
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(IntervalSetTreeToString(engine.GetIntervalSetTree(node)),
+              IntervalSetTreeToString(fresh_engine.GetIntervalSetTree(node)))
+        << node->GetName();
+  }
+}
+
 TEST_F(RangeQueryEngineTest, Array) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -30,6 +30,8 @@ class ReassociationPass : public FunctionBasePass {
   ReassociationPass() : FunctionBasePass("reassociation", "Reassociation") {}
   ~ReassociationPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
@@ -14,6 +14,7 @@
 
 #include "xls/passes/select_simplification_pass.h"
 
+#include <memory>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -928,8 +929,10 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
 absl::StatusOr<bool> SelectSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* func, const PassOptions& options,
     PassResults* results) const {
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<TernaryQueryEngine> shared_query_engine,
+      results->analyses.GetQueryEngine<TernaryQueryEngine>(func));
+  const TernaryQueryEngine& query_engine = *shared_query_engine;
   bool changed = false;
   for (Node* node : TopoSort(func)) {
     XLS_ASSIGN_OR_RETURN(bool node_changed,
@@ -40,6 +40,7 @@
 #include "xls/passes/proc_inlining_pass.h"
 #include "xls/passes/proc_state_flattening_pass.h"
 #include "xls/passes/proc_state_optimization_pass.h"
+#include "xls/passes/proof_simplification_pass.h"
 #include "xls/passes/ram_rewrite_pass.h"
 #include "xls/passes/reassociation_pass.h"
 #include "xls/passes/receive_default_value_simplification_pass.h"
@@ -95,6 +96,8 @@ SimplificationPass::SimplificationPass(int64_t opt_level)
   Add<DeadCodeEliminationPass>();
   Add<BooleanSimplificationPass>();
   Add<DeadCodeEliminationPass>();
+  Add<ProofSimplificationPass>();
+  Add<DeadCodeEliminationPass>();
   Add<CsePass>();
 }
 
@@ -14,10 +14,16 @@
 
 #include "xls/passes/standard_pipeline.h"
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/bits.h"
@@ -269,6 +275,67 @@ TEST_F(StandardPipelineTest, LogicCombining) {
   EXPECT_THAT(f->return_value(), m::Param("x"));
 }
 
+TEST_F(StandardPipelineTest, FunctionBasePassThreadsMatchSerial) {
+  // Functions without a top so none is removed as dead.
+  constexpr std::string_view kPackage = R"(
+package threads
+
+fn assoc(x: bits[8]) -> bits[8] {
+  lit1: bits[8] = literal(value=7)
+  lit2: bits[8] = literal(value=12)
+  add.1: bits[8] = add(lit1, x)
+  ret add.2: bits[8] = add(add.1, lit2)
+}
+
+fn logic(x: bits[32], y: bits[32]) -> bits[32] {
+  not.4: bits[32] = not(y)
+  and.3: bits[32] = and(x, y)
+  and.5: bits[32] = and(x, not.4)
+  ret or.6: bits[32] = or(and.3, and.5)
+}
+
+fn identities(x: bits[8]) -> bits[8] {
+  one: bits[8] = literal(value=1)
+  v1: bits[8] = identity(x)
+  add: bits[8] = add(v1, one)
+  v2: bits[8] = identity(add)
+  ret sub: bits[8] = sub(v2, one)
+}
+
+fn select(p: bits[1], x: bits[16]) -> bits[16] {
+  zero: bits[16] = literal(value=0)
+  sel.1: bits[16] = sel(p, cases=[x, zero])
+  ret sel.2: bits[16] = sel(p, cases=[sel.1, zero])
+}
+)";
+  auto run = [&](std::optional<int64_t> threads) {
+    std::unique_ptr<Package> p = Parser::ParsePackage(kPackage).value();
+    PassOptions options;
+    options.function_base_pass_threads = threads;
+    PassResults results;
+    XLS_CHECK_OK(
+        CreateStandardPassPipeline()->Run(p.get(), options, &results).status());
+    return p;
+  };
+  std::unique_ptr<Package> serial = run(std::nullopt);
+  std::unique_ptr<Package> one_thread = run(1);
+  // Staged node ids are renumbered in the order of the node table when the
+  // threads are done, so the IR, including the node ids, does not depend on
+  // the number of threads.
+  for (int64_t threads : {2, 4, 16}) {
+    EXPECT_EQ(run(threads)->DumpIr(), one_thread->DumpIr()) << threads;
+  }
+  // The optimized graphs match those optimized serially; only ids of nodes
+  // created and removed within a pass may differ.
+  ASSERT_EQ(one_thread->functions().size(), serial->functions().size());
+  for (int64_t i = 0; i < serial->functions().size(); ++i) {
+    EXPECT_EQ(one_thread->functions()[i]->GetFingerprint(),
+              serial->functions()[i]->GetFingerprint())
+        << serial->functions()[i]->name();
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * logic, one_thread->GetFunction("logic"));
+  EXPECT_THAT(logic->return_value(), m::Param("x"));
+}
 
 }  // namespace
 }  // namespace xls
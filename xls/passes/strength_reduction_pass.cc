@@ -14,6 +14,8 @@
 
 #include "xls/passes/strength_reduction_pass.h"
 
+#include <memory>
+
 #include "absl/status/statusor.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
@@ -336,8 +338,10 @@ absl::StatusOr<bool> StrengthReduceNode(
 
 absl::StatusOr<bool> StrengthReductionPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const PassOptions& options, PassResults* results) const {
-  TernaryQueryEngine query_engine;
-  XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<TernaryQueryEngine> shared_query_engine,
+      results->analyses.GetQueryEngine<TernaryQueryEngine>(f));
+  const TernaryQueryEngine& query_engine = *shared_query_engine;
   XLS_ASSIGN_OR_RETURN(absl::flat_hash_set<Node*> reducible_adds,
                        FindReducibleAdds(f, query_engine));
   // Note: because we introduce new nodes into the graph that were not present
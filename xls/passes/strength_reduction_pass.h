@@ -30,6 +30,8 @@ class StrengthReductionPass : public FunctionBasePass {
         opt_level_(opt_level) {}
   ~StrengthReductionPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   int64_t opt_level_;
 
@@ -13,7 +13,16 @@
 // limitations under the License.
 #include "xls/passes/table_switch_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/node_iterator.h"
@@ -54,6 +63,24 @@ static std::optional<Uint64Comparison> MatchCompareEqAgainstUint64(Node* node) {
   return std::nullopt;
 }
 
+// Returns whether the two nodes are the same index for the purpose of a chain
+// of selects: either the same node, or identical slices of the same node. The
+// latter occurs in chains switching on a field of a value, e.g. those emitted
+// by xlscc, where each comparison slices the field out anew.
+static bool IsSameIndex(Node* a, Node* b) {
+  if (a == b) {
+    return true;
+  }
+  if (!a->Is<BitSlice>() || !b->Is<BitSlice>()) {
+    return false;
+  }
+  BitSlice* a_slice = a->As<BitSlice>();
+  BitSlice* b_slice = b->As<BitSlice>();
+  return a_slice->operand(0) == b_slice->operand(0) &&
+         a_slice->start() == b_slice->start() &&
+         a_slice->width() == b_slice->width();
+}
+
 // Return type of the MatchLink function. See MatchLink comment for details.
 struct Link {
   Select* node;
@@ -72,7 +99,8 @@ struct Link {
 //
 // Where:
 //   {key}   : A literal whose value fits in a uint64_t.
-//   {index} : Equal to the argument 'index' if 'index' is non-null.
+//   {index} : The same index as the argument 'index' (see IsSameIndex) if
+//             'index' is non-null.
 //   {next}  : Arbitrary node.
 //   {value} : A literal node.
 //
@@ -110,15 +138,103 @@ static std::optional<Link> MatchLink(Node* node, Node* index = nullptr) {
   const Value& value = value_node->As<Literal>()->value();
 
   // The index, if given, must match the non-literal operand of the eq.
-  if (index != nullptr && index != match->index) {
+  if (index != nullptr && !IsSameIndex(index, match->index)) {
     return std::nullopt;
   }
 
   return Link{select, match->index, match->key, value, next};
 }
 
-// Returns an array Value of the table lookup effectively performed by the given
-// chain of selects. For example, given the following chain:
+// Minimum number of links in a chain converted into a table lookup.
+constexpr int64_t kMinChainLength = 3;
+
+// The ways in which a chain of selects can be converted into a table lookup.
+// See LinksToTable.
+enum class TableKind {
+  // The selects cover the entire index space.
+  kFullIndexSpace,
+  // The selects cover most of the index space; the holes are filled with the
+  // final fall-through value.
+  kFilledHoles,
+  // The selects cover the keys from zero on up; the final fall-through value
+  // is put at the index past the last key, where out-of-bounds indices
+  // saturate.
+  kSaturating,
+};
+
+// The set of keys of a (suffix of a) chain of selects.
+struct KeySet {
+  absl::flat_hash_set<uint64_t> keys;
+  uint64_t min_key = std::numeric_limits<uint64_t>::max();
+  uint64_t max_key = 0;
+
+  void Add(uint64_t key) {
+    keys.insert(key);
+    min_key = std::min(min_key, key);
+    max_key = std::max(max_key, key);
+  }
+};
+
+// Returns how a chain of selects with the given keys can be converted into a
+// table lookup, or std::nullopt if it cannot be. `else_value` is the final
+// fall-through value of the chain if it is a literal.
+//
+// `index_space_size` is the size of the space indexed by the index of the
+// chain. Used to test if the selects cover the entire index space. If the index
+// space is huge (>=2^64) it is std::nullopt and considered to be infinitely
+// large for the purposes of this transformation.
+static std::optional<TableKind> GetTableKind(
+    const KeySet& key_set, std::optional<uint64_t> index_space_size,
+    const Value* else_value) {
+  const uint64_t size = key_set.keys.size();
+  if (index_space_size.has_value() && size == index_space_size.value()) {
+    // The on-true cases of the selects cover the entire index space. The final
+    // on-false case is dead and need not be considered.
+    return TableKind::kFullIndexSpace;
+  }
+
+  // The entire index space is not covered so the final on-false case is not
+  // dead and must be a literal in order for this to be converted into a table
+  // lookup.
+  if (else_value == nullptr) {
+    return std::nullopt;
+  }
+
+  if (index_space_size.has_value() && size < index_space_size.value() &&
+      size * 2 > index_space_size.value()) {
+    // There are holes in the index space, but most of the index space is
+    // covered. Necessarily, if the index assumes one of the missing values the
+    // expression returns else_value so the holes can be filled with it.
+    return TableKind::kFilledHoles;
+  }
+
+  // As a special case we can rely on the saturating semantics of ArrayIndex to
+  // convert the select sequence to a table lookup. Specifically, if the index
+  // is OOB, ArrayIndex returns the element of the array at the max index. We
+  // put the else_value at the maximum index. For this to work, the keys must
+  // be dense from zero on up.
+  if (size == key_set.max_key + 1) {
+    return TableKind::kSaturating;
+  }
+
+  // Possible improvements that could be handled here:
+  //  - Handling non-zero start indexes.
+  //  - Support non-1 index strides:
+  //    - Extract a constant factor, e.g., 0, 4, 8, ... -> 0, 1, 2, ...
+  //  - Handle "partial" chains - those that only cover part of the match space
+  return std::nullopt;
+}
+
+// The table lookup replacing a suffix of a chain of selects: the links from
+// `first` on are replaced by an index of the array `table`.
+struct ChainTable {
+  int64_t first;
+  Value table;
+};
+
+// Returns the longest suffix of the given chain of selects which can be
+// converted into a table lookup, along with the array Value of the lookup
+// effectively performed by it. For example, given the following chain:
 //
 //                        else_value
 //                             |    Value_2
@@ -134,128 +250,106 @@ static std::optional<Link> MatchLink(Node* node, Node* index = nullptr) {
 //
 // The returned array might be: {Value_0, Value_1, Value_2, else_value}
 //
-// Returns std::nullopt if the chain cannot be represented as an index into a
-// literal array.
-static absl::StatusOr<std::optional<Value>> LinksToTable(
+// All the suffixes of the chain share its final fall-through value, so they
+// are considered together in a single walk down the chain which grows the set
+// of keys one link at a time. This is equivalent to, but linear rather than
+// quadratic in the chain length unlike, trying each suffix in turn.
+//
+// Returns std::nullopt if no suffix of at least kMinChainLength links can be
+// represented as an index into a literal array.
+static absl::StatusOr<std::optional<ChainTable>> LinksToTable(
     absl::Span<const Link> links) {
-  if (links.empty()) {
-    XLS_VLOG(3) << "Empty chain.";
+  if (links.size() < kMinChainLength) {
+    XLS_VLOG(3) << "Chain is too short.";
     return std::nullopt;
   }
 
-  // Compute the size of the space indexed by the index of the select
-  // chain. Used to test if the selects cover the entire index space. If the
-  // index space is huge (>=2^64) we set this value to std::nullopt and
-  // consider the index space size to be infinitely large for the purposes of
-  // this transformation.
   int64_t index_width = links.front().index->GetType()->GetFlatBitCount();
   std::optional<uint64_t> index_space_size = std::nullopt;
   if (index_width < 63) {
     index_space_size = uint64_t{1} << index_width;
   }
+  const Value* else_value = links.back().next->Is<Literal>()
+                                ? &links.back().next->As<Literal>()->value()
+                                : nullptr;
+  XLS_VLOG(3) << "Index width: " << index_width;
 
-  // Gather all selectable Values in a map indexed by the uint64_t index
-  // associated with the Value.
-  absl::flat_hash_map<uint64_t, Value> map;
-  uint64_t min_key = std::numeric_limits<uint64_t>::max();
-  uint64_t max_key = 0;
-  for (const Link& link : links) {
-    if (map.contains(link.key)) {
-      // We're iterating from the bottom of the chain up, so if a key appears
-      // more than once then the value associated with the later instance is
-      // dead and can be ignored.
+  KeySet key_set;
+  std::optional<int64_t> first;
+  std::optional<TableKind> kind;
+  for (int64_t i = links.size() - 1; i >= 0; --i) {
+    key_set.Add(links[i].key);
+    if (links.size() - i < kMinChainLength) {
       continue;
     }
-    map[link.key] = link.value;
-    min_key = std::min(min_key, link.key);
-    max_key = std::max(max_key, link.key);
-  }
-
-  // Converts the dense map of Values into an array of Values.
-  auto map_to_array_value = [](const absl::flat_hash_map<uint64_t, Value>& m)
-      -> absl::StatusOr<Value> {
-    std::vector<Value> values(m.size());
-    for (auto& [key, value] : m) {
-      XLS_RET_CHECK_LT(key, values.size());
-      values[key] = value;
+    if (std::optional<TableKind> suffix_kind =
+            GetTableKind(key_set, index_space_size, else_value)) {
+      first = i;
+      kind = suffix_kind;
     }
-    return Value::Array(values);
-  };
-
-  if (index_space_size.has_value() && map.size() == index_space_size.value()) {
-    // The on-true cases of the selects cover the entire index space. The final
-    // on-false case (else_value in the diagram above) is dead and need not be
-    // considered.
-    XLS_RET_CHECK_EQ(min_key, 0);
-    XLS_RET_CHECK_EQ(max_key, index_space_size.value() - 1);
-    XLS_ASSIGN_OR_RETURN(Value array, map_to_array_value(map));
-    return array;
   }
-
-  // The entire index space is not covered so the final on-false case
-  // (else_value in the diagram above) is not dead and must be a literal in
-  // order for this to be converted into a table lookup.
-  if (!links.back().next->Is<Literal>()) {
-    XLS_VLOG(3) << "Final fall-through case is not a literal: "
-                << links.back().next->ToString();
+  if (!first.has_value()) {
+    XLS_VLOG(3) << "Cannot convert link chain to table lookup";
     return std::nullopt;
   }
-  const Value& else_value = links.back().next->As<Literal>()->value();
 
-  XLS_VLOG(3) << "Index width: " << index_width;
-  if (index_space_size.has_value()) {
-    XLS_VLOG(3) << "Index space size: " << index_space_size.value();
+  // Recompute the keys of the chosen suffix, and build the table directly from
+  // the values of the links, pointing into the literals rather than copying
+  // the values until the array is created.
+  KeySet suffix_keys;
+  for (int64_t i = first.value(); i < links.size(); ++i) {
+    suffix_keys.Add(links[i].key);
   }
-  XLS_VLOG(3) << "map.size(): " << map.size();
-
-  if (index_space_size.has_value() && map.size() < index_space_size.value() &&
-      map.size() * 2 > index_space_size.value()) {
-    // There are holes in the index space, but most of the index space is
-    // covered. Necessarily, if the index assumes one of the missing values the
-    // expression returns else_value so fill in the holes with else_value and
-    // return.
-    for (uint64_t i = 0; i < index_space_size; ++i) {
-      if (!map.contains(i)) {
-        map[i] = else_value;
-      }
+  uint64_t table_size = 0;
+  switch (kind.value()) {
+    case TableKind::kFullIndexSpace:
+    case TableKind::kFilledHoles:
+      table_size = index_space_size.value();
+      break;
+    case TableKind::kSaturating:
+      // The condition for this kind should imply that the min key is zero.
+      XLS_RET_CHECK_EQ(suffix_keys.min_key, 0);
+      table_size = suffix_keys.max_key + 2;
+      break;
+  }
+  std::vector<const Value*> entries(table_size, nullptr);
+  for (int64_t i = first.value(); i < links.size(); ++i) {
+    XLS_RET_CHECK_LT(links[i].key, table_size);
+    // We're iterating from the bottom of the chain up, so if a key appears
+    // more than once then the value associated with the later instance is
+    // dead and can be ignored.
+    if (entries[links[i].key] == nullptr) {
+      entries[links[i].key] = &links[i].value;
     }
-    XLS_RET_CHECK_EQ(map.size(), index_space_size.value());
-    XLS_ASSIGN_OR_RETURN(Value array, map_to_array_value(map));
-    return array;
   }
-
-  // As a special case we can rely on the saturating semantics of ArrayIndex to
-  // convert the select sequence to a table lookup. Specifically, if the index
-  // is OOB, ArrayIndex returns the element of the array at the max index. We
-  // put the else_value at the maximum index. For this to work, the map must be
-  // dense from zero on up.
-  if (map.size() == max_key + 1) {
-    // The condition above should imply that the min key is zero.
-    XLS_RET_CHECK_EQ(min_key, 0);
-    map[max_key + 1] = else_value;
-    XLS_ASSIGN_OR_RETURN(Value array, map_to_array_value(map));
-    return array;
+  std::vector<Value> values;
+  values.reserve(table_size);
+  for (const Value* entry : entries) {
+    if (entry == nullptr) {
+      XLS_RET_CHECK(kind != TableKind::kFullIndexSpace);
+      XLS_RET_CHECK(else_value != nullptr);
+      entry = else_value;
+    }
+    values.push_back(*entry);
   }
-
-  // Possible improvements that could be handled here:
-  //  - Handling non-zero start indexes.
-  //  - Support non-1 index strides:
-  //    - Extract a constant factor, e.g., 0, 4, 8, ... -> 0, 1, 2, ...
-  //  - Handle "partial" chains - those that only cover part of the match space
-
-  XLS_VLOG(3) << "Cannot convert link chain to table lookup";
-  return std::nullopt;
+  XLS_ASSIGN_OR_RETURN(Value table, Value::Array(values));
+  return ChainTable{first.value(), std::move(table)};
 }
 
 absl::StatusOr<bool> TableSwitchPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const PassOptions& options, PassResults* results) const {
   bool changed = false;
-  absl::flat_hash_set<Node*> transformed;
+  // Selects which have been walked as part of a chain. Every suffix of a chain
+  // is considered when the chain is first walked, so these need not be walked
+  // again.
+  absl::flat_hash_set<Node*> visited;
+  // The array literals created, which are shared by lookups into identical
+  // tables.
+  absl::flat_hash_map<Value, Literal*> table_literals;
   for (Node* node : ReverseTopoSort(f)) {
     XLS_VLOG(3) << "Considering node: " << node->ToString();
-    if (transformed.contains(node)) {
-      XLS_VLOG(3) << absl::StreamFormat("Already transformed %s",
-                                        node->GetName());
+    if (visited.contains(node)) {
+      XLS_VLOG(3) << absl::StreamFormat("Already visited %s", node->GetName());
       continue;
     }
     // Check if this node is the start of a chain of selects. This also
@@ -294,6 +388,9 @@ absl::StatusOr<bool> TableSwitchPass::RunOnFunctionBaseInternal(
       next = link->next;
       links.push_back(link.value());
     }
+    for (const Link& link : links) {
+      visited.insert(link.node);
+    }
 
     XLS_VLOG(3) << absl::StreamFormat("Chain of length %d found", links.size());
     if (XLS_VLOG_IS_ON(4)) {
@@ -305,33 +402,30 @@ absl::StatusOr<bool> TableSwitchPass::RunOnFunctionBaseInternal(
       }
     }
 
-    if (links.size() <= 2) {
-      XLS_VLOG(3) << "Chain is too short.";
-      continue;
-    }
-
-    // Try to convert the chain into a table representing the lookup being
-    // performed.
-    XLS_ASSIGN_OR_RETURN(std::optional<Value> table, LinksToTable(links));
-    if (!table.has_value()) {
+    // Try to convert the chain, or its longest possible suffix, into a table
+    // representing the lookup being performed.
+    XLS_ASSIGN_OR_RETURN(std::optional<ChainTable> chain_table,
+                         LinksToTable(links));
+    if (!chain_table.has_value()) {
       continue;
     }
+    const Link& first = links[chain_table->first];
 
     XLS_VLOG(3) << absl::StreamFormat(
         "Replacing chain starting at %s with index of array: %s",
-        node->GetName(), table.value().ToString());
+        first.node->GetName(), chain_table->table.ToString());
 
-    XLS_ASSIGN_OR_RETURN(Literal * array_literal,
-                         f->MakeNode<Literal>(node->loc(), table.value()));
-    XLS_RETURN_IF_ERROR(node->ReplaceUsesWithNew<ArrayIndex>(
-                                array_literal, std::vector<Node*>({index}))
-                            .status());
-
-    // Mark the replaced nodes as being transformed to avoid quadratic
-    // behavior. These nodes will be skipped in future iterations.
-    for (const Link& link : links) {
-      transformed.insert(link.node);
+    auto [it, inserted] =
+        table_literals.try_emplace(chain_table->table, nullptr);
+    if (inserted) {
+      XLS_ASSIGN_OR_RETURN(
+          it->second,
+          f->MakeNode<Literal>(first.node->loc(), chain_table->table));
     }
+    XLS_RETURN_IF_ERROR(first.node
+                            ->ReplaceUsesWithNew<ArrayIndex>(
+                                it->second, std::vector<Node*>({first.index}))
+                            .status());
     changed = true;
   }
 
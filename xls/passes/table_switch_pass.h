@@ -25,7 +25,10 @@ namespace xls {
 // sel.(N+1)(eq.Y, sel.(N), literal.C)
 // sel.(N+2)(eq.Z, sel.(N+1), literal.D)
 // And so on. In these chains, eq.X, eq.Y, and eq.Z must all be comparisons of
-// the same value against different literals.
+// the same value, or of identical bit slices of the same value, against
+// different literals. If a chain cannot be converted as a whole, its longest
+// convertible suffix is. Chains are discovered and converted in time linear in
+// their length.
 //
 // Current limitations:
 //  - Either the start or end index in the chain must be 0.
@@ -37,6 +40,8 @@ class TableSwitchPass : public FunctionBasePass {
   TableSwitchPass()
       : FunctionBasePass("table_switch", "Table switch conversion") {}
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
@@ -16,11 +16,14 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
 #include "xls/common/status/matchers.h"
 #include "xls/interpreter/function_interpreter.h"
@@ -785,5 +788,143 @@ fn main(index: bits[2]) -> bits[32] {
           /*indices=*/{m::Param()}));
 }
 
+TEST_F(TableSwitchPassTest, BitSliceIndex) {
+  // Each comparison slices the index out of a wider value anew.
+  std::string program = R"(
+fn main(x: bits[8]) -> bits[32] {
+  _111: bits[32] = literal(value=111)
+  _222: bits[32] = literal(value=222)
+  _333: bits[32] = literal(value=333)
+  _444: bits[32] = literal(value=444)
+
+  literal_0: bits[2] = literal(value=0)
+  literal_1: bits[2] = literal(value=1)
+  literal_2: bits[2] = literal(value=2)
+  literal_3: bits[2] = literal(value=3)
+  slice_0: bits[2] = bit_slice(x, start=4, width=2)
+  slice_1: bits[2] = bit_slice(x, start=4, width=2)
+  slice_2: bits[2] = bit_slice(x, start=4, width=2)
+  slice_3: bits[2] = bit_slice(x, start=4, width=2)
+  eq_0: bits[1] = eq(slice_0, literal_0)
+  eq_1: bits[1] = eq(slice_1, literal_1)
+  eq_2: bits[1] = eq(slice_2, literal_2)
+  eq_3: bits[1] = eq(slice_3, literal_3)
+
+  sel_3: bits[32] = sel(eq_3, cases=[_111, _444])
+  sel_2: bits[32] = sel(eq_2, cases=[sel_3, _333])
+  sel_1: bits[32] = sel(eq_1, cases=[sel_2, _222])
+  ret sel_0: bits[32] = sel(eq_0, cases=[sel_1, _111])
+})";
+
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  ASSERT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(
+      f->return_value(),
+      m::ArrayIndex(
+          m::Literal(Value::UBitsArray({111, 222, 333, 444}, 32).value()),
+          /*indices=*/{m::BitSlice(m::Param(), /*start=*/4, /*width=*/2)}));
+}
+
+TEST_F(TableSwitchPassTest, DifferentBitSliceIndexes) {
+  std::string program = R"(
+fn main(x: bits[8]) -> bits[32] {
+  _111: bits[32] = literal(value=111)
+  _222: bits[32] = literal(value=222)
+  _333: bits[32] = literal(value=333)
+  _444: bits[32] = literal(value=444)
+
+  literal_0: bits[2] = literal(value=0)
+  literal_1: bits[2] = literal(value=1)
+  literal_2: bits[2] = literal(value=2)
+  literal_3: bits[2] = literal(value=3)
+  slice_0: bits[2] = bit_slice(x, start=4, width=2)
+  slice_1: bits[2] = bit_slice(x, start=2, width=2)
+  eq_0: bits[1] = eq(slice_0, literal_0)
+  eq_1: bits[1] = eq(slice_1, literal_1)
+  eq_2: bits[1] = eq(slice_0, literal_2)
+  eq_3: bits[1] = eq(slice_1, literal_3)
+
+  sel_3: bits[32] = sel(eq_3, cases=[_111, _444])
+  sel_2: bits[32] = sel(eq_2, cases=[sel_3, _333])
+  sel_1: bits[32] = sel(eq_1, cases=[sel_2, _222])
+  ret sel_0: bits[32] = sel(eq_0, cases=[sel_1, _111])
+})";
+
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  ASSERT_THAT(Run(f), IsOkAndHolds(false));
+}
+
+TEST_F(TableSwitchPassTest, ConvertsLongestSuffix) {
+  // The chain as a whole is too sparse, but the chain above its first link is
+  // dense.
+  std::string program = R"(
+fn main(index: bits[32]) -> bits[32] {
+  _0: bits[32] = literal(value=0)
+  _111: bits[32] = literal(value=111)
+  _222: bits[32] = literal(value=222)
+  _333: bits[32] = literal(value=333)
+  _999: bits[32] = literal(value=999)
+
+  literal_0: bits[32] = literal(value=0)
+  literal_1: bits[32] = literal(value=1)
+  literal_2: bits[32] = literal(value=2)
+  literal_100: bits[32] = literal(value=100)
+  eq_0: bits[1] = eq(index, literal_0)
+  eq_1: bits[1] = eq(index, literal_1)
+  eq_2: bits[1] = eq(index, literal_2)
+  eq_100: bits[1] = eq(index, literal_100)
+
+  sel_3: bits[32] = sel(eq_2, cases=[_0, _333])
+  sel_2: bits[32] = sel(eq_1, cases=[sel_3, _222])
+  sel_1: bits[32] = sel(eq_0, cases=[sel_2, _111])
+  ret sel_0: bits[32] = sel(eq_100, cases=[sel_1, _999])
+})";
+
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Value> before_data,
+                           GetBeforeData(f, /*max_index=*/100));
+  ASSERT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(
+      f->return_value(),
+      m::Select(m::Eq(),
+                /*cases=*/{m::ArrayIndex(m::Literal(Value::UBitsArray(
+                                                        {111, 222, 333, 0}, 32)
+                                                        .value()),
+                                         /*indices=*/{m::Param()}),
+                           m::Literal(999)}));
+  XLS_ASSERT_OK(CompareBeforeAfter(f, before_data));
+}
+
+TEST_F(TableSwitchPassTest, LongChain) {
+  // A chain of the length emitted by xlscc for large switch statements.
+  constexpr int kNumArms = 2000;
+  std::string program = "fn main(index: bits[32]) -> bits[32] {\n";
+  absl::StrAppend(&program, "  sel_", kNumArms,
+                  ": bits[32] = literal(value=0)\n");
+  for (int i = kNumArms - 1; i >= 0; --i) {
+    absl::StrAppendFormat(&program,
+                          "  key_%d: bits[32] = literal(value=%d)\n"
+                          "  value_%d: bits[32] = literal(value=%d)\n"
+                          "  eq_%d: bits[1] = eq(index, key_%d)\n"
+                          "  %ssel_%d: bits[32] = sel(eq_%d, "
+                          "cases=[sel_%d, value_%d])\n",
+                          i, i, i, 3 * i + 1, i, i, i == 0 ? "ret " : "", i,
+                          i, i + 1, i);
+  }
+  absl::StrAppend(&program, "}\n");
+
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Value> before_data,
+                           GetBeforeData(f, kNumArms));
+  ASSERT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::ArrayIndex(m::Literal(), /*indices=*/{m::Param()}));
+  XLS_ASSERT_OK(CompareBeforeAfter(f, before_data));
+}
+
 }  // namespace
 }  // namespace xls
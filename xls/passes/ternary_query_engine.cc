@@ -14,9 +14,14 @@
 
 #include "xls/passes/ternary_query_engine.h"
 
+#include <algorithm>
 #include <limits>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "xls/common/status/status_macros.h"
@@ -63,6 +68,28 @@ static Bits TernaryVectorToValueBits(
   return Bits(bits);
 }
 
+// Returns the ternary value of the bits-typed `node` given the function
+// `operand_value` returning the ternary values of its bits-typed operands.
+static absl::StatusOr<TernaryEvaluator::Vector> EvaluateNode(
+    Node* node, TernaryEvaluator* evaluator,
+    absl::FunctionRef<TernaryEvaluator::Vector(Node*)> operand_value) {
+  auto create_unknown_vector = [](Node* n) {
+    return TernaryEvaluator::Vector(n->BitCountOrDie(), TernaryValue::kUnknown);
+  };
+  if (IsExpensiveToEvaluate(node) ||
+      std::any_of(node->operands().begin(), node->operands().end(),
+                  [](Node* o) { return !o->GetType()->IsBits(); })) {
+    return create_unknown_vector(node);
+  }
+
+  std::vector<TernaryEvaluator::Vector> operand_values;
+  for (Node* operand : node->operands()) {
+    operand_values.push_back(operand_value(operand));
+  }
+  return AbstractEvaluate(node, operand_values, evaluator,
+                          /*default_handler=*/create_unknown_vector);
+}
+
 absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   TernaryEvaluator evaluator;
   absl::flat_hash_map<Node*, TernaryEvaluator::Vector> values;
@@ -70,25 +97,10 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
     if (!node->GetType()->IsBits()) {
       continue;
     }
-    auto create_unknown_vector = [](Node* n) {
-      return TernaryEvaluator::Vector(n->BitCountOrDie(),
-                                      TernaryValue::kUnknown);
-    };
-    if (IsExpensiveToEvaluate(node) ||
-        std::any_of(node->operands().begin(), node->operands().end(),
-                    [](Node* o) { return !o->GetType()->IsBits(); })) {
-      values[node] = create_unknown_vector(node);
-      continue;
-    }
-
-    std::vector<TernaryEvaluator::Vector> operand_values;
-    for (Node* operand : node->operands()) {
-      operand_values.push_back(values.at(operand));
-    }
     XLS_ASSIGN_OR_RETURN(
         values[node],
-        AbstractEvaluate(node, operand_values, &evaluator,
-                         /*default_handler=*/create_unknown_vector));
+        EvaluateNode(node, &evaluator,
+                     [&](Node* operand) { return values.at(operand); }));
   }
 
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
@@ -114,6 +126,30 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   return rf;
 }
 
+absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Update(
+    absl::Span<Node* const> changed) {
+  TernaryEvaluator evaluator;
+  return UpdateForwardCone(changed, [&](Node* node) -> absl::StatusOr<bool> {
+    if (!node->GetType()->IsBits()) {
+      return false;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        TernaryEvaluator::Vector value,
+        EvaluateNode(node, &evaluator, [&](Node* operand) {
+          return ternary_ops::FromKnownBits(known_bits_.at(operand),
+                                            bits_values_.at(operand));
+        }));
+    Bits known_bits = TernaryVectorToKnownBits(value);
+    Bits bits_values = TernaryVectorToValueBits(value);
+    auto it = known_bits_.find(node);
+    bool node_changed = it == known_bits_.end() || it->second != known_bits ||
+                        bits_values_.at(node) != bits_values;
+    known_bits_[node] = std::move(known_bits);
+    bits_values_[node] = std::move(bits_values);
+    return node_changed;
+  });
+}
+
 bool TernaryQueryEngine::AtMostOneTrue(
     absl::Span<TreeBitLocation const> bits) const {
   int64_t maybe_one_count = 0;
@@ -35,6 +35,9 @@ class TernaryQueryEngine : public QueryEngine {
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  absl::StatusOr<ReachedFixpoint> Update(
+      absl::Span<Node* const> changed) override;
+
   bool IsTracked(Node* node) const override {
     return known_bits_.contains(node);
   }
@@ -15,6 +15,7 @@
 #include "xls/passes/ternary_query_engine.h"
 
 #include <memory>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -130,5 +131,39 @@ TEST_F(TernaryQueryEngineTest, Ne) {
   EXPECT_THAT(RunOnBinaryOp("0b011", "0b011", make_ne), IsOkAndHolds("0b0"));
 }
 
+TEST_F(TernaryQueryEngineTest, Update) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  BValue sum = fb.Add(masked, fb.Literal(UBits(0x10, 8)));
+  BValue other =
+      fb.Or(fb.Param("y", p->GetBitsType(8)), fb.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Concat({sum, other})));
+  TernaryQueryEngine engine;
+  XLS_ASSERT_OK(engine.Populate(f));
+  EXPECT_EQ(engine.ToString(sum.node()), "0b0001_XXXX");
+
+  f->SetChangeTrackingEnabled(true);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Literal * mask,
+      f->MakeNode<Literal>(SourceInfo(), Value(UBits(0xf0, 8))));
+  XLS_ASSERT_OK(masked.node()->ReplaceOperandNumber(1, mask));
+  std::vector<Node*> changed(f->changed_nodes().begin(),
+                             f->changed_nodes().end());
+  EXPECT_THAT(engine.Update(changed), IsOkAndHolds(ReachedFixpoint::Changed));
+  EXPECT_EQ(engine.ToString(sum.node()), "0bXXXX_0000");
+  EXPECT_THAT(engine.Update({}), IsOkAndHolds(ReachedFixpoint::Unchanged));
+
+  // The updated engine agrees with an engine populated from scratch.
+  TernaryQueryEngine fresh_engine;
+  XLS_ASSERT_OK(fresh_engine.Populate(f));
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(engine.ToString(node), fresh_engine.ToString(node))
+        << node->GetName();
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -29,6 +29,8 @@ class TupleSimplificationPass : public FunctionBasePass {
       : FunctionBasePass("tuple_simp", "Tuple simplification") {}
   ~TupleSimplificationPass() override = default;
 
+  bool DependsOnlyOnFunctionBase() const override { return true; }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
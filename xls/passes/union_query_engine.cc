@@ -18,21 +18,38 @@
 
 namespace xls {
 
+// Returns the meet of the given fixpoint results.
+static ReachedFixpoint MeetReachedFixpoint(ReachedFixpoint result,
+                                           ReachedFixpoint rf) {
+  // Unchanged is the top of the lattice so it's an identity
+  if (result == ReachedFixpoint::Unchanged) {
+    return rf;
+  }
+  // Changed can only degrade to Unknown
+  if ((result == ReachedFixpoint::Changed) &&
+      (rf == ReachedFixpoint::Unknown)) {
+    return ReachedFixpoint::Unknown;
+  }
+  // No case needed for ReachedFixpoint::Unknown since it's already the bottom
+  // of the lattice
+  return result;
+}
+
 absl::StatusOr<ReachedFixpoint> UnionQueryEngine::Populate(FunctionBase* f) {
   ReachedFixpoint result = ReachedFixpoint::Unchanged;
-  for (const std::unique_ptr<QueryEngine>& engine : engines_) {
+  for (QueryEngine* engine : engines_) {
     XLS_ASSIGN_OR_RETURN(ReachedFixpoint rf, engine->Populate(f));
-    // Unchanged is the top of the lattice so it's an identity
-    if (result == ReachedFixpoint::Unchanged) {
-      result = rf;
-    }
-    // Changed can only degrade to Unknown
-    if ((result == ReachedFixpoint::Changed) &&
-        (rf == ReachedFixpoint::Unknown)) {
-      result = ReachedFixpoint::Unknown;
-    }
-    // No case needed for ReachedFixpoint::Unknown since it's already the bottom
-    // of the lattice
+    result = MeetReachedFixpoint(result, rf);
+  }
+  return result;
+}
+
+absl::StatusOr<ReachedFixpoint> UnionQueryEngine::Update(
+    absl::Span<Node* const> changed) {
+  ReachedFixpoint result = ReachedFixpoint::Unchanged;
+  for (QueryEngine* engine : engines_) {
+    XLS_ASSIGN_OR_RETURN(ReachedFixpoint rf, engine->Update(changed));
+    result = MeetReachedFixpoint(result, rf);
   }
   return result;
 }
@@ -37,12 +37,24 @@ namespace xls {
 // will be fixed at some point.
 class UnionQueryEngine : public QueryEngine {
  public:
-  explicit UnionQueryEngine(std::vector<std::unique_ptr<QueryEngine>> engines) {
-    engines_ = std::move(engines);
+  explicit UnionQueryEngine(std::vector<std::unique_ptr<QueryEngine>> engines)
+      : owned_engines_(std::move(engines)) {
+    for (const std::unique_ptr<QueryEngine>& engine : owned_engines_) {
+      engines_.push_back(engine.get());
+    }
   }
 
+  // Combines engines owned by the caller, which must outlive this engine (for
+  // example, engines cached by an AnalysisManager).
+  explicit UnionQueryEngine(std::vector<QueryEngine*> engines)
+      : engines_(std::move(engines)) {}
+
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
+  // Updates each of the engines. All of them must support Update.
+  absl::StatusOr<ReachedFixpoint> Update(
+      absl::Span<Node* const> changed) override;
+
   bool IsTracked(Node* node) const override;
 
   LeafTypeTree<TernaryVector> GetTernary(Node* node) const override;
@@ -69,7 +81,8 @@ class UnionQueryEngine : public QueryEngine {
  private:
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
-  std::vector<std::unique_ptr<QueryEngine>> engines_;
+  std::vector<std::unique_ptr<QueryEngine>> owned_engines_;
+  std::vector<QueryEngine*> engines_;
 };
 
 }  // namespace xls
@@ -14,49 +14,119 @@
 
 #include "xls/passes/unroll_pass.h"
 
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/node_iterator.h"
 
 namespace xls {
 namespace {
 
-// Finds an "effectively used" (has users or is return value) counted for in the
-// function f, or returns nullptr if none is found.
-CountedFor* FindCountedFor(FunctionBase* f) {
+// Returns the "effectively used" (has users or is return value) counted for
+// loops in the function f in topological order.
+std::vector<CountedFor*> FindCountedFors(FunctionBase* f) {
+  std::vector<CountedFor*> loops;
   for (Node* node : TopoSort(f)) {
     if (node->Is<CountedFor>() &&
         (f->HasImplicitUse(node) || !node->users().empty())) {
-      return node->As<CountedFor>();
+      loops.push_back(node->As<CountedFor>());
     }
   }
-  return nullptr;
+  return loops;
 }
 
-// Unrolls the node "loop" by replacing it with a sequence of dependent
-// invocations.
-absl::Status UnrollCountedFor(CountedFor* loop) {
+// Appends invocations of the body of `loop` for the iterations with the given
+// induction variable values to `loop_carry`, returning the final loop carry.
+absl::StatusOr<Node*> AppendIterations(CountedFor* loop, Node* loop_carry,
+                                       int64_t first_iv, int64_t trip_count) {
   FunctionBase* f = loop->function_base();
-  Node* loop_carry = loop->initial_value();
   int64_t ivar_bit_count = loop->body()->params()[0]->BitCountOrDie();
-  for (int64_t trip = 0, iv = 0; trip < loop->trip_count();
+  std::vector<Node*> invoke_args = {nullptr, nullptr};
+  invoke_args.insert(invoke_args.end(), loop->invariant_args().begin(),
+                     loop->invariant_args().end());
+  for (int64_t trip = 0, iv = first_iv; trip < trip_count;
        ++trip, iv += loop->stride()) {
     XLS_ASSIGN_OR_RETURN(
-        Literal * iv_node,
+        invoke_args[0],
         f->MakeNode<Literal>(loop->loc(), Value(UBits(iv, ivar_bit_count))));
-
-    // Construct the args for invocation.
-    std::vector<Node*> invoke_args = {iv_node, loop_carry};
-    for (Node* invariant_arg : loop->invariant_args()) {
-      invoke_args.push_back(invariant_arg);
-    }
-
+    invoke_args[1] = loop_carry;
     XLS_ASSIGN_OR_RETURN(
         loop_carry,
         f->MakeNode<Invoke>(loop->loc(), absl::MakeSpan(invoke_args),
                             loop->body()));
   }
+  return loop_carry;
+}
+
+// Unrolls the node "loop" by replacing it with a sequence of dependent
+// invocations.
+absl::Status UnrollCountedFor(CountedFor* loop) {
+  XLS_ASSIGN_OR_RETURN(
+      Node * loop_carry,
+      AppendIterations(loop, loop->initial_value(), /*first_iv=*/0,
+                       loop->trip_count()));
+  XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
+  return loop->function_base()->RemoveNode(loop);
+}
+
+// Returns a function with the signature of the body of `loop` which invokes
+// the body `factor` times for consecutive iterations, i.e.: with induction
+// variables i, i + stride, ..., i + (factor - 1) * stride. The function is
+// shared by all loops with the same body and stride.
+absl::StatusOr<Function*> GetUnrolledBody(CountedFor* loop, int64_t factor) {
+  Function* body = loop->body();
+  Package* p = body->package();
+  std::string name = absl::StrFormat("%s__unrolled_x%d_stride_%d",
+                                     body->name(), factor, loop->stride());
+  if (absl::StatusOr<Function*> existing = p->GetFunction(name);
+      existing.ok()) {
+    return *existing;
+  }
+
+  FunctionBuilder fb(name, p);
+  std::vector<BValue> params;
+  for (Param* param : body->params()) {
+    params.push_back(fb.Param(param->GetName(), param->GetType()));
+  }
+  int64_t ivar_bit_count = body->params()[0]->BitCountOrDie();
+  BValue loop_carry = params[1];
+  std::vector<BValue> invoke_args = params;
+  for (int64_t j = 0; j < factor; ++j) {
+    invoke_args[0] =
+        j == 0 ? params[0]
+               : fb.Add(params[0],
+                        fb.Literal(UBits(j * loop->stride(), ivar_bit_count)));
+    invoke_args[1] = loop_carry;
+    loop_carry = fb.Invoke(invoke_args, body);
+  }
+  return fb.BuildWithReturnValue(loop_carry);
+}
+
+// Unrolls the node "loop" by the given factor: the loop is replaced with one
+// running over `factor` iterations at a time, followed by invocations for any
+// remaining iterations.
+absl::Status PartiallyUnrollCountedFor(CountedFor* loop, int64_t factor) {
+  FunctionBase* f = loop->function_base();
+  int64_t outer_trip_count = loop->trip_count() / factor;
+  XLS_ASSIGN_OR_RETURN(Function * unrolled_body,
+                       GetUnrolledBody(loop, factor));
+  XLS_ASSIGN_OR_RETURN(
+      CountedFor * outer_loop,
+      f->MakeNode<CountedFor>(loop->loc(), loop->initial_value(),
+                              loop->invariant_args(), outer_trip_count,
+                              loop->stride() * factor, unrolled_body));
+  XLS_ASSIGN_OR_RETURN(
+      Node * loop_carry,
+      AppendIterations(loop, outer_loop,
+                       /*first_iv=*/outer_trip_count * factor * loop->stride(),
+                       loop->trip_count() % factor));
   XLS_RETURN_IF_ERROR(loop->ReplaceUsesWith(loop_carry));
   return f->RemoveNode(loop);
 }
@@ -65,13 +135,17 @@ absl::Status UnrollCountedFor(CountedFor* loop) {
 
 absl::StatusOr<bool> UnrollPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const PassOptions& options, PassResults* results) const {
+  // Unrolling invokes the loop bodies rather than inlining them, so it never
+  // exposes further loops in `f`, and a single walk over the loops suffices.
   bool changed = false;
-  while (true) {
-    CountedFor* loop = FindCountedFor(f);
-    if (loop == nullptr) {
-      break;
+  for (CountedFor* loop : FindCountedFors(f)) {
+    if (unroll_factor_.has_value() &&
+        loop->trip_count() / unroll_factor_.value() >= 2) {
+      XLS_RETURN_IF_ERROR(
+          PartiallyUnrollCountedFor(loop, unroll_factor_.value()));
+    } else {
+      XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
     }
-    XLS_RETURN_IF_ERROR(UnrollCountedFor(loop));
     changed = true;
   }
   return changed;
@@ -15,20 +15,40 @@
 #ifndef XLS_PASSES_UNROLL_PASS_H_
 #define XLS_PASSES_UNROLL_PASS_H_
 
+#include <cstdint>
+#include <optional>
+
 #include "absl/status/statusor.h"
+#include "xls/common/logging/logging.h"
 #include "xls/ir/function.h"
 #include "xls/passes/passes.h"
 
 namespace xls {
 
+// Unrolls counted_for loops into sequences of invocations of their bodies.
+//
+// If an unroll factor is given, loops of at least twice that many iterations
+// are only partially unrolled: each becomes a counted_for over a new body
+// which invokes the original body `unroll_factor` times, followed by
+// invocations for the remaining iterations. This keeps the IR compact for
+// loops with large trip counts.
 class UnrollPass : public FunctionBasePass {
  public:
-  UnrollPass() : FunctionBasePass("loop_unroll", "Unroll counted loops") {}
+  explicit UnrollPass(std::optional<int64_t> unroll_factor = std::nullopt)
+      : FunctionBasePass("loop_unroll", "Unroll counted loops"),
+        unroll_factor_(unroll_factor) {
+    XLS_CHECK(!unroll_factor.has_value() || unroll_factor.value() > 0);
+  }
+
+  bool IsExpensive() const override { return true; }
 
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const PassOptions& options,
       PassResults* results) const override;
+
+ private:
+  std::optional<int64_t> unroll_factor_;
 };
 
 }  // namespace xls
@@ -17,6 +17,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/passes/dce_pass.h"
@@ -57,5 +58,66 @@ fn unrollable() -> bits[32] {
                         m::Literal(0)));
 }
 
+constexpr char kStridedSumProgram[] = R"(
+package some_package
+
+fn body(i: bits[8], accum: bits[32], scale: bits[32]) -> bits[32] {
+  zero_ext.3: bits[32] = zero_ext(i, new_bit_count=32)
+  umul.4: bits[32] = umul(zero_ext.3, scale)
+  ret add.5: bits[32] = add(umul.4, accum)
+}
+
+fn unrollable(scale: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=7)
+  ret counted_for.2: bits[32] = counted_for(literal.1, trip_count=7, stride=3, body=body, invariant_args=[scale])
+}
+)";
+
+TEST(UnrollPassTest, PartiallyUnrollsByFactor) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kStridedSumProgram));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  UnrollPass pass(/*unroll_factor=*/3);
+  EXPECT_THAT(pass.RunOnFunctionBase(f, PassOptions(), &results),
+              IsOkAndHolds(true));
+  // Two trips over three iterations each, then the seventh iteration.
+  EXPECT_THAT(f->return_value(),
+              m::Invoke(m::Literal(18), m::CountedFor(), m::Param("scale")));
+  CountedFor* loop = f->return_value()->operand(1)->As<CountedFor>();
+  EXPECT_EQ(loop->trip_count(), 2);
+  EXPECT_EQ(loop->stride(), 9);
+  EXPECT_THAT(loop->body()->return_value(),
+              m::Invoke(m::Add(m::Param("i"), m::Literal(6)),
+                        m::Invoke(m::Add(m::Param("i"), m::Literal(3)),
+                                  m::Invoke(m::Param("i"), m::Param("accum"),
+                                            m::Param("scale")),
+                                  m::Param("scale")),
+                        m::Param("scale")));
+
+  // sum(3 * i * scale for i in range(7)) + 7
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      InterpretFunction(f, {Value(UBits(5, 32))}));
+  EXPECT_EQ(result.value, Value(UBits(3 * 21 * 5 + 7, 32)));
+}
+
+TEST(UnrollPassTest, ShortLoopsAreFullyUnrolledWithFactor) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kStridedSumProgram));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("unrollable"));
+  PassResults results;
+  UnrollPass pass(/*unroll_factor=*/4);
+  EXPECT_THAT(pass.RunOnFunctionBase(f, PassOptions(), &results),
+              IsOkAndHolds(true));
+  for (Node* node : f->nodes()) {
+    EXPECT_FALSE(node->Is<CountedFor>()) << node->ToString();
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      InterpretFunction(f, {Value(UBits(5, 32))}));
+  EXPECT_EQ(result.value, Value(UBits(3 * 21 * 5 + 7, 32)));
+}
+
 }  // namespace
 }  // namespace xls
@@ -20,6 +20,9 @@ namespace xls {
 
 absl::Status VerifierChecker::Run(Package* p, const PassOptions& options,
                                   PassResults* results) const {
+  if (options.incremental_verification) {
+    return VerifyPackageIncrementally(p);
+  }
   return VerifyPackage(p);
 }
 
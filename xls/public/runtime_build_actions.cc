@@ -14,8 +14,20 @@
 
 #include "xls/public/runtime_build_actions.h"
 
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/import_data.h"
@@ -23,6 +35,7 @@
 #include "xls/dslx/mangle.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/passes/passes.h"
+#include "xls/passes/standard_pipeline.h"
 #include "xls/tools/opt.h"
 #include "xls/tools/proto_to_dslx.h"
 
@@ -90,4 +103,125 @@ absl::StatusOr<std::string> ProtoToDslx(std::string_view proto_def,
   return module->ToString();
 }
 
+namespace {
+
+// Above this many entries, a result cache of a session is cleared before more
+// are added.
+constexpr int64_t kMaxCacheEntries = 4096;
+
+void AddToCache(std::string key, std::string value,
+                absl::flat_hash_map<std::string, std::string>& cache) {
+  if (cache.size() >= kMaxCacheEntries) {
+    cache.clear();
+  }
+  cache.emplace(std::move(key), std::move(value));
+}
+
+}  // namespace
+
+class XlsCompilerSession::State {
+ public:
+  State(std::string_view dslx_stdlib_path,
+        absl::Span<const std::filesystem::path> additional_search_paths)
+      : dslx_stdlib_path(dslx_stdlib_path),
+        additional_search_paths(additional_search_paths.begin(),
+                                additional_search_paths.end()),
+        pipeline(CreateStandardPassPipeline(kMaxOptLevel)) {
+    absl::MutexLock lock(&mutex);
+    ResetImportData();
+  }
+
+  void ResetImportData() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex) {
+    import_data = std::make_unique<dslx::ImportData>(
+        dslx::CreateImportData(dslx_stdlib_path, additional_search_paths));
+  }
+
+  absl::Mutex mutex;
+  const std::string dslx_stdlib_path;
+  const std::vector<std::filesystem::path> additional_search_paths;
+  // Holds the modules imported so far, parsed and typechecked.
+  std::unique_ptr<dslx::ImportData> import_data ABSL_GUARDED_BY(mutex);
+  const std::unique_ptr<CompoundPass> pipeline;
+  // Results keyed by digests of the inputs of the action.
+  absl::flat_hash_map<std::string, std::string> converted_ir
+      ABSL_GUARDED_BY(mutex);
+  absl::flat_hash_map<std::string, std::string> optimized_ir
+      ABSL_GUARDED_BY(mutex);
+};
+
+XlsCompilerSession::XlsCompilerSession(
+    std::string_view dslx_stdlib_path,
+    absl::Span<const std::filesystem::path> additional_search_paths)
+    : state_(std::make_unique<State>(dslx_stdlib_path,
+                                     additional_search_paths)) {}
+
+XlsCompilerSession::~XlsCompilerSession() = default;
+
+absl::StatusOr<std::string> XlsCompilerSession::ConvertDslxToIr(
+    std::string_view dslx, std::string_view path,
+    std::string_view module_name) {
+  absl::MutexLock lock(&state_->mutex);
+  std::string key = ContentDigest({dslx, path, module_name});
+  if (auto it = state_->converted_ir.find(key);
+      it != state_->converted_ir.end()) {
+    return it->second;
+  }
+
+  // A module of the same name may have been converted (or imported) before,
+  // possibly with different text; drop it so it is typechecked afresh. Fall
+  // back to starting over if other modules import it.
+  XLS_ASSIGN_OR_RETURN(dslx::ImportTokens subject,
+                       dslx::ImportTokens::FromString(module_name));
+  if (state_->import_data->Contains(subject) &&
+      !state_->import_data->Remove(subject).ok()) {
+    state_->ResetImportData();
+  }
+  absl::StatusOr<dslx::TypecheckedModule> typechecked = dslx::ParseAndTypecheck(
+      dslx, path, module_name, state_->import_data.get());
+  if (!typechecked.ok()) {
+    // Don't keep what a failed typecheck may have left half done.
+    state_->ResetImportData();
+    return typechecked.status();
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::string ir,
+      dslx::ConvertModule(typechecked->module, state_->import_data.get(),
+                          dslx::ConvertOptions{}));
+  AddToCache(std::move(key), ir, state_->converted_ir);
+  return ir;
+}
+
+absl::StatusOr<std::string> XlsCompilerSession::ConvertDslxPathToIr(
+    std::filesystem::path path) {
+  XLS_ASSIGN_OR_RETURN(std::string dslx, GetFileContents(path));
+  XLS_ASSIGN_OR_RETURN(std::string module_name, ExtractModuleName(path));
+  return ConvertDslxToIr(dslx, std::string(path), module_name);
+}
+
+absl::StatusOr<std::string> XlsCompilerSession::OptimizeIr(
+    std::string_view ir, std::string_view top) {
+  absl::MutexLock lock(&state_->mutex);
+  std::string key = ContentDigest({ir, top});
+  if (auto it = state_->optimized_ir.find(key);
+      it != state_->optimized_ir.end()) {
+    return it->second;
+  }
+  const tools::OptOptions options = {
+      .opt_level = xls::kMaxOptLevel,
+      .top = top,
+      .pipeline = state_->pipeline.get(),
+  };
+  XLS_ASSIGN_OR_RETURN(std::string optimized_ir,
+                       tools::OptimizeIrForTop(ir, options));
+  AddToCache(std::move(key), optimized_ir, state_->optimized_ir);
+  return optimized_ir;
+}
+
+void XlsCompilerSession::Reset() {
+  absl::MutexLock lock(&state_->mutex);
+  state_->ResetImportData();
+  state_->converted_ir.clear();
+  state_->optimized_ir.clear();
+}
+
 }  // namespace xls
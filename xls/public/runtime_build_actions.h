@@ -29,10 +29,12 @@
 // these actions remaining stable, they will evolve as the XLS system evolves.
 
 #include <filesystem>
+#include <memory>
 #include <string>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace xls {
 
@@ -96,6 +98,55 @@ absl::StatusOr<std::string> ProtoToDslx(std::string_view proto_def,
                                         std::string_view text_proto,
                                         std::string_view binding_name);
 
+// Performs the build actions above while keeping state warm between calls, for
+// callers (e.g. build system plugins) which perform many of them:
+//
+//  * Imported modules, including the standard library, are parsed and
+//    typechecked once per session rather than once per conversion.
+//  * The results of conversions and optimizations are cached keyed by a
+//    digest of their inputs, so repeated requests are answered immediately.
+//  * The optimization pass pipeline is built once.
+//
+// Imported modules are read once and assumed not to change during the
+// session; create a new session to pick up changes to them.
+//
+// Thread-safe, though calls are serialized.
+class XlsCompilerSession {
+ public:
+  // Args:
+  //  dslx_stdlib_path: Path to the DSLX standard library.
+  //  additional_search_paths: Additional filesystem paths to search for
+  //    imported modules.
+  XlsCompilerSession(
+      std::string_view dslx_stdlib_path,
+      absl::Span<const std::filesystem::path> additional_search_paths);
+  ~XlsCompilerSession();
+
+  // As the ConvertDslxToIr() function above.
+  absl::StatusOr<std::string> ConvertDslxToIr(std::string_view dslx,
+                                              std::string_view path,
+                                              std::string_view module_name);
+
+  // As the ConvertDslxPathToIr() function above. The file is read on each
+  // call.
+  absl::StatusOr<std::string> ConvertDslxPathToIr(std::filesystem::path path);
+
+  // As the OptimizeIr() function above.
+  absl::StatusOr<std::string> OptimizeIr(std::string_view ir,
+                                         std::string_view top);
+
+  // Drops cached results and imported modules, e.g. after imported files
+  // changed.
+  void Reset();
+
+ private:
+  // Defined in the source file to keep the internal dependencies of the
+  // session out of this header.
+  class State;
+
+  std::unique_ptr<State> state_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_PUBLIC_RUNTIME_BUILD_ACTIONS_H_
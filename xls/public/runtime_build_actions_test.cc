@@ -64,5 +64,45 @@ TEST(RuntimeBuildActionsTest, DefaultDslxPath) {
   EXPECT_EQ(GetDefaultDslxStdlibPath(), kDefaultDslxStdlibPath);
 }
 
+TEST(RuntimeBuildActionsTest, SessionReconvertsChangedModule) {
+  XlsCompilerSession session(kDefaultDslxStdlibPath,
+                             /*additional_search_paths=*/{});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string ir,
+      session.ConvertDslxToIr("fn f(x: u32) -> u32 { x + u32:1 }",
+                              "my_module.x", "my_module"));
+  EXPECT_THAT(ir, testing::HasSubstr("add("));
+
+  // Same module name, different text: must not see the stale module.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ir, session.ConvertDslxToIr("fn f(x: u32) -> u32 { x - u32:1 }",
+                                  "my_module.x", "my_module"));
+  EXPECT_THAT(ir, testing::HasSubstr("sub("));
+  EXPECT_THAT(ir, testing::Not(testing::HasSubstr("add(")));
+
+  EXPECT_FALSE(session
+                   .ConvertDslxToIr("fn f(x: u32) -> u32 { y }", "my_module.x",
+                                    "my_module")
+                   .ok());
+  XLS_EXPECT_OK(session.ConvertDslxToIr("fn f(x: u32) -> u32 { x }",
+                                        "my_module.x", "my_module"));
+}
+
+TEST(RuntimeBuildActionsTest, SessionOptimizesIr) {
+  XlsCompilerSession session(kDefaultDslxStdlibPath,
+                             /*additional_search_paths=*/{});
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string ir,
+      session.ConvertDslxToIr("fn f(x: u32) -> u32 { x + u32:0 }",
+                              "my_module.x", "my_module"));
+  for (int i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::string optimized,
+                             session.OptimizeIr(ir, "__my_module__f"));
+    EXPECT_THAT(optimized, testing::Not(testing::HasSubstr("add(")));
+  }
+  session.Reset();
+  XLS_EXPECT_OK(session.OptimizeIr(ir, "__my_module__f"));
+}
+
 }  // namespace
 }  // namespace xls
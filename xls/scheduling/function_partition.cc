@@ -43,9 +43,11 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
   auto sink = graph.AddNode("sink");
   std::vector<Node*> xls_nodes_in_mincut_graph;
 
-  // Maps to/from XLS Nodes to nodes in the mincut graph.
+  // Maps to/from XLS Nodes to nodes in the mincut graph. Mincut node ids are
+  // dense so the reverse map is a vector, holding nullptr for the artificial
+  // nodes.
   absl::flat_hash_map<Node*, min_cut::NodeId> xls_to_mincut_node;
-  absl::flat_hash_map<min_cut::NodeId, Node*> mincut_to_xls_node;
+  std::vector<Node*> mincut_to_xls_node = {nullptr, nullptr};
 
   const int64_t kMaxWeight = std::numeric_limits<int64_t>::max();
 
@@ -62,7 +64,7 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
     XLS_CHECK(!xls_to_mincut_node.contains(node));
     min_cut::NodeId graph_node_id = graph.AddNode(node->GetName());
     xls_to_mincut_node[node] = graph_node_id;
-    mincut_to_xls_node[graph_node_id] = node;
+    mincut_to_xls_node.push_back(node);
     xls_nodes_in_mincut_graph.push_back(node);
     return graph_node_id;
   };
@@ -152,6 +154,7 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
     //     x_fanin
     //
     min_cut::NodeId node_sink = graph.AddNode(node->GetName() + "_fanin");
+    mincut_to_xls_node.push_back(nullptr);
     int64_t weight = edge_weight(node, /*fan_out=*/successors.size());
     for (min_cut::NodeId successor : successors) {
       add_edge(xls_to_mincut_node.at(node), successor, weight);
@@ -163,23 +166,19 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
       min_cut::MinCutBetweenNodes(graph, source, sink);
 
   // Map the mincut graph partition back to the XLS graph.
-  std::pair<std::vector<Node*>, std::vector<Node*>> partitions;
-  for (min_cut::NodeId node_id : graph_cut.source_partition) {
-    if (mincut_to_xls_node.contains(node_id)) {
-      Node* node = mincut_to_xls_node.at(node_id);
-      if (partitionable_nodes_set.contains(node)) {
-        partitions.first.push_back(node);
-      }
-    }
-  }
-  for (min_cut::NodeId node_id : graph_cut.sink_partition) {
-    if (mincut_to_xls_node.contains(node_id)) {
-      Node* node = mincut_to_xls_node.at(node_id);
-      if (partitionable_nodes_set.contains(node)) {
-        partitions.second.push_back(node);
+  XLS_CHECK_EQ(mincut_to_xls_node.size(), graph.node_count());
+  auto map_partition = [&](absl::Span<const min_cut::NodeId> node_ids,
+                           std::vector<Node*>* partition) {
+    for (min_cut::NodeId node_id : node_ids) {
+      Node* node = mincut_to_xls_node[static_cast<int64_t>(node_id)];
+      if (node != nullptr && partitionable_nodes_set.contains(node)) {
+        partition->push_back(node);
       }
     }
-  }
+  };
+  std::pair<std::vector<Node*>, std::vector<Node*>> partitions;
+  map_partition(graph_cut.source_partition, &partitions.first);
+  map_partition(graph_cut.sink_partition, &partitions.second);
   if (XLS_VLOG_IS_ON(4)) {
     XLS_VLOG(4) << "Before cut";
     for (Node* node : partitions.first) {
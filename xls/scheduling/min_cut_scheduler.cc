@@ -17,7 +17,11 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <random>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
@@ -27,6 +31,8 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/ir/node_util.h"
 #include "xls/scheduling/function_partition.h"
@@ -181,11 +187,13 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
   }
 
   // Try a number of different orderings of cycle boundary at which the min-cut
-  // is performed and keep the best one.
-  int64_t best_register_count = std::numeric_limits<int64_t>::max();
-  std::optional<sched::ScheduleBounds> best_bounds;
-  for (const std::vector<int64_t>& cut_order :
-       GetMinCutCycleOrders(pipeline_stages - 1)) {
+  // is performed and keep the best one. The orderings are independent so they
+  // are tried in parallel on the shared thread pool, each with its own copy of
+  // the bounds.
+  std::vector<std::vector<int64_t>> cut_orders =
+      GetMinCutCycleOrders(pipeline_stages - 1);
+  auto try_cut_order = [&](const std::vector<int64_t>& cut_order)
+      -> absl::StatusOr<sched::ScheduleBounds> {
     XLS_VLOG(3) << absl::StreamFormat("Trying cycle order: {%s}",
                                       absl::StrJoin(cut_order, ", "));
     sched::ScheduleBounds trial_bounds = *bounds;
@@ -199,11 +207,22 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
       XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
       XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
     }
+    return trial_bounds;
+  };
+  std::vector<absl::StatusOr<sched::ScheduleBounds>> trials(cut_orders.size());
+  ParallelFor(0, cut_orders.size(),
+              [&](int64_t i) { trials[i] = try_cut_order(cut_orders[i]); });
+
+  // Ties are broken in favor of the earlier ordering.
+  int64_t best_register_count = std::numeric_limits<int64_t>::max();
+  std::optional<sched::ScheduleBounds> best_bounds;
+  for (absl::StatusOr<sched::ScheduleBounds>& trial_bounds : trials) {
+    XLS_RETURN_IF_ERROR(trial_bounds.status());
     XLS_ASSIGN_OR_RETURN(int64_t trial_register_count,
-                         CountInteriorPipelineRegisters(f, trial_bounds));
+                         CountInteriorPipelineRegisters(f, *trial_bounds));
     if (!best_bounds.has_value() ||
         best_register_count > trial_register_count) {
-      best_bounds = std::move(trial_bounds);
+      best_bounds = std::move(trial_bounds).value();
       best_register_count = trial_register_count;
     }
   }
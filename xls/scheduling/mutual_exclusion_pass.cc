@@ -15,10 +15,10 @@
 #include "xls/scheduling/mutual_exclusion_pass.h"
 
 #include <algorithm>
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <memory>
-#include <numeric>
 #include <optional>
 #include <string>
 #include <utility>
@@ -33,12 +33,15 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/graph_coloring.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/data_structures/transitive_closure.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -91,14 +94,6 @@ bool HasIntersection(const absl::flat_hash_set<T>& lhs,
                      [&bigger](T element) { return bigger.contains(element); });
 }
 
-Z3_lbool RunSolver(Z3_context c, Z3_ast asserted) {
-  Z3_solver solver = solvers::z3::CreateSolver(c, 1);
-  Z3_solver_assert(c, solver, asserted);
-  Z3_lbool satisfiable = Z3_solver_check(c, solver);
-  Z3_solver_dec_ref(c, solver);
-  return satisfiable;
-}
-
 // Returns a list of all predicates in a deterministic order, paired with their
 // index in the list.
 std::vector<std::pair<Node*, int64_t>> PredicateNodes(Predicates* p,
@@ -307,38 +302,27 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
     }
   }
 
-  // The complement of the `neighborhoods` graph
-  absl::flat_hash_map<Node*, absl::flat_hash_set<Node*>> inverted_neighborhoods;
-
-  for (Node* node : nodes) {
-    inverted_neighborhoods[node] = nodes;
-    for (Node* neighbor : neighborhoods.at(node)) {
-      inverted_neighborhoods[node].erase(neighbor);
-    }
-  }
-
   absl::flat_hash_map<Node*, int64_t> node_to_index;
   for (int64_t i = 0; i < ordered_nodes.size(); ++i) {
     node_to_index[ordered_nodes[i]] = i;
   }
 
-  std::vector<int64_t> iota(ordered_nodes.size());
-  std::iota(iota.begin(), iota.end(), 0);
-  std::vector<absl::flat_hash_set<int64_t>> coloring_indices =
-      RecursiveLargestFirstColoring<int64_t>(
-          absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
-          [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
-            absl::flat_hash_set<Node*> inv_neighbors =
-                inverted_neighborhoods.at(ordered_nodes.at(node_index));
-            absl::flat_hash_set<int64_t> result;
-            for (Node* inv_neighbor : inv_neighbors) {
-              result.insert(node_to_index.at(inv_neighbor));
-            }
-            return result;
-          });
+  // The complement of the `neighborhoods` graph, as adjacency bitmaps.
+  const int64_t n = ordered_nodes.size();
+  std::vector<InlineBitmap> inverted_adjacency(n,
+                                               InlineBitmap(n, /*fill=*/true));
+  for (int64_t i = 0; i < n; ++i) {
+    inverted_adjacency[i].Set(i, false);
+    for (Node* neighbor : neighborhoods.at(ordered_nodes[i])) {
+      inverted_adjacency[i].Set(node_to_index.at(neighbor), false);
+    }
+  }
+
+  std::vector<std::vector<int64_t>> coloring_indices =
+      RecursiveLargestFirstColoring(inverted_adjacency);
 
   std::vector<absl::flat_hash_set<Node*>> coloring;
-  for (const absl::flat_hash_set<int64_t>& color_class : coloring_indices) {
+  for (const std::vector<int64_t>& color_class : coloring_indices) {
     absl::flat_hash_set<Node*> color_node_class;
     for (int64_t index : color_class) {
       color_node_class.insert(ordered_nodes[index]);
@@ -827,18 +811,30 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
   return absl::OkStatus();
 }
 
-absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
+absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
+                                    std::optional<absl::Duration> time_budget) {
   if (f->IsBlock()) {
     return absl::OkStatus();
   }
+  absl::Time deadline = time_budget.has_value()
+                            ? absl::Now() + time_budget.value()
+                            : absl::InfiniteFuture();
 
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<solvers::z3::IrTranslator> translator,
-                       solvers::z3::IrTranslator::CreateAndTranslate(f, true));
+  // The queries about the predicates of a function base share one
+  // translation and one solver, so what the solver learns carries over.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<solvers::z3::IncrementalProver> solver,
+      solvers::z3::IncrementalProver::Create(f, /*allow_unsupported=*/true));
 
-  Z3_context ctx = translator->ctx();
+  Z3_context ctx = solver->ctx();
 
   solvers::z3::ScopedErrorHandler seh(ctx);
 
+  auto is_true = [&](Node* node) {
+    return solvers::z3::BitVectorToBoolean(
+        ctx, solver->translator()->GetTranslation(node));
+  };
+
   std::vector<std::pair<Node*, int64_t>> predicate_nodes = PredicateNodes(p, f);
 
   // Determine for each predicate whether it is always false using Z3.
@@ -846,9 +842,10 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
   // the runtime  by doing only a linear amount of Z3 calls to remove
   // quadratically many Z3 calls.
   for (const auto& [node, index] : predicate_nodes) {
-    Z3_ast translated = translator->GetTranslation(node);
-    if (RunSolver(ctx, solvers::z3::BitVectorToBoolean(ctx, translated)) ==
-        Z3_L_FALSE) {
+    if (absl::Now() >= deadline) {
+      break;
+    }
+    if (solver->Check(is_true(node)) == Z3_L_FALSE) {
       XLS_VLOG(3) << "Proved that " << node << " is always false";
       // A constant false node is mutually exclusive with all other nodes.
       for (const auto& [other, other_index] : predicate_nodes) {
@@ -886,7 +883,36 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
     }
   }
 
+  // Checks whether `a AND b` is satisfiable, which is true iff `a NAND b` is
+  // not valid, and records the answer.
+  auto check_pair = [&](Node* node_a, Node* node_b) -> absl::Status {
+    Z3_lbool satisfiable = solver->Check(
+        Z3_mk_and(ctx, 2, std::array<Z3_ast, 2>{is_true(node_a),
+                                                is_true(node_b)}
+                              .data()));
+    if (satisfiable == Z3_L_FALSE) {
+      known_true += 1;
+      return p->MarkMutuallyExclusive(node_a, node_b);
+    }
+    if (satisfiable == Z3_L_TRUE) {
+      known_false += 1;
+      return p->MarkNotMutuallyExclusive(node_a, node_b);
+    }
+    unknown += 1;
+    XLS_VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
+                << node_a->GetName() << " and " << node_b->GetName();
+    return absl::OkStatus();
+  };
+
+  // The pairs involving each predicate are checked in batches: if
+  // `a AND (b_1 OR ... OR b_n)` is unsatisfiable then `a` is mutually exclusive
+  // with every `b_i`. Otherwise every `b_i` which is true in the satisfying
+  // assignment is not mutually exclusive with `a`, and the rest are checked
+  // again. As most pairs are typically mutually exclusive or not, this needs
+  // far fewer queries than checking each pair.
+  const int64_t kMaxBatchSize = 32;
   for (const auto& [node_a, index_a] : predicate_nodes) {
+    std::vector<Node*> candidates;
     for (const auto& [node_b, index_b] : predicate_nodes) {
       // This prevents checking `a NAND b` and then later checking `b NAND a`.
       if (index_a >= index_b) {
@@ -902,34 +928,71 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f) {
           !HasIntersection(ops_for_pred.at(node_a), ops_for_pred.at(node_b))) {
         continue;
       }
+      candidates.push_back(node_b);
+    }
 
-      Z3_ast z3_a = translator->GetTranslation(node_a);
-      Z3_ast z3_b = translator->GetTranslation(node_b);
-
-      // We try to find out if `a ∧ b` is satisfiable, which is true iff
-      // `a NAND b` is not valid.
-      Z3_ast a_and_b =
-          solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
-
-      Z3_lbool satisfiable = RunSolver(ctx, a_and_b);
-
-      if (satisfiable == Z3_L_FALSE) {
-        known_true += 1;
-        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
-      } else if (satisfiable == Z3_L_TRUE) {
-        known_false += 1;
-        XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
-      } else {
-        unknown += 1;
-        XLS_VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
-                    << node_a->GetName() << " and " << node_b->GetName();
+    for (int64_t start = 0; start < candidates.size();
+         start += kMaxBatchSize) {
+      std::vector<Node*> batch(
+          candidates.begin() + start,
+          candidates.begin() +
+              std::min<int64_t>(start + kMaxBatchSize, candidates.size()));
+      while (batch.size() > 1 && absl::Now() < deadline) {
+        std::vector<Z3_ast> disjuncts;
+        for (Node* node_b : batch) {
+          disjuncts.push_back(is_true(node_b));
+        }
+        Z3_ast any_b = Z3_mk_or(ctx, disjuncts.size(), disjuncts.data());
+        Z3_lbool satisfiable = solver->Check(Z3_mk_and(
+            ctx, 2, std::array<Z3_ast, 2>{is_true(node_a), any_b}.data()));
+        if (satisfiable == Z3_L_FALSE) {
+          for (Node* node_b : batch) {
+            known_true += 1;
+            XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
+          }
+          batch.clear();
+          break;
+        }
+        if (satisfiable != Z3_L_TRUE) {
+          // The batch is too hard; check its pairs individually.
+          break;
+        }
+        std::vector<Node*> remaining;
+        for (Node* node_b : batch) {
+          if (solver->IsTrueInModel(is_true(node_b))) {
+            known_false += 1;
+            XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
+          } else {
+            remaining.push_back(node_b);
+          }
+        }
+        if (remaining.size() == batch.size()) {
+          // Unexpected, but avoid looping forever.
+          break;
+        }
+        batch = std::move(remaining);
+      }
+      for (Node* node_b : batch) {
+        if (absl::Now() >= deadline) {
+          // Pairs which are not known to be mutually exclusive are
+          // conservatively treated as not mutually exclusive.
+          unknown += 1;
+          continue;
+        }
+        XLS_RETURN_IF_ERROR(check_pair(node_a, node_b));
       }
     }
   }
+  if (absl::Now() >= deadline) {
+    XLS_VLOG(2) << "Mutual exclusion analysis of " << f->name()
+                << " exceeded its time budget";
+  }
 
   XLS_VLOG(3) << "known_false = " << known_false;
   XLS_VLOG(3) << "known_true  = " << known_true;
   XLS_VLOG(3) << "unknown     = " << unknown;
+  XLS_VLOG(3) << solver->query_count() << " queries took "
+              << solver->total_duration();
 
   XLS_RETURN_IF_ERROR(seh.status());
 
@@ -965,7 +1028,13 @@ absl::StatusOr<bool> MutualExclusionPass::RunOnFunctionBaseInternal(
 
   Predicates p;
   XLS_RETURN_IF_ERROR(AddSendReceivePredicates(&p, f));
-  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(&p, f));
+  std::optional<absl::Duration> time_budget;
+  if (options.scheduling_options.mutual_exclusion_time_budget_ms()
+          .has_value()) {
+    time_budget = absl::Milliseconds(
+        options.scheduling_options.mutual_exclusion_time_budget_ms().value());
+  }
+  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(&p, f, time_budget));
   XLS_ASSIGN_OR_RETURN(std::vector<absl::flat_hash_set<Node*>> merge_classes,
                        ComputeMergeClasses(&p, f, scm));
 
@@ -15,7 +15,10 @@
 #ifndef XLS_SCHEDULING_MUTUAL_EXCLUSION_PASS_H_
 #define XLS_SCHEDULING_MUTUAL_EXCLUSION_PASS_H_
 
+#include <optional>
+
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "xls/ir/function.h"
 #include "xls/passes/passes.h"
 #include "xls/scheduling/scheduling_pass.h"
@@ -97,8 +100,12 @@ absl::StatusOr<Node*> AddPredicate(Predicates* p, Node* node, Node* pred);
 absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f);
 
 // Use an SMT solver to populate the given `Predicates*` with information about
-// whether nodes are used in a mutually exclusive way.
-absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f);
+// whether nodes are used in a mutually exclusive way. If `time_budget` is given
+// then no further queries are made once it has elapsed; the pairs left
+// unanswered are not known to be mutually exclusive.
+absl::Status ComputeMutualExclusion(
+    Predicates* p, FunctionBase* f,
+    std::optional<absl::Duration> time_budget = std::nullopt);
 
 // Pass which merges together nodes that are determined to be mutually exclusive
 // via SMT solver analysis.
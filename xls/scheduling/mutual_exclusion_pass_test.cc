@@ -44,7 +44,9 @@ class MutualExclusionPassTest : public IrTestBase {
  protected:
   MutualExclusionPassTest() = default;
 
-  absl::StatusOr<bool> Run(FunctionBase* f) {
+  absl::StatusOr<bool> Run(
+      FunctionBase* f,
+      const SchedulingPassOptions& options = SchedulingPassOptions()) {
     PassResults results;
     bool changed = false;
     bool subpass_changed;
@@ -54,8 +56,8 @@ class MutualExclusionPassTest : public IrTestBase {
       SchedulingPassResults scheduling_results;
       XLS_ASSIGN_OR_RETURN(
           subpass_changed,
-          MutualExclusionPass().RunOnFunctionBase(
-              &unit, SchedulingPassOptions(), &scheduling_results));
+          MutualExclusionPass().RunOnFunctionBase(&unit, options,
+                                                  &scheduling_results));
       changed |= subpass_changed;
     }
     XLS_ASSIGN_OR_RETURN(
@@ -155,6 +157,40 @@ TEST_F(MutualExclusionPassTest, ThreeParallelSends) {
                        *proc->GetNode("literal.4")}));
 }
 
+TEST_F(MutualExclusionPassTest, ParallelSendsWithExhaustedTimeBudget) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
+     package test_module
+
+     chan test_channel(
+       bits[32], id=0, kind=streaming, ops=send_only,
+       flow_control=ready_valid, metadata="""""")
+
+     top proc main(__token: token, __state: bits[2], init={0}) {
+       literal.1: bits[2] = literal(value=1)
+       add.2: bits[2] = add(literal.1, __state)
+       zero_ext.3: bits[32] = zero_ext(add.2, new_bit_count=32)
+       literal.4: bits[32] = literal(value=50)
+       literal.5: bits[32] = literal(value=60)
+       literal.6: bits[32] = literal(value=70)
+       eq.7: bits[1] = eq(zero_ext.3, literal.4)
+       eq.8: bits[1] = eq(zero_ext.3, literal.5)
+       eq.9: bits[1] = eq(zero_ext.3, literal.6)
+       send.10: token = send(__token, literal.4, predicate=eq.7, channel_id=0)
+       send.11: token = send(__token, literal.5, predicate=eq.8, channel_id=0)
+       send.12: token = send(__token, literal.6, predicate=eq.9, channel_id=0)
+       after_all.13: token = after_all(send.10, send.11, send.12)
+       next (after_all.13, add.2)
+     }
+  )"));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, p->GetTopAsProc());
+  // Without time to prove anything the sends are conservatively kept apart.
+  SchedulingPassOptions options;
+  options.scheduling_options.mutual_exclusion_time_budget_ms(0);
+  XLS_ASSERT_OK(Run(proc, options).status());
+  EXPECT_EQ(NumberOfOp(proc, Op::kSend), 3);
+  XLS_EXPECT_OK(VerifyProc(proc, true));
+}
+
 TEST_F(MutualExclusionPassTest, TwoSequentialSends) {
   XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p, ParsePackage(R"(
      package test_module
@@ -16,10 +16,16 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <functional>
 #include <random>
+#include <string>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -172,7 +178,8 @@ absl::StatusOr<int64_t> ComputeCriticalPath(
 absl::StatusOr<int64_t> FindMinimumClockPeriod(
     FunctionBase* f, int64_t pipeline_stages,
     const DelayEstimator& delay_estimator,
-    absl::Span<const SchedulingConstraint> constraints) {
+    absl::Span<const SchedulingConstraint> constraints, int64_t search_threads,
+    bool sparse_timing_constraints) {
   XLS_VLOG(4) << "FindMinimumClockPeriod()";
   XLS_VLOG(4) << "  pipeline stages = " << pipeline_stages;
   auto topo_sort_it = TopoSort(f);
@@ -188,22 +195,43 @@ absl::StatusOr<int64_t> FindMinimumClockPeriod(
   int64_t search_end = function_cp;
   XLS_VLOG(4) << absl::StreamFormat("Binary searching over interval [%d, %d]",
                                     search_start, search_end);
-  XLS_ASSIGN_OR_RETURN(
-      int64_t min_period,
-      BinarySearchMinTrueWithStatus(
-          search_start, search_end,
-          [&](int64_t clk_period_ps) -> absl::StatusOr<bool> {
-            absl::StatusOr<sched::ScheduleBounds> bounds_or = ConstructBounds(
-                f, clk_period_ps, topo_sort, pipeline_stages, delay_estimator);
-            if (!bounds_or.ok()) {
-              return false;
-            }
-            sched::ScheduleBounds bounds = bounds_or.value();
-            absl::StatusOr<ScheduleCycleMap> scm =
-                SDCScheduler(f, pipeline_stages, clk_period_ps, delay_estimator,
-                             &bounds, constraints, /*check_feasibility=*/true);
-            return scm.ok();
-          }));
+  // Each worker of the search owns an SDC model which is updated for each
+  // clock period it probes rather than rebuilt. The models are independent
+  // solver instances so workers may probe concurrently.
+  int64_t worker_count = std::max<int64_t>(search_threads, 1);
+  std::vector<std::unique_ptr<SDCSchedulingModel>> models(worker_count);
+  auto is_feasible = [&](int64_t clk_period_ps,
+                         int64_t worker) -> absl::StatusOr<bool> {
+    if (models[worker] == nullptr) {
+      XLS_ASSIGN_OR_RETURN(
+          models[worker],
+          SDCSchedulingModel::Create(f, pipeline_stages, delay_estimator,
+                                     constraints, /*check_feasibility=*/true,
+                                     sparse_timing_constraints));
+    }
+    absl::StatusOr<sched::ScheduleBounds> bounds_or = ConstructBounds(
+        f, clk_period_ps, topo_sort, pipeline_stages, delay_estimator);
+    bool feasible =
+        bounds_or.ok() &&
+        models[worker]->Solve(clk_period_ps, bounds_or.value()).ok();
+    XLS_VLOG(2) << absl::StreamFormat("Clock period %dps: %s", clk_period_ps,
+                                      feasible ? "feasible" : "infeasible");
+    return feasible;
+  };
+  int64_t min_period;
+  if (worker_count > 1) {
+    XLS_ASSIGN_OR_RETURN(min_period, KarySearchMinTrueWithStatus(
+                                         search_start, search_end,
+                                         worker_count, is_feasible));
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        min_period,
+        BinarySearchMinTrueWithStatus(
+            search_start, search_end,
+            [&](int64_t clk_period_ps) -> absl::StatusOr<bool> {
+              return is_feasible(clk_period_ps, /*worker=*/0);
+            }));
+  }
   XLS_VLOG(4) << "minimum clock period = " << min_period;
 
   return min_period;
@@ -320,6 +348,10 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
         return node->op() == Op::kReceive ? base_delay + input_delay
                                           : base_delay;
       });
+  // The steps below look up the delay of each node many times. Share one
+  // precomputed table of the delays of the nodes of `f` between them.
+  CachingDelayEstimator node_delays("node_delays", input_delay_added);
+  node_delays.PrecomputeDelays(f);
 
   int64_t clock_period_ps;
   if (options.clock_period_ps().has_value()) {
@@ -344,8 +376,10 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
     // given pipeline length.
     XLS_ASSIGN_OR_RETURN(
         clock_period_ps,
-        FindMinimumClockPeriod(f, *options.pipeline_stages(), input_delay_added,
-                               options.constraints()));
+        FindMinimumClockPeriod(
+            f, *options.pipeline_stages(), node_delays, options.constraints(),
+            options.clock_period_search_threads().value_or(1),
+            options.sparse_timing_constraints()));
 
     if (options.period_relaxation_percent().has_value()) {
       int64_t relaxation_percent = options.period_relaxation_percent().value();
@@ -357,7 +391,7 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
   XLS_ASSIGN_OR_RETURN(
       sched::ScheduleBounds bounds,
       ConstructBounds(f, clock_period_ps, TopoSort(f).AsVector(),
-                      options.pipeline_stages(), input_delay_added));
+                      options.pipeline_stages(), node_delays));
   int64_t schedule_length = bounds.max_lower_bound() + 1;
   if (options.pipeline_stages().has_value()) {
     schedule_length = options.pipeline_stages().value();
@@ -377,20 +411,21 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
   if (ii > 1) {
     XLS_ASSIGN_OR_RETURN(
         bounds, ConstructBounds(f, clock_period_ps, TopoSort(f).AsVector(),
-                                schedule_length, input_delay_added));
+                                schedule_length, node_delays));
   }
 
   ScheduleCycleMap cycle_map;
   if (options.strategy() == SchedulingStrategy::MIN_CUT) {
     XLS_ASSIGN_OR_RETURN(
         cycle_map,
-        MinCutScheduler(f, schedule_length, clock_period_ps, input_delay_added,
+        MinCutScheduler(f, schedule_length, clock_period_ps, node_delays,
                         &bounds, options.constraints()));
   } else if (options.strategy() == SchedulingStrategy::SDC) {
     XLS_ASSIGN_OR_RETURN(
         cycle_map,
-        SDCScheduler(f, schedule_length, clock_period_ps, input_delay_added,
-                     &bounds, options.constraints()));
+        SDCScheduler(f, schedule_length, clock_period_ps, node_delays, &bounds,
+                     options.constraints(), /*check_feasibility=*/false,
+                     options.sparse_timing_constraints()));
   } else if (options.strategy() == SchedulingStrategy::RANDOM) {
     std::mt19937_64 gen(options.seed().value_or(0));
 
@@ -416,8 +451,7 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
 
   auto schedule = PipelineSchedule(f, cycle_map, schedule_length);
   XLS_RETURN_IF_ERROR(schedule.Verify());
-  XLS_RETURN_IF_ERROR(
-      schedule.VerifyTiming(clock_period_ps, input_delay_added));
+  XLS_RETURN_IF_ERROR(schedule.VerifyTiming(clock_period_ps, node_delays));
 
   // Verify that scheduling constraints are obeyed.
   {
@@ -458,6 +492,25 @@ std::vector<Node*> PipelineSchedule::GetLiveOutOfCycle(int64_t c) const {
           }
         }
       }
+      if (std::holds_alternative<ResourceSharingConstraint>(constraint)) {
+        const ResourceSharingConstraint& resource_constr =
+            std::get<ResourceSharingConstraint>(constraint);
+        // Each stage spans `ii` cycles.
+        int64_t capacity = resource_constr.GetUnitCount() * ii;
+        for (int64_t c = 0; c < schedule.length(); ++c) {
+          int64_t count = absl::c_count_if(
+              schedule.nodes_in_cycle(c), [&](Node* node) {
+                return node->op() == resource_constr.GetOp();
+              });
+          if (count > capacity) {
+            return absl::ResourceExhaustedError(absl::StrFormat(
+                "Scheduling constraint violated: %d %s ops were scheduled in "
+                "stage %d but at most %d may share the %d available units.",
+                count, OpToString(resource_constr.GetOp()), c, capacity,
+                resource_constr.GetUnitCount()));
+          }
+        }
+      }
     }
   }
 
@@ -567,6 +620,7 @@ absl::Status PipelineSchedule::VerifyTiming(
 PipelineScheduleProto PipelineSchedule::ToProto() const {
   PipelineScheduleProto proto;
   proto.set_function(function_base_->name());
+  proto.set_initiation_interval(ComputeInitiationInterval());
   for (int i = 0; i < cycle_to_nodes_.size(); i++) {
     StageProto* stage = proto.add_stages();
     stage->set_stage(i);
@@ -577,6 +631,50 @@ PipelineScheduleProto PipelineSchedule::ToProto() const {
   return proto;
 }
 
+int64_t PipelineSchedule::ComputeInitiationInterval() const {
+  int64_t feedback_stages = 1;
+  if (function_base_->IsProc()) {
+    Proc* proc = function_base_->AsProcOrDie();
+    for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+      Node* param = proc->GetStateParam(i);
+      Node* next = proc->GetNextStateElement(i);
+      if (IsScheduled(param) && IsScheduled(next)) {
+        feedback_stages =
+            std::max(feedback_stages, cycle(next) - cycle(param) + 1);
+      }
+    }
+  }
+  return feedback_stages * function_base_->GetInitiationInterval().value_or(1);
+}
+
+std::vector<uint64_t> PipelineSchedule::ComputeStageFingerprints() const {
+  absl::flat_hash_map<Node*, uint64_t> node_hashes;
+  std::vector<uint64_t> fingerprints(length());
+  for (Node* node : TopoSort(function_base_)) {
+    if (!IsScheduled(node)) {
+      continue;
+    }
+    int64_t stage = cycle(node);
+    // Operands from earlier stages are pipeline register inputs of this stage
+    // and contribute only their type and stage so that changes upstream do
+    // not ripple into the fingerprints of downstream stages.
+    std::vector<uint64_t> operand_hashes;
+    for (Node* operand : node->operands()) {
+      operand_hashes.push_back(
+          cycle(operand) == stage
+              ? node_hashes.at(operand)
+              : absl::HashOf(cycle(operand), operand->GetType()->ToString()));
+    }
+    uint64_t hash =
+        absl::HashOf(node->GetType()->ToString(), node->ToCanonicalString(),
+                     absl::MakeConstSpan(operand_hashes));
+    node_hashes[node] = hash;
+    fingerprints[stage] = absl::HashOf(fingerprints[stage], hash,
+                                       IsLiveOutOfCycle(node, stage));
+  }
+  return fingerprints;
+}
+
 int64_t PipelineSchedule::CountFinalInteriorPipelineRegisters() const {
   int64_t reg_count = 0;
 
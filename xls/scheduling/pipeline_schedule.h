@@ -15,6 +15,9 @@
 #ifndef XLS_SCHEDULING_PIPELINE_SCHEDULE_H_
 #define XLS_SCHEDULING_PIPELINE_SCHEDULE_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -91,6 +94,21 @@ class PipelineSchedule {
   // Returns a protobuf holding this object's scheduling info.
   PipelineScheduleProto ToProto() const;
 
+  // Returns the worst-case number of cycles between the starts of successive
+  // iterations of the pipeline, i.e., the reciprocal of its throughput. Each
+  // stage spans the initiation interval of the function base (one if not
+  // set), and an iteration of a proc cannot start until the stage computing
+  // each next state value of the previous iteration has run.
+  int64_t ComputeInitiationInterval() const;
+
+  // Returns a fingerprint of the IR scheduled in each stage. The fingerprint
+  // covers the operations, types and attributes of the nodes in the stage,
+  // the types of the values it receives from earlier stages and which of its
+  // values are live out of it, but not node names or ids. A stage whose
+  // fingerprint is unchanged between two compilations produces the same
+  // logic, so tools may skip re-emitting or re-synthesizing it.
+  std::vector<uint64_t> ComputeStageFingerprints() const;
+
   // Returns the number of internal registers in this schedule.
   int64_t CountFinalInteriorPipelineRegisters() const;
 
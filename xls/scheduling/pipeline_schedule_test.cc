@@ -14,8 +14,15 @@
 
 #include "xls/scheduling/pipeline_schedule.h"
 
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
@@ -28,6 +35,8 @@
 #include "xls/ir/node.h"
 #include "xls/ir/op.h"
 #include "xls/ir/type.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/sdc_scheduler.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -848,5 +857,207 @@ TEST_F(PipelineScheduleTest, RandomSchedule) {
   }
 }
 
+TEST_F(PipelineScheduleTest, SdcModelReusedAcrossClockPeriods) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(8));
+  for (int64_t i = 0; i < 8; ++i) {
+    x = fb.Negate(x);
+  }
+  fb.Concat({x, fb.Not(y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SDCSchedulingModel> model,
+      SDCSchedulingModel::Create(func, /*pipeline_stages=*/10,
+                                 TestDelayEstimator(), /*constraints=*/{}));
+  // Solving the model with a sequence of clock periods gives the same results
+  // as scheduling from scratch with each clock period.
+  for (auto [clock_period_ps, bounds_clock_period_ps] :
+       std::vector<std::pair<int64_t, int64_t>>{
+           {9, 9}, {2, 2}, {1, 2}, {3, 3}, {2, 2}, {9, 9}}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        sched::ScheduleBounds bounds,
+        sched::ScheduleBounds::ComputeAsapAndAlapBounds(
+            func, bounds_clock_period_ps, TestDelayEstimator()));
+    absl::StatusOr<ScheduleCycleMap> expected =
+        SDCScheduler(func, /*pipeline_stages=*/10, clock_period_ps,
+                     TestDelayEstimator(), &bounds, /*constraints=*/{});
+    absl::StatusOr<ScheduleCycleMap> actual =
+        model->Solve(clock_period_ps, bounds);
+    ASSERT_EQ(actual.ok(), expected.ok()) << clock_period_ps;
+    if (expected.ok()) {
+      EXPECT_EQ(actual.value(), expected.value()) << clock_period_ps;
+    }
+  }
+}
+
+TEST_F(PipelineScheduleTest, ParallelClockPeriodSearch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  for (int64_t i = 0; i < 20; ++i) {
+    x = fb.Negate(x);
+    if (i % 3 == 0) {
+      y = fb.Not(y);
+    }
+  }
+  fb.Concat({x, y});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  for (int64_t pipeline_stages : {1, 3, 7}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule serial,
+        PipelineSchedule::Run(
+            func, TestDelayEstimator(),
+            SchedulingOptions().pipeline_stages(pipeline_stages)));
+    // Searching for the minimum clock period with several concurrent probes
+    // finds the same clock period, and so the same schedule, as the serial
+    // search.
+    for (int64_t threads : {2, 3, 8}) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          PipelineSchedule parallel,
+          PipelineSchedule::Run(func, TestDelayEstimator(),
+                                SchedulingOptions()
+                                    .pipeline_stages(pipeline_stages)
+                                    .clock_period_search_threads(threads)));
+      EXPECT_EQ(parallel.GetCycleMap(), serial.GetCycleMap())
+          << pipeline_stages << " stages, " << threads << " threads";
+    }
+  }
+}
+
+TEST_F(PipelineScheduleTest, SparseTimingConstraints) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto z = fb.Param("z", p->GetBitsType(32));
+  for (int64_t i = 0; i < 6; ++i) {
+    auto sum = fb.Add(x, y);
+    y = fb.Negate(fb.Concat({fb.BitSlice(sum, 0, 16), fb.BitSlice(z, 8, 16)}));
+    x = fb.Not(fb.Subtract(sum, z));
+    z = fb.UMul(y, x);
+  }
+  fb.Tuple({x, y, z});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // Deriving the timing constraints from nearby nodes only gives schedules of
+  // the same length and register count as deriving them from all pairs, both
+  // when searching for the clock period and when it is given.
+  std::vector<SchedulingOptions> all_options;
+  for (int64_t pipeline_stages : {2, 5, 11}) {
+    all_options.push_back(SchedulingOptions().pipeline_stages(pipeline_stages));
+  }
+  for (int64_t clock_period_ps : {2, 3, 7}) {
+    all_options.push_back(SchedulingOptions().clock_period_ps(clock_period_ps));
+  }
+  for (SchedulingOptions& options : all_options) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule exact,
+        PipelineSchedule::Run(func, TestDelayEstimator(), options));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule sparse,
+        PipelineSchedule::Run(func, TestDelayEstimator(),
+                              options.sparse_timing_constraints(true)));
+    EXPECT_EQ(sparse.length(), exact.length());
+    EXPECT_EQ(sparse.CountFinalInteriorPipelineRegisters(),
+              exact.CountFinalInteriorPipelineRegisters());
+    XLS_EXPECT_OK(sparse.Verify());
+  }
+}
+
+TEST_F(PipelineScheduleTest, ResourceSharingConstraint) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  std::vector<BValue> products;
+  for (int64_t i = 0; i < 4; ++i) {
+    products.push_back(fb.UMul(x, fb.Add(y, fb.Literal(UBits(i, 32)))));
+  }
+  fb.Tuple(products);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  for (int64_t units : {1, 2}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        PipelineSchedule::Run(
+            func, TestDelayEstimator(),
+            SchedulingOptions().pipeline_stages(4 / units).add_constraint(
+                ResourceSharingConstraint(Op::kUMul, units))));
+    // Without the constraint the multiplies would all be scheduled in the
+    // same stage.
+    for (int64_t c = 0; c < schedule.length(); ++c) {
+      EXPECT_EQ(absl::c_count_if(
+                    schedule.nodes_in_cycle(c),
+                    [](Node* node) { return node->op() == Op::kUMul; }),
+                units)
+          << "stage " << c;
+    }
+  }
+}
+
+TEST_F(PipelineScheduleTest, InitiationIntervalOfProc) {
+  Package p("p");
+  TokenlessProcBuilder pb("the_proc", "tkn", &p);
+  BValue st = pb.StateElement("st", Value(UBits(42, 16)));
+  BValue next = pb.Negate(pb.Not(st));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({next}));
+
+  ScheduleCycleMap cycle_map;
+  for (Node* node : proc->nodes()) {
+    cycle_map[node] = node == next.node() ? 1 : 0;
+  }
+  PipelineSchedule schedule(proc, cycle_map, 2);
+  // The next state is computed a stage after the state is read so a new
+  // iteration may only start every other cycle.
+  EXPECT_EQ(schedule.ComputeInitiationInterval(), 2);
+
+  proc->SetInitiationInterval(3);
+  EXPECT_EQ(schedule.ComputeInitiationInterval(), 6);
+  EXPECT_EQ(schedule.ToProto().initiation_interval(), 6);
+}
+
+TEST_F(PipelineScheduleTest, StageFingerprints) {
+  // Schedules (x + y) * k over two stages with the multiply and the literal k
+  // in the second stage.
+  auto p = CreatePackage();
+  auto schedule_fn = [&](std::string_view name,
+                         int64_t k) -> absl::StatusOr<PipelineSchedule> {
+    FunctionBuilder fb(name, p.get());
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    BValue y = fb.Param("y", p->GetBitsType(8));
+    BValue sum = fb.Add(x, y);
+    BValue literal = fb.Literal(UBits(k, 8));
+    BValue product = fb.UMul(sum, literal);
+    XLS_ASSIGN_OR_RETURN(Function * f, fb.BuildWithReturnValue(product));
+    ScheduleCycleMap cycle_map;
+    for (Node* node : f->nodes()) {
+      cycle_map[node] =
+          node == literal.node() || node == product.node() ? 1 : 0;
+    }
+    return PipelineSchedule(f, cycle_map, 2);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule a, schedule_fn("a", 3));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule b, schedule_fn("b", 3));
+  XLS_ASSERT_OK_AND_ASSIGN(PipelineSchedule c, schedule_fn("c", 5));
+
+  std::vector<uint64_t> a_fingerprints = a.ComputeStageFingerprints();
+  std::vector<uint64_t> b_fingerprints = b.ComputeStageFingerprints();
+  std::vector<uint64_t> c_fingerprints = c.ComputeStageFingerprints();
+  ASSERT_EQ(a_fingerprints.size(), 2);
+  EXPECT_NE(a_fingerprints[0], a_fingerprints[1]);
+
+  // The nodes of `b` have different ids and names from those of `a`.
+  EXPECT_EQ(a_fingerprints, b_fingerprints);
+
+  // Changing the literal only changes the fingerprint of the second stage.
+  EXPECT_EQ(a_fingerprints[0], c_fingerprints[0]);
+  EXPECT_NE(a_fingerprints[1], c_fingerprints[1]);
+}
+
 }  // namespace
 }  // namespace xls
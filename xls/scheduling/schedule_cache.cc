@@ -0,0 +1,184 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_cache.h"
+
+#include <utility>
+#include <variant>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/op.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+
+namespace xls {
+namespace {
+
+std::string OptionalToString(std::optional<int64_t> value) {
+  return value.has_value() ? absl::StrCat(value.value()) : "none";
+}
+
+std::string ConstraintToString(const SchedulingConstraint& constraint) {
+  if (std::holds_alternative<IOConstraint>(constraint)) {
+    const IOConstraint& c = std::get<IOConstraint>(constraint);
+    return absl::StrFormat(
+        "io(%s:%d:%s:%d:%d:%d)", c.SourceChannel(),
+        static_cast<int>(c.SourceDirection()), c.TargetChannel(),
+        static_cast<int>(c.TargetDirection()), c.MinimumLatency(),
+        c.MaximumLatency());
+  }
+  if (std::holds_alternative<NodeInCycleConstraint>(constraint)) {
+    const NodeInCycleConstraint& c =
+        std::get<NodeInCycleConstraint>(constraint);
+    return absl::StrFormat("node_in_cycle(%s:%d)", c.GetNode()->GetName(),
+                           c.GetCycle());
+  }
+  if (std::holds_alternative<DifferenceConstraint>(constraint)) {
+    const DifferenceConstraint& c = std::get<DifferenceConstraint>(constraint);
+    return absl::StrFormat("difference(%s:%s:%d)", c.GetA()->GetName(),
+                           c.GetB()->GetName(), c.GetMaxDifference());
+  }
+  if (std::holds_alternative<RecvsFirstSendsLastConstraint>(constraint)) {
+    return "recvs_first_sends_last";
+  }
+  if (std::holds_alternative<BackedgeConstraint>(constraint)) {
+    return "backedge";
+  }
+  const ResourceSharingConstraint& c =
+      std::get<ResourceSharingConstraint>(constraint);
+  return absl::StrFormat("resource_sharing(%s:%d)", OpToString(c.GetOp()),
+                         c.GetUnitCount());
+}
+
+// Parses the package and schedule of `entry` and verifies the schedule.
+absl::StatusOr<CachedSchedule> ParseEntry(
+    const ScheduleCacheEntryProto& entry, const DelayEstimator& delay_estimator,
+    std::optional<int64_t> clock_period_ps) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(entry.scheduled_ir()));
+  XLS_ASSIGN_OR_RETURN(FunctionBase * top, package->GetFunctionBaseByName(
+                                               entry.schedule().function()));
+  XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
+                       PipelineSchedule::FromProto(top, entry.schedule()));
+  XLS_RETURN_IF_ERROR(schedule.Verify());
+  if (clock_period_ps.has_value()) {
+    XLS_RETURN_IF_ERROR(
+        schedule.VerifyTiming(clock_period_ps.value(), delay_estimator));
+  }
+  return CachedSchedule{.package = std::move(package),
+                        .schedule = std::move(schedule)};
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<ScheduleCache>>
+ScheduleCache::Create(const std::filesystem::path& directory) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new ScheduleCache(directory));
+}
+
+/* static */ std::string ScheduleCache::ComputeKey(
+    std::string_view ir, const SchedulingOptions& options,
+    std::string_view delay_model_name) {
+  std::string key = absl::StrFormat(
+      "delay_model: %s\n"
+      "strategy: %d\n"
+      "clock_period_ps: %s\n"
+      "pipeline_stages: %s\n"
+      "clock_margin_percent: %s\n"
+      "period_relaxation_percent: %s\n"
+      "additional_input_delay_ps: %s\n"
+      "clock_period_search_threads: %s\n"
+      "sparse_timing_constraints: %d\n"
+      "seed: %s\n"
+      "mutual_exclusion_z3_rlimit: %s\n"
+      "mutual_exclusion_time_budget_ms: %s\n",
+      delay_model_name, static_cast<int>(options.strategy()),
+      OptionalToString(options.clock_period_ps()),
+      OptionalToString(options.pipeline_stages()),
+      OptionalToString(options.clock_margin_percent()),
+      OptionalToString(options.period_relaxation_percent()),
+      OptionalToString(options.additional_input_delay_ps()),
+      OptionalToString(options.clock_period_search_threads()),
+      options.sparse_timing_constraints(), OptionalToString(options.seed()),
+      OptionalToString(options.mutual_exclusion_z3_rlimit()),
+      OptionalToString(options.mutual_exclusion_time_budget_ms()));
+  for (const SchedulingConstraint& constraint : options.constraints()) {
+    absl::StrAppend(&key, "constraint: ", ConstraintToString(constraint),
+                    "\n");
+  }
+  // The IR goes last so the components of the key need no delimiting.
+  absl::StrAppend(&key, "ir:\n", ir);
+  return key;
+}
+
+absl::StatusOr<std::optional<CachedSchedule>> ScheduleCache::Lookup(
+    std::string_view key, const DelayEstimator& delay_estimator,
+    std::optional<int64_t> clock_period_ps) {
+  std::string digest = ContentDigest({key});
+  std::filesystem::path path = cache_.EntryPath(digest);
+  XLS_ASSIGN_OR_RETURN(std::optional<std::string> contents,
+                       cache_.Read(digest));
+  if (!contents.has_value()) {
+    ++miss_count_;
+    return std::nullopt;
+  }
+
+  ScheduleCacheEntryProto entry;
+  if (!entry.ParseFromString(*contents)) {
+    XLS_LOG(WARNING) << "Ignoring corrupt schedule cache entry: " << path;
+    ++miss_count_;
+    return std::nullopt;
+  }
+  if (entry.key() != key) {
+    // A digest collision; the entry will be replaced by the caller.
+    XLS_VLOG(1) << "Schedule cache entry " << path << " has a different key";
+    ++miss_count_;
+    return std::nullopt;
+  }
+  absl::StatusOr<CachedSchedule> cached =
+      ParseEntry(entry, delay_estimator, clock_period_ps);
+  if (!cached.ok()) {
+    XLS_LOG(WARNING) << "Ignoring invalid schedule cache entry " << path
+                     << ": " << cached.status();
+    ++miss_count_;
+    return std::nullopt;
+  }
+  ++hit_count_;
+  XLS_VLOG(1) << "Schedule cache hit: " << path;
+  return std::move(cached).value();
+}
+
+absl::Status ScheduleCache::Insert(std::string_view key,
+                                   const PipelineSchedule& schedule) {
+  ScheduleCacheEntryProto entry;
+  entry.set_key(std::string(key));
+  entry.set_scheduled_ir(schedule.function_base()->package()->DumpIr());
+  *entry.mutable_schedule() = schedule.ToProto();
+
+  std::string digest = ContentDigest({key});
+  std::filesystem::path path = cache_.EntryPath(digest);
+  XLS_RETURN_IF_ERROR(cache_.Write(digest, entry.SerializeAsString()));
+  XLS_VLOG(1) << "Added schedule cache entry: " << path;
+  return absl::OkStatus();
+}
+
+}  // namespace xls
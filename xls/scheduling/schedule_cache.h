@@ -0,0 +1,97 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SCHEDULING_SCHEDULE_CACHE_H_
+#define XLS_SCHEDULING_SCHEDULE_CACHE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+
+// A schedule loaded from a ScheduleCache along with the package it schedules.
+struct CachedSchedule {
+  // The package as transformed by the scheduling pass pipeline.
+  std::unique_ptr<Package> package;
+  // The schedule of the top entity of `package`.
+  PipelineSchedule schedule;
+};
+
+// A persistent on-disk cache of the results of the scheduling pass pipeline.
+// Entries are stored as individual files in a directory and keyed by
+// everything which determines the schedule: the IR of the package before
+// scheduling (which includes the top entity), the scheduling options and the
+// name of the delay model. As the scheduling pass pipeline transforms the IR,
+// an entry holds the scheduled IR as well as the schedule.
+//
+// Loaded schedules are verified before they are returned and entries which
+// fail verification are treated as misses. Entries are never evicted.
+class ScheduleCache {
+ public:
+  // Creates a cache backed by `directory`, which is created if it does not
+  // exist.
+  static absl::StatusOr<std::unique_ptr<ScheduleCache>> Create(
+      const std::filesystem::path& directory);
+
+  // Returns the cache key for scheduling the package with the given IR using
+  // the given options and delay model.
+  static std::string ComputeKey(std::string_view ir,
+                                const SchedulingOptions& options,
+                                std::string_view delay_model_name);
+
+  // Returns the schedule associated with `key` or std::nullopt if no valid
+  // entry exists. The schedule is checked with PipelineSchedule::Verify and,
+  // if `clock_period_ps` is given, with PipelineSchedule::VerifyTiming.
+  absl::StatusOr<std::optional<CachedSchedule>> Lookup(
+      std::string_view key, const DelayEstimator& delay_estimator,
+      std::optional<int64_t> clock_period_ps);
+
+  // Adds `schedule` and the IR of the package it schedules to the cache under
+  // `key`.
+  absl::Status Insert(std::string_view key, const PipelineSchedule& schedule);
+
+  const std::filesystem::path& directory() const { return cache_.directory(); }
+
+  // Returns the number of lookups which did/did not find a valid entry.
+  int64_t hit_count() const { return hit_count_; }
+  int64_t miss_count() const { return miss_count_; }
+
+ private:
+  static constexpr std::string_view kEntrySuffix = ".schedule";
+
+  explicit ScheduleCache(const std::filesystem::path& directory)
+      : cache_(directory, kEntrySuffix) {}
+
+  // Entries are named by a digest of the key and hold the key itself so
+  // lookups can detect collisions.
+  ContentAddressedCache cache_;
+  int64_t hit_count_ = 0;
+  int64_t miss_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_SCHEDULE_CACHE_H_
@@ -0,0 +1,99 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/scheduling/schedule_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/scheduling_options.h"
+
+namespace xls {
+namespace {
+
+class ScheduleCacheTest : public IrTestBase {};
+
+TEST_F(ScheduleCacheTest, InsertAndLookup) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  fb.Negate(fb.Not(fb.Negate(x)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK(p->SetTop(f));
+
+  SchedulingOptions options = SchedulingOptions().clock_period_ps(2);
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ScheduleCache> cache,
+                           ScheduleCache::Create(temp_dir.path()));
+  std::string key = ScheduleCache::ComputeKey(p->DumpIr(), options, "test");
+  XLS_ASSERT_OK_AND_ASSIGN(std::optional<CachedSchedule> cached,
+                           cache->Lookup(key, TestDelayEstimator(), 2));
+  EXPECT_FALSE(cached.has_value());
+  EXPECT_EQ(cache->miss_count(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(f, TestDelayEstimator(), options));
+  XLS_ASSERT_OK(cache->Insert(key, schedule));
+
+  // The cache persists across instances.
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ScheduleCache> other_cache,
+                           ScheduleCache::Create(temp_dir.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(cached,
+                           other_cache->Lookup(key, TestDelayEstimator(), 2));
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(other_cache->hit_count(), 1);
+  EXPECT_EQ(cached->package->DumpIr(), p->DumpIr());
+  EXPECT_EQ(cached->schedule.length(), schedule.length());
+  for (Node* node : f->nodes()) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Node * cached_node,
+        cached->schedule.function_base()->GetNode(node->GetName()));
+    EXPECT_EQ(cached->schedule.cycle(cached_node), schedule.cycle(node));
+  }
+
+  // A schedule which does not meet the requested clock period is not used.
+  XLS_ASSERT_OK_AND_ASSIGN(cached,
+                           cache->Lookup(key, TestDelayEstimator(), 1));
+  EXPECT_FALSE(cached.has_value());
+}
+
+TEST_F(ScheduleCacheTest, KeyDependsOnAllComponents) {
+  SchedulingOptions options = SchedulingOptions().clock_period_ps(2);
+  std::string key = ScheduleCache::ComputeKey("ir", options, "model");
+  EXPECT_EQ(key, ScheduleCache::ComputeKey("ir", options, "model"));
+  EXPECT_NE(key, ScheduleCache::ComputeKey("ir2", options, "model"));
+  EXPECT_NE(key, ScheduleCache::ComputeKey("ir", options, "model2"));
+  EXPECT_NE(key, ScheduleCache::ComputeKey(
+                     "ir", SchedulingOptions().clock_period_ps(3), "model"));
+  EXPECT_NE(key, ScheduleCache::ComputeKey(
+                     "ir", SchedulingOptions().pipeline_stages(2), "model"));
+  EXPECT_NE(key,
+            ScheduleCache::ComputeKey(
+                "ir", SchedulingOptions(options).add_constraint(
+                          ResourceSharingConstraint(Op::kUMul, 1)),
+                "model"));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,264 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Benchmarks of the pipeline schedulers over a fixed corpus of designs: the
+// IR examples, the floating-point modules, AES and synthetic unrolled
+// multiply-accumulate chains. For each design the SDC and min-cut schedulers
+// are timed at a fixed clock period, as are the search for the minimum clock
+// period of a fixed number of stages and the verification of a schedule.
+//
+// Besides the time, each benchmark reports the number of nodes, the number of
+// stages and the peak resident set size of the process so far (run a single
+// benchmark with --benchmark_filter for a per-design figure); the SDC
+// benchmarks also report the size of the LP. To track regressions save the
+// results with --benchmark_out=<file> --benchmark_out_format=json and compare
+// runs with Google Benchmark's tools/compare.py.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/analyze_critical_path.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/examples/sample_packages.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/standard_pipeline.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/schedule_bounds.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/scheduling/sdc_scheduler.h"
+
+namespace xls {
+namespace {
+
+// The number of stages of the schedules in the benchmarks. The fixed clock
+// period of each design is chosen so its critical path spans about this many
+// stages.
+constexpr int64_t kPipelineStages = 4;
+
+struct Design {
+  std::string name;
+  std::unique_ptr<Package> package;
+  FunctionBase* top;
+  int64_t clock_period_ps;
+};
+
+// Returns the fixed clock period for `f`: the critical-path delay divided by
+// kPipelineStages, but at least the largest delay of a single node.
+absl::StatusOr<int64_t> ChooseClockPeriod(
+    FunctionBase* f, const DelayEstimator& delay_estimator) {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<CriticalPathEntry> critical_path,
+      AnalyzeCriticalPath(f, /*clock_period_ps=*/std::nullopt,
+                          delay_estimator));
+  int64_t clock_period_ps = std::max<int64_t>(
+      CeilOfRatio(critical_path.front().path_delay_ps, kPipelineStages), 1);
+  for (Node* node : f->nodes()) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay,
+                         delay_estimator.GetOperationDelayInPs(node));
+    clock_period_ps = std::max(clock_period_ps, delay);
+  }
+  return clock_period_ps;
+}
+
+// Returns a package with a function computing the sum of `taps` products of
+// pairs of parameters as a single chain of adds, as a loop would after
+// unrolling.
+std::unique_ptr<Package> BuildUnrolledMac(int64_t taps) {
+  auto package = std::make_unique<Package>(absl::StrCat("mac", taps));
+  FunctionBuilder fb("mac", package.get());
+  Type* u32 = package->GetBitsType(32);
+  BValue accumulator = fb.Literal(UBits(0, 32));
+  for (int64_t i = 0; i < taps; ++i) {
+    BValue product = fb.UMul(fb.Param(absl::StrCat("x", i), u32),
+                             fb.Param(absl::StrCat("c", i), u32));
+    accumulator = fb.Add(accumulator, product);
+  }
+  Function* f = fb.BuildWithReturnValue(accumulator).value();
+  XLS_CHECK_OK(package->SetTop(f));
+  return package;
+}
+
+absl::StatusOr<std::vector<std::unique_ptr<Package>>> LoadCorpus(
+    std::vector<std::string>* names) {
+  std::vector<std::unique_ptr<Package>> packages;
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> example_names,
+                       sample_packages::GetBenchmarkNames());
+  for (const std::string& name :
+       {"modules/fp/fp32_add_2", "modules/fp/fp32_mul_2",
+        "modules/fp/fp64_add_2", "modules/fp/fp64_mul_2"}) {
+    example_names.push_back(name);
+  }
+  for (const std::string& name : example_names) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         sample_packages::GetBenchmark(name, true));
+    packages.push_back(std::move(package));
+    names->push_back(name);
+  }
+
+  // Only the unoptimized IR of AES is built.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> aes,
+      sample_packages::GetBenchmark("modules/aes/aes_encrypt", false));
+  XLS_RETURN_IF_ERROR(RunStandardPassPipeline(aes.get()).status());
+  packages.push_back(std::move(aes));
+  names->push_back("modules/aes/aes_encrypt");
+
+  for (int64_t taps : {64, 256, 1024}) {
+    packages.push_back(BuildUnrolledMac(taps));
+    names->push_back(absl::StrCat("synthetic/mac", taps));
+  }
+  return packages;
+}
+
+void SetCounters(benchmark::State& state, const Design& design,
+                 const PipelineSchedule& schedule) {
+  state.counters["nodes"] = design.top->node_count();
+  state.counters["stages"] = schedule.length();
+  state.counters["peak_rss_mb"] =
+      static_cast<double>(GetPeakRssBytes()) / (1024 * 1024);
+}
+
+void BM_Schedule(benchmark::State& state, const Design* design,
+                 SchedulingStrategy strategy) {
+  SchedulingOptions options =
+      SchedulingOptions(strategy).clock_period_ps(design->clock_period_ps);
+  const DelayEstimator& delay_estimator = GetStandardDelayEstimator();
+  std::optional<PipelineSchedule> schedule;
+  for (auto _ : state) {
+    schedule = PipelineSchedule::Run(design->top, delay_estimator, options)
+                   .value();
+  }
+  SetCounters(state, *design, *schedule);
+  if (strategy == SchedulingStrategy::SDC) {
+    // Rebuild the LP outside of the timed loop to report its size.
+    sched::ScheduleBounds bounds =
+        sched::ScheduleBounds::ComputeAsapAndAlapBounds(
+            design->top, design->clock_period_ps, delay_estimator)
+            .value();
+    std::unique_ptr<SDCSchedulingModel> model =
+        SDCSchedulingModel::Create(design->top, bounds.max_lower_bound() + 1,
+                                   delay_estimator, options.constraints())
+            .value();
+    XLS_CHECK_OK(model->Solve(design->clock_period_ps, bounds).status());
+    state.counters["lp_variables"] = model->variable_count();
+    state.counters["lp_constraints"] = model->constraint_count();
+  }
+}
+
+void BM_ClockPeriodSearch(benchmark::State& state, const Design* design) {
+  SchedulingOptions options = SchedulingOptions(SchedulingStrategy::SDC)
+                                  .pipeline_stages(kPipelineStages);
+  std::optional<PipelineSchedule> schedule;
+  for (auto _ : state) {
+    schedule = PipelineSchedule::Run(design->top, GetStandardDelayEstimator(),
+                                     options)
+                   .value();
+  }
+  SetCounters(state, *design, *schedule);
+}
+
+void BM_Verify(benchmark::State& state, const Design* design) {
+  const DelayEstimator& delay_estimator = GetStandardDelayEstimator();
+  PipelineSchedule schedule =
+      PipelineSchedule::Run(
+          design->top, delay_estimator,
+          SchedulingOptions().clock_period_ps(design->clock_period_ps))
+          .value();
+  for (auto _ : state) {
+    XLS_CHECK_OK(schedule.Verify());
+    XLS_CHECK_OK(
+        schedule.VerifyTiming(design->clock_period_ps, delay_estimator));
+  }
+  SetCounters(state, *design, schedule);
+}
+
+// Loads the corpus and registers the benchmarks of each design. Designs which
+// cannot be scheduled are skipped with a warning.
+absl::Status RegisterBenchmarks(std::vector<Design>* designs) {
+  std::vector<std::string> names;
+  XLS_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<Package>> packages,
+                       LoadCorpus(&names));
+  const DelayEstimator& delay_estimator = GetStandardDelayEstimator();
+  designs->reserve(packages.size());
+  for (int64_t i = 0; i < packages.size(); ++i) {
+    std::optional<FunctionBase*> top = packages[i]->GetTop();
+    if (!top.has_value()) {
+      XLS_LOG(WARNING) << "Skipping " << names[i] << ": no top entity";
+      continue;
+    }
+    absl::StatusOr<int64_t> clock_period_ps =
+        ChooseClockPeriod(top.value(), delay_estimator);
+    absl::Status status = clock_period_ps.status();
+    if (status.ok()) {
+      status = PipelineSchedule::Run(top.value(), delay_estimator,
+                                     SchedulingOptions().clock_period_ps(
+                                         clock_period_ps.value()))
+                   .status();
+    }
+    if (!status.ok()) {
+      XLS_LOG(WARNING) << "Skipping " << names[i] << ": " << status;
+      continue;
+    }
+    designs->push_back(Design{.name = names[i],
+                              .package = std::move(packages[i]),
+                              .top = top.value(),
+                              .clock_period_ps = clock_period_ps.value()});
+  }
+
+  // Register after loading so pointers into `designs` are stable.
+  for (const Design& design : *designs) {
+    benchmark::RegisterBenchmark(absl::StrCat("BM_Sdc/", design.name).c_str(),
+                                 BM_Schedule, &design, SchedulingStrategy::SDC)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(
+        absl::StrCat("BM_MinCut/", design.name).c_str(), BM_Schedule, &design,
+        SchedulingStrategy::MIN_CUT)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(
+        absl::StrCat("BM_ClockPeriodSearch/", design.name).c_str(),
+        BM_ClockPeriodSearch, &design)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(
+        absl::StrCat("BM_Verify/", design.name).c_str(), BM_Verify, &design)
+        ->Unit(benchmark::kMicrosecond);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  benchmark::Initialize(&argc, argv);
+  xls::InitXls(argv[0], argc, argv);
+  std::vector<xls::Design> designs;
+  XLS_QCHECK_OK(xls::RegisterBenchmarks(&designs));
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
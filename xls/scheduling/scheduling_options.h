@@ -21,6 +21,7 @@
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/op.h"
 #include "xls/ir/proc.h"
 
 namespace xls {
@@ -133,9 +134,31 @@ class BackedgeConstraint {
   BackedgeConstraint() = default;
 };
 
+// Operations of kind `op` (e.g., umul) share `unit_count` functional units,
+// each of which starts at most one operation per cycle. As each stage spans
+// the initiation interval of the function base (one if not set), a stage may
+// contain at most `unit_count * II` such operations. Only supported by the SDC
+// scheduler, which expresses the limit as difference constraints: the
+// operations are ordered topologically, their cycles must not decrease along
+// that order, and each must be scheduled in an earlier stage than the
+// operation `unit_count * II` places later in the order.
+class ResourceSharingConstraint {
+ public:
+  ResourceSharingConstraint(Op op, int64_t unit_count)
+      : op_(op), unit_count_(unit_count) {}
+
+  Op GetOp() const { return op_; }
+  int64_t GetUnitCount() const { return unit_count_; }
+
+ private:
+  Op op_;
+  int64_t unit_count_;
+};
+
 using SchedulingConstraint =
     std::variant<IOConstraint, NodeInCycleConstraint, DifferenceConstraint,
-                 RecvsFirstSendsLastConstraint, BackedgeConstraint>;
+                 RecvsFirstSendsLastConstraint, BackedgeConstraint,
+                 ResourceSharingConstraint>;
 
 // Options to use when generating a pipeline schedule. At least a clock period
 // or a pipeline length (or both) must be specified. See
@@ -197,6 +220,27 @@ class SchedulingOptions {
     return additional_input_delay_ps_;
   }
 
+  // The number of clock periods probed concurrently when searching for the
+  // minimum clock period. Each probe runs on its own thread with its own
+  // solver instance. Only used if the clock period is not specified.
+  SchedulingOptions& clock_period_search_threads(int64_t value) {
+    clock_period_search_threads_ = value;
+    return *this;
+  }
+  std::optional<int64_t> clock_period_search_threads() const {
+    return clock_period_search_threads_;
+  }
+
+  // Whether the SDC scheduler derives its timing constraints from the
+  // critical-path distances between nodes at most one clock period apart
+  // rather than between all pairs of nodes. The feasible schedules are the
+  // same but far less memory is required for large functions.
+  SchedulingOptions& sparse_timing_constraints(bool value) {
+    sparse_timing_constraints_ = value;
+    return *this;
+  }
+  bool sparse_timing_constraints() const { return sparse_timing_constraints_; }
+
   // Add a constraint to the set of scheduling constraints.
   SchedulingOptions& add_constraint(const SchedulingConstraint& constraint) {
     constraints_.push_back(constraint);
@@ -226,16 +270,32 @@ class SchedulingOptions {
     return mutual_exclusion_z3_rlimit_;
   }
 
+  // The wall-clock time the mutual exclusion analysis of each function base may
+  // spend in the solver. Pairs of predicates left unanswered when it runs out
+  // are treated as not mutually exclusive.
+  SchedulingOptions& mutual_exclusion_time_budget_ms(int64_t value) {
+    mutual_exclusion_time_budget_ms_ = value;
+    return *this;
+  }
+  std::optional<int64_t> mutual_exclusion_time_budget_ms() const {
+    return mutual_exclusion_time_budget_ms_;
+  }
+
  private:
+  // LINT.IfChange
   SchedulingStrategy strategy_;
   std::optional<int64_t> clock_period_ps_;
   std::optional<int64_t> pipeline_stages_;
   std::optional<int64_t> clock_margin_percent_;
   std::optional<int64_t> period_relaxation_percent_;
   std::optional<int64_t> additional_input_delay_ps_;
+  std::optional<int64_t> clock_period_search_threads_;
+  bool sparse_timing_constraints_ = false;
   std::vector<SchedulingConstraint> constraints_;
   std::optional<int32_t> seed_;
   std::optional<int64_t> mutual_exclusion_z3_rlimit_;
+  std::optional<int64_t> mutual_exclusion_time_budget_ms_;
+  // LINT.ThenChange(//xls/scheduling/schedule_cache.cc)
 };
 
 // A map from node to cycle as a bare-bones representation of a schedule.
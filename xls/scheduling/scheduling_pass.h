@@ -15,7 +15,10 @@
 #ifndef XLS_SCHEDULING_SCHEDULING_PASS_H_
 #define XLS_SCHEDULING_SCHEDULING_PASS_H_
 
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <type_traits>
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
@@ -50,6 +53,13 @@ struct SchedulingUnit {
     return out;
   }
   std::string name() const { return ir->name(); }
+  int64_t GetNodeCount() const {
+    if constexpr (std::is_same_v<IrT, Package*>) {
+      return ir->GetNodeCount();
+    } else {
+      return ir->node_count();
+    }
+  }
 };
 
 // Options passed to each scheduling pass.
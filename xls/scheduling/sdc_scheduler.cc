@@ -17,11 +17,17 @@
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <memory>
+#include <optional>
 #include <random>
+#include <utility>
+#include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -175,18 +181,101 @@ ComputeCombinationalDelayConstraints(FunctionBase* f, int64_t clock_period_ps,
   return result;
 }
 
-class ConstraintBuilder {
+// Returns a set of constraints equivalent to that of
+// ComputeCombinationalDelayConstraints without computing the all-pairs
+// critical-path distances. Only the distances to each node from the nodes at
+// most `clock_period_ps` away are tracked, so the memory required is
+// proportional to the number of nodes which may share a stage with each node
+// rather than to the square of the number of nodes. The distances to a node
+// are dropped once all of its users have been visited.
+//
+// The returned constraints include all of those returned by
+// ComputeCombinationalDelayConstraints which are not implied by the others;
+// any additional constraint is between the endpoints of a path longer than
+// `clock_period_ps` so is implied by the constraints on that path. The set of
+// feasible schedules is therefore the same.
+absl::flat_hash_map<Node*, std::vector<Node*>>
+ComputeSparseCombinationalDelayConstraints(FunctionBase* f,
+                                           int64_t clock_period_ps,
+                                           const DelayMap& delay_map) {
+  absl::flat_hash_map<Node*, std::vector<Node*>> result;
+  result.reserve(f->node_count());
+  for (Node* node : f->nodes()) {
+    result[node];
+  }
+
+  // The critical-path distances to each visited node from the nodes at most
+  // `clock_period_ps` away, including the delay of both endpoints.
+  absl::flat_hash_map<Node*, absl::flat_hash_map<Node*, int64_t>>
+      distances_to_node;
+  // The number of users of each visited node which have not been visited.
+  absl::flat_hash_map<Node*, int64_t> unvisited_users;
+  for (Node* node : TopoSort(f)) {
+    int64_t node_delay = delay_map.at(node);
+    absl::flat_hash_map<Node*, int64_t> distances;
+    // The nodes from which the critical-path distance to `node` crosses the
+    // `clock_period_ps` boundary with the delay of `node`.
+    absl::flat_hash_set<Node*> constraint_sources;
+    for (Node* operand : node->operands()) {
+      for (const auto& [source, operand_distance] :
+           distances_to_node.at(operand)) {
+        int64_t distance = operand_distance + node_delay;
+        if (distance > clock_period_ps) {
+          constraint_sources.insert(source);
+        } else {
+          auto [it, inserted] = distances.insert({source, distance});
+          if (!inserted) {
+            it->second = std::max(it->second, distance);
+          }
+        }
+      }
+    }
+    for (Node* source : constraint_sources) {
+      distances.erase(source);
+      result.at(source).push_back(node);
+    }
+    if (node_delay <= clock_period_ps) {
+      distances[node] = node_delay;
+    }
+
+    // Users are counted once however many times they use a node.
+    for (Node* operand : absl::flat_hash_set<Node*>(node->operands().begin(),
+                                                    node->operands().end())) {
+      auto it = unvisited_users.find(operand);
+      if (--it->second == 0) {
+        unvisited_users.erase(it);
+        distances_to_node.erase(operand);
+      }
+    }
+    if (!node->users().empty()) {
+      unvisited_users[node] = node->users().size();
+      distances_to_node[node] = std::move(distances);
+    }
+  }
+
+  if (XLS_VLOG_IS_ON(4)) {
+    XLS_VLOG(4) << absl::StrFormat("Sparse constraints (clock period: %dps):",
+                                   clock_period_ps);
+    for (Node* node : TopoSort(f)) {
+      XLS_VLOG(4) << absl::StrFormat("  %s: [%s]", node->GetName(),
+                                     absl::StrJoin(result.at(node), ", "));
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+class SDCConstraintBuilder {
  public:
-  ConstraintBuilder(FunctionBase* func, or_tools::MPSolver* solver,
-                    int64_t pipeline_length, int64_t clock_period_ps,
-                    const sched::ScheduleBounds& bounds,
-                    const DelayMap& delay_map);
+  SDCConstraintBuilder(FunctionBase* func, or_tools::MPSolver* solver,
+                       int64_t pipeline_length, const DelayMap& delay_map,
+                       bool sparse_timing_constraints);
 
   absl::Status AddDefUseConstraints(Node* node, std::optional<Node*> user);
   absl::Status AddCausalConstraint(Node* node, std::optional<Node*> user);
   absl::Status AddLifetimeConstraint(Node* node, std::optional<Node*> user);
   absl::Status AddBackedgeConstraints();
-  absl::Status AddTimingConstraints();
   absl::Status AddSchedulingConstraint(const SchedulingConstraint& constraint);
   absl::Status AddIOConstraint(const IOConstraint& constraint);
   absl::Status AddNodeInCycleConstraint(
@@ -194,10 +283,23 @@ class ConstraintBuilder {
   absl::Status AddDifferenceConstraint(const DifferenceConstraint& constraint);
   absl::Status AddRFSLConstraint(
       const RecvsFirstSendsLastConstraint& constraint);
+  absl::Status AddResourceSharingConstraint(
+      const ResourceSharingConstraint& constraint);
 
   absl::Status AddObjective();
 
-  or_tools::MPSolver::ResultStatus Solve() { return solver_->Solve(); }
+  // Sets the bounds of the cycle of each node.
+  void SetCycleBounds(const sched::ScheduleBounds& bounds);
+
+  // Makes the timing constraints those required by `clock_period_ps`. Only the
+  // constraints which differ from those of the previous clock period are
+  // touched: constraints no longer required are relaxed to be unbounded
+  // rather than removed so they can be re-enabled by later clock periods.
+  absl::Status UpdateTimingConstraints(int64_t clock_period_ps);
+
+  // Solves the model, starting from the basis of the last optimal solve (if
+  // any) as the model generally changes little between solves.
+  or_tools::MPSolver::ResultStatus Solve();
 
   absl::StatusOr<ScheduleCycleMap> ExtractResult() const;
 
@@ -250,8 +352,8 @@ class ConstraintBuilder {
   FunctionBase* func_;
   or_tools::MPSolver* solver_;
   int64_t pipeline_length_;
-  int64_t clock_period_ps_;
   const DelayMap& delay_map_;
+  bool sparse_timing_constraints_;
   double infinity_;
 
   // Node's cycle after scheduling
@@ -265,25 +367,32 @@ class ConstraintBuilder {
   // graph.
   or_tools::MPVariable* cycle_at_sinknode_;
 
-  // A cache of the delay constraints.
-  absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints_;
+  // The timing constraints created so far keyed by (source, target), the
+  // subset required by the current clock period and that clock period.
+  absl::flat_hash_map<std::pair<Node*, Node*>, or_tools::MPConstraint*>
+      timing_constraints_;
+  absl::flat_hash_set<std::pair<Node*, Node*>> active_timing_constraints_;
+  std::optional<int64_t> timing_clock_period_ps_;
+
+  // The basis of the last optimal solve.
+  std::vector<or_tools::MPSolver::BasisStatus> variable_basis_;
+  std::vector<or_tools::MPSolver::BasisStatus> constraint_basis_;
 };
 
-ConstraintBuilder::ConstraintBuilder(FunctionBase* func,
-                                     or_tools::MPSolver* solver,
-                                     int64_t pipeline_length,
-                                     int64_t clock_period_ps,
-                                     const sched::ScheduleBounds& bounds,
-                                     const DelayMap& delay_map)
+SDCConstraintBuilder::SDCConstraintBuilder(FunctionBase* func,
+                                           or_tools::MPSolver* solver,
+                                           int64_t pipeline_length,
+                                           const DelayMap& delay_map,
+                                           bool sparse_timing_constraints)
     : func_(func),
       solver_(solver),
       pipeline_length_(pipeline_length),
-      clock_period_ps_(clock_period_ps),
       delay_map_(delay_map),
+      sparse_timing_constraints_(sparse_timing_constraints),
       infinity_(solver->infinity()) {
+  // The bounds of the cycles are set by SetCycleBounds before each solve.
   for (Node* node : func_->nodes()) {
-    cycle_var_[node] =
-        solver_->MakeNumVar(bounds.lb(node), bounds.ub(node), node->GetName());
+    cycle_var_[node] = solver_->MakeNumVar(0.0, infinity_, node->GetName());
     lifetime_var_[node] = solver_->MakeNumVar(
         0.0, infinity_, absl::StrFormat("lifetime_%s", node->GetName()));
   }
@@ -291,14 +400,14 @@ ConstraintBuilder::ConstraintBuilder(FunctionBase* func,
       solver->MakeNumVar(-infinity_, infinity_, "cycle_at_sinknode");
 }
 
-absl::Status ConstraintBuilder::AddDefUseConstraints(
+absl::Status SDCConstraintBuilder::AddDefUseConstraints(
     Node* node, std::optional<Node*> user) {
   XLS_RETURN_IF_ERROR(AddCausalConstraint(node, user));
   XLS_RETURN_IF_ERROR(AddLifetimeConstraint(node, user));
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddCausalConstraint(Node* node,
+absl::Status SDCConstraintBuilder::AddCausalConstraint(Node* node,
                                                     std::optional<Node*> user) {
   or_tools::MPVariable* cycle_at_node = cycle_var_.at(node);
   or_tools::MPVariable* cycle_at_user =
@@ -320,7 +429,7 @@ absl::Status ConstraintBuilder::AddCausalConstraint(Node* node,
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddLifetimeConstraint(
+absl::Status SDCConstraintBuilder::AddLifetimeConstraint(
     Node* node, std::optional<Node*> user) {
   or_tools::MPVariable* cycle_at_node = cycle_var_.at(node);
   or_tools::MPVariable* lifetime_at_node = lifetime_var_.at(node);
@@ -346,7 +455,7 @@ absl::Status ConstraintBuilder::AddLifetimeConstraint(
 
 // This ensures that state backedges don't span more than one cycle, which is
 // necessary while II = 1.
-absl::Status ConstraintBuilder::AddBackedgeConstraints() {
+absl::Status SDCConstraintBuilder::AddBackedgeConstraints() {
   Proc* proc = dynamic_cast<Proc*>(func_);
   if (proc == nullptr) {
     return absl::OkStatus();
@@ -414,25 +523,85 @@ absl::Status ConstraintBuilder::AddBackedgeConstraints() {
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddTimingConstraints() {
-  if (delay_constraints_.empty()) {
-    delay_constraints_ = ComputeCombinationalDelayConstraints(
-        func_, clock_period_ps_, delay_map_);
+void SDCConstraintBuilder::SetCycleBounds(
+    const sched::ScheduleBounds& bounds) {
+  for (Node* node : func_->nodes()) {
+    cycle_var_.at(node)->SetBounds(bounds.lb(node), bounds.ub(node));
+  }
+}
+
+absl::Status SDCConstraintBuilder::UpdateTimingConstraints(
+    int64_t clock_period_ps) {
+  if (timing_clock_period_ps_ == clock_period_ps) {
+    return absl::OkStatus();
   }
+  absl::flat_hash_map<Node*, std::vector<Node*>> delay_constraints =
+      sparse_timing_constraints_
+          ? ComputeSparseCombinationalDelayConstraints(func_, clock_period_ps,
+                                                       delay_map_)
+          : ComputeCombinationalDelayConstraints(func_, clock_period_ps,
+                                                 delay_map_);
 
+  absl::flat_hash_set<std::pair<Node*, Node*>> active;
   for (Node* source : func_->nodes()) {
-    for (Node* target : delay_constraints_.at(source)) {
-      DiffGreaterThanConstraint(target, source, 1, "timing");
+    for (Node* target : delay_constraints.at(source)) {
+      std::pair<Node*, Node*> key = {source, target};
+      if (!active.insert(key).second ||
+          active_timing_constraints_.contains(key)) {
+        continue;
+      }
+      auto it = timing_constraints_.find(key);
+      if (it == timing_constraints_.end()) {
+        timing_constraints_[key] =
+            DiffGreaterThanConstraint(target, source, 1, "timing");
+      } else {
+        it->second->SetBounds(-infinity_, -1);
+      }
       XLS_VLOG(2) << "Setting timing constraint: "
                   << absl::StrFormat("1 ≤ %s - %s", target->GetName(),
                                      source->GetName());
     }
   }
-
+  for (const std::pair<Node*, Node*>& key : active_timing_constraints_) {
+    if (!active.contains(key)) {
+      timing_constraints_.at(key)->SetBounds(-infinity_, infinity_);
+    }
+  }
+  active_timing_constraints_ = std::move(active);
+  timing_clock_period_ps_ = clock_period_ps;
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddSchedulingConstraint(
+or_tools::MPSolver::ResultStatus SDCConstraintBuilder::Solve() {
+  if (!variable_basis_.empty()) {
+    std::vector<or_tools::MPSolver::BasisStatus> constraint_basis =
+        constraint_basis_;
+    // Constraints created since the last solve and relaxed constraints start
+    // with their slack in the basis.
+    constraint_basis.resize(solver_->NumConstraints(),
+                            or_tools::MPSolver::BASIC);
+    for (const auto& [key, constraint] : timing_constraints_) {
+      if (!active_timing_constraints_.contains(key)) {
+        constraint_basis[constraint->index()] = or_tools::MPSolver::BASIC;
+      }
+    }
+    solver_->SetStartingLpBasis(variable_basis_, constraint_basis);
+  }
+  or_tools::MPSolver::ResultStatus status = solver_->Solve();
+  if (status == or_tools::MPSolver::OPTIMAL) {
+    variable_basis_.clear();
+    for (const or_tools::MPVariable* variable : solver_->variables()) {
+      variable_basis_.push_back(variable->basis_status());
+    }
+    constraint_basis_.clear();
+    for (const or_tools::MPConstraint* constraint : solver_->constraints()) {
+      constraint_basis_.push_back(constraint->basis_status());
+    }
+  }
+  return status;
+}
+
+absl::Status SDCConstraintBuilder::AddSchedulingConstraint(
     const SchedulingConstraint& constraint) {
   if (std::holds_alternative<BackedgeConstraint>(constraint)) {
     return AddBackedgeConstraints();
@@ -451,10 +620,45 @@ absl::Status ConstraintBuilder::AddSchedulingConstraint(
     return AddRFSLConstraint(
         std::get<RecvsFirstSendsLastConstraint>(constraint));
   }
+  if (std::holds_alternative<ResourceSharingConstraint>(constraint)) {
+    return AddResourceSharingConstraint(
+        std::get<ResourceSharingConstraint>(constraint));
+  }
   return absl::InternalError("Unhandled scheduling constraint type");
 }
 
-absl::Status ConstraintBuilder::AddIOConstraint(
+absl::Status SDCConstraintBuilder::AddResourceSharingConstraint(
+    const ResourceSharingConstraint& constraint) {
+  XLS_RET_CHECK_GT(constraint.GetUnitCount(), 0);
+  // Each stage spans the initiation interval so a unit may be used once in
+  // each cycle of the stage.
+  int64_t capacity =
+      constraint.GetUnitCount() * func_->GetInitiationInterval().value_or(1);
+  std::vector<Node*> ops;
+  for (Node* node : TopoSort(func_)) {
+    if (node->op() == constraint.GetOp()) {
+      ops.push_back(node);
+    }
+  }
+  // Limiting the number of operations in each stage is not expressible as
+  // difference constraints. Instead fix the order of the stages of the
+  // operations (following the topological order, which dependencies already
+  // impose on dependent operations) so that any `capacity + 1` consecutive
+  // operations span at least two stages.
+  for (int64_t i = 0; i + 1 < ops.size(); ++i) {
+    DiffLessThanConstraint(ops[i], ops[i + 1], 0, "resource_order");
+    if (i + capacity < ops.size()) {
+      Node* later = ops[i + capacity];
+      DiffGreaterThanConstraint(later, ops[i], 1, "resource");
+      XLS_VLOG(2) << "Setting resource constraint: "
+                  << absl::StrFormat("1 ≤ %s - %s", later->GetName(),
+                                     ops[i]->GetName());
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SDCConstraintBuilder::AddIOConstraint(
     const IOConstraint& constraint) {
   // Map from channel name to set of nodes that send/receive on that channel.
   absl::flat_hash_map<std::string, std::vector<Node*>> channel_to_nodes;
@@ -499,7 +703,7 @@ absl::Status ConstraintBuilder::AddIOConstraint(
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddNodeInCycleConstraint(
+absl::Status SDCConstraintBuilder::AddNodeInCycleConstraint(
     const NodeInCycleConstraint& constraint) {
   Node* node = constraint.GetNode();
   int64_t cycle = constraint.GetCycle();
@@ -513,7 +717,7 @@ absl::Status ConstraintBuilder::AddNodeInCycleConstraint(
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddDifferenceConstraint(
+absl::Status SDCConstraintBuilder::AddDifferenceConstraint(
     const DifferenceConstraint& constraint) {
   Node* a = constraint.GetA();
   Node* b = constraint.GetB();
@@ -527,7 +731,7 @@ absl::Status ConstraintBuilder::AddDifferenceConstraint(
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddRFSLConstraint(
+absl::Status SDCConstraintBuilder::AddRFSLConstraint(
     const RecvsFirstSendsLastConstraint& constraint) {
   for (Node* node : func_->nodes()) {
     if (node->Is<Receive>()) {
@@ -553,7 +757,7 @@ absl::Status ConstraintBuilder::AddRFSLConstraint(
   return absl::OkStatus();
 }
 
-absl::Status ConstraintBuilder::AddObjective() {
+absl::Status SDCConstraintBuilder::AddObjective() {
   or_tools::MPObjective* objective = solver_->MutableObjective();
   for (Node* node : func_->nodes()) {
     // This acts as a tie-breaker for underconstrained problems.
@@ -568,7 +772,7 @@ absl::Status ConstraintBuilder::AddObjective() {
   return absl::OkStatus();
 }
 
-absl::StatusOr<ScheduleCycleMap> ConstraintBuilder::ExtractResult() const {
+absl::StatusOr<ScheduleCycleMap> SDCConstraintBuilder::ExtractResult() const {
   ScheduleCycleMap cycle_map;
   for (Node* node : func_->nodes()) {
     double cycle = cycle_var_.at(node)->solution_value();
@@ -581,31 +785,40 @@ absl::StatusOr<ScheduleCycleMap> ConstraintBuilder::ExtractResult() const {
   return cycle_map;
 }
 
-}  // namespace
+SDCSchedulingModel::SDCSchedulingModel() = default;
 
-absl::StatusOr<ScheduleCycleMap> SDCScheduler(
-    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
-    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints,
-    bool check_feasibility) {
-  XLS_VLOG(3) << "SDCScheduler()";
+SDCSchedulingModel::~SDCSchedulingModel() = default;
+
+int64_t SDCSchedulingModel::variable_count() const {
+  return solver_->NumVariables();
+}
+
+int64_t SDCSchedulingModel::constraint_count() const {
+  return solver_->NumConstraints();
+}
+
+absl::StatusOr<std::unique_ptr<SDCSchedulingModel>> SDCSchedulingModel::Create(
+    FunctionBase* f, int64_t pipeline_stages,
+    const DelayEstimator& delay_estimator,
+    absl::Span<const SchedulingConstraint> constraints, bool check_feasibility,
+    bool sparse_timing_constraints) {
+  XLS_VLOG(3) << "SDCSchedulingModel::Create()";
   XLS_VLOG(3) << "  pipeline stages = " << pipeline_stages;
   XLS_VLOG_LINES(4, f->DumpIr());
 
-  XLS_VLOG(4) << "Initial bounds:";
-  XLS_VLOG_LINES(4, bounds->ToString());
-
-  std::unique_ptr<or_tools::MPSolver> solver(
-      or_tools::MPSolver::CreateSolver("GLOP"));
-  if (!solver) {
+  auto model = absl::WrapUnique(new SDCSchedulingModel());
+  model->solver_.reset(or_tools::MPSolver::CreateSolver("GLOP"));
+  if (!model->solver_) {
     return absl::UnavailableError("GLOP solver unavailable.");
   }
 
-  XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
+  XLS_ASSIGN_OR_RETURN(model->delay_map_,
                        ComputeNodeDelays(f, delay_estimator));
 
-  ConstraintBuilder builder(f, solver.get(), pipeline_stages, clock_period_ps,
-                            *bounds, delay_map);
+  model->builder_ = std::make_unique<SDCConstraintBuilder>(
+      f, model->solver_.get(), pipeline_stages, model->delay_map_,
+      sparse_timing_constraints);
+  SDCConstraintBuilder& builder = *model->builder_;
 
   for (const SchedulingConstraint& constraint : constraints) {
     XLS_RETURN_IF_ERROR(builder.AddSchedulingConstraint(constraint));
@@ -620,20 +833,43 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler(
     }
   }
 
-  XLS_RETURN_IF_ERROR(builder.AddTimingConstraints());
-
   if (!check_feasibility) {
     XLS_RETURN_IF_ERROR(builder.AddObjective());
   }
+  return model;
+}
+
+absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::Solve(
+    int64_t clock_period_ps, const sched::ScheduleBounds& bounds) {
+  XLS_VLOG(3) << "SDCSchedulingModel::Solve()";
+  XLS_VLOG(3) << "  clock period = " << clock_period_ps;
+  XLS_VLOG(4) << "Initial bounds:";
+  XLS_VLOG_LINES(4, bounds.ToString());
+
+  builder_->SetCycleBounds(bounds);
+  XLS_RETURN_IF_ERROR(builder_->UpdateTimingConstraints(clock_period_ps));
 
-  or_tools::MPSolver::ResultStatus status = builder.Solve();
+  or_tools::MPSolver::ResultStatus status = builder_->Solve();
 
   if (status != or_tools::MPSolver::OPTIMAL) {
     XLS_VLOG(1) << "SDCScheduler failed with " << status;
     return absl::InternalError("The problem does not have an optimal solution");
   }
 
-  return builder.ExtractResult();
+  return builder_->ExtractResult();
+}
+
+absl::StatusOr<ScheduleCycleMap> SDCScheduler(
+    FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
+    const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
+    absl::Span<const SchedulingConstraint> constraints, bool check_feasibility,
+    bool sparse_timing_constraints) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<SDCSchedulingModel> model,
+      SDCSchedulingModel::Create(f, pipeline_stages, delay_estimator,
+                                 constraints, check_feasibility,
+                                 sparse_timing_constraints));
+  return model->Solve(clock_period_ps, *bounds);
 }
 
 }  // namespace xls
@@ -15,6 +15,9 @@
 #ifndef XLS_SCHEDULING_SDC_SCHEDULER_H_
 #define XLS_SCHEDULING_SDC_SCHEDULER_H_
 
+#include <cstdint>
+#include <memory>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -25,8 +28,14 @@
 #include "xls/scheduling/schedule_bounds.h"
 #include "xls/scheduling/scheduling_options.h"
 
+namespace operations_research {
+class MPSolver;
+}  // namespace operations_research
+
 namespace xls {
 
+class SDCConstraintBuilder;
+
 // Schedule to minimize the total pipeline registers using SDC scheduling
 // the constraint matrix is totally unimodular, this ILP problem can be solved
 // by LP.
@@ -35,6 +44,13 @@ namespace xls {
 // the LP solver will merely attempt to show that the generated set of
 // constraints is feasible, rather than find an register-optimal schedule.
 //
+// With `sparse_timing_constraints = true`, the timing constraints are derived
+// from the critical-path distances between nodes at most one clock period
+// apart rather than between all pairs of nodes. The set of feasible schedules
+// is the same but the memory required grows with the size of a stage rather
+// than with the square of the number of nodes, which makes very large
+// functions tractable.
+//
 // References:
 //   - Cong, Jason, and Zhiru Zhang. "An efficient and versatile scheduling
 //   algorithm based on SDC formulation." 2006 43rd ACM/IEEE Design Automation
@@ -46,7 +62,43 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
     absl::Span<const SchedulingConstraint> constraints,
-    bool check_feasibility = false);
+    bool check_feasibility = false, bool sparse_timing_constraints = false);
+
+// The SDC scheduling problem of a function base, kept alive across solves for
+// different clock periods as when searching for the minimum feasible clock
+// period. The variables, the def-use constraints and the given scheduling
+// constraints do not depend on the clock period and are built once. Each
+// solve updates only the bounds of the cycles and the timing constraints which
+// differ from the previous solve, and starts from the basis of the last
+// optimal solve. The result of each solve is the same as that of SDCScheduler
+// with the same arguments.
+class SDCSchedulingModel {
+ public:
+  static absl::StatusOr<std::unique_ptr<SDCSchedulingModel>> Create(
+      FunctionBase* f, int64_t pipeline_stages,
+      const DelayEstimator& delay_estimator,
+      absl::Span<const SchedulingConstraint> constraints,
+      bool check_feasibility = false, bool sparse_timing_constraints = false);
+  ~SDCSchedulingModel();
+
+  // Schedules the function base with the given clock period and bounds on the
+  // cycle of each node.
+  absl::StatusOr<ScheduleCycleMap> Solve(int64_t clock_period_ps,
+                                         const sched::ScheduleBounds& bounds);
+
+  // Returns the number of variables and constraints of the problem. Timing
+  // constraints created for earlier solves remain in the problem (relaxed) and
+  // are counted.
+  int64_t variable_count() const;
+  int64_t constraint_count() const;
+
+ private:
+  SDCSchedulingModel();
+
+  absl::flat_hash_map<Node*, int64_t> delay_map_;
+  std::unique_ptr<operations_research::MPSolver> solver_;
+  std::unique_ptr<SDCConstraintBuilder> builder_;
+};
 
 }  // namespace xls
 
@@ -14,20 +14,36 @@
 
 #include "xls/simulation/module_simulator.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "xls/codegen/flattening.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/number_parser.h"
 #include "xls/tools/eval_helpers.h"
 
 namespace xls {
@@ -238,6 +254,46 @@ absl::StatusOr<std::vector<std::unique_ptr<Bits>>> CaptureOutputChannel(
   return outputs;
 }
 
+// The number of cycles the batch testbench waits (holding reset, if any)
+// before driving inputs.
+constexpr int64_t kBatchResetCycles = 5;
+
+// Returns the given data ports which have a port in the Verilog module; ports
+// of zero width have none.
+std::vector<const PortProto*> NonZeroWidthPorts(
+    absl::Span<const PortProto> ports) {
+  std::vector<const PortProto*> result;
+  for (const PortProto& port : ports) {
+    if (port.width() > 0) {
+      result.push_back(&port);
+    }
+  }
+  return result;
+}
+
+int64_t TotalWidth(absl::Span<const PortProto* const> ports) {
+  int64_t width = 0;
+  for (const PortProto* port : ports) {
+    width += port->width();
+  }
+  return width;
+}
+
+// Returns a Verilog concatenation of the given ports, with the first port in
+// the most significant bits, or a one-bit zero if there are no ports.
+std::string PortConcatenation(absl::Span<const PortProto* const> ports) {
+  if (ports.empty()) {
+    return "1'b0";
+  }
+  return absl::StrCat(
+      "{",
+      absl::StrJoin(ports, ", ",
+                    [](std::string* out, const PortProto* port) {
+                      absl::StrAppend(out, port->name());
+                    }),
+      "}");
+}
+
 }  // namespace
 
 absl::flat_hash_map<std::string, Bits> ModuleSimulator::DeassertControlSignals()
@@ -455,6 +511,308 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
   return outputs;
 }
 
+absl::StatusOr<std::string> ModuleSimulator::GenerateBatchTestbenchVerilog()
+    const {
+  const ModuleSignatureProto& proto = signature_.proto();
+  if (!proto.has_combinational() && !proto.has_fixed_latency() &&
+      !proto.has_pipeline()) {
+    return absl::UnimplementedError(
+        absl::StrCat("Unsupported interface for batch simulation: ",
+                     proto.interface_oneof_case()));
+  }
+  if (!proto.has_combinational() && !proto.has_clock_name()) {
+    return absl::InvalidArgumentError("Expected clock in signature");
+  }
+  std::vector<const PortProto*> inputs =
+      NonZeroWidthPorts(signature_.data_inputs());
+  std::vector<const PortProto*> outputs =
+      NonZeroWidthPorts(signature_.data_outputs());
+
+  std::string tb = "module batch_testbench;\n";
+  std::vector<std::string> connections;
+  auto add_port = [&](std::string_view kind, std::string_view name,
+                      int64_t width) {
+    absl::StrAppendFormat(&tb, "  %s [%d:0] %s;\n", kind, width - 1, name);
+    connections.push_back(absl::StrFormat(".%s(%s)", name, name));
+  };
+  for (const PortProto* input : inputs) {
+    add_port("reg", input->name(), input->width());
+  }
+  for (const PortProto* output : outputs) {
+    add_port("wire", output->name(), output->width());
+  }
+
+  // Statements setting the control inputs before reset, and while a vector is
+  // or is not being driven.
+  std::string init;
+  std::string drive;
+  std::string idle;
+  if (proto.has_clock_name()) {
+    add_port("reg", proto.clock_name(), 1);
+  }
+  if (proto.has_reset()) {
+    add_port("reg", proto.reset().name(), 1);
+    absl::StrAppendFormat(&init, "    %s = %d;\n", proto.reset().name(),
+                          proto.reset().active_low() ? 0 : 1);
+  }
+  if (proto.has_pipeline() && proto.pipeline().has_pipeline_control()) {
+    const PipelineControl& control = proto.pipeline().pipeline_control();
+    if (control.has_valid()) {
+      add_port("reg", control.valid().input_name(), 1);
+      absl::StrAppendFormat(&init, "    %s = 0;\n",
+                            control.valid().input_name());
+      absl::StrAppendFormat(&drive, "        %s = 1;\n",
+                            control.valid().input_name());
+      absl::StrAppendFormat(&idle, "        %s = 0;\n",
+                            control.valid().input_name());
+    } else if (control.has_manual()) {
+      // Drive the pipeline register load-enable signals high.
+      int64_t latency = proto.pipeline().latency();
+      add_port("reg", control.manual().input_name(), latency);
+      absl::StrAppendFormat(&init, "    %s = {%d{1'b1}};\n",
+                            control.manual().input_name(), latency);
+    }
+  }
+
+  absl::StrAppendFormat(&tb, "  reg [%d:0] vector;\n",
+                        std::max(TotalWidth(inputs), int64_t{1}) - 1);
+  absl::StrAppend(&tb,
+                  "  reg [8*4096-1:0] stimulus_path, results_path;\n"
+                  "  integer stimulus_fd, results_fd, status;\n"
+                  "  integer cycle, driven, written;\n\n");
+  absl::StrAppendFormat(&tb, "  %s dut (\n    %s\n  );\n\n",
+                        signature_.module_name(),
+                        absl::StrJoin(connections, ",\n    "));
+
+  std::string clk;
+  if (proto.has_clock_name()) {
+    clk = proto.clock_name();
+    absl::StrAppendFormat(&tb,
+                          "  initial begin\n"
+                          "    %s = 0;\n"
+                          "    forever #5 %s = !%s;\n"
+                          "  end\n\n",
+                          clk, clk, clk);
+  }
+
+  std::string read_vector =
+      "status = $fscanf(stimulus_fd, \"%h\\n\", vector);";
+  std::string assign_inputs;
+  if (!inputs.empty()) {
+    assign_inputs = absl::StrFormat("%s = vector;", PortConcatenation(inputs));
+  }
+  std::string write_outputs = absl::StrFormat(
+      "$fwrite(results_fd, \"%%h\\n\", %s);", PortConcatenation(outputs));
+
+  absl::StrAppend(
+      &tb,
+      "  initial begin\n"
+      "    if (!$value$plusargs(\"stimulus=%s\", stimulus_path) ||\n"
+      "        !$value$plusargs(\"results=%s\", results_path)) begin\n"
+      "      $display(\"ERROR: expected +stimulus=<path> and "
+      "+results=<path>\");\n"
+      "      $finish;\n"
+      "    end\n"
+      "    stimulus_fd = $fopen(stimulus_path, \"r\");\n"
+      "    results_fd = $fopen(results_path, \"w\");\n"
+      "    if (stimulus_fd == 0 || results_fd == 0) begin\n"
+      "      $display(\"ERROR: cannot open the stimulus or results file\");\n"
+      "      $finish;\n"
+      "    end\n",
+      init);
+  if (!clk.empty()) {
+    absl::StrAppendFormat(&tb, "    repeat (%d) @(posedge %s);\n",
+                          kBatchResetCycles, clk);
+    if (proto.has_reset()) {
+      absl::StrAppendFormat(&tb, "    %s = %d;\n", proto.reset().name(),
+                            proto.reset().active_low() ? 1 : 0);
+    }
+    absl::StrAppend(&tb, "    #1;\n");
+  }
+  absl::StrAppend(&tb, "    ", read_vector, "\n");
+
+  if (proto.has_combinational()) {
+    absl::StrAppend(&tb,
+                    "    while (status == 1) begin\n"
+                    "      ",
+                    assign_inputs,
+                    "\n"
+                    "      #1;\n"
+                    "      ",
+                    write_outputs,
+                    "\n"
+                    "      ",
+                    read_vector,
+                    "\n"
+                    "    end\n");
+  } else if (proto.has_fixed_latency()) {
+    // Drive each vector until its outputs have been written.
+    absl::StrAppendFormat(&tb,
+                          "    while (status == 1) begin\n"
+                          "      %s\n"
+                          "      %s\n"
+                          "      repeat (%d) begin\n"
+                          "        @(posedge %s);\n"
+                          "        #1;\n"
+                          "      end\n"
+                          "      @(negedge %s);\n"
+                          "      %s\n"
+                          "      @(posedge %s);\n"
+                          "      #1;\n"
+                          "    end\n",
+                          assign_inputs, read_vector,
+                          proto.fixed_latency().latency(), clk, clk,
+                          write_outputs, clk);
+  } else {
+    // Drive a new vector every cycle; the outputs of the vector driven in
+    // cycle c are written in cycle c + latency.
+    absl::StrAppendFormat(&tb,
+                          "    cycle = 0;\n"
+                          "    driven = 0;\n"
+                          "    written = 0;\n"
+                          "    while (status == 1 || written < driven) begin\n"
+                          "      if (status == 1) begin\n"
+                          "        %s\n"
+                          "%s"
+                          "        driven = driven + 1;\n"
+                          "        %s\n"
+                          "      end else begin\n"
+                          "%s"
+                          "      end\n"
+                          "      @(negedge %s);\n"
+                          "      if (cycle >= %d && written < driven) begin\n"
+                          "        %s\n"
+                          "        written = written + 1;\n"
+                          "      end\n"
+                          "      @(posedge %s);\n"
+                          "      #1;\n"
+                          "      cycle = cycle + 1;\n"
+                          "    end\n",
+                          assign_inputs, drive, read_vector, idle, clk,
+                          proto.pipeline().latency(), write_outputs, clk);
+  }
+  absl::StrAppend(&tb,
+                  "    $fclose(results_fd);\n"
+                  "    $finish;\n"
+                  "  end\n"
+                  "endmodule\n");
+  return tb;
+}
+
+absl::StatusOr<std::unique_ptr<ModuleSimulator::BatchSession>>
+ModuleSimulator::CreateBatchSession() const {
+  XLS_ASSIGN_OR_RETURN(std::string testbench, GenerateBatchTestbenchVerilog());
+  XLS_VLOG(2) << "Batch testbench:\n" << testbench;
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<CompiledSimulation> compiled,
+      simulator_->Compile(absl::StrCat(verilog_text_, "\n", testbench),
+                          file_type_, includes_));
+  return absl::WrapUnique(new BatchSession(signature_, std::move(compiled)));
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::BatchSession::Run(absl::Span<const BitsMap> inputs,
+                                   int64_t shard_count) const {
+  XLS_RET_CHECK_GE(shard_count, 1);
+  for (const BitsMap& input : inputs) {
+    XLS_RETURN_IF_ERROR(signature_.ValidateInputs(input));
+  }
+  if (inputs.empty()) {
+    return std::vector<BitsMap>();
+  }
+  XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+  if (shard_count == 1) {
+    return RunShard(inputs, temp_dir.path(), /*shard=*/0);
+  }
+
+  int64_t shard_size = CeilOfRatio(static_cast<int64_t>(inputs.size()),
+                                   shard_count);
+  std::vector<absl::StatusOr<std::vector<BitsMap>>> shard_outputs(
+      CeilOfRatio(static_cast<int64_t>(inputs.size()), shard_size));
+  ParallelFor(0, shard_outputs.size(), [&](int64_t shard) {
+    shard_outputs[shard] = RunShard(
+        inputs.subspan(shard * shard_size, shard_size), temp_dir.path(), shard);
+  });
+
+  std::vector<BitsMap> outputs;
+  outputs.reserve(inputs.size());
+  for (absl::StatusOr<std::vector<BitsMap>>& shard_output : shard_outputs) {
+    XLS_RETURN_IF_ERROR(shard_output.status());
+    for (BitsMap& output : shard_output.value()) {
+      outputs.push_back(std::move(output));
+    }
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::BatchSession::RunShard(absl::Span<const BitsMap> inputs,
+                                        const std::filesystem::path& temp_dir,
+                                        int64_t shard) const {
+  std::vector<const PortProto*> input_ports =
+      NonZeroWidthPorts(signature_.data_inputs());
+  std::string stimulus;
+  for (const BitsMap& input : inputs) {
+    std::vector<Bits> values;
+    for (const PortProto* port : input_ports) {
+      values.push_back(input.at(port->name()));
+    }
+    absl::StrAppend(
+        &stimulus,
+        bits_ops::Concat(values).ToRawDigits(FormatPreference::kPlainHex),
+        "\n");
+  }
+  std::filesystem::path stimulus_path =
+      temp_dir / absl::StrFormat("stimulus_%d.hex", shard);
+  std::filesystem::path results_path =
+      temp_dir / absl::StrFormat("results_%d.hex", shard);
+  XLS_RETURN_IF_ERROR(SetFileContents(stimulus_path, stimulus));
+
+  std::pair<std::string, std::string> stdout_stderr;
+  XLS_ASSIGN_OR_RETURN(
+      stdout_stderr,
+      compiled_->Run({absl::StrCat("stimulus=", stimulus_path.string()),
+                      absl::StrCat("results=", results_path.string())}));
+  if (absl::StrContains(stdout_stderr.first, "ERROR")) {
+    return absl::InternalError(absl::StrCat("Batch simulation failed: ",
+                                            stdout_stderr.first,
+                                            stdout_stderr.second));
+  }
+  XLS_ASSIGN_OR_RETURN(std::string results, GetFileContents(results_path));
+
+  std::vector<const PortProto*> output_ports =
+      NonZeroWidthPorts(signature_.data_outputs());
+  int64_t results_width = std::max(TotalWidth(output_ports), int64_t{1});
+  std::vector<BitsMap> outputs;
+  for (std::string_view line :
+       absl::StrSplit(results, '\n', absl::SkipWhitespace())) {
+    if (line.find_first_of("xXzZ") != std::string_view::npos) {
+      return absl::InternalError(absl::StrFormat(
+          "Batch simulation produced X or Z output for input %d: %s",
+          outputs.size(), line));
+    }
+    XLS_ASSIGN_OR_RETURN(Bits result,
+                         ParseUnsignedNumberWithoutPrefix(
+                             line, FormatPreference::kHex, results_width));
+    BitsMap& output = outputs.emplace_back();
+    int64_t offset = TotalWidth(output_ports);
+    for (const PortProto& port : signature_.data_outputs()) {
+      if (port.width() == 0) {
+        output[port.name()] = Bits();
+        continue;
+      }
+      offset -= port.width();
+      output[port.name()] = result.Slice(offset, port.width());
+    }
+  }
+  if (outputs.size() != inputs.size()) {
+    return absl::InternalError(absl::StrFormat(
+        "Batch simulation produced %d results for %d inputs: %s",
+        outputs.size(), inputs.size(), stdout_stderr.second));
+  }
+  return outputs;
+}
+
 absl::StatusOr<Value> ModuleSimulator::RunFunction(
     const absl::flat_hash_map<std::string, Value>& inputs) const {
   absl::flat_hash_map<std::string, Value> input_map(inputs.begin(),
@@ -15,6 +15,13 @@
 #ifndef XLS_SIMULATION_MODULE_SIMULATOR_H_
 #define XLS_SIMULATION_MODULE_SIMULATOR_H_
 
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/module_signature.h"
@@ -99,6 +106,46 @@ class ModuleSimulator {
   absl::StatusOr<std::vector<BitsMap>> RunBatched(
       absl::Span<const BitsMap> inputs) const;
 
+  // A session which compiles a testbench for the module once and then
+  // simulates any number of batches of inputs with it. Rather than embedding
+  // the inputs, the testbench streams input vectors from a file and writes the
+  // outputs to another, so each batch only pays for starting the simulation
+  // runtime, and a batch can be split into shards simulated by concurrent
+  // simulator processes. Requires a combinational, fixed-latency or pipelined
+  // interface and a simulator which implements VerilogSimulator::Compile.
+  class BatchSession {
+   public:
+    // Runs the given batch of argument values through the module, splitting
+    // it into up to `shard_count` shards which are simulated concurrently.
+    absl::StatusOr<std::vector<BitsMap>> Run(absl::Span<const BitsMap> inputs,
+                                             int64_t shard_count = 1) const;
+
+   private:
+    friend class ModuleSimulator;
+
+    BatchSession(const ModuleSignature& signature,
+                 std::unique_ptr<CompiledSimulation> compiled)
+        : signature_(signature), compiled_(std::move(compiled)) {}
+
+    // Simulates one shard of inputs, using files in `temp_dir` named after
+    // `shard`.
+    absl::StatusOr<std::vector<BitsMap>> RunShard(
+        absl::Span<const BitsMap> inputs, const std::filesystem::path& temp_dir,
+        int64_t shard) const;
+
+    ModuleSignature signature_;
+    std::unique_ptr<CompiledSimulation> compiled_;
+  };
+
+  // Compiles the module and a streaming testbench for it into a BatchSession.
+  absl::StatusOr<std::unique_ptr<BatchSession>> CreateBatchSession() const;
+
+  // Returns the (Verilog) testbench compiled by CreateBatchSession. It reads
+  // one hexadecimal vector of the concatenated data inputs per line from the
+  // file named by the "stimulus" plusarg and writes the concatenated data
+  // outputs in the same form to the file named by the "results" plusarg.
+  absl::StatusOr<std::string> GenerateBatchTestbenchVerilog() const;
+
   // Overloads which accept Values rather than Bits.
   absl::StatusOr<Value> RunFunction(
       const absl::flat_hash_map<std::string, Value>& inputs) const;
@@ -14,8 +14,12 @@
 
 #include "xls/simulation/module_simulator.h"
 
+#include <memory>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/common/file/filesystem.h"
@@ -32,6 +36,7 @@ using status_testing::IsOkAndHolds;
 using status_testing::StatusIs;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Pair;
 
 constexpr char kTestName[] = "module_simulator_test";
@@ -208,6 +213,57 @@ TEST_P(ModuleSimulatorTest, CombinationalBatched) {
   EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(100, 8))));
 }
 
+TEST_P(ModuleSimulatorTest, FixedLatencyBatchSession) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeFixedLatencyModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+  absl::StatusOr<std::unique_ptr<ModuleSimulator::BatchSession>> session =
+      simulator.CreateBatchSession();
+  if (absl::IsUnimplemented(session.status())) {
+    GTEST_SKIP() << session.status();
+  }
+  XLS_ASSERT_OK(session.status());
+
+  std::vector<ModuleSimulator::BitsMap> inputs;
+  for (int64_t i = 0; i < 100; ++i) {
+    inputs.push_back({{"x", UBits(i, 8)}});
+  }
+  // The same compiled session serves several batches and shard counts.
+  for (int64_t shard_count : {1, 3}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::vector<ModuleSimulator::BitsMap> outputs,
+                             (*session)->Run(inputs, shard_count));
+    ASSERT_EQ(outputs.size(), inputs.size());
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      EXPECT_THAT(outputs[i], ElementsAre(Pair("out", UBits(2 * i, 8))))
+          << "input " << i;
+    }
+  }
+}
+
+TEST_P(ModuleSimulatorTest, CombinationalBatchSession) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeCombinationalModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+  absl::StatusOr<std::unique_ptr<ModuleSimulator::BatchSession>> session =
+      simulator.CreateBatchSession();
+  if (absl::IsUnimplemented(session.status())) {
+    GTEST_SKIP() << session.status();
+  }
+  XLS_ASSERT_OK(session.status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<ModuleSimulator::BitsMap> outputs,
+      (*session)->Run({{{"x", UBits(99, 8)}, {"y", UBits(12, 8)}},
+                       {{"x", UBits(100, 8)}, {"y", UBits(25, 8)}},
+                       {{"x", UBits(255, 8)}, {"y", UBits(155, 8)}}},
+                      /*shard_count=*/2));
+  EXPECT_EQ(outputs.size(), 3);
+  EXPECT_THAT(outputs[0], ElementsAre(Pair("out", UBits(87, 8))));
+  EXPECT_THAT(outputs[1], ElementsAre(Pair("out", UBits(75, 8))));
+  EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(100, 8))));
+  EXPECT_THAT((*session)->Run({}), IsOkAndHolds(IsEmpty()));
+}
+
 TEST_P(ModuleSimulatorTest, MultipleOutputs) {
   const std::string text = R"(
 module delay_3(
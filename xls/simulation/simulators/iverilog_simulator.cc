@@ -12,10 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <filesystem>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
 #include "xls/common/file/filesystem.h"
@@ -70,6 +74,29 @@ absl::StatusOr<std::pair<std::string, std::string>> InvokeVvp(
       SubprocessErrorAsStatus(InvokeSubprocess(args_vec)));
 }
 
+// A design compiled by iverilog into a vvp program; each run only invokes the
+// vvp runtime.
+class IcarusCompiledSimulation : public CompiledSimulation {
+ public:
+  IcarusCompiledSimulation(TempDirectory temp_dir,
+                           std::filesystem::path program_path)
+      : temp_dir_(std::move(temp_dir)),
+        program_path_(std::move(program_path)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      absl::Span<const std::string> plusargs) const override {
+    std::vector<std::string> args = {program_path_.string()};
+    for (const std::string& plusarg : plusargs) {
+      args.push_back(absl::StrCat("+", plusarg));
+    }
+    return InvokeVvp(args);
+  }
+
+ private:
+  TempDirectory temp_dir_;
+  std::filesystem::path program_path_;
+};
+
 class IcarusVerilogSimulator : public VerilogSimulator {
  public:
   absl::StatusOr<std::pair<std::string, std::string>> Run(
@@ -121,6 +148,29 @@ class IcarusVerilogSimulator : public VerilogSimulator {
 
     return absl::OkStatus();
   }
+
+  absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    if (file_type == FileType::kSystemVerilog) {
+      return absl::UnimplementedError(
+          "iverilog does not support SystemVerilog");
+    }
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_top, TempDirectory::Create());
+    std::filesystem::path temp_dir = temp_top.path();
+
+    std::string top_v_path = temp_dir / GetTopFileName(file_type);
+    XLS_RETURN_IF_ERROR(SetFileContents(top_v_path, text));
+    XLS_RETURN_IF_ERROR(SetUpIncludes(temp_dir, includes));
+
+    std::filesystem::path program_path = temp_dir / "top.vvp";
+    XLS_RETURN_IF_ERROR(InvokeIverilog({top_v_path, "-o",
+                                        program_path.string(), "-I",
+                                        temp_dir.string()})
+                            .status());
+    return std::make_unique<IcarusCompiledSimulation>(std::move(temp_top),
+                                                      std::move(program_path));
+  }
 };
 
 XLS_REGISTER_MODULE_INITIALIZER(iverilog_simulator, {
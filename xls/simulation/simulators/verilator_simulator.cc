@@ -0,0 +1,218 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/module_initializer.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/subprocess.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/tools/verilog_include.h"
+
+ABSL_FLAG(std::string, verilator_path, "verilator",
+          "Path of the Verilator executable used by the \"verilator\" Verilog "
+          "simulator.");
+ABSL_FLAG(std::string, verilator_cache_dir, "",
+          "Directory in which the \"verilator\" Verilog simulator caches "
+          "compiled models by a hash of their Verilog. Defaults to a "
+          "directory under the system temporary directory.");
+
+namespace xls {
+namespace verilog {
+namespace {
+
+// Bumped whenever the Verilator invocation changes, invalidating cached
+// models.
+constexpr std::string_view kCacheVersion = "1";
+
+// Name of the simulation executable within a model's directory.
+constexpr std::string_view kExecutableName = "Vsim";
+
+std::filesystem::path GetCacheDir() {
+  std::string cache_dir = absl::GetFlag(FLAGS_verilator_cache_dir);
+  if (!cache_dir.empty()) {
+    return cache_dir;
+  }
+  return std::filesystem::temp_directory_path() / "xls_verilator_cache";
+}
+
+// Returns a hex digest identifying the model of the given design.
+std::string GetModelKey(std::string_view text, FileType file_type,
+                        absl::Span<const VerilogInclude> includes) {
+  std::vector<std::string_view> pieces = {
+      kCacheVersion, file_type == FileType::kSystemVerilog ? "sv" : "v", text};
+  std::vector<std::string> include_paths;
+  include_paths.reserve(includes.size());
+  for (const VerilogInclude& include : includes) {
+    include_paths.push_back(include.relative_path.string());
+  }
+  for (int64_t i = 0; i < includes.size(); ++i) {
+    pieces.push_back(include_paths[i]);
+    pieces.push_back(includes[i].verilog_text);
+  }
+  return ContentDigest(pieces);
+}
+
+absl::StatusOr<std::pair<std::string, std::string>> InvokeVerilator(
+    absl::Span<const std::string> args, const std::filesystem::path& cwd) {
+  std::vector<std::string> args_vec = {absl::GetFlag(FLAGS_verilator_path)};
+  args_vec.insert(args_vec.end(), args.begin(), args.end());
+  return SubprocessResultToStrings(
+      SubprocessErrorAsStatus(InvokeSubprocess(args_vec, cwd)));
+}
+
+// Writes the design and its includes into `dir` and returns the path of the
+// top file.
+absl::StatusOr<std::filesystem::path> WriteSources(
+    const std::filesystem::path& dir, std::string_view top_file_name,
+    std::string_view text, absl::Span<const VerilogInclude> includes) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(dir));
+  for (const VerilogInclude& include : includes) {
+    std::filesystem::path path = dir / include.relative_path;
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(path.parent_path()));
+    XLS_RETURN_IF_ERROR(SetFileContents(path, include.verilog_text));
+  }
+  std::filesystem::path top_path = dir / top_file_name;
+  XLS_RETURN_IF_ERROR(SetFileContents(top_path, text));
+  return top_path;
+}
+
+// Verilator options shared by simulation and syntax checking. Lint warnings
+// are not errors: generated testbenches trip several of them.
+std::vector<std::string> CommonOptions(const std::filesystem::path& dir) {
+  return {"-Wno-fatal", "-Wno-lint", "-Wno-style",
+          absl::StrCat("-I", dir.string())};
+}
+
+// A model built by Verilator into a simulation executable; each run only
+// executes it.
+class VerilatorCompiledSimulation : public CompiledSimulation {
+ public:
+  explicit VerilatorCompiledSimulation(std::filesystem::path executable)
+      : executable_(std::move(executable)) {}
+
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      absl::Span<const std::string> plusargs) const override {
+    std::vector<std::string> args = {executable_.string()};
+    for (const std::string& plusarg : plusargs) {
+      args.push_back(absl::StrCat("+", plusarg));
+    }
+    return SubprocessResultToStrings(
+        SubprocessErrorAsStatus(InvokeSubprocess(args)));
+  }
+
+ private:
+  std::filesystem::path executable_;
+};
+
+// A simulator which compiles designs with Verilator into native executables.
+// Compiled models are cached across runs and processes by a hash of the
+// design, so repeatedly simulating the same testbench, e.g., through
+// ModuleSimulator::BatchSession, pays for the C++ build only once.
+class VerilatorSimulator : public VerilogSimulator {
+ public:
+  absl::StatusOr<std::pair<std::string, std::string>> Run(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledSimulation> compiled,
+                         Compile(text, file_type, includes));
+    return compiled->Run(/*plusargs=*/{});
+  }
+
+  absl::Status RunSyntaxChecking(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    XLS_ASSIGN_OR_RETURN(TempDirectory temp_dir, TempDirectory::Create());
+    XLS_ASSIGN_OR_RETURN(
+        std::filesystem::path top_path,
+        WriteSources(temp_dir.path(), GetTopFileName(file_type), text,
+                     includes));
+    std::vector<std::string> args = CommonOptions(temp_dir.path());
+    args.push_back("--lint-only");
+    args.push_back(top_path.string());
+    return InvokeVerilator(args, temp_dir.path()).status();
+  }
+
+  absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const override {
+    ContentAddressedCache cache(GetCacheDir());
+    std::string key = GetModelKey(text, file_type, includes);
+    std::filesystem::path entry = cache.EntryPath(key);
+    std::filesystem::path executable = entry / "obj" / kExecutableName;
+    if (FileExists(executable).ok()) {
+      XLS_VLOG(1) << "Using cached Verilator model " << entry;
+      return std::make_unique<VerilatorCompiledSimulation>(executable);
+    }
+
+    // Build in a private staging directory which is published as the entry
+    // once complete so concurrent builders never observe a partial model.
+    XLS_ASSIGN_OR_RETURN(TempDirectory build_dir,
+                         cache.CreateStagingDirectory());
+    XLS_ASSIGN_OR_RETURN(
+        std::filesystem::path top_path,
+        WriteSources(build_dir.path(), GetTopFileName(file_type), text,
+                     includes));
+    std::vector<std::string> args = CommonOptions(build_dir.path());
+    args.insert(args.end(), {"--binary", "-j", "0", "-Mdir",
+                             (build_dir.path() / "obj").string(), "-o",
+                             std::string(kExecutableName), top_path.string()});
+    XLS_RETURN_IF_ERROR(InvokeVerilator(args, build_dir.path()).status());
+
+    // An entry without an executable, e.g., left by an interrupted cleanup,
+    // would otherwise block publishing forever, so replace it.
+    std::error_code ec;
+    if (std::filesystem::exists(entry, ec) && !FileExists(executable).ok()) {
+      XLS_LOG(WARNING) << "Replacing incomplete Verilator model " << entry;
+      std::filesystem::remove_all(entry, ec);
+      if (ec) {
+        return absl::InternalError(absl::StrCat(
+            "Unable to remove incomplete model ", entry.string(), ": ",
+            ec.message()));
+      }
+    }
+    // Another builder may have published the same model first.
+    XLS_ASSIGN_OR_RETURN(bool published,
+                         cache.PublishDirectory(std::move(build_dir), key));
+    if (!published && !FileExists(executable).ok()) {
+      return absl::InternalError(
+          absl::StrCat("Unable to cache model at ", entry.string()));
+    }
+    return std::make_unique<VerilatorCompiledSimulation>(executable);
+  }
+};
+
+XLS_REGISTER_MODULE_INITIALIZER(verilator_simulator, {
+  XLS_CHECK_OK(GetVerilogSimulatorManagerSingleton().RegisterVerilogSimulator(
+      "verilator", std::make_unique<VerilatorSimulator>()));
+});
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
@@ -0,0 +1,147 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+// Tests of the "verilator" Verilog simulator and its cache of compiled models.
+// Requires a Verilator installation, hence the test is manual.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/simulation/verilog_simulator.h"
+#include "xls/simulation/verilog_simulators.h"
+#include "xls/tools/verilog_include.h"
+
+ABSL_DECLARE_FLAG(std::string, verilator_cache_dir);
+
+namespace xls {
+namespace verilog {
+namespace {
+
+using ::testing::HasSubstr;
+
+constexpr std::string_view kIncrementer = R"(module tb;
+  integer x;
+  initial begin
+    if (!$value$plusargs("x=%d", x)) x = 1;
+    $display("y = %0d", x + 1);
+    $finish;
+  end
+endmodule
+)";
+
+constexpr std::string_view kDoubler = R"(module tb;
+  integer x;
+  initial begin
+    if (!$value$plusargs("x=%d", x)) x = 1;
+    $display("y = %0d", x * 2);
+    $finish;
+  end
+endmodule
+)";
+
+class VerilatorSimulatorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    XLS_ASSERT_OK_AND_ASSIGN(cache_dir_, TempDirectory::Create());
+    absl::SetFlag(&FLAGS_verilator_cache_dir, cache_dir_->path().string());
+    XLS_ASSERT_OK_AND_ASSIGN(simulator_, GetVerilogSimulator("verilator"));
+  }
+
+  void TearDown() override { absl::SetFlag(&FLAGS_verilator_cache_dir, ""); }
+
+  // Returns the number of entries in the model cache.
+  int64_t CacheEntryCount() const {
+    int64_t count = 0;
+    for (const auto& entry :
+         std::filesystem::directory_iterator(cache_dir_->path())) {
+      (void)entry;
+      ++count;
+    }
+    return count;
+  }
+
+  std::optional<TempDirectory> cache_dir_;
+  VerilogSimulator* simulator_ = nullptr;
+};
+
+TEST_F(VerilatorSimulatorTest, CompiledModelRunsWithPlusargs) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledSimulation> compiled,
+                           simulator_->Compile(kIncrementer, FileType::kVerilog,
+                                               /*includes=*/{}));
+  XLS_ASSERT_OK_AND_ASSIGN(auto result, compiled->Run(/*plusargs=*/{}));
+  EXPECT_THAT(result.first, HasSubstr("y = 2"));
+  XLS_ASSERT_OK_AND_ASSIGN(result, compiled->Run({"x=41"}));
+  EXPECT_THAT(result.first, HasSubstr("y = 42"));
+}
+
+TEST_F(VerilatorSimulatorTest, ModelsAreCachedByDesign) {
+  XLS_ASSERT_OK(
+      simulator_->Compile(kIncrementer, FileType::kVerilog, {}).status());
+  EXPECT_EQ(CacheEntryCount(), 1);
+
+  // The same design reuses the entry.
+  XLS_ASSERT_OK(
+      simulator_->Compile(kIncrementer, FileType::kVerilog, {}).status());
+  EXPECT_EQ(CacheEntryCount(), 1);
+
+  // A different design, file type or set of includes gets its own entry.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledSimulation> doubler,
+      simulator_->Compile(kDoubler, FileType::kVerilog, {}));
+  EXPECT_EQ(CacheEntryCount(), 2);
+  XLS_ASSERT_OK(
+      simulator_->Compile(kIncrementer, FileType::kSystemVerilog, {})
+          .status());
+  EXPECT_EQ(CacheEntryCount(), 3);
+  VerilogInclude include{.relative_path = "unused.v",
+                         .verilog_text = "// unused\n"};
+  XLS_ASSERT_OK(
+      simulator_->Compile(kIncrementer, FileType::kVerilog, {include})
+          .status());
+  EXPECT_EQ(CacheEntryCount(), 4);
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto result, doubler->Run({"x=21"}));
+  EXPECT_THAT(result.first, HasSubstr("y = 42"));
+}
+
+TEST_F(VerilatorSimulatorTest, IncompleteEntryIsRebuilt) {
+  XLS_ASSERT_OK(
+      simulator_->Compile(kIncrementer, FileType::kVerilog, {}).status());
+  ASSERT_EQ(CacheEntryCount(), 1);
+
+  // Remove the executable from the entry as an interrupted cleanup might.
+  std::filesystem::path entry =
+      std::filesystem::directory_iterator(cache_dir_->path())->path();
+  std::filesystem::remove(entry / "obj" / "Vsim");
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<CompiledSimulation> compiled,
+                           simulator_->Compile(kIncrementer, FileType::kVerilog,
+                                               {}));
+  XLS_ASSERT_OK_AND_ASSIGN(auto result, compiled->Run({"x=41"}));
+  EXPECT_THAT(result.first, HasSubstr("y = 42"));
+  EXPECT_EQ(CacheEntryCount(), 1);
+}
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
@@ -95,6 +95,14 @@ absl::Status VerilogSimulator::RunSyntaxChecking(std::string_view text,
   return RunSyntaxChecking(text, file_type, /*includes=*/{});
 }
 
+absl::StatusOr<std::unique_ptr<CompiledSimulation>> VerilogSimulator::Compile(
+    std::string_view text, FileType file_type,
+    absl::Span<const VerilogInclude> includes) const {
+  return absl::UnimplementedError(
+      "Simulator does not support compiling a design for repeated "
+      "simulation.");
+}
+
 absl::StatusOr<std::vector<Observation>>
 VerilogSimulator::SimulateCombinational(
     std::string_view text, FileType file_type,
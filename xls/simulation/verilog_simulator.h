@@ -15,6 +15,9 @@
 #ifndef XLS_SIMULATION_VERILOG_SIMULATOR_H_
 #define XLS_SIMULATION_VERILOG_SIMULATOR_H_
 
+#include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -37,6 +40,20 @@ struct Observation {
   Bits value;
 };
 
+// A design compiled by a Verilog simulator which can be simulated repeatedly
+// without recompiling it, e.g., over different stimulus files named by
+// plusargs. Run may be called concurrently from several threads.
+class CompiledSimulation {
+ public:
+  virtual ~CompiledSimulation() = default;
+
+  // Simulates the design with the given plusargs (without the leading '+',
+  // e.g., "stimulus=/tmp/in.hex") and returns the stdout/stderr as a string
+  // pair.
+  virtual absl::StatusOr<std::pair<std::string, std::string>> Run(
+      absl::Span<const std::string> plusargs) const = 0;
+};
+
 // Interface wrapping a Verilog simulator such Icarus verilog.
 class VerilogSimulator {
  public:
@@ -57,6 +74,13 @@ class VerilogSimulator {
   absl::Status RunSyntaxChecking(std::string_view text,
                                  FileType file_type) const;
 
+  // Compiles the given Verilog text once for repeated simulation. Returns an
+  // Unimplemented error if the simulator does not separate compilation from
+  // simulation.
+  virtual absl::StatusOr<std::unique_ptr<CompiledSimulation>> Compile(
+      std::string_view text, FileType file_type,
+      absl::Span<const VerilogInclude> includes) const;
+
   // Simulation runner harness: runs the given Verilog text using the verilog
   // simulator infrastructure and returns observations of data values that arose
   // during simulation.
@@ -14,10 +14,14 @@
 
 #include "xls/solvers/z3_ir_translator.h"
 
+#include <algorithm>
+
 #include "absl/debugging/leak_check.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "absl/time/time.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/logging/vlog_is_on.h"
@@ -1433,39 +1437,144 @@ static absl::StatusOr<Z3_ast> PredicateToObjective(Predicate p, Z3_ast a,
 
 absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
                               absl::Duration timeout) {
-  XLS_ASSIGN_OR_RETURN(auto translator, IrTranslator::CreateAndTranslate(f));
-  translator->SetTimeout(timeout);
-  Z3_ast value = translator->GetTranslation(subject);
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IncrementalProver> prover,
+                       IncrementalProver::Create(f));
+  prover->SetTimeout(timeout);
+  return prover->TryProve(subject, p);
+}
+
+std::string SolverQueryStats::ToString() const {
+  std::vector<std::pair<std::string, int64_t>> sorted(counters.begin(),
+                                                      counters.end());
+  std::sort(sorted.begin(), sorted.end());
+  std::string result_str =
+      result == Z3_L_TRUE ? "sat" : (result == Z3_L_FALSE ? "unsat" : "undef");
+  return absl::StrFormat(
+      "%s in %s; %s", result_str, absl::FormatDuration(duration),
+      absl::StrJoin(sorted, ", ", absl::PairFormatter("=")));
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<IncrementalProver>>
+IncrementalProver::Create(FunctionBase* f, bool allow_unsupported) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(f, allow_unsupported));
+  return absl::WrapUnique(new IncrementalProver(std::move(translator)));
+}
+
+IncrementalProver::IncrementalProver(std::unique_ptr<IrTranslator> translator)
+    : translator_(std::move(translator)),
+      solver_(CreateSolver(translator_->ctx(), 1)) {}
+
+IncrementalProver::~IncrementalProver() {
+  ResetModel();
+  Z3_solver_dec_ref(ctx(), solver_);
+}
+
+void IncrementalProver::SetTimeout(absl::Duration timeout) {
+  Z3_params params = Z3_mk_params(ctx());
+  Z3_params_inc_ref(ctx(), params);
+  Z3_params_set_uint(ctx(), params, Z3_mk_string_symbol(ctx(), "timeout"),
+                     absl::ToInt64Milliseconds(timeout));
+  Z3_solver_set_params(ctx(), solver_, params);
+  Z3_params_dec_ref(ctx(), params);
+}
+
+void IncrementalProver::Push() { Z3_solver_push(ctx(), solver_); }
 
+void IncrementalProver::Pop() { Z3_solver_pop(ctx(), solver_, 1); }
+
+void IncrementalProver::Assert(Z3_ast condition) {
+  Z3_solver_assert(ctx(), solver_, condition);
+}
+
+Z3_lbool IncrementalProver::Check(Z3_ast condition,
+                                  absl::Span<const Z3_ast> assumptions) {
+  ResetModel();
+  absl::flat_hash_map<std::string, int64_t> counters_before = GetCounters();
+  absl::Time start = absl::Now();
+  Z3_solver_push(ctx(), solver_);
+  Z3_solver_assert(ctx(), solver_, condition);
+  Z3_lbool satisfiable = Z3_solver_check_assumptions(
+      ctx(), solver_, assumptions.size(), assumptions.data());
+  if (satisfiable == Z3_L_TRUE) {
+    model_ = Z3_solver_get_model(ctx(), solver_);
+    Z3_model_inc_ref(ctx(), model_);
+  }
+  Z3_solver_pop(ctx(), solver_, 1);
+
+  last_stats_.result = satisfiable;
+  last_stats_.duration = absl::Now() - start;
+  last_stats_.counters = GetCounters();
+  for (auto& [key, value] : last_stats_.counters) {
+    auto it = counters_before.find(key);
+    if (it != counters_before.end()) {
+      value -= it->second;
+    }
+  }
+  ++query_count_;
+  total_duration_ += last_stats_.duration;
+  XLS_VLOG(3) << "Query " << query_count_ << ": " << last_stats_.ToString();
+  return satisfiable;
+}
+
+absl::StatusOr<bool> IncrementalProver::TryProve(
+    Node* subject, Predicate p, absl::Span<Node* const> assumptions) {
   // All token types are equal.
   if (subject->GetType()->IsToken() &&
       p.kind() == PredicateKind::kEqualToNode &&
       p.node()->GetType()->IsToken()) {
     return true;
   }
-  if (translator->GetValueKind(value) != Z3_BV_SORT) {
+  Z3_ast value = translator_->GetTranslation(subject);
+  if (translator_->GetValueKind(value) != Z3_BV_SORT) {
     return absl::InvalidArgumentError(
         "Cannot prove properties of non-bits-typed node: " +
         subject->ToString());
   }
   XLS_ASSIGN_OR_RETURN(Z3_ast objective,
-                       PredicateToObjective(p, value, translator.get()));
-  Z3_context ctx = translator->ctx();
-  XLS_VLOG(2) << "objective:\n" << Z3_ast_to_string(ctx, objective);
-  Z3_solver solver = solvers::z3::CreateSolver(ctx, 1);
-  Z3_solver_assert(ctx, solver, objective);
-  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
-  XLS_VLOG(2) << solvers::z3::SolverResultToString(ctx, solver, satisfiable);
-  Z3_solver_dec_ref(ctx, solver);
-
-  if (Z3_solver_check(ctx, solver) == Z3_L_FALSE) {
-    // We posit the inverse of the predicate we want to check -- when that is
-    // unsatisfiable, the predicate has been proven (there was no way found that
-    // we could not satisfy its inverse).
-    return true;
+                       PredicateToObjective(p, value, translator_.get()));
+  XLS_VLOG(2) << "objective:\n" << Z3_ast_to_string(ctx(), objective);
+  std::vector<Z3_ast> assumption_terms;
+  for (Node* assumption : assumptions) {
+    XLS_RET_CHECK_EQ(assumption->GetType()->GetFlatBitCount(), 1)
+        << assumption->ToString();
+    assumption_terms.push_back(BitVectorToBoolean(
+        ctx(), translator_->GetTranslation(assumption)));
   }
 
-  return false;
+  // We posit the inverse of the predicate we want to check -- when that is
+  // unsatisfiable, the predicate has been proven (there was no way found that
+  // we could not satisfy its inverse).
+  return Check(objective, assumption_terms) == Z3_L_FALSE;
+}
+
+bool IncrementalProver::IsTrueInModel(Z3_ast term) {
+  Z3_ast value;
+  return model_ != nullptr &&
+         Z3_model_eval(ctx(), model_, term, /*model_completion=*/true,
+                       &value) &&
+         Z3_get_bool_value(ctx(), value) == Z3_L_TRUE;
+}
+
+void IncrementalProver::ResetModel() {
+  if (model_ != nullptr) {
+    Z3_model_dec_ref(ctx(), model_);
+    model_ = nullptr;
+  }
+}
+
+absl::flat_hash_map<std::string, int64_t> IncrementalProver::GetCounters() {
+  absl::flat_hash_map<std::string, int64_t> counters;
+  Z3_stats stats = Z3_solver_get_statistics(ctx(), solver_);
+  Z3_stats_inc_ref(ctx(), stats);
+  for (unsigned i = 0; i < Z3_stats_size(ctx(), stats); ++i) {
+    if (Z3_stats_is_uint(ctx(), stats, i)) {
+      counters[Z3_stats_get_key(ctx(), stats, i)] +=
+          Z3_stats_get_uint_value(ctx(), stats, i);
+    }
+  }
+  Z3_stats_dec_ref(ctx(), stats);
+  return counters;
 }
 
 }  // namespace z3
@@ -18,8 +18,14 @@
 #ifndef XLS_TOOLS_Z3_IR_TRANSLATOR_H_
 #define XLS_TOOLS_Z3_IR_TRANSLATOR_H_
 
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/logging.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/function.h"
@@ -316,6 +322,79 @@ class Predicate {
 absl::StatusOr<bool> TryProve(Function* f, Node* subject, Predicate p,
                               absl::Duration timeout);
 
+// Statistics of one query of an IncrementalProver.
+struct SolverQueryStats {
+  Z3_lbool result = Z3_L_UNDEF;
+  absl::Duration duration;
+  // The growth of each of the solver's integer statistics (e.g., "conflicts"
+  // or "decisions") over the query.
+  absl::flat_hash_map<std::string, int64_t> counters;
+
+  std::string ToString() const;
+};
+
+// Answers a series of queries about one function with a single translation
+// and a single solver. TryProve above translates the function and builds a
+// solver per query; here each node is translated once, the terms are shared
+// by all queries, and what the solver learns in one query carries over to the
+// next. Each query is asserted in its own scope, on top of the assertions made
+// with Assert in the scopes opened by Push.
+class IncrementalProver {
+ public:
+  static absl::StatusOr<std::unique_ptr<IncrementalProver>> Create(
+      FunctionBase* f, bool allow_unsupported = false);
+  ~IncrementalProver();
+
+  IrTranslator* translator() { return translator_.get(); }
+  Z3_context ctx() { return translator_->ctx(); }
+
+  // Sets the amount of time to allow each query.
+  void SetTimeout(absl::Duration timeout);
+
+  // Opens and closes a scope of assertions.
+  void Push();
+  void Pop();
+
+  // Asserts the boolean `condition` until the current scope is popped.
+  void Assert(Z3_ast condition);
+
+  // Checks whether the boolean `condition` is satisfiable under the assertions
+  // in scope and the boolean `assumptions`, neither of which persist. If
+  // satisfiable, the satisfying assignment is kept for IsTrueInModel until the
+  // next query.
+  Z3_lbool Check(Z3_ast condition, absl::Span<const Z3_ast> assumptions = {});
+
+  // Attempts to prove that `subject` satisfies `p` for all inputs satisfying
+  // the assertions in scope and for which the single-bit `assumptions` are
+  // one. Returns false if disproven or unknown.
+  absl::StatusOr<bool> TryProve(Node* subject, Predicate p,
+                                absl::Span<Node* const> assumptions = {});
+
+  // Returns whether the boolean `term` is true under the assignment found by
+  // the last satisfiable query.
+  bool IsTrueInModel(Z3_ast term);
+
+  const SolverQueryStats& last_query_stats() const { return last_stats_; }
+  int64_t query_count() const { return query_count_; }
+  absl::Duration total_duration() const { return total_duration_; }
+
+ private:
+  explicit IncrementalProver(std::unique_ptr<IrTranslator> translator);
+
+  void ResetModel();
+
+  // Returns the current value of each integer statistic of the solver.
+  absl::flat_hash_map<std::string, int64_t> GetCounters();
+
+  std::unique_ptr<IrTranslator> translator_;
+  Z3_solver solver_;
+  Z3_model model_ = nullptr;
+
+  SolverQueryStats last_stats_;
+  int64_t query_count_ = 0;
+  absl::Duration total_duration_;
+};
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
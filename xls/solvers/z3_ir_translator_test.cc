@@ -34,6 +34,7 @@
 namespace xls {
 namespace {
 
+using solvers::z3::IncrementalProver;
 using solvers::z3::IrTranslator;
 using solvers::z3::Predicate;
 using solvers::z3::TryProve;
@@ -1888,5 +1889,45 @@ fn f() -> bits[1] {
   }
 }
 
+TEST_F(Z3IrTranslatorTest, IncrementalProverAnswersSeveralQueries) {
+  auto p = CreatePackage();
+  FunctionBuilder b("f", p.get());
+  BValue x = b.Param("x", p->GetBitsType(8));
+  BValue y = b.Param("y", p->GetBitsType(8));
+  BValue x_is_zero = b.Eq(x, b.Literal(UBits(0, 8)));
+  BValue x_and_y = b.And(x, y);
+  BValue y_gt_x = b.UGt(y, x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<IncrementalProver> prover,
+                           IncrementalProver::Create(f));
+  prover->SetTimeout(absl::Seconds(60));
+  EXPECT_THAT(prover->TryProve(x_and_y.node(), Predicate::EqualToZero()),
+              IsOkAndHolds(false));
+  // Under an assumption, which doesn't persist past the query.
+  EXPECT_THAT(prover->TryProve(x_and_y.node(), Predicate::EqualToZero(),
+                               {x_is_zero.node()}),
+              IsOkAndHolds(true));
+  EXPECT_THAT(prover->TryProve(x_and_y.node(), Predicate::EqualToZero()),
+              IsOkAndHolds(false));
+
+  // Under an assertion, until its scope is popped.
+  prover->Push();
+  prover->Assert(solvers::z3::BitVectorToBoolean(
+      prover->ctx(), prover->translator()->GetTranslation(x_is_zero.node())));
+  EXPECT_THAT(prover->TryProve(x_and_y.node(), Predicate::EqualToZero()),
+              IsOkAndHolds(true));
+  EXPECT_THAT(prover->TryProve(y_gt_x.node(), Predicate::NotEqualToZero()),
+              IsOkAndHolds(false));
+  EXPECT_EQ(prover->last_query_stats().result, Z3_L_TRUE);
+  prover->Pop();
+  EXPECT_THAT(prover->TryProve(x_and_y.node(), Predicate::EqualToZero()),
+              IsOkAndHolds(false));
+
+  EXPECT_EQ(prover->query_count(), 6);
+  EXPECT_EQ(prover->last_query_stats().result, Z3_L_TRUE);
+  EXPECT_FALSE(prover->last_query_stats().ToString().empty());
+}
+
 }  // namespace
 }  // namespace xls
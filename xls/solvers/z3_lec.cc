@@ -14,14 +14,20 @@
 
 #include "xls/solvers/z3_lec.h"
 
+#include <algorithm>
+#include <atomic>
 #include <thread>  // NOLINT(build/c++11)
 
 #include "absl/base/internal/sysinfo.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/codegen/vast.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/node_util.h"
 #include "xls/solvers/z3_utils.h"
 #include "../z3/src/api/z3_api.h"
@@ -42,8 +48,44 @@ bool CheckingSingleStage(std::optional<PipelineSchedule> schedule,
   return schedule && stage != -1;
 }
 
+// Returns a description of the output bits [first, first + count) of `nodes`
+// (numbered as in LecPartitionResult), e.g., "add.3[7:4], not.5[0]".
+std::string DescribeOutputBits(absl::Span<const Node* const> nodes,
+                               int64_t first, int64_t count) {
+  std::vector<std::string> pieces;
+  int64_t node_first = 0;
+  for (const Node* node : nodes) {
+    int64_t width = node->GetType()->GetFlatBitCount();
+    // Output bits run from the MSB down, so the first index is the high bit.
+    int64_t begin = std::max(first, node_first) - node_first;
+    int64_t end = std::min(first + count, node_first + width) - node_first;
+    if (begin < end) {
+      int64_t hi = width - 1 - begin;
+      int64_t lo = width - end;
+      pieces.push_back(
+          lo == hi ? absl::StrFormat("%s[%d]", node->GetName(), lo)
+                   : absl::StrFormat("%s[%d:%d]", node->GetName(), hi, lo));
+    }
+    node_first += width;
+  }
+  return absl::StrJoin(pieces, ", ");
+}
+
 }  // namespace
 
+std::string LecPartitionStatusToString(LecPartitionStatus status) {
+  switch (status) {
+    case LecPartitionStatus::kProven:
+      return "proven";
+    case LecPartitionStatus::kDisproven:
+      return "disproven";
+    case LecPartitionStatus::kUnknown:
+      return "unknown";
+  }
+  return absl::StrFormat("<invalid LecPartitionStatus %d>",
+                         static_cast<int>(status));
+}
+
 absl::StatusOr<std::unique_ptr<Lec>> Lec::Create(const LecParams& params) {
   auto lec = absl::WrapUnique<Lec>(new Lec(params.ir_function, params.netlist,
                                            params.netlist_module_name,
@@ -63,14 +105,100 @@ absl::StatusOr<std::unique_ptr<Lec>> Lec::CreateForStage(
   return lec;
 }
 
+absl::StatusOr<std::vector<LecPartitionResult>> Lec::RunPartitioned(
+    const LecParams& params, const PartitionedLecOptions& options) {
+  XLS_RET_CHECK_GT(options.bits_per_partition, 0);
+  XLS_RET_CHECK(!options.schedule.has_value() ||
+                options.schedule->function_base() == params.ir_function);
+
+  // Partitions are enumerated up front from the output nodes alone; each is
+  // then translated and solved from scratch in its own context.
+  std::vector<int> stages;
+  if (!options.schedule.has_value()) {
+    stages.push_back(-1);
+  } else if (options.stage != -1) {
+    stages.push_back(options.stage);
+  } else {
+    for (int stage = 0; stage < options.schedule->length(); ++stage) {
+      stages.push_back(stage);
+    }
+  }
+  std::vector<LecPartitionResult> results;
+  for (int stage : stages) {
+    std::vector<const Node*> output_nodes =
+        GetIrOutputNodes(params.ir_function, options.schedule, stage);
+    int64_t bit_count = 0;
+    for (const Node* node : output_nodes) {
+      bit_count += node->GetType()->GetFlatBitCount();
+    }
+    for (int64_t first = 0; first < bit_count;
+         first += options.bits_per_partition) {
+      LecPartitionResult& result = results.emplace_back();
+      result.stage = stage;
+      result.first_bit = first;
+      result.bit_count =
+          std::min(options.bits_per_partition, bit_count - first);
+      result.bits =
+          DescribeOutputBits(output_nodes, first, result.bit_count);
+      result.status = LecPartitionStatus::kUnknown;
+    }
+  }
+
+  std::atomic<bool> failed = false;
+  absl::Mutex mutex;
+  absl::Status status;
+  int64_t max_concurrency = std::max<int64_t>(options.num_threads, 1);
+  BoundedParallelFor(0, results.size(), max_concurrency, [&](int64_t i) {
+    if (failed.load()) {
+      return;
+    }
+    LecPartitionResult& result = results[i];
+    absl::Time start = absl::Now();
+    auto lec = absl::WrapUnique<Lec>(
+        new Lec(params.ir_function, params.netlist,
+                params.netlist_module_name, options.schedule, result.stage,
+                OutputBitRange{result.first_bit, result.bit_count}));
+    absl::Status partition_status = lec->Init();
+    if (partition_status.ok() && options.constraints != nullptr) {
+      partition_status = lec->AddConstraints(options.constraints);
+    }
+    if (!partition_status.ok()) {
+      absl::MutexLock lock(&mutex);
+      status.Update(partition_status);
+      failed.store(true);
+      return;
+    }
+    if (options.partition_timeout.has_value()) {
+      lec->SetTimeout(*options.partition_timeout);
+    }
+    if (lec->Run()) {
+      result.status = LecPartitionStatus::kProven;
+    } else if (lec->result_unknown()) {
+      result.status = LecPartitionStatus::kUnknown;
+    } else {
+      result.status = LecPartitionStatus::kDisproven;
+      result.counterexample = lec->ResultToString();
+    }
+    result.duration = absl::Now() - start;
+    if (options.progress_callback) {
+      absl::MutexLock lock(&mutex);
+      options.progress_callback(result);
+    }
+  });
+  XLS_RETURN_IF_ERROR(status);
+  return results;
+}
+
 Lec::Lec(Function* ir_function, Netlist* netlist,
          const std::string& netlist_module_name,
-         std::optional<PipelineSchedule> schedule, int stage)
+         std::optional<PipelineSchedule> schedule, int stage,
+         std::optional<OutputBitRange> output_bits)
     : ir_function_(ir_function),
       netlist_(netlist),
       netlist_module_name_(netlist_module_name),
       schedule_(schedule),
-      stage_(stage) {}
+      stage_(stage),
+      output_bits_(output_bits) {}
 
 Lec::~Lec() {
   if (model_) {
@@ -100,6 +228,7 @@ absl::Status Lec::Init() {
   Z3_ast x = Z3_mk_const(ctx(), Z3_mk_string_symbol(ctx(), "X"),
                          Z3_mk_bv_sort(ctx(), 1));
   std::vector<Z3_ast> eq_nodes;
+  int64_t bit_index = 0;
   for (const Node* node : ir_output_nodes_) {
     // Extract the individual bits out of each IR output node, and match those
     // up the corresponding netlist bits. The netlist outputs do not contain
@@ -114,7 +243,10 @@ absl::Status Lec::Init() {
                          GetNetlistZ3ForIr(node));
     XLS_RET_CHECK(ir_bits.size() == netlist_bits.size());
 
-    for (int i = 0; i < ir_bits.size(); i++) {
+    for (int i = 0; i < ir_bits.size(); i++, bit_index++) {
+      bool compared = !output_bits_.has_value() ||
+                      (bit_index >= output_bits_->first &&
+                       bit_index < output_bits_->first + output_bits_->count);
       if (netlist_bits[i] == nullptr) {
         XLS_VLOG(3) << "  Skipping " << node->GetName() << " IR output bit "
                     << i;
@@ -123,14 +255,22 @@ absl::Status Lec::Init() {
       } else {
         ir_outputs_.push_back(ir_bits[i]);
         netlist_outputs_.push_back(netlist_bits[i]);
-        eq_nodes.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
+        if (compared) {
+          eq_nodes.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
+        }
       }
     }
   }
 
-  Z3_ast eval_node = Z3_mk_and(ctx(), eq_nodes.size(), eq_nodes.data());
+  // A partition may contain only output bits absent from the netlist.
+  Z3_ast eval_node = eq_nodes.empty() ? Z3_mk_true(ctx())
+                                      : Z3_mk_and(ctx(), eq_nodes.size(),
+                                                  eq_nodes.data());
   eval_node = Z3_mk_not(ctx(), eval_node);
-  solver_ = CreateSolver(ctx(), std::thread::hardware_concurrency());
+  // Partitions are solved in parallel, so each uses a single solver thread.
+  solver_ = CreateSolver(ctx(), output_bits_.has_value()
+                                    ? 1
+                                    : std::thread::hardware_concurrency());
   Z3_solver_assert(ctx(), solver_.value(), eval_node);
 
   return absl::OkStatus();
@@ -170,27 +310,32 @@ absl::Status Lec::CollectIrInputs() {
 }
 
 void Lec::CollectIrOutputNodes() {
+  ir_output_nodes_ = GetIrOutputNodes(ir_function_, schedule_, stage_);
+}
+
+/* static */ std::vector<const Node*> Lec::GetIrOutputNodes(
+    Function* ir_function, const std::optional<PipelineSchedule>& schedule,
+    int stage) {
   // Easy case first! If we're working on the whole function, then we just need
   // the output node & its corresponding wires.
-  if (!CheckingSingleStage(schedule_, stage_)) {
-    ir_output_nodes_ = {ir_function_->return_value()};
-    return;
+  if (!CheckingSingleStage(schedule, stage)) {
+    return {ir_function->return_value()};
   }
 
   // Collect all stage outputs - those nodes using a node within this stage
   // but that aren't present in this cycle. Use a set to uniqify the output
   // nodes.
   absl::flat_hash_set<const Node*> stage_outputs;
-  for (const Node* node : schedule_->nodes_in_cycle(stage_)) {
+  for (const Node* node : schedule->nodes_in_cycle(stage)) {
     for (const Node* user : node->users()) {
-      if (schedule_->cycle(user) != stage_) {
+      if (schedule->cycle(user) != stage) {
         stage_outputs.insert(node);
       }
     }
   }
 
   // Ensure a deterministic output order.
-  ir_output_nodes_ = SetToSortedVector(stage_outputs);
+  return SetToSortedVector(stage_outputs);
 }
 
 absl::StatusOr<std::vector<NetRef>> Lec::GetIrNetrefs(const Node* node) {
@@ -254,20 +399,29 @@ absl::Status Lec::AddConstraints(Function* constraints) {
   return absl::OkStatus();
 }
 
+void Lec::SetTimeout(absl::Duration timeout) {
+  Z3_params params = Z3_mk_params(ctx());
+  Z3_params_inc_ref(ctx(), params);
+  Z3_params_set_uint(ctx(), params, Z3_mk_string_symbol(ctx(), "timeout"),
+                     absl::ToInt64Milliseconds(timeout));
+  Z3_solver_set_params(ctx(), solver_.value(), params);
+  Z3_params_dec_ref(ctx(), params);
+}
+
 bool Lec::Run() {
-  XLS_LOG(INFO) << "Beginning execution";
-  satisfiable_ = Z3_solver_check(ctx(), solver_.value()) == Z3_L_TRUE;
+  XLS_VLOG(1) << "Beginning execution";
+  result_ = Z3_solver_check(ctx(), solver_.value());
+  satisfiable_ = result_ == Z3_L_TRUE;
   if (satisfiable_) {
     model_ = Z3_solver_get_model(ctx(), solver_.value());
     Z3_model_inc_ref(ctx(), model_.value());
   }
-  return !satisfiable_;
+  return result_ == Z3_L_FALSE;
 }
 
 std::string Lec::ResultToString() {
   std::vector<std::string> output;
-  output.push_back(SolverResultToString(ctx(), solver_.value(),
-                                        satisfiable_ ? Z3_L_TRUE : Z3_L_FALSE,
+  output.push_back(SolverResultToString(ctx(), solver_.value(), result_,
                                         /*hexify=*/true));
   if (satisfiable_) {
     for (const Node* node : ir_output_nodes_) {
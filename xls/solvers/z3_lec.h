@@ -15,11 +15,15 @@
 #ifndef XLS_SOLVERS_Z3_LEC_H_
 #define XLS_SOLVERS_Z3_LEC_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "xls/ir/package.h"
 #include "xls/netlist/netlist.h"
@@ -48,6 +52,60 @@ struct LecParams {
   std::string netlist_module_name;
 };
 
+// The outcome of checking one partition of a partitioned LEC.
+enum class LecPartitionStatus {
+  // The compared output bits are equivalent.
+  kProven,
+  // A counterexample was found.
+  kDisproven,
+  // The solver timed out (or otherwise gave up) before reaching an answer.
+  kUnknown,
+};
+
+std::string LecPartitionStatusToString(LecPartitionStatus status);
+
+struct LecPartitionResult {
+  // The pipeline stage checked by the partition, or -1 for a whole-function
+  // check.
+  int stage;
+  // The range of output bits compared by the partition: bits are numbered by
+  // flattening the (stage) output nodes in order, each from its MSB down.
+  int64_t first_bit;
+  int64_t bit_count;
+  // A human-readable list of the compared bits, e.g., "not.4[3:2]".
+  std::string bits;
+  LecPartitionStatus status;
+  absl::Duration duration;
+  // For disproven partitions, the counterexample (Lec::ResultToString()).
+  std::string counterexample;
+};
+
+// Options for Lec::RunPartitioned.
+struct PartitionedLecOptions {
+  // The number of output bits compared by each partition.
+  int64_t bits_per_partition = 1;
+
+  // The number of partitions solved at once on the shared thread pool.
+  int64_t num_threads = 1;
+
+  // If set, the time each partition may spend in the solver before it is
+  // reported as kUnknown.
+  std::optional<absl::Duration> partition_timeout;
+
+  // If set, the schedule of the IR function; every stage is then checked
+  // (stage by stage), or only `stage` if it is not -1.
+  std::optional<PipelineSchedule> schedule;
+  int stage = -1;
+
+  // Optional input constraints, as for Lec::AddConstraints. Only allowed when
+  // checking the whole function or the first stage alone.
+  Function* constraints = nullptr;
+
+  // If set, called after each partition is solved. Calls are serialized but
+  // are made on the worker threads.
+  std::function<void(const LecPartitionResult&)> progress_callback;
+};
+
 // Class for performing logical equivalence checks between a function specified
 // in XLS IR (perhaps converted from DSLX) and a netlist.
 class Lec {
@@ -61,6 +119,16 @@ class Lec {
   // cell/wire to stage is derived from there.
   static absl::StatusOr<std::unique_ptr<Lec>> CreateForStage(
       const LecParams& params, const PipelineSchedule& schedule, int stage);
+
+  // Checks equivalence as a set of independent problems, each comparing
+  // `options.bits_per_partition` of the output bits (of each stage, with a
+  // schedule). A monolithic miter over wide datapaths such as multipliers can
+  // be intractable while each output bit alone is not; up to
+  // `options.num_threads` partitions are solved at once on the shared thread
+  // pool, each with its own Z3 context, so they share nothing. Returns the
+  // results in partition order.
+  static absl::StatusOr<std::vector<LecPartitionResult>> RunPartitioned(
+      const LecParams& params, const PartitionedLecOptions& options);
   ~Lec();
 
   // Applies additional constraints (aside from the LEC itself), such as
@@ -73,9 +141,16 @@ class Lec {
   // Constraints can not be currently specified with per-stage evaluation.
   absl::Status AddConstraints(Function* constraints);
 
+  // Sets the amount of time to allow the solver in Run().
+  void SetTimeout(absl::Duration timeout);
+
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
+  // Returns true if the last Run() ended without an answer, e.g., because the
+  // timeout elapsed.
+  bool result_unknown() const { return result_ == Z3_L_UNDEF; }
+
   // Dumps all Z3 values corresponding to IR nodes in the input function.
   void DumpIrTree();
 
@@ -85,9 +160,16 @@ class Lec {
   Z3_context ctx() { return ir_translator_->ctx(); }
 
  private:
+  // The output bits [first, first + count) compared by a partition.
+  struct OutputBitRange {
+    int64_t first;
+    int64_t count;
+  };
+
   Lec(Function* ir_function, netlist::rtl::Netlist* netlist,
       const std::string& netlist_module_name,
-      std::optional<PipelineSchedule> schedule, int stage);
+      std::optional<PipelineSchedule> schedule, int stage,
+      std::optional<OutputBitRange> output_bits = std::nullopt);
   absl::Status Init();
   absl::Status CreateIrTranslator();
   absl::Status CreateNetlistTranslator();
@@ -100,6 +182,9 @@ class Lec {
   // And the above, but for outputs - either the function outputs for
   // whole-function or last-stage checks, or stage outputs for all others.
   void CollectIrOutputNodes();
+  static std::vector<const Node*> GetIrOutputNodes(
+      Function* ir_function, const std::optional<PipelineSchedule>& schedule,
+      int stage);
 
   // Connects IR Params to netlist inputs.
   absl::Status BindNetlistInputs();
@@ -154,6 +239,9 @@ class Lec {
   std::optional<PipelineSchedule> schedule_;
   int stage_;
 
+  // If set, only these output bits are compared.
+  std::optional<OutputBitRange> output_bits_;
+
   // Z3 elements are, under the hood, void pointers, but let's respect the
   // interface and use std::optional to determine live-ness.
   std::optional<Z3_solver> solver_;
@@ -161,6 +249,7 @@ class Lec {
   // Satisfiable is equivalent to "model_.has_value()", but having an explicit
   // value is more understandable.
   bool satisfiable_;
+  Z3_lbool result_ = Z3_L_UNDEF;
   std::optional<Z3_model> model_;
 };
 
@@ -17,6 +17,8 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/netlist/cell_library.h"
@@ -135,6 +137,89 @@ endmodule
   ASSERT_FALSE(match);
 }
 
+// Verifies that a partitioned LEC proves the matching output bits and
+// pinpoints the mismatched one.
+TEST(Z3LecTest, PartitionedLecLocatesMismatch) {
+  std::string ir_text = R"(
+package p
+
+top fn main(input: bits[4]) -> bits[4] {
+  ret not.2: bits[4] = not(input)
+}
+)";
+
+  std::string netlist_text = R"(
+module main ( clk, input_3_, input_2_, input_1_, input_0_, out_3_, out_2_, out_1_, out_0_);
+  input clk, input_3_, input_2_, input_1_, input_0_;
+  output out_3_, out_2_, out_1_, out_0_;
+  wire p0_input_3_, p0_input_2_, p0_input_1_, p0_input_0_,
+       p0_not_2_comb_3_, p0_not_2_comb_2_, p0_not_2_comb_1_, p0_not_2_comb_0_;
+
+  DFF p0_input_reg_3_ ( .D(input_3_), .CLK(clk), .Q(p0_input_3_) );
+  DFF p0_input_reg_2_ ( .D(input_2_), .CLK(clk), .Q(p0_input_2_) );
+  DFF p0_input_reg_1_ ( .D(input_1_), .CLK(clk), .Q(p0_input_1_) );
+  DFF p0_input_reg_0_ ( .D(input_0_), .CLK(clk), .Q(p0_input_0_) );
+
+  INV p0_not_2_3_ ( .A(p0_input_3_), .ZN(p0_not_2_comb_3_) );
+  INV p0_not_2_2_ ( .A(p0_input_2_), .ZN(p0_not_2_comb_2_) );
+  OR  p0_not_2_1_ ( .A(p0_input_1_), .B(p0_input_1_), .Z(p0_not_2_comb_1_) );
+  INV p0_not_2_0_ ( .A(p0_input_0_), .ZN(p0_not_2_comb_0_) );
+
+  DFF p0_not_2_reg_3_ (.D(p0_not_2_comb_3_), .CLK(clk), .Q(out_3_));
+  DFF p0_not_2_reg_2_ (.D(p0_not_2_comb_2_), .CLK(clk), .Q(out_2_));
+  DFF p0_not_2_reg_1_ (.D(p0_not_2_comb_1_), .CLK(clk), .Q(out_1_));
+  DFF p0_not_2_reg_0_ (.D(p0_not_2_comb_0_), .CLK(clk), .Q(out_0_));
+endmodule
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * entry_function,
+                           package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(netlist::CellLibrary cell_library,
+                           netlist::MakeFakeCellLibrary());
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Netlist> netlist,
+      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+
+  LecParams params;
+  params.ir_package = package.get();
+  params.ir_function = entry_function;
+  params.netlist = netlist.get();
+  params.netlist_module_name = "main";
+
+  int64_t progress_count = 0;
+  PartitionedLecOptions options;
+  options.num_threads = 2;
+  options.partition_timeout = absl::Seconds(60);
+  options.progress_callback = [&](const LecPartitionResult& result) {
+    ++progress_count;
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<LecPartitionResult> results,
+                           Lec::RunPartitioned(params, options));
+  EXPECT_EQ(progress_count, 4);
+  ASSERT_EQ(results.size(), 4);
+  for (int64_t i = 0; i < results.size(); ++i) {
+    EXPECT_EQ(results[i].stage, -1);
+    EXPECT_EQ(results[i].first_bit, i);
+    EXPECT_EQ(results[i].bit_count, 1);
+    EXPECT_EQ(results[i].bits, absl::StrFormat("not.2[%d]", 3 - i));
+    EXPECT_EQ(results[i].status, i == 2 ? LecPartitionStatus::kDisproven
+                                        : LecPartitionStatus::kProven)
+        << results[i].bits;
+  }
+  EXPECT_FALSE(results[2].counterexample.empty());
+
+  options.bits_per_partition = 3;
+  XLS_ASSERT_OK_AND_ASSIGN(results, Lec::RunPartitioned(params, options));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].bits, "not.2[3:1]");
+  EXPECT_EQ(results[0].status, LecPartitionStatus::kDisproven);
+  EXPECT_EQ(results[1].bits, "not.2[0]");
+  EXPECT_EQ(results[1].status, LecPartitionStatus::kProven);
+}
+
 // This test verifies that we can do a simple multi-stage LEC.
 // There are three defined stages:
 // [inputs] -> p0_AND -> p1_OR -> p2 NOT -> [outputs]
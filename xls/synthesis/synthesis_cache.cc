@@ -0,0 +1,181 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/synthesis_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/logging/logging.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+CompileResponse MarkAsCacheHit(CompileResponse response) {
+  (*response.mutable_data_fields())[SynthesisCache::kCacheHitField] = "true";
+  return response;
+}
+
+}  // namespace
+
+/* static */ std::string SynthesisCache::Key(
+    const CompileRequest& request,
+    absl::Span<const std::string> server_config) {
+  std::string target_frequency =
+      request.has_target_frequency_hz()
+          ? absl::StrCat(request.target_frequency_hz())
+          : "";
+  std::vector<std::string_view> pieces = {request.module_text(),
+                                          request.top_module_name(),
+                                          target_frequency};
+  pieces.insert(pieces.end(), server_config.begin(), server_config.end());
+  return ContentDigest(pieces);
+}
+
+SynthesisCache::SynthesisCache(const Options& options) : options_(options) {
+  if (options_.cache_dir.has_value()) {
+    disk_cache_.emplace(*options_.cache_dir);
+  }
+}
+
+absl::StatusOr<CompileResponse> SynthesisCache::GetOrCompile(
+    const std::string& key,
+    const std::function<absl::StatusOr<CompileResponse>()>& compile) {
+  std::shared_ptr<InFlight> in_flight;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto result_it = results_.find(key);
+    if (result_it != results_.end()) {
+      ++hit_count_;
+      return MarkAsCacheHit(result_it->second);
+    }
+    auto in_flight_it = in_flight_.find(key);
+    if (in_flight_it != in_flight_.end()) {
+      // Wait for the identical request which is already being synthesized.
+      std::shared_ptr<InFlight> other = in_flight_it->second;
+      auto done = [&other]() { return other->done; };
+      mutex_.Await(absl::Condition(&done));
+      ++hit_count_;
+      if (!other->result.ok()) {
+        return other->result.status();
+      }
+      return MarkAsCacheHit(*other->result);
+    }
+    in_flight = std::make_shared<InFlight>();
+    in_flight_[key] = in_flight;
+  }
+
+  if (std::optional<CompileResponse> response = ReadFromDisk(key)) {
+    absl::MutexLock lock(&mutex_);
+    ++hit_count_;
+    AddToMemory(key, *response);
+    Finish(key, in_flight.get(), *response);
+    return MarkAsCacheHit(*std::move(response));
+  }
+
+  {
+    absl::MutexLock lock(&mutex_);
+    ++miss_count_;
+    if (queued_jobs_ >= options_.max_queued_jobs) {
+      absl::Status status = absl::ResourceExhaustedError(absl::StrFormat(
+          "Synthesis queue is full (%d requests waiting).", queued_jobs_));
+      Finish(key, in_flight.get(), status);
+      return status;
+    }
+    ++queued_jobs_;
+    auto has_free_slot = [this]() ABSL_SHARED_LOCKS_REQUIRED(mutex_) {
+      return running_jobs_ < options_.max_concurrent_jobs;
+    };
+    mutex_.Await(absl::Condition(&has_free_slot));
+    --queued_jobs_;
+    ++running_jobs_;
+  }
+
+  absl::StatusOr<CompileResponse> result = compile();
+  if (result.ok() && disk_cache_.has_value()) {
+    // Entries are written atomically, so other servers sharing the directory
+    // never read a partial result.
+    absl::Status status = disk_cache_->Write(key, result->SerializeAsString());
+    if (!status.ok()) {
+      XLS_LOG(WARNING) << "Unable to write synthesis result to "
+                       << disk_cache_->EntryPath(key) << ": " << status;
+    }
+  }
+
+  absl::MutexLock lock(&mutex_);
+  --running_jobs_;
+  if (result.ok()) {
+    AddToMemory(key, *result);
+  }
+  Finish(key, in_flight.get(), result);
+  return result;
+}
+
+std::optional<CompileResponse> SynthesisCache::ReadFromDisk(
+    const std::string& key) const {
+  if (!disk_cache_.has_value()) {
+    return std::nullopt;
+  }
+  absl::StatusOr<std::optional<std::string>> serialized =
+      disk_cache_->Read(key);
+  CompileResponse response;
+  if (serialized.ok() && !serialized->has_value()) {
+    return std::nullopt;
+  }
+  if (!serialized.ok() || !response.ParseFromString(**serialized)) {
+    XLS_LOG(WARNING) << "Ignoring unreadable cached synthesis result "
+                     << disk_cache_->EntryPath(key) << ": "
+                     << (serialized.ok() ? "unparseable"
+                                         : serialized.status().ToString());
+    return std::nullopt;
+  }
+  return response;
+}
+
+void SynthesisCache::AddToMemory(const std::string& key,
+                                 const CompileResponse& response) {
+  if (options_.max_cached_results <= 0 || results_.contains(key)) {
+    return;
+  }
+  while (results_.size() >= options_.max_cached_results) {
+    results_.erase(result_order_.front());
+    result_order_.pop_front();
+  }
+  results_[key] = response;
+  result_order_.push_back(key);
+}
+
+void SynthesisCache::Finish(const std::string& key, InFlight* in_flight,
+                            absl::StatusOr<CompileResponse> result) {
+  in_flight->result = std::move(result);
+  in_flight->done = true;
+  in_flight_.erase(key);
+}
+
+int64_t SynthesisCache::hit_count() const {
+  absl::MutexLock lock(&mutex_);
+  return hit_count_;
+}
+
+int64_t SynthesisCache::miss_count() const {
+  absl::MutexLock lock(&mutex_);
+  return miss_count_;
+}
+
+}  // namespace synthesis
+}  // namespace xls
@@ -0,0 +1,125 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SYNTHESIS_SYNTHESIS_CACHE_H_
+#define XLS_SYNTHESIS_SYNTHESIS_CACHE_H_
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+
+// Content-addressed cache of synthesis results which also bounds the number of
+// syntheses running at once. Intended for synthesis servers, where timing
+// characterization sweeps send the same modules over and over.
+//
+// Results are keyed on the request (see Key()) and kept in memory and,
+// optionally, in a directory so they survive server restarts. Concurrent
+// requests with the same key share a single synthesis run. Failed syntheses
+// are not cached. Thread-safe.
+class SynthesisCache {
+ public:
+  struct Options {
+    // Maximum number of syntheses running at once.
+    int64_t max_concurrent_jobs = 1;
+
+    // Maximum number of syntheses waiting for a free slot; further requests
+    // are rejected with a ResourceExhausted error.
+    int64_t max_queued_jobs = 1024;
+
+    // Maximum number of results kept in memory; the oldest are evicted first.
+    int64_t max_cached_results = 16384;
+
+    // If set, results are also stored in (and read back from) this directory,
+    // one binary CompileResponse per file named by its key.
+    std::optional<std::filesystem::path> cache_dir;
+  };
+
+  // Name of the data field set to "true" in responses served from the cache.
+  static constexpr std::string_view kCacheHitField = "cache_hit";
+
+  explicit SynthesisCache(const Options& options);
+
+  // Returns the key of `request`: a digest of the module text, the top module
+  // name and the target frequency (which parameterizes the synthesis
+  // scripts), together with `server_config`. `server_config` should describe
+  // everything else which affects the result, e.g., the target device or cell
+  // library and the tool paths.
+  static std::string Key(const CompileRequest& request,
+                         absl::Span<const std::string> server_config);
+
+  // Returns the cached response for `key` if there is one. Otherwise waits for
+  // a free slot, runs `compile` and caches its result if successful.
+  absl::StatusOr<CompileResponse> GetOrCompile(
+      const std::string& key,
+      const std::function<absl::StatusOr<CompileResponse>()>& compile);
+
+  int64_t hit_count() const;
+  int64_t miss_count() const;
+
+ private:
+  // A synthesis in progress, shared by the requests waiting for its result.
+  struct InFlight {
+    bool done = false;
+    absl::StatusOr<CompileResponse> result;
+  };
+
+  // Reads the response of `key` from the cache directory, if any.
+  std::optional<CompileResponse> ReadFromDisk(const std::string& key) const;
+
+  // Adds `response` to the in-memory cache, evicting old entries as needed.
+  void AddToMemory(const std::string& key, const CompileResponse& response)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Publishes the result of `in_flight` to its waiters.
+  void Finish(const std::string& key, InFlight* in_flight,
+              absl::StatusOr<CompileResponse> result)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  const Options options_;
+  // The cache in `options_.cache_dir`, if any.
+  std::optional<ContentAddressedCache> disk_cache_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, CompileResponse> results_
+      ABSL_GUARDED_BY(mutex_);
+  // Keys of `results_` in insertion order, for eviction.
+  std::deque<std::string> result_order_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::shared_ptr<InFlight>> in_flight_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t running_jobs_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t queued_jobs_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t hit_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t miss_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_SYNTHESIS_SYNTHESIS_CACHE_H_
@@ -0,0 +1,195 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/synthesis_cache.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::IsOkAndHolds;
+using status_testing::StatusIs;
+using ::testing::Contains;
+using ::testing::Not;
+using ::testing::Pair;
+
+CompileRequest MakeRequest(std::string_view module_text,
+                           int64_t target_frequency_hz) {
+  CompileRequest request;
+  request.set_module_text(std::string(module_text));
+  request.set_top_module_name("main");
+  request.set_target_frequency_hz(target_frequency_hz);
+  return request;
+}
+
+CompileResponse MakeResponse(int64_t slack_ps) {
+  CompileResponse response;
+  response.set_slack_ps(slack_ps);
+  return response;
+}
+
+TEST(SynthesisCacheTest, KeyDependsOnRequestAndConfig) {
+  std::string key = SynthesisCache::Key(MakeRequest("module a", 1), {"ice40"});
+  EXPECT_EQ(SynthesisCache::Key(MakeRequest("module a", 1), {"ice40"}), key);
+  EXPECT_NE(SynthesisCache::Key(MakeRequest("module b", 1), {"ice40"}), key);
+  EXPECT_NE(SynthesisCache::Key(MakeRequest("module a", 2), {"ice40"}), key);
+  EXPECT_NE(SynthesisCache::Key(MakeRequest("module a", 1), {"ecp5"}), key);
+  EXPECT_NE(SynthesisCache::Key(MakeRequest("module a", 1), {"ice", "40"}),
+            key);
+}
+
+TEST(SynthesisCacheTest, SuccessfulResultsAreCached) {
+  SynthesisCache cache(SynthesisCache::Options{});
+  int64_t compile_count = 0;
+  auto compile = [&]() -> absl::StatusOr<CompileResponse> {
+    ++compile_count;
+    return MakeResponse(42);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse response,
+                           cache.GetOrCompile("k", compile));
+  EXPECT_EQ(response.slack_ps(), 42);
+  EXPECT_THAT(response.data_fields(),
+              Not(Contains(Pair(SynthesisCache::kCacheHitField, "true"))));
+
+  XLS_ASSERT_OK_AND_ASSIGN(response, cache.GetOrCompile("k", compile));
+  EXPECT_EQ(response.slack_ps(), 42);
+  EXPECT_THAT(response.data_fields(),
+              Contains(Pair(SynthesisCache::kCacheHitField, "true")));
+  EXPECT_EQ(compile_count, 1);
+  EXPECT_EQ(cache.hit_count(), 1);
+  EXPECT_EQ(cache.miss_count(), 1);
+}
+
+TEST(SynthesisCacheTest, FailuresAreNotCached) {
+  SynthesisCache cache(SynthesisCache::Options{});
+  int64_t compile_count = 0;
+  auto compile = [&]() -> absl::StatusOr<CompileResponse> {
+    ++compile_count;
+    return absl::InternalError("yosys crashed");
+  };
+  EXPECT_THAT(cache.GetOrCompile("k", compile),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(cache.GetOrCompile("k", compile),
+              StatusIs(absl::StatusCode::kInternal));
+  EXPECT_EQ(compile_count, 2);
+}
+
+TEST(SynthesisCacheTest, OldestResultsAreEvicted) {
+  SynthesisCache cache(SynthesisCache::Options{.max_cached_results = 2});
+  int64_t compile_count = 0;
+  auto compile = [&]() -> absl::StatusOr<CompileResponse> {
+    return MakeResponse(compile_count++);
+  };
+  XLS_ASSERT_OK(cache.GetOrCompile("a", compile).status());
+  XLS_ASSERT_OK(cache.GetOrCompile("b", compile).status());
+  XLS_ASSERT_OK(cache.GetOrCompile("c", compile).status());
+  EXPECT_EQ(compile_count, 3);
+  XLS_ASSERT_OK(cache.GetOrCompile("c", compile).status());
+  EXPECT_EQ(compile_count, 3);
+  XLS_ASSERT_OK(cache.GetOrCompile("a", compile).status());
+  EXPECT_EQ(compile_count, 4);
+}
+
+TEST(SynthesisCacheTest, ResultsPersistInCacheDirectory) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  SynthesisCache::Options options{.cache_dir = temp_dir.path()};
+  {
+    SynthesisCache cache(options);
+    XLS_ASSERT_OK(
+        cache.GetOrCompile("k", [] { return MakeResponse(7); }).status());
+  }
+  SynthesisCache cache(options);
+  auto fail = []() -> absl::StatusOr<CompileResponse> {
+    return absl::InternalError("should not be called");
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse response,
+                           cache.GetOrCompile("k", fail));
+  EXPECT_EQ(response.slack_ps(), 7);
+  EXPECT_EQ(cache.hit_count(), 1);
+}
+
+TEST(SynthesisCacheTest, ConcurrencyIsBoundedAndDuplicatesShareARun) {
+  constexpr int64_t kThreads = 8;
+  SynthesisCache cache(SynthesisCache::Options{.max_concurrent_jobs = 2});
+  std::atomic<int64_t> running = 0;
+  std::atomic<int64_t> max_running = 0;
+  std::atomic<int64_t> compile_count = 0;
+  auto compile = [&]() -> absl::StatusOr<CompileResponse> {
+    int64_t now_running = ++running;
+    int64_t previous_max = max_running.load();
+    while (now_running > previous_max &&
+           !max_running.compare_exchange_weak(previous_max, now_running)) {
+    }
+    ++compile_count;
+    absl::SleepFor(absl::Milliseconds(20));
+    --running;
+    return MakeResponse(1);
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < kThreads; ++i) {
+    // Every key is requested by two threads.
+    std::string key = absl::StrCat("k", i / 2);
+    threads.push_back(std::make_unique<Thread>([&cache, &compile, key] {
+      EXPECT_THAT(cache.GetOrCompile(key, compile).status(),
+                  status_testing::IsOk());
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  EXPECT_LE(max_running.load(), 2);
+  EXPECT_EQ(compile_count.load(), kThreads / 2);
+}
+
+TEST(SynthesisCacheTest, FullQueueIsRejected) {
+  SynthesisCache cache(SynthesisCache::Options{.max_concurrent_jobs = 1,
+                                               .max_queued_jobs = 0});
+  absl::Notification started;
+  absl::Notification release;
+  Thread blocker([&] {
+    XLS_EXPECT_OK(cache
+                      .GetOrCompile("slow",
+                                    [&]() -> absl::StatusOr<CompileResponse> {
+                                      started.Notify();
+                                      release.WaitForNotification();
+                                      return MakeResponse(0);
+                                    })
+                      .status());
+  });
+  started.WaitForNotification();
+  EXPECT_THAT(cache.GetOrCompile("other", [] { return MakeResponse(1); }),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  release.Notify();
+  blocker.Join();
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
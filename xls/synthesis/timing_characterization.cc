@@ -0,0 +1,315 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/timing_characterization.h"
+
+#include <memory>
+#include <optional>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/codegen/pipeline_generator.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+// How the operands and result of an op are swept.
+enum class SweepKind {
+  // bits[N] -> bits[N].
+  kUnary,
+  // 2 to 7 operands of bits[N] -> bits[N].
+  kVariadic,
+  // bits[N], bits[N] -> bits[N].
+  kBinary,
+  // bits[N], bits[N] -> bits[1].
+  kComparison,
+  // bits[N] -> bits[M] for M > N.
+  kExtension,
+};
+
+struct CharacterizableOp {
+  std::string_view op;
+  std::string_view ir_name;
+  SweepKind kind;
+};
+
+// The ops characterized by timing_characterization_client.py, in the same
+// order. Division is excluded as it is too complex to appear in reasonable RTL.
+constexpr CharacterizableOp kCharacterizableOps[] = {
+    {"kIdentity", "identity", SweepKind::kUnary},
+    {"kNot", "not", SweepKind::kUnary},
+    {"kAnd", "and", SweepKind::kVariadic},
+    {"kOr", "or", SweepKind::kVariadic},
+    {"kXor", "xor", SweepKind::kVariadic},
+    {"kNeg", "neg", SweepKind::kUnary},
+    {"kAdd", "add", SweepKind::kBinary},
+    {"kSMul", "smul", SweepKind::kBinary},
+    {"kSub", "sub", SweepKind::kBinary},
+    {"kUMul", "umul", SweepKind::kBinary},
+    {"kEq", "eq", SweepKind::kComparison},
+    {"kNe", "ne", SweepKind::kComparison},
+    {"kSGe", "sge", SweepKind::kComparison},
+    {"kSGt", "sgt", SweepKind::kComparison},
+    {"kSLe", "sle", SweepKind::kComparison},
+    {"kSLt", "slt", SweepKind::kComparison},
+    {"kUGe", "uge", SweepKind::kComparison},
+    {"kUGt", "ugt", SweepKind::kComparison},
+    {"kULe", "ule", SweepKind::kComparison},
+    {"kULt", "ult", SweepKind::kComparison},
+    {"kShll", "shll", SweepKind::kBinary},
+    {"kShra", "shra", SweepKind::kBinary},
+    {"kShrl", "shrl", SweepKind::kBinary},
+    {"kZeroExt", "zero_ext", SweepKind::kExtension},
+    {"kSignExt", "sign_ext", SweepKind::kExtension},
+};
+
+std::optional<CharacterizableOp> FindCharacterizableOp(std::string_view op) {
+  for (const CharacterizableOp& characterizable_op : kCharacterizableOps) {
+    if (characterizable_op.op == op) {
+      return characterizable_op;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string BitsType(int64_t bit_count) {
+  return absl::StrFormat("bits[%d]", bit_count);
+}
+
+// Returns the text of a package whose top function applies `ir_name` to its
+// parameters, one per operand type. Equivalent to
+// op_module_generator.generate_ir_package.
+absl::StatusOr<std::string> GenerateIrPackage(
+    std::string_view ir_name, std::string_view output_type,
+    const std::vector<std::string>& operand_types,
+    std::string_view attributes = "") {
+  std::vector<std::string> params;
+  std::vector<std::string> args;
+  for (int64_t i = 0; i < operand_types.size(); ++i) {
+    params.push_back(absl::StrFormat("op%d: %s", i, operand_types[i]));
+    args.push_back(absl::StrCat("op", i));
+  }
+  if (!attributes.empty()) {
+    args.push_back(std::string(attributes));
+  }
+  std::string ir_text = absl::StrFormat(
+      "package %s_characterization\n\n"
+      "top fn main(%s) -> %s {\n"
+      "  ret result: %s = %s(%s)\n"
+      "}\n",
+      ir_name, absl::StrJoin(params, ", "), output_type, output_type, ir_name,
+      absl::StrJoin(args, ", "));
+  // Verify the IR parses and verifies.
+  XLS_RETURN_IF_ERROR(Parser::ParsePackage(ir_text).status());
+  return ir_text;
+}
+
+// Returns the operation of a data point. As in the Python client, the bit
+// count of the first operand stands for both the result and the operands.
+delay_model::Operation MakeOperation(std::string_view op, int64_t bit_count) {
+  delay_model::Operation operation;
+  operation.set_op(std::string(op));
+  operation.set_bit_count(bit_count);
+  operation.add_operands()->set_bit_count(bit_count);
+  return operation;
+}
+
+}  // namespace
+
+std::vector<int64_t> CharacterizationBitWidths(int64_t max_width) {
+  std::vector<int64_t> widths = {1, 2};
+  while (widths.back() < max_width) {
+    widths.push_back(widths[widths.size() - 1] + widths[widths.size() - 2]);
+  }
+  return widths;
+}
+
+std::vector<std::string> CharacterizableOps() {
+  std::vector<std::string> ops;
+  for (const CharacterizableOp& characterizable_op : kCharacterizableOps) {
+    ops.push_back(std::string(characterizable_op.op));
+  }
+  return ops;
+}
+
+delay_model::OpModel DefaultOpModel(std::string_view op) {
+  delay_model::OpModel op_model;
+  op_model.set_op(std::string(op));
+  delay_model::DelayFactor* factor = op_model.mutable_estimator()
+                                         ->mutable_regression()
+                                         ->add_expressions()
+                                         ->mutable_factor();
+  factor->set_source(delay_model::DelayFactor::OPERAND_BIT_COUNT);
+  factor->set_operand_number(0);
+  return op_model;
+}
+
+std::string OperationKey(const delay_model::Operation& operation) {
+  std::vector<int64_t> bit_counts = {operation.bit_count()};
+  for (const delay_model::Operation::Operand& operand : operation.operands()) {
+    bit_counts.push_back(operand.bit_count());
+  }
+  return absl::StrCat(operation.op(), ": ", absl::StrJoin(bit_counts, ", "));
+}
+
+absl::StatusOr<std::vector<SweepPoint>> EnumerateSweep(std::string_view op,
+                                                       int64_t max_width) {
+  std::optional<CharacterizableOp> characterizable_op =
+      FindCharacterizableOp(op);
+  if (!characterizable_op.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Op %s cannot be characterized; supported ops: %s", op,
+                        absl::StrJoin(CharacterizableOps(), ", ")));
+  }
+  std::string_view ir_name = characterizable_op->ir_name;
+  std::vector<SweepPoint> points;
+  absl::flat_hash_set<std::string> keys;
+  auto add_point = [&](int64_t bit_count, std::string_view output_type,
+                       const std::vector<std::string>& operand_types,
+                       std::string_view attributes = "") -> absl::Status {
+    delay_model::Operation operation = MakeOperation(op, bit_count);
+    if (!keys.insert(OperationKey(operation)).second) {
+      return absl::OkStatus();
+    }
+    XLS_ASSIGN_OR_RETURN(
+        std::string ir_text,
+        GenerateIrPackage(ir_name, output_type, operand_types, attributes));
+    points.push_back(SweepPoint{.operation = std::move(operation),
+                                .ir_text = std::move(ir_text)});
+    return absl::OkStatus();
+  };
+
+  std::vector<int64_t> widths = CharacterizationBitWidths(max_width);
+  for (int64_t width : widths) {
+    std::string type = BitsType(width);
+    switch (characterizable_op->kind) {
+      case SweepKind::kUnary:
+        XLS_RETURN_IF_ERROR(add_point(width, type, {type}));
+        break;
+      case SweepKind::kVariadic:
+        for (int64_t arity = 2; arity < 8; ++arity) {
+          XLS_RETURN_IF_ERROR(add_point(
+              width, type, std::vector<std::string>(arity, type)));
+        }
+        break;
+      case SweepKind::kBinary:
+        XLS_RETURN_IF_ERROR(add_point(width, type, {type, type}));
+        break;
+      case SweepKind::kComparison:
+        XLS_RETURN_IF_ERROR(add_point(width, BitsType(1), {type, type}));
+        break;
+      case SweepKind::kExtension:
+        for (int64_t new_width : widths) {
+          if (new_width > width) {
+            XLS_RETURN_IF_ERROR(
+                add_point(width, BitsType(new_width), {type},
+                          absl::StrCat("new_bit_count=", new_width)));
+          }
+        }
+        break;
+    }
+  }
+  return points;
+}
+
+absl::StatusOr<std::string> GenerateOpModuleVerilog(
+    const SweepPoint& point, std::string_view module_name) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(point.ir_text));
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+  XLS_ASSIGN_OR_RETURN(
+      PipelineSchedule schedule,
+      PipelineSchedule::Run(f, GetStandardDelayEstimator(),
+                            SchedulingOptions().pipeline_stages(1)));
+  verilog::CodegenOptions options = verilog::BuildPipelineOptions();
+  options.module_name(module_name);
+  options.use_system_verilog(false);
+  XLS_ASSIGN_OR_RETURN(verilog::ModuleGeneratorResult result,
+                       verilog::ToPipelineModuleText(schedule, f, options));
+  return absl::StrCat("// op: ", point.operation.op(), " \n",
+                      result.verilog_text);
+}
+
+absl::StatusOr<CompileResponse> SearchForMaxFrequency(
+    std::string_view verilog_text, std::string_view top_module_name,
+    int64_t min_frequency_hz, int64_t max_frequency_hz,
+    const CompileFunction& compile) {
+  constexpr double kEpsilonHz = 10e6;
+  CompileResponse best_result;
+  double high_hz = max_frequency_hz;
+  double low_hz = min_frequency_hz;
+  CompileRequest request;
+  request.set_module_text(std::string(verilog_text));
+  request.set_top_module_name(std::string(top_module_name));
+  while (high_hz - low_hz > kEpsilonHz) {
+    double current_hz = (high_hz + low_hz) / 2;
+    request.set_target_frequency_hz(static_cast<int64_t>(current_hz));
+    XLS_ASSIGN_OR_RETURN(CompileResponse response, compile(request));
+    if (response.slack_ps() >= 0) {
+      XLS_VLOG(1) << absl::StreamFormat("PASS at %.1fps (slack %dps)",
+                                        1e12 / current_hz, response.slack_ps());
+      low_hz = current_hz;
+      if (current_hz >= best_result.max_frequency_hz()) {
+        best_result = std::move(response);
+      }
+    } else {
+      XLS_VLOG(1) << absl::StreamFormat("FAIL at %.1fps (slack %dps)",
+                                        1e12 / current_hz, response.slack_ps());
+      // Narrow the search around the reported maximum frequency if the target
+      // was far off.
+      if (current_hz > response.max_frequency_hz() * 1.5) {
+        high_hz = response.max_frequency_hz() * 1.1;
+        low_hz = response.max_frequency_hz() * 0.9;
+      } else {
+        high_hz = current_hz;
+      }
+    }
+  }
+  return best_result;
+}
+
+absl::StatusOr<delay_model::DataPoint> CharacterizePoint(
+    const SweepPoint& point, int64_t min_frequency_hz,
+    int64_t max_frequency_hz, const CompileFunction& compile) {
+  constexpr std::string_view kModuleName = "top";
+  XLS_ASSIGN_OR_RETURN(std::string verilog_text,
+                       GenerateOpModuleVerilog(point, kModuleName));
+  XLS_ASSIGN_OR_RETURN(
+      CompileResponse response,
+      SearchForMaxFrequency(verilog_text, kModuleName, min_frequency_hz,
+                            max_frequency_hz, compile));
+  delay_model::DataPoint data_point;
+  *data_point.mutable_operation() = point.operation;
+  if (response.max_frequency_hz() > 0) {
+    data_point.set_delay(
+        static_cast<int64_t>(1e12 / response.max_frequency_hz()));
+  }
+  return data_point;
+}
+
+}  // namespace synthesis
+}  // namespace xls
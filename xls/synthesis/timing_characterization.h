@@ -0,0 +1,90 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Building blocks of the native delay model characterization driver
+// (timing_characterization_main.cc). The sweep mirrors
+// timing_characterization_client.py so that models and checkpoints produced by
+// either are interchangeable.
+
+#ifndef XLS_SYNTHESIS_TIMING_CHARACTERIZATION_H_
+#define XLS_SYNTHESIS_TIMING_CHARACTERIZATION_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/delay_model/delay_model.pb.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+
+// A single point of a characterization sweep: an operation with particular
+// bit widths, and the IR of a function computing it.
+struct SweepPoint {
+  delay_model::Operation operation;
+  std::string ir_text;
+};
+
+// Returns the bit widths at which ops are characterized: the Fibonacci
+// numbers starting at 1, 2 up to the first one at least `max_width`.
+std::vector<int64_t> CharacterizationBitWidths(int64_t max_width);
+
+// Returns the ops (e.g., "kAdd") which can be characterized, in the order in
+// which they are characterized by default.
+std::vector<std::string> CharacterizableOps();
+
+// Returns the op model recorded for a characterized op: a regression over the
+// bit count of the first operand.
+delay_model::OpModel DefaultOpModel(std::string_view op);
+
+// Returns the key identifying the data point of `operation`; operations with
+// the same key are only characterized once.
+std::string OperationKey(const delay_model::Operation& operation);
+
+// Returns the sweep of `op` up to `max_width` bits, without points whose
+// operation has the same key as an earlier point.
+absl::StatusOr<std::vector<SweepPoint>> EnumerateSweep(std::string_view op,
+                                                       int64_t max_width);
+
+// Returns the Verilog of a single-stage pipeline named `module_name` computing
+// the function of `point`.
+absl::StatusOr<std::string> GenerateOpModuleVerilog(
+    const SweepPoint& point, std::string_view module_name);
+
+using CompileFunction =
+    std::function<absl::StatusOr<CompileResponse>(const CompileRequest&)>;
+
+// Finds the maximum frequency at which `verilog_text` meets timing by bisecting
+// target frequencies between `min_frequency_hz` and `max_frequency_hz`, and
+// returns the response of the highest passing frequency (an empty response if
+// none passed).
+absl::StatusOr<CompileResponse> SearchForMaxFrequency(
+    std::string_view verilog_text, std::string_view top_module_name,
+    int64_t min_frequency_hz, int64_t max_frequency_hz,
+    const CompileFunction& compile);
+
+// Synthesizes `point` and returns its data point; the delay is the period of
+// the maximum frequency found by SearchForMaxFrequency (zero if none).
+absl::StatusOr<delay_model::DataPoint> CharacterizePoint(
+    const SweepPoint& point, int64_t min_frequency_hz,
+    int64_t max_frequency_hz, const CompileFunction& compile);
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_SYNTHESIS_TIMING_CHARACTERIZATION_H_
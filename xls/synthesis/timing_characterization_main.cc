@@ -0,0 +1,308 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Native delay model characterization driver: sweeps ops over bit widths,
+// finding the delay of each point by synthesizing it on a pool of synthesis
+// servers, and emits the resulting xls.delay_model.DelayModel textproto.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/text_format.h"
+#include "grpcpp/grpcpp.h"
+#include "grpcpp/security/credentials.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/delay_model/delay_model.pb.h"
+#include "xls/synthesis/synthesis.pb.h"
+#include "xls/synthesis/synthesis_service.grpc.pb.h"
+#include "xls/synthesis/timing_characterization.h"
+
+const char kUsage[] = R"(
+Characterizes the delay of XLS ops by synthesizing them at a sweep of bit widths
+on one or more synthesis servers, and prints the resulting DelayModel textproto.
+
+Points already present in the checkpoint are skipped, so an interrupted run
+resumes where it stopped when rerun with the same --checkpoint_path.
+
+Invocation:
+
+  timing_characterization_main --servers=host1:10000,host2:10000 \
+      --checkpoint_path=/tmp/model.textproto [--spec=model.textproto]
+)";
+
+ABSL_FLAG(std::string, servers, "localhost:10000",
+          "Comma-separated addresses of the synthesis servers to use.");
+ABSL_FLAG(int64_t, requests_per_server, 1,
+          "Number of points synthesized concurrently on each server.");
+ABSL_FLAG(std::string, spec, "",
+          "Optional DelayModel textproto whose regression op models determine "
+          "the ops to characterize. Its op models and data points are carried "
+          "over to the output.");
+ABSL_FLAG(std::string, ops, "",
+          "Comma-separated ops (e.g., kAdd,kUMul) to characterize. Overrides "
+          "the ops from --spec; defaults to all characterizable ops.");
+ABSL_FLAG(std::string, checkpoint_path, "",
+          "Path at which the model is loaded from and saved after every "
+          "characterized point. Checkpoints are not kept if unspecified.");
+ABSL_FLAG(bool, quick_run, false, "Do just a small subset for testing.");
+ABSL_FLAG(int64_t, max_width, 8, "Max width in bits to sweep.");
+ABSL_FLAG(int64_t, min_freq_mhz, 500, "Minimum frequency to test.");
+ABSL_FLAG(int64_t, max_freq_mhz, 5000, "Maximum frequency to test.");
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+// Returns the ops to characterize, adding op models for them to `model` as
+// needed.
+absl::StatusOr<std::vector<std::string>> GetOps(
+    const delay_model::DelayModel* spec, delay_model::DelayModel* model) {
+  std::vector<std::string> ops;
+  std::string ops_flag = absl::GetFlag(FLAGS_ops);
+  if (!ops_flag.empty()) {
+    ops = absl::StrSplit(ops_flag, ',');
+  } else if (absl::GetFlag(FLAGS_quick_run)) {
+    ops = {"kAdd", "kUMul"};
+  } else if (spec != nullptr) {
+    std::vector<std::string> characterizable = CharacterizableOps();
+    for (const delay_model::OpModel& op_model : spec->op_models()) {
+      if (!op_model.estimator().has_regression()) {
+        continue;
+      }
+      if (std::find(characterizable.begin(), characterizable.end(),
+                    op_model.op()) == characterizable.end()) {
+        XLS_LOG(WARNING) << "Skipping op " << op_model.op()
+                         << " which cannot be characterized.";
+        continue;
+      }
+      ops.push_back(op_model.op());
+    }
+  } else {
+    ops = CharacterizableOps();
+  }
+
+  absl::flat_hash_set<std::string> modeled_ops;
+  for (const delay_model::OpModel& op_model : model->op_models()) {
+    modeled_ops.insert(op_model.op());
+  }
+  for (const std::string& op : ops) {
+    if (modeled_ops.insert(op).second) {
+      *model->add_op_models() = DefaultOpModel(op);
+    }
+  }
+  return ops;
+}
+
+// Writes `model` to `path` via a temporary file, so that an interruption never
+// leaves a truncated checkpoint.
+absl::Status SaveCheckpoint(const delay_model::DelayModel& model,
+                            const std::filesystem::path& path) {
+  std::filesystem::path temp_path = path;
+  temp_path += ".tmp";
+  XLS_RETURN_IF_ERROR(SetTextProtoFile(temp_path, model));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, path, ec);
+  if (ec) {
+    return absl::InternalError(absl::StrFormat(
+        "Unable to rename %s to %s: %s", temp_path.string(), path.string(),
+        ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+// Orders the data points by op (in the order of the op models) and then by bit
+// counts, as they are added in completion order.
+void SortDataPoints(delay_model::DelayModel* model) {
+  absl::flat_hash_map<std::string, int64_t> op_index;
+  for (const delay_model::OpModel& op_model : model->op_models()) {
+    op_index.insert({op_model.op(), op_index.size()});
+  }
+  auto sort_key = [&](const delay_model::DataPoint& data_point) {
+    const delay_model::Operation& operation = data_point.operation();
+    auto it = op_index.find(operation.op());
+    std::vector<int64_t> key = {
+        it == op_index.end() ? static_cast<int64_t>(op_index.size())
+                             : it->second,
+        operation.bit_count()};
+    for (const auto& operand : operation.operands()) {
+      key.push_back(operand.bit_count());
+    }
+    return key;
+  };
+  std::stable_sort(model->mutable_data_points()->begin(),
+                   model->mutable_data_points()->end(),
+                   [&](const delay_model::DataPoint& a,
+                       const delay_model::DataPoint& b) {
+                     return sort_key(a) < sort_key(b);
+                   });
+}
+
+absl::Status RealMain() {
+  const std::string checkpoint_path = absl::GetFlag(FLAGS_checkpoint_path);
+  const std::string spec_path = absl::GetFlag(FLAGS_spec);
+  std::optional<delay_model::DelayModel> spec;
+  if (!spec_path.empty()) {
+    spec.emplace();
+    XLS_RETURN_IF_ERROR(ParseTextProtoFile(spec_path, &*spec));
+  }
+  delay_model::DelayModel model;
+  if (!checkpoint_path.empty() && FileExists(checkpoint_path).ok()) {
+    XLS_RETURN_IF_ERROR(ParseTextProtoFile(checkpoint_path, &model));
+    XLS_LOG(INFO) << "Resuming from checkpoint with "
+                  << model.data_points_size() << " data points.";
+  } else if (spec.has_value()) {
+    model = *spec;
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<std::string> ops,
+                       GetOps(spec.has_value() ? &*spec : nullptr, &model));
+
+  // Enumerate the points which have not been characterized yet.
+  absl::flat_hash_set<std::string> done;
+  for (const delay_model::DataPoint& data_point : model.data_points()) {
+    done.insert(OperationKey(data_point.operation()));
+  }
+  std::vector<SweepPoint> points;
+  for (const std::string& op : ops) {
+    XLS_ASSIGN_OR_RETURN(std::vector<SweepPoint> op_points,
+                         EnumerateSweep(op, absl::GetFlag(FLAGS_max_width)));
+    for (SweepPoint& point : op_points) {
+      if (!done.contains(OperationKey(point.operation))) {
+        points.push_back(std::move(point));
+      }
+    }
+  }
+  XLS_LOG(INFO) << absl::StreamFormat(
+      "%d points to characterize (%d already characterized).", points.size(),
+      done.size());
+
+  std::vector<std::unique_ptr<SynthesisService::Stub>> stubs;
+  for (std::string_view server :
+       absl::StrSplit(absl::GetFlag(FLAGS_servers), ',', absl::SkipEmpty())) {
+    stubs.push_back(SynthesisService::NewStub(::grpc::CreateChannel(
+        std::string(server),
+        ::grpc::experimental::LocalCredentials(LOCAL_TCP))));
+  }
+  if (stubs.empty()) {
+    return absl::InvalidArgumentError("--servers must not be empty.");
+  }
+
+  const int64_t min_frequency_hz = absl::GetFlag(FLAGS_min_freq_mhz) * 1000000;
+  const int64_t max_frequency_hz = absl::GetFlag(FLAGS_max_freq_mhz) * 1000000;
+  std::atomic<int64_t> next_point = 0;
+  absl::Mutex mutex;
+  absl::Status first_error;
+  int64_t failure_count = 0;
+  auto worker = [&](SynthesisService::Stub* stub) {
+    CompileFunction compile = [stub](const CompileRequest& request)
+        -> absl::StatusOr<CompileResponse> {
+      ::grpc::ClientContext context;
+      CompileResponse response;
+      ::grpc::Status status = stub->Compile(&context, request, &response);
+      if (!status.ok()) {
+        return absl::InternalError(absl::StrCat(
+            "Synthesis request failed: ", status.error_message()));
+      }
+      return response;
+    };
+    for (int64_t i = next_point.fetch_add(1); i < points.size();
+         i = next_point.fetch_add(1)) {
+      const SweepPoint& point = points[i];
+      std::string key = OperationKey(point.operation);
+      XLS_LOG(INFO) << "Characterizing " << key;
+      absl::StatusOr<delay_model::DataPoint> data_point = CharacterizePoint(
+          point, min_frequency_hz, max_frequency_hz, compile);
+      absl::MutexLock lock(&mutex);
+      if (!data_point.ok()) {
+        XLS_LOG(ERROR) << "Unable to characterize " << key << ": "
+                       << data_point.status();
+        ++failure_count;
+        first_error.Update(data_point.status());
+        continue;
+      }
+      XLS_LOG(INFO) << key << ": " << data_point->delay() << "ps";
+      *model.add_data_points() = *std::move(data_point);
+      if (!checkpoint_path.empty()) {
+        absl::Status status = SaveCheckpoint(model, checkpoint_path);
+        if (!status.ok()) {
+          XLS_LOG(ERROR) << "Unable to save checkpoint: " << status;
+        }
+      }
+    }
+  };
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (std::unique_ptr<SynthesisService::Stub>& stub : stubs) {
+    for (int64_t i = 0; i < absl::GetFlag(FLAGS_requests_per_server); ++i) {
+      threads.push_back(
+          std::make_unique<Thread>([&worker, &stub] { worker(stub.get()); }));
+    }
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  SortDataPoints(&model);
+  if (!checkpoint_path.empty()) {
+    XLS_RETURN_IF_ERROR(SaveCheckpoint(model, checkpoint_path));
+  }
+  std::string model_text;
+  XLS_RET_CHECK(
+      google::protobuf::TextFormat::PrintToString(model, &model_text));
+  std::cout << "# proto-file: xls/delay_model/delay_model.proto\n"
+            << "# proto-message: xls.delay_model.DelayModel\n"
+            << model_text;
+  if (failure_count > 0) {
+    return absl::Status(
+        first_error.code(),
+        absl::StrFormat("%d points failed; rerun to retry them. First error: "
+                        "%s",
+                        failure_count, first_error.message()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  XLS_QCHECK(positional_arguments.empty())
+      << "Unexpected positional arguments.";
+  XLS_QCHECK_OK(xls::synthesis::RealMain());
+  return EXIT_SUCCESS;
+}
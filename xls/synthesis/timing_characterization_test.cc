@@ -0,0 +1,131 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/timing_characterization.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+constexpr int64_t kMaxFrequencyHz = 1'000'000'000;
+
+// Compiles every request as if the design met timing up to 1GHz.
+absl::StatusOr<CompileResponse> FakeCompile(const CompileRequest& request) {
+  CompileResponse response;
+  response.set_max_frequency_hz(kMaxFrequencyHz);
+  response.set_slack_ps(request.target_frequency_hz() <= kMaxFrequencyHz
+                            ? 0
+                            : -100);
+  return response;
+}
+
+TEST(TimingCharacterizationTest, BitWidths) {
+  EXPECT_THAT(CharacterizationBitWidths(8), ElementsAre(1, 2, 3, 5, 8));
+  EXPECT_THAT(CharacterizationBitWidths(10), ElementsAre(1, 2, 3, 5, 8, 13));
+}
+
+TEST(TimingCharacterizationTest, BinarySweep) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<SweepPoint> points,
+                           EnumerateSweep("kAdd", 8));
+  std::vector<std::string> keys;
+  for (const SweepPoint& point : points) {
+    keys.push_back(OperationKey(point.operation));
+  }
+  EXPECT_THAT(keys, ElementsAre("kAdd: 1, 1", "kAdd: 2, 2", "kAdd: 3, 3",
+                                "kAdd: 5, 5", "kAdd: 8, 8"));
+  EXPECT_THAT(points[1].ir_text,
+              HasSubstr("ret result: bits[2] = add(op0, op1)"));
+}
+
+TEST(TimingCharacterizationTest, DuplicatePointsAreSkipped) {
+  // All arities of a variadic op share a data point, as do all result widths
+  // of an extension, so only the first of each is swept.
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<SweepPoint> and_points,
+                           EnumerateSweep("kAnd", 8));
+  ASSERT_EQ(and_points.size(), 5);
+  EXPECT_THAT(and_points[0].ir_text, HasSubstr("and(op0, op1)"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<SweepPoint> ext_points,
+                           EnumerateSweep("kZeroExt", 8));
+  ASSERT_EQ(ext_points.size(), 4);
+  EXPECT_THAT(ext_points[0].ir_text,
+              HasSubstr("zero_ext(op0, new_bit_count=2)"));
+}
+
+TEST(TimingCharacterizationTest, UnsupportedOp) {
+  EXPECT_THAT(EnumerateSweep("kUDiv", 8),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("cannot be characterized")));
+}
+
+TEST(TimingCharacterizationTest, OpModuleVerilog) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<SweepPoint> points,
+                           EnumerateSweep("kULt", 8));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string verilog,
+                           GenerateOpModuleVerilog(points[0], "top"));
+  EXPECT_THAT(verilog, HasSubstr("// op: kULt"));
+  EXPECT_THAT(verilog, HasSubstr("module top("));
+}
+
+TEST(TimingCharacterizationTest, SearchForMaxFrequency) {
+  std::vector<int64_t> targets;
+  auto compile = [&](const CompileRequest& request) {
+    targets.push_back(request.target_frequency_hz());
+    return FakeCompile(request);
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CompileResponse response,
+      SearchForMaxFrequency("module top(); endmodule", "top", 500'000'000,
+                            5'000'000'000, compile));
+  EXPECT_GE(response.slack_ps(), 0);
+  EXPECT_EQ(response.max_frequency_hz(), kMaxFrequencyHz);
+  EXPECT_FALSE(targets.empty());
+}
+
+TEST(TimingCharacterizationTest, CharacterizePoint) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<SweepPoint> points,
+                           EnumerateSweep("kNot", 8));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      delay_model::DataPoint data_point,
+      CharacterizePoint(points[2], 500'000'000, 5'000'000'000, FakeCompile));
+  EXPECT_EQ(data_point.operation().op(), "kNot");
+  EXPECT_EQ(data_point.operation().bit_count(), 3);
+  EXPECT_EQ(data_point.delay(), 1000);
+}
+
+TEST(TimingCharacterizationTest, CompileErrorsArePropagated) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<SweepPoint> points,
+                           EnumerateSweep("kNot", 8));
+  auto fail = [](const CompileRequest&) -> absl::StatusOr<CompileResponse> {
+    return absl::UnavailableError("server down");
+  };
+  EXPECT_THAT(CharacterizePoint(points[0], 500'000'000, 5'000'000'000, fail),
+              StatusIs(absl::StatusCode::kUnavailable));
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
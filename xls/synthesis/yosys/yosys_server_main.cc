@@ -12,6 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
@@ -32,6 +39,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
 #include "xls/synthesis/server_credentials.h"
+#include "xls/synthesis/synthesis_cache.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
 #include "xls/synthesis/yosys/yosys_util.h"
@@ -66,6 +74,20 @@ ABSL_FLAG(std::string, synthesis_libraries, "",
 ABSL_FLAG(
     std::string, sta_libraries, "",
     "The technology library/libraries file to target for STA; *.lib * lib.gz");
+ABSL_FLAG(int64_t, max_concurrent_jobs, std::thread::hardware_concurrency(),
+          "Maximum number of syntheses to run at once. Further requests wait "
+          "in a queue.");
+ABSL_FLAG(int64_t, max_queued_jobs, 1024,
+          "Maximum number of requests waiting for a synthesis slot; further "
+          "requests are rejected with RESOURCE_EXHAUSTED.");
+ABSL_FLAG(int64_t, max_cached_results, 16384,
+          "Maximum number of synthesis results cached in memory. Requests "
+          "identical to an earlier one (same Verilog, top, target frequency "
+          "and server configuration) are answered from the cache.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If specified, synthesis results are also cached in this directory, "
+          "which persists them across server restarts and may be shared by "
+          "servers with the same configuration.");
 
 namespace xls {
 namespace synthesis {
@@ -78,27 +100,43 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
                                      std::string_view synthesis_target,
                                      std::string_view sta_path,
                                      std::string_view synthesis_libraries,
-                                     std::string_view sta_libraries)
+                                     std::string_view sta_libraries,
+                                     const SynthesisCache::Options& options)
       : yosys_path_(yosys_path),
         nextpnr_path_(nextpnr_path),
         synthesis_target_(synthesis_target),
         sta_path_(sta_path),
         synthesis_libraries_(synthesis_libraries),
-        sta_libraries_(sta_libraries) {}
+        sta_libraries_(sta_libraries),
+        server_config_({yosys_path_, nextpnr_path_, synthesis_target_,
+                        sta_path_, synthesis_libraries_, sta_libraries_,
+                        absl::StrCat(absl::GetFlag(FLAGS_synthesis_only)),
+                        absl::StrCat(absl::GetFlag(FLAGS_return_netlist))}),
+        cache_(options) {}
 
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override {
-    auto start = absl::Now();
-
-    absl::Status synthesis_status = RunSynthesis(request, result);
-    if (!synthesis_status.ok()) {
-      return ::grpc::Status(grpc::StatusCode::INTERNAL,
-                            std::string(synthesis_status.message()));
+    absl::StatusOr<CompileResponse> response = cache_.GetOrCompile(
+        SynthesisCache::Key(*request, server_config_),
+        [&]() -> absl::StatusOr<CompileResponse> {
+          auto start = absl::Now();
+          CompileResponse response;
+          XLS_RETURN_IF_ERROR(RunSynthesis(request, &response));
+          response.set_elapsed_runtime_ms(
+              absl::ToInt64Milliseconds(absl::Now() - start));
+          return response;
+        });
+    XLS_VLOG(1) << absl::StreamFormat("Synthesis cache: %d hits, %d misses",
+                                      cache_.hit_count(), cache_.miss_count());
+    if (!response.ok()) {
+      return ::grpc::Status(
+          absl::IsResourceExhausted(response.status())
+              ? grpc::StatusCode::RESOURCE_EXHAUSTED
+              : grpc::StatusCode::INTERNAL,
+          std::string(response.status().message()));
     }
-
-    result->set_elapsed_runtime_ms(
-        absl::ToInt64Milliseconds(absl::Now() - start));
+    *result = *std::move(response);
 
     return ::grpc::Status::OK;
   }
@@ -425,6 +463,11 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   std::string sta_path_;
   std::string synthesis_libraries_;
   std::string sta_libraries_;
+
+  // Everything besides the request which affects the synthesis result; part
+  // of the cache key.
+  std::vector<std::string> server_config_;
+  SynthesisCache cache_;
 };
 
 void RealMain() {
@@ -466,9 +509,19 @@ void RealMain() {
 
   int port = absl::GetFlag(FLAGS_port);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
+  SynthesisCache::Options cache_options{
+      .max_concurrent_jobs =
+          std::max<int64_t>(absl::GetFlag(FLAGS_max_concurrent_jobs), 1),
+      .max_queued_jobs = absl::GetFlag(FLAGS_max_queued_jobs),
+      .max_cached_results = absl::GetFlag(FLAGS_max_cached_results)};
+  std::string cache_dir = absl::GetFlag(FLAGS_cache_dir);
+  if (!cache_dir.empty()) {
+    XLS_QCHECK_OK(RecursivelyCreateDir(cache_dir));
+    cache_options.cache_dir = cache_dir;
+  }
   YosysSynthesisServiceImpl service(yosys_path, nextpnr_path, synthesis_target,
                                     sta_path, synthesis_libraries,
-                                    sta_libraries);
+                                    sta_libraries, cache_options);
 
   ::grpc::ServerBuilder builder;
   std::shared_ptr<::grpc::ServerCredentials> creds = GetServerCredentials();
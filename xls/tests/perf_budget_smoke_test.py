@@ -0,0 +1,211 @@
+#
+# Copyright 2023 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Performance budget smoke test of the XLS toolchain.
+
+Benchmarks the optimization, scheduling, codegen and JIT compilation and
+evaluation of the floating-point and AES modules, some of the examples and two
+large synthetic designs with benchmark_main, and checks the timings, peak
+memory and quality of results of each design against the budgets in
+perf_budgets.textproto. Each design is benchmarked in its own process so that
+its peak memory is its own.
+
+The checked-in budgets are coarse limits, not measurements, so the test only
+catches blowups such as a pass going quadratic, not small regressions. Running
+it with --write_budgets=<path> writes budgets derived from the measured
+results, with headroom for machine noise, which may replace
+perf_budgets.textproto on a machine that tracks the toolchain's performance.
+"""
+
+import os
+import subprocess
+from typing import Dict, List
+
+from absl import flags
+
+from google.protobuf import json_format
+from google.protobuf import text_format
+from absl.testing import absltest
+from xls.common import runfiles
+from xls.common import test_base
+from xls.tests import perf_budgets_pb2
+from xls.tools import benchmark_results_pb2
+
+_WRITE_BUDGETS = flags.DEFINE_string(
+    'write_budgets', None,
+    'If set, write budgets derived from the measured results to this path.')
+
+_BENCHMARK_MAIN_PATH = runfiles.get_path('xls/tools/benchmark_main')
+_BUDGETS_PATH = runfiles.get_path('xls/tests/perf_budgets.textproto')
+
+# Unoptimized IR of the designs of the test, as converted from DSLX by the
+# build.
+_IR_PATHS = (
+    'xls/modules/fp/fp32_add_2.ir',
+    'xls/modules/fp/fp32_mul_2.ir',
+    'xls/modules/fp/fp32_fma.ir',
+    'xls/modules/fp/fp64_add_2.ir',
+    'xls/modules/aes/aes_encrypt.ir',
+    'xls/modules/aes/aes_ctr.ir',
+    'xls/modules/aes/aes_ghash.ir',
+    'xls/examples/adler32.ir',
+    'xls/examples/sha256.ir',
+    'xls/examples/large_array.ir',
+)
+
+# Flags shared by the benchmark of every design. The unit delay model keeps
+# the schedules independent of the delay model of any process.
+_BENCHMARK_FLAGS = (
+    '--delay_model=unit',
+    '--clock_period_ps=10',
+    '--batch_threads=1',
+)
+
+# Slack of the budgets written with --write_budgets, as factors of the
+# measured values.
+_TIME_AND_MEMORY_SLACK = 3
+_QUALITY_SLACK = 0.1
+
+
+def _synthetic_chain_ir(length: int) -> str:
+  """Returns a function which is a dependent chain of `length` operations."""
+  ops = ('add', 'xor', 'sub', 'or')
+  lines = ['package synthetic_chain', '',
+           'top fn synthetic_chain(p0: bits[64], p1: bits[64], p2: bits[64], '
+           'p3: bits[64]) -> bits[64] {',
+           '  n0: bits[64] = add(p0, p1)']
+  for i in range(1, length):
+    lines.append(f'  n{i}: bits[64] = {ops[i % len(ops)]}(n{i - 1}, p{i % 4})')
+  lines.append(f'  ret result: bits[64] = identity(n{length - 1})')
+  lines.append('}')
+  return '\n'.join(lines) + '\n'
+
+
+def _synthetic_wide_ir(width: int) -> str:
+  """Returns a function of `width` independent multiplies summed by a tree."""
+  lines = ['package synthetic_wide', '',
+           'top fn synthetic_wide(a: bits[32], b: bits[32]) -> bits[32] {']
+  level = []
+  for i in range(width):
+    lines.append(f'  k{i}: bits[32] = literal(value={i})')
+    lines.append(f'  x{i}: bits[32] = xor(a, k{i})')
+    lines.append(f'  m{i}: bits[32] = umul(x{i}, b)')
+    level.append(f'm{i}')
+  depth = 0
+  while len(level) > 1:
+    next_level = []
+    for i in range(0, len(level) - 1, 2):
+      name = f's{depth}_{i // 2}'
+      lines.append(f'  {name}: bits[32] = add({level[i]}, {level[i + 1]})')
+      next_level.append(name)
+    if len(level) % 2:
+      next_level.append(level[-1])
+    level = next_level
+    depth += 1
+  lines.append(f'  ret result: bits[32] = identity({level[0]})')
+  lines.append('}')
+  return '\n'.join(lines) + '\n'
+
+
+def _derive_ranges(
+    design: benchmark_results_pb2.DesignBenchmarkProto
+) -> Dict[str, perf_budgets_pb2.MetricRangeProto]:
+  """Returns budgets around the measured results of `design`."""
+  ranges = {}
+  for field in ('optimization_us', 'scheduling_us', 'codegen_us',
+                'jit_compile_us', 'peak_rss_bytes'):
+    value = getattr(design, field)
+    if value:
+      ranges[field] = perf_budgets_pb2.MetricRangeProto(
+          max=value * _TIME_AND_MEMORY_SLACK)
+  if design.jit_calls_per_second:
+    ranges['jit_calls_per_second'] = perf_budgets_pb2.MetricRangeProto(
+        min=design.jit_calls_per_second // _TIME_AND_MEMORY_SLACK)
+  for field in ('node_count', 'pipeline_stages'):
+    value = getattr(design, field)
+    ranges[field] = perf_budgets_pb2.MetricRangeProto(
+        min=int(value * (1 - _QUALITY_SLACK)),
+        max=int(value * (1 + _QUALITY_SLACK)) + 1)
+  return ranges
+
+
+class PerfBudgetSmokeTest(test_base.TestCase):
+
+  def _benchmark(
+      self, ir_path: str) -> benchmark_results_pb2.DesignBenchmarkProto:
+    output_path = os.path.join(self.create_tempdir().full_path,
+                               'results.json')
+    subprocess.run(
+        [_BENCHMARK_MAIN_PATH, f'--batch_output={output_path}'] +
+        list(_BENCHMARK_FLAGS) + [ir_path],
+        check=True)
+    with open(output_path) as f:
+      results = json_format.Parse(
+          f.read(), benchmark_results_pb2.BenchmarkResultsProto())
+    self.assertLen(results.designs, 1)
+    return results.designs[0]
+
+  def _ir_paths(self) -> List[str]:
+    paths = [runfiles.get_path(path) for path in _IR_PATHS]
+    for name, ir_text in (('synthetic_chain', _synthetic_chain_ir(2000)),
+                          ('synthetic_wide', _synthetic_wide_ir(1024))):
+      paths.append(
+          self.create_tempfile(file_path=f'{name}.ir',
+                               content=ir_text).full_path)
+    return paths
+
+  def test_designs_within_budgets(self):
+    with open(_BUDGETS_PATH) as f:
+      budgets = text_format.Parse(f.read(), perf_budgets_pb2.PerfBudgetsProto())
+    budget_by_name = {design.name: design for design in budgets.designs}
+    fields = benchmark_results_pb2.DesignBenchmarkProto.DESCRIPTOR
+    new_budgets = perf_budgets_pb2.PerfBudgetsProto()
+    violations = []
+    names = []
+    for ir_path in self._ir_paths():
+      name = os.path.basename(ir_path)[:-len('.ir')]
+      names.append(name)
+      design = self._benchmark(ir_path)
+      new_budget = new_budgets.designs.add(name=name)
+      for field, metric_range in _derive_ranges(design).items():
+        new_budget.ranges[field].CopyFrom(metric_range)
+      if design.error:
+        violations.append(f'{name}: {design.error}')
+        continue
+      if name not in budget_by_name:
+        violations.append(f'{name}: no budget')
+        continue
+      for field, metric_range in budget_by_name[name].ranges.items():
+        if field not in fields.fields_by_name:
+          violations.append(f'{name}: unknown metric {field}')
+          continue
+        value = getattr(design, field)
+        if metric_range.HasField('min') and value < metric_range.min:
+          violations.append(
+              f'{name}: {field} is {value}, below {metric_range.min}')
+        if metric_range.HasField('max') and value > metric_range.max:
+          violations.append(
+              f'{name}: {field} is {value}, above {metric_range.max}')
+    for name in budget_by_name:
+      if name not in names:
+        violations.append(f'{name}: budget of a design not in the test')
+
+    if _WRITE_BUDGETS.value:
+      with open(_WRITE_BUDGETS.value, 'w') as f:
+        f.write(text_format.MessageToString(new_budgets))
+    self.assertEmpty(violations, '\n'.join(violations))
+
+
+if __name__ == '__main__':
+  absltest.main()
@@ -12,13 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <filesystem>
+#include <limits>
 #include <numeric>
 
+#include "google/protobuf/util/json_util.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "absl/time/clock.h"
+#include "absl/types/span.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/pipeline_generator.h"
 #include "xls/common/file/filesystem.h"
@@ -26,20 +33,25 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/delay_model/analyze_critical_path.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
+#include "xls/delay_model/incremental_critical_path.h"
+#include "xls/interpreter/compiled_function.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/random_value.h"
-#include "xls/ir/ir_parser.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/node_iterator.h"
 #include "xls/jit/function_jit.h"
 #include "xls/jit/proc_jit.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/pass_base.h"
 #include "xls/passes/passes.h"
 #include "xls/passes/standard_pipeline.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_pass_pipeline.h"
+#include "xls/tools/benchmark_results.pb.h"
 
 const char kUsage[] = R"(
 Prints numerous metrics and other information about an XLS IR file including:
@@ -52,6 +64,11 @@ where:
 
 Example invocation:
   benchmark_main path/to/file.ir
+
+With --batch_output, benchmarks many designs in one process and writes the
+timings of the main phases of each to a single CSV or JSON file:
+  benchmark_main --batch_output=timings.csv path/to/dir path/to/file.ir ...
+Directories are searched (non-recursively) for .ir and .irb files.
 )";
 
 // LINT.IfChange
@@ -77,6 +94,9 @@ ABSL_FLAG(int64_t, clock_margin_percent, 0,
           "with --clock_period_ps");
 ABSL_FLAG(bool, show_known_bits, false,
           "Show known bits as determined via the query engine.");
+ABSL_FLAG(int64_t, critical_path_count, 1,
+          "The number of longest paths to print. Paths after the critical "
+          "path are summarized by their delay and endpoints.");
 ABSL_FLAG(std::string, top, "", "Top entity to use in lieu of the default.");
 ABSL_FLAG(std::string, delay_model, "",
           "Delay model name to use from registry.");
@@ -86,6 +106,13 @@ ABSL_FLAG(int64_t, convert_array_index_to_select, -1,
           "into chains of selects. Otherwise, this optimization is skipped, "
           "since it can sometimes reduce output quality.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(std::string, batch_output, "",
+          "If set, benchmark every IR file given as an argument in this "
+          "process and write the timings of each to this file, as JSON if it "
+          "ends in .json and as CSV otherwise, instead of printing a report.");
+ABSL_FLAG(int64_t, batch_threads, 0,
+          "Number of designs to benchmark concurrently with --batch_output. "
+          "Zero means one per thread of the shared pool (see --xls_threads).");
 
 namespace xls {
 namespace {
@@ -122,12 +149,7 @@ int64_t DurationToMs(absl::Duration duration) {
   return duration / absl::Milliseconds(1);
 }
 
-// Run the standard pipeline on the given package and prints stats about the
-// passes and execution time.
-absl::Status RunOptimizationAndPrintStats(Package* package) {
-  std::unique_ptr<CompoundPass> pipeline = CreateStandardPassPipeline();
-
-  absl::Time start = absl::Now();
+PassOptions GetPassOptions() {
   PassOptions pass_options;
   int64_t convert_array_index_to_select =
       absl::GetFlag(FLAGS_convert_array_index_to_select);
@@ -137,9 +159,18 @@ absl::Status RunOptimizationAndPrintStats(Package* package) {
           : std::make_optional(convert_array_index_to_select);
   // TODO(meheff): 2022/3/23 Add this as a flag and benchmark_ir option.
   pass_options.inline_procs = true;
+  return pass_options;
+}
+
+// Run the standard pipeline on the given package and prints stats about the
+// passes and execution time.
+absl::Status RunOptimizationAndPrintStats(Package* package) {
+  std::unique_ptr<CompoundPass> pipeline = CreateStandardPassPipeline();
+
+  absl::Time start = absl::Now();
   PassResults pass_results;
   XLS_RETURN_IF_ERROR(
-      pipeline->Run(package, pass_options, &pass_results).status());
+      pipeline->Run(package, GetPassOptions(), &pass_results).status());
   absl::Duration total_time = absl::Now() - start;
   std::cout << absl::StreamFormat("Optimization time: %dms\n",
                                   DurationToMs(total_time));
@@ -231,6 +262,25 @@ absl::Status PrintCriticalPath(
   return absl::OkStatus();
 }
 
+absl::Status PrintNearCriticalPaths(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    std::optional<int64_t> effective_clock_period_ps, int64_t count) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<IncrementalCriticalPathAnalysis> analysis,
+      IncrementalCriticalPathAnalysis::Create(f, effective_clock_period_ps,
+                                              delay_estimator));
+  std::vector<std::vector<CriticalPathEntry>> paths =
+      analysis->CriticalPaths(count);
+  std::cout << "Longest paths:" << std::endl;
+  for (int64_t i = 0; i < paths.size(); ++i) {
+    std::cout << absl::StreamFormat(
+        "  #%-3d %6dps (%3d entries): %s -> %s\n", i,
+        paths[i].front().path_delay_ps, paths[i].size(),
+        paths[i].back().node->GetName(), paths[i].front().node->GetName());
+  }
+  return absl::OkStatus();
+}
+
 absl::Status PrintTotalDelay(FunctionBase* f,
                              const DelayEstimator& delay_estimator) {
   int64_t total_delay = 0;
@@ -266,7 +316,7 @@ absl::StatusOr<std::vector<int64_t>> GetDelayPerStageInPs(
   return delay_per_stage;
 }
 
-absl::StatusOr<PipelineSchedule> ScheduleAndPrintStats(
+absl::StatusOr<PipelineSchedule> Schedule(
     Package* package, const DelayEstimator& delay_estimator,
     std::optional<int64_t> clock_period_ps,
     std::optional<int64_t> pipeline_stages,
@@ -293,15 +343,25 @@ absl::StatusOr<PipelineSchedule> ScheduleAndPrintStats(
       CreateSchedulingPassPipeline();
   SchedulingPassResults results;
   SchedulingUnit<> scheduling_unit = {package, /*schedule=*/std::nullopt};
-
-  absl::Time start = absl::Now();
   XLS_RETURN_IF_ERROR(
       scheduling_pipeline->Run(&scheduling_unit, options, &results).status());
+  return std::move(*scheduling_unit.schedule);
+}
+
+absl::StatusOr<PipelineSchedule> ScheduleAndPrintStats(
+    Package* package, const DelayEstimator& delay_estimator,
+    std::optional<int64_t> clock_period_ps,
+    std::optional<int64_t> pipeline_stages,
+    std::optional<int64_t> clock_margin_percent) {
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(
+      PipelineSchedule schedule,
+      Schedule(package, delay_estimator, clock_period_ps, pipeline_stages,
+               clock_margin_percent));
   absl::Duration total_time = absl::Now() - start;
   std::cout << absl::StreamFormat("Scheduling time: %dms\n",
                                   total_time / absl::Milliseconds(1));
-
-  return std::move(*scheduling_unit.schedule);
+  return schedule;
 }
 
 absl::Status PrintCodegenInfo(FunctionBase* f,
@@ -443,13 +503,67 @@ absl::StatusOr<float> CountRate(std::function<void()> f, int64_t duration_ms) {
   return elapsed_ms == 0 ? 0.0f : (1000.0 * call_count) / elapsed_ms;
 }
 
+// Returns `count` sets of random arguments of the function.
+std::vector<std::vector<Value>> RandomArgSets(Function* function,
+                                              int64_t count) {
+  std::minstd_rand rng_engine;
+  std::vector<std::vector<Value>> arg_set(count);
+  for (std::vector<Value>& args : arg_set) {
+    for (Param* param : function->params()) {
+      args.push_back(RandomValue(param->GetType(), &rng_engine));
+    }
+  }
+  return arg_set;
+}
+
+// Runs the JIT-compiled function on the given arguments repeatedly for about
+// `duration_ms` milliseconds and returns the number of calls per second.
+absl::StatusOr<float> MeasureJitRunRate(
+    Function* function, FunctionJit* jit,
+    absl::Span<const std::vector<Value>> arg_set, int64_t duration_ms) {
+  // To avoid being dominated by xls::Value conversion to native
+  // format, preconvert the arguments.
+  std::vector<std::vector<std::vector<uint8_t>>> jit_arg_buffers;
+  std::vector<std::vector<uint8_t*>> jit_arg_pointers;
+  for (const std::vector<Value>& args : arg_set) {
+    std::vector<std::vector<uint8_t>> buffers;
+    std::vector<uint8_t*> pointers;
+    for (int64_t i = 0; i < args.size(); ++i) {
+      buffers.push_back(std::vector<uint8_t>(jit->GetArgTypeSize(i), 0));
+      pointers.push_back(buffers.back().data());
+    }
+    jit_arg_buffers.push_back(std::move(buffers));
+    jit_arg_pointers.push_back(pointers);
+    XLS_RETURN_IF_ERROR(jit->runtime()->PackArgs(
+        args, function->GetType()->parameters(), jit_arg_pointers.back()));
+  }
+
+  // The JIT is much faster so run many times.
+  const int64_t kJitRunMultiplier = 1000;
+  InterpreterEvents events;
+  std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+  XLS_ASSIGN_OR_RETURN(
+      float jit_run_rate,
+      CountRate(
+          [&]() -> absl::Status {
+            for (int64_t i = 0; i < kJitRunMultiplier; ++i) {
+              for (const std::vector<uint8_t*>& pointers : jit_arg_pointers) {
+                XLS_CHECK_OK(jit->RunWithViews(
+                    pointers, absl::MakeSpan(result_buffer), &events));
+              }
+            }
+            return absl::OkStatus();
+          },
+          duration_ms));
+  return arg_set.size() * kJitRunMultiplier * jit_run_rate;
+}
+
 absl::Status RunInterpeterAndJit(FunctionBase* function_base,
                                  std::string_view description) {
   // Run the interpreter/JIT for a fixed amount of time and measure the rate of
   // calls per second.
   int64_t kRunDurationMs = 500;
 
-  std::minstd_rand rng_engine;
   if (function_base->IsFunction()) {
     Function* function = function_base->AsFunctionOrDie();
     absl::Time start_jit_compile = absl::Now();
@@ -460,64 +574,44 @@ absl::Status RunInterpeterAndJit(FunctionBase* function_base,
         DurationToMs(absl::Now() - start_jit_compile));
 
     const int64_t kInputCount = 100;
-    std::vector<std::vector<Value>> arg_set(kInputCount);
-    for (std::vector<Value>& args : arg_set) {
-      for (Param* param : function->params()) {
-        args.push_back(RandomValue(param->GetType(), &rng_engine));
-      }
-    }
-
-    // To avoid being dominated by xls::Value conversion to native
-    // format, preconvert the arguments.
-    std::vector<std::vector<std::vector<uint8_t>>> jit_arg_buffers;
-    std::vector<std::vector<uint8_t*>> jit_arg_pointers;
-    for (const std::vector<Value>& args : arg_set) {
-      std::vector<std::vector<uint8_t>> buffers;
-      std::vector<uint8_t*> pointers;
-      for (int64_t i = 0; i < args.size(); ++i) {
-        buffers.push_back(std::vector<uint8_t>(jit->GetArgTypeSize(i), 0));
-        pointers.push_back(buffers.back().data());
-      }
-      jit_arg_buffers.push_back(std::move(buffers));
-      jit_arg_pointers.push_back(pointers);
-      XLS_RETURN_IF_ERROR(jit->runtime()->PackArgs(
-          args, function->GetType()->parameters(), jit_arg_pointers.back()));
-    }
-
-    // The JIT is much faster so run many times.
-    const int64_t kJitRunMultiplier = 1000;
-    InterpreterEvents events;
-    std::vector<uint8_t> result_buffer(jit->GetReturnTypeSize());
+    std::vector<std::vector<Value>> arg_set =
+        RandomArgSets(function, kInputCount);
     XLS_ASSIGN_OR_RETURN(
         float jit_run_rate,
+        MeasureJitRunRate(function, jit.get(), arg_set, kRunDurationMs));
+    std::cout << absl::StreamFormat("JIT run time (%s): %d Kcalls/s\n",
+                                    description,
+                                    static_cast<int64_t>(jit_run_rate / 1000));
+
+    XLS_ASSIGN_OR_RETURN(
+        float interpreter_run_rate,
         CountRate(
             [&]() -> absl::Status {
-              for (int64_t i = 0; i < kJitRunMultiplier; ++i) {
-                for (const std::vector<uint8_t*>& pointers : jit_arg_pointers) {
-                  XLS_CHECK_OK(jit->RunWithViews(
-                      pointers, absl::MakeSpan(result_buffer), &events));
-                }
+              for (const std::vector<Value>& args : arg_set) {
+                XLS_CHECK_OK(InterpretFunction(function, args).status());
               }
               return absl::OkStatus();
             },
             kRunDurationMs));
     std::cout << absl::StreamFormat(
-        "JIT run time (%s): %d Kcalls/s\n", description,
-        static_cast<int64_t>(kInputCount * jit_run_rate));
+        "Interpreter run time (%s): %d calls/s\n", description,
+        static_cast<int64_t>(kInputCount * interpreter_run_rate));
 
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunction> compiled,
+                         CompiledFunction::Create(function));
     XLS_ASSIGN_OR_RETURN(
-        float interpreter_run_rate,
+        float compiled_run_rate,
         CountRate(
             [&]() -> absl::Status {
               for (const std::vector<Value>& args : arg_set) {
-                XLS_CHECK_OK(InterpretFunction(function, args).status());
+                XLS_CHECK_OK(compiled->Run(args).status());
               }
               return absl::OkStatus();
             },
             kRunDurationMs));
     std::cout << absl::StreamFormat(
-        "Interpreter run time (%s): %d calls/s\n", description,
-        static_cast<int64_t>(kInputCount * interpreter_run_rate));
+        "Compiled interpreter run time (%s): %d calls/s\n", description,
+        static_cast<int64_t>(kInputCount * compiled_run_rate));
     return absl::OkStatus();
   }
 
@@ -539,14 +633,20 @@ absl::Status RunInterpeterAndJit(FunctionBase* function_base,
   return absl::OkStatus();
 }
 
+absl::StatusOr<const DelayEstimator*> GetDelayEstimatorFromFlags() {
+  if (absl::GetFlag(FLAGS_delay_model).empty()) {
+    return &GetStandardDelayEstimator();
+  }
+  return GetDelayEstimator(absl::GetFlag(FLAGS_delay_model));
+}
+
 absl::Status RealMain(std::string_view path,
                       std::optional<int64_t> clock_period_ps,
                       std::optional<int64_t> pipeline_stages,
                       std::optional<int64_t> clock_margin_percent) {
   XLS_VLOG(1) << "Reading contents at path: " << path;
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(contents));
+                       ParsePackageFile(path));
   if (!absl::GetFlag(FLAGS_top).empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(absl::GetFlag(FLAGS_top)));
   }
@@ -574,16 +674,16 @@ absl::Status RealMain(std::string_view path,
           (*clock_period_ps * *clock_margin_percent + 50) / 100;
     }
   }
-  const DelayEstimator* pdelay_estimator;
-  if (absl::GetFlag(FLAGS_delay_model).empty()) {
-    pdelay_estimator = &GetStandardDelayEstimator();
-  } else {
-    XLS_ASSIGN_OR_RETURN(pdelay_estimator,
-                         GetDelayEstimator(absl::GetFlag(FLAGS_delay_model)));
-  }
+  XLS_ASSIGN_OR_RETURN(const DelayEstimator* pdelay_estimator,
+                       GetDelayEstimatorFromFlags());
   const auto& delay_estimator = *pdelay_estimator;
   XLS_RETURN_IF_ERROR(PrintCriticalPath(f, query_engine, delay_estimator,
                                         effective_clock_period_ps));
+  if (absl::GetFlag(FLAGS_critical_path_count) > 1) {
+    XLS_RETURN_IF_ERROR(PrintNearCriticalPaths(
+        f, delay_estimator, effective_clock_period_ps,
+        absl::GetFlag(FLAGS_critical_path_count)));
+  }
   XLS_RETURN_IF_ERROR(PrintTotalDelay(f, delay_estimator));
 
   if (clock_period_ps.has_value() || pipeline_stages.has_value()) {
@@ -613,6 +713,201 @@ absl::Status RealMain(std::string_view path,
   return absl::OkStatus();
 }
 
+// Returns the IR files among `paths`, replacing directories by the .ir and
+// .irb files in them.
+absl::StatusOr<std::vector<std::filesystem::path>> ExpandIrPaths(
+    absl::Span<const std::string_view> paths) {
+  std::vector<std::filesystem::path> ir_paths;
+  for (std::string_view path : paths) {
+    if (!std::filesystem::is_directory(path)) {
+      ir_paths.push_back(path);
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> entries,
+                         GetDirectoryEntries(path));
+    std::sort(entries.begin(), entries.end());
+    for (const std::filesystem::path& entry : entries) {
+      if (entry.extension() == ".ir" || entry.extension() == ".irb") {
+        ir_paths.push_back(entry);
+      }
+    }
+  }
+  return ir_paths;
+}
+
+// Benchmarks the main phases of the design at `path` in batch mode: parsing,
+// optimization, scheduling and codegen (if a clock period or stage count is
+// given, also recording the stage count and the delay of the slowest stage),
+// and JIT compilation and evaluation of the optimized top. Timings of the
+// phases reached are recorded in `result` even on error.
+absl::Status BenchmarkDesign(const std::filesystem::path& path,
+                             const DelayEstimator& delay_estimator,
+                             std::optional<int64_t> clock_period_ps,
+                             std::optional<int64_t> pipeline_stages,
+                             std::optional<int64_t> clock_margin_percent,
+                             DesignBenchmarkProto* result) {
+  // Each design has a run of a few hundred milliseconds at most, so a batch
+  // of hundreds of designs stays quick.
+  constexpr int64_t kJitRunDurationMs = 100;
+  constexpr int64_t kJitInputCount = 16;
+
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackageFile(path));
+  result->set_parse_us(absl::ToInt64Microseconds(absl::Now() - start));
+  if (!absl::GetFlag(FLAGS_top).empty()) {
+    XLS_RETURN_IF_ERROR(package->SetTopByName(absl::GetFlag(FLAGS_top)));
+  }
+  if (!package->GetTop().has_value()) {
+    return absl::InternalError(absl::StrFormat(
+        "Top entity not set for package: %s.", package->name()));
+  }
+  result->set_top(package->GetTop().value()->name());
+
+  start = absl::Now();
+  std::unique_ptr<CompoundPass> pipeline = CreateStandardPassPipeline();
+  PassResults pass_results;
+  XLS_RETURN_IF_ERROR(
+      pipeline->Run(package.get(), GetPassOptions(), &pass_results).status());
+  result->set_optimization_us(absl::ToInt64Microseconds(absl::Now() - start));
+  FunctionBase* top = package->GetTop().value();
+  result->set_node_count(top->node_count());
+
+  if (clock_period_ps.has_value() || pipeline_stages.has_value()) {
+    start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
+                         Schedule(package.get(), delay_estimator,
+                                  clock_period_ps, pipeline_stages,
+                                  clock_margin_percent));
+    result->set_scheduling_us(absl::ToInt64Microseconds(absl::Now() - start));
+    result->set_pipeline_stages(schedule.length());
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<int64_t> delay_per_stage,
+        GetDelayPerStageInPs(top, schedule, delay_estimator));
+    result->set_max_stage_delay_ps(
+        *std::max_element(delay_per_stage.begin(), delay_per_stage.end()));
+
+    start = absl::Now();
+    XLS_RETURN_IF_ERROR(verilog::ToPipelineModuleText(
+                            schedule, top, verilog::BuildPipelineOptions())
+                            .status());
+    result->set_codegen_us(absl::ToInt64Microseconds(absl::Now() - start));
+  }
+
+  if (top->IsFunction()) {
+    Function* function = top->AsFunctionOrDie();
+    start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(function));
+    result->set_jit_compile_us(absl::ToInt64Microseconds(absl::Now() - start));
+    XLS_ASSIGN_OR_RETURN(
+        float jit_run_rate,
+        MeasureJitRunRate(function, jit.get(),
+                          RandomArgSets(function, kJitInputCount),
+                          kJitRunDurationMs));
+    result->set_jit_calls_per_second(static_cast<int64_t>(jit_run_rate));
+  } else if (top->IsProc()) {
+    start = absl::Now();
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<JitChannelQueueManager> queue_manager,
+        JitChannelQueueManager::CreateThreadSafe(package.get()));
+    XLS_RETURN_IF_ERROR(ProcJit::Create(top->AsProcOrDie(),
+                                        &queue_manager->runtime(),
+                                        queue_manager.get())
+                            .status());
+    result->set_jit_compile_us(absl::ToInt64Microseconds(absl::Now() - start));
+  }
+  return absl::OkStatus();
+}
+
+std::string BenchmarkResultsToCsv(const BenchmarkResultsProto& results) {
+  std::string csv =
+      "path,top,error,node_count,parse_us,optimization_us,scheduling_us,"
+      "jit_compile_us,jit_calls_per_second,pipeline_stages,"
+      "max_stage_delay_ps,fmax_mhz,codegen_us,peak_rss_bytes\n";
+  // Quotes a field, doubling any quotes in it.
+  auto quote = [](std::string_view field) {
+    return absl::StrCat("\"", absl::StrReplaceAll(field, {{"\"", "\"\""}}),
+                        "\"");
+  };
+  for (const DesignBenchmarkProto& design : results.designs()) {
+    // Achievable clock frequency of the schedule, in MHz.
+    double fmax_mhz = design.max_stage_delay_ps() > 0
+                          ? 1e6 / design.max_stage_delay_ps()
+                          : 0.0;
+    absl::StrAppendFormat(
+        &csv, "%s,%s,%s,%d,%d,%d,%d,%d,%d,%d,%d,%.1f,%d,%d\n",
+        quote(design.path()), quote(design.top()), quote(design.error()),
+        design.node_count(), design.parse_us(), design.optimization_us(),
+        design.scheduling_us(), design.jit_compile_us(),
+        design.jit_calls_per_second(), design.pipeline_stages(),
+        design.max_stage_delay_ps(), fmax_mhz, design.codegen_us(),
+        design.peak_rss_bytes());
+  }
+  return csv;
+}
+
+absl::StatusOr<std::string> BenchmarkResultsToJson(
+    const BenchmarkResultsProto& results) {
+  std::string serialized_json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+  print_options.always_print_primitive_fields = true;
+  auto status = google::protobuf::util::MessageToJsonString(
+      results, &serialized_json, print_options);
+  if (!status.ok()) {
+    return absl::InternalError(std::string{status.message()});
+  }
+  return serialized_json;
+}
+
+// Benchmarks each of the designs at `paths` in this process, sharing the delay
+// model and the LLVM initialization among them, and writes the timings to
+// `output_path`. Failures of individual designs are recorded in the output
+// rather than ending the batch.
+absl::Status BatchMain(absl::Span<const std::string_view> paths,
+                       const std::filesystem::path& output_path,
+                       std::optional<int64_t> clock_period_ps,
+                       std::optional<int64_t> pipeline_stages,
+                       std::optional<int64_t> clock_margin_percent) {
+  XLS_ASSIGN_OR_RETURN(std::vector<std::filesystem::path> ir_paths,
+                       ExpandIrPaths(paths));
+  XLS_ASSIGN_OR_RETURN(const DelayEstimator* delay_estimator,
+                       GetDelayEstimatorFromFlags());
+
+  BenchmarkResultsProto results;
+  for (const std::filesystem::path& path : ir_paths) {
+    results.add_designs()->set_path(path.string());
+  }
+  int64_t thread_count = absl::GetFlag(FLAGS_batch_threads);
+  if (thread_count <= 0) {
+    thread_count = std::numeric_limits<int64_t>::max();
+  }
+
+  // Designs vary a lot in size, so threads take the next design when done
+  // with the last rather than a fixed share of them.
+  BoundedParallelFor(0, ir_paths.size(), thread_count, [&](int64_t index) {
+    DesignBenchmarkProto* result = results.mutable_designs(index);
+    absl::Status status =
+        BenchmarkDesign(ir_paths[index], *delay_estimator, clock_period_ps,
+                        pipeline_stages, clock_margin_percent, result);
+    if (!status.ok()) {
+      XLS_LOG(ERROR) << ir_paths[index] << ": " << status;
+      result->set_error(status.ToString());
+    } else {
+      XLS_VLOG(1) << "Benchmarked " << ir_paths[index];
+    }
+    result->set_peak_rss_bytes(GetPeakRssBytes());
+  });
+
+  if (output_path.extension() == ".json") {
+    XLS_ASSIGN_OR_RETURN(std::string json, BenchmarkResultsToJson(results));
+    return SetFileContents(output_path, json);
+  }
+  return SetFileContents(output_path, BenchmarkResultsToCsv(results));
+}
+
 }  // namespace
 }  // namespace xls
 
@@ -637,6 +932,13 @@ int main(int argc, char** argv) {
   if (absl::GetFlag(FLAGS_clock_margin_percent) > 0) {
     clock_margin_percent = absl::GetFlag(FLAGS_clock_margin_percent);
   }
+  if (!absl::GetFlag(FLAGS_batch_output).empty()) {
+    XLS_QCHECK_OK(xls::BatchMain(positional_arguments,
+                                 absl::GetFlag(FLAGS_batch_output),
+                                 clock_period_ps, pipeline_stages,
+                                 clock_margin_percent));
+    return EXIT_SUCCESS;
+  }
   XLS_QCHECK_OK(xls::RealMain(positional_arguments[0], clock_period_ps,
                               pipeline_stages, clock_margin_percent));
   return EXIT_SUCCESS;
@@ -12,21 +12,33 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <thread>  // NOLINT(build/c++11)
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <random>
+#include <utility>
 
 #include "absl/base/internal/sysinfo.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/interpreter/random_value.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/inlining_pass.h"
 #include "xls/passes/map_inlining_pass.h"
@@ -49,6 +61,13 @@ Example invocation:
 If there are multiple functions in the specified files, then it's _strongly_
 recommended that you specify --function to ensure that the right functions are
 compared. If the tool picks the wrong one, a crash may result.
+
+For wide outputs a single proof may not finish. With --partition, each leaf of
+a tuple or array output (or each --partition_bit_width-bit slice of it) is
+proven by a separate query on its own thread, each with the --timeout, and
+the status of each part is reported. With --random_samples, both functions
+are first evaluated with the JIT on random inputs in parallel as a quick
+search for a counterexample.
 )";
 
 // LINT.IfChange
@@ -59,6 +78,18 @@ ABSL_FLAG(std::string, top, "",
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(bool, partition, false,
+          "Prove each element of the output separately; see above.");
+ABSL_FLAG(int64_t, partition_bit_width, 0,
+          "With --partition, additionally split bits outputs (or elements) "
+          "wider than this into slices of this width. Zero means no "
+          "splitting.");
+ABSL_FLAG(int64_t, random_samples, 0,
+          "Number of random inputs on which to compare the functions with the "
+          "JIT before attempting a proof.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads for partitioned proofs and random samples. Zero "
+          "means one per thread of the shared pool (see --xls_threads).");
 
 namespace xls {
 
@@ -79,6 +110,263 @@ absl::StatusOr<Z3_ast> CreateComparisonFunction(
   return Z3_mk_eq(ctx, result1, result2);
 }
 
+// The outcome of a proof: the solver result (Z3_L_FALSE if the functions are
+// equivalent) and its printable form, including any counterexample.
+struct ProofResult {
+  Z3_lbool satisfiable;
+  std::string message;
+};
+
+// Tries to prove the two functions equivalent in a new Z3 context.
+absl::StatusOr<ProofResult> ProveEquivalence(
+    const std::vector<Function*>& functions, absl::Duration timeout,
+    int64_t solver_threads) {
+  std::vector<std::unique_ptr<IrTranslator>> translators;
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(functions[0]));
+  translators.push_back(std::move(translator));
+
+  // Get the params for the first function, so we can map the second function's
+  // parameters to them.
+  Z3_context ctx = translators[0]->ctx();
+  std::vector<Z3_ast> z3_params;
+  for (const Param* param : functions[0]->params()) {
+    z3_params.push_back(translators[0]->GetTranslation(param));
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      translator, IrTranslator::CreateAndTranslate(ctx, functions[1],
+                                                   absl::MakeSpan(z3_params)));
+  translators.push_back(std::move(translator));
+
+  XLS_ASSIGN_OR_RETURN(
+      Z3_ast results_equal,
+      CreateComparisonFunction(absl::MakeSpan(translators), functions));
+  translators[0]->SetTimeout(timeout);
+
+  Z3_solver solver = solvers::z3::CreateSolver(ctx, solver_threads);
+
+  // Remember: we try to prove the condition by searching for a model that
+  // produces the opposite result. Thus, we want to find a model where the
+  // results are _not_ equal.
+  Z3_ast objective = Z3_mk_eq(ctx, Z3_mk_false(ctx), results_equal);
+  Z3_solver_assert(ctx, solver, objective);
+
+  ProofResult result;
+  result.satisfiable = Z3_solver_check(ctx, solver);
+  result.message =
+      solvers::z3::SolverResultToString(ctx, solver, result.satisfiable);
+
+  Z3_solver_dec_ref(ctx, solver);
+
+  return result;
+}
+
+// A part of the output of the functions: the element reached from the return
+// value by the given sequence of tuple or array indices, and then optionally
+// a slice of its bits.
+struct OutputPartition {
+  std::vector<int64_t> indices;
+  // Start and width of the slice.
+  std::optional<std::pair<int64_t, int64_t>> bit_slice;
+
+  std::string ToString() const {
+    std::string result = "ret";
+    for (int64_t index : indices) {
+      absl::StrAppend(&result, "[", index, "]");
+    }
+    if (bit_slice.has_value()) {
+      absl::StrAppendFormat(&result, " bits [%d, %d)", bit_slice->first,
+                            bit_slice->first + bit_slice->second);
+    }
+    return result;
+  }
+};
+
+// Appends the partitions of a value of the given type, reached by `indices`,
+// to `partitions`. Zero-width values and tokens have nothing to prove.
+void AddPartitions(Type* type, int64_t bit_width,
+                   std::vector<int64_t>& indices,
+                   std::vector<OutputPartition>& partitions) {
+  if (type->IsTuple() || type->IsArray()) {
+    const int64_t size = type->IsTuple() ? type->AsTupleOrDie()->size()
+                                         : type->AsArrayOrDie()->size();
+    for (int64_t i = 0; i < size; ++i) {
+      indices.push_back(i);
+      AddPartitions(type->IsTuple() ? type->AsTupleOrDie()->element_type(i)
+                                    : type->AsArrayOrDie()->element_type(),
+                    bit_width, indices, partitions);
+      indices.pop_back();
+    }
+    return;
+  }
+  if (!type->IsBits() || type->GetFlatBitCount() == 0) {
+    return;
+  }
+  const int64_t bit_count = type->GetFlatBitCount();
+  if (bit_width <= 0 || bit_count <= bit_width) {
+    partitions.push_back(OutputPartition{.indices = indices});
+    return;
+  }
+  for (int64_t start = 0; start < bit_count; start += bit_width) {
+    partitions.push_back(OutputPartition{
+        .indices = indices,
+        .bit_slice = std::make_pair(
+            start, std::min(bit_width, bit_count - start))});
+  }
+}
+
+// Clones `f` into `package` with the given partition of its output as the
+// return value, leaving only the nodes the partition depends on.
+absl::StatusOr<Function*> ClonePartition(Function* f,
+                                         const OutputPartition& partition,
+                                         Package* package) {
+  XLS_ASSIGN_OR_RETURN(Function * clone, f->Clone(f->name(), package));
+  Node* node = clone->return_value();
+  for (int64_t index : partition.indices) {
+    if (node->GetType()->IsTuple()) {
+      XLS_ASSIGN_OR_RETURN(
+          node, clone->MakeNode<TupleIndex>(SourceInfo(), node, index));
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Node * literal,
+        clone->MakeNode<Literal>(SourceInfo(), Value(UBits(index, 64))));
+    XLS_ASSIGN_OR_RETURN(
+        node, clone->MakeNode<ArrayIndex>(SourceInfo(), node,
+                                          std::vector<Node*>{literal}));
+  }
+  if (partition.bit_slice.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        node, clone->MakeNode<BitSlice>(SourceInfo(), node,
+                                        partition.bit_slice->first,
+                                        partition.bit_slice->second));
+  }
+  XLS_RETURN_IF_ERROR(clone->set_return_value(node));
+  PassResults results;
+  XLS_RETURN_IF_ERROR(DeadCodeEliminationPass()
+                          .RunOnFunctionBase(clone, PassOptions(), &results)
+                          .status());
+  return clone;
+}
+
+// Proves each partition of the output separately on `thread_count` threads
+// and prints the outcome of each.
+absl::Status ProvePartitions(const std::vector<Function*>& functions,
+                             absl::Duration timeout, int64_t bit_width,
+                             int64_t thread_count) {
+  std::vector<OutputPartition> partitions;
+  std::vector<int64_t> indices;
+  AddPartitions(functions[0]->return_value()->GetType(), bit_width, indices,
+                partitions);
+  std::cout << absl::StreamFormat("Proving %d output partitions\n",
+                                  partitions.size());
+
+  // Each partition is translated into a Z3 context of its own, as contexts
+  // can't be shared between threads, from clones of the functions in
+  // packages of its own. Threads take the next partition as they finish.
+  std::vector<absl::StatusOr<ProofResult>> results(
+      partitions.size(), absl::UnknownError("Not run"));
+  BoundedParallelFor(0, partitions.size(), thread_count, [&](int64_t index) {
+    results[index] = [&]() -> absl::StatusOr<ProofResult> {
+      std::vector<std::unique_ptr<Package>> packages;
+      std::vector<Function*> clones;
+      for (Function* f : functions) {
+        packages.push_back(std::make_unique<Package>(f->package()->name()));
+        XLS_ASSIGN_OR_RETURN(
+            Function * clone,
+            ClonePartition(f, partitions[index], packages.back().get()));
+        clones.push_back(clone);
+      }
+      return ProveEquivalence(clones, timeout, /*solver_threads=*/1);
+    }();
+  });
+
+  int64_t proven_count = 0;
+  for (int64_t i = 0; i < partitions.size(); ++i) {
+    XLS_RETURN_IF_ERROR(results[i].status());
+    std::string outcome;
+    switch (results[i]->satisfiable) {
+      case Z3_L_FALSE:
+        outcome = "proven";
+        ++proven_count;
+        break;
+      case Z3_L_TRUE:
+        outcome = "NOT EQUIVALENT";
+        break;
+      default:
+        outcome = "unknown (timed out?)";
+        break;
+    }
+    std::cout << absl::StreamFormat("  %s: %s\n", partitions[i].ToString(),
+                                    outcome);
+    if (results[i]->satisfiable == Z3_L_TRUE) {
+      std::cout << results[i]->message << std::endl;
+    }
+  }
+  std::cout << absl::StreamFormat("Proven %d of %d partitions\n",
+                                  proven_count, partitions.size());
+  return absl::OkStatus();
+}
+
+// Evaluates both functions with the JIT on `sample_count` random inputs split
+// among `thread_count` threads. Returns a description of a mismatch if one is
+// found.
+absl::StatusOr<std::optional<std::string>> FindCounterexampleBySimulation(
+    const std::vector<Function*>& functions, int64_t sample_count,
+    int64_t thread_count) {
+  std::vector<std::unique_ptr<FunctionJit>> jits;
+  for (Function* f : functions) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                         FunctionJit::Create(f));
+    jits.push_back(std::move(jit));
+  }
+
+  absl::Mutex mutex;
+  absl::Status status;
+  std::optional<std::string> counterexample;
+  std::atomic<bool> done = false;
+  // Each index draws its own share of the samples from its own seed, so the
+  // samples do not depend on how the indices are scheduled on the pool.
+  ParallelFor(0, thread_count, [&](int64_t i) {
+    std::minstd_rand engine(i + 1);
+    auto run_samples = [&]() -> absl::Status {
+      for (int64_t sample = i; sample < sample_count && !done.load();
+           sample += thread_count) {
+        std::vector<Value> args =
+            RandomFunctionArguments(functions[0], &engine);
+        XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> expected,
+                             jits[0]->Run(args));
+        XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> actual,
+                             jits[1]->Run(args));
+        if (expected.value != actual.value) {
+          absl::MutexLock lock(&mutex);
+          if (!counterexample.has_value()) {
+            counterexample = absl::StrFormat(
+                "Arguments: (%s)\n  %s: %s\n  %s: %s",
+                absl::StrJoin(args, ", ",
+                              [](std::string* out, const Value& v) {
+                                absl::StrAppend(out, v.ToString());
+                              }),
+                functions[0]->name(), expected.value.ToString(),
+                functions[1]->name(), actual.value.ToString());
+          }
+          done.store(true);
+        }
+      }
+      return absl::OkStatus();
+    };
+    absl::Status thread_status = run_samples();
+    if (!thread_status.ok()) {
+      absl::MutexLock lock(&mutex);
+      status.Update(thread_status);
+      done.store(true);
+    }
+  });
+  XLS_RETURN_IF_ERROR(status);
+  return counterexample;
+}
+
 absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
                       const std::string& entry, absl::Duration timeout) {
   std::vector<std::unique_ptr<Package>> packages;
@@ -119,44 +407,39 @@ absl::Status RealMain(const std::vector<std::string_view>& ir_paths,
     functions.push_back(func);
   }
 
-  std::vector<std::unique_ptr<IrTranslator>> translators;
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
-                       IrTranslator::CreateAndTranslate(functions[0]));
-  translators.push_back(std::move(translator));
+  int64_t thread_count = absl::GetFlag(FLAGS_threads);
+  if (thread_count <= 0) {
+    thread_count = ThreadPool::Default()->thread_count();
+  }
 
-  // Get the params for the first function, so we can map the second function's
-  // parameters to them.
-  Z3_context ctx = translators[0]->ctx();
-  std::vector<Z3_ast> z3_params;
-  for (const Param* param : functions[0]->params()) {
-    z3_params.push_back(translators[0]->GetTranslation(param));
+  if (absl::GetFlag(FLAGS_random_samples) > 0) {
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<std::string> counterexample,
+        FindCounterexampleBySimulation(
+            functions, absl::GetFlag(FLAGS_random_samples), thread_count));
+    if (counterexample.has_value()) {
+      std::cout << "Not equivalent; counterexample found by simulation:\n"
+                << *counterexample << std::endl;
+      return absl::OkStatus();
+    }
+    std::cout << absl::StreamFormat("No mismatch in %d random samples\n",
+                                    absl::GetFlag(FLAGS_random_samples));
   }
 
-  XLS_ASSIGN_OR_RETURN(
-      translator, IrTranslator::CreateAndTranslate(ctx, functions[1],
-                                                   absl::MakeSpan(z3_params)));
-  translators.push_back(std::move(translator));
+  if (absl::GetFlag(FLAGS_partition)) {
+    return ProvePartitions(functions, timeout,
+                           absl::GetFlag(FLAGS_partition_bit_width),
+                           thread_count);
+  }
 
   XLS_ASSIGN_OR_RETURN(
-      Z3_ast results_equal,
-      CreateComparisonFunction(absl::MakeSpan(translators), functions));
-  translators[0]->SetTimeout(timeout);
-
-  Z3_solver solver =
-      solvers::z3::CreateSolver(ctx, std::thread::hardware_concurrency());
-
-  // Remember: we try to prove the condition by searching for a model that
-  // produces the opposite result. Thus, we want to find a model where the
-  // results are _not_ equal.
-  Z3_ast objective = Z3_mk_eq(ctx, Z3_mk_false(ctx), results_equal);
-  Z3_solver_assert(ctx, solver, objective);
+      ProofResult result,
+      ProveEquivalence(
+          functions, timeout,
+          /*solver_threads=*/ThreadPool::Default()->thread_count()));
 
   // Finally, print the output to the terminal in gorgeous two-color ASCII.
-  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
-  std::cout << solvers::z3::SolverResultToString(ctx, solver, satisfiable)
-            << std::endl;
-
-  Z3_solver_dec_ref(ctx, solver);
+  std::cout << result.message << std::endl;
 
   return absl::OkStatus();
 }
@@ -0,0 +1,115 @@
+# Copyright 2022 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for xls.tools.check_ir_equivalence_main."""
+
+import subprocess
+
+from xls.common import runfiles
+from absl.testing import absltest
+
+CHECK_IR_EQUIVALENCE_MAIN_PATH = runfiles.get_path(
+    'xls/tools/check_ir_equivalence_main')
+
+REFERENCE_IR = """package reference
+
+top fn f(x: bits[8], y: bits[8]) -> (bits[8], bits[8]) {
+  add.1: bits[8] = add(x, y)
+  xor.2: bits[8] = xor(x, y)
+  ret tuple.3: (bits[8], bits[8]) = tuple(add.1, xor.2)
+}
+"""
+
+# The operands of both operations are swapped.
+EQUIVALENT_IR = """package equivalent
+
+top fn f(x: bits[8], y: bits[8]) -> (bits[8], bits[8]) {
+  add.1: bits[8] = add(y, x)
+  xor.2: bits[8] = xor(y, x)
+  ret tuple.3: (bits[8], bits[8]) = tuple(add.1, xor.2)
+}
+"""
+
+# The second element differs from the reference whenever x & y is nonzero.
+NOT_EQUIVALENT_IR = """package not_equivalent
+
+top fn f(x: bits[8], y: bits[8]) -> (bits[8], bits[8]) {
+  add.1: bits[8] = add(y, x)
+  or.2: bits[8] = or(x, y)
+  ret tuple.3: (bits[8], bits[8]) = tuple(add.1, or.2)
+}
+"""
+
+
+class CheckIrEquivalenceMainTest(absltest.TestCase):
+
+  def _check(self, other_ir: str, *flags: str) -> str:
+    reference = self.create_tempfile(content=REFERENCE_IR)
+    other = self.create_tempfile(content=other_ir)
+    return subprocess.check_output(
+        [CHECK_IR_EQUIVALENCE_MAIN_PATH] + list(flags) +
+        [reference.full_path, other.full_path]).decode('utf-8')
+
+  def test_equivalent(self):
+    output = self._check(EQUIVALENT_IR)
+    self.assertIn('satisfiable: false', output)
+
+  def test_not_equivalent(self):
+    output = self._check(NOT_EQUIVALENT_IR)
+    self.assertIn('satisfiable: true', output)
+
+  def test_partitioned_equivalent(self):
+    output = self._check(EQUIVALENT_IR, '--partition', '--threads=2')
+    self.assertIn('Proving 2 output partitions', output)
+    self.assertIn('ret[0]: proven', output)
+    self.assertIn('ret[1]: proven', output)
+    self.assertIn('Proven 2 of 2 partitions', output)
+
+  def test_partitioned_not_equivalent(self):
+    output = self._check(NOT_EQUIVALENT_IR, '--partition', '--threads=2')
+    self.assertIn('ret[0]: proven', output)
+    self.assertIn('ret[1]: NOT EQUIVALENT', output)
+    self.assertIn('Proven 1 of 2 partitions', output)
+
+  def test_partitioned_bit_slices_equivalent(self):
+    output = self._check(EQUIVALENT_IR, '--partition',
+                         '--partition_bit_width=4')
+    self.assertIn('Proving 4 output partitions', output)
+    self.assertIn('Proven 4 of 4 partitions', output)
+
+  def test_partitioned_bit_slices_not_equivalent(self):
+    output = self._check(NOT_EQUIVALENT_IR, '--partition',
+                         '--partition_bit_width=4')
+    self.assertIn('ret[0] bits [0, 4): proven', output)
+    self.assertIn('ret[0] bits [4, 8): proven', output)
+    self.assertIn('ret[1] bits [0, 4): NOT EQUIVALENT', output)
+    self.assertIn('ret[1] bits [4, 8): NOT EQUIVALENT', output)
+    self.assertIn('Proven 2 of 4 partitions', output)
+
+  def test_random_samples_equivalent(self):
+    # Without a mismatch the functions are still proven equivalent.
+    output = self._check(EQUIVALENT_IR, '--random_samples=1000',
+                         '--threads=4')
+    self.assertIn('No mismatch in 1000 random samples', output)
+    self.assertIn('satisfiable: false', output)
+
+  def test_random_samples_not_equivalent(self):
+    output = self._check(NOT_EQUIVALENT_IR, '--random_samples=1000',
+                         '--threads=4')
+    self.assertIn('counterexample found by simulation', output)
+    self.assertNotIn('satisfiable', output)
+
+
+if __name__ == '__main__':
+  absltest.main()
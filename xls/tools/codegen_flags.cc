@@ -38,6 +38,22 @@ ABSL_FLAG(
 ABSL_FLAG(std::string, output_verilog_line_map_path, "",
           "Specific output path for Verilog line map. If not specified then "
           "Verilog line map is not generated.");
+ABSL_FLAG(std::string, output_pass_metrics_path, "",
+          "Specific output path for the metrics of each scheduling and codegen "
+          "pass invocation. The metrics are written as JSON if the path ends "
+          "in '.json' and as a PassMetricsProto text proto otherwise. If not "
+          "specified then pass metrics are not generated.");
+ABSL_FLAG(std::string, output_stage_fingerprints_path, "",
+          "Specific output path for a fingerprint of the IR scheduled in each "
+          "pipeline stage, one line per stage. The fingerprint of a stage is "
+          "unaffected by node names and ids so stages whose fingerprint is "
+          "unchanged between runs produce the same logic. If not specified "
+          "then stage fingerprints are not generated.");
+ABSL_FLAG(std::string, schedule_cache_dir, "",
+          "If specified, the directory of a cache of pipeline schedules keyed "
+          "by the IR, the scheduling options and the delay model. On a hit the "
+          "scheduled IR and schedule are loaded from the cache rather than "
+          "running the scheduler; on a miss they are added to the cache.");
 ABSL_FLAG(std::string, top, "",
           "Top entity of the package to generate the (System)Verilog code.");
 ABSL_FLAG(std::string, generator, "pipeline",
@@ -128,6 +144,14 @@ ABSL_FLAG(bool, gate_recvs, true,
 ABSL_FLAG(bool, array_index_bounds_checking, true,
           "If true, emit bounds checking on array-index operations in Verilog. "
           "Otherwise, the bounds checking is not evaluated.");
+ABSL_FLAG(int64_t, bdd_io_analysis_node_limit, 0,
+          "The maximum number of nodes in the BDD used to determine whether "
+          "the streaming outputs of a proc are mutually exclusive. If the "
+          "limit is exceeded the outputs are conservatively assumed not to be "
+          "mutually exclusive. If zero, a default limit is used.");
+ABSL_FLAG(bool, merge_registers, false,
+          "If true, merge registers which are written with identical inputs "
+          "and remove registers which always hold the same constant value.");
 // LINT.ThenChange(
 //   //xls/build_rules/xls_codegen_rules.bzl,
 //   //docs_src/codegen_options.md
@@ -168,6 +192,9 @@ absl::StatusOr<CodegenFlagsProto> CodegenFlagsFromAbslFlags() {
   POPULATE_FLAG(output_block_ir_path);
   POPULATE_FLAG(output_signature_path);
   POPULATE_FLAG(output_verilog_line_map_path);
+  POPULATE_FLAG(output_pass_metrics_path);
+  POPULATE_FLAG(output_stage_fingerprints_path);
+  POPULATE_FLAG(schedule_cache_dir);
   POPULATE_FLAG(top);
 
   // Generator is somewhat special, in that we need to parse it to its enum
@@ -218,6 +245,8 @@ absl::StatusOr<CodegenFlagsProto> CodegenFlagsFromAbslFlags() {
   // Optimizations
   POPULATE_FLAG(gate_recvs);
   POPULATE_FLAG(array_index_bounds_checking);
+  POPULATE_FLAG(bdd_io_analysis_node_limit);
+  POPULATE_FLAG(merge_registers);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
   return p;
@@ -39,11 +39,13 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/ir_parser.h"
 #include "xls/ir/op.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/pass_metrics.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/scheduling/schedule_cache.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/scheduling/scheduling_pass.h"
 #include "xls/scheduling/scheduling_pass_pipeline.h"
@@ -159,23 +161,26 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 
   options.gate_recvs(p.gate_recvs());
   options.array_index_bounds_checking(p.array_index_bounds_checking());
+  if (p.bdd_io_analysis_node_limit() > 0) {
+    options.bdd_io_analysis_node_limit(p.bdd_io_analysis_node_limit());
+  }
+  options.merge_registers(p.merge_registers());
 
   return options;
 }
 
 absl::StatusOr<PipelineSchedule> RunSchedulingPipeline(
     FunctionBase* main, const SchedulingOptions& scheduling_options,
-    const DelayEstimator* delay_estimator) {
+    const DelayEstimator* delay_estimator, SchedulingPassResults* results) {
   Package* p = main->package();
   SchedulingPassOptions sched_options;
   sched_options.scheduling_options = scheduling_options;
   sched_options.delay_estimator = delay_estimator;
   std::unique_ptr<SchedulingCompoundPass> scheduling_pipeline =
       CreateSchedulingPassPipeline();
-  SchedulingPassResults results;
   SchedulingUnit<> scheduling_unit = {p, /*schedule=*/std::nullopt};
   absl::Status scheduling_status =
-      scheduling_pipeline->Run(&scheduling_unit, sched_options, &results)
+      scheduling_pipeline->Run(&scheduling_unit, sched_options, results)
           .status();
   if (!scheduling_status.ok()) {
     if (absl::IsResourceExhausted(scheduling_status)) {
@@ -207,9 +212,15 @@ absl::Status RealMain(std::string_view ir_path) {
     ir_path = "/dev/stdin";
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
-                       Parser::ParsePackage(ir_contents, ir_path));
+  // Invocations of both the scheduling and codegen passes, and the timings of
+  // the phases around them.
+  PassResults pass_results;
+
+  std::unique_ptr<Package> p;
+  {
+    ScopedPhaseTimer timer(&pass_results, "ir_parsing");
+    XLS_ASSIGN_OR_RETURN(p, ParsePackageFile(ir_path));
+  }
 
   if (!codegen_flags_proto.top().empty()) {
     XLS_RETURN_IF_ERROR(p->SetTopByName(codegen_flags_proto.top()));
@@ -232,9 +243,34 @@ absl::Status RealMain(std::string_view ir_path) {
                          SetUpSchedulingOptions(p.get()));
     XLS_ASSIGN_OR_RETURN(const DelayEstimator* delay_estimator,
                          SetUpDelayEstimator());
-    XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
-        RunSchedulingPipeline(main(), scheduling_options, delay_estimator));
+    std::unique_ptr<ScheduleCache> schedule_cache;
+    std::string schedule_cache_key;
+    std::optional<PipelineSchedule> schedule;
+    if (!codegen_flags_proto.schedule_cache_dir().empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          schedule_cache,
+          ScheduleCache::Create(codegen_flags_proto.schedule_cache_dir()));
+      schedule_cache_key = ScheduleCache::ComputeKey(
+          p->DumpIr(), scheduling_options, delay_estimator->name());
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<CachedSchedule> cached,
+          schedule_cache->Lookup(schedule_cache_key, *delay_estimator,
+                                 scheduling_options.clock_period_ps()));
+      if (cached.has_value()) {
+        p = std::move(cached->package);
+        schedule = std::move(cached->schedule);
+      }
+    }
+    if (!schedule.has_value()) {
+      ScopedPhaseTimer timer(&pass_results, "scheduling");
+      XLS_ASSIGN_OR_RETURN(
+          schedule, RunSchedulingPipeline(main(), scheduling_options,
+                                          delay_estimator, &pass_results));
+      if (schedule_cache != nullptr) {
+        XLS_RETURN_IF_ERROR(
+            schedule_cache->Insert(schedule_cache_key, schedule.value()));
+      }
+    }
 
     XLS_RETURN_IF_ERROR(VerifyPackage(p.get(), /*codegen=*/true));
 
@@ -244,12 +280,25 @@ absl::Status RealMain(std::string_view ir_path) {
                           main()->package()->DumpIr()));
     }
 
-    XLS_ASSIGN_OR_RETURN(result, verilog::ToPipelineModuleText(
-                                     schedule, main(), codegen_options));
+    XLS_ASSIGN_OR_RETURN(
+        result, verilog::ToPipelineModuleText(*schedule, main(),
+                                              codegen_options, &pass_results));
 
     if (!codegen_flags_proto.output_schedule_path().empty()) {
       XLS_RETURN_IF_ERROR(SetTextProtoFile(
-          codegen_flags_proto.output_schedule_path(), schedule.ToProto()));
+          codegen_flags_proto.output_schedule_path(), schedule->ToProto()));
+    }
+
+    if (!codegen_flags_proto.output_stage_fingerprints_path().empty()) {
+      std::string fingerprints;
+      std::vector<uint64_t> stage_fingerprints =
+          schedule->ComputeStageFingerprints();
+      for (int64_t stage = 0; stage < stage_fingerprints.size(); ++stage) {
+        absl::StrAppendFormat(&fingerprints, "stage %d: %016x\n", stage,
+                              stage_fingerprints[stage]);
+      }
+      XLS_RETURN_IF_ERROR(SetFileContents(
+          codegen_flags_proto.output_stage_fingerprints_path(), fingerprints));
     }
   } else if (codegen_flags_proto.generator() == GENERATOR_KIND_COMBINATIONAL) {
     if (!codegen_flags_proto.output_schedule_ir_path().empty()) {
@@ -257,8 +306,9 @@ absl::Status RealMain(std::string_view ir_path) {
           SetFileContents(codegen_flags_proto.output_schedule_ir_path(), ""));
     }
 
-    XLS_ASSIGN_OR_RETURN(
-        result, verilog::GenerateCombinationalModule(main(), codegen_options));
+    XLS_ASSIGN_OR_RETURN(result,
+                         verilog::GenerateCombinationalModule(
+                             main(), codegen_options, &pass_results));
   } else {
     // Note: this should already be validated by CodegenFlagsFromAbslFlags().
     XLS_LOG(FATAL) << "Invalid generator kind: "
@@ -273,6 +323,11 @@ absl::Status RealMain(std::string_view ir_path) {
         codegen_flags_proto.output_block_ir_path(), p->DumpIr()));
   }
 
+  if (!codegen_flags_proto.output_pass_metrics_path().empty()) {
+    XLS_RETURN_IF_ERROR(WritePassMetrics(
+        pass_results, codegen_flags_proto.output_pass_metrics_path()));
+  }
+
   if (!codegen_flags_proto.output_signature_path().empty()) {
     XLS_RETURN_IF_ERROR(SetTextProtoFile(
         codegen_flags_proto.output_signature_path(), result.signature.proto()));
@@ -15,20 +15,33 @@
 // Takes in an IR file and produces an IR file that has been run through the
 // standard optimization pipeline.
 
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "google/protobuf/util/json_util.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/delay_model/analyze_critical_path.h"
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/delay_model/delay_estimators.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/node_iterator.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
-#include "xls/scheduling/extract_stage.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/tools/delay_info.pb.h"
 
 const char kUsage[] = R"(
 
@@ -44,6 +57,10 @@ information:
      --schedule_path=SCHEDULE_FILE \
      --top=ENTRY \
      IR_FILE
+
+Stages are analyzed concurrently. With --proto_out, the delay information,
+including the --top_k longest paths and a histogram of node delays of each
+stage, is also written as a DelayInfoProto (see xls/tools/delay_info.proto).
 )";
 
 ABSL_FLAG(
@@ -55,10 +72,121 @@ ABSL_FLAG(std::string, delay_model, "",
 ABSL_FLAG(std::string, schedule_path, "",
           "Optional path to a pipeline schedule to use for emitting per-stage "
           "critical paths.");
+ABSL_FLAG(int64_t, top_k, 1,
+          "Number of longest paths to report for each stage, each ending at a "
+          "different output of the stage.");
+ABSL_FLAG(std::string, proto_out, "",
+          "Optional path to write the delay information to as a "
+          "DelayInfoProto; as JSON if the path ends in .json and as a text "
+          "proto otherwise.");
 
 namespace xls::tools {
 namespace {
 
+// The delay information of a stage, with the paths as lists of nodes as well
+// for printing.
+struct StageDelayInfo {
+  StageDelayProto proto;
+  std::vector<std::vector<CriticalPathEntry>> paths;
+};
+
+// Returns the delay information of the given nodes, which must be in
+// topological order. Paths start at the first node of the set on them: values
+// from outside the set (e.g. earlier pipeline stages) are taken to be
+// available at time zero.
+StageDelayInfo AnalyzeStage(
+    absl::Span<Node* const> nodes,
+    const absl::flat_hash_map<Node*, int64_t>& node_delays, int64_t top_k) {
+  StageDelayInfo result;
+  StageDelayProto& stage = result.proto;
+  stage.set_node_count(nodes.size());
+
+  // The arrival time of each node, and its operand on the longest path to it.
+  absl::flat_hash_map<Node*, std::pair<int64_t, Node*>> arrivals;
+  arrivals.reserve(nodes.size());
+  std::vector<int64_t> histogram;
+  for (Node* node : nodes) {
+    int64_t start = 0;
+    Node* predecessor = nullptr;
+    for (Node* operand : node->operands()) {
+      auto it = arrivals.find(operand);
+      if (it != arrivals.end() && it->second.first >= start) {
+        start = it->second.first;
+        predecessor = operand;
+      }
+    }
+    const int64_t delay = node_delays.at(node);
+    arrivals[node] = {start + delay, predecessor};
+    stage.set_total_node_delay_ps(stage.total_node_delay_ps() + delay);
+    const int64_t bucket = absl::bit_width(static_cast<uint64_t>(delay));
+    if (bucket >= histogram.size()) {
+      histogram.resize(bucket + 1);
+    }
+    ++histogram[bucket];
+  }
+
+  // The outputs of the stage are the nodes without users in it; the paths
+  // ending at other nodes are prefixes of longer ones.
+  std::vector<Node*> outputs;
+  for (Node* node : nodes) {
+    if (std::none_of(node->users().begin(), node->users().end(),
+                     [&](Node* user) { return arrivals.contains(user); })) {
+      outputs.push_back(node);
+    }
+  }
+  const int64_t path_count =
+      std::min<int64_t>(std::max<int64_t>(top_k, 0), outputs.size());
+  std::stable_sort(outputs.begin(), outputs.end(), [&](Node* a, Node* b) {
+    return arrivals.at(a).first > arrivals.at(b).first;
+  });
+  for (int64_t i = 0; i < path_count; ++i) {
+    std::vector<CriticalPathEntry>& entries = result.paths.emplace_back();
+    DelayPathProto* path = stage.add_paths();
+    path->set_delay_ps(arrivals.at(outputs[i]).first);
+    for (Node* node = outputs[i]; node != nullptr;
+         node = arrivals.at(node).second) {
+      entries.push_back(
+          CriticalPathEntry{.node = node,
+                            .node_delay_ps = node_delays.at(node),
+                            .path_delay_ps = arrivals.at(node).first,
+                            .delayed_by_cycle_boundary = false});
+      DelayPathEntryProto* entry = path->add_entries();
+      entry->set_node(node->GetName());
+      entry->set_op(OpToString(node->op()));
+      entry->set_node_delay_ps(node_delays.at(node));
+      entry->set_path_delay_ps(arrivals.at(node).first);
+    }
+  }
+
+  for (int64_t bucket = 0; bucket < histogram.size(); ++bucket) {
+    if (histogram[bucket] == 0) {
+      continue;
+    }
+    DelayBucketProto* proto = stage.add_node_delay_histogram();
+    proto->set_min_delay_ps(bucket == 0 ? 0 : int64_t{1} << (bucket - 1));
+    proto->set_max_delay_ps(bucket == 0 ? 0 : (int64_t{1} << bucket) - 1);
+    proto->set_count(histogram[bucket]);
+  }
+  return result;
+}
+
+absl::Status WriteDelayInfo(const DelayInfoProto& delay_info,
+                            const std::filesystem::path& path) {
+  if (path.extension() != ".json") {
+    return SetTextProtoFile(path, delay_info);
+  }
+  std::string serialized_json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+  auto status = google::protobuf::util::MessageToJsonString(
+      delay_info, &serialized_json, print_options);
+  if (!status.ok()) {
+    return absl::InternalError(std::string{status.message()});
+  }
+  return SetFileContents(path, serialized_json);
+}
+
 absl::Status RealMain(std::string_view input_path) {
   if (input_path == "-") {
     input_path = "/dev/stdin";
@@ -81,14 +209,32 @@ absl::Status RealMain(std::string_view input_path) {
   XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
                        GetDelayEstimator(absl::GetFlag(FLAGS_delay_model)));
 
-  if (absl::GetFlag(FLAGS_schedule_path).empty()) {
-    XLS_ASSIGN_OR_RETURN(
-        std::vector<CriticalPathEntry> critical_path,
-        AnalyzeCriticalPath(top, /*clock_period_ps=*/std::nullopt,
-                            *delay_estimator));
-    std::cout << "# Critical path:\n";
-    std::cout << CriticalPathToString(critical_path);
-    std::cout << "\n";
+  DelayInfoProto delay_info;
+  delay_info.set_top(top->name());
+
+  // The delay of each node is estimated once, up front, and shared by the
+  // analyses of all stages. Unknown delays count as zero.
+  std::vector<Node*> topo_sorted_nodes;
+  absl::flat_hash_map<Node*, int64_t> node_delays;
+  node_delays.reserve(top->node_count());
+  for (Node* node : TopoSort(top)) {
+    topo_sorted_nodes.push_back(node);
+    NodeDelayProto* node_delay = delay_info.add_node_delays();
+    node_delay->set_node(node->GetName());
+    absl::StatusOr<int64_t> delay_status =
+        delay_estimator->GetOperationDelayInPs(node);
+    if (delay_status.ok()) {
+      node_delay->set_delay_ps(delay_status.value());
+    }
+    node_delays[node] = delay_status.value_or(0);
+  }
+
+  // The nodes of each stage in topological order; a single stage of all nodes
+  // without a schedule.
+  std::vector<std::vector<Node*>> stage_nodes;
+  const bool has_schedule = !absl::GetFlag(FLAGS_schedule_path).empty();
+  if (!has_schedule) {
+    stage_nodes.push_back(topo_sorted_nodes);
   } else {
     XLS_ASSIGN_OR_RETURN(PipelineScheduleProto proto,
                          ParseTextProtoFile<PipelineScheduleProto>(
@@ -96,31 +242,53 @@ absl::Status RealMain(std::string_view input_path) {
     XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule,
                          PipelineSchedule::FromProto(top, proto));
     XLS_RETURN_IF_ERROR(schedule.Verify());
-    for (int64_t i = 0; i < schedule.length(); ++i) {
-      XLS_ASSIGN_OR_RETURN(Function * stage_function,
-                           ExtractStage(top, schedule, i));
-      XLS_ASSIGN_OR_RETURN(
-          std::vector<CriticalPathEntry> critical_path,
-          AnalyzeCriticalPath(stage_function, /*clock_period_ps=*/std::nullopt,
-                              *delay_estimator));
+    stage_nodes.resize(schedule.length());
+    for (Node* node : topo_sorted_nodes) {
+      stage_nodes[schedule.cycle(node)].push_back(node);
+    }
+  }
+
+  // Stages are independent given the delay table, so analyze them
+  // concurrently on the shared thread pool.
+  std::vector<StageDelayInfo> stages(stage_nodes.size());
+  ParallelFor(0, stages.size(), [&](int64_t stage) {
+    stages[stage] = AnalyzeStage(stage_nodes[stage], node_delays,
+                                 absl::GetFlag(FLAGS_top_k));
+  });
+
+  for (int64_t i = 0; i < stages.size(); ++i) {
+    if (has_schedule) {
+      stages[i].proto.set_stage(i);
       std::cout << absl::StrFormat("# Critical path for stage %d:\n", i);
-      std::cout << CriticalPathToString(critical_path);
+    } else {
+      std::cout << "# Critical path:\n";
+    }
+    for (int64_t j = 0; j < stages[i].paths.size(); ++j) {
+      if (j > 0) {
+        std::cout << absl::StrFormat("# Path %d:\n", j + 1);
+      }
+      std::cout << CriticalPathToString(stages[i].paths[j]);
       std::cout << "\n";
     }
+    *delay_info.add_stages() = std::move(stages[i].proto);
   }
 
   std::cout << "# Delay of all nodes:\n";
-  for (Node* node : TopoSort(top)) {
-    absl::StatusOr<int64_t> delay_status =
-        delay_estimator->GetOperationDelayInPs(node);
-    if (delay_status.ok()) {
-      std::cout << absl::StreamFormat("%-15s : %5dps\n", node->GetName(),
-                                      delay_status.value());
+  for (const NodeDelayProto& node_delay : delay_info.node_delays()) {
+    if (node_delay.has_delay_ps()) {
+      std::cout << absl::StreamFormat("%-15s : %5dps\n", node_delay.node(),
+                                      node_delay.delay_ps());
     } else {
-      std::cout << absl::StreamFormat("%-15s : <unknown>\n", node->GetName());
+      std::cout << absl::StreamFormat("%-15s : <unknown>\n",
+                                      node_delay.node());
     }
   }
 
+  if (!absl::GetFlag(FLAGS_proto_out).empty()) {
+    XLS_RETURN_IF_ERROR(
+        WriteDelayInfo(delay_info, absl::GetFlag(FLAGS_proto_out)));
+  }
+
   return absl::OkStatus();
 }
 
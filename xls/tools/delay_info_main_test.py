@@ -14,6 +14,8 @@
 # limitations under the License.
 """Tests for xls.tools.delay_info_main."""
 
+import json
+import os
 import subprocess
 
 from xls.common import runfiles
@@ -76,13 +78,11 @@ not_sum         :     1ps
 
     self.assertEqual(
         optimized_ir, """# Critical path for stage 0:
-      1ps (+  1ps): tuple.7: (bits[32], bits[32]) = tuple(x: bits[32], y: bits[32], id=7)
-      0ps (+  0ps): y: bits[32] = param(y, id=6)
+      0ps (+  0ps): x: bits[32] = param(x, id=1)
 
 # Critical path for stage 1:
-      2ps (+  1ps): not_sum: bits[32] = not(sum: bits[32], id=11)
-      1ps (+  1ps): sum: bits[32] = add(x: bits[32], y: bits[32], id=10)
-      0ps (+  0ps): y: bits[32] = param(y, id=9)
+      2ps (+  1ps): not_sum: bits[32] = not(sum: bits[32], id=4)
+      1ps (+  1ps): sum: bits[32] = add(x: bits[32], y: bits[32], id=3)
 
 # Delay of all nodes:
 x               :     0ps
@@ -91,6 +91,32 @@ sum             :     1ps
 not_sum         :     1ps
 """)
 
+  def test_proto_out(self):
+    """Test tool writing the delay information as JSON."""
+    ir_file = self.create_tempfile(content=NOT_ADD_IR)
+    schedule_file = self.create_tempfile(content=NOT_ADD_SCHEDULE)
+    json_path = os.path.join(self.create_tempdir().full_path, 'info.json')
+
+    subprocess.check_call([
+        DELAY_INFO_MAIN_PATH, '--delay_model=unit', '--top_k=2',
+        f'--schedule_path={schedule_file.full_path}',
+        f'--proto_out={json_path}', ir_file.full_path
+    ])
+    with open(json_path) as f:
+      info = json.load(f)
+
+    self.assertEqual(info['top'], 'not_add')
+    self.assertLen(info['node_delays'], 4)
+    self.assertLen(info['stages'], 2)
+    # Both params are outputs of stage 0.
+    self.assertLen(info['stages'][0]['paths'], 2)
+    self.assertEqual(info['stages'][1]['stage'], '1')
+    self.assertLen(info['stages'][1]['paths'], 1)
+    critical_path = info['stages'][1]['paths'][0]
+    self.assertEqual(critical_path['delay_ps'], '2')
+    self.assertEqual([e['node'] for e in critical_path['entries']],
+                     ['not_sum', 'sum'])
+
 
 if __name__ == '__main__':
   test_base.main()
@@ -15,9 +15,13 @@
 #ifndef XLS_TOOLS_DEVICE_RPC_STRATEGY_H_
 #define XLS_TOOLS_DEVICE_RPC_STRATEGY_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 
@@ -38,6 +42,28 @@ class DeviceRpcStrategy {
   // Calls an unnamed function on the device.
   virtual absl::StatusOr<Value> CallUnnamed(
       const FunctionType& function_type, absl::Span<const Value> arguments) = 0;
+
+  // Calls an unnamed function on the device once per element of
+  // "argument_sets", returning the results in order. Up to "max_in_flight"
+  // calls are sent ahead of the result being read, which the device must be
+  // able to buffer; e.g. verilog::kStreamingWindow for a pipelined device
+  // function wrapped with the streaming I/O harness. Pipelining calls this way
+  // lets the link bandwidth, rather than its round-trip latency, bound the call
+  // rate.
+  //
+  // The default implementation makes the calls one at a time.
+  virtual absl::StatusOr<std::vector<Value>> CallUnnamedBatched(
+      const FunctionType& function_type,
+      absl::Span<const std::vector<Value>> argument_sets,
+      int64_t max_in_flight) {
+    std::vector<Value> results;
+    results.reserve(argument_sets.size());
+    for (const std::vector<Value>& arguments : argument_sets) {
+      XLS_ASSIGN_OR_RETURN(Value result, CallUnnamed(function_type, arguments));
+      results.push_back(std::move(result));
+    }
+    return results;
+  }
 };
 
 }  // namespace xls
@@ -15,11 +15,17 @@
 // Command line tool for sending "device RPCs" to XLS-generated device
 // functions.
 //
+// The arguments of a single call are given positionally. With --input_file,
+// one call is made per line of the file instead, and up to --max_in_flight of
+// them are pipelined to the device.
+//
 // TODO(leary): 2019-04-07 Probably want a way to select the desired output
 // format; e.g. -hex, -dec, -bin and so on.
 
 #include "absl/flags/flag.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_split.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
 #include "xls/ir/ir_parser.h"
@@ -32,6 +38,14 @@ ABSL_FLAG(int64_t, device_ordinal, 0,
           "Device ordinal within the -target_device category, useful when "
           "multiple are present.");
 ABSL_FLAG(std::string, function_type, "", "Function type being invoked.");
+ABSL_FLAG(std::string, input_file, "",
+          "Arguments of many calls, one set per line. Each line should contain "
+          "a semicolon-separated set of typed values. Cannot be specified with "
+          "positional arguments.");
+ABSL_FLAG(int64_t, max_in_flight, 1,
+          "With --input_file, the number of calls to send ahead of reading "
+          "their results. The device must be able to buffer this many; "
+          "devices wrapped with the streaming I/O harness buffer 16.");
 
 namespace xls {
 namespace tools {
@@ -50,13 +64,32 @@ void RealMain(absl::Span<const std::string_view> args) {
   XLS_QCHECK_OK(function_type_status.status());
   FunctionType* function_type = function_type_status.value();
 
-  std::vector<Value> arguments;
-  for (int64_t i = 0; i < args.size(); ++i) {
-    std::string_view s = args[i];
-    absl::StatusOr<Value> argument =
-        Parser::ParseValue(s, function_type->parameter_type(i));
-    XLS_QCHECK_OK(argument.status());
-    arguments.push_back(std::move(argument).value());
+  // Parses the arguments of one call.
+  auto parse_arguments = [&](absl::Span<const std::string_view> strings) {
+    std::vector<Value> arguments;
+    for (int64_t i = 0; i < strings.size(); ++i) {
+      absl::StatusOr<Value> argument =
+          Parser::ParseValue(strings[i], function_type->parameter_type(i));
+      XLS_QCHECK_OK(argument.status());
+      arguments.push_back(std::move(argument).value());
+    }
+    return arguments;
+  };
+
+  std::vector<std::vector<Value>> argument_sets;
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
+  if (input_file.empty()) {
+    argument_sets.push_back(parse_arguments(args));
+  } else {
+    XLS_QCHECK(args.empty())
+        << "Cannot specify both --input_file and positional arguments";
+    absl::StatusOr<std::string> contents = GetFileContents(input_file);
+    XLS_QCHECK_OK(contents.status());
+    for (std::string_view line :
+         absl::StrSplit(contents.value(), '\n', absl::SkipWhitespace())) {
+      std::vector<std::string_view> strings = absl::StrSplit(line, ';');
+      argument_sets.push_back(parse_arguments(strings));
+    }
   }
 
   absl::StatusOr<std::unique_ptr<DeviceRpcStrategy>> drpc_status =
@@ -66,11 +99,23 @@ void RealMain(absl::Span<const std::string_view> args) {
   std::unique_ptr<DeviceRpcStrategy> drpc = std::move(drpc_status).value();
   XLS_QCHECK_OK(drpc->Connect(absl::GetFlag(FLAGS_device_ordinal)));
 
-  absl::StatusOr<Value> rpc_status =
-      drpc->CallUnnamed(*function_type, arguments);
-  XLS_QCHECK_OK(rpc_status.status());
+  if (input_file.empty()) {
+    absl::StatusOr<Value> rpc_status =
+        drpc->CallUnnamed(*function_type, argument_sets.front());
+    XLS_QCHECK_OK(rpc_status.status());
 
-  std::cout << rpc_status.value().ToString(FormatPreference::kHex) << std::endl;
+    std::cout << rpc_status.value().ToString(FormatPreference::kHex)
+              << std::endl;
+    return;
+  }
+
+  absl::StatusOr<std::vector<Value>> rpc_status = drpc->CallUnnamedBatched(
+      *function_type, argument_sets, absl::GetFlag(FLAGS_max_in_flight));
+  XLS_QCHECK_OK(rpc_status.status());
+  for (const Value& result : rpc_status.value()) {
+    std::cout << result.ToString(FormatPreference::kHex) << "\n";
+  }
+  std::cout << std::flush;
 }
 
 }  // namespace
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <random>
 
 #include "absl/flags/flag.h"
@@ -26,6 +27,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
@@ -34,9 +36,11 @@
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/interpreter/random_value.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value_helpers.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/passes/passes.h"
 #include "xls/passes/standard_pipeline.h"
 
@@ -121,6 +125,13 @@ ABSL_FLAG(bool, test_llvm_jit, false,
 ABSL_FLAG(int64_t, llvm_opt_level, 3,
           "The optimization level of the LLVM JIT. Valid values are from 0 (no "
           "optimizations) to 3 (maximum optimizations).");
+ABSL_FLAG(std::string, jit_object_cache_dir, "",
+          "If non-empty, directory of a persistent cache of JIT-compiled "
+          "object code. Reusing the cache across invocations avoids "
+          "recompiling identical functions.");
+ABSL_FLAG(int64_t, jit_object_cache_max_bytes, int64_t{1} << 30,
+          "Maximum total size of the JIT object cache in bytes. Least "
+          "recently used entries are evicted beyond this size.");
 ABSL_FLAG(std::string, input_validator_expr, "",
           "DSLX expression to validate randomly-generated inputs. "
           "The expression can reference entry function input arguments "
@@ -134,6 +145,12 @@ ABSL_FLAG(std::string, dslx_stdlib_path, xls::kDefaultDslxStdlibPath,
 ABSL_FLAG(int64_t, input_validator_limit, 1024,
           "Maximum number of tries to generate a valid random input before "
           "giving up. Only used if \"input_validator\" is set.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads used to evaluate the inputs. The inputs are split "
+          "into contiguous shards, one per thread, each evaluated with its own "
+          "JIT or interpreter on the shared thread pool. Results are printed "
+          "in input order. Zero means one shard per thread of the pool (see "
+          "--xls_threads).");
 
 ABSL_FLAG(
     std::string, test_only_inject_jit_result, "",
@@ -154,58 +171,154 @@ struct ArgSet {
   std::optional<Value> expected;
 };
 
+// Returns the JIT object cache specified by --jit_object_cache_dir or nullptr
+// if no cache was specified.
+absl::StatusOr<JitObjectCache*> GetJitObjectCache() {
+  static std::unique_ptr<JitObjectCache> cache;
+  if (cache == nullptr && !absl::GetFlag(FLAGS_jit_object_cache_dir).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        cache,
+        JitObjectCache::Create(absl::GetFlag(FLAGS_jit_object_cache_dir),
+                               absl::GetFlag(FLAGS_jit_object_cache_max_bytes)));
+  }
+  return cache.get();
+}
+
 // Returns the given arguments as a semicolon-separated string.
 std::string ArgsToString(absl::Span<const Value> args) {
   return absl::StrJoin(args, "; ", ValueFormatterHex);
 }
 
+// The outcome of evaluating a shard of the inputs: the number of results
+// produced and the first error, if any.
+struct ShardResult {
+  int64_t produced = 0;
+  absl::Status status;
+};
+
+// Evaluates the function with the ArgSets of a shard of the inputs and stores
+// the results in `results`. `first_index` is the index of the first ArgSet of
+// the shard among all inputs. If `print` is true each result is printed as it
+// is produced. Evaluation stops at the first error, which is either a result
+// not matching expectations (if any) or a failure to evaluate.
+ShardResult EvalShard(Function* f, absl::Span<const ArgSet> arg_sets,
+                      int64_t first_index, bool use_jit,
+                      std::string_view actual_src,
+                      std::string_view expected_src, bool print,
+                      absl::Span<Value> results) {
+  ShardResult shard_result;
+  auto eval = [&]() -> absl::Status {
+    std::unique_ptr<FunctionJit> jit;
+    if (use_jit) {
+      // No support for procs yet.
+      XLS_ASSIGN_OR_RETURN(JitObjectCache * object_cache, GetJitObjectCache());
+      XLS_ASSIGN_OR_RETURN(
+          jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level),
+                                   object_cache));
+    }
+
+    for (int64_t i = 0; i < arg_sets.size(); ++i) {
+      const ArgSet& arg_set = arg_sets[i];
+      Value result;
+      if (use_jit) {
+        if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
+          XLS_ASSIGN_OR_RETURN(result,
+                               DropInterpreterEvents(jit->Run(arg_set.args)));
+        } else {
+          XLS_ASSIGN_OR_RETURN(result, Parser::ParseTypedValue(absl::GetFlag(
+                                           FLAGS_test_only_inject_jit_result)));
+        }
+      } else {
+        // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also
+        // compare resulting events once the JIT fully supports events. Note:
+        // This will require rethinking some of the control flow because event
+        // comparison only makes sense for certain modes (optimize_ir and
+        // test_llvm_jit).
+        XLS_ASSIGN_OR_RETURN(
+            result, DropInterpreterEvents(InterpretFunction(f, arg_set.args)));
+      }
+      if (print) {
+        std::cout << result.ToString(FormatPreference::kHex) << std::endl;
+      }
+      results[i] = result;
+      ++shard_result.produced;
+
+      if (arg_set.expected.has_value()) {
+        if (result != *arg_set.expected) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s",
+              first_index + i, ArgsToString(arg_set.args), actual_src,
+              result.ToString(FormatPreference::kHex), expected_src,
+              arg_set.expected->ToString(FormatPreference::kHex)));
+        }
+      }
+    }
+    return absl::OkStatus();
+  };
+  shard_result.status = eval();
+  return shard_result;
+}
+
 // Evaluates the function with the given ArgSets. Returns an error if the result
 // does not match expectations (if any). 'actual_src' and 'expected_src' are
 // string descriptions of the sources of the actual results and expected
-// results, respectively. These strings are included in error messages.
+// results, respectively. These strings are included in error messages. The
+// ArgSets are sharded across --threads threads.
 absl::StatusOr<std::vector<Value>> Eval(
     Function* f, absl::Span<const ArgSet> arg_sets, bool use_jit,
     std::string_view actual_src = "actual",
     std::string_view expected_src = "expected") {
-  std::unique_ptr<FunctionJit> jit;
+  std::vector<Value> results(arg_sets.size());
+  int64_t thread_count = absl::GetFlag(FLAGS_threads);
+  if (thread_count == 0) {
+    thread_count = ThreadPool::Default()->thread_count();
+  }
+  int64_t shard_count = std::clamp<int64_t>(
+      thread_count, 1, std::max<int64_t>(arg_sets.size(), 1));
   if (use_jit) {
-    // No support for procs yet.
-    XLS_ASSIGN_OR_RETURN(
-        jit, FunctionJit::Create(f, absl::GetFlag(FLAGS_llvm_opt_level)));
+    // Create the object cache (if any) before it is shared by the shards.
+    XLS_RETURN_IF_ERROR(GetJitObjectCache().status());
   }
 
-  std::vector<Value> results;
-  for (const ArgSet& arg_set : arg_sets) {
-    Value result;
-    if (use_jit) {
-      if (absl::GetFlag(FLAGS_test_only_inject_jit_result).empty()) {
-        XLS_ASSIGN_OR_RETURN(result,
-                             DropInterpreterEvents(jit->Run(arg_set.args)));
-      } else {
-        XLS_ASSIGN_OR_RETURN(result, Parser::ParseTypedValue(absl::GetFlag(
-                                         FLAGS_test_only_inject_jit_result)));
-      }
-    } else {
-      // TODO(https://github.com/google/xls/issues/506): 2021-10-12 Also compare
-      // resulting events once the JIT fully supports events. Note: This will
-      // require rethinking some of the control flow because event comparison
-      // only makes sense for certain modes (optimize_ir and test_llvm_jit).
-      XLS_ASSIGN_OR_RETURN(
-          result, DropInterpreterEvents(InterpretFunction(f, arg_set.args)));
+  if (shard_count == 1) {
+    ShardResult shard_result =
+        EvalShard(f, arg_sets, /*first_index=*/0, use_jit, actual_src,
+                  expected_src, /*print=*/true, absl::MakeSpan(results));
+    XLS_RETURN_IF_ERROR(shard_result.status);
+    return results;
+  }
+
+  // Split the inputs into contiguous shards so results can be printed in input
+  // order once all threads are done.
+  std::vector<int64_t> shard_starts;
+  for (int64_t shard = 0; shard < shard_count; ++shard) {
+    shard_starts.push_back(arg_sets.size() * shard / shard_count);
+  }
+  shard_starts.push_back(arg_sets.size());
+  std::vector<ShardResult> shard_results(shard_count);
+  ParallelFor(0, shard_count, [&](int64_t shard) {
+    int64_t start = shard_starts[shard];
+    int64_t size = shard_starts[shard + 1] - start;
+    shard_results[shard] =
+        EvalShard(f, arg_sets.subspan(start, size), start, use_jit, actual_src,
+                  expected_src, /*print=*/false,
+                  absl::MakeSpan(results).subspan(start, size));
+  });
+
+  // Report the results up to and including the first error in input order.
+  for (int64_t shard = 0; shard < shard_count; ++shard) {
+    const ShardResult& shard_result = shard_results[shard];
+    for (int64_t i = 0; i < shard_result.produced; ++i) {
+      std::cout << results[shard_starts[shard] + i].ToString(
+                       FormatPreference::kHex)
+                << "\n";
     }
-    std::cout << result.ToString(FormatPreference::kHex) << std::endl;
-
-    if (arg_set.expected.has_value()) {
-      if (result != *arg_set.expected) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Miscompare for input[%i] \"%s\"\n  %s: %s\n  %s: %s",
-            results.size(), ArgsToString(arg_set.args), actual_src,
-            result.ToString(FormatPreference::kHex), expected_src,
-            arg_set.expected->ToString(FormatPreference::kHex)));
-      }
+    if (!shard_result.status.ok()) {
+      std::cout.flush();
+      return shard_result.status;
     }
-    results.push_back(result);
   }
+  std::cout.flush();
   return results;
 }
 
@@ -392,9 +505,8 @@ absl::Status RealMain(std::string_view input_path,
   if (input_path == "-") {
     input_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(input_path));
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(contents, input_path));
+                       ParsePackageFile(input_path));
   if (!absl::GetFlag(FLAGS_top).empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(absl::GetFlag(FLAGS_top)));
   }
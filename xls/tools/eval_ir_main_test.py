@@ -192,6 +192,50 @@ class EvalMainTest(absltest.TestCase):
     # And with overwhelming probability they should all be different.
     self.assertLen(set(result.decode('utf-8').strip().split('\n')), 42)
 
+  def test_input_file_with_threads(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    inputs = ['bits[32]:{}; bits[32]:{}'.format(i, 2 * i) for i in range(10)]
+    input_file = self.create_tempfile(content='\n'.join(inputs))
+    for use_jit in ('true', 'false'):
+      results = subprocess.check_output([
+          EVAL_IR_MAIN_PATH, '--input_file=' + input_file.full_path,
+          '--threads=3', '--use_llvm_jit=' + use_jit, ir_file.full_path
+      ])
+      # Results are printed in input order.
+      self.assertSequenceEqual(
+          ['bits[32]:{:#x}'.format(3 * i) for i in range(10)],
+          results.decode('utf-8').strip().split('\n'))
+
+  def test_failed_expected_file_with_threads(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    inputs = ['bits[32]:{}; bits[32]:0x1'.format(i) for i in range(8)]
+    input_file = self.create_tempfile(content='\n'.join(inputs))
+    expected = ['bits[32]:{}'.format(i + 1) for i in range(8)]
+    expected[5] = 'bits[32]:0x0'
+    expected_file = self.create_tempfile(content='\n'.join(expected))
+    comp = subprocess.run([
+        EVAL_IR_MAIN_PATH, '--input_file=' + input_file.full_path,
+        '--expected_file=' + expected_file.full_path, '--threads=4',
+        ir_file.full_path
+    ],
+                          stdout=subprocess.PIPE,
+                          stderr=subprocess.PIPE,
+                          check=False)
+    self.assertNotEqual(comp.returncode, 0)
+    self.assertIn('Miscompare for input[5] "bits[32]:0x5; bits[32]:0x1"',
+                  comp.stderr.decode('utf-8'))
+    # The results up to and including the miscompare are printed.
+    self.assertLen(comp.stdout.decode('utf-8').strip().split('\n'), 6)
+
+  def test_test_llvm_jit_with_threads(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    comp = subprocess.run([
+        EVAL_IR_MAIN_PATH, '--random_inputs=100', '--test_llvm_jit',
+        '--threads=4', ir_file.full_path
+    ],
+                          check=False)
+    self.assertEqual(comp.returncode, 0)
+
   def test_jit_result_injection(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     result = subprocess.check_output([
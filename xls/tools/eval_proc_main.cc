@@ -15,7 +15,10 @@
 // Tool to evaluate the behavior of a Proc network.
 
 #include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <queue>
 #include <random>
 #include <string>
@@ -23,8 +26,10 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
@@ -41,9 +46,15 @@
 #include "xls/interpreter/interpreter_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/event_sinks.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value_helpers.h"
+#include "xls/jit/jit_node_profile.h"
+#include "xls/jit/block_jit.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/jit_proc_runtime.h"
+#include "xls/jit/jit_trace_buffer.h"
+#include "xls/jit/orc_jit.h"
 #include "xls/tools/eval_helpers.h"
 
 constexpr const char* kUsage = R"(
@@ -62,8 +73,34 @@ ABSL_FLAG(std::vector<std::string>, ticks, {},
 ABSL_FLAG(std::string, backend, "serial_jit",
           "Backend to use for evaluation. Valid options are:\n"
           " * serial_jit: JIT-backed single-stepping runtime.\n"
+          " * threaded_jit: JIT-backed runtime which ticks procs "
+          "concurrently on a pool of threads (see --jit_threads).\n"
+          " * tiered_jit: Single-stepping runtime which interprets the procs "
+          "while they are JIT-compiled in the background and then switches to "
+          "the JIT.\n"
           " * ir_interpreter: Interpreter at the IR level.\n"
-          " * block_interpreter: Interpret a block generated from a proc.");
+          " * block_interpreter: Interpret a block generated from a proc.\n"
+          " * block_jit: JIT-compile a block generated from a proc and "
+          "simulate it cycle by cycle.");
+ABSL_FLAG(std::string, jit_object_cache_dir, "",
+          "If non-empty, directory of a persistent cache of JIT-compiled "
+          "object code used by the JIT backends.");
+ABSL_FLAG(int64_t, jit_object_cache_max_bytes, int64_t{1} << 30,
+          "Maximum total size of the JIT object cache in bytes. Least "
+          "recently used entries are evicted beyond this size.");
+ABSL_FLAG(int64_t, jit_threads, 0,
+          "Number of worker threads used by the threaded_jit backend. Zero "
+          "means use the number of hardware threads.");
+ABSL_FLAG(bool, jit_profile, false,
+          "If true, instrument the jitted procs to count the executions and "
+          "cycles of each IR node and print the hottest nodes and ops to "
+          "stderr after evaluation. Disables the JIT object cache.");
+ABSL_FLAG(int64_t, jit_profile_top_n, 20,
+          "Number of entries in each of the hot lists printed with "
+          "--jit_profile.");
+ABSL_FLAG(bool, jit_perf_map, false,
+          "If true, write /tmp/perf-<pid>.map so that `perf` can symbolize "
+          "samples in jitted code.");
 ABSL_FLAG(std::string, block_signature_proto, "",
           "Path to textproto file containing signature from codegen");
 ABSL_FLAG(int64_t, max_cycles_no_output, 100,
@@ -119,18 +156,185 @@ ABSL_FLAG(std::string, idle_channel_name, "idle", "Name of idle channel.");
 ABSL_FLAG(int64_t, random_seed, 42, "Random seed");
 ABSL_FLAG(double, prob_input_valid_assert, 1.0,
           "Single-cycle probability of asserting valid with more input ready.");
-ABSL_FLAG(bool, show_trace, false, "Whether or not to print trace messages.");
+ABSL_FLAG(bool, show_trace, false,
+          "Whether or not to print trace messages. With the JIT backends, "
+          "trace operations are only compiled in if set.");
+ABSL_FLAG(bool, streaming_io, false,
+          "If true, read the files given with --inputs_for_channels lazily as "
+          "the procs consume the values and compare outputs against the files "
+          "given with --expected_outputs_for_channels as they are produced, "
+          "so memory use does not grow with the number of transactions. The "
+          "files may be pipes. Outputs on channels without expected values "
+          "are discarded. Only supported by the proc backends.");
+ABSL_FLAG(int64_t, max_reported_mismatches, 10,
+          "With --streaming_io, the maximum number of output mismatches to "
+          "log. All mismatches are counted.");
 
 namespace xls {
 
+// Reads XLS values lazily from a file (or pipe) containing one value in
+// human-readable form per line. Blank lines are skipped.
+class StreamingValueReader {
+ public:
+  static absl::StatusOr<std::unique_ptr<StreamingValueReader>> Create(
+      std::string_view filename) {
+    auto reader =
+        absl::WrapUnique(new StreamingValueReader(std::string(filename)));
+    if (!reader->stream_.is_open()) {
+      return absl::NotFoundError(
+          absl::StrFormat("Unable to open values file: %s", filename));
+    }
+    return reader;
+  }
+
+  // Returns the next value or std::nullopt at the end of the file. If a line
+  // cannot be parsed, returns std::nullopt and records the error in
+  // `status()`; no further values are returned.
+  std::optional<Value> Next() {
+    std::string line;
+    while (status_.ok() && std::getline(stream_, line)) {
+      ++line_number_;
+      if (absl::StripAsciiWhitespace(line).empty()) {
+        continue;
+      }
+      absl::StatusOr<Value> value = Parser::ParseTypedValue(line);
+      if (!value.ok()) {
+        status_ = absl::InvalidArgumentError(
+            absl::StrFormat("%s:%d: %s", filename_, line_number_,
+                            value.status().message()));
+        return std::nullopt;
+      }
+      return *std::move(value);
+    }
+    return std::nullopt;
+  }
+
+  absl::Status status() const { return status_; }
+
+ private:
+  explicit StreamingValueReader(std::string filename)
+      : filename_(std::move(filename)), stream_(filename_) {}
+
+  std::string filename_;
+  std::ifstream stream_;
+  int64_t line_number_ = 0;
+  absl::Status status_;
+};
+
+// Compares the values sent on an output channel against expected values read
+// lazily from a file. Only counters are kept.
+class StreamingOutputChecker {
+ public:
+  StreamingOutputChecker(ChannelQueue* queue,
+                         std::unique_ptr<StreamingValueReader> expected,
+                         int64_t max_reported_mismatches)
+      : queue_(queue),
+        expected_(std::move(expected)),
+        max_reported_mismatches_(max_reported_mismatches) {}
+
+  // Reads all values currently in the queue and compares them against the
+  // next expected values. Outputs beyond the end of the expected values are
+  // counted but not checked.
+  absl::Status Drain() {
+    for (const Value& value : queue_->ReadBatch(queue_->GetSize())) {
+      std::optional<Value> expected = expected_->Next();
+      XLS_RETURN_IF_ERROR(expected_->status());
+      if (!expected.has_value()) {
+        ++unchecked_count_;
+        continue;
+      }
+      if (value != *expected) {
+        if (mismatch_count_ < max_reported_mismatches_) {
+          XLS_LOG(ERROR) << absl::StreamFormat(
+              "Mismatched (channel=%s) after %d outputs (%s != %s)",
+              queue_->channel()->name(), checked_count_, expected->ToString(),
+              value.ToString());
+        }
+        ++mismatch_count_;
+      }
+      ++checked_count_;
+    }
+    return absl::OkStatus();
+  }
+
+  // Drains the queue a final time and warns about expected values which were
+  // never produced.
+  absl::Status Finish() {
+    XLS_RETURN_IF_ERROR(Drain());
+    int64_t missing_count = 0;
+    while (expected_->Next().has_value()) {
+      ++missing_count;
+    }
+    XLS_RETURN_IF_ERROR(expected_->status());
+    std::string_view channel_name = queue_->channel()->name();
+    if (missing_count > 0) {
+      XLS_LOG(WARNING) << "Warning: Channel " << channel_name
+                       << " didn't consume " << missing_count
+                       << " expected values";
+    }
+    if (unchecked_count_ > 0) {
+      XLS_LOG(WARNING) << "Warning: Channel " << channel_name << " produced "
+                       << unchecked_count_ << " values beyond the expected "
+                       << "values";
+    }
+    XLS_LOG(INFO) << absl::StreamFormat(
+        "Channel %s: checked %d outputs, %d mismatched", channel_name,
+        checked_count_, mismatch_count_);
+    return absl::OkStatus();
+  }
+
+  int64_t checked_count() const { return checked_count_; }
+  int64_t mismatch_count() const { return mismatch_count_; }
+
+ private:
+  ChannelQueue* queue_;
+  std::unique_ptr<StreamingValueReader> expected_;
+  int64_t max_reported_mismatches_;
+  int64_t checked_count_ = 0;
+  int64_t mismatch_count_ = 0;
+  int64_t unchecked_count_ = 0;
+};
+
 absl::Status EvaluateProcs(
-    Package* package, bool use_jit, const std::vector<int64_t>& ticks,
+    Package* package, std::string_view backend,
+    const std::vector<int64_t>& ticks,
     absl::flat_hash_map<std::string, std::vector<Value>> inputs_for_channels,
     absl::flat_hash_map<std::string, std::vector<Value>>
-        expected_outputs_for_channels) {
-  std::unique_ptr<SerialProcRuntime> runtime;
+        expected_outputs_for_channels,
+    const absl::flat_hash_map<std::string, std::string>& streaming_inputs,
+    const absl::flat_hash_map<std::string, std::string>&
+        streaming_expected_outputs) {
+  bool streaming = !streaming_inputs.empty() ||
+                   !streaming_expected_outputs.empty();
+  bool use_jit = backend != "ir_interpreter";
+  std::unique_ptr<ProcRuntime> runtime;
+  std::unique_ptr<JitObjectCache> object_cache;
+  if (use_jit && !absl::GetFlag(FLAGS_jit_object_cache_dir).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        object_cache,
+        JitObjectCache::Create(absl::GetFlag(FLAGS_jit_object_cache_dir),
+                               absl::GetFlag(FLAGS_jit_object_cache_max_bytes)));
+  }
+  std::unique_ptr<JitNodeProfile> profile;
+  if (use_jit && absl::GetFlag(FLAGS_jit_profile)) {
+    profile = std::make_unique<JitNodeProfile>();
+  }
   if (use_jit) {
-    XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(package));
+    OrcJit::SetPerfMapEnabled(absl::GetFlag(FLAGS_jit_perf_map));
+    SetJitTracesEnabled(absl::GetFlag(FLAGS_show_trace));
+  }
+  if (backend == "threaded_jit") {
+    XLS_ASSIGN_OR_RETURN(
+        runtime, CreateJitThreadedProcRuntime(
+                     package, absl::GetFlag(FLAGS_jit_threads),
+                     object_cache.get(), profile.get()));
+  } else if (backend == "tiered_jit") {
+    XLS_ASSIGN_OR_RETURN(
+        runtime, CreateTieredSerialProcRuntime(package, object_cache.get()));
+  } else if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(runtime,
+                         CreateJitSerialProcRuntime(package, object_cache.get(),
+                                                    profile.get()));
   } else {
     XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(package));
   }
@@ -139,8 +343,60 @@ absl::Status EvaluateProcs(
   for (const auto& [channel_name, values] : inputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
                          queue_manager.GetQueueByName(channel_name));
-    for (const Value& value : values) {
-      XLS_RETURN_IF_ERROR(in_queue->Write(value));
+    XLS_RETURN_IF_ERROR(in_queue->WriteBatch(values));
+  }
+
+  std::vector<std::unique_ptr<StreamingValueReader>> input_readers;
+  for (const auto& [channel_name, filename] : streaming_inputs) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
+                         queue_manager.GetQueueByName(channel_name));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<StreamingValueReader> reader,
+                         StreamingValueReader::Create(filename));
+    XLS_RETURN_IF_ERROR(in_queue->AttachGenerator(
+        [reader = reader.get()]() { return reader->Next(); }));
+    input_readers.push_back(std::move(reader));
+  }
+
+  // With streaming I/O, outputs are checked or discarded after every tick so
+  // the output queues stay small.
+  std::vector<StreamingOutputChecker> output_checkers;
+  std::vector<ChannelQueue*> discarded_queues;
+  if (streaming) {
+    for (const Channel* channel : package->channels()) {
+      if (!channel->CanSend()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
+                           queue_manager.GetQueueByName(channel->name()));
+      auto it = streaming_expected_outputs.find(channel->name());
+      if (it == streaming_expected_outputs.end()) {
+        discarded_queues.push_back(out_queue);
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(std::unique_ptr<StreamingValueReader> reader,
+                           StreamingValueReader::Create(it->second));
+      output_checkers.emplace_back(
+          out_queue, std::move(reader),
+          absl::GetFlag(FLAGS_max_reported_mismatches));
+    }
+    if (output_checkers.size() != streaming_expected_outputs.size()) {
+      return absl::NotFoundError(
+          "Expected outputs given for a channel which is not an output "
+          "channel of the package");
+    }
+  }
+
+  // Print traces as they are produced rather than accumulating them for the
+  // whole run.
+  std::vector<std::unique_ptr<CallbackEventSink>> trace_sinks;
+  if (absl::GetFlag(FLAGS_show_trace)) {
+    for (const std::unique_ptr<Proc>& proc : package->procs()) {
+      trace_sinks.push_back(std::make_unique<CallbackEventSink>(
+          [name = proc->name()](TraceEvent event) {
+            std::cerr << "Proc " << name << " trace: " << event.ToString()
+                      << "\n";
+          }));
+      runtime->SetEventSink(proc.get(), trace_sinks.back().get());
     }
   }
 
@@ -151,6 +407,17 @@ absl::Status EvaluateProcs(
     for (int i = 0; i < this_ticks; i++) {
       XLS_RETURN_IF_ERROR(runtime->Tick());
 
+      for (const std::unique_ptr<StreamingValueReader>& reader :
+           input_readers) {
+        XLS_RETURN_IF_ERROR(reader->status());
+      }
+      for (StreamingOutputChecker& checker : output_checkers) {
+        XLS_RETURN_IF_ERROR(checker.Drain());
+      }
+      for (ChannelQueue* queue : discarded_queues) {
+        queue->ReadBatch(queue->GetSize());
+      }
+
       // Sort the keys for stable print order.
       absl::flat_hash_map<Proc*, std::vector<Value>> states;
       std::vector<Proc*> sorted_procs;
@@ -162,17 +429,8 @@ absl::Status EvaluateProcs(
       std::sort(sorted_procs.begin(), sorted_procs.end(),
                 [](Proc* a, Proc* b) { return a->name() < b->name(); });
 
-      if (absl::GetFlag(FLAGS_show_trace)) {
-        for (Proc* proc : sorted_procs) {
-          for (const auto& msg :
-               runtime->GetInterpreterEvents(proc).trace_msgs) {
-            std::cerr << "Proc " << proc->name() << " trace: " << msg << "\n";
-          }
-        }
-      }
-
-      for (const auto& proc : package->procs()) {
-        const auto& state = states.at(proc.get());
+      for (Proc* proc : sorted_procs) {
+        const auto& state = states.at(proc);
         XLS_VLOG(1) << "Proc " << proc->name() << " : "
                     << absl::StrFormat(
                            "{%s}", absl::StrJoin(state, ", ", ValueFormatter));
@@ -180,6 +438,28 @@ absl::Status EvaluateProcs(
     }
   }
 
+  if (profile != nullptr) {
+    std::cerr << profile->ToString(absl::GetFlag(FLAGS_jit_profile_top_n));
+  }
+
+  if (streaming) {
+    int64_t checked_count = 0;
+    int64_t mismatch_count = 0;
+    for (StreamingOutputChecker& checker : output_checkers) {
+      XLS_RETURN_IF_ERROR(checker.Finish());
+      checked_count += checker.checked_count();
+      mismatch_count += checker.mismatch_count();
+    }
+    if (mismatch_count > 0) {
+      return absl::InternalError(absl::StrFormat(
+          "%d of %d outputs mismatched", mismatch_count, checked_count));
+    }
+    if (checked_count == 0 && !output_checkers.empty()) {
+      return absl::UnknownError("No output verified (empty expected values?)");
+    }
+    return absl::OkStatus();
+  }
+
   bool checked_any_output = false;
   for (const auto& [channel_name, values] : expected_outputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
@@ -339,7 +619,8 @@ Value XsForWidth(uint64_t width) {
 Value XsOfType(Type* type) { return AllOnesOfType(type); }
 
 absl::Status RunBlockInterpreter(
-    Package* package, const std::vector<int64_t>& ticks,
+    Package* package, std::string_view backend,
+    const std::vector<int64_t>& ticks,
     const verilog::ModuleSignatureProto& signature,
     const int64_t max_cycles_no_output,
     absl::flat_hash_map<std::string, std::vector<Value>> inputs_for_channels,
@@ -399,6 +680,23 @@ absl::Status RunBlockInterpreter(
     reg_state[reg->name()] = XsOfType(reg->type());
   }
 
+  // With the block_jit backend the register state is held by the jit.
+  std::unique_ptr<JitObjectCache> object_cache;
+  std::unique_ptr<BlockJit> jit;
+  if (backend == "block_jit") {
+    if (!absl::GetFlag(FLAGS_jit_object_cache_dir).empty()) {
+      XLS_ASSIGN_OR_RETURN(
+          object_cache,
+          JitObjectCache::Create(
+              absl::GetFlag(FLAGS_jit_object_cache_dir),
+              absl::GetFlag(FLAGS_jit_object_cache_max_bytes)));
+    }
+    OrcJit::SetPerfMapEnabled(absl::GetFlag(FLAGS_jit_perf_map));
+    SetJitTracesEnabled(absl::GetFlag(FLAGS_show_trace));
+    XLS_ASSIGN_OR_RETURN(jit, BlockJit::Create(block, object_cache.get()));
+    XLS_RETURN_IF_ERROR(jit->SetRegisters(reg_state));
+  }
+
   int64_t last_output_cycle = 0;
   int64_t matched_outputs = 0;
 
@@ -445,9 +743,15 @@ absl::Status RunBlockInterpreter(
       input_set[info.channel_ready] = xls::Value(xls::UBits(1, 1));
     }
 
-    XLS_ASSIGN_OR_RETURN(xls::BlockRunResult result,
-                         xls::BlockRun(input_set, reg_state, block));
-    reg_state = std::move(result.reg_state);
+    xls::BlockRunResult result;
+    if (jit != nullptr) {
+      XLS_RETURN_IF_ERROR(jit->SetInputs(input_set));
+      jit->RunOneCycle();
+      result.outputs = jit->GetOutputsMap();
+    } else {
+      XLS_ASSIGN_OR_RETURN(result, xls::BlockRun(input_set, reg_state, block));
+      reg_state = std::move(result.reg_state);
+    }
 
     if (resetting) {
       last_output_cycle = cycle;
@@ -596,7 +900,24 @@ absl::Status RealMain(
     std::string_view streaming_channel_ready_suffix,
     std::string_view streaming_channel_valid_suffix,
     std::string_view idle_channel_name, const int random_seed,
-    const double prob_input_valid_assert) {
+    const double prob_input_valid_assert, const bool streaming_io) {
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_file));
+  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
+
+  if (streaming_io) {
+    // Values are read from the files as they are consumed rather than up
+    // front.
+    XLS_ASSIGN_OR_RETURN(auto streaming_inputs,
+                         ParseChannelFilenames(inputs_for_channels_text));
+    XLS_ASSIGN_OR_RETURN(
+        auto streaming_expected_outputs,
+        ParseChannelFilenames(expected_outputs_for_channels_text));
+    return EvaluateProcs(package.get(), backend, ticks,
+                         /*inputs_for_channels=*/{},
+                         /*expected_outputs_for_channels=*/{}, streaming_inputs,
+                         streaming_expected_outputs);
+  }
+
   // Don't waste time and memory parsing more input than can possibly be
   // consumed.
   const int64_t total_ticks =
@@ -626,25 +947,22 @@ absl::Status RealMain(
                                    total_ticks));
   }
 
-  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_file));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
-
-  if (backend == "serial_jit") {
-    return EvaluateProcs(package.get(), /*use_jit=*/true, ticks,
-                         inputs_for_channels, expected_outputs_for_channels);
+  if (backend == "serial_jit" || backend == "threaded_jit" ||
+      backend == "tiered_jit" || backend == "ir_interpreter") {
+    return EvaluateProcs(package.get(), backend, ticks, inputs_for_channels,
+                         expected_outputs_for_channels,
+                         /*streaming_inputs=*/{},
+                         /*streaming_expected_outputs=*/{});
   }
-  if (backend == "ir_interpreter") {
-    return EvaluateProcs(package.get(), /*use_jit=*/false, ticks,
-                         inputs_for_channels, expected_outputs_for_channels);
-  }
-  if (backend == "block_interpreter") {
+  if (backend == "block_interpreter" || backend == "block_jit") {
     verilog::ModuleSignatureProto proto;
     XLS_CHECK_OK(ParseTextProtoFile(block_signature_proto, &proto));
     return RunBlockInterpreter(
-        package.get(), ticks, proto, max_cycles_no_output, inputs_for_channels,
-        expected_outputs_for_channels, streaming_channel_data_suffix,
-        streaming_channel_ready_suffix, streaming_channel_valid_suffix,
-        idle_channel_name, random_seed, prob_input_valid_assert);
+        package.get(), backend, ticks, proto, max_cycles_no_output,
+        inputs_for_channels, expected_outputs_for_channels,
+        streaming_channel_data_suffix, streaming_channel_ready_suffix,
+        streaming_channel_valid_suffix, idle_channel_name, random_seed,
+        prob_input_valid_assert);
   }
   XLS_LOG(QFATAL) << "Unknown backend type";
 }
@@ -659,14 +977,15 @@ int main(int argc, char* argv[]) {
   }
 
   std::string backend = absl::GetFlag(FLAGS_backend);
-  if (backend != "serial_jit" && backend != "ir_interpreter" &&
-      backend != "block_interpreter") {
+  if (backend != "serial_jit" && backend != "threaded_jit" &&
+      backend != "tiered_jit" && backend != "ir_interpreter" &&
+      backend != "block_interpreter" && backend != "block_jit") {
     XLS_LOG(QFATAL) << "Unrecognized backend choice.";
   }
 
-  if (backend == "block_interpreter" &&
+  if ((backend == "block_interpreter" || backend == "block_jit") &&
       absl::GetFlag(FLAGS_block_signature_proto).empty()) {
-    XLS_LOG(QFATAL) << "Block interpreter requires --block_signature_proto.";
+    XLS_LOG(QFATAL) << "Block backends require --block_signature_proto.";
   }
 
   std::vector<int64_t> ticks;
@@ -694,6 +1013,17 @@ int main(int argc, char* argv[]) {
                        "--expected_outputs_for_all_channels must be set.";
   }
 
+  if (absl::GetFlag(FLAGS_streaming_io)) {
+    if (backend == "block_interpreter" || backend == "block_jit") {
+      XLS_LOG(QFATAL) << "--streaming_io is only supported by proc backends.";
+    }
+    if (!absl::GetFlag(FLAGS_inputs_for_all_channels).empty() ||
+        !absl::GetFlag(FLAGS_expected_outputs_for_all_channels).empty()) {
+      XLS_LOG(QFATAL) << "--streaming_io requires --inputs_for_channels and "
+                         "--expected_outputs_for_channels.";
+    }
+  }
+
   XLS_QCHECK_OK(xls::RealMain(
       positional_args[0], backend, absl::GetFlag(FLAGS_block_signature_proto),
       ticks, absl::GetFlag(FLAGS_max_cycles_no_output),
@@ -705,7 +1035,8 @@ int main(int argc, char* argv[]) {
       absl::GetFlag(FLAGS_streaming_channel_ready_suffix),
       absl::GetFlag(FLAGS_streaming_channel_valid_suffix),
       absl::GetFlag(FLAGS_idle_channel_name), absl::GetFlag(FLAGS_random_seed),
-      absl::GetFlag(FLAGS_prob_input_valid_assert)));
+      absl::GetFlag(FLAGS_prob_input_valid_assert),
+      absl::GetFlag(FLAGS_streaming_io)));
 
   return 0;
 }
@@ -391,6 +391,52 @@ class EvalProcTest(absltest.TestCase):
     output = run_command(shared_args + ["--backend", "serial_jit"])
     self.assertIn("Proc test_proc", output.stderr)
 
+  def test_streaming_io(self):
+    ir_file = self.create_tempfile(content=PROC_IR)
+    input_file = self.create_tempfile(
+        content=textwrap.dedent("""
+          bits[64]:42
+          bits[64]:101
+        """))
+    input_file_2 = self.create_tempfile(
+        content=textwrap.dedent("""
+          bits[64]:10
+          bits[64]:6
+        """))
+    output_file = self.create_tempfile(
+        content=textwrap.dedent("""
+          bits[64]:62
+          bits[64]:127
+        """))
+    bad_output_file = self.create_tempfile(
+        content=textwrap.dedent("""
+          bits[64]:62
+          bits[64]:128
+        """))
+
+    def args(outfile):
+      return [
+          EVAL_PROC_MAIN_PATH, ir_file.full_path, "--ticks", "2",
+          "--logtostderr", "--streaming_io", "--inputs_for_channels",
+          "in_ch={infile1},in_ch_2={infile2}".format(
+              infile1=input_file.full_path, infile2=input_file_2.full_path),
+          "--expected_outputs_for_channels", "out_ch={}".format(outfile)
+      ]
+
+    for backend in ("ir_interpreter", "serial_jit"):
+      output = run_command(
+          args(output_file.full_path) + ["--backend", backend])
+      self.assertIn("checked 2 outputs, 0 mismatched", output.stderr)
+
+      comp = subprocess.run(
+          args(bad_output_file.full_path) + ["--backend", backend],
+          stdout=subprocess.PIPE,
+          stderr=subprocess.PIPE,
+          encoding="utf-8",
+          check=False)
+      self.assertNotEqual(comp.returncode, 0)
+      self.assertIn("1 of 2 outputs mismatched", comp.stderr)
+
   def test_reset_static(self):
     ir_file = self.create_tempfile(content=PROC_IR)
     input_file = self.create_tempfile(
@@ -457,15 +503,17 @@ class EvalProcTest(absltest.TestCase):
     shared_args = [
         EVAL_PROC_MAIN_PATH, ir_file.full_path, "--ticks", "2", "-v=3",
         "--logtostderr", "--block_signature_proto", signature_file.full_path,
-        "--backend", "block_interpreter", "--inputs_for_channels",
-        "in_ch={infile1},in_ch_2={infile2}".format(
+        "--inputs_for_channels", "in_ch={infile1},in_ch_2={infile2}".format(
             infile1=input_file.full_path,
             infile2=input_file_2.full_path), "--expected_outputs_for_channels",
         "out_ch={outfile},out_ch_2={outfile2}".format(
             outfile=output_file.full_path, outfile2=output_file_2.full_path)
     ]
 
-    output = run_command(shared_args)
+    output = run_command(shared_args + ["--backend", "block_interpreter"])
+    self.assertIn("Cycle[6]: resetting? false", output.stderr)
+
+    output = run_command(shared_args + ["--backend", "block_jit"])
     self.assertIn("Cycle[6]: resetting? false", output.stderr)
 
   def test_block_no_output(self):
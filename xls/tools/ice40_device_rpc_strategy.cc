@@ -20,8 +20,11 @@
 #include <termios.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -162,6 +165,44 @@ std::string LocalModesToString(tcflag_t local_modes) {
   return absl::StrJoin(pieces, ", ");
 }
 
+// Returns the bytes to send to the device for a call with the given arguments:
+// their flattened bits, with the bytes equal to the reset and escape control
+// codes of the device I/O state machine (see verilog::IOControlCode) escaped.
+absl::StatusOr<std::vector<uint8_t>> EncodeArguments(
+    absl::Span<const Value> arguments) {
+  constexpr uint8_t kReset = 0xfe;
+  constexpr uint8_t kEscape = 0xff;
+  constexpr uint8_t kEscapedReset = 0x00;
+  constexpr uint8_t kEscapedEscape = 0xff;
+
+  BitPushBuffer buffer;
+  for (const Value& arg : arguments) {
+    arg.FlattenTo(&buffer);
+  }
+
+  if (buffer.empty()) {
+    // TODO(leary): 2019-04-07 We probably want this to be possible eventually,
+    // but we'd have to decide whether in this case the device function is
+    // constantly producing output data since there's no input event to trigger
+    // it, so we'd just move on to the read itself.
+    return absl::InvalidArgumentError("Cannot perform an empty-payload RPC.");
+  }
+
+  std::vector<uint8_t> payload;
+  for (uint8_t byte : buffer.GetUint8Data()) {
+    if (byte == kReset) {
+      payload.push_back(kEscape);
+      payload.push_back(kEscapedReset);
+    } else if (byte == kEscape) {
+      payload.push_back(kEscape);
+      payload.push_back(kEscapedEscape);
+    } else {
+      payload.push_back(byte);
+    }
+  }
+  return payload;
+}
+
 }  // namespace
 
 Ice40DeviceRpcStrategy::~Ice40DeviceRpcStrategy() {
@@ -255,41 +296,29 @@ absl::Status Ice40DeviceRpcStrategy::Connect(int64_t device_ordinal) {
   return absl::OkStatus();
 }
 
-absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
-    const FunctionType& function_type, absl::Span<const Value> arguments) {
-  BitPushBuffer buffer;
-  for (const Value& arg : arguments) {
-    arg.FlattenTo(&buffer);
-  }
-
-  if (buffer.empty()) {
-    // TODO(leary): 2019-04-07 We probably want this to be possible eventually,
-    // but we'd have to decide whether in this case the device function is
-    // constantly producing output data since there's no input event to trigger
-    // it, so we'd just move on to the read itself.
-    return absl::InvalidArgumentError("Cannot perform an empty-payload RPC.");
+absl::Status Ice40DeviceRpcStrategy::WriteBytes(
+    absl::Span<const uint8_t> bytes) {
+  if (!tty_fd_.has_value()) {
+    return absl::FailedPreconditionError("Not connected to an ICE40 device.");
   }
-
-  std::vector<uint8_t> u8_data = buffer.GetUint8Data();
-
   int64_t bytes_written = 0;
-  while (bytes_written < buffer.size_in_bytes()) {
-    int ret = write(tty_fd_.value(), u8_data.data() + bytes_written,
-                    u8_data.size() - bytes_written);
+  while (bytes_written < bytes.size()) {
+    int ret = write(tty_fd_.value(), bytes.data() + bytes_written,
+                    bytes.size() - bytes_written);
     if (ret < 0) {
       return absl::InternalError(
           absl::StrFormat("Could not write partial data of %d remaining bytes "
                           "(originally %d) to ICE40: %s",
-                          buffer.size_in_bytes() - bytes_written,
-                          buffer.size_in_bytes(), Strerror(errno)));
+                          bytes.size() - bytes_written, bytes.size(),
+                          Strerror(errno)));
     }
     bytes_written += ret;
   }
+  return absl::OkStatus();
+}
 
-  if (tcflush(tty_fd_.value(), TCOFLUSH) != 0) {
-    return absl::InternalError("Could not flush write(s) to device.");
-  }
-
+absl::StatusOr<Value> Ice40DeviceRpcStrategy::ReadResult(
+    const FunctionType& function_type) {
   int64_t output_bits = function_type.return_type()->GetFlatBitCount();
   std::vector<uint8_t> result(CeilOfRatio(output_bits, int64_t{8}));
 
@@ -304,8 +333,8 @@ absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
       return absl::InternalError(
           absl::StrFormat("Could not read partial data of %d remaining bytes "
                           "(originally %d) from ICE40: %s",
-                          buffer.size_in_bytes() - bytes_written,
-                          buffer.size_in_bytes(), Strerror(errno)));
+                          result.size() - bytes_read, result.size(),
+                          Strerror(errno)));
     }
     bytes_read += ret;
   }
@@ -323,4 +352,52 @@ absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
   return absl::UnimplementedError("NYI: convert result to Value");
 }
 
+absl::StatusOr<Value> Ice40DeviceRpcStrategy::CallUnnamed(
+    const FunctionType& function_type, absl::Span<const Value> arguments) {
+  XLS_ASSIGN_OR_RETURN(std::vector<uint8_t> payload,
+                       EncodeArguments(arguments));
+  XLS_RETURN_IF_ERROR(WriteBytes(payload));
+
+  if (tcflush(tty_fd_.value(), TCOFLUSH) != 0) {
+    return absl::InternalError("Could not flush write(s) to device.");
+  }
+
+  return ReadResult(function_type);
+}
+
+absl::StatusOr<std::vector<Value>> Ice40DeviceRpcStrategy::CallUnnamedBatched(
+    const FunctionType& function_type,
+    absl::Span<const std::vector<Value>> argument_sets,
+    int64_t max_in_flight) {
+  XLS_RET_CHECK_GE(max_in_flight, 1);
+  std::vector<std::vector<uint8_t>> payloads;
+  payloads.reserve(argument_sets.size());
+  for (const std::vector<Value>& arguments : argument_sets) {
+    XLS_ASSIGN_OR_RETURN(std::vector<uint8_t> payload,
+                         EncodeArguments(arguments));
+    payloads.push_back(std::move(payload));
+  }
+
+  // Send the first window of calls in a single write, then send one more call
+  // as each result arrives so that the device always has work queued.
+  int64_t sent = std::min(max_in_flight, static_cast<int64_t>(payloads.size()));
+  std::vector<uint8_t> window;
+  for (int64_t i = 0; i < sent; ++i) {
+    window.insert(window.end(), payloads[i].begin(), payloads[i].end());
+  }
+  XLS_RETURN_IF_ERROR(WriteBytes(window));
+
+  std::vector<Value> results;
+  results.reserve(payloads.size());
+  for (int64_t i = 0; i < payloads.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Value result, ReadResult(function_type));
+    results.push_back(std::move(result));
+    if (sent < payloads.size()) {
+      XLS_RETURN_IF_ERROR(WriteBytes(payloads[sent]));
+      ++sent;
+    }
+  }
+  return results;
+}
+
 }  // namespace xls
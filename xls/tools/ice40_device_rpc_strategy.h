@@ -15,6 +15,10 @@
 #ifndef XLS_TOOLS_ICE40_DEVICE_RPC_STRATEGY_H_
 #define XLS_TOOLS_ICE40_DEVICE_RPC_STRATEGY_H_
 
+#include <cstdint>
+#include <optional>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "xls/tools/device_rpc_strategy.h"
 
@@ -29,7 +33,18 @@ class Ice40DeviceRpcStrategy : public DeviceRpcStrategy {
   absl::StatusOr<Value> CallUnnamed(const FunctionType& function_type,
                                     absl::Span<const Value> arguments) override;
 
+  absl::StatusOr<std::vector<Value>> CallUnnamedBatched(
+      const FunctionType& function_type,
+      absl::Span<const std::vector<Value>> argument_sets,
+      int64_t max_in_flight) override;
+
  private:
+  // Writes all of "bytes" to the device.
+  absl::Status WriteBytes(absl::Span<const uint8_t> bytes);
+
+  // Reads the result of one call from the device.
+  absl::StatusOr<Value> ReadResult(const FunctionType& function_type);
+
   std::optional<int> tty_fd_;
 };
 
@@ -0,0 +1,89 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Converts XLS IR between the text and binary (see xls/ir/binary_ir.h)
+// formats. The direction of the conversion is determined by the format of the
+// input.
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/logging/logging.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/ir/ir_parser.h"
+
+const char kUsage[] = R"(
+Converts text IR to binary IR or binary IR to text IR:
+
+  ir_binary_main --output=foo.irb foo.ir
+  ir_binary_main foo.irb > foo.ir
+)";
+
+ABSL_FLAG(std::string, output, "",
+          "Path to write the converted IR to. If empty, the converted IR is "
+          "written to stdout.");
+
+namespace xls::tools {
+namespace {
+
+absl::Status RealMain(std::string_view input_path) {
+  if (input_path == "-") {
+    input_path = "/dev/stdin";
+  }
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(input_path));
+  std::string output;
+  if (IsBinaryIr(contents)) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<Package> package,
+        ParseBinaryIr(absl::MakeConstSpan(
+            reinterpret_cast<const uint8_t*>(contents.data()),
+            contents.size())));
+    output = package->DumpIr();
+  } else {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(contents, input_path));
+    XLS_ASSIGN_OR_RETURN(output, DumpBinaryIr(package.get()));
+  }
+  std::string output_path = absl::GetFlag(FLAGS_output);
+  if (output_path.empty()) {
+    std::cout << output;
+    return absl::OkStatus();
+  }
+  return SetFileContents(output_path, output);
+}
+
+}  // namespace
+}  // namespace xls::tools
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    XLS_LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <path>",
+                                          argv[0]);
+  }
+
+  XLS_QCHECK_OK(xls::tools::RealMain(positional_arguments[0]));
+  return EXIT_SUCCESS;
+}
@@ -12,20 +12,27 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <functional>
 #include <random>
 
 #include "absl/flags/flag.h"
 #include "absl/random/distributions.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread_pool.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/ir_parser.h"
@@ -77,6 +84,12 @@ from the interpreter results. Example invocation:
   ir_minimizer_main --test_llvm_jit --use_optimization_pipeline \
     --input='bits[32]:42; bits[1]:0' IR_FILE
 
+With --parallelism=N, N candidate simplifications are built and tested
+concurrently and the smallest one which still fails is kept. Before making
+single random simplifications, the minimizer then tries replacing whole chunks
+of nodes with zeros (halves of the function, then quarters, and so on), which
+quickly discards the bulk of large samples.
+
 )";
 
 ABSL_FLAG(bool, can_remove_params, false,
@@ -129,6 +142,10 @@ ABSL_FLAG(std::vector<std::string>, preserve_channels, {},
           "Preserve IO ops on the given channel names during minimization. "
           "This is useful when minimizing with a script that runs the "
           "scheduler with IO constraints.");
+ABSL_FLAG(int64_t, parallelism, 1,
+          "The number of candidate simplifications to build and test "
+          "concurrently. If greater than one, chunks of nodes are also "
+          "replaced with zeros before single simplifications are tried.");
 ABSL_FLAG(std::string, top, "",
           "The name of the top entity. Currently, only procs and functions are "
           "supported. Entry function to use during minimization.");
@@ -741,6 +758,251 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// A simplified (and cleaned up) variant of the known failing IR.
+struct Candidate {
+  std::string ir_text;
+  std::string which_transform;
+  int64_t node_count;
+};
+
+// Builds a candidate from the given known failing IR. Returns nullopt if the
+// simplification did not change the IR.
+using CandidateBuilder =
+    std::function<absl::StatusOr<std::optional<Candidate>>(std::string_view)>;
+
+// A test cache shared by the threads testing candidates concurrently.
+struct SharedTestCache {
+  absl::Mutex mutex;
+  // Guarded by `mutex`.
+  absl::flat_hash_map<std::string, bool>* results;
+};
+
+absl::StatusOr<Candidate> CleanUpCandidate(Package* package,
+                                           std::string which_transform,
+                                           bool can_remove_params) {
+  FunctionBase* f = package->GetTop().value();
+  XLS_RETURN_IF_ERROR(CleanUp(f, can_remove_params));
+  return Candidate{package->DumpIr(), std::move(which_transform),
+                   f->node_count()};
+}
+
+// Returns the nodes of `f` whose replacement with a zero literal would
+// simplify it: those which are used, have no tokens and are not already zero.
+std::vector<Node*> ZeroableNodes(FunctionBase* f) {
+  std::vector<Node*> nodes;
+  for (Node* n : f->nodes()) {
+    if (TypeHasToken(n->GetType()) ||
+        (n->users().empty() && !f->HasImplicitUse(n)) ||
+        (n->Is<Literal>() && n->As<Literal>()->value().IsAllZeros())) {
+      continue;
+    }
+    nodes.push_back(n);
+  }
+  return nodes;
+}
+
+// Replaces the zeroable nodes [begin, end) of the top of the known failing IR
+// with zeros.
+absl::StatusOr<std::optional<Candidate>> BuildChunkCandidate(
+    std::string_view knownf_ir_text, int64_t begin, int64_t end,
+    bool can_remove_params) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackage(knownf_ir_text));
+  std::vector<Node*> nodes = ZeroableNodes(package->GetTop().value());
+  end = std::min<int64_t>(end, nodes.size());
+  if (begin >= end) {
+    return std::nullopt;
+  }
+  for (int64_t i = begin; i < end; ++i) {
+    XLS_RETURN_IF_ERROR(
+        nodes[i]->ReplaceUsesWithNew<Literal>(ZeroOfType(nodes[i]->GetType()))
+            .status());
+  }
+  return CleanUpCandidate(
+      package.get(),
+      absl::StrFormat("replace nodes %d to %d with zeros", begin, end - 1),
+      can_remove_params);
+}
+
+// Applies a random simplification (see Simplify) to the known failing IR.
+absl::StatusOr<std::optional<Candidate>> BuildRandomCandidate(
+    std::string_view knownf_ir_text,
+    const std::optional<std::vector<Value>>& inputs, uint32_t seed,
+    bool can_remove_params) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackage(knownf_ir_text));
+  std::mt19937 rng(seed);
+  std::string which_transform;
+  XLS_ASSIGN_OR_RETURN(SimplificationResult simplification,
+                       Simplify(package->GetTop().value(), inputs, &rng,
+                                &which_transform));
+  if (simplification != SimplificationResult::kDidChange) {
+    return std::nullopt;
+  }
+  return CleanUpCandidate(package.get(), std::move(which_transform),
+                          can_remove_params);
+}
+
+// Builds a candidate and returns it if it differs from the known failing IR
+// and still fails.
+absl::StatusOr<std::optional<Candidate>> BuildAndTestCandidate(
+    const CandidateBuilder& builder, std::string_view knownf_ir_text,
+    const std::optional<std::vector<Value>>& inputs, SharedTestCache* cache) {
+  XLS_ASSIGN_OR_RETURN(std::optional<Candidate> candidate,
+                       builder(knownf_ir_text));
+  if (!candidate.has_value() || candidate->ir_text == knownf_ir_text) {
+    return std::nullopt;
+  }
+  std::optional<bool> still_fails;
+  {
+    absl::MutexLock lock(&cache->mutex);
+    auto it = cache->results->find(candidate->ir_text);
+    if (it != cache->results->end()) {
+      still_fails = it->second;
+    }
+  }
+  if (!still_fails.has_value()) {
+    XLS_ASSIGN_OR_RETURN(still_fails,
+                         StillFailsHelper(candidate->ir_text, inputs));
+    absl::MutexLock lock(&cache->mutex);
+    (*cache->results)[candidate->ir_text] = *still_fails;
+  }
+  if (!*still_fails) {
+    return std::nullopt;
+  }
+  return candidate;
+}
+
+// Builds and tests candidates concurrently on the shared thread pool, and
+// returns the failing candidate with the fewest nodes, if any.
+absl::StatusOr<std::optional<Candidate>> TestCandidates(
+    std::string_view knownf_ir_text,
+    absl::Span<const CandidateBuilder> builders,
+    const std::optional<std::vector<Value>>& inputs, SharedTestCache* cache) {
+  std::vector<absl::StatusOr<std::optional<Candidate>>> results(
+      builders.size());
+  ParallelFor(0, builders.size(), [&](int64_t i) {
+    results[i] =
+        BuildAndTestCandidate(builders[i], knownf_ir_text, inputs, cache);
+  });
+  std::optional<Candidate> best;
+  for (absl::StatusOr<std::optional<Candidate>>& result : results) {
+    XLS_RETURN_IF_ERROR(result.status());
+    if (result->has_value() &&
+        (!best.has_value() || (*result)->node_count < best->node_count)) {
+      best = std::move(**result);
+    }
+  }
+  return best;
+}
+
+// Minimizes the known failing IR, testing `parallelism` candidates at a time.
+// Delta-debugging style, whole chunks of nodes are first replaced with zeros,
+// starting with halves of the function and halving the chunks whenever no
+// chunk can be replaced. Then single random simplifications are tried, as in
+// the serial minimization, until `failed_attempt_limit` attempts in a row fail.
+absl::StatusOr<std::string> MinimizeInParallel(
+    std::string knownf_ir_text, const std::optional<std::vector<Value>>& inputs,
+    bool can_remove_params, int64_t parallelism, int64_t failed_attempt_limit,
+    int64_t total_attempt_limit,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  SharedTestCache cache;
+  cache.results = test_cache;
+  int64_t total_attempts = 0;
+  auto accept = [&](Candidate candidate) {
+    std::cerr << "---\ntransform: " << candidate.which_transform << "\n"
+              << (candidate.node_count > 50 ? "" : candidate.ir_text) << "("
+              << candidate.node_count << " nodes)" << std::endl;
+    knownf_ir_text = std::move(candidate.ir_text);
+  };
+
+  int64_t chunk_count = 2;
+  while (total_attempts < total_attempt_limit) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         ParsePackage(knownf_ir_text));
+    int64_t node_count = ZeroableNodes(package->GetTop().value()).size();
+    if (chunk_count > node_count) {
+      break;
+    }
+    int64_t chunk_size = CeilOfRatio(node_count, chunk_count);
+    XLS_LOG(INFO) << absl::StreamFormat(
+        "=== Replacing chunks of %d of %d nodes with zeros", chunk_size,
+        node_count);
+    bool reduced = false;
+    for (int64_t begin = 0; begin < node_count && !reduced &&
+                            total_attempts < total_attempt_limit;
+         begin += chunk_size * parallelism) {
+      std::vector<CandidateBuilder> builders;
+      int64_t batch_end =
+          std::min(node_count, begin + chunk_size * parallelism);
+      for (int64_t b = begin; b < batch_end; b += chunk_size) {
+        builders.push_back([b, chunk_size, can_remove_params](
+                               std::string_view ir_text) {
+          return BuildChunkCandidate(ir_text, b, b + chunk_size,
+                                     can_remove_params);
+        });
+      }
+      total_attempts += builders.size();
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<Candidate> best,
+          TestCandidates(knownf_ir_text, builders, inputs, &cache));
+      if (best.has_value()) {
+        accept(*std::move(best));
+        reduced = true;
+      }
+    }
+    if (!reduced) {
+      chunk_count *= 2;
+    }
+  }
+
+  std::mt19937 rng;  // Default constructor uses deterministic seed.
+  int64_t failed_simplification_attempts = 0;
+  while (true) {
+    if (failed_simplification_attempts >= failed_attempt_limit) {
+      XLS_LOG(INFO) << "Hit failed-simplification-attempt-limit: "
+                    << failed_simplification_attempts;
+      break;
+    }
+    if (total_attempts >= total_attempt_limit) {
+      XLS_LOG(INFO) << "Hit total-attempt-limit: " << total_attempts;
+      break;
+    }
+    std::vector<CandidateBuilder> builders;
+    for (int64_t i = 0; i < parallelism; ++i) {
+      uint32_t seed = rng();
+      builders.push_back([&inputs, seed, can_remove_params](
+                             std::string_view ir_text) {
+        return BuildRandomCandidate(ir_text, inputs, seed, can_remove_params);
+      });
+    }
+    total_attempts += builders.size();
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<Candidate> best,
+        TestCandidates(knownf_ir_text, builders, inputs, &cache));
+    if (!best.has_value()) {
+      failed_simplification_attempts += builders.size();
+      continue;
+    }
+    accept(*std::move(best));
+    failed_simplification_attempts = 0;
+  }
+  return knownf_ir_text;
+}
+
+// Verifies the minimized IR still fails and writes it to stdout.
+absl::Status EmitMinimized(std::string_view knownf_ir_text,
+                           const std::optional<std::vector<Value>>& inputs) {
+  // Run the last test verification without the cache.
+  XLS_RETURN_IF_ERROR(VerifyStillFails(knownf_ir_text, inputs,
+                                       "Minimized function does not fail!",
+                                       /*test_cache=*/nullptr));
+
+  std::cout << knownf_ir_text;
+
+  return absl::OkStatus();
+}
+
 absl::Status RealMain(std::string_view path,
                       const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit) {
@@ -784,6 +1046,17 @@ absl::Status RealMain(std::string_view path,
     XLS_LOG(INFO) << "=== Done cleaning up initial garbage";
   }
 
+  const int64_t parallelism = absl::GetFlag(FLAGS_parallelism);
+  if (parallelism > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        MinimizeInParallel(std::move(knownf_ir_text), inputs,
+                           can_remove_params, parallelism,
+                           failed_attempt_limit, total_attempt_limit,
+                           &test_cache));
+    return EmitMinimized(knownf_ir_text, inputs);
+  }
+
   // If so, we start simplifying via this seeded RNG.
   std::mt19937 rng;  // Default constructor uses deterministic seed.
 
@@ -791,6 +1064,22 @@ absl::Status RealMain(std::string_view path,
   int64_t failed_simplification_attempts = 0;
   int64_t total_attempts = 0;
 
+  // Candidates are produced by mutating a single package under a checkpoint
+  // which is rolled back if the candidate is rejected. This avoids re-parsing
+  // the known failing IR for each attempt. Packages with blocks cannot be
+  // checkpointed and are re-parsed instead.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackage(knownf_ir_text));
+  const bool use_checkpoints = package->blocks().empty();
+  auto reject_candidate = [&]() -> absl::Status {
+    if (!use_checkpoints) {
+      return absl::OkStatus();
+    }
+    XLS_RETURN_IF_ERROR(package->RollbackToCheckpoint());
+    XLS_DCHECK_EQ(package->DumpIr(), knownf_ir_text);
+    return absl::OkStatus();
+  };
+
   while (true) {
     if (failed_simplification_attempts >= failed_attempt_limit) {
       XLS_LOG(INFO) << "Hit failed-simplification-attempt-limit: "
@@ -807,8 +1096,11 @@ absl::Status RealMain(std::string_view path,
 
     XLS_VLOG(1) << "=== Simplification attempt " << total_attempts;
 
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                         ParsePackage(knownf_ir_text));
+    if (use_checkpoints) {
+      XLS_RETURN_IF_ERROR(package->Checkpoint());
+    } else {
+      XLS_ASSIGN_OR_RETURN(package, ParsePackage(knownf_ir_text));
+    }
     FunctionBase* candidate = package->GetTop().value();
     XLS_VLOG_LINES(2,
                    "=== Candidate for simplification:\n" + candidate->DumpIr());
@@ -821,6 +1113,7 @@ absl::Status RealMain(std::string_view path,
     // If we cannot change it, we're done.
     if (simplification == SimplificationResult::kCannotChange) {
       XLS_LOG(INFO) << "Cannot simplify any further, done!";
+      XLS_RETURN_IF_ERROR(reject_candidate());
       break;
     }
 
@@ -830,6 +1123,7 @@ absl::Status RealMain(std::string_view path,
     if (simplification == SimplificationResult::kDidNotChange) {
       XLS_VLOG(1) << "Did not change the sample.";
       failed_simplification_attempts++;
+      XLS_RETURN_IF_ERROR(reject_candidate());
       continue;
     }
     XLS_LOG(INFO) << "Trying " << which_transform;
@@ -852,6 +1146,7 @@ absl::Status RealMain(std::string_view path,
       // That simplification caused it to stop failing, but keep going with the
       // last known failing version and seeing if we can find something else
       // from there.
+      XLS_RETURN_IF_ERROR(reject_candidate());
       continue;
     }
 
@@ -865,6 +1160,16 @@ absl::Status RealMain(std::string_view path,
         &test_cache));
 
     knownf_ir_text = candidate_ir_text;
+    if (use_checkpoints) {
+      XLS_RETURN_IF_ERROR(package->CommitCheckpoint());
+      // The second clean up may have changed the package further since the
+      // candidate IR was dumped. Candidates must start from the known failing
+      // IR so re-parse it in that (rare) case.
+      if (package->DumpIr() != knownf_ir_text) {
+        XLS_ASSIGN_OR_RETURN(package, ParsePackage(knownf_ir_text));
+        candidate = package->GetTop().value();
+      }
+    }
 
     std::cerr << "---\ntransform: " << which_transform << "\n"
               << (candidate->node_count() > 50 ? "" : candidate->DumpIr())
@@ -873,14 +1178,7 @@ absl::Status RealMain(std::string_view path,
     failed_simplification_attempts = 0;
   }
 
-  // Run the last test verification without the cache.
-  XLS_RETURN_IF_ERROR(VerifyStillFails(knownf_ir_text, inputs,
-                                       "Minimized function does not fail!",
-                                       /*test_cache=*/nullptr));
-
-  std::cout << knownf_ir_text;
-
-  return absl::OkStatus();
+  return EmitMinimized(knownf_ir_text, inputs);
 }
 
 }  // namespace
@@ -899,6 +1197,9 @@ int main(int argc, char** argv) {
              absl::GetFlag(FLAGS_test_llvm_jit))
       << "Must specify either --test_executable or --test_llvm_jit";
 
+  XLS_QCHECK_GE(absl::GetFlag(FLAGS_parallelism), 1)
+      << "--parallelism must be positive";
+
   XLS_QCHECK_OK(xls::RealMain(positional_arguments[0],
                               absl::GetFlag(FLAGS_failed_attempt_limit),
                               absl::GetFlag(FLAGS_total_attempt_limit)));
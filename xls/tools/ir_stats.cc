@@ -0,0 +1,288 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/ir_stats.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/util/json_util.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/numeric/bits.h"
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/math_util.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node_iterator.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/type.h"
+
+namespace xls {
+namespace {
+
+// Cost of dispatching a node in the interpreter, beyond the work of the node
+// itself, in the units of EstimateJitCost().
+constexpr int64_t kInterpreterNodeOverhead = 20;
+
+int64_t WordCount(Type* type) {
+  return std::max<int64_t>(1,
+                           CeilOfRatio(type->GetFlatBitCount(), int64_t{64}));
+}
+
+std::string FunctionBaseKind(FunctionBase* f) {
+  if (f->IsFunction()) {
+    return "function";
+  }
+  return f->IsProc() ? "proc" : "block";
+}
+
+// Returns the function called by the node, if any, and how many times it is
+// called per evaluation of the node.
+std::optional<std::pair<Function*, int64_t>> GetCallee(Node* node) {
+  switch (node->op()) {
+    case Op::kInvoke:
+      return std::make_pair(node->As<Invoke>()->to_apply(), int64_t{1});
+    case Op::kMap:
+      return std::make_pair(
+          node->As<Map>()->to_apply(),
+          node->operand(0)->GetType()->AsArrayOrDie()->size());
+    case Op::kCountedFor:
+      return std::make_pair(node->As<CountedFor>()->body(),
+                            node->As<CountedFor>()->trip_count());
+    case Op::kDynamicCountedFor:
+      // The trip count is only known at run time; count one iteration.
+      return std::make_pair(node->As<DynamicCountedFor>()->body(), int64_t{1});
+    default:
+      return std::nullopt;
+  }
+}
+
+// Computes the statistics of function bases, memoizing them so that the costs
+// of callees are computed once however often they are called.
+class IrStatsBuilder {
+ public:
+  const FunctionBaseStatsProto& GetStats(FunctionBase* f) {
+    if (auto it = stats_.find(f); it != stats_.end()) {
+      return it->second;
+    }
+    FunctionBaseStatsProto stats = Compute(f);
+    return stats_.emplace(f, std::move(stats)).first->second;
+  }
+
+ private:
+  FunctionBaseStatsProto Compute(FunctionBase* f) {
+    FunctionBaseStatsProto stats;
+    stats.set_name(f->name());
+    stats.set_kind(FunctionBaseKind(f));
+    stats.set_node_count(f->node_count());
+    if (f->IsFunction()) {
+      stats.set_signature(f->AsFunctionOrDie()->GetType()->ToString());
+    }
+
+    absl::flat_hash_map<std::pair<Op, int64_t>, int64_t> op_counts;
+    absl::flat_hash_map<Type*, int64_t> array_counts;
+    // Bucket k holds the nodes with a fanout of bit width k.
+    std::vector<int64_t> fanout_buckets;
+    absl::flat_hash_map<Node*, int64_t> path_lengths;
+    path_lengths.reserve(f->node_count());
+    int64_t jit_cost = 0;
+    int64_t interpreter_cost = 0;
+    for (Node* node : TopoSort(f)) {
+      int64_t path_length = 0;
+      for (Node* operand : node->operands()) {
+        path_length = std::max(path_length, path_lengths.at(operand));
+      }
+      ++path_length;
+      path_lengths[node] = path_length;
+      if (path_length > stats.critical_path_length()) {
+        stats.set_critical_path_length(path_length);
+        stats.set_critical_path_end(node->GetName());
+      }
+
+      Type* type = node->GetType();
+      ++op_counts[{node->op(), type->GetFlatBitCount()}];
+      if (type->IsArray()) {
+        ++array_counts[type];
+      }
+
+      const int64_t fanout = node->users().size();
+      stats.set_max_fanout(std::max(stats.max_fanout(), fanout));
+      const int64_t bucket = absl::bit_width(static_cast<uint64_t>(fanout));
+      if (bucket >= fanout_buckets.size()) {
+        fanout_buckets.resize(bucket + 1);
+      }
+      ++fanout_buckets[bucket];
+
+      jit_cost += EstimateJitCost(node);
+      interpreter_cost += EstimateInterpreterCost(node);
+      if (std::optional<std::pair<Function*, int64_t>> callee =
+              GetCallee(node)) {
+        const FunctionBaseStatsProto& callee_stats = GetStats(callee->first);
+        jit_cost += callee->second * callee_stats.estimated_jit_cost();
+        interpreter_cost +=
+            callee->second * callee_stats.estimated_interpreter_cost();
+      }
+    }
+    stats.set_estimated_jit_cost(jit_cost);
+    stats.set_estimated_interpreter_cost(interpreter_cost);
+
+    std::vector<std::pair<std::pair<std::string, int64_t>, int64_t>>
+        sorted_op_counts;
+    sorted_op_counts.reserve(op_counts.size());
+    for (const auto& [op_and_width, count] : op_counts) {
+      sorted_op_counts.push_back(
+          {{OpToString(op_and_width.first), op_and_width.second}, count});
+    }
+    std::sort(sorted_op_counts.begin(), sorted_op_counts.end());
+    for (const auto& [op_and_width, count] : sorted_op_counts) {
+      OpWidthCountProto* proto = stats.add_op_counts();
+      proto->set_op(op_and_width.first);
+      proto->set_bit_count(op_and_width.second);
+      proto->set_count(count);
+    }
+
+    for (int64_t bucket = 0; bucket < fanout_buckets.size(); ++bucket) {
+      if (fanout_buckets[bucket] == 0) {
+        continue;
+      }
+      FanoutBucketProto* proto = stats.add_fanout_histogram();
+      proto->set_min_fanout(bucket == 0 ? 0 : int64_t{1} << (bucket - 1));
+      proto->set_max_fanout(bucket == 0 ? 0 : (int64_t{1} << bucket) - 1);
+      proto->set_count(fanout_buckets[bucket]);
+    }
+
+    std::vector<std::pair<std::string, Type*>> sorted_array_types;
+    sorted_array_types.reserve(array_counts.size());
+    for (const auto& [type, count] : array_counts) {
+      sorted_array_types.push_back({type->ToString(), type});
+    }
+    std::sort(sorted_array_types.begin(), sorted_array_types.end());
+    for (const auto& [name, type] : sorted_array_types) {
+      ArrayTypeCountProto* proto = stats.add_array_types();
+      proto->set_type(name);
+      proto->set_element_count(type->AsArrayOrDie()->size());
+      proto->set_bit_count(type->GetFlatBitCount());
+      proto->set_count(array_counts.at(type));
+    }
+    return stats;
+  }
+
+  absl::flat_hash_map<FunctionBase*, FunctionBaseStatsProto> stats_;
+};
+
+}  // namespace
+
+int64_t EstimateJitCost(Node* node) {
+  const int64_t words = WordCount(node->GetType());
+  switch (node->op()) {
+    case Op::kParam:
+    case Op::kLiteral:
+    case Op::kAfterAll:
+      return 0;
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kUMulp:
+    case Op::kSMulp:
+      return 3 * words * words;
+    case Op::kUDiv:
+    case Op::kSDiv:
+    case Op::kUMod:
+    case Op::kSMod:
+      return 20 * words * words;
+    case Op::kArrayIndex:
+      // Bounds checks of the indices and a copy of the element.
+      return 2 * node->operand_count() + words;
+    case Op::kInvoke:
+    case Op::kMap:
+    case Op::kCountedFor:
+    case Op::kDynamicCountedFor:
+      // Call overhead; see ComputeIrStats() for the cost of the callee.
+      return 5 + words;
+    default:
+      return words;
+  }
+}
+
+int64_t EstimateInterpreterCost(Node* node) {
+  // Besides dispatching every node, the interpreter materializes each value
+  // in heap-allocated Bits or Values.
+  return kInterpreterNodeOverhead + 4 * EstimateJitCost(node);
+}
+
+IrStatsProto ComputeIrStats(Package* package,
+                            std::optional<std::string_view> restrict_to) {
+  IrStatsProto stats;
+  stats.set_package_name(package->name());
+  IrStatsBuilder builder;
+  for (FunctionBase* f : package->GetFunctionBases()) {
+    if (restrict_to.has_value() && f->name() != *restrict_to) {
+      continue;
+    }
+    *stats.add_function_bases() = builder.GetStats(f);
+    stats.set_node_count(stats.node_count() + f->node_count());
+  }
+  return stats;
+}
+
+absl::StatusOr<std::string> IrStatsToJson(const IrStatsProto& stats) {
+  std::string serialized_json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+  auto status = google::protobuf::util::MessageToJsonString(
+      stats, &serialized_json, print_options);
+  if (!status.ok()) {
+    return absl::InternalError(std::string{status.message()});
+  }
+  return serialized_json;
+}
+
+std::string IrStatsToString(const IrStatsProto& stats) {
+  std::string result =
+      absl::StrFormat("Package \"%s\"\n", stats.package_name());
+  for (const FunctionBaseStatsProto& f : stats.function_bases()) {
+    std::string kind = f.kind();
+    kind[0] = absl::ascii_toupper(kind[0]);
+    absl::StrAppendFormat(&result, "  %s: \"%s\"\n", kind, f.name());
+    if (!f.signature().empty()) {
+      absl::StrAppendFormat(&result, "    Signature: %s\n", f.signature());
+    }
+    absl::StrAppendFormat(&result, "    Nodes: %d\n", f.node_count());
+    absl::StrAppendFormat(&result,
+                          "    Critical path: %d nodes, ending at %s\n",
+                          f.critical_path_length(), f.critical_path_end());
+    absl::StrAppendFormat(&result, "    Max fanout: %d\n", f.max_fanout());
+    absl::StrAppendFormat(&result,
+                          "    Estimated cost: %d (JIT), %d (interpreter)\n",
+                          f.estimated_jit_cost(),
+                          f.estimated_interpreter_cost());
+    result += "    Ops:\n";
+    for (const OpWidthCountProto& op_count : f.op_counts()) {
+      absl::StrAppendFormat(&result, "      %s (%d bits): %d\n", op_count.op(),
+                            op_count.bit_count(), op_count.count());
+    }
+    result += "\n";
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -0,0 +1,49 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_IR_STATS_H_
+#define XLS_TOOLS_IR_STATS_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/tools/ir_stats.pb.h"
+
+namespace xls {
+
+// Returns the statistics of the functions, procs and blocks of the package, or
+// only of the one named `restrict_to` if given. Each node is visited once, so
+// this is cheap even for packages with millions of nodes.
+IrStatsProto ComputeIrStats(
+    Package* package, std::optional<std::string_view> restrict_to);
+
+// Returns the estimated cost of evaluating the node with the JIT and with the
+// interpreter. See FunctionBaseStatsProto.
+int64_t EstimateJitCost(Node* node);
+int64_t EstimateInterpreterCost(Node* node);
+
+// Returns the JSON serialization of the given statistics.
+absl::StatusOr<std::string> IrStatsToJson(const IrStatsProto& stats);
+
+// Returns a human-readable summary of the given statistics.
+std::string IrStatsToString(const IrStatsProto& stats);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_IR_STATS_H_
@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-// Prints summary information about an IR file to the terminal.
-// Output will be added as needs warrant, so feel free to make additions!
+// Prints summary information about an IR file (text or binary) to the
+// terminal, or as JSON with --json. See xls/tools/ir_stats.proto for the
+// statistics computed. Output will be added as needs warrant, so feel free to
+// make additions!
 
+#include <iostream>
+#include <optional>
+#include <string>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -25,30 +30,29 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
-#include "xls/ir/ir_parser.h"
+#include "xls/ir/binary_ir.h"
+#include "xls/tools/ir_stats.h"
 
 ABSL_FLAG(
     std::string, top, "",
     "The name of the top entity. Currently, only functions are supported. "
     "If set, restrict dumping to the given function. "
     "The name should not be mangled with the Package name.");
+ABSL_FLAG(bool, json, false,
+          "Print the statistics as JSON rather than a readable summary.");
 
 namespace xls {
 
 absl::Status RealMain(std::string_view ir_path,
                       std::optional<std::string> restrict_fn) {
-  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(contents));
-
-  std::cout << "Package \"" << package->name() << "\"" << std::endl;
-  for (const auto& f : package->functions()) {
-    if (restrict_fn && restrict_fn.value() != f->name()) {
-      continue;
-    }
-    std::cout << "  Function: \"" << f->name() << "\"" << std::endl;
-    std::cout << "    Signature: " << f->GetType()->ToString() << std::endl;
-    std::cout << "    Nodes: " << f->node_count() << std::endl;
-    std::cout << std::endl;
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackageFile(ir_path));
+  IrStatsProto stats = ComputeIrStats(package.get(), restrict_fn);
+  if (absl::GetFlag(FLAGS_json)) {
+    XLS_ASSIGN_OR_RETURN(std::string json, IrStatsToJson(stats));
+    std::cout << json << std::endl;
+  } else {
+    std::cout << IrStatsToString(stats);
   }
   return absl::OkStatus();
 }
@@ -0,0 +1,125 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/ir_stats.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_test_base.h"
+
+namespace xls {
+namespace {
+
+using ::testing::HasSubstr;
+
+class IrStatsTest : public IrTestBase {};
+
+TEST_F(IrStatsTest, FunctionStats) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(R"(
+package p
+
+fn body(i: bits[32], acc: bits[32]) -> bits[32] {
+  ret umul.1: bits[32] = umul(i, acc)
+}
+
+fn f(x: bits[32], y: bits[32], a: bits[8][4]) -> bits[32] {
+  add.2: bits[32] = add(x, y)
+  sub.3: bits[32] = sub(add.2, x)
+  and.4: bits[32] = and(add.2, sub.3, y)
+  ret counted_for.5: bits[32] = counted_for(and.4, trip_count=10, stride=1, body=body)
+}
+)"));
+  IrStatsProto stats = ComputeIrStats(package.get(), "f");
+  EXPECT_EQ(stats.package_name(), "p");
+  ASSERT_EQ(stats.function_bases_size(), 1);
+  const FunctionBaseStatsProto& f = stats.function_bases(0);
+  EXPECT_EQ(f.name(), "f");
+  EXPECT_EQ(f.kind(), "function");
+  EXPECT_EQ(f.node_count(), 7);
+  EXPECT_EQ(stats.node_count(), 7);
+  // x -> add -> sub -> and -> counted_for.
+  EXPECT_EQ(f.critical_path_length(), 5);
+  EXPECT_EQ(f.critical_path_end(), "counted_for.5");
+  // x, y and add.2 have two users each.
+  EXPECT_EQ(f.max_fanout(), 2);
+
+  ASSERT_EQ(f.array_types_size(), 1);
+  EXPECT_EQ(f.array_types(0).type(), "bits[8][4]");
+  EXPECT_EQ(f.array_types(0).element_count(), 4);
+  EXPECT_EQ(f.array_types(0).bit_count(), 32);
+  EXPECT_EQ(f.array_types(0).count(), 1);
+
+  int64_t param_count = 0;
+  for (const OpWidthCountProto& op_count : f.op_counts()) {
+    if (op_count.op() == "param") {
+      param_count += op_count.count();
+    }
+  }
+  EXPECT_EQ(param_count, 3);
+
+  // The ten multiplies of the loop body dominate the cost.
+  IrStatsProto body_stats = ComputeIrStats(package.get(), "body");
+  const FunctionBaseStatsProto& body = body_stats.function_bases(0);
+  EXPECT_EQ(body.estimated_jit_cost(),
+            EstimateJitCost(FindNode("umul.1", package.get())));
+  EXPECT_GE(f.estimated_jit_cost(), 10 * body.estimated_jit_cost());
+  EXPECT_GT(f.estimated_interpreter_cost(), f.estimated_jit_cost());
+}
+
+TEST_F(IrStatsTest, FanoutHistogram) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(R"(
+package p
+
+fn f(x: bits[4]) -> (bits[4], bits[4], bits[4], bits[4]) {
+  not.1: bits[4] = not(x)
+  ret tuple.2: (bits[4], bits[4], bits[4], bits[4]) = tuple(x, x, x, not.1)
+}
+)"));
+  IrStatsProto stats = ComputeIrStats(package.get(), std::nullopt);
+  const FunctionBaseStatsProto& f = stats.function_bases(0);
+  // tuple.2 has no users, not.1 one, and x two.
+  ASSERT_EQ(f.fanout_histogram_size(), 3);
+  EXPECT_EQ(f.fanout_histogram(0).min_fanout(), 0);
+  EXPECT_EQ(f.fanout_histogram(0).count(), 1);
+  EXPECT_EQ(f.fanout_histogram(1).min_fanout(), 1);
+  EXPECT_EQ(f.fanout_histogram(1).max_fanout(), 1);
+  EXPECT_EQ(f.fanout_histogram(1).count(), 1);
+  EXPECT_EQ(f.fanout_histogram(2).min_fanout(), 2);
+  EXPECT_EQ(f.fanout_histogram(2).max_fanout(), 3);
+  EXPECT_EQ(f.fanout_histogram(2).count(), 1);
+}
+
+TEST_F(IrStatsTest, Serialization) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(R"(
+package p
+
+fn f(x: bits[4]) -> bits[4] {
+  ret neg.1: bits[4] = neg(x)
+}
+)"));
+  IrStatsProto stats = ComputeIrStats(package.get(), std::nullopt);
+  XLS_ASSERT_OK_AND_ASSIGN(std::string json, IrStatsToJson(stats));
+  EXPECT_THAT(json, HasSubstr("\"critical_path_end\": \"neg.1\""));
+  std::string text = IrStatsToString(stats);
+  EXPECT_THAT(text, HasSubstr("Function: \"f\""));
+  EXPECT_THAT(text, HasSubstr("Signature: (bits[4]) -> bits[4]"));
+  EXPECT_THAT(text, HasSubstr("neg (4 bits): 1"));
+}
+
+}  // namespace
+}  // namespace xls
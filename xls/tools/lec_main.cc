@@ -20,8 +20,10 @@
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/time.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/init_xls.h"
@@ -42,7 +44,8 @@
 
 ABSL_FLAG(std::string, cell_lib_path, "",
           "Path to the cell library. "
-          "Either this or cell_proto_path should be set.");
+          "Either this or cell_proto_path should be set. The extracted "
+          "cell library proto is cached next to the library.");
 ABSL_FLAG(std::string, cell_proto_path, "",
           "Path to the preprocessed cell library proto. "
           "This is a whole bunch faster than specifying an unprocessed "
@@ -85,6 +88,15 @@ ABSL_FLAG(int32_t, stage, -1,
           "Pipeline stage to evaluate. Requires --schedule.\n"
           "If \"schedule\" is set, but this is not, then the entire module "
           "will be evaluated.");
+ABSL_FLAG(int64_t, partition_bits, 0,
+          "If non-zero, split the check into independent problems each "
+          "comparing this many output bits (of each stage, if a schedule is "
+          "given) and report which bits are proven. --timeout_sec then "
+          "applies to each problem. The tool fails unless every bit is "
+          "proven.");
+ABSL_FLAG(int64_t, partition_threads, 1,
+          "With --partition_bits, the number of problems solved in "
+          "parallel.");
 
 namespace xls {
 namespace {
@@ -105,11 +117,9 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(cell_proto.ParseFromString(cell_proto_text));
     return netlist::CellLibrary::FromProto(cell_proto);
   } else {
-    XLS_ASSIGN_OR_RETURN(std::string lib_text, GetFileContents(cell_lib_path));
-    XLS_ASSIGN_OR_RETURN(auto stream,
-                         netlist::cell_lib::CharStream::FromText(lib_text));
-    XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto proto,
-                         netlist::function::ExtractFunctions(&stream));
+    XLS_ASSIGN_OR_RETURN(
+        netlist::CellLibraryProto proto,
+        netlist::function::ExtractFunctionsFromPath(cell_lib_path));
     return netlist::CellLibrary::FromProto(proto);
   }
 }
@@ -219,6 +229,55 @@ absl::Status AutoStage(const solvers::z3::LecParams& lec_params,
   return absl::OkStatus();
 }
 
+// Runs a partitioned LEC, printing each result as it's found and then a
+// summary. Returns an error unless every output bit is proven.
+absl::Status RunPartitioned(const solvers::z3::LecParams& lec_params,
+                            solvers::z3::PartitionedLecOptions options) {
+  int64_t done = 0;
+  options.progress_callback =
+      [&](const solvers::z3::LecPartitionResult& result) {
+        ++done;
+        std::cout << absl::StreamFormat(
+                         "[%d] stage %d %s: %s (%s)", done, result.stage,
+                         result.bits,
+                         solvers::z3::LecPartitionStatusToString(result.status),
+                         absl::FormatDuration(result.duration))
+                  << std::endl;
+      };
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<solvers::z3::LecPartitionResult> results,
+      solvers::z3::Lec::RunPartitioned(lec_params, options));
+
+  int64_t proven_bits = 0;
+  int64_t total_bits = 0;
+  std::vector<std::string> unproven;
+  for (const solvers::z3::LecPartitionResult& result : results) {
+    total_bits += result.bit_count;
+    if (result.status == solvers::z3::LecPartitionStatus::kProven) {
+      proven_bits += result.bit_count;
+      continue;
+    }
+    unproven.push_back(absl::StrFormat(
+        "  stage %d %s: %s", result.stage, result.bits,
+        solvers::z3::LecPartitionStatusToString(result.status)));
+    if (!result.counterexample.empty()) {
+      std::cout << "\nCounterexample for stage " << result.stage << " "
+                << result.bits << ":\n"
+                << result.counterexample << std::endl;
+    }
+  }
+  std::cout << absl::StreamFormat("\nProved %d of %d output bits.\n",
+                                  proven_bits, total_bits);
+  if (!unproven.empty()) {
+    std::cout << "Unproven bits:\n" << absl::StrJoin(unproven, "\n")
+              << std::endl;
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "%d of %d output bits not proven equivalent.",
+        total_bits - proven_bits, total_bits));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::Status RealMain(
@@ -226,7 +285,8 @@ absl::Status RealMain(
     std::string_view netlist_module_name, std::string_view cell_lib_path,
     std::string_view cell_proto_path, std::string_view netlist_path,
     std::string_view constraints_file, std::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    int stage, bool auto_stage, int timeout_sec, int64_t partition_bits,
+    int64_t partition_threads) {
   solvers::z3::LecParams lec_params;
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
@@ -245,24 +305,21 @@ absl::Status RealMain(
   lec_params.netlist = netlist.get();
   lec_params.netlist_module_name = netlist_module_name;
 
-  std::unique_ptr<solvers::z3::Lec> lec;
+  std::optional<PipelineSchedule> schedule;
   if (!schedule_path.empty()) {
     XLS_ASSIGN_OR_RETURN(
         PipelineScheduleProto proto,
         ParseTextProtoFile<PipelineScheduleProto>(schedule_path));
     XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
-        PipelineSchedule::FromProto(lec_params.ir_function, proto));
-    if (auto_stage) {
-      return AutoStage(lec_params, schedule, timeout_sec);
-    }
-    XLS_ASSIGN_OR_RETURN(
-        lec, solvers::z3::Lec::CreateForStage(lec_params, schedule, stage));
-  } else {
-    XLS_ASSIGN_OR_RETURN(lec, solvers::z3::Lec::Create(lec_params));
+        schedule, PipelineSchedule::FromProto(lec_params.ir_function, proto));
+  }
+
+  if (auto_stage) {
+    return AutoStage(lec_params, *schedule, timeout_sec);
   }
 
   std::unique_ptr<Package> constraints_pkg;
+  Function* constraints = nullptr;
   if (!constraints_file.empty()) {
     XLS_ASSIGN_OR_RETURN(std::filesystem::path ir_converter_path,
                          GetXlsRunfilePath(kIrConverterPath));
@@ -275,9 +332,31 @@ absl::Status RealMain(
 
     XLS_ASSIGN_OR_RETURN(constraints_pkg,
                          Parser::ParsePackage(stdout_and_stderr.first));
-    XLS_ASSIGN_OR_RETURN(Function * function,
-                         constraints_pkg->GetTopAsFunction());
-    XLS_RETURN_IF_ERROR(lec->AddConstraints(function));
+    XLS_ASSIGN_OR_RETURN(constraints, constraints_pkg->GetTopAsFunction());
+  }
+
+  if (partition_bits > 0) {
+    solvers::z3::PartitionedLecOptions options;
+    options.bits_per_partition = partition_bits;
+    options.num_threads = partition_threads;
+    if (timeout_sec != -1) {
+      options.partition_timeout = absl::Seconds(timeout_sec);
+    }
+    options.schedule = schedule;
+    options.stage = stage;
+    options.constraints = constraints;
+    return RunPartitioned(lec_params, options);
+  }
+
+  std::unique_ptr<solvers::z3::Lec> lec;
+  if (schedule.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        lec, solvers::z3::Lec::CreateForStage(lec_params, *schedule, stage));
+  } else {
+    XLS_ASSIGN_OR_RETURN(lec, solvers::z3::Lec::Create(lec_params));
+  }
+  if (constraints != nullptr) {
+    XLS_RETURN_IF_ERROR(lec->AddConstraints(constraints));
   }
 
   struct sigaction old_action;
@@ -330,11 +409,15 @@ int main(int argc, char* argv[]) {
 
   XLS_QCHECK(!(auto_stage && schedule_path.empty()))
       << "--schedule_path must be specified with --auto_stage.";
+  XLS_QCHECK(!(auto_stage && absl::GetFlag(FLAGS_partition_bits) > 0))
+      << "Only one of --auto_stage or --partition_bits may be specified.";
 
   XLS_QCHECK_OK(xls::RealMain(
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
       netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      auto_stage, absl::GetFlag(FLAGS_timeout_sec),
+      absl::GetFlag(FLAGS_partition_bits),
+      absl::GetFlag(FLAGS_partition_threads)));
   return 0;
 }
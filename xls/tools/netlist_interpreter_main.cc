@@ -13,14 +13,19 @@
 // limitations under the License.
 
 // Driver for NetlistInterpreter: loads a netlist from disk, feeds Value input
-// (taken from the command line) into it, and prints the result.
+// (taken from the command line) into it, and prints the result. With
+// --input_vectors, evaluates each vector of a file with the compiled
+// (bit-parallel) evaluator instead, printing one result per line.
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "xls/codegen/flattening.h"
 #include "xls/common/file/filesystem.h"
+#include "xls/common/file/memory_mapped_file.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -28,6 +33,7 @@
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/value.h"
 #include "xls/netlist/cell_library.h"
+#include "xls/netlist/compiled_module.h"
 #include "xls/netlist/function_extractor.h"
 #include "xls/netlist/interpreter.h"
 #include "xls/netlist/lib_parser.h"
@@ -35,7 +41,8 @@
 #include "xls/netlist/netlist_parser.h"
 
 ABSL_FLAG(std::string, cell_library, "",
-          "Cell library to use for interpretation.");
+          "Cell library to use for interpretation. The extracted cell "
+          "library proto is cached next to the library.");
 ABSL_FLAG(std::string, cell_library_proto, "",
           "Preprocessed cell library proto to use for interpretation.");
 // TODO(rspringer): Eliminate the need for this flag.
@@ -51,6 +58,17 @@ ABSL_FLAG(std::string, input, "",
 ABSL_FLAG(std::string, output_type, "",
           "Type of the value as an XLS-formatted string. If un-set, then the "
           "output will be printed as flat uninterpreted bits.");
+ABSL_FLAG(std::string, input_vectors, "",
+          "Path to a file of inputs, one per line, each in the format of "
+          "--input. The inputs are evaluated in batches by the compiled "
+          "netlist evaluator and the outputs printed one per line.");
+ABSL_FLAG(int64_t, batch_words, 8,
+          "With --input_vectors, the number of 64-input words evaluated in "
+          "each pass over the compiled netlist.");
+ABSL_FLAG(int64_t, num_threads, 0,
+          "With --input_vectors, the number of threads between which the "
+          "batches of inputs are divided. If zero, the inputs are evaluated "
+          "on the main thread.");
 ABSL_FLAG(std::string, module_name, "", "Module in the netlist to interpret.");
 ABSL_FLAG(std::string, netlist, "", "Path to the netlist to interpret.");
 
@@ -66,34 +84,17 @@ absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(lib_proto.ParseFromString(proto_text));
     return netlist::CellLibrary::FromProto(lib_proto);
   } else {
-    XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
-                         GetFileContents(cell_library_path));
     XLS_ASSIGN_OR_RETURN(
-        auto char_stream,
-        netlist::cell_lib::CharStream::FromText(cell_library_text));
-    XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
-                         netlist::function::ExtractFunctions(&char_stream));
+        netlist::CellLibraryProto lib_proto,
+        netlist::function::ExtractFunctionsFromPath(cell_library_path));
     return netlist::CellLibrary::FromProto(lib_proto);
   }
 }
 
-absl::Status RealMain(const std::string& netlist_path,
-                      const std::string& cell_library_path,
-                      const std::string& cell_library_proto_path,
-                      const std::string& module_name,
-                      absl::Span<const std::string> inputs,
-                      const std::string& output_type_string,
-                      absl::Span<const std::string> dump_cells) {
-  XLS_ASSIGN_OR_RETURN(
-      netlist::CellLibrary cell_library,
-      GetCellLibrary(cell_library_path, cell_library_proto_path));
-
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
-                                         &cell_library, &scanner));
-  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
-
+// Returns the values of the input nets of `module` (in the order of
+// Module::inputs()) for the given semicolon-separated input values.
+absl::StatusOr<std::vector<bool>> GetInputNetValues(
+    const netlist::rtl::Module* module, absl::Span<const std::string> inputs) {
   // Input values are listed in the same order as inputs are declared by
   // the netlist module declaration, which may be different from the order of
   // Module::inputs().  For example:
@@ -115,37 +116,119 @@ absl::Status RealMain(const std::string& netlist_path,
   }
   input_bits = bits_ops::Reverse(input_bits);
 
-  netlist::NetRef2Value input_nets;
   const std::vector<netlist::rtl::NetRef>& module_inputs = module->inputs();
   XLS_RET_CHECK(module_inputs.size() == input_bits.bit_count());
 
-  for (int i = 0; i < module->inputs().size(); i++) {
+  std::vector<bool> values(module_inputs.size());
+  for (int i = 0; i < module_inputs.size(); i++) {
     const netlist::rtl::NetRef in = module_inputs[i];
-    input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
+    values[i] = input_bits.Get(module->GetInputPortOffset(in->name()));
   }
+  return values;
+}
 
-  netlist::Interpreter interpreter(netlist.get());
-  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
-                                             module, input_nets, dump_cells));
-
-  BitsRope rope(output_nets.size());
-  for (const netlist::rtl::NetRef ref : module->outputs()) {
-    rope.push_back(output_nets[ref]);
+// Returns the output of the module given the values of its output nets.
+absl::StatusOr<Value> GetOutputValue(const std::vector<bool>& output_values,
+                                     Type* output_type) {
+  BitsRope rope(output_values.size());
+  for (bool value : output_values) {
+    rope.push_back(value);
   }
   Bits output_bits = rope.Build();
+  if (output_type != nullptr) {
+    return UnflattenBitsToValue(output_bits, output_type);
+  }
+  return Value(output_bits);
+}
+
+// Evaluates each line of the file at `input_vectors_path` with the compiled
+// module, printing the outputs.
+absl::Status EvaluateInputVectors(const netlist::rtl::Netlist& netlist,
+                                  const netlist::rtl::Module* module,
+                                  const std::string& input_vectors_path,
+                                  Type* output_type) {
+  XLS_ASSIGN_OR_RETURN(netlist::CompiledModule compiled,
+                       netlist::CompiledModule::Compile(netlist, *module));
+
+  XLS_ASSIGN_OR_RETURN(std::string vectors_text,
+                       GetFileContents(input_vectors_path));
+  std::vector<std::vector<bool>> vectors;
+  for (std::string_view line : absl::StrSplit(vectors_text, '\n')) {
+    if (absl::StripAsciiWhitespace(line).empty()) {
+      continue;
+    }
+    std::vector<std::string> inputs = absl::StrSplit(line, ';');
+    XLS_ASSIGN_OR_RETURN(std::vector<bool> values,
+                         GetInputNetValues(module, inputs));
+    vectors.push_back(std::move(values));
+  }
 
-  Value output;
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<std::vector<bool>> outputs,
+      compiled.EvaluateVectors(vectors, absl::GetFlag(FLAGS_batch_words),
+                               absl::GetFlag(FLAGS_num_threads)));
+  std::string output_text;
+  for (const std::vector<bool>& output_values : outputs) {
+    XLS_ASSIGN_OR_RETURN(Value output,
+                         GetOutputValue(output_values, output_type));
+    absl::StrAppend(&output_text, output.ToString(FormatPreference::kHex),
+                    "\n");
+  }
+  std::cout << output_text;
+  return absl::OkStatus();
+}
+
+absl::Status RealMain(const std::string& netlist_path,
+                      const std::string& cell_library_path,
+                      const std::string& cell_library_proto_path,
+                      const std::string& module_name,
+                      absl::Span<const std::string> inputs,
+                      const std::string& input_vectors_path,
+                      const std::string& output_type_string,
+                      absl::Span<const std::string> dump_cells) {
+  XLS_ASSIGN_OR_RETURN(
+      netlist::CellLibrary cell_library,
+      GetCellLibrary(cell_library_path, cell_library_proto_path));
+
+  // The netlist is scanned in place; names are copied out as they're parsed.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<MemoryMappedFile> netlist_file,
+                       MemoryMappedFile::Open(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_file->contents());
+  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
+                                         &cell_library, &scanner));
+  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
+
+  // This is a disposable package - it only exists to hold the output type.
+  Package package("foo");
+  Type* output_type = nullptr;
   if (!output_type_string.empty()) {
-    // This is a disposable package - it only exists to hold the type below.
-    Package package("foo");
-    XLS_ASSIGN_OR_RETURN(Type * output_type,
+    XLS_ASSIGN_OR_RETURN(output_type,
                          Parser::ParseType(output_type_string, &package));
-    XLS_ASSIGN_OR_RETURN(output,
-                         UnflattenBitsToValue(output_bits, output_type));
-  } else {
-    output = Value(output_bits);
   }
 
+  if (!input_vectors_path.empty()) {
+    return EvaluateInputVectors(*netlist, module, input_vectors_path,
+                                output_type);
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::vector<bool> input_values,
+                       GetInputNetValues(module, inputs));
+  netlist::NetRef2Value input_nets;
+  for (int i = 0; i < module->inputs().size(); i++) {
+    input_nets[module->inputs()[i]] = input_values[i];
+  }
+
+  netlist::Interpreter interpreter(netlist.get());
+  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
+                                             module, input_nets, dump_cells));
+
+  std::vector<bool> output_values;
+  for (const netlist::rtl::NetRef ref : module->outputs()) {
+    output_values.push_back(output_nets[ref]);
+  }
+  XLS_ASSIGN_OR_RETURN(Value output,
+                       GetOutputValue(output_values, output_type));
+
   std::cout << output.ToString(FormatPreference::kHex) << std::endl;
   return absl::OkStatus();
 }
@@ -168,8 +251,13 @@ int main(int argc, char* argv[]) {
   XLS_QCHECK(!module_name.empty()) << "--module_name must be specified.";
 
   std::string input = absl::GetFlag(FLAGS_input);
-  XLS_QCHECK(!input.empty()) << "--input must be specified.";
-  std::vector<std::string> inputs = absl::StrSplit(input, ';');
+  std::string input_vectors_path = absl::GetFlag(FLAGS_input_vectors);
+  XLS_QCHECK(!input.empty() ^ !input_vectors_path.empty())
+      << "One (and only one) of --input or --input_vectors must be specified.";
+  std::vector<std::string> inputs;
+  if (!input.empty()) {
+    inputs = absl::StrSplit(input, ';');
+  }
 
   std::string dump_cells_str = absl::GetFlag(FLAGS_dump_cells);
   std::vector<std::string> dump_cells = absl::StrSplit(dump_cells_str, ',');
@@ -178,7 +266,7 @@ int main(int argc, char* argv[]) {
 
   XLS_QCHECK_OK(xls::RealMain(netlist_path, cell_library_path,
                               cell_library_proto_path, module_name, inputs,
-                              output_type, dump_cells));
+                              input_vectors_path, output_type, dump_cells));
 
   return 0;
 }
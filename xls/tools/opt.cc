@@ -14,19 +14,114 @@
 
 #include "xls/tools/opt.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "xls/common/casts.h"
+#include "xls/common/file/content_addressed_cache.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
 #include "xls/dslx/parse_and_typecheck.h"
+#include "xls/ir/binary_ir.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/pass_metrics.h"
 #include "xls/passes/passes.h"
+#include "xls/passes/proof_service.h"
 #include "xls/passes/standard_pipeline.h"
 
 namespace xls::tools {
+namespace {
 
-absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
-                                             const OptOptions& options) {
+// Bumped whenever the format of cache keys or entries changes.
+constexpr std::string_view kOptCacheVersion = "2";
+
+void AppendConfig(const RamConfig& config, std::string* key) {
+  absl::StrAppend(key, RamKindToString(config.kind), ",", config.depth, ",",
+                  config.word_partition_size.value_or(-1), ",");
+  if (config.initial_value.has_value()) {
+    absl::StrAppend(key, "[",
+                    absl::StrJoin(*config.initial_value, ",",
+                                  [](std::string* out, const Value& v) {
+                                    absl::StrAppend(out, v.ToString());
+                                  }),
+                    "]");
+  }
+  absl::StrAppend(key, ";");
+}
+
+// Appends the names of the passes of `pass` in the order they run, nesting
+// the passes of compound passes in parentheses.
+void AppendPassNames(const Pass& pass, std::string* key) {
+  absl::StrAppend(key, pass.short_name());
+  if (!pass.IsCompound()) {
+    return;
+  }
+  absl::StrAppend(key, "(");
+  for (const Pass* nested : down_cast<const CompoundPass*>(&pass)->passes()) {
+    AppendPassNames(*nested, key);
+    absl::StrAppend(key, ",");
+  }
+  absl::StrAppend(key, ")");
+}
+
+// Returns the name of the cache entry of the optimized IR of `ir` produced by
+// `pipeline` with `options` in the build `build_id`: a SHA-256 digest of the
+// IR, the build, the passes of the pipeline and every option which may affect
+// the optimized IR.
+std::string OptCacheKey(std::string_view ir, const OptOptions& options,
+                        std::string_view build_id,
+                        const CompoundPass& pipeline) {
+  std::string key =
+      absl::StrCat("version=", kOptCacheVersion, "\nbuild=", build_id,
+                   "\nopt_level=", options.opt_level, "\ntop=", options.top,
+                   "\npipeline=");
+  AppendPassNames(pipeline, &key);
+  absl::StrAppend(&key, "\n");
+  if (options.run_only_passes.has_value()) {
+    absl::StrAppend(&key, "run_only_passes=",
+                    absl::StrJoin(*options.run_only_passes, ","), "\n");
+  }
+  absl::StrAppend(&key, "skip_passes=", absl::StrJoin(options.skip_passes, ","),
+                  "\nconvert_array_index_to_select=",
+                  options.convert_array_index_to_select.value_or(-1),
+                  "\ninline_procs=", options.inline_procs,
+                  "\nincremental_topo_sort=", options.incremental_topo_sort,
+                  "\nstructural_hashing=", options.structural_hashing,
+                  "\nfunction_base_pass_threads=",
+                  options.function_base_pass_threads.has_value(), "\n");
+  for (const RamRewrite& rewrite : options.ram_rewrites) {
+    absl::StrAppend(&key, "ram_rewrite=");
+    AppendConfig(rewrite.from_config, &key);
+    AppendConfig(rewrite.to_config, &key);
+    std::vector<std::pair<std::string, std::string>> channels(
+        rewrite.from_channels_logical_to_physical.begin(),
+        rewrite.from_channels_logical_to_physical.end());
+    std::sort(channels.begin(), channels.end());
+    for (const auto& [logical, physical] : channels) {
+      absl::StrAppend(&key, logical, "=", physical, ",");
+    }
+    absl::StrAppend(&key, rewrite.to_name_prefix, ",",
+                    rewrite.model_builder.has_value(), "\n");
+  }
+  return ContentDigest({key, ir});
+}
+
+absl::StatusOr<std::string> OptimizeIr(std::string_view ir,
+                                       const OptOptions& options) {
   if (!options.top.empty()) {
     XLS_VLOG(3) << "OptimizeIrForEntry; top: '" << options.top
                 << "'; opt_level: " << options.opt_level;
@@ -34,8 +129,15 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
     XLS_VLOG(3) << "OptimizeIrForEntry; opt_level: " << options.opt_level;
   }
 
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                       Parser::ParsePackage(ir, options.ir_path));
+  std::unique_ptr<Package> package;
+  if (IsBinaryIr(ir)) {
+    XLS_ASSIGN_OR_RETURN(
+        package, ParseBinaryIr(absl::MakeConstSpan(
+                     reinterpret_cast<const uint8_t*>(ir.data()), ir.size())));
+  } else {
+    XLS_ASSIGN_OR_RETURN(package,
+                         Parser::ParsePackageParallel(ir, options.ir_path));
+  }
   if (!options.top.empty()) {
     XLS_RETURN_IF_ERROR(package->SetTopByName(options.top));
   }
@@ -45,30 +147,119 @@ absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
         "Top entity not set for package: %s.", package->name()));
   }
   XLS_VLOG(3) << "Top entity: '" << top.value()->name() << "'";
+  if (options.incremental_topo_sort) {
+    for (FunctionBase* f : package->GetFunctionBases()) {
+      f->SetIncrementalTopoSortEnabled(true);
+    }
+  }
+  if (options.structural_hashing) {
+    for (FunctionBase* f : package->GetFunctionBases()) {
+      f->SetStructuralHashingEnabled(true);
+    }
+  }
 
-  std::unique_ptr<CompoundPass> pipeline =
-      CreateStandardPassPipeline(options.opt_level);
-  const PassOptions pass_options = {
+  std::unique_ptr<CompoundPass> owned_pipeline;
+  CompoundPass* pipeline = options.pipeline;
+  if (pipeline == nullptr) {
+    owned_pipeline = CreateStandardPassPipeline(options.opt_level);
+    pipeline = owned_pipeline.get();
+  }
+  PassOptions pass_options = {
       .ir_dump_path = options.ir_dump_path,
       .run_only_passes = options.run_only_passes,
       .skip_passes = options.skip_passes,
       .inline_procs = options.inline_procs,
       .convert_array_index_to_select = options.convert_array_index_to_select,
       .ram_rewrites = options.ram_rewrites,
+      .incremental_verification = options.incremental_verification,
+      .incremental_fixed_point = options.incremental_fixed_point,
+      .function_base_pass_threads = options.function_base_pass_threads,
+      .time_budget = options.time_budget,
   };
+  std::unique_ptr<ProofService> proof_service;
+  if (options.proof_threads > 0) {
+    proof_service = std::make_unique<ProofService>(options.proof_threads,
+                                                   options.proof_timeout);
+    pass_options.proof_service = proof_service.get();
+  }
   PassResults results;
   XLS_RETURN_IF_ERROR(
       pipeline->Run(package.get(), pass_options, &results).status());
+  if (proof_service != nullptr) {
+    XLS_VLOG(1) << "Proof service answered " << proof_service->answer_count()
+                << " claims, proving " << proof_service->proven_count();
+  }
+  if (!results.skipped_passes.empty()) {
+    XLS_LOG(WARNING) << "Optimization time budget exceeded; skipped passes: "
+                     << absl::StrJoin(results.skipped_passes, ", ");
+  }
+  if (options.incremental_verification) {
+    // Incremental verification skips some package-wide checks so finish with
+    // a full verification.
+    XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+    for (FunctionBase* f : package->GetFunctionBases()) {
+      f->SetChangeTrackingEnabled(false);
+    }
+  }
+  if (!options.pass_metrics_path.empty()) {
+    XLS_RETURN_IF_ERROR(WritePassMetrics(results, options.pass_metrics_path));
+  }
   return package->DumpIr();
 }
 
+}  // namespace
+
+absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
+                                             const OptOptions& options) {
+  // IR dumps and pass metrics are side outputs of running the pipeline which a
+  // cache hit would not produce.
+  if (options.cache_dir.empty() || options.time_budget.has_value() ||
+      options.proof_threads > 0 || !options.ir_dump_path.empty() ||
+      !options.pass_metrics_path.empty()) {
+    return OptimizeIr(ir, options);
+  }
+  absl::StatusOr<std::string> build_id = ComputeFileBuildId("/proc/self/exe");
+  if (!build_id.ok()) {
+    XLS_LOG(WARNING) << "Not using the opt cache: " << build_id.status();
+    return OptimizeIr(ir, options);
+  }
+  // Build the pipeline here so that its passes are part of the key.
+  OptOptions cached_options = options;
+  std::unique_ptr<CompoundPass> owned_pipeline;
+  if (cached_options.pipeline == nullptr) {
+    owned_pipeline = CreateStandardPassPipeline(options.opt_level);
+    cached_options.pipeline = owned_pipeline.get();
+  }
+  ContentAddressedCache cache(options.cache_dir, ".opt.ir");
+  std::string key =
+      OptCacheKey(ir, cached_options, *build_id, *cached_options.pipeline);
+  absl::StatusOr<std::optional<std::string>> cached = cache.Read(key);
+  if (cached.ok() && cached->has_value()) {
+    XLS_VLOG(1) << "Using optimized IR cached in " << cache.EntryPath(key);
+    return **std::move(cached);
+  }
+  XLS_ASSIGN_OR_RETURN(std::string optimized_ir,
+                       OptimizeIr(ir, cached_options));
+  // Failing to populate the cache is not an error.
+  absl::Status status = cache.Write(key, optimized_ir);
+  if (!status.ok()) {
+    XLS_LOG(WARNING) << "Unable to write opt cache entry: " << status;
+  }
+  return optimized_ir;
+}
+
 absl::StatusOr<std::string> OptimizeIrForTop(
     std::string_view input_path, int64_t opt_level, std::string_view top,
     std::string_view ir_dump_path,
     absl::Span<const std::string> run_only_passes,
     absl::Span<const std::string> skip_passes,
     int64_t convert_array_index_to_select, bool inline_procs,
-    std::string_view ram_rewrites_pb) {
+    std::string_view ram_rewrites_pb, bool incremental_topo_sort,
+    bool incremental_verification, std::string_view pass_metrics_path,
+    bool incremental_fixed_point, int64_t function_base_pass_threads,
+    bool structural_hashing, std::string_view cache_dir,
+    absl::Duration opt_time_budget, int64_t proof_threads,
+    absl::Duration proof_timeout) {
   XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(input_path));
   std::vector<RamRewrite> ram_rewrites;
   if (!ram_rewrites_pb.empty()) {
@@ -94,6 +285,21 @@ absl::StatusOr<std::string> OptimizeIrForTop(
               : std::make_optional(convert_array_index_to_select),
       .inline_procs = inline_procs,
       .ram_rewrites = std::move(ram_rewrites),
+      .incremental_topo_sort = incremental_topo_sort,
+      .incremental_verification = incremental_verification,
+      .pass_metrics_path = std::string(pass_metrics_path),
+      .incremental_fixed_point = incremental_fixed_point,
+      .function_base_pass_threads =
+          (function_base_pass_threads < 0)
+              ? std::nullopt
+              : std::make_optional(function_base_pass_threads),
+      .structural_hashing = structural_hashing,
+      .cache_dir = std::string(cache_dir),
+      .time_budget = (opt_time_budget == absl::InfiniteDuration())
+                         ? std::nullopt
+                         : std::make_optional(opt_time_budget),
+      .proof_threads = proof_threads,
+      .proof_timeout = proof_timeout,
   };
   return OptimizeIrForTop(ir, options);
 }
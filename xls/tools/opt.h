@@ -18,11 +18,13 @@
 #define XLS_TOOLS_OPT_H_
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 
 // TODO(meheff): 2021-10-04 Remove this header.
 #include "xls/passes/passes.h"
@@ -41,11 +43,55 @@ struct OptOptions {
   std::optional<int64_t> convert_array_index_to_select = std::nullopt;
   bool inline_procs;
   std::vector<RamRewrite> ram_rewrites = {};
+  // Whether to maintain topological orders of the nodes incrementally rather
+  // than recomputing them for each pass. See
+  // FunctionBase::SetIncrementalTopoSortEnabled.
+  bool incremental_topo_sort = false;
+  // Whether to verify only the changed parts of the IR after each pass. The
+  // IR is verified in full at the start and end of the pipeline. See
+  // VerifyPackageIncrementally.
+  bool incremental_verification = false;
+  // If non-empty, the per-pass metrics of the pipeline are written to this
+  // path. See WritePassMetrics.
+  std::string pass_metrics_path = "";
+  // Whether passes in fixed point loops skip function bases unchanged since
+  // their previous run. See PassOptions::incremental_fixed_point.
+  bool incremental_fixed_point = false;
+  // If set, function-local passes run on the functions and procs of the
+  // package concurrently using this many threads. See
+  // PassOptions::function_base_pass_threads.
+  std::optional<int64_t> function_base_pass_threads;
+  // Whether to maintain an index of the nodes by their structure so common
+  // subexpression elimination only considers the nodes changed since it last
+  // ran. See FunctionBase::SetStructuralHashingEnabled.
+  bool structural_hashing = false;
+  // If non-empty, the optimized IR is cached in this directory keyed by a
+  // digest of the input IR, the options affecting the result, the passes of
+  // the pipeline and the build of the running executable, and reused by later
+  // runs with the same key. Runs which write IR dumps or pass metrics bypass
+  // the cache.
+  std::string cache_dir = "";
+  // If set, the wall-clock time the optimization pipeline should take.
+  // Expensive passes are skipped as the budget runs low so the optimized IR
+  // depends on the speed of the machine; such runs are never cached. See
+  // PassOptions::time_budget.
+  std::optional<absl::Duration> time_budget;
+  // If positive, claims about the IR are proven with Z3 on this many
+  // background threads, each claim taking at most `proof_timeout`, and the
+  // proven facts used to simplify the IR. As solver timeouts depend on the
+  // speed of the machine such runs are never cached. See ProofService.
+  int64_t proof_threads = 0;
+  absl::Duration proof_timeout = absl::Seconds(1);
+  // If non-null, this pipeline is run instead of a standard pipeline created
+  // for `opt_level`, so callers optimizing many packages can build it once.
+  // It must be equivalent to CreateStandardPassPipeline(opt_level).
+  CompoundPass* pipeline = nullptr;
 };
 
 // Helper used in the opt_main tool, optimizes the given IR for a particular
 // top-level entity (e.g., function, proc, etc) at the given opt level and
-// returns the resulting optimized IR.
+// returns the resulting optimized IR. The input may be text or binary IR (see
+// xls/ir/binary_ir.h); the result is always text IR.
 absl::StatusOr<std::string> OptimizeIrForTop(std::string_view ir,
                                              const OptOptions& options);
 
@@ -57,7 +103,14 @@ absl::StatusOr<std::string> OptimizeIrForTop(
     absl::Span<const std::string> run_only_passes,
     absl::Span<const std::string> skip_passes,
     int64_t convert_array_index_to_select, bool inline_procs,
-    std::string_view ram_rewrites_pb);
+    std::string_view ram_rewrites_pb, bool incremental_topo_sort = false,
+    bool incremental_verification = false,
+    std::string_view pass_metrics_path = "",
+    bool incremental_fixed_point = false,
+    int64_t function_base_pass_threads = -1, bool structural_hashing = false,
+    std::string_view cache_dir = "",
+    absl::Duration opt_time_budget = absl::InfiniteDuration(),
+    int64_t proof_threads = 0, absl::Duration proof_timeout = absl::Seconds(1));
 
 }  // namespace xls::tools
 
@@ -17,6 +17,7 @@
 
 #include "absl/status/status.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/logging.h"
@@ -65,6 +66,55 @@ ABSL_FLAG(bool, inline_procs, false,
           "Whether to inline all procs by calling the proc inlining pass.");
 ABSL_FLAG(std::string, ram_rewrites_pb, "",
           "Path to protobuf describing ram rewrites.");
+ABSL_FLAG(bool, incremental_topo_sort, false,
+          "Whether to maintain topological orders of the nodes incrementally "
+          "as passes mutate the IR rather than recomputing them from scratch. "
+          "The resulting orders are valid but may differ from the default, so "
+          "the optimized IR may differ.");
+ABSL_FLAG(bool, incremental_verification, false,
+          "Whether to verify only the parts of the IR changed by each pass "
+          "rather than the entire IR. The IR is verified in full at the start "
+          "and end of the pipeline.");
+ABSL_FLAG(bool, incremental_fixed_point, false,
+          "Whether passes within fixed point loops should skip functions and "
+          "procs which are unchanged since the pass last ran on them without "
+          "changing them. The optimized IR is unaffected.");
+ABSL_FLAG(int64_t, function_base_pass_threads, -1,
+          "If non-negative, run passes which only touch a single function or "
+          "proc on the functions and procs of the package concurrently using "
+          "this many threads. The optimized IR does not depend on the number "
+          "of threads but may differ from the IR optimized serially (without "
+          "this flag) in node ids.");
+ABSL_FLAG(bool, structural_hashing, false,
+          "Whether to maintain an index of the nodes by their structure as "
+          "passes mutate the IR so common subexpression elimination only "
+          "considers the nodes changed since it last ran. Equivalent nodes "
+          "are commoned in a different order, so the optimized IR may differ "
+          "in names and ids.");
+ABSL_FLAG(std::string, pass_metrics_path, "",
+          "If specified, write the metrics of each pass invocation (run time, "
+          "node counts, peak memory growth and fixed point nesting) to this "
+          "path. The metrics are written as JSON if the path ends in '.json' "
+          "and as a PassMetricsProto text proto otherwise.");
+ABSL_FLAG(std::string, cache_dir, "",
+          "If specified, cache the optimized IR in this directory and reuse "
+          "it for later runs of the same build of opt_main on the same IR "
+          "with the same options. Runs given --ir_dump_path or "
+          "--pass_metrics_path do not use the cache.");
+ABSL_FLAG(absl::Duration, opt_time_budget, absl::InfiniteDuration(),
+          "If specified, the wall-clock time the optimization pipeline should "
+          "take (e.g. '30s'). As the budget runs low expensive passes are "
+          "skipped and some analyses are downgraded; once it is spent fixed "
+          "point loops stop iterating. The skipped passes are logged. The "
+          "optimized IR then depends on the speed of the machine and is "
+          "never cached.");
+ABSL_FLAG(int64_t, proof_threads, 0,
+          "If positive, prove facts about the IR which cheaper analyses cannot "
+          "(e.g. that a select arm is never selected) with Z3 on this many "
+          "background threads and use them to simplify the IR. The optimized "
+          "IR then depends on the speed of the machine and is never cached.");
+ABSL_FLAG(absl::Duration, proof_timeout, absl::Seconds(1),
+          "The time the solver may spend on each claim with --proof_threads.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls::tools {
@@ -84,6 +134,18 @@ absl::Status RealMain(std::string_view input_path) {
       absl::GetFlag(FLAGS_convert_array_index_to_select);
   bool inline_procs = absl::GetFlag(FLAGS_inline_procs);
   std::string ram_rewrites_pb = absl::GetFlag(FLAGS_ram_rewrites_pb);
+  bool incremental_topo_sort = absl::GetFlag(FLAGS_incremental_topo_sort);
+  bool incremental_verification =
+      absl::GetFlag(FLAGS_incremental_verification);
+  std::string pass_metrics_path = absl::GetFlag(FLAGS_pass_metrics_path);
+  bool incremental_fixed_point = absl::GetFlag(FLAGS_incremental_fixed_point);
+  int64_t function_base_pass_threads =
+      absl::GetFlag(FLAGS_function_base_pass_threads);
+  bool structural_hashing = absl::GetFlag(FLAGS_structural_hashing);
+  std::string cache_dir = absl::GetFlag(FLAGS_cache_dir);
+  absl::Duration opt_time_budget = absl::GetFlag(FLAGS_opt_time_budget);
+  int64_t proof_threads = absl::GetFlag(FLAGS_proof_threads);
+  absl::Duration proof_timeout = absl::GetFlag(FLAGS_proof_timeout);
   XLS_ASSIGN_OR_RETURN(
       std::string opt_ir,
       tools::OptimizeIrForTop(
@@ -94,7 +156,17 @@ absl::Status RealMain(std::string_view input_path) {
           /*skip_passes=*/skip_passes,
           /*convert_array_index_to_select=*/convert_array_index_to_select,
           /*inline_procs=*/inline_procs,
-          /*ram_rewrites_pb=*/ram_rewrites_pb));
+          /*ram_rewrites_pb=*/ram_rewrites_pb,
+          /*incremental_topo_sort=*/incremental_topo_sort,
+          /*incremental_verification=*/incremental_verification,
+          /*pass_metrics_path=*/pass_metrics_path,
+          /*incremental_fixed_point=*/incremental_fixed_point,
+          /*function_base_pass_threads=*/function_base_pass_threads,
+          /*structural_hashing=*/structural_hashing,
+          /*cache_dir=*/cache_dir,
+          /*opt_time_budget=*/opt_time_budget,
+          /*proof_threads=*/proof_threads,
+          /*proof_timeout=*/proof_timeout));
   std::cout << opt_ir;
   return absl::OkStatus();
 }
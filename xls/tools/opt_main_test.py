@@ -15,6 +15,7 @@
 
 """Tests for xls.tools.codegen_main."""
 
+import os
 import subprocess
 
 from xls.common import runfiles
@@ -129,5 +130,45 @@ class OptMainTest(test_base.TestCase):
     self.assertNotIn('concat', optimized_ir)
 
 
+  def test_cache_dir(self):
+    ir_file = self.create_tempfile(content=ADD_ZERO_IR)
+    cache_dir = self.create_tempdir()
+
+    optimized_ir = subprocess.check_output([
+        OPT_MAIN_PATH, '--cache_dir=' + cache_dir.full_path, ir_file.full_path
+    ]).decode('utf-8')
+    self.assertIn('ret x', optimized_ir)
+    entries = os.listdir(cache_dir.full_path)
+    self.assertLen(entries, 1)
+    entry = os.path.join(cache_dir.full_path, entries[0])
+    with open(entry) as f:
+      self.assertEqual(f.read(), optimized_ir)
+
+    # A second run with the same IR and options reads the cache entry.
+    with open(entry, 'w') as f:
+      f.write('cached')
+    self.assertEqual(
+        subprocess.check_output([
+            OPT_MAIN_PATH, '--cache_dir=' + cache_dir.full_path,
+            ir_file.full_path
+        ]).decode('utf-8'), 'cached')
+
+    # Different options produce a different entry.
+    subprocess.check_call([
+        OPT_MAIN_PATH, '--cache_dir=' + cache_dir.full_path, '--opt_level=1',
+        ir_file.full_path
+    ])
+    self.assertLen(os.listdir(cache_dir.full_path), 2)
+
+    # Runs writing pass metrics bypass the cache.
+    metrics_file = self.create_tempfile()
+    self.assertIn(
+        'ret x',
+        subprocess.check_output([
+            OPT_MAIN_PATH, '--cache_dir=' + cache_dir.full_path,
+            '--pass_metrics_path=' + metrics_file.full_path, ir_file.full_path
+        ]).decode('utf-8'))
+    self.assertNotEmpty(metrics_file.read_text())
+
 if __name__ == '__main__':
   test_base.main()
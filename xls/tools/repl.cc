@@ -63,8 +63,12 @@
 #include "xls/dslx/type_system/concrete_type.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/typecheck.h"
+#include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
 #include "xls/passes/standard_pipeline.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_pass.h"
@@ -120,7 +124,8 @@ enum class CommandName {
   kIr,
   kVerilog,
   kLlvm,
-  kType
+  kType,
+  kRun
 };
 
 // A parsed command, along with its arguments.
@@ -159,6 +164,17 @@ std::optional<Command> ParseCommand(std::string_view str) {
   } else if (munch_prefix(":type ") || munch_prefix(":t ")) {
     result.command = CommandName::kType;
     result.arguments.push_back(absl::StripAsciiWhitespace(str));
+  } else if (munch_prefix(":run ")) {
+    // Function name, then the (parenthesized) arguments.
+    result.command = CommandName::kRun;
+    str = absl::StripAsciiWhitespace(str);
+    size_t args_start = str.find('(');
+    if (args_start == std::string_view::npos) {
+      return std::nullopt;
+    }
+    result.arguments.push_back(
+        absl::StripAsciiWhitespace(str.substr(0, args_start)));
+    result.arguments.push_back(str.substr(args_start));
   } else {
     XLS_VLOG(1) << "Unknown command prefix: \"" << stripped_str << "\"";
     return std::nullopt;
@@ -170,22 +186,30 @@ std::optional<Command> ParseCommand(std::string_view str) {
 // callbacks, without an extra `void*` parameter through which context can be
 // provided.
 struct DslxGlobals {
-  DslxGlobals(dslx::ImportData import_data_in,
-              std::unique_ptr<dslx::Module> module_in,
+  DslxGlobals(std::string contents_in, std::unique_ptr<dslx::Module> module_in,
               dslx::TypeInfo* type_info_in)
-      : import_data(std::move(import_data_in)),
+      : contents(std::move(contents_in)),
         module(std::move(module_in)),
         type_info(type_info_in) {}
 
-  dslx::ImportData import_data;
+  // The text the module was parsed from.
+  std::string contents;
   std::unique_ptr<dslx::Module> module;
   dslx::TypeInfo* type_info;
 };
 
 struct Globals {
   std::string_view dslx_path;
+  // Holds the typechecked imported modules. Kept across `:reload`s, so that
+  // unchanged imports aren't typechecked again; `:reset` drops it.
+  std::unique_ptr<dslx::ImportData> import_data;
   std::unique_ptr<DslxGlobals> dslx;
+  // Converted from `dslx` on first use; see UpdateIr().
   std::unique_ptr<Package> ir_package;
+  // The number of `:run`s of each IR function, and JITs of those run more
+  // than once. Both refer to `ir_package`.
+  absl::flat_hash_map<std::string, int64_t> run_counts;
+  absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jits;
   Trie identifier_trie;
   Trie command_trie;
 };
@@ -231,6 +255,11 @@ char* HintsCallback(const char* buf, int* color, int* bold) {
     *bold = 0;
     return (char*)" <id>";
   }
+  if (!strcasecmp(buf, ":run")) {
+    *color = 90;
+    *bold = 0;
+    return (char*)" <function>(<args>)";
+  }
   return NULL;
 }
 
@@ -269,20 +298,28 @@ Trie PopulateIdentifierTrie() {
 
 // After this is called, the state of `GetSingletonGlobals()->ir_package` is
 // guaranteed to be up to date with respect to the state of
-// `GetSingletonGlobals()->module`.
+// `GetSingletonGlobals()->module`. The IR is only converted and optimized again
+// after the module changed.
 absl::Status UpdateIr() {
   Globals* globals = GetSingletonGlobals();
+  if (globals->ir_package != nullptr) {
+    return absl::OkStatus();
+  }
   XLS_ASSIGN_OR_RETURN(globals->ir_package,
                        ConvertModuleToPackage(globals->dslx->module.get(),
-                                              &globals->dslx->import_data,
+                                              globals->import_data.get(),
                                               dslx::ConvertOptions{},
                                               /*traverse_tests=*/true));
   XLS_ASSIGN_OR_RETURN(std::string mangled_name,
                        dslx::MangleDslxName(globals->dslx->module.get()->name(),
                                             "main", /*free_keys=*/{}));
   XLS_RETURN_IF_ERROR(globals->ir_package->SetTopByName(mangled_name));
-  XLS_RETURN_IF_ERROR(
-      RunStandardPassPipeline(globals->ir_package.get()).status());
+  absl::Status status =
+      RunStandardPassPipeline(globals->ir_package.get()).status();
+  if (!status.ok()) {
+    globals->ir_package = nullptr;
+    return status;
+  }
   return absl::OkStatus();
 }
 
@@ -303,17 +340,23 @@ absl::Status CommandHelp() {
             << "    :llvm            Generate and print LLVM for file\n"
             << "    :type <id>       Show the type of identifier <id>\n"
             << "    :t <id>          Alias for :type\n"
+            << "    :run <f>(<args>) Evaluate IR function <f> on the given IR\n"
+            << "                     values, e.g. :run add(1, 2)\n"
             << "\n";
   return absl::OkStatus();
 }
 
 // Function implementing the `:reload` command, which reloads the DSLX file from
-// disk and parses/typechecks it.
+// disk and parses/typechecks it. Nothing is done if the file is unchanged.
 absl::Status CommandReload() {
   Globals* globals = GetSingletonGlobals();
 
   XLS_ASSIGN_OR_RETURN(std::string dslx_contents,
                        GetFileContents(globals->dslx_path));
+  if (globals->dslx != nullptr && globals->dslx->contents == dslx_contents) {
+    std::cout << globals->dslx_path << " is unchanged\n";
+    return absl::OkStatus();
+  }
 
   dslx::Scanner scanner(std::string(globals->dslx_path), dslx_contents);
   dslx::Parser parser("main", &scanner);
@@ -327,14 +370,21 @@ absl::Status CommandReload() {
   }
 
   std::unique_ptr<dslx::Module> module = std::move(maybe_module).value();
-  dslx::ImportData import_data(dslx::CreateImportData(
-      /*dslx_stdlib_path=*/"",
-      /*additional_search_paths=*/{}));
+  if (globals->import_data == nullptr) {
+    globals->import_data =
+        std::make_unique<dslx::ImportData>(dslx::CreateImportData(
+            /*dslx_stdlib_path=*/"",
+            /*additional_search_paths=*/{}));
+  }
   dslx::WarningCollector warnings;
-  XLS_ASSIGN_OR_RETURN(dslx::TypeInfo * type_info,
-                       CheckModule(module.get(), &import_data, &warnings));
-  globals->dslx = std::make_unique<DslxGlobals>(std::move(import_data),
-                                                std::move(module), type_info);
+  XLS_ASSIGN_OR_RETURN(
+      dslx::TypeInfo * type_info,
+      CheckModule(module.get(), globals->import_data.get(), &warnings));
+  globals->dslx = std::make_unique<DslxGlobals>(
+      std::move(dslx_contents), std::move(module), type_info);
+  globals->jits.clear();
+  globals->run_counts.clear();
+  globals->ir_package = nullptr;
   globals->identifier_trie = PopulateIdentifierTrie();
 
   std::cout << "Successfully loaded " << globals->dslx_path << "\n";
@@ -343,9 +393,16 @@ absl::Status CommandReload() {
 }
 
 // Function implementing the `:reset` command, which is the same as `:reload`
-// except it also resets the terminal first.
+// except it also resets the terminal first, and typechecks imported modules
+// afresh.
 absl::Status CommandReset() {
   std::cout << "\ec";
+  Globals* globals = GetSingletonGlobals();
+  globals->jits.clear();
+  globals->run_counts.clear();
+  globals->ir_package = nullptr;
+  globals->dslx = nullptr;
+  globals->import_data = nullptr;
   return CommandReload();
 }
 
@@ -388,7 +445,12 @@ absl::Status CommandVerilog(std::optional<std::string> function_name) {
   XLS_VLOG(1) << "Running verilog command with function name: "
               << (function_name ? *function_name : "<none>");
   XLS_RETURN_IF_ERROR(UpdateIr());
-  Package* package = GetSingletonGlobals()->ir_package.get();
+  // Codegen adds blocks to the package, so work on a copy to keep the cached
+  // IR clean.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package_copy,
+      Parser::ParsePackage(GetSingletonGlobals()->ir_package->DumpIr()));
+  Package* package = package_copy.get();
   dslx::Module* module = GetSingletonGlobals()->dslx->module.get();
   FunctionBase* main;
   if (function_name) {
@@ -469,6 +531,60 @@ absl::Status CommandType(std::string_view ident) {
   return absl::OkStatus();
 }
 
+// Function implementing the `:run` command, which evaluates an IR function of
+// the module on the given arguments, written as a tuple of IR values. A
+// function is interpreted the first time it is run, as that is quicker than
+// compiling it for a single call, and JIT-compiled once run again; the JIT is
+// kept until the module changes.
+absl::Status CommandRun(std::string_view function_name,
+                        std::string_view arguments) {
+  XLS_RETURN_IF_ERROR(UpdateIr());
+  Globals* globals = GetSingletonGlobals();
+  Package* package = globals->ir_package.get();
+  XLS_ASSIGN_OR_RETURN(
+      Function * function,
+      FindFunction(function_name, globals->dslx->module.get(), package));
+  if (function == nullptr) {
+    return absl::OkStatus();
+  }
+
+  std::vector<Type*> param_types;
+  for (Param* param : function->params()) {
+    param_types.push_back(param->GetType());
+  }
+  absl::StatusOr<Value> args =
+      Parser::ParseValue(arguments, package->GetTupleType(param_types));
+  if (!args.ok()) {
+    std::cout << "Could not parse arguments of type "
+              << package->GetTupleType(param_types)->ToString() << ": "
+              << args.status() << "\n";
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<InterpreterResult<Value>> result;
+  if (++globals->run_counts[function->name()] == 1) {
+    result = InterpretFunction(function, args->elements());
+  } else {
+    std::unique_ptr<FunctionJit>& jit = globals->jits[function->name()];
+    if (jit == nullptr) {
+      XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(function));
+    }
+    result = jit->Run(args->elements());
+  }
+  if (!result.ok()) {
+    std::cout << result.status() << "\n";
+    return absl::OkStatus();
+  }
+  for (const std::string& trace : result->events.trace_msgs) {
+    std::cout << "trace: " << trace << "\n";
+  }
+  for (const std::string& assert_msg : result->events.assert_msgs) {
+    std::cout << "assertion failed: " << assert_msg << "\n";
+  }
+  std::cout << result->value.ToString() << "\n";
+  return absl::OkStatus();
+}
+
 absl::Status RealMain(std::string_view dslx_path,
                       std::filesystem::path history_path) {
   Globals* globals = GetSingletonGlobals();
@@ -477,7 +593,7 @@ absl::Status RealMain(std::string_view dslx_path,
 
   globals->dslx_path = dslx_path;
   globals->command_trie = Trie{{":help", ":quit", ":reload", ":reset", ":ir",
-                                ":verilog", ":llvm", ":type "}};
+                                ":verilog", ":llvm", ":type ", ":run "}};
 
   XLS_RETURN_IF_ERROR(CommandReload());
 
@@ -495,6 +611,9 @@ absl::Status RealMain(std::string_view dslx_path,
   linenoiseHistoryLoad(history_path.c_str());
 
   while (true) {
+    // Show the output of the previous command before waiting for the next one,
+    // which matters when commands are piped in.
+    std::cout.flush();
     char* line_ptr = linenoise("xls> ");
     if (line_ptr == nullptr) {
       std::cout << "Ctrl-D received, quitting.\n";
@@ -546,6 +665,11 @@ absl::Status RealMain(std::string_view dslx_path,
         XLS_RETURN_IF_ERROR(CommandType(command->arguments[0]));
         break;
       }
+      case CommandName::kRun: {
+        XLS_RETURN_IF_ERROR(
+            CommandRun(command->arguments[0], command->arguments[1]));
+        break;
+      }
     }
   }
 
@@ -0,0 +1,90 @@
+# Copyright 2022 The XLS Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Tests for xls.tools.repl."""
+
+import os
+import subprocess
+
+from xls.common import runfiles
+from absl.testing import absltest
+
+REPL_PATH = runfiles.get_path('xls/tools/repl')
+
+INCREMENT_DSLX = """fn main(x: u32) -> u32 { x + u32:1 }
+"""
+
+# Changes both the signature and the behavior of `main`.
+DOUBLE_DSLX = """fn main(x: u16) -> u16 { x * u16:2 }
+"""
+
+
+class ReplTest(absltest.TestCase):
+
+  def setUp(self):
+    super().setUp()
+    self.dslx_file = self.create_tempfile('main.x', content=INCREMENT_DSLX)
+    env = dict(os.environ)
+    env['XLS_HISTORY_PATH'] = self.create_tempfile().full_path
+    self.repl = subprocess.Popen([REPL_PATH, self.dslx_file.full_path],
+                                 stdin=subprocess.PIPE,
+                                 stdout=subprocess.PIPE,
+                                 env=env,
+                                 universal_newlines=True)
+    self.assertIn('Welcome', self.repl.stdout.readline())
+    self.assertIn('Successfully loaded', self.repl.stdout.readline())
+
+  def tearDown(self):
+    self.repl.stdin.write(':quit\n')
+    self.repl.stdin.close()
+    self.assertEqual(self.repl.wait(), 0)
+    self.repl.stdout.close()
+    super().tearDown()
+
+  def _command(self, command: str) -> str:
+    """Runs a command printing a single line and returns that line."""
+    self.repl.stdin.write(command + '\n')
+    self.repl.stdin.flush()
+    return self.repl.stdout.readline().strip()
+
+  def test_reload_unchanged_keeps_module(self):
+    self.assertEqual(self._command(':run main(41)'), 'bits[32]:42')
+    self.assertEqual(self._command(':run main(41)'), 'bits[32]:42')
+    self.assertIn('is unchanged', self._command(':reload'))
+    self.assertEqual(self._command(':run main(1)'), 'bits[32]:2')
+
+  def test_reload_after_edit_does_not_reuse_stale_ir_or_jit(self):
+    # The first run interprets main; the second compiles and runs a JIT.
+    self.assertEqual(self._command(':run main(41)'), 'bits[32]:42')
+    self.assertEqual(self._command(':run main(41)'), 'bits[32]:42')
+    self.assertIn('uN[32]', self._command(':type main'))
+
+    self.dslx_file.write_text(DOUBLE_DSLX)
+    self.assertIn('Successfully loaded', self._command(':reload'))
+    self.assertIn('uN[16]', self._command(':type main'))
+    # Arguments are parsed against the IR of the edited module, and both the
+    # interpreter and the JIT run its new body.
+    self.assertEqual(self._command(':run main(41)'), 'bits[16]:82')
+    self.assertEqual(self._command(':run main(41)'), 'bits[16]:82')
+    self.assertEqual(self._command(':run main(100)'), 'bits[16]:200')
+
+    # Editing back switches to a fresh IR and JIT again.
+    self.dslx_file.write_text(INCREMENT_DSLX)
+    self.assertIn('Successfully loaded', self._command(':reload'))
+    self.assertEqual(self._command(':run main(41)'), 'bits[32]:42')
+    self.assertEqual(self._command(':run main(41)'), 'bits[32]:42')
+
+
+if __name__ == '__main__':
+  absltest.main()
@@ -21,6 +21,7 @@
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/delay_model/delay_estimators.h"
+#include "xls/ir/op.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
 // LINT.IfChange
@@ -46,6 +47,17 @@ ABSL_FLAG(int64_t, period_relaxation_percent, 0,
           "count. See https://google.github.io/xls/scheduling for details.");
 ABSL_FLAG(int64_t, additional_input_delay_ps, 0,
           "The additional delay added to each receive node.");
+ABSL_FLAG(int64_t, clock_period_search_threads, 1,
+          "The number of candidate clock periods evaluated concurrently when "
+          "searching for the minimum clock period (i.e., when "
+          "--clock_period_ps is not given). Values greater than one use a "
+          "k-ary search which narrows the search interval by a factor of "
+          "(threads + 1) per round.");
+ABSL_FLAG(bool, sparse_timing_constraints, false,
+          "If true, the SDC scheduler derives its timing constraints only "
+          "from paths between nodes at most one clock period apart rather "
+          "than from all pairs of nodes. The set of feasible schedules is the "
+          "same but much less memory is required for large designs.");
 ABSL_FLAG(std::vector<std::string>, io_constraints, {},
           "A comma-separated list of IO constraints, each of which is "
           "specified by a literal like `foo:send:bar:recv:3:5` which means "
@@ -58,11 +70,22 @@ ABSL_FLAG(std::vector<std::string>, io_constraints, {},
           "If the special minimum/maximum value `none` is used, then "
           "the minimum latency will be the lowest representable int64_t, "
           "and likewise for maximum latency.");
+ABSL_FLAG(std::vector<std::string>, resource_sharing_constraints, {},
+          "A comma-separated list of resource sharing constraints, each of "
+          "which is specified by a literal like `umul:2` which means that the "
+          "umul operations share 2 functional units, each of which starts at "
+          "most one operation per cycle. A pipeline stage spanning II cycles "
+          "(see the initiation_interval attribute) may then contain at most "
+          "2 * II umul operations. Only supported by the SDC scheduler.");
 ABSL_FLAG(bool, receives_first_sends_last, false,
           "If true, this forces receives into the first cycle and sends into "
           "the last cycle.");
 ABSL_FLAG(int64_t, mutual_exclusion_z3_rlimit, -1,
           "Resource limit for solver in mutual exclusion pass");
+ABSL_FLAG(int64_t, mutual_exclusion_time_budget_ms, -1,
+          "Wall-clock time in milliseconds the mutual exclusion pass may spend "
+          "in the solver for each function or proc. Pairs of operations not "
+          "analyzed in time are not merged.");
 // LINT.ThenChange(
 //   //xls/build_rules/xls_codegen_rules.bzl,
 //   //docs_src/codegen_options.md
@@ -91,6 +114,12 @@ absl::StatusOr<SchedulingOptions> SetUpSchedulingOptions(Package* p) {
     scheduling_options.additional_input_delay_ps(
         absl::GetFlag(FLAGS_additional_input_delay_ps));
   }
+  if (absl::GetFlag(FLAGS_clock_period_search_threads) > 1) {
+    scheduling_options.clock_period_search_threads(
+        absl::GetFlag(FLAGS_clock_period_search_threads));
+  }
+  scheduling_options.sparse_timing_constraints(
+      absl::GetFlag(FLAGS_sparse_timing_constraints));
   for (const std::string& c : absl::GetFlag(FLAGS_io_constraints)) {
     std::vector<std::string> components = absl::StrSplit(c, ':');
     if (components.size() != 6) {
@@ -135,6 +164,19 @@ absl::StatusOr<SchedulingOptions> SetUpSchedulingOptions(Package* p) {
                             max_latency);
     scheduling_options.add_constraint(constraint);
   }
+  for (const std::string& c :
+       absl::GetFlag(FLAGS_resource_sharing_constraints)) {
+    std::vector<std::string> components = absl::StrSplit(c, ':');
+    int64_t unit_count;
+    if (components.size() != 2 ||
+        !absl::SimpleAtoi(components[1], &unit_count) || unit_count <= 0) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Could not parse resource sharing constraint: `%s`", c));
+    }
+    XLS_ASSIGN_OR_RETURN(Op op, StringToOp(components[0]));
+    scheduling_options.add_constraint(
+        ResourceSharingConstraint(op, unit_count));
+  }
   if (absl::GetFlag(FLAGS_receives_first_sends_last)) {
     scheduling_options.add_constraint(RecvsFirstSendsLastConstraint());
   }
@@ -143,6 +185,10 @@ absl::StatusOr<SchedulingOptions> SetUpSchedulingOptions(Package* p) {
     scheduling_options.mutual_exclusion_z3_rlimit(
         absl::GetFlag(FLAGS_mutual_exclusion_z3_rlimit));
   }
+  if (absl::GetFlag(FLAGS_mutual_exclusion_time_budget_ms) != -1) {
+    scheduling_options.mutual_exclusion_time_budget_ms(
+        absl::GetFlag(FLAGS_mutual_exclusion_time_budget_ms));
+  }
 
   if (p != nullptr) {
     for (const SchedulingConstraint& c : scheduling_options.constraints()) {
@@ -27,8 +27,12 @@ ABSL_DECLARE_FLAG(std::string, delay_model);
 ABSL_DECLARE_FLAG(int64_t, clock_margin_percent);
 ABSL_DECLARE_FLAG(int64_t, period_relaxation_percent);
 ABSL_DECLARE_FLAG(int64_t, additional_input_delay_ps);
+ABSL_DECLARE_FLAG(int64_t, clock_period_search_threads);
+ABSL_DECLARE_FLAG(bool, sparse_timing_constraints);
 ABSL_DECLARE_FLAG(std::vector<std::string>, scheduling_constraints);
+ABSL_DECLARE_FLAG(std::vector<std::string>, resource_sharing_constraints);
 ABSL_DECLARE_FLAG(int64_t, mutual_exclusion_z3_rlimit);
+ABSL_DECLARE_FLAG(int64_t, mutual_exclusion_time_budget_ms);
 
 namespace xls {
 
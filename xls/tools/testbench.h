@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <thread>  // NOLINT(build/c++11)
 #include <type_traits>
 
@@ -35,10 +36,10 @@ namespace xls {
 // periodically printed to the terminal, as this class' primary use is for
 // exploring large test spaces.
 //
-// Presently, work is parititioned uniformly across threads at startup. This can
-// lead to work imbalance if certain areas of the input space execute faster
-// than others. More advanced strategies can be explored in the future if this
-// becomes a problem.
+// Work is handed out in chunks: each thread claims a new chunk of the input
+// space from a shared cursor whenever it finishes its last one (see
+// TestbenchIndexRange), so threads that land on cheap areas of the input space
+// pick up the slack of those working through expensive ones.
 
 namespace internal {
 // Forward decl of common Testbench base class.
@@ -92,9 +93,10 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
         create_shard_(create_shard),
         compute_expected_(compute_expected),
         compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+    this->thread_create_fn_ = [this]() {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
+          &this->mutex_, &this->wake_me_, this->indices_.get(),
+          this->max_failures_,
           this->index_to_input_, create_shard_, compute_expected_,
           compute_actual_, this->compare_results_, this->log_errors_);
     };
@@ -124,9 +126,10 @@ class Testbench<InputT, ResultT, ShardDataT,
             compare_results, log_errors),
         compute_expected_(compute_expected),
         compute_actual_(compute_actual) {
-    this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
+    this->thread_create_fn_ = [this]() {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
-          &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
+          &this->mutex_, &this->wake_me_, this->indices_.get(),
+          this->max_failures_,
           this->index_to_input_, compute_expected_, compute_actual_,
           this->compare_results_, this->log_errors_);
     };
@@ -178,24 +181,12 @@ class TestbenchBase {
     mutex_.Lock();
     started_ = true;
 
-    // Set up all the workers.
-    uint64_t chunk_size = (end_ - start_) / num_threads_;
-    uint64_t chunk_remainder =
-        chunk_size == 0 ? (end_ - start_) : (end_ - start_) % chunk_size;
-    uint64_t first = 0;
-    uint64_t last;
+    // Set up all the workers, which claim their work from the shared range.
+    indices_ =
+        std::make_unique<TestbenchIndexRange>(start_, end_, num_threads_);
     for (int i = 0; i < num_threads_; i++) {
-      last = first + chunk_size;
-      // Distribute any remainder evenly amongst the threads.
-      if (chunk_remainder > 0) {
-        last++;
-        chunk_remainder--;
-      }
-
-      threads_.push_back(thread_create_fn_(first, last));
+      threads_.push_back(thread_create_fn_());
       threads_.back()->Run();
-
-      first = last + 1;
     }
 
     // Wait for all to be ready.
@@ -266,33 +257,28 @@ class TestbenchBase {
   // How many seconds to wait before printing status (at most).
   static constexpr absl::Duration kPrintInterval = absl::Seconds(5);
 
-  // Prints the current execution status across all threads.
+  // Prints the current execution status across all threads. The per-thread
+  // counts are atomics written only by their threads, so reading them takes no
+  // locks and never stalls the workers.
   void PrintStatus() {
-    // Get the remainder-adjusted chunk size for this thread.
-    auto thread_chunk_size = [this](int thread_index) {
-      uint64_t total_size = end_ - start_;
-      uint64_t chunk_size = total_size / threads_.size();
-      uint64_t remainder =
-          chunk_size == 0 ? total_size : total_size % chunk_size;
-      if (thread_index < remainder) {
-        chunk_size++;
-      }
-      return chunk_size;
-    };
-
-    // Ignore remainder issues here. It shouldn't matter much at all.
     absl::Time now = absl::Now();
     auto delta = now - start_time_;
+    uint64_t total_size = end_ - start_;
     uint64_t total_done = 0;
     for (int64_t i = 0; i < threads_.size(); ++i) {
       uint64_t num_passes = threads_[i]->num_passes();
       uint64_t num_failures = threads_[i]->num_failures();
       uint64_t thread_done = num_passes + num_failures;
-      uint64_t chunk_size = thread_chunk_size(i);
       total_done += thread_done;
+      // With dynamic partitioning, a thread's progress is its share of all the
+      // samples rather than of a fixed slice.
       std::cout << absl::StreamFormat(
-                       "thread %02d: %f%% @ %.1f us/sample :: failures %d", i,
-                       static_cast<double>(thread_done) / chunk_size * 100.0,
+                       "thread %02d: %d samples (%f%% of total) @ %.1f "
+                       "us/sample :: failures %d",
+                       i, thread_done,
+                       total_size == 0 ? 0.0
+                                       : static_cast<double>(thread_done) /
+                                             total_size * 100.0,
                        absl::ToDoubleMicroseconds(delta) / thread_done,
                        num_failures)
                 << "\n";
@@ -300,7 +286,7 @@ class TestbenchBase {
     double done_per_second = delta == absl::ZeroDuration()
                                  ? 0.0
                                  : total_done / absl::ToDoubleSeconds(delta);
-    int64_t remaining = end_ - start_ - total_done;
+    int64_t remaining = total_size - total_done;
     auto estimate = absl::Seconds(
         done_per_second == 0.0 ? 0.0 : remaining / done_per_second);
     double throughput_this_print =
@@ -334,8 +320,11 @@ class TestbenchBase {
   std::function<bool(ResultT, ResultT)> compare_results_;
   std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors_;
 
+  // The index space shared by the worker threads; created by Run().
+  std::unique_ptr<TestbenchIndexRange> indices_;
+
   using ThreadT = TestbenchThread<InputT, ResultT, ShardDataT>;
-  std::function<std::unique_ptr<ThreadT>(uint64_t, uint64_t)> thread_create_fn_;
+  std::function<std::unique_ptr<ThreadT>()> thread_create_fn_;
   std::vector<std::unique_ptr<ThreadT>> threads_;
 
   // The main thread sleeps while tests are running. As worker threads finish,
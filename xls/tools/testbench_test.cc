@@ -0,0 +1,89 @@
+// Copyright 2022 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/testbench.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+TEST(TestbenchIndexRangeTest, ChunksCoverRange) {
+  TestbenchIndexRange indices(/*start=*/10, /*end=*/100000, /*num_threads=*/4);
+  EXPECT_EQ(indices.size(), 99990);
+  uint64_t first;
+  uint64_t last;
+  uint64_t expected_first = 10;
+  uint64_t previous_size = TestbenchIndexRange::kMaxChunkSize;
+  while (indices.NextChunk(&first, &last)) {
+    EXPECT_EQ(first, expected_first);
+    EXPECT_LT(first, last);
+    // Chunks shrink as the range is consumed.
+    EXPECT_LE(last - first, previous_size);
+    previous_size = last - first;
+    expected_first = last;
+  }
+  EXPECT_EQ(expected_first, 100000);
+  EXPECT_FALSE(indices.NextChunk(&first, &last));
+}
+
+TEST(TestbenchIndexRangeTest, EmptyRange) {
+  TestbenchIndexRange indices(/*start=*/5, /*end=*/5, /*num_threads=*/2);
+  uint64_t first;
+  uint64_t last;
+  EXPECT_FALSE(indices.NextChunk(&first, &last));
+}
+
+TEST(TestbenchTest, EachIndexEvaluatedOnce) {
+  constexpr uint64_t kStart = 1000;
+  constexpr uint64_t kEnd = 200000;
+  std::vector<std::atomic<int>> counts(kEnd);
+  Testbench<uint64_t, uint64_t> testbench(
+      kStart, kEnd, /*num_threads=*/8, /*max_failures=*/1,
+      /*index_to_input=*/[](uint64_t index) { return index; },
+      /*compute_expected=*/
+      [&](uint64_t input) {
+        counts[input].fetch_add(1);
+        return input;
+      },
+      /*compute_actual=*/[](uint64_t input) { return input; },
+      /*compare_results=*/[](uint64_t a, uint64_t b) { return a == b; },
+      /*log_errors=*/[](int64_t, uint64_t, uint64_t, uint64_t) {});
+  XLS_ASSERT_OK(testbench.Run());
+  for (uint64_t i = 0; i < kEnd; ++i) {
+    ASSERT_EQ(counts[i].load(), i < kStart ? 0 : 1) << i;
+  }
+}
+
+TEST(TestbenchTest, MismatchReported) {
+  Testbench<uint64_t, uint64_t> testbench(
+      /*start=*/0, /*end=*/10000, /*num_threads=*/4, /*max_failures=*/1,
+      /*index_to_input=*/[](uint64_t index) { return index; },
+      /*compute_expected=*/[](uint64_t input) { return input; },
+      /*compute_actual=*/
+      [](uint64_t input) { return input == 4321 ? 0 : input; },
+      /*compare_results=*/[](uint64_t a, uint64_t b) { return a == b; },
+      /*log_errors=*/[](int64_t, uint64_t, uint64_t, uint64_t) {});
+  EXPECT_FALSE(testbench.Run().ok());
+}
+
+}  // namespace
+}  // namespace xls
@@ -15,6 +15,9 @@
 #ifndef XLS_TOOLS_TESTBENCH_THREAD_H_
 #define XLS_TOOLS_TESTBENCH_THREAD_H_
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 
 #include "absl/status/status.h"
@@ -26,12 +29,63 @@
 
 namespace xls {
 
+// TestbenchIndexRange hands out chunks of the index space [start, end) to
+// worker threads as they ask for them, so threads that draw cheap inputs take
+// on more of the work than those stuck on expensive ones.
+//
+// Chunk sizes shrink as the range is consumed ("guided" scheduling): early
+// chunks are large to keep contention on the shared cursor negligible, while
+// the last ones are small so that all threads finish at about the same time.
+class TestbenchIndexRange {
+ public:
+  // Bounds on the number of indices in a chunk (the last chunk may be
+  // smaller).
+  static constexpr uint64_t kMinChunkSize = 256;
+  static constexpr uint64_t kMaxChunkSize = uint64_t{1} << 20;
+
+  TestbenchIndexRange(uint64_t start, uint64_t end, int64_t num_threads)
+      : start_(start),
+        end_(std::max(start, end)),
+        num_threads_(std::max(num_threads, int64_t{1})),
+        next_(start_) {}
+
+  // Claims the next chunk, as [*first, *last). Returns false once the range is
+  // exhausted. Thread-safe and lock-free.
+  bool NextChunk(uint64_t* first, uint64_t* last) {
+    uint64_t next = next_.load(std::memory_order_relaxed);
+    uint64_t chunk_size;
+    do {
+      if (next >= end_) {
+        return false;
+      }
+      // Each thread gets about a quarter of its fair share of what is left.
+      chunk_size = std::clamp<uint64_t>((end_ - next) / (4 * num_threads_),
+                                        kMinChunkSize, kMaxChunkSize);
+      chunk_size = std::min(chunk_size, end_ - next);
+    } while (!next_.compare_exchange_weak(next, next + chunk_size,
+                                          std::memory_order_relaxed));
+    *first = next;
+    *last = next + chunk_size;
+    return true;
+  }
+
+  // The number of indices in the whole range.
+  uint64_t size() const { return end_ - start_; }
+
+ private:
+  const uint64_t start_;
+  const uint64_t end_;
+  const uint64_t num_threads_;
+  std::atomic<uint64_t> next_;
+};
+
 template <typename InputT, typename ResultT, typename ShardDataT>
 class TestbenchThreadBase;
 
 // TestbenchThread handles the work of _actually_ running tests.
-// It simply iterates over its given range of the index space and calls the
-// expected/actual calculators.
+// It repeatedly claims a chunk of the index space from the shared
+// TestbenchIndexRange and calls the expected/actual calculators on each index
+// in it.
 //
 // Just as with Testbench, TestbenchThread supports execution both with and
 // without per-shard data, and uses the same type of construct to expose an API
@@ -45,6 +99,7 @@ class TestbenchThread
   // All specified functions must be thread-safe.
   //  - wake_parent_mutex: A mutex that protects:
   //  - wake_parent: A condvar to kick the parent when this thread has finished.
+  //  - indices: The index space shared by all threads of the testbench.
   //  - max_failures: The number of failures that will cause us to bail out.
   //                  If 0, then there will be no limit.
   //  - index_to_input: A function that can convert an index to an input to the
@@ -54,7 +109,7 @@ class TestbenchThread
   //                     under test.
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchIndexRange* indices, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<std::unique_ptr<ShardDataT>()> create_shard,
       std::function<ResultT(ShardDataT*, InputT)> generate_expected,
@@ -62,8 +117,8 @@ class TestbenchThread
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            wake_parent_mutex, wake_parent, indices, max_failures,
+            index_to_input, compare_results, log_errors),
         create_shard_fn_(create_shard),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
@@ -94,15 +149,15 @@ class TestbenchThread<
  public:
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchIndexRange* indices, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<ResultT(InputT)> generate_expected,
       std::function<ResultT(InputT)> generate_actual,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
-            wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            wake_parent_mutex, wake_parent, indices, max_failures,
+            index_to_input, compare_results, log_errors),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
     this->generate_expected_fn_ = [this](InputT& input) {
@@ -127,7 +182,7 @@ class TestbenchThreadBase {
  public:
   TestbenchThreadBase(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
-      uint64_t start_index, uint64_t end_index, uint64_t max_failures,
+      TestbenchIndexRange* indices, uint64_t max_failures,
       std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
@@ -137,8 +192,7 @@ class TestbenchThreadBase {
         running_(false),
         ready_(false),
         start_(false),
-        start_index_(start_index),
-        end_index_(end_index),
+        indices_(indices),
         max_failures_(max_failures),
         num_passes_(0),
         num_failures_(0),
@@ -151,6 +205,9 @@ class TestbenchThreadBase {
   // Starts the thread. Silently returns if it's already running.
   // If the tax of calling index_to_input_ every iter is too high, we can
   // specialize this for simple cases, like uint64_t -> uint64_t.
+  // This is a dedicated thread rather than a task of the shared pool: it spins
+  // until the parent's start signal, which only comes once every thread has
+  // initialized, so pool tasks could wait forever for a worker.
   void Run() {
     if (thread_) {
       return;
@@ -173,27 +230,7 @@ class TestbenchThreadBase {
     }
 
     running_.store(true);
-    for (uint64_t i = start_index_; i < end_index_; i++) {
-      // Don't check for cancelled on every iteration; it's a touch slow.
-      if (i % 128 == 0 && cancelled_.load()) {
-        return_status = absl::CancelledError("This thread was cancelled.");
-        break;
-      }
-
-      InputT input = index_to_input_(i);
-      ResultT expected = generate_expected_fn_(input);
-      ResultT actual = generate_actual_fn_(input);
-      if (!compare_results_(expected, actual)) {
-        num_failures_.store(num_failures_.load() + 1);
-        log_errors_(i, input, expected, actual);
-        if (max_failures_ <= num_failures_.load()) {
-          return_status = absl::UnknownError("Maximum error count reached.");
-          break;
-        }
-      } else {
-        num_passes_.store(num_passes_.load() + 1);
-      }
-    }
+    return_status = RunChunks();
 
     running_.store(false);
     {
@@ -203,6 +240,40 @@ class TestbenchThreadBase {
     this->WakeParent();
   }
 
+  // Processes chunks of the index space until it is exhausted, this thread is
+  // cancelled, or too many failures occur.
+  absl::Status RunChunks() {
+    uint64_t first;
+    uint64_t last;
+    while (indices_->NextChunk(&first, &last)) {
+      for (uint64_t i = first; i < last; i++) {
+        // Don't check for cancelled on every iteration; it's a touch slow.
+        if (i % 128 == 0 && cancelled_.load(std::memory_order_relaxed)) {
+          return absl::CancelledError("This thread was cancelled.");
+        }
+
+        InputT input = index_to_input_(i);
+        ResultT expected = generate_expected_fn_(input);
+        ResultT actual = generate_actual_fn_(input);
+        // Only this thread writes the counts, so they need no read-modify-write
+        // atomics; the parent reads them without locking to report progress.
+        if (!compare_results_(expected, actual)) {
+          uint64_t num_failures =
+              num_failures_.load(std::memory_order_relaxed) + 1;
+          num_failures_.store(num_failures, std::memory_order_relaxed);
+          log_errors_(i, input, expected, actual);
+          if (max_failures_ <= num_failures) {
+            return absl::UnknownError("Maximum error count reached.");
+          }
+        } else {
+          num_passes_.store(num_passes_.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
   // Do any one-time initialization. In practice, this is initializing shard
   // data.
   virtual void Init() {}
@@ -253,8 +324,8 @@ class TestbenchThreadBase {
   std::atomic<bool> ready_;
   std::atomic<bool> start_;
 
-  uint64_t start_index_;
-  uint64_t end_index_;
+  // Parent-owned; shared with the other threads.
+  TestbenchIndexRange* indices_;
 
   // Bookkeeping data.
   uint64_t max_failures_;
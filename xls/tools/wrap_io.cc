@@ -14,6 +14,7 @@
 
 #include "xls/tools/wrap_io.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include "absl/status/statusor.h"
@@ -103,6 +104,117 @@ absl::Status InstantiateFixedLatencyDeviceFunction(
   return absl::OkStatus();
 }
 
+// Instantiates the given device function module which is a pipeline accepting
+// a new input every cycle, streaming transactions through it back-to-back.
+//
+// An input is passed to the pipeline as soon as it is received, and its result
+// is pushed into an output FIFO `latency` cycles later, as tracked by a shift
+// register of valid bits. Inputs are only accepted while the FIFO has room for
+// the results of all the transactions in flight: a credit counter starts at
+// the FIFO depth, and is decremented when an input is accepted and
+// incremented when a result leaves the FIFO.
+absl::Status InstantiateStreamingDeviceFunction(
+    const ModuleSignature& signature, LogicRef* clk, LogicRef* rst_n,
+    ReadyValid input, ReadyValid output, int64_t latency, Module* m) {
+  XLS_RET_CHECK_EQ(signature.data_inputs().size(), 1);
+  XLS_RET_CHECK_EQ(signature.data_outputs().size(), 1);
+  XLS_RET_CHECK_GE(latency, 1);
+  const PortProto& input_port = signature.data_inputs().front();
+  const PortProto& output_port = signature.data_outputs().front();
+  const int64_t output_bits = signature.TotalDataOutputBits();
+
+  VerilogFile* f = m->file();
+  const int64_t fifo_depth = std::max(latency + 1, kStreamingWindow);
+  XLS_ASSIGN_OR_RETURN(Module * fifo_m,
+                       OutputFifoModule(output_bits, fifo_depth, f));
+
+  LogicRef* input_fire =
+      m->AddWire("input_fire", f->ScalarType(SourceInfo()), SourceInfo());
+  LogicRef* output_fire =
+      m->AddWire("output_fire", f->ScalarType(SourceInfo()), SourceInfo());
+  m->Add<ContinuousAssignment>(
+      SourceInfo(), input_fire,
+      f->LogicalAnd(input.valid, input.ready, SourceInfo()));
+  m->Add<ContinuousAssignment>(
+      SourceInfo(), output_fire,
+      f->LogicalAnd(output.valid, output.ready, SourceInfo()));
+
+  // The number of further transactions for whose results there is room in the
+  // FIFO.
+  const int64_t credit_bits = Bits::MinBitCountUnsigned(fifo_depth);
+  LogicRef* credits =
+      m->AddReg("credits", f->BitVectorType(credit_bits, SourceInfo()),
+                SourceInfo(),
+                /*init=*/f->Literal(fifo_depth, credit_bits, SourceInfo()));
+  Expression* credits_next = f->Ternary(
+      f->LogicalAnd(input_fire, f->LogicalNot(output_fire, SourceInfo()),
+                    SourceInfo()),
+      f->Sub(credits, f->PlainLiteral(1, SourceInfo()), SourceInfo()),
+      f->Ternary(
+          f->LogicalAnd(f->LogicalNot(input_fire, SourceInfo()), output_fire,
+                        SourceInfo()),
+          f->Add(credits, f->PlainLiteral(1, SourceInfo()), SourceInfo()),
+          credits, SourceInfo()),
+      SourceInfo());
+
+  // Bit i is set if the pipeline holds a transaction accepted i + 1 cycles ago.
+  LogicRef* in_flight =
+      m->AddReg("in_flight", f->BitVectorType(latency, SourceInfo()),
+                SourceInfo(), /*init=*/f->Literal(0, latency, SourceInfo()));
+  Expression* in_flight_next =
+      latency == 1
+          ? static_cast<Expression*>(input_fire)
+          : f->Concat({f->Slice(in_flight, latency - 2, 0, SourceInfo()),
+                       input_fire},
+                      SourceInfo());
+
+  auto af = m->Add<AlwaysFlop>(
+      SourceInfo(), clk,
+      Reset{rst_n, /*asynchronous=*/false, /*active_low=*/true});
+  af->AddRegister(credits, credits_next, SourceInfo(),
+                  f->Literal(fifo_depth, credit_bits, SourceInfo()));
+  af->AddRegister(in_flight, in_flight_next, SourceInfo(),
+                  f->Literal(0, latency, SourceInfo()));
+
+  m->Add<ContinuousAssignment>(
+      SourceInfo(), input.ready,
+      f->NotEquals(credits, f->PlainLiteral(0, SourceInfo()), SourceInfo()));
+
+  LogicRef* device_output = m->AddWire(
+      "device_output", f->BitVectorType(output_bits, SourceInfo()),
+      SourceInfo());
+  std::vector<Connection> connections;
+  if (signature.proto().has_clock_name()) {
+    connections.push_back({signature.proto().clock_name(), clk});
+  }
+  if (signature.proto().has_reset()) {
+    XLS_RET_CHECK(signature.proto().reset().active_low());
+    connections.push_back({signature.proto().reset().name(), rst_n});
+  }
+  connections.push_back({input_port.name(), input.data});
+  connections.push_back({output_port.name(), device_output});
+  m->Add<Instantiation>(SourceInfo(), signature.module_name(),
+                        "device_function",
+                        /*parameters=*/std::vector<Connection>{},
+                        /*connections=*/connections);
+
+  {
+    std::vector<Connection> connections;
+    connections.push_back(Connection{"clk", clk});
+    connections.push_back(Connection{"rst_n", rst_n});
+    connections.push_back(Connection{"data_in", device_output});
+    connections.push_back(Connection{
+        "data_in_valid", f->Index(in_flight, latency - 1, SourceInfo())});
+    connections.push_back(Connection{"data_out", output.data});
+    connections.push_back(Connection{"data_out_valid", output.valid});
+    connections.push_back(Connection{"data_out_ready", output.ready});
+    m->Add<Instantiation>(SourceInfo(), fifo_m->name(), "output_fifo",
+                          /*parameters=*/absl::Span<const Connection>(),
+                          connections);
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::StatusOr<Module*> WrapIO(std::string_view module_name,
@@ -200,7 +312,13 @@ absl::StatusOr<Module*> WrapIO(std::string_view module_name,
   ReadyValid input{flat_input_ready, flat_input_valid, flat_input};
   ReadyValid output{flat_output_ready, flat_output_valid, flat_output};
 
-  if (signature.proto().has_pipeline()) {
+  if (signature.proto().has_pipeline() &&
+      signature.proto().pipeline().initiation_interval() == 1 &&
+      !signature.proto().pipeline().has_pipeline_control()) {
+    XLS_RETURN_IF_ERROR(InstantiateStreamingDeviceFunction(
+        signature, clk, rst_n, input, output,
+        signature.proto().pipeline().latency(), io_wrapper));
+  } else if (signature.proto().has_pipeline()) {
     XLS_RETURN_IF_ERROR(InstantiateFixedLatencyDeviceFunction(
         signature, clk, rst_n, input, output,
         signature.proto().pipeline().latency(), io_wrapper));
@@ -661,5 +779,107 @@ absl::StatusOr<Module*> OutputControllerModule(const ModuleSignature& signature,
   return m;
 }
 
+absl::StatusOr<Module*> OutputFifoModule(int64_t bit_count, int64_t depth,
+                                         VerilogFile* f) {
+  XLS_RET_CHECK_GE(depth, 1);
+  Module* m = f->AddModule("output_fifo", SourceInfo());
+  LogicRef* clk = m->AddInput("clk", f->ScalarType(SourceInfo()), SourceInfo());
+  LogicRef* rst_n =
+      m->AddInput("rst_n", f->ScalarType(SourceInfo()), SourceInfo());
+  LogicRef* data_in = m->AddInput(
+      "data_in", f->BitVectorType(bit_count, SourceInfo()), SourceInfo());
+  LogicRef* data_in_valid =
+      m->AddInput("data_in_valid", f->ScalarType(SourceInfo()), SourceInfo());
+  LogicRef* data_out = m->AddOutput(
+      "data_out", f->BitVectorType(bit_count, SourceInfo()), SourceInfo());
+  LogicRef* data_out_valid =
+      m->AddOutput("data_out_valid", f->ScalarType(SourceInfo()), SourceInfo());
+  LogicRef* data_out_ready =
+      m->AddInput("data_out_ready", f->ScalarType(SourceInfo()), SourceInfo());
+
+  // A circular buffer of `depth` entries with read and write pointers, and a
+  // count of the entries held.
+  LogicRef* entries = m->AddReg(
+      "entries", f->UnpackedArrayType(bit_count, {depth}, SourceInfo()),
+      SourceInfo());
+  const int64_t pointer_bits =
+      std::max(int64_t{1}, Bits::MinBitCountUnsigned(depth - 1));
+  const int64_t count_bits = Bits::MinBitCountUnsigned(depth);
+  LogicRef* read_pointer =
+      m->AddReg("read_pointer", f->BitVectorType(pointer_bits, SourceInfo()),
+                SourceInfo(),
+                /*init=*/f->Literal(0, pointer_bits, SourceInfo()));
+  LogicRef* write_pointer =
+      m->AddReg("write_pointer", f->BitVectorType(pointer_bits, SourceInfo()),
+                SourceInfo(),
+                /*init=*/f->Literal(0, pointer_bits, SourceInfo()));
+  LogicRef* count =
+      m->AddReg("count", f->BitVectorType(count_bits, SourceInfo()),
+                SourceInfo(), /*init=*/f->Literal(0, count_bits, SourceInfo()));
+
+  LogicRef* push =
+      m->AddWire("push", f->ScalarType(SourceInfo()), SourceInfo());
+  LogicRef* pop = m->AddWire("pop", f->ScalarType(SourceInfo()), SourceInfo());
+  m->Add<ContinuousAssignment>(SourceInfo(), push, data_in_valid);
+  m->Add<ContinuousAssignment>(
+      SourceInfo(), pop,
+      f->LogicalAnd(data_out_valid, data_out_ready, SourceInfo()));
+
+  // Returns the pointer following `pointer`, wrapping around at `depth`.
+  auto increment = [&](LogicRef* pointer) -> Expression* {
+    return f->Ternary(
+        f->Equals(pointer, f->Literal(depth - 1, pointer_bits, SourceInfo()),
+                  SourceInfo()),
+        f->Literal(0, pointer_bits, SourceInfo()),
+        f->Add(pointer, f->PlainLiteral(1, SourceInfo()), SourceInfo()),
+        SourceInfo());
+  };
+  Expression* count_next = f->Ternary(
+      f->LogicalAnd(push, f->LogicalNot(pop, SourceInfo()), SourceInfo()),
+      f->Add(count, f->PlainLiteral(1, SourceInfo()), SourceInfo()),
+      f->Ternary(
+          f->LogicalAnd(f->LogicalNot(push, SourceInfo()), pop, SourceInfo()),
+          f->Sub(count, f->PlainLiteral(1, SourceInfo()), SourceInfo()),
+          count, SourceInfo()),
+      SourceInfo());
+
+  auto af = m->Add<AlwaysFlop>(
+      SourceInfo(), clk,
+      Reset{rst_n, /*asynchronous=*/false, /*active_low=*/true});
+  af->AddRegister(
+      read_pointer,
+      f->Ternary(pop, increment(read_pointer), read_pointer, SourceInfo()),
+      SourceInfo(), f->Literal(0, pointer_bits, SourceInfo()));
+  af->AddRegister(
+      write_pointer,
+      f->Ternary(push, increment(write_pointer), write_pointer, SourceInfo()),
+      SourceInfo(), f->Literal(0, pointer_bits, SourceInfo()));
+  af->AddRegister(count, count_next, SourceInfo(),
+                  f->Literal(0, count_bits, SourceInfo()));
+
+  // The entries are not reset.
+  //
+  //   always @ (posedge clk) begin
+  //     if (push) entries[write_pointer] <= data_in;
+  //   end
+  auto write = m->Add<Always>(
+      SourceInfo(), std::vector<SensitivityListElement>(
+                        {f->Make<PosEdge>(SourceInfo(), clk)}));
+  write->statements()
+      ->Add<Conditional>(SourceInfo(), push)
+      ->consequent()
+      ->Add<NonblockingAssignment>(
+          SourceInfo(), f->Index(entries, write_pointer, SourceInfo()),
+          data_in);
+
+  m->Add<ContinuousAssignment>(SourceInfo(), data_out,
+                               f->Index(entries, read_pointer, SourceInfo()));
+  m->Add<ContinuousAssignment>(
+      SourceInfo(), data_out_valid,
+      f->NotEquals(count, f->PlainLiteral(0, SourceInfo()), SourceInfo()));
+
+  return m;
+}
+
 }  // namespace verilog
 }  // namespace xls
@@ -15,6 +15,8 @@
 #ifndef XLS_TOOLS_WRAP_IO_H_
 #define XLS_TOOLS_WRAP_IO_H_
 
+#include <cstdint>
+
 #include "absl/status/statusor.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast.h"
@@ -51,6 +53,11 @@ enum IOEscapeCode : uint8_t {
   kEscapeByte = 0xff,
 };
 
+// The number of transactions a host may have in flight to a device function
+// wrapped with the streaming harness (see WrapIO) without stalling its input:
+// the harness buffers at least this many results.
+inline constexpr int64_t kStreamingWindow = 16;
+
 // Decorates a Verilog module, that represents an HLS-codegen'd function entry
 // point, with an I/O state machine.
 //
@@ -62,6 +69,13 @@ enum IOEscapeCode : uint8_t {
 // doesn't require any particular triggering), and after some latency L we know
 // the output data is ready to transmit back to the host as a response.
 //
+// If the device function is a pipeline which accepts a new input every cycle
+// (an initiation interval of one and no pipeline control), transactions are
+// instead streamed through it: each input is passed to the pipeline as soon as
+// it has been received, and the results are queued in a FIFO for transmission,
+// so the host may send up to kStreamingWindow transactions ahead of reading
+// their results.
+//
 // Args:
 //  module_name: Name of the module being instantiated as the "device function"
 //    that we're going to invoke. This should already be defined in the Verilog
@@ -110,6 +124,14 @@ absl::StatusOr<Module*> InputShiftRegisterModule(int64_t bit_count,
 absl::StatusOr<Module*> OutputControllerModule(const ModuleSignature& signature,
                                                VerilogFile* f);
 
+// Creates and returns the FIFO which buffers the results of the device function
+// in the streaming harness. The input is a valid-only interface: the producer
+// must not push into a full FIFO. The output has ready/valid flow control. This
+// is instantiated within WrapIO and is exposed in the header for testing
+// purposes.
+absl::StatusOr<Module*> OutputFifoModule(int64_t bit_count, int64_t depth,
+                                         VerilogFile* f);
+
 }  // namespace verilog
 }  // namespace xls
 
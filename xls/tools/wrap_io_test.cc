@@ -477,6 +477,91 @@ TEST_P(WrapIOTest, OutputControllerForSimpleComputation) {
   XLS_EXPECT_OK(tb.Run());
 }
 
+TEST_P(WrapIOTest, WrapIOStreamingPipelinedIncrement8b) {
+  VerilogFile file = NewVerilogFile();
+
+  // A two-stage pipeline which increments its input.
+  const std::string kWrappedModuleName = TestBaseName();
+  Module* wrapped_m = file.AddModule(kWrappedModuleName, SourceInfo());
+  LogicRef* m_clk =
+      wrapped_m->AddInput("clk", file.ScalarType(SourceInfo()), SourceInfo());
+  LogicRef* m_input = wrapped_m->AddInput(
+      "in", file.BitVectorType(8, SourceInfo()), SourceInfo());
+  LogicRef* m_output = wrapped_m->AddOutput(
+      "out", file.BitVectorType(8, SourceInfo()), SourceInfo());
+  LogicRef* p0 = wrapped_m->AddReg("p0", file.BitVectorType(8, SourceInfo()),
+                                   SourceInfo());
+  LogicRef* p1 = wrapped_m->AddReg("p1", file.BitVectorType(8, SourceInfo()),
+                                   SourceInfo());
+  auto af = wrapped_m->Add<AlwaysFlop>(SourceInfo(), m_clk);
+  af->AddRegister(
+      p0, file.Add(m_input, file.PlainLiteral(1, SourceInfo()), SourceInfo()),
+      SourceInfo());
+  af->AddRegister(p1, p0, SourceInfo());
+  wrapped_m->Add<ContinuousAssignment>(SourceInfo(), m_output, p1);
+
+  ModuleSignatureBuilder b(kWrappedModuleName);
+  b.WithClock("clk");
+  b.AddDataInputAsBits(m_input->GetName(), 8);
+  b.AddDataOutputAsBits(m_output->GetName(), 8);
+  b.WithPipelineInterface(/*latency=*/2, /*initiation_interval=*/1);
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleSignature signature, b.Build());
+
+  NullIOStrategy io_strategy;
+  XLS_ASSERT_OK_AND_ASSIGN(Module * m, WrapIO(kWrappedModuleName, "dtw",
+                                              signature, &io_strategy, &file));
+  EXPECT_NE(m, nullptr);
+  XLS_VLOG(1) << file.Emit();
+
+  // Send three transactions back-to-back before reading any result.
+  ModuleTestbench tb(m, GetSimulator(), "clk");
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleTestbenchThread * tbt, tb.CreateThread());
+  tbt->Set("byte_out_ready", 0).Set("byte_in_valid", 1);
+  tbt->Set("byte_in", 42).WaitForCycleAfter("byte_in_ready");
+  tbt->Set("byte_in", 100).WaitForCycleAfter("byte_in_ready");
+  tbt->Set("byte_in", 0).WaitForCycleAfter("byte_in_ready");
+  tbt->SetX("byte_in").Set("byte_in_valid", 0);
+
+  tbt->AtEndOfCycleWhen("byte_out_valid").ExpectEq("byte_out", 43);
+  tbt->Set("byte_out_ready", 1).NextCycle().Set("byte_out_ready", 0);
+  tbt->AtEndOfCycleWhen("byte_out_valid").ExpectEq("byte_out", 101);
+  tbt->Set("byte_out_ready", 1).NextCycle().Set("byte_out_ready", 0);
+  tbt->AtEndOfCycleWhen("byte_out_valid").ExpectEq("byte_out", 1);
+  tbt->Set("byte_out_ready", 1).NextCycle().Set("byte_out_ready", 0);
+
+  XLS_EXPECT_OK(tb.Run());
+}
+
+TEST_P(WrapIOTest, OutputFifo) {
+  VerilogFile file = NewVerilogFile();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Module * m, OutputFifoModule(/*bit_count=*/8, /*depth=*/2, &file));
+
+  ModuleTestbench tb(m, GetSimulator(), /*clk_name=*/"clk");
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleTestbenchThread * tbt, tb.CreateThread());
+  tbt->Set("rst_n", 0).Set("data_in_valid", 0).Set("data_out_ready", 0);
+  tbt->NextCycle();
+  tbt->Set("rst_n", 1);
+  tbt->AtEndOfCycle().ExpectEq("data_out_valid", 0);
+
+  // Fill the FIFO.
+  tbt->Set("data_in_valid", 1).Set("data_in", 0x11).NextCycle();
+  tbt->Set("data_in", 0x22).NextCycle();
+  tbt->Set("data_in_valid", 0).SetX("data_in");
+  tbt->AtEndOfCycle().ExpectEq("data_out_valid", 1).ExpectEq("data_out", 0x11);
+
+  // Drain it, pushing one more value as the pointers wrap around.
+  tbt->Set("data_out_ready", 1);
+  tbt->AtEndOfCycle().ExpectEq("data_out_valid", 1).ExpectEq("data_out", 0x11);
+  tbt->Set("data_in_valid", 1).Set("data_in", 0x33);
+  tbt->AtEndOfCycle().ExpectEq("data_out_valid", 1).ExpectEq("data_out", 0x22);
+  tbt->Set("data_in_valid", 0).SetX("data_in");
+  tbt->AtEndOfCycle().ExpectEq("data_out_valid", 1).ExpectEq("data_out", 0x33);
+  tbt->AtEndOfCycle().ExpectEq("data_out_valid", 0);
+
+  XLS_EXPECT_OK(tb.Run());
+}
+
 // Iverilog hangs when simulating some of these tests.
 // TODO(meheff): Add iverilog to the simulator list.
 INSTANTIATE_TEST_SUITE_P(WrapIOTestInstantiation, WrapIOTest,
@@ -16,7 +16,9 @@
 Exposes a text box to edit or cut-and-paste XLS IR to render as a graph.
 """
 
+import collections
 import functools
+import hashlib
 import json
 import os
 import subprocess
@@ -66,6 +68,12 @@ IR_EXAMPLES_FILE_LIST = 'xls/visualization/ir_viz/ir_examples_file_list.txt'
 webapp = flask.Flask('XLS UI')
 webapp.debug = True
 
+# Visualizers of the most recently posted large graphs, keyed by graph id (the
+# hash of the IR text). Each holds the parsed package and the cached per-node
+# data, so graphs are evicted least recently used first.
+MAX_CACHED_VISUALIZERS = 4
+visualizers = collections.OrderedDict()
+
 # Set of pre-canned examples as a list of (name, IR text) tuples. By default
 # these are loaded from IR_EXAMPLES_FILE_LIST unless --example_ir_dir is given.
 examples = []
@@ -243,6 +251,78 @@ def graph_handler():
   return jsonified
 
 
+def error_response(e: Exception):
+  return flask.jsonify({'error_code': 'error', 'message': str(e)})
+
+
+def get_visualizer(graph_id: str):
+  """Returns the cached visualizer of the given graph id or aborts with 404."""
+  if graph_id not in visualizers:
+    flask.abort(404)
+  visualizers.move_to_end(graph_id)
+  return visualizers[graph_id]
+
+
+@webapp.route('/graph/summary', methods=['POST'])
+def graph_summary_handler():
+  """Parses the posted text and returns the summary of its graphs.
+
+  Unlike /graph the response holds no nodes or edges; these are fetched piece
+  by piece with the neighborhood and stage handlers using the returned graph
+  id. This scales to functions with millions of nodes.
+
+  Returns:
+    Flask response.
+  """
+  text = flask.request.form['text']
+  graph_id = hashlib.sha256(text.encode('utf-8')).hexdigest()
+  try:
+    if graph_id in visualizers:
+      visualizer = get_visualizer(graph_id)
+    else:
+      visualizer = ir_to_json.IrVisualizer.create(text, FLAGS.delay_model,
+                                                  FLAGS.pipeline_stages,
+                                                  FLAGS.top)
+      visualizers[graph_id] = visualizer
+      while len(visualizers) > MAX_CACHED_VISUALIZERS:
+        visualizers.popitem(last=False)
+    json_text = visualizer.summary_json()
+  except Exception as e:  # pylint: disable=broad-except
+    return error_response(e)
+  return flask.jsonify({
+      'error_code': 'ok',
+      'graph_id': graph_id,
+      'graph': json.loads(json_text)
+  })
+
+
+@webapp.route('/graph/<graph_id>/<function_id>/neighborhood')
+def graph_neighborhood_handler(graph_id: str, function_id: str):
+  """Returns the nodes around the node given by the `node` query parameter."""
+  visualizer = get_visualizer(graph_id)
+  try:
+    json_text = visualizer.neighborhood_json(
+        function_id, flask.request.args['node'],
+        flask.request.args.get('radius', 2, type=int),
+        flask.request.args.get('max_nodes', 500, type=int))
+  except Exception as e:  # pylint: disable=broad-except
+    return error_response(e)
+  return flask.jsonify({'error_code': 'ok', 'graph': json.loads(json_text)})
+
+
+@webapp.route('/graph/<graph_id>/<function_id>/stage/<int:cycle>')
+def graph_stage_handler(graph_id: str, function_id: str, cycle: int):
+  """Returns a page of the nodes scheduled in the given cycle."""
+  visualizer = get_visualizer(graph_id)
+  try:
+    json_text = visualizer.stage_json(
+        function_id, cycle, flask.request.args.get('offset', 0, type=int),
+        flask.request.args.get('limit', 1000, type=int))
+  except Exception as e:  # pylint: disable=broad-except
+    return error_response(e)
+  return flask.jsonify({'error_code': 'ok', 'graph': json.loads(json_text)})
+
+
 def main(argv):
   if len(argv) > 1:
     raise app.UsageError('Too many command-line arguments.')
@@ -14,6 +14,10 @@
 
 #include "xls/visualization/ir_viz/ir_to_json.h"
 
+#include <algorithm>
+#include <deque>
+
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -27,10 +31,12 @@
 #include "xls/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/dfs_visitor.h"
+#include "xls/ir/node_iterator.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
 #include "xls/visualization/ir_viz/visualization.pb.h"
 #include "re2/re2.h"
 
@@ -125,15 +131,13 @@ std::optional<int64_t> MaybeGetStateParamIndex(Node* node) {
 // Returns the attributes of a node (e.g., the index value of a kTupleIndex
 // instruction) as a proto which is to be serialized to JSON.
 absl::StatusOr<viz::NodeAttributes> NodeAttributes(
-    Node* node,
-    const absl::flat_hash_map<Node*, CriticalPathEntry*>& critical_path_map,
+    Node* node, const absl::flat_hash_set<Node*>& critical_path_nodes,
     const QueryEngine& query_engine, const PipelineSchedule* schedule,
     const DelayEstimator& delay_estimator) {
   AttributeVisitor visitor;
   XLS_RETURN_IF_ERROR(node->VisitSingleNode(&visitor));
   viz::NodeAttributes attributes = visitor.attributes();
-  auto it = critical_path_map.find(node);
-  if (it != critical_path_map.end()) {
+  if (critical_path_nodes.contains(node)) {
     attributes.set_on_critical_path(true);
   }
   if (query_engine.IsTracked(node)) {
@@ -165,63 +169,143 @@ absl::StatusOr<viz::NodeAttributes> NodeAttributes(
   return attributes;
 }
 
-absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
-    FunctionBase* function, const DelayEstimator& delay_estimator,
-    const PipelineSchedule* schedule,
-    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
-  viz::FunctionBase proto;
-  proto.set_name(function->name());
+absl::StatusOr<std::string> FunctionBaseKind(FunctionBase* function) {
   if (function->IsFunction()) {
-    proto.set_kind("function");
-  } else if (function->IsProc()) {
-    proto.set_kind("proc");
-  } else {
-    XLS_RET_CHECK(function->IsBlock());
-    proto.set_kind("block");
+    return "function";
   }
-  proto.set_id(function_ids.at(function));
+  if (function->IsProc()) {
+    return "proc";
+  }
+  XLS_RET_CHECK(function->IsBlock());
+  return "block";
+}
+
+// Returns the nodes on the critical path of the function, or no nodes if the
+// critical path cannot be analyzed.
+absl::flat_hash_set<Node*> GetCriticalPathNodes(
+    FunctionBase* function, const DelayEstimator& delay_estimator) {
   absl::StatusOr<std::vector<CriticalPathEntry>> critical_path =
       AnalyzeCriticalPath(function, /*clock_period_ps=*/std::nullopt,
                           delay_estimator);
-  absl::flat_hash_map<Node*, CriticalPathEntry*> node_to_critical_path_entry;
+  absl::flat_hash_set<Node*> critical_path_nodes;
   if (critical_path.ok()) {
-    for (CriticalPathEntry& entry : critical_path.value()) {
-      node_to_critical_path_entry[entry.node] = &entry;
+    for (const CriticalPathEntry& entry : critical_path.value()) {
+      critical_path_nodes.insert(entry.node);
     }
   } else {
     XLS_LOG(WARNING) << "Could not analyze critical path for function: "
                      << critical_path.status();
   }
+  return critical_path_nodes;
+}
+
+absl::StatusOr<viz::Node> NodeToVisualizationProto(
+    Node* node, const absl::flat_hash_set<Node*>& critical_path_nodes,
+    const QueryEngine& query_engine, const PipelineSchedule* schedule,
+    const DelayEstimator& delay_estimator,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
+  viz::Node graph_node;
+  graph_node.set_name(node->GetName());
+  graph_node.set_id(GetNodeUniqueId(node, function_ids));
+  graph_node.set_opcode(OpToString(node->op()));
+  graph_node.set_ir(node->ToStringWithOperandTypes());
+  XLS_ASSIGN_OR_RETURN(*graph_node.mutable_attributes(),
+                       NodeAttributes(node, critical_path_nodes, query_engine,
+                                      schedule, delay_estimator));
+  return graph_node;
+}
+
+viz::Edge EdgeToVisualizationProto(
+    Node* operand, Node* node,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
+  viz::Edge graph_edge;
+  graph_edge.set_id(GetEdgeUniqueId(operand, node, function_ids));
+  graph_edge.set_source_id(GetNodeUniqueId(operand, function_ids));
+  graph_edge.set_target_id(GetNodeUniqueId(node, function_ids));
+  graph_edge.set_type(operand->GetType()->ToString());
+  graph_edge.set_bit_width(operand->GetType()->GetFlatBitCount());
+  return graph_edge;
+}
+
+absl::StatusOr<viz::FunctionBase> FunctionBaseToVisualizationProto(
+    FunctionBase* function, const DelayEstimator& delay_estimator,
+    const PipelineSchedule* schedule,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids) {
+  viz::FunctionBase proto;
+  proto.set_name(function->name());
+  XLS_ASSIGN_OR_RETURN(*proto.mutable_kind(), FunctionBaseKind(function));
+  proto.set_id(function_ids.at(function));
+  absl::flat_hash_set<Node*> critical_path_nodes =
+      GetCriticalPathNodes(function, delay_estimator);
 
   BddQueryEngine query_engine(BddFunction::kDefaultPathLimit);
   XLS_RETURN_IF_ERROR(query_engine.Populate(function).status());
 
   for (Node* node : function->nodes()) {
-    viz::Node* graph_node = proto.add_nodes();
-    graph_node->set_name(node->GetName());
-    graph_node->set_id(GetNodeUniqueId(node, function_ids));
-    graph_node->set_opcode(OpToString(node->op()));
-    graph_node->set_ir(node->ToStringWithOperandTypes());
     XLS_ASSIGN_OR_RETURN(
-        *graph_node->mutable_attributes(),
-        NodeAttributes(node, node_to_critical_path_entry, query_engine,
-                       schedule, delay_estimator));
+        *proto.add_nodes(),
+        NodeToVisualizationProto(node, critical_path_nodes, query_engine,
+                                 schedule, delay_estimator, function_ids));
   }
 
   for (Node* node : function->nodes()) {
-    for (int64_t i = 0; i < node->operand_count(); ++i) {
-      Node* operand = node->operand(i);
-      viz::Edge* graph_edge = proto.add_edges();
-      graph_edge->set_id(GetEdgeUniqueId(operand, node, function_ids));
-      graph_edge->set_source_id(GetNodeUniqueId(operand, function_ids));
-      graph_edge->set_target_id(GetNodeUniqueId(node, function_ids));
-      graph_edge->set_type(operand->GetType()->ToString());
-      graph_edge->set_bit_width(operand->GetType()->GetFlatBitCount());
+    for (Node* operand : node->operands()) {
+      *proto.add_edges() =
+          EdgeToVisualizationProto(operand, node, function_ids);
     }
   }
   return std::move(proto);
 }
 
+absl::StatusOr<std::string> ProtoToJson(
+    const google::protobuf::Message& proto) {
+  std::string serialized_json;
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.add_whitespace = true;
+  print_options.preserve_proto_field_names = true;
+
+  auto status =
+      google::protobuf::util::MessageToJsonString(proto, &serialized_json, print_options);
+  if (!status.ok()) {
+    return absl::InternalError(std::string{status.message()});
+  }
+  return serialized_json;
+}
+
+// Sets the fields of the package proto other than its function bases.
+absl::Status SetPackageFields(
+    Package* package, std::optional<std::string_view> entry_name,
+    const absl::flat_hash_map<FunctionBase*, std::string>& function_ids,
+    viz::Package* proto) {
+  proto->set_name(package->name());
+  XLS_ASSIGN_OR_RETURN(std::string ir_html, MarkUpIrText(package));
+  proto->set_ir_html(ir_html);
+  std::optional<FunctionBase*> entry_function_base;
+  if (entry_name.has_value()) {
+    for (FunctionBase* fb : package->GetFunctionBases()) {
+      if (fb->name() == entry_name.value()) {
+        entry_function_base = fb;
+      }
+    }
+  }
+  if (!entry_function_base.has_value()) {
+    entry_function_base = package->GetTop();
+  }
+  if (entry_function_base.has_value()) {
+    proto->set_entry_id(function_ids.at(entry_function_base.value()));
+  }
+  return absl::OkStatus();
+}
+
+// Function bases with more nodes than this are analyzed with the ternary
+// query engine rather than the (more precise but much slower) BDD query engine.
+constexpr int64_t kMaxBddNodeCount = 10000;
+
+// The distances between adjacent rows and columns of the layout computed for
+// partial graphs.
+constexpr double kLayoutRowSpacing = 100.0;
+constexpr double kLayoutColumnSpacing = 200.0;
+
 }  // namespace
 
 absl::StatusOr<std::string> IrToJson(
@@ -233,7 +317,6 @@ absl::StatusOr<std::string> IrToJson(
   absl::flat_hash_map<FunctionBase*, std::string> function_ids =
       GetFunctionIds(package);
 
-  std::optional<FunctionBase*> entry_function_base;
   for (FunctionBase* fb : package->GetFunctionBases()) {
     XLS_ASSIGN_OR_RETURN(
         *proto.add_function_bases(),
@@ -242,33 +325,236 @@ absl::StatusOr<std::string> IrToJson(
             schedule != nullptr && schedule->function_base() == fb ? schedule
                                                                    : nullptr,
             function_ids));
-    if (entry_name.has_value() && fb->name() == entry_name.value()) {
-      entry_function_base = fb;
+  }
+  XLS_RETURN_IF_ERROR(
+      SetPackageFields(package, entry_name, function_ids, &proto));
+  return ProtoToJson(proto);
+}
+
+IrVisualizer::IrVisualizer(std::unique_ptr<Package> package,
+                           const DelayEstimator& delay_estimator,
+                           std::optional<PipelineSchedule> schedule)
+    : package_(std::move(package)),
+      delay_estimator_(delay_estimator),
+      schedule_(std::move(schedule)),
+      function_ids_(GetFunctionIds(package_.get())) {}
+
+absl::StatusOr<std::string> IrVisualizer::SummaryJson(
+    std::optional<std::string_view> entry_name) {
+  viz::Package proto;
+  for (FunctionBase* fb : package_->GetFunctionBases()) {
+    viz::FunctionBase* fb_proto = proto.add_function_bases();
+    fb_proto->set_name(fb->name());
+    XLS_ASSIGN_OR_RETURN(*fb_proto->mutable_kind(), FunctionBaseKind(fb));
+    fb_proto->set_id(function_ids_.at(fb));
+    fb_proto->set_partial(true);
+    fb_proto->set_node_count(fb->node_count());
+    const PipelineSchedule* schedule = GetSchedule(fb);
+    std::vector<viz::StageSummary> stages;
+    if (schedule != nullptr) {
+      stages.resize(schedule->length());
+      for (int64_t cycle = 0; cycle < stages.size(); ++cycle) {
+        stages[cycle].set_cycle(cycle);
+      }
+    }
+    int64_t edge_count = 0;
+    for (Node* node : fb->nodes()) {
+      edge_count += node->operand_count();
+      if (schedule == nullptr) {
+        continue;
+      }
+      viz::StageSummary& stage = stages.at(schedule->cycle(node));
+      stage.set_node_count(stage.node_count() + 1);
+      for (Node* operand : node->operands()) {
+        if (schedule->cycle(operand) < schedule->cycle(node)) {
+          stage.set_incoming_edge_count(stage.incoming_edge_count() + 1);
+          stage.set_incoming_bit_count(stage.incoming_bit_count() +
+                                       operand->GetType()->GetFlatBitCount());
+        }
+      }
+    }
+    fb_proto->set_edge_count(edge_count);
+    for (viz::StageSummary& stage : stages) {
+      *fb_proto->add_stages() = std::move(stage);
     }
   }
-  proto.set_name(package->name());
-  XLS_ASSIGN_OR_RETURN(std::string ir_html, MarkUpIrText(package));
-  proto.set_ir_html(ir_html);
-  if (entry_function_base.has_value()) {
-    proto.set_entry_id(function_ids.at(entry_function_base.value()));
-  } else {
-    std::optional<FunctionBase*> top = package->GetTop();
-    if (top.has_value()) {
-      proto.set_entry_id(function_ids.at(top.value()));
+  XLS_RETURN_IF_ERROR(
+      SetPackageFields(package_.get(), entry_name, function_ids_, &proto));
+  return ProtoToJson(proto);
+}
+
+absl::StatusOr<std::string> IrVisualizer::NeighborhoodJson(
+    std::string_view function_id, std::string_view node_name, int64_t radius,
+    int64_t max_nodes) {
+  if (radius < 0 || max_nodes <= 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Invalid neighborhood radius %d or node limit %d.",
+                        radius, max_nodes));
+  }
+  XLS_ASSIGN_OR_RETURN(FunctionBase * function_base,
+                       GetFunctionBase(function_id));
+  XLS_ASSIGN_OR_RETURN(Node * focus, function_base->GetNode(node_name));
+  XLS_ASSIGN_OR_RETURN(const FunctionBaseView* view, GetView(function_base));
+
+  // Breadth-first search over the edges in either direction.
+  std::vector<Node*> nodes = {focus};
+  absl::flat_hash_set<Node*> visited = {focus};
+  std::deque<std::pair<Node*, int64_t>> worklist = {{focus, 0}};
+  auto visit = [&](Node* node, int64_t distance) {
+    if (nodes.size() < max_nodes && visited.insert(node).second) {
+      nodes.push_back(node);
+      worklist.push_back({node, distance});
+    }
+  };
+  while (!worklist.empty() && nodes.size() < max_nodes) {
+    auto [node, distance] = worklist.front();
+    worklist.pop_front();
+    if (distance == radius) {
+      continue;
+    }
+    for (Node* operand : node->operands()) {
+      visit(operand, distance + 1);
+    }
+    for (Node* user : node->users()) {
+      visit(user, distance + 1);
     }
   }
+  return PartialGraphJson(*view, std::move(nodes));
+}
 
-  std::string serialized_json;
-  google::protobuf::util::JsonPrintOptions print_options;
-  print_options.add_whitespace = true;
-  print_options.preserve_proto_field_names = true;
+absl::StatusOr<std::string> IrVisualizer::StageJson(
+    std::string_view function_id, int64_t cycle, int64_t offset,
+    int64_t limit) {
+  if (offset < 0 || limit < 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid stage node offset %d or limit %d.", offset, limit));
+  }
+  XLS_ASSIGN_OR_RETURN(FunctionBase * function_base,
+                       GetFunctionBase(function_id));
+  XLS_ASSIGN_OR_RETURN(const FunctionBaseView* view, GetView(function_base));
+  const PipelineSchedule* schedule = GetSchedule(function_base);
+  std::vector<Node*> nodes;
+  int64_t skipped = 0;
+  for (Node* node : view->nodes) {
+    if (nodes.size() >= limit) {
+      break;
+    }
+    if ((schedule == nullptr ? 0 : schedule->cycle(node)) != cycle) {
+      continue;
+    }
+    if (skipped < offset) {
+      ++skipped;
+      continue;
+    }
+    nodes.push_back(node);
+  }
+  return PartialGraphJson(*view, std::move(nodes));
+}
 
-  auto status =
-      google::protobuf::util::MessageToJsonString(proto, &serialized_json, print_options);
-  if (!status.ok()) {
-    return absl::InternalError(std::string{status.message()});
+absl::StatusOr<FunctionBase*> IrVisualizer::GetFunctionBase(
+    std::string_view function_id) {
+  for (const auto& [function_base, id] : function_ids_) {
+    if (id == function_id) {
+      return function_base;
+    }
   }
-  return serialized_json;
+  return absl::NotFoundError(
+      absl::StrFormat("No function base with id %s.", function_id));
+}
+
+const PipelineSchedule* IrVisualizer::GetSchedule(
+    FunctionBase* function_base) const {
+  if (schedule_.has_value() && schedule_->function_base() == function_base) {
+    return &schedule_.value();
+  }
+  return nullptr;
+}
+
+absl::StatusOr<const IrVisualizer::FunctionBaseView*> IrVisualizer::GetView(
+    FunctionBase* function_base) {
+  auto it = views_.find(function_base);
+  if (it != views_.end()) {
+    return it->second.get();
+  }
+  auto view = std::make_unique<FunctionBaseView>();
+  view->function_base = function_base;
+  view->nodes = TopoSort(function_base).AsVector();
+  view->edge_count = 0;
+
+  absl::flat_hash_set<Node*> critical_path_nodes =
+      GetCriticalPathNodes(function_base, delay_estimator_);
+  std::unique_ptr<QueryEngine> query_engine;
+  if (function_base->node_count() <= kMaxBddNodeCount) {
+    query_engine =
+        std::make_unique<BddQueryEngine>(BddFunction::kDefaultPathLimit);
+  } else {
+    query_engine = std::make_unique<TernaryQueryEngine>();
+  }
+  XLS_RETURN_IF_ERROR(query_engine->Populate(function_base).status());
+
+  // Layered layout: each node is placed in the row of its longest path from a
+  // node without operands, in topological order within the row.
+  std::vector<int64_t> rows(view->nodes.size());
+  std::vector<int64_t> row_sizes;
+  const PipelineSchedule* schedule = GetSchedule(function_base);
+  for (int64_t i = 0; i < view->nodes.size(); ++i) {
+    Node* node = view->nodes[i];
+    view->node_indices[node] = i;
+    view->edge_count += node->operand_count();
+    int64_t row = 0;
+    for (Node* operand : node->operands()) {
+      row = std::max(row, rows[view->node_indices.at(operand)] + 1);
+    }
+    rows[i] = row;
+    if (row >= row_sizes.size()) {
+      row_sizes.resize(row + 1, 0);
+    }
+    XLS_ASSIGN_OR_RETURN(
+        viz::Node node_proto,
+        NodeToVisualizationProto(node, critical_path_nodes, *query_engine,
+                                 schedule, delay_estimator_, function_ids_));
+    node_proto.mutable_position()->set_x(row_sizes[row]++ *
+                                         kLayoutColumnSpacing);
+    node_proto.mutable_position()->set_y(row * kLayoutRowSpacing);
+    view->node_protos.push_back(std::move(node_proto));
+  }
+  const FunctionBaseView* result = view.get();
+  views_[function_base] = std::move(view);
+  return result;
+}
+
+absl::StatusOr<std::string> IrVisualizer::PartialGraphJson(
+    const FunctionBaseView& view, std::vector<Node*> nodes) {
+  FunctionBase* function_base = view.function_base;
+  viz::FunctionBase proto;
+  proto.set_name(function_base->name());
+  XLS_ASSIGN_OR_RETURN(*proto.mutable_kind(), FunctionBaseKind(function_base));
+  proto.set_id(function_ids_.at(function_base));
+  proto.set_partial(true);
+  proto.set_node_count(view.nodes.size());
+  proto.set_edge_count(view.edge_count);
+
+  absl::flat_hash_set<Node*> included(nodes.begin(), nodes.end());
+  for (Node* node : nodes) {
+    viz::Node* node_proto = proto.add_nodes();
+    *node_proto = view.node_protos.at(view.node_indices.at(node));
+    int64_t hidden_edge_count = 0;
+    for (Node* operand : node->operands()) {
+      if (included.contains(operand)) {
+        *proto.add_edges() =
+            EdgeToVisualizationProto(operand, node, function_ids_);
+      } else {
+        ++hidden_edge_count;
+      }
+    }
+    for (Node* user : node->users()) {
+      if (!included.contains(user)) {
+        hidden_edge_count += user->OperandInstanceCount(node);
+      }
+    }
+    node_proto->set_hidden_edge_count(hidden_edge_count);
+  }
+  return ProtoToJson(proto);
 }
 
 // Wraps the given text in a span with the given id, classes, and data. The
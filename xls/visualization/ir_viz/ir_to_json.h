@@ -15,11 +15,21 @@
 #ifndef XLS_IR_VISUALIZATION_IR_TO_JSON_H_
 #define XLS_IR_VISUALIZATION_IR_TO_JSON_H_
 
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "xls/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
+#include "xls/visualization/ir_viz/visualization.pb.h"
 
 namespace xls {
 
@@ -31,6 +41,67 @@ absl::StatusOr<std::string> IrToJson(
     const PipelineSchedule* schedule = nullptr,
     std::optional<std::string_view> entry_name = std::nullopt);
 
+// Serves the visualization of a package piece by piece for packages too large
+// to be sent to (and laid out by) the browser as a single JSON document. The
+// JSON documents are based on the xls::viz protos like those of IrToJson, but
+// the function bases hold only part of their graph, with node positions from a
+// layout computed by the server. The nodes, their attributes and the layout of
+// each function base are computed on first use and cached.
+class IrVisualizer {
+ public:
+  // The schedule, if given, must be of a function base of `package`.
+  IrVisualizer(std::unique_ptr<Package> package,
+               const DelayEstimator& delay_estimator,
+               std::optional<PipelineSchedule> schedule = std::nullopt);
+
+  // Returns a JSON xls::viz::Package holding the marked up IR text and the
+  // summary of each function base (its node and edge counts and stages) but
+  // none of their nodes or edges.
+  absl::StatusOr<std::string> SummaryJson(
+      std::optional<std::string_view> entry_name = std::nullopt);
+
+  // Returns a JSON xls::viz::FunctionBase holding the nodes at most `radius`
+  // edges away from the node named `node_name`, nearest first and at most
+  // `max_nodes` of them, and the edges between them. `function_id` is the id
+  // of the function base in the summary.
+  absl::StatusOr<std::string> NeighborhoodJson(std::string_view function_id,
+                                               std::string_view node_name,
+                                               int64_t radius,
+                                               int64_t max_nodes);
+
+  // Returns a JSON xls::viz::FunctionBase holding the nodes scheduled in
+  // `cycle` (all nodes are in cycle 0 if the function base is not scheduled),
+  // the `limit` of them in topological order starting at `offset`, and the
+  // edges between them.
+  absl::StatusOr<std::string> StageJson(std::string_view function_id,
+                                        int64_t cycle, int64_t offset,
+                                        int64_t limit);
+
+ private:
+  // The cached nodes of a function base, in topological order.
+  struct FunctionBaseView {
+    FunctionBase* function_base;
+    std::vector<Node*> nodes;
+    std::vector<viz::Node> node_protos;
+    absl::flat_hash_map<Node*, int64_t> node_indices;
+    int64_t edge_count;
+  };
+
+  absl::StatusOr<FunctionBase*> GetFunctionBase(std::string_view function_id);
+  absl::StatusOr<const FunctionBaseView*> GetView(FunctionBase* function_base);
+  const PipelineSchedule* GetSchedule(FunctionBase* function_base) const;
+
+  // Returns the JSON partial graph of the view holding the given nodes.
+  absl::StatusOr<std::string> PartialGraphJson(const FunctionBaseView& view,
+                                               std::vector<Node*> nodes);
+
+  std::unique_ptr<Package> package_;
+  const DelayEstimator& delay_estimator_;
+  std::optional<PipelineSchedule> schedule_;
+  absl::flat_hash_map<FunctionBase*, std::string> function_ids_;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<FunctionBaseView>> views_;
+};
+
 // Return the IR text of the given package with HTML mark up. Various IR
 // constructs are wrapped in spans. This function is exposed only for testing as
 // the marked up IR is generally available in the JSON produced by IrToJson.
@@ -20,6 +20,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/memory/memory.h"
+#include "google/protobuf/util/json_util.h"
 #include "xls/common/golden_files.h"
 #include "xls/common/logging/logging.h"
 #include "xls/common/status/matchers.h"
@@ -29,11 +30,15 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
+#include "xls/visualization/ir_viz/visualization.pb.h"
 
 namespace xls {
 namespace {
 
+using status_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
 
 constexpr char kTestdataPath[] = "xls/visualization/ir_viz/testdata";
 
@@ -177,5 +182,133 @@ top proc the_proc(tkn: token, x: bits[32], y: bits[64], init={0, 42}) {
   ExpectEqualToGoldenFile(GoldenFilePath("htmltext"), html);
 }
 
+template <typename ProtoT>
+ProtoT ParseJson(std::string_view json) {
+  ProtoT proto;
+  auto status =
+      google::protobuf::util::JsonStringToMessage(std::string{json}, &proto);
+  XLS_CHECK(status.ok()) << json;
+  return proto;
+}
+
+std::vector<std::string> NodeNames(const viz::FunctionBase& proto) {
+  std::vector<std::string> names;
+  for (const viz::Node& node : proto.nodes()) {
+    names.push_back(node.name());
+  }
+  return names;
+}
+
+TEST_F(IrToJsonTest, IrVisualizerNeighborhood) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
+package test
+
+top fn main(x: bits[32]) -> bits[32] {
+  a: bits[32] = neg(x)
+  b: bits[32] = not(a)
+  c: bits[32] = neg(b)
+  ret d: bits[32] = add(c, c)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  IrVisualizer visualizer(std::move(p), *delay_estimator);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string summary_json, visualizer.SummaryJson());
+  XLS_VLOG(1) << summary_json;
+  viz::Package summary = ParseJson<viz::Package>(summary_json);
+  EXPECT_EQ(summary.entry_id(), "f0");
+  ASSERT_EQ(summary.function_bases_size(), 1);
+  EXPECT_EQ(summary.function_bases(0).node_count(), 5);
+  EXPECT_EQ(summary.function_bases(0).edge_count(), 5);
+  EXPECT_TRUE(summary.function_bases(0).nodes().empty());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string json,
+      visualizer.NeighborhoodJson("f0", "b", /*radius=*/1, /*max_nodes=*/10));
+  XLS_VLOG(1) << json;
+  viz::FunctionBase neighborhood = ParseJson<viz::FunctionBase>(json);
+  EXPECT_TRUE(neighborhood.partial());
+  EXPECT_EQ(neighborhood.node_count(), 5);
+  EXPECT_THAT(NodeNames(neighborhood), ElementsAre("b", "a", "c"));
+  EXPECT_EQ(neighborhood.edges_size(), 2);
+  for (const viz::Node& node : neighborhood.nodes()) {
+    // `a` has hidden operand `x` and `c` has two edges to the hidden `d`.
+    EXPECT_EQ(node.hidden_edge_count(),
+              node.name() == "a" ? 1 : (node.name() == "c" ? 2 : 0));
+    // Nodes are laid out in rows by their depth.
+    EXPECT_EQ(node.position().y(), neighborhood.nodes(0).position().y() +
+                                       (node.name() == "a"   ? -100.0
+                                        : node.name() == "c" ? 100.0
+                                                             : 0.0));
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      json,
+      visualizer.NeighborhoodJson("f0", "b", /*radius=*/2, /*max_nodes=*/4));
+  EXPECT_THAT(NodeNames(ParseJson<viz::FunctionBase>(json)),
+              ElementsAre("b", "a", "c", "x"));
+
+  EXPECT_THAT(visualizer.NeighborhoodJson("f0", "foo", 1, 10),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(visualizer.NeighborhoodJson("f42", "b", 1, 10),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(IrToJsonTest, IrVisualizerStages) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue add = fb.Add(x, y);
+  BValue negate = fb.Negate(add);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  ScheduleCycleMap cycle_map;
+  cycle_map[x.node()] = 0;
+  cycle_map[y.node()] = 0;
+  cycle_map[add.node()] = 1;
+  cycle_map[negate.node()] = 2;
+  PipelineSchedule schedule(f, cycle_map);
+  XLS_ASSERT_OK_AND_ASSIGN(DelayEstimator * delay_estimator,
+                           GetDelayEstimator("unit"));
+  IrVisualizer visualizer(std::move(p), *delay_estimator, schedule);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string summary_json,
+                           visualizer.SummaryJson(TestName()));
+  XLS_VLOG(1) << summary_json;
+  viz::Package summary = ParseJson<viz::Package>(summary_json);
+  ASSERT_EQ(summary.function_bases_size(), 1);
+  const viz::FunctionBase& function = summary.function_bases(0);
+  ASSERT_EQ(function.stages_size(), 3);
+  EXPECT_EQ(function.stages(0).node_count(), 2);
+  EXPECT_EQ(function.stages(0).incoming_edge_count(), 0);
+  EXPECT_EQ(function.stages(1).node_count(), 1);
+  EXPECT_EQ(function.stages(1).incoming_edge_count(), 2);
+  EXPECT_EQ(function.stages(1).incoming_bit_count(), 64);
+  EXPECT_EQ(function.stages(2).incoming_edge_count(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string json,
+      visualizer.StageJson("f0", /*cycle=*/0, /*offset=*/0, /*limit=*/10));
+  viz::FunctionBase stage = ParseJson<viz::FunctionBase>(json);
+  EXPECT_THAT(NodeNames(stage), UnorderedElementsAre("x", "y"));
+  EXPECT_TRUE(stage.edges().empty());
+  for (const viz::Node& node : stage.nodes()) {
+    EXPECT_EQ(node.attributes().cycle(), 0);
+    EXPECT_EQ(node.hidden_edge_count(), 1);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      json, visualizer.StageJson("f0", /*cycle=*/0, /*offset=*/1,
+                                 /*limit=*/10));
+  EXPECT_EQ(ParseJson<viz::FunctionBase>(json).nodes_size(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      json, visualizer.StageJson("f0", /*cycle=*/2, /*offset=*/0,
+                                 /*limit=*/10));
+  EXPECT_THAT(NodeNames(ParseJson<viz::FunctionBase>(json)),
+              ElementsAre(negate.node()->GetName()));
+}
+
 }  // namespace
 }  // namespace xls
@@ -15,6 +15,8 @@
 #include "xls/visualization/ir_viz/ir_to_json.h"
 
 #include <memory>
+#include <optional>
+#include <string>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
@@ -48,6 +50,68 @@ absl::StatusOr<FunctionBase*> GetFunctionBaseToView(Package* package) {
       absl::StrFormat("No entities found in package: %s.", package->name()));
 }
 
+// Returns the entity to view: the function named `entry_name` if given,
+// otherwise the entity chosen by GetFunctionBaseToView.
+absl::StatusOr<FunctionBase*> GetEntry(
+    Package* package, std::optional<std::string_view> entry_name) {
+  if (entry_name.has_value()) {
+    return package->GetFunction(entry_name.value());
+  }
+  return GetFunctionBaseToView(package);
+}
+
+// Schedules the entity in the given number of stages, if any.
+absl::StatusOr<std::optional<PipelineSchedule>> MaybeSchedule(
+    FunctionBase* func_base, const DelayEstimator& delay_estimator,
+    std::optional<int64_t> pipeline_stages) {
+  if (!pipeline_stages.has_value()) {
+    return std::nullopt;
+  }
+  // TODO(meheff): Support scheduled procs.
+  XLS_RET_CHECK(func_base->IsFunction());
+  return PipelineSchedule::Run(
+      func_base->AsFunctionOrDie(), delay_estimator,
+      SchedulingOptions().pipeline_stages(pipeline_stages.value()));
+}
+
+// IrVisualizer which also remembers the name of the entity to view.
+class IrVisualizerWrapper {
+ public:
+  static absl::StatusOr<std::unique_ptr<IrVisualizerWrapper>> Create(
+      std::string_view ir_text, std::string_view delay_model_name,
+      std::optional<int64_t> pipeline_stages,
+      std::optional<std::string_view> entry_name) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         Parser::ParsePackage(ir_text));
+    XLS_ASSIGN_OR_RETURN(FunctionBase * func_base,
+                         GetEntry(package.get(), entry_name));
+    XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+                         GetDelayEstimator(delay_model_name));
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<PipelineSchedule> schedule,
+        MaybeSchedule(func_base, *delay_estimator, pipeline_stages));
+    std::string name = func_base->name();
+    return std::make_unique<IrVisualizerWrapper>(
+        std::move(name), std::make_unique<IrVisualizer>(
+                             std::move(package), *delay_estimator,
+                             std::move(schedule)));
+  }
+
+  IrVisualizerWrapper(std::string entry_name,
+                      std::unique_ptr<IrVisualizer> visualizer)
+      : entry_name_(std::move(entry_name)),
+        visualizer_(std::move(visualizer)) {}
+
+  absl::StatusOr<std::string> SummaryJson() {
+    return visualizer_->SummaryJson(entry_name_);
+  }
+  IrVisualizer& visualizer() { return *visualizer_; }
+
+ private:
+  std::string entry_name_;
+  std::unique_ptr<IrVisualizer> visualizer_;
+};
+
 }  // namespace
 
 // IR to JSON conversion function which takes strings rather than objects.
@@ -57,26 +121,15 @@ static absl::StatusOr<std::string> IrToJsonWrapper(
     std::optional<std::string_view> entry_name) {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
                        Parser::ParsePackage(ir_text));
-  FunctionBase* func_base;
-  if (entry_name.has_value()) {
-    XLS_ASSIGN_OR_RETURN(func_base, package->GetFunction(entry_name.value()));
-  } else {
-    XLS_ASSIGN_OR_RETURN(func_base, GetFunctionBaseToView(package.get()));
-  }
+  XLS_ASSIGN_OR_RETURN(FunctionBase * func_base,
+                       GetEntry(package.get(), entry_name));
   XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
                        GetDelayEstimator(delay_model_name));
-  if (pipeline_stages.has_value()) {
-    // TODO(meheff): Support scheduled procs.
-    XLS_RET_CHECK(func_base->IsFunction());
-    XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
-        PipelineSchedule::Run(
-            func_base->AsFunctionOrDie(), *delay_estimator,
-            SchedulingOptions().pipeline_stages(pipeline_stages.value())));
-    return IrToJson(package.get(), *delay_estimator, &schedule,
-                    func_base->name());
-  }
-  return IrToJson(package.get(), *delay_estimator, /*schedule=*/nullptr,
+  XLS_ASSIGN_OR_RETURN(
+      std::optional<PipelineSchedule> schedule,
+      MaybeSchedule(func_base, *delay_estimator, pipeline_stages));
+  return IrToJson(package.get(), *delay_estimator,
+                  schedule.has_value() ? &schedule.value() : nullptr,
                   func_base->name());
 }
 
@@ -86,6 +139,31 @@ PYBIND11_MODULE(ir_to_json, m) {
   m.def("ir_to_json", &IrToJsonWrapper, py::arg("ir_text"),
         py::arg("delay_model_name"), py::arg("pipeline_stages") = std::nullopt,
         py::arg("entry") = std::nullopt);
+
+  py::class_<IrVisualizerWrapper>(m, "IrVisualizer")
+      .def_static("create", &IrVisualizerWrapper::Create, py::arg("ir_text"),
+                  py::arg("delay_model_name"),
+                  py::arg("pipeline_stages") = std::nullopt,
+                  py::arg("entry") = std::nullopt)
+      .def("summary_json", &IrVisualizerWrapper::SummaryJson)
+      .def(
+          "neighborhood_json",
+          [](IrVisualizerWrapper& self, std::string_view function_id,
+             std::string_view node_name, int64_t radius, int64_t max_nodes) {
+            return self.visualizer().NeighborhoodJson(function_id, node_name,
+                                                      radius, max_nodes);
+          },
+          py::arg("function_id"), py::arg("node"), py::arg("radius"),
+          py::arg("max_nodes"))
+      .def(
+          "stage_json",
+          [](IrVisualizerWrapper& self, std::string_view function_id,
+             int64_t cycle, int64_t offset, int64_t limit) {
+            return self.visualizer().StageJson(function_id, cycle, offset,
+                                               limit);
+          },
+          py::arg("function_id"), py::arg("cycle"), py::arg("offset"),
+          py::arg("limit"));
 }
 
 }  // namespace xls
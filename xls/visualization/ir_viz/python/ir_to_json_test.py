@@ -70,6 +70,36 @@ top fn main(x: bits[32], y: bits[32]) -> bits[32] {
       elif node['id'] == 'neg_2':
         self.assertEqual(node['attributes']['cycle'], 1)
 
+  def test_ir_visualizer(self):
+    visualizer = ir_to_json.IrVisualizer.create(
+        """package test
+
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  add.1: bits[32] = add(x, y)
+  ret neg.2: bits[32] = neg(add.1)
+}""", 'unit', 2)
+    summary = json.loads(visualizer.summary_json())
+    function_dict = summary['function_bases'][0]
+    self.assertTrue(function_dict['partial'])
+    self.assertEqual(function_dict['node_count'], 4)
+    self.assertEqual(function_dict['edge_count'], 3)
+    self.assertNotIn('nodes', function_dict)
+    self.assertLen(function_dict['stages'], 2)
+
+    neighborhood = json.loads(
+        visualizer.neighborhood_json(
+            function_dict['id'], 'add.1', radius=1, max_nodes=10))
+    self.assertLen(neighborhood['nodes'], 4)
+    self.assertLen(neighborhood['edges'], 3)
+
+    stage = json.loads(
+        visualizer.stage_json(function_dict['id'], 1, offset=0, limit=10))
+    for node in stage['nodes']:
+      self.assertEqual(node['attributes']['cycle'], 1)
+
+    with self.assertRaisesRegex(Exception, 'No function base'):
+      visualizer.stage_json('foo', 0, offset=0, limit=10)
+
 
 if __name__ == '__main__':
   absltest.main()